@@ -0,0 +1,1007 @@
+/*
+
+					SpoutBenchmark.cpp
+
+		Throughput and latency of sender/receiver process pairs
+
+	Usage :
+
+		SpoutBenchmark [-mode dx11,gldx,cpu,memory] [-size 1920x1080,...]
+		               [-frames n] [-csv file]
+		               [-load compute,fill] [-loadlevel n] [-priority n] [-async]
+
+	With no arguments, every share mode is measured at 720p, 1080p, 4K and 8K.
+	DirectX 11 texture share is also measured for each sender format.
+
+	For each combination a sender and a receiver process are started
+	with the same executable and sender name. The sender sends as fast as
+	it can and the receiver receives until the number of frames is reached.
+
+		dx11   - spoutDX SendTexture / ReceiveTexture
+		gldx   - OpenGL/DirectX interop SendTexture / ReceiveTexture
+		cpu    - CPU share (SetCPUshare)
+		memory - Memory share (SetMemoryShareMode)
+
+	Reported for each combination :
+
+		fps        - frames received per second
+		p50, p99   - sender publish to receiver receipt msec (frame age)
+		send       - sender SendTexture msec per frame
+		recv       - receiver ReceiveTexture msec per frame
+		gpu        - sender GPU copy msec per frame (dx11 frame timing)
+		missed     - sender frames not received
+		load       - synthetic GPU load frames per second (with -load)
+
+	GPU load
+
+	Idle system figures do not show copies and read backs queued
+	behind other GPU work. With -load, a third process renders a
+	synthetic load on the default adapter for the whole measurement,
+	as a heavy application would, and keeps the GPU queue full.
+
+		compute    - ALU bound compute shader over a 4K texture
+		fill       - overdraw of full screen triangles with blending
+		             to a 4K floating point render target (fill rate)
+
+	-loadlevel is the number of passes of each kernel for every load
+	frame (default 8). The load process keeps two frames in flight.
+
+	GPU priority and asynchronous send can then be compared under load.
+
+		-priority n - GPU thread priority (-7 to 7) of the sender and
+		              receiver devices (SetGPUPriority)
+		-async      - dx11 sender asynchronous send (SetAsyncSend)
+
+	Memory share and frame counting are user registry settings.
+	They are set for the child processes and restored afterwards,
+	so other Spout applications should be closed while the benchmark runs.
+
+	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+	========================
+
+	14.10.26 - first version
+	15.10.26 - Add synthetic GPU load process with -load and -loadlevel.
+			   Add -priority and -async for the sender and receiver.
+
+*/
+
+#include "SpoutDX.h"
+#include "SpoutSender.h"
+#include "SpoutReceiver.h"
+#include <algorithm> // for std::sort
+
+// Frames received before measurement starts
+#define BENCH_WARMUP 30
+// Maximum msec for a receiver to connect and for each measurement
+#define BENCH_CONNECT_TIMEOUT 5000
+#define BENCH_RUN_TIMEOUT 20000
+// Msec for the GPU load to reach a steady state before measurement
+#define BENCH_LOAD_WARMUP 500
+// Size of the GPU load targets
+#define BENCH_LOAD_WIDTH  3840
+#define BENCH_LOAD_HEIGHT 2160
+
+struct BenchConfig {
+	char mode[16];
+	unsigned int width;
+	unsigned int height;
+	DWORD format;
+	int priority; // GPU thread priority of the sender and receiver devices
+	bool bAsync; // dx11 asynchronous send
+};
+
+struct BenchResult {
+	bool bValid;
+	LONG64 frames;
+	LONG64 missed;
+	double fps;
+	double p50;
+	double p99;
+	double sendmsec;
+	double recvmsec;
+	double gpumsec;
+	double loadfps;
+};
+
+static const char* const g_Modes[] = { "dx11", "gldx", "cpu", "memory" };
+static const unsigned int g_Sizes[][2] = { {1280, 720}, {1920, 1080}, {3840, 2160}, {7680, 4320} };
+// DXGI formats for dx11 : BGRA8, RGBA8, RGB10A2, RGBA16F, RGBA32F
+static const DWORD g_Formats[] = { 87, 28, 24, 10, 2 };
+
+//
+// Timing
+//
+
+static double CounterFrequency()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceFrequency(&li);
+	return static_cast<double>(li.QuadPart)/1000.0; // counts per msec
+}
+
+static LONG64 Counter()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceCounter(&li);
+	return li.QuadPart;
+}
+
+// Nearest rank percentile of sorted values
+static double Percentile(const std::vector<double>& sorted, unsigned int percent)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = (sorted.size()*percent + 99)/100;
+	if (rank < 1) rank = 1;
+	if (rank > sorted.size()) rank = sorted.size();
+	return sorted[rank-1];
+}
+
+static bool StopSignalled(HANDLE hStop)
+{
+	return (hStop && WaitForSingleObject(hStop, 0) == WAIT_OBJECT_0);
+}
+
+//
+// GPU load process
+//
+// Renders the load until the stop event is set and writes
+// the load frames per second to the output file.
+//
+
+// ALU bound kernel, 8x8 threads for each 8x8 pixel tile
+static const char* g_LoadComputeShader =
+	"RWTexture2D<float4> output : register(u0);\n"
+	"[numthreads(8, 8, 1)]\n"
+	"void main(uint3 id : SV_DispatchThreadID)\n"
+	"{\n"
+	"	float4 v = float4(id.xy, 0.5, 1.0)*0.001;\n"
+	"	[loop] for (uint i = 0; i < 512; i++)\n"
+	"		v = frac(v*v*1.0001 + float4(0.37, 0.21, 0.13, 0.07));\n"
+	"	output[id.xy] = v;\n"
+	"}\n";
+
+// Full screen triangle from the vertex id
+static const char* g_LoadVertexShader =
+	"float4 main(uint id : SV_VertexID) : SV_Position\n"
+	"{\n"
+	"	float2 uv = float2((id << 1) & 2, id & 2);\n"
+	"	return float4(uv*float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);\n"
+	"}\n";
+
+static const char* g_LoadPixelShader =
+	"float4 main(float4 pos : SV_Position) : SV_Target\n"
+	"{\n"
+	"	return float4(frac(pos.xy*0.001), 0.01, 0.01);\n"
+	"}\n";
+
+static ID3DBlob* CompileLoadShader(const char* shader, const char* target)
+{
+	static pD3DCompile pCompile = nullptr;
+	if (!pCompile) {
+		HMODULE hCompiler = LoadLibraryA("d3dcompiler_47.dll");
+		if (hCompiler)
+			pCompile = (pD3DCompile)GetProcAddress(hCompiler, "D3DCompile");
+	}
+	if (!pCompile)
+		return nullptr;
+
+	ID3DBlob* pBlob = nullptr;
+	ID3DBlob* pErrorBlob = nullptr;
+	const HRESULT hr = pCompile(shader, strlen(shader), nullptr, nullptr, nullptr,
+		"main", target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pBlob, &pErrorBlob);
+	if (pErrorBlob) pErrorBlob->Release();
+	if (FAILED(hr)) {
+		if (pBlob) pBlob->Release();
+		return nullptr;
+	}
+	return pBlob;
+}
+
+struct LoadResources {
+	ID3D11ComputeShader* pCompute;
+	ID3D11UnorderedAccessView* pComputeView;
+	ID3D11VertexShader* pVertex;
+	ID3D11PixelShader* pPixel;
+	ID3D11BlendState* pBlend;
+	ID3D11RenderTargetView* pFillView;
+	ID3D11Texture2D* pTextures[2];
+	ID3D11Query* pQueries[2];
+};
+
+static void ReleaseLoad(LoadResources& res)
+{
+	if (res.pCompute) res.pCompute->Release();
+	if (res.pComputeView) res.pComputeView->Release();
+	if (res.pVertex) res.pVertex->Release();
+	if (res.pPixel) res.pPixel->Release();
+	if (res.pBlend) res.pBlend->Release();
+	if (res.pFillView) res.pFillView->Release();
+	for (int i = 0; i < 2; i++) {
+		if (res.pTextures[i]) res.pTextures[i]->Release();
+		if (res.pQueries[i]) res.pQueries[i]->Release();
+	}
+	res = {};
+}
+
+static bool CreateLoad(ID3D11Device* pDevice, bool bCompute, bool bFill, LoadResources& res)
+{
+	res = {};
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = BENCH_LOAD_WIDTH;
+	desc.Height = BENCH_LOAD_HEIGHT;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+
+	if (bCompute) {
+		desc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+		ID3DBlob* pBlob = CompileLoadShader(g_LoadComputeShader, "cs_5_0");
+		if (!pBlob
+			|| FAILED(pDevice->CreateComputeShader(pBlob->GetBufferPointer(), pBlob->GetBufferSize(), nullptr, &res.pCompute))
+			|| FAILED(pDevice->CreateTexture2D(&desc, nullptr, &res.pTextures[0]))
+			|| FAILED(pDevice->CreateUnorderedAccessView(res.pTextures[0], nullptr, &res.pComputeView))) {
+			if (pBlob) pBlob->Release();
+			ReleaseLoad(res);
+			return false;
+		}
+		pBlob->Release();
+	}
+
+	if (bFill) {
+		desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+		desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+		ID3DBlob* pVSBlob = CompileLoadShader(g_LoadVertexShader, "vs_5_0");
+		ID3DBlob* pPSBlob = CompileLoadShader(g_LoadPixelShader, "ps_5_0");
+		D3D11_BLEND_DESC blend={};
+		blend.RenderTarget[0].BlendEnable = TRUE;
+		blend.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+		blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		blend.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		const bool bCreated = pVSBlob && pPSBlob
+			&& SUCCEEDED(pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &res.pVertex))
+			&& SUCCEEDED(pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &res.pPixel))
+			&& SUCCEEDED(pDevice->CreateBlendState(&blend, &res.pBlend))
+			&& SUCCEEDED(pDevice->CreateTexture2D(&desc, nullptr, &res.pTextures[1]))
+			&& SUCCEEDED(pDevice->CreateRenderTargetView(res.pTextures[1], nullptr, &res.pFillView));
+		if (pVSBlob) pVSBlob->Release();
+		if (pPSBlob) pPSBlob->Release();
+		if (!bCreated) {
+			ReleaseLoad(res);
+			return false;
+		}
+	}
+
+	D3D11_QUERY_DESC query={};
+	query.Query = D3D11_QUERY_EVENT;
+	for (int i = 0; i < 2; i++) {
+		if (FAILED(pDevice->CreateQuery(&query, &res.pQueries[i]))) {
+			ReleaseLoad(res);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool RunLoad(const char* kernels, unsigned int level, HANDLE hStop, double& loadfps)
+{
+	const bool bCompute = (strstr(kernels, "compute") != nullptr);
+	const bool bFill = (strstr(kernels, "fill") != nullptr);
+	if (!bCompute && !bFill)
+		return false;
+
+	spoutDX loader;
+	if (!loader.OpenDirectX11() || !loader.GetDX11Device())
+		return false;
+	ID3D11DeviceContext* pContext = loader.GetDX11Context();
+
+	LoadResources res={};
+	if (!CreateLoad(loader.GetDX11Device(), bCompute, bFill, res)) {
+		loader.CloseDirectX11();
+		return false;
+	}
+
+	const D3D11_VIEWPORT viewport = { 0.0f, 0.0f, (float)BENCH_LOAD_WIDTH, (float)BENCH_LOAD_HEIGHT, 0.0f, 1.0f };
+	const float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const double frequency = CounterFrequency();
+	const LONG64 timeout = Counter() + (LONG64)(frequency*(BENCH_CONNECT_TIMEOUT+BENCH_RUN_TIMEOUT*3));
+	const LONG64 start = Counter();
+	LONG64 frames = 0;
+
+	while (!StopSignalled(hStop) && Counter() < timeout) {
+		// Wait for the frame before last so that two frames are queued
+		ID3D11Query* pQuery = res.pQueries[frames % 2];
+		if (frames >= 2) {
+			while (pContext->GetData(pQuery, nullptr, 0, 0) == S_FALSE) {
+				if (StopSignalled(hStop))
+					break;
+				YieldProcessor();
+			}
+		}
+		for (unsigned int i = 0; i < level; i++) {
+			if (bCompute) {
+				pContext->CSSetShader(res.pCompute, nullptr, 0);
+				pContext->CSSetUnorderedAccessViews(0, 1, &res.pComputeView, nullptr);
+				pContext->Dispatch((BENCH_LOAD_WIDTH+7)/8, (BENCH_LOAD_HEIGHT+7)/8, 1);
+			}
+			if (bFill) {
+				if (i == 0)
+					pContext->ClearRenderTargetView(res.pFillView, clear);
+				pContext->OMSetRenderTargets(1, &res.pFillView, nullptr);
+				pContext->OMSetBlendState(res.pBlend, nullptr, 0xffffffff);
+				pContext->RSSetViewports(1, &viewport);
+				pContext->IASetInputLayout(nullptr);
+				pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+				pContext->VSSetShader(res.pVertex, nullptr, 0);
+				pContext->PSSetShader(res.pPixel, nullptr, 0);
+				// Overdraw of eight full screen layers
+				for (int j = 0; j < 8; j++)
+					pContext->Draw(3, 0);
+			}
+		}
+		pContext->End(pQuery);
+		pContext->Flush();
+		frames++;
+	}
+
+	const double elapsed = static_cast<double>(Counter()-start)/frequency;
+	loadfps = (elapsed > 0.0) ? static_cast<double>(frames)*1000.0/elapsed : 0.0;
+
+	pContext->ClearState();
+	ReleaseLoad(res);
+	loader.CloseDirectX11();
+
+	return (frames > 0);
+}
+
+//
+// Sender process
+//
+// Sends until the stop event is set and writes the
+// SendTexture msec per frame to the output file.
+//
+
+static bool RunSenderDX(const BenchConfig& config, const char* name, HANDLE hStop, double& sendmsec, LONG64& frames)
+{
+	spoutDX sender;
+	if (config.priority != 0)
+		sender.spoutdx.SetGPUPriority(config.priority);
+	if (!sender.OpenDirectX11())
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = config.width;
+	desc.Height = config.height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = (DXGI_FORMAT)config.format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+	ID3D11Texture2D* pTexture = nullptr;
+	ID3D11RenderTargetView* pView = nullptr;
+	if (FAILED(sender.GetDX11Device()->CreateTexture2D(&desc, nullptr, &pTexture))
+		|| FAILED(sender.GetDX11Device()->CreateRenderTargetView(pTexture, nullptr, &pView))) {
+		if (pTexture) pTexture->Release();
+		return false;
+	}
+
+	// GPU copy time for the receiver
+	sender.frame.EnableFrameTiming();
+	sender.SetAsyncSend(config.bAsync);
+	sender.SetSenderFormat((DXGI_FORMAT)config.format);
+	sender.SetSenderName(name);
+
+	const double frequency = CounterFrequency();
+	const LONG64 timeout = Counter() + (LONG64)(frequency*(BENCH_CONNECT_TIMEOUT+BENCH_RUN_TIMEOUT*2));
+	LONG64 total = 0;
+	frames = 0;
+	while (!StopSignalled(hStop) && Counter() < timeout) {
+		// Change the texture every frame
+		const float level = static_cast<float>(frames % 256)/255.0f;
+		const float color[4] = { level, 0.5f, 1.0f-level, 1.0f };
+		sender.GetDX11Context()->ClearRenderTargetView(pView, color);
+		const LONG64 start = Counter();
+		if (!sender.SendTexture(pTexture))
+			break;
+		total += Counter() - start;
+		frames++;
+	}
+
+	sendmsec = (frames > 0) ? static_cast<double>(total)/frequency/static_cast<double>(frames) : 0.0;
+
+	sender.ReleaseSender();
+	pView->Release();
+	pTexture->Release();
+	sender.CloseDirectX11();
+
+	return (frames > 0);
+}
+
+static bool RunSenderGL(const BenchConfig& config, const char* name, HANDLE hStop, double& sendmsec, LONG64& frames)
+{
+	SpoutSender sender;
+	if (config.priority != 0)
+		sender.spout.spoutdx.SetGPUPriority(config.priority);
+	if (!sender.CreateOpenGL())
+		return false;
+
+	if (strcmp(config.mode, "cpu") == 0)
+		sender.SetCPUshare(true);
+
+	// Texture with a pattern
+	std::vector<unsigned char> pixels((size_t)config.width*config.height*4);
+	for (size_t i = 0; i < pixels.size(); i++)
+		pixels[i] = (unsigned char)(i % 251);
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, config.width, config.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	sender.SetSenderName(name);
+
+	const double frequency = CounterFrequency();
+	const LONG64 timeout = Counter() + (LONG64)(frequency*(BENCH_CONNECT_TIMEOUT+BENCH_RUN_TIMEOUT*2));
+	LONG64 total = 0;
+	frames = 0;
+	while (!StopSignalled(hStop) && Counter() < timeout) {
+		const LONG64 start = Counter();
+		if (!sender.SendTexture(texture, GL_TEXTURE_2D, config.width, config.height, false))
+			break;
+		total += Counter() - start;
+		frames++;
+	}
+
+	sendmsec = (frames > 0) ? static_cast<double>(total)/frequency/static_cast<double>(frames) : 0.0;
+
+	sender.ReleaseSender();
+	glDeleteTextures(1, &texture);
+	sender.CloseOpenGL();
+
+	return (frames > 0);
+}
+
+//
+// Receiver process
+//
+// Receives until the number of frames after warmup and writes the results.
+//
+
+// Results from the receive times, frame ages and elapsed time
+static void ReceiverResult(BenchResult& result, const std::vector<double>& recvtimes,
+	std::vector<double>& ages, double elapsed, LONG64 missed)
+{
+	result.frames = (LONG64)recvtimes.size();
+	result.missed = missed;
+	result.fps = (elapsed > 0.0) ? static_cast<double>(result.frames)*1000.0/elapsed : 0.0;
+	double total = 0.0;
+	for (size_t i = 0; i < recvtimes.size(); i++)
+		total += recvtimes[i];
+	result.recvmsec = recvtimes.empty() ? 0.0 : total/static_cast<double>(recvtimes.size());
+	std::sort(ages.begin(), ages.end());
+	result.p50 = Percentile(ages, 50);
+	result.p99 = Percentile(ages, 99);
+	result.bValid = (result.frames > 0);
+}
+
+static bool RunReceiverDX(const BenchConfig& config, const char* name, unsigned int nFrames, BenchResult& result)
+{
+	spoutDX receiver;
+	if (config.priority != 0)
+		receiver.spoutdx.SetGPUPriority(config.priority);
+	if (!receiver.OpenDirectX11())
+		return false;
+
+	receiver.SetReceiverName(name);
+
+	ID3D11Texture2D* pTexture = nullptr;
+	std::vector<double> recvtimes;
+	std::vector<double> ages;
+	recvtimes.reserve(nFrames);
+	ages.reserve(nFrames);
+
+	const double frequency = CounterFrequency();
+	LONG64 timeout = Counter() + (LONG64)(frequency*BENCH_CONNECT_TIMEOUT);
+	LONG64 start = 0;
+	LONG64 missedstart = 0;
+	double gputotal = 0.0;
+	unsigned int gpucount = 0;
+	unsigned int warmup = 0;
+
+	while (recvtimes.size() < nFrames && Counter() < timeout) {
+		const LONG64 t0 = Counter();
+		const bool bReceived = receiver.ReceiveTexture(&pTexture);
+		const LONG64 t1 = Counter();
+		if (receiver.IsUpdated()) {
+			// Receiving texture the same size and format as the sender
+			if (pTexture) pTexture->Release();
+			pTexture = nullptr;
+			receiver.spoutdx.CreateDX11Texture(receiver.GetDX11Device(),
+				receiver.GetSenderWidth(), receiver.GetSenderHeight(),
+				receiver.GetSenderFormat(), &pTexture);
+			continue;
+		}
+		if (!bReceived || !pTexture || !receiver.IsFrameNew()) {
+			YieldProcessor();
+			continue;
+		}
+		if (warmup < BENCH_WARMUP) {
+			// Measure from the end of the warmup
+			if (++warmup == BENCH_WARMUP) {
+				start = Counter();
+				missedstart = receiver.GetSenderMissedFrames();
+				timeout = start + (LONG64)(frequency*BENCH_RUN_TIMEOUT);
+			}
+			continue;
+		}
+		recvtimes.push_back(static_cast<double>(t1-t0)/frequency);
+		ages.push_back(receiver.GetSenderFrameAge());
+		const double gpumsec = receiver.frame.GetFrameCopyTime();
+		if (gpumsec > 0.0) {
+			gputotal += gpumsec;
+			gpucount++;
+		}
+	}
+
+	const double elapsed = (start > 0) ? static_cast<double>(Counter()-start)/frequency : 0.0;
+	ReceiverResult(result, recvtimes, ages, elapsed, receiver.GetSenderMissedFrames()-missedstart);
+	result.gpumsec = (gpucount > 0) ? gputotal/static_cast<double>(gpucount) : 0.0;
+
+	if (pTexture) pTexture->Release();
+	receiver.ReleaseReceiver();
+	receiver.CloseDirectX11();
+
+	UNREFERENCED_PARAMETER(config);
+
+	return result.bValid;
+}
+
+static bool RunReceiverGL(const BenchConfig& config, const char* name, unsigned int nFrames, BenchResult& result)
+{
+	SpoutReceiver receiver;
+	if (config.priority != 0)
+		receiver.spout.spoutdx.SetGPUPriority(config.priority);
+	if (!receiver.CreateOpenGL())
+		return false;
+
+	if (strcmp(config.mode, "cpu") == 0)
+		receiver.SetCPUshare(true);
+
+	receiver.SetReceiverName(name);
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+
+	std::vector<double> recvtimes;
+	std::vector<double> ages;
+	recvtimes.reserve(nFrames);
+	ages.reserve(nFrames);
+
+	const double frequency = CounterFrequency();
+	LONG64 timeout = Counter() + (LONG64)(frequency*BENCH_CONNECT_TIMEOUT);
+	LONG64 start = 0;
+	LONG64 missedstart = 0;
+	unsigned int warmup = 0;
+	bool bTexture = false;
+
+	while (recvtimes.size() < nFrames && Counter() < timeout) {
+		const LONG64 t0 = Counter();
+		const bool bReceived = receiver.ReceiveTexture(bTexture ? texture : 0, GL_TEXTURE_2D);
+		const LONG64 t1 = Counter();
+		if (receiver.IsUpdated()) {
+			// Receiving texture the same size as the sender
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, receiver.GetSenderWidth(), receiver.GetSenderHeight(),
+				0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			bTexture = true;
+			continue;
+		}
+		if (!bReceived || !bTexture || !receiver.IsFrameNew()) {
+			YieldProcessor();
+			continue;
+		}
+		if (warmup < BENCH_WARMUP) {
+			if (++warmup == BENCH_WARMUP) {
+				start = Counter();
+				missedstart = receiver.GetSenderMissedFrames();
+				timeout = start + (LONG64)(frequency*BENCH_RUN_TIMEOUT);
+			}
+			continue;
+		}
+		recvtimes.push_back(static_cast<double>(t1-t0)/frequency);
+		ages.push_back(receiver.GetSenderFrameAge());
+	}
+
+	const double elapsed = (start > 0) ? static_cast<double>(Counter()-start)/frequency : 0.0;
+	ReceiverResult(result, recvtimes, ages, elapsed, receiver.GetSenderMissedFrames()-missedstart);
+	result.gpumsec = 0.0;
+
+	receiver.ReleaseReceiver();
+	glDeleteTextures(1, &texture);
+	receiver.CloseOpenGL();
+
+	return result.bValid;
+}
+
+//
+// Controller
+//
+
+static bool ParseConfig(int argc, char* argv[], int first, BenchConfig& config)
+{
+	if (argc < first+4)
+		return false;
+	strcpy_s(config.mode, 16, argv[first]);
+	config.width  = (unsigned int)atoi(argv[first+1]);
+	config.height = (unsigned int)atoi(argv[first+2]);
+	config.format = (DWORD)atoi(argv[first+3]);
+	return (config.width > 0 && config.height > 0);
+}
+
+// Optional priority and async arguments following the fixed arguments
+static void ParseOptions(int argc, char* argv[], int first, BenchConfig& config)
+{
+	if (argc > first)
+		config.priority = atoi(argv[first]);
+	if (argc > first+1)
+		config.bAsync = (atoi(argv[first+1]) != 0);
+}
+
+static HANDLE StartProcess(const char* args)
+{
+	char path[MAX_PATH]={};
+	GetModuleFileNameA(NULL, path, MAX_PATH);
+
+	char cmdline[1024]={};
+	sprintf_s(cmdline, 1024, "\"%s\" %s", path, args);
+
+	STARTUPINFOA si={};
+	si.cb = sizeof(si);
+	PROCESS_INFORMATION pi={};
+	if (!CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi))
+		return NULL;
+	CloseHandle(pi.hThread);
+	return pi.hProcess;
+}
+
+// Run a sender and receiver pair, with a GPU load process
+// if load kernels are specified, and read their results
+static bool RunConfig(const BenchConfig& config, unsigned int nFrames,
+	const char* load, unsigned int loadlevel, BenchResult& result)
+{
+	char name[64]={};
+	char stopname[80]={};
+	char senderfile[MAX_PATH]={};
+	char receiverfile[MAX_PATH]={};
+	char loadfile[MAX_PATH]={};
+	char temppath[MAX_PATH]={};
+	char args[512]={};
+
+	result = {};
+
+	GetTempPathA(MAX_PATH, temppath);
+	sprintf_s(name, 64, "SpoutBenchmark_%lu", GetCurrentProcessId());
+	sprintf_s(stopname, 80, "%s_stop", name);
+	sprintf_s(senderfile, MAX_PATH, "%s%s_sender.txt", temppath, name);
+	sprintf_s(receiverfile, MAX_PATH, "%s%s_receiver.txt", temppath, name);
+	sprintf_s(loadfile, MAX_PATH, "%s%s_load.txt", temppath, name);
+	DeleteFileA(senderfile);
+	DeleteFileA(receiverfile);
+	DeleteFileA(loadfile);
+
+	HANDLE hStop = CreateEventA(NULL, TRUE, FALSE, stopname);
+	if (!hStop)
+		return false;
+
+	// The load runs until the stop event for the whole measurement
+	HANDLE hLoad = NULL;
+	if (load) {
+		sprintf_s(args, 512, "-gpuload %s %u %s \"%s\"", load, loadlevel, name, loadfile);
+		hLoad = StartProcess(args);
+		if (!hLoad) {
+			CloseHandle(hStop);
+			return false;
+		}
+		Sleep(BENCH_LOAD_WARMUP);
+	}
+
+	sprintf_s(args, 512, "-sender %s %u %u %lu %s \"%s\" %d %d",
+		config.mode, config.width, config.height, config.format, name, senderfile,
+		config.priority, config.bAsync ? 1 : 0);
+	HANDLE hSender = StartProcess(args);
+	if (!hSender) {
+		SetEvent(hStop);
+		if (hLoad) {
+			if (WaitForSingleObject(hLoad, BENCH_CONNECT_TIMEOUT) != WAIT_OBJECT_0)
+				TerminateProcess(hLoad, 1);
+			CloseHandle(hLoad);
+		}
+		CloseHandle(hStop);
+		return false;
+	}
+
+	sprintf_s(args, 512, "-receiver %s %u %u %lu %s \"%s\" %u %d",
+		config.mode, config.width, config.height, config.format, name, receiverfile, nFrames,
+		config.priority);
+	HANDLE hReceiver = StartProcess(args);
+	if (hReceiver) {
+		if (WaitForSingleObject(hReceiver, BENCH_CONNECT_TIMEOUT+BENCH_RUN_TIMEOUT*2) != WAIT_OBJECT_0)
+			TerminateProcess(hReceiver, 1);
+		CloseHandle(hReceiver);
+	}
+
+	SetEvent(hStop);
+	if (WaitForSingleObject(hSender, BENCH_CONNECT_TIMEOUT) != WAIT_OBJECT_0)
+		TerminateProcess(hSender, 1);
+	CloseHandle(hSender);
+	if (hLoad) {
+		if (WaitForSingleObject(hLoad, BENCH_CONNECT_TIMEOUT) != WAIT_OBJECT_0)
+			TerminateProcess(hLoad, 1);
+		CloseHandle(hLoad);
+	}
+	CloseHandle(hStop);
+
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, receiverfile, "r") == 0 && fp) {
+		long long frames = 0;
+		long long missed = 0;
+		if (fscanf_s(fp, "%lld %lld %lf %lf %lf %lf %lf", &frames, &missed,
+			&result.fps, &result.p50, &result.p99, &result.recvmsec, &result.gpumsec) == 7) {
+			result.frames = frames;
+			result.missed = missed;
+			result.bValid = (frames > 0);
+		}
+		fclose(fp);
+	}
+	if (fopen_s(&fp, senderfile, "r") == 0 && fp) {
+		if (fscanf_s(fp, "%lf", &result.sendmsec) != 1)
+			result.sendmsec = 0.0;
+		fclose(fp);
+	}
+	if (hLoad && fopen_s(&fp, loadfile, "r") == 0 && fp) {
+		if (fscanf_s(fp, "%lf", &result.loadfps) != 1)
+			result.loadfps = 0.0;
+		fclose(fp);
+	}
+	DeleteFileA(senderfile);
+	DeleteFileA(receiverfile);
+	DeleteFileA(loadfile);
+
+	return result.bValid;
+}
+
+static bool ListContains(const char* list, const char* item)
+{
+	if (!list)
+		return true;
+	std::string str = ",";
+	str += list;
+	str += ",";
+	std::string find = ",";
+	find += item;
+	find += ",";
+	return (str.find(find) != std::string::npos);
+}
+
+static int RunBenchmark(const char* modes, const char* sizes, unsigned int nFrames, const char* csvpath,
+	const char* load, unsigned int loadlevel, int priority, bool bAsync)
+{
+	// Registry settings used by the child processes
+	DWORD dwMemory = 0;
+	DWORD dwFramecount = 0;
+	const bool bMemoryKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", &dwMemory);
+	const bool bCountKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", &dwFramecount);
+	WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", 1);
+
+	FILE* csv = nullptr;
+	if (csvpath) {
+		if (fopen_s(&csv, csvpath, "w") == 0 && csv)
+			fprintf(csv, "mode,width,height,format,frames,fps,p50,p99,send,recv,gpu,missed,load\n");
+	}
+
+	if (load)
+		printf("GPU load : %s, level %u\n", load, loadlevel);
+	if (priority != 0 || bAsync)
+		printf("GPU priority %d%s\n", priority, bAsync ? ", async send" : "");
+	printf("%-7s %-10s %6s %8s %8s %8s %8s %8s %8s %7s %8s\n",
+		"mode", "size", "format", "fps", "p50", "p99", "send", "recv", "gpu", "missed", "load");
+
+	int failed = 0;
+	for (int m = 0; m < _countof(g_Modes); m++) {
+		if (!ListContains(modes, g_Modes[m]))
+			continue;
+		const bool bDX = (strcmp(g_Modes[m], "dx11") == 0);
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare",
+			(strcmp(g_Modes[m], "memory") == 0) ? 1 : 0);
+		for (int s = 0; s < _countof(g_Sizes); s++) {
+			char size[32]={};
+			sprintf_s(size, 32, "%ux%u", g_Sizes[s][0], g_Sizes[s][1]);
+			if (!ListContains(sizes, size))
+				continue;
+			// Formats are only selectable for DirectX 11 texture share
+			const int nFormats = bDX ? (int)_countof(g_Formats) : 1;
+			for (int f = 0; f < nFormats; f++) {
+				BenchConfig config={};
+				strcpy_s(config.mode, 16, g_Modes[m]);
+				config.width = g_Sizes[s][0];
+				config.height = g_Sizes[s][1];
+				config.format = g_Formats[f];
+				config.priority = priority;
+				config.bAsync = bDX && bAsync;
+				BenchResult result={};
+				if (RunConfig(config, nFrames, load, loadlevel, result)) {
+					printf("%-7s %-10s %6lu %8.1f %8.3f %8.3f %8.3f %8.3f %8.3f %7lld %8.1f\n",
+						config.mode, size, config.format, result.fps, result.p50, result.p99,
+						result.sendmsec, result.recvmsec, result.gpumsec, result.missed, result.loadfps);
+					if (csv)
+						fprintf(csv, "%s,%u,%u,%lu,%lld,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%lld,%.2f\n",
+							config.mode, config.width, config.height, config.format, result.frames,
+							result.fps, result.p50, result.p99, result.sendmsec, result.recvmsec,
+							result.gpumsec, result.missed, result.loadfps);
+				}
+				else {
+					printf("%-7s %-10s %6lu   failed\n", config.mode, size, config.format);
+					failed++;
+				}
+			}
+		}
+	}
+
+	if (csv)
+		fclose(csv);
+
+	// Restore registry settings
+	if (bMemoryKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", dwMemory);
+	else
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", 0);
+	if (bCountKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", dwFramecount);
+
+	return (failed > 0) ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchConfig config={};
+
+	// GPU load process
+	// -gpuload kernels level name file
+	if (argc > 1 && strcmp(argv[1], "-gpuload") == 0) {
+		if (argc < 6)
+			return 1;
+		HANDLE hStop = OpenEventA(SYNCHRONIZE, FALSE, (std::string(argv[4]) + "_stop").c_str());
+		double loadfps = 0.0;
+		const unsigned int level = (unsigned int)atoi(argv[3]);
+		const bool bResult = RunLoad(argv[2], (level > 0) ? level : 1, hStop, loadfps);
+		if (hStop) CloseHandle(hStop);
+		FILE* fp = nullptr;
+		if (bResult && fopen_s(&fp, argv[5], "w") == 0 && fp) {
+			fprintf(fp, "%.6f\n", loadfps);
+			fclose(fp);
+		}
+		return bResult ? 0 : 1;
+	}
+
+	// Sender process
+	// -sender mode width height format name file [priority async]
+	if (argc > 1 && strcmp(argv[1], "-sender") == 0) {
+		if (!ParseConfig(argc, argv, 2, config) || argc < 8)
+			return 1;
+		ParseOptions(argc, argv, 8, config);
+		HANDLE hStop = OpenEventA(SYNCHRONIZE, FALSE, (std::string(argv[6]) + "_stop").c_str());
+		double sendmsec = 0.0;
+		LONG64 frames = 0;
+		bool bResult = false;
+		if (strcmp(config.mode, "dx11") == 0)
+			bResult = RunSenderDX(config, argv[6], hStop, sendmsec, frames);
+		else
+			bResult = RunSenderGL(config, argv[6], hStop, sendmsec, frames);
+		if (hStop) CloseHandle(hStop);
+		FILE* fp = nullptr;
+		if (bResult && fopen_s(&fp, argv[7], "w") == 0 && fp) {
+			fprintf(fp, "%.6f %lld\n", sendmsec, frames);
+			fclose(fp);
+		}
+		return bResult ? 0 : 1;
+	}
+
+	// Receiver process
+	// -receiver mode width height format name file frames [priority]
+	if (argc > 1 && strcmp(argv[1], "-receiver") == 0) {
+		if (!ParseConfig(argc, argv, 2, config) || argc < 9)
+			return 1;
+		ParseOptions(argc, argv, 9, config);
+		BenchResult result={};
+		bool bResult = false;
+		if (strcmp(config.mode, "dx11") == 0)
+			bResult = RunReceiverDX(config, argv[6], (unsigned int)atoi(argv[8]), result);
+		else
+			bResult = RunReceiverGL(config, argv[6], (unsigned int)atoi(argv[8]), result);
+		FILE* fp = nullptr;
+		if (bResult && fopen_s(&fp, argv[7], "w") == 0 && fp) {
+			fprintf(fp, "%lld %lld %.6f %.6f %.6f %.6f %.6f\n", result.frames, result.missed,
+				result.fps, result.p50, result.p99, result.recvmsec, result.gpumsec);
+			fclose(fp);
+		}
+		return bResult ? 0 : 1;
+	}
+
+	// Controller
+	const char* modes = nullptr;
+	const char* sizes = nullptr;
+	const char* csvpath = nullptr;
+	const char* load = nullptr;
+	unsigned int loadlevel = 8;
+	int priority = 0;
+	bool bAsync = false;
+	unsigned int nFrames = 600;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-mode") == 0 && i+1 < argc)
+			modes = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0 && i+1 < argc)
+			sizes = argv[++i];
+		else if (strcmp(argv[i], "-frames") == 0 && i+1 < argc)
+			nFrames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-csv") == 0 && i+1 < argc)
+			csvpath = argv[++i];
+		else if (strcmp(argv[i], "-load") == 0 && i+1 < argc)
+			load = argv[++i];
+		else if (strcmp(argv[i], "-loadlevel") == 0 && i+1 < argc)
+			loadlevel = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-priority") == 0 && i+1 < argc)
+			priority = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-async") == 0)
+			bAsync = true;
+		else {
+			printf("SpoutBenchmark [-mode dx11,gldx,cpu,memory] [-size 1920x1080,...] [-frames n] [-csv file]\n");
+			printf("               [-load compute,fill] [-loadlevel n] [-priority n] [-async]\n");
+			return 1;
+		}
+	}
+	if (nFrames == 0)
+		nFrames = 600;
+	if (loadlevel == 0)
+		loadlevel = 8;
+	if (priority < -7) priority = -7;
+	if (priority > 7) priority = 7;
+
+	return RunBenchmark(modes, sizes, nFrames, csvpath, load, loadlevel, priority, bAsync);
+}
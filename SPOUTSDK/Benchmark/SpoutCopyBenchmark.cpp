@@ -0,0 +1,325 @@
+/*
+
+					SpoutCopyBenchmark.cpp
+
+		Throughput of spoutCopy conversion functions
+
+	Usage :
+
+		SpoutCopyBenchmark [-func name] [-size 1920x1080,...] [-threads n]
+		                   [-quick] [-csv file]
+
+	Each conversion is timed for each instruction level available
+	(SetInstructionLevel) with and without invert, for each image size,
+	buffer alignment and source pitch padding.
+	Functions specific to one instruction set are timed once.
+
+		size    - 640x480 to 3840x2160 and an odd width of 1917x1080
+		align   - buffers aligned to 64 or 16 bytes
+		          SSE functions use aligned loads and require 16 byte alignment
+		pitch   - source line pitch of the image width or padded by 256 bytes
+		          for functions with a pitch argument
+
+	Throughput is source plus destination bytes per second.
+	The memcpy baseline for each size copies an RGBA image and also
+	counts bytes read and written. "memcpy %" is the conversion
+	throughput as a percentage of the baseline.
+
+	-func   - only conversions with names containing the text
+	-size   - comma separated list of sizes
+	-threads - SetCopyThreads for multiple threads (default 1)
+	-quick  - 1920x1080, 64 byte alignment, no pitch padding
+
+	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+	========================
+
+	14.10.26 - first version
+
+*/
+
+#include "SpoutCopy.h"
+#include <malloc.h> // for _aligned_malloc
+#include <algorithm> // for std::sort
+#include <vector>
+#include <string>
+
+// Minimum time and number of timed calls for each case
+#define COPY_BENCH_MSEC 200.0
+#define COPY_BENCH_MIN_CALLS 5
+#define COPY_BENCH_MAX_CALLS 500
+
+// Arguments of a conversion
+struct CopyArgs {
+	const spoutCopy* copy;
+	const unsigned char* src;
+	unsigned char* dst;
+	unsigned int width;
+	unsigned int height;
+	unsigned int srcPitch; // source line bytes
+	unsigned int dstPitch; // destination line bytes
+	unsigned int dstWidth; // resample
+	unsigned int dstHeight;
+	bool bInvert;
+};
+
+typedef void (*CopyFunc)(const CopyArgs& a);
+
+struct Converter {
+	const char* name;
+	unsigned int srcBytes; // Source bytes per pixel
+	unsigned int dstBytes; // Destination bytes per pixel
+	bool bPitch; // Uses a source pitch
+	bool bResample; // Destination is 3/4 of the source size
+	int level; // Instruction level of a specific function, -1 for any
+	CopyFunc func;
+};
+
+static const Converter g_Converters[] = {
+	{ "CopyPixels",         4, 4, false, false, -1, [](const CopyArgs& a) { a.copy->CopyPixels(a.src, a.dst, a.width, a.height, GL_RGBA, a.bInvert); } },
+	{ "RemovePadding",      4, 4, true,  false, -1, [](const CopyArgs& a) { a.copy->RemovePadding(a.src, a.dst, a.width, a.height, a.srcPitch/4, GL_RGBA); } },
+	{ "rgba2rgba",          4, 4, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2rgba(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgba2rgba dpitch",   4, 4, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2rgba(a.src, a.dst, a.width, a.height, a.srcPitch, a.dstPitch, a.bInvert); } },
+	{ "rgba2rgbaResample",  4, 4, true,  true,  -1, [](const CopyArgs& a) { a.copy->rgba2rgbaResample(a.src, a.dst, a.width, a.height, a.srcPitch, a.dstWidth, a.dstHeight, a.bInvert); } },
+	{ "rgba2bgra",          4, 4, false, false, -1, [](const CopyArgs& a) { a.copy->rgba2bgra(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "rgba2bgra pitch",    4, 4, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2bgra(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgba2bgra dpitch",   4, 4, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2bgra(a.src, a.dst, a.width, a.height, a.srcPitch, a.dstPitch, a.bInvert); } },
+	{ "bgra2rgba",          4, 4, false, false, -1, [](const CopyArgs& a) { a.copy->bgra2rgba(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "rgba2rgb pitch",     4, 3, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2rgb(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgba2rgb swap",      4, 3, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2rgb(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert, false, true); } },
+	{ "rgba2rgb mirror",    4, 3, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2rgb(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert, true, false); } },
+	{ "rgba2bgr pitch",     4, 3, true,  false, -1, [](const CopyArgs& a) { a.copy->rgba2bgr(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgba2rgbResample",   4, 3, true,  true,  -1, [](const CopyArgs& a) { a.copy->rgba2rgbResample(a.src, a.dst, a.width, a.height, a.srcPitch, a.dstWidth, a.dstHeight, a.bInvert); } },
+	{ "rgba2bgrResample",   4, 3, true,  true,  -1, [](const CopyArgs& a) { a.copy->rgba2bgrResample(a.src, a.dst, a.width, a.height, a.srcPitch, a.dstWidth, a.dstHeight, a.bInvert); } },
+	{ "rgb2rgba",           3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->rgb2rgba(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "rgb2rgba dpitch",    3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->rgb2rgba(a.src, a.dst, a.width, a.height, a.dstPitch, a.bInvert); } },
+	{ "bgr2rgba",           3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->bgr2rgba(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "bgr2rgba dpitch",    3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->bgr2rgba(a.src, a.dst, a.width, a.height, a.dstPitch, a.bInvert); } },
+	{ "rgb2bgra",           3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->rgb2bgra(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "rgb2bgra dpitch",    3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->rgb2bgra(a.src, a.dst, a.width, a.height, a.dstPitch, a.bInvert); } },
+	{ "bgr2bgra",           3, 4, false, false, -1, [](const CopyArgs& a) { a.copy->bgr2bgra(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "rgba2bgr",           4, 3, false, false, -1, [](const CopyArgs& a) { a.copy->rgba2bgr(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "bgra2rgb",           4, 3, false, false, -1, [](const CopyArgs& a) { a.copy->bgra2rgb(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	{ "bgra2bgr",           4, 3, false, false, -1, [](const CopyArgs& a) { a.copy->bgra2bgr(a.src, a.dst, a.width, a.height, a.bInvert); } },
+	// Specific instruction sets
+	{ "memcpy_sse2",        4, 4, false, false, SPOUT_COPY_SSE2, [](const CopyArgs& a) { a.copy->memcpy_sse2(a.dst, a.src, (size_t)a.width*a.height*4); } },
+	{ "memcpy_avx2",        4, 4, false, false, SPOUT_COPY_AVX2, [](const CopyArgs& a) { a.copy->memcpy_avx2(a.dst, a.src, (size_t)a.width*a.height*4); } },
+	{ "rgba_to_rgb_sse3",   4, 3, true,  false, SPOUT_COPY_SSSE3, [](const CopyArgs& a) { a.copy->rgba_to_rgb_sse3(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgba_to_rgb_avx2",   4, 3, true,  false, SPOUT_COPY_AVX2, [](const CopyArgs& a) { a.copy->rgba_to_rgb_avx2(a.src, a.dst, a.width, a.height, a.srcPitch, a.bInvert); } },
+	{ "rgb_to_rgba_avx2",   3, 4, false, false, SPOUT_COPY_AVX2, [](const CopyArgs& a) { a.copy->rgb_to_rgba_avx2(a.src, a.dst, a.width, a.height, a.width*4, a.bInvert); } },
+};
+
+static const char* const g_LevelNames[] = { "scalar", "sse2", "sse3", "ssse3", "avx2", "avx512" };
+static const unsigned int g_Sizes[][2] = { {640, 480}, {1280, 720}, {1917, 1080}, {1920, 1080}, {3840, 2160} };
+
+static double CounterFrequency()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceFrequency(&li);
+	return static_cast<double>(li.QuadPart)/1000.0; // counts per msec
+}
+
+static LONG64 Counter()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceCounter(&li);
+	return li.QuadPart;
+}
+
+// Median msec of repeated calls
+template <typename F>
+static double TimeCalls(const F& func, double frequency)
+{
+	// Warm up caches and thread pool
+	func();
+	func();
+
+	std::vector<double> times;
+	double total = 0.0;
+	while (times.size() < COPY_BENCH_MAX_CALLS
+		&& (times.size() < COPY_BENCH_MIN_CALLS || total < COPY_BENCH_MSEC)) {
+		const LONG64 start = Counter();
+		func();
+		const double msec = static_cast<double>(Counter()-start)/frequency;
+		times.push_back(msec);
+		total += msec;
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size()/2];
+}
+
+// GB/s for bytes processed in msec
+static double Throughput(double bytes, double msec)
+{
+	return (msec > 0.0) ? bytes/(msec*1.0e6) : 0.0;
+}
+
+static bool ListContains(const char* list, const char* item)
+{
+	if (!list)
+		return true;
+	std::string str = ",";
+	str += list;
+	str += ",";
+	std::string find = ",";
+	find += item;
+	find += ",";
+	return (str.find(find) != std::string::npos);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* funcname = nullptr;
+	const char* sizes = nullptr;
+	const char* csvpath = nullptr;
+	int nThreads = 1;
+	bool bQuick = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-func") == 0 && i+1 < argc)
+			funcname = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0 && i+1 < argc)
+			sizes = argv[++i];
+		else if (strcmp(argv[i], "-threads") == 0 && i+1 < argc)
+			nThreads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-csv") == 0 && i+1 < argc)
+			csvpath = argv[++i];
+		else if (strcmp(argv[i], "-quick") == 0)
+			bQuick = true;
+		else {
+			printf("SpoutCopyBenchmark [-func name] [-size 1920x1080,...] [-threads n] [-quick] [-csv file]\n");
+			return 1;
+		}
+	}
+	if (bQuick && !sizes)
+		sizes = "1920x1080";
+
+	spoutCopy copy;
+	copy.SetCopyThreads(nThreads);
+	const SpoutCopyLevel maxLevel = copy.GetInstructionLevel();
+	const double frequency = CounterFrequency();
+
+	printf("Instruction level %s, %d copy threads\n", g_LevelNames[maxLevel], copy.GetCopyThreads());
+
+	FILE* csv = nullptr;
+	if (csvpath && fopen_s(&csv, csvpath, "w") == 0 && csv)
+		fprintf(csv, "function,level,width,height,align,pitch,invert,msec,GBps,memcpy\n");
+
+	// Largest buffers with padding and alignment offset
+	size_t maxBytes = 0;
+	for (int s = 0; s < _countof(g_Sizes); s++) {
+		const size_t bytes = (size_t)(g_Sizes[s][0]*4 + 256)*g_Sizes[s][1];
+		if (bytes > maxBytes) maxBytes = bytes;
+	}
+	unsigned char* srcBuffer = static_cast<unsigned char*>(_aligned_malloc(maxBytes + 64, 64));
+	unsigned char* dstBuffer = static_cast<unsigned char*>(_aligned_malloc(maxBytes + 64, 64));
+	if (!srcBuffer || !dstBuffer) {
+		printf("Buffer allocation failed\n");
+		return 1;
+	}
+	for (size_t i = 0; i < maxBytes + 64; i++)
+		srcBuffer[i] = (unsigned char)(i % 251);
+	memset(dstBuffer, 0, maxBytes + 64);
+
+	printf("%-20s %-7s %-10s %5s %5s %6s %8s %8s %8s\n",
+		"function", "level", "size", "align", "pitch", "invert", "msec", "GB/s", "memcpy %");
+
+	for (int s = 0; s < _countof(g_Sizes); s++) {
+
+		const unsigned int width = g_Sizes[s][0];
+		const unsigned int height = g_Sizes[s][1];
+		char size[32]={};
+		sprintf_s(size, 32, "%ux%u", width, height);
+		if (!ListContains(sizes, size))
+			continue;
+
+		// memcpy baseline for an RGBA image
+		const size_t imageBytes = (size_t)width*height*4;
+		const double memcpyMsec = TimeCalls([&]() { memcpy(dstBuffer, srcBuffer, imageBytes); }, frequency);
+		const double memcpyRate = Throughput(2.0*static_cast<double>(imageBytes), memcpyMsec);
+		printf("%-20s %-7s %-10s %5d %5d %6s %8.3f %8.2f %8.0f\n",
+			"memcpy", "crt", size, 64, 0, "-", memcpyMsec, memcpyRate, 100.0);
+		if (csv)
+			fprintf(csv, "memcpy,crt,%u,%u,64,0,0,%.4f,%.3f,100\n", width, height, memcpyMsec, memcpyRate);
+
+		for (int c = 0; c < _countof(g_Converters); c++) {
+
+			const Converter& conv = g_Converters[c];
+			if (funcname && !strstr(conv.name, funcname))
+				continue;
+
+			// Specific functions once if the instructions are available
+			const int firstLevel = (conv.level < 0) ? 0 : (int)maxLevel;
+			if (conv.level > (int)maxLevel)
+				continue;
+
+			for (int level = firstLevel; level <= (int)maxLevel; level++) {
+				copy.SetInstructionLevel((SpoutCopyLevel)level);
+				for (int align = 0; align < (bQuick ? 1 : 2); align++) {
+					const unsigned int offset = align*16;
+					for (int pad = 0; pad < ((conv.bPitch && !bQuick) ? 2 : 1); pad++) {
+						for (int invert = 0; invert < 2; invert++) {
+
+							CopyArgs args={};
+							args.copy = &copy;
+							args.src = srcBuffer + offset;
+							args.dst = dstBuffer + offset;
+							args.width = width;
+							args.height = height;
+							args.srcPitch = width*conv.srcBytes + pad*256;
+							args.dstPitch = width*conv.dstBytes;
+							args.dstWidth = conv.bResample ? (width*3/4) & ~3u : width;
+							args.dstHeight = conv.bResample ? height*3/4 : height;
+							args.bInvert = (invert == 1);
+
+							const double bytes = static_cast<double>((size_t)width*height*conv.srcBytes)
+								+ static_cast<double>((size_t)args.dstWidth*args.dstHeight*conv.dstBytes);
+							const double msec = TimeCalls([&]() { conv.func(args); }, frequency);
+							const double rate = Throughput(bytes, msec);
+							const double percent = (memcpyRate > 0.0) ? rate*100.0/memcpyRate : 0.0;
+
+							printf("%-20s %-7s %-10s %5u %5u %6s %8.3f %8.2f %8.0f\n",
+								conv.name, g_LevelNames[level], size, offset ? 16u : 64u, pad*256,
+								args.bInvert ? "yes" : "no", msec, rate, percent);
+							if (csv)
+								fprintf(csv, "%s,%s,%u,%u,%u,%u,%d,%.4f,%.3f,%.1f\n",
+									conv.name, g_LevelNames[level], width, height, offset ? 16u : 64u, pad*256,
+									invert, msec, rate, percent);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	copy.SetInstructionLevel();
+
+	if (csv)
+		fclose(csv);
+	_aligned_free(srcBuffer);
+	_aligned_free(dstBuffer);
+
+	return 0;
+}
@@ -0,0 +1,848 @@
+/*
+
+					SpoutLatency.cpp
+
+		Glass to glass latency of sender/receiver process pairs
+
+	Usage :
+
+		SpoutLatency [-mode dx11,gldx,cpu,memory] [-path texture,image]
+		             [-size 1920x1080] [-fps n] [-frames n]
+		             [-adapter sender,receiver] [-csv file]
+
+	With no arguments, every share mode is measured for both receive paths
+	at 1920x1080 and 60 fps with the default graphics adapter.
+
+	For each combination a sender and a receiver process are started
+	with the same executable and sender name, as for SpoutBenchmark.
+
+	The sender tags every frame with the frame number and the performance
+	counter at the time of sending. The tag is written to the top rows of
+	the texture as 8x8 blocks of white or black pixels, so it survives the
+	texture copies and pixel conversions of every share mode.
+
+	The receiver decodes the tag after each receive and the latency is the
+	performance counter at that time less the sender counter. The counter
+	is system wide, so sender and receiver times can be compared directly.
+
+		dx11   - spoutDX SendTexture / ReceiveTexture or ReceiveImage
+		gldx   - OpenGL/DirectX interop SendTexture / ReceiveTexture or ReceiveImage
+		cpu    - CPU share (SetCPUshare)
+		memory - Memory share (SetMemoryShareMode)
+
+		texture - the received texture. The tag rows are read back after the
+		          receive, so the time includes a small GPU copy and map.
+		image   - ReceiveImage to an rgba pixel buffer
+
+	For dx11, -adapter selects the sender and receiver graphics adapters.
+	A receiver on a different adapter to the sender uses SetAdapterBridge.
+
+	Reported for each combination :
+
+		frames     - tagged frames received
+		dropped    - sender frames not received (gaps in the frame numbers)
+		min, p50, p90, p99, max, mean - sender to receiver msec
+
+	Memory share and frame counting are user registry settings.
+	They are set for the child processes and restored afterwards,
+	so other Spout applications should be closed while the measurement runs.
+
+	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+	========================
+
+	15.10.26 - first version
+
+*/
+
+#include "SpoutDX.h"
+#include "SpoutSender.h"
+#include "SpoutReceiver.h"
+#include <algorithm> // for std::sort
+
+// Frames received before measurement starts
+#define LATENCY_WARMUP 30
+// Maximum msec for a receiver to connect
+#define LATENCY_CONNECT_TIMEOUT 5000
+
+// Frame tag - frame number (32 bits) and performance counter (64 bits)
+// Each bit is a block of 8x8 pixels along the top of the texture.
+#define TAG_BITS 96
+#define TAG_BLOCK 8
+#define TAG_WIDTH (TAG_BITS*TAG_BLOCK)
+
+struct LatencyConfig {
+	char mode[16];
+	char path[16];
+	unsigned int width;
+	unsigned int height;
+	unsigned int fps;
+	int senderadapter; // -1 for the default adapter
+	int receiveradapter;
+};
+
+struct LatencyResult {
+	bool bValid;
+	LONG64 frames;
+	LONG64 dropped;
+	double minmsec;
+	double p50;
+	double p90;
+	double p99;
+	double maxmsec;
+	double mean;
+};
+
+static const char* const g_Modes[] = { "dx11", "gldx", "cpu", "memory" };
+static const char* const g_Paths[] = { "texture", "image" };
+
+//
+// Timing
+//
+
+static double CounterFrequency()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceFrequency(&li);
+	return static_cast<double>(li.QuadPart)/1000.0; // counts per msec
+}
+
+static LONG64 Counter()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceCounter(&li);
+	return li.QuadPart;
+}
+
+// Nearest rank percentile of sorted values
+static double Percentile(const std::vector<double>& sorted, unsigned int percent)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = (sorted.size()*percent + 99)/100;
+	if (rank < 1) rank = 1;
+	if (rank > sorted.size()) rank = sorted.size();
+	return sorted[rank-1];
+}
+
+static bool StopSignalled(HANDLE hStop)
+{
+	return (hStop && WaitForSingleObject(hStop, 0) == WAIT_OBJECT_0);
+}
+
+// Wait for the time of the next frame at the sender frame rate
+static void WaitFrame(LONG64 start, LONG64 frames, double frequency, unsigned int fps)
+{
+	const LONG64 next = start + (LONG64)(frequency*1000.0*static_cast<double>(frames)/static_cast<double>(fps));
+	while (Counter() < next) {
+		if ((double)(next - Counter()) > frequency*2.0)
+			Sleep(1);
+		else
+			YieldProcessor();
+	}
+}
+
+//
+// Frame tag
+//
+
+// Write the tag to rgba pixels of TAG_WIDTH x TAG_BLOCK
+static void EncodeTag(unsigned char* strip, DWORD frame, LONG64 counter)
+{
+	for (unsigned int bit = 0; bit < TAG_BITS; bit++) {
+		bool bSet = false;
+		if (bit < 32)
+			bSet = ((frame >> bit) & 1) != 0;
+		else
+			bSet = ((static_cast<unsigned __int64>(counter) >> (bit-32)) & 1) != 0;
+		const unsigned char value = bSet ? 255 : 0;
+		for (unsigned int y = 0; y < TAG_BLOCK; y++) {
+			unsigned char* p = strip + ((size_t)y*TAG_WIDTH + (size_t)bit*TAG_BLOCK)*4;
+			for (unsigned int x = 0; x < TAG_BLOCK; x++) {
+				p[0] = value;
+				p[1] = value;
+				p[2] = value;
+				p[3] = 255;
+				p += 4;
+			}
+		}
+	}
+}
+
+// Read the tag from the centre of each block of a pixel row
+// rgba or bgra, the green channel is the same for both
+static bool DecodeTag(const unsigned char* row, DWORD& frame, LONG64& counter)
+{
+	unsigned __int64 value = 0;
+	frame = 0;
+	for (unsigned int bit = 0; bit < TAG_BITS; bit++) {
+		const bool bSet = row[((size_t)bit*TAG_BLOCK + TAG_BLOCK/2)*4 + 1] > 127;
+		if (!bSet)
+			continue;
+		if (bit < 32)
+			frame |= (1UL << bit);
+		else
+			value |= (1ULL << (bit-32));
+	}
+	counter = static_cast<LONG64>(value);
+	// No tag yet, or a counter from the future
+	return (counter > 0 && counter <= Counter());
+}
+
+// Decode from the top of a pixel buffer, or the bottom if it is inverted
+static bool DecodeImage(const unsigned char* pixels, unsigned int width, unsigned int height,
+	DWORD& frame, LONG64& counter)
+{
+	if (DecodeTag(pixels + (size_t)(TAG_BLOCK/2)*width*4, frame, counter))
+		return true;
+	return DecodeTag(pixels + (size_t)(height-1-TAG_BLOCK/2)*width*4, frame, counter);
+}
+
+//
+// Sender process
+//
+// Sends tagged frames at the frame rate until the stop event is set.
+//
+
+static bool RunSenderDX(const LatencyConfig& config, const char* name, HANDLE hStop, LONG64& frames)
+{
+	spoutDX sender;
+	if (config.senderadapter >= 0 && !sender.SetAdapter(config.senderadapter))
+		return false;
+	if (!sender.OpenDirectX11())
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = config.width;
+	desc.Height = config.height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+	ID3D11Texture2D* pTexture = nullptr;
+	ID3D11RenderTargetView* pView = nullptr;
+	if (FAILED(sender.GetDX11Device()->CreateTexture2D(&desc, nullptr, &pTexture))
+		|| FAILED(sender.GetDX11Device()->CreateRenderTargetView(pTexture, nullptr, &pView))) {
+		if (pTexture) pTexture->Release();
+		return false;
+	}
+
+	sender.SetSenderFormat(DXGI_FORMAT_R8G8B8A8_UNORM);
+	sender.SetSenderName(name);
+
+	std::vector<unsigned char> strip((size_t)TAG_WIDTH*TAG_BLOCK*4);
+	const D3D11_BOX box = { 0, 0, 0, TAG_WIDTH, TAG_BLOCK, 1 };
+
+	const double frequency = CounterFrequency();
+	const LONG64 start = Counter();
+	frames = 0;
+	while (!StopSignalled(hStop)) {
+		WaitFrame(start, frames, frequency, config.fps);
+		// Change the texture every frame
+		const float level = static_cast<float>(frames % 256)/255.0f;
+		const float color[4] = { level, 0.5f, 1.0f-level, 1.0f };
+		sender.GetDX11Context()->ClearRenderTargetView(pView, color);
+		// Tag with the frame number and the time of sending
+		EncodeTag(strip.data(), (DWORD)(frames+1), Counter());
+		sender.GetDX11Context()->UpdateSubresource(pTexture, 0, &box, strip.data(), TAG_WIDTH*4, 0);
+		if (!sender.SendTexture(pTexture))
+			break;
+		frames++;
+	}
+
+	sender.ReleaseSender();
+	pView->Release();
+	pTexture->Release();
+	sender.CloseDirectX11();
+
+	return (frames > 0);
+}
+
+static bool RunSenderGL(const LatencyConfig& config, const char* name, HANDLE hStop, LONG64& frames)
+{
+	SpoutSender sender;
+	if (!sender.CreateOpenGL())
+		return false;
+
+	if (strcmp(config.mode, "cpu") == 0)
+		sender.SetCPUshare(true);
+
+	// Texture with a pattern
+	std::vector<unsigned char> pixels((size_t)config.width*config.height*4);
+	for (size_t i = 0; i < pixels.size(); i++)
+		pixels[i] = (unsigned char)(i % 251);
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, config.width, config.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	sender.SetSenderName(name);
+
+	std::vector<unsigned char> strip((size_t)TAG_WIDTH*TAG_BLOCK*4);
+
+	const double frequency = CounterFrequency();
+	const LONG64 start = Counter();
+	frames = 0;
+	while (!StopSignalled(hStop)) {
+		WaitFrame(start, frames, frequency, config.fps);
+		// Tag with the frame number and the time of sending
+		// The texture is sent without invert so that the tag stays at the top
+		EncodeTag(strip.data(), (DWORD)(frames+1), Counter());
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TAG_WIDTH, TAG_BLOCK, GL_RGBA, GL_UNSIGNED_BYTE, strip.data());
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (!sender.SendTexture(texture, GL_TEXTURE_2D, config.width, config.height, false))
+			break;
+		frames++;
+	}
+
+	sender.ReleaseSender();
+	glDeleteTextures(1, &texture);
+	sender.CloseOpenGL();
+
+	return (frames > 0);
+}
+
+//
+// Receiver process
+//
+// Receives until the number of tagged frames after warmup and writes the results.
+//
+
+// Collects the latency of each decoded tag
+class LatencyRecord {
+
+	public:
+
+		LatencyRecord(unsigned int nFrames)
+		{
+			m_frequency = CounterFrequency();
+			m_msec.reserve(nFrames);
+		}
+
+		// Returns false during warmup
+		bool Add(DWORD frame, LONG64 counter, LONG64 received)
+		{
+			// The same frame again
+			if (frame == m_lastframe)
+				return false;
+			if (m_warmup < LATENCY_WARMUP) {
+				m_warmup++;
+				m_lastframe = frame;
+				return false;
+			}
+			if (frame > m_lastframe)
+				m_dropped += (LONG64)(frame - m_lastframe - 1);
+			m_lastframe = frame;
+			m_msec.push_back(static_cast<double>(received - counter)/m_frequency);
+			return true;
+		}
+
+		size_t Count()
+		{
+			return m_msec.size();
+		}
+
+		void Result(LatencyResult& result)
+		{
+			result = {};
+			result.frames = (LONG64)m_msec.size();
+			result.dropped = m_dropped;
+			if (m_msec.empty())
+				return;
+			std::sort(m_msec.begin(), m_msec.end());
+			double total = 0.0;
+			for (size_t i = 0; i < m_msec.size(); i++)
+				total += m_msec[i];
+			result.mean = total/static_cast<double>(m_msec.size());
+			result.minmsec = m_msec.front();
+			result.maxmsec = m_msec.back();
+			result.p50 = Percentile(m_msec, 50);
+			result.p90 = Percentile(m_msec, 90);
+			result.p99 = Percentile(m_msec, 99);
+			result.bValid = true;
+		}
+
+	private:
+
+		double m_frequency = 1.0;
+		std::vector<double> m_msec;
+		DWORD m_lastframe = 0;
+		unsigned int m_warmup = 0;
+		LONG64 m_dropped = 0;
+
+};
+
+// Msec for the number of frames at the sender rate, with a margin
+static double RunMsec(const LatencyConfig& config, unsigned int nFrames)
+{
+	const double msec = static_cast<double>(nFrames + LATENCY_WARMUP)*1000.0/static_cast<double>(config.fps);
+	return msec*2.0 + LATENCY_CONNECT_TIMEOUT;
+}
+
+static LONG64 RunTimeout(const LatencyConfig& config, unsigned int nFrames, double frequency)
+{
+	return (LONG64)(frequency*RunMsec(config, nFrames));
+}
+
+static bool RunReceiverDX(const LatencyConfig& config, const char* name, unsigned int nFrames, LatencyResult& result)
+{
+	spoutDX receiver;
+	if (config.receiveradapter >= 0 && !receiver.SetAdapter(config.receiveradapter))
+		return false;
+	// A sender on a different adapter is received by way of system memory
+	if (config.receiveradapter != config.senderadapter)
+		receiver.SetAdapterBridge(true);
+	if (!receiver.OpenDirectX11())
+		return false;
+
+	receiver.SetReceiverName(name);
+
+	const bool bImage = (strcmp(config.path, "image") == 0);
+	ID3D11Texture2D* pTexture = nullptr;
+	ID3D11Texture2D* pStaging = nullptr; // Tag rows of the received texture
+	std::vector<unsigned char> pixels;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	LatencyRecord record(nFrames);
+
+	const double frequency = CounterFrequency();
+	const LONG64 timeout = Counter() + RunTimeout(config, nFrames, frequency);
+
+	while (record.Count() < nFrames && Counter() < timeout) {
+		bool bReceived = false;
+		if (bImage)
+			bReceived = receiver.ReceiveImage(pixels.empty() ? nullptr : pixels.data(), width, height);
+		else
+			bReceived = receiver.ReceiveTexture(&pTexture);
+		if (receiver.IsUpdated()) {
+			width = receiver.GetSenderWidth();
+			height = receiver.GetSenderHeight();
+			if (bImage) {
+				pixels.resize((size_t)width*height*4);
+			}
+			else {
+				// Receiving texture the same size and format as the sender
+				if (pTexture) pTexture->Release();
+				pTexture = nullptr;
+				receiver.spoutdx.CreateDX11Texture(receiver.GetDX11Device(),
+					width, height, receiver.GetSenderFormat(), &pTexture);
+				if (!pStaging) {
+					D3D11_TEXTURE2D_DESC desc={};
+					desc.Width = TAG_WIDTH;
+					desc.Height = TAG_BLOCK;
+					desc.MipLevels = 1;
+					desc.ArraySize = 1;
+					desc.Format = (DXGI_FORMAT)receiver.GetSenderFormat();
+					desc.SampleDesc.Count = 1;
+					desc.Usage = D3D11_USAGE_STAGING;
+					desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+					receiver.GetDX11Device()->CreateTexture2D(&desc, nullptr, &pStaging);
+				}
+			}
+			continue;
+		}
+		if (!bReceived || !receiver.IsFrameNew() || width < TAG_WIDTH || height < TAG_BLOCK) {
+			YieldProcessor();
+			continue;
+		}
+
+		DWORD frame = 0;
+		LONG64 counter = 0;
+		bool bDecoded = false;
+		if (bImage) {
+			bDecoded = DecodeImage(pixels.data(), width, height, frame, counter);
+		}
+		else if (pTexture && pStaging) {
+			// Map waits for the copy of the received texture
+			const D3D11_BOX box = { 0, 0, 0, TAG_WIDTH, TAG_BLOCK, 1 };
+			receiver.GetDX11Context()->CopySubresourceRegion(pStaging, 0, 0, 0, 0, pTexture, 0, &box);
+			D3D11_MAPPED_SUBRESOURCE mapped={};
+			if (SUCCEEDED(receiver.GetDX11Context()->Map(pStaging, 0, D3D11_MAP_READ, 0, &mapped))) {
+				bDecoded = DecodeTag(static_cast<const unsigned char*>(mapped.pData)
+					+ (size_t)mapped.RowPitch*(TAG_BLOCK/2), frame, counter);
+				receiver.GetDX11Context()->Unmap(pStaging, 0);
+			}
+		}
+		if (bDecoded)
+			record.Add(frame, counter, Counter());
+	}
+
+	record.Result(result);
+
+	if (pStaging) pStaging->Release();
+	if (pTexture) pTexture->Release();
+	receiver.ReleaseReceiver();
+	receiver.CloseDirectX11();
+
+	return result.bValid;
+}
+
+static bool RunReceiverGL(const LatencyConfig& config, const char* name, unsigned int nFrames, LatencyResult& result)
+{
+	SpoutReceiver receiver;
+	if (!receiver.CreateOpenGL())
+		return false;
+
+	if (strcmp(config.mode, "cpu") == 0)
+		receiver.SetCPUshare(true);
+
+	receiver.SetReceiverName(name);
+
+	const bool bImage = (strcmp(config.path, "image") == 0);
+	GLuint texture = 0;
+	GLuint fbo = 0; // For reading the tag rows of the received texture
+	glGenTextures(1, &texture);
+	glGenFramebuffersEXT(1, &fbo);
+	std::vector<unsigned char> pixels;
+	std::vector<unsigned char> strip((size_t)TAG_WIDTH*TAG_BLOCK*4);
+	unsigned int width = 0;
+	unsigned int height = 0;
+	bool bTexture = false;
+	LatencyRecord record(nFrames);
+
+	const double frequency = CounterFrequency();
+	const LONG64 timeout = Counter() + RunTimeout(config, nFrames, frequency);
+
+	while (record.Count() < nFrames && Counter() < timeout) {
+		bool bReceived = false;
+		if (bImage)
+			bReceived = receiver.ReceiveImage(pixels.empty() ? nullptr : pixels.data(), GL_RGBA);
+		else
+			bReceived = receiver.ReceiveTexture(bTexture ? texture : 0, GL_TEXTURE_2D);
+		if (receiver.IsUpdated()) {
+			width = receiver.GetSenderWidth();
+			height = receiver.GetSenderHeight();
+			if (bImage) {
+				pixels.resize((size_t)width*height*4);
+			}
+			else {
+				// Receiving texture the same size as the sender
+				glBindTexture(GL_TEXTURE_2D, texture);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				bTexture = true;
+			}
+			continue;
+		}
+		if (!bReceived || !receiver.IsFrameNew() || width < TAG_WIDTH || height < TAG_BLOCK) {
+			YieldProcessor();
+			continue;
+		}
+
+		DWORD frame = 0;
+		LONG64 counter = 0;
+		bool bDecoded = false;
+		if (bImage) {
+			bDecoded = DecodeImage(pixels.data(), width, height, frame, counter);
+		}
+		else if (bTexture) {
+			// glReadPixels waits for the copy to the received texture
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+			glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, texture, 0);
+			glReadPixels(0, 0, TAG_WIDTH, TAG_BLOCK, GL_RGBA, GL_UNSIGNED_BYTE, strip.data());
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+			bDecoded = DecodeTag(strip.data() + (size_t)(TAG_BLOCK/2)*TAG_WIDTH*4, frame, counter);
+		}
+		if (bDecoded)
+			record.Add(frame, counter, Counter());
+	}
+
+	record.Result(result);
+
+	receiver.ReleaseReceiver();
+	glDeleteFramebuffersEXT(1, &fbo);
+	glDeleteTextures(1, &texture);
+	receiver.CloseOpenGL();
+
+	return result.bValid;
+}
+
+//
+// Controller
+//
+
+// mode path width height fps senderadapter receiveradapter
+static bool ParseConfig(int argc, char* argv[], int first, LatencyConfig& config)
+{
+	if (argc < first+7)
+		return false;
+	strcpy_s(config.mode, 16, argv[first]);
+	strcpy_s(config.path, 16, argv[first+1]);
+	config.width  = (unsigned int)atoi(argv[first+2]);
+	config.height = (unsigned int)atoi(argv[first+3]);
+	config.fps    = (unsigned int)atoi(argv[first+4]);
+	config.senderadapter   = atoi(argv[first+5]);
+	config.receiveradapter = atoi(argv[first+6]);
+	return (config.width >= TAG_WIDTH && config.height >= TAG_BLOCK && config.fps > 0);
+}
+
+static HANDLE StartProcess(const char* args)
+{
+	char path[MAX_PATH]={};
+	GetModuleFileNameA(NULL, path, MAX_PATH);
+
+	char cmdline[1024]={};
+	sprintf_s(cmdline, 1024, "\"%s\" %s", path, args);
+
+	STARTUPINFOA si={};
+	si.cb = sizeof(si);
+	PROCESS_INFORMATION pi={};
+	if (!CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi))
+		return NULL;
+	CloseHandle(pi.hThread);
+	return pi.hProcess;
+}
+
+// Run a sender and receiver pair and read the receiver results
+static bool RunConfig(const LatencyConfig& config, unsigned int nFrames, LatencyResult& result)
+{
+	char name[64]={};
+	char stopname[80]={};
+	char receiverfile[MAX_PATH]={};
+	char temppath[MAX_PATH]={};
+	char configargs[256]={};
+	char args[512]={};
+
+	result = {};
+
+	GetTempPathA(MAX_PATH, temppath);
+	sprintf_s(name, 64, "SpoutLatency_%lu", GetCurrentProcessId());
+	sprintf_s(stopname, 80, "%s_stop", name);
+	sprintf_s(receiverfile, MAX_PATH, "%s%s_receiver.txt", temppath, name);
+	DeleteFileA(receiverfile);
+
+	HANDLE hStop = CreateEventA(NULL, TRUE, FALSE, stopname);
+	if (!hStop)
+		return false;
+
+	sprintf_s(configargs, 256, "%s %s %u %u %u %d %d", config.mode, config.path,
+		config.width, config.height, config.fps, config.senderadapter, config.receiveradapter);
+
+	sprintf_s(args, 512, "-sender %s %s", configargs, name);
+	HANDLE hSender = StartProcess(args);
+	if (!hSender) {
+		CloseHandle(hStop);
+		return false;
+	}
+
+	sprintf_s(args, 512, "-receiver %s %s \"%s\" %u", configargs, name, receiverfile, nFrames);
+	HANDLE hReceiver = StartProcess(args);
+	if (hReceiver) {
+		if (WaitForSingleObject(hReceiver, (DWORD)RunMsec(config, nFrames) + LATENCY_CONNECT_TIMEOUT) != WAIT_OBJECT_0)
+			TerminateProcess(hReceiver, 1);
+		CloseHandle(hReceiver);
+	}
+
+	SetEvent(hStop);
+	if (WaitForSingleObject(hSender, LATENCY_CONNECT_TIMEOUT) != WAIT_OBJECT_0)
+		TerminateProcess(hSender, 1);
+	CloseHandle(hSender);
+	CloseHandle(hStop);
+
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, receiverfile, "r") == 0 && fp) {
+		long long frames = 0;
+		long long dropped = 0;
+		if (fscanf_s(fp, "%lld %lld %lf %lf %lf %lf %lf %lf", &frames, &dropped,
+			&result.minmsec, &result.p50, &result.p90, &result.p99, &result.maxmsec, &result.mean) == 8) {
+			result.frames = frames;
+			result.dropped = dropped;
+			result.bValid = (frames > 0);
+		}
+		fclose(fp);
+	}
+	DeleteFileA(receiverfile);
+
+	return result.bValid;
+}
+
+static bool ListContains(const char* list, const char* item)
+{
+	if (!list)
+		return true;
+	std::string str = ",";
+	str += list;
+	str += ",";
+	std::string find = ",";
+	find += item;
+	find += ",";
+	return (str.find(find) != std::string::npos);
+}
+
+static int RunLatency(const char* modes, const char* paths, const LatencyConfig& base,
+	unsigned int nFrames, const char* csvpath)
+{
+	// Registry settings used by the child processes
+	DWORD dwMemory = 0;
+	DWORD dwFramecount = 0;
+	const bool bMemoryKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", &dwMemory);
+	const bool bCountKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", &dwFramecount);
+	WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", 1);
+
+	FILE* csv = nullptr;
+	if (csvpath) {
+		if (fopen_s(&csv, csvpath, "w") == 0 && csv)
+			fprintf(csv, "mode,path,width,height,fps,senderadapter,receiveradapter,frames,dropped,min,p50,p90,p99,max,mean\n");
+	}
+
+	char size[32]={};
+	sprintf_s(size, 32, "%ux%u", base.width, base.height);
+	printf("%-7s %-8s %-10s %7s %7s %8s %8s %8s %8s %8s %8s\n",
+		"mode", "path", "size", "frames", "dropped", "min", "p50", "p90", "p99", "max", "mean");
+
+	int failed = 0;
+	for (int m = 0; m < _countof(g_Modes); m++) {
+		if (!ListContains(modes, g_Modes[m]))
+			continue;
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare",
+			(strcmp(g_Modes[m], "memory") == 0) ? 1 : 0);
+		for (int p = 0; p < _countof(g_Paths); p++) {
+			if (!ListContains(paths, g_Paths[p]))
+				continue;
+			LatencyConfig config = base;
+			strcpy_s(config.mode, 16, g_Modes[m]);
+			strcpy_s(config.path, 16, g_Paths[p]);
+			LatencyResult result={};
+			if (RunConfig(config, nFrames, result)) {
+				printf("%-7s %-8s %-10s %7lld %7lld %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+					config.mode, config.path, size, result.frames, result.dropped,
+					result.minmsec, result.p50, result.p90, result.p99, result.maxmsec, result.mean);
+				if (csv)
+					fprintf(csv, "%s,%s,%u,%u,%u,%d,%d,%lld,%lld,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+						config.mode, config.path, config.width, config.height, config.fps,
+						config.senderadapter, config.receiveradapter, result.frames, result.dropped,
+						result.minmsec, result.p50, result.p90, result.p99, result.maxmsec, result.mean);
+			}
+			else {
+				printf("%-7s %-8s %-10s   failed\n", config.mode, config.path, size);
+				failed++;
+			}
+		}
+	}
+
+	if (csv)
+		fclose(csv);
+
+	// Restore registry settings
+	if (bMemoryKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", dwMemory);
+	else
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", 0);
+	if (bCountKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", dwFramecount);
+
+	return (failed > 0) ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	LatencyConfig config={};
+
+	// Sender process
+	// -sender mode path width height fps senderadapter receiveradapter name
+	if (argc > 1 && strcmp(argv[1], "-sender") == 0) {
+		if (!ParseConfig(argc, argv, 2, config) || argc < 10)
+			return 1;
+		HANDLE hStop = OpenEventA(SYNCHRONIZE, FALSE, (std::string(argv[9]) + "_stop").c_str());
+		LONG64 frames = 0;
+		bool bResult = false;
+		if (strcmp(config.mode, "dx11") == 0)
+			bResult = RunSenderDX(config, argv[9], hStop, frames);
+		else
+			bResult = RunSenderGL(config, argv[9], hStop, frames);
+		if (hStop) CloseHandle(hStop);
+		return bResult ? 0 : 1;
+	}
+
+	// Receiver process
+	// -receiver mode path width height fps senderadapter receiveradapter name file frames
+	if (argc > 1 && strcmp(argv[1], "-receiver") == 0) {
+		if (!ParseConfig(argc, argv, 2, config) || argc < 12)
+			return 1;
+		LatencyResult result={};
+		bool bResult = false;
+		if (strcmp(config.mode, "dx11") == 0)
+			bResult = RunReceiverDX(config, argv[9], (unsigned int)atoi(argv[11]), result);
+		else
+			bResult = RunReceiverGL(config, argv[9], (unsigned int)atoi(argv[11]), result);
+		FILE* fp = nullptr;
+		if (bResult && fopen_s(&fp, argv[10], "w") == 0 && fp) {
+			fprintf(fp, "%lld %lld %.6f %.6f %.6f %.6f %.6f %.6f\n", result.frames, result.dropped,
+				result.minmsec, result.p50, result.p90, result.p99, result.maxmsec, result.mean);
+			fclose(fp);
+		}
+		return bResult ? 0 : 1;
+	}
+
+	// Controller
+	const char* modes = nullptr;
+	const char* paths = nullptr;
+	const char* csvpath = nullptr;
+	unsigned int nFrames = 600;
+	config.width = 1920;
+	config.height = 1080;
+	config.fps = 60;
+	config.senderadapter = -1;
+	config.receiveradapter = -1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-mode") == 0 && i+1 < argc)
+			modes = argv[++i];
+		else if (strcmp(argv[i], "-path") == 0 && i+1 < argc)
+			paths = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0 && i+1 < argc)
+			sscanf_s(argv[++i], "%ux%u", &config.width, &config.height);
+		else if (strcmp(argv[i], "-fps") == 0 && i+1 < argc)
+			config.fps = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-frames") == 0 && i+1 < argc)
+			nFrames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-adapter") == 0 && i+1 < argc)
+			sscanf_s(argv[++i], "%d,%d", &config.senderadapter, &config.receiveradapter);
+		else if (strcmp(argv[i], "-csv") == 0 && i+1 < argc)
+			csvpath = argv[++i];
+		else {
+			printf("SpoutLatency [-mode dx11,gldx,cpu,memory] [-path texture,image] [-size 1920x1080]\n"
+				"             [-fps n] [-frames n] [-adapter sender,receiver] [-csv file]\n");
+			return 1;
+		}
+	}
+	if (nFrames == 0)
+		nFrames = 600;
+	if (config.fps == 0)
+		config.fps = 60;
+	if (config.width < TAG_WIDTH || config.height < TAG_BLOCK) {
+		printf("SpoutLatency - the minimum size is %ux%u for the frame tag\n", TAG_WIDTH, TAG_BLOCK);
+		return 1;
+	}
+
+	return RunLatency(modes, paths, config, nFrames, csvpath);
+}
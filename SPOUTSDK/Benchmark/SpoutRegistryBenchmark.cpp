@@ -0,0 +1,438 @@
+/*
+
+					SpoutRegistryBenchmark.cpp
+
+		Cost of sender registry, shared memory and frame count operations
+
+	Usage :
+
+		SpoutRegistryBenchmark [-op name] [-senders 1,8,64,...] [-csv file]
+
+	Senders are registered in this process, without textures, until each
+	registry size from 1 to 256 is reached. At each size every operation is
+	timed and reported in nanoseconds per operation. The scaling table
+	gives each operation relative to the time with one sender, so that
+	a cost which grows with the number of senders is shown directly.
+
+		register    - RegisterSenderName of a new name
+		release     - ReleaseSenderName of that name
+		find hit    - FindSenderName of a registered name
+		find miss   - FindSenderName of a name not registered
+		info        - GetSenderInfo
+		shared      - getSharedInfo, maps opened for each call
+		shared cache - getSharedInfo with SetSenderInfoCache
+		clean       - CleanSenders with no orphaned senders
+		mem create  - SpoutSharedMemory Create and Close of a new map
+		mem open    - SpoutSharedMemory Open and Close of an existing map
+		mem lock    - SpoutSharedMemory Lock and Unlock
+		frame set   - spoutFrameCount SetNewFrame (semaphore release)
+		frame get   - spoutFrameCount GetNewFrame (semaphore read)
+
+	The names searched are in the middle of the registry.
+
+	-op      - only operations with names containing the text
+	-senders - comma separated list of registry sizes
+
+	Maximum senders and frame counting are user registry settings.
+	They are set while the benchmark runs and restored afterwards.
+	Other Spout senders add to the registry size and should be closed.
+
+	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+	========================
+
+	15.10.26 - first version
+
+*/
+
+#include "SpoutSenderNames.h"
+#include "SpoutSharedMemory.h"
+#include "SpoutFrameCount.h"
+#include <algorithm> // for std::sort
+#include <vector>
+#include <string>
+
+// Minimum time and number of timed batches for each operation
+#define REG_BENCH_MSEC 100.0
+#define REG_BENCH_MIN_BATCHES 5
+#define REG_BENCH_MAX_BATCHES 1000
+// Operations timed together in a batch
+#define REG_BENCH_BATCH 16
+// Largest registry size
+#define REG_BENCH_MAX_SENDERS 256
+
+enum RegOp {
+	REG_REGISTER,
+	REG_RELEASE,
+	REG_FIND_HIT,
+	REG_FIND_MISS,
+	REG_INFO,
+	REG_SHARED,
+	REG_SHARED_CACHE,
+	REG_CLEAN,
+	REG_MEM_CREATE,
+	REG_MEM_OPEN,
+	REG_MEM_LOCK,
+	REG_FRAME_SET,
+	REG_FRAME_GET,
+	REG_OPS
+};
+
+static const char* const g_OpNames[REG_OPS] = {
+	"register", "release", "find hit", "find miss", "info", "shared", "shared cache",
+	"clean", "mem create", "mem open", "mem lock", "frame set", "frame get"
+};
+
+static const unsigned int g_Sizes[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+static double CounterFrequency()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceFrequency(&li);
+	return static_cast<double>(li.QuadPart)/1000.0; // counts per msec
+}
+
+static LONG64 Counter()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceCounter(&li);
+	return li.QuadPart;
+}
+
+// Median nanoseconds per operation of batches of calls
+template <typename F>
+static double TimeOps(const F& func, double frequency)
+{
+	// Warm up
+	func();
+	func();
+
+	std::vector<double> times;
+	double total = 0.0;
+	while (times.size() < REG_BENCH_MAX_BATCHES
+		&& (times.size() < REG_BENCH_MIN_BATCHES || total < REG_BENCH_MSEC)) {
+		const LONG64 start = Counter();
+		for (int i = 0; i < REG_BENCH_BATCH; i++)
+			func();
+		const double msec = static_cast<double>(Counter()-start)/frequency;
+		times.push_back(msec*1.0e6/REG_BENCH_BATCH);
+		total += msec;
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size()/2];
+}
+
+// Median nanoseconds per operation of a pair of operations,
+// where the second undoes the first, timed separately
+template <typename F1, typename F2>
+static void TimePair(const F1& first, const F2& second, double frequency, double& ns1, double& ns2)
+{
+	first(0);
+	second(0);
+
+	std::vector<double> times1;
+	std::vector<double> times2;
+	double total = 0.0;
+	while (times1.size() < REG_BENCH_MAX_BATCHES
+		&& (times1.size() < REG_BENCH_MIN_BATCHES || total < REG_BENCH_MSEC)) {
+		const LONG64 start = Counter();
+		for (int i = 0; i < REG_BENCH_BATCH; i++)
+			first(i);
+		const LONG64 mid = Counter();
+		for (int i = 0; i < REG_BENCH_BATCH; i++)
+			second(i);
+		const LONG64 end = Counter();
+		const double msec1 = static_cast<double>(mid-start)/frequency;
+		const double msec2 = static_cast<double>(end-mid)/frequency;
+		times1.push_back(msec1*1.0e6/REG_BENCH_BATCH);
+		times2.push_back(msec2*1.0e6/REG_BENCH_BATCH);
+		total += msec1 + msec2;
+	}
+	std::sort(times1.begin(), times1.end());
+	std::sort(times2.begin(), times2.end());
+	ns1 = times1[times1.size()/2];
+	ns2 = times2[times2.size()/2];
+}
+
+static bool ListContains(const char* list, const char* item)
+{
+	if (!list)
+		return true;
+	std::string str = ",";
+	str += list;
+	str += ",";
+	std::string find = ",";
+	find += item;
+	find += ",";
+	return (str.find(find) != std::string::npos);
+}
+
+static bool OpSelected(const char* opname, int op)
+{
+	return (!opname || strstr(g_OpNames[op], opname) != nullptr);
+}
+
+// Time the selected operations with the current registry size
+static void TimeRegistry(spoutSenderNames& names, const std::vector<std::string>& senders,
+	const char* prefix, const char* opname, double frequency, double* ns)
+{
+	const std::string& target = senders[senders.size()/2];
+	const std::string missing = std::string(prefix) + "_missing";
+
+	// Names for register and release
+	char extra[REG_BENCH_BATCH][64]={};
+	for (int i = 0; i < REG_BENCH_BATCH; i++)
+		sprintf_s(extra[i], 64, "%s_extra_%d", prefix, i);
+
+	for (int op = 0; op < REG_OPS; op++)
+		ns[op] = -1.0;
+
+	if (OpSelected(opname, REG_REGISTER) || OpSelected(opname, REG_RELEASE)) {
+		TimePair(
+			[&](int i) { names.RegisterSenderName(extra[i]); },
+			[&](int i) { names.ReleaseSenderName(extra[i]); },
+			frequency, ns[REG_REGISTER], ns[REG_RELEASE]);
+	}
+
+	if (OpSelected(opname, REG_FIND_HIT))
+		ns[REG_FIND_HIT] = TimeOps([&]() { names.FindSenderName(target.c_str()); }, frequency);
+
+	if (OpSelected(opname, REG_FIND_MISS))
+		ns[REG_FIND_MISS] = TimeOps([&]() { names.FindSenderName(missing.c_str()); }, frequency);
+
+	if (OpSelected(opname, REG_INFO)) {
+		unsigned int width = 0;
+		unsigned int height = 0;
+		HANDLE hShare = NULL;
+		DWORD dwFormat = 0;
+		ns[REG_INFO] = TimeOps([&]() { names.GetSenderInfo(target.c_str(), width, height, hShare, dwFormat); }, frequency);
+	}
+
+	SharedTextureInfo info={};
+	if (OpSelected(opname, REG_SHARED)) {
+		names.SetSenderInfoCache(false);
+		ns[REG_SHARED] = TimeOps([&]() { names.getSharedInfo(target.c_str(), &info); }, frequency);
+	}
+
+	if (OpSelected(opname, REG_SHARED_CACHE)) {
+		names.SetSenderInfoCache(true);
+		ns[REG_SHARED_CACHE] = TimeOps([&]() { names.getSharedInfo(target.c_str(), &info); }, frequency);
+		names.SetSenderInfoCache(false);
+	}
+
+	if (OpSelected(opname, REG_CLEAN))
+		ns[REG_CLEAN] = TimeOps([&]() { names.CleanSenders(); }, frequency);
+
+	if (OpSelected(opname, REG_MEM_CREATE)) {
+		const std::string memname = std::string(prefix) + "_create";
+		ns[REG_MEM_CREATE] = TimeOps([&]() {
+			SpoutSharedMemory mem;
+			mem.Create(memname.c_str(), 4096);
+			mem.Close();
+		}, frequency);
+	}
+
+	if (OpSelected(opname, REG_MEM_OPEN) || OpSelected(opname, REG_MEM_LOCK)) {
+		const std::string memname = std::string(prefix) + "_open";
+		SpoutSharedMemory mem;
+		if (mem.Create(memname.c_str(), 4096) != SPOUT_CREATE_FAILED) {
+			if (OpSelected(opname, REG_MEM_OPEN)) {
+				ns[REG_MEM_OPEN] = TimeOps([&]() {
+					SpoutSharedMemory other;
+					other.Open(memname.c_str());
+					other.Close();
+				}, frequency);
+			}
+			if (OpSelected(opname, REG_MEM_LOCK)) {
+				ns[REG_MEM_LOCK] = TimeOps([&]() {
+					if (mem.Lock())
+						mem.Unlock();
+				}, frequency);
+			}
+			mem.Close();
+		}
+	}
+
+	if (OpSelected(opname, REG_FRAME_SET) || OpSelected(opname, REG_FRAME_GET)) {
+		// Sender and receiver of the middle sender
+		spoutFrameCount sender;
+		spoutFrameCount receiver;
+		sender.EnableFrameCount(target.c_str());
+		receiver.EnableFrameCount(target.c_str());
+		if (sender.IsFrameCountEnabled() && receiver.IsFrameCountEnabled()) {
+			if (OpSelected(opname, REG_FRAME_SET))
+				ns[REG_FRAME_SET] = TimeOps([&]() { sender.SetNewFrame(); }, frequency);
+			if (OpSelected(opname, REG_FRAME_GET))
+				ns[REG_FRAME_GET] = TimeOps([&]() { receiver.GetNewFrame(); }, frequency);
+		}
+		receiver.CleanupFrameCount();
+		sender.CleanupFrameCount();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* opname = nullptr;
+	const char* sizes = nullptr;
+	const char* csvpath = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-op") == 0 && i+1 < argc)
+			opname = argv[++i];
+		else if (strcmp(argv[i], "-senders") == 0 && i+1 < argc)
+			sizes = argv[++i];
+		else if (strcmp(argv[i], "-csv") == 0 && i+1 < argc)
+			csvpath = argv[++i];
+		else {
+			printf("SpoutRegistryBenchmark [-op name] [-senders 1,8,64,...] [-csv file]\n");
+			return 1;
+		}
+	}
+
+	// Registry settings for the benchmark
+	DWORD dwMaxSenders = 0;
+	DWORD dwFramecount = 0;
+	const bool bMaxKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MaxSenders", &dwMaxSenders);
+	const bool bCountKey = ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", &dwFramecount);
+	WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", 1);
+
+	const double frequency = CounterFrequency();
+	int maxsenders = 0;
+	int result = 0;
+
+	// Scope for the sender names object before registry settings are restored
+	{
+		spoutSenderNames names;
+		maxsenders = names.GetMaxSenders();
+		// Room for the senders and the names registered during timing
+		if (names.GetMaxSenders() < REG_BENCH_MAX_SENDERS + REG_BENCH_BATCH + 16)
+			names.SetMaxSenders(REG_BENCH_MAX_SENDERS + REG_BENCH_BATCH + 16);
+
+		const int existing = names.GetSenderCount();
+		const int capacity = names.GetSenderCapacity() - existing - REG_BENCH_BATCH;
+		printf("%d existing senders, capacity %d\n", existing, capacity);
+
+		char prefix[64]={};
+		sprintf_s(prefix, 64, "SpoutRegBench_%lu", GetCurrentProcessId());
+
+		FILE* csv = nullptr;
+		if (csvpath && fopen_s(&csv, csvpath, "w") == 0 && csv)
+			fprintf(csv, "op,senders,ns,scaling\n");
+
+		std::vector<std::string> senders;
+		std::vector<unsigned int> measured;
+		std::vector<std::vector<double>> results(REG_OPS);
+
+		for (int s = 0; s < _countof(g_Sizes); s++) {
+
+			char size[16]={};
+			sprintf_s(size, 16, "%u", g_Sizes[s]);
+			if (!ListContains(sizes, size))
+				continue;
+			if ((int)g_Sizes[s] > capacity) {
+				printf("%u senders exceeds the capacity of the sender map\n", g_Sizes[s]);
+				result = 1;
+				break;
+			}
+
+			// Add senders to the size
+			while (senders.size() < g_Sizes[s]) {
+				char name[64]={};
+				sprintf_s(name, 64, "%s_%03u", prefix, (unsigned int)senders.size());
+				if (!names.CreateSender(name, 640, 360, NULL, 87)) {
+					printf("CreateSender failed for %s\n", name);
+					result = 1;
+					break;
+				}
+				senders.push_back(name);
+			}
+			if (senders.size() < g_Sizes[s])
+				break;
+
+			double ns[REG_OPS]={};
+			TimeRegistry(names, senders, prefix, opname, frequency, ns);
+			measured.push_back(g_Sizes[s]);
+			for (int op = 0; op < REG_OPS; op++)
+				results[op].push_back(ns[op]);
+			printf("%u senders timed\n", g_Sizes[s]);
+		}
+
+		// Nanoseconds per operation
+		printf("\n%-13s", "ns/op");
+		for (size_t s = 0; s < measured.size(); s++)
+			printf(" %9u", measured[s]);
+		printf("\n");
+		for (int op = 0; op < REG_OPS; op++) {
+			if (!OpSelected(opname, op))
+				continue;
+			printf("%-13s", g_OpNames[op]);
+			for (size_t s = 0; s < measured.size(); s++) {
+				if (results[op][s] < 0.0)
+					printf(" %9s", "-");
+				else
+					printf(" %9.0f", results[op][s]);
+			}
+			printf("\n");
+		}
+
+		// Relative to the first size
+		printf("\n%-13s", "scaling");
+		for (size_t s = 0; s < measured.size(); s++)
+			printf(" %9u", measured[s]);
+		printf("\n");
+		for (int op = 0; op < REG_OPS; op++) {
+			if (!OpSelected(opname, op))
+				continue;
+			printf("%-13s", g_OpNames[op]);
+			for (size_t s = 0; s < measured.size(); s++) {
+				const double base = results[op][0];
+				const double scale = (base > 0.0 && results[op][s] >= 0.0) ? results[op][s]/base : 0.0;
+				printf(" %9.2f", scale);
+				if (csv && results[op][s] >= 0.0)
+					fprintf(csv, "%s,%u,%.1f,%.3f\n", g_OpNames[op], measured[s], results[op][s], scale);
+			}
+			printf("\n");
+		}
+
+		if (csv)
+			fclose(csv);
+
+		// Remove the senders
+		for (size_t i = 0; i < senders.size(); i++)
+			names.ReleaseSenderName(senders[i].c_str());
+	}
+
+	// Restore registry settings
+	if (bMaxKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MaxSenders", dwMaxSenders);
+	else
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MaxSenders", (DWORD)maxsenders);
+	if (bCountKey)
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", dwFramecount);
+	else
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Framecount", 0);
+
+	return result;
+}
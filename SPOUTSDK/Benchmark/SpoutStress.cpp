@@ -0,0 +1,654 @@
+/*
+
+					SpoutStress.cpp
+
+		Many sender and receiver load generator
+
+	Usage :
+
+		SpoutStress [-senders n] [-receivers n] [-threads n] [-processes n]
+		            [-size 640x360] [-fps n] [-churn n] [-seconds n] [-csv file]
+
+		-senders   - number of senders (default 64)
+		-receivers - number of receivers (default 64)
+		             Receiver i receives from sender i modulo the number of senders.
+		-threads   - worker threads in each process (default 8)
+		             The senders and receivers of a thread share one DirectX 11 device.
+		-processes - number of processes (default 1)
+		             Senders and receivers are divided between the processes,
+		             each on its own threads. Each process reports separately.
+		-size      - sender texture size (default 640x360)
+		-fps       - frames per second of each sender (default 30)
+		-churn     - senders released and created again per second (default 0)
+		-seconds   - duration of the measurement (default 10)
+		-csv       - operation times to a file
+
+	Senders are spoutDX objects sending a cleared texture. Receivers
+	use ReceiveTexture. A monitor thread reads the sender list with
+	GetSenderNames and releases orphaned senders with CleanSenders.
+
+	Reported for each process :
+
+		Sender list operations (msec)
+			create - SendTexture that creates the sender and registers the name
+			send   - SendTexture of an existing sender
+			release - ReleaseSender
+			names  - GetSenderNames
+			clean  - CleanSenders
+			receive - ReceiveTexture
+		with count, mean, p50, p99 and max for each.
+
+		Frame delivery
+			sent       - frames sent by all senders
+			received   - new frames received by all receivers
+			missed     - sender frames not received
+			reconnect  - receiver updates for a new or changed sender
+			age p50, p99 - sender publish to receiver receipt msec
+			senders    - maximum number of senders in the list
+
+	The sender list is limited by the registry setting for the maximum
+	number of senders (see SetMaxSenders). Create times increase and
+	senders fail when the limit is reached.
+
+	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+	========================
+
+	15.10.26 - first version
+
+*/
+
+#include "SpoutDX.h"
+#include <algorithm> // for std::sort
+
+// Interval of the monitor thread sender list read and cleanup
+#define STRESS_NAMES_INTERVAL 100
+#define STRESS_CLEAN_INTERVAL 1000
+
+// Timed operations
+enum StressOp {
+	STRESS_CREATE,
+	STRESS_SEND,
+	STRESS_RELEASE,
+	STRESS_NAMES,
+	STRESS_CLEAN,
+	STRESS_RECEIVE,
+	STRESS_OPS
+};
+
+static const char* const g_OpNames[STRESS_OPS] = { "create", "send", "release", "names", "clean", "receive" };
+
+struct StressConfig {
+	unsigned int senders;
+	unsigned int receivers;
+	unsigned int threads;
+	unsigned int processes;
+	unsigned int width;
+	unsigned int height;
+	unsigned int fps;
+	double churn; // Releases per second
+	unsigned int seconds;
+	unsigned int process; // Index of this process
+};
+
+// Results of all threads of a process
+struct StressStats {
+	SRWLOCK lock;
+	std::vector<double> msec[STRESS_OPS];
+	std::vector<double> ages;
+	LONG64 sent;
+	LONG64 received;
+	LONG64 missed;
+	LONG64 reconnects;
+	int maxsenders; // Most senders in the list
+};
+
+// Sender or receiver on a worker thread
+struct StressSender {
+	spoutDX* pSender;
+	char name[64];
+	ID3D11Texture2D* pTexture;
+	ID3D11RenderTargetView* pView;
+	bool bCreated; // Registered in the sender list
+};
+
+struct StressReceiver {
+	spoutDX* pReceiver;
+	LONG64 missedstart; // Missed frames of the sender when connected
+};
+
+// Worker thread arguments
+struct StressThread {
+	const StressConfig* pConfig;
+	StressStats* pStats;
+	std::vector<unsigned int> senders; // Sender indices
+	std::vector<unsigned int> receivers; // Receiver indices
+	HANDLE hStop;
+};
+
+struct StressMonitor {
+	const StressConfig* pConfig;
+	StressStats* pStats;
+	HANDLE hStop;
+};
+
+//
+// Timing
+//
+
+static double CounterFrequency()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceFrequency(&li);
+	return static_cast<double>(li.QuadPart)/1000.0; // counts per msec
+}
+
+static LONG64 Counter()
+{
+	LARGE_INTEGER li={};
+	QueryPerformanceCounter(&li);
+	return li.QuadPart;
+}
+
+// Nearest rank percentile of sorted values
+static double Percentile(const std::vector<double>& sorted, unsigned int percent)
+{
+	if (sorted.empty())
+		return 0.0;
+	size_t rank = (sorted.size()*percent + 99)/100;
+	if (rank < 1) rank = 1;
+	if (rank > sorted.size()) rank = sorted.size();
+	return sorted[rank-1];
+}
+
+static bool StopSignalled(HANDLE hStop)
+{
+	return (hStop && WaitForSingleObject(hStop, 0) == WAIT_OBJECT_0);
+}
+
+// Sender names are unique to the process and index
+static void StressSenderName(char* name, int maxchars, const StressConfig& config, unsigned int index)
+{
+	sprintf_s(name, maxchars, "SpoutStress_%u_%u", config.process, index);
+}
+
+//
+// Worker thread
+//
+// Sends and receives at the frame rate until the stop event is set.
+// Thread results are added to the process results at the end.
+//
+
+static bool OpenStressSender(StressSender& sender, ID3D11Device* pDevice, const StressConfig& config)
+{
+	sender.pSender = new spoutDX;
+	if (!sender.pSender->OpenDirectX11(pDevice))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = config.width;
+	desc.Height = config.height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	if (FAILED(pDevice->CreateTexture2D(&desc, nullptr, &sender.pTexture))
+		|| FAILED(pDevice->CreateRenderTargetView(sender.pTexture, nullptr, &sender.pView)))
+		return false;
+
+	sender.pSender->SetSenderName(sender.name);
+	return true;
+}
+
+static void CloseStressSender(StressSender& sender)
+{
+	if (sender.pSender) {
+		sender.pSender->ReleaseSender();
+		sender.pSender->CloseDirectX11();
+		delete sender.pSender;
+	}
+	if (sender.pView) sender.pView->Release();
+	if (sender.pTexture) sender.pTexture->Release();
+	sender.pSender = nullptr;
+	sender.pView = nullptr;
+	sender.pTexture = nullptr;
+}
+
+static DWORD WINAPI StressThreadProc(LPVOID lpParameter)
+{
+	StressThread* pThread = static_cast<StressThread*>(lpParameter);
+	const StressConfig& config = *pThread->pConfig;
+
+	// One device for the senders and receivers of this thread
+	spoutDX host;
+	if (!host.OpenDirectX11())
+		return 1;
+	ID3D11Device* pDevice = host.GetDX11Device();
+	ID3D11DeviceContext* pContext = host.GetDX11Context();
+
+	std::vector<StressSender> senders(pThread->senders.size());
+	for (size_t i = 0; i < senders.size(); i++) {
+		senders[i] = {};
+		StressSenderName(senders[i].name, 64, config, pThread->senders[i]);
+		if (!OpenStressSender(senders[i], pDevice, config))
+			CloseStressSender(senders[i]);
+	}
+
+	std::vector<StressReceiver> receivers(pThread->receivers.size());
+	for (size_t i = 0; i < receivers.size(); i++) {
+		receivers[i] = {};
+		receivers[i].pReceiver = new spoutDX;
+		if (receivers[i].pReceiver->OpenDirectX11(pDevice)) {
+			char name[64]={};
+			StressSenderName(name, 64, config, pThread->receivers[i] % config.senders);
+			receivers[i].pReceiver->SetReceiverName(name);
+		}
+	}
+
+	std::vector<double> msec[STRESS_OPS];
+	std::vector<double> ages;
+	LONG64 sent = 0;
+	LONG64 received = 0;
+	LONG64 missed = 0;
+	LONG64 reconnects = 0;
+
+	// Releases per frame for the senders of this thread
+	const double churn = (config.senders > 0)
+		? config.churn*static_cast<double>(senders.size())/static_cast<double>(config.senders)/static_cast<double>(config.fps)
+		: 0.0;
+	double churncount = 0.0;
+	size_t churnindex = 0;
+
+	const double frequency = CounterFrequency();
+	const LONG64 start = Counter();
+	LONG64 frames = 0;
+	while (!StopSignalled(pThread->hStop)) {
+
+		// Senders
+		for (size_t i = 0; i < senders.size(); i++) {
+			StressSender& sender = senders[i];
+			if (!sender.pSender)
+				continue;
+			const float level = static_cast<float>((frames + i) % 256)/255.0f;
+			const float color[4] = { level, 0.5f, 1.0f-level, 1.0f };
+			pContext->ClearRenderTargetView(sender.pView, color);
+			const LONG64 t0 = Counter();
+			const bool bSent = sender.pSender->SendTexture(sender.pTexture);
+			const double t = static_cast<double>(Counter()-t0)/frequency;
+			if (bSent) {
+				msec[sender.bCreated ? STRESS_SEND : STRESS_CREATE].push_back(t);
+				sender.bCreated = true;
+				sent++;
+			}
+		}
+
+		// Sender churn - release and create again on the next frame
+		churncount += churn;
+		while (churncount >= 1.0 && !senders.empty()) {
+			churncount -= 1.0;
+			StressSender& sender = senders[churnindex];
+			churnindex = (churnindex + 1) % senders.size();
+			if (sender.pSender && sender.bCreated) {
+				const LONG64 t0 = Counter();
+				sender.pSender->ReleaseSender();
+				msec[STRESS_RELEASE].push_back(static_cast<double>(Counter()-t0)/frequency);
+				sender.pSender->SetSenderName(sender.name);
+				sender.bCreated = false;
+			}
+		}
+
+		// Receivers
+		for (size_t i = 0; i < receivers.size(); i++) {
+			StressReceiver& receiver = receivers[i];
+			const LONG64 t0 = Counter();
+			const bool bReceived = receiver.pReceiver->ReceiveTexture();
+			const double t = static_cast<double>(Counter()-t0)/frequency;
+			if (receiver.pReceiver->IsUpdated()) {
+				receiver.missedstart = receiver.pReceiver->GetSenderMissedFrames();
+				reconnects++;
+				continue;
+			}
+			if (bReceived) {
+				msec[STRESS_RECEIVE].push_back(t);
+				if (receiver.pReceiver->IsFrameNew()) {
+					received++;
+					ages.push_back(receiver.pReceiver->GetSenderFrameAge());
+				}
+			}
+		}
+
+		// Next frame
+		frames++;
+		const LONG64 next = start + (LONG64)(frequency*1000.0*static_cast<double>(frames)/static_cast<double>(config.fps));
+		while (Counter() < next && !StopSignalled(pThread->hStop))
+			Sleep(1);
+	}
+
+	// Missed frames of the senders still connected
+	for (size_t i = 0; i < receivers.size(); i++) {
+		if (receivers[i].pReceiver->IsConnected())
+			missed += receivers[i].pReceiver->GetSenderMissedFrames() - receivers[i].missedstart;
+		receivers[i].pReceiver->ReleaseReceiver();
+		receivers[i].pReceiver->CloseDirectX11();
+		delete receivers[i].pReceiver;
+	}
+	for (size_t i = 0; i < senders.size(); i++)
+		CloseStressSender(senders[i]);
+	host.CloseDirectX11();
+
+	// Add to the process results
+	StressStats* pStats = pThread->pStats;
+	AcquireSRWLockExclusive(&pStats->lock);
+	for (int op = 0; op < STRESS_OPS; op++)
+		pStats->msec[op].insert(pStats->msec[op].end(), msec[op].begin(), msec[op].end());
+	pStats->ages.insert(pStats->ages.end(), ages.begin(), ages.end());
+	pStats->sent += sent;
+	pStats->received += received;
+	pStats->missed += missed;
+	pStats->reconnects += reconnects;
+	ReleaseSRWLockExclusive(&pStats->lock);
+
+	return 0;
+}
+
+//
+// Monitor thread
+//
+// Sender list read and orphaned sender cleanup at intervals
+//
+
+static DWORD WINAPI StressMonitorProc(LPVOID lpParameter)
+{
+	StressMonitor* pMonitor = static_cast<StressMonitor*>(lpParameter);
+	spoutSenderNames sendernames;
+	std::set<std::string> names;
+	std::vector<double> namesmsec;
+	std::vector<double> cleanmsec;
+	int maxsenders = 0;
+
+	const double frequency = CounterFrequency();
+	LONG64 lastclean = Counter();
+	while (WaitForSingleObject(pMonitor->hStop, STRESS_NAMES_INTERVAL) == WAIT_TIMEOUT) {
+		names.clear();
+		LONG64 t0 = Counter();
+		sendernames.GetSenderNames(&names);
+		namesmsec.push_back(static_cast<double>(Counter()-t0)/frequency);
+		if ((int)names.size() > maxsenders)
+			maxsenders = (int)names.size();
+		if (static_cast<double>(Counter()-lastclean)/frequency >= STRESS_CLEAN_INTERVAL) {
+			t0 = Counter();
+			sendernames.CleanSenders();
+			lastclean = Counter();
+			cleanmsec.push_back(static_cast<double>(lastclean-t0)/frequency);
+		}
+	}
+
+	StressStats* pStats = pMonitor->pStats;
+	AcquireSRWLockExclusive(&pStats->lock);
+	pStats->msec[STRESS_NAMES] = namesmsec;
+	pStats->msec[STRESS_CLEAN] = cleanmsec;
+	pStats->maxsenders = maxsenders;
+	ReleaseSRWLockExclusive(&pStats->lock);
+
+	return 0;
+}
+
+//
+// Process
+//
+
+static void PrintStats(const StressConfig& config, StressStats& stats, FILE* csv)
+{
+	printf("\nProcess %u - %u senders, %u receivers, %u threads, %ux%u at %u fps, churn %.1f/sec\n",
+		config.process, config.senders, config.receivers, config.threads,
+		config.width, config.height, config.fps, config.churn);
+
+	printf("%-8s %8s %8s %8s %8s %8s\n", "op", "count", "mean", "p50", "p99", "max");
+	for (int op = 0; op < STRESS_OPS; op++) {
+		std::vector<double>& msec = stats.msec[op];
+		std::sort(msec.begin(), msec.end());
+		double total = 0.0;
+		for (size_t i = 0; i < msec.size(); i++)
+			total += msec[i];
+		const double mean = msec.empty() ? 0.0 : total/static_cast<double>(msec.size());
+		const double maxmsec = msec.empty() ? 0.0 : msec.back();
+		printf("%-8s %8zu %8.3f %8.3f %8.3f %8.3f\n", g_OpNames[op], msec.size(),
+			mean, Percentile(msec, 50), Percentile(msec, 99), maxmsec);
+		if (csv) {
+			for (size_t i = 0; i < msec.size(); i++)
+				fprintf(csv, "%u,%s,%.4f\n", config.process, g_OpNames[op], msec[i]);
+		}
+	}
+
+	std::sort(stats.ages.begin(), stats.ages.end());
+	printf("\n%10s %10s %10s %10s %8s %8s %8s\n",
+		"sent", "received", "missed", "reconnect", "age p50", "age p99", "senders");
+	printf("%10lld %10lld %10lld %10lld %8.3f %8.3f %8d\n",
+		stats.sent, stats.received, stats.missed, stats.reconnects,
+		Percentile(stats.ages, 50), Percentile(stats.ages, 99), stats.maxsenders);
+}
+
+// Senders and receivers of this process on its threads
+static int RunProcess(const StressConfig& config, const char* csvpath)
+{
+	StressStats stats;
+	InitializeSRWLock(&stats.lock);
+	stats.sent = 0;
+	stats.received = 0;
+	stats.missed = 0;
+	stats.reconnects = 0;
+	stats.maxsenders = 0;
+
+	spoutSenderNames sendernames;
+	const int maxsenders = sendernames.GetMaxSenders();
+	if ((int)(config.senders*config.processes) > maxsenders)
+		printf("SpoutStress - %u senders for a sender list of %d (see SetMaxSenders)\n",
+			config.senders*config.processes, maxsenders);
+
+	HANDLE hStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!hStop)
+		return 1;
+
+	// Divide senders and receivers between the threads
+	std::vector<StressThread> threads(config.threads);
+	for (unsigned int t = 0; t < config.threads; t++) {
+		threads[t].pConfig = &config;
+		threads[t].pStats = &stats;
+		threads[t].hStop = hStop;
+	}
+	for (unsigned int i = 0; i < config.senders; i++)
+		threads[i % config.threads].senders.push_back(i);
+	for (unsigned int i = 0; i < config.receivers; i++)
+		threads[i % config.threads].receivers.push_back(i);
+
+	std::vector<HANDLE> handles;
+	for (unsigned int t = 0; t < config.threads; t++) {
+		HANDLE hThread = CreateThread(NULL, 0, StressThreadProc, &threads[t], 0, NULL);
+		if (hThread)
+			handles.push_back(hThread);
+	}
+
+	StressMonitor monitor = { &config, &stats, hStop };
+	HANDLE hMonitor = CreateThread(NULL, 0, StressMonitorProc, &monitor, 0, NULL);
+
+	Sleep(config.seconds*1000);
+	SetEvent(hStop);
+
+	if (!handles.empty())
+		WaitForMultipleObjects((DWORD)handles.size(), handles.data(), TRUE, INFINITE);
+	for (size_t i = 0; i < handles.size(); i++)
+		CloseHandle(handles[i]);
+	if (hMonitor) {
+		WaitForSingleObject(hMonitor, INFINITE);
+		CloseHandle(hMonitor);
+	}
+	CloseHandle(hStop);
+
+	// The csv file is created by the controller and each process
+	// appends its operation times. The results of one process are
+	// printed and written together.
+	HANDLE hMutex = CreateMutexA(NULL, FALSE, "SpoutStress_results");
+	if (hMutex)
+		WaitForSingleObject(hMutex, INFINITE);
+	FILE* csv = nullptr;
+	if (csvpath)
+		fopen_s(&csv, csvpath, "a");
+	PrintStats(config, stats, csv);
+	if (csv)
+		fclose(csv);
+	fflush(stdout);
+	if (hMutex) {
+		ReleaseMutex(hMutex);
+		CloseHandle(hMutex);
+	}
+
+	return (handles.size() == config.threads) ? 0 : 1;
+}
+
+//
+// Controller
+//
+
+static HANDLE StartProcess(const char* args)
+{
+	char path[MAX_PATH]={};
+	GetModuleFileNameA(NULL, path, MAX_PATH);
+
+	char cmdline[1024]={};
+	sprintf_s(cmdline, 1024, "\"%s\" %s", path, args);
+
+	// Child processes share the console for the results
+	STARTUPINFOA si={};
+	si.cb = sizeof(si);
+	PROCESS_INFORMATION pi={};
+	if (!CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi))
+		return NULL;
+	CloseHandle(pi.hThread);
+	return pi.hProcess;
+}
+
+int main(int argc, char* argv[])
+{
+	StressConfig config={};
+	config.senders = 64;
+	config.receivers = 64;
+	config.threads = 8;
+	config.processes = 1;
+	config.width = 640;
+	config.height = 360;
+	config.fps = 30;
+	config.churn = 0.0;
+	config.seconds = 10;
+	const char* csvpath = nullptr;
+	int worker = -1;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-senders") == 0 && i+1 < argc)
+			config.senders = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-receivers") == 0 && i+1 < argc)
+			config.receivers = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0 && i+1 < argc)
+			config.threads = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-processes") == 0 && i+1 < argc)
+			config.processes = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0 && i+1 < argc)
+			sscanf_s(argv[++i], "%ux%u", &config.width, &config.height);
+		else if (strcmp(argv[i], "-fps") == 0 && i+1 < argc)
+			config.fps = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-churn") == 0 && i+1 < argc)
+			config.churn = atof(argv[++i]);
+		else if (strcmp(argv[i], "-seconds") == 0 && i+1 < argc)
+			config.seconds = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-csv") == 0 && i+1 < argc)
+			csvpath = argv[++i];
+		else if (strcmp(argv[i], "-worker") == 0 && i+1 < argc)
+			worker = atoi(argv[++i]);
+		else {
+			printf("SpoutStress [-senders n] [-receivers n] [-threads n] [-processes n]\n"
+				"            [-size 640x360] [-fps n] [-churn n] [-seconds n] [-csv file]\n");
+			return 1;
+		}
+	}
+	if (config.senders == 0 || config.threads == 0 || config.processes == 0
+		|| config.width == 0 || config.height == 0 || config.fps == 0 || config.seconds == 0) {
+		printf("SpoutStress - senders, threads, processes, size, fps and seconds must not be zero\n");
+		return 1;
+	}
+
+	// Worker process with its share of the senders and receivers
+	if (worker >= 0) {
+		config.process = (unsigned int)worker;
+		return RunProcess(config, csvpath);
+	}
+
+	// Create the csv file for the processes to append to
+	if (csvpath) {
+		FILE* csv = nullptr;
+		if (fopen_s(&csv, csvpath, "w") == 0 && csv) {
+			fprintf(csv, "process,op,msec\n");
+			fclose(csv);
+		}
+	}
+
+	if (config.processes == 1)
+		return RunProcess(config, csvpath);
+
+	// Divide between processes
+	StressConfig process = config;
+	process.senders = (config.senders + config.processes - 1)/config.processes;
+	process.receivers = (config.receivers + config.processes - 1)/config.processes;
+	process.threads = (config.threads + config.processes - 1)/config.processes;
+
+	std::vector<HANDLE> handles;
+	for (unsigned int p = 0; p < config.processes; p++) {
+		char args[512]={};
+		sprintf_s(args, 512, "-worker %u -senders %u -receivers %u -threads %u -processes %u -size %ux%u -fps %u -churn %.2f -seconds %u",
+			p, process.senders, process.receivers, process.threads, config.processes,
+			config.width, config.height, config.fps, config.churn/static_cast<double>(config.processes), config.seconds);
+		if (csvpath) {
+			strcat_s(args, 512, " -csv \"");
+			strcat_s(args, 512, csvpath);
+			strcat_s(args, 512, "\"");
+		}
+		HANDLE hProcess = StartProcess(args);
+		if (hProcess)
+			handles.push_back(hProcess);
+	}
+
+	if (!handles.empty())
+		WaitForMultipleObjects((DWORD)handles.size(), handles.data(), TRUE, INFINITE);
+
+	int failed = 0;
+	for (size_t i = 0; i < handles.size(); i++) {
+		DWORD dwExit = 0;
+		if (!GetExitCodeProcess(handles[i], &dwExit) || dwExit != 0)
+			failed++;
+		CloseHandle(handles[i]);
+	}
+
+	return (failed > 0 || handles.size() != config.processes) ? 1 : 0;
+}
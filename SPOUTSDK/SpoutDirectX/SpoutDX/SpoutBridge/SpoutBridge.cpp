@@ -0,0 +1,771 @@
+//
+//		spoutBridge.cpp
+//
+//		Functions to bridge a Spout sender to another computer over a network
+//		Base class spoutEncoder for hardware encoding of the sender texture.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. Hardware encoded frames are sent as UDP datagrams
+//					  and decoded by a D3D11 hardware decoder to a Spout sender on
+//					  the remote computer, with the sender frame number and time.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutBridge.h"
+
+//
+// Class: spoutBridge
+//
+// Functions to bridge a Spout sender to another computer over a network.
+//
+// Base class is spoutEncoder for hardware encoding of the sender texture.
+//
+// The bridge sender receives a Spout sender with spoutEncoder, which converts
+// the shared texture to NV12 and encodes it on the GPU with low delay settings.
+// Each encoded frame is divided into fragments, each sent as a UDP datagram
+// with a header of the frame sequence, size, sender frame number and time.
+// The frame is sent as soon as the encoder outputs it.
+//
+// The bridge receiver collects the fragments of each frame and passes the
+// complete frame to a Media Foundation decoder using the D3D11 device.
+// The decoded NV12 texture is converted to BGRA by the video processor and
+// sent with SendTexture, so the frame is not read back on either computer.
+// If a frame is incomplete when the next arrives, it is counted as lost and
+// following frames are skipped until a key frame, which the receiver requests
+// from the bridge sender.
+//
+// Use separate objects to send and receive at the same time.
+//
+// Refer to source code for further details.
+//
+
+spoutBridge::spoutBridge() {
+
+	m_BridgeSocket = INVALID_SOCKET;
+	m_bWinsock = false;
+	m_bBridgeSend = false;
+	m_bBridgeReceive = false;
+	m_BridgeSequence = 0;
+
+	ZeroMemory(&m_AssembleHeader, sizeof(m_AssembleHeader));
+	m_AssembleCount = 0;
+	m_bAssembling = false;
+	m_bWaitKeyframe = true;
+	m_LastSequence = 0;
+	ZeroMemory(&m_PeerAddress, sizeof(m_PeerAddress));
+	m_bPeer = false;
+	m_KeyRequestTime = 0;
+	m_BridgeLost = 0;
+	m_BridgeFrame = 0;
+	m_BridgeTimestamp = 0;
+
+	m_pDecoder = nullptr;
+	m_DecodeCodec = SPOUT_ENCODE_H264;
+	m_DecodeWidth = 0;
+	m_DecodeHeight = 0;
+
+	m_pDecodeEnum = nullptr;
+	m_pDecodeProcessor = nullptr;
+	m_pBridgeTexture = nullptr;
+	m_pBridgeView = nullptr;
+
+}
+
+spoutBridge::~spoutBridge() {
+
+	StopBridge();
+
+	if (m_bWinsock)
+		WSACleanup();
+
+}
+
+//
+// Group: Bridge sender
+//
+
+//---------------------------------------------------------
+// Function: StartBridgeSend
+// Start sending a Spout sender to an address and port.
+//
+//   address - IPv4 address of the bridge receiver, e.g. "192.168.1.20"
+//   codec, bitrate, fps - encoder settings (see StartEncoding)
+//
+//   Set the sender to receive with SetReceiverName first
+//   or the active sender is used.
+bool spoutBridge::StartBridgeSend(const char* address, unsigned short port,
+	SpoutEncodeCodec codec, unsigned int bitrate, unsigned int fps)
+{
+	if (!address || !*address || port == 0)
+		return false;
+
+	StopBridge();
+
+	if (!OpenBridgeSocket(port, address))
+		return false;
+
+	if (!StartEncoding(codec, bitrate, fps)) {
+		StopBridge();
+		return false;
+	}
+
+	m_BridgeSequence = 0;
+	m_bBridgeSend = true;
+
+	SpoutLogNotice("spoutBridge::StartBridgeSend - %s:%d", address, port);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: BridgeSend
+// Encode and send a new frame.
+//
+//   Call at the sender frame rate or faster.
+//   Each encoded frame is sent as soon as it is ready.
+//   Returns false if not sending or there is no sender.
+bool spoutBridge::BridgeSend()
+{
+	if (!m_bBridgeSend)
+		return false;
+
+	// Key frame requests from the bridge receiver
+	SpoutBridgeHeader request={};
+	while (recv(m_BridgeSocket, reinterpret_cast<char*>(&request), (int)sizeof(request), 0) == (int)sizeof(request)) {
+		if (request.id == SPOUT_BRIDGE_ID && request.type == SPOUT_BRIDGE_KEYREQUEST)
+			RequestKeyframe();
+	}
+
+	const bool bRet = Encode();
+
+	SpoutEncodedPacket packet;
+	while (GetPacket(packet))
+		SendBridgePacket(packet);
+
+	return bRet;
+}
+
+//
+// Group: Bridge receiver
+//
+
+//---------------------------------------------------------
+// Function: StartBridgeReceive
+// Start receiving on a port to a Spout sender.
+//
+//   The sender is created with the size of the first frame decoded.
+bool spoutBridge::StartBridgeReceive(unsigned short port, const char* sendername)
+{
+	if (port == 0 || !sendername || !*sendername)
+		return false;
+
+	StopBridge();
+
+	// The class device with video support is used by the decoder
+	if (!CreateEncodeDevice())
+		return false;
+
+	if (!OpenBridgeSocket(port, nullptr))
+		return false;
+
+	SetSenderName(sendername);
+	m_bAssembling = false;
+	m_bWaitKeyframe = true;
+	m_bPeer = false;
+	m_BridgeLost = 0;
+	m_BridgeFrame = 0;
+	m_BridgeTimestamp = 0;
+	m_bBridgeReceive = true;
+
+	SpoutLogNotice("spoutBridge::StartBridgeReceive - port %d to [%s]", port, sendername);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: BridgeReceive
+// Receive, decode and send the frames that have arrived.
+//
+//   Call often, at least at the frame rate of the bridge sender.
+//   Datagrams waiting are read without blocking.
+bool spoutBridge::BridgeReceive()
+{
+	if (!m_bBridgeReceive)
+		return false;
+
+	for (;;) {
+		sockaddr_in from={};
+		int fromlen = (int)sizeof(from);
+		const int bytes = recvfrom(m_BridgeSocket, reinterpret_cast<char*>(m_Datagram.data()),
+			(int)m_Datagram.size(), 0, reinterpret_cast<sockaddr*>(&from), &fromlen);
+		if (bytes < (int)sizeof(SpoutBridgeHeader))
+			break; // WSAEWOULDBLOCK if there are no more
+
+		SpoutBridgeHeader header={};
+		memcpy(&header, m_Datagram.data(), sizeof(SpoutBridgeHeader));
+		if (header.id != SPOUT_BRIDGE_ID || header.type != SPOUT_BRIDGE_FRAME)
+			continue;
+
+		// Key frame requests are returned to the bridge sender
+		m_PeerAddress = from;
+		m_bPeer = true;
+
+		ReceiveFragment(header, m_Datagram.data() + sizeof(SpoutBridgeHeader),
+			(unsigned int)bytes - (unsigned int)sizeof(SpoutBridgeHeader));
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetBridgeFrame
+// Sender frame number of the last frame received
+LONG64 spoutBridge::GetBridgeFrame()
+{
+	return m_BridgeFrame;
+}
+
+//---------------------------------------------------------
+// Function: GetBridgeTimestamp
+// Sender timestamp of the last frame received.
+//
+//   100 nanosecond units from the first frame encoded.
+LONG64 spoutBridge::GetBridgeTimestamp()
+{
+	return m_BridgeTimestamp;
+}
+
+//---------------------------------------------------------
+// Function: GetBridgeLost
+// Frames lost or incomplete
+unsigned __int64 spoutBridge::GetBridgeLost()
+{
+	return m_BridgeLost;
+}
+
+//---------------------------------------------------------
+// Function: StopBridge
+// Stop sending or receiving
+void spoutBridge::StopBridge()
+{
+	if (m_bBridgeSend)
+		StopEncoding();
+
+	if (m_bBridgeReceive) {
+		ReleaseDecoder();
+		ReleaseSender();
+		SpoutLogNotice("spoutBridge::StopBridge - %llu frames lost", m_BridgeLost);
+	}
+
+	if (m_BridgeSocket != INVALID_SOCKET)
+		closesocket(m_BridgeSocket);
+	m_BridgeSocket = INVALID_SOCKET;
+
+	m_Assemble.clear();
+	m_AssembleFragment.clear();
+	m_bAssembling = false;
+	m_bBridgeSend = false;
+	m_bBridgeReceive = false;
+}
+
+//
+// Protected
+//
+
+// Create a non-blocking UDP socket.
+// A bridge sender connects to the receiver address.
+// A bridge receiver binds to the port on all interfaces.
+bool spoutBridge::OpenBridgeSocket(unsigned short port, const char* address)
+{
+	if (!m_bWinsock) {
+		WSADATA wsaData={};
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+			SpoutLogError("spoutBridge::OpenBridgeSocket - WSAStartup failed");
+			return false;
+		}
+		m_bWinsock = true;
+	}
+
+	m_BridgeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (m_BridgeSocket == INVALID_SOCKET) {
+		SpoutLogError("spoutBridge::OpenBridgeSocket - could not create socket (%d)", WSAGetLastError());
+		return false;
+	}
+
+	u_long nonblocking = 1;
+	ioctlsocket(m_BridgeSocket, FIONBIO, &nonblocking);
+
+	// Buffers for the datagrams of several large frames
+	int buffersize = 8*1024*1024;
+	setsockopt(m_BridgeSocket, SOL_SOCKET, address ? SO_SNDBUF : SO_RCVBUF,
+		reinterpret_cast<const char*>(&buffersize), (int)sizeof(buffersize));
+
+	sockaddr_in addr={};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	int result = 0;
+	if (address) {
+		if (inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+			SpoutLogError("spoutBridge::OpenBridgeSocket - invalid address [%s]", address);
+			StopBridge();
+			return false;
+		}
+		result = connect(m_BridgeSocket, reinterpret_cast<sockaddr*>(&addr), (int)sizeof(addr));
+	}
+	else {
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		result = bind(m_BridgeSocket, reinterpret_cast<sockaddr*>(&addr), (int)sizeof(addr));
+	}
+	if (result == SOCKET_ERROR) {
+		SpoutLogError("spoutBridge::OpenBridgeSocket - port %d failed (%d)", port, WSAGetLastError());
+		StopBridge();
+		return false;
+	}
+
+	m_Datagram.resize(SPOUT_BRIDGE_DATAGRAM);
+
+	return true;
+}
+
+// Send an encoded frame as datagrams of the header and a fragment
+bool spoutBridge::SendBridgePacket(const SpoutEncodedPacket &packet)
+{
+	const unsigned int size = (unsigned int)packet.data.size();
+	if (size == 0)
+		return false;
+
+	SpoutBridgeHeader header={};
+	header.id = SPOUT_BRIDGE_ID;
+	header.type = SPOUT_BRIDGE_FRAME;
+	header.codec = (uint16_t)m_Codec;
+	header.sequence = ++m_BridgeSequence;
+	header.fragments = (uint16_t)((size + SPOUT_BRIDGE_PAYLOAD - 1)/SPOUT_BRIDGE_PAYLOAD);
+	header.size = size;
+	header.width = m_EncodeWidth;
+	header.height = m_EncodeHeight;
+	header.frame = packet.frame;
+	header.timestamp = packet.timestamp;
+	header.flags = packet.keyframe ? SPOUT_BRIDGE_KEYFRAME : 0;
+
+	bool bRet = true;
+	for (unsigned int i = 0; i < header.fragments; i++) {
+		header.fragment = (uint16_t)i;
+		header.offset = i*SPOUT_BRIDGE_PAYLOAD;
+		const unsigned int length = (size - header.offset < (unsigned int)SPOUT_BRIDGE_PAYLOAD)
+			? size - header.offset : (unsigned int)SPOUT_BRIDGE_PAYLOAD;
+		memcpy(m_Datagram.data(), &header, sizeof(SpoutBridgeHeader));
+		memcpy(m_Datagram.data() + sizeof(SpoutBridgeHeader), packet.data.data() + header.offset, length);
+		const int bytes = (int)(sizeof(SpoutBridgeHeader) + length);
+		// The send buffer is large enough for a frame, so a full buffer is a loss
+		if (send(m_BridgeSocket, reinterpret_cast<const char*>(m_Datagram.data()), bytes, 0) != bytes)
+			bRet = false;
+	}
+
+	return bRet;
+}
+
+// Add a fragment to the frame being assembled and decode a complete frame
+void spoutBridge::ReceiveFragment(const SpoutBridgeHeader &header, const unsigned char* data, unsigned int length)
+{
+	if (header.fragments == 0 || header.fragment >= header.fragments
+		|| header.offset + length > header.size)
+		return;
+
+	// Ignore fragments of frames already complete or abandoned
+	if ((int32_t)(header.sequence - m_LastSequence) <= 0 && m_LastSequence != 0)
+		return;
+
+	if (!m_bAssembling || header.sequence != m_AssembleHeader.sequence) {
+		// A later frame has started before the last was complete
+		if (m_bAssembling && (int32_t)(header.sequence - m_AssembleHeader.sequence) < 0)
+			return;
+		if (m_bAssembling) {
+			m_BridgeLost++;
+			m_bWaitKeyframe = true;
+		}
+		// Frames missed entirely
+		if (m_LastSequence != 0 && header.sequence != m_LastSequence + 1 && !m_bWaitKeyframe) {
+			m_BridgeLost += header.sequence - m_LastSequence - 1;
+			m_bWaitKeyframe = true;
+		}
+		m_AssembleHeader = header;
+		m_Assemble.resize(header.size);
+		m_AssembleFragment.assign(header.fragments, false);
+		m_AssembleCount = 0;
+		m_bAssembling = true;
+	}
+
+	if (m_AssembleFragment[header.fragment])
+		return;
+	memcpy(m_Assemble.data() + header.offset, data, length);
+	m_AssembleFragment[header.fragment] = true;
+	m_AssembleCount++;
+	if (m_AssembleCount < m_AssembleHeader.fragments)
+		return;
+
+	// The frame is complete
+	m_bAssembling = false;
+	m_LastSequence = m_AssembleHeader.sequence;
+
+	if (m_bWaitKeyframe) {
+		if (!(m_AssembleHeader.flags & SPOUT_BRIDGE_KEYFRAME)) {
+			RequestBridgeKeyframe();
+			return;
+		}
+		m_bWaitKeyframe = false;
+	}
+
+	if (!DecodeFrame(m_AssembleHeader, m_Assemble.data(), m_AssembleHeader.size))
+		m_bWaitKeyframe = true;
+}
+
+// Ask the bridge sender for a key frame, at most every 100 msec
+void spoutBridge::RequestBridgeKeyframe()
+{
+	if (!m_bPeer)
+		return;
+	const DWORD now = GetTickCount();
+	if (now - m_KeyRequestTime < 100)
+		return;
+	m_KeyRequestTime = now;
+
+	SpoutBridgeHeader request={};
+	request.id = SPOUT_BRIDGE_ID;
+	request.type = SPOUT_BRIDGE_KEYREQUEST;
+	sendto(m_BridgeSocket, reinterpret_cast<const char*>(&request), (int)sizeof(request), 0,
+		reinterpret_cast<const sockaddr*>(&m_PeerAddress), (int)sizeof(m_PeerAddress));
+}
+
+// Create a D3D11 aware decoder for the codec and size
+bool spoutBridge::CreateDecoder(SpoutEncodeCodec codec, unsigned int width, unsigned int height)
+{
+	ReleaseDecoder();
+
+	const GUID subtype = (codec == SPOUT_ENCODE_HEVC) ? MFVideoFormat_HEVC : MFVideoFormat_H264;
+	MFT_REGISTER_TYPE_INFO input = { MFMediaType_Video, subtype };
+	MFT_REGISTER_TYPE_INFO output = { MFMediaType_Video, MFVideoFormat_NV12 };
+	IMFActivate** ppActivate = nullptr;
+	UINT32 count = 0;
+	// The Microsoft decoders are synchronous and use DXVA with the device manager
+	HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_DECODER,
+		MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
+		&input, &output, &ppActivate, &count);
+	if (FAILED(hr) || count == 0) {
+		SpoutLogWarning("spoutBridge::CreateDecoder - no %s decoder", (codec == SPOUT_ENCODE_HEVC) ? "HEVC" : "H.264");
+		if (ppActivate) CoTaskMemFree(ppActivate);
+		return false;
+	}
+	hr = ppActivate[0]->ActivateObject(IID_PPV_ARGS(&m_pDecoder));
+	for (UINT32 i = 0; i < count; i++)
+		ppActivate[i]->Release();
+	CoTaskMemFree(ppActivate);
+	if (FAILED(hr)) {
+		m_pDecoder = nullptr;
+		return false;
+	}
+
+	// Decode to textures of the class device
+	IMFAttributes* pAttributes = nullptr;
+	bool bD3D11 = false;
+	if (SUCCEEDED(m_pDecoder->GetAttributes(&pAttributes))) {
+		bD3D11 = (MFGetAttributeUINT32(pAttributes, MF_SA_D3D11_AWARE, FALSE) != 0);
+		// Output each frame without reordering delay
+		pAttributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+		pAttributes->Release();
+	}
+	if (bD3D11)
+		hr = m_pDecoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, reinterpret_cast<ULONG_PTR>(m_pDeviceManager));
+	if (!bD3D11 || FAILED(hr)) {
+		SpoutLogWarning("spoutBridge::CreateDecoder - decoder does not support D3D11");
+		ReleaseDecoder();
+		return false;
+	}
+
+	IMFMediaType* pType = nullptr;
+	hr = MFCreateMediaType(&pType);
+	if (SUCCEEDED(hr)) {
+		pType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+		pType->SetGUID(MF_MT_SUBTYPE, subtype);
+		pType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+		MFSetAttributeSize(pType, MF_MT_FRAME_SIZE, width, height);
+		hr = m_pDecoder->SetInputType(0, pType, 0);
+		pType->Release();
+	}
+	if (FAILED(hr) || !SetDecoderOutputType()) {
+		SpoutLogWarning("spoutBridge::CreateDecoder - %dx%d not supported (0x%.7X)", width, height, (unsigned int)hr);
+		ReleaseDecoder();
+		return false;
+	}
+
+	if (!CreateDecodeProcessor(width, height)) {
+		ReleaseDecoder();
+		return false;
+	}
+
+	m_pDecoder->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+	m_pDecoder->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+
+	m_DecodeCodec = codec;
+	m_DecodeWidth = width;
+	m_DecodeHeight = height;
+	m_DecodeTimes.clear();
+
+	SpoutLogNotice("spoutBridge::CreateDecoder - %s %dx%d",
+		(codec == SPOUT_ENCODE_HEVC) ? "HEVC" : "H.264", width, height);
+
+	return true;
+}
+
+// Set the NV12 output type offered by the decoder
+bool spoutBridge::SetDecoderOutputType()
+{
+	for (DWORD i = 0; ; i++) {
+		IMFMediaType* pType = nullptr;
+		if (FAILED(m_pDecoder->GetOutputAvailableType(0, i, &pType)))
+			return false;
+		GUID subtype = GUID_NULL;
+		pType->GetGUID(MF_MT_SUBTYPE, &subtype);
+		HRESULT hr = E_FAIL;
+		if (subtype == MFVideoFormat_NV12)
+			hr = m_pDecoder->SetOutputType(0, pType, 0);
+		pType->Release();
+		if (SUCCEEDED(hr))
+			return true;
+	}
+}
+
+// Decode a complete frame and send the decoded frames
+bool spoutBridge::DecodeFrame(const SpoutBridgeHeader &header, const unsigned char* data, unsigned int size)
+{
+	if (!m_pDecoder || header.codec != (uint16_t)m_DecodeCodec
+		|| header.width != m_DecodeWidth || header.height != m_DecodeHeight) {
+		if (!CreateDecoder((SpoutEncodeCodec)header.codec, header.width, header.height))
+			return false;
+	}
+
+	IMFMediaBuffer* pBuffer = nullptr;
+	IMFSample* pSample = nullptr;
+	HRESULT hr = MFCreateMemoryBuffer(size, &pBuffer);
+	if (SUCCEEDED(hr)) {
+		BYTE* pData = nullptr;
+		hr = pBuffer->Lock(&pData, nullptr, nullptr);
+		if (SUCCEEDED(hr)) {
+			memcpy(pData, data, size);
+			pBuffer->Unlock();
+			pBuffer->SetCurrentLength(size);
+		}
+	}
+	if (SUCCEEDED(hr))
+		hr = MFCreateSample(&pSample);
+	if (SUCCEEDED(hr))
+		hr = pSample->AddBuffer(pBuffer);
+	if (SUCCEEDED(hr)) {
+		pSample->SetSampleTime(header.timestamp);
+		if (header.flags & SPOUT_BRIDGE_KEYFRAME)
+			pSample->SetUINT32(MFSampleExtension_CleanPoint, TRUE);
+		hr = m_pDecoder->ProcessInput(0, pSample, 0);
+	}
+	if (pSample) pSample->Release();
+	if (pBuffer) pBuffer->Release();
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutBridge::DecodeFrame - decoder input failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	// The sender frame of the output is found from the timestamp
+	m_DecodeTimes.push_back(std::make_pair((LONG64)header.timestamp, (LONG64)header.frame));
+	if (m_DecodeTimes.size() > SPOUT_ENCODE_PACKETS)
+		m_DecodeTimes.pop_front();
+
+	// Output all frames ready
+	for (;;) {
+		MFT_OUTPUT_DATA_BUFFER output={};
+		DWORD status = 0;
+		hr = m_pDecoder->ProcessOutput(0, 1, &output, &status);
+		if (output.pEvents)
+			output.pEvents->Release();
+		if (hr == MF_E_TRANSFORM_STREAM_CHANGE) {
+			// The decoder has found the stream format
+			if (output.pSample) output.pSample->Release();
+			if (!SetDecoderOutputType())
+				return false;
+			continue;
+		}
+		if (FAILED(hr)) {
+			if (output.pSample) output.pSample->Release();
+			// MF_E_TRANSFORM_NEED_MORE_INPUT when all are output
+			return (hr == MF_E_TRANSFORM_NEED_MORE_INPUT);
+		}
+		if (output.pSample) {
+			SendDecodedSample(output.pSample);
+			output.pSample->Release();
+		}
+	}
+}
+
+// Convert a decoded texture to the BGRA texture and send it
+bool spoutBridge::SendDecodedSample(IMFSample* pSample)
+{
+	IMFMediaBuffer* pBuffer = nullptr;
+	IMFDXGIBuffer* pDXGIBuffer = nullptr;
+	ID3D11Texture2D* pTexture = nullptr;
+	UINT subresource = 0;
+	HRESULT hr = pSample->GetBufferByIndex(0, &pBuffer);
+	if (SUCCEEDED(hr))
+		hr = pBuffer->QueryInterface(IID_PPV_ARGS(&pDXGIBuffer));
+	if (SUCCEEDED(hr))
+		hr = pDXGIBuffer->GetResource(IID_PPV_ARGS(&pTexture));
+	if (SUCCEEDED(hr))
+		hr = pDXGIBuffer->GetSubresourceIndex(&subresource);
+
+	// The decoder outputs to a slice of a texture array
+	ID3D11VideoProcessorInputView* pInputView = nullptr;
+	if (SUCCEEDED(hr)) {
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd={};
+		ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		ivd.Texture2D.ArraySlice = subresource;
+		hr = m_pEncodeVideoDevice->CreateVideoProcessorInputView(pTexture, m_pDecodeEnum, &ivd, &pInputView);
+	}
+	if (SUCCEEDED(hr)) {
+		D3D11_VIDEO_PROCESSOR_STREAM stream={};
+		stream.Enable = TRUE;
+		stream.pInputSurface = pInputView;
+		hr = m_pEncodeVideoContext->VideoProcessorBlt(m_pDecodeProcessor, m_pBridgeView, 0, 1, &stream);
+	}
+	if (pInputView) pInputView->Release();
+	if (pTexture) pTexture->Release();
+	if (pDXGIBuffer) pDXGIBuffer->Release();
+	if (pBuffer) pBuffer->Release();
+
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutBridge::SendDecodedSample - decoded frame not converted (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	LONGLONG time = 0;
+	pSample->GetSampleTime(&time);
+	m_BridgeTimestamp = time;
+	while (!m_DecodeTimes.empty() && m_DecodeTimes.front().first <= time) {
+		if (m_DecodeTimes.front().first == time)
+			m_BridgeFrame = m_DecodeTimes.front().second;
+		m_DecodeTimes.pop_front();
+	}
+
+	return SendTexture(m_pBridgeTexture);
+}
+
+// Release the decoder and the BGRA conversion
+void spoutBridge::ReleaseDecoder()
+{
+	if (m_pDecoder) {
+		m_pDecoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+		m_pDecoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, 0);
+		m_pDecoder->Release();
+	}
+	m_pDecoder = nullptr;
+	m_DecodeWidth = 0;
+	m_DecodeHeight = 0;
+	m_DecodeTimes.clear();
+	ReleaseDecodeProcessor();
+}
+
+// Create the video processor and the BGRA texture sent
+bool spoutBridge::CreateDecodeProcessor(unsigned int width, unsigned int height)
+{
+	ReleaseDecodeProcessor();
+
+	// The video device and context of the encoder are not used by a bridge receiver
+	HRESULT hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&m_pEncodeVideoDevice));
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(IID_PPV_ARGS(&m_pEncodeVideoContext));
+
+	D3D11_VIDEO_PROCESSOR_CONTENT_DESC content={};
+	content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+	content.InputWidth   = width;
+	content.InputHeight  = height;
+	content.OutputWidth  = width;
+	content.OutputHeight = height;
+	content.Usage = D3D11_VIDEO_USAGE_OPTIMAL_SPEED;
+	if (SUCCEEDED(hr))
+		hr = m_pEncodeVideoDevice->CreateVideoProcessorEnumerator(&content, &m_pDecodeEnum);
+	if (SUCCEEDED(hr))
+		hr = m_pEncodeVideoDevice->CreateVideoProcessor(m_pDecodeEnum, 0, &m_pDecodeProcessor);
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice->CreateTexture2D(&desc, nullptr, &m_pBridgeTexture);
+	D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd={};
+	ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+	if (SUCCEEDED(hr))
+		hr = m_pEncodeVideoDevice->CreateVideoProcessorOutputView(m_pBridgeTexture, m_pDecodeEnum, &ovd, &m_pBridgeView);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutBridge::CreateDecodeProcessor - failed (0x%.7X)", (unsigned int)hr);
+		ReleaseDecodeProcessor();
+		return false;
+	}
+
+	// BT.709 studio range in, RGB full range out
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE incs={};
+	incs.YCbCr_Matrix = 1; // BT.709
+	incs.Nominal_Range = D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE outcs={};
+	outcs.RGB_Range = 0; // 0-255
+	m_pEncodeVideoContext->VideoProcessorSetStreamColorSpace(m_pDecodeProcessor, 0, &incs);
+	m_pEncodeVideoContext->VideoProcessorSetOutputColorSpace(m_pDecodeProcessor, &outcs);
+	m_pEncodeVideoContext->VideoProcessorSetStreamFrameFormat(m_pDecodeProcessor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+	m_pEncodeVideoContext->VideoProcessorSetStreamAutoProcessingMode(m_pDecodeProcessor, 0, FALSE);
+	// Decoded textures can be larger than the frame (e.g. 1088 lines)
+	const RECT rect = { 0, 0, (LONG)width, (LONG)height };
+	m_pEncodeVideoContext->VideoProcessorSetStreamSourceRect(m_pDecodeProcessor, 0, TRUE, &rect);
+
+	return true;
+}
+
+// Release the video processor and the BGRA texture
+void spoutBridge::ReleaseDecodeProcessor()
+{
+	if (m_pBridgeView) m_pBridgeView->Release();
+	if (m_pBridgeTexture) m_pBridgeTexture->Release();
+	if (m_pDecodeProcessor) m_pDecodeProcessor->Release();
+	if (m_pDecodeEnum) m_pDecodeEnum->Release();
+	m_pBridgeView = nullptr;
+	m_pBridgeTexture = nullptr;
+	m_pDecodeProcessor = nullptr;
+	m_pDecodeEnum = nullptr;
+	// Video device and context
+	ReleaseEncodeProcessor();
+}
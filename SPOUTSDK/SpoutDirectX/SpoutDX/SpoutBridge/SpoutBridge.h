@@ -0,0 +1,159 @@
+/*
+
+	spoutBridge.h
+
+	Functions to bridge a Spout sender to another computer over a network
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutBridge__
+#define __spoutBridge__
+
+// Winsock 2 must be included before windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "..\SpoutEncoder\SpoutEncoder.h" // Base class
+
+#pragma comment (lib, "ws2_32.lib")
+
+// Identifier of bridge datagrams "SPBR"
+#define SPOUT_BRIDGE_ID 0x52425053
+// Datagram types
+#define SPOUT_BRIDGE_FRAME 1 // Fragment of an encoded frame
+#define SPOUT_BRIDGE_KEYREQUEST 2 // Receiver request for a key frame
+// Flags
+#define SPOUT_BRIDGE_KEYFRAME 1
+// Largest datagram, within the Ethernet MTU to avoid IP fragmentation
+#define SPOUT_BRIDGE_DATAGRAM 1400
+
+//
+// Header of each bridge datagram (56 bytes)
+//
+struct SpoutBridgeHeader {
+	uint32_t id; // SPOUT_BRIDGE_ID
+	uint16_t type; // SPOUT_BRIDGE_FRAME or SPOUT_BRIDGE_KEYREQUEST
+	uint16_t codec; // SpoutEncodeCodec
+	uint32_t sequence; // Encoded frame sequence number
+	uint16_t fragment; // Fragment index
+	uint16_t fragments; // Number of fragments of the frame
+	uint32_t size; // Bytes of the encoded frame
+	uint32_t offset; // Position of the fragment data in the frame
+	uint32_t width; // Frame width
+	uint32_t height; // Frame height
+	int64_t frame; // Sender frame number
+	int64_t timestamp; // Sender time in 100 nanosecond units
+	uint32_t flags; // SPOUT_BRIDGE_KEYFRAME
+	uint32_t reserved;
+};
+
+// Fragment data of each datagram
+#define SPOUT_BRIDGE_PAYLOAD (SPOUT_BRIDGE_DATAGRAM - (int)sizeof(SpoutBridgeHeader))
+
+class spoutBridge : public spoutEncoder {
+
+	public:
+
+		spoutBridge();
+		~spoutBridge();
+
+		//
+		// Bridge sender
+		//
+
+		// Start sending a Spout sender to an address and port
+		bool StartBridgeSend(const char* address, unsigned short port,
+			SpoutEncodeCodec codec = SPOUT_ENCODE_H264, unsigned int bitrate = 0, unsigned int fps = 60);
+		// Encode and send a new frame
+		bool BridgeSend();
+
+		//
+		// Bridge receiver
+		//
+
+		// Start receiving on a port to a Spout sender
+		bool StartBridgeReceive(unsigned short port, const char* sendername);
+		// Receive, decode and send the frames that have arrived
+		bool BridgeReceive();
+		// Sender frame number of the last frame received
+		LONG64 GetBridgeFrame();
+		// Sender timestamp of the last frame received
+		LONG64 GetBridgeTimestamp();
+		// Frames lost or incomplete
+		unsigned __int64 GetBridgeLost();
+
+		// Stop sending or receiving
+		void StopBridge();
+
+	protected:
+
+		SOCKET m_BridgeSocket;
+		bool m_bWinsock;
+		bool m_bBridgeSend;
+		bool m_bBridgeReceive;
+		uint32_t m_BridgeSequence; // Frame sequence number
+		std::vector<unsigned char> m_Datagram; // Datagram buffer
+		bool OpenBridgeSocket(unsigned short port, const char* address);
+		bool SendBridgePacket(const SpoutEncodedPacket &packet);
+
+		// Reassembly of the fragments of a frame
+		SpoutBridgeHeader m_AssembleHeader; // Header of the frame being assembled
+		std::vector<unsigned char> m_Assemble; // Frame data
+		std::vector<bool> m_AssembleFragment; // Fragments received
+		unsigned int m_AssembleCount; // Number of fragments received
+		bool m_bAssembling;
+		bool m_bWaitKeyframe; // Frames are skipped after a loss until a key frame
+		uint32_t m_LastSequence; // Sequence of the last complete frame
+		sockaddr_in m_PeerAddress; // Bridge sender for key frame requests
+		bool m_bPeer;
+		DWORD m_KeyRequestTime; // Time of the last key frame request
+		unsigned __int64 m_BridgeLost;
+		LONG64 m_BridgeFrame;
+		LONG64 m_BridgeTimestamp;
+		void ReceiveFragment(const SpoutBridgeHeader &header, const unsigned char* data, unsigned int length);
+		void RequestBridgeKeyframe();
+
+		// Hardware decoder
+		IMFTransform* m_pDecoder;
+		SpoutEncodeCodec m_DecodeCodec;
+		unsigned int m_DecodeWidth;
+		unsigned int m_DecodeHeight;
+		std::deque<std::pair<LONG64, LONG64>> m_DecodeTimes; // Timestamp and sender frame passed to the decoder
+		bool CreateDecoder(SpoutEncodeCodec codec, unsigned int width, unsigned int height);
+		bool SetDecoderOutputType();
+		bool DecodeFrame(const SpoutBridgeHeader &header, const unsigned char* data, unsigned int size);
+		bool SendDecodedSample(IMFSample* pSample);
+		void ReleaseDecoder();
+
+		// GPU conversion of the decoded NV12 texture to the sender texture
+		ID3D11VideoProcessorEnumerator* m_pDecodeEnum;
+		ID3D11VideoProcessor* m_pDecodeProcessor;
+		ID3D11Texture2D* m_pBridgeTexture; // BGRA texture sent
+		ID3D11VideoProcessorOutputView* m_pBridgeView;
+		bool CreateDecodeProcessor(unsigned int width, unsigned int height);
+		void ReleaseDecodeProcessor();
+
+};
+
+#endif
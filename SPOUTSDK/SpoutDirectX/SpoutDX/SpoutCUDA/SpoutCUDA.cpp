@@ -0,0 +1,348 @@
+//
+//		spoutCUDA.cpp
+//
+//		Functions to receive Spout textures to CUDA by D3D11 interop
+//		Base class spoutDX for receiving functions.
+//
+// ====================================================================================
+//		Revisions :
+//		14.10.26	- Start class. The class receiving texture is registered with
+//					  CUDA and mapped as a CUDA array or copied to a linear
+//					  device buffer without transfer by way of system memory.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutCUDA.h"
+
+//
+// Class: spoutCUDA
+//
+// Functions to receive Spout textures to CUDA by D3D11 interop.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// The sender shared texture is copied to the class receiving texture by
+// ReceiveTexture within the sender mutex lock, as for any D3D11 receiver.
+// The receiving texture is registered with CUDA and mapped on the application
+// stream. Mapping orders CUDA work after the D3D11 copy and unmapping orders
+// the next D3D11 copy after CUDA work, so no further sync is necessary.
+//
+// Refer to source code for further details.
+//
+
+spoutCUDA::spoutCUDA() {
+
+	m_bCUDA = false;
+	m_CUDADevice = -1;
+	m_pCUDAResource = nullptr;
+	m_pCUDATexture = nullptr;
+	m_CUDAStream = 0;
+	m_bCUDAMapped = false;
+	m_pCUDABuffer = nullptr;
+	m_CUDAPitch = 0;
+	m_CUDABufferWidth = 0;
+	m_CUDABufferHeight = 0;
+	m_CUDABufferPixelSize = 0;
+
+}
+
+spoutCUDA::~spoutCUDA() {
+
+	CloseCUDA();
+
+}
+
+//
+// Group: CUDA
+//
+
+// Function: OpenCUDA
+// Initialize CUDA using the device of the D3D11 graphics adapter.
+// A class D3D11 device is created if not already initialized.
+bool spoutCUDA::OpenCUDA()
+{
+	if (m_bCUDA)
+		return true;
+
+	if (!OpenDirectX11())
+		return false;
+
+	// The CUDA device for the D3D11 adapter
+	IDXGIDevice* pDXGIDevice = nullptr;
+	IDXGIAdapter* pAdapter = nullptr;
+	if (SUCCEEDED(m_pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&pDXGIDevice)))) {
+		pDXGIDevice->GetAdapter(&pAdapter);
+		pDXGIDevice->Release();
+	}
+	if (!pAdapter) {
+		SpoutLogError("spoutCUDA::OpenCUDA - could not get D3D11 adapter");
+		return false;
+	}
+
+	int device = -1;
+	cudaError_t err = cudaD3D11GetDevice(&device, pAdapter);
+	pAdapter->Release();
+	if (err == cudaSuccess)
+		err = cudaSetDevice(device);
+	if (err != cudaSuccess) {
+		SpoutLogError("spoutCUDA::OpenCUDA - no CUDA device for the adapter (%s)", cudaGetErrorString(err));
+		return false;
+	}
+
+	m_CUDADevice = device;
+	m_bCUDA = true;
+
+	cudaDeviceProp prop = {};
+	cudaGetDeviceProperties(&prop, device);
+	SpoutLogNotice("spoutCUDA::OpenCUDA - device %d (%s)", device, prop.name);
+
+	return true;
+}
+
+// Function: CloseCUDA
+// Release CUDA resources.
+void spoutCUDA::CloseCUDA()
+{
+	if (!m_bCUDA)
+		return;
+
+	ReleaseCUDAFrame();
+	UnregisterCUDATexture();
+	ReleaseCUDABuffer();
+
+	m_CUDADevice = -1;
+	m_bCUDA = false;
+}
+
+// Function: IsCUDAOpen
+// CUDA is initialized
+bool spoutCUDA::IsCUDAOpen()
+{
+	return m_bCUDA;
+}
+
+// Function: GetCUDADevice
+// CUDA device index or -1 if not initialized
+int spoutCUDA::GetCUDADevice()
+{
+	return m_CUDADevice;
+}
+
+//
+// Group: Receiver
+//
+
+// Function: ReceiveCUDAArray
+// Receive a sender texture to a CUDA array.
+//
+// The class receiving texture is mapped on the stream and the array
+// can be used by work on the stream until the next receive or ReleaseCUDAFrame.
+// The array has the sender size and format. See GetSenderFormat and GetCUDAPixelSize.
+bool spoutCUDA::ReceiveCUDAArray(cudaArray_t* pArray, cudaStream_t stream)
+{
+	if (!pArray)
+		return false;
+
+	*pArray = nullptr;
+
+	if (!OpenCUDA())
+		return false;
+
+	// The texture is unmapped before D3D11 copies the next frame to it
+	ReleaseCUDAFrame();
+
+	// Copy the sender texture to the class receiving texture
+	if (!ReceiveTexture())
+		return false;
+
+	// Return if flagged for update
+	if (m_bUpdated || !m_pTexture)
+		return false;
+
+	// Register the receiving texture if created or re-created
+	if (m_pTexture != m_pCUDATexture) {
+		if (!RegisterCUDATexture())
+			return false;
+	}
+
+	cudaError_t err = cudaGraphicsMapResources(1, &m_pCUDAResource, stream);
+	if (err != cudaSuccess) {
+		SpoutLogWarning("spoutCUDA::ReceiveCUDAArray - map failed (%s)", cudaGetErrorString(err));
+		return false;
+	}
+	m_bCUDAMapped = true;
+	m_CUDAStream = stream;
+
+	err = cudaGraphicsSubResourceGetMappedArray(pArray, m_pCUDAResource, 0, 0);
+	if (err != cudaSuccess) {
+		SpoutLogWarning("spoutCUDA::ReceiveCUDAArray - no mapped array (%s)", cudaGetErrorString(err));
+		ReleaseCUDAFrame();
+		*pArray = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+// Function: ReceiveCUDABuffer
+// Receive a sender texture to a linear CUDA device buffer.
+//
+// The mapped array is copied on the stream to a class pitched device buffer
+// and unmapped. The buffer is valid until the next receive or the sender changes.
+// Each line is "pitch" bytes of GetSenderWidth() * GetCUDAPixelSize() pixel data.
+bool spoutCUDA::ReceiveCUDABuffer(void** ppBuffer, size_t* pPitch, cudaStream_t stream)
+{
+	if (!ppBuffer || !pPitch)
+		return false;
+
+	*ppBuffer = nullptr;
+	*pPitch = 0;
+
+	cudaArray_t pArray = nullptr;
+	if (!ReceiveCUDAArray(&pArray, stream))
+		return false;
+
+	const unsigned int pixelsize = GetCUDAPixelSize();
+	if (pixelsize == 0 || !CheckCUDABuffer(m_Width, m_Height, pixelsize)) {
+		ReleaseCUDAFrame();
+		return false;
+	}
+
+	cudaError_t err = cudaMemcpy2DFromArrayAsync(m_pCUDABuffer, m_CUDAPitch, pArray, 0, 0,
+		(size_t)m_Width * pixelsize, m_Height, cudaMemcpyDeviceToDevice, stream);
+	ReleaseCUDAFrame();
+	if (err != cudaSuccess) {
+		SpoutLogWarning("spoutCUDA::ReceiveCUDABuffer - copy failed (%s)", cudaGetErrorString(err));
+		return false;
+	}
+
+	*ppBuffer = m_pCUDABuffer;
+	*pPitch = m_CUDAPitch;
+
+	return true;
+}
+
+// Function: ReleaseCUDAFrame
+// Unmap the array returned by ReceiveCUDAArray.
+// Work on the stream using the array is complete before the texture is used by D3D11.
+void spoutCUDA::ReleaseCUDAFrame()
+{
+	if (m_bCUDAMapped && m_pCUDAResource)
+		cudaGraphicsUnmapResources(1, &m_pCUDAResource, m_CUDAStream);
+	m_bCUDAMapped = false;
+	m_CUDAStream = 0;
+}
+
+// Function: GetCUDAPixelSize
+// Bytes per pixel of the received texture format, 0 if not supported
+unsigned int spoutCUDA::GetCUDAPixelSize()
+{
+	switch ((DXGI_FORMAT)m_dwFormat) {
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+			return 4;
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			return 8;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+//
+// Protected
+//
+
+// Register the class receiving texture with CUDA
+bool spoutCUDA::RegisterCUDATexture()
+{
+	UnregisterCUDATexture();
+
+	cudaError_t err = cudaGraphicsD3D11RegisterResource(&m_pCUDAResource, m_pTexture, cudaGraphicsRegisterFlagsNone);
+	if (err != cudaSuccess) {
+		SpoutLogWarning("spoutCUDA::RegisterCUDATexture - could not register texture format %d (%s)",
+			(int)m_dwFormat, cudaGetErrorString(err));
+		m_pCUDAResource = nullptr;
+		return false;
+	}
+	cudaGraphicsResourceSetMapFlags(m_pCUDAResource, cudaGraphicsMapFlagsReadOnly);
+	m_pCUDATexture = m_pTexture;
+
+	SpoutLogNotice("spoutCUDA::RegisterCUDATexture - %dx%d format %d", m_Width, m_Height, (int)m_dwFormat);
+
+	return true;
+}
+
+void spoutCUDA::UnregisterCUDATexture()
+{
+	if (m_pCUDAResource)
+		cudaGraphicsUnregisterResource(m_pCUDAResource);
+	m_pCUDAResource = nullptr;
+	m_pCUDATexture = nullptr;
+}
+
+// Create or update the linear device buffer
+bool spoutCUDA::CheckCUDABuffer(unsigned int width, unsigned int height, unsigned int pixelsize)
+{
+	if (m_pCUDABuffer && width == m_CUDABufferWidth && height == m_CUDABufferHeight && pixelsize == m_CUDABufferPixelSize)
+		return true;
+
+	ReleaseCUDABuffer();
+
+	cudaError_t err = cudaMallocPitch(&m_pCUDABuffer, &m_CUDAPitch, (size_t)width * pixelsize, height);
+	if (err != cudaSuccess) {
+		SpoutLogWarning("spoutCUDA::CheckCUDABuffer - could not allocate %dx%d buffer (%s)", width, height, cudaGetErrorString(err));
+		m_pCUDABuffer = nullptr;
+		m_CUDAPitch = 0;
+		return false;
+	}
+
+	m_CUDABufferWidth = width;
+	m_CUDABufferHeight = height;
+	m_CUDABufferPixelSize = pixelsize;
+
+	return true;
+}
+
+void spoutCUDA::ReleaseCUDABuffer()
+{
+	if (m_pCUDABuffer) {
+		// The buffer may still be in use by work on a stream
+		cudaDeviceSynchronize();
+		cudaFree(m_pCUDABuffer);
+	}
+	m_pCUDABuffer = nullptr;
+	m_CUDAPitch = 0;
+	m_CUDABufferWidth = 0;
+	m_CUDABufferHeight = 0;
+	m_CUDABufferPixelSize = 0;
+}
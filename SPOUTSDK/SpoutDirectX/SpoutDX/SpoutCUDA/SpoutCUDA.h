@@ -0,0 +1,88 @@
+/*
+
+	spoutCUDA.h
+
+	Functions to receive Spout textures to CUDA by D3D11 interop
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutCUDA__
+#define __spoutCUDA__
+
+#include "..\SpoutDX.h" // Base class
+
+#include <cuda_runtime.h>
+#include <cuda_d3d11_interop.h>
+#pragma comment (lib, "cudart.lib") // CUDA runtime
+
+class spoutCUDA : public spoutDX {
+
+	public:
+
+		spoutCUDA();
+		~spoutCUDA();
+
+		// Initialize CUDA on the device of the D3D11 adapter
+		bool OpenCUDA();
+		// Release CUDA resources
+		void CloseCUDA();
+		// CUDA is initialized
+		bool IsCUDAOpen();
+		// CUDA device index
+		int GetCUDADevice();
+
+		// Receive a sender texture to a CUDA array mapped on the stream.
+		// The array is valid for work on the stream until the next receive or ReleaseCUDAFrame.
+		bool ReceiveCUDAArray(cudaArray_t* pArray, cudaStream_t stream = 0);
+		// Receive a sender texture to a linear CUDA device buffer.
+		// The buffer is valid until the next receive or until the sender changes.
+		bool ReceiveCUDABuffer(void** ppBuffer, size_t* pPitch, cudaStream_t stream = 0);
+		// Unmap the array returned by ReceiveCUDAArray
+		void ReleaseCUDAFrame();
+		// Bytes per pixel of the received texture format
+		unsigned int GetCUDAPixelSize();
+
+	protected:
+
+		bool m_bCUDA;
+		int m_CUDADevice;
+		cudaGraphicsResource_t m_pCUDAResource; // Registered class receiving texture
+		ID3D11Texture2D* m_pCUDATexture; // Texture that is registered
+		cudaStream_t m_CUDAStream; // Stream of the mapped resource
+		bool m_bCUDAMapped;
+		void* m_pCUDABuffer; // Linear device buffer
+		size_t m_CUDAPitch;
+		unsigned int m_CUDABufferWidth;
+		unsigned int m_CUDABufferHeight;
+		unsigned int m_CUDABufferPixelSize;
+
+		bool RegisterCUDATexture();
+		void UnregisterCUDATexture();
+		bool CheckCUDABuffer(unsigned int width, unsigned int height, unsigned int pixelsize);
+		void ReleaseCUDABuffer();
+
+};
+
+#endif
@@ -0,0 +1,487 @@
+//
+//		spoutCapture.cpp
+//
+//		Functions to send a monitor or window captured by DXGI Desktop Duplication
+//		Base class spoutDX for the D3D11 device and Spout functions.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. Each desktop frame acquired by Desktop Duplication
+//					  is copied GPU to GPU to the sender texture, only the changed
+//					  regions if the duplication reports them.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutCapture.h"
+
+//
+// Class: spoutCapture
+//
+// Functions to send a monitor or window captured by DXGI Desktop Duplication.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// The desktop image of a monitor is duplicated with the class device.
+// AcquireNextFrame waits until the desktop has a new frame, so capture
+// runs at the refresh rate of the monitor and does not poll. The desktop
+// image is copied on the GPU to the sender texture by SendTexture. The
+// changed and moved regions reported by the duplication are copied alone
+// and are published for receivers that read back only changed regions.
+//
+// For a window, the client area on the monitor is sent whenever a changed
+// region overlaps it. The application should be DPI aware so that the
+// window coordinates are those of the desktop.
+//
+// The mouse pointer is not drawn. Monitor rotation is not applied.
+//
+// Refer to source code for further details.
+//
+
+spoutCapture::spoutCapture() {
+
+	m_pDuplication = nullptr;
+	m_CaptureOutput = 0;
+	ZeroMemory(&m_OutputRect, sizeof(m_OutputRect));
+	m_CaptureWidth = 0;
+	m_CaptureHeight = 0;
+	m_hCaptureWnd = NULL;
+	m_bCaptureWhole = true;
+	m_bCapturing = false;
+	m_CapturedFrames = 0;
+	m_CapturedRegions = 0;
+
+	m_hCaptureThread = NULL;
+	m_hCaptureStop = NULL;
+
+}
+
+spoutCapture::~spoutCapture() {
+
+	StopCaptureThread();
+	StopCapture();
+
+}
+
+//
+// Group: Capture
+//
+
+//---------------------------------------------------------
+// Function: StartCapture
+// Start capture of a monitor.
+//
+//   output - index of the monitor among the outputs of the adapter
+//            used by the class device (see SetAdapter)
+//
+//   Set the sender name with SetSenderName before capture.
+//   The sender is created with the monitor size on the first frame.
+bool spoutCapture::StartCapture(unsigned int output)
+{
+	StopCapture();
+
+	if (!OpenDirectX11())
+		return false;
+
+	m_CaptureOutput = output;
+	if (!CreateDuplication())
+		return false;
+
+	m_bCapturing = true;
+	m_bCaptureWhole = true;
+	m_CapturedFrames = 0;
+	m_CapturedRegions = 0;
+
+	SpoutLogNotice("spoutCapture::StartCapture - output %d (%dx%d)", output, m_CaptureWidth, m_CaptureHeight);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SetCaptureWindow
+// Capture the client area of a window.
+//
+//   The window must be on the monitor being captured and the part
+//   on the monitor is sent. The sender size follows the window size.
+//   Null to capture the whole monitor.
+void spoutCapture::SetCaptureWindow(HWND hWnd)
+{
+	m_hCaptureWnd = hWnd;
+	m_bCaptureWhole = true;
+}
+
+//---------------------------------------------------------
+// Function: CaptureFrame
+// Wait for a new desktop frame and send it.
+//
+//   dwTimeout - milliseconds to wait for a new frame
+//
+//   Returns true if a frame was sent. Returns false for timeout,
+//   a frame with only a mouse pointer update, or if the capture
+//   is interrupted, for example by a mode change or the secure desktop.
+//   Capture resumes with the next call.
+bool spoutCapture::CaptureFrame(DWORD dwTimeout)
+{
+	if (!m_bCapturing)
+		return false;
+
+	// Duplication released after access was lost
+	if (!m_pDuplication) {
+		if (!CreateDuplication()) {
+			// Try again after the timeout
+			Sleep(dwTimeout);
+			return false;
+		}
+	}
+
+	DXGI_OUTDUPL_FRAME_INFO info={};
+	IDXGIResource* pResource = nullptr;
+	HRESULT hr = m_pDuplication->AcquireNextFrame(dwTimeout, &info, &pResource);
+	if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+		return false;
+	if (hr == DXGI_ERROR_ACCESS_LOST) {
+		// Mode change, desktop switch or full screen application.
+		// The duplication is created again by the next call.
+		SpoutLogNotice("spoutCapture::CaptureFrame - access lost");
+		ReleaseDuplication();
+		return false;
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutCapture::CaptureFrame - AcquireNextFrame failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	bool bSent = false;
+
+	// A frame with only a mouse update has no new desktop image
+	if (info.LastPresentTime.QuadPart != 0) {
+		ID3D11Texture2D* pTexture = nullptr;
+		hr = pResource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&pTexture);
+		if (SUCCEEDED(hr)) {
+			const bool bRects = !m_bCaptureWhole && GetCaptureRects(info);
+			if (m_hCaptureWnd) {
+				// The window client area if any changed region overlaps it
+				RECT region={};
+				if (GetWindowRegion(region)) {
+					bool bChanged = !bRects;
+					RECT overlap={};
+					for (size_t i = 0; i < m_CaptureRects.size() && !bChanged; i++)
+						bChanged = (IntersectRect(&overlap, &m_CaptureRects[i], &region) != 0);
+					if (bChanged) {
+						bSent = SendTexture(pTexture, (unsigned int)region.left, (unsigned int)region.top,
+							(unsigned int)(region.right - region.left), (unsigned int)(region.bottom - region.top));
+					}
+				}
+			}
+			else if (bRects) {
+				// Only the changed regions
+				if (!m_CaptureRects.empty()) {
+					bSent = SendTexture(pTexture, m_CaptureRects.data(), (unsigned int)m_CaptureRects.size());
+					if (bSent)
+						m_CapturedRegions++;
+				}
+			}
+			else {
+				bSent = SendTexture(pTexture);
+			}
+			pTexture->Release();
+		}
+	}
+
+	pResource->Release();
+	m_pDuplication->ReleaseFrame();
+
+	if (bSent) {
+		m_bCaptureWhole = false;
+		m_CapturedFrames++;
+	}
+
+	return bSent;
+}
+
+//---------------------------------------------------------
+// Function: StopCapture
+// Stop capture.
+//
+//   The sender is not released.
+void spoutCapture::StopCapture()
+{
+	ReleaseDuplication();
+	m_bCapturing = false;
+}
+
+//---------------------------------------------------------
+// Function: IsCapturing
+// Capture started
+bool spoutCapture::IsCapturing()
+{
+	return m_bCapturing;
+}
+
+//
+// Group: Capture thread
+//
+
+//---------------------------------------------------------
+// Function: StartCaptureThread
+// Capture and send on a thread for each new desktop frame.
+//
+//   The thread waits in AcquireNextFrame and sends each new frame.
+//   The class device context is used by the thread, so do not call
+//   other functions of the object until StopCaptureThread.
+bool spoutCapture::StartCaptureThread(unsigned int output)
+{
+	StopCaptureThread();
+
+	if (!StartCapture(output))
+		return false;
+
+	m_hCaptureStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!m_hCaptureStop) {
+		SpoutLogError("spoutCapture::StartCaptureThread - could not create stop event (%d)", GetLastError());
+		return false;
+	}
+
+	m_hCaptureThread = CreateThread(NULL, 0, CaptureThread, this, 0, NULL);
+	if (!m_hCaptureThread) {
+		SpoutLogError("spoutCapture::StartCaptureThread - could not create thread (%d)", GetLastError());
+		CloseHandle(m_hCaptureStop);
+		m_hCaptureStop = NULL;
+		return false;
+	}
+
+	SpoutLogNotice("spoutCapture::StartCaptureThread");
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: StopCaptureThread
+// Stop the capture thread.
+//
+//   Capture is stopped but the sender is not released.
+void spoutCapture::StopCaptureThread()
+{
+	if (m_hCaptureThread) {
+		SetEvent(m_hCaptureStop);
+		WaitForSingleObject(m_hCaptureThread, INFINITE);
+		CloseHandle(m_hCaptureThread);
+		m_hCaptureThread = NULL;
+		StopCapture();
+		SpoutLogNotice("spoutCapture::StopCaptureThread");
+	}
+	if (m_hCaptureStop) {
+		CloseHandle(m_hCaptureStop);
+		m_hCaptureStop = NULL;
+	}
+}
+
+//
+// Group: Information
+//
+
+//---------------------------------------------------------
+// Function: GetCaptureWidth
+// Width of the monitor captured
+unsigned int spoutCapture::GetCaptureWidth()
+{
+	return m_CaptureWidth;
+}
+
+//---------------------------------------------------------
+// Function: GetCaptureHeight
+// Height of the monitor captured
+unsigned int spoutCapture::GetCaptureHeight()
+{
+	return m_CaptureHeight;
+}
+
+//---------------------------------------------------------
+// Function: GetCapturedFrames
+// Frames sent
+unsigned __int64 spoutCapture::GetCapturedFrames()
+{
+	return m_CapturedFrames;
+}
+
+//---------------------------------------------------------
+// Function: GetCapturedRegionFrames
+// Frames sent with only the changed regions
+unsigned __int64 spoutCapture::GetCapturedRegionFrames()
+{
+	return m_CapturedRegions;
+}
+
+//
+// Protected
+//
+
+// Duplicate the output with the class device.
+// The output must be connected to the adapter of the device.
+bool spoutCapture::CreateDuplication()
+{
+	if (!m_pd3dDevice)
+		return false;
+
+	IDXGIDevice* pDXGIDevice = nullptr;
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), (void**)&pDXGIDevice);
+	if (FAILED(hr))
+		return false;
+
+	IDXGIAdapter* pAdapter = nullptr;
+	hr = pDXGIDevice->GetAdapter(&pAdapter);
+	pDXGIDevice->Release();
+	if (FAILED(hr))
+		return false;
+
+	IDXGIOutput* pOutput = nullptr;
+	hr = pAdapter->EnumOutputs(m_CaptureOutput, &pOutput);
+	pAdapter->Release();
+	if (FAILED(hr)) {
+		SpoutLogError("spoutCapture::CreateDuplication - output %d is not connected to the adapter", m_CaptureOutput);
+		return false;
+	}
+
+	DXGI_OUTPUT_DESC outdesc={};
+	pOutput->GetDesc(&outdesc);
+	m_OutputRect = outdesc.DesktopCoordinates;
+
+	IDXGIOutput1* pOutput1 = nullptr;
+	hr = pOutput->QueryInterface(__uuidof(IDXGIOutput1), (void**)&pOutput1);
+	pOutput->Release();
+	if (FAILED(hr)) {
+		SpoutLogError("spoutCapture::CreateDuplication - Desktop Duplication is not supported");
+		return false;
+	}
+
+	hr = pOutput1->DuplicateOutput(m_pd3dDevice, &m_pDuplication);
+	pOutput1->Release();
+	if (FAILED(hr)) {
+		m_pDuplication = nullptr;
+		if (hr == DXGI_ERROR_UNSUPPORTED)
+			SpoutLogError("spoutCapture::CreateDuplication - the monitor is driven by another adapter");
+		else if (hr == DXGI_ERROR_NOT_CURRENTLY_AVAILABLE)
+			SpoutLogWarning("spoutCapture::CreateDuplication - too many applications are capturing the output");
+		else if (hr == E_ACCESSDENIED)
+			SpoutLogWarning("spoutCapture::CreateDuplication - access denied (secure desktop)");
+		else
+			SpoutLogError("spoutCapture::CreateDuplication - DuplicateOutput failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	DXGI_OUTDUPL_DESC dupldesc={};
+	m_pDuplication->GetDesc(&dupldesc);
+	m_CaptureWidth = dupldesc.ModeDesc.Width;
+	m_CaptureHeight = dupldesc.ModeDesc.Height;
+	if (dupldesc.Rotation != DXGI_MODE_ROTATION_IDENTITY && dupldesc.Rotation != DXGI_MODE_ROTATION_UNSPECIFIED)
+		SpoutLogWarning("spoutCapture::CreateDuplication - monitor rotation is not applied");
+
+	// The new duplication has no earlier frame for changed regions
+	m_bCaptureWhole = true;
+
+	return true;
+}
+
+void spoutCapture::ReleaseDuplication()
+{
+	if (m_pDuplication)
+		m_pDuplication->Release();
+	m_pDuplication = nullptr;
+}
+
+// Changed regions of the acquired frame.
+// The destinations of moved regions already have the moved
+// content in the desktop image and are copied as changed regions.
+// Returns false if the regions are not available.
+bool spoutCapture::GetCaptureRects(const DXGI_OUTDUPL_FRAME_INFO &info)
+{
+	m_CaptureRects.clear();
+
+	if (info.TotalMetadataBufferSize == 0)
+		return false;
+
+	if (m_CaptureMeta.size() < info.TotalMetadataBufferSize)
+		m_CaptureMeta.resize(info.TotalMetadataBufferSize);
+
+	UINT moveBytes = 0;
+	HRESULT hr = m_pDuplication->GetFrameMoveRects(info.TotalMetadataBufferSize,
+		reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(m_CaptureMeta.data()), &moveBytes);
+	if (FAILED(hr))
+		return false;
+
+	UINT dirtyBytes = 0;
+	hr = m_pDuplication->GetFrameDirtyRects(info.TotalMetadataBufferSize - moveBytes,
+		reinterpret_cast<RECT*>(m_CaptureMeta.data() + moveBytes), &dirtyBytes);
+	if (FAILED(hr))
+		return false;
+
+	const DXGI_OUTDUPL_MOVE_RECT* pMoves = reinterpret_cast<const DXGI_OUTDUPL_MOVE_RECT*>(m_CaptureMeta.data());
+	const unsigned int nMoves = moveBytes/(UINT)sizeof(DXGI_OUTDUPL_MOVE_RECT);
+	for (unsigned int i = 0; i < nMoves; i++)
+		m_CaptureRects.push_back(pMoves[i].DestinationRect);
+
+	const RECT* pDirty = reinterpret_cast<const RECT*>(m_CaptureMeta.data() + moveBytes);
+	const unsigned int nDirty = dirtyBytes/(UINT)sizeof(RECT);
+	for (unsigned int i = 0; i < nDirty; i++)
+		m_CaptureRects.push_back(pDirty[i]);
+
+	return true;
+}
+
+// Client area of the capture window on the output, in output coordinates.
+// Returns false if the window is closed, minimized or not on the output.
+bool spoutCapture::GetWindowRegion(RECT &region)
+{
+	if (!IsWindow(m_hCaptureWnd) || IsIconic(m_hCaptureWnd))
+		return false;
+
+	RECT client={};
+	if (!GetClientRect(m_hCaptureWnd, &client))
+		return false;
+
+	POINT origin = { 0, 0 };
+	ClientToScreen(m_hCaptureWnd, &origin);
+	RECT screen = { origin.x, origin.y, origin.x + client.right, origin.y + client.bottom };
+
+	if (!IntersectRect(&region, &screen, &m_OutputRect))
+		return false;
+
+	OffsetRect(&region, -m_OutputRect.left, -m_OutputRect.top);
+
+	return true;
+}
+
+DWORD WINAPI spoutCapture::CaptureThread(LPVOID lpParameter)
+{
+	spoutCapture* pCapture = static_cast<spoutCapture*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_FRAME);
+	// AcquireNextFrame waits for each new desktop frame
+	while (WaitForSingleObject(pCapture->m_hCaptureStop, 0) == WAIT_TIMEOUT)
+		pCapture->CaptureFrame(100);
+	EndSpoutThread(SPOUT_THREAD_FRAME, hTask);
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*
+
+	spoutCapture.h
+
+	Functions to send a monitor or window captured by DXGI Desktop Duplication
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutCapture__
+#define __spoutCapture__
+
+#include "..\SpoutDX.h" // Base class
+#include <dxgi1_2.h> // for IDXGIOutputDuplication
+#include <vector>
+
+class spoutCapture : public spoutDX {
+
+	public:
+
+		spoutCapture();
+		~spoutCapture();
+
+		// Start capture of a monitor of the adapter used by the class device
+		bool StartCapture(unsigned int output = 0);
+		// Capture the client area of a window on the monitor being captured
+		void SetCaptureWindow(HWND hWnd);
+		// Wait for a new desktop frame and send it
+		bool CaptureFrame(DWORD dwTimeout = 100);
+		// Stop capture
+		void StopCapture();
+		// Capture started
+		bool IsCapturing();
+
+		// Capture and send on a thread for each new desktop frame
+		bool StartCaptureThread(unsigned int output = 0);
+		// Stop the capture thread
+		void StopCaptureThread();
+
+		// Width of the capture
+		unsigned int GetCaptureWidth();
+		// Height of the capture
+		unsigned int GetCaptureHeight();
+		// Frames sent
+		unsigned __int64 GetCapturedFrames();
+		// Frames sent with only the changed regions
+		unsigned __int64 GetCapturedRegionFrames();
+
+	protected:
+
+		IDXGIOutputDuplication* m_pDuplication;
+		unsigned int m_CaptureOutput; // Output index of the adapter
+		RECT m_OutputRect; // Desktop coordinates of the output
+		unsigned int m_CaptureWidth;
+		unsigned int m_CaptureHeight;
+		HWND m_hCaptureWnd; // Window to capture, or null for the whole output
+		bool m_bCaptureWhole; // Next frame is copied whole
+		bool m_bCapturing;
+		unsigned __int64 m_CapturedFrames;
+		unsigned __int64 m_CapturedRegions;
+
+		// Changed regions of the acquired frame
+		std::vector<unsigned char> m_CaptureMeta; // Move and dirty rectangle data
+		std::vector<RECT> m_CaptureRects;
+		bool GetCaptureRects(const DXGI_OUTDUPL_FRAME_INFO &info);
+		bool GetWindowRegion(RECT &region);
+
+		bool CreateDuplication();
+		void ReleaseDuplication();
+
+		// Capture thread
+		HANDLE m_hCaptureThread;
+		HANDLE m_hCaptureStop;
+		static DWORD WINAPI CaptureThread(LPVOID lpParameter);
+
+};
+
+#endif
@@ -0,0 +1,516 @@
+//
+//		spoutComposite.cpp
+//
+//		Functions to receive many Spout senders to one atlas texture
+//		Base class spoutDX for the D3D11 device and Spout functions.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. Sender textures are opened together and copied
+//					  to tiles of an atlas texture with one batch of access checks
+//					  and one flush for all senders.
+//					- Open sender textures shared by a named NT handle
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutComposite.h"
+
+//
+// Class: spoutComposite
+//
+// Functions to receive many Spout senders to one atlas texture.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// Each sender is copied to a tile of the atlas. The sender textures are
+// opened once and retained until the sender changes or closes. Composite
+// acquires access to every sender with a new frame, queues a region copy
+// for each, flushes once and then allows access to all of them.
+// A sender that is busy for longer than the composite timeout is skipped
+// and its tile keeps the last frame.
+//
+// The atlas can be sent on with SendTexture(GetAtlasTexture()).
+//
+// Refer to source code for further details.
+//
+
+spoutComposite::spoutComposite() {
+
+	m_pAtlas = nullptr;
+	m_AtlasWidth = 0;
+	m_AtlasHeight = 0;
+	m_AtlasFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
+	m_GridColumns = 1;
+	m_GridRows = 1;
+	ZeroMemory(m_Source, sizeof(m_Source));
+	m_nSources = 0;
+	m_dwCompositeTimeout = 4;
+	m_CompositeGeneration = 0;
+	m_dwCompositeCheck = 0;
+
+}
+
+spoutComposite::~spoutComposite() {
+
+	ReleaseAtlas();
+
+}
+
+//
+// Group: Atlas
+//
+
+//---------------------------------------------------------
+// Function: CreateAtlas
+// Create the atlas texture.
+//
+//   Sender textures must have the atlas format to be copied.
+//   The atlas is re-created if the size or format is different.
+//   Tiles of the grid are updated for the new size.
+bool spoutComposite::CreateAtlas(unsigned int width, unsigned int height, DXGI_FORMAT format)
+{
+	if (width == 0 || height == 0)
+		return false;
+
+	if (!OpenDirectX11())
+		return false;
+
+	if (m_pAtlas && width == m_AtlasWidth && height == m_AtlasHeight && format == m_AtlasFormat)
+		return true;
+
+	// Senders are opened again for a new format
+	if (format != m_AtlasFormat) {
+		for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++)
+			CloseSource(m_Source[i]);
+		m_dwCompositeCheck = 0;
+	}
+
+	// The SpoutDirectX function releases an existing texture
+	if (!spoutdx.CreateDX11Texture(m_pd3dDevice, width, height, format, &m_pAtlas)) {
+		SpoutLogError("spoutComposite::CreateAtlas - could not create %dx%d atlas", width, height);
+		return false;
+	}
+	m_AtlasWidth = width;
+	m_AtlasHeight = height;
+	m_AtlasFormat = format;
+
+	// Update tiles of the grid for the new size
+	SetGrid(m_GridColumns, m_GridRows);
+
+	SpoutLogNotice("spoutComposite::CreateAtlas - %dx%d format %d", width, height, format);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReleaseAtlas
+// Release the atlas texture and all senders
+void spoutComposite::ReleaseAtlas()
+{
+	ClearSources();
+
+	if (m_pAtlas)
+		spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pAtlas);
+	m_pAtlas = nullptr;
+	m_AtlasWidth = 0;
+	m_AtlasHeight = 0;
+}
+
+//---------------------------------------------------------
+// Function: GetAtlasTexture
+// Atlas texture
+ID3D11Texture2D* spoutComposite::GetAtlasTexture()
+{
+	return m_pAtlas;
+}
+
+//---------------------------------------------------------
+// Function: GetAtlasWidth
+// Atlas width
+unsigned int spoutComposite::GetAtlasWidth()
+{
+	return m_AtlasWidth;
+}
+
+//---------------------------------------------------------
+// Function: GetAtlasHeight
+// Atlas height
+unsigned int spoutComposite::GetAtlasHeight()
+{
+	return m_AtlasHeight;
+}
+
+//---------------------------------------------------------
+// Function: SetGrid
+// Divide the atlas into a grid of tiles.
+//
+//   Tiles are numbered from the top left, along each row.
+//   AddSource(name) copies a sender to the next free tile.
+//   Senders already added to the grid are moved to the new tiles.
+//   The default is one tile for the whole atlas.
+bool spoutComposite::SetGrid(unsigned int columns, unsigned int rows)
+{
+	if (columns == 0 || rows == 0 || columns*rows > SPOUT_COMPOSITE_SOURCES) {
+		SpoutLogWarning("spoutComposite::SetGrid - %d x %d tiles not supported (maximum %d)",
+			columns, rows, SPOUT_COMPOSITE_SOURCES);
+		return false;
+	}
+
+	m_GridColumns = columns;
+	m_GridRows = rows;
+
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		if (m_Source[i].name[0] && m_Source[i].bGrid)
+			GetGridTile(i, m_Source[i].tile);
+	}
+
+	return true;
+}
+
+//
+// Group: Senders
+//
+
+//---------------------------------------------------------
+// Function: AddSource
+// Copy a sender to the next free tile of the grid.
+//
+//   Returns the tile index, or -1 if all tiles are used.
+int spoutComposite::AddSource(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return -1;
+
+	const int nTiles = (int)(m_GridColumns*m_GridRows);
+	for (int i = 0; i < nTiles; i++) {
+		if (!m_Source[i].name[0]) {
+			SpoutCompositeSource& source = m_Source[i];
+			strcpy_s(source.name, 256, sendername);
+			source.bGrid = true;
+			GetGridTile(i, source.tile);
+			m_nSources++;
+			// Open the sender on the next composite
+			m_dwCompositeCheck = 0;
+			return i;
+		}
+	}
+
+	SpoutLogWarning("spoutComposite::AddSource - no free tile for [%s]", sendername);
+	return -1;
+}
+
+//---------------------------------------------------------
+// Function: AddSource
+// Copy a sender to a region of the atlas.
+//
+//   The sender is copied from the top left and clipped to the region.
+//   A sender smaller than the region leaves the remainder unchanged.
+//   Returns the index for the sender, or -1 if the maximum
+//   number of senders (SPOUT_COMPOSITE_SOURCES) has been added.
+int spoutComposite::AddSource(const char* sendername,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height)
+{
+	if (!sendername || !*sendername || width == 0 || height == 0)
+		return -1;
+
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		if (!m_Source[i].name[0]) {
+			SpoutCompositeSource& source = m_Source[i];
+			strcpy_s(source.name, 256, sendername);
+			source.bGrid = false;
+			source.tile.left   = xoffset;
+			source.tile.right  = xoffset+width;
+			source.tile.top    = yoffset;
+			source.tile.bottom = yoffset+height;
+			source.tile.front  = 0;
+			source.tile.back   = 1;
+			m_nSources++;
+			m_dwCompositeCheck = 0;
+			return i;
+		}
+	}
+
+	SpoutLogWarning("spoutComposite::AddSource - maximum of %d senders", SPOUT_COMPOSITE_SOURCES);
+	return -1;
+}
+
+//---------------------------------------------------------
+// Function: RemoveSource
+// Remove a sender. The tile keeps the last frame.
+bool spoutComposite::RemoveSource(int index)
+{
+	if (index < 0 || index >= SPOUT_COMPOSITE_SOURCES || !m_Source[index].name[0])
+		return false;
+
+	CloseSource(m_Source[index]);
+	ZeroMemory(&m_Source[index], sizeof(SpoutCompositeSource));
+	m_nSources--;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ClearSources
+// Remove all senders
+void spoutComposite::ClearSources()
+{
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		CloseSource(m_Source[i]);
+		ZeroMemory(&m_Source[i], sizeof(SpoutCompositeSource));
+	}
+	m_nSources = 0;
+}
+
+//---------------------------------------------------------
+// Function: GetSourceCount
+// Number of senders
+int spoutComposite::GetSourceCount()
+{
+	return m_nSources;
+}
+
+//---------------------------------------------------------
+// Function: GetSourceName
+// Sender name of a tile, or null if the tile is not used
+const char* spoutComposite::GetSourceName(int index)
+{
+	if (index < 0 || index >= SPOUT_COMPOSITE_SOURCES || !m_Source[index].name[0])
+		return nullptr;
+	return m_Source[index].name;
+}
+
+//---------------------------------------------------------
+// Function: IsSourceConnected
+// Sender texture is open
+bool spoutComposite::IsSourceConnected(int index)
+{
+	if (index < 0 || index >= SPOUT_COMPOSITE_SOURCES)
+		return false;
+	return (m_Source[index].pTexture != nullptr);
+}
+
+//
+// Group: Composite
+//
+
+//---------------------------------------------------------
+// Function: Composite
+// Copy new frames of all senders to the atlas.
+//
+//   Senders are opened, re-opened or closed only if a sender has been
+//   created, updated or closed. Access is acquired for all senders with
+//   a new frame before any copy, the copies are queued and flushed together,
+//   and access is then allowed for all of them.
+//
+//   The time is recorded in the timer as "Composite", and the GPU time
+//   of the copies as "GPUComposite" if EnableGPUTiming is set.
+//
+//   Returns the number of tiles updated.
+int spoutComposite::Composite()
+{
+	if (!m_pAtlas || !m_pImmediateContext || m_nSources == 0)
+		return 0;
+
+	// Open, re-open or close senders if any sender has changed
+	if (sendernames.CheckSenderChange(m_CompositeGeneration, m_dwCompositeCheck))
+		UpdateSources();
+
+	spoutTimerScope scope(&timer, "Composite");
+
+	// Acquire access to every sender with a new frame
+	int nAccess = 0;
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		SpoutCompositeSource& source = m_Source[i];
+		source.bAccess = false;
+		if (!source.pTexture || !source.pFrame)
+			continue;
+		if (source.pFrame->GetNewFrame()
+			&& source.pFrame->CheckTextureAccess(source.pTexture, m_dwCompositeTimeout)) {
+			source.bAccess = true;
+			nAccess++;
+		}
+	}
+
+	if (nAccess == 0)
+		return 0;
+
+	// Copy each sender to its tile, clipped to the tile and the atlas
+	spoutdx.BeginGPUTime(m_pImmediateContext, "GPUComposite");
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		const SpoutCompositeSource& source = m_Source[i];
+		if (!source.bAccess)
+			continue;
+		if (source.tile.left >= m_AtlasWidth || source.tile.top >= m_AtlasHeight)
+			continue;
+		const unsigned int right  = (source.tile.right  < m_AtlasWidth)  ? source.tile.right  : m_AtlasWidth;
+		const unsigned int bottom = (source.tile.bottom < m_AtlasHeight) ? source.tile.bottom : m_AtlasHeight;
+		D3D11_BOX box={};
+		box.right  = (source.width  < right-source.tile.left) ? source.width  : right-source.tile.left;
+		box.bottom = (source.height < bottom-source.tile.top) ? source.height : bottom-source.tile.top;
+		box.back   = 1;
+		m_pImmediateContext->CopySubresourceRegion(m_pAtlas, 0,
+			source.tile.left, source.tile.top, 0, source.pTexture, 0, &box);
+	}
+	spoutdx.EndGPUTime(m_pImmediateContext);
+
+	// One flush for all copies before access is allowed
+	m_pImmediateContext->Flush();
+
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		SpoutCompositeSource& source = m_Source[i];
+		if (source.bAccess) {
+			source.pFrame->AllowTextureAccess(source.pTexture);
+			source.bAccess = false;
+		}
+	}
+
+	return nAccess;
+}
+
+//---------------------------------------------------------
+// Function: SetCompositeTimeout
+// Milliseconds to wait for access to each sender texture.
+//
+//   A sender that is busy for longer is skipped until the next Composite.
+//   The default is 4 msec, so that one sender cannot hold up the others.
+void spoutComposite::SetCompositeTimeout(DWORD dwTimeout)
+{
+	m_dwCompositeTimeout = dwTimeout;
+}
+
+//
+// Protected
+//
+
+// Region of a tile of the grid
+bool spoutComposite::GetGridTile(int index, D3D11_BOX &tile)
+{
+	tile = {};
+	if (index < 0 || index >= (int)(m_GridColumns*m_GridRows))
+		return false;
+
+	const unsigned int tilewidth  = m_AtlasWidth/m_GridColumns;
+	const unsigned int tileheight = m_AtlasHeight/m_GridRows;
+	tile.left   = (index % m_GridColumns)*tilewidth;
+	tile.top    = (index / m_GridColumns)*tileheight;
+	tile.right  = tile.left+tilewidth;
+	tile.bottom = tile.top+tileheight;
+	tile.front  = 0;
+	tile.back   = 1;
+
+	return true;
+}
+
+// Open senders that have started or changed and close senders that have closed
+void spoutComposite::UpdateSources()
+{
+	for (int i = 0; i < SPOUT_COMPOSITE_SOURCES; i++) {
+		SpoutCompositeSource& source = m_Source[i];
+		if (!source.name[0])
+			continue;
+		SharedTextureInfo info={};
+		if (!sendernames.getSharedInfo(source.name, &info)) {
+			// The sender has closed
+			if (source.dxShareHandle) {
+				CloseSource(source);
+				spoutdx.EvictSharedTexture(source.name);
+			}
+			continue;
+		}
+		// Open the sender texture if the share handle has changed
+		if ((HANDLE)(LongToHandle((long)info.shareHandle)) != source.dxShareHandle)
+			OpenSource(source, info);
+	}
+}
+
+// Open the shared texture, access mutex and frame count of a sender
+bool spoutComposite::OpenSource(SpoutCompositeSource &source, const SharedTextureInfo &info)
+{
+	CloseSource(source);
+
+	// Retain the share handle so that a texture that
+	// cannot be used is not opened again until it changes
+	source.dxShareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
+
+	// Memory share mode not supported (no texture share handle)
+	if (!source.dxShareHandle)
+		return false;
+
+	// For DX9 sender formats, use a compatible DX11 format
+	DWORD dwFormat = info.format;
+	if (dwFormat == 21 || dwFormat == 22)
+		dwFormat = (DWORD)DXGI_FORMAT_B8G8R8A8_UNORM;
+	if ((DXGI_FORMAT)dwFormat != m_AtlasFormat) {
+		SpoutLogWarning("spoutComposite::OpenSource - [%s] format %d is not the atlas format %d",
+			source.name, dwFormat, m_AtlasFormat);
+		return false;
+	}
+
+	// A texture opened before for the sender is used without OpenSharedResource
+	if (!spoutdx.OpenSharedTexture(m_pd3dDevice, &source.pTexture, source.dxShareHandle, source.name,
+		(info.usage & SPOUT_USAGE_NTHANDLE) != 0)) {
+		SpoutLogWarning("spoutComposite::OpenSource - could not open the texture of [%s]", source.name);
+		source.pTexture = nullptr;
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	source.pTexture->GetDesc(&desc);
+	source.width = desc.Width;
+	source.height = desc.Height;
+
+	// Named sender mutex and frame count for this sender
+	source.pFrame = new spoutFrameCount;
+	source.pFrame->CreateAccessMutex(source.name);
+	source.pFrame->EnableFrameCount(source.name);
+
+	SpoutLogNotice("spoutComposite::OpenSource - [%s] %dx%d to %d, %d",
+		source.name, source.width, source.height, source.tile.left, source.tile.top);
+
+	return true;
+}
+
+// Close the shared texture, access mutex and frame count of a sender
+void spoutComposite::CloseSource(SpoutCompositeSource &source)
+{
+	if (source.pFrame) {
+		source.pFrame->CloseAccessMutex();
+		source.pFrame->CleanupFrameCount();
+		delete source.pFrame;
+	}
+	source.pFrame = nullptr;
+
+	if (source.pTexture)
+		source.pTexture->Release();
+	source.pTexture = nullptr;
+	source.dxShareHandle = nullptr;
+	source.width = 0;
+	source.height = 0;
+	source.bAccess = false;
+}
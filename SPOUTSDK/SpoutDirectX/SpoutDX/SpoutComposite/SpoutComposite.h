@@ -0,0 +1,118 @@
+/*
+
+	spoutComposite.h
+
+	Functions to receive many Spout senders to one atlas texture
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutComposite__
+#define __spoutComposite__
+
+#include "..\SpoutDX.h" // Base class
+
+// Maximum number of senders in the atlas
+#define SPOUT_COMPOSITE_SOURCES 64
+
+//
+// Sender copied to a tile of the atlas texture
+//
+struct SpoutCompositeSource {
+	char name[256]; // Sender name
+	D3D11_BOX tile; // Region of the atlas texture
+	HANDLE dxShareHandle; // Sender share handle
+	ID3D11Texture2D* pTexture; // Sender shared texture
+	unsigned int width; // Sender width
+	unsigned int height; // Sender height
+	spoutFrameCount* pFrame; // Sender access mutex and frame count
+	bool bGrid; // Tile of the grid (SetGrid)
+	bool bAccess; // Access acquired for the current composite
+};
+
+class spoutComposite : public spoutDX {
+
+	public:
+
+		spoutComposite();
+		~spoutComposite();
+
+		// Create the atlas texture
+		bool CreateAtlas(unsigned int width, unsigned int height,
+			DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM);
+		// Release the atlas texture and all senders
+		void ReleaseAtlas();
+		// Atlas texture
+		ID3D11Texture2D* GetAtlasTexture();
+		// Atlas width
+		unsigned int GetAtlasWidth();
+		// Atlas height
+		unsigned int GetAtlasHeight();
+		// Divide the atlas into a grid of tiles for AddSource(name)
+		bool SetGrid(unsigned int columns, unsigned int rows);
+
+		// Copy a sender to the next free tile of the grid
+		int AddSource(const char* sendername);
+		// Copy a sender to a region of the atlas
+		int AddSource(const char* sendername,
+			unsigned int xoffset, unsigned int yoffset,
+			unsigned int width, unsigned int height);
+		// Remove a sender
+		bool RemoveSource(int index);
+		// Remove all senders
+		void ClearSources();
+		// Number of senders
+		int GetSourceCount();
+		// Sender name of a tile
+		const char* GetSourceName(int index);
+		// Sender texture is open
+		bool IsSourceConnected(int index);
+
+		// Copy new frames of all senders to the atlas
+		int Composite();
+		// Milliseconds to wait for access to each sender texture
+		void SetCompositeTimeout(DWORD dwTimeout = 4);
+
+	protected:
+
+		ID3D11Texture2D* m_pAtlas;
+		unsigned int m_AtlasWidth;
+		unsigned int m_AtlasHeight;
+		DXGI_FORMAT m_AtlasFormat;
+		unsigned int m_GridColumns;
+		unsigned int m_GridRows;
+		SpoutCompositeSource m_Source[SPOUT_COMPOSITE_SOURCES];
+		int m_nSources;
+		DWORD m_dwCompositeTimeout;
+		LONG m_CompositeGeneration; // Sender change count of the last check
+		DWORD m_dwCompositeCheck; // Time of the last check
+
+		bool GetGridTile(int index, D3D11_BOX &tile);
+		void UpdateSources();
+		bool OpenSource(SpoutCompositeSource &source, const SharedTextureInfo &info);
+		void CloseSource(SpoutCompositeSource &source);
+
+};
+
+#endif
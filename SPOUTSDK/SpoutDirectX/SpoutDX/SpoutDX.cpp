@@ -143,6 +143,175 @@
 //		28.10.23	- CheckSender - executable path retrieved in SpoutSenderNames::SetSenderInfo
 //		02.12.23	- Update and test examples with 2.007.013 SpoutGL files. No other changes.
 //		06.12.23	- SetSenderName - use SpoutUtils GetExeName()
+//		14.10.26	- CheckSender, CreateReceiver - create or open a shared fence
+//					  if enabled by frame.EnableFenceSync()
+//					- Add SetTextureRing/GetTextureRing for a sender ring of shared textures
+//					  SendTexture writes the next texture of the ring and 
+//					  ReceiveTexture reads the last written without the access mutex
+//					- ReceiveSenderData - without a sender, check for one only if
+//					  the sender change count has changed, or once a second
+//					- Add ReceiveImageView and ReleaseImageView to access
+//					  the mapped staging texture without copy to a pixel buffer
+//					- Add SetComputeConversion/GetComputeConversion
+//					  ReceiveImage - optional compute shader conversion to the
+//					  receiving buffer format and size before the staging copy
+//					- Add SetResampleMode/GetResampleMode for bilinear or box
+//					  resample on the GPU before the staging copy
+//					- Add SetPreview/GetPreview for a sender preview texture
+//					  published in shared memory "<sendername>_SpoutPreview"
+//					  Add ReceivePreview, GetPreviewTexture, GetPreviewWidth/Height
+//					- Add ReceiveTexture with offsets and ReceiveImageRegion
+//					  to copy part of the sender texture.
+//					  ReadPixelData - source size from the staging texture
+//					- Add SendTexture with dirty rectangles. ReceiveImage copies and
+//					  reads only the changed regions if the sender publishes them.
+//					  Add ReadDirtyPixels and CopyDirtyRects
+//					- CheckSender - create frame timing if enabled.
+//					  Add GetSenderFrameAge and GetSenderMissedFrames
+//					- Add spoutTimer "timer" for scoped timing of SendTexture, ReceiveTexture,
+//					  ReceiveImage, texture access and pixel copy
+//					- SendTexture, ReceiveTexture and staging map TraceLogging events
+//					- Add WaitFrameSync for a number of senders
+//					- Add spoutReceiveThread class to receive pixels on a dedicated
+//					  thread to three buffers. AcquireFrame returns the latest.
+//					- Add spoutReceiverGroup class to receive from a number of senders
+//					  with one device, one sender change check and a texture pool
+//					- ReceiveSenderData - use spoutDirectX::OpenSharedTexture to re-use
+//					  sender textures already opened. Release them if the sender closes.
+//					- CheckStagingTextures - staging textures from the spoutDirectX
+//					  process pool. Return them to the pool when released.
+//					- Add SetYUVFormat/GetYUVFormat for a sender NV12 or P010 texture
+//					  published in shared memory "<sendername>_SpoutYUV" and converted
+//					  on the GPU by the D3D11 video processor. Add ReceiveYUVTexture,
+//					  ReceiveYUVImage for planar pixels, GetYUVTexture, GetSenderYUVFormat,
+//					  GetYUVWidth and GetYUVHeight
+//					- ReadPixelData - convert 10 bit and half float staging textures
+//					  to 8 bit pixels by the spoutCopy high bit depth functions
+//					- Add CreateFrameData, WriteFrameData and ReadFrameData
+//					- Add LockMemoryBuffer, UnlockMemoryBuffer
+//					- ReadPixelData - conversion to the user buffer in CopyPixelData
+//					  for spoutDX12 readback buffers
+//					- Add SetAdapterBridge, GetAdapterBridge and IsAdapterBridge.
+//					  ReceiveSenderData - if the sender texture cannot be opened,
+//					  open it with a device on the sender adapter and copy to the
+//					  receiving device by way of a ring of staging textures.
+//					- OpenBridge - disable telemetry for the bridge frame counter
+//					- Add GetSenderFrameStats and ResetSenderFrameStats
+//					- ReceiveTexture - check for a new frame before waiting for
+//					  access to the shared texture
+//					- ReceiveYUVImage - read back only if there is a new YUV frame
+//					- Add SetReceiverTexture for ReceiveTexture() to copy directly
+//					  to an application texture instead of the class texture
+//					- Add PrepareSender
+//					- Add SetPreconnect and GetPreconnect to open sender textures
+//					  on a thread when senders change (see spoutDirectX::StartPreopen)
+//					- SendTexture - share an array texture with one sender name, mutex
+//					  and frame count. Receivers create the class texture with the same
+//					  number of views. Pixels are read from the first view.
+//					  Add GetSenderArraySize.
+//					- Add SetSenderMips to create the sender texture with a mip chain
+//					  that is generated after each frame. Add GetSenderMipLevels
+//					  and ReceiveMipLevel to copy a scaled down level.
+//					- Add EnableGPUTiming to record the GPU time of the shared texture
+//					  and staging copies in the timer ("GPUSharedCopy", "GPUStagingCopy")
+//					- Add SendSwapChain to send the back buffer of a swap chain before
+//					  Present and report the time added. Add WaitSwapChain to pace
+//					  a sender with the frame latency waitable object.
+//					- Add AddAtlasSender, RemoveAtlasSender and GetAtlasSenderCount
+//					  to publish regions of the sender texture as separate senders.
+//					  Receivers copy the region (CopySenderTexture) and use the
+//					  access mutex and frame count of the atlas sender.
+//					- Add SetDeferredSend and SubmitSend. SendTexture records the copy
+//					  in a deferred context on a worker thread and the owner thread
+//					  submits it within the sender mutex lock.
+//					- Add SetAsyncSend. SendTexture copies to a snapshot texture and
+//					  returns. A Spout thread waits for access and copies the last
+//					  snapshot to the shared texture.
+//					- spoutReceiveThread - add WaitFrame, GetFrameEvent and SetFrameCallback.
+//					  The thread waits on the sender sync event if the sender has created one.
+//					- Add SetIdleReceive and GetIdleReceive. Receiving functions return
+//					  before the sender checks until the sender frame event is signalled.
+//					- CheckSender - update the sender heartbeat for cleanup
+//					- Add GetSenderList. CheckSender records the sender adapter.
+//					- Add SetSharedImages and SetReceiveSharedImage. Receivers request
+//					  an image format and size in "<sendername>_SpoutImages" and the
+//					  sender converts each requested image once for all receivers.
+//					- Add SetFrameCache. The first receiver to read back a frame shares
+//					  it in "<sendername>_SpoutFrameCache" and other receivers copy it.
+//					- Add SetComputeRGB. ReceiveImage to an RGB buffer packs the pixels
+//					  by compute shader so that a quarter less is read back.
+//					- Add ReceiveImageYUV. The sender texture is converted to planar
+//					  NV12 or I420 by compute shader for encoders.
+//					- Add SetSendPolicy for receivers that lag behind the sender.
+//					  Latest frame, queue of ring textures read in order, or block
+//					  until receivers have acknowledged. GetSendDropped, GetSendOverrun.
+//					  Add SetFrameAck for receivers to acknowledge each frame.
+//					- Add SetSenderNTHandle to share the sender texture by a named NT handle.
+//					  Receivers open the texture by name if the sender information has
+//					  SPOUT_USAGE_NTHANDLE. Add CreateSenderTexture for CheckSender.
+//					- Add AddSenderReplica to keep replicas of the sender texture on other
+//					  adapters in "<sendername>_SpoutReplicas". Each frame is read back once
+//					  for all replicas. Receivers open the replica on their adapter.
+//					- AsyncSendThread and spoutReceiveThread register with the Multimedia
+//					  Class Scheduler as frame critical threads (BeginSpoutThread).
+//					- Add GetMemoryUsage for the textures and shared memory held by
+//					  a sender or receiver. CheckSender and ReceiveSenderData record
+//					  the total with telemetry (CheckTelemetryMemory).
+//					- Add SetSkipUnchanged and GetSkipUnchanged to skip receiving frames
+//					  with the same content hash as the last (spoutFrameCount::SetSkipUnchanged)
+//					- Add named data channels (CreateDataChannel, WriteDataChannel,
+//					  ReadDataChannel) with a retained map for each channel
+//					- ReceiveSenderData - do not read the sender information if the
+//					  sender information change count is unchanged (CheckSenderInfoChange)
+//					- Add SetVideoProcessing and GetVideoProcessing. ReceiveImage of different
+//					  size and ReceiveImageYUV NV12 use the hardware video processor
+//					  between the shared texture and the staging copy (ProcessVideoData)
+//					- Add SendImage with source line pitch and format so that padded
+//					  images do not need RemovePadding before sending
+//					- Add ReceiveImage with destination line pitch. ReadPixelData,
+//					  CopyPixelData and ReadConvertedData write each line at the pitch.
+//					- Add SetReadbackBands and GetReadbackBands. ReceiveImage copies bands
+//					  of the sender texture to separate staging textures and converts
+//					  each as soon as its copy is complete (ReadBandedPixels)
+//					- Add TryReceiveImage to map the staging texture with D3D11_MAP_FLAG_DO_NOT_WAIT
+//					  and return SPOUT_RECEIVE_PENDING instead of waiting for the GPU copy
+//					- Add AnalyzeTexture, GetAnalysis and SetReceiveAnalysis. Colour and luminance
+//					  histograms and waveform of the received texture by compute shader
+//					- Add GetSenderNames to copy the sender names without allocation
+//					- SelectSenderPanel registers a wait for the SpoutPanel process.
+//					  CheckSpoutPanel tests a flag set when it closes instead of the mutex.
+//					- Add SelectSender(name) and SelectSender(index)
+//					- OpenTextureRing - open the named ring textures of a D3D12 sender and
+//					  its fence. ReadTextureRing waits on the GPU for the frame to be written.
+//					- Add BeginFrame and EndFrame to render directly to the sender texture
+//					  without a copy from an application texture
+//					- Add SetToneMapping. ReceiveImage from a floating point sender
+//					  is tone mapped and quantised to 8 bit by the conversion shader
+//					  before the staging copy.
+//					- Add BeginSendBatch and EndSendBatch. Sends of all senders on the
+//					  thread between them are flushed once and the new frames are
+//					  signalled together.
+//					- Add SetSendSlices, SendTextureSlice, ReceiveTextureSlice and
+//					  GetReceiveSlices. Horizontal slices of a frame are published as they
+//					  are copied with the shared fence value of each slice, and received
+//					  as soon as they are published.
+//					- Trace the sender flush and the pixel conversion of staging
+//					  texture reads for the flight recorder (SpoutUtils).
+//					- SendTextureSlice - take the access mutex while a slice is written
+//					  unless the shared fence is the only sync (frame.SetFenceOnly)
+//					- Texture ring - a keyed mutex for each ring texture so that the sender
+//					  cannot write to a texture being copied. A receiver of a ring without
+//					  keyed mutexes copies again if the sender has gone round the ring.
+//					  Minimum of 3 ring textures.
+//					- SetComputeRGB - default false. Compute shader RGB packing is optional.
+//					- ReadTextureRing - receive the shared texture if the ring has been
+//					  re-created by the sender and check the ring index.
+//					- Acknowledge frames (SetFrameAck) on every receive path.
+//					  SetSendPolicy default timeout 1000 msec.
+//					- ReceiveTexture, ReceiveTextureSlice, ReceiveMipLevel - receive the
+//					  frame again if access to the shared texture times out.
+//					- ReceiveImageView - return the sender frame number of the staging
+//					  texture mapped. Return false until that texture has been written.
 //
 // ====================================================================================
 /*
@@ -171,6 +340,192 @@
 */
 #include "spoutDX.h"
 
+// Senders of the thread queued by a send batch (BeginSendBatch)
+static thread_local bool t_bSendBatch = false;
+static thread_local std::vector<spoutDX*> t_SendBatch;
+
+// Wait callback for the SpoutPanel process (SelectSenderPanel)
+static VOID CALLBACK SpoutPanelClosed(PVOID lpParameter, BOOLEAN /* TimerOrWaitFired */)
+{
+	InterlockedExchange(static_cast<volatile LONG*>(lpParameter), 1);
+}
+
+//
+// Compute shader for ReceiveImage conversion
+//
+// One invocation for each 32 bit word of the receiving buffer so that
+// RGB/BGR lines are packed without padding. The source texture is
+// resampled if the buffer is a different size.
+//
+// flags : 1 - flip, 2 - swap red/blue, 4 - mirror, 8 - bilinear, 16 - box
+//         32 - Reinhard tone map, 64 - ACES tone map
+// Box averages the source pixels covered, up to 16x16 samples.
+// Tone mapping scales a linear floating point source (1.0 = SDR white)
+// by exposure and encodes the mapped values as sRGB.
+//
+static const char* g_ConvertShader =
+	"Texture2D<float4> src : register(t0);\n"
+	"RWByteAddressBuffer dst : register(u0);\n"
+	"cbuffer params : register(b0) {\n"
+	"    uint srcWidth; uint srcHeight; uint dstWidth; uint dstHeight;\n"
+	"    uint bpp; uint words; uint stride; uint flags;\n"
+	"    float exposure;\n"
+	"};\n"
+	"float3 tonemap(float3 x) {\n"
+	"    x = max(x * exposure, 0.0);\n"
+	"    if (flags & 64) {\n"
+	"        x *= 0.6;\n"
+	"        x = (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14);\n"
+	"    }\n"
+	"    else {\n"
+	"        x = x / (1.0 + dot(x, float3(0.2126, 0.7152, 0.0722)));\n"
+	"    }\n"
+	"    x = saturate(x);\n"
+	"    return (x <= 0.0031308) ? x * 12.92 : 1.055 * pow(x, 1.0 / 2.4) - 0.055;\n"
+	"}\n"
+	"float4 resample(uint x, uint y) {\n"
+	"    int2 m = int2(srcWidth - 1, srcHeight - 1);\n"
+	"    float2 scale = float2(srcWidth, srcHeight) / float2(dstWidth, dstHeight);\n"
+	"    if (flags & 16) {\n"
+	"        int2 p0 = min(int2(float2(x, y) * scale), m);\n"
+	"        int2 p1 = clamp(int2(float2(x + 1, y + 1) * scale), p0 + 1, m + 1);\n"
+	"        int2 step = max(int2(1, 1), (p1 - p0 + 15) / 16);\n"
+	"        float4 c = 0;\n"
+	"        float n = 0;\n"
+	"        for (int j = p0.y; j < p1.y; j += step.y) {\n"
+	"            for (int i = p0.x; i < p1.x; i += step.x) {\n"
+	"                c += src.Load(int3(i, j, 0));\n"
+	"                n += 1.0;\n"
+	"            }\n"
+	"        }\n"
+	"        return c / n;\n"
+	"    }\n"
+	"    if (flags & 8) {\n"
+	"        float2 s = (float2(x, y) + 0.5) * scale - 0.5;\n"
+	"        int2 s0 = int2(floor(s));\n"
+	"        float2 f = s - float2(s0);\n"
+	"        float4 c00 = src.Load(int3(clamp(s0, 0, m), 0));\n"
+	"        float4 c10 = src.Load(int3(clamp(s0 + int2(1, 0), 0, m), 0));\n"
+	"        float4 c01 = src.Load(int3(clamp(s0 + int2(0, 1), 0, m), 0));\n"
+	"        float4 c11 = src.Load(int3(clamp(s0 + int2(1, 1), 0, m), 0));\n"
+	"        return lerp(lerp(c00, c10, f.x), lerp(c01, c11, f.x), f.y);\n"
+	"    }\n"
+	"    return src.Load(int3(x * srcWidth / dstWidth, y * srcHeight / dstHeight, 0));\n"
+	"}\n"
+	"[numthreads(256, 1, 1)]\n"
+	"void main(uint3 id : SV_DispatchThreadID) {\n"
+	"    uint w = id.y * stride + id.x;\n"
+	"    if (w >= words) return;\n"
+	"    uint word = 0;\n"
+	"    uint pixel = 0xFFFFFFFF;\n"
+	"    uint4 c = 0;\n"
+	"    for (uint i = 0; i < 4; i++) {\n"
+	"        uint b = w * 4 + i;\n"
+	"        uint p = b / bpp;\n"
+	"        if (p >= dstWidth * dstHeight) break;\n"
+	"        if (p != pixel) {\n"
+	"            pixel = p;\n"
+	"            uint x = p % dstWidth;\n"
+	"            uint y = p / dstWidth;\n"
+	"            if (flags & 4) x = dstWidth - 1 - x;\n"
+	"            if (flags & 1) y = dstHeight - 1 - y;\n"
+	"            float4 f = resample(x, y);\n"
+	"            if (flags & 96) f.rgb = tonemap(f.rgb);\n"
+	"            if (flags & 2) f = f.bgra;\n"
+	"            c = uint4(saturate(f) * 255.0 + 0.5);\n"
+	"        }\n"
+	"        word |= c[b - p * bpp] << (i * 8);\n"
+	"    }\n"
+	"    dst.Store(w * 4, word);\n"
+	"}\n";
+
+//
+// Compute shader for ReceiveImageYUV
+//
+// One invocation for each 32 bit word of the Y plane followed by
+// interleaved UV (NV12) or U and V planes (I420). Chroma is the average
+// of 2x2 pixels. The source texture is sampled nearest for a different size.
+//
+// planar : 0 - NV12, 1 - I420
+// flags  : 1 - flip, 2 - BT.709 (BT.601 if not set), 4 - full range
+//
+static const char* g_ConvertYUVShader =
+	"Texture2D<float4> src : register(t0);\n"
+	"RWByteAddressBuffer dst : register(u0);\n"
+	"cbuffer params : register(b0) {\n"
+	"    uint srcWidth; uint srcHeight; uint dstWidth; uint dstHeight;\n"
+	"    uint planar; uint words; uint stride; uint flags;\n"
+	"};\n"
+	"float3 rgb(uint x, uint y) {\n"
+	"    if (flags & 1) y = dstHeight - 1 - y;\n"
+	"    return saturate(src.Load(int3(x * srcWidth / dstWidth, y * srcHeight / dstHeight, 0)).rgb);\n"
+	"}\n"
+	"[numthreads(256, 1, 1)]\n"
+	"void main(uint3 id : SV_DispatchThreadID) {\n"
+	"    uint w = id.y * stride + id.x;\n"
+	"    if (w >= words) return;\n"
+	"    float2 k = (flags & 2) ? float2(0.2126, 0.0722) : float2(0.299, 0.114);\n"
+	"    float3 kY = float3(k.x, 1.0 - k.x - k.y, k.y);\n"
+	"    float3 range = (flags & 4) ? float3(0.0, 255.0, 255.0) : float3(16.0, 219.0, 224.0);\n"
+	"    uint ysize = dstWidth * dstHeight;\n"
+	"    uint cwidth = dstWidth / 2;\n"
+	"    uint csize = cwidth * (dstHeight / 2);\n"
+	"    uint word = 0;\n"
+	"    for (uint i = 0; i < 4; i++) {\n"
+	"        uint b = w * 4 + i;\n"
+	"        if (b >= ysize + csize * 2) break;\n"
+	"        float v;\n"
+	"        if (b < ysize) {\n"
+	"            v = range.x + dot(rgb(b % dstWidth, b / dstWidth), kY) * range.y;\n"
+	"        }\n"
+	"        else {\n"
+	"            uint c = b - ysize;\n"
+	"            uint p = planar ? c % csize : c / 2;\n"
+	"            bool bV = planar ? (c >= csize) : ((c & 1) != 0);\n"
+	"            uint x = (p % cwidth) * 2;\n"
+	"            uint y = (p / cwidth) * 2;\n"
+	"            float3 f = (rgb(x, y) + rgb(x + 1, y) + rgb(x, y + 1) + rgb(x + 1, y + 1)) * 0.25;\n"
+	"            float l = dot(f, kY);\n"
+	"            float d = bV ? (f.r - l) / (2.0 * (1.0 - k.x)) : (f.b - l) / (2.0 * (1.0 - k.y));\n"
+	"            v = 128.0 + d * range.z;\n"
+	"        }\n"
+	"        word |= uint(clamp(v + 0.5, 0.0, 255.0)) << (i * 8);\n"
+	"    }\n"
+	"    dst.Store(w * 4, word);\n"
+	"}\n";
+
+// Histograms and waveform of a texture (AnalyzeTexture)
+// Words 0-1023 : red, green, blue and luminance histograms of 256 levels
+// Words 1024+  : waveform of 128 columns, each of 64 luminance levels
+// Each group of 16x16 pixels accumulates in shared memory
+// and adds non-zero counts to the output buffer.
+static const char* g_ScopeShader =
+	"Texture2D<float4> src : register(t0);\n"
+	"RWByteAddressBuffer dst : register(u0);\n"
+	"groupshared uint hist[1024];\n"
+	"[numthreads(16, 16, 1)]\n"
+	"void main(uint3 id : SV_DispatchThreadID, uint gi : SV_GroupIndex) {\n"
+	"    for (uint i = gi; i < 1024; i += 256) hist[i] = 0;\n"
+	"    GroupMemoryBarrierWithGroupSync();\n"
+	"    uint w, h;\n"
+	"    src.GetDimensions(w, h);\n"
+	"    if (id.x < w && id.y < h) {\n"
+	"        float3 c = saturate(src.Load(int3(id.xy, 0)).rgb);\n"
+	"        uint3 v = uint3(c * 255.0 + 0.5);\n"
+	"        uint l = uint(dot(c, float3(0.2126, 0.7152, 0.0722)) * 255.0 + 0.5);\n"
+	"        InterlockedAdd(hist[v.r], 1);\n"
+	"        InterlockedAdd(hist[256 + v.g], 1);\n"
+	"        InterlockedAdd(hist[512 + v.b], 1);\n"
+	"        InterlockedAdd(hist[768 + l], 1);\n"
+	"        uint col = (id.x * 128) / w;\n"
+	"        dst.InterlockedAdd((1024 + col * 64 + (l >> 2)) * 4, 1);\n"
+	"    }\n"
+	"    GroupMemoryBarrierWithGroupSync();\n"
+	"    for (uint j = gi; j < 1024; j += 256) {\n"
+	"        if (hist[j] != 0) dst.InterlockedAdd(j * 4, hist[j]);\n"
+	"    }\n"
+	"}\n";
+
 //
 // Class: spoutDX
 //
@@ -186,36 +541,263 @@ spoutDX::spoutDX()
 	m_pImmediateContext = nullptr;
 
 	m_pTexture = nullptr;
+	m_ppReceiverTexture = nullptr;
+	m_dwMemoryTime = 0;
 	m_pStaging[0] = nullptr;
 	m_pStaging[1] = nullptr;
+	m_pMappedStaging = nullptr;
+	m_bStagingView[0] = false;
+	m_bStagingView[1] = false;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++)
+		m_DataChannels[i] = {};
 	m_Index = 0;
 	m_NextIndex = 0;
+	m_pDirtyPixels = nullptr;
+	m_bDirtyInvert = false;
+	m_bReadPending = false;
+
+	m_bComputeConversion = false;
+	m_bComputeRGB = false;
+	m_ResampleMode = 0; // nearest
+	m_ToneMap = SPOUT_TONEMAP_NONE;
+	m_ToneMapExposure = 1.0f;
+	m_bVideoProcessing = false;
+	m_pVPDevice = nullptr;
+	m_pVPContext = nullptr;
+	m_pVPEnum = nullptr;
+	m_pVPProcessor = nullptr;
+	m_pVPTexture = nullptr;
+	m_pVPOutputView = nullptr;
+	m_pVPInputView = nullptr;
+	m_pVPSource = nullptr;
+	m_pVPStaging[0] = nullptr;
+	m_pVPStaging[1] = nullptr;
+	m_VPInputWidth = 0;
+	m_VPInputHeight = 0;
+	m_VPOutputWidth = 0;
+	m_VPOutputHeight = 0;
+	m_VPOutputFormat = DXGI_FORMAT_UNKNOWN;
+	m_nReadBands = 0;
+	for (int i = 0; i < SPOUT_READBACK_BANDS; i++) {
+		m_pBandStaging[i] = nullptr;
+		m_pBandQuery[i] = nullptr;
+	}
+	m_BandWidth = 0;
+	m_BandHeight = 0;
+	m_dwBandFormat = 0;
+	m_pConvertShader = nullptr;
+	m_pConvertYUVShader = nullptr;
+	m_pConvertConstants = nullptr;
+	m_pConvertBuffer = nullptr;
+	m_pConvertUAV = nullptr;
+	m_pConvertStaging[0] = nullptr;
+	m_pConvertStaging[1] = nullptr;
+	m_ConvertSize = 0;
+	m_pConvertSRV = nullptr;
+	m_pConvertSource = nullptr;
+
+	m_bReceiveAnalysis = false;
+	m_pScopeShader = nullptr;
+	m_pScopeBuffer = nullptr;
+	m_pScopeUAV = nullptr;
+	m_pScopeStaging[0] = nullptr;
+	m_pScopeStaging[1] = nullptr;
+	m_bScopePending[0] = false;
+	m_bScopePending[1] = false;
+	m_ScopeIndex = 0;
+	m_pScopeSRV = nullptr;
+	m_pScopeSource = nullptr;
 
 	m_pSharedTexture = nullptr;
+	m_pSharedSRV = nullptr;
+	m_pSharedRTV = nullptr;
+	m_pSharedRTVTexture = nullptr;
+	m_bFrameBegun = false;
 	m_dxShareHandle = nullptr;
 	m_SenderNameSetup[0] = 0;
 	m_SenderName[0] = 0;
 	m_dwFormat = DXGI_FORMAT_B8G8R8A8_UNORM; // default;
 	m_Width = 0;
 	m_Height = 0;
+	m_ArraySize = 1;
+	m_MipLevels = 1;
+	m_bSenderMips = false;
+	m_bNThandle = false;
+	m_hNThandle = nullptr;
+	m_NThandleCount = 0;
+	m_pWaitSwapChain = nullptr;
+	m_hSwapChainWait = nullptr;
+	m_SwapChainLatency = 0.0;
 	m_bUpdated = false;
 	m_bConnected = false;
 	m_bSpoutInitialized = false;
+	m_bSenderFound = false;
+	m_SenderGeneration = 0;
+	m_dwSenderCheck = 0;
+	m_SharedGeneration = 0;
+	m_SenderInfoChange = 0;
+	m_SenderInfoGeneration = 0;
+	m_dwSenderInfoCheck = 0;
+	m_bPreconnect = false;
+	m_bIdleReceive = false;
+	m_dwIdleTimeout = 0;
+	m_IdleGeneration = 0;
 	m_bSpoutPanelOpened = false;
 	m_bSpoutPanelActive = false;
 	m_bClassDevice = false;
 	m_bMirror = false;
 	m_bSwapRB = false;
 	m_bAdapt = false; // Receiver switch to the sender's graphics adapter
+	m_bBridge = false; // Receiver copy from the sender's graphics adapter
+
+	// Adapter bridge
+	m_pBridgeDevice = nullptr;
+	m_pBridgeContext = nullptr;
+	m_pBridgeShared = nullptr;
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		m_pBridgeStaging[i] = nullptr;
+		m_BridgeCopy[i] = 0;
+	}
+	m_BridgeCount = 0;
+	m_BridgeNext = 0;
+
+	// Sender replicas
+	for (int i = 0; i < SPOUT_MAX_REPLICAS; i++) {
+		m_ReplicaAdapter[i] = -1;
+		m_pReplicaDevice[i] = nullptr;
+		m_pReplicaContext[i] = nullptr;
+		m_pReplicaTexture[i] = nullptr;
+	}
+	m_nReplicaAdapters = 0;
+	m_nReplicas = 0;
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		m_pReplicaStaging[i] = nullptr;
+		m_ReplicaCopy[i] = 0;
+	}
+	m_ReplicaCount = 0;
+	m_ReplicaNext = 0;
 	m_bMemoryShare = GetMemoryShareMode(); // 2.006 memoryshare mode
 
+	// Shared texture ring
+	for (int i = 0; i < 4; i++) {
+		m_pRingTexture[i] = nullptr;
+		m_pRingMutex[i] = nullptr;
+	}
+	m_nRing = 0;
+	m_nRingOpen = 0;
+	m_RingFrame = 0;
+	m_bRingOrdered = false;
+	m_pRingFence = nullptr;
+	m_pRingContext = nullptr;
+
+	// Send policy
+	m_SendPolicy = SPOUT_SEND_DEFAULT;
+	m_dwSendTimeout = 1000;
+	m_SendDropped = 0;
+	m_SendOverrun = 0;
+	m_bFrameAck = false;
+
+	// Atlas sub-senders
+	ZeroMemory(m_AtlasSender, sizeof(m_AtlasSender));
+	m_nAtlas = 0;
+	m_bAtlasRegion = false;
+	m_AtlasRegion = {};
+
+	// Deferred send
+	m_bDeferredSend = false;
+	m_pDeferredContext = nullptr;
+	m_pCommandList = nullptr;
+	InitializeSRWLock(&m_DeferredLock);
+	m_DeferredWidth = 0;
+	m_DeferredHeight = 0;
+	m_DeferredArraySize = 0;
+	m_dwDeferredFormat = 0;
+
+	// Frame slices
+	m_nSendSlices = 0;
+	m_ReceiveSlices = 0;
+	m_ReceiveSliceFrame = 0;
+	m_ReceiveSliceNext = 0;
+
+	// Asynchronous send
+	m_bAsyncSend = false;
+	for (int i = 0; i < SPOUT_ASYNC_TEXTURES; i++)
+		m_pAsyncTexture[i] = nullptr;
+	m_AsyncWrite = -1;
+	m_AsyncRead = -1;
+	InitializeSRWLock(&m_AsyncLock);
+	m_hAsyncThread = NULL;
+	m_hAsyncStop = NULL;
+	m_hAsyncEvent = NULL;
+	m_pMultithread = nullptr;
+
+	// Preview texture
+	m_pPreviewTexture = nullptr;
+	m_pPreviewMips = nullptr;
+	m_pPreviewSRV = nullptr;
+	m_pPreviewReceived = nullptr;
+	m_PreviewMaxWidth = 0;
+	m_PreviewLevel = 0;
+	m_PreviewWidth = 0;
+	m_PreviewHeight = 0;
+	m_bPreviewOpen = false;
+	m_PreviewFrame = 0;
+
+	// Shared images
+	m_bSharedImages = false;
+	m_bReceiveSharedImage = false;
+	ZeroMemory(m_SharedImageKey, sizeof(m_SharedImageKey));
+	m_pImageStaging[0] = nullptr;
+	m_pImageStaging[1] = nullptr;
+	m_ImageIndex = 0;
+	m_ImageFrame = 0;
+	m_ReceivedImageKey = {};
+	m_ImageRequestTime = 0;
+	m_ReceivedImageFrame = 0;
+	m_ImageRetry = 0;
+
+	// Frame cache
+	m_bFrameCache = false;
+	m_FrameCacheWidth = 0;
+	m_FrameCacheHeight = 0;
+	m_dwFrameCacheFormat = 0;
+	m_FrameCacheLast = 0;
+	m_StagingFrame[0] = 0;
+	m_StagingFrame[1] = 0;
+
+	// YUV texture
+	m_YUVFormat = DXGI_FORMAT_UNKNOWN;
+	m_pYUVTexture = nullptr;
+	m_pYUVReceived = nullptr;
+	m_pYUVStaging = nullptr;
+	m_YUVWidth = 0;
+	m_YUVHeight = 0;
+	m_dwYUVFormat = 0;
+	m_bYUVOpen = false;
+	m_YUVFrame = 0;
+	m_YUVPixelFrame = 0;
+	m_pYUVPixels = nullptr;
+	m_pVideoDevice = nullptr;
+	m_pVideoContext = nullptr;
+	m_pVideoEnum = nullptr;
+	m_pVideoProcessor = nullptr;
+	m_pYUVOutputView = nullptr;
+	m_pYUVInputView = nullptr;
+	m_pYUVSource = nullptr;
+
 	ZeroMemory(&m_SenderInfo, sizeof(SharedTextureInfo));
 	ZeroMemory(&m_ShExecInfo, sizeof(m_ShExecInfo));
+	m_hSpoutPanelWait = NULL;
+	m_SpoutPanelClosed = 0;
+	m_SelectedSender[0] = 0;
 
 }
 
 spoutDX::~spoutDX()
 {
+	// The SpoutPanel wait callback must not run after the class is destroyed
+	ReleaseSpoutPanel();
+
 	if (m_bConnected) {
 		// Receiver object
 		// Do not release the connected sender name
@@ -227,8 +809,12 @@ spoutDX::~spoutDX()
 		ReleaseSender();
 	}
 
+	// Swap chain waitable object if used
+	ReleaseSwapChainWait();
+
 	CloseDirectX11();
 	memorybuffer.Close();
+	CloseDataChannels();
 
 }
 
@@ -300,13 +886,42 @@ void spoutDX::CloseDirectX11()
 	m_pTexture = nullptr;
 	m_dxShareHandle = nullptr;
 
-	if (m_pStaging[0]) spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pStaging[0]);
-	if (m_pStaging[1]) spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pStaging[1]);
+	ReleaseTextureRing();
+	ReleasePreview();
+	ReleaseYUV();
+	ReleaseReplicas();
+	ReleaseSharedImages();
+	ReleaseFrameCache();
+	ReleaseConvert();
+	ReleaseScope();
+	ReleaseVideoProcessor();
+	ReleaseReadbackBands();
+
+	ReleaseImageView();
+	// Return staging textures to the process pool
+	spoutdx.ReleaseStagingTexture(m_pStaging[0]);
+	spoutdx.ReleaseStagingTexture(m_pStaging[1]);
 	m_pStaging[0] = nullptr;
 	m_pStaging[1] = nullptr;
 	m_Index = 0;
 	m_NextIndex = 0;
+	m_StagingFrame[0] = 0;
+	m_StagingFrame[1] = 0;
+	m_bStagingView[0] = false;
+	m_bStagingView[1] = false;
 	
+	// Sender textures retained by OpenSharedTexture
+	spoutdx.ReleaseSharedTextures();
+
+	// GPU timing queries
+	spoutdx.ReleaseGPUTiming();
+
+	// Deferred context and command list
+	ReleaseDeferred(true);
+
+	// Asynchronous send thread and snapshot textures
+	StopAsyncSend();
+
 	// Flush now to avoid deferred object destruction
 	if (m_pImmediateContext) m_pImmediateContext->Flush();
 
@@ -335,6 +950,108 @@ bool spoutDX::IsClassDevice()
 	return m_bClassDevice;
 }
 
+//---------------------------------------------------------
+// Function: EnableGPUTiming
+// Record the GPU time of copies in the timer.
+//
+//   The shared texture copy of SendTexture and ReceiveTexture is
+//   recorded as "GPUSharedCopy" and the staging copy of SendImage
+//   and ReceiveImage as "GPUStagingCopy". Times are read from
+//   timestamp queries a few frames later and recorded if the
+//   timer is also enabled (timer.Enable()).
+void spoutDX::EnableGPUTiming(bool bEnable)
+{
+	spoutdx.EnableGPUTiming(bEnable ? &timer : nullptr);
+}
+
+//---------------------------------------------------------
+// Function: IsGPUTiming
+// GPU timing status
+bool spoutDX::IsGPUTiming()
+{
+	return spoutdx.IsGPUTiming();
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryUsage
+// Memory held by this sender or receiver by category and heap.
+//
+// Shared textures of the sender, ring, preview, YUV and replicas
+// and the receiving textures are in video memory. Staging textures
+// are counted as system memory and shared memory maps by their size.
+// The figures are found from the resources held at the time of the query,
+// so are current after any are created or released. An application texture
+// set by SetReceiverTexture, the process staging pool and shared textures
+// retained by OpenSharedTexture are not included.
+bool spoutDX::GetMemoryUsage(SpoutMemoryUsage& usage)
+{
+	usage = {};
+
+	// Textures
+	spoutdx.AddTextureUsage(usage, m_pSharedTexture);
+	spoutdx.AddTextureUsage(usage, m_pTexture);
+	for (int i = 0; i < 2; i++) {
+		spoutdx.AddTextureUsage(usage, m_pStaging[i]);
+		spoutdx.AddTextureUsage(usage, m_pImageStaging[i]);
+	}
+	for (int i = 0; i < 4; i++)
+		spoutdx.AddTextureUsage(usage, m_pRingTexture[i]);
+	for (int i = 0; i < SPOUT_ASYNC_TEXTURES; i++)
+		spoutdx.AddTextureUsage(usage, m_pAsyncTexture[i]);
+	spoutdx.AddTextureUsage(usage, m_pPreviewTexture);
+	spoutdx.AddTextureUsage(usage, m_pPreviewMips);
+	spoutdx.AddTextureUsage(usage, m_pPreviewReceived);
+	spoutdx.AddTextureUsage(usage, m_pYUVTexture);
+	spoutdx.AddTextureUsage(usage, m_pYUVReceived);
+	spoutdx.AddTextureUsage(usage, m_pYUVStaging);
+	spoutdx.AddTextureUsage(usage, m_pVPTexture);
+	spoutdx.AddTextureUsage(usage, m_pVPStaging[0]);
+	spoutdx.AddTextureUsage(usage, m_pVPStaging[1]);
+	for (int i = 0; i < SPOUT_READBACK_BANDS; i++)
+		spoutdx.AddTextureUsage(usage, m_pBandStaging[i]);
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		spoutdx.AddTextureUsage(usage, m_pBridgeStaging[i]);
+		spoutdx.AddTextureUsage(usage, m_pReplicaStaging[i]);
+	}
+	for (int i = 0; i < SPOUT_MAX_REPLICAS; i++)
+		spoutdx.AddTextureUsage(usage, m_pReplicaTexture[i]);
+
+	// Shared memory
+	UINT64 bytes = (UINT64)memorybuffer.Size64()
+		+ (UINT64)m_RingMemory.Size64()
+		+ (UINT64)m_PreviewMemory.Size64()
+		+ (UINT64)m_YUVMemory.Size64()
+		+ (UINT64)m_ImageRequests.Size64()
+		+ (UINT64)m_ReceivedImage.Size64()
+		+ (UINT64)m_FrameCacheMemory.Size64()
+		+ (UINT64)m_ReplicaMemory.Size64();
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++)
+		bytes += (UINT64)m_SharedImage[i].Size64();
+	for (int i = 0; i < SPOUT_ATLAS_SENDERS; i++)
+		bytes += (UINT64)m_AtlasMemory[i].Size64();
+	usage.maps += bytes;
+	usage.sharedmap += bytes;
+
+	usage.total = usage.video + usage.system + usage.sharedmap;
+
+	return (usage.total > 0);
+}
+
+// Record the memory held with telemetry once a second
+void spoutDX::CheckTelemetryMemory()
+{
+	if (!frame.IsTelemetryEnabled())
+		return;
+
+	const DWORD dwNow = GetTickCount();
+	if ((dwNow - m_dwMemoryTime) > 1000) {
+		SpoutMemoryUsage usage;
+		GetMemoryUsage(usage);
+		frame.SetTelemetryMemory(usage.total);
+		m_dwMemoryTime = dwNow;
+	}
+}
+
 //---------------------------------------------------------
 // SENDER
 //
@@ -395,6 +1112,53 @@ void spoutDX::SetSenderFormat(DXGI_FORMAT format)
 	m_dwFormat = format;
 }
 
+//---------------------------------------------------------
+// Function: SetSenderMips
+// Create the sender texture with a mip chain.
+//   The levels are generated from the shared texture after each frame
+//   is sent (GenerateMips) and the number of levels is recorded in the
+//   sender information. Receivers can then copy a scaled down level
+//   for a small preview (ReceiveMipLevel) instead of the full texture.
+//   Not used for an array texture sender.
+//   An existing sender texture is re-created on the next send.
+void spoutDX::SetSenderMips(bool bMips)
+{
+	m_bSenderMips = bMips;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderMips
+// Sender mip chain option
+bool spoutDX::GetSenderMips()
+{
+	return m_bSenderMips;
+}
+
+//---------------------------------------------------------
+// Function: SetSenderNTHandle
+// Share the sender texture by a named NT handle.
+//   The texture is created with D3D11_RESOURCE_MISC_SHARED_NTHANDLE and
+//   the handle is named from the sender name "<sendername>_SpoutTexture_<id>".
+//   The identifier is recorded in place of the share handle and receivers
+//   open the texture by name with OpenSharedResourceByName.
+//   NT handles can be used for shared fences and by D3D12 and Vulkan.
+//   Requires D3D_FEATURE_LEVEL_11_1. Otherwise a legacy handle is used.
+//   Receivers of earlier versions cannot open a texture shared by name.
+//   The ring, preview and YUV textures use legacy handles.
+//   An existing sender texture is re-created on the next send.
+void spoutDX::SetSenderNTHandle(bool bNThandle)
+{
+	m_bNThandle = bNThandle;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderNTHandle
+// Sender NT handle option
+bool spoutDX::GetSenderNTHandle()
+{
+	return m_bNThandle;
+}
+
 //---------------------------------------------------------
 // Function: ReleaseSender
 // Close sender and release resources.
@@ -402,10 +1166,53 @@ void spoutDX::SetSenderFormat(DXGI_FORMAT format)
 // A new sender is created or updated by all sending functions
 void spoutDX::ReleaseSender()
 {
+	// Remove from a send batch of the thread
+	const auto batch = std::find(t_SendBatch.begin(), t_SendBatch.end(), this);
+	if (batch != t_SendBatch.end())
+		t_SendBatch.erase(batch);
+
+	// Stop the asynchronous send thread before the sender texture is released
+	StopAsyncSend();
+
+	// Allow access if a frame was begun and not ended
+	if (m_bFrameBegun && m_pSharedTexture)
+		frame.AllowTextureAccess(m_pSharedTexture);
+	m_bFrameBegun = false;
+	ReleaseSharedRTV();
+
+	if (m_pSharedSRV)
+		m_pSharedSRV->Release();
+	m_pSharedSRV = nullptr;
+
 	if (m_pSharedTexture) 
 		m_pSharedTexture->Release();
 	m_pSharedTexture = nullptr;
 	m_dxShareHandle = nullptr;
+	ReleaseSenderNTHandle();
+
+	// Release ring textures if used
+	ReleaseTextureRing();
+
+	// Release preview textures if used
+	ReleasePreview();
+
+	// Release YUV texture if used
+	ReleaseYUV();
+
+	// Release sender replicas if used
+	ReleaseReplicas();
+
+	// Release shared images if used
+	ReleaseSharedImages();
+
+	// Close the swap chain waitable object if used
+	ReleaseSwapChainWait();
+
+	// Release sub-sender names if used
+	ReleaseAtlasSenders();
+
+	// Release a command list that has not been submitted
+	ReleaseDeferred(false);
 
 	if (m_bSpoutInitialized) 
 		sendernames.ReleaseSenderName(m_SenderName);
@@ -415,8 +1222,9 @@ void spoutDX::ReleaseSender()
 	m_SenderName[0] = 0;
 	m_bSpoutInitialized = false;
 
-	// Close shared memory buffer if used
+	// Close shared memory buffer and data channels if used
 	memorybuffer.Close();
+	CloseDataChannels();
 
 }
 
@@ -451,6 +1259,120 @@ bool spoutDX::SendBackBuffer()
 	return false;
 }
 
+//---------------------------------------------------------
+// Function: SendSwapChain
+// Send the back buffer of a swap chain.
+//
+//   Call after rendering and before Present so that the copy
+//   is queued directly behind the frame. Buffer zero is the
+//   current back buffer for both flip and bitblt model swap chains.
+//   The swap chain must be created on the spoutDX device.
+//
+//   The milliseconds added to the frame by the send are returned
+//   in pLatency if used, and by GetSwapChainLatency. This is the
+//   CPU time of the send. The GPU time of the copy is recorded
+//   by EnableGPUTiming.
+//
+bool spoutDX::SendSwapChain(IDXGISwapChain* pSwapChain, double* pLatency)
+{
+	if (!pSwapChain)
+		return false;
+
+	// Make sure DirectX is initialized
+	if (!OpenDirectX11())
+		return false;
+
+	LARGE_INTEGER start{};
+	LARGE_INTEGER end{};
+	LARGE_INTEGER frequency{};
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+
+	// The back buffer can only be copied on the same device
+	ID3D11Device* pDevice = nullptr;
+	if (FAILED(pSwapChain->GetDevice(__uuidof(ID3D11Device), (void**)&pDevice)) || !pDevice) {
+		SpoutLogError("spoutDX::SendSwapChain - could not get the swap chain device");
+		return false;
+	}
+	pDevice->Release();
+	if (pDevice != m_pd3dDevice) {
+		SpoutLogError("spoutDX::SendSwapChain - swap chain is not on the spoutDX device");
+		return false;
+	}
+
+	ID3D11Texture2D* pBackBuffer = nullptr;
+	if (FAILED(pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&pBackBuffer)) || !pBackBuffer) {
+		SpoutLogError("spoutDX::SendSwapChain - could not get the back buffer");
+		return false;
+	}
+
+	// SendTexture handles sender creation and re-sizing.
+	const bool bSent = SendTexture(pBackBuffer);
+	pBackBuffer->Release();
+
+	QueryPerformanceCounter(&end);
+	m_SwapChainLatency = (double)(end.QuadPart - start.QuadPart)*1000.0/(double)frequency.QuadPart;
+	if (pLatency)
+		*pLatency = m_SwapChainLatency;
+
+	return bSent;
+}
+
+//---------------------------------------------------------
+// Function: WaitSwapChain
+// Wait on the frame latency waitable object of a swap chain.
+//
+//   For a flip model swap chain created with
+//   DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT.
+//   Call before rendering in place of the application's own wait
+//   so that the frame, SendSwapChain and Present keep within the
+//   frame latency set for the swap chain (SetMaximumFrameLatency).
+//   The object is opened on the first call and kept until
+//   the swap chain changes or the sender is released.
+//
+//   Returns false if the swap chain has no waitable object
+//   or the wait timed out.
+//
+bool spoutDX::WaitSwapChain(IDXGISwapChain* pSwapChain, DWORD dwTimeout)
+{
+	if (!pSwapChain)
+		return false;
+
+	IDXGISwapChain2* pSwapChain2 = nullptr;
+	if (FAILED(pSwapChain->QueryInterface(__uuidof(IDXGISwapChain2), (void**)&pSwapChain2)) || !pSwapChain2)
+		return false;
+
+	if (pSwapChain2 != m_pWaitSwapChain) {
+		ReleaseSwapChainWait();
+		DXGI_SWAP_CHAIN_DESC desc{};
+		pSwapChain2->GetDesc(&desc);
+		if (!(desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT)) {
+			pSwapChain2->Release();
+			return false;
+		}
+		m_hSwapChainWait = pSwapChain2->GetFrameLatencyWaitableObject();
+		if (!m_hSwapChainWait) {
+			pSwapChain2->Release();
+			return false;
+		}
+		// Keep the reference for the waitable object
+		m_pWaitSwapChain = pSwapChain2;
+	}
+	else {
+		pSwapChain2->Release();
+	}
+
+	return (WaitForSingleObjectEx(m_hSwapChainWait, dwTimeout, TRUE) == WAIT_OBJECT_0);
+}
+
+//---------------------------------------------------------
+// Function: GetSwapChainLatency
+// Milliseconds added by the last SendSwapChain
+double spoutDX::GetSwapChainLatency()
+{
+	return m_SwapChainLatency;
+}
+
 //---------------------------------------------------------
 // Function: SendTexture
 // Send DirectX11 texture
@@ -483,6 +1405,14 @@ bool spoutDX::SendTexture(ID3D11Texture2D* pTexture)
 	if (!OpenDirectX11())
 		return false;
 
+	// Record the copy for SubmitSend if deferred
+	if (m_bDeferredSend)
+		return SendDeferred(pTexture);
+
+	// Copy to a snapshot for the send thread if asynchronous
+	if (m_bAsyncSend)
+		return SendAsync(pTexture);
+
 	// Get the texture details to check for zero size
 	D3D11_TEXTURE2D_DESC desc;
 	ZeroMemory(&desc, sizeof(desc));
@@ -491,21 +1421,62 @@ bool spoutDX::SendTexture(ID3D11Texture2D* pTexture)
 		return false;
 
 	// Create or update the sender
-	if (!CheckSender(desc.Width, desc.Height, (DWORD)desc.Format))
+	// An array texture is shared with the same number of views
+	if (!CheckSender(desc.Width, desc.Height, (DWORD)desc.Format, desc.ArraySize))
 		return false;
 
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+
+	// Wait until registered receivers have acknowledged the last frame
+	if (m_SendPolicy == SPOUT_SEND_BLOCK && !frame.WaitFrameAck(m_dwSendTimeout))
+		m_SendOverrun++;
+
+	// Ring, preview and YUV textures have one view
+	if (m_ArraySize == 1) {
+		// Write to the next texture of the ring if used
+		WriteTextureRing(pTexture);
+		// Write the preview texture if used
+		WritePreview(pTexture);
+	}
+
+	spoutTimerScope scope(&timer, "SendTexture");
+
 	// Check the sender mutex for access the shared texture
-	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+	// Do not wait for receivers if the latest frame policy is set
+	const LONG64 accessStart = timer.Start();
+	const bool bAccess = (m_SendPolicy == SPOUT_SEND_LATEST)
+		? frame.CheckTextureAccess(m_pSharedTexture, 0)
+		: frame.CheckTextureAccess(m_pSharedTexture);
+	if (bAccess) {
+		timer.Stop("CheckAccess", accessStart);
 		// Copy the application texture to the sender's shared texture
-		m_pImmediateContext->CopyResource(m_pSharedTexture, pTexture);
+		// (the top level if the sender texture has a mip chain)
+		spoutdx.BeginGPUTime(m_pImmediateContext, "GPUSharedCopy");
+		// Copy and publish in slices if used (SetSendSlices)
+		if (!WriteSenderSlices(pTexture))
+			spoutdx.CopySharedTexture(m_pImmediateContext, m_pSharedTexture, pTexture);
+		// Update the mip chain if used
+		GenerateSenderMips();
+		spoutdx.EndGPUTime(m_pImmediateContext);
+		// Convert to the YUV texture and update replicas if used
+		if (m_ArraySize == 1) {
+			WriteYUV(m_pSharedTexture);
+			WriteReplicas(m_pSharedTexture);
+		}
 		// Flush the command queue now because the shared texture has been updated on this device
-		m_pImmediateContext->Flush();
-		// Signal a new frame while the mutex is locked
-		frame.SetNewFrame();
+		// and signal a new frame while the mutex is locked, or queue for EndSendBatch
+		SignalSend();
 		// Allow access to the shared texture
 		frame.AllowTextureAccess(m_pSharedTexture);
+		// Convert images requested by receivers if used
+		WriteSharedImages(m_pSharedTexture);
+	}
+	else {
+		m_SendDropped++;
 	}
 
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
 	return true;
 }
 
@@ -556,2096 +1527,9220 @@ bool spoutDX::SendTexture(ID3D11Texture2D* pTexture,
 		return false;
 	}
 
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+
+	// Write to the next texture of the ring if used
+	WriteTextureRing(pTexture, &sourceRegion);
+
+	// Write the preview texture if used
+	WritePreview(pTexture, &sourceRegion);
+
 	// Check the sender mutex for access the shared texture
 	if (frame.CheckTextureAccess(m_pSharedTexture)) {
 		// Copy the texture region to the sender's shared texture
 		m_pImmediateContext->CopySubresourceRegion(m_pSharedTexture, 0, 0, 0, 0, pTexture, 0, &sourceRegion);
+		// Update the mip chain if used
+		GenerateSenderMips();
+		// Convert to the YUV texture if used
+		WriteYUV(m_pSharedTexture);
+		// Update sender replicas if used
+		WriteReplicas(m_pSharedTexture);
 		// Flush the command queue now because the shared texture has been updated on this device
-		m_pImmediateContext->Flush();
-		// Signal a new frame while the mutex is locked
-		frame.SetNewFrame();
+		// and signal a new frame while the mutex is locked, or queue for EndSendBatch
+		SignalSend();
 		// Allow access to the shared texture
 		frame.AllowTextureAccess(m_pSharedTexture);
+		// Convert images requested by receivers if used
+		WriteSharedImages(m_pSharedTexture);
+	}
+
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
+	return true;
+}
+
+
+// Flush the command queue and signal a new frame after the shared
+// texture has been updated, or queue the sender if a send batch
+// has been started on this thread (BeginSendBatch)
+void spoutDX::SignalSend()
+{
+	if (t_bSendBatch) {
+		if (std::find(t_SendBatch.begin(), t_SendBatch.end(), this) == t_SendBatch.end())
+			t_SendBatch.push_back(this);
+		return;
 	}
+	m_pImmediateContext->Flush();
+	frame.SetNewFrame();
+	SpoutTrace(SPOUT_TRACE_FLUSH, m_SenderName, frame.GetSenderFrame64());
+}
 
+// Region of a dirty rectangle within the texture
+static bool DirtyRectBox(const RECT &rect, unsigned int width, unsigned int height, D3D11_BOX &box)
+{
+	const LONG right  = (rect.right  < (LONG)width)  ? rect.right  : (LONG)width;
+	const LONG bottom = (rect.bottom < (LONG)height) ? rect.bottom : (LONG)height;
+	if (rect.left < 0 || rect.top < 0 || rect.left >= right || rect.top >= bottom)
+		return false;
+	box.left   = (UINT)rect.left;
+	box.top    = (UINT)rect.top;
+	box.right  = (UINT)right;
+	box.bottom = (UINT)bottom;
+	box.front  = 0;
+	box.back   = 1;
 	return true;
 }
 
+// Rows of a horizontal slice of the texture (SetSendSlices)
+static D3D11_BOX SliceBox(unsigned int slice, unsigned int nSlices, unsigned int width, unsigned int height)
+{
+	D3D11_BOX box={};
+	box.left   = 0;
+	box.right  = width;
+	box.top    = (UINT)(((uint64_t)height * slice) / nSlices);
+	box.bottom = (UINT)(((uint64_t)height * (slice + 1)) / nSlices);
+	box.front  = 0;
+	box.back   = 1;
+	return box;
+}
 
 //---------------------------------------------------------
-// Function: SendImage
-// Send pixel image
-bool spoutDX::SendImage(const unsigned char * pData, unsigned int width, unsigned int height)
+// Function: SendTexture
+// Send the changed regions of a DirectX11 texture
+//
+// The rectangles are pixels from the top left of the texture with
+// right and bottom exclusive. Only the rectangles are copied to the
+// sender's shared texture and they are published for receivers
+// so that a receiver can read back only the regions that changed.
+// The whole texture is copied if the sender is created or changes size.
+//
+bool spoutDX::SendTexture(ID3D11Texture2D* pTexture, const RECT* pDirtyRects, unsigned int nRects)
 {
-	// Quit if no data
-	if (!pData)
+	if (!pDirtyRects || nRects == 0)
+		return SendTexture(pTexture);
+
+	if (!pTexture || !OpenDirectX11())
 		return false;
 
-	// Create or update the sender
-	if (!CheckSender(width, height, m_dwFormat))
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0)
 		return false;
 
-	// Check the sender mutex for access the shared texture
+	// A new shared texture has to be copied whole
+	ID3D11Texture2D* pShared = m_pSharedTexture;
+	if (!CheckSender(desc.Width, desc.Height, (DWORD)desc.Format))
+		return false;
+	const bool bWhole = (pShared != m_pSharedTexture);
+
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+
+	// Rectangles for the next frame
+	frame.SetDirtyRects(m_SenderName, bWhole ? nullptr : pDirtyRects, nRects);
+
+	WriteTextureRing(pTexture);
+	WritePreview(pTexture);
+
 	if (frame.CheckTextureAccess(m_pSharedTexture)) {
-		// Update the shared texture resource with the pixel buffer
-		m_pImmediateContext->UpdateSubresource(m_pSharedTexture, 0, NULL, pData, m_Width * 4, 0);
-		// Flush the command queue because the shared texture has been updated on this device
-		m_pImmediateContext->Flush();
-		// Signal a new frame while the mutex is locked
-		frame.SetNewFrame();
-		// Allow access to the shared texture
+		if (bWhole) {
+			spoutdx.CopySharedTexture(m_pImmediateContext, m_pSharedTexture, pTexture);
+		}
+		else {
+			D3D11_BOX box={};
+			for (unsigned int i = 0; i < nRects; i++) {
+				if (DirtyRectBox(pDirtyRects[i], m_Width, m_Height, box))
+					m_pImmediateContext->CopySubresourceRegion(m_pSharedTexture, 0, box.left, box.top, 0, pTexture, 0, &box);
+			}
+		}
+		GenerateSenderMips();
+		WriteYUV(m_pSharedTexture);
+		WriteReplicas(m_pSharedTexture);
+		// Signal a new frame and publish the rectangles while the mutex is locked
+		SignalSend();
 		frame.AllowTextureAccess(m_pSharedTexture);
+		// Convert images requested by receivers if used
+		WriteSharedImages(m_pSharedTexture);
 	}
 
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
 	return true;
 }
 
 //---------------------------------------------------------
-// Function: IsInitialized
-// Initialization status
-bool spoutDX::IsInitialized()
+// Function: SendTextureSlice
+// Send a horizontal slice of a texture as soon as it is rendered.
+//
+//   For an application that renders a frame in slices from the top
+//   (SetSendSlices). The slice is copied to the sender texture and
+//   published at once so that receivers can copy it before the rest
+//   of the frame is rendered. Slice 0 begins a new frame and the
+//   last slice completes it. Slices are the rows from
+//   slice*height/count to (slice+1)*height/count.
+//
+//   The texture is the size of the whole frame. Requires the shared fence
+//   (frame.EnableFenceSync). Without it, the whole texture is sent
+//   with the last slice. Not available for deferred or asynchronous send.
+bool spoutDX::SendTextureSlice(ID3D11Texture2D* pTexture, unsigned int slice)
 {
-	return m_bSpoutInitialized;
-}
+	if (!pTexture || !OpenDirectX11())
+		return false;
 
-//---------------------------------------------------------
-// Function: GetName
-// Sender name
-const char * spoutDX::GetName()
-{
-	return m_SenderName;
-}
+	if (m_nSendSlices < 2 || slice >= m_nSendSlices) {
+		SpoutLogWarning("spoutDX::SendTextureSlice - slice %d of %d", slice, m_nSendSlices);
+		return false;
+	}
 
-//---------------------------------------------------------
-// Function: GetWidth
-// Sender width
-unsigned int spoutDX::GetWidth()
-{
-	return m_Width;
+	if (m_bDeferredSend || m_bAsyncSend) {
+		SpoutLogWarning("spoutDX::SendTextureSlice - not available for deferred or asynchronous send");
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0)
+		return false;
+
+	// Create or update the sender
+	if (!CheckSender(desc.Width, desc.Height, (DWORD)desc.Format))
+		return false;
+
+	// Send the whole texture with the last slice if slices cannot be published
+	if (!frame.CreateFrameSlices(m_SenderName, m_nSendSlices)) {
+		if (slice == m_nSendSlices-1)
+			return SendTexture(pTexture);
+		return true;
+	}
+
+	if (slice == 0) {
+		SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+		frame.BeginFrameSlices();
+	}
+
+	// Receivers that do not use the fence rely on the access mutex
+	// while the slice is written, unless the fence is the only sync
+	const bool bMutex = !frame.IsFenceOnly();
+	if (bMutex && !frame.CheckAccess()) {
+		m_SendDropped++;
+		return false;
+	}
+	const bool bSlice = WriteSenderSlice(pTexture, slice);
+	if (bMutex)
+		frame.AllowAccess();
+	if (!bSlice)
+		return false;
+
+	// The frame is complete with the last slice
+	if (slice == m_nSendSlices-1) {
+		GenerateSenderMips();
+		WriteYUV(m_pSharedTexture);
+		WriteReplicas(m_pSharedTexture);
+		SignalSend();
+		WriteSharedImages(m_pSharedTexture);
+		SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+	}
+
+	return true;
 }
 
-//---------------------------------------------------------
-// Function: GetHeight
-// Sender height
-unsigned int spoutDX::GetHeight()
+// Copy the slices of a texture to the sender texture and publish each one
+// after it is copied (SetSendSlices). Returns false if slices are not used.
+bool spoutDX::WriteSenderSlices(ID3D11Texture2D* pTexture)
 {
-	return m_Height;
+	if (m_nSendSlices < 2 || m_ArraySize != 1
+		|| !frame.CreateFrameSlices(m_SenderName, m_nSendSlices))
+		return false;
+
+	frame.BeginFrameSlices();
+	for (unsigned int i = 0; i < m_nSendSlices; i++)
+		WriteSenderSlice(pTexture, i);
+
+	return true;
 }
 
-//---------------------------------------------------------
-// Function: GetFps
-// Sender frame rate
-//    Round result to reduce variability
-double spoutDX::GetFps()
+// Copy a slice of a texture to the sender texture and publish it.
+// The shared fence is signalled and the command queue flushed.
+bool spoutDX::WriteSenderSlice(ID3D11Texture2D* pTexture, unsigned int slice)
 {
-	return (frame.GetSenderFps());
+	const D3D11_BOX box = SliceBox(slice, m_nSendSlices, m_Width, m_Height);
+	m_pImmediateContext->CopySubresourceRegion(m_pSharedTexture, 0, 0, box.top, 0, pTexture, 0, &box);
+	return frame.SignalFrameSlice(slice);
 }
 
 //---------------------------------------------------------
-// Function: GetFrame
-// Sender frame number
-long spoutDX::GetFrame()
+// Function: BeginFrame
+// Begin rendering directly to the sender texture.
+//
+//   Returns a render target view of the sender texture, created or
+//   re-created at the width, height and format given (default the
+//   sender format, see SetSenderFormat). Render to the view and then
+//   call EndFrame to send the frame. There is no copy from an
+//   application texture as with SendTexture.
+//
+//   The sender mutex is held from BeginFrame until EndFrame, so render
+//   the frame and call EndFrame without delay. The texture may contain
+//   the previous frame or be cleared by other senders and should be
+//   cleared or fully rendered.
+//
+//   Returns null if receivers have access to the sender texture.
+//   The frame is not sent and counted as dropped (GetSendDropped).
+//   Not available for deferred or asynchronous send.
+ID3D11RenderTargetView* spoutDX::BeginFrame(unsigned int width, unsigned int height, DXGI_FORMAT format)
 {
-	return (frame.GetSenderFrame());
-}
+	if (m_bFrameBegun) {
+		SpoutLogWarning("spoutDX::BeginFrame - EndFrame has not been called");
+		return m_pSharedRTV;
+	}
 
+	if (m_bDeferredSend || m_bAsyncSend) {
+		SpoutLogWarning("spoutDX::BeginFrame - not available for deferred or asynchronous send");
+		return nullptr;
+	}
 
-//---------------------------------------------------------
-// RECEIVER
-//
+	if (!OpenDirectX11())
+		return nullptr;
 
-//
-// Group: Receiver
-//
-// ReceiveTexture and ReceiveImage
-//
-//	- Connect to a sender
-//	- Set class variables for sender name, width and height
-//  - If the sender has changed size, set a flag for the application to update
-//	  the receiving texture or imageif IsUpdated() returns true.
-//  - Copy the sender shared texture to the user texture or image.
-//
-
-//---------------------------------------------------------
-// Function: SetReceiverName
-// Specify sender for connection
-//
-//   The application will not connect to any other unless the user selects one
-//   If that sender closes, the application will wait for the nominated sender to open 
-//   If no name is specified, the receiver will connect to the active sender
-void spoutDX::SetReceiverName(const char * SenderName)
-{
-	if (SenderName && SenderName[0]) {
-		strcpy_s(m_SenderNameSetup, 256, SenderName);
-		strcpy_s(m_SenderName, 256, SenderName);
-	}
-}
-
-//---------------------------------------------------------
-// Function: ReleaseReceiver
-// Close receiver and release resources ready to connect to another sender
-void spoutDX::ReleaseReceiver()
-{
-	if (!m_bSpoutInitialized)
-		return;
-
-	SpoutLogNotice("ReleaseReceiver(%s)", m_SenderName);
-
-	// Restore the sender name if one was specified by SetReceiverName
-	if (m_SenderNameSetup[0])
-		strcpy_s(m_SenderName, 256, m_SenderNameSetup);
-	else
-		m_SenderName[0] = 0;
-
-	// Wait 4 frames in case the same sender opens again
-	Sleep(67);
+	if (format == DXGI_FORMAT_UNKNOWN)
+		format = (DXGI_FORMAT)m_dwFormat;
 
-	// Sender shared texture pointer
-	if (m_pSharedTexture) m_pSharedTexture->Release();
-	m_pSharedTexture = nullptr;
-	m_dxShareHandle = nullptr;
+	// Create or update the sender
+	if (!CheckSender(width, height, (DWORD)format))
+		return nullptr;
 
-	// Class receiving texture
-	if (m_pTexture)	m_pTexture->Release();
-	m_pTexture = nullptr;
-	
-	// Staging textures for ReceiveImage
-	if (m_pStaging[0]) spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pStaging[0]);
-	if (m_pStaging[1]) spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pStaging[1]);
-	m_pStaging[0] = nullptr;
-	m_pStaging[1] = nullptr;
-	m_Index = 0;
-	m_NextIndex = 0;
+	// The view is created again if the sender texture has been re-created
+	if (m_pSharedRTVTexture != m_pSharedTexture) {
+		ReleaseSharedRTV();
+		// The top level if the sender texture has a mip chain
+		D3D11_RENDER_TARGET_VIEW_DESC rtvd={};
+		rtvd.Format = format;
+		rtvd.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+		rtvd.Texture2D.MipSlice = 0;
+		const HRESULT hr = m_pd3dDevice->CreateRenderTargetView(m_pSharedTexture, &rtvd, &m_pSharedRTV);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDX::BeginFrame - could not create render target view (0x%.7X)", (unsigned int)hr);
+			m_pSharedRTV = nullptr;
+			return nullptr;
+		}
+		m_pSharedRTVTexture = m_pSharedTexture;
+	}
 
-	// Flush now to avoid deferred object destruction
-	if (m_pImmediateContext) m_pImmediateContext->Flush();
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
 
-	// Close the named access mutex and frame counting semaphore.
-	frame.CloseAccessMutex();
-	frame.CleanupFrameCount();
+	// Wait until registered receivers have acknowledged the last frame
+	if (m_SendPolicy == SPOUT_SEND_BLOCK && !frame.WaitFrameAck(m_dwSendTimeout))
+		m_SendOverrun++;
 
-	// Close shared memory buffer if used
-	memorybuffer.Close();
+	// Hold the sender mutex until EndFrame
+	const bool bAccess = (m_SendPolicy == SPOUT_SEND_LATEST)
+		? frame.CheckTextureAccess(m_pSharedTexture, 0)
+		: frame.CheckTextureAccess(m_pSharedTexture);
+	if (!bAccess) {
+		m_SendDropped++;
+		return nullptr;
+	}
 
-	// Zero width and height so that they are reset when a sender is found
-	m_Width = 0;
-	m_Height = 0;
-	
-	// Initialize again when a sender is found
-	m_bSpoutInitialized = false;
-	m_bUpdated = false;
+	m_bFrameBegun = true;
 
+	return m_pSharedRTV;
 }
 
 //---------------------------------------------------------
-// Function: ReceiveTexture
-//  Copy the sender DX11 shared texture to a class texture
+// Function: EndFrame
+// Send the frame rendered after BeginFrame.
 //
-bool spoutDX::ReceiveTexture()
+//   Ring, preview, YUV and replica textures are written
+//   from the sender texture if they are used.
+bool spoutDX::EndFrame()
 {
-	// Return if flagged for update
-	// The update flag is reset when the receiving application calls IsUpdated()
-	if (m_bUpdated)
-		return true;
-
-	// Try to receive texture details from a sender
-	if (ReceiveSenderData()) {
+	if (!m_bFrameBegun || !m_pSharedTexture)
+		return false;
 
-		// Was the shared texture pointer retrieved ?
-		if (!m_pSharedTexture) {
-			return false;
-		}
+	m_bFrameBegun = false;
+
+	// Update the mip chain if used
+	GenerateSenderMips();
+	// Write the ring, preview and YUV textures and replicas if used
+	WriteTextureRing(m_pSharedTexture);
+	WritePreview(m_pSharedTexture);
+	WriteYUV(m_pSharedTexture);
+	WriteReplicas(m_pSharedTexture);
+	// Flush the command queue now because the shared texture has been rendered on this device
+	// and signal a new frame while the mutex is locked, or queue for EndSendBatch
+	SignalSend();
+	// Allow access to the shared texture
+	frame.AllowTextureAccess(m_pSharedTexture);
+	// Convert images requested by receivers if used
+	WriteSharedImages(m_pSharedTexture);
+
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
 
-		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
-		if (m_bUpdated) {
-			m_bUpdated = false; // Reset for ReceiveSenderData
-			// Update the receiving class texture.
-			if (!CheckTexture(m_Width, m_Height, m_dwFormat))
-				return false;
-		}
+	return true;
+}
 
-		// The receiving texture is created on the first update above
-		// ready for copy from the sender's shared texture.
+//---------------------------------------------------------
+// Function: SendImage
+// Send pixel image
+bool spoutDX::SendImage(const unsigned char * pData, unsigned int width, unsigned int height)
+{
+	// Quit if no data
+	if (!pData)
+		return false;
 
-		//
-		// Found a sender
-		//
-		if (frame.CheckTextureAccess(m_pSharedTexture)) {
-			// Check if the sender has produced a new frame.
-			if (frame.GetNewFrame()) {
-				// Copy from the sender's shared texture to the receiving class texture.
-				m_pImmediateContext->CopyResource(m_pTexture, m_pSharedTexture);
-				// Testing has shown that Flush is needed here for the texture
-				// to be immediately available for subsequent copy.
-				// May be removed if the texture is not immediately copied.
-				// Test for the individual application.
-				m_pImmediateContext->Flush();
-			}
-			// Allow access to the shared texture
-			frame.AllowTextureAccess(m_pSharedTexture);
-		}
-		m_bConnected = true;
+	// Create or update the sender
+	if (!CheckSender(width, height, m_dwFormat))
+		return false;
 
-	} // sender exists
-	else {
-		// There is no sender or the connected sender closed.
-		ReleaseReceiver();
-		// Let the application know.
-		m_bConnected = false;
+	// Check the sender mutex for access the shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		// Update the shared texture resource with the pixel buffer
+		m_pImmediateContext->UpdateSubresource(m_pSharedTexture, 0, NULL, pData, m_Width * 4, 0);
+		// Update the mip chain if used
+		GenerateSenderMips();
+		// Write the preview texture if used
+		WritePreview(m_pSharedTexture);
+		// Convert to the YUV texture if used
+		WriteYUV(m_pSharedTexture);
+		// Update sender replicas if used
+		WriteReplicas(m_pSharedTexture);
+		// Flush the command queue because the shared texture has been updated on this device
+		// and signal a new frame while the mutex is locked, or queue for EndSendBatch
+		SignalSend();
+		// Allow access to the shared texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+		// Convert images requested by receivers if used
+		WriteSharedImages(m_pSharedTexture);
 	}
 
-	// ReceiveTexture fails if there is no sender or the connected sender closed.
-	return m_bConnected;
-
+	return true;
 }
 
 //---------------------------------------------------------
-// Function: ReceiveTexture
-//  Copy the sender DX11 shared texture
-//
-//    The receiving texture must be the same format
-//    and must be re-allocated if IsUpdated() returns true
-//
-bool spoutDX::ReceiveTexture(ID3D11Texture2D** ppTexture)
+// Function: SendImage
+// Send pixel image with a source line pitch and format
+//
+//   pitch    - bytes of each line including padding (0 for packed pixels)
+//   dwFormat - image format (0 for the sender format)
+//              DXGI_FORMAT_R8G8B8A8_UNORM or DXGI_FORMAT_B8G8R8A8_UNORM, or 24 bit
+//              RGB and BGR as the OpenGL values GL_RGB (0x1907) and GL_BGR_EXT (0x80E0)
+//   bInvert  - flip the image vertically
+//
+//   An image of the sender format, for example a capture card or video decoder frame,
+//   is updated directly from the source pitch without removing the padding first.
+//   Other formats are converted by spoutCopy to a staging texture of the sender format.
+bool spoutDX::SendImage(const unsigned char * pData, unsigned int width, unsigned int height,
+	unsigned int pitch, DWORD dwFormat, bool bInvert)
 {
-	// No texture
-	if (!ppTexture)
+	// Quit if no data
+	if (!pData)
 		return false;
 
-	// Return if flagged for update
-	// The update flag is reset when the receiving application calls IsUpdated()
-	if (m_bUpdated)
-		return true;
+	if (dwFormat == 0)
+		dwFormat = m_dwFormat;
 
-	// Try to receive texture details from a sender
-	if (ReceiveSenderData()) {
+	// The same format without invert is updated with the source pitch
+	const bool bDirect = (dwFormat == m_dwFormat && !bInvert);
+	if (bDirect && (pitch == 0 || pitch == width*4))
+		return SendImage(pData, width, height);
 
-		// Was the shared texture pointer retrieved ?
-		if (!m_pSharedTexture) {
-			return false;
-		}
+	// Create or update the sender
+	if (!CheckSender(width, height, m_dwFormat))
+		return false;
 
-		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
-		if (m_bUpdated) {
-			// If the sender is new or changed, return to update the receiving texture.
-			// The application detects the change with IsUpdated().
-			return true;
-		}
+	// Staging textures of the sender format for conversion
+	if (!bDirect && !CheckStagingTextures(m_Width, m_Height, m_dwFormat))
+		return false;
 
-		// The application receiving texture is created
-		// by the application on the first update above
-		// ready for copy from the sender's shared texture.
-		// Test for it here.
-		ID3D11Texture2D* pTexture = *ppTexture;
-		if (!pTexture) {
-			return false;
+	bool bWritten = false;
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (bDirect) {
+			m_pImmediateContext->UpdateSubresource(m_pSharedTexture, 0, NULL, pData, pitch, 0);
+			bWritten = true;
 		}
-
-		//
-		// Found a sender
-		//
-		if (frame.CheckTextureAccess(m_pSharedTexture)) {
-			// Check if the sender has produced a new frame.
-			if (frame.GetNewFrame()) {
-				// Copy from the sender's shared texture to the receiving texture.
-				m_pImmediateContext->CopyResource(pTexture, m_pSharedTexture);
-				// Testing has shown that Flush is needed here for the texture
-				// to be immediately available for subsequent copy.
-				// May be removed if the texture is not immediately copied.
-				// Test for the individual application.
-				m_pImmediateContext->Flush();
-			 }
-			// Allow access to the shared texture
-			frame.AllowTextureAccess(m_pSharedTexture);
+		else {
+			// Alternate staging textures so that the map does not wait
+			// for the copy of the previous frame
+			m_Index = (m_Index + 1) % 2;
+			D3D11_MAPPED_SUBRESOURCE mapped={};
+			if (SUCCEEDED(m_pImmediateContext->Map(m_pStaging[m_Index], 0, D3D11_MAP_WRITE, 0, &mapped))) {
+				bWritten = spoutcopy.ConvertPixels(pData, mapped.pData, m_Width, m_Height,
+					dwFormat, m_dwFormat, pitch, mapped.RowPitch, bInvert);
+				m_pImmediateContext->Unmap(m_pStaging[m_Index], 0);
+				if (bWritten)
+					m_pImmediateContext->CopyResource(m_pSharedTexture, m_pStaging[m_Index]);
+				else
+					SpoutLogWarning("spoutDX::SendImage - format %d not supported", dwFormat);
+			}
 		}
-		m_bConnected = true;
-
-	} // sender exists
-	else {
-		// There is no sender or the connected sender closed.
-		ReleaseReceiver();
-		// Let the application know.
-		m_bConnected = false;
+		if (bWritten) {
+			GenerateSenderMips();
+			WritePreview(m_pSharedTexture);
+			WriteYUV(m_pSharedTexture);
+			WriteReplicas(m_pSharedTexture);
+			SignalSend();
+		}
+		frame.AllowTextureAccess(m_pSharedTexture);
+		if (bWritten)
+			WriteSharedImages(m_pSharedTexture);
 	}
 
-	// ReceiveTexture fails if there is no sender or the connected sender closed.
-	return m_bConnected;
-
+	return bWritten;
 }
 
 //---------------------------------------------------------
-// Function: ReceiveImage
-// Receive from a sender via DX11 staging textures to an rgba or rgb buffer of variable size
-// A new shared texture pointer (m_pSharedTexture) is retrieved if the sender changed
-bool spoutDX::ReceiveImage(unsigned char * pixels,
-	unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+// Function: PrepareSender
+// Create sender resources before the first frame is sent.
+//   The shared texture, ring, preview and YUV textures, sender mutex
+//   and frame count are created and the mutex is opened once so that
+//   the first SendTexture or SendImage does not allocate.
+//   A new frame is not signalled, so receivers do not read the empty texture.
+//   The default format is the current sender format (SetSenderFormat).
+bool spoutDX::PrepareSender(const char* sendername, unsigned int width, unsigned int height, DWORD dwFormat)
 {
-	// Return if flagged for update
-	// The update flag is reset when the receiving application calls IsUpdated()
-	if (m_bUpdated)
-		return true;
+	if (sendername && *sendername) {
+		if (!SetSenderName(sendername))
+			return false;
+	}
 
+	if (dwFormat == 0)
+		dwFormat = m_dwFormat;
 
-	// Try to receive texture details from a sender
-	if (ReceiveSenderData()) {
+	if (!CheckSender(width, height, dwFormat))
+		return false;
 
-		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
-		if (m_bUpdated) {
-			// A new sender has been found or the one connected has changed.
-			// The staging textures must be the same size and format as the sender
-			// Create new staging textures if it is a different size
-			CheckStagingTextures(m_Width, m_Height, m_dwFormat);
-			// The application detects the change with IsUpdated()
-			// and the receiving buffer is updated to match the sender.
-			return true;
-		}
+	// Open the sender mutex without signalling a new frame
+	if (frame.CheckTextureAccess(m_pSharedTexture))
+		frame.AllowTextureAccess(m_pSharedTexture);
 
+	// Submit the texture creation work now
+	m_pImmediateContext->Flush();
 
-		// The receiving pixel buffer is created after the first update
-		// So check here instead of at the beginning
-		if (!pixels)
-			return false;
+	SpoutLogNotice("spoutDX::PrepareSender - [%s] %dx%d prepared", m_SenderName, width, height);
 
-		// No staging textures - no copy
-		if (!m_pStaging[0] || !m_pStaging[1])
-			return false;
+	return true;
+}
 
+//---------------------------------------------------------
+// Function: IsInitialized
+// Initialization status
+bool spoutDX::IsInitialized()
+{
+	return m_bSpoutInitialized;
+}
 
-		//
-		// Found a sender
-		//
-		// Access the sender shared texture
-		if (frame.CheckTextureAccess(m_pSharedTexture)) {
-			// Check if the sender has produced a new frame.
-			if (frame.GetNewFrame()) {
-				// Read from the sender GPU texture to CPU pixels via two staging textures
-				// One texture - approx 7 - 12 msec at 1920x1080
-				// Two textures - approx 2.5 - 3.5 msec at 1920x1080
-				m_Index = (m_Index + 1) % 2;
-				m_NextIndex = (m_Index + 1) % 2;
-				// Copy from the sender's shared texture to the first staging texture
-				m_pImmediateContext->CopyResource(m_pStaging[m_Index], m_pSharedTexture);
-				// Map and read from the second while the first is occupied
-				ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, bRGB, bInvert, false);
-			}
-			// Allow access to the shared texture
-			frame.AllowTextureAccess(m_pSharedTexture);
-		}
-		m_bConnected = true;
-	} // sender exists
-	else {
-		// There is no sender or the connected sender closed.
-		ReleaseReceiver();
-		// Let the application know.
-		m_bConnected = false;
-	}
-
-	// ReceiveImage fails if there is no sender or the connected sender closed.
-	return m_bConnected;
+//---------------------------------------------------------
+// Function: GetName
+// Sender name
+const char * spoutDX::GetName()
+{
+	return m_SenderName;
+}
 
+//---------------------------------------------------------
+// Function: GetWidth
+// Sender width
+unsigned int spoutDX::GetWidth()
+{
+	return m_Width;
 }
 
 //---------------------------------------------------------
-// Function: ReadTexurePixels
-// Read pixels from texture
-bool spoutDX::ReadTexurePixels(ID3D11Texture2D* pTexture, unsigned char* pixels)
+// Function: GetHeight
+// Sender height
+unsigned int spoutDX::GetHeight()
 {
-	if (!pTexture || !pixels)
-		return false;
+	return m_Height;
+}
 
-	// Get texture size
-	D3D11_TEXTURE2D_DESC desc={};
-	pTexture->GetDesc(&desc);
-	unsigned int width = desc.Width;
-	unsigned int height = desc.Height;
+//---------------------------------------------------------
+// Function: GetFps
+// Sender frame rate
+//    Round result to reduce variability
+double spoutDX::GetFps()
+{
+	return (frame.GetSenderFps());
+}
 
-	// Set global width and height for ReadPixelData
-	if (!m_pStaging[0]) {
-		m_Width = width;
-		m_Height = height;
-	}
+//---------------------------------------------------------
+// Function: GetFrame
+// Sender frame number
+long spoutDX::GetFrame()
+{
+	return (frame.GetSenderFrame());
+}
 
-	// Update staging textures if necessary
-	CheckStagingTextures(width, height, m_dwFormat);
-	if (!m_pStaging[0] || !m_pStaging[1])
-		return false;
+//---------------------------------------------------------
+// Function: SetTextureRing
+// Set the number of shared textures for a sender texture ring.
+//
+// A sender can write to a ring of 3-4 shared textures in addition
+// to the sender shared texture. The texture handles and the index of the 
+// last texture written are saved in shared memory "<sendername>_SpoutRing".
+// A spoutDX receiver copies from the last texture written without
+// waiting for the access mutex, while the sender writes to the next one.
+// Other receivers use the sender shared texture as before.
+//
+// Each ring texture has a keyed mutex so that the sender cannot write
+// to a texture while a receiver is still copying from it. With 3 or more
+// textures, the sender writes to one that receivers are not reading.
+//
+// Applies to SendTexture. Must be set before the sender is created.
+// Zero (default) or one disables the ring. 2 is increased to 3.
+void spoutDX::SetTextureRing(int nTextures)
+{
+	if (nTextures < 2) nTextures = 0;
+	else if (nTextures < 3) nTextures = 3;
+	if (nTextures > 4) nTextures = 4;
+	m_nRing = nTextures;
+}
 
-	m_Index = (m_Index + 1) % 2;
-	m_NextIndex = (m_Index + 1) % 2;
+//---------------------------------------------------------
+// Function: GetTextureRing
+// Get the number of shared textures for a sender texture ring
+int spoutDX::GetTextureRing()
+{
+	return m_nRing;
+}
 
-	// Copy from the texture to the first staging texture
-	m_pImmediateContext->CopyResource(m_pStaging[m_Index], pTexture);
+//---------------------------------------------------------
+// Function: SetSendPolicy
+// Set the policy for receivers that lag behind the sender.
+//
+//   SPOUT_SEND_DEFAULT - wait for access to the sender texture
+//   up to the access timeout (SetAccessTimeout). The frame is not
+//   sent if a receiver still has access.
+//
+//   SPOUT_SEND_LATEST - do not wait for access. The frame is dropped
+//   if a receiver has access, and receivers skip to the latest frame.
+//
+//   SPOUT_SEND_QUEUE - write to a ring of "queue" textures (3-4, see SetTextureRing).
+//   spoutDX receivers read the ring frames in order. The sender waits only
+//   if a registered receiver has not read the frame that will be overwritten.
+//
+//   SPOUT_SEND_BLOCK - wait until all registered receivers
+//   have acknowledged the last frame before sending the next.
+//
+//   Receivers register with SetFrameAck. If no receiver has registered,
+//   the sender does not wait. "dwTimeout" limits the wait in msec
+//   (default 1000) so that a receiver which stops receiving does not
+//   hold the sender. INFINITE waits for every acknowledgement.
+//   A frame overwritten before it has been acknowledged is counted (GetSendOverrun).
+//   Frame counting must be enabled for acknowledgement.
+//
+//   Applies to SendTexture. Must be set before the sender is created.
+void spoutDX::SetSendPolicy(SpoutSendPolicy policy, int queue, DWORD dwTimeout)
+{
+	m_SendPolicy = policy;
+	m_dwSendTimeout = dwTimeout;
+	if (policy == SPOUT_SEND_QUEUE)
+		SetTextureRing(queue < 3 ? 3 : queue);
+}
 
-	// Map and read from the second while the first is occupied
-	ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, false, false, false);
+//---------------------------------------------------------
+// Function: GetSendPolicy
+// Get the send policy
+SpoutSendPolicy spoutDX::GetSendPolicy()
+{
+	return m_SendPolicy;
+}
 
-	return true;
+//---------------------------------------------------------
+// Function: GetSendDropped
+// Frames not sent because a receiver had access to the sender texture
+LONG64 spoutDX::GetSendDropped()
+{
+	return m_SendDropped;
+}
 
+//---------------------------------------------------------
+// Function: GetSendOverrun
+// Frames overwritten before all registered receivers had acknowledged them.
+//
+//   Counted if the send policy timeout elapses (SetSendPolicy).
+LONG64 spoutDX::GetSendOverrun()
+{
+	return m_SendOverrun;
 }
 
+//---------------------------------------------------------
+// Function: SetPreview
+// Publish a reduced size preview texture with the sender.
+//
+// The sender texture is reduced by a mip level, the first that is
+// no wider than maxWidth, and copied to a separate shared texture.
+// The texture handle and size are saved in shared memory
+// "<sendername>_SpoutPreview". Receivers that show thumbnails
+// can copy the preview (ReceivePreview) instead of the full texture.
+// There is no access mutex for the preview texture.
+//
+// Applies to SendTexture and SendImage. Must be set before the sender is created.
+// Zero (default) disables the preview.
+void spoutDX::SetPreview(unsigned int maxWidth)
+{
+	m_PreviewMaxWidth = maxWidth;
+}
 
 //---------------------------------------------------------
-// Function: SelectSender
-// Open sender selection dialog
-void spoutDX::SelectSender()
+// Function: GetPreview
+// Get the maximum preview width
+unsigned int spoutDX::GetPreview()
 {
-	SelectSenderPanel();
+	return m_PreviewMaxWidth;
 }
 
 //---------------------------------------------------------
-// Function: IsUpdated
-// Query whether the sender has changed.
-//
-//   Must be checked at every cycle before receiving data. 
-//
-//   If this is not done, the receiving functions fail.
-bool spoutDX::IsUpdated()
+// Function: SetYUVFormat
+// Publish an NV12 or P010 copy of the sender texture.
+//
+// The sender texture is converted on the GPU by the D3D11 video processor
+// (BT.709, 16-235 range) to a separate shared texture of the same size,
+// rounded down to even width and height. The texture handle and size
+// are saved in shared memory "<sendername>_SpoutYUV" as for the preview.
+// Receivers that encode or process YUV can copy it (ReceiveYUVTexture)
+// or read back planar pixels (ReceiveYUVImage) with half or less
+// of the bandwidth of the RGBA texture.
+//
+// The sender shared texture is unchanged. Receivers that do not use
+// the YUV texture, including OpenGL receivers, are not affected.
+//
+//   DXGI_FORMAT_NV12 - 8 bit Y plane, interleaved UV at half size
+//   DXGI_FORMAT_P010 - as NV12 with 16 bit samples (10 bit data)
+//   DXGI_FORMAT_UNKNOWN (default) - disable
+//
+// Applies to SendTexture and SendImage. Must be set before the sender is created.
+void spoutDX::SetYUVFormat(DXGI_FORMAT format)
 {
-	bool bRet = m_bUpdated;
-	m_bUpdated = false; // Reset the update flag before return
-	return bRet;
+	if (format != DXGI_FORMAT_NV12 && format != DXGI_FORMAT_P010 && format != DXGI_FORMAT_UNKNOWN) {
+		SpoutLogWarning("spoutDX::SetYUVFormat - format %d not supported", format);
+		return;
+	}
+	m_YUVFormat = format;
 }
 
+//---------------------------------------------------------
+// Function: GetYUVFormat
+// Get the sender YUV format
+DXGI_FORMAT spoutDX::GetYUVFormat()
+{
+	return m_YUVFormat;
+}
 
 //---------------------------------------------------------
-// Function: IsConnected
-// Query sender connection.
-//
-//   If the sender closes, receiving functions return false,  
-//   but connection can be tested at any time.
-bool spoutDX::IsConnected()
+// Function: SetSharedImages
+// Convert pixels once for all receivers of the same image format.
+//
+// Receivers that read pixels each convert the sender texture to the
+// format of their buffer. With this option, a receiver that enables
+// SetReceiveSharedImage requests its format and size in shared memory
+// "<sendername>_SpoutImages". The sender reads back each frame once and
+// converts it once for each requested format, up to SPOUT_SHARED_IMAGES.
+// The receivers then copy the pixels without readback or conversion.
+// The cost grows with the number of different formats requested,
+// not the number of receivers. There is no cost if none are requested.
+// The pixels are one frame behind, as for receivers that read back.
+//
+// Applies to SendTexture and SendImage, but not to a deferred or
+// asynchronous send. Must be set before the sender is created.
+void spoutDX::SetSharedImages(bool bShared)
 {
-	return m_bConnected;
+	m_bSharedImages = bShared;
 }
 
 //---------------------------------------------------------
-// Function: IsFrameNew
-// Query received frame status
-//
-//   The receiving texture or pixel buffer is refreshed if the sender has produced a new frame  
-//   This can be queried to process texture data only for new frames
-bool spoutDX::IsFrameNew()
+// Function: GetSharedImages
+// Shared image conversion status
+bool spoutDX::GetSharedImages()
 {
-	return frame.IsFrameNew();
+	return m_bSharedImages;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderTexture()
-// Received class texture
-//   Used together with ReceiveTexture()
-//   Can also be called after receiving to an application texture
-//   with ReceiveTexture(ID3D11Texture2D** ppTexture)
-//
-ID3D11Texture2D* spoutDX::GetSenderTexture()
+// Function: AddAtlasSender
+// Publish a region of the sender texture as a separate sender.
+//
+// An application that renders many outputs into one texture
+// can share it once and publish each output as a sub-sender.
+// The sub-sender is registered with the atlas texture handle
+// and the region size, and the region is saved in shared memory
+// "<sendername>_SpoutAtlas". A spoutDX receiver of the sub-sender
+// copies only the region, and uses the access mutex and frame
+// count of the atlas sender. So there is one copy and one frame
+// update for the atlas each frame, however many sub-senders there are.
+//
+// The region must be within the sender texture. Sub-senders are
+// registered when the sender is created, or at once if it exists,
+// and are updated if the sender texture changes size.
+// A sub-sender for a region outside the new size is released
+// until the size allows it again. Up to SPOUT_ATLAS_SENDERS
+// sub-senders can be added. To move a region, remove and add it again.
+//
+// Receivers of earlier versions, and OpenGL receivers,
+// cannot receive from a sub-sender.
+bool spoutDX::AddAtlasSender(const char* sendername,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height)
 {
-	if (!m_bConnected)
-		return nullptr;
+	if (!sendername || !*sendername || width == 0 || height == 0)
+		return false;
 
-	if (!m_pTexture) {
+	if (m_nAtlas >= SPOUT_ATLAS_SENDERS) {
+		SpoutLogWarning("spoutDX::AddAtlasSender - maximum of %d sub-senders", SPOUT_ATLAS_SENDERS);
+		return false;
+	}
 
-		// Create the class texture
-		if (!CheckTexture(GetSenderWidth(), GetSenderHeight(), GetSenderFormat()))
-			return nullptr;
-		
-		if (!m_pTexture)
-			return nullptr;
+	if (strcmp(sendername, m_SenderName) == 0) {
+		SpoutLogWarning("spoutDX::AddAtlasSender - [%s] is the atlas sender name", sendername);
+		return false;
+	}
 
-		// Copy the shared texture to it
-		if (frame.CheckTextureAccess(m_pSharedTexture)) {
-			m_pImmediateContext->CopyResource(m_pTexture, m_pSharedTexture);
-			m_pImmediateContext->Flush();
+	int index = -1;
+	for (int i = 0; i < SPOUT_ATLAS_SENDERS; i++) {
+		if (strcmp(m_AtlasSender[i].name, sendername) == 0) {
+			SpoutLogWarning("spoutDX::AddAtlasSender - [%s] already added", sendername);
+			return false;
 		}
-		frame.AllowTextureAccess(m_pSharedTexture);
+		if (index < 0 && !m_AtlasSender[i].name[0])
+			index = i;
+	}
 
+	// The name must not be used by another sender
+	if (sendernames.FindSenderName(sendername)) {
+		SpoutLogWarning("spoutDX::AddAtlasSender - sender [%s] already exists", sendername);
+		return false;
 	}
-	return m_pTexture;
+
+	SpoutAtlasSender& atlas = m_AtlasSender[index];
+	strcpy_s(atlas.name, 256, sendername);
+	atlas.region.left   = xoffset;
+	atlas.region.right  = xoffset+width;
+	atlas.region.top    = yoffset;
+	atlas.region.bottom = yoffset+height;
+	atlas.region.front  = 0;
+	atlas.region.back   = 1;
+	atlas.bCreated = false;
+	m_nAtlas++;
+
+	// Register now if the sender exists
+	if (m_bSpoutInitialized)
+		CreateAtlasSender(index);
+
+	return true;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderHandle
-// Received sender share handle
-HANDLE spoutDX::GetSenderHandle()
+// Function: RemoveAtlasSender
+// Remove a sub-sender of the sender texture
+bool spoutDX::RemoveAtlasSender(const char* sendername)
 {
-	return m_dxShareHandle;
+	if (!sendername || !*sendername)
+		return false;
+
+	for (int i = 0; i < SPOUT_ATLAS_SENDERS; i++) {
+		if (strcmp(m_AtlasSender[i].name, sendername) == 0) {
+			// Free the slot for another sub-sender
+			ReleaseAtlasSender(i);
+			ZeroMemory(&m_AtlasSender[i], sizeof(SpoutAtlasSender));
+			m_nAtlas--;
+			return true;
+		}
+	}
+
+	return false;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderFormat
-// Get sender DirectX texture format
-DXGI_FORMAT spoutDX::GetSenderFormat()
+// Function: GetAtlasSenderCount
+// Number of sub-senders of the sender texture
+int spoutDX::GetAtlasSenderCount()
 {
-	return (DXGI_FORMAT)m_dwFormat;
+	return m_nAtlas;
 }
 
-
 //---------------------------------------------------------
-// Function: GetSenderName
-// Get sender name
-const char * spoutDX::GetSenderName()
+// Function: SetDeferredSend
+// Record SendTexture in a deferred context for SubmitSend.
+//
+// The immediate context can only be used by one thread. An application
+// that renders on worker threads can call SendTexture on a worker thread
+// so that the copy to the sender shared texture is recorded in a deferred
+// context of the spoutDX device. The owner thread of the immediate context
+// then calls SubmitSend to execute it within the sender mutex lock and
+// signal the new frame. Only the last send recorded before SubmitSend is
+// executed, and the texture must not be changed until it has been submitted.
+//
+// The sender is created or updated by SubmitSend, so the first frame and
+// the frame after a size change are not sent. Use PrepareSender on the
+// owner thread to create the sender before the first frame.
+//
+// Applies to SendTexture of a whole texture. Ring, preview and YUV
+// textures are not written and GPU timing is not recorded.
+// Other functions must be called on the owner thread.
+// The device must not be created with D3D11_CREATE_DEVICE_SINGLETHREADED.
+void spoutDX::SetDeferredSend(bool bDeferred)
 {
-	return m_SenderName;
+	if (!bDeferred)
+		ReleaseDeferred(true);
+	m_bDeferredSend = bDeferred;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderWidth
-// Get sender width
-unsigned int spoutDX::GetSenderWidth()
+// Function: GetDeferredSend
+// Deferred send mode
+bool spoutDX::GetDeferredSend()
 {
-	return m_Width;
+	return m_bDeferredSend;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderHeight
-// Get sender height
-unsigned int spoutDX::GetSenderHeight()
+// Function: SetAsyncSend
+// Copy to the sender texture on a Spout thread after SendTexture returns.
+//
+// SendTexture copies the texture to one of SPOUT_ASYNC_TEXTURES snapshot
+// textures and returns without waiting for receivers. A Spout thread waits
+// for access to the sender shared texture, copies the last snapshot to it,
+// flushes and signals the new frame. If a receiver holds the access mutex,
+// the thread waits instead of the render loop, and snapshots that arrive
+// meanwhile replace each other so that only the latest frame is sent.
+//
+// The immediate context is then used by two threads, so multithread
+// protection is set for the device (ID3D11Multithread). This applies
+// to all use of the device by the application.
+//
+// Applies to SendTexture of a whole texture. Ring and preview textures
+// are written by SendTexture as usual. YUV textures are not written
+// and GPU timing is not recorded for the thread copy.
+void spoutDX::SetAsyncSend(bool bAsync)
 {
-	return m_Height;
+	if (!bAsync)
+		StopAsyncSend();
+	m_bAsyncSend = bAsync;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderFps
-// Get sender frame rate
-double spoutDX::GetSenderFps()
+// Function: GetAsyncSend
+// Asynchronous send mode
+bool spoutDX::GetAsyncSend()
 {
-	return frame.GetSenderFps();
+	return m_bAsyncSend;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderFrame
-// Get sender frame number
-long spoutDX::GetSenderFrame()
+// Function: SetSendSlices
+// Copy and publish the sender texture in horizontal slices.
+//
+// For very low latency receivers such as LED processors. SendTexture
+// copies the texture to the sender texture in slices from the top and
+// publishes each slice as soon as it is copied, so that a receiver
+// (ReceiveTextureSlice) can copy the first slices while the rest are
+// copied. An application that renders in slices can send each one as
+// it is rendered with SendTextureSlice.
+//
+// 0 or 1 sends whole frames, otherwise 2 to SPOUT_MAX_SLICES (16).
+// Typically 4 to 8. Each slice signals the shared fence and flushes,
+// so shared fence synchronisation must be enabled (frame.EnableFenceSync)
+// by the sender and by receivers. Whole frames are sent without it.
+// Receivers of whole frames are not affected.
+void spoutDX::SetSendSlices(unsigned int nSlices)
 {
-	return frame.GetSenderFrame();
+	if (nSlices < 2)
+		nSlices = 0;
+	if (nSlices > SPOUT_MAX_SLICES)
+		nSlices = SPOUT_MAX_SLICES;
+	if (nSlices > 0 && !frame.IsFenceSyncEnabled())
+		SpoutLogWarning("spoutDX::SetSendSlices - fence sync is not enabled, whole frames are sent");
+	// Receivers return to whole frames
+	if (nSlices == 0)
+		frame.CloseFrameSlices();
+	m_nSendSlices = nSlices;
 }
 
+//---------------------------------------------------------
+// Function: GetSendSlices
+// Number of slices of each frame sent
+unsigned int spoutDX::GetSendSlices()
+{
+	return m_nSendSlices;
+}
 
 //---------------------------------------------------------
-// COMMON
+// Function: SubmitSend
+// Submit the last send recorded by SendTexture on another thread.
 //
+//   Call on the owner thread of the immediate context.
+//   Returns true if a send was submitted.
+bool spoutDX::SubmitSend()
+{
+	if (!m_bDeferredSend || !m_pImmediateContext)
+		return false;
 
-//
-// Group: Frame counting
-//
+	AcquireSRWLockExclusive(&m_DeferredLock);
+
+	// Create or update the sender for the texture of the last send
+	if (m_DeferredWidth > 0 && m_DeferredHeight > 0) {
+		CheckSender(m_DeferredWidth, m_DeferredHeight, m_dwDeferredFormat, m_DeferredArraySize);
+		m_DeferredWidth = 0;
+		m_DeferredHeight = 0;
+	}
+
+	// Take the command list for execution
+	ID3D11CommandList* pCommandList = m_pCommandList;
+	m_pCommandList = nullptr;
+	ID3D11Texture2D* pSharedTexture = m_pSharedTexture;
+	if (pSharedTexture)
+		pSharedTexture->AddRef();
+
+	ReleaseSRWLockExclusive(&m_DeferredLock);
+
+	if (!pCommandList || !pSharedTexture) {
+		if (pCommandList) pCommandList->Release();
+		if (pSharedTexture) pSharedTexture->Release();
+		return false;
+	}
+
+	spoutTimerScope scope(&timer, "SubmitSend");
+
+	// Execute the copy within the sender mutex lock as for SendTexture
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+	if (frame.CheckTextureAccess(pSharedTexture)) {
+		m_pImmediateContext->ExecuteCommandList(pCommandList, FALSE);
+		SignalSend();
+		frame.AllowTextureAccess(pSharedTexture);
+	}
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
+	pCommandList->Release();
+	pSharedTexture->Release();
+
+	return true;
+}
 
 //---------------------------------------------------------
-// Function: HoldFps
-// Frame rate control
-//    Desired frames per second
-void spoutDX::HoldFps(int fps)
+// Function: BeginSendBatch
+// Begin a batch of sends on this thread.
+//
+// An application with a number of senders otherwise flushes the
+// command queue for each sender every frame. Between BeginSendBatch
+// and EndSendBatch, SendTexture, SendImage, EndFrame and SubmitSend
+// of all senders on the thread copy to the sender textures and release
+// the sender mutex without a flush. EndSendBatch then flushes once for
+// each device and signals the new frame of every sender sent.
+//
+// Receivers do not find the new frames until EndSendBatch,
+// so call it as soon as the senders of the frame have been sent.
+// A sender with a keyed mutex texture is not accessible to
+// receivers until the flush.
+void spoutDX::BeginSendBatch()
 {
-	frame.HoldFps(fps);
+	t_bSendBatch = true;
+	t_SendBatch.clear();
 }
 
-// Function: DisableFrameCount
-// Disable frame counting specifically for this application
-void spoutDX::DisableFrameCount()
+//---------------------------------------------------------
+// Function: EndSendBatch
+// Flush once for the batch and signal the new frames.
+//
+//   Returns the number of senders signalled.
+int spoutDX::EndSendBatch()
 {
-	frame.DisableFrameCount();
+	t_bSendBatch = false;
+
+	// One flush for each device context of the batch
+	std::vector<ID3D11DeviceContext*> contexts;
+	for (size_t i = 0; i < t_SendBatch.size(); i++) {
+		ID3D11DeviceContext* pContext = t_SendBatch[i]->m_pImmediateContext;
+		if (pContext && std::find(contexts.begin(), contexts.end(), pContext) == contexts.end()) {
+			pContext->Flush();
+			contexts.push_back(pContext);
+		}
+	}
+
+	// Then the frame count of each sender
+	for (size_t i = 0; i < t_SendBatch.size(); i++) {
+		t_SendBatch[i]->frame.SetNewFrame();
+		SpoutTrace(SPOUT_TRACE_FLUSH, t_SendBatch[i]->m_SenderName, t_SendBatch[i]->frame.GetSenderFrame64());
+	}
+
+	const int nSenders = (int)t_SendBatch.size();
+	t_SendBatch.clear();
+
+	return nSenders;
 }
 
 //---------------------------------------------------------
-// Function: IsFrameCountEnabled
-// Return frame count status
-bool spoutDX::IsFrameCountEnabled()
-{
-	return frame.IsFrameCountEnabled();
-}
-
-// -----------------------------------------------
-// Function: SetFrameSync
-// Signal sync event.
-//   Create a named sync event and set for test
-void spoutDX::SetFrameSync(const char* SenderName)
-{
-	if (SenderName && SenderName[0] && m_bSpoutInitialized)
-		frame.SetFrameSync(SenderName);
-}
-
-// -----------------------------------------------
-// Function: WaitFrameSync
-// Wait or test for named sync event.
-// Wait until the sync event is signalled or the timeout elapses.
-// Events are typically created based on the sender name and are
-// effective between a single sender/receiver pair.
-//   - For testing for a signal, use a wait timeout of zero.
-//   - For synchronization, use a timeout greater than the expected delay
-// 
-bool spoutDX::WaitFrameSync(const char *SenderName, DWORD dwTimeout)
+// Function: IsSendBatch
+// Send batch started on this thread
+bool spoutDX::IsSendBatch()
 {
-	if (!SenderName || !SenderName[0] || !m_bSpoutInitialized)
-		return false;
-	return frame.WaitFrameSync(SenderName, dwTimeout);
+	return t_bSendBatch;
 }
 
 
 //---------------------------------------------------------
-// SenderNames
+// RECEIVER
 //
 
 //
-// Group: Sender names
+// Group: Receiver
+//
+// ReceiveTexture and ReceiveImage
+//
+//	- Connect to a sender
+//	- Set class variables for sender name, width and height
+//  - If the sender has changed size, set a flag for the application to update
+//	  the receiving texture or imageif IsUpdated() returns true.
+//  - Copy the sender shared texture to the user texture or image.
 //
 
 //---------------------------------------------------------
-// Function: GetSenderCount
-// Number of senders
-int spoutDX::GetSenderCount()
+// Function: SetReceiverName
+// Specify sender for connection
+//
+//   The application will not connect to any other unless the user selects one
+//   If that sender closes, the application will wait for the nominated sender to open 
+//   If no name is specified, the receiver will connect to the active sender
+void spoutDX::SetReceiverName(const char * SenderName)
 {
-	return sendernames.GetSenderCount();
+	if (SenderName && SenderName[0]) {
+		strcpy_s(m_SenderNameSetup, 256, SenderName);
+		strcpy_s(m_SenderName, 256, SenderName);
+		// Look for the sender on the next receive
+		m_dwSenderCheck = 0;
+		// Update the sender opened by the pre-connect thread
+		if (spoutdx.IsPreopen())
+			spoutdx.SetPreopenSender(SenderName);
+	}
 }
 
 //---------------------------------------------------------
-// Function: GetSender
-// Sender item name in the sender names set
-bool spoutDX::GetSender(int index, char* sendername, int sendernameMaxSize)
+// Function: SetPreconnect
+// Open sender textures on a thread when senders change.
+//
+//   When the sender specified by SetReceiverName, or the active sender,
+//   is created or changes size, the sender texture is opened on a thread
+//   and retained. ReceiveTexture then uses the opened texture without
+//   OpenSharedResource. The thread starts on the next receive.
+void spoutDX::SetPreconnect(bool bPreconnect)
 {
-	return sendernames.GetSender(index, sendername, sendernameMaxSize);
+	m_bPreconnect = bPreconnect;
+	if (!bPreconnect)
+		spoutdx.StopPreopen();
 }
 
 //---------------------------------------------------------
-// Function: GetSenderInfo
-// Sender information
-bool spoutDX::GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat)
+// Function: GetPreconnect
+// Pre-connect status
+bool spoutDX::GetPreconnect()
 {
-	return sendernames.GetSenderInfo(sendername, width, height, dxShareHandle, dwFormat);
+	return m_bPreconnect;
 }
 
 //---------------------------------------------------------
-// Function: GetActiveSender
-// Current active sender name
-bool spoutDX::GetActiveSender(char* Sendername)
+// Function: SetIdleReceive
+// Return without checking the sender until it signals a new frame.
+//
+//    Without a new frame, ReceiveTexture and ReceiveImage still read the
+//    sender information and test the frame count and sender list. For many
+//    receivers of senders that seldom change, this is wasted every cycle.
+//    With idle receive, once connected, the receiving functions first test
+//    the sender frame counter and sender change count without kernel calls,
+//    and return with the last frame if neither has changed. IsFrameNew() is
+//    then false. Senders signal a frame event with every frame, and a
+//    timeout in msec waits for it, so that a receiving thread can block
+//    until there is a new frame instead of polling.
+//
+//    Requires frame counting to be enabled. Senders of earlier versions
+//    are received as usual.
+//
+void spoutDX::SetIdleReceive(bool bIdle, DWORD dwTimeout)
 {
-	return sendernames.GetActiveSender(Sendername);
+	m_bIdleReceive = bIdle;
+	m_dwIdleTimeout = dwTimeout;
+	m_IdleGeneration = sendernames.GetSenderGeneration();
 }
 
 //---------------------------------------------------------
-// Function: SetActiveSender
-// Set sender as active
-bool spoutDX::SetActiveSender(const char* Sendername)
+// Function: GetIdleReceive
+// Idle receive status
+bool spoutDX::GetIdleReceive()
 {
-	return sendernames.SetActiveSender(Sendername);
+	return m_bIdleReceive;
 }
 
 //---------------------------------------------------------
-// Function: GetMaxSenders
-// Get user Maximum senders allowed
-int spoutDX::GetMaxSenders()
+// Function: SetReceiveSharedImage
+// Receive images converted by the sender if it provides them.
+//
+// ReceiveImage requests the format and size of the receiving buffer
+// from a sender that converts images for receivers (SetSharedImages)
+// and copies the converted pixels. Otherwise the sender texture
+// is read back and converted by the receiver as usual.
+// Disabled by default.
+void spoutDX::SetReceiveSharedImage(bool bShared)
 {
-	return(sendernames.GetMaxSenders());
+	m_bReceiveSharedImage = bShared;
+	if (!bShared)
+		ReleaseSharedImages();
 }
 
 //---------------------------------------------------------
-// Function: SetMaxSenders
-// Set user Maximum senders allowed
-void spoutDX::SetMaxSenders(int maxSenders)
+// Function: GetReceiveSharedImage
+// Shared image receive status
+bool spoutDX::GetReceiveSharedImage()
 {
-	sendernames.SetMaxSenders(maxSenders);
+	return m_bReceiveSharedImage;
 }
 
-
-//
-// Adapter functions
-//
-
-//
-// Group: Graphics adapter
-//
-// Return graphics adapter number and names.
-// Get and set adapter index for the DirectX device.
-//
-// Note that both the Sender and Receiver must use the same graphics adapter.
-//
-
-
 //---------------------------------------------------------
-// Function: GetNumAdapters
-// The number of graphics adapters in the system
-int spoutDX::GetNumAdapters()
+// Function: SetFrameCache
+// Share the frames read back by ReceiveImage with other receivers.
+//
+// Each receiver that reads pixels copies the sender texture to staging
+// and reads it back, so the same frame is transferred from the GPU once
+// for every receiver. With this option, the first receiver to read back
+// a frame saves it in shared memory "<sendername>_SpoutFrameCache_.."
+// tagged with the sender frame number. Other receivers with the option
+// copy it from there and convert it to their own buffer format.
+// A receiver that finds another reading the frame waits up to
+// SPOUT_FRAMECACHE_WAIT msec for it, otherwise reads it back itself.
+//
+// Senders of any version and type can be received, but the sender
+// must have frame counting enabled. Applies to ReceiveImage for the
+// whole sender texture. Disabled by default.
+void spoutDX::SetFrameCache(bool bCache)
 {
-	return spoutdx.GetNumAdapters();
+	m_bFrameCache = bCache;
+	if (!bCache)
+		ReleaseFrameCache();
 }
 
 //---------------------------------------------------------
-// Function: GetAdapterName
-// Get adapter item name
-bool spoutDX::GetAdapterName(int index, char *adaptername, int maxchars)
+// Function: GetFrameCache
+// Frame cache status
+bool spoutDX::GetFrameCache()
 {
-	return spoutdx.GetAdapterName(index, adaptername, maxchars);
+	return m_bFrameCache;
 }
 
 //---------------------------------------------------------
-// Function: GetAdapterInfo
-// // Get the current adapter description
-bool spoutDX::GetAdapterInfo(char *adapter, char *display, int maxchars)
+// Function: SetFrameAck
+// Acknowledge each frame received for a sender that waits.
+//
+//   The receiver registers with the sender when it connects and
+//   acknowledges each frame after it has been copied, so that a sender
+//   with the queue or block policy does not overwrite frames that have
+//   not been received (see SetSendPolicy). Set before receiving.
+void spoutDX::SetFrameAck(bool bAck)
 {
-	return spoutdx.GetAdapterInfo(adapter, display, maxchars);
+	m_bFrameAck = bAck;
+	if (!bAck)
+		frame.UnregisterFrameAck();
 }
 
 //---------------------------------------------------------
-// Function: GetAdapter
-// Get adapter index
-int spoutDX::GetAdapter()
+// Function: GetFrameAck
+// Frame acknowledge status
+bool spoutDX::GetFrameAck()
 {
-	return spoutdx.GetAdapter();
+	return m_bFrameAck;
 }
 
 //---------------------------------------------------------
-// Function: SetAdapter
-// Set graphics adapter for output
-bool spoutDX::SetAdapter(int index)
+// Function: ReleaseReceiver
+// Close receiver and release resources ready to connect to another sender
+void spoutDX::ReleaseReceiver()
 {
-	if (spoutdx.SetAdapter(index))
-		return true;
+	if (!m_bSpoutInitialized)
+		return;
 
-	SpoutLogError("spoutDX::SetAdapter(%d) failed", index);
-	spoutdx.SetAdapter(0); // make sure globals are reset to default
+	SpoutLogNotice("ReleaseReceiver(%s)", m_SenderName);
 
-	return false;
-}
+	// Restore the sender name if one was specified by SetReceiverName
+	if (m_SenderNameSetup[0])
+		strcpy_s(m_SenderName, 256, m_SenderNameSetup);
+	else
+		m_SenderName[0] = 0;
 
-//---------------------------------------------------------
-// Function: GetAdapterPointer
-// Get adapter pointer for a given adapter (-1 means current)
-IDXGIAdapter* spoutDX::GetAdapterPointer(int index)
-{
-	return spoutdx.GetAdapterPointer(index);
-}
+	// Wait 4 frames in case the same sender opens again
+	Sleep(67);
 
-//---------------------------------------------------------
-// Function: SetAdapterPointer
-// Set required graphics adapter for creating a device
-void spoutDX::SetAdapterPointer(IDXGIAdapter* pAdapter)
-{
-	spoutdx.SetAdapterPointer(pAdapter);
-}
+	// Adapter bridge if used
+	CloseBridge();
 
-//---------------------------------------------------------
-// Function: GetAdapterAuto
-// Get auto device switching status
-bool spoutDX::GetAdapterAuto()
-{
-	return m_bAdapt;
-}
+	// Sender shared texture pointer
+	if (m_pSharedTexture) m_pSharedTexture->Release();
+	m_pSharedTexture = nullptr;
+	m_dxShareHandle = nullptr;
+
+	// Class receiving texture
+	if (m_pTexture)	m_pTexture->Release();
+	m_pTexture = nullptr;
+
+	// Sender ring texture pointers
+	ReleaseTextureRing();
+
+	// The sender no longer waits for this receiver
+	frame.UnregisterFrameAck();
+
+	// Sender preview texture and receiving copy
+	ReleasePreview();
+
+	// Sender YUV texture and receiving copy
+	ReleaseYUV();
+
+	// Image requested from the sender
+	ReleaseSharedImages();
+
+	// Frames shared with other receivers
+	ReleaseFrameCache();
+
+	// Region of an atlas sender
+	m_bAtlasRegion = false;
+	m_AtlasRegion = {};
+
+	// Slices received by ReceiveTextureSlice
+	m_ReceiveSlices = 0;
+	m_ReceiveSliceFrame = 0;
+	m_ReceiveSliceNext = 0;
+	
+	// Staging textures, compute conversion, video processor and bands for ReceiveImage
+	ReleaseConvert();
+	ReleaseScope();
+	ReleaseVideoProcessor();
+	ReleaseReadbackBands();
+	ReleaseImageView();
+	// Return staging textures to the process pool
+	spoutdx.ReleaseStagingTexture(m_pStaging[0]);
+	spoutdx.ReleaseStagingTexture(m_pStaging[1]);
+	m_pStaging[0] = nullptr;
+	m_pStaging[1] = nullptr;
+	m_bReadPending = false;
+	m_Index = 0;
+	m_NextIndex = 0;
+	m_StagingFrame[0] = 0;
+	m_StagingFrame[1] = 0;
+	m_bStagingView[0] = false;
+	m_bStagingView[1] = false;
+
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+
+	// Close the named access mutex and frame counting semaphore.
+	frame.CloseAccessMutex();
+	frame.CleanupFrameCount();
+
+	// Close shared memory buffer and data channels if used
+	memorybuffer.Close();
+	CloseDataChannels();
+
+	// Zero width and height so that they are reset when a sender is found
+	m_Width = 0;
+	m_Height = 0;
+	
+	// Initialize again when a sender is found
+	m_bSpoutInitialized = false;
+	m_bUpdated = false;
 
-//---------------------------------------------------------
-// Function: SetAdapterAuto
-// Auto switch receiving device to use the same adapter as the sender
-void spoutDX::SetAdapterAuto(bool bAdapt)
-{
-	if (bAdapt && !IsClassDevice()) {
-		SpoutLogWarning("spoutDX::SetAdapterAuto : D3D11 device created outside the class");
-		return;
-	}
-	m_bAdapt = bAdapt;
 }
 
 //---------------------------------------------------------
-// Function: GetSenderAdapter
-// Get adapter index and name for a given sender
+// Function: SetReceiverTexture
+//  Set an application texture for ReceiveTexture() to copy to
 //
-// OpenDX11shareHandle will fail if the share handle has been created 
-// using a different graphics adapter (see spoutDirectX).
+//    ReceiveTexture() copies the sender shared texture directly to the
+//    application texture instead of the class texture. The texture
+//    pointer can be null. If the sender size or format is different,
+//    the texture is released and re-created with the same usage and
+//    bind flags, and the new pointer is returned to the application.
+//    IsUpdated() then returns true so that the application can create
+//    new resource views. The texture is not released by Spout.
 //
-// This function loops though all graphics adapters in the system
-// until OpenDX11shareHandle is successful and the same adapter
-// index as the sender is established. 
+//    GetSenderTexture() returns the application texture.
+//    A null argument restores the class texture.
 //
-// This adapter can then be used by CreateDX11device when the Spout
-// DirectX device is created.
+void spoutDX::SetReceiverTexture(ID3D11Texture2D** ppTexture)
+{
+	m_ppReceiverTexture = ppTexture;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveTexture
+//  Copy the sender DX11 shared texture to a class texture
+//  or to the application texture set by SetReceiverTexture
 //
-int spoutDX::GetSenderAdapter(const char* sendername, char* adaptername, int maxchars)
+bool spoutDX::ReceiveTexture()
 {
-	if (!sendername || !sendername[0])
-		return -1;
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
 
-	int senderadapter = -1;
-	ID3D11Texture2D* pSharedTexture = nullptr;
-	ID3D11Device* pDummyDevice = nullptr;
-	ID3D11DeviceContext* pContext = nullptr;
-	IDXGIAdapter* pAdapter = nullptr;
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
 
-	// Get the current device adapter pointer (could be null default)
-	IDXGIAdapter* pCurrentAdapter = spoutdx.GetAdapterPointer();
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
 
-	SpoutLogNotice("spoutDX::GetSenderAdapter - testing for sender adapter (%s)", sendername);
+		// Was the shared texture pointer retrieved ?
+		if (!m_pSharedTexture) {
+			return false;
+		}
 
-	SharedTextureInfo info={};
-	if (sendernames.getSharedInfo(sendername, &info)) {
-		const int nAdapters = spoutdx.GetNumAdapters();
-		for (int i = 0; i < nAdapters; i++) {
-			pAdapter = spoutdx.GetAdapterPointer(i);
-			if (pAdapter) {
-				SpoutLogNotice("   testing adapter %d", i);
-				// Set the adapter pointer for CreateDX11device to use temporarily
-				spoutdx.SetAdapterPointer(pAdapter);
-				// Create a dummy device using this adapter
-				pDummyDevice = spoutdx.CreateDX11device();
-				if (pDummyDevice) {
-					// Try to open the share handle with the device created from the adapter
-					if (spoutdx.OpenDX11shareHandle(pDummyDevice, &pSharedTexture, LongToHandle((long)info.shareHandle))) {
-						// break as soon as it succeeds
-						SpoutLogNotice("    found sender adapter %d (0x%.7X)", i, PtrToUint(pAdapter));
-						senderadapter = i;
-						// Return the adapter name
-						if(adaptername)
-							spoutdx.GetAdapterName(i, adaptername, maxchars);
-						pDummyDevice->GetImmediateContext(&pContext);
-						if (pContext) pContext->Flush();
-						pDummyDevice->Release();
-						pAdapter->Release();
-						break;
-					}
-					pDummyDevice->GetImmediateContext(&pContext);
-					if (pContext) pContext->Flush();
-					pDummyDevice->Release();
-				}
-				pAdapter->Release();
+		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
+		if (m_bUpdated) {
+			m_bUpdated = false; // Reset for ReceiveSenderData
+			if (m_ppReceiverTexture) {
+				// Update the application texture.
+				// If it is re-created, the application detects 
+				// the change with IsUpdated() after the copy.
+				if (!CheckReceiverTexture(m_Width, m_Height, m_dwFormat, m_bUpdated))
+					return false;
+			}
+			else {
+				// Update the receiving class texture.
+				if (!CheckTexture(m_Width, m_Height, m_dwFormat))
+					return false;
 			}
 		}
-	}
+		ID3D11Texture2D* pTexture = m_ppReceiverTexture ? *m_ppReceiverTexture : m_pTexture;
+		if (!pTexture)
+			return false;
 
-	// Set the SpoutDirectX class adapter pointer back to what it was
-	spoutdx.SetAdapterPointer(pCurrentAdapter);
+		// The receiving texture is created on the first update above
+		// ready for copy from the sender's shared texture.
 
-	// Return the sender adapter index
-	return senderadapter;
+		//
+		// Found a sender
+		//
+		// Copy from the last texture written if the sender uses a texture ring
+		if (ReadTextureRing(pTexture)) {
+			m_bConnected = true;
+			return true;
+		}
+		// Check if the sender has produced a new frame.
+		// If not, the receiving texture is unchanged and
+		// there is no wait for access to the shared texture.
+		if (frame.GetNewFrame()) {
+			if (frame.CheckTextureAccess(m_pSharedTexture)) {
+				// Copy from the sender's shared texture to the receiving texture.
+				CopySenderTexture(pTexture);
+				// Testing has shown that Flush is needed here for the texture
+				// to be immediately available for subsequent copy.
+				// May be removed if the texture is not immediately copied.
+				// Test for the individual application.
+				m_pImmediateContext->Flush();
+				// Allow access to the shared texture
+				frame.AllowTextureAccess(m_pSharedTexture);
+				// The sender can write the next frame (SetFrameAck)
+				if (m_bFrameAck)
+					frame.AckFrame();
+				// Histograms and waveform of the received texture (SetReceiveAnalysis)
+				if (m_bReceiveAnalysis)
+					AnalyzeTexture(pTexture);
+			}
+			else {
+				// Access timed out, receive the frame next time
+				frame.ResetNewFrame();
+			}
+		}
+		m_bConnected = true;
 
-}
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
 
-//
-// Group: Graphics performance
-//
-// Windows Graphics performance preferences.
-//
-// To be effective, performance preference requires the system to have multiple graphics
-// processors which provide a choice between "Power saving" and "High perfformance". 
-// Typically this will be laptop systems with integrated and discrete graphics.
-// Desktop systems with multiple discrete graphics cards do not provide that choice, 
-// even though Windows still allows applications to be set for desired preference.
-//
-// Windows preferences take priority over any settings made by driver
-// programs such as the NVIDIA Control Panel or AMD Control Center for that application.
-// If there is no Windows preference for an application, the graphics driver <settings
-// at https://www.nvidia.com/content/Control-Panel-Help/vLatest/en-us/mergedProjects/nv3d/Setting_the_Preferred_Graphics_Processor.htm> take effect.
-//
-// Performance prefrence settings are available from Windows 10
-// April 2018 update "Redstone 4" (Version 1803, build 17134) and later.
-// Windows 10 SDK required included in Visual Studio 2017 ver.15.7 
-//
-#ifdef NTDDI_WIN10_RS4
+	// ReceiveTexture fails if there is no sender or the connected sender closed.
+	return m_bConnected;
+
+}
 
 //---------------------------------------------------------
-// Function: GetPerformancePreference
-// Get the Windows graphics preference for an application
-//
-//	-1 - Not registered
-//
-//	 0 - DXGI_GPU_PREFERENCE_UNSPECIFIED
-//
-//	 1 - DXGI_GPU_PREFERENCE_MINIMUM_POWER
-//
-//	 2 - DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE
+// Function: ReceiveTexture
+//  Copy the sender DX11 shared texture
 //
-// If no path is specified, use the current application path
+//    The receiving texture must be the same format
+//    and must be re-allocated if IsUpdated() returns true
 //
-int spoutDX::GetPerformancePreference(const char* path)
+bool spoutDX::ReceiveTexture(ID3D11Texture2D** ppTexture)
 {
-	return spoutdx.GetPerformancePreference(path);
+	return ReceiveTexture(ppTexture, 0, 0, 0, 0);
 }
 
 //---------------------------------------------------------
-// Function: SetPerformancePreference
-// Set the Windows graphics preference for an application
-//
-//     -1 - No preference
-//
-//      0 - Default
-//
-//      1 - Power saving
-//
-//      2 - High performance
+// Function: ReceiveTexture
+//  Copy part of the sender DX11 shared texture
 //
-// If no path is specified, use the current application path
+//    The region from xoffset, yoffset (top left) of size width x height
+//    is copied to the top left of the receiving texture.
+//    Zero width or height copies the whole texture.
+//    The receiving texture must be the same format and at least the region size.
+//    The region must be within the sender texture.
 //
-bool spoutDX::SetPerformancePreference(int preference, const char* path)
+bool spoutDX::ReceiveTexture(ID3D11Texture2D** ppTexture,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height)
 {
-	return spoutdx.SetPerformancePreference(preference, path);
+	// No texture
+	if (!ppTexture)
+		return false;
+
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		// Was the shared texture pointer retrieved ?
+		if (!m_pSharedTexture) {
+			return false;
+		}
+
+		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
+		if (m_bUpdated) {
+			// If the sender is new or changed, return to update the receiving texture.
+			// The application detects the change with IsUpdated().
+			return true;
+		}
+
+		// The application receiving texture is created
+		// by the application on the first update above
+		// ready for copy from the sender's shared texture.
+		// Test for it here.
+		ID3D11Texture2D* pTexture = *ppTexture;
+		if (!pTexture) {
+			return false;
+		}
+
+		spoutTimerScope scope(&timer, "ReceiveTexture");
+
+		// Region to copy or the whole texture
+		D3D11_BOX sourceRegion={};
+		const D3D11_BOX* pSourceRegion = nullptr;
+		if (width > 0 && height > 0) {
+			if (!GetSourceRegion(xoffset, yoffset, width, height, sourceRegion))
+				return false;
+			pSourceRegion = &sourceRegion;
+		}
+
+		//
+		// Found a sender
+		//
+		// Copy from the last texture written if the sender uses a texture ring
+		if (ReadTextureRing(pTexture, pSourceRegion)) {
+			m_bConnected = true;
+			return true;
+		}
+		// Check if the sender has produced a new frame.
+		// If not, the receiving texture is unchanged and
+		// there is no wait for access to the shared texture.
+		if (frame.GetNewFrame()) {
+			const LONG64 accessStart = timer.Start();
+			if (frame.CheckTextureAccess(m_pSharedTexture)) {
+				timer.Stop("CheckAccess", accessStart);
+				// Copy from the sender's shared texture to the receiving texture.
+				spoutdx.BeginGPUTime(m_pImmediateContext, "GPUSharedCopy");
+				if (pSourceRegion)
+					m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, 0, 0, m_pSharedTexture, 0, pSourceRegion);
+				else
+					CopySenderTexture(pTexture);
+				spoutdx.EndGPUTime(m_pImmediateContext);
+				// Testing has shown that Flush is needed here for the texture
+				// to be immediately available for subsequent copy.
+				// May be removed if the texture is not immediately copied.
+				// Test for the individual application.
+				m_pImmediateContext->Flush();
+				SpoutTrace(SPOUT_TRACE_RECEIVE_COPY, m_SenderName, frame.GetSenderFrame64());
+				// Allow access to the shared texture
+				frame.AllowTextureAccess(m_pSharedTexture);
+				// The sender can write the next frame (SetFrameAck)
+				if (m_bFrameAck)
+					frame.AckFrame();
+				// Histograms and waveform of the received texture (SetReceiveAnalysis)
+				if (m_bReceiveAnalysis)
+					AnalyzeTexture(pTexture);
+			}
+			else {
+				// Access timed out, receive the frame next time
+				frame.ResetNewFrame();
+			}
+		}
+		m_bConnected = true;
+
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
+
+	// ReceiveTexture fails if there is no sender or the connected sender closed.
+	return m_bConnected;
+
 }
 
+//---------------------------------------------------------
+// Function: ReceiveTextureSlice
+//  Copy the next slice of the sender DX11 shared texture
+//  as soon as the sender has published it (see SetSendSlices)
+//
+//    The slice index is returned. Slices are received in order
+//    from the top and are the rows from slice*height/count to
+//    (slice+1)*height/count, where count is GetReceiveSlices.
+//    The timeout is the time in msec to wait for the slice (0 to return at once).
+//    Requires the shared fence (frame.EnableFenceSync). A sender that
+//    does not send slices is received as a whole frame and slice 0.
+//
+//    SPOUT_RECEIVE_SUCCESS  - a slice was copied to the texture
+//    SPOUT_RECEIVE_NO_FRAME - the next slice has not been sent
+//    SPOUT_RECEIVE_UPDATED  - the sender has changed, update the texture (IsUpdated)
+//    SPOUT_RECEIVE_FAILED   - no sender or the connected sender closed
+//
+SpoutReceiveStatus spoutDX::ReceiveTextureSlice(ID3D11Texture2D** ppTexture, unsigned int &slice, DWORD dwTimeout)
+{
+	return ReceiveTextureSlice(ppTexture, 0, 0, 0, 0, slice, dwTimeout);
+}
 
+//---------------------------------------------------------
+// Function: ReceiveTextureSlice
+//  Copy the part of the next slice within a region of the sender texture
 //
-// https://learn.microsoft.com/en-us/windows/win32/api/dxgi1_6/nf-dxgi1_6-idxgifactory6-enumadapterbygpupreference
-//
-// When DXGI_GPU_PREFERENCE_UNSPECIFIED is specified for the GpuPreference parameter,
-// this method is equivalent to calling IDXGIFactory1::EnumAdapters1.
-//
-// When DXGI_GPU_PREFERENCE_MINIMUM_POWER is specified for the GpuPreference parameter,
-// the order of preference for the adapter returned in ppvAdapter will be:
-// 1. iGPUs (integrated GPUs)
-// 2. dGPUs (discrete GPUs)
-// 3. xGPUs (external GPUs)
-//
-// When DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE is specified for the GpuPreference parameter,
-// the order of preference for the adapter returned in ppvAdapter will be:
-// 1. xGPUs (external GPUs)
-// 2. dGPUs (discrete GPUs)
-// 3. iGPUs (integrated GPUs)
+//    The region from xoffset, yoffset (top left) of size width x height
+//    is received to the top left of the receiving texture, as for ReceiveTexture.
+//    Zero width or height receives the whole texture.
+//    Slices outside the region are received without a copy.
 //
+SpoutReceiveStatus spoutDX::ReceiveTextureSlice(ID3D11Texture2D** ppTexture,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height,
+	unsigned int &slice, DWORD dwTimeout)
+{
+	slice = 0;
+	if (!ppTexture)
+		return SPOUT_RECEIVE_FAILED;
+
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return SPOUT_RECEIVE_UPDATED;
+
+	// Try to receive texture details from a sender
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return SPOUT_RECEIVE_FAILED;
+	}
+	m_bConnected = true;
+
+	if (m_bUpdated) {
+		// Start again from the first slice of a frame
+		m_ReceiveSliceFrame = 0;
+		m_ReceiveSliceNext = 0;
+		return SPOUT_RECEIVE_UPDATED;
+	}
+
+	ID3D11Texture2D* pTexture = *ppTexture;
+	if (!pTexture || !m_pSharedTexture)
+		return SPOUT_RECEIVE_FAILED;
+
+	// Region to copy or the whole texture
+	if (width == 0 || height == 0) {
+		xoffset = 0;
+		yoffset = 0;
+		width = m_Width;
+		height = m_Height;
+	}
+	D3D11_BOX region={};
+	if (!GetSourceRegion(xoffset, yoffset, width, height, region))
+		return SPOUT_RECEIVE_FAILED;
+
+	// A sender that does not send slices is received as one slice
+	m_ReceiveSlices = frame.OpenFrameSlices(m_SenderName) ? frame.GetFrameSlices() : 0;
+	if (m_ReceiveSlices < 2) {
+		m_ReceiveSlices = 1;
+		m_ReceiveSliceNext = 0;
+		if (!frame.GetNewFrame())
+			return SPOUT_RECEIVE_NO_FRAME;
+		if (!frame.CheckTextureAccess(m_pSharedTexture)) {
+			// Access timed out, receive the frame next time
+			frame.ResetNewFrame();
+			return SPOUT_RECEIVE_NO_FRAME;
+		}
+		m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, 0, 0, m_pSharedTexture, 0, &region);
+		m_pImmediateContext->Flush();
+		frame.AllowTextureAccess(m_pSharedTexture);
+		if (m_bFrameAck)
+			frame.AckFrame();
+		return SPOUT_RECEIVE_SUCCESS;
+	}
+
+	// The number of slices has changed
+	if (m_ReceiveSliceNext >= m_ReceiveSlices)
+		m_ReceiveSliceNext = 0;
+
+	// The first slice of a new frame, or the next slice of this frame
+	// or a later one if the receiver is behind the sender.
+	// A GPU wait for the slice copy is queued before the copy below.
+	const unsigned int next = m_ReceiveSliceNext;
+	const LONG64 minframe = (next == 0) ? m_ReceiveSliceFrame + 1 : m_ReceiveSliceFrame;
+	// All slices of the last frame have been received. The sender
+	// frame count is acknowledged while waiting for the next frame
+	// because the sender counts the frame after the last slice.
+	if (next == 0 && m_bFrameAck && m_ReceiveSliceFrame > 0)
+		frame.AckFrame(frame.GetSenderFrame64());
+	LONG64 sliceframe = 0;
+	if (!frame.WaitFrameSlice(next, minframe, sliceframe, dwTimeout))
+		return SPOUT_RECEIVE_NO_FRAME;
+	if (next == 0)
+		m_ReceiveSliceFrame = sliceframe;
+	m_ReceiveSliceNext = (next + 1) % m_ReceiveSlices;
+	slice = next;
+
+	// Rows of the slice within the region
+	const D3D11_BOX box = SliceBox(next, m_ReceiveSlices, m_Width, m_Height);
+	D3D11_BOX copy = region;
+	if (box.top > copy.top) copy.top = box.top;
+	if (box.bottom < copy.bottom) copy.bottom = box.bottom;
+	if (copy.top < copy.bottom) {
+		m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, copy.top - region.top, 0, m_pSharedTexture, 0, &copy);
+		m_pImmediateContext->Flush();
+	}
+
+	return SPOUT_RECEIVE_SUCCESS;
+}
 
 //---------------------------------------------------------
-// Function: GetPreferredAdapterName
-//
-// Get the graphics adapter name for a Windows preference.
-// This is the first adapter for the given preference :
-//
-//    DXGI_GPU_PREFERENCE_UNSPECIFIED - (0) Equivalent to EnumAdapters1
-//
-//    DXGI_GPU_PREFERENCE_MINIMUM_POWER - (1) Integrated GPU
-//
-//    DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE - (2) External GPU / Discrete GPU
-//
-bool spoutDX::GetPreferredAdapterName(int preference, char* adaptername, int maxchars)
+// Function: GetReceiveSlices
+// Number of slices of each frame received by ReceiveTextureSlice.
+// 1 if the sender sends whole frames.
+unsigned int spoutDX::GetReceiveSlices()
 {
-	return spoutdx.GetPreferredAdapterName(preference, adaptername, maxchars);
+	return m_ReceiveSlices;
 }
 
 //---------------------------------------------------------
-// Function: SetPreferredAdapter
-//
-// Set graphics adapter index for a Windows preference
+// Function: ReceiveImage
+// Receive from a sender via DX11 staging textures to an rgba or rgb buffer of variable size
+// A new shared texture pointer (m_pSharedTexture) is retrieved if the sender changed
+bool spoutDX::ReceiveImage(unsigned char * pixels,
+	unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+{
+	return ReceiveImage(pixels, width, height, 0, bRGB, bInvert);
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImage
+// Receive to an rgba or rgb buffer with a line pitch
 //
-// Set the adapter index for a performance preference without registering the
-// preference with Windows. This index is used by CreateDX11device when DirectX
-// is intitialized. The function should be called before Spout is initialized.
+//   pitch - bytes of each line including padding, for example
+//           an FFmpeg frame linesize or an aligned buffer (0 for packed pixels)
+//
+//   Lines are written at the pitch directly from the mapped staging texture.
+//   A buffer of different size is resampled by compute shader (SetComputeConversion).
+//   Shared images and the frame cache are used only for packed pixels.
+bool spoutDX::ReceiveImage(unsigned char * pixels,
+	unsigned int width, unsigned int height, unsigned int pitch, bool bRGB, bool bInvert)
+{
+	// Buffer lines with padding
+	const unsigned int rowbytes = width*(bRGB ? 3 : 4);
+	if (pitch > 0 && pitch < rowbytes)
+		return false;
+	const bool bPitch = (pitch > rowbytes);
+	if (!bPitch)
+		pitch = 0;
+
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
+
+	// A staging texture cannot be mapped twice
+	ReleaseImageView();
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		// The sender name, width, height, format, shared texture handle and pointer have been retrieved.
+		if (m_bUpdated) {
+			// A new sender has been found or the one connected has changed.
+			// The staging textures must be the same size and format as the sender
+			// Create new staging textures if it is a different size
+			CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+			// Request the image again for the new sender or size
+			ReleaseSharedImages();
+			ReleaseFrameCache();
+			// The application detects the change with IsUpdated()
+			// and the receiving buffer is updated to match the sender.
+			return true;
+		}
+
+
+		// The receiving pixel buffer is created after the first update
+		// So check here instead of at the beginning
+		if (!pixels)
+			return false;
+
+		// Pixels converted by the sender if it provides them
+		if (m_bReceiveSharedImage && !m_bAtlasRegion && !bPitch
+			&& ReadSharedImage(pixels, width, height, bRGB, bInvert)) {
+			m_bConnected = true;
+			return true;
+		}
+
+		// Staging textures can be region size after ReceiveImageRegion
+		CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+
+		// No staging textures - no copy
+		if (!m_pStaging[0] || !m_pStaging[1])
+			return false;
+
+
+		//
+		// Found a sender
+		//
+		spoutTimerScope scope(&timer, "ReceiveImage");
+
+		// Access the sender shared texture
+		const LONG64 accessStart = timer.Start();
+		bool bCopied = false;
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			timer.Stop("CheckAccess", accessStart);
+			// Check if the sender has produced a new frame.
+			if (frame.GetNewFrame()) {
+				// Read from the sender GPU texture to CPU pixels via two staging textures
+				// One texture - approx 7 - 12 msec at 1920x1080
+				// Two textures - approx 2.5 - 3.5 msec at 1920x1080
+				m_Index = (m_Index + 1) % 2;
+				m_NextIndex = (m_Index + 1) % 2;
+				// Compute shader conversion, or GPU resample for a buffer of different size
+				// (not for the region of an atlas sender)
+				const bool bResample = (m_ResampleMode > 0 && (width != m_Width || height != m_Height));
+				// RGB pixels are packed on the GPU to reduce the data read back
+				// A buffer of different size with padding is resampled on the GPU
+				const bool bSize = (width != m_Width || height != m_Height);
+				// A floating point sender is tone mapped to 8 bit before the staging copy
+				const bool bCompute = m_bComputeConversion || bResample || (bRGB && m_bComputeRGB)
+					|| (bPitch && bSize) || IsToneMapped();
+				// Hardware video processor scaling for a buffer of different size (SetVideoProcessing)
+				const bool bVideo = m_bVideoProcessing && !m_bAtlasRegion
+					&& (width != m_Width || height != m_Height)
+					&& (m_dwFormat == DXGI_FORMAT_B8G8R8A8_UNORM || m_dwFormat == DXGI_FORMAT_R8G8B8A8_UNORM);
+				bool bCached = false;
+				bool bBanded = false;
+				if (bVideo && ProcessVideoData(m_pSharedTexture, width, height, (DXGI_FORMAT)m_dwFormat)) {
+					// The first staging texture has the scaled frame
+					// Read from the second at the buffer size
+					ReadPixelData(m_pVPStaging[m_NextIndex], pixels, width, height, bRGB, bInvert, false, pitch);
+					// The staging textures are not updated
+					frame.ResetDirtyRects();
+				}
+				else if (bCompute && !m_bAtlasRegion
+					&& ConvertPixelData(m_pSharedTexture, width, height, bRGB, bInvert, false)) {
+					// The first staging buffer has the converted pixels
+					// Read from the second with a single copy
+					ReadConvertedData(pixels, width*height*(bRGB ? 3 : 4), height, pitch);
+					// The staging textures are not updated
+					frame.ResetDirtyRects();
+				}
+				else if (m_nReadBands > 1 && !bSize && !m_bAtlasRegion
+					&& ReadBandedPixels(pixels, bRGB, bInvert, pitch)) {
+					// The whole frame has been read without the staging textures
+					frame.ResetDirtyRects();
+					bBanded = true;
+				}
+				else if (m_bFrameCache && !m_bAtlasRegion && !bPitch
+					&& ReceiveFrameCache(pixels, width, height, bRGB, bInvert)) {
+					// Read back by this or another receiver
+					frame.ResetDirtyRects();
+					bCached = true;
+				}
+				else if (!bPitch && frame.ReadDirtyRects(m_SenderName) && frame.GetDirtyFrames() >= 2) {
+					// The sender publishes changed regions and both staging
+					// textures have a whole frame. Copy the regions changed
+					// since the first staging texture was last written.
+					CopyDirtyRects(m_pStaging[m_Index], m_pSharedTexture, 2);
+					// The second staging texture was written on the last frame
+					// and the pixel buffer has the frame before that
+					const RECT* pRects = nullptr;
+					unsigned int nRects = 0;
+					if (pixels == m_pDirtyPixels && bInvert == m_bDirtyInvert
+						&& frame.GetDirtyRects(1, &pRects, nRects)) {
+						ReadDirtyPixels(m_pStaging[m_NextIndex], pixels, pRects, nRects, bInvert);
+					}
+					else {
+						ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, bRGB, bInvert, false);
+					}
+				}
+				else {
+					// Copy from the sender's shared texture to the first staging texture
+					spoutdx.BeginGPUTime(m_pImmediateContext, "GPUStagingCopy");
+					CopySenderTexture(m_pStaging[m_Index]);
+					spoutdx.EndGPUTime(m_pImmediateContext);
+					// Map and read from the second while the first is occupied
+					ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, bRGB, bInvert, false, pitch);
+				}
+				// Changed regions can be read to the same buffer next time
+				// if it is rgba of the sender size
+				const bool bDirtyBuffer = (!bRGB && !bSize && !bPitch && !bCompute && !bCached && !bBanded);
+				m_pDirtyPixels = bDirtyBuffer ? pixels : nullptr;
+				m_bDirtyInvert = bInvert;
+				bCopied = true;
+			}
+			// Allow access to the shared texture
+			frame.AllowTextureAccess(m_pSharedTexture);
+			// The sender can write the next frame (SetFrameAck)
+			if (bCopied && m_bFrameAck)
+				frame.AckFrame();
+		}
+		m_bConnected = true;
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
+
+	// ReceiveImage fails if there is no sender or the connected sender closed.
+	return m_bConnected;
+
+}
+
+//---------------------------------------------------------
+// Function: TryReceiveImage
+// Receive to an rgba or rgb buffer without waiting for the GPU
+//
+//   The sender texture is copied to a staging texture and mapped with
+//   D3D11_MAP_FLAG_DO_NOT_WAIT. If the copy is not complete, the function
+//   returns SPOUT_RECEIVE_PENDING at once and the same frame is read by
+//   the next call. A timing thread can call once per tick and never wait
+//   for the GPU. The frame is read as soon as the copy is complete,
+//   without the frame of latency of ReceiveImage.
+//
+//   SPOUT_RECEIVE_SUCCESS  - a new frame was copied to the pixel buffer
+//   SPOUT_RECEIVE_PENDING  - the copy is not complete, try again
+//   SPOUT_RECEIVE_NO_FRAME - there is no new frame
+//   SPOUT_RECEIVE_UPDATED  - the sender has changed, update the buffer (IsUpdated)
+//   SPOUT_RECEIVE_FAILED   - no sender or the connected sender closed
+//
+//   Do not use together with ReceiveImage, which shares the staging textures.
+SpoutReceiveStatus spoutDX::TryReceiveImage(unsigned char * pixels,
+	unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+{
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return SPOUT_RECEIVE_UPDATED;
+
+	// A staging texture cannot be mapped twice
+	ReleaseImageView();
+
+	// Try to receive texture details from a sender
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return SPOUT_RECEIVE_FAILED;
+	}
+	m_bConnected = true;
+
+	if (m_bUpdated) {
+		// Staging textures for the new sender or size
+		CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+		ReleaseSharedImages();
+		ReleaseFrameCache();
+		return SPOUT_RECEIVE_UPDATED;
+	}
+
+	// The receiving pixel buffer is created after the first update
+	if (!pixels)
+		return SPOUT_RECEIVE_FAILED;
+
+	// Staging textures can be region size after ReceiveImageRegion
+	if (!CheckStagingTextures(m_Width, m_Height, m_dwFormat))
+		return SPOUT_RECEIVE_FAILED;
+
+	if (!m_bReadPending) {
+		// Return if the sender has not signalled a new frame (SetIdleReceive)
+		if (IsReceiverIdle())
+			return SPOUT_RECEIVE_NO_FRAME;
+		// Copy a new frame to the next staging texture
+		bool bCopied = false;
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			if (frame.GetNewFrame()) {
+				m_Index = (m_Index + 1) % 2;
+				m_NextIndex = (m_Index + 1) % 2;
+				CopySenderTexture(m_pStaging[m_Index]);
+				bCopied = true;
+			}
+			frame.AllowTextureAccess(m_pSharedTexture);
+			// The sender can write the next frame (SetFrameAck)
+			if (bCopied && m_bFrameAck)
+				frame.AckFrame();
+		}
+		if (!bCopied)
+			return SPOUT_RECEIVE_NO_FRAME;
+		// Submit the copy now
+		m_pImmediateContext->Flush();
+		// The other staging texture and the pixel buffer no longer
+		// have the frames for changed regions (ReceiveImage)
+		frame.ResetDirtyRects();
+		m_pDirtyPixels = nullptr;
+		m_bReadPending = true;
+	}
+
+	// Map without waiting for the GPU copy
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	const HRESULT hr = m_pImmediateContext->Map(m_pStaging[m_Index], 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+	if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+		return SPOUT_RECEIVE_PENDING;
+	m_bReadPending = false;
+	if (FAILED(hr))
+		return SPOUT_RECEIVE_FAILED;
+
+	CopyPixelData(mapped.pData, mapped.RowPitch, m_Width, m_Height,
+		pixels, width, height, bRGB, bInvert, false);
+	m_pImmediateContext->Unmap(m_pStaging[m_Index], 0);
+
+	return SPOUT_RECEIVE_SUCCESS;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImageYUV
+// Receive an image converted to planar YUV
+//
+//   For encoders that take NV12 or I420 input.
+//   The sender texture is converted by compute shader and only
+//   the YUV data is read back, half the size of RGBA pixels.
+//   Width and height must be even and the buffer width*height*3/2 bytes.
+//   The sender texture is sampled nearest for a different size.
+//   Senders must be 8 bit RGBA or BGRA.
+//   With SetVideoProcessing, NV12 is converted and scaled
+//   by the hardware video processor instead.
+bool spoutDX::ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+	SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert)
+{
+	// Return if flagged for update and there is a sender
+	if (m_bUpdated)
+		return true;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		if (m_bUpdated) {
+			// The application detects the change with IsUpdated()
+			// and the receiving buffer is updated to match the sender.
+			return true;
+		}
+
+		// The receiving pixel buffer is created after the first update
+		if (!pixels || width < 2 || height < 2 || (width & 1) || (height & 1))
+			return false;
+
+		spoutTimerScope scope(&timer, "ReceiveImageYUV");
+
+		// Access the sender shared texture
+		bool bCopied = false;
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			// Check if the sender has produced a new frame.
+			if (frame.GetNewFrame()) {
+				// Convert to the first staging buffer
+				// and read from the second as for ReceiveImage
+				m_Index = (m_Index + 1) % 2;
+				m_NextIndex = (m_Index + 1) % 2;
+				if (!m_bAtlasRegion && m_bVideoProcessing && layout == SPOUT_YUV_NV12
+					&& ProcessVideoData(m_pSharedTexture, width, height, DXGI_FORMAT_NV12, matrix, bFullRange)) {
+					ReadVideoYUV(pixels, width, height, bInvert);
+				}
+				else if (!m_bAtlasRegion
+					&& ConvertYUVData(m_pSharedTexture, width, height, layout, matrix, bFullRange, bInvert)) {
+					ReadConvertedData(pixels, width*height*3/2);
+				}
+				// ReceiveImage cannot use changed regions of the staging textures
+				frame.ResetDirtyRects();
+				m_pDirtyPixels = nullptr;
+				bCopied = true;
+			}
+			// Allow access to the shared texture
+			frame.AllowTextureAccess(m_pSharedTexture);
+			// The sender can write the next frame (SetFrameAck)
+			if (bCopied && m_bFrameAck)
+				frame.AckFrame();
+		}
+		m_bConnected = true;
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImageRegion
+// Receive part of the sender texture to an rgba or rgb buffer
+//
+//    The region from xoffset, yoffset (top left) of size width x height
+//    is copied to staging textures of the region size, so only the
+//    region is read back. The pixel buffer is width x height.
+//    The region must be within the sender texture.
+//
+bool spoutDX::ReceiveImageRegion(unsigned char * pixels,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height,
+	bool bRGB, bool bInvert)
+{
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
+
+	// A staging texture cannot be mapped twice
+	ReleaseImageView();
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		// The application detects a sender change with IsUpdated()
+		if (m_bUpdated)
+			return true;
+
+		if (!pixels)
+			return false;
+
+		D3D11_BOX sourceRegion={};
+		if (!GetSourceRegion(xoffset, yoffset, width, height, sourceRegion))
+			return false;
+
+		// Staging textures of the region size
+		if (!CheckStagingTextures(width, height, m_dwFormat))
+			return false;
+
+		// Access the sender shared texture
+		bool bCopied = false;
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			if (frame.GetNewFrame()) {
+				m_Index = (m_Index + 1) % 2;
+				m_NextIndex = (m_Index + 1) % 2;
+				// Copy the region to the first staging texture
+				m_pImmediateContext->CopySubresourceRegion(m_pStaging[m_Index], 0, 0, 0, 0, m_pSharedTexture, 0, &sourceRegion);
+				// The staging textures no longer have whole frames
+				frame.ResetDirtyRects();
+				// Map and read from the second while the first is occupied
+				ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, bRGB, bInvert, false);
+				bCopied = true;
+			}
+			frame.AllowTextureAccess(m_pSharedTexture);
+			if (bCopied && m_bFrameAck)
+				frame.AckFrame();
+		}
+		m_bConnected = true;
+	}
+	else {
+		ReleaseReceiver();
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+}
+
+//---------------------------------------------------------
+// Function: ReadTexurePixels
+// Read pixels from texture
+bool spoutDX::ReadTexurePixels(ID3D11Texture2D* pTexture, unsigned char* pixels)
+{
+	if (!pTexture || !pixels)
+		return false;
+
+	// Get texture size
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	unsigned int width = desc.Width;
+	unsigned int height = desc.Height;
+
+	// Set global width and height for ReadPixelData
+	if (!m_pStaging[0]) {
+		m_Width = width;
+		m_Height = height;
+	}
+
+	// Update staging textures if necessary
+	CheckStagingTextures(width, height, m_dwFormat);
+	if (!m_pStaging[0] || !m_pStaging[1])
+		return false;
+
+	m_Index = (m_Index + 1) % 2;
+	m_NextIndex = (m_Index + 1) % 2;
+
+	// Copy from the texture to the first staging texture
+	spoutdx.BeginGPUTime(m_pImmediateContext, "GPUStagingCopy");
+	m_pImmediateContext->CopyResource(m_pStaging[m_Index], pTexture);
+	spoutdx.EndGPUTime(m_pImmediateContext);
+	frame.ResetDirtyRects();
+
+	// Map and read from the second while the first is occupied
+	ReadPixelData(m_pStaging[m_NextIndex], pixels, width, height, false, false, false);
+
+	return true;
+
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImageView
+// Receive a view of the mapped staging texture without copy
+//
+//    The sender texture is copied to a staging texture as for ReceiveImage
+//    and the staging texture written on the previous frame is mapped for read.
+//    The view returns a pointer to the mapped data, the line pitch,
+//    width, height, DXGI format and sender frame number.
+//    The data can be used directly, for example by an encoder,
+//    without copy to a pixel buffer.
+//
+//    The data remains valid until ReleaseImageView is called.
+//    ReleaseImageView must be called before the next ReceiveImageView
+//    or other receive functions. Any existing view is released here.
+//
+//    For a new sender or sender size change, IsUpdated() returns true
+//    and there is no image data until the following frame.
+//    The view is of the previous frame received, so there is also
+//    no image data for the first frame received. The view frame number
+//    is the sender frame copied to the mapped staging texture.
+//
+bool spoutDX::ReceiveImageView(SpoutImageView &view)
+{
+	ReleaseImageView();
+	view = {};
+
+	// Try to receive texture details from a sender
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return false;
+	}
+
+	m_bConnected = true;
+
+	// The staging textures must be the same size and format as the sender
+	if (m_bUpdated) {
+		CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+		return false;
+	}
+
+	if (!m_pStaging[0] || !m_pStaging[1])
+		return false;
+
+	// Access the sender shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		// Copy a new frame to the first staging texture
+		bool bCopied = false;
+		if (frame.GetNewFrame()) {
+			m_Index = (m_Index + 1) % 2;
+			m_NextIndex = (m_Index + 1) % 2;
+			spoutdx.BeginGPUTime(m_pImmediateContext, "GPUStagingCopy");
+			CopySenderTexture(m_pStaging[m_Index]);
+			spoutdx.EndGPUTime(m_pImmediateContext);
+			// The frame number of the copy for the view of this staging texture
+			m_StagingFrame[m_Index] = frame.GetSenderFrame64();
+			m_bStagingView[m_Index] = true;
+			bCopied = true;
+		}
+		// Allow access to the shared texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+		// The sender can write the next frame (SetFrameAck)
+		if (bCopied && m_bFrameAck)
+			frame.AckFrame();
+	}
+
+	// The second staging texture has not been written yet
+	if (!m_bStagingView[m_NextIndex])
+		return false;
+
+	// Map the second while the first is occupied
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+	m_pImmediateContext->Flush();
+	const HRESULT hr = m_pImmediateContext->Map(m_pStaging[m_NextIndex], 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::ReceiveImageView - staging texture map failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	m_pMappedStaging = m_pStaging[m_NextIndex];
+	view.data   = static_cast<const unsigned char*>(mappedSubResource.pData);
+	view.pitch  = mappedSubResource.RowPitch;
+	view.width  = m_Width;
+	view.height = m_Height;
+	view.format = m_dwFormat;
+	view.frame  = static_cast<long>(m_StagingFrame[m_NextIndex]);
+
+	return true;
+
+}
+
+//---------------------------------------------------------
+// Function: ReleaseImageView
+// Release the view returned by ReceiveImageView
+void spoutDX::ReleaseImageView()
+{
+	if (m_pMappedStaging && m_pImmediateContext)
+		m_pImmediateContext->Unmap(m_pMappedStaging, 0);
+	m_pMappedStaging = nullptr;
+}
+
+
+//---------------------------------------------------------
+// Function: ReceivePreview
+// Receive the preview texture of a sender (see SetPreview).
+//
+// The preview is copied to a class texture returned by GetPreviewTexture.
+// If the sender does not publish a preview, the full size sender texture
+// is received as for ReceiveTexture() and GetPreviewTexture returns it.
+// The texture and size can change when IsUpdated() returns true.
+bool spoutDX::ReceivePreview()
+{
+	if (m_bUpdated)
+		return true;
+
+	// No preview or the sender has not been found yet
+	if (!m_bPreviewOpen || !m_pPreviewTexture)
+		return ReceiveTexture();
+
+	if (ReceiveSenderData()) {
+
+		// The preview is opened again by CreateReceiver for a new sender
+		if (m_bUpdated) {
+			m_bUpdated = false; // Reset for ReceiveSenderData
+			if (!m_bPreviewOpen)
+				return ReceiveTexture();
+		}
+
+		if (!m_pPreviewReceived) {
+			if (!spoutdx.CreateDX11Texture(m_pd3dDevice, m_PreviewWidth, m_PreviewHeight,
+				(DXGI_FORMAT)m_dwFormat, &m_pPreviewReceived))
+				return false;
+		}
+
+		// Copy only if the sender has written a new preview
+		SharedTexturePreview* pPreview = reinterpret_cast<SharedTexturePreview*>(m_PreviewMemory.Buffer());
+		if (pPreview) {
+			const LONG64 previewframe = InterlockedCompareExchange64(&pPreview->frame, 0, 0);
+			if (previewframe != m_PreviewFrame) {
+				m_pImmediateContext->CopyResource(m_pPreviewReceived, m_pPreviewTexture);
+				m_pImmediateContext->Flush();
+				m_PreviewFrame = previewframe;
+			}
+		}
+		m_bConnected = true;
+	}
+	else {
+		ReleaseReceiver();
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+}
+
+//---------------------------------------------------------
+// Function: GetPreviewTexture
+// Received preview texture, or the full size texture if the sender has no preview
+ID3D11Texture2D* spoutDX::GetPreviewTexture()
+{
+	if (m_bPreviewOpen && m_pPreviewReceived)
+		return m_pPreviewReceived;
+	return m_pTexture;
+}
+
+//---------------------------------------------------------
+// Function: GetPreviewWidth
+// Received preview width
+unsigned int spoutDX::GetPreviewWidth()
+{
+	if (m_bPreviewOpen)
+		return m_PreviewWidth;
+	return m_Width;
+}
+
+//---------------------------------------------------------
+// Function: GetPreviewHeight
+// Received preview height
+unsigned int spoutDX::GetPreviewHeight()
+{
+	if (m_bPreviewOpen)
+		return m_PreviewHeight;
+	return m_Height;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveYUVTexture
+// Receive the YUV texture of a sender (see SetYUVFormat).
+//
+// The texture is copied to a class texture returned by GetYUVTexture.
+// Returns false if the sender does not publish a YUV texture.
+// The texture and size can change when IsUpdated() returns true.
+bool spoutDX::ReceiveYUVTexture()
+{
+	if (m_bUpdated)
+		return true;
+
+	if (!ReceiveSenderData()) {
+		ReleaseReceiver();
+		m_bConnected = false;
+		return false;
+	}
+
+	// The YUV texture is opened again by CreateReceiver for a new sender
+	if (m_bUpdated)
+		m_bUpdated = false; // Reset for ReceiveSenderData
+	m_bConnected = true;
+
+	if (!m_bYUVOpen || !m_pYUVTexture)
+		return false;
+
+	if (!m_pYUVReceived) {
+		D3D11_TEXTURE2D_DESC desc={};
+		m_pYUVTexture->GetDesc(&desc);
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		desc.MiscFlags = 0;
+		if (FAILED(m_pd3dDevice->CreateTexture2D(&desc, nullptr, &m_pYUVReceived))) {
+			SpoutLogWarning("spoutDX::ReceiveYUVTexture - could not create receiving texture");
+			m_pYUVReceived = nullptr;
+			return false;
+		}
+	}
+
+	// Copy only if the sender has written a new frame
+	SharedTexturePreview* pYUV = reinterpret_cast<SharedTexturePreview*>(m_YUVMemory.Buffer());
+	if (pYUV) {
+		const LONG64 yuvframe = InterlockedCompareExchange64(&pYUV->frame, 0, 0);
+		if (yuvframe != m_YUVFrame) {
+			m_pImmediateContext->CopyResource(m_pYUVReceived, m_pYUVTexture);
+			m_pImmediateContext->Flush();
+			m_YUVFrame = yuvframe;
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveYUVImage
+// Receive the sender YUV texture to planar pixels.
+//
+// The buffer layout is the Y plane followed by the interleaved UV plane
+// at half width and height with no row padding.
+//
+//   NV12 - width*height*3/2 bytes
+//   P010 - width*height*3 bytes (16 bit samples)
+//
+// The buffer must be the size of the YUV texture (GetYUVWidth, GetYUVHeight).
+bool spoutDX::ReceiveYUVImage(unsigned char* pixels, unsigned int width, unsigned int height)
+{
+	if (!pixels)
+		return false;
+
+	if (!ReceiveYUVTexture() || m_bUpdated || !m_pYUVReceived)
+		return false;
+
+	if (width != m_YUVWidth || height != m_YUVHeight)
+		return false;
+
+	// The pixels have the last frame read back
+	if (pixels == m_pYUVPixels && m_YUVFrame == m_YUVPixelFrame)
+		return true;
+
+	if (!m_pYUVStaging) {
+		if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, m_YUVWidth, m_YUVHeight,
+			(DXGI_FORMAT)m_dwYUVFormat, &m_pYUVStaging))
+			return false;
+	}
+
+	m_pImmediateContext->CopyResource(m_pYUVStaging, m_pYUVReceived);
+
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	m_pImmediateContext->Flush();
+	if (FAILED(m_pImmediateContext->Map(m_pYUVStaging, 0, D3D11_MAP_READ, 0, &mapped)))
+		return false;
+
+	// Bytes of each sample
+	const unsigned int bytes = (m_dwYUVFormat == DXGI_FORMAT_P010) ? 2 : 1;
+	const unsigned int rowbytes = width * bytes;
+	const unsigned char* src = static_cast<const unsigned char*>(mapped.pData);
+	unsigned char* dst = pixels;
+
+	// Y plane
+	for (unsigned int y = 0; y < height; y++) {
+		memcpy(dst, src + (uint64_t)y * mapped.RowPitch, rowbytes);
+		dst += rowbytes;
+	}
+	// UV plane follows the Y plane of the texture height
+	src += (uint64_t)mapped.RowPitch * height;
+	for (unsigned int y = 0; y < height / 2; y++) {
+		memcpy(dst, src + (uint64_t)y * mapped.RowPitch, rowbytes);
+		dst += rowbytes;
+	}
+
+	m_pImmediateContext->Unmap(m_pYUVStaging, 0);
+
+	m_pYUVPixels = pixels;
+	m_YUVPixelFrame = m_YUVFrame;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetYUVTexture
+// Received YUV texture
+ID3D11Texture2D* spoutDX::GetYUVTexture()
+{
+	return m_pYUVReceived;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderYUVFormat
+// Received YUV format
+DXGI_FORMAT spoutDX::GetSenderYUVFormat()
+{
+	if (m_bYUVOpen)
+		return (DXGI_FORMAT)m_dwYUVFormat;
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+//---------------------------------------------------------
+// Function: GetYUVWidth
+// Received YUV width
+unsigned int spoutDX::GetYUVWidth()
+{
+	return m_YUVWidth;
+}
+
+//---------------------------------------------------------
+// Function: GetYUVHeight
+// Received YUV height
+unsigned int spoutDX::GetYUVHeight()
+{
+	return m_YUVHeight;
+}
+
+//---------------------------------------------------------
+// Function: SetComputeConversion
+// Use a compute shader for ReceiveImage format, flip and resize.
+// The sender texture is converted on the GPU to the layout and size
+// of the receiving buffer and the staging copy is read with a single memcpy.
+// RGBA and BGRA 8 bit textures are supported.
+// Other formats, or if the shader is not available, use the default method.
+void spoutDX::SetComputeConversion(bool bCompute)
+{
+	m_bComputeConversion = bCompute;
+	if (!bCompute)
+		ReleaseConvert();
+}
+
+//---------------------------------------------------------
+// Function: GetComputeConversion
+// Compute shader conversion status
+bool spoutDX::GetComputeConversion()
+{
+	return m_bComputeConversion;
+}
+
+//---------------------------------------------------------
+// Function: SetComputeRGB
+// Pack RGB pixels for ReceiveImage by compute shader (default false).
+// The staging copy is three bytes per pixel instead of four
+// and there is no conversion on the CPU.
+// Disabled if the shader is not available.
+// The shader requires d3dcompiler_47.dll, so it is not used unless enabled.
+void spoutDX::SetComputeRGB(bool bCompute)
+{
+	m_bComputeRGB = bCompute;
+}
+
+//---------------------------------------------------------
+// Function: GetComputeRGB
+// Compute shader RGB packing status
+bool spoutDX::GetComputeRGB()
+{
+	return m_bComputeRGB;
+}
+
+//---------------------------------------------------------
+// Function: SetResampleMode
+// Set resample mode for ReceiveImage with a buffer of different size
+//   0 - nearest on the CPU after readback (default)
+//   1 - bilinear on the GPU before the staging copy
+//   2 - box on the GPU, for reduction by more than half
+// GPU resample reads back only the buffer size instead of the sender size.
+// With compute conversion (SetComputeConversion), mode 0 is nearest on the GPU.
+void spoutDX::SetResampleMode(int mode)
+{
+	if (mode < 0) mode = 0;
+	if (mode > 2) mode = 2;
+	m_ResampleMode = mode;
+}
+
+//---------------------------------------------------------
+// Function: GetResampleMode
+// Get resample mode
+int spoutDX::GetResampleMode()
+{
+	return m_ResampleMode;
+}
+
+//---------------------------------------------------------
+// Function: SetToneMapping
+// Tone map floating point senders for ReceiveImage by compute shader.
+// A sender texture of DXGI_FORMAT_R16G16B16A16_FLOAT or R32G32B32A32_FLOAT
+// (linear, 1.0 = SDR white) is tone mapped and quantised to 8 bit sRGB
+// in the layout of the receiving buffer before the staging copy, so the
+// data read back is the same as for an 8 bit sender.
+//   mode     - SPOUT_TONEMAP_NONE, SPOUT_TONEMAP_REINHARD or SPOUT_TONEMAP_ACES
+//   exposure - scale of the linear values before mapping
+// The default method is used if the shader is not available.
+void spoutDX::SetToneMapping(SpoutToneMap mode, float exposure)
+{
+	m_ToneMap = mode;
+	m_ToneMapExposure = (exposure > 0.0f) ? exposure : 1.0f;
+}
+
+//---------------------------------------------------------
+// Function: GetToneMapping
+// Tone mapping mode
+SpoutToneMap spoutDX::GetToneMapping()
+{
+	return m_ToneMap;
+}
+
+// Tone mapping is enabled and the sender texture is floating point
+bool spoutDX::IsToneMapped()
+{
+	return (m_ToneMap != SPOUT_TONEMAP_NONE
+		&& (m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT
+		 || m_dwFormat == DXGI_FORMAT_R32G32B32A32_FLOAT));
+}
+
+//---------------------------------------------------------
+// Function: SetVideoProcessing
+// Use the hardware video processor (ID3D11VideoProcessor)
+//   ReceiveImage - scale to a buffer of different size
+//   ReceiveImageYUV - NV12 conversion and scaling
+// The fixed function video engine is used instead of shaders
+// and only the output size is read back.
+// 8 bit RGBA and BGRA senders. Disabled if the processor is not available.
+void spoutDX::SetVideoProcessing(bool bProcess)
+{
+	m_bVideoProcessing = bProcess;
+	if (!bProcess)
+		ReleaseVideoProcessor();
+}
+
+//---------------------------------------------------------
+// Function: GetVideoProcessing
+// Video processing status
+bool spoutDX::GetVideoProcessing()
+{
+	return m_bVideoProcessing;
+}
+
+//---------------------------------------------------------
+// Function: SetReadbackBands
+// Read back ReceiveImage in horizontal bands
+//   Each band of the sender texture is copied to its own staging texture
+//   and converted to the pixel buffer as soon as that copy is complete,
+//   so that conversion of the first bands overlaps transfer of the rest.
+//   For large frames, the time to the last pixel approaches the longer
+//   of transfer and conversion rather than their sum.
+//   The current frame is read, without the frame of latency of the staging pair.
+//   nBands - 0 or 1 to disable (default), up to 8
+//   For a buffer of the sender size without compute conversion.
+void spoutDX::SetReadbackBands(int nBands)
+{
+	if (nBands < 2) nBands = 0;
+	if (nBands > SPOUT_READBACK_BANDS) nBands = SPOUT_READBACK_BANDS;
+	if (nBands != m_nReadBands)
+		ReleaseReadbackBands();
+	m_nReadBands = nBands;
+}
+
+//---------------------------------------------------------
+// Function: GetReadbackBands
+// Number of readback bands
+int spoutDX::GetReadbackBands()
+{
+	return m_nReadBands;
+}
+
+//---------------------------------------------------------
+// Function: SelectSender
+// Open sender selection dialog
+void spoutDX::SelectSender()
+{
+	SelectSenderPanel();
+}
+
+//---------------------------------------------------------
+// Function: SelectSender
+// Select a sender without SpoutPanel.
+//   The sender becomes the active sender and the receiver
+//   switches to it on the next receive, as for SpoutPanel.
+//   For a sender list shown by the application (see GetSenderNames).
+bool spoutDX::SelectSender(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return false;
+
+	// The sender must exist
+	SharedTextureInfo info={};
+	if (!sendernames.getSharedInfo(sendername, &info)) {
+		SpoutLogWarning("spoutDX::SelectSender - sender [%s] not found", sendername);
+		return false;
+	}
+
+	sendernames.SetActiveSender(sendername);
+	strcpy_s(m_SelectedSender, 256, sendername);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SelectSender
+// Select a sender by index of the sender list (see GetSender)
+bool spoutDX::SelectSender(int index)
+{
+	char sendername[256]={};
+	if (!sendernames.GetSender(index, sendername, 256))
+		return false;
+	return SelectSender(sendername);
+}
+
+//---------------------------------------------------------
+// Function: IsUpdated
+// Query whether the sender has changed.
+//
+//   Must be checked at every cycle before receiving data. 
+//
+//   If this is not done, the receiving functions fail.
+bool spoutDX::IsUpdated()
+{
+	bool bRet = m_bUpdated;
+	m_bUpdated = false; // Reset the update flag before return
+	return bRet;
+}
+
+
+//---------------------------------------------------------
+// Function: IsConnected
+// Query sender connection.
+//
+//   If the sender closes, receiving functions return false,  
+//   but connection can be tested at any time.
+bool spoutDX::IsConnected()
+{
+	return m_bConnected;
+}
+
+//---------------------------------------------------------
+// Function: IsFrameNew
+// Query received frame status
+//
+//   The receiving texture or pixel buffer is refreshed if the sender has produced a new frame  
+//   This can be queried to process texture data only for new frames
+bool spoutDX::IsFrameNew()
+{
+	return frame.IsFrameNew();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderTexture()
+// Received class texture
+//   Used together with ReceiveTexture()
+//   Can also be called after receiving to an application texture
+//   with ReceiveTexture(ID3D11Texture2D** ppTexture)
+//
+ID3D11Texture2D* spoutDX::GetSenderTexture()
+{
+	if (!m_bConnected)
+		return nullptr;
+
+	// Application texture set by SetReceiverTexture
+	if (m_ppReceiverTexture)
+		return *m_ppReceiverTexture;
+
+	if (!m_pTexture) {
+
+		// Create the class texture
+		if (!CheckTexture(GetSenderWidth(), GetSenderHeight(), GetSenderFormat()))
+			return nullptr;
+		
+		if (!m_pTexture)
+			return nullptr;
+
+		// Copy the shared texture to it
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			CopySenderTexture(m_pTexture);
+			m_pImmediateContext->Flush();
+		}
+		frame.AllowTextureAccess(m_pSharedTexture);
+
+	}
+	return m_pTexture;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderHandle
+// Received sender share handle
+HANDLE spoutDX::GetSenderHandle()
+{
+	return m_dxShareHandle;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFormat
+// Get sender DirectX texture format
+DXGI_FORMAT spoutDX::GetSenderFormat()
+{
+	return (DXGI_FORMAT)m_dwFormat;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderArraySize
+// Get sender number of views.
+//   The class texture, or a texture set by SetReceiverTexture,
+//   has the same number of views as the sender texture.
+unsigned int spoutDX::GetSenderArraySize()
+{
+	return m_ArraySize;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderMipLevels
+// Get sender number of mip levels.
+//   The receiving texture has one level and receives the top level.
+//   Lower levels are received with ReceiveMipLevel.
+unsigned int spoutDX::GetSenderMipLevels()
+{
+	return m_MipLevels;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveMipLevel
+// Receive a mip level of the sender texture.
+//
+//   The texture must have the size of the level, the sender size divided
+//   by 2 for each level, and the sender format. For example, level 2 of
+//   a 1920x1080 sender is 480x270. Copy to a staging texture of that size
+//   to read back a scaled down image.
+//
+//   As for ReceiveTexture, check IsUpdated() for a sender change
+//   and re-create the texture for the new level size.
+//   Level 0 is the full size texture and can be received from any sender.
+bool spoutDX::ReceiveMipLevel(ID3D11Texture2D* pTexture, unsigned int level)
+{
+	if (!pTexture)
+		return false;
+
+	// Return if flagged for update
+	if (m_bUpdated)
+		return true;
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		if (!m_pSharedTexture)
+			return false;
+
+		// Return to update the receiving texture for a sender change
+		if (m_bUpdated)
+			return true;
+
+		if (level >= m_MipLevels) {
+			SpoutLogWarning("spoutDX::ReceiveMipLevel - level %d not available (%d levels)", level, m_MipLevels);
+			return false;
+		}
+
+		// The receiving texture must be the size of the level
+		D3D11_TEXTURE2D_DESC desc={};
+		pTexture->GetDesc(&desc);
+		const unsigned int width = (m_Width >> level) > 0 ? (m_Width >> level) : 1;
+		const unsigned int height = (m_Height >> level) > 0 ? (m_Height >> level) : 1;
+		if (desc.Width != width || desc.Height != height) {
+			SpoutLogWarning("spoutDX::ReceiveMipLevel - texture %dx%d is not level %d size %dx%d",
+				desc.Width, desc.Height, level, width, height);
+			return false;
+		}
+
+		// Copy the level if the sender has produced a new frame
+		if (frame.GetNewFrame()) {
+			if (frame.CheckTextureAccess(m_pSharedTexture)) {
+				m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, 0, 0,
+					m_pSharedTexture, D3D11CalcSubresource(level, 0, m_MipLevels), nullptr);
+				m_pImmediateContext->Flush();
+				frame.AllowTextureAccess(m_pSharedTexture);
+				if (m_bFrameAck)
+					frame.AckFrame();
+			}
+			else {
+				// Access timed out, receive the frame next time
+				frame.ResetNewFrame();
+			}
+		}
+		m_bConnected = true;
+	}
+	else {
+		ReleaseReceiver();
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+}
+
+
+//---------------------------------------------------------
+// Function: GetSenderName
+// Get sender name
+const char * spoutDX::GetSenderName()
+{
+	return m_SenderName;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderWidth
+// Get sender width
+unsigned int spoutDX::GetSenderWidth()
+{
+	return m_Width;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderHeight
+// Get sender height
+unsigned int spoutDX::GetSenderHeight()
+{
+	return m_Height;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFps
+// Get sender frame rate
+double spoutDX::GetSenderFps()
+{
+	return frame.GetSenderFps();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFrame
+// Get sender frame number
+long spoutDX::GetSenderFrame()
+{
+	return frame.GetSenderFrame();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFrameAge
+// Time in msec from sender publish to receipt of the last frame.
+// Zero for a sender of an earlier version.
+double spoutDX::GetSenderFrameAge()
+{
+	return frame.GetFrameAge();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderMissedFrames
+// Number of sender frames not received since connection
+LONG64 spoutDX::GetSenderMissedFrames()
+{
+	return frame.GetMissedFrames();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFrameStats
+// Frame statistics since connection or for the last second.
+// New frames received, sender frames skipped, receive calls for a frame
+// already received, the largest number of frames skipped at one time
+// and the longest time between new frames. Frame counting must be enabled.
+void spoutDX::GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow)
+{
+	frame.GetFrameStats(stats, bWindow);
+}
+
+//---------------------------------------------------------
+// Function: ResetSenderFrameStats
+// Reset frame statistics
+void spoutDX::ResetSenderFrameStats()
+{
+	frame.ResetFrameStats();
+}
+
+//---------------------------------------------------------
+// Function: SetReceiveAnalysis
+// Histograms and waveform of each frame received by ReceiveTexture.
+// The analysis is done by compute shader and the result
+// is retrieved by GetAnalysis one frame later without a pipeline stall.
+void spoutDX::SetReceiveAnalysis(bool bAnalyze)
+{
+	m_bReceiveAnalysis = bAnalyze;
+	if (!bAnalyze)
+		ReleaseScope();
+}
+
+//---------------------------------------------------------
+// Function: GetReceiveAnalysis
+// Texture analysis option
+bool spoutDX::GetReceiveAnalysis()
+{
+	return m_bReceiveAnalysis;
+}
+
+//---------------------------------------------------------
+// Function: SetSkipUnchanged
+// Skip frames with the same content as the last received.
+// For senders that publish a content hash with each frame
+// (see Spout::EnableContentHash). The copy or read back is skipped
+// and IsFrameNew returns false. Frame counting must be enabled.
+void spoutDX::SetSkipUnchanged(bool bSkip)
+{
+	frame.SetSkipUnchanged(bSkip);
+}
+
+//---------------------------------------------------------
+// Function: GetSkipUnchanged
+// Skip unchanged frames option
+bool spoutDX::GetSkipUnchanged()
+{
+	return frame.GetSkipUnchanged();
+}
+
+
+//---------------------------------------------------------
+// COMMON
+//
+
+//
+// Group: Frame counting
+//
+
+//---------------------------------------------------------
+// Function: HoldFps
+// Frame rate control
+//    Desired frames per second
+void spoutDX::HoldFps(int fps)
+{
+	frame.HoldFps(fps);
+}
+
+// Function: DisableFrameCount
+// Disable frame counting specifically for this application
+void spoutDX::DisableFrameCount()
+{
+	frame.DisableFrameCount();
+}
+
+//---------------------------------------------------------
+// Function: IsFrameCountEnabled
+// Return frame count status
+bool spoutDX::IsFrameCountEnabled()
+{
+	return frame.IsFrameCountEnabled();
+}
+
+// -----------------------------------------------
+// Function: SetFrameSync
+// Signal sync event.
+//   Create a named sync event and set for test
+void spoutDX::SetFrameSync(const char* SenderName)
+{
+	if (SenderName && SenderName[0] && m_bSpoutInitialized)
+		frame.SetFrameSync(SenderName);
+}
+
+// -----------------------------------------------
+// Function: WaitFrameSync
+// Wait or test for named sync event.
+// Wait until the sync event is signalled or the timeout elapses.
+// Events are typically created based on the sender name and are
+// effective between a single sender/receiver pair.
+//   - For testing for a signal, use a wait timeout of zero.
+//   - For synchronization, use a timeout greater than the expected delay
+// 
+bool spoutDX::WaitFrameSync(const char *SenderName, DWORD dwTimeout)
+{
+	if (!SenderName || !SenderName[0] || !m_bSpoutInitialized)
+		return false;
+	return frame.WaitFrameSync(SenderName, dwTimeout);
+}
+
+// -----------------------------------------------
+// Function: WaitFrameSync
+// Wait or test for the sync events of a number of senders.
+//
+// Wait until any of the sync events is signalled or the timeout elapses.
+// bSignalled is an array of "count" flags which are set true for the
+// senders that signalled. Returns the number of senders that signalled.
+// 
+int spoutDX::WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout)
+{
+	if (!SenderNames || !m_bSpoutInitialized)
+		return 0;
+	return frame.WaitFrameSync(SenderNames, count, bSignalled, dwTimeout);
+}
+
+
+//---------------------------------------------------------
+// SenderNames
+//
+
+//
+// Group: Sender names
+//
+
+//---------------------------------------------------------
+// Function: GetSenderCount
+// Number of senders
+int spoutDX::GetSenderCount()
+{
+	return sendernames.GetSenderCount();
+}
+
+//---------------------------------------------------------
+// Function: GetSender
+// Sender item name in the sender names set
+bool spoutDX::GetSender(int index, char* sendername, int sendernameMaxSize)
+{
+	return sendernames.GetSender(index, sendername, sendernameMaxSize);
+}
+
+//---------------------------------------------------------
+// Function: GetSenderNames
+// Copy the sender names to a buffer of maxsenders names, each of maxlength bytes.
+// The names are in the same order as GetSender and there is no allocation.
+// Returns the number of names copied, or the number of senders if names is null.
+int spoutDX::GetSenderNames(char* names, int maxsenders, int maxlength)
+{
+	return sendernames.GetSenderNames(names, maxsenders, maxlength);
+}
+
+//---------------------------------------------------------
+// Function: GetSenderInfo
+// Sender information
+bool spoutDX::GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat)
+{
+	return sendernames.GetSenderInfo(sendername, width, height, dxShareHandle, dwFormat);
+}
+
+//---------------------------------------------------------
+// Function: GetSenderList
+// Details of all senders in one call.
+// Returns the number of senders copied, or the number of senders if pSenders is null.
+// The adapter index can be found with spoutdx.GetAdapterIndex(LUID).
+int spoutDX::GetSenderList(SpoutSenderDetails* pSenders, int maxsenders)
+{
+	return sendernames.GetSenderList(pSenders, maxsenders);
+}
+
+//---------------------------------------------------------
+// Function: GetActiveSender
+// Current active sender name
+bool spoutDX::GetActiveSender(char* Sendername)
+{
+	return sendernames.GetActiveSender(Sendername);
+}
+
+//---------------------------------------------------------
+// Function: SetActiveSender
+// Set sender as active
+bool spoutDX::SetActiveSender(const char* Sendername)
+{
+	return sendernames.SetActiveSender(Sendername);
+}
+
+//---------------------------------------------------------
+// Function: GetMaxSenders
+// Get user Maximum senders allowed
+int spoutDX::GetMaxSenders()
+{
+	return(sendernames.GetMaxSenders());
+}
+
+//---------------------------------------------------------
+// Function: SetMaxSenders
+// Set user Maximum senders allowed
+void spoutDX::SetMaxSenders(int maxSenders)
+{
+	sendernames.SetMaxSenders(maxSenders);
+}
+
+
+//
+// Adapter functions
+//
+
+//
+// Group: Graphics adapter
+//
+// Return graphics adapter number and names.
+// Get and set adapter index for the DirectX device.
+//
+// Note that both the Sender and Receiver must use the same graphics adapter.
+//
+
+
+//---------------------------------------------------------
+// Function: GetNumAdapters
+// The number of graphics adapters in the system
+int spoutDX::GetNumAdapters()
+{
+	return spoutdx.GetNumAdapters();
+}
+
+//---------------------------------------------------------
+// Function: GetAdapterName
+// Get adapter item name
+bool spoutDX::GetAdapterName(int index, char *adaptername, int maxchars)
+{
+	return spoutdx.GetAdapterName(index, adaptername, maxchars);
+}
+
+//---------------------------------------------------------
+// Function: GetAdapterInfo
+// // Get the current adapter description
+bool spoutDX::GetAdapterInfo(char *adapter, char *display, int maxchars)
+{
+	return spoutdx.GetAdapterInfo(adapter, display, maxchars);
+}
+
+//---------------------------------------------------------
+// Function: GetAdapter
+// Get adapter index
+int spoutDX::GetAdapter()
+{
+	return spoutdx.GetAdapter();
+}
+
+//---------------------------------------------------------
+// Function: SetAdapter
+// Set graphics adapter for output
+bool spoutDX::SetAdapter(int index)
+{
+	if (spoutdx.SetAdapter(index))
+		return true;
+
+	SpoutLogError("spoutDX::SetAdapter(%d) failed", index);
+	spoutdx.SetAdapter(0); // make sure globals are reset to default
+
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: GetAdapterPointer
+// Get adapter pointer for a given adapter (-1 means current)
+IDXGIAdapter* spoutDX::GetAdapterPointer(int index)
+{
+	return spoutdx.GetAdapterPointer(index);
+}
+
+//---------------------------------------------------------
+// Function: SetAdapterPointer
+// Set required graphics adapter for creating a device
+void spoutDX::SetAdapterPointer(IDXGIAdapter* pAdapter)
+{
+	spoutdx.SetAdapterPointer(pAdapter);
+}
+
+//---------------------------------------------------------
+// Function: GetAdapterAuto
+// Get auto device switching status
+bool spoutDX::GetAdapterAuto()
+{
+	return m_bAdapt;
+}
+
+//---------------------------------------------------------
+// Function: SetAdapterAuto
+// Auto switch receiving device to use the same adapter as the sender
+void spoutDX::SetAdapterAuto(bool bAdapt)
+{
+	if (bAdapt && !IsClassDevice()) {
+		SpoutLogWarning("spoutDX::SetAdapterAuto : D3D11 device created outside the class");
+		return;
+	}
+	m_bAdapt = bAdapt;
+}
+
+//---------------------------------------------------------
+// Function: SetAdapterBridge
+// Receive from a sender on a different graphics adapter by way of system memory.
+//
+// If the sender texture cannot be opened by the receiving device and the
+// device is not switched to the sender adapter (see SetAdapterAuto),
+// a device is created on the sender adapter to open the sender texture.
+// Each new frame is copied to the next of a ring of staging textures and
+// the last completed is copied to the receiving device, so neither waits
+// for the other. Frames are received one frame later than the sender.
+void spoutDX::SetAdapterBridge(bool bBridge)
+{
+	m_bBridge = bBridge;
+}
+
+//---------------------------------------------------------
+// Function: GetAdapterBridge
+// Get adapter bridge option
+bool spoutDX::GetAdapterBridge()
+{
+	return m_bBridge;
+}
+
+//---------------------------------------------------------
+// Function: IsAdapterBridge
+// Receiving from a sender on a different graphics adapter
+bool spoutDX::IsAdapterBridge()
+{
+	return (m_pBridgeShared != nullptr);
+}
+
+//---------------------------------------------------------
+// Function: AddSenderReplica
+// Keep a replica of the sender texture on another graphics adapter.
+//
+// Receivers on a different adapter to the sender otherwise receive
+// by way of system memory (SetAdapterBridge), each with a separate
+// read back. With a replica, each frame is read back once by the sender
+// and updated to a shared texture on every replica adapter.
+// The replicas are recorded with their adapter in shared memory
+// "<sendername>_SpoutReplicas". A receiver that cannot open the sender
+// texture opens the replica on the adapter of its device.
+//
+// Replicas are created with the sender texture, so add them before
+// sending. They are not used for array textures and replicate the top
+// level of a mip chain. Frames are updated one frame later than the sender.
+bool spoutDX::AddSenderReplica(int adapterindex)
+{
+	if (adapterindex < 0 || adapterindex >= spoutdx.GetNumAdapters()) {
+		SpoutLogWarning("spoutDX::AddSenderReplica - adapter %d not found", adapterindex);
+		return false;
+	}
+
+	for (int i = 0; i < m_nReplicaAdapters; i++) {
+		if (m_ReplicaAdapter[i] == adapterindex)
+			return true;
+	}
+
+	if (m_nReplicaAdapters >= SPOUT_MAX_REPLICAS) {
+		SpoutLogWarning("spoutDX::AddSenderReplica - maximum of %d replicas", SPOUT_MAX_REPLICAS);
+		return false;
+	}
+
+	m_ReplicaAdapter[m_nReplicaAdapters] = adapterindex;
+	m_nReplicaAdapters++;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ClearSenderReplicas
+// Remove all sender replicas
+void spoutDX::ClearSenderReplicas()
+{
+	ReleaseReplicas();
+	for (int i = 0; i < SPOUT_MAX_REPLICAS; i++)
+		m_ReplicaAdapter[i] = -1;
+	m_nReplicaAdapters = 0;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderReplicas
+// Number of adapters with a sender replica
+int spoutDX::GetSenderReplicas()
+{
+	return m_nReplicaAdapters;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderAdapter
+// Get adapter index and name for a given sender
+//
+// OpenDX11shareHandle will fail if the share handle has been created 
+// using a different graphics adapter (see spoutDirectX).
+//
+// This function loops though all graphics adapters in the system
+// until OpenDX11shareHandle is successful and the same adapter
+// index as the sender is established. 
+//
+// This adapter can then be used by CreateDX11device when the Spout
+// DirectX device is created.
+//
+int spoutDX::GetSenderAdapter(const char* sendername, char* adaptername, int maxchars)
+{
+	if (!sendername || !sendername[0])
+		return -1;
+
+	int senderadapter = -1;
+	ID3D11Texture2D* pSharedTexture = nullptr;
+	ID3D11Device* pDummyDevice = nullptr;
+	ID3D11DeviceContext* pContext = nullptr;
+	IDXGIAdapter* pAdapter = nullptr;
+
+	// Get the current device adapter pointer (could be null default)
+	IDXGIAdapter* pCurrentAdapter = spoutdx.GetAdapterPointer();
+
+	SpoutLogNotice("spoutDX::GetSenderAdapter - testing for sender adapter (%s)", sendername);
+
+	SharedTextureInfo info={};
+	if (sendernames.getSharedInfo(sendername, &info)) {
+		const int nAdapters = spoutdx.GetNumAdapters();
+		for (int i = 0; i < nAdapters; i++) {
+			pAdapter = spoutdx.GetAdapterPointer(i);
+			if (pAdapter) {
+				SpoutLogNotice("   testing adapter %d", i);
+				// Set the adapter pointer for CreateDX11device to use temporarily
+				spoutdx.SetAdapterPointer(pAdapter);
+				// Create a dummy device using this adapter
+				pDummyDevice = spoutdx.CreateDX11device();
+				if (pDummyDevice) {
+					// Try to open the share handle with the device created from the adapter
+					if (spoutdx.OpenDX11shareHandle(pDummyDevice, &pSharedTexture, LongToHandle((long)info.shareHandle))) {
+						// break as soon as it succeeds
+						SpoutLogNotice("    found sender adapter %d (0x%.7X)", i, PtrToUint(pAdapter));
+						senderadapter = i;
+						// Return the adapter name
+						if(adaptername)
+							spoutdx.GetAdapterName(i, adaptername, maxchars);
+						pDummyDevice->GetImmediateContext(&pContext);
+						if (pContext) pContext->Flush();
+						pDummyDevice->Release();
+						pAdapter->Release();
+						break;
+					}
+					pDummyDevice->GetImmediateContext(&pContext);
+					if (pContext) pContext->Flush();
+					pDummyDevice->Release();
+				}
+				pAdapter->Release();
+			}
+		}
+	}
+
+	// Set the SpoutDirectX class adapter pointer back to what it was
+	spoutdx.SetAdapterPointer(pCurrentAdapter);
+
+	// Return the sender adapter index
+	return senderadapter;
+
+}
+
+//
+// Group: Graphics performance
+//
+// Windows Graphics performance preferences.
+//
+// To be effective, performance preference requires the system to have multiple graphics
+// processors which provide a choice between "Power saving" and "High perfformance". 
+// Typically this will be laptop systems with integrated and discrete graphics.
+// Desktop systems with multiple discrete graphics cards do not provide that choice, 
+// even though Windows still allows applications to be set for desired preference.
+//
+// Windows preferences take priority over any settings made by driver
+// programs such as the NVIDIA Control Panel or AMD Control Center for that application.
+// If there is no Windows preference for an application, the graphics driver <settings
+// at https://www.nvidia.com/content/Control-Panel-Help/vLatest/en-us/mergedProjects/nv3d/Setting_the_Preferred_Graphics_Processor.htm> take effect.
+//
+// Performance prefrence settings are available from Windows 10
+// April 2018 update "Redstone 4" (Version 1803, build 17134) and later.
+// Windows 10 SDK required included in Visual Studio 2017 ver.15.7 
+//
+#ifdef NTDDI_WIN10_RS4
+
+//---------------------------------------------------------
+// Function: GetPerformancePreference
+// Get the Windows graphics preference for an application
+//
+//	-1 - Not registered
+//
+//	 0 - DXGI_GPU_PREFERENCE_UNSPECIFIED
+//
+//	 1 - DXGI_GPU_PREFERENCE_MINIMUM_POWER
+//
+//	 2 - DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE
+//
+// If no path is specified, use the current application path
+//
+int spoutDX::GetPerformancePreference(const char* path)
+{
+	return spoutdx.GetPerformancePreference(path);
+}
+
+//---------------------------------------------------------
+// Function: SetPerformancePreference
+// Set the Windows graphics preference for an application
+//
+//     -1 - No preference
+//
+//      0 - Default
+//
+//      1 - Power saving
+//
+//      2 - High performance
+//
+// If no path is specified, use the current application path
+//
+bool spoutDX::SetPerformancePreference(int preference, const char* path)
+{
+	return spoutdx.SetPerformancePreference(preference, path);
+}
+
+
+//
+// https://learn.microsoft.com/en-us/windows/win32/api/dxgi1_6/nf-dxgi1_6-idxgifactory6-enumadapterbygpupreference
+//
+// When DXGI_GPU_PREFERENCE_UNSPECIFIED is specified for the GpuPreference parameter,
+// this method is equivalent to calling IDXGIFactory1::EnumAdapters1.
+//
+// When DXGI_GPU_PREFERENCE_MINIMUM_POWER is specified for the GpuPreference parameter,
+// the order of preference for the adapter returned in ppvAdapter will be:
+// 1. iGPUs (integrated GPUs)
+// 2. dGPUs (discrete GPUs)
+// 3. xGPUs (external GPUs)
+//
+// When DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE is specified for the GpuPreference parameter,
+// the order of preference for the adapter returned in ppvAdapter will be:
+// 1. xGPUs (external GPUs)
+// 2. dGPUs (discrete GPUs)
+// 3. iGPUs (integrated GPUs)
+//
+
+//---------------------------------------------------------
+// Function: GetPreferredAdapterName
+//
+// Get the graphics adapter name for a Windows preference.
+// This is the first adapter for the given preference :
+//
+//    DXGI_GPU_PREFERENCE_UNSPECIFIED - (0) Equivalent to EnumAdapters1
+//
+//    DXGI_GPU_PREFERENCE_MINIMUM_POWER - (1) Integrated GPU
+//
+//    DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE - (2) External GPU / Discrete GPU
+//
+bool spoutDX::GetPreferredAdapterName(int preference, char* adaptername, int maxchars)
+{
+	return spoutdx.GetPreferredAdapterName(preference, adaptername, maxchars);
+}
+
+//---------------------------------------------------------
+// Function: SetPreferredAdapter
+//
+// Set graphics adapter index for a Windows preference
+//
+// Set the adapter index for a performance preference without registering the
+// preference with Windows. This index is used by CreateDX11device when DirectX
+// is intitialized. The function should be called before Spout is initialized.
 //
 //    DXGI_GPU_PREFERENCE_UNSPECIFIED - (0) Equivalent to EnumAdapters1
 //
-//    DXGI_GPU_PREFERENCE_MINIMUM_POWER - (1) Integrated GPU
+//    DXGI_GPU_PREFERENCE_MINIMUM_POWER - (1) Integrated GPU
+//
+//    DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE - (2) External GPU / Discrete GPU
+//
+// The function achieves this result without user Windows preference by getting the name
+// of the preferred adapter using EnumAdapterByGpuPreference, finding the index of
+// that adapter in the current list of adapters, using EnumAdapters and finally 
+// retrieving a pointer to the adapter for CreateDX11device to use. To be effective,
+// this requires a system with multiple graphics processors which enable a choice 
+// between "Power saving" and "High performance".
+//
+bool spoutDX::SetPreferredAdapter(int preference)
+{
+	return spoutdx.SetPreferredAdapter(preference);
+}
+
+
+//---------------------------------------------------------
+// Function: IsPreferenceAvailable()
+// Availability of Windows graphics preference settings.
+//
+// Settings are available from Windows 10 April 2018 update 
+// (Version 1803, build 17134) and later.
+bool spoutDX::IsPreferenceAvailable()
+{
+	return spoutdx.IsPreferenceAvailable();
+}
+
+//---------------------------------------------------------
+// Function: IsApplicationPath
+//
+// Is the path a valid application
+//
+// A valid application path will have a drive letter and terminate with ".exe"
+bool spoutDX::IsApplicationPath(const char* path)
+{
+	return spoutdx.IsApplicationPath(path);
+}
+#endif
+
+
+//
+// Group: Data sharing
+//
+//   General purpose data exchange functions using shared memory.
+//   These functions can be used in addition to texture sharing.
+//   Typical uses will be for data attached to the video frame,
+//   commonly referred to as "per frame Metadata".
+//
+//   Notes for synchronisation.
+//
+//   If used before sending and after receiving, the data will be 
+//   associated with the same video frame, but frames may be missed 
+//   if the receiver has a lower frame rate than the sender.
+//
+//   If strict synchronization is required, the data sharing functions
+//   should be used in combination with event signal functions. The sender
+//   frame rate will be matched exactly to that of the receiver and the 
+//   receiver will not miss any frames.
+//
+//      - void SetFrameSync(const char* SenderName);
+//      - bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
+//
+//   WaitFrameSync
+//   A sender should use this before rendering or sending texture or data and
+//   wait for a signal from the receiver that it is ready to read another frame.
+//
+//   SetFrameSync
+//   After receiving a texture, rendering the result and reading data
+//   a receiver should signal that it is ready to read another. 
+//
+
+//---------------------------------------------------------
+// Function: WriteMemoryBuffer
+// Write buffer to sender shared memory.
+//
+//    If shared memory has not been created in advance, it will be
+//    created on the first call to this function at the length specified.
+//
+//    This is acceptable if the data to send is fixed in length.
+//    Otherwise the shared memory should be created in advance of sufficient
+//    size to contain the maximum length expected (see CreateMemoryBuffer).
+//
+//    The map is closed when the sender is released.
+//
+bool spoutDX::WriteMemoryBuffer(const char *name, const char* data, int length)
+{
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return false;
+
+	if (!name || !name[0]) {
+		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no name");
+		return false;
+	}
+
+	if (!data) {
+		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no data");
+		return false;
+	}
+
+	// Create a shared memory map for the buffer if it does not exist yet
+	if (memorybuffer.Size() == 0) {
+		// Create a name for the map from the sender name
+		std::string namestring = name;
+		namestring += "_map";
+		// The first 16 bytes are reserved for the memory map size. Make the map larger to compensate. 
+		if (!memorybuffer.Create(namestring.c_str(), length + 16)) {
+			SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - could not create shared memory");
+			return false;
+		}
+		char* pBuffer = memorybuffer.Lock();
+		if (!pBuffer) {
+			SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no buffer lock");
+			return false;
+		}
+		// Convert the map size to decimal digit chars directly to shared memory
+		_itoa_s(length, reinterpret_cast<char *>(pBuffer), 16, 10);
+		memorybuffer.Unlock();
+		SpoutLogNotice("SpoutSharedMemory::WriteMemoryBuffer - created memory buffer %d bytes", length);
+	}
+
+	char* pBuffer = memorybuffer.Lock();
+	if (!pBuffer) {
+		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no buffer lock");
+		return false;
+	}
+
+	// Write user data to shared memory (skip the map size)
+	memcpy(reinterpret_cast<void *>(pBuffer + 16), reinterpret_cast<const void *>(data), length);
+
+	// Terminate the shared memory data with a null.
+	// The map is created larger in advance to allow for it.
+	if (memorybuffer.Size() > (16 + length))
+		*(pBuffer + 16 + length) = 0;
+
+	memorybuffer.Unlock();
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReadMemoryBuffer
+// Read sender shared memory to a buffer.
+//
+//    Open a sender memory map and retain the handle.
+//    The map is closed when the receiver is released.
+int spoutDX::ReadMemoryBuffer(const char* name, char* data, int maxlength)
+{
+	// Quit if 2.006 memory share mode
+	if (m_bMemoryShare)
+		return 0;
+
+	if (!name || !name[0]) {
+		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no name");
+		return 0;
+	}
+
+	if (!data) {
+		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no data");
+		return 0;
+	}
+
+	// Open a shared memory map for the buffer if it not already
+	if (!memorybuffer.Name()) {
+		// Create a name for the map from the sender name
+		std::string namestring = name;
+		namestring += "_map";
+		// Open the shared memory. This also creates a mutex
+		// for the reader to lock and unlock the map for reads.
+		if (!memorybuffer.Open(namestring.c_str())) {
+			return 0;
+		}
+		SpoutLogNotice("SpoutSharedMemory::ReadMemoryBuffer - opened sender memory map [%s]", memorybuffer.Name());
+	}
+
+	char* pBuffer = memorybuffer.Lock();
+	if (!pBuffer) {
+		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no buffer lock");
+		return 0;
+	}
+
+	// The memory map includes it's size, saved as the first 16 bytes
+	*(pBuffer + 15) = 0; // End for atoi
+
+	// Number of bytes available for data transfer
+	int nbytes = atoi(reinterpret_cast<char *>(pBuffer));
+
+	// Reduce if the user buffer max length is less
+	if (maxlength < nbytes)
+		nbytes = maxlength;
+
+	// Copy bytes from shared memory to the user buffer
+	if (nbytes > 0)
+		memcpy(reinterpret_cast<void *>(data), reinterpret_cast<const void *>(pBuffer + 16), nbytes);
+
+	// Done with the shared memory buffer pointer
+	memorybuffer.Unlock();
+
+	return nbytes;
+
+}
+
+//---------------------------------------------------------
+// Function: LockMemoryBuffer
+// Lock sender shared memory for read without copy.
+//
+//    Returns the number of bytes available and a pointer to the data
+//    in the memory map, or zero if the sender has no buffer.
+//    The sender cannot write to the buffer until UnlockMemoryBuffer
+//    is called, so use the data and unlock as soon as possible.
+//    The map remains open until the receiver is released.
+//    See also spoutMemoryBufferScope (SpoutSharedMemory.h).
+int spoutDX::LockMemoryBuffer(const char* name, const char** ppData)
+{
+	if (!ppData)
+		return 0;
+	*ppData = nullptr;
+
+	// Quit if 2.006 memory share mode
+	if (m_bMemoryShare)
+		return 0;
+
+	if (!name || !name[0]) {
+		SpoutLogError("spoutDX::LockMemoryBuffer - no name");
+		return 0;
+	}
+
+	// Open the sender's map if not done already
+	if (!memorybuffer.Name()) {
+		std::string namestring = name;
+		namestring += "_map";
+		if (!memorybuffer.Open(namestring.c_str()))
+			return 0;
+		SpoutLogNotice("spoutDX::LockMemoryBuffer - opened sender memory map [%s]", memorybuffer.Name());
+	}
+
+	const char* pBuffer = memorybuffer.Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutDX::LockMemoryBuffer - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes available is saved as the first 16 bytes
+	char size[16]={};
+	memcpy(size, pBuffer, 15);
+	const int nbytes = atoi(size);
+	if (nbytes <= 0) {
+		memorybuffer.Unlock();
+		return 0;
+	}
+
+	*ppData = pBuffer + 16;
+
+	return nbytes;
+}
+
+//---------------------------------------------------------
+// Function: UnlockMemoryBuffer
+// Unlock shared memory locked by LockMemoryBuffer
+void spoutDX::UnlockMemoryBuffer()
+{
+	memorybuffer.Unlock();
+}
+
+//---------------------------------------------------------
+// Function: CreateMemoryBuffer
+// Create a sender shared memory buffer.
+//
+//    Create a memory map and retain the handle.
+//    This function should be called before any buffer write
+//    if the length of the data to send will vary.
+//    The map is closed when the sender is released.
+bool spoutDX::CreateMemoryBuffer(const char *name, int length)
+{
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return false;
+
+	if (!name || !name[0]) {
+		SpoutLogError("spoutDX::CreateMemoryBuffer - no name");
+		return false;
+	}
+
+	if (memorybuffer.Size() > 0) {
+		SpoutLogError("spoutDX::CreateMemoryBuffer - shared memory already exists");
+		return false;
+	}
+
+	// Create a name for the map from the sender name
+	std::string namestring = name;
+	namestring += "_map";
+
+	// The first 16 bytes are reserved to record the number of bytes available
+	// for data transfer. Make the map 16 bytes larger to compensate. 
+	// Add another 16 bytes to allow for a null terminator.
+	// (Use multiples of 16 for alignment to allow for SSE copy : TODO).
+	if (!memorybuffer.Create(namestring.c_str(), length + 32)) {
+		SpoutLogError("spoutGL::CreateMemoryBuffer - could not create shared memory");
+		return false;
+	}
+
+	// The length requested is the number of bytes to be
+	// available for data transfer (map data size).
+	char* pBuffer = memorybuffer.Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::CreateMemoryBuffer - no buffer lock");
+		return false;
+	}
+
+	// Convert the map data size to decimal digit chars
+	// directly to the first 16 bytes of the shared memory.
+	_itoa_s(length, reinterpret_cast<char *>(pBuffer), 16, 10);
+
+	memorybuffer.Unlock();
+
+	SpoutLogNotice("spoutDXL::CreateMemoryBuffer - created memory buffer %d bytes", length);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: DeleteMemoryBuffer
+// Delete a sender shared memory buffer.
+//
+bool spoutDX::DeleteMemoryBuffer()
+{
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return false;
+
+	// A sender must create a map
+	// A receiver must open a sender map to find the size
+	if (memorybuffer.Size() == 0) {
+		SpoutLogError("spoutDX::DeleteMemoryBuffer - no shared memory size");
+		return false;
+	}
+
+	memorybuffer.Close();
+
+	return true;
+
+}
+
+
+//---------------------------------------------------------
+// Function: GetMemoryBufferSize
+// Get the size of a sender shared memory buffer.
+//
+int spoutDX::GetMemoryBufferSize(const char *name)
+{
+	if (!m_bSpoutInitialized)
+		return 0;
+
+	// A writer has created the map and recorded the data length in the first 16 bytes.
+	// Another 16 bytes is added to allow for a terminating NULL. (See CreateMemoryBuffer)
+	// The remaining length is the number of bytes available for data transfer.
+	if (memorybuffer.Size() > 32) {
+		return memorybuffer.Size() - 32;
+	}
+
+	// A reader must read the map to get the size
+	// Open a shared memory map for the buffer if it not already
+	if (!memorybuffer.Name()) {
+		// Create a name for the map
+		std::string namestring = name;
+		namestring += "_map";
+		// Open the shared memory map.
+		// This also creates a mutex for the receiver to lock and unlock the map for reads.
+		if (!memorybuffer.Open(namestring.c_str())) {
+			return 0;
+		}
+		SpoutLogNotice("spoutDX::GetMemoryBufferSize - opened sender memory map [%s]", memorybuffer.Name());
+	}
+
+	char* pBuffer = memorybuffer.Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutDX::GetMemoryBufferSize - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes of the memory map available for data transfer
+	// is saved in the first 16 bytes.
+	*(pBuffer + 15) = 0; // End for atoi
+	int nbytes = atoi(reinterpret_cast<char *>(pBuffer));
+
+	memorybuffer.Unlock();
+
+	return nbytes;
+
+}
+
+//---------------------------------------------------------
+// Function: CreateDataChannel
+// Create a named data channel.
+//
+//    Channels are shared memory buffers in the same format as
+//    CreateMemoryBuffer, so they can be read by ReadMemoryBuffer.
+//    Each channel has its own map, which is created once and retained,
+//    so that several independent streams of data can be written
+//    without re-opening a map for each. Up to SPOUT_DATA_CHANNELS
+//    channels are available. The channels are closed when the sender
+//    or receiver is released (see CloseDataChannels).
+bool spoutDX::CreateDataChannel(const char* name, int length)
+{
+	if (!name || !*name || length <= 0) {
+		SpoutLogError("spoutDX::CreateDataChannel - no name or length");
+		return false;
+	}
+
+	if (FindDataChannel(name) >= 0) {
+		SpoutLogWarning("spoutDX::CreateDataChannel - channel [%s] already exists", name);
+		return false;
+	}
+
+	// A free channel
+	int index = -1;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		if (!m_DataChannels[i].pMap) {
+			index = i;
+			break;
+		}
+	}
+	if (index < 0) {
+		SpoutLogError("spoutDX::CreateDataChannel - all %d channels used", SPOUT_DATA_CHANNELS);
+		return false;
+	}
+
+	std::string namestring = name;
+	namestring += "_map";
+
+	// The first 16 bytes record the number of bytes available
+	// and another 16 bytes allow for a null terminator
+	SpoutSharedMemory* pMap = new SpoutSharedMemory;
+	if (pMap->Create(namestring.c_str(), (ULONGLONG)length + 32) == SPOUT_CREATE_FAILED) {
+		SpoutLogError("spoutDX::CreateDataChannel - could not create shared memory [%s]", namestring.c_str());
+		delete pMap;
+		return false;
+	}
+
+	char* pBuffer = pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutDX::CreateDataChannel - no buffer lock");
+		delete pMap;
+		return false;
+	}
+	_itoa_s(length, pBuffer, 16, 10);
+	*(pBuffer + 16) = 0;
+	pMap->Unlock();
+
+	strcpy_s(m_DataChannels[index].name, 256, name);
+	m_DataChannels[index].pMap = pMap;
+	m_DataChannels[index].size = length;
+	SpoutLogNotice("spoutDX::CreateDataChannel - created channel [%s] %d bytes", name, length);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: WriteDataChannel
+// Write data to a named data channel.
+//
+//    The channel is created on the first write at the length given
+//    if it has not been created in advance (see CreateDataChannel).
+//    Data longer than the channel is truncated.
+bool spoutDX::WriteDataChannel(const char* name, const char* data, int length)
+{
+	if (!name || !*name || !data || length <= 0)
+		return false;
+
+	int index = FindDataChannel(name);
+	if (index < 0) {
+		if (!CreateDataChannel(name, length))
+			return false;
+		index = FindDataChannel(name);
+	}
+
+	// A channel opened for read cannot be written
+	SpoutDataChannel& channel = m_DataChannels[index];
+	if (channel.size <= 0) {
+		SpoutLogError("spoutDX::WriteDataChannel - channel [%s] is open for read", name);
+		return false;
+	}
+
+	if (length > channel.size)
+		length = channel.size;
+
+	char* pBuffer = channel.pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutDX::WriteDataChannel - no buffer lock");
+		return false;
+	}
+	memcpy(pBuffer + 16, data, length);
+	*(pBuffer + 16 + length) = 0;
+	channel.pMap->Unlock();
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReadDataChannel
+// Read data from a named data channel.
+//
+//    The channel map is opened on the first read and retained.
+//    Returns the number of bytes copied, or zero if the channel
+//    has not been created by a sender.
+int spoutDX::ReadDataChannel(const char* name, char* data, int maxlength)
+{
+	if (!name || !*name || !data || maxlength <= 0)
+		return 0;
+
+	int index = FindDataChannel(name);
+	if (index < 0) {
+		// A free channel
+		for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+			if (!m_DataChannels[i].pMap) {
+				index = i;
+				break;
+			}
+		}
+		if (index < 0) {
+			SpoutLogError("spoutDX::ReadDataChannel - all %d channels used", SPOUT_DATA_CHANNELS);
+			return 0;
+		}
+		// Open the sender's map. Zero if it does not exist yet.
+		std::string namestring = name;
+		namestring += "_map";
+		SpoutSharedMemory* pMap = new SpoutSharedMemory;
+		if (!pMap->Open(namestring.c_str())) {
+			delete pMap;
+			return 0;
+		}
+		strcpy_s(m_DataChannels[index].name, 256, name);
+		m_DataChannels[index].pMap = pMap;
+		m_DataChannels[index].size = 0; // Opened for read
+		SpoutLogNotice("spoutDX::ReadDataChannel - opened channel [%s]", name);
+	}
+
+	SpoutSharedMemory* pMap = m_DataChannels[index].pMap;
+	const char* pBuffer = pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutDX::ReadDataChannel - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes available is saved as the first 16 bytes
+	char size[16]={};
+	memcpy(size, pBuffer, 15);
+	int nbytes = atoi(size);
+	if (nbytes > maxlength)
+		nbytes = maxlength;
+	if (nbytes > 0)
+		memcpy(data, pBuffer + 16, nbytes);
+
+	pMap->Unlock();
+
+	return (nbytes > 0) ? nbytes : 0;
+}
+
+//---------------------------------------------------------
+// Function: CloseDataChannel
+// Close a named data channel
+void spoutDX::CloseDataChannel(const char* name)
+{
+	const int index = FindDataChannel(name);
+	if (index < 0)
+		return;
+	delete m_DataChannels[index].pMap; // Closes the map
+	m_DataChannels[index] = {};
+}
+
+//---------------------------------------------------------
+// Function: CloseDataChannels
+// Close all data channels
+void spoutDX::CloseDataChannels()
+{
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		delete m_DataChannels[i].pMap;
+		m_DataChannels[i] = {};
+	}
+}
+
+// Index of a named data channel or -1
+int spoutDX::FindDataChannel(const char* name)
+{
+	if (!name || !*name)
+		return -1;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		if (m_DataChannels[i].pMap && strcmp(m_DataChannels[i].name, name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+//---------------------------------------------------------
+// Function: CreateFrameData
+// Create a frame data buffer.
+//
+//    Optional. Sets the maximum length of data for each frame.
+//    Otherwise the buffer is created by the first WriteFrameData
+//    for at least 4096 bytes.
+bool spoutDX::CreateFrameData(int maxlength)
+{
+	if (!m_SenderName[0] || maxlength <= 0)
+		return false;
+	return frame.CreateFrameData(m_SenderName, (unsigned int)maxlength);
+}
+
+//---------------------------------------------------------
+// Function: WriteFrameData
+// Write data sent with the next frame.
+//
+//    Each write is tagged with the number of the frame that it is
+//    sent with and saved in the next of a number of buffers.
+//    Receivers do not lock out the sender (see spoutFrameCount).
+//    Call before sending the frame. Frame counting must be enabled.
+bool spoutDX::WriteFrameData(const char* data, int length)
+{
+	if (!m_SenderName[0] || !data || length <= 0)
+		return false;
+	return frame.WriteFrameData(m_SenderName, data, (unsigned int)length);
+}
+
+//---------------------------------------------------------
+// Function: ReadFrameData
+// Read the data sent with a frame.
+//
+//    framenumber - sender frame number, 0 for the frame received (GetSenderFrame)
+//
+//    Returns the number of bytes read, or zero if no data was sent with the frame
+//    or it has been replaced by later frames.
+int spoutDX::ReadFrameData(char* data, int maxlength, long framenumber)
+{
+	if (!m_SenderName[0] || !data || maxlength <= 0)
+		return 0;
+	return frame.ReadFrameData(m_SenderName, data, (unsigned int)maxlength, (LONG64)framenumber);
+}
+
+//
+// Sharing modes
+//
+
+//
+// Group: Retained for 2.006 compatibility
+//
+
+//---------------------------------------------------------
+// Function: GetDX9
+// Get user DX9 mode
+bool spoutDX::GetDX9()
+{
+	DWORD dwDX9 = 0;
+	ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "DX9", &dwDX9);
+	return (dwDX9 == 1);
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryShareMode
+// Get user memory share mode
+bool spoutDX::GetMemoryShareMode()
+{
+	bool bRet = false;
+	DWORD dwMem = 0;
+	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", &dwMem)) {
+		bRet = (dwMem == 1);
+	}
+	return bRet;
+}
+
+//
+// Utilities
+//
+
+//---------------------------------------------------------
+// Function: CreateDX11texture
+// Create a texture that is not shared
+bool spoutDX::CreateDX11texture(ID3D11Device* pd3dDevice,
+	unsigned int width, unsigned int height,
+	DXGI_FORMAT format, ID3D11Texture2D** ppTexture)
+{
+	return spoutdx.CreateDX11Texture(pd3dDevice, width, height, format, ppTexture);
+}
+
+//---------------------------------------------------------
+// Function: CheckSenderFormat
+// Find sender shared memory.
+// If format is zero, try to open the sharehandle
+// and write the correct format back to shared memory
+// Also register the sender name if not already
+void spoutDX::CheckSenderFormat(const char * sendername)
+{
+	SharedTextureInfo info={};
+
+	// Correct for format 0 and un-registered
+	if (sendernames.getSharedInfo(sendername, &info)) {
+		if (info.format == 0) {
+			ID3D11Device *pDummyDevice = nullptr;
+			ID3D11Texture2D* pSharedTexture = nullptr;
+			pDummyDevice = spoutdx.CreateDX11device();
+			if (pDummyDevice) {
+
+				// Try to open the share handle
+				// If it's DirectX9, the handle will not open
+				if (spoutdx.OpenDX11shareHandle(pDummyDevice, &pSharedTexture, LongToHandle((LONG)info.shareHandle))) {
+					if (pSharedTexture) {
+						// Get the texture details
+						D3D11_TEXTURE2D_DESC desc;
+						pSharedTexture->GetDesc(&desc);
+						// Set the format to the sender info
+						info.format = (DWORD)desc.Format;
+						sendernames.setSharedInfo(sendername, &info);
+						pSharedTexture->Release();
+					}
+				}
+			}
+		}
+
+		// Register the sender name if not already
+		sendernames.RegisterSenderName(sendername);
+
+		// Make active if there is no active sender
+		char activename[256]={};
+		if (!sendernames.GetActiveSender(activename))
+			sendernames.SetActiveSender(sendername);
+	}
+}
+
+//
+// SpoutUtils namespace functions for dll access
+//
+
+void spoutDX::OpenSpoutConsole()
+{
+	spoututils::OpenSpoutConsole();
+}
+
+void spoutDX::CloseSpoutConsole(bool bWarning)
+{
+	spoututils::CloseSpoutConsole(bWarning);
+}
+
+void spoutDX::EnableSpoutLog()
+{
+	spoututils::EnableSpoutLog();
+}
+
+void spoutDX::EnableSpoutLogFile(const char* filename, bool append)
+{
+	spoututils::EnableSpoutLogFile(filename, append);
+}
+
+void spoutDX::DisableSpoutLogFile()
+{
+	spoututils::DisableSpoutLogFile();
+}
+
+void spoutDX::DisableSpoutLog()
+{
+	spoututils::DisableSpoutLog();
+}
+
+
+
+//
+// PRIVATE
+//
+
+// --------------------------------------------------------
+// If a sender has not been created yet
+//    o Make sure DirectX is initialized
+//    o Create a shared texture for the sender
+//    o Create a sender using the DX11 shared texture handle
+// If the sender exists, test for size or format change
+//    o Re-create the class shared texture to the new size
+//    o Update the sender and class variables
+// An array size greater than 1 creates an array texture sender
+bool spoutDX::CheckSender(unsigned int width, unsigned int height, DWORD dwFormat, unsigned int arraysize)
+{
+	if (arraysize < 1) arraysize = 1;
+	if (arraysize > SPOUT_USAGE_ARRAY_MASK) {
+		SpoutLogWarning("spoutDX::CheckSender - array size %d is greater than %d", arraysize, SPOUT_USAGE_ARRAY_MASK);
+		return false;
+	}
+
+	// A mip chain is created for a single texture if the option is set
+	const bool bMips = (m_bSenderMips && arraysize == 1);
+
+	if (width == 0 || height == 0)
+		return false;
+
+	// The sender needs a name (default is the executable name)
+	if (!m_SenderName[0]) {
+		if (!SetSenderName())
+			return false;
+	}
+
+	if (!m_bSpoutInitialized) {
+
+		// Make sure DirectX is initialized
+		if (!OpenDirectX11())
+			return false;
+
+		// Create a shared texture for the sender
+		// A sender creates a new texture with a new share handle
+		// the existing shared texture is released
+		if (!CreateSenderTexture(width, height, dwFormat, arraysize, bMips ? 0 : 1)) {
+			SpoutLogWarning("spoutDX::CheckSender - could not create shared texture");
+			return false;
+		}
+		CreateSenderMips(bMips);
+
+		// Save class width and height and format to test
+		// for sender size changes after initialization
+		m_Width = width;
+		m_Height = height;
+		m_dwFormat = dwFormat;
+		m_ArraySize = arraysize;
+
+		// Ring, preview and YUV textures are not used for an array texture
+		if (arraysize == 1) {
+
+			// Create ring textures if used, before receivers can connect
+			if (m_nRing > 1)
+				CreateTextureRing(width, height, dwFormat);
+
+			// Create the preview texture if used
+			if (m_PreviewMaxWidth > 0)
+				CreatePreview(width, height, dwFormat);
+
+			// Create the YUV texture if used
+			if (m_YUVFormat != DXGI_FORMAT_UNKNOWN)
+				CreateYUV(width, height, (DWORD)m_YUVFormat);
+
+			// Create replicas on other adapters if used
+			if (m_nReplicaAdapters > 0)
+				CreateReplicas(width, height, dwFormat);
+		}
+
+		// Create a sender using the DX11 shared texture handle (m_dxShareHandle)
+		// and specifying the same texture format.
+		if (sendernames.CreateSender(m_SenderName, m_Width, m_Height, m_dxShareHandle, m_dwFormat)) {
+
+			// sendernames::SetSenderInfo writes the sender information to shared memory
+			// including the sender executable path
+
+			// Record the number of views of an array texture sender
+			if (arraysize > 1)
+				sendernames.SetSenderArraySize(m_SenderName, arraysize);
+			// Record the number of mip levels
+			if (m_MipLevels > 1)
+				sendernames.SetSenderMipLevels(m_SenderName, m_MipLevels);
+			// Record a texture shared by a named NT handle
+			if (m_hNThandle)
+				sendernames.SetSenderNTHandle(m_SenderName, true);
+			// Record the adapter for the sender list
+			LUID luid={};
+			if (spoutdx.GetDeviceAdapterLuid(m_pd3dDevice, luid))
+				sendernames.SetSenderAdapterLuid(m_SenderName, luid);
+
+			// Create a sender mutex for access to the shared texture
+			frame.CreateAccessMutex(m_SenderName);
+
+			// Create a shared fence if the option is enabled
+			if (frame.IsFenceSyncEnabled())
+				frame.CreateSharedFence(m_SenderName, m_pd3dDevice);
+
+			// Time GPU copy completion if the option is enabled
+			if (frame.IsFrameTimingEnabled())
+				frame.CreateFrameTiming(m_pd3dDevice);
+
+			// Enable frame counting so the receiver gets frame number and fps
+			frame.EnableFrameCount(m_SenderName);
+
+			// Image requests of receivers if used
+			if (m_bSharedImages && arraysize == 1)
+				CreateSharedImages();
+
+			m_bSpoutInitialized = true;
+
+			// Register sub-senders if used
+			UpdateAtlasSenders();
+		}
+		else {
+			SpoutLogWarning("spoutDX::CheckSender - could not get create sender");
+			return false;
+		}
+	} // end create sender
+
+	// Initialized but has the source texture changed size ?
+	if (m_Width != width || m_Height != height || m_dwFormat != dwFormat || m_ArraySize != arraysize
+		|| (m_bSenderMips && arraysize == 1) != (m_pSharedSRV != nullptr)
+		|| m_bNThandle != (m_hNThandle != nullptr)) {
+		SpoutLogNotice("spoutDX::CheckSender - size change from %dx%d to %dx%d\n", m_Width, m_Height, width, height);
+		if (m_pSharedSRV)
+			m_pSharedSRV->Release();
+		m_pSharedSRV = nullptr;
+		if (m_pSharedTexture) {
+			spoutdx.ReleaseDX11Texture(m_pSharedTexture);
+			// The existing shared texture is changed on this device
+			m_pImmediateContext->Flush();
+		}
+		m_pSharedTexture = nullptr;
+
+		const bool bNewMips = (m_bSenderMips && arraysize == 1);
+		if (!CreateSenderTexture(width, height, dwFormat, arraysize, bNewMips ? 0 : 1)) {
+			SpoutLogWarning("spoutDX::CheckSender - could not re-create shared texture");
+			return false;
+		}
+		CreateSenderMips(bNewMips);
+
+		if (arraysize == 1) {
+
+			// Re-create ring textures if used, before receivers can re-connect
+			if (m_nRing > 1)
+				CreateTextureRing(width, height, dwFormat);
+
+			// Re-create the preview texture if used
+			if (m_PreviewMaxWidth > 0)
+				CreatePreview(width, height, dwFormat);
+
+			// Re-create the YUV texture if used
+			if (m_YUVFormat != DXGI_FORMAT_UNKNOWN)
+				CreateYUV(width, height, (DWORD)m_YUVFormat);
+
+			// Re-create replicas if used
+			if (m_nReplicaAdapters > 0)
+				CreateReplicas(width, height, dwFormat);
+		}
+		else {
+			// Replicas are not used for an array texture
+			ReleaseReplicas();
+		}
+
+		// Update the sender information
+		sendernames.UpdateSender(m_SenderName, width, height, m_dxShareHandle, dwFormat);
+		if (arraysize > 1)
+			sendernames.SetSenderArraySize(m_SenderName, arraysize);
+		if (m_MipLevels > 1)
+			sendernames.SetSenderMipLevels(m_SenderName, m_MipLevels);
+		if (m_hNThandle)
+			sendernames.SetSenderNTHandle(m_SenderName, true);
+
+		// Update class variables
+		m_Width = width;
+		m_Height = height;
+		m_dwFormat = dwFormat;
+		m_ArraySize = arraysize;
+
+		// Update sub-senders with the new texture if used
+		UpdateAtlasSenders();
+
+	} // end size checks
+
+	// Let cleanup know that the sender is alive
+	sendernames.SetSenderHeartbeat(m_SenderName);
+
+	// Memory held by the sender for telemetry
+	CheckTelemetryMemory();
+
+	return true;
+
+}
+
+// Create the sender shared texture (m_pSharedTexture) and share handle (m_dxShareHandle).
+// For the NT handle option, the texture is shared by a named NT handle (m_hNThandle)
+// and m_dxShareHandle is the identifier of the name recorded for receivers.
+bool spoutDX::CreateSenderTexture(unsigned int width, unsigned int height, DWORD dwFormat, unsigned int arraysize, unsigned int miplevels)
+{
+	// The name of a previous texture is released with its handle
+	ReleaseSenderNTHandle();
+	m_dxShareHandle = nullptr;
+
+	// The identifier is different for each process and each texture
+	// so that a receiver does not use a texture that has been replaced
+	unsigned int id = 0;
+	char sharename[256]={};
+	if (m_bNThandle) {
+		m_NThandleCount++;
+		id = (GetCurrentProcessId() << 8) | (m_NThandleCount & 0xFF);
+		if (id == 0) id = 1;
+		spoutdx.GetSharedTextureName(m_SenderName, UintToPtr(id), sharename, 256);
+	}
+
+	HANDLE hShare = nullptr;
+	if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pSharedTexture, hShare,
+		false, m_bNThandle, arraysize, miplevels, m_bNThandle ? sharename : nullptr)) {
+		return false;
+	}
+
+	// An NT handle is not created if the device does not support D3D_FEATURE_LEVEL_11_1
+	D3D11_TEXTURE2D_DESC desc={};
+	m_pSharedTexture->GetDesc(&desc);
+	if ((desc.MiscFlags & D3D11_RESOURCE_MISC_SHARED_NTHANDLE) != 0) {
+		m_hNThandle = hShare;
+		m_dxShareHandle = UintToPtr(id);
+	}
+	else {
+		if (m_bNThandle) {
+			SpoutLogWarning("spoutDX::CreateSenderTexture - NT handle not supported, using a share handle");
+			// Avoid re-creating the sender texture for each frame
+			m_bNThandle = false;
+		}
+		m_dxShareHandle = hShare;
+	}
+
+	return true;
+}
+
+// Close the NT handle of the sender texture
+void spoutDX::ReleaseSenderNTHandle()
+{
+	if (m_hNThandle)
+		CloseHandle(m_hNThandle);
+	m_hNThandle = nullptr;
+}
+
+// Create a resource view of the sender texture for GenerateMips
+// and record the number of mip levels
+void spoutDX::CreateSenderMips(bool bMips)
+{
+	if (m_pSharedSRV)
+		m_pSharedSRV->Release();
+	m_pSharedSRV = nullptr;
+	m_MipLevels = 1;
+
+	if (!bMips || !m_pSharedTexture)
+		return;
+
+	if (FAILED(m_pd3dDevice->CreateShaderResourceView(m_pSharedTexture, nullptr, &m_pSharedSRV))) {
+		SpoutLogWarning("spoutDX::CreateSenderMips - could not create resource view. Mip chain disabled.");
+		m_pSharedSRV = nullptr;
+		// Avoid re-creating the sender texture for each frame
+		m_bSenderMips = false;
+		return;
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	m_pSharedTexture->GetDesc(&desc);
+	m_MipLevels = desc.MipLevels;
+
+}
+
+// Generate the sender texture mip chain from the top level
+void spoutDX::GenerateSenderMips()
+{
+	if (m_pSharedSRV)
+		m_pImmediateContext->GenerateMips(m_pSharedSRV);
+}
+
+// Release the render target view of the sender texture used by BeginFrame
+void spoutDX::ReleaseSharedRTV()
+{
+	if (m_pSharedRTV)
+		m_pSharedRTV->Release();
+	m_pSharedRTV = nullptr;
+	m_pSharedRTVTexture = nullptr;
+}
+
+//---------------------------------------------------------
+// Close the waitable object and release the swap chain used by WaitSwapChain
+void spoutDX::ReleaseSwapChainWait()
+{
+	if (m_hSwapChainWait)
+		CloseHandle(m_hSwapChainWait);
+	m_hSwapChainWait = nullptr;
+
+	if (m_pWaitSwapChain)
+		m_pWaitSwapChain->Release();
+	m_pWaitSwapChain = nullptr;
+}
+
+//---------------------------------------------------------
+// Used when the sender was there but the texture pointer could not be retrieved from the share handle.
+// Try using the sender adapter if different.
+ID3D11Texture2D* spoutDX::CheckSenderTexture(char *sendername, HANDLE dxShareHandle)
+{
+	// If auto adapter switching not activated, return a NULL pointer
+	if (!m_bAdapt) {
+		SpoutLogWarning("spoutDX::CheckSenderTexture - no automatic switch to sender adapter");
+		return nullptr;
+	}
+
+	ID3D11Texture2D* pTexture =  nullptr;
+
+	// Save the current adapter index
+	int receiverindex = GetAdapter();
+
+	// Get the sender adapter index
+	int senderindex = GetSenderAdapter(sendername);
+		
+	// If they are different, switch to the sender adapter
+	if (receiverindex != senderindex) {
+
+		CloseDirectX11(); // Close the current DX11 device
+
+		SetAdapter(senderindex); // Change to the same adapter as the sender
+		
+		OpenDirectX11(); // Create a new device with that adapter
+
+		// Try again to get the texture pointer
+		if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &pTexture, dxShareHandle)) {
+
+			// If that didn't work, change back to the original adapter
+			CloseDirectX11();
+			SetAdapter(receiverindex);
+			OpenDirectX11();
+			SpoutLogWarning("spoutDX::CheckSenderTexture - could not change to sender adapter %d", senderindex);
+
+			return nullptr;
+		}
+
+		// The sharehandle opened OK with the new adapter
+		SpoutLogNotice("spoutDX::CheckSenderTexture - changed to sender adapter %d", senderindex);
+
+		return pTexture;
+
+	}
+
+	// The adapter was not different so the sharehandle still could not be opened
+	return nullptr;
+
+}
+
+//---------------------------------------------------------
+// Open a sender texture on a different adapter for the adapter bridge.
+// Return a texture on the receiving device to use in place of the sender texture.
+ID3D11Texture2D* spoutDX::OpenBridge(const char* sendername, HANDLE dxShareHandle)
+{
+	CloseBridge();
+
+	// The sender adapter
+	const int senderindex = GetSenderAdapter(sendername);
+	if (senderindex < 0 || senderindex == GetAdapter()) {
+		SpoutLogWarning("spoutDX::OpenBridge - sender adapter not found");
+		return nullptr;
+	}
+
+	// Create a device on the sender adapter
+	IDXGIAdapter* pCurrentAdapter = spoutdx.GetAdapterPointer();
+	IDXGIAdapter* pAdapter = spoutdx.GetAdapterPointer(senderindex);
+	if (pAdapter) {
+		spoutdx.SetAdapterPointer(pAdapter);
+		m_pBridgeDevice = spoutdx.CreateDX11device();
+		pAdapter->Release();
+	}
+	spoutdx.SetAdapterPointer(pCurrentAdapter);
+	if (!m_pBridgeDevice) {
+		SpoutLogWarning("spoutDX::OpenBridge - could not create device for adapter %d", senderindex);
+		return nullptr;
+	}
+	m_pBridgeDevice->GetImmediateContext(&m_pBridgeContext);
+
+	// Open the sender texture with the bridge device
+	if (!spoutdx.OpenDX11shareHandle(m_pBridgeDevice, &m_pBridgeShared, dxShareHandle)) {
+		SpoutLogWarning("spoutDX::OpenBridge - could not open sender texture on adapter %d", senderindex);
+		CloseBridge();
+		return nullptr;
+	}
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	m_pBridgeShared->GetDesc(&desc);
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		if (!spoutdx.CreateDX11StagingTexture(m_pBridgeDevice, desc.Width, desc.Height, desc.Format, &m_pBridgeStaging[i])) {
+			CloseBridge();
+			return nullptr;
+		}
+	}
+
+	// Texture on the receiving device updated from the staging textures
+	ID3D11Texture2D* pTexture = nullptr;
+	if (!spoutdx.CreateDX11Texture(m_pd3dDevice, desc.Width, desc.Height, desc.Format, &pTexture)) {
+		CloseBridge();
+		return nullptr;
+	}
+
+	// Independent of the receiver mutex lock and frame count
+	// The receiver records the telemetry for the sender
+	m_BridgeFrame.CreateAccessMutex(sendername);
+	m_BridgeFrame.EnableTelemetry(false);
+	m_BridgeFrame.EnableFrameCount(sendername);
+
+	SpoutLogNotice("spoutDX::OpenBridge - %s (%dx%d) from adapter %d", sendername, desc.Width, desc.Height, senderindex);
+
+	return pTexture;
+}
+
+//---------------------------------------------------------
+// Close the adapter bridge.
+// The texture returned by OpenBridge is released with the sender texture.
+void spoutDX::CloseBridge()
+{
+	if (!m_pBridgeDevice)
+		return;
+
+	m_BridgeFrame.CloseAccessMutex();
+	m_BridgeFrame.CleanupFrameCount();
+
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		if (m_pBridgeStaging[i]) m_pBridgeStaging[i]->Release();
+		m_pBridgeStaging[i] = nullptr;
+		m_BridgeCopy[i] = 0;
+	}
+	m_BridgeCount = 0;
+	m_BridgeNext = 0;
+	if (m_pBridgeShared) m_pBridgeShared->Release();
+	m_pBridgeShared = nullptr;
+	if (m_pBridgeContext) {
+		m_pBridgeContext->Flush();
+		m_pBridgeContext->Release();
+	}
+	m_pBridgeContext = nullptr;
+	m_pBridgeDevice->Release();
+	m_pBridgeDevice = nullptr;
+}
+
+//---------------------------------------------------------
+// Copy a new sender frame to the next bridge staging texture and copy
+// the last staging texture completed to the receiving device texture.
+// If the sender has not produced a new frame, the last copy is waited for
+// so that it is received after the sender stops.
+void spoutDX::UpdateBridge()
+{
+	if (!m_pBridgeShared || !m_pSharedTexture)
+		return;
+
+	bool bNewFrame = false;
+	if (m_BridgeFrame.CheckTextureAccess(m_pBridgeShared)) {
+		if (m_BridgeFrame.GetNewFrame()) {
+			spoutdx.CopySharedTexture(m_pBridgeContext, m_pBridgeStaging[m_BridgeNext], m_pBridgeShared);
+			m_pBridgeContext->Flush();
+			m_BridgeCopy[m_BridgeNext] = ++m_BridgeCount;
+			m_BridgeNext = (m_BridgeNext + 1) % SPOUT_BRIDGE_STAGING;
+			bNewFrame = true;
+		}
+		m_BridgeFrame.AllowTextureAccess(m_pBridgeShared);
+	}
+
+	// Pending copies from the latest
+	int slots[SPOUT_BRIDGE_STAGING] = {};
+	int nPending = 0;
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		const int slot = (m_BridgeNext + SPOUT_BRIDGE_STAGING - 1 - i) % SPOUT_BRIDGE_STAGING;
+		if (m_BridgeCopy[slot] > 0)
+			slots[nPending++] = slot;
+	}
+	if (nPending == 0)
+		return;
+
+	// The latest staging texture that has completed.
+	// Without a new frame, wait for the latest.
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	int found = -1;
+	for (int i = 0; i < nPending && found < 0; i++) {
+		const UINT flags = bNewFrame ? D3D11_MAP_FLAG_DO_NOT_WAIT : 0;
+		if (SUCCEEDED(m_pBridgeContext->Map(m_pBridgeStaging[slots[i]], 0, D3D11_MAP_READ, flags, &mapped)))
+			found = slots[i];
+	}
+	if (found < 0)
+		return;
+
+	m_pImmediateContext->UpdateSubresource(m_pSharedTexture, 0, nullptr, mapped.pData, mapped.RowPitch, 0);
+	m_pBridgeContext->Unmap(m_pBridgeStaging[found], 0);
+
+	// This and earlier copies are no longer pending
+	const LONG64 copied = m_BridgeCopy[found];
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		if (m_BridgeCopy[i] <= copied)
+			m_BridgeCopy[i] = 0;
+	}
+
+	// The frame count for the sender is already read if there is no new frame
+	if (!bNewFrame)
+		frame.ResetNewFrame();
+}
+
+//
+// Sender replicas
+//
+// See AddSenderReplica
+//
+
+//---------------------------------------------------------
+// Sender create a device and shared texture on each replica adapter,
+// the staging textures for read back and the replica information map.
+// The adapter of the sender device is skipped.
+bool spoutDX::CreateReplicas(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	ReleaseReplicas();
+
+	if (m_nReplicaAdapters == 0 || !m_pd3dDevice || !m_SenderName[0] || width == 0 || height == 0)
+		return false;
+
+	LUID senderluid={};
+	spoutdx.GetDeviceAdapterLuid(m_pd3dDevice, senderluid);
+
+	SharedTextureReplica replicas[SPOUT_MAX_REPLICAS]={};
+	IDXGIAdapter* pCurrentAdapter = spoutdx.GetAdapterPointer();
+	for (int i = 0; i < m_nReplicaAdapters; i++) {
+
+		// Create a device on the replica adapter
+		ID3D11Device* pDevice = nullptr;
+		IDXGIAdapter* pAdapter = spoutdx.GetAdapterPointer(m_ReplicaAdapter[i]);
+		if (pAdapter) {
+			spoutdx.SetAdapterPointer(pAdapter);
+			pDevice = spoutdx.CreateDX11device();
+			pAdapter->Release();
+		}
+		spoutdx.SetAdapterPointer(pCurrentAdapter);
+		if (!pDevice) {
+			SpoutLogWarning("spoutDX::CreateReplicas - could not create device for adapter %d", m_ReplicaAdapter[i]);
+			continue;
+		}
+
+		LUID luid={};
+		spoutdx.GetDeviceAdapterLuid(pDevice, luid);
+		if (luid.LowPart == senderluid.LowPart && luid.HighPart == senderluid.HighPart) {
+			// Receivers on the sender adapter open the sender texture
+			pDevice->Release();
+			continue;
+		}
+
+		HANDLE hShare = nullptr;
+		ID3D11Texture2D* pTexture = nullptr;
+		if (!spoutdx.CreateSharedDX11Texture(pDevice, width, height, (DXGI_FORMAT)dwFormat, &pTexture, hShare)) {
+			SpoutLogWarning("spoutDX::CreateReplicas - could not create texture on adapter %d", m_ReplicaAdapter[i]);
+			pDevice->Release();
+			continue;
+		}
+
+		m_pReplicaDevice[m_nReplicas] = pDevice;
+		pDevice->GetImmediateContext(&m_pReplicaContext[m_nReplicas]);
+		m_pReplicaTexture[m_nReplicas] = pTexture;
+
+		replicas[m_nReplicas].adapter = luid;
+		replicas[m_nReplicas].shareHandle = (uint32_t)HandleToLong(hShare);
+		replicas[m_nReplicas].width  = width;
+		replicas[m_nReplicas].height = height;
+		replicas[m_nReplicas].format = dwFormat;
+		m_nReplicas++;
+	}
+
+	if (m_nReplicas == 0)
+		return false;
+
+	// Staging textures on the sender device
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pReplicaStaging[i])) {
+			ReleaseReplicas();
+			return false;
+		}
+	}
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutReplicas";
+	if (m_ReplicaMemory.Create(mapname.c_str(), (int)sizeof(replicas)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreateReplicas - could not create replica map");
+		ReleaseReplicas();
+		return false;
+	}
+	char* pBuf = m_ReplicaMemory.Lock();
+	if (!pBuf) {
+		ReleaseReplicas();
+		return false;
+	}
+	memcpy(pBuf, replicas, sizeof(replicas));
+	m_ReplicaMemory.Unlock();
+
+	SpoutLogNotice("spoutDX::CreateReplicas - [%s] %dx%d on %d adapters", mapname.c_str(), width, height, m_nReplicas);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Release the replica devices and textures and close the replica map
+void spoutDX::ReleaseReplicas()
+{
+	if (m_nReplicas == 0)
+		return;
+
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+		if (m_pReplicaStaging[i]) m_pReplicaStaging[i]->Release();
+		m_pReplicaStaging[i] = nullptr;
+		m_ReplicaCopy[i] = 0;
+	}
+	m_ReplicaCount = 0;
+	m_ReplicaNext = 0;
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+
+	for (int i = 0; i < m_nReplicas; i++) {
+		if (m_pReplicaTexture[i]) m_pReplicaTexture[i]->Release();
+		m_pReplicaTexture[i] = nullptr;
+		if (m_pReplicaContext[i]) {
+			m_pReplicaContext[i]->Flush();
+			m_pReplicaContext[i]->Release();
+		}
+		m_pReplicaContext[i] = nullptr;
+		if (m_pReplicaDevice[i]) m_pReplicaDevice[i]->Release();
+		m_pReplicaDevice[i] = nullptr;
+	}
+	m_nReplicas = 0;
+
+	m_ReplicaMemory.Close();
+}
+
+//---------------------------------------------------------
+// Sender update the replicas from the last staging texture completed
+// and copy the new frame to the next staging texture.
+// Called within the sender mutex lock before the sender texture is flushed,
+// so that receivers of a replica use the sender mutex and frame count.
+// Neither the sender nor the replica devices wait for the read back.
+bool spoutDX::WriteReplicas(ID3D11Texture2D* pTexture)
+{
+	if (m_nReplicas == 0 || !pTexture || !m_pImmediateContext)
+		return false;
+
+	// The latest staging texture that has completed
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	int found = -1;
+	for (int i = 0; i < SPOUT_BRIDGE_STAGING && found < 0; i++) {
+		const int slot = (m_ReplicaNext + SPOUT_BRIDGE_STAGING - 1 - i) % SPOUT_BRIDGE_STAGING;
+		if (m_ReplicaCopy[slot] > 0
+			&& SUCCEEDED(m_pImmediateContext->Map(m_pReplicaStaging[slot], 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+			found = slot;
+	}
+
+	if (found >= 0) {
+		// Update every replica from the same read back
+		SharedTextureReplica* pReplicas = reinterpret_cast<SharedTextureReplica*>(m_ReplicaMemory.Buffer());
+		for (int i = 0; i < m_nReplicas; i++) {
+			m_pReplicaContext[i]->UpdateSubresource(m_pReplicaTexture[i], 0, nullptr, mapped.pData, mapped.RowPitch, 0);
+			// Flush because the shared texture has been updated on this device
+			m_pReplicaContext[i]->Flush();
+			if (pReplicas)
+				InterlockedIncrement64(&pReplicas[i].frame);
+		}
+		m_pImmediateContext->Unmap(m_pReplicaStaging[found], 0);
+
+		// This and earlier copies are no longer pending
+		const LONG64 copied = m_ReplicaCopy[found];
+		for (int i = 0; i < SPOUT_BRIDGE_STAGING; i++) {
+			if (m_ReplicaCopy[i] <= copied)
+				m_ReplicaCopy[i] = 0;
+		}
+	}
+
+	// Copy the new frame (the top level of a mip chain) to the next staging texture
+	m_pImmediateContext->CopySubresourceRegion(m_pReplicaStaging[m_ReplicaNext], 0, 0, 0, 0, pTexture, 0, nullptr);
+	m_ReplicaCopy[m_ReplicaNext] = ++m_ReplicaCount;
+	m_ReplicaNext = (m_ReplicaNext + 1) % SPOUT_BRIDGE_STAGING;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Receiver open the replica of a sender texture on the adapter of the receiving device.
+// Return the replica texture to use in place of the sender texture.
+ID3D11Texture2D* spoutDX::OpenReplica(const char* sendername)
+{
+	if (!sendername || !*sendername || !m_pd3dDevice)
+		return nullptr;
+
+	std::string mapname = sendername;
+	mapname += "_SpoutReplicas";
+	// No warning if the sender does not keep replicas
+	SpoutSharedMemory replicamemory;
+	if (!replicamemory.Open(mapname.c_str()))
+		return nullptr;
+
+	SharedTextureReplica replicas[SPOUT_MAX_REPLICAS]={};
+	char* pBuf = replicamemory.Lock();
+	if (pBuf) {
+		memcpy(replicas, pBuf, sizeof(replicas));
+		replicamemory.Unlock();
+	}
+	replicamemory.Close();
+
+	LUID luid={};
+	if (!spoutdx.GetDeviceAdapterLuid(m_pd3dDevice, luid))
+		return nullptr;
+
+	for (int i = 0; i < SPOUT_MAX_REPLICAS; i++) {
+		if (replicas[i].shareHandle == 0
+			|| replicas[i].adapter.LowPart != luid.LowPart
+			|| replicas[i].adapter.HighPart != luid.HighPart)
+			continue;
+		ID3D11Texture2D* pTexture = nullptr;
+		if (spoutdx.OpenDX11shareHandle(m_pd3dDevice, &pTexture, LongToHandle((long)replicas[i].shareHandle))) {
+			SpoutLogNotice("spoutDX::OpenReplica - %s (%dx%d) replica on this adapter", sendername, replicas[i].width, replicas[i].height);
+			return pTexture;
+		}
+		SpoutLogWarning("spoutDX::OpenReplica - could not open replica texture");
+	}
+
+	return nullptr;
+}
+
+//---------------------------------------------------------
+// Idle receive test (SetIdleReceive).
+// True if connected and the sender has no new frame and
+// no sender has been created, updated or closed.
+bool spoutDX::IsReceiverIdle()
+{
+	if (!m_bIdleReceive || !m_bConnected || !m_pSharedTexture)
+		return false;
+
+	const LONG generation = sendernames.GetSenderGeneration();
+	if (generation != m_IdleGeneration) {
+		m_IdleGeneration = generation;
+		return false;
+	}
+
+	return !frame.WaitNewFrame(m_dwIdleTimeout);
+}
+
+//---------------------------------------------------------
+//	o Connect to a sender and inform the application to update texture dimensions
+//	o Check for user sender selection
+//  o Receive texture details from the sender for write to the user texture
+//  o Retrieve width, height, format, share handle and texture pointer
+bool spoutDX::ReceiveSenderData()
+{
+	m_bUpdated = false;
+	
+	// Make sure DirectX is initialized
+	if (!OpenDirectX11())
+		return false;
+
+	// Start the pre-connect thread if enabled
+	if (m_bPreconnect && !spoutdx.IsPreopen())
+		spoutdx.StartPreopen(m_pd3dDevice, m_SenderNameSetup);
+
+	// Release retained sender textures of senders that have closed
+	if (spoutdx.GetSharedTextureCount() > 0) {
+		const LONG generation = sendernames.GetSenderGeneration();
+		if (generation != m_SharedGeneration) {
+			m_SharedGeneration = generation;
+			spoutdx.CheckSharedTextures(sendernames);
+		}
+	}
+
+	// Without a sender, look for one only if a sender has been created,
+	// updated or closed, or at intervals for senders of earlier versions.
+	// This avoids opening the sender maps every frame while waiting.
+	if (!m_bSenderFound && !IsSenderSelected()
+		&& !sendernames.CheckSenderChange(m_SenderGeneration, m_dwSenderCheck))
+		return false;
+
+	// For a connected sender, read the sender information again only if
+	// the sender has changed it, any sender has been created, updated
+	// or closed, or at intervals in case the sender process has closed.
+	// Otherwise the test is two integer reads without opening a map.
+	if (m_bSenderFound && m_bSpoutInitialized && !IsSenderSelected()
+		&& !sendernames.CheckSenderInfoChange(m_SenderName, m_SenderInfoChange,
+			m_SenderInfoGeneration, m_dwSenderInfoCheck)) {
+		if (m_pBridgeShared)
+			UpdateBridge();
+		CheckTelemetryMemory();
+		return true;
+	}
+	m_bSenderFound = false;
+
+	// Initialization is recorded in this class for sender or receiver
+	// m_Width or m_Height are established when the receiver connects to a sender
+	char sendername[256]={};
+	strcpy_s(sendername, 256, m_SenderName);
+
+	// Check the entered Sender name to see if it exists
+	if (sendername[0] == 0) {
+		// Passed name was null, so find the active sender
+		if (!GetActiveSender(sendername))
+			return false; // No sender
+	}
+
+	// If SpoutPanel has been opened, the active sender name could be different
+	if (CheckSpoutPanel(sendername, 256)) {
+		// Disable the setup name
+		m_SenderNameSetup[0] = 0;
+	}
+
+	// Now we have either an existing sender name or the active sender name
+
+	// Save current sender name and dimensions to test for change
+	unsigned int width = m_Width;
+	unsigned int height = m_Height;
+	DWORD dwFormat = m_dwFormat;
+	HANDLE dxShareHandle = m_dxShareHandle;
+
+	// Try to get the sender shared memory information.
+	// Retrieve width, height, sharehandle and format.
+	SharedTextureInfo info={};
+	if (sendernames.getSharedInfo(sendername, &info)) {
+
+		m_bSenderFound = true;
+
+		// Memory share mode not supported (no texture share handle)
+		if (info.shareHandle == 0) {
+			ReleaseReceiver();
+			return false;
+		}
+
+		width  = info.width;
+		height = info.height;
+		dxShareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
+		dwFormat = info.format;
+
+		// For DX9 sender formats, use a compatible DX11 format
+		// 21 =	D3DFMT_A8R8G8B8
+		// 22 = D3DFMT_X8R8G8B8
+		if (dwFormat == 21 || dwFormat == 22) {
+			dwFormat = (DWORD)DXGI_FORMAT_B8G8R8A8_UNORM;
+		}
+
+		// The shared texture handle will be different
+		//   o for a new sender
+		//   o for texture size or format change
+		// Sub-senders of an atlas sender have the same handle
+		// but a different name or size
+		if (dxShareHandle != m_dxShareHandle
+			|| (m_bSpoutInitialized && (strcmp(sendername, m_SenderName) != 0
+				|| width != m_Width || height != m_Height))) {
+
+			/*
+			printf("\nReceiveSenderData : %s \n", sendername);
+			printf("     Width     : %d\n", info.width);
+			printf("     Height    : %d\n", info.height);
+			printf("     Format    : %d (0x%X)\n", info.format, info.format);
+			printf("     handle    : 0x%X\n", info.shareHandle);
+			printf("     Usage     : %d (0x%X)\n", info.usage, info.usage);
+			printf("     Description : [%s]\n", (char*)info.description);
+			printf("     PartnerId : 0x%X\n", info.partnerId);
+			*/
+
+			// Release everything and start again
+			ReleaseReceiver();
+
+			// Update the sender share handle
+			m_dxShareHandle = dxShareHandle;
+
+			// Get a new shared texture pointer (m_pSharedTexture)
+			// A texture opened before for the sender is used without OpenSharedResource
+			// A texture shared by a named NT handle is opened by name
+			const bool bNThandle = ((info.usage & SPOUT_USAGE_NTHANDLE) != 0);
+			if (!spoutdx.OpenSharedTexture(m_pd3dDevice, &m_pSharedTexture, dxShareHandle, sendername, bNThandle)) {
+
+				// If this fails, the sender graphics adapter might be different
+				SpoutLogWarning("SpoutReceiver::ReceiveSenderData - could not retrieve sender texture from share handle");
+
+				// If a device has been created within this class, we can re-create it
+				// on the fly using a different graphics adapter if auto adapter switching 
+				// has been activated with SetAdapterAuto()
+				// The adapter test and bridge open a legacy share handle.
+				// A replica of the sender texture on this adapter is used first.
+				ID3D11Texture2D* pTexture = OpenReplica(sendername);
+				if (!pTexture && m_bClassDevice && m_bAdapt && !bNThandle) {
+					// Test to find the sender adapter.
+					// If different, switch to it and retrieve the shared texture pointer.
+					pTexture = CheckSenderTexture(sendername, dxShareHandle);
+					// CheckSenderTexture will re-create the class D3D11 device using the sender's adapter
+				}
+				// Otherwise copy from the sender adapter if the adapter bridge is enabled
+				if (!pTexture && m_bBridge && !bNThandle)
+					pTexture = OpenBridge(sendername, dxShareHandle);
+				if (!pTexture) {
+					// If that failed, retain the share handle (m_dxShareHandle) 
+					// so we don't query it again. The texture pointer (m_pSharedTexture)
+					// is null but will not be used. Return true and wait until another
+					// sender is selected or the shared texture handle is valid.
+					return true;
+				}
+				// Use the replica or the new sender texture pointer retrieved by
+				// CheckSenderTexture or the texture updated by the adapter bridge
+				m_pSharedTexture = pTexture;
+
+			}
+
+			// Get the texture details to check for zero size
+			D3D11_TEXTURE2D_DESC desc;
+			ZeroMemory(&desc, sizeof(desc));
+			m_pSharedTexture->GetDesc(&desc);
+			if (desc.Width == 0 || desc.Height == 0)
+				return false;
+
+			// Number of views of an array texture sender
+			m_ArraySize = (desc.ArraySize > 1) ? desc.ArraySize : 1;
+			// Mip levels of the sender texture
+			m_MipLevels = (desc.MipLevels > 1) ? desc.MipLevels : 1;
+
+			// For incorrect sender information, use the format
+			// of the D3D11 texture generated by OpenDX11shareHandle
+			if (dwFormat != (DWORD)desc.Format)
+				dwFormat = (DWORD)desc.Format;
+
+			// Initialize again with the newly connected sender values
+			CreateReceiver(sendername, width, height, dwFormat);
+
+			// Return to update the receiving texture or image
+			// If the graphics adapter was changed, the class device will be different
+			// and the texture returned will have been created using that device.
+			m_bUpdated = true;
+
+		}
+
+		// Connected and intialized
+		// Sender name, width, height, format, texture pointer and share handle have been retrieved
+
+		// Copy from the sender adapter if the adapter bridge is open
+		if (m_pBridgeShared)
+			UpdateBridge();
+
+		// Memory held by the receiver for telemetry
+		CheckTelemetryMemory();
+
+		// The application can now access and copy the sender texture
+		return true;
+
+		//
+		// ===================================================
+		
+
+	} // end find sender
+
+	// There is no sender or the connected sender closed
+	spoutdx.EvictSharedTexture(sendername);
+	return false;
+
+}
+
+// Create receiver resources for a new sender
+void spoutDX::CreateReceiver(const char * SenderName, unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	SpoutLogNotice("CreateReceiver(%s) %d x %d : format %d", SenderName, width, height, dwFormat);
+
+	if (m_bSpoutInitialized)
+		ReleaseReceiver();
+
+	// A sub-sender of an atlas sender uses the atlas mutex and frame count
+	char atlasname[256]={};
+	const char* syncname = SenderName;
+	if (OpenAtlasRegion(SenderName, atlasname, 256)) {
+		syncname = atlasname;
+		// The region has one view and level
+		m_ArraySize = 1;
+		m_MipLevels = 1;
+	}
+
+	// Create a named sender mutex for access to the sender's shared texture
+	frame.CreateAccessMutex(syncname);
+
+	// Open the sender's shared fence if the option is enabled
+	// The access mutex is used if the sender has not created a fence
+	if (frame.IsFenceSyncEnabled())
+		frame.OpenSharedFence(syncname, m_pd3dDevice);
+
+	// Open the sender's ring textures if it has created them
+	OpenTextureRing(SenderName);
+
+	// Open the sender's preview texture if it has created one
+	OpenPreview(SenderName);
+
+	// Open the sender's YUV texture if it has created one
+	OpenYUV(SenderName);
+
+	// Enable frame counting to get the sender frame number and fps
+	frame.EnableFrameCount(syncname);
+
+	// Register to acknowledge frames for a sender that waits
+	if (m_bFrameAck)
+		frame.RegisterFrameAck(syncname);
+
+	// Set class globals
+	strcpy_s(m_SenderName, 256, SenderName);
+	m_Width = width;
+	m_Height = height;
+	m_dwFormat = dwFormat;
+
+	m_bSpoutInitialized = true;
+
+}
+
+//
+// Shared texture ring
+//
+// See SetTextureRing
+//
+
+// Sender create ring textures and the ring information map
+bool spoutDX::CreateTextureRing(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	ReleaseTextureRing();
+
+	if (m_nRing < 2 || !m_pd3dDevice || !m_SenderName[0])
+		return false;
+
+	SharedTextureRing ring={};
+	ring.count  = (uint32_t)m_nRing;
+	ring.width  = width;
+	ring.height = height;
+	ring.format = dwFormat;
+	// Each texture has a keyed mutex for the sender and receivers
+	ring.flags  = SPOUT_RING_KEYED;
+	for (int i = 0; i < m_nRing; i++) {
+		HANDLE hShare = nullptr;
+		if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pRingTexture[i], hShare, true)
+			|| FAILED(m_pRingTexture[i]->QueryInterface(__uuidof(IDXGIKeyedMutex), (void**)&m_pRingMutex[i]))) {
+			SpoutLogWarning("spoutDX::CreateTextureRing - could not create ring texture %d", i);
+			ReleaseTextureRing();
+			return false;
+		}
+		ring.shareHandle[i] = (uint32_t)HandleToLong(hShare);
+	}
+	// The first texture written will be index 0
+	ring.index = m_nRing-1;
+	// Receivers read frames in order for a send queue
+	ring.ordered = (m_SendPolicy == SPOUT_SEND_QUEUE) ? 1 : 0;
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutRing";
+	if (m_RingMemory.Create(mapname.c_str(), (int)sizeof(SharedTextureRing)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreateTextureRing - could not create ring map");
+		ReleaseTextureRing();
+		return false;
+	}
+	char* pBuf = m_RingMemory.Lock();
+	if (!pBuf) {
+		ReleaseTextureRing();
+		return false;
+	}
+	memcpy(pBuf, &ring, sizeof(SharedTextureRing));
+	m_RingMemory.Unlock();
+
+	m_nRingOpen = m_nRing;
+
+	SpoutLogNotice("spoutDX::CreateTextureRing - [%s] %d textures %dx%d", mapname.c_str(), m_nRing, width, height);
+
+	return true;
+}
+
+// Receiver open the sender's ring textures if the sender has created them
+bool spoutDX::OpenTextureRing(const char* sendername)
+{
+	ReleaseTextureRing();
+
+	if (!sendername || !*sendername || !m_pd3dDevice)
+		return false;
+
+	std::string mapname = sendername;
+	mapname += "_SpoutRing";
+	// No warning if the sender does not use a ring
+	if (!m_RingMemory.Open(mapname.c_str()))
+		return false;
+
+	SharedTextureRing ring={};
+	char* pBuf = m_RingMemory.Lock();
+	if (pBuf) {
+		memcpy(&ring, pBuf, sizeof(SharedTextureRing));
+		m_RingMemory.Unlock();
+	}
+
+	if (ring.count < 2 || ring.count > 4) {
+		m_RingMemory.Close();
+		return false;
+	}
+
+	for (int i = 0; i < (int)ring.count; i++) {
+		bool bOpen = false;
+		if (ring.flags & SPOUT_RING_NTNAME) {
+			// Named NT handle of a D3D12 sender
+			char sharename[256]={};
+			sprintf_s(sharename, 256, "%s_SpoutRing_%u", sendername, ring.shareHandle[i]);
+			bOpen = spoutdx.OpenDX11shareName(m_pd3dDevice, &m_pRingTexture[i], sharename);
+		}
+		else {
+			HANDLE hShare = (HANDLE)(LongToHandle((long)ring.shareHandle[i]));
+			bOpen = spoutdx.OpenDX11shareHandle(m_pd3dDevice, &m_pRingTexture[i], hShare);
+		}
+		// Keyed mutex of a D3D11 sender ring texture
+		if (bOpen && (ring.flags & SPOUT_RING_KEYED))
+			bOpen = SUCCEEDED(m_pRingTexture[i]->QueryInterface(__uuidof(IDXGIKeyedMutex), (void**)&m_pRingMutex[i]));
+		if (!bOpen) {
+			SpoutLogWarning("spoutDX::OpenTextureRing - could not open ring texture %d", i);
+			ReleaseTextureRing();
+			return false;
+		}
+	}
+
+	// A D3D12 sender signals a fence when each texture is written
+	if ((ring.flags & SPOUT_RING_FENCE) && !OpenRingFence(ring)) {
+		ReleaseTextureRing();
+		return false;
+	}
+
+	m_nRingOpen = (int)ring.count;
+	m_RingFrame = 0;
+	m_bRingOrdered = (ring.ordered != 0);
+
+	SpoutLogNotice("spoutDX::OpenTextureRing - [%s] %d textures", mapname.c_str(), m_nRingOpen);
+
+	return true;
+}
+
+// Receiver open the fence of a D3D12 sender ring.
+// The sender's NT handle is duplicated into this process.
+bool spoutDX::OpenRingFence(const SharedTextureRing &ring)
+{
+	if (ring.processId == 0 || ring.fenceHandle == 0)
+		return false;
+
+	HANDLE hFence = NULL;
+	HANDLE hProcess = OpenProcess(PROCESS_DUP_HANDLE, FALSE, ring.processId);
+	if (hProcess) {
+		DuplicateHandle(hProcess, (HANDLE)(ULONG_PTR)ring.fenceHandle,
+			GetCurrentProcess(), &hFence, 0, FALSE, DUPLICATE_SAME_ACCESS);
+		CloseHandle(hProcess);
+	}
+	if (!hFence) {
+		SpoutLogWarning("spoutDX::OpenRingFence - could not duplicate fence handle (%lu)", GetLastError());
+		return false;
+	}
+
+	ID3D11Device5* pDevice5 = nullptr;
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (SUCCEEDED(hr)) {
+		hr = pDevice5->OpenSharedFence(hFence, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pRingFence));
+		pDevice5->Release();
+	}
+	// The device has its own reference after OpenSharedFence
+	CloseHandle(hFence);
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pRingContext));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::OpenRingFence - could not open fence (0x%.7X)", (unsigned int)hr);
+		if (m_pRingFence) m_pRingFence->Release();
+		m_pRingFence = nullptr;
+		m_pRingContext = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+// Release ring textures and close the ring information map
+void spoutDX::ReleaseTextureRing()
+{
+	if (m_nRingOpen == 0 && !m_pRingTexture[0])
+		return;
+
+	for (int i = 0; i < 4; i++) {
+		if (m_pRingMutex[i]) m_pRingMutex[i]->Release();
+		m_pRingMutex[i] = nullptr;
+		if (m_pRingTexture[i]) m_pRingTexture[i]->Release();
+		m_pRingTexture[i] = nullptr;
+	}
+	if (m_pRingContext) m_pRingContext->Release();
+	if (m_pRingFence) m_pRingFence->Release();
+	m_pRingContext = nullptr;
+	m_pRingFence = nullptr;
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+	m_RingMemory.Close();
+	m_nRingOpen = 0;
+	m_RingFrame = 0;
+	m_bRingOrdered = false;
+}
+
+// Sender write to the next texture of the ring and publish the index
+bool spoutDX::WriteTextureRing(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion)
+{
+	if (m_nRing < 2 || m_nRingOpen < 2 || !pTexture || !m_pImmediateContext)
+		return false;
+
+	SharedTextureRing* pRing = reinterpret_cast<SharedTextureRing*>(m_RingMemory.Buffer());
+	if (!pRing)
+		return false;
+
+	// Wait until registered receivers have read the frame to be overwritten
+	const LONG64 ringframe = pRing->frame + 1;
+	if (m_SendPolicy == SPOUT_SEND_QUEUE && ringframe > m_nRingOpen
+		&& !frame.WaitFrameAck(ringframe - m_nRingOpen, m_dwSendTimeout))
+		m_SendOverrun++;
+
+	// Receivers read the last texture written, so write to the next one
+	const LONG index = (pRing->index + 1) % m_nRingOpen;
+
+	// Wait for a receiver that is still copying from the texture.
+	// The frame is not written to the ring if the wait times out.
+	IDXGIKeyedMutex* pMutex = m_pRingMutex[index];
+	if (pMutex && pMutex->AcquireSync(0, frame.GetAccessTimeout()) != S_OK) {
+		m_SendDropped++;
+		return false;
+	}
+
+	if (pSourceRegion)
+		m_pImmediateContext->CopySubresourceRegion(m_pRingTexture[index], 0, 0, 0, 0, pTexture, 0, pSourceRegion);
+	else
+		m_pImmediateContext->CopyResource(m_pRingTexture[index], pTexture);
+
+	// Receivers can copy when the GPU has written the texture
+	if (pMutex)
+		pMutex->ReleaseSync(0);
+
+	// Flush because the shared texture has been updated on this device
+	m_pImmediateContext->Flush();
+
+	// Publish the index after the copy has been submitted
+	InterlockedExchange(&pRing->index, index);
+	InterlockedIncrement64(&pRing->frame);
+
+	return true;
+}
+
+// Receiver copy from the last texture written by the sender without locking
+bool spoutDX::ReadTextureRing(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion)
+{
+	if (m_nRingOpen < 2 || !pTexture || !m_pImmediateContext)
+		return false;
+
+	SharedTextureRing* pRing = reinterpret_cast<SharedTextureRing*>(m_RingMemory.Buffer());
+	if (!pRing)
+		return false;
+
+	// Update the frame count for the receiver
+	frame.GetNewFrame();
+
+	// Copy only if the sender has written a new frame
+	const LONG64 ringframe = InterlockedCompareExchange64(&pRing->frame, 0, 0);
+	if (ringframe == m_RingFrame)
+		return true;
+
+	// The sender re-creates the ring before it updates the sender
+	// information, so the ring can have no frames, fewer frames than
+	// have been read or a different size. The shared texture is received
+	// until the receiver opens the ring again for the updated sender.
+	if (ringframe <= 0 || ringframe < m_RingFrame
+		|| pRing->width != m_Width || pRing->height != m_Height) {
+		m_RingFrame = 0;
+		frame.ResetNewFrame();
+		return false;
+	}
+
+	// Frames of a send queue are read in order while they are in the ring.
+	// Otherwise, or if frames have been overwritten, read the last written.
+	// The texture of each frame follows from the frame number.
+	LONG64 readframe = ringframe;
+	if (m_bRingOrdered && m_RingFrame > 0 && ringframe - m_RingFrame < m_nRingOpen)
+		readframe = m_RingFrame + 1;
+
+	for (int attempt = 0; attempt < 2; attempt++) {
+
+		const LONG index = (LONG)((readframe - 1) % m_nRingOpen);
+		if (index < 0 || index >= m_nRingOpen) {
+			frame.ResetNewFrame();
+			return false;
+		}
+
+		// The keyed mutex of a D3D11 sender ring texture prevents the sender
+		// writing to it until the copy is complete. If the sender is writing
+		// to it now, the sender shared texture is received instead.
+		IDXGIKeyedMutex* pMutex = m_pRingMutex[index];
+		if (pMutex && pMutex->AcquireSync(0, 0) != S_OK) {
+			frame.ResetNewFrame();
+			return false;
+		}
+
+		// The copy waits on the GPU until a D3D12 sender has written the frame
+		if (m_pRingFence)
+			m_pRingContext->Wait(m_pRingFence, (UINT64)readframe);
+
+		if (pSourceRegion)
+			m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, 0, 0, m_pRingTexture[index], 0, pSourceRegion);
+		else
+			m_pImmediateContext->CopyResource(pTexture, m_pRingTexture[index]);
+
+		if (pMutex) {
+			pMutex->ReleaseSync(0);
+			break;
+		}
+
+		// Without a keyed mutex, the sender can write to the texture again
+		// once it has gone round the ring. If it has nearly done so by now,
+		// the copy could be torn, so copy again from the last frame written.
+		// The second copy replaces the first on the GPU.
+		const LONG64 lastframe = InterlockedCompareExchange64(&pRing->frame, 0, 0);
+		if (lastframe - readframe < m_nRingOpen - 1)
+			break;
+		readframe = lastframe;
+	}
+	m_pImmediateContext->Flush();
+	m_RingFrame = readframe;
+
+	// The sender can overwrite the frame (SetFrameAck)
+	if (m_bFrameAck)
+		frame.AckFrame(readframe);
+
+	return true;
+}
+
+// Region of the sender texture for receive
+// Returns false if the region is empty or not within the texture
+bool spoutDX::GetSourceRegion(unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height, D3D11_BOX &region)
+{
+	if (width == 0 || height == 0
+		|| xoffset >= m_Width || yoffset >= m_Height
+		|| width > m_Width - xoffset || height > m_Height - yoffset) {
+		SpoutLogWarning("spoutDX::GetSourceRegion - region %d, %d, %dx%d is not within %dx%d",
+			xoffset, yoffset, width, height, m_Width, m_Height);
+		return false;
+	}
+	region.left   = xoffset;
+	region.right  = xoffset+width;
+	region.top    = yoffset;
+	region.bottom = yoffset+height;
+	region.front  = 0;
+	region.back   = 1;
+	// Offset within the texture of an atlas sender
+	if (m_bAtlasRegion) {
+		region.left   += m_AtlasRegion.left;
+		region.right  += m_AtlasRegion.left;
+		region.top    += m_AtlasRegion.top;
+		region.bottom += m_AtlasRegion.top;
+	}
+	return true;
+}
+
+//
+// Atlas sub-senders
+//
+// See AddAtlasSender
+//
+
+// Sender register a sub-sender with the atlas texture and save the region map
+bool spoutDX::CreateAtlasSender(int index)
+{
+	if (index < 0 || index >= SPOUT_ATLAS_SENDERS || !m_AtlasSender[index].name[0]
+		|| !m_bSpoutInitialized || !m_dxShareHandle)
+		return false;
+
+	// The texture name of a named NT handle is derived from the atlas sender name
+	if (m_hNThandle) {
+		SpoutLogWarning("spoutDX::CreateAtlasSender - [%s] not available for a sender texture shared by NT handle", m_AtlasSender[index].name);
+		return false;
+	}
+
+	SpoutAtlasSender& atlas = m_AtlasSender[index];
+	const D3D11_BOX& box = atlas.region;
+
+	// The region must be within the sender texture
+	if (box.right > m_Width || box.bottom > m_Height) {
+		SpoutLogWarning("spoutDX::CreateAtlasSender - [%s] region %d, %d, %dx%d is not within %dx%d",
+			atlas.name, box.left, box.top, box.right-box.left, box.bottom-box.top, m_Width, m_Height);
+		ReleaseAtlasSender(index);
+		return false;
+	}
+
+	// Save the region before the sub-sender is registered
+	// so that it is available when receivers connect
+	SharedAtlasRegion region={};
+	strcpy_s((char*)region.atlas, 256, m_SenderName);
+	region.x      = box.left;
+	region.y      = box.top;
+	region.width  = box.right-box.left;
+	region.height = box.bottom-box.top;
+
+	std::string mapname = atlas.name;
+	mapname += "_SpoutAtlas";
+	if (!m_AtlasMemory[index].Buffer()
+		&& m_AtlasMemory[index].Create(mapname.c_str(), (int)sizeof(SharedAtlasRegion)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreateAtlasSender - could not create atlas map [%s]", mapname.c_str());
+		return false;
+	}
+	char* pBuf = m_AtlasMemory[index].Lock();
+	if (!pBuf) {
+		ReleaseAtlasSender(index);
+		return false;
+	}
+	memcpy(pBuf, &region, sizeof(SharedAtlasRegion));
+	m_AtlasMemory[index].Unlock();
+
+	// Register the sub-sender, or update it with a new atlas texture handle
+	if (!sendernames.CreateSender(atlas.name, region.width, region.height, m_dxShareHandle, m_dwFormat)) {
+		SpoutLogWarning("spoutDX::CreateAtlasSender - could not create sender [%s]", atlas.name);
+		ReleaseAtlasSender(index);
+		return false;
+	}
+	atlas.bCreated = true;
+
+	return true;
+}
+
+// Sender copy to a snapshot texture and signal the send thread
+bool spoutDX::SendAsync(ID3D11Texture2D* pTexture)
+{
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0)
+		return false;
+
+	// Create or update the sender and the snapshot textures.
+	// The thread does not use the sender texture while it is changed.
+	AcquireSRWLockExclusive(&m_AsyncLock);
+	bool bSender = CheckSender(desc.Width, desc.Height, (DWORD)desc.Format, desc.ArraySize);
+	if (bSender)
+		bSender = CheckAsyncTextures();
+	// A snapshot not written or being copied by the thread
+	LONG index = 0;
+	while (index == m_AsyncWrite || index == m_AsyncRead)
+		index++;
+	ReleaseSRWLockExclusive(&m_AsyncLock);
+	if (!bSender)
+		return false;
+
+	if (!m_hAsyncThread && !StartAsyncSend())
+		return false;
+
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+
+	// Ring and preview textures are written without the access mutex
+	if (m_ArraySize == 1) {
+		WriteTextureRing(pTexture);
+		WritePreview(pTexture);
+	}
+
+	// The snapshot copy is queued on the immediate context
+	// before the copy to the shared texture by the thread
+	spoutdx.CopySharedTexture(m_pImmediateContext, m_pAsyncTexture[index], pTexture);
+
+	// Replace a snapshot that has not been copied
+	AcquireSRWLockExclusive(&m_AsyncLock);
+	m_AsyncWrite = index;
+	ReleaseSRWLockExclusive(&m_AsyncLock);
+	SetEvent(m_hAsyncEvent);
+
+	return true;
+}
+
+// Create snapshot textures of the sender texture size, format and views
+bool spoutDX::CheckAsyncTextures()
+{
+	if (!m_pSharedTexture)
+		return false;
+
+	D3D11_TEXTURE2D_DESC shared={};
+	m_pSharedTexture->GetDesc(&shared);
+
+	if (m_pAsyncTexture[0]) {
+		D3D11_TEXTURE2D_DESC desc={};
+		m_pAsyncTexture[0]->GetDesc(&desc);
+		if (desc.Width == shared.Width && desc.Height == shared.Height
+			&& desc.Format == shared.Format && desc.ArraySize == shared.ArraySize)
+			return true;
+	}
+
+	// Snapshots of the previous size are not copied
+	m_AsyncWrite = -1;
+	for (int i = 0; i < SPOUT_ASYNC_TEXTURES; i++) {
+		if (!spoutdx.CreateDX11Texture(m_pd3dDevice, shared.Width, shared.Height,
+			shared.Format, &m_pAsyncTexture[i], shared.ArraySize)) {
+			SpoutLogError("spoutDX::CheckAsyncTextures - could not create snapshot texture");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Start the send thread
+bool spoutDX::StartAsyncSend()
+{
+	if (!m_pImmediateContext)
+		return false;
+
+	// The immediate context is used by the application and the send thread
+	if (!m_pMultithread) {
+		if (FAILED(m_pImmediateContext->QueryInterface(__uuidof(ID3D11Multithread), (void**)&m_pMultithread))) {
+			SpoutLogError("spoutDX::StartAsyncSend - multithread protection not available");
+			m_pMultithread = nullptr;
+			return false;
+		}
+		m_pMultithread->SetMultithreadProtected(TRUE);
+	}
+
+	m_hAsyncStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	m_hAsyncEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	if (!m_hAsyncStop || !m_hAsyncEvent) {
+		SpoutLogError("spoutDX::StartAsyncSend - could not create events (%d)", GetLastError());
+		StopAsyncSend();
+		return false;
+	}
+
+	m_hAsyncThread = CreateThread(NULL, 0, AsyncSendThread, this, 0, NULL);
+	if (!m_hAsyncThread) {
+		SpoutLogError("spoutDX::StartAsyncSend - could not create thread (%d)", GetLastError());
+		StopAsyncSend();
+		return false;
+	}
+
+	SpoutLogNotice("spoutDX::StartAsyncSend (%s)", m_SenderName);
+
+	return true;
+}
+
+// Stop the send thread and release the snapshot textures
+void spoutDX::StopAsyncSend()
+{
+	if (m_hAsyncThread) {
+		SetEvent(m_hAsyncStop);
+		WaitForSingleObject(m_hAsyncThread, INFINITE);
+		CloseHandle(m_hAsyncThread);
+		m_hAsyncThread = NULL;
+		SpoutLogNotice("spoutDX::StopAsyncSend");
+	}
+	if (m_hAsyncStop) CloseHandle(m_hAsyncStop);
+	m_hAsyncStop = NULL;
+	if (m_hAsyncEvent) CloseHandle(m_hAsyncEvent);
+	m_hAsyncEvent = NULL;
+
+	for (int i = 0; i < SPOUT_ASYNC_TEXTURES; i++) {
+		if (m_pAsyncTexture[i])
+			m_pAsyncTexture[i]->Release();
+		m_pAsyncTexture[i] = nullptr;
+	}
+	m_AsyncWrite = -1;
+	m_AsyncRead = -1;
+
+	// Multithread protection remains set for the device
+	if (m_pMultithread)
+		m_pMultithread->Release();
+	m_pMultithread = nullptr;
+}
+
+DWORD WINAPI spoutDX::AsyncSendThread(LPVOID lpParameter)
+{
+	spoutDX* pThis = reinterpret_cast<spoutDX*>(lpParameter);
+	if (pThis) {
+		const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_FRAME);
+		pThis->AsyncSendLoop();
+		EndSpoutThread(SPOUT_THREAD_FRAME, hTask);
+	}
+	return 0;
+}
+
+// Wait for access and copy the last snapshot to the shared texture
+void spoutDX::AsyncSendLoop()
+{
+	HANDLE handles[2] = { m_hAsyncStop, m_hAsyncEvent };
+
+	while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0+1) {
+
+		// Take the last snapshot with the sender texture of the same size
+		AcquireSRWLockExclusive(&m_AsyncLock);
+		const LONG index = m_AsyncWrite;
+		m_AsyncWrite = -1;
+		m_AsyncRead = index;
+		ID3D11Texture2D* pSnapshot = (index >= 0) ? m_pAsyncTexture[index] : nullptr;
+		ID3D11Texture2D* pShared = m_pSharedTexture;
+		ID3D11ShaderResourceView* pSharedSRV = m_pSharedSRV;
+		if (pSnapshot) pSnapshot->AddRef();
+		if (pShared) pShared->AddRef();
+		if (pSharedSRV) pSharedSRV->AddRef();
+		ReleaseSRWLockExclusive(&m_AsyncLock);
+
+		// The wait for receivers is on this thread
+		if (pSnapshot && pShared && frame.CheckTextureAccess(pShared)) {
+			m_pMultithread->Enter();
+			spoutdx.CopySharedTexture(m_pImmediateContext, pShared, pSnapshot);
+			if (pSharedSRV)
+				m_pImmediateContext->GenerateMips(pSharedSRV);
+			m_pImmediateContext->Flush();
+			m_pMultithread->Leave();
+			frame.SetNewFrame();
+			frame.AllowTextureAccess(pShared);
+			SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+		}
+
+		if (pSnapshot) pSnapshot->Release();
+		if (pShared) pShared->Release();
+		if (pSharedSRV) pSharedSRV->Release();
+
+		AcquireSRWLockExclusive(&m_AsyncLock);
+		m_AsyncRead = -1;
+		ReleaseSRWLockExclusive(&m_AsyncLock);
+	}
+}
+
+// Sender record a send in the deferred context on the calling thread
+bool spoutDX::SendDeferred(ID3D11Texture2D* pTexture)
+{
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0)
+		return false;
+
+	AcquireSRWLockExclusive(&m_DeferredLock);
+
+	// The deferred context is created on the first send.
+	// Device functions can be used by any thread.
+	if (!m_pDeferredContext) {
+		if (FAILED(m_pd3dDevice->CreateDeferredContext(0, &m_pDeferredContext))) {
+			SpoutLogError("spoutDX::SendDeferred - could not create deferred context");
+			m_pDeferredContext = nullptr;
+			ReleaseSRWLockExclusive(&m_DeferredLock);
+			return false;
+		}
+	}
+
+	// SubmitSend creates or updates the sender on the owner thread
+	const unsigned int arraysize = (desc.ArraySize > 1) ? desc.ArraySize : 1;
+	if (!m_bSpoutInitialized || !m_pSharedTexture
+		|| desc.Width != m_Width || desc.Height != m_Height
+		|| (DWORD)desc.Format != m_dwFormat || arraysize != m_ArraySize) {
+		m_DeferredWidth = desc.Width;
+		m_DeferredHeight = desc.Height;
+		m_DeferredArraySize = arraysize;
+		m_dwDeferredFormat = (DWORD)desc.Format;
+		// A command list for the previous texture is not used
+		if (m_pCommandList) m_pCommandList->Release();
+		m_pCommandList = nullptr;
+		ReleaseSRWLockExclusive(&m_DeferredLock);
+		return true;
+	}
+
+	// Record the copy and mip chain update
+	spoutdx.CopySharedTexture(m_pDeferredContext, m_pSharedTexture, pTexture);
+	if (m_pSharedSRV)
+		m_pDeferredContext->GenerateMips(m_pSharedSRV);
+
+	// Replace a command list that has not been submitted
+	ID3D11CommandList* pCommandList = nullptr;
+	const HRESULT hr = m_pDeferredContext->FinishCommandList(FALSE, &pCommandList);
+	if (m_pCommandList) m_pCommandList->Release();
+	m_pCommandList = SUCCEEDED(hr) ? pCommandList : nullptr;
+
+	ReleaseSRWLockExclusive(&m_DeferredLock);
+
+	return SUCCEEDED(hr);
+}
+
+// Release the command list and optionally the deferred context
+void spoutDX::ReleaseDeferred(bool bContext)
+{
+	AcquireSRWLockExclusive(&m_DeferredLock);
+	if (m_pCommandList)
+		m_pCommandList->Release();
+	m_pCommandList = nullptr;
+	if (bContext && m_pDeferredContext) {
+		m_pDeferredContext->Release();
+		m_pDeferredContext = nullptr;
+	}
+	m_DeferredWidth = 0;
+	m_DeferredHeight = 0;
+	ReleaseSRWLockExclusive(&m_DeferredLock);
+}
+
+// Sender release a sub-sender name and the region map
+void spoutDX::ReleaseAtlasSender(int index)
+{
+	if (index < 0 || index >= SPOUT_ATLAS_SENDERS)
+		return;
+
+	if (m_AtlasSender[index].bCreated)
+		sendernames.ReleaseSenderName(m_AtlasSender[index].name);
+	m_AtlasSender[index].bCreated = false;
+	m_AtlasMemory[index].Close();
+}
+
+// Sender register or update all sub-senders after the atlas texture is created
+void spoutDX::UpdateAtlasSenders()
+{
+	for (int i = 0; i < SPOUT_ATLAS_SENDERS; i++) {
+		if (m_AtlasSender[i].name[0])
+			CreateAtlasSender(i);
+	}
+}
+
+// Sender release all sub-sender names. The regions are retained
+// and registered again if the sender is created again.
+void spoutDX::ReleaseAtlasSenders()
+{
+	for (int i = 0; i < SPOUT_ATLAS_SENDERS; i++)
+		ReleaseAtlasSender(i);
+}
+
+// Receiver read the region of an atlas sender if the sender is a sub-sender
+bool spoutDX::OpenAtlasRegion(const char* sendername, char* atlasname, int maxchars)
+{
+	m_bAtlasRegion = false;
+	m_AtlasRegion = {};
+
+	if (!sendername || !*sendername || !atlasname)
+		return false;
+
+	std::string mapname = sendername;
+	mapname += "_SpoutAtlas";
+	// No warning if the sender is not a sub-sender
+	SpoutSharedMemory atlasmemory;
+	if (!atlasmemory.Open(mapname.c_str()))
+		return false;
+
+	SharedAtlasRegion region={};
+	char* pBuf = atlasmemory.Lock();
+	if (!pBuf)
+		return false;
+	memcpy(&region, pBuf, sizeof(SharedAtlasRegion));
+	atlasmemory.Unlock();
+	region.atlas[255] = 0;
+
+	if (region.atlas[0] == 0 || region.width == 0 || region.height == 0)
+		return false;
+
+	strcpy_s(atlasname, maxchars, (const char*)region.atlas);
+	m_AtlasRegion.left   = region.x;
+	m_AtlasRegion.right  = region.x+region.width;
+	m_AtlasRegion.top    = region.y;
+	m_AtlasRegion.bottom = region.y+region.height;
+	m_AtlasRegion.front  = 0;
+	m_AtlasRegion.back   = 1;
+	m_bAtlasRegion = true;
+
+	SpoutLogNotice("spoutDX::OpenAtlasRegion - [%s] region %d, %d, %dx%d of [%s]",
+		sendername, region.x, region.y, region.width, region.height, atlasname);
+
+	return true;
+}
+
+// Receiver copy the sender texture, or the region of an atlas sender
+void spoutDX::CopySenderTexture(ID3D11Texture2D* pTexture)
+{
+	if (m_bAtlasRegion)
+		m_pImmediateContext->CopySubresourceRegion(pTexture, 0, 0, 0, 0, m_pSharedTexture, 0, &m_AtlasRegion);
+	else
+		spoutdx.CopySharedTexture(m_pImmediateContext, pTexture, m_pSharedTexture);
+}
+
+//
+// Preview texture
+//
+// See SetPreview
+//
+
+// Sender create the mip texture, the shared preview texture and the preview map
+bool spoutDX::CreatePreview(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	ReleasePreview();
+
+	if (m_PreviewMaxWidth == 0 || !m_pd3dDevice || !m_SenderName[0] || width == 0 || height == 0)
+		return false;
+
+	// The first mip level no wider than the maximum
+	unsigned int level = 1;
+	while ((width >> level) > m_PreviewMaxWidth && (width >> (level+1)) > 0 && (height >> (level+1)) > 0)
+		level++;
+	const unsigned int pw = (width  >> level) > 0 ? (width  >> level) : 1;
+	const unsigned int ph = (height >> level) > 0 ? (height >> level) : 1;
+
+	// Texture with mip levels for GenerateMips
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width            = width;
+	desc.Height           = height;
+	desc.MipLevels        = level+1;
+	desc.ArraySize        = 1;
+	desc.Format           = (DXGI_FORMAT)dwFormat;
+	desc.SampleDesc.Count = 1;
+	desc.Usage            = D3D11_USAGE_DEFAULT;
+	desc.BindFlags        = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	desc.MiscFlags        = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+	HRESULT hr = m_pd3dDevice->CreateTexture2D(&desc, nullptr, &m_pPreviewMips);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreatePreview - could not create mip texture (0x%.7X)", (unsigned int)hr);
+		m_pPreviewMips = nullptr;
+		return false;
+	}
+	hr = m_pd3dDevice->CreateShaderResourceView(m_pPreviewMips, nullptr, &m_pPreviewSRV);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreatePreview - could not create shader resource view (0x%.7X)", (unsigned int)hr);
+		m_pPreviewSRV = nullptr;
+		ReleasePreview();
+		return false;
+	}
+
+	HANDLE hShare = nullptr;
+	if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, pw, ph, (DXGI_FORMAT)dwFormat, &m_pPreviewTexture, hShare)) {
+		SpoutLogWarning("spoutDX::CreatePreview - could not create preview texture");
+		ReleasePreview();
+		return false;
+	}
+
+	SharedTexturePreview preview={};
+	preview.shareHandle = (uint32_t)HandleToLong(hShare);
+	preview.width  = pw;
+	preview.height = ph;
+	preview.format = dwFormat;
+	preview.level  = level;
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutPreview";
+	if (m_PreviewMemory.Create(mapname.c_str(), (int)sizeof(SharedTexturePreview)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreatePreview - could not create preview map");
+		ReleasePreview();
+		return false;
+	}
+	char* pBuf = m_PreviewMemory.Lock();
+	if (!pBuf) {
+		ReleasePreview();
+		return false;
+	}
+	memcpy(pBuf, &preview, sizeof(SharedTexturePreview));
+	m_PreviewMemory.Unlock();
+
+	m_PreviewLevel  = level;
+	m_PreviewWidth  = pw;
+	m_PreviewHeight = ph;
+	m_bPreviewOpen  = true;
+
+	SpoutLogNotice("spoutDX::CreatePreview - [%s] %dx%d (level %d)", mapname.c_str(), pw, ph, level);
+
+	return true;
+}
+
+// Receiver open the sender's preview texture if the sender has created one
+bool spoutDX::OpenPreview(const char* sendername)
+{
+	ReleasePreview();
+
+	if (!sendername || !*sendername || !m_pd3dDevice)
+		return false;
+
+	std::string mapname = sendername;
+	mapname += "_SpoutPreview";
+	// No warning if the sender does not publish a preview
+	if (!m_PreviewMemory.Open(mapname.c_str()))
+		return false;
+
+	SharedTexturePreview preview={};
+	char* pBuf = m_PreviewMemory.Lock();
+	if (pBuf) {
+		memcpy(&preview, pBuf, sizeof(SharedTexturePreview));
+		m_PreviewMemory.Unlock();
+	}
+
+	if (preview.shareHandle == 0 || preview.width == 0 || preview.height == 0) {
+		m_PreviewMemory.Close();
+		return false;
+	}
+
+	HANDLE hShare = (HANDLE)(LongToHandle((long)preview.shareHandle));
+	if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &m_pPreviewTexture, hShare)) {
+		SpoutLogWarning("spoutDX::OpenPreview - could not open preview texture");
+		ReleasePreview();
+		return false;
+	}
+
+	m_PreviewLevel  = preview.level;
+	m_PreviewWidth  = preview.width;
+	m_PreviewHeight = preview.height;
+	m_PreviewFrame  = 0;
+	m_bPreviewOpen  = true;
+
+	SpoutLogNotice("spoutDX::OpenPreview - [%s] %dx%d", mapname.c_str(), m_PreviewWidth, m_PreviewHeight);
+
+	return true;
+}
+
+// Release preview textures and close the preview information map
+void spoutDX::ReleasePreview()
+{
+	if (!m_bPreviewOpen && !m_pPreviewTexture && !m_pPreviewMips && !m_pPreviewReceived)
+		return;
+
+	if (m_pPreviewSRV) m_pPreviewSRV->Release();
+	if (m_pPreviewMips) m_pPreviewMips->Release();
+	if (m_pPreviewTexture) m_pPreviewTexture->Release();
+	if (m_pPreviewReceived) m_pPreviewReceived->Release();
+	m_pPreviewSRV = nullptr;
+	m_pPreviewMips = nullptr;
+	m_pPreviewTexture = nullptr;
+	m_pPreviewReceived = nullptr;
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+	m_PreviewMemory.Close();
+	m_PreviewLevel = 0;
+	m_PreviewWidth = 0;
+	m_PreviewHeight = 0;
+	m_bPreviewOpen = false;
+	m_PreviewFrame = 0;
+}
+
+// Sender reduce the texture by mip level and copy to the preview texture
+bool spoutDX::WritePreview(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion)
+{
+	if (m_PreviewMaxWidth == 0 || !m_bPreviewOpen || !m_pPreviewMips || !pTexture || !m_pImmediateContext)
+		return false;
+
+	SharedTexturePreview* pPreview = reinterpret_cast<SharedTexturePreview*>(m_PreviewMemory.Buffer());
+	if (!pPreview)
+		return false;
+
+	m_pImmediateContext->CopySubresourceRegion(m_pPreviewMips, 0, 0, 0, 0, pTexture, 0, pSourceRegion);
+	m_pImmediateContext->GenerateMips(m_pPreviewSRV);
+	m_pImmediateContext->CopySubresourceRegion(m_pPreviewTexture, 0, 0, 0, 0, m_pPreviewMips, m_PreviewLevel, nullptr);
+	// Flush because the shared texture has been updated on this device
+	m_pImmediateContext->Flush();
+
+	InterlockedIncrement64(&pPreview->frame);
+
+	return true;
+}
+
+//
+// YUV texture
+//
+// See SetYUVFormat
+//
+
+// Sender create the video processor, the shared YUV texture and the information map
+bool spoutDX::CreateYUV(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	ReleaseYUV();
+
+	if (!m_pd3dDevice || !m_SenderName[0])
+		return false;
+
+	// Even size for 4:2:0
+	const unsigned int yw = width & ~1u;
+	const unsigned int yh = height & ~1u;
+	if (yw == 0 || yh == 0)
+		return false;
+
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(ID3D11VideoDevice), reinterpret_cast<void**>(&m_pVideoDevice));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreateYUV - no video device (0x%.7X)", (unsigned int)hr);
+		m_pVideoDevice = nullptr;
+		return false;
+	}
+	hr = m_pImmediateContext->QueryInterface(__uuidof(ID3D11VideoContext), reinterpret_cast<void**>(&m_pVideoContext));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreateYUV - no video context (0x%.7X)", (unsigned int)hr);
+		m_pVideoContext = nullptr;
+		ReleaseYUV();
+		return false;
+	}
+
+	D3D11_VIDEO_PROCESSOR_CONTENT_DESC content={};
+	content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+	content.InputWidth   = width;
+	content.InputHeight  = height;
+	content.OutputWidth  = yw;
+	content.OutputHeight = yh;
+	content.Usage = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL;
+	hr = m_pVideoDevice->CreateVideoProcessorEnumerator(&content, &m_pVideoEnum);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreateYUV - could not create video processor enumerator (0x%.7X)", (unsigned int)hr);
+		m_pVideoEnum = nullptr;
+		ReleaseYUV();
+		return false;
+	}
+
+	UINT support = 0;
+	if (FAILED(m_pVideoEnum->CheckVideoProcessorFormat((DXGI_FORMAT)dwFormat, &support))
+		|| !(support & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_OUTPUT)) {
+		SpoutLogWarning("spoutDX::CreateYUV - format %d not supported for output", dwFormat);
+		ReleaseYUV();
+		return false;
+	}
+
+	hr = m_pVideoDevice->CreateVideoProcessor(m_pVideoEnum, 0, &m_pVideoProcessor);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreateYUV - could not create video processor (0x%.7X)", (unsigned int)hr);
+		m_pVideoProcessor = nullptr;
+		ReleaseYUV();
+		return false;
+	}
+
+	// RGB full range in, BT.709 studio range out
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE incs={};
+	incs.RGB_Range = 0; // 0-255
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE outcs={};
+	outcs.YCbCr_Matrix = 1; // BT.709
+	outcs.Nominal_Range = D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+	m_pVideoContext->VideoProcessorSetStreamColorSpace(m_pVideoProcessor, 0, &incs);
+	m_pVideoContext->VideoProcessorSetOutputColorSpace(m_pVideoProcessor, &outcs);
+	m_pVideoContext->VideoProcessorSetStreamFrameFormat(m_pVideoProcessor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+	m_pVideoContext->VideoProcessorSetStreamAutoProcessingMode(m_pVideoProcessor, 0, FALSE);
+
+	HANDLE hShare = nullptr;
+	if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, yw, yh, (DXGI_FORMAT)dwFormat, &m_pYUVTexture, hShare)) {
+		SpoutLogWarning("spoutDX::CreateYUV - could not create YUV texture");
+		ReleaseYUV();
+		return false;
+	}
+
+	D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd={};
+	ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+	hr = m_pVideoDevice->CreateVideoProcessorOutputView(m_pYUVTexture, m_pVideoEnum, &ovd, &m_pYUVOutputView);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CreateYUV - could not create output view (0x%.7X)", (unsigned int)hr);
+		m_pYUVOutputView = nullptr;
+		ReleaseYUV();
+		return false;
+	}
+
+	SharedTexturePreview yuv={};
+	yuv.shareHandle = (uint32_t)HandleToLong(hShare);
+	yuv.width  = yw;
+	yuv.height = yh;
+	yuv.format = dwFormat;
+	yuv.level  = 0;
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutYUV";
+	if (m_YUVMemory.Create(mapname.c_str(), (int)sizeof(SharedTexturePreview)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreateYUV - could not create YUV map");
+		ReleaseYUV();
+		return false;
+	}
+	char* pBuf = m_YUVMemory.Lock();
+	if (!pBuf) {
+		ReleaseYUV();
+		return false;
+	}
+	memcpy(pBuf, &yuv, sizeof(SharedTexturePreview));
+	m_YUVMemory.Unlock();
+
+	m_YUVWidth  = yw;
+	m_YUVHeight = yh;
+	m_dwYUVFormat = dwFormat;
+	m_bYUVOpen  = true;
+
+	SpoutLogNotice("spoutDX::CreateYUV - [%s] %dx%d format %d", mapname.c_str(), yw, yh, dwFormat);
+
+	return true;
+}
+
+// Receiver open the sender's YUV texture if the sender has created one
+bool spoutDX::OpenYUV(const char* sendername)
+{
+	ReleaseYUV();
+
+	if (!sendername || !*sendername || !m_pd3dDevice)
+		return false;
+
+	std::string mapname = sendername;
+	mapname += "_SpoutYUV";
+	// No warning if the sender does not publish a YUV texture
+	if (!m_YUVMemory.Open(mapname.c_str()))
+		return false;
+
+	SharedTexturePreview yuv={};
+	char* pBuf = m_YUVMemory.Lock();
+	if (pBuf) {
+		memcpy(&yuv, pBuf, sizeof(SharedTexturePreview));
+		m_YUVMemory.Unlock();
+	}
+
+	if (yuv.shareHandle == 0 || yuv.width == 0 || yuv.height == 0) {
+		m_YUVMemory.Close();
+		return false;
+	}
+
+	HANDLE hShare = (HANDLE)(LongToHandle((long)yuv.shareHandle));
+	if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &m_pYUVTexture, hShare)) {
+		SpoutLogWarning("spoutDX::OpenYUV - could not open YUV texture");
+		ReleaseYUV();
+		return false;
+	}
+
+	m_YUVWidth  = yuv.width;
+	m_YUVHeight = yuv.height;
+	m_dwYUVFormat = yuv.format;
+	m_YUVFrame  = 0;
+	m_YUVPixelFrame = 0;
+	m_pYUVPixels = nullptr;
+	m_bYUVOpen  = true;
+
+	SpoutLogNotice("spoutDX::OpenYUV - [%s] %dx%d format %d", mapname.c_str(), m_YUVWidth, m_YUVHeight, m_dwYUVFormat);
+
+	return true;
+}
+
+// Release the YUV textures and video processor and close the information map
+void spoutDX::ReleaseYUV()
+{
+	if (!m_bYUVOpen && !m_pYUVTexture && !m_pVideoDevice && !m_pYUVReceived)
+		return;
+
+	if (m_pYUVInputView) m_pYUVInputView->Release();
+	if (m_pYUVOutputView) m_pYUVOutputView->Release();
+	if (m_pVideoProcessor) m_pVideoProcessor->Release();
+	if (m_pVideoEnum) m_pVideoEnum->Release();
+	if (m_pVideoContext) m_pVideoContext->Release();
+	if (m_pVideoDevice) m_pVideoDevice->Release();
+	if (m_pYUVTexture) m_pYUVTexture->Release();
+	if (m_pYUVReceived) m_pYUVReceived->Release();
+	if (m_pYUVStaging) m_pYUVStaging->Release();
+	m_pYUVInputView = nullptr;
+	m_pYUVSource = nullptr;
+	m_pYUVOutputView = nullptr;
+	m_pVideoProcessor = nullptr;
+	m_pVideoEnum = nullptr;
+	m_pVideoContext = nullptr;
+	m_pVideoDevice = nullptr;
+	m_pYUVTexture = nullptr;
+	m_pYUVReceived = nullptr;
+	m_pYUVStaging = nullptr;
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+	m_YUVMemory.Close();
+	m_YUVWidth = 0;
+	m_YUVHeight = 0;
+	m_dwYUVFormat = 0;
+	m_bYUVOpen = false;
+	m_YUVFrame = 0;
+	m_YUVPixelFrame = 0;
+	m_pYUVPixels = nullptr;
+}
+
+// Sender convert the texture to the YUV texture
+bool spoutDX::WriteYUV(ID3D11Texture2D* pTexture)
+{
+	if (m_YUVFormat == DXGI_FORMAT_UNKNOWN || !m_bYUVOpen || !m_pVideoProcessor || !pTexture)
+		return false;
+
+	SharedTexturePreview* pYUV = reinterpret_cast<SharedTexturePreview*>(m_YUVMemory.Buffer());
+	if (!pYUV)
+		return false;
+
+	// The input view is retained for the same source texture
+	if (pTexture != m_pYUVSource) {
+		if (m_pYUVInputView) m_pYUVInputView->Release();
+		m_pYUVInputView = nullptr;
+		m_pYUVSource = nullptr;
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd={};
+		ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		const HRESULT hr = m_pVideoDevice->CreateVideoProcessorInputView(pTexture, m_pVideoEnum, &ivd, &m_pYUVInputView);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDX::WriteYUV - could not create input view (0x%.7X)", (unsigned int)hr);
+			m_pYUVInputView = nullptr;
+			return false;
+		}
+		m_pYUVSource = pTexture;
+	}
+
+	D3D11_VIDEO_PROCESSOR_STREAM stream={};
+	stream.Enable = TRUE;
+	stream.pInputSurface = m_pYUVInputView;
+	if (FAILED(m_pVideoContext->VideoProcessorBlt(m_pVideoProcessor, m_pYUVOutputView, 0, 1, &stream)))
+		return false;
+
+	InterlockedIncrement64(&pYUV->frame);
+
+	return true;
+}
+
+//
+// Video processor (see SetVideoProcessing)
+//
+
+// Create the video processor, output texture and staging textures
+// for the source texture and an output of width x height and format
+bool spoutDX::CheckVideoProcessor(ID3D11Texture2D* pSource, unsigned int width, unsigned int height, DXGI_FORMAT format)
+{
+	if (!m_pd3dDevice || !m_pImmediateContext || !pSource || width == 0 || height == 0)
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pSource->GetDesc(&desc);
+
+	// Return if the same input and output
+	if (m_pVPProcessor && m_pVPStaging[0] && m_pVPStaging[1]
+		&& desc.Width == m_VPInputWidth && desc.Height == m_VPInputHeight
+		&& width == m_VPOutputWidth && height == m_VPOutputHeight
+		&& format == m_VPOutputFormat)
+		return true;
+
+	ReleaseVideoProcessor();
+
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(ID3D11VideoDevice), reinterpret_cast<void**>(&m_pVPDevice));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - no video device (0x%.7X)", (unsigned int)hr);
+		m_pVPDevice = nullptr;
+		return false;
+	}
+	hr = m_pImmediateContext->QueryInterface(__uuidof(ID3D11VideoContext), reinterpret_cast<void**>(&m_pVPContext));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - no video context (0x%.7X)", (unsigned int)hr);
+		m_pVPContext = nullptr;
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	D3D11_VIDEO_PROCESSOR_CONTENT_DESC content={};
+	content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+	content.InputWidth   = desc.Width;
+	content.InputHeight  = desc.Height;
+	content.OutputWidth  = width;
+	content.OutputHeight = height;
+	content.Usage = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL;
+	hr = m_pVPDevice->CreateVideoProcessorEnumerator(&content, &m_pVPEnum);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - could not create video processor enumerator (0x%.7X)", (unsigned int)hr);
+		m_pVPEnum = nullptr;
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	UINT support = 0;
+	if (FAILED(m_pVPEnum->CheckVideoProcessorFormat(desc.Format, &support))
+		|| !(support & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_INPUT)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - format %d not supported for input", desc.Format);
+		ReleaseVideoProcessor();
+		return false;
+	}
+	support = 0;
+	if (FAILED(m_pVPEnum->CheckVideoProcessorFormat(format, &support))
+		|| !(support & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_OUTPUT)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - format %d not supported for output", format);
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	hr = m_pVPDevice->CreateVideoProcessor(m_pVPEnum, 0, &m_pVPProcessor);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - could not create video processor (0x%.7X)", (unsigned int)hr);
+		m_pVPProcessor = nullptr;
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	// The whole source is scaled to the whole output
+	const RECT srcrect = { 0, 0, (LONG)desc.Width, (LONG)desc.Height };
+	const RECT dstrect = { 0, 0, (LONG)width, (LONG)height };
+	m_pVPContext->VideoProcessorSetStreamFrameFormat(m_pVPProcessor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+	m_pVPContext->VideoProcessorSetStreamAutoProcessingMode(m_pVPProcessor, 0, FALSE);
+	m_pVPContext->VideoProcessorSetStreamSourceRect(m_pVPProcessor, 0, TRUE, &srcrect);
+	m_pVPContext->VideoProcessorSetStreamDestRect(m_pVPProcessor, 0, TRUE, &dstrect);
+	m_pVPContext->VideoProcessorSetOutputTargetRect(m_pVPProcessor, TRUE, &dstrect);
+
+	if (!spoutdx.CreateDX11Texture(m_pd3dDevice, width, height, format, &m_pVPTexture)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - could not create output texture");
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd={};
+	ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+	hr = m_pVPDevice->CreateVideoProcessorOutputView(m_pVPTexture, m_pVPEnum, &ovd, &m_pVPOutputView);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - could not create output view (0x%.7X)", (unsigned int)hr);
+		m_pVPOutputView = nullptr;
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	// Staging textures of the output size and format
+	if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, format, &m_pVPStaging[0])
+		|| !spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, format, &m_pVPStaging[1])) {
+		SpoutLogWarning("spoutDX::CheckVideoProcessor - could not create staging textures");
+		ReleaseVideoProcessor();
+		return false;
+	}
+
+	m_VPInputWidth   = desc.Width;
+	m_VPInputHeight  = desc.Height;
+	m_VPOutputWidth  = width;
+	m_VPOutputHeight = height;
+	m_VPOutputFormat = format;
+
+	SpoutLogNotice("spoutDX::CheckVideoProcessor - %dx%d to %dx%d format %d",
+		desc.Width, desc.Height, width, height, format);
+
+	return true;
+}
+
+// Process the source texture to the output texture
+// and copy to the staging texture m_Index.
+// Video processing is disabled if it fails.
+bool spoutDX::ProcessVideoData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+	DXGI_FORMAT format, SpoutYUVMatrix matrix, bool bFullRange)
+{
+	if (!CheckVideoProcessor(pSource, width, height, format)) {
+		SpoutLogWarning("spoutDX::ProcessVideoData - video processor not available");
+		m_bVideoProcessing = false;
+		return false;
+	}
+
+	// The input view is retained for the same source texture
+	if (pSource != m_pVPSource) {
+		if (m_pVPInputView) m_pVPInputView->Release();
+		m_pVPInputView = nullptr;
+		m_pVPSource = nullptr;
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd={};
+		ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		const HRESULT hr = m_pVPDevice->CreateVideoProcessorInputView(pSource, m_pVPEnum, &ivd, &m_pVPInputView);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDX::ProcessVideoData - could not create input view (0x%.7X)", (unsigned int)hr);
+			m_pVPInputView = nullptr;
+			m_bVideoProcessing = false;
+			return false;
+		}
+		m_pVPSource = pSource;
+	}
+
+	// RGB full range in, RGB full range or YUV of the requested matrix and range out
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE incs={};
+	incs.RGB_Range = 0; // 0-255
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE outcs={};
+	outcs.RGB_Range = 0;
+	outcs.YCbCr_Matrix = (matrix == SPOUT_YUV_BT709) ? 1 : 0;
+	outcs.Nominal_Range = bFullRange ? D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_0_255 : D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+	m_pVPContext->VideoProcessorSetStreamColorSpace(m_pVPProcessor, 0, &incs);
+	m_pVPContext->VideoProcessorSetOutputColorSpace(m_pVPProcessor, &outcs);
+
+	D3D11_VIDEO_PROCESSOR_STREAM stream={};
+	stream.Enable = TRUE;
+	stream.pInputSurface = m_pVPInputView;
+	spoutdx.BeginGPUTime(m_pImmediateContext, "GPUVideoProcess");
+	const HRESULT hr = m_pVPContext->VideoProcessorBlt(m_pVPProcessor, m_pVPOutputView, 0, 1, &stream);
+	spoutdx.EndGPUTime(m_pImmediateContext);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::ProcessVideoData - VideoProcessorBlt failed (0x%.7X)", (unsigned int)hr);
+		m_bVideoProcessing = false;
+		return false;
+	}
+
+	// Copy to the first staging texture
+	m_pImmediateContext->CopyResource(m_pVPStaging[m_Index], m_pVPTexture);
+
+	return true;
+}
+
+// Read NV12 data from the video processor staging texture m_NextIndex
+// to a buffer of width*height*3/2 bytes
+bool spoutDX::ReadVideoYUV(unsigned char* destpixels, unsigned int width, unsigned int height, bool bInvert)
+{
+	ID3D11Texture2D* pStaging = m_pVPStaging[m_NextIndex];
+	if (!m_pImmediateContext || !destpixels || !pStaging || m_VPOutputFormat != DXGI_FORMAT_NV12)
+		return false;
+
+	if (width != m_VPOutputWidth || height != m_VPOutputHeight)
+		return false;
+
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	// Make sure all commands are done before mapping the staging texture
+	m_pImmediateContext->Flush();
+	// Map waits for GPU access
+	if (FAILED(m_pImmediateContext->Map(pStaging, 0, D3D11_MAP_READ, 0, &mapped)))
+		return false;
+
+	const unsigned char* src = static_cast<const unsigned char*>(mapped.pData);
+	unsigned char* dst = destpixels;
+
+	// Y plane
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned int row = bInvert ? (height - 1 - y) : y;
+		memcpy(dst, src + (uint64_t)row * mapped.RowPitch, width);
+		dst += width;
+	}
+	// Interleaved UV plane follows the Y plane of the texture height
+	src += (uint64_t)mapped.RowPitch * height;
+	for (unsigned int y = 0; y < height / 2; y++) {
+		const unsigned int row = bInvert ? (height / 2 - 1 - y) : y;
+		memcpy(dst, src + (uint64_t)row * mapped.RowPitch, width);
+		dst += width;
+	}
+
+	m_pImmediateContext->Unmap(pStaging, 0);
+
+	return true;
+}
+
+// Release the video processor and textures
+void spoutDX::ReleaseVideoProcessor()
+{
+	if (m_pVPInputView) m_pVPInputView->Release();
+	if (m_pVPOutputView) m_pVPOutputView->Release();
+	if (m_pVPProcessor) m_pVPProcessor->Release();
+	if (m_pVPEnum) m_pVPEnum->Release();
+	if (m_pVPContext) m_pVPContext->Release();
+	if (m_pVPDevice) m_pVPDevice->Release();
+	if (m_pVPTexture) m_pVPTexture->Release();
+	if (m_pVPStaging[0]) m_pVPStaging[0]->Release();
+	if (m_pVPStaging[1]) m_pVPStaging[1]->Release();
+	m_pVPInputView = nullptr;
+	m_pVPSource = nullptr;
+	m_pVPOutputView = nullptr;
+	m_pVPProcessor = nullptr;
+	m_pVPEnum = nullptr;
+	m_pVPContext = nullptr;
+	m_pVPDevice = nullptr;
+	m_pVPTexture = nullptr;
+	m_pVPStaging[0] = nullptr;
+	m_pVPStaging[1] = nullptr;
+	m_VPInputWidth = 0;
+	m_VPInputHeight = 0;
+	m_VPOutputWidth = 0;
+	m_VPOutputHeight = 0;
+	m_VPOutputFormat = DXGI_FORMAT_UNKNOWN;
+
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+}
+
+//
+// Banded readback (see SetReadbackBands)
+//
+
+// Create staging textures and event queries for bands of a texture
+bool spoutDX::CheckReadbackBands(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	if (!m_pd3dDevice || m_nReadBands < 2 || height < (unsigned int)m_nReadBands)
+		return false;
+
+	const unsigned int bandheight = (height + m_nReadBands - 1) / m_nReadBands;
+
+	// Return if the same band size and format
+	if (m_pBandStaging[m_nReadBands-1] && m_pBandQuery[m_nReadBands-1]
+		&& width == m_BandWidth && bandheight == m_BandHeight && dwFormat == m_dwBandFormat)
+		return true;
+
+	ReleaseReadbackBands();
+
+	D3D11_QUERY_DESC queryDesc={};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	for (int i = 0; i < m_nReadBands; i++) {
+		if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, bandheight, (DXGI_FORMAT)dwFormat, &m_pBandStaging[i])
+			|| FAILED(m_pd3dDevice->CreateQuery(&queryDesc, &m_pBandQuery[i]))) {
+			SpoutLogWarning("spoutDX::CheckReadbackBands - could not create band %d", i);
+			ReleaseReadbackBands();
+			return false;
+		}
+	}
+
+	m_BandWidth  = width;
+	m_BandHeight = bandheight;
+	m_dwBandFormat = dwFormat;
+
+	SpoutLogNotice("spoutDX::CheckReadbackBands - %d bands of %dx%d", m_nReadBands, width, bandheight);
+
+	return true;
+}
+
+// Copy bands of the sender texture to the band staging textures
+// and convert each band to the pixel buffer as soon as its copy is complete.
+// The pixel buffer is the sender size.
+bool spoutDX::ReadBandedPixels(unsigned char* destpixels, bool bRGB, bool bInvert, unsigned int destPitch)
+{
+	if (!m_pImmediateContext || !m_pSharedTexture || !destpixels)
+		return false;
+
+	if (!CheckReadbackBands(m_Width, m_Height, m_dwFormat))
+		return false;
+
+	// Queue the copy of every band with a query after each
+	for (int i = 0; i < m_nReadBands; i++) {
+		const unsigned int y0 = i * m_BandHeight;
+		const unsigned int y1 = (y0 + m_BandHeight < m_Height) ? y0 + m_BandHeight : m_Height;
+		if (y0 >= y1)
+			break;
+		const D3D11_BOX box = { 0, y0, 0, m_Width, y1, 1 };
+		m_pImmediateContext->CopySubresourceRegion(m_pBandStaging[i], 0, 0, 0, 0, m_pSharedTexture, 0, &box);
+		m_pImmediateContext->End(m_pBandQuery[i]);
+	}
+	// Submit the copies now
+	m_pImmediateContext->Flush();
+
+	// Bytes of each line of the pixel buffer
+	const unsigned int linebytes = (destPitch > 0) ? destPitch : m_Width*(bRGB ? 3 : 4);
+
+	for (int i = 0; i < m_nReadBands; i++) {
+		const unsigned int y0 = i * m_BandHeight;
+		const unsigned int y1 = (y0 + m_BandHeight < m_Height) ? y0 + m_BandHeight : m_Height;
+		if (y0 >= y1)
+			break;
+		// Wait for the copy of this band only
+		while (m_pImmediateContext->GetData(m_pBandQuery[i], nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_FALSE)
+			SwitchToThread();
+		D3D11_MAPPED_SUBRESOURCE mapped={};
+		if (FAILED(m_pImmediateContext->Map(m_pBandStaging[i], 0, D3D11_MAP_READ, 0, &mapped)))
+			return false;
+		// An inverted band is written to the opposite lines of the buffer
+		const unsigned int rows = y1 - y0;
+		const unsigned int desty = bInvert ? (m_Height - y1) : y0;
+		CopyPixelData(mapped.pData, mapped.RowPitch, m_Width, rows,
+			destpixels + (uint64_t)desty * linebytes, m_Width, rows, bRGB, bInvert, false, destPitch);
+		m_pImmediateContext->Unmap(m_pBandStaging[i], 0);
+	}
+
+	return true;
+}
+
+// Release the band staging textures and queries
+void spoutDX::ReleaseReadbackBands()
+{
+	for (int i = 0; i < SPOUT_READBACK_BANDS; i++) {
+		if (m_pBandStaging[i]) m_pBandStaging[i]->Release();
+		if (m_pBandQuery[i]) m_pBandQuery[i]->Release();
+		m_pBandStaging[i] = nullptr;
+		m_pBandQuery[i] = nullptr;
+	}
+	m_BandWidth = 0;
+	m_BandHeight = 0;
+	m_dwBandFormat = 0;
+}
+
+//
+// Shared images (see SetSharedImages)
 //
-//    DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE - (2) External GPU / Discrete GPU
+
+// Name of the image map for a format and size
+static std::string SharedImageName(const char* sendername, const SharedImageRequest &key)
+{
+	char name[512]={};
+	sprintf_s(name, 512, "%s_SpoutImage_%ux%u_%u", sendername, key.width, key.height, key.flags);
+	return std::string(name);
+}
+
+// Sender create the image request entries for receivers
+bool spoutDX::CreateSharedImages()
+{
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutImages";
+	if (m_ImageRequests.Create(mapname.c_str(), (int)(sizeof(SharedImageRequest)*SPOUT_SHARED_IMAGES)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::CreateSharedImages - could not create [%s]", mapname.c_str());
+		return false;
+	}
+	SpoutLogNotice("spoutDX::CreateSharedImages - [%s]", mapname.c_str());
+	return true;
+}
+
+// Release sender images and staging textures,
+// or the receiver request and image
+void spoutDX::ReleaseSharedImages()
+{
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++) {
+		m_SharedImage[i].Close();
+		m_SharedImageKey[i] = {};
+	}
+	for (int i = 0; i < 2; i++) {
+		if (m_pImageStaging[i])
+			spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pImageStaging[i]);
+		m_pImageStaging[i] = nullptr;
+	}
+	m_ImageIndex = 0;
+	m_ImageFrame = 0;
+	m_ImageRequests.Close();
+
+	m_ReceivedImage.Close();
+	m_ReceivedImageKey = {};
+	m_ImageRequestTime = 0;
+	m_ReceivedImageFrame = 0;
+	m_ImageRetry = 0;
+}
+
+// Sender copy the shared texture to staging and convert
+// the previous frame for each format requested by receivers
+void spoutDX::WriteSharedImages(ID3D11Texture2D* pTexture)
+{
+	SharedImageRequest* pRequest = reinterpret_cast<SharedImageRequest*>(m_ImageRequests.Buffer());
+	if (!m_bSharedImages || !pRequest || !pTexture)
+		return;
+
+	// Requests renewed within the timeout
+	const ULONGLONG now = GetTickCount64();
+	bool bRequested[SPOUT_SHARED_IMAGES]={};
+	bool bActive = false;
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++) {
+		if (InterlockedCompareExchange(&pRequest[i].state, 0, 0) != SPOUT_IMAGE_REQUESTED)
+			continue;
+		const LONG64 time = InterlockedCompareExchange64(&pRequest[i].time, 0, 0);
+		if (now - (ULONGLONG)time < SPOUT_IMAGE_TIMEOUT) {
+			bRequested[i] = true;
+			bActive = true;
+		}
+		else {
+			// Expired, free for another request
+			InterlockedCompareExchange(&pRequest[i].state, SPOUT_IMAGE_FREE, SPOUT_IMAGE_REQUESTED);
+		}
+	}
+
+	// Close images no longer requested
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++) {
+		if (!bRequested[i] && m_SharedImage[i].Buffer()) {
+			m_SharedImage[i].Close();
+			m_SharedImageKey[i] = {};
+		}
+	}
+	if (!bActive) {
+		m_ImageFrame = 0;
+		return;
+	}
+
+	// Staging textures of the sender size and format
+	D3D11_TEXTURE2D_DESC desc={};
+	if (m_pImageStaging[0])
+		m_pImageStaging[0]->GetDesc(&desc);
+	if (!m_pImageStaging[0] || desc.Width != m_Width || desc.Height != m_Height || desc.Format != (DXGI_FORMAT)m_dwFormat) {
+		for (int i = 0; i < 2; i++) {
+			if (m_pImageStaging[i])
+				spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pImageStaging[i]);
+			m_pImageStaging[i] = nullptr;
+			if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, m_Width, m_Height, (DXGI_FORMAT)m_dwFormat, &m_pImageStaging[i])) {
+				SpoutLogWarning("spoutDX::WriteSharedImages - could not create staging texture");
+				return;
+			}
+		}
+		m_ImageIndex = 0;
+		m_ImageFrame = 0;
+	}
+
+	// Copy this frame to one staging texture
+	// and read the previous frame from the other
+	const int index = m_ImageIndex;
+	m_ImageIndex = 1 - index;
+	m_pImmediateContext->CopyResource(m_pImageStaging[index], pTexture);
+	const LONG64 framenumber = m_ImageFrame;
+	m_ImageFrame++;
+	if (framenumber == 0)
+		return;
+
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	m_pImmediateContext->Flush();
+	if (FAILED(m_pImmediateContext->Map(m_pImageStaging[1-index], 0, D3D11_MAP_READ, 0, &mapped)))
+		return;
+
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++) {
+		if (!bRequested[i])
+			continue;
+
+		SharedImageRequest key={};
+		key.flags  = pRequest[i].flags;
+		key.width  = pRequest[i].width;
+		key.height = pRequest[i].height;
+		if (key.width == 0 || key.height == 0)
+			continue;
+		const unsigned int pitch = key.width*((key.flags & SPOUT_IMAGE_RGB) ? 3 : 4);
+
+		// Create the image for a new request
+		if (!m_SharedImage[i].Buffer() || key.flags != m_SharedImageKey[i].flags
+			|| key.width != m_SharedImageKey[i].width || key.height != m_SharedImageKey[i].height) {
+			m_SharedImage[i].Close();
+			const std::string mapname = SharedImageName(m_SenderName, key);
+			const size_t size = sizeof(SharedImageHeader) + (size_t)pitch*key.height*2;
+			if (size > (size_t)INT_MAX || m_SharedImage[i].Create(mapname.c_str(), (int)size) == SPOUT_CREATE_FAILED) {
+				SpoutLogWarning("spoutDX::WriteSharedImages - could not create [%s]", mapname.c_str());
+				continue;
+			}
+			SharedImageHeader* pNew = reinterpret_cast<SharedImageHeader*>(m_SharedImage[i].Buffer());
+			pNew->pitch  = pitch;
+			pNew->width  = key.width;
+			pNew->height = key.height;
+			m_SharedImageKey[i] = key;
+			SpoutLogNotice("spoutDX::WriteSharedImages - [%s]", mapname.c_str());
+		}
+
+		// Write the buffer that was not written last
+		SharedImageHeader* pHeader = reinterpret_cast<SharedImageHeader*>(m_SharedImage[i].Buffer());
+		const LONG buffer = 1 - InterlockedCompareExchange(&pHeader->index, 0, 0);
+		unsigned char* pixels = reinterpret_cast<unsigned char*>(pHeader+1) + (size_t)buffer*pitch*key.height;
+		InterlockedIncrement64(&pHeader->sequence[buffer]); // odd while writing
+		CopyPixelData(mapped.pData, mapped.RowPitch, m_Width, m_Height, pixels,
+			key.width, key.height, (key.flags & SPOUT_IMAGE_RGB) != 0, (key.flags & SPOUT_IMAGE_INVERT) != 0, false);
+		pHeader->frame[buffer] = framenumber;
+		InterlockedIncrement64(&pHeader->sequence[buffer]);
+		InterlockedExchange(&pHeader->index, buffer);
+	}
+
+	m_pImmediateContext->Unmap(m_pImageStaging[1-index], 0);
+}
+
+// Receiver claim or renew the request entry for an image format and size
+bool spoutDX::RequestSharedImage(const SharedImageRequest &key)
+{
+	SharedImageRequest* pRequest = reinterpret_cast<SharedImageRequest*>(m_ImageRequests.Buffer());
+	if (!pRequest)
+		return false;
+
+	const LONG64 now = (LONG64)GetTickCount64();
+	int entry = -1;
+	LONG entrystate = SPOUT_IMAGE_FREE;
+	for (int i = 0; i < SPOUT_SHARED_IMAGES; i++) {
+		const LONG state = InterlockedCompareExchange(&pRequest[i].state, 0, 0);
+		const bool bExpired = (now - InterlockedCompareExchange64(&pRequest[i].time, 0, 0)) >= SPOUT_IMAGE_TIMEOUT;
+		if (state == SPOUT_IMAGE_REQUESTED && !bExpired && pRequest[i].flags == key.flags
+			&& pRequest[i].width == key.width && pRequest[i].height == key.height) {
+			// Requested by this or another receiver
+			InterlockedExchange64(&pRequest[i].time, now);
+			return true;
+		}
+		if (entry < 0 && (state == SPOUT_IMAGE_FREE || (state == SPOUT_IMAGE_REQUESTED && bExpired))) {
+			entry = i;
+			entrystate = state;
+		}
+	}
+
+	// Claim a free entry unless another receiver has claimed it first
+	if (entry < 0 || InterlockedCompareExchange(&pRequest[entry].state, SPOUT_IMAGE_CLAIMED, entrystate) != entrystate)
+		return false;
+	pRequest[entry].flags  = key.flags;
+	pRequest[entry].width  = key.width;
+	pRequest[entry].height = key.height;
+	InterlockedExchange64(&pRequest[entry].time, now);
+	InterlockedExchange(&pRequest[entry].state, SPOUT_IMAGE_REQUESTED);
+
+	return true;
+}
+
+// Receiver copy the image converted by the sender.
+// Returns false if the sender does not provide the image yet,
+// so that the sender texture is received instead.
+bool spoutDX::ReadSharedImage(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+{
+	// Request entries of a sender that converts images
+	if (!m_ImageRequests.Buffer()) {
+		if (m_ImageRetry > 0) {
+			m_ImageRetry--;
+			return false;
+		}
+		std::string mapname = m_SenderName;
+		mapname += "_SpoutImages";
+		// No warning for a sender without shared images
+		if (!m_ImageRequests.Open(mapname.c_str())) {
+			m_ImageRetry = 60;
+			return false;
+		}
+	}
+
+	SharedImageRequest key={};
+	key.flags  = (bRGB ? SPOUT_IMAGE_RGB : 0) | (bInvert ? SPOUT_IMAGE_INVERT : 0);
+	key.width  = width;
+	key.height = height;
+	const bool bNewKey = (key.flags != m_ReceivedImageKey.flags
+		|| key.width != m_ReceivedImageKey.width || key.height != m_ReceivedImageKey.height);
+	if (bNewKey) {
+		m_ReceivedImage.Close();
+		m_ReceivedImageKey = key;
+		m_ReceivedImageFrame = 0;
+		m_ImageRequestTime = 0;
+	}
+
+	// Renew the request well within the timeout
+	const ULONGLONG now = GetTickCount64();
+	if (now - m_ImageRequestTime >= SPOUT_IMAGE_TIMEOUT/4) {
+		if (!RequestSharedImage(key))
+			return false;
+		m_ImageRequestTime = now;
+	}
+
+	// The sender creates the image with the next frame
+	if (!m_ReceivedImage.Buffer()) {
+		if (!m_ReceivedImage.Open(SharedImageName(m_SenderName, key).c_str()))
+			return false;
+	}
+
+	const SharedImageHeader* pHeader = reinterpret_cast<const SharedImageHeader*>(m_ReceivedImage.Buffer());
+	const unsigned int pitch = width*(bRGB ? 3 : 4);
+	if (pHeader->width != width || pHeader->height != height || pHeader->pitch != pitch)
+		return false;
+
+	// Copy the buffer last written and test that it
+	// was not written again during the copy
+	for (int i = 0; i < 2; i++) {
+		const LONG buffer = InterlockedCompareExchange((volatile LONG*)&pHeader->index, 0, 0);
+		const LONG64 sequence = InterlockedCompareExchange64((volatile LONG64*)&pHeader->sequence[buffer], 0, 0);
+		if ((sequence & 1) != 0 || sequence == 0)
+			continue;
+		const LONG64 framenumber = pHeader->frame[buffer];
+		if (framenumber == m_ReceivedImageFrame)
+			return true; // No new frame
+		const unsigned char* pSource = reinterpret_cast<const unsigned char*>(pHeader+1) + (size_t)buffer*pitch*height;
+		memcpy(pixels, pSource, (size_t)pitch*height);
+		if (InterlockedCompareExchange64((volatile LONG64*)&pHeader->sequence[buffer], 0, 0) == sequence) {
+			m_ReceivedImageFrame = framenumber;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 //
-// The function achieves this result without user Windows preference by getting the name
-// of the preferred adapter using EnumAdapterByGpuPreference, finding the index of
-// that adapter in the current list of adapters, using EnumAdapters and finally 
-// retrieving a pointer to the adapter for CreateDX11device to use. To be effective,
-// this requires a system with multiple graphics processors which enable a choice 
-// between "Power saving" and "High performance".
+// Frame cache (see SetFrameCache)
 //
-bool spoutDX::SetPreferredAdapter(int preference)
+
+// Create or open the frame cache for the sender size and format
+bool spoutDX::OpenFrameCache()
+{
+	if (m_FrameCacheMemory.Buffer() && m_FrameCacheWidth == m_Width
+		&& m_FrameCacheHeight == m_Height && m_dwFrameCacheFormat == m_dwFormat)
+		return true;
+
+	ReleaseFrameCache();
+
+	if (!m_SenderName[0] || m_Width == 0 || m_Height == 0)
+		return false;
+
+	const unsigned int pitch = m_Width*((m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT) ? 8 : 4);
+	const size_t size = sizeof(SharedFrameCache) + (size_t)pitch*m_Height*2;
+	if (size > (size_t)INT_MAX)
+		return false;
+
+	// The first receiver creates the cache and others open it
+	char mapname[512]={};
+	sprintf_s(mapname, 512, "%s_SpoutFrameCache_%ux%u_%u", m_SenderName, m_Width, m_Height, (unsigned int)m_dwFormat);
+	const SpoutCreateResult result = m_FrameCacheMemory.Create(mapname, (int)size);
+	if (result == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX::OpenFrameCache - could not create [%s]", mapname);
+		return false;
+	}
+
+	SharedFrameCache* pCache = reinterpret_cast<SharedFrameCache*>(m_FrameCacheMemory.Buffer());
+	if (result == SPOUT_CREATE_SUCCESS) {
+		pCache->width  = m_Width;
+		pCache->height = m_Height;
+		pCache->format = (uint32_t)m_dwFormat;
+		pCache->pitch  = pitch;
+	}
+
+	m_FrameCacheWidth  = m_Width;
+	m_FrameCacheHeight = m_Height;
+	m_dwFrameCacheFormat = m_dwFormat;
+	m_FrameCacheLast = 0;
+	m_StagingFrame[0] = 0;
+	m_StagingFrame[1] = 0;
+
+	SpoutLogNotice("spoutDX::OpenFrameCache - [%s]", mapname);
+
+	return true;
+}
+
+// Close the frame cache
+void spoutDX::ReleaseFrameCache()
+{
+	m_FrameCacheMemory.Close();
+	m_FrameCacheWidth = 0;
+	m_FrameCacheHeight = 0;
+	m_dwFrameCacheFormat = 0;
+	m_FrameCacheLast = 0;
+	m_StagingFrame[0] = 0;
+	m_StagingFrame[1] = 0;
+}
+
+// Copy the last frame in the cache if it is at least minframe
+bool spoutDX::ReadFrameCache(unsigned char* pixels, unsigned int width, unsigned int height,
+	bool bRGB, bool bInvert, LONG64 minframe)
+{
+	const SharedFrameCache* pCache = reinterpret_cast<const SharedFrameCache*>(m_FrameCacheMemory.Buffer());
+	if (!pCache || pCache->pitch == 0)
+		return false;
+
+	const LONG slot = InterlockedCompareExchange((volatile LONG*)&pCache->index, 0, 0);
+	const LONG64 sequence = InterlockedCompareExchange64((volatile LONG64*)&pCache->sequence[slot], 0, 0);
+	const LONG64 framenumber = pCache->frame[slot];
+	if ((sequence & 1) != 0 || sequence == 0 || framenumber < minframe || framenumber <= m_FrameCacheLast)
+		return false;
+
+	const unsigned char* pSource = reinterpret_cast<const unsigned char*>(pCache+1) + (size_t)slot*pCache->pitch*pCache->height;
+	CopyPixelData(pSource, pCache->pitch, pCache->width, pCache->height, pixels, width, height, bRGB, bInvert, false);
+
+	// The slot was written again during the copy
+	if (InterlockedCompareExchange64((volatile LONG64*)&pCache->sequence[slot], 0, 0) != sequence)
+		return false;
+
+	m_FrameCacheLast = framenumber;
+
+	return true;
+}
+
+// Receive a new frame from the cache, or read it back and save it to the cache.
+// As for ReceiveImage, the frame read back is the one copied to staging
+// with the previous frame. Returns false if the cache cannot be used.
+bool spoutDX::ReceiveFrameCache(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+{
+	const LONG64 senderframe = frame.GetSenderFrame64();
+	if (senderframe <= 0 || !OpenFrameCache())
+		return false;
+
+	SharedFrameCache* pCache = reinterpret_cast<SharedFrameCache*>(m_FrameCacheMemory.Buffer());
+
+	// The frame before this one has been read back by another receiver
+	if (ReadFrameCache(pixels, width, height, bRGB, bInvert, senderframe-1))
+		return true;
+
+	// Claim this frame to read back, or wait for another receiver that has
+	LONG64 claim = InterlockedCompareExchange64(&pCache->claim, 0, 0);
+	while (claim < senderframe) {
+		const LONG64 previous = InterlockedCompareExchange64(&pCache->claim, senderframe, claim);
+		if (previous == claim)
+			break;
+		claim = previous;
+	}
+	if (claim >= senderframe) {
+		const ULONGLONG start = GetTickCount64();
+		do {
+			if (ReadFrameCache(pixels, width, height, bRGB, bInvert, senderframe-1))
+				return true;
+			Sleep(0);
+		} while (GetTickCount64() - start < SPOUT_FRAMECACHE_WAIT);
+	}
+
+	// Read back as ReceiveImage does and save the frame to the cache
+	spoutdx.BeginGPUTime(m_pImmediateContext, "GPUStagingCopy");
+	CopySenderTexture(m_pStaging[m_Index]);
+	spoutdx.EndGPUTime(m_pImmediateContext);
+	m_StagingFrame[m_Index] = senderframe;
+
+	// The other staging texture has an earlier frame than the
+	// last received from the cache. There is no new frame this time.
+	const LONG64 stagedframe = m_StagingFrame[m_NextIndex];
+	if (stagedframe <= 0 || stagedframe <= m_FrameCacheLast)
+		return true;
+
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	m_pImmediateContext->Flush();
+	if (FAILED(m_pImmediateContext->Map(m_pStaging[m_NextIndex], 0, D3D11_MAP_READ, 0, &mapped)))
+		return true;
+
+	// Save to the slot not written last unless another receiver is writing
+	if (InterlockedCompareExchange(&pCache->writer, 1, 0) == 0) {
+		const LONG slot = 1 - InterlockedCompareExchange(&pCache->index, 0, 0);
+		unsigned char* pSlot = reinterpret_cast<unsigned char*>(pCache+1) + (size_t)slot*pCache->pitch*pCache->height;
+		InterlockedIncrement64(&pCache->sequence[slot]); // odd while writing
+		const unsigned char* pRow = static_cast<const unsigned char*>(mapped.pData);
+		for (unsigned int y = 0; y < pCache->height; y++)
+			memcpy(pSlot + (size_t)y*pCache->pitch, pRow + (size_t)y*mapped.RowPitch, pCache->pitch);
+		pCache->frame[slot] = stagedframe;
+		InterlockedIncrement64(&pCache->sequence[slot]);
+		InterlockedExchange(&pCache->index, slot);
+		InterlockedExchange(&pCache->writer, 0);
+	}
+
+	// Convert to the receiving buffer
+	CopyPixelData(mapped.pData, mapped.RowPitch, m_Width, m_Height, pixels, width, height, bRGB, bInvert, false);
+	m_pImmediateContext->Unmap(m_pStaging[m_NextIndex], 0);
+	m_FrameCacheLast = stagedframe;
+
+	return true;
+}
+
+//
+// COPY FROM A DX11 STAGING TEXTURE TO A USER RGBA/RGB/BGR PIXEL BUFFER OF GIVEN SIZE
+//
+// A class device and context must have been created using OpenDirectX11()
+//
+// bRGB - pixel data is RGB instead of RGBA
+// bInvert - flip the image
+// bSwap - swap red/blue (BGRA/RGBA). Not available for re-sample
+//
+bool spoutDX::ReadPixelData(ID3D11Texture2D* pStagingSource, unsigned char* destpixels,
+	unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap,
+	unsigned int destPitch)
+{
+	if (!m_pImmediateContext || !pStagingSource || !destpixels)
+		return false;
+
+	// Source size from the staging texture
+	// which can be smaller than the sender texture (ReceiveImageRegion)
+	D3D11_TEXTURE2D_DESC desc={};
+	pStagingSource->GetDesc(&desc);
+	const unsigned int srcWidth  = desc.Width;
+	const unsigned int srcHeight = desc.Height;
+
+	// Map the staging texture resource so we can access the pixels
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+	// Make sure all commands are done before mapping the staging texture
+	m_pImmediateContext->Flush();
+	// Map waits for GPU access
+	SpoutTrace(SPOUT_TRACE_MAP_BEGIN, m_SenderName, frame.GetSenderFrame64());
+	const HRESULT hr = m_pImmediateContext->Map(pStagingSource, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	SpoutTrace(SPOUT_TRACE_MAP_END, m_SenderName, frame.GetSenderFrame64());
+	if (SUCCEEDED(hr)) {
+		SpoutTrace(SPOUT_TRACE_CONVERT_BEGIN, m_SenderName, frame.GetSenderFrame64());
+		const LONG64 copyStart = timer.Start();
+
+		// Convert to the user buffer
+		CopyPixelData(mappedSubResource.pData, mappedSubResource.RowPitch, srcWidth, srcHeight,
+			destpixels, width, height, bRGB, bInvert, bSwap, destPitch);
+
+		timer.Stop("spoutCopy", copyStart);
+		SpoutTrace(SPOUT_TRACE_CONVERT_END, m_SenderName, frame.GetSenderFrame64());
+		m_pImmediateContext->Unmap(pStagingSource, 0);
+
+		return true;
+
+	} // endif DX11 map OK
+
+	return false;
+
+} // end ReadPixelData
+
+//---------------------------------------------------------
+// Function: CopyPixelData
+// Copy mapped texture pixels of the sender format to a user buffer.
+// Converts 10 bit and half float pixels, rgb and resample.
+// For staging textures (ReadPixelData) and buffers with the same layout.
+// destPitch - bytes of each line of the user buffer including padding (0 for packed)
+void spoutDX::CopyPixelData(const void* pSource, unsigned int srcPitch,
+	unsigned int srcWidth, unsigned int srcHeight, unsigned char* destpixels,
+	unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap,
+	unsigned int destPitch)
+{
+	// A buffer with padding is written line by line at the pitch.
+	// Resampled buffers are converted by compute shader instead.
+	if (destPitch > 0 && destPitch != width*(bRGB ? 3 : 4)) {
+		if (width != srcWidth || height != srcHeight)
+			return;
+		auto src = static_cast<const unsigned char*>(pSource);
+		for (unsigned int y = 0; y < height; y++) {
+			const unsigned int line = bInvert ? (height - 1 - y) : y;
+			CopyPixelData(src + (uint64_t)line * srcPitch, srcPitch, srcWidth, 1,
+				destpixels + (uint64_t)y * destPitch, width, 1, bRGB, false, bSwap);
+		}
+		return;
+	}
+
+	// 10 bit and half float textures are converted to 8 bit RGBA.
+	// RGBA buffers of the same size are converted directly. Otherwise
+	// the pixels are converted to a temporary RGBA buffer for the copy.
+	const void* pData = pSource;
+	unsigned int rowPitch = srcPitch;
+	DWORD dwFormat = m_dwFormat;
+	unsigned char* pRGBA = nullptr;
+	if (m_dwFormat == DXGI_FORMAT_R10G10B10A2_UNORM || m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT) {
+		const bool bHalf = (m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT);
+		if (!bRGB && width == srcWidth && height == srcHeight) {
+			if (bHalf)
+				spoutcopy.rgba16f_to_rgba(pData, destpixels, width, height, rowPitch, bInvert, bSwap);
+			else
+				spoutcopy.rgb10a2_to_rgba(pData, destpixels, width, height, rowPitch, bInvert, bSwap);
+			return;
+		}
+		pRGBA = new unsigned char[(size_t)srcWidth * srcHeight * 4];
+		if (bHalf)
+			spoutcopy.rgba16f_to_rgba(pData, pRGBA, srcWidth, srcHeight, rowPitch);
+		else
+			spoutcopy.rgb10a2_to_rgba(pData, pRGBA, srcWidth, srcHeight, rowPitch);
+		pData = pRGBA;
+		rowPitch = srcWidth * 4;
+		dwFormat = 28; // DXGI_FORMAT_R8G8B8A8_UNORM
+	}
+
+	// Copy the pixels to the user buffer
+	if (!bRGB) {
+		// RGBA pixel buffer
+		// TODO : test rgba-rgba resample
+		// TODO : rgba2bgraResample
+		if (width != srcWidth || height != srcHeight) {
+			spoutcopy.rgba2rgbaResample(pData, destpixels, srcWidth, srcHeight, rowPitch, width, height, bInvert);
+		}
+		else {
+			// Copy rgba to bgra line by line allowing for source pitch using the fastest method
+			// Uses SSE3 copy function if line data is 16bit aligned (see SpoutCopy.cpp)
+			if (bSwap) {
+				spoutcopy.rgba2bgra(pData, destpixels, width, height, rowPitch, bInvert);
+			}
+			else {
+				spoutcopy.rgba2rgba(pData, destpixels, width, height, rowPitch, bInvert);
+			}
+		}
+	}
+	else if (dwFormat == 28) { // DXGI_FORMAT_R8G8B8A8_UNORM
+		// RGBA texture - RGB/BGR pixel buffer
+		// If the texture format is RGBA it has to be converted to RGB/BGR by the staging texture copy
+		if (width != srcWidth || height != srcHeight) {
+			if(bSwap)
+				spoutcopy.rgba2bgrResample(pData, destpixels, srcWidth, srcHeight, rowPitch, width, height, bInvert);
+			else
+				spoutcopy.rgba2rgbResample(pData, destpixels, srcWidth, srcHeight, rowPitch, width, height, bInvert);
+		}
+		else {
+			// Copy RGBA to RGB or BGR allowing for source line pitch using the fastest method
+			// Uses SSE3 conversion functions if data is 16bit aligned (see SpoutCopy.cpp)
+			if (bSwap)
+				spoutcopy.rgba2rgb(pData, destpixels, srcWidth, srcHeight, rowPitch, bInvert, true);
+			else
+				spoutcopy.rgba2rgb(pData, destpixels, srcWidth, srcHeight, rowPitch, bInvert, false);
+		}
+	}
+	else {
+		if (width != srcWidth || height != srcHeight) {
+			spoutcopy.rgba2rgbResample(pData, destpixels, srcWidth, srcHeight, rowPitch, width, height, bInvert, m_bMirror, m_bSwapRB);
+		}
+		else {
+			// Approx 5 msec at 1920x1080
+			spoutcopy.rgba2rgb(pData, destpixels, srcWidth, srcHeight, rowPitch, bInvert, m_bMirror, m_bSwapRB);
+		}
+
+	}
+
+	if (pRGBA)
+		delete[] pRGBA;
+
+}
+
+// Read the changed regions from an rgba staging texture of the sender size
+// to a pixel buffer that has the previous frame
+bool spoutDX::ReadDirtyPixels(ID3D11Texture2D* pStagingSource, unsigned char* destpixels,
+	const RECT* pRects, unsigned int nRects, bool bInvert)
+{
+	if (!m_pImmediateContext || !pStagingSource || !destpixels)
+		return false;
+
+	// Nothing changed
+	if (!pRects || nRects == 0)
+		return true;
+
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+	m_pImmediateContext->Flush();
+	SpoutTrace(SPOUT_TRACE_MAP_BEGIN, m_SenderName, frame.GetSenderFrame64());
+	const HRESULT hr = m_pImmediateContext->Map(pStagingSource, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	SpoutTrace(SPOUT_TRACE_MAP_END, m_SenderName, frame.GetSenderFrame64());
+	if (FAILED(hr))
+		return false;
+
+	const unsigned char* pSource = static_cast<const unsigned char*>(mappedSubResource.pData);
+	D3D11_BOX box={};
+	SpoutTrace(SPOUT_TRACE_CONVERT_BEGIN, m_SenderName, frame.GetSenderFrame64());
+	const LONG64 copyStart = timer.Start();
+	for (unsigned int i = 0; i < nRects; i++) {
+		if (!DirtyRectBox(pRects[i], m_Width, m_Height, box))
+			continue;
+		// Destination rows are reversed for invert
+		const unsigned int desty = bInvert ? m_Height - box.bottom : box.top;
+		spoutcopy.rgba2rgba(pSource + (uint64_t)box.top*mappedSubResource.RowPitch + (uint64_t)box.left*4,
+			destpixels + ((uint64_t)desty*m_Width + box.left)*4,
+			box.right-box.left, box.bottom-box.top,
+			mappedSubResource.RowPitch, m_Width*4, bInvert);
+	}
+	timer.Stop("spoutCopy", copyStart);
+	SpoutTrace(SPOUT_TRACE_CONVERT_END, m_SenderName, frame.GetSenderFrame64());
+	m_pImmediateContext->Unmap(pStagingSource, 0);
+
+	return true;
+}
+
+// Copy the regions changed in the last nFrames frames received
+// to a texture that has the frame received before them
+void spoutDX::CopyDirtyRects(ID3D11Texture2D* pDest, ID3D11Texture2D* pSource, unsigned int nFrames)
 {
-	return spoutdx.SetPreferredAdapter(preference);
+	const RECT* pRects = nullptr;
+	unsigned int nRects = 0;
+	D3D11_BOX box={};
+	for (unsigned int age = 0; age < nFrames; age++) {
+		if (!frame.GetDirtyRects(age, &pRects, nRects))
+			continue;
+		for (unsigned int i = 0; i < nRects; i++) {
+			if (DirtyRectBox(pRects[i], m_Width, m_Height, box))
+				m_pImmediateContext->CopySubresourceRegion(pDest, 0, box.left, box.top, 0, pSource, 0, &box);
+		}
+	}
 }
 
 
-//---------------------------------------------------------
-// Function: IsPreferenceAvailable()
-// Availability of Windows graphics preference settings.
-//
-// Settings are available from Windows 10 April 2018 update 
-// (Version 1803, build 17134) and later.
-bool spoutDX::IsPreferenceAvailable()
+// Create new class staging textures if changed size or do not exist yet
+bool spoutDX::CheckStagingTextures(unsigned int width, unsigned int height, DWORD dwFormat)
 {
-	return spoutdx.IsPreferenceAvailable();
+	if (!m_pd3dDevice) {
+		return false;
+	}
+
+	if (m_pStaging[0] && m_pStaging[1]) {
+
+		// A staging texture cannot be released while mapped
+		ReleaseImageView();
+
+		// Get the texture details to test for change (both textures are the same)
+		D3D11_TEXTURE2D_DESC desc={0};
+		m_pStaging[0]->GetDesc(&desc);
+
+		// Return if the same size and format
+		if (desc.Width == width && desc.Height == height && desc.Format == (DXGI_FORMAT)dwFormat)
+			return true;
+
+		// Drop through to create new staging textures
+		m_Index = 0;
+		m_NextIndex = 0;
+		m_StagingFrame[0] = 0;
+		m_StagingFrame[1] = 0;
+		m_bStagingView[0] = false;
+		m_bStagingView[1] = false;
+		m_bReadPending = false;
+
+	}
+
+	// The SpoutDirectX function returns an existing texture to the pool
+	// and checks for zero or DX9 format. Textures of the same size and
+	// format released by other objects in the process are re-used.
+	if(spoutdx.AcquireStagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pStaging[0])
+	&& spoutdx.AcquireStagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pStaging[1])) {
+		// Flush now to avoid deferred object destruction
+		if (m_pImmediateContext) m_pImmediateContext->Flush();
+		// New staging textures are copied whole
+		frame.ResetDirtyRects();
+		m_pDirtyPixels = nullptr;
+		return true;
+	}
+
+	return false;
 }
 
-//---------------------------------------------------------
-// Function: IsApplicationPath
+
 //
-// Is the path a valid application
+// COMPUTE SHADER CONVERSION FOR RECEIVEIMAGE
 //
-// A valid application path will have a drive letter and terminate with ".exe"
-bool spoutDX::IsApplicationPath(const char* path)
+
+// Compile the conversion shader and create the constant buffer
+// The compiler is loaded from d3dcompiler_47.dll when first used
+// so that applications do not need to link with it.
+// bYUV - planar YUV shader for ReceiveImageYUV
+bool spoutDX::CreateConvertShader(bool bYUV)
 {
-	return spoutdx.IsApplicationPath(path);
+	ID3D11ComputeShader** ppShader = bYUV ? &m_pConvertYUVShader : &m_pConvertShader;
+	if (*ppShader && m_pConvertConstants)
+		return true;
+
+	if (!m_pd3dDevice)
+		return false;
+
+	// ReceiveImage conversion is disabled if the shader fails
+	// but not for a YUV shader failure.
+	if (!*ppShader) {
+		*ppShader = CompileComputeShader(bYUV ? g_ConvertYUVShader : g_ConvertShader);
+		if (!*ppShader) {
+			if (!bYUV) {
+				m_bComputeConversion = false;
+				m_bComputeRGB = false;
+			}
+			return false;
+		}
+	}
+
+	// Constant buffer shared by both shaders
+	if (m_pConvertConstants)
+		return true;
+
+	D3D11_BUFFER_DESC desc={};
+	desc.ByteWidth = 12*sizeof(UINT); // Multiple of 16 bytes
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	const HRESULT hr = m_pd3dDevice->CreateBuffer(&desc, nullptr, &m_pConvertConstants);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CreateConvertShader - constant buffer failed (0x%.7X)", (unsigned int)hr);
+		m_pConvertConstants = nullptr;
+		return false;
+	}
+
+	return true;
 }
-#endif
 
+// Compile a compute shader with D3DCompile (d3dcompiler_47.dll)
+ID3D11ComputeShader* spoutDX::CompileComputeShader(const char* shader)
+{
+	if (!m_pd3dDevice || !shader)
+		return nullptr;
 
-//
-// Group: Data sharing
-//
-//   General purpose data exchange functions using shared memory.
-//   These functions can be used in addition to texture sharing.
-//   Typical uses will be for data attached to the video frame,
-//   commonly referred to as "per frame Metadata".
-//
-//   Notes for synchronisation.
-//
-//   If used before sending and after receiving, the data will be 
-//   associated with the same video frame, but frames may be missed 
-//   if the receiver has a lower frame rate than the sender.
-//
-//   If strict synchronization is required, the data sharing functions
-//   should be used in combination with event signal functions. The sender
-//   frame rate will be matched exactly to that of the receiver and the 
-//   receiver will not miss any frames.
-//
-//      - void SetFrameSync(const char* SenderName);
-//      - bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
-//
-//   WaitFrameSync
-//   A sender should use this before rendering or sending texture or data and
-//   wait for a signal from the receiver that it is ready to read another frame.
-//
-//   SetFrameSync
-//   After receiving a texture, rendering the result and reading data
-//   a receiver should signal that it is ready to read another. 
-//
+	static pD3DCompile pCompile = nullptr;
+	if (!pCompile) {
+		HMODULE hCompiler = LoadLibraryA("d3dcompiler_47.dll");
+		if (hCompiler)
+			pCompile = (pD3DCompile)GetProcAddress(hCompiler, "D3DCompile");
+	}
+	if (!pCompile) {
+		SpoutLogWarning("spoutDX::CompileComputeShader - D3DCompile not available");
+		return nullptr;
+	}
 
-//---------------------------------------------------------
-// Function: WriteMemoryBuffer
-// Write buffer to sender shared memory.
-//
-//    If shared memory has not been created in advance, it will be
-//    created on the first call to this function at the length specified.
-//
-//    This is acceptable if the data to send is fixed in length.
-//    Otherwise the shared memory should be created in advance of sufficient
-//    size to contain the maximum length expected (see CreateMemoryBuffer).
-//
-//    The map is closed when the sender is released.
-//
-bool spoutDX::WriteMemoryBuffer(const char *name, const char* data, int length)
+	ID3DBlob* pShaderBlob = nullptr;
+	ID3DBlob* pErrorBlob = nullptr;
+	HRESULT hr = pCompile(shader, strlen(shader), nullptr, nullptr, nullptr,
+		"main", "cs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pShaderBlob, &pErrorBlob);
+	if (FAILED(hr)) {
+		if (pErrorBlob) {
+			SpoutLogError("spoutDX::CompileComputeShader - compile failed\n%s", (const char*)pErrorBlob->GetBufferPointer());
+			pErrorBlob->Release();
+		}
+		if (pShaderBlob) pShaderBlob->Release();
+		return nullptr;
+	}
+	if (pErrorBlob) pErrorBlob->Release();
+
+	ID3D11ComputeShader* pShader = nullptr;
+	hr = m_pd3dDevice->CreateComputeShader(pShaderBlob->GetBufferPointer(),
+		pShaderBlob->GetBufferSize(), nullptr, &pShader);
+	pShaderBlob->Release();
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CompileComputeShader - CreateComputeShader failed (0x%.7X)", (unsigned int)hr);
+		return nullptr;
+	}
+
+	return pShader;
+}
+
+// Create the conversion output buffer and staging buffers
+// if changed size or do not exist yet
+bool spoutDX::CheckConvertBuffers(unsigned int size)
 {
-	// Quit if 2.006 memoryshare mode
-	if (m_bMemoryShare)
+	if (!m_pd3dDevice || size == 0)
 		return false;
 
-	if (!name || !name[0]) {
-		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no name");
+	if (m_pConvertBuffer && size == m_ConvertSize)
+		return true;
+
+	// Release existing buffers
+	if (m_pConvertUAV) m_pConvertUAV->Release();
+	if (m_pConvertBuffer) m_pConvertBuffer->Release();
+	if (m_pConvertStaging[0]) m_pConvertStaging[0]->Release();
+	if (m_pConvertStaging[1]) m_pConvertStaging[1]->Release();
+	m_pConvertUAV = nullptr;
+	m_pConvertBuffer = nullptr;
+	m_pConvertStaging[0] = nullptr;
+	m_pConvertStaging[1] = nullptr;
+	m_ConvertSize = 0;
+
+	// The shader writes 32 bit words
+	const unsigned int bytes = (size + 3) & ~3u;
+
+	D3D11_BUFFER_DESC desc={};
+	desc.ByteWidth = bytes;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+	HRESULT hr = m_pd3dDevice->CreateBuffer(&desc, nullptr, &m_pConvertBuffer);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CheckConvertBuffers - buffer failed (0x%.7X)", (unsigned int)hr);
+		m_pConvertBuffer = nullptr;
 		return false;
 	}
 
-	if (!data) {
-		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no data");
+	D3D11_UNORDERED_ACCESS_VIEW_DESC uavdesc={};
+	uavdesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	uavdesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+	uavdesc.Buffer.FirstElement = 0;
+	uavdesc.Buffer.NumElements = bytes/4;
+	uavdesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+	hr = m_pd3dDevice->CreateUnorderedAccessView(m_pConvertBuffer, &uavdesc, &m_pConvertUAV);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CheckConvertBuffers - view failed (0x%.7X)", (unsigned int)hr);
+		m_pConvertUAV = nullptr;
 		return false;
 	}
 
-	// Create a shared memory map for the buffer if it does not exist yet
-	if (memorybuffer.Size() == 0) {
-		// Create a name for the map from the sender name
-		std::string namestring = name;
-		namestring += "_map";
-		// The first 16 bytes are reserved for the memory map size. Make the map larger to compensate. 
-		if (!memorybuffer.Create(namestring.c_str(), length + 16)) {
-			SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - could not create shared memory");
-			return false;
-		}
-		char* pBuffer = memorybuffer.Lock();
-		if (!pBuffer) {
-			SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no buffer lock");
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.MiscFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	for (int i = 0; i < 2; i++) {
+		hr = m_pd3dDevice->CreateBuffer(&desc, nullptr, &m_pConvertStaging[i]);
+		if (FAILED(hr)) {
+			SpoutLogError("spoutDX::CheckConvertBuffers - staging buffer failed (0x%.7X)", (unsigned int)hr);
+			m_pConvertStaging[i] = nullptr;
 			return false;
 		}
-		// Convert the map size to decimal digit chars directly to shared memory
-		_itoa_s(length, reinterpret_cast<char *>(pBuffer), 16, 10);
-		memorybuffer.Unlock();
-		SpoutLogNotice("SpoutSharedMemory::WriteMemoryBuffer - created memory buffer %d bytes", length);
 	}
 
-	char* pBuffer = memorybuffer.Lock();
-	if (!pBuffer) {
-		SpoutLogError("SpoutSharedMemory::WriteMemoryBuffer - no buffer lock");
+	m_ConvertSize = size;
+
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+
+	return true;
+}
+
+// Convert a texture to RGBA/BGRA/RGB/BGR pixels of the given size
+// and copy to the staging buffer m_Index.
+// Swap, mirror and the output order follow ReadPixelData.
+bool spoutDX::ConvertPixelData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+	bool bRGB, bool bInvert, bool bSwap)
+{
+	if (!m_pd3dDevice || !m_pImmediateContext || !pSource || width == 0 || height == 0)
 		return false;
+
+	// 8 bit RGBA and BGRA textures, or floating point if tone mapped
+	D3D11_TEXTURE2D_DESC desc={};
+	pSource->GetDesc(&desc);
+	const bool bToneMap = IsToneMapped()
+		&& (desc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT || desc.Format == DXGI_FORMAT_R32G32B32A32_FLOAT);
+	if (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM && !bToneMap)
+		return false;
+
+	if (!CreateConvertShader())
+		return false;
+
+	const unsigned int bpp = bRGB ? 3 : 4;
+	if (!CheckConvertBuffers(width*height*bpp))
+		return false;
+
+	// The shader loads RGBA. The buffer has the byte order
+	// of the texture unless red and blue are swapped.
+	bool bMirror = false;
+	if (bRGB && m_dwFormat != 28) { // DXGI_FORMAT_R8G8B8A8_UNORM
+		bSwap = m_bSwapRB;
+		bMirror = m_bMirror;
 	}
+	const bool bBGR = ((desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM) != bSwap);
+	UINT flags = (bInvert ? 1 : 0) | (bBGR ? 2 : 0) | (bMirror ? 4 : 0);
+	if (width != desc.Width || height != desc.Height) {
+		if (m_ResampleMode == 1) flags |= 8;
+		if (m_ResampleMode == 2) flags |= 16;
+	}
+	if (bToneMap)
+		flags |= (m_ToneMap == SPOUT_TONEMAP_ACES) ? 64 : 32;
 
-	// Write user data to shared memory (skip the map size)
-	memcpy(reinterpret_cast<void *>(pBuffer + 16), reinterpret_cast<const void *>(data), length);
+	return DispatchConvert(m_pConvertShader, pSource, width, height, bpp, flags);
+}
 
-	// Terminate the shared memory data with a null.
-	// The map is created larger in advance to allow for it.
-	if (memorybuffer.Size() > (16 + length))
-		*(pBuffer + 16 + length) = 0;
+// Convert a texture to planar YUV pixels of the given size
+// and copy to the staging buffer m_Index.
+bool spoutDX::ConvertYUVData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+	SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert)
+{
+	if (!m_pd3dDevice || !m_pImmediateContext || !pSource || width < 2 || height < 2)
+		return false;
 
-	memorybuffer.Unlock();
+	// 8 bit RGBA and BGRA textures
+	D3D11_TEXTURE2D_DESC desc={};
+	pSource->GetDesc(&desc);
+	if (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM)
+		return false;
 
-	return true;
+	if (!CreateConvertShader(true))
+		return false;
+
+	// Y plane and two chroma planes of quarter size
+	if (!CheckConvertBuffers(width*height*3/2))
+		return false;
+
+	const UINT flags = (bInvert ? 1 : 0) | (matrix == SPOUT_YUV_BT709 ? 2 : 0) | (bFullRange ? 4 : 0);
+
+	return DispatchConvert(m_pConvertYUVShader, pSource, width, height,
+		(layout == SPOUT_YUV_I420) ? 1 : 0, flags);
 }
 
-//---------------------------------------------------------
-// Function: ReadMemoryBuffer
-// Read sender shared memory to a buffer.
-//
-//    Open a sender memory map and retain the handle.
-//    The map is closed when the receiver is released.
-int spoutDX::ReadMemoryBuffer(const char* name, char* data, int maxlength)
+// Dispatch a conversion shader to the output buffer
+// and copy to the staging buffer m_Index.
+// The buffers must be created first by CheckConvertBuffers.
+// mode - bytes per pixel (ConvertPixelData) or planar layout (ConvertYUVData)
+bool spoutDX::DispatchConvert(ID3D11ComputeShader* pShader, ID3D11Texture2D* pSource,
+	unsigned int width, unsigned int height, unsigned int mode, unsigned int flags)
 {
-	// Quit if 2.006 memory share mode
-	if (m_bMemoryShare)
-		return 0;
+	if (!pShader || !m_pConvertBuffer)
+		return false;
 
-	if (!name || !name[0]) {
-		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no name");
-		return 0;
-	}
+	D3D11_TEXTURE2D_DESC desc={};
+	pSource->GetDesc(&desc);
 
-	if (!data) {
-		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no data");
-		return 0;
+	// A texture that cannot be bound to a shader is copied to the class texture
+	if (!(desc.BindFlags & D3D11_BIND_SHADER_RESOURCE)) {
+		if (!CheckTexture(desc.Width, desc.Height, desc.Format))
+			return false;
+		m_pImmediateContext->CopyResource(m_pTexture, pSource);
+		pSource = m_pTexture;
 	}
 
-	// Open a shared memory map for the buffer if it not already
-	if (!memorybuffer.Name()) {
-		// Create a name for the map from the sender name
-		std::string namestring = name;
-		namestring += "_map";
-		// Open the shared memory. This also creates a mutex
-		// for the reader to lock and unlock the map for reads.
-		if (!memorybuffer.Open(namestring.c_str())) {
-			return 0;
+	// Shader resource view of the source texture
+	if (pSource != m_pConvertSource) {
+		if (m_pConvertSRV) m_pConvertSRV->Release();
+		m_pConvertSRV = nullptr;
+		m_pConvertSource = nullptr;
+		const HRESULT hr = m_pd3dDevice->CreateShaderResourceView(pSource, nullptr, &m_pConvertSRV);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDX::DispatchConvert - shader resource view failed (0x%.7X)", (unsigned int)hr);
+			m_pConvertSRV = nullptr;
+			return false;
 		}
-		SpoutLogNotice("SpoutSharedMemory::ReadMemoryBuffer - opened sender memory map [%s]", memorybuffer.Name());
+		m_pConvertSource = pSource;
 	}
 
-	char* pBuffer = memorybuffer.Lock();
-	if (!pBuffer) {
-		SpoutLogError("SpoutSharedMemory::ReadMemoryBuffer - no buffer lock");
-		return 0;
+	// Dispatch groups of 256 words, limited to 65535 groups for each dimension
+	const UINT words = (m_ConvertSize + 3)/4;
+	const UINT groups = (words + 255)/256;
+	const UINT groupsX = groups < 65535 ? groups : 65535;
+	const UINT groupsY = (groups + groupsX - 1)/groupsX;
+	UINT params[12] = { desc.Width, desc.Height, width, height, mode, words, groupsX*256, flags };
+	memcpy(&params[8], &m_ToneMapExposure, sizeof(float)); // Tone map exposure (ConvertPixelData)
+	m_pImmediateContext->UpdateSubresource(m_pConvertConstants, 0, nullptr, params, 0, 0);
+
+	m_pImmediateContext->CSSetShader(pShader, nullptr, 0);
+	m_pImmediateContext->CSSetConstantBuffers(0, 1, &m_pConvertConstants);
+	m_pImmediateContext->CSSetShaderResources(0, 1, &m_pConvertSRV);
+	m_pImmediateContext->CSSetUnorderedAccessViews(0, 1, &m_pConvertUAV, nullptr);
+	m_pImmediateContext->Dispatch(groupsX, groupsY, 1);
+
+	// Unbind so that the texture and buffer can be used elsewhere
+	ID3D11ShaderResourceView* pNullSRV = nullptr;
+	ID3D11UnorderedAccessView* pNullUAV = nullptr;
+	ID3D11Buffer* pNullBuffer = nullptr;
+	m_pImmediateContext->CSSetShaderResources(0, 1, &pNullSRV);
+	m_pImmediateContext->CSSetUnorderedAccessViews(0, 1, &pNullUAV, nullptr);
+	m_pImmediateContext->CSSetConstantBuffers(0, 1, &pNullBuffer);
+	m_pImmediateContext->CSSetShader(nullptr, nullptr, 0);
+
+	// Copy to the first staging buffer
+	m_pImmediateContext->CopyResource(m_pConvertStaging[m_Index], m_pConvertBuffer);
+
+	return true;
+}
+
+// Copy the converted pixels from the staging buffer m_NextIndex
+// size - bytes of the receiving buffer
+// lines, destPitch - lines of the buffer and bytes of each line including padding
+bool spoutDX::ReadConvertedData(unsigned char* destpixels, unsigned int size,
+	unsigned int lines, unsigned int destPitch)
+{
+	if (!m_pImmediateContext || !destpixels || !m_pConvertStaging[m_NextIndex])
+		return false;
+
+	if (size != m_ConvertSize)
+		return false;
+
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+	// Make sure all commands are done before mapping the staging buffer
+	m_pImmediateContext->Flush();
+	// Map waits for GPU access
+	const HRESULT hr = m_pImmediateContext->Map(m_pConvertStaging[m_NextIndex], 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	if (FAILED(hr))
+		return false;
+
+	// Already in the layout and size of the receiving buffer
+	const unsigned int rowbytes = (lines > 0) ? size/lines : 0;
+	if (destPitch > rowbytes && rowbytes > 0) {
+		const unsigned char* src = static_cast<const unsigned char*>(mappedSubResource.pData);
+		for (unsigned int y = 0; y < lines; y++)
+			memcpy(destpixels + (uint64_t)y * destPitch, src + (uint64_t)y * rowbytes, rowbytes);
+	}
+	else {
+		memcpy(destpixels, mappedSubResource.pData, size);
 	}
 
-	// The memory map includes it's size, saved as the first 16 bytes
-	*(pBuffer + 15) = 0; // End for atoi
+	m_pImmediateContext->Unmap(m_pConvertStaging[m_NextIndex], 0);
+
+	return true;
+}
+
+// Release compute conversion objects
+void spoutDX::ReleaseConvert()
+{
+	if (m_pConvertSRV) m_pConvertSRV->Release();
+	if (m_pConvertUAV) m_pConvertUAV->Release();
+	if (m_pConvertBuffer) m_pConvertBuffer->Release();
+	if (m_pConvertStaging[0]) m_pConvertStaging[0]->Release();
+	if (m_pConvertStaging[1]) m_pConvertStaging[1]->Release();
+	if (m_pConvertConstants) m_pConvertConstants->Release();
+	if (m_pConvertShader) m_pConvertShader->Release();
+	if (m_pConvertYUVShader) m_pConvertYUVShader->Release();
+	m_pConvertSRV = nullptr;
+	m_pConvertSource = nullptr;
+	m_pConvertUAV = nullptr;
+	m_pConvertBuffer = nullptr;
+	m_pConvertStaging[0] = nullptr;
+	m_pConvertStaging[1] = nullptr;
+	m_pConvertConstants = nullptr;
+	m_pConvertShader = nullptr;
+	m_pConvertYUVShader = nullptr;
+	m_ConvertSize = 0;
+
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
+}
+
+//
+// Texture analysis (see SetReceiveAnalysis)
+//
+
+// Create the scope shader, output buffer and staging buffers if they do not exist yet
+bool spoutDX::CheckScopeBuffers()
+{
+	if (!m_pd3dDevice)
+		return false;
 
-	// Number of bytes available for data transfer
-	int nbytes = atoi(reinterpret_cast<char *>(pBuffer));
+	if (m_pScopeShader && m_pScopeUAV && m_pScopeStaging[1])
+		return true;
 
-	// Reduce if the user buffer max length is less
-	if (maxlength < nbytes)
-		nbytes = maxlength;
+	ReleaseScope();
 
-	// Copy bytes from shared memory to the user buffer
-	if (nbytes > 0)
-		memcpy(reinterpret_cast<void *>(data), reinterpret_cast<const void *>(pBuffer + 16), nbytes);
+	m_pScopeShader = CompileComputeShader(g_ScopeShader);
+	if (!m_pScopeShader)
+		return false;
 
-	// Done with the shared memory buffer pointer
-	memorybuffer.Unlock();
+	D3D11_BUFFER_DESC desc={};
+	desc.ByteWidth = SPOUT_SCOPE_WORDS*4;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+	HRESULT hr = m_pd3dDevice->CreateBuffer(&desc, nullptr, &m_pScopeBuffer);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CheckScopeBuffers - buffer failed (0x%.7X)", (unsigned int)hr);
+		m_pScopeBuffer = nullptr;
+		ReleaseScope();
+		return false;
+	}
 
-	return nbytes;
+	D3D11_UNORDERED_ACCESS_VIEW_DESC uavdesc={};
+	uavdesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	uavdesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+	uavdesc.Buffer.FirstElement = 0;
+	uavdesc.Buffer.NumElements = SPOUT_SCOPE_WORDS;
+	uavdesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+	hr = m_pd3dDevice->CreateUnorderedAccessView(m_pScopeBuffer, &uavdesc, &m_pScopeUAV);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX::CheckScopeBuffers - view failed (0x%.7X)", (unsigned int)hr);
+		m_pScopeUAV = nullptr;
+		ReleaseScope();
+		return false;
+	}
+
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.MiscFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	for (int i = 0; i < 2; i++) {
+		hr = m_pd3dDevice->CreateBuffer(&desc, nullptr, &m_pScopeStaging[i]);
+		if (FAILED(hr)) {
+			SpoutLogError("spoutDX::CheckScopeBuffers - staging buffer failed (0x%.7X)", (unsigned int)hr);
+			m_pScopeStaging[i] = nullptr;
+			ReleaseScope();
+			return false;
+		}
+	}
 
+	return true;
 }
 
-//---------------------------------------------------------
-// Function: CreateMemoryBuffer
-// Create a sender shared memory buffer.
-//
-//    Create a memory map and retain the handle.
-//    This function should be called before any buffer write
-//    if the length of the data to send will vary.
-//    The map is closed when the sender is released.
-bool spoutDX::CreateMemoryBuffer(const char *name, int length)
+// Histograms and waveform of a texture by compute shader.
+// The result is copied to alternate staging buffers
+// and is retrieved by GetAnalysis without waiting for the GPU.
+bool spoutDX::AnalyzeTexture(ID3D11Texture2D* pTexture)
 {
-	// Quit if 2.006 memoryshare mode
-	if (m_bMemoryShare)
+	if (!m_pImmediateContext || !pTexture)
 		return false;
 
-	if (!name || !name[0]) {
-		SpoutLogError("spoutDX::CreateMemoryBuffer - no name");
+	if (!CheckScopeBuffers())
 		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+
+	// A texture that cannot be bound to a shader is copied to the class texture
+	if (!(desc.BindFlags & D3D11_BIND_SHADER_RESOURCE)) {
+		if (!CheckTexture(desc.Width, desc.Height, desc.Format))
+			return false;
+		m_pImmediateContext->CopyResource(m_pTexture, pTexture);
+		pTexture = m_pTexture;
 	}
 
-	if (memorybuffer.Size() > 0) {
-		SpoutLogError("spoutDX::CreateMemoryBuffer - shared memory already exists");
-		return false;
+	// Shader resource view of the source texture
+	if (pTexture != m_pScopeSource) {
+		if (m_pScopeSRV) m_pScopeSRV->Release();
+		m_pScopeSRV = nullptr;
+		m_pScopeSource = nullptr;
+		const HRESULT hr = m_pd3dDevice->CreateShaderResourceView(pTexture, nullptr, &m_pScopeSRV);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDX::AnalyzeTexture - shader resource view failed (0x%.7X)", (unsigned int)hr);
+			m_pScopeSRV = nullptr;
+			return false;
+		}
+		m_pScopeSource = pTexture;
 	}
 
-	// Create a name for the map from the sender name
-	std::string namestring = name;
-	namestring += "_map";
+	// Counts are accumulated, so clear the buffer first
+	const UINT zero[4] = { 0, 0, 0, 0 };
+	m_pImmediateContext->ClearUnorderedAccessViewUint(m_pScopeUAV, zero);
+
+	m_pImmediateContext->CSSetShader(m_pScopeShader, nullptr, 0);
+	m_pImmediateContext->CSSetShaderResources(0, 1, &m_pScopeSRV);
+	m_pImmediateContext->CSSetUnorderedAccessViews(0, 1, &m_pScopeUAV, nullptr);
+	m_pImmediateContext->Dispatch((desc.Width + 15)/16, (desc.Height + 15)/16, 1);
+
+	// Unbind so that the texture and buffer can be used elsewhere
+	ID3D11ShaderResourceView* pNullSRV = nullptr;
+	ID3D11UnorderedAccessView* pNullUAV = nullptr;
+	m_pImmediateContext->CSSetShaderResources(0, 1, &pNullSRV);
+	m_pImmediateContext->CSSetUnorderedAccessViews(0, 1, &pNullUAV, nullptr);
+	m_pImmediateContext->CSSetShader(nullptr, nullptr, 0);
+
+	// Copy to the next staging buffer and submit
+	// so that the copy completes while the application continues
+	m_pImmediateContext->CopyResource(m_pScopeStaging[m_ScopeIndex], m_pScopeBuffer);
+	m_pImmediateContext->Flush();
+	m_bScopePending[m_ScopeIndex] = true;
+	m_ScopeIndex = 1 - m_ScopeIndex;
 
-	// The first 16 bytes are reserved to record the number of bytes available
-	// for data transfer. Make the map 16 bytes larger to compensate. 
-	// Add another 16 bytes to allow for a null terminator.
-	// (Use multiples of 16 for alignment to allow for SSE copy : TODO).
-	if (!memorybuffer.Create(namestring.c_str(), length + 32)) {
-		SpoutLogError("spoutGL::CreateMemoryBuffer - could not create shared memory");
+	return true;
+}
+
+// Retrieve the latest completed result of AnalyzeTexture.
+// Without wait, the most recent copy is used if the GPU has finished it,
+// otherwise the previous one. Returns false if neither is available.
+bool spoutDX::GetAnalysis(SpoutScopeData &data, bool bWait)
+{
+	if (!m_pImmediateContext || !m_pScopeStaging[0] || !m_pScopeStaging[1])
 		return false;
+
+	// Most recent copy first
+	const int order[2] = { 1 - m_ScopeIndex, m_ScopeIndex };
+	for (int n = 0; n < 2; n++) {
+		const int i = order[n];
+		if (!m_bScopePending[i])
+			continue;
+		D3D11_MAPPED_SUBRESOURCE mapped={};
+		const UINT flags = (bWait && n == 0) ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT;
+		if (SUCCEEDED(m_pImmediateContext->Map(m_pScopeStaging[i], 0, D3D11_MAP_READ, flags, &mapped))) {
+			SpoutScopeResult(static_cast<const unsigned int*>(mapped.pData), data);
+			m_pImmediateContext->Unmap(m_pScopeStaging[i], 0);
+			return true;
+		}
 	}
+	return false;
+}
 
-	// The length requested is the number of bytes to be
-	// available for data transfer (map data size).
-	char* pBuffer = memorybuffer.Lock();
-	if (!pBuffer) {
-		SpoutLogError("spoutGL::CreateMemoryBuffer - no buffer lock");
+// Release texture analysis objects
+void spoutDX::ReleaseScope()
+{
+	if (m_pScopeSRV) m_pScopeSRV->Release();
+	if (m_pScopeUAV) m_pScopeUAV->Release();
+	if (m_pScopeBuffer) m_pScopeBuffer->Release();
+	if (m_pScopeStaging[0]) m_pScopeStaging[0]->Release();
+	if (m_pScopeStaging[1]) m_pScopeStaging[1]->Release();
+	if (m_pScopeShader) m_pScopeShader->Release();
+	m_pScopeSRV = nullptr;
+	m_pScopeSource = nullptr;
+	m_pScopeUAV = nullptr;
+	m_pScopeBuffer = nullptr;
+	m_pScopeStaging[0] = nullptr;
+	m_pScopeStaging[1] = nullptr;
+	m_pScopeShader = nullptr;
+	m_bScopePending[0] = false;
+	m_bScopePending[1] = false;
+	m_ScopeIndex = 0;
+}
+
+// Create new class texture if changed size or does not exist yet
+bool spoutDX::CheckTexture(unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	if (!m_pd3dDevice)
 		return false;
-	}
 
-	// Convert the map data size to decimal digit chars
-	// directly to the first 16 bytes of the shared memory.
-	_itoa_s(length, reinterpret_cast<char *>(pBuffer), 16, 10);
+	if (m_pTexture) {
+		
+		// Get the texture details to test for change
+		D3D11_TEXTURE2D_DESC desc = { 0 };
+		m_pTexture->GetDesc(&desc);
+		
+		// Return if the same size, format and number of views
+		if (desc.Width == width && desc.Height == height && desc.Format == (DXGI_FORMAT)dwFormat
+			&& desc.ArraySize == m_ArraySize)
+			return true;
 
-	memorybuffer.Unlock();
+		// Drop through to create new texture
+	}
 
-	SpoutLogNotice("spoutDXL::CreateMemoryBuffer - created memory buffer %d bytes", length);
+	// The SpoutDirectX function releases an existing texture and checks for zero or DX9 format
+	return spoutdx.CreateDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pTexture, m_ArraySize);
 
-	return true;
 }
 
-//---------------------------------------------------------
-// Function: DeleteMemoryBuffer
-// Delete a sender shared memory buffer.
-//
-bool spoutDX::DeleteMemoryBuffer()
+// Create or update the application texture set by SetReceiverTexture.
+// bCreated is set true if the texture is re-created.
+bool spoutDX::CheckReceiverTexture(unsigned int width, unsigned int height, DWORD dwFormat, bool &bCreated)
 {
-	// Quit if 2.006 memoryshare mode
-	if (m_bMemoryShare)
+	bCreated = false;
+
+	if (!m_pd3dDevice || !m_ppReceiverTexture)
 		return false;
 
-	// A sender must create a map
-	// A receiver must open a sender map to find the size
-	if (memorybuffer.Size() == 0) {
-		SpoutLogError("spoutDX::DeleteMemoryBuffer - no shared memory size");
+	D3D11_TEXTURE2D_DESC desc = { 0 };
+	if (*m_ppReceiverTexture) {
+		// Return if the same size, format and number of views
+		(*m_ppReceiverTexture)->GetDesc(&desc);
+		if (desc.Width == width && desc.Height == height && desc.Format == (DXGI_FORMAT)dwFormat
+			&& desc.ArraySize == m_ArraySize)
+			return true;
+		// Drop through to create a new texture with the same usage
+	}
+	else {
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	}
+
+	// Same size and format as the sender texture for CopyResource
+	desc.Width = width;
+	desc.Height = height;
+	desc.Format = (DXGI_FORMAT)dwFormat;
+	desc.MipLevels = 1;
+	desc.ArraySize = m_ArraySize;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.MiscFlags &= ~D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+	ID3D11Texture2D* pTexture = nullptr;
+	const HRESULT hr = m_pd3dDevice->CreateTexture2D(&desc, nullptr, &pTexture);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX::CheckReceiverTexture - could not create %dx%d texture format %d (0x%.7X)",
+			width, height, dwFormat, (unsigned int)hr);
 		return false;
 	}
 
-	memorybuffer.Close();
+	if (*m_ppReceiverTexture)
+		(*m_ppReceiverTexture)->Release();
+	*m_ppReceiverTexture = pTexture;
+	bCreated = true;
 
-	return true;
+	SpoutLogNotice("spoutDX::CheckReceiverTexture - created %dx%d texture format %d", width, height, dwFormat);
 
+	return true;
 }
 
 
-//---------------------------------------------------------
-// Function: GetMemoryBufferSize
-// Get the size of a sender shared memory buffer.
 //
-int spoutDX::GetMemoryBufferSize(const char *name)
+// The following functions are adapted from equivalents in SpoutSDK.cpp
+// for applications not using the entire Spout SDK.
+//
+
+// Pop up SpoutPanel to allow the user to select a sender
+// Usually activated by RH click
+void spoutDX::SelectSenderPanel()
 {
-	if (!m_bSpoutInitialized)
-		return 0;
+	HANDLE hMutex1 = NULL;
+	HMODULE module = NULL;
+	char path[MAX_PATH]={};
+	char drive[MAX_PATH]={};;
+	char dir[MAX_PATH]={};
+	char fname[MAX_PATH]={};
 
-	// A writer has created the map and recorded the data length in the first 16 bytes.
-	// Another 16 bytes is added to allow for a terminating NULL. (See CreateMemoryBuffer)
-	// The remaining length is the number of bytes available for data transfer.
-	if (memorybuffer.Size() > 32) {
-		return memorybuffer.Size() - 32;
-	}
+	// The selected sender is then the "Active" sender and this receiver switches to it.
+	// If Spout is not installed, SpoutPanel.exe has to be in the same folder
+	// as this executable. This rather complicated process avoids having to use a dialog
+	// which causes problems with host GUI messaging.
 
-	// A reader must read the map to get the size
-	// Open a shared memory map for the buffer if it not already
-	if (!memorybuffer.Name()) {
-		// Create a name for the map
-		std::string namestring = name;
-		namestring += "_map";
-		// Open the shared memory map.
-		// This also creates a mutex for the receiver to lock and unlock the map for reads.
-		if (!memorybuffer.Open(namestring.c_str())) {
-			return 0;
+	// First find if there has been a Spout installation >= 2.002 with an install path for SpoutPanel.exe
+	if (!ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "InstallPath", path)) {
+		// Path not registered so find the path of the host program
+		// where SpoutPanel should have been copied
+		module = GetModuleHandle(NULL);
+		GetModuleFileNameA(module, path, MAX_PATH);
+		_splitpath_s(path, drive, MAX_PATH, dir, MAX_PATH, fname, MAX_PATH, NULL, 0);
+		_makepath_s(path, MAX_PATH, drive, dir, "SpoutPanel", ".exe");
+		// Does SpoutPanel.exe exist in this path ?
+		if(_access(path, 0) == -1) {
+		// if (!PathFileExistsA(path)) {
+			// Try the current working directory
+			if (_getcwd(path, MAX_PATH)) {
+				strcat_s(path, MAX_PATH, "\\SpoutPanel.exe");
+				// Does SpoutPanel exist here?
+				if (_access(path, 0) == -1) {
+				// if (!PathFileExistsA(path)) {
+					SpoutLogWarning("spoutDX::SelectSender - SpoutPanel path not found");
+					return;
+				}
+			}
 		}
-		SpoutLogNotice("spoutDX::GetMemoryBufferSize - opened sender memory map [%s]", memorybuffer.Name());
 	}
 
-	char* pBuffer = memorybuffer.Lock();
-	if (!pBuffer) {
-		SpoutLogError("spoutDX::GetMemoryBufferSize - no buffer lock");
-		return 0;
-	}
+	// Check whether the panel is already running
+	// Try to open the application mutex.
+	hMutex1 = OpenMutexA(MUTEX_ALL_ACCESS, 0, "SpoutPanel");
+	if (!hMutex1) {
+		// No mutex, so not running, so can open it
 
-	// The number of bytes of the memory map available for data transfer
-	// is saved in the first 16 bytes.
-	*(pBuffer + 15) = 0; // End for atoi
-	int nbytes = atoi(reinterpret_cast<char *>(pBuffer));
+		// First release any orphaned senders if the name exists
+		// in the sender list but the shared memory info does not
+		// So that the sender list is clean
+		sendernames.CleanSenders();
 
-	memorybuffer.Unlock();
+		// Release a previous wait and process handle
+		ReleaseSpoutPanel();
+
+		// Use ShellExecuteEx so we can test its return value later
+		ZeroMemory(&m_ShExecInfo, sizeof(m_ShExecInfo));
+		m_ShExecInfo.cbSize = sizeof(SHELLEXECUTEINFO);
+		m_ShExecInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
+		m_ShExecInfo.hwnd = NULL;
+		m_ShExecInfo.lpVerb = NULL;
+		m_ShExecInfo.lpFile = (LPCSTR)path;
+		m_ShExecInfo.lpDirectory = NULL;
+		m_ShExecInfo.nShow = SW_SHOW;
+		m_ShExecInfo.hInstApp = NULL;
+		ShellExecuteExA(&m_ShExecInfo);
+
+		// Wait for the process to close on a thread pool thread
+		// so that the receiver does not test for it every frame
+		m_SpoutPanelClosed = 0;
+		if (m_ShExecInfo.hProcess) {
+			if (!RegisterWaitForSingleObject(&m_hSpoutPanelWait, m_ShExecInfo.hProcess,
+				SpoutPanelClosed, (PVOID)&m_SpoutPanelClosed, INFINITE, WT_EXECUTEONLYONCE)) {
+				m_hSpoutPanelWait = NULL;
+			}
+		}
+
+		//
+		// The flag "m_bSpoutPanelOpened" is set here to indicate that the user
+		// has opened the panel to select a sender. This flag is local to 
+		// this process so will not affect any other receiver instance
+		// Then when the selection panel closes, sender name is tested
+		//
+		m_bSpoutPanelOpened = true;
+	}
+	else {
+		// The mutex exists, so another instance is already running.
+		// Find the SpoutPanel window and bring it to the top.
+		// SpoutPanel is opened as topmost anyway but pop it to
+		// the front in case anything else has stolen topmost.
+		HWND hWnd = FindWindowA(NULL, (LPCSTR)"SpoutPanel");
+		if (hWnd && IsWindow(hWnd)) {
+			SetForegroundWindow(hWnd);
+			// prevent other windows from hiding the dialog
+			// and open the window wherever the user clicked
+			SetWindowPos(hWnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_ASYNCWINDOWPOS | SWP_SHOWWINDOW | SWP_NOSIZE | SWP_NOMOVE);
+		}
+		else if (path[0]) {
+			// If the window was not found but the mutex exists
+			// and SpoutPanel is installed, it has crashed.
+			// Terminate the process and the mutex or the mutex will remain
+			// and SpoutPanel will not be started again.
+			PROCESSENTRY32 pEntry={};
+			pEntry.dwSize = sizeof(pEntry);
+			bool done = false;
+			// Take a snapshot of all processes and threads in the system
+			HANDLE hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPALL, NULL);
+			if (hProcessSnap == INVALID_HANDLE_VALUE) {
+				SpoutLogError("spoutDX::OpenSpoutPanel - CreateToolhelp32Snapshot error");
+			}
+			else {
+				// Retrieve information about the first process
+				BOOL hRes = Process32First(hProcessSnap, &pEntry);
+				if (!hRes) {
+					SpoutLogError("spoutDX::OpenSpoutPanel - Process32First error");
+					CloseHandle(hProcessSnap);
+				}
+				else {
+					// Look through all processes
+					while (hRes && !done) {
+						const int value = _tcsicmp(pEntry.szExeFile, _T("SpoutPanel.exe"));
+						if (value == 0) {
+							HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, 0, (DWORD)pEntry.th32ProcessID);
+							if (hProcess != NULL) {
+								// Terminate SpoutPanel and it's mutex
+								TerminateProcess(hProcess, 9);
+								CloseHandle(hProcess);
+								done = true;
+							}
+						}
+						if (!done)
+							hRes = Process32Next(hProcessSnap, &pEntry); // Get the next process
+						else
+							hRes = NULL; // found SpoutPanel
+					}
+					CloseHandle(hProcessSnap);
+				}
+			}
+			// Now SpoutPanel will start the next time the user activates it
+		} // endif SpoutPanel crashed
+	} // endif SpoutPanel already open
 
-	return nbytes;
+	// If we opened the mutex, close it now or it is never released
+	if (hMutex1) CloseHandle(hMutex1);
 
-}
+	return;
 
-//
-// Sharing modes
-//
+} // end SelectSenderPanel
 
 //
-// Group: Retained for 2.006 compatibility
+// Check whether SpoutPanel opened and return the new sender name
+// or return a sender selected by SelectSender
 //
-
-//---------------------------------------------------------
-// Function: GetDX9
-// Get user DX9 mode
-bool spoutDX::GetDX9()
-{
-	DWORD dwDX9 = 0;
-	ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "DX9", &dwDX9);
-	return (dwDX9 == 1);
-}
-
-//---------------------------------------------------------
-// Function: GetMemoryShareMode
-// Get user memory share mode
-bool spoutDX::GetMemoryShareMode()
+bool spoutDX::CheckSpoutPanel(char *sendername, int maxchars)
 {
-	bool bRet = false;
-	DWORD dwMem = 0;
-	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", &dwMem)) {
-		bRet = (dwMem == 1);
+	// Sender selected without SpoutPanel
+	if (m_SelectedSender[0]) {
+		strcpy_s(sendername, maxchars, m_SelectedSender);
+		m_SelectedSender[0] = 0;
+		return true;
 	}
-	return bRet;
-}
 
-//
-// Utilities
-//
+	// If SpoutPanel has been activated, test if it has closed.
+	// The process wait sets a flag, so there are no registry reads
+	// or process checks while the panel is open.
+	if (!IsSpoutPanelClosed())
+		return false;
 
-//---------------------------------------------------------
-// Function: CreateDX11texture
-// Create a texture that is not shared
-bool spoutDX::CreateDX11texture(ID3D11Device* pd3dDevice,
-	unsigned int width, unsigned int height,
-	DXGI_FORMAT format, ID3D11Texture2D** ppTexture)
-{
-	return spoutdx.CreateDX11Texture(pd3dDevice, width, height, format, ppTexture);
-}
+	m_bSpoutPanelOpened = false; // Don't do this part again
+	m_bSpoutPanelActive = false;
 
-//---------------------------------------------------------
-// Function: CheckSenderFormat
-// Find sender shared memory.
-// If format is zero, try to open the sharehandle
-// and write the correct format back to shared memory
-// Also register the sender name if not already
-void spoutDX::CheckSenderFormat(const char * sendername)
-{
-	SharedTextureInfo info={};
+	// Get the exit code from SpoutPanel
+	DWORD dwExitCode = 1;
+	if (m_ShExecInfo.hProcess)
+		GetExitCodeProcess(m_ShExecInfo.hProcess, &dwExitCode);
+	ReleaseSpoutPanel();
 
-	// Correct for format 0 and un-registered
-	if (sendernames.getSharedInfo(sendername, &info)) {
-		if (info.format == 0) {
-			ID3D11Device *pDummyDevice = nullptr;
-			ID3D11Texture2D* pSharedTexture = nullptr;
-			pDummyDevice = spoutdx.CreateDX11device();
-			if (pDummyDevice) {
+	// Only act if exit code = 0 (OK)
+	if (dwExitCode != 0)
+		return false;
 
-				// Try to open the share handle
-				// If it's DirectX9, the handle will not open
-				if (spoutdx.OpenDX11shareHandle(pDummyDevice, &pSharedTexture, LongToHandle((LONG)info.shareHandle))) {
-					if (pSharedTexture) {
-						// Get the texture details
-						D3D11_TEXTURE2D_DESC desc;
-						pSharedTexture->GetDesc(&desc);
-						// Set the format to the sender info
-						info.format = (DWORD)desc.Format;
-						sendernames.setSharedInfo(sendername, &info);
-						pSharedTexture->Release();
-					}
+	// SpoutPanel has been activated and OK clicked
+	// Test the active sender which should have been set by SpoutPanel
+	SharedTextureInfo TextureInfo={};
+	char newname[256]={};
+	if (!sendernames.GetActiveSender(newname)) {
+		// Otherwise the sender might not be registered.
+		// SpoutPanel always writes the selected sender name to the registry.
+		if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "Sendername", newname)) {
+			// Register the sender if it exists
+			if (newname[0] != 0) {
+				if (sendernames.getSharedInfo(newname, &TextureInfo)) {
+					// Register in the list of senders and make it the active sender
+					sendernames.RegisterSenderName(newname);
+					sendernames.SetActiveSender(newname);
 				}
 			}
 		}
+	}
 
-		// Register the sender name if not already
-		sendernames.RegisterSenderName(sendername);
+	// Now do we have a valid sender name ?
+	if (newname[0] == 0)
+		return false;
+
+	// Pass back the new name
+	strcpy_s(sendername, maxchars, newname);
+
+	return true;
 
-		// Make active if there is no active sender
-		char activename[256]={};
-		if (!sendernames.GetActiveSender(activename))
-			sendernames.SetActiveSender(sendername);
-	}
 }
 
 //
-// SpoutUtils namespace functions for dll access
+// A sender has been selected by SelectSender or SpoutPanel has closed
 //
-
-void spoutDX::OpenSpoutConsole()
+bool spoutDX::IsSenderSelected()
 {
-	spoututils::OpenSpoutConsole();
+	return (m_SelectedSender[0] != 0 || IsSpoutPanelClosed());
 }
 
-void spoutDX::CloseSpoutConsole(bool bWarning)
+//
+// SpoutPanel opened by SelectSenderPanel has closed
+//
+bool spoutDX::IsSpoutPanelClosed()
 {
-	spoututils::CloseSpoutConsole(bWarning);
-}
+	if (!m_bSpoutPanelOpened)
+		return false;
 
-void spoutDX::EnableSpoutLog()
-{
-	spoututils::EnableSpoutLog();
-}
+	// Flag set by the process wait
+	if (m_hSpoutPanelWait)
+		return (InterlockedCompareExchange(&m_SpoutPanelClosed, 0, 0) != 0);
 
-void spoutDX::EnableSpoutLogFile(const char* filename, bool append)
-{
-	spoututils::EnableSpoutLogFile(filename, append);
-}
+	// Without a registered wait, test the process without waiting
+	if (m_ShExecInfo.hProcess)
+		return (WaitForSingleObject(m_ShExecInfo.hProcess, 0) == WAIT_OBJECT_0);
 
-void spoutDX::DisableSpoutLogFile()
-{
-	spoututils::DisableSpoutLogFile();
+	// SpoutPanel did not start
+	m_bSpoutPanelOpened = false;
+	return false;
 }
 
-void spoutDX::DisableSpoutLog()
+//
+// Release the SpoutPanel process wait and process handle
+//
+void spoutDX::ReleaseSpoutPanel()
 {
-	spoututils::DisableSpoutLog();
+	// Wait for a callback in progress to complete
+	if (m_hSpoutPanelWait)
+		UnregisterWaitEx(m_hSpoutPanelWait, INVALID_HANDLE_VALUE);
+	m_hSpoutPanelWait = NULL;
+	if (m_ShExecInfo.hProcess)
+		CloseHandle(m_ShExecInfo.hProcess);
+	m_ShExecInfo.hProcess = NULL;
 }
 
 
-
 //
-// PRIVATE
+// Group: Receive thread
+//
+// spoutReceiveThread receives to pixel buffers on a dedicated thread
+// so that the application does not wait for GPU readback.
+//
+// The thread has a spoutDX object with its own D3D11 device
+// and can be used with an application device on another thread.
+//
+// Three buffers are used :
+//   back  - written by ReceiveImage on the thread
+//   ready - the latest frame completed
+//   front - held by the application after AcquireFrame
+// A new frame exchanges back and ready. AcquireFrame exchanges
+// ready and front if there is a new frame. The front buffer
+// remains valid until the next AcquireFrame or Stop.
+//
+// Applications need not poll AcquireFrame. WaitFrame blocks until there
+// is a new frame, the frame event (GetFrameEvent) can be waited on with
+// other handles or by a thread pool wait or coroutine, and a callback
+// (SetFrameCallback) is called on the thread for each new frame.
+//
+// If the sender signals a sync event for each frame (SetFrameSync),
+// the thread waits on it rather than testing for a new frame each msec.
 //
 
-// --------------------------------------------------------
-// If a sender has not been created yet
-//    o Make sure DirectX is initialized
-//    o Create a shared texture for the sender
-//    o Create a sender using the DX11 shared texture handle
-// If the sender exists, test for size or format change
-//    o Re-create the class shared texture to the new size
-//    o Update the sender and class variables
-bool spoutDX::CheckSender(unsigned int width, unsigned int height, DWORD dwFormat)
+spoutReceiveThread::spoutReceiveThread()
 {
-	if (width == 0 || height == 0)
-		return false;
-
-	// The sender needs a name (default is the executable name)
-	if (!m_SenderName[0]) {
-		if (!SetSenderName())
-			return false;
+	m_hThread = NULL;
+	m_hStopEvent = NULL;
+	InitializeCriticalSection(&m_Lock);
+	for (int i = 0; i < 3; i++) {
+		m_pBuffer[i] = nullptr;
+		m_BufferSize[i] = 0;
+		m_BufferWidth[i] = 0;
+		m_BufferHeight[i] = 0;
+		m_BufferFrame[i] = 0;
 	}
+	m_Back = 0;
+	m_Ready = 1;
+	m_Front = 2;
+	m_bReadyNew = false;
+	// Auto-reset, so that one wait is released for each new frame
+	m_hFrameEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	m_FrameCallback = nullptr;
+	m_pCallbackData = nullptr;
+	m_bConnected = 0;
+	m_SenderName[0] = 0;
+	m_bRGB = false;
+	m_bInvert = false;
+}
 
-	if (!m_bSpoutInitialized) {
+spoutReceiveThread::~spoutReceiveThread()
+{
+	Stop();
+	if (m_hFrameEvent) CloseHandle(m_hFrameEvent);
+	DeleteCriticalSection(&m_Lock);
+}
 
-		// Make sure DirectX is initialized
-		if (!OpenDirectX11())
-			return false;
+//---------------------------------------------------------
+// Function: Start
+// Start receiving on a dedicated thread
+//   sendername - sender to connect to or the active sender if null
+//   bRGB       - rgb pixels, otherwise rgba
+//   bInvert    - flip the image
+bool spoutReceiveThread::Start(const char* sendername, bool bRGB, bool bInvert)
+{
+	if (m_hThread)
+		Stop();
 
-		// Create a shared texture for the sender
-		// A sender creates a new texture with a new share handle
-		// the existing shared texture is released
-		m_dxShareHandle = nullptr;
-		if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pSharedTexture, m_dxShareHandle)) {
-			SpoutLogWarning("spoutDX::CheckSender - could not create shared texture");
-			return false;
-		}
+	m_SenderName[0] = 0;
+	if (sendername && *sendername)
+		strcpy_s(m_SenderName, 256, sendername);
+	m_bRGB = bRGB;
+	m_bInvert = bInvert;
+	m_bReadyNew = false;
+	m_bConnected = 0;
+
+	m_hStopEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!m_hStopEvent) {
+		SpoutLogError("spoutReceiveThread::Start - could not create stop event (%d)", GetLastError());
+		return false;
+	}
 
-		// Save class width and height and format to test
-		// for sender size changes after initialization
-		m_Width = width;
-		m_Height = height;
-		m_dwFormat = dwFormat;
+	m_hThread = CreateThread(NULL, 0, ReceiveThread, this, 0, NULL);
+	if (!m_hThread) {
+		SpoutLogError("spoutReceiveThread::Start - could not create thread (%d)", GetLastError());
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+		return false;
+	}
 
-		// Create a sender using the DX11 shared texture handle (m_dxShareHandle)
-		// and specifying the same texture format.
-		if (sendernames.CreateSender(m_SenderName, m_Width, m_Height, m_dxShareHandle, m_dwFormat)) {
+	SpoutLogNotice("spoutReceiveThread::Start (%s)", m_SenderName[0] ? m_SenderName : "active sender");
 
-			// sendernames::SetSenderInfo writes the sender information to shared memory
-			// including the sender executable path
+	return true;
+}
 
-			// Create a sender mutex for access to the shared texture
-			frame.CreateAccessMutex(m_SenderName);
+//---------------------------------------------------------
+// Function: Stop
+// Stop the thread and release buffers
+void spoutReceiveThread::Stop()
+{
+	if (m_hThread) {
+		SetEvent(m_hStopEvent);
+		WaitForSingleObject(m_hThread, INFINITE);
+		CloseHandle(m_hThread);
+		m_hThread = NULL;
+		SpoutLogNotice("spoutReceiveThread::Stop");
+	}
+	if (m_hStopEvent) {
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+	}
+	for (int i = 0; i < 3; i++) {
+		if (m_pBuffer[i]) delete[] m_pBuffer[i];
+		m_pBuffer[i] = nullptr;
+		m_BufferSize[i] = 0;
+		m_BufferWidth[i] = 0;
+		m_BufferHeight[i] = 0;
+		m_BufferFrame[i] = 0;
+	}
+	m_bReadyNew = false;
+	m_bConnected = 0;
+}
 
-			// Enable frame counting so the receiver gets frame number and fps
-			frame.EnableFrameCount(m_SenderName);
+//---------------------------------------------------------
+// Function: IsRunning
+// Thread is running
+bool spoutReceiveThread::IsRunning()
+{
+	return (m_hThread != NULL);
+}
 
-			m_bSpoutInitialized = true;
-		}
-		else {
-			SpoutLogWarning("spoutDX::CheckSender - could not get create sender");
-			return false;
-		}
-	} // end create sender
+//---------------------------------------------------------
+// Function: IsConnected
+// The thread is connected to a sender
+bool spoutReceiveThread::IsConnected()
+{
+	return (InterlockedCompareExchange(&m_bConnected, 0, 0) != 0);
+}
 
-	// Initialized but has the source texture changed size ?
-	if (m_Width != width || m_Height != height || m_dwFormat != dwFormat) {
-		SpoutLogNotice("spoutDX::CheckSender - size change from %dx%d to %dx%d\n", m_Width, m_Height, width, height);
-		if (m_pSharedTexture) {
-			spoutdx.ReleaseDX11Texture(m_pSharedTexture);
-			// The existing shared texture is changed on this device
-			m_pImmediateContext->Flush();
-		}
-		m_pSharedTexture = nullptr;
-		m_dxShareHandle = nullptr;
+//---------------------------------------------------------
+// Function: AcquireFrame
+// Latest frame received.
+//
+// Does not wait for the receiving thread.
+// Returns true if the frame is new since the last call.
+// The frame is returned in either case and frame.data
+// is null if no frame has been received.
+// The pixels remain valid until the next AcquireFrame or Stop.
+bool spoutReceiveThread::AcquireFrame(SpoutThreadFrame &frame)
+{
+	bool bNew = false;
+
+	EnterCriticalSection(&m_Lock);
+	if (m_bReadyNew) {
+		const int front = m_Front;
+		m_Front = m_Ready;
+		m_Ready = front;
+		m_bReadyNew = false;
+		bNew = true;
+	}
+	const int index = m_Front;
+	LeaveCriticalSection(&m_Lock);
+
+	// The front buffer is not changed by the thread
+	frame.data = (m_BufferWidth[index] > 0) ? m_pBuffer[index] : nullptr;
+	frame.width = m_BufferWidth[index];
+	frame.height = m_BufferHeight[index];
+	frame.pitch = m_BufferWidth[index]*(m_bRGB ? 3 : 4);
+	frame.bRGB = m_bRGB;
+	frame.frame = m_BufferFrame[index];
+
+	return bNew;
+}
 
-		if (!spoutdx.CreateSharedDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pSharedTexture, m_dxShareHandle)) {
-			SpoutLogWarning("spoutDX::CheckSender - could not re-create shared texture");
-			return false;
+//---------------------------------------------------------
+// Function: WaitFrame
+// Wait for a new frame.
+//
+// Returns true with the new frame as for AcquireFrame, or false
+// if there is no new frame before the timeout in msec elapses.
+bool spoutReceiveThread::WaitFrame(SpoutThreadFrame &frame, DWORD dwTimeout)
+{
+	const DWORD dwStart = GetTickCount();
+	while (!AcquireFrame(frame)) {
+		DWORD dwRemain = INFINITE;
+		if (dwTimeout != INFINITE) {
+			const DWORD dwElapsed = GetTickCount()-dwStart;
+			if (dwElapsed >= dwTimeout)
+				return false;
+			dwRemain = dwTimeout-dwElapsed;
 		}
-
-		// Update the sender information
-		sendernames.UpdateSender(m_SenderName, width, height, m_dxShareHandle, dwFormat);
-
-		// Update class variables
-		m_Width = width;
-		m_Height = height;
-		m_dwFormat = dwFormat;
-
-	} // end size checks
-
+		// The event can be signalled for a frame already acquired,
+		// so test again after the wait
+		if (!m_hThread || WaitForSingleObject(m_hFrameEvent, dwRemain) != WAIT_OBJECT_0)
+			return false;
+	}
 	return true;
-
 }
 
-
 //---------------------------------------------------------
-// Used when the sender was there but the texture pointer could not be retrieved from the share handle.
-// Try using the sender adapter if different.
-ID3D11Texture2D* spoutDX::CheckSenderTexture(char *sendername, HANDLE dxShareHandle)
+// Function: GetFrameEvent
+// Event signalled for each new frame.
+//
+// The auto-reset event can be waited on with other handles, by a thread pool
+// wait (RegisterWaitForSingleObject) or by a coroutine that resumes on the
+// signal, and AcquireFrame then returns the frame. The event remains valid
+// for the life of the object.
+HANDLE spoutReceiveThread::GetFrameEvent()
 {
-	// If auto adapter switching not activated, return a NULL pointer
-	if (!m_bAdapt) {
-		SpoutLogWarning("spoutDX::CheckSenderTexture - no automatic switch to sender adapter");
-		return nullptr;
-	}
+	return m_hFrameEvent;
+}
 
-	ID3D11Texture2D* pTexture =  nullptr;
+//---------------------------------------------------------
+// Function: SetFrameCallback
+// Function called on the thread for each new frame.
+//
+// The frame is the latest buffer and the pixels remain valid until
+// the callback returns. The callback should copy or process them and
+// return quickly, because the thread does not receive meanwhile.
+// A null callback removes it.
+void spoutReceiveThread::SetFrameCallback(SpoutFrameCallback callback, void* pUserData)
+{
+	EnterCriticalSection(&m_Lock);
+	m_FrameCallback = callback;
+	m_pCallbackData = pUserData;
+	LeaveCriticalSection(&m_Lock);
+}
 
-	// Save the current adapter index
-	int receiverindex = GetAdapter();
+//
+// Protected
+//
 
-	// Get the sender adapter index
-	int senderindex = GetSenderAdapter(sendername);
-		
-	// If they are different, switch to the sender adapter
-	if (receiverindex != senderindex) {
+DWORD WINAPI spoutReceiveThread::ReceiveThread(LPVOID lpParameter)
+{
+	spoutReceiveThread* pThread = static_cast<spoutReceiveThread*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_FRAME);
+	pThread->ReceiveLoop();
+	EndSpoutThread(SPOUT_THREAD_FRAME, hTask);
+	return 0;
+}
 
-		CloseDirectX11(); // Close the current DX11 device
+// Receive until the stop event is set
+void spoutReceiveThread::ReceiveLoop()
+{
+	spoutDX receiver;
+	if (!receiver.OpenDirectX11()) {
+		SpoutLogError("spoutReceiveThread - could not open DirectX 11");
+		return;
+	}
+	if (m_SenderName[0])
+		receiver.SetReceiverName(m_SenderName);
 
-		SetAdapter(senderindex); // Change to the same adapter as the sender
-		
-		OpenDirectX11(); // Create a new device with that adapter
+	// Sync event of the connected sender if it has created one
+	HANDLE hSyncEvent = NULL;
+	char syncname[256]={};
+	DWORD dwSyncCheck = 0;
 
-		// Try again to get the texture pointer
-		if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &pTexture, dxShareHandle)) {
+	DWORD dwWait = 0;
+	while (WaitForSingleObject(m_hStopEvent, dwWait) == WAIT_TIMEOUT) {
 
-			// If that didn't work, change back to the original adapter
-			CloseDirectX11();
-			SetAdapter(receiverindex);
-			OpenDirectX11();
-			SpoutLogWarning("spoutDX::CheckSenderTexture - could not change to sender adapter %d", senderindex);
+		// Only the back buffer is changed by this thread
+		const int back = m_Back;
 
-			return nullptr;
+		// Buffer exchanged from an earlier sender size
+		if (receiver.GetSenderWidth() > 0 && (m_BufferWidth[back] != receiver.GetSenderWidth()
+			|| m_BufferHeight[back] != receiver.GetSenderHeight())) {
+			CheckBuffer(back, receiver.GetSenderWidth(), receiver.GetSenderHeight());
 		}
 
-		// The sharehandle opened OK with the new adapter
-		SpoutLogNotice("spoutDX::CheckSenderTexture - changed to sender adapter %d", senderindex);
+		const bool bReceived = receiver.ReceiveImage(m_pBuffer[back],
+			m_BufferWidth[back], m_BufferHeight[back], m_bRGB, m_bInvert);
 
-		return pTexture;
+		if (!bReceived) {
+			// No sender
+			InterlockedExchange(&m_bConnected, 0);
+			dwWait = 16;
+			continue;
+		}
+		InterlockedExchange(&m_bConnected, 1);
+
+		if (receiver.IsUpdated()) {
+			// Sender found or changed size
+			// The back buffer is updated to the sender size
+			// before the next ReceiveImage
+			CheckBuffer(back, receiver.GetSenderWidth(), receiver.GetSenderHeight());
+			dwWait = 0;
+			continue;
+		}
 
+		if (receiver.IsFrameNew()) {
+			m_BufferFrame[back] = receiver.frame.GetSenderFrame64();
+			// New ready buffer
+			EnterCriticalSection(&m_Lock);
+			m_Back = m_Ready;
+			m_Ready = back;
+			m_bReadyNew = true;
+			const SpoutFrameCallback callback = m_FrameCallback;
+			void* pUserData = m_pCallbackData;
+			LeaveCriticalSection(&m_Lock);
+			SetEvent(m_hFrameEvent);
+			// The ready buffer is not written by this thread
+			// until it is exchanged with the back buffer again
+			if (callback) {
+				SpoutThreadFrame frame={};
+				frame.data = m_pBuffer[back];
+				frame.width = m_BufferWidth[back];
+				frame.height = m_BufferHeight[back];
+				frame.pitch = m_BufferWidth[back]*(m_bRGB ? 3 : 4);
+				frame.bRGB = m_bRGB;
+				frame.frame = m_BufferFrame[back];
+				callback(frame, pUserData);
+			}
+			dwWait = 0;
+		}
+		else {
+			// Open the sync event for a new sender, and again at
+			// intervals in case the sender creates it later
+			if (strcmp(syncname, receiver.GetSenderName()) != 0
+				|| (!hSyncEvent && GetTickCount()-dwSyncCheck > 1000)) {
+				if (hSyncEvent) CloseHandle(hSyncEvent);
+				strcpy_s(syncname, 256, receiver.GetSenderName());
+				char eventname[256]={};
+				sprintf_s(eventname, 256, "%s_Sync_Event", syncname);
+				hSyncEvent = OpenEventA(SYNCHRONIZE, FALSE, eventname);
+				dwSyncCheck = GetTickCount();
+			}
+			if (hSyncEvent) {
+				// Wait for the sender to signal the next frame
+				HANDLE handles[2] = { m_hStopEvent, hSyncEvent };
+				if (WaitForMultipleObjects(2, handles, FALSE, 16) == WAIT_OBJECT_0)
+					break;
+				dwWait = 0;
+			}
+			else {
+				// Wait 1 msec if the sender has no new frame
+				dwWait = 1;
+			}
+		}
 	}
 
-	// The adapter was not different so the sharehandle still could not be opened
-	return nullptr;
-
+	if (hSyncEvent) CloseHandle(hSyncEvent);
+	InterlockedExchange(&m_bConnected, 0);
 }
 
-//---------------------------------------------------------
-//	o Connect to a sender and inform the application to update texture dimensions
-//	o Check for user sender selection
-//  o Receive texture details from the sender for write to the user texture
-//  o Retrieve width, height, format, share handle and texture pointer
-bool spoutDX::ReceiveSenderData()
+// Allocate a buffer for the sender size
+bool spoutReceiveThread::CheckBuffer(int index, unsigned int width, unsigned int height)
 {
-	m_bUpdated = false;
-	
-	// Make sure DirectX is initialized
-	if (!OpenDirectX11())
+	if (width == 0 || height == 0)
 		return false;
 
-	// Initialization is recorded in this class for sender or receiver
-	// m_Width or m_Height are established when the receiver connects to a sender
-	char sendername[256]={};
-	strcpy_s(sendername, 256, m_SenderName);
-
-	// Check the entered Sender name to see if it exists
-	if (sendername[0] == 0) {
-		// Passed name was null, so find the active sender
-		if (!GetActiveSender(sendername))
-			return false; // No sender
-	}
-
-	// If SpoutPanel has been opened, the active sender name could be different
-	if (CheckSpoutPanel(sendername, 256)) {
-		// Disable the setup name
-		m_SenderNameSetup[0] = 0;
+	const unsigned int size = width*height*(m_bRGB ? 3 : 4);
+	if (size > m_BufferSize[index]) {
+		if (m_pBuffer[index]) delete[] m_pBuffer[index];
+		m_pBuffer[index] = new unsigned char[size];
+		m_BufferSize[index] = size;
 	}
+	m_BufferWidth[index] = width;
+	m_BufferHeight[index] = height;
+	m_BufferFrame[index] = 0;
 
-	// Now we have either an existing sender name or the active sender name
-
-	// Save current sender name and dimensions to test for change
-	unsigned int width = m_Width;
-	unsigned int height = m_Height;
-	DWORD dwFormat = m_dwFormat;
-	HANDLE dxShareHandle = m_dxShareHandle;
-
-	// Try to get the sender shared memory information.
-	// Retrieve width, height, sharehandle and format.
-	SharedTextureInfo info={};
-	if (sendernames.getSharedInfo(sendername, &info)) {
+	return true;
+}
 
-		// Memory share mode not supported (no texture share handle)
-		if (info.shareHandle == 0) {
-			ReleaseReceiver();
-			return false;
-		}
 
-		width  = info.width;
-		height = info.height;
-		dxShareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
-		dwFormat = info.format;
+//
+// Group: Receiver group
+//
+// spoutReceiverGroup receives from a number of senders using one D3D11 device.
+//
+// The sender change count is checked once for all senders by ReceiveAll
+// and the sender information is read only if it has changed or at
+// intervals for senders of earlier versions.
+//
+// Receiving textures and staging textures are taken from a pool shared
+// by all senders. A texture released by a sender that has closed or
+// changed size is re-used for the next sender of the same size and format.
+//
+// Each sender has a spoutFrameCount object for the sender access mutex
+// and frame count. If a callback is set by AddSender, it is called
+// by ReceiveAll for each new frame with the receiving texture.
+//
 
-		// For DX9 sender formats, use a compatible DX11 format
-		// 21 =	D3DFMT_A8R8G8B8
-		// 22 = D3DFMT_X8R8G8B8
-		if (dwFormat == 21 || dwFormat == 22) {
-			dwFormat = (DWORD)DXGI_FORMAT_B8G8R8A8_UNORM;
-		}
+spoutReceiverGroup::spoutReceiverGroup()
+{
+	m_pd3dDevice = nullptr;
+	m_pImmediateContext = nullptr;
+	m_bClassDevice = false;
+	ZeroMemory(m_pSenders, sizeof(m_pSenders));
+	ZeroMemory(m_Pool, sizeof(m_Pool));
+	m_SenderGeneration = 0;
+	m_dwSenderCheck = 0;
+}
 
-		// The shared texture handle will be different
-		//   o for a new sender
-		//   o for texture size or format change
-		if (dxShareHandle != m_dxShareHandle) {
+spoutReceiverGroup::~spoutReceiverGroup()
+{
+	CloseDirectX11();
+}
 
-			/*
-			printf("\nReceiveSenderData : %s \n", sendername);
-			printf("     Width     : %d\n", info.width);
-			printf("     Height    : %d\n", info.height);
-			printf("     Format    : %d (0x%X)\n", info.format, info.format);
-			printf("     handle    : 0x%X\n", info.shareHandle);
-			printf("     Usage     : %d (0x%X)\n", info.usage, info.usage);
-			printf("     Description : [%s]\n", (char*)info.description);
-			printf("     PartnerId : 0x%X\n", info.partnerId);
-			*/
+//---------------------------------------------------------
+// Function: OpenDirectX11
+// Initialize with an application device or create one
+bool spoutReceiverGroup::OpenDirectX11(ID3D11Device* pDevice)
+{
+	if (m_pd3dDevice)
+		return true;
 
-			// Release everything and start again
-			ReleaseReceiver();
+	if (pDevice) {
+		m_pd3dDevice = pDevice;
+		pDevice->GetImmediateContext(&m_pImmediateContext);
+		m_bClassDevice = false;
+	}
+	else if (spoutdx.OpenDirectX11()) {
+		m_pd3dDevice = spoutdx.GetDX11Device();
+		m_pImmediateContext = spoutdx.GetDX11Context();
+		m_bClassDevice = true;
+	}
+	else {
+		SpoutLogWarning("spoutReceiverGroup::OpenDirectX11 - device creation failed");
+		return false;
+	}
 
-			// Update the sender share handle
-			m_dxShareHandle = dxShareHandle;
+	SpoutLogNotice("spoutReceiverGroup::OpenDirectX11 - device (0x%.7X)", PtrToUint(m_pd3dDevice));
 
-			// Get a new shared texture pointer (m_pSharedTexture)
-			if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &m_pSharedTexture, dxShareHandle)) {
+	return true;
+}
 
-				// If this fails, the sender graphics adapter might be different
-				SpoutLogWarning("SpoutReceiver::ReceiveSenderData - could not retrieve sender texture from share handle");
+//---------------------------------------------------------
+// Function: CloseDirectX11
+// Release senders, textures and the device
+void spoutReceiverGroup::CloseDirectX11()
+{
+	RemoveAllSenders();
+	ReleasePool();
 
-				// If a device has been created within this class, we can re-create it
-				// on the fly using a different graphics adapter if auto adapter switching 
-				// has been activated with SetAdapterAuto()
-				if (m_bClassDevice && m_bAdapt) {
-					// Test to find the sender adapter.
-					// If different, switch to it and retrieve the shared texture pointer.
-					ID3D11Texture2D* pTexture = CheckSenderTexture(sendername, dxShareHandle);
-					// CheckSenderTexture will re-create the class D3D11 device using the sender's adapter
-					if (!pTexture) {
-						// If that failed, retain the share handle (m_dxShareHandle) 
-						// so we don't query it again. The texture pointer (m_pSharedTexture)
-						// is null but will not be used. Return true and wait until another
-						// sender is selected.
-						return true;
-					}
-					// Use the new sender texture pointer retrieved by CheckSenderTexture
-					m_pSharedTexture = pTexture;
-				}
-				else {
-					// Wait until another sender is selected or the shared texture handle is valid.
-					return true;
-				}
+	if (m_pImmediateContext) m_pImmediateContext->Flush();
 
-			}
+	if (m_pd3dDevice) {
+		if (m_bClassDevice)
+			spoutdx.CloseDirectX11();
+		else if (m_pImmediateContext)
+			m_pImmediateContext->Release();
+	}
 
-			// Get the texture details to check for zero size
-			D3D11_TEXTURE2D_DESC desc;
-			ZeroMemory(&desc, sizeof(desc));
-			m_pSharedTexture->GetDesc(&desc);
-			if (desc.Width == 0 || desc.Height == 0)
-				return false;
+	m_pd3dDevice = nullptr;
+	m_pImmediateContext = nullptr;
+}
 
-			// For incorrect sender information, use the format
-			// of the D3D11 texture generated by OpenDX11shareHandle
-			if (dwFormat != (DWORD)desc.Format)
-				dwFormat = (DWORD)desc.Format;
+//---------------------------------------------------------
+// Function: GetDX11Device
+// Group device
+ID3D11Device* spoutReceiverGroup::GetDX11Device()
+{
+	return m_pd3dDevice;
+}
 
-			// Initialize again with the newly connected sender values
-			CreateReceiver(sendername, width, height, dwFormat);
+//---------------------------------------------------------
+// Function: GetDX11Context
+// Group immediate context
+ID3D11DeviceContext* spoutReceiverGroup::GetDX11Context()
+{
+	return m_pImmediateContext;
+}
 
-			// Return to update the receiving texture or image
-			// If the graphics adapter was changed, the class device will be different
-			// and the texture returned will have been created using that device.
-			m_bUpdated = true;
+//---------------------------------------------------------
+// Function: AddSender
+// Add a sender to receive. 
+// The sender does not have to be running.
+// Returns the sender index or -1 if the group is full.
+int spoutReceiverGroup::AddSender(const char* sendername, SpoutGroupCallback callback, void* pUserData)
+{
+	if (!sendername || !*sendername)
+		return -1;
 
+	for (int i = 0; i < SPOUT_GROUP_MAX; i++) {
+		if (!m_pSenders[i]) {
+			SpoutGroupSender* pSender = new SpoutGroupSender;
+			ZeroMemory(pSender, sizeof(SpoutGroupSender));
+			strcpy_s(pSender->name, 256, sendername);
+			pSender->callback = callback;
+			pSender->pUserData = pUserData;
+			pSender->pFrame = new spoutFrameCount;
+			m_pSenders[i] = pSender;
+			// Check senders on the next ReceiveAll
+			m_dwSenderCheck = 0;
+			SpoutLogNotice("spoutReceiverGroup::AddSender(%d) - %s", i, sendername);
+			return i;
 		}
+	}
 
-		// Connected and intialized
-		// Sender name, width, height, format, texture pointer and share handle have been retrieved
+	SpoutLogWarning("spoutReceiverGroup::AddSender - maximum of %d senders", SPOUT_GROUP_MAX);
+	return -1;
+}
 
-		// The application can now access and copy the sender texture
-		return true;
+//---------------------------------------------------------
+// Function: RemoveSender
+// Remove a sender
+void spoutReceiverGroup::RemoveSender(int index)
+{
+	if (index < 0 || index >= SPOUT_GROUP_MAX || !m_pSenders[index])
+		return;
 
-		//
-		// ===================================================
-		
+	SpoutLogNotice("spoutReceiverGroup::RemoveSender(%d) - %s", index, m_pSenders[index]->name);
+	ReleaseSender(m_pSenders[index]);
+	delete m_pSenders[index]->pFrame;
+	delete m_pSenders[index];
+	m_pSenders[index] = nullptr;
+}
 
-	} // end find sender
+//---------------------------------------------------------
+// Function: RemoveAllSenders
+// Remove all senders
+void spoutReceiverGroup::RemoveAllSenders()
+{
+	for (int i = 0; i < SPOUT_GROUP_MAX; i++)
+		RemoveSender(i);
+}
 
-	// There is no sender or the connected sender closed
-	return false;
+//---------------------------------------------------------
+// Function: ReceiveAll
+// Receive new frames of all senders.
+//
+// Each new frame is copied to the receiving texture of the sender
+// and the sender callback is called.
+// Returns the number of new frames received.
+int spoutReceiverGroup::ReceiveAll()
+{
+	if (!OpenDirectX11())
+		return 0;
 
+	// One check of the sender change count for all senders
+	const bool bChanged = sendernames.CheckSenderChange(m_SenderGeneration, m_dwSenderCheck);
+
+	int nFrames = 0;
+	for (int i = 0; i < SPOUT_GROUP_MAX; i++) {
+		SpoutGroupSender* pSender = m_pSenders[i];
+		if (!pSender)
+			continue;
+		// Read the sender information only if a sender has changed
+		if (bChanged && !CheckSender(pSender))
+			continue;
+		if (pSender->bConnected && ReceiveSender(i))
+			nFrames++;
+	}
+
+	return nFrames;
 }
 
-// Create receiver resources for a new sender
-void spoutDX::CreateReceiver(const char * SenderName, unsigned int width, unsigned int height, DWORD dwFormat)
+//---------------------------------------------------------
+// Function: IsConnected
+// Connected to a sender
+bool spoutReceiverGroup::IsConnected(int index)
 {
-	SpoutLogNotice("CreateReceiver(%s) %d x %d : format %d", SenderName, width, height, dwFormat);
-
-	if (m_bSpoutInitialized)
-		ReleaseReceiver();
+	if (index < 0 || index >= SPOUT_GROUP_MAX || !m_pSenders[index])
+		return false;
+	return m_pSenders[index]->bConnected;
+}
 
-	// Create a named sender mutex for access to the sender's shared texture
-	frame.CreateAccessMutex(SenderName);
+//---------------------------------------------------------
+// Function: GetSenderTexture
+// Receiver copy of the sender texture
+ID3D11Texture2D* spoutReceiverGroup::GetSenderTexture(int index)
+{
+	if (!IsConnected(index))
+		return nullptr;
+	return m_pSenders[index]->pTexture;
+}
 
-	// Enable frame counting to get the sender frame number and fps
-	frame.EnableFrameCount(SenderName);
+//---------------------------------------------------------
+// Function: GetSenderWidth
+// Sender width
+unsigned int spoutReceiverGroup::GetSenderWidth(int index)
+{
+	if (!IsConnected(index))
+		return 0;
+	return m_pSenders[index]->width;
+}
 
-	// Set class globals
-	strcpy_s(m_SenderName, 256, SenderName);
-	m_Width = width;
-	m_Height = height;
-	m_dwFormat = dwFormat;
+//---------------------------------------------------------
+// Function: GetSenderHeight
+// Sender height
+unsigned int spoutReceiverGroup::GetSenderHeight(int index)
+{
+	if (!IsConnected(index))
+		return 0;
+	return m_pSenders[index]->height;
+}
 
-	m_bSpoutInitialized = true;
+//---------------------------------------------------------
+// Function: GetSenderFormat
+// Sender texture format
+DXGI_FORMAT spoutReceiverGroup::GetSenderFormat(int index)
+{
+	if (!IsConnected(index))
+		return DXGI_FORMAT_UNKNOWN;
+	return (DXGI_FORMAT)m_pSenders[index]->format;
+}
 
+//---------------------------------------------------------
+// Function: GetSenderFrame
+// Sender frame number of the last texture received
+LONG64 spoutReceiverGroup::GetSenderFrame(int index)
+{
+	if (!IsConnected(index))
+		return 0;
+	return m_pSenders[index]->frame;
 }
 
+//---------------------------------------------------------
+// Function: ReadPixels
+// Read the last texture received to an rgba or rgb buffer of the sender size.
 //
-// COPY FROM A DX11 STAGING TEXTURE TO A USER RGBA/RGB/BGR PIXEL BUFFER OF GIVEN SIZE
-//
-// A class device and context must have been created using OpenDirectX11()
-//
-// bRGB - pixel data is RGB instead of RGBA
-// bInvert - flip the image
-// bSwap - swap red/blue (BGRA/RGBA). Not available for re-sample
-//
-bool spoutDX::ReadPixelData(ID3D11Texture2D* pStagingSource, unsigned char* destpixels,
-	unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap)
+// A staging texture of the sender size and format is taken from the pool
+// for the copy and returned after it is mapped and read.
+bool spoutReceiverGroup::ReadPixels(int index, unsigned char* pixels, bool bRGB, bool bInvert)
 {
-	if (!m_pImmediateContext || !pStagingSource || !destpixels)
+	if (!pixels || !IsConnected(index) || !m_pSenders[index]->pTexture)
 		return false;
 
-	// Map the staging texture resource so we can access the pixels
+	SpoutGroupSender* pSender = m_pSenders[index];
+	ID3D11Texture2D* pStaging = AcquirePoolTexture(pSender->width, pSender->height, pSender->format, true);
+	if (!pStaging)
+		return false;
+
+	m_pImmediateContext->CopyResource(pStaging, pSender->pTexture);
+
 	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
-	// Make sure all commands are done before mapping the staging texture
-	m_pImmediateContext->Flush();
-	// Map waits for GPU access
-	const HRESULT hr = m_pImmediateContext->Map(pStagingSource, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	const HRESULT hr = m_pImmediateContext->Map(pStaging, 0, D3D11_MAP_READ, 0, &mappedSubResource);
 	if (SUCCEEDED(hr)) {
-		// Copy the staging texture pixels to the user buffer
-		if (!bRGB) {
-			// RGBA pixel buffer
-			// TODO : test rgba-rgba resample
-			// TODO : rgba2bgraResample
-			if (width != m_Width || height != m_Height) {
-				spoutcopy.rgba2rgbaResample(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, width, height, bInvert);
-			}
-			else {
-				// Copy rgba to bgra line by line allowing for source pitch using the fastest method
-				// Uses SSE3 copy function if line data is 16bit aligned (see SpoutCopy.cpp)
-				if (bSwap) {
-					spoutcopy.rgba2bgra(mappedSubResource.pData, destpixels, width, height, mappedSubResource.RowPitch, bInvert);
-				}
-				else {
-					spoutcopy.rgba2rgba(mappedSubResource.pData, destpixels, width, height, mappedSubResource.RowPitch, bInvert);
-				}
-			}
-		}
-		else if (m_dwFormat == 28) { // DXGI_FORMAT_R8G8B8A8_UNORM
-			// RGBA texture - RGB/BGR pixel buffer
-			// If the texture format is RGBA it has to be converted to RGB/BGR by the staging texture copy
-			if (width != m_Width || height != m_Height) {
-				if(bSwap)
-					spoutcopy.rgba2bgrResample(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, width, height, bInvert);
-				else
-					spoutcopy.rgba2rgbResample(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, width, height, bInvert);
-			}
-			else {
-				// Copy RGBA to RGB or BGR allowing for source line pitch using the fastest method
-				// Uses SSE3 conversion functions if data is 16bit aligned (see SpoutCopy.cpp)
-				if (bSwap)
-					spoutcopy.rgba2rgb(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert, true);
-				else
-					spoutcopy.rgba2rgb(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert, false);
-			}
+		if (bRGB) {
+			// BGRA textures are swapped to RGB
+			const bool bSwap = (pSender->format == (DWORD)DXGI_FORMAT_B8G8R8A8_UNORM);
+			spoutcopy.rgba2rgb(mappedSubResource.pData, pixels, pSender->width, pSender->height,
+				mappedSubResource.RowPitch, bInvert, false, bSwap);
 		}
 		else {
-			if (width != m_Width || height != m_Height) {
-				spoutcopy.rgba2rgbResample(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, width, height, bInvert, m_bMirror, m_bSwapRB);
-			}
-			else {
-				// Approx 5 msec at 1920x1080
-				spoutcopy.rgba2rgb(mappedSubResource.pData, destpixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert, m_bMirror, m_bSwapRB);
-			}
-
+			spoutcopy.rgba2rgba(mappedSubResource.pData, pixels, pSender->width, pSender->height,
+				mappedSubResource.RowPitch, bInvert);
 		}
+		m_pImmediateContext->Unmap(pStaging, 0);
+	}
+	else {
+		SpoutLogWarning("spoutReceiverGroup::ReadPixels - staging texture map failed (0x%.7X)", (unsigned int)hr);
+	}
 
-		m_pImmediateContext->Unmap(pStagingSource, 0);
-
-		return true;
-
-	} // endif DX11 map OK
-
-	return false;
+	ReleasePoolTexture(pStaging);
 
-} // end ReadPixelData
+	return SUCCEEDED(hr);
+}
 
+//
+// Protected
+//
 
-// Create new class staging textures if changed size or do not exist yet
-bool spoutDX::CheckStagingTextures(unsigned int width, unsigned int height, DWORD dwFormat)
+// Read the sender information and connect or re-connect.
+// Returns false if the sender is not available.
+bool spoutReceiverGroup::CheckSender(SpoutGroupSender* pSender)
 {
-	if (!m_pd3dDevice) {
+	SharedTextureInfo info={};
+	if (!sendernames.getSharedInfo(pSender->name, &info) || info.shareHandle == 0) {
+		// Sender closed or memory share
+		if (pSender->bConnected)
+			ReleaseSender(pSender);
 		return false;
 	}
 
-	if (m_pStaging[0] && m_pStaging[1]) {
-
-		// Get the texture details to test for change (both textures are the same)
-		D3D11_TEXTURE2D_DESC desc={0};
-		m_pStaging[0]->GetDesc(&desc);
-
-		// Return if the same size and format
-		if (desc.Width == width && desc.Height == height && desc.Format == (DXGI_FORMAT)dwFormat)
-			return true;
+	const HANDLE dxShareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
+	if (pSender->bConnected && dxShareHandle == pSender->shareHandle)
+		return true; // No change
 
-		// Drop through to create new staging textures
-		m_Index = 0;
-		m_NextIndex = 0;
+	// New sender or the sender texture has changed
+	ReleaseSender(pSender);
+	pSender->shareHandle = dxShareHandle;
 
+	if (!spoutdx.OpenDX11shareHandle(m_pd3dDevice, &pSender->pSharedTexture, dxShareHandle)) {
+		SpoutLogWarning("spoutReceiverGroup - could not open the texture of %s", pSender->name);
+		// Retain the share handle so it is not opened again
+		return false;
 	}
 
-	// The SpoutDirectX function releases an existing texture and checks for zero or DX9 format
-	if(spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pStaging[0])
-	&& spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pStaging[1])) {
-		// Flush now to avoid deferred object destruction
-		if (m_pImmediateContext) m_pImmediateContext->Flush();
-		return true;
+	// Format of the D3D11 texture in case of incorrect sender information
+	D3D11_TEXTURE2D_DESC desc={};
+	pSender->pSharedTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0) {
+		ReleaseSender(pSender);
+		return false;
+	}
+	pSender->width = desc.Width;
+	pSender->height = desc.Height;
+	pSender->format = (DWORD)desc.Format;
+
+	// Receiving texture from the pool
+	pSender->pTexture = AcquirePoolTexture(pSender->width, pSender->height, pSender->format, false);
+	if (!pSender->pTexture) {
+		ReleaseSender(pSender);
+		return false;
 	}
 
-	return false;
+	pSender->pFrame->CreateAccessMutex(pSender->name);
+	pSender->pFrame->EnableFrameCount(pSender->name);
+	pSender->frame = 0;
+	pSender->bConnected = true;
+
+	SpoutLogNotice("spoutReceiverGroup - connected to %s (%dx%d format %d)",
+		pSender->name, pSender->width, pSender->height, pSender->format);
+
+	return true;
 }
 
+// Release the sender texture and return the receiving texture to the pool
+// The sender name, callback and frame count object are retained
+void spoutReceiverGroup::ReleaseSender(SpoutGroupSender* pSender)
+{
+	if (pSender->bConnected) {
+		pSender->pFrame->CloseAccessMutex();
+		pSender->pFrame->CleanupFrameCount();
+	}
+	if (pSender->pSharedTexture) pSender->pSharedTexture->Release();
+	pSender->pSharedTexture = nullptr;
+	if (pSender->pTexture) ReleasePoolTexture(pSender->pTexture);
+	pSender->pTexture = nullptr;
+	pSender->shareHandle = nullptr;
+	pSender->bConnected = false;
+	pSender->frame = 0;
+}
 
-// Create new class texture if changed size or does not exist yet
-bool spoutDX::CheckTexture(unsigned int width, unsigned int height, DWORD dwFormat)
+// Copy a new frame of a sender to the receiving texture
+bool spoutReceiverGroup::ReceiveSender(int index)
 {
-	if (!m_pd3dDevice)
+	SpoutGroupSender* pSender = m_pSenders[index];
+	if (!pSender->pSharedTexture || !pSender->pTexture)
 		return false;
 
-	if (m_pTexture) {
-		
-		// Get the texture details to test for change
-		D3D11_TEXTURE2D_DESC desc = { 0 };
-		m_pTexture->GetDesc(&desc);
-		
-		// Return if the same size and format
-		if (desc.Width == width && desc.Height == height && desc.Format == (DXGI_FORMAT)dwFormat)
-			return true;
-
-		// Drop through to create new texture
+	bool bNew = false;
+	if (pSender->pFrame->CheckTextureAccess(pSender->pSharedTexture)) {
+		if (pSender->pFrame->GetNewFrame()) {
+			m_pImmediateContext->CopyResource(pSender->pTexture, pSender->pSharedTexture);
+			pSender->frame = pSender->pFrame->GetSenderFrame64();
+			bNew = true;
+		}
+		pSender->pFrame->AllowTextureAccess(pSender->pSharedTexture);
 	}
 
-	// The SpoutDirectX function releases an existing texture and checks for zero or DX9 format
-	return spoutdx.CreateDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)dwFormat, &m_pTexture);
+	// Callback after access is released
+	if (bNew && pSender->callback)
+		pSender->callback(index, pSender->name, pSender->pTexture, pSender->pUserData);
 
+	return bNew;
 }
 
-
-//
-// The following functions are adapted from equivalents in SpoutSDK.cpp
-// for applications not using the entire Spout SDK.
-//
-
-// Pop up SpoutPanel to allow the user to select a sender
-// Usually activated by RH click
-void spoutDX::SelectSenderPanel()
+// Unused pool texture of the size and format or a new one
+ID3D11Texture2D* spoutReceiverGroup::AcquirePoolTexture(unsigned int width, unsigned int height, DWORD format, bool bStaging)
 {
-	HANDLE hMutex1 = NULL;
-	HMODULE module = NULL;
-	char path[MAX_PATH]={};
-	char drive[MAX_PATH]={};;
-	char dir[MAX_PATH]={};
-	char fname[MAX_PATH]={};
-
-	// The selected sender is then the "Active" sender and this receiver switches to it.
-	// If Spout is not installed, SpoutPanel.exe has to be in the same folder
-	// as this executable. This rather complicated process avoids having to use a dialog
-	// which causes problems with host GUI messaging.
-
-	// First find if there has been a Spout installation >= 2.002 with an install path for SpoutPanel.exe
-	if (!ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "InstallPath", path)) {
-		// Path not registered so find the path of the host program
-		// where SpoutPanel should have been copied
-		module = GetModuleHandle(NULL);
-		GetModuleFileNameA(module, path, MAX_PATH);
-		_splitpath_s(path, drive, MAX_PATH, dir, MAX_PATH, fname, MAX_PATH, NULL, 0);
-		_makepath_s(path, MAX_PATH, drive, dir, "SpoutPanel", ".exe");
-		// Does SpoutPanel.exe exist in this path ?
-		if(_access(path, 0) == -1) {
-		// if (!PathFileExistsA(path)) {
-			// Try the current working directory
-			if (_getcwd(path, MAX_PATH)) {
-				strcat_s(path, MAX_PATH, "\\SpoutPanel.exe");
-				// Does SpoutPanel exist here?
-				if (_access(path, 0) == -1) {
-				// if (!PathFileExistsA(path)) {
-					SpoutLogWarning("spoutDX::SelectSender - SpoutPanel path not found");
-					return;
-				}
-			}
+	int freeslot = -1;
+	int unused = -1;
+	for (int i = 0; i < SPOUT_GROUP_POOL; i++) {
+		SpoutPoolTexture& entry = m_Pool[i];
+		if (!entry.pTexture) {
+			if (freeslot < 0) freeslot = i;
+			continue;
+		}
+		if (entry.bInUse)
+			continue;
+		if (entry.width == width && entry.height == height
+			&& entry.format == format && entry.bStaging == bStaging) {
+			entry.bInUse = true;
+			return entry.pTexture;
 		}
+		if (unused < 0) unused = i;
 	}
 
-	// Check whether the panel is already running
-	// Try to open the application mutex.
-	hMutex1 = OpenMutexA(MUTEX_ALL_ACCESS, 0, "SpoutPanel");
-	if (!hMutex1) {
-		// No mutex, so not running, so can open it
-
-		// First release any orphaned senders if the name exists
-		// in the sender list but the shared memory info does not
-		// So that the sender list is clean
-		sendernames.CleanSenders();
-
-		// Use ShellExecuteEx so we can test its return value later
-		ZeroMemory(&m_ShExecInfo, sizeof(m_ShExecInfo));
-		m_ShExecInfo.cbSize = sizeof(SHELLEXECUTEINFO);
-		m_ShExecInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
-		m_ShExecInfo.hwnd = NULL;
-		m_ShExecInfo.lpVerb = NULL;
-		m_ShExecInfo.lpFile = (LPCSTR)path;
-		m_ShExecInfo.lpDirectory = NULL;
-		m_ShExecInfo.nShow = SW_SHOW;
-		m_ShExecInfo.hInstApp = NULL;
-		ShellExecuteExA(&m_ShExecInfo);
-
-		//
-		// The flag "m_bSpoutPanelOpened" is set here to indicate that the user
-		// has opened the panel to select a sender. This flag is local to 
-		// this process so will not affect any other receiver instance
-		// Then when the selection panel closes, sender name is tested
-		//
-		m_bSpoutPanelOpened = true;
+	// Release an unused texture of a different size if the pool is full
+	if (freeslot < 0 && unused >= 0) {
+		spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_Pool[unused].pTexture);
+		ZeroMemory(&m_Pool[unused], sizeof(SpoutPoolTexture));
+		freeslot = unused;
+	}
+	if (freeslot < 0) {
+		SpoutLogWarning("spoutReceiverGroup - texture pool is full");
+		return nullptr;
 	}
-	else {
-		// The mutex exists, so another instance is already running.
-		// Find the SpoutPanel window and bring it to the top.
-		// SpoutPanel is opened as topmost anyway but pop it to
-		// the front in case anything else has stolen topmost.
-		HWND hWnd = FindWindowA(NULL, (LPCSTR)"SpoutPanel");
-		if (hWnd && IsWindow(hWnd)) {
-			SetForegroundWindow(hWnd);
-			// prevent other windows from hiding the dialog
-			// and open the window wherever the user clicked
-			SetWindowPos(hWnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_ASYNCWINDOWPOS | SWP_SHOWWINDOW | SWP_NOSIZE | SWP_NOMOVE);
-		}
-		else if (path[0]) {
-			// If the window was not found but the mutex exists
-			// and SpoutPanel is installed, it has crashed.
-			// Terminate the process and the mutex or the mutex will remain
-			// and SpoutPanel will not be started again.
-			PROCESSENTRY32 pEntry={};
-			pEntry.dwSize = sizeof(pEntry);
-			bool done = false;
-			// Take a snapshot of all processes and threads in the system
-			HANDLE hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPALL, NULL);
-			if (hProcessSnap == INVALID_HANDLE_VALUE) {
-				SpoutLogError("spoutDX::OpenSpoutPanel - CreateToolhelp32Snapshot error");
-			}
-			else {
-				// Retrieve information about the first process
-				BOOL hRes = Process32First(hProcessSnap, &pEntry);
-				if (!hRes) {
-					SpoutLogError("spoutDX::OpenSpoutPanel - Process32First error");
-					CloseHandle(hProcessSnap);
-				}
-				else {
-					// Look through all processes
-					while (hRes && !done) {
-						const int value = _tcsicmp(pEntry.szExeFile, _T("SpoutPanel.exe"));
-						if (value == 0) {
-							HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, 0, (DWORD)pEntry.th32ProcessID);
-							if (hProcess != NULL) {
-								// Terminate SpoutPanel and it's mutex
-								TerminateProcess(hProcess, 9);
-								CloseHandle(hProcess);
-								done = true;
-							}
-						}
-						if (!done)
-							hRes = Process32Next(hProcessSnap, &pEntry); // Get the next process
-						else
-							hRes = NULL; // found SpoutPanel
-					}
-					CloseHandle(hProcessSnap);
-				}
-			}
-			// Now SpoutPanel will start the next time the user activates it
-		} // endif SpoutPanel crashed
-	} // endif SpoutPanel already open
 
-	// If we opened the mutex, close it now or it is never released
-	if (hMutex1) CloseHandle(hMutex1);
+	ID3D11Texture2D* pTexture = nullptr;
+	const bool bCreated = bStaging
+		? spoutdx.CreateDX11StagingTexture(m_pd3dDevice, width, height, (DXGI_FORMAT)format, &pTexture)
+		: spoutdx.CreateDX11Texture(m_pd3dDevice, width, height, (DXGI_FORMAT)format, &pTexture);
+	if (!bCreated || !pTexture)
+		return nullptr;
 
-	return;
+	SpoutPoolTexture& entry = m_Pool[freeslot];
+	entry.pTexture = pTexture;
+	entry.width = width;
+	entry.height = height;
+	entry.format = format;
+	entry.bStaging = bStaging;
+	entry.bInUse = true;
 
-} // end SelectSenderPanel
+	return pTexture;
+}
 
-//
-// Check whether SpoutPanel opened and return the new sender name
-//
-bool spoutDX::CheckSpoutPanel(char *sendername, int maxchars)
+// Return a texture to the pool
+void spoutReceiverGroup::ReleasePoolTexture(ID3D11Texture2D* pTexture)
 {
-	// If SpoutPanel has been activated, test if the user has clicked OK
-	if (m_bSpoutPanelOpened) { // User has activated spout panel
-
-		SharedTextureInfo TextureInfo={};
-		HANDLE hMutex = NULL;
-		DWORD dwExitCode = 0;
-		char newname[256]={};
-		bool bRet = false;
-
-		// Must find the mutex to signify that SpoutPanel has opened
-		// and then wait for the mutex to close
-		hMutex = OpenMutexA(MUTEX_ALL_ACCESS, 0, "SpoutPanel");
-
-		// Has it been activated 
-		if (!m_bSpoutPanelActive) {
-			// If the mutex has been found, set the active flag true and quit
-			// otherwise on the next round it will test for the mutex closed
-			if (hMutex) m_bSpoutPanelActive = true;
-		}
-		else if (!hMutex) { // It has now closed
-			m_bSpoutPanelOpened = false; // Don't do this part again
-			m_bSpoutPanelActive = false;
-			// call GetExitCodeProcess() with the hProcess member of
-			// global SHELLEXECUTEINFO to get the exit code from SpoutPanel
-			if (m_ShExecInfo.hProcess) {
-				GetExitCodeProcess(m_ShExecInfo.hProcess, &dwExitCode);
-				// Only act if exit code = 0 (OK)
-				if (dwExitCode == 0) {
-					// SpoutPanel has been activated and OK clicked
-					// Test the active sender which should have been set by SpoutPanel
-					newname[0] = 0;
-					if (!sendernames.GetActiveSender(newname)) {
-						// Otherwise the sender might not be registered.
-						// SpoutPanel always writes the selected sender name to the registry.
-						if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "Sendername", newname)) {
-							// Register the sender if it exists
-							if (newname[0] != 0) {
-								if (sendernames.getSharedInfo(newname, &TextureInfo)) {
-									// Register in the list of senders and make it the active sender
-									sendernames.RegisterSenderName(newname);
-									sendernames.SetActiveSender(newname);
-								}
-							}
-						}
-					}
-					// Now do we have a valid sender name ?
-					if (newname[0] != 0) {
-						// Pass back the new name
-						strcpy_s(sendername, maxchars, newname);
-						bRet = true;
-					} // endif valid sender name
-				} // endif SpoutPanel OK
-			} // got the exit code
-		} // endif no mutex so SpoutPanel has closed
-		// If we opened the mutex, close it now or it is never released
-		if (hMutex) CloseHandle(hMutex);
-		return bRet;
-	} // SpoutPanel has not been opened
-
-	return false;
+	for (int i = 0; i < SPOUT_GROUP_POOL; i++) {
+		if (m_Pool[i].pTexture == pTexture) {
+			m_Pool[i].bInUse = false;
+			return;
+		}
+	}
+}
 
+// Release all pool textures
+void spoutReceiverGroup::ReleasePool()
+{
+	for (int i = 0; i < SPOUT_GROUP_POOL; i++) {
+		if (m_Pool[i].pTexture)
+			spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_Pool[i].pTexture);
+	}
+	ZeroMemory(m_Pool, sizeof(m_Pool));
 }
@@ -57,12 +57,56 @@
 #include "SpoutUtils.h" // Registry utiities
 #endif
 
+#include <d3dcompiler.h> // for pD3DCompile
 #include <direct.h> // for _getcwd
 #include <TlHelp32.h> // for PROCESSENTRY32
 #include <tchar.h> // for _tcsicmp
 #include <psapi.h> // for GetModuleFileNameExA
+#include <algorithm> // for std::find
 #pragma comment(lib, "Psapi.lib")
 
+// Number of staging textures for a receiver adapter bridge
+#define SPOUT_BRIDGE_STAGING 3
+
+// Number of snapshot textures for an asynchronous sender
+#define SPOUT_ASYNC_TEXTURES 3
+
+// Maximum number of sub-senders of an atlas sender
+#define SPOUT_ATLAS_SENDERS 64
+
+// Maximum number of bands for a banded readback
+#define SPOUT_READBACK_BANDS 8
+
+//
+// Result of TryReceiveImage
+//
+enum SpoutReceiveStatus {
+	SPOUT_RECEIVE_FAILED = 0, // No sender or the connected sender closed
+	SPOUT_RECEIVE_SUCCESS,    // A new frame was copied to the pixel buffer
+	SPOUT_RECEIVE_PENDING,    // The GPU copy is not complete. Try again later.
+	SPOUT_RECEIVE_NO_FRAME,   // There is no new frame
+	SPOUT_RECEIVE_UPDATED     // The sender has changed. Update the buffer (IsUpdated).
+};
+
+//
+// Sender policy for receivers that lag behind (see SetSendPolicy)
+//
+enum SpoutSendPolicy {
+	SPOUT_SEND_DEFAULT = 0, // Wait for texture access up to the access timeout
+	SPOUT_SEND_LATEST,      // Do not wait. The frame is dropped if a receiver has access.
+	SPOUT_SEND_QUEUE,       // Texture ring. Wait only if the ring is full.
+	SPOUT_SEND_BLOCK        // Wait until receivers have acknowledged the last frame
+};
+
+//
+// Sub-sender for a region of an atlas sender texture (see AddAtlasSender)
+//
+struct SpoutAtlasSender {
+	char name[256]; // Sub-sender name
+	D3D11_BOX region; // Region of the sender texture
+	bool bCreated; // Registered with the atlas texture
+};
+
 class SPOUT_DLLEXP spoutDX {
 
 	public:
@@ -79,6 +123,12 @@ class SPOUT_DLLEXP spoutDX {
 	ID3D11DeviceContext* GetDX11Context();
 	void CloseDirectX11();
 	bool IsClassDevice();
+	// Record the GPU time of copies in the timer
+	void EnableGPUTiming(bool bEnable = true);
+	// GPU timing status
+	bool IsGPUTiming();
+	// Memory held by this sender or receiver by category and heap
+	bool GetMemoryUsage(SpoutMemoryUsage& usage);
 
 	//
 	// SENDER
@@ -88,18 +138,43 @@ class SPOUT_DLLEXP spoutDX {
 	bool SetSenderName(const char* sendername = nullptr);
 	// Set the sender texture format
 	void SetSenderFormat(DXGI_FORMAT format);
+	// Create the sender texture with a mip chain
+	void SetSenderMips(bool bMips = true);
+	// Sender mip chain option
+	bool GetSenderMips();
+	// Share the sender texture by a named NT handle
+	void SetSenderNTHandle(bool bNThandle = true);
+	// Sender NT handle option
+	bool GetSenderNTHandle();
 	// Close sender and free resources
 	void ReleaseSender();
 	// Send the back buffer
 	bool SendBackBuffer();
+	// Send the back buffer of a swap chain after rendering and before Present
+	bool SendSwapChain(IDXGISwapChain* pSwapChain, double* pLatency = nullptr);
+	// Wait on the frame latency waitable object of a swap chain
+	bool WaitSwapChain(IDXGISwapChain* pSwapChain, DWORD dwTimeout = 1000);
+	// Milliseconds added by the last SendSwapChain
+	double GetSwapChainLatency();
 	// Send a texture
 	bool SendTexture(ID3D11Texture2D* pTexture);
 	// Send part of a texture
 	bool SendTexture(ID3D11Texture2D* pTexture,
 		unsigned int xoffset, unsigned int yoffset,
 		unsigned int width, unsigned int height); 
+	// Send the changed regions of a texture
+	bool SendTexture(ID3D11Texture2D* pTexture, const RECT* pDirtyRects, unsigned int nRects);
+	// Begin rendering directly to the sender texture
+	ID3D11RenderTargetView* BeginFrame(unsigned int width, unsigned int height, DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN);
+	// Send the frame rendered after BeginFrame
+	bool EndFrame();
 	// Send an image
 	bool SendImage(const unsigned char * pData, unsigned int width, unsigned int height);
+	// Send an image with a line pitch including padding and a source format
+	bool SendImage(const unsigned char * pData, unsigned int width, unsigned int height,
+		unsigned int pitch, DWORD dwFormat = 0, bool bInvert = false);
+	// Create sender resources before the first frame is sent
+	bool PrepareSender(const char* sendername, unsigned int width, unsigned int height, DWORD dwFormat = 0);
 	// Sender status
 	bool IsInitialized();
 	// Sender name
@@ -112,6 +187,60 @@ class SPOUT_DLLEXP spoutDX {
 	double GetFps();
 	// Get frame number
 	long GetFrame();
+	// Set the number of shared textures for a sender texture ring (0 or 3-4)
+	void SetTextureRing(int nTextures);
+	// Get the number of shared textures for a sender texture ring
+	int GetTextureRing();
+	// Set the policy for receivers that lag behind the sender
+	void SetSendPolicy(SpoutSendPolicy policy, int queue = 3, DWORD dwTimeout = 1000);
+	// Get the send policy
+	SpoutSendPolicy GetSendPolicy();
+	// Frames not sent because a receiver had access to the sender texture
+	LONG64 GetSendDropped();
+	// Frames overwritten before all registered receivers had acknowledged them
+	LONG64 GetSendOverrun();
+	// Publish a reduced size preview texture with maximum width (0 disables)
+	void SetPreview(unsigned int maxWidth = 320);
+	// Get the maximum preview width
+	unsigned int GetPreview();
+	// Publish an NV12 or P010 copy of the sender texture (DXGI_FORMAT_UNKNOWN disables)
+	void SetYUVFormat(DXGI_FORMAT format);
+	// Get the sender YUV format
+	DXGI_FORMAT GetYUVFormat();
+	// Convert pixels once for all receivers of the same image format
+	void SetSharedImages(bool bShared = true);
+	// Shared image conversion status
+	bool GetSharedImages();
+	// Publish a region of the sender texture as a separate sender
+	bool AddAtlasSender(const char* sendername,
+		unsigned int xoffset, unsigned int yoffset,
+		unsigned int width, unsigned int height);
+	// Remove a sub-sender of the sender texture
+	bool RemoveAtlasSender(const char* sendername);
+	// Number of sub-senders of the sender texture
+	int GetAtlasSenderCount();
+	// Record SendTexture in a deferred context for SubmitSend
+	void SetDeferredSend(bool bDeferred = true);
+	// Deferred send mode
+	bool GetDeferredSend();
+	// Submit the last send recorded by SendTexture on another thread
+	bool SubmitSend();
+	// Begin a batch of sends on this thread flushed once by EndSendBatch
+	static void BeginSendBatch();
+	// Flush once for the batch and signal the new frames
+	static int EndSendBatch();
+	// Send batch started on this thread
+	static bool IsSendBatch();
+	// Copy to the sender texture on a Spout thread after SendTexture returns
+	void SetAsyncSend(bool bAsync = true);
+	// Asynchronous send mode
+	bool GetAsyncSend();
+	// Copy and publish the sender texture in horizontal slices (0 or 2-16)
+	void SetSendSlices(unsigned int nSlices);
+	// Number of slices of each frame sent
+	unsigned int GetSendSlices();
+	// Send a horizontal slice of a texture as soon as it is rendered
+	bool SendTextureSlice(ID3D11Texture2D* pTexture, unsigned int slice);
 
 	//
 	// RECEIVER
@@ -119,20 +248,127 @@ class SPOUT_DLLEXP spoutDX {
 
 	// Set the sender to connect to
 	void SetReceiverName(const char * sendername = nullptr);
+	// Open sender textures on a thread when senders change
+	void SetPreconnect(bool bPreconnect = true);
+	// Pre-connect status
+	bool GetPreconnect();
+	// Return without checking the sender until it signals a new frame
+	void SetIdleReceive(bool bIdle = true, DWORD dwTimeout = 0);
+	// Idle receive status
+	bool GetIdleReceive();
+	// Receive images converted by the sender if it provides them
+	void SetReceiveSharedImage(bool bShared = true);
+	// Shared image receive status
+	bool GetReceiveSharedImage();
+	// Share the frames read back by ReceiveImage with other receivers
+	void SetFrameCache(bool bCache = true);
+	// Frame cache status
+	bool GetFrameCache();
+	// Acknowledge each frame received for a sender that waits (SetSendPolicy)
+	void SetFrameAck(bool bAck = true);
+	// Frame acknowledge status
+	bool GetFrameAck();
 	// Close receiver and free resources
 	void ReleaseReceiver();
 	// Receive from a sender
 	bool ReceiveTexture();
+	// Set an application texture for ReceiveTexture() to copy to
+	void SetReceiverTexture(ID3D11Texture2D** ppTexture = nullptr);
 	// Receive a texture from a sender
 	bool ReceiveTexture(ID3D11Texture2D** ppTexture);
+	// Receive part of the sender texture
+	bool ReceiveTexture(ID3D11Texture2D** ppTexture,
+		unsigned int xoffset, unsigned int yoffset,
+		unsigned int width, unsigned int height);
+	// Receive the next slice of the sender texture as soon as it is sent
+	SpoutReceiveStatus ReceiveTextureSlice(ID3D11Texture2D** ppTexture, unsigned int &slice, DWORD dwTimeout = 0);
+	// Receive the next slice within a region of the sender texture
+	SpoutReceiveStatus ReceiveTextureSlice(ID3D11Texture2D** ppTexture,
+		unsigned int xoffset, unsigned int yoffset,
+		unsigned int width, unsigned int height,
+		unsigned int &slice, DWORD dwTimeout = 0);
+	// Number of slices of each frame received
+	unsigned int GetReceiveSlices();
 	// Receive an image
 	bool ReceiveImage(unsigned char * pixels, unsigned int width, unsigned int height, bool bRGB = false, bool bInvert = false);
+	// Receive an image to a buffer with a line pitch including padding
+	bool ReceiveImage(unsigned char * pixels, unsigned int width, unsigned int height,
+		unsigned int pitch, bool bRGB, bool bInvert);
+	// Receive an image without waiting for the GPU copy
+	SpoutReceiveStatus TryReceiveImage(unsigned char * pixels, unsigned int width, unsigned int height,
+		bool bRGB = false, bool bInvert = false);
+	// Receive part of the sender texture to an image
+	bool ReceiveImageRegion(unsigned char * pixels,
+		unsigned int xoffset, unsigned int yoffset,
+		unsigned int width, unsigned int height,
+		bool bRGB = false, bool bInvert = false);
 	// Read pixels from texture
 	bool ReadTexurePixels(ID3D11Texture2D* ppTexture, unsigned char* pixels);
+	// Receive a view of the mapped staging texture without copy
+	bool ReceiveImageView(SpoutImageView &view);
+	// Release the view returned by ReceiveImageView
+	void ReleaseImageView();
+	// Receive the sender preview texture, or the full texture if there is none
+	bool ReceivePreview();
+	// Received preview texture
+	ID3D11Texture2D* GetPreviewTexture();
+	// Received preview width
+	unsigned int GetPreviewWidth();
+	// Received preview height
+	unsigned int GetPreviewHeight();
+	// Receive an image converted to planar YUV by compute shader
+	//   NV12 or I420, BT.601 or BT.709, limited or full range
+	//   Width and height must be even. The buffer size is width*height*3/2.
+	bool ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+		SpoutYUVLayout layout = SPOUT_YUV_NV12, SpoutYUVMatrix matrix = SPOUT_YUV_BT709,
+		bool bFullRange = false, bool bInvert = false);
+	// Receive the sender YUV texture (see SetYUVFormat)
+	bool ReceiveYUVTexture();
+	// Receive the sender YUV texture to planar NV12 or P010 pixels
+	bool ReceiveYUVImage(unsigned char* pixels, unsigned int width, unsigned int height);
+	// Received YUV texture
+	ID3D11Texture2D* GetYUVTexture();
+	// Received YUV format, or DXGI_FORMAT_UNKNOWN if the sender does not publish one
+	DXGI_FORMAT GetSenderYUVFormat();
+	// Received YUV width
+	unsigned int GetYUVWidth();
+	// Received YUV height
+	unsigned int GetYUVHeight();
+	// Use a compute shader for ReceiveImage format, flip and resize
+	void SetComputeConversion(bool bCompute = true);
+	// Compute shader conversion status
+	bool GetComputeConversion();
+	// Pack RGB pixels for ReceiveImage by compute shader (default false)
+	void SetComputeRGB(bool bCompute = true);
+	// Compute shader RGB packing status
+	bool GetComputeRGB();
+	// Set resample mode for ReceiveImage of different size
+	//   0 nearest (CPU), 1 bilinear (GPU), 2 box (GPU)
+	void SetResampleMode(int mode);
+	// Get resample mode
+	int GetResampleMode();
+	// Tone map floating point senders for ReceiveImage by compute shader
+	void SetToneMapping(SpoutToneMap mode = SPOUT_TONEMAP_ACES, float exposure = 1.0f);
+	// Tone mapping mode
+	SpoutToneMap GetToneMapping();
+	// Use the hardware video processor for ReceiveImage scaling
+	// and ReceiveImageYUV NV12 conversion
+	void SetVideoProcessing(bool bProcess = true);
+	// Video processing status
+	bool GetVideoProcessing();
+	// Read back ReceiveImage in horizontal bands that are converted
+	// as soon as each is copied (0 or 1 to disable)
+	void SetReadbackBands(int nBands);
+	// Number of readback bands
+	int GetReadbackBands();
 
 
 	// Open sender selection dialog
 	void SelectSender();
+	// Select a sender without the dialog
+	bool SelectSender(const char* sendername);
+	// Select a sender by index of the sender list
+	bool SelectSender(int index);
 	// Sender has changed
 	bool IsUpdated();
 	// Connected to a sender
@@ -145,6 +381,12 @@ class SPOUT_DLLEXP spoutDX {
 	HANDLE GetSenderHandle();
 	// Received sender texture format
 	DXGI_FORMAT GetSenderFormat();
+	// Received sender number of views (1 for a single texture)
+	unsigned int GetSenderArraySize();
+	// Received sender number of mip levels (1 without a mip chain)
+	unsigned int GetSenderMipLevels();
+	// Receive a mip level of the sender texture to a texture of the level size
+	bool ReceiveMipLevel(ID3D11Texture2D* pTexture, unsigned int level);
 	// Received sender name
 	const char * GetSenderName();
 	// Received sender width
@@ -155,6 +397,26 @@ class SPOUT_DLLEXP spoutDX {
 	double GetSenderFps();
 	// Received sender frame number
 	long GetSenderFrame();
+	// Time in msec from sender publish to receipt of the last frame
+	double GetSenderFrameAge();
+	// Number of sender frames not received
+	LONG64 GetSenderMissedFrames();
+	// Frame statistics since connection or for the last second
+	void GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow = false);
+	// Reset frame statistics
+	void ResetSenderFrameStats();
+	// Skip frames with the same content as the last received
+	void SetSkipUnchanged(bool bSkip = true);
+	// Skip unchanged frames option
+	bool GetSkipUnchanged();
+	// Histograms and waveform of each frame received by ReceiveTexture
+	void SetReceiveAnalysis(bool bAnalyze = true);
+	// Texture analysis option
+	bool GetReceiveAnalysis();
+	// Histograms and waveform of a texture by compute shader
+	bool AnalyzeTexture(ID3D11Texture2D* pTexture);
+	// Latest completed result of AnalyzeTexture
+	bool GetAnalysis(SpoutScopeData &data, bool bWait = false);
 	
 	//
 	// COMMON
@@ -170,6 +432,8 @@ class SPOUT_DLLEXP spoutDX {
 	void SetFrameSync(const char* SenderName);
 	// Wait or test for a sync event
 	bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
+	// Wait or test for the sync events of a number of senders
+	int WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout = 0);
 
 								
 	//
@@ -180,8 +444,12 @@ class SPOUT_DLLEXP spoutDX {
 	int  GetSenderCount();
 	// Get sender name for a given index
 	bool GetSender(int index, char* sendername, int MaxSize = 256);
+	// Copy the sender names to a buffer without allocation
+	int GetSenderNames(char* names, int maxsenders, int maxlength = 256);
 	// Get sender details
 	bool GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat);
+	// Get the details of all senders
+	int GetSenderList(SpoutSenderDetails* pSenders, int maxsenders);
 	// Get active sender name
 	bool GetActiveSender(char* sendername);
 	// set active sender name
@@ -215,6 +483,18 @@ class SPOUT_DLLEXP spoutDX {
 	void SetAdapterAuto(bool bAuto = true);
 	// Get sender adapter index and name for a given sender
 	int GetSenderAdapter(const char* sendername, char* adaptername = nullptr, int maxchars = 256);
+	// Receive from a sender on a different adapter by way of system memory
+	void SetAdapterBridge(bool bBridge = true);
+	// Get adapter bridge option
+	bool GetAdapterBridge();
+	// Receiving from a sender on a different adapter
+	bool IsAdapterBridge();
+	// Keep a replica of the sender texture on another graphics adapter
+	bool AddSenderReplica(int adapterindex);
+	// Remove all sender replicas
+	void ClearSenderReplicas();
+	// Number of adapters with a sender replica
+	int GetSenderReplicas();
 
 	//
 	// Graphics preference
@@ -280,12 +560,32 @@ class SPOUT_DLLEXP spoutDX {
 	bool WriteMemoryBuffer(const char *name, const char* data, int length);
 	// Read data from shared memory
 	int  ReadMemoryBuffer(const char* name, char* data, int maxlength);
+	// Lock shared memory for read without copy
+	int  LockMemoryBuffer(const char* name, const char** ppData);
+	// Unlock shared memory locked by LockMemoryBuffer
+	void UnlockMemoryBuffer();
 	// Create a shared memory buffer
 	bool CreateMemoryBuffer(const char *name, int length);
 	// Delete a shared memory buffer
 	bool DeleteMemoryBuffer();
 	// Get the number of bytes available for data transfer
 	int  GetMemoryBufferSize(const char *name);
+	// Create a named data channel with a retained shared memory map
+	bool CreateDataChannel(const char* name, int length);
+	// Write data to a named data channel
+	bool WriteDataChannel(const char* name, const char* data, int length);
+	// Read data from a named data channel
+	int  ReadDataChannel(const char* name, char* data, int maxlength);
+	// Close a named data channel
+	void CloseDataChannel(const char* name);
+	// Close all data channels
+	void CloseDataChannels();
+	// Create a frame data buffer
+	bool CreateFrameData(int maxlength);
+	// Write data sent with the next frame
+	bool WriteFrameData(const char* data, int length);
+	// Read the data sent with a frame
+	int  ReadFrameData(char* data, int maxlength, long framenumber = 0);
 
 	//
 	// Public for external access
@@ -295,6 +595,8 @@ class SPOUT_DLLEXP spoutDX {
 	spoutFrameCount frame;
 	spoutDirectX spoutdx;
 	spoutCopy spoutcopy;
+	// Scoped timing of texture and pixel transfer stages
+	spoutTimer timer;
 
 	//
 	// Options used for SpoutCam
@@ -310,10 +612,19 @@ protected :
 	ID3D11Device* m_pd3dDevice;
 	ID3D11DeviceContext* m_pImmediateContext;
 	ID3D11Texture2D* m_pSharedTexture;
+	ID3D11ShaderResourceView* m_pSharedSRV; // For GenerateMips of a sender mip chain
 	ID3D11Texture2D* m_pTexture;
+	ID3D11Texture2D** m_ppReceiverTexture; // Application texture set by SetReceiverTexture
 	ID3D11Texture2D* m_pStaging[2];
+	ID3D11Texture2D* m_pMappedStaging; // Staging texture mapped by ReceiveImageView
+	bool m_bStagingView[2]; // Staging texture written by ReceiveImageView
 	int m_Index;
 	int m_NextIndex;
+	unsigned char* m_pDirtyPixels; // Pixel buffer updated by the last ReceiveImage
+	bool m_bReadPending; // Staging texture m_Index copied by TryReceiveImage and not yet read
+	bool m_bDirtyInvert;
+	DWORD m_dwMemoryTime; // Time of the last telemetry memory update
+	void CheckTelemetryMemory();
 
 	HANDLE m_dxShareHandle;
 	DWORD m_dwFormat;
@@ -322,6 +633,15 @@ protected :
 	char m_SenderName[256];
 	unsigned int m_Width;
 	unsigned int m_Height;
+	unsigned int m_ArraySize; // Views of an array texture sender
+	unsigned int m_MipLevels; // Mip levels of the sender texture
+	bool m_bSenderMips; // Create the sender texture with a mip chain
+	bool m_bNThandle; // Share the sender texture by a named NT handle
+	HANDLE m_hNThandle; // NT handle of the sender texture
+	unsigned int m_NThandleCount; // Sender textures created with an NT handle
+	IDXGISwapChain2* m_pWaitSwapChain; // Swap chain of the waitable object
+	HANDLE m_hSwapChainWait; // Frame latency waitable object
+	double m_SwapChainLatency; // Milliseconds added by SendSwapChain
 	bool m_bUpdated;
 	bool m_bConnected;
 	bool m_bSpoutInitialized;
@@ -329,30 +649,535 @@ protected :
 	bool m_bSpoutPanelActive;
 	bool m_bClassDevice;
 	bool m_bAdapt;
+	bool m_bBridge; // Receive from a sender on a different adapter
 	bool m_bMemoryShare; // Using 2.006 memoryshare methods
 	SHELLEXECUTEINFOA m_ShExecInfo; // For ShellExecute
+	HANDLE m_hSpoutPanelWait; // Wait registered for the SpoutPanel process
+	volatile LONG m_SpoutPanelClosed; // Set by the wait when SpoutPanel closes
+	char m_SelectedSender[256]; // Sender selected without SpoutPanel
+
+	// Sender change count and time of the last check for a sender
+	bool m_bSenderFound;
+	LONG m_SenderGeneration;
+	DWORD m_dwSenderCheck;
+	LONG m_SharedGeneration; // Sender change count of the last shared texture check
+	LONG m_SenderInfoChange; // Connected sender information change count of the last check
+	LONG m_SenderInfoGeneration; // Sender change count of the last connected sender check
+	DWORD m_dwSenderInfoCheck;
+	bool m_bPreconnect; // Open sender textures on a thread (SetPreconnect)
+	bool m_bIdleReceive; // Wait for the sender frame event (SetIdleReceive)
+	DWORD m_dwIdleTimeout;
+	LONG m_IdleGeneration; // Sender change count of the last idle test
 
 	// For WriteMemoryBuffer/ReadMemoryBuffer
 	SpoutSharedMemory memorybuffer;
 
-	bool CheckSender(unsigned int width, unsigned int height, DWORD dwFormat);
+	// Named data channels
+	SpoutDataChannel m_DataChannels[SPOUT_DATA_CHANNELS];
+	int FindDataChannel(const char* name);
+
+	// Shared texture ring
+	ID3D11Texture2D* m_pRingTexture[4];
+	IDXGIKeyedMutex* m_pRingMutex[4]; // Keyed mutex of each texture (SPOUT_RING_KEYED)
+	int m_nRing; // Sender number of ring textures
+	int m_nRingOpen; // Number of ring textures created or opened
+	LONG64 m_RingFrame; // Receiver last ring frame copied
+	bool m_bRingOrdered; // Receiver read ring frames in order (send queue)
+	SpoutSharedMemory m_RingMemory;
+	ID3D11Fence* m_pRingFence; // Fence of a D3D12 sender ring (SPOUT_RING_FENCE)
+	ID3D11DeviceContext4* m_pRingContext; // For the ring fence wait
+	bool OpenRingFence(const SharedTextureRing &ring);
+	bool CreateTextureRing(unsigned int width, unsigned int height, DWORD dwFormat);
+	bool OpenTextureRing(const char* sendername);
+	void ReleaseTextureRing();
+	bool WriteTextureRing(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion = nullptr);
+	bool ReadTextureRing(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion = nullptr);
+
+	// Send policy
+	SpoutSendPolicy m_SendPolicy;
+	DWORD m_dwSendTimeout; // Wait for receiver acknowledgement
+	LONG64 m_SendDropped; // Frames not sent
+	LONG64 m_SendOverrun; // Frames overwritten before acknowledgement
+	// Render directly to the sender texture (BeginFrame/EndFrame)
+	ID3D11RenderTargetView* m_pSharedRTV; // Render target view of the sender texture
+	ID3D11Texture2D* m_pSharedRTVTexture; // Sender texture of the view
+	bool m_bFrameBegun; // BeginFrame has access to the sender texture
+	void ReleaseSharedRTV();
+	bool m_bFrameAck; // Receiver acknowledge frames
+	// Region of the sender texture to receive
+	bool GetSourceRegion(unsigned int xoffset, unsigned int yoffset,
+		unsigned int width, unsigned int height, D3D11_BOX &region);
+
+	// Atlas sub-senders
+	SpoutAtlasSender m_AtlasSender[SPOUT_ATLAS_SENDERS];
+	SpoutSharedMemory m_AtlasMemory[SPOUT_ATLAS_SENDERS];
+	int m_nAtlas; // Number of sub-senders
+	bool m_bAtlasRegion; // Receiver connected to a sub-sender
+	D3D11_BOX m_AtlasRegion; // Region of the atlas texture for the receiver
+	bool CreateAtlasSender(int index);
+	void ReleaseAtlasSender(int index);
+	void UpdateAtlasSenders();
+	void ReleaseAtlasSenders();
+	bool OpenAtlasRegion(const char* sendername, char* atlasname, int maxchars);
+	// Copy the sender texture, or the atlas region, to a receiving texture
+	void CopySenderTexture(ID3D11Texture2D* pTexture);
+
+	// Deferred send
+	bool m_bDeferredSend;
+	ID3D11DeviceContext* m_pDeferredContext;
+	ID3D11CommandList* m_pCommandList; // Last send recorded
+	SRWLOCK m_DeferredLock; // For the command list and sender texture
+	unsigned int m_DeferredWidth; // Sender update for SubmitSend
+	unsigned int m_DeferredHeight;
+	unsigned int m_DeferredArraySize;
+	DWORD m_dwDeferredFormat;
+	bool SendDeferred(ID3D11Texture2D* pTexture);
+	void ReleaseDeferred(bool bContext);
+
+	// Flush and signal a new frame, or queue for EndSendBatch
+	void SignalSend();
+
+	// Frame slices (SetSendSlices)
+	unsigned int m_nSendSlices; // Slices of each frame sent
+	unsigned int m_ReceiveSlices; // Slices of each frame received
+	LONG64 m_ReceiveSliceFrame; // Frame of the slices being received
+	unsigned int m_ReceiveSliceNext; // Next slice to receive
+	bool WriteSenderSlices(ID3D11Texture2D* pTexture);
+	bool WriteSenderSlice(ID3D11Texture2D* pTexture, unsigned int slice);
+
+	// Asynchronous send
+	bool m_bAsyncSend;
+	ID3D11Texture2D* m_pAsyncTexture[SPOUT_ASYNC_TEXTURES]; // Snapshots of sent textures
+	LONG m_AsyncWrite; // Snapshot of the last send, -1 if copied
+	LONG m_AsyncRead; // Snapshot being copied by the thread, -1 if none
+	SRWLOCK m_AsyncLock; // For the snapshot indices and sender texture
+	HANDLE m_hAsyncThread;
+	HANDLE m_hAsyncStop;
+	HANDLE m_hAsyncEvent; // Signalled for a new snapshot
+	ID3D11Multithread* m_pMultithread; // Immediate context protection
+	bool SendAsync(ID3D11Texture2D* pTexture);
+	bool CheckAsyncTextures();
+	bool StartAsyncSend();
+	void StopAsyncSend();
+	static DWORD WINAPI AsyncSendThread(LPVOID lpParameter);
+	void AsyncSendLoop();
+
+	// Preview texture
+	ID3D11Texture2D* m_pPreviewTexture; // Shared preview texture
+	ID3D11Texture2D* m_pPreviewMips; // Sender texture with mip levels
+	ID3D11ShaderResourceView* m_pPreviewSRV; // For GenerateMips
+	ID3D11Texture2D* m_pPreviewReceived; // Receiver copy of the preview
+	unsigned int m_PreviewMaxWidth; // Sender maximum preview width
+	unsigned int m_PreviewLevel; // Mip level of the preview
+	unsigned int m_PreviewWidth;
+	unsigned int m_PreviewHeight;
+	bool m_bPreviewOpen; // Preview created or opened
+	LONG64 m_PreviewFrame; // Receiver last preview frame copied
+	SpoutSharedMemory m_PreviewMemory;
+	bool CreatePreview(unsigned int width, unsigned int height, DWORD dwFormat);
+	bool OpenPreview(const char* sendername);
+	void ReleasePreview();
+	bool WritePreview(ID3D11Texture2D* pTexture, const D3D11_BOX* pSourceRegion = nullptr);
+
+	// YUV texture
+	DXGI_FORMAT m_YUVFormat; // Sender YUV format set by SetYUVFormat
+	ID3D11Texture2D* m_pYUVTexture; // Shared NV12 or P010 texture
+	ID3D11Texture2D* m_pYUVReceived; // Receiver copy of the YUV texture
+	ID3D11Texture2D* m_pYUVStaging; // Receiver staging texture for ReceiveYUVImage
+	unsigned int m_YUVWidth;
+	unsigned int m_YUVHeight;
+	DWORD m_dwYUVFormat; // Format of the texture created or opened
+	bool m_bYUVOpen; // YUV texture created or opened
+	LONG64 m_YUVFrame; // Receiver last YUV frame copied
+	LONG64 m_YUVPixelFrame; // Receiver last YUV frame read back by ReceiveYUVImage
+	unsigned char* m_pYUVPixels; // Buffer of the last read back
+	SpoutSharedMemory m_YUVMemory;
+	// Video processor for RGB to YUV conversion
+	ID3D11VideoDevice* m_pVideoDevice;
+	ID3D11VideoContext* m_pVideoContext;
+	ID3D11VideoProcessorEnumerator* m_pVideoEnum;
+	ID3D11VideoProcessor* m_pVideoProcessor;
+	ID3D11VideoProcessorOutputView* m_pYUVOutputView;
+	ID3D11VideoProcessorInputView* m_pYUVInputView; // Input view of m_pYUVSource
+	ID3D11Texture2D* m_pYUVSource; // Texture of the input view
+	bool CreateYUV(unsigned int width, unsigned int height, DWORD dwFormat);
+	bool OpenYUV(const char* sendername);
+	void ReleaseYUV();
+	bool WriteYUV(ID3D11Texture2D* pTexture);
+
+	// Shared images
+	// The sender converts a frame once for each image format
+	// requested by receivers (see SetSharedImages)
+	bool m_bSharedImages; // Sender option
+	bool m_bReceiveSharedImage; // Receiver option
+	SpoutSharedMemory m_ImageRequests; // Request entries of the sender
+	SpoutSharedMemory m_SharedImage[SPOUT_SHARED_IMAGES]; // Sender images
+	SharedImageRequest m_SharedImageKey[SPOUT_SHARED_IMAGES]; // Format of each image created
+	ID3D11Texture2D* m_pImageStaging[2]; // Sender staging textures
+	int m_ImageIndex; // Staging texture for the next copy
+	LONG64 m_ImageFrame; // Number of frames copied to staging
+	SpoutSharedMemory m_ReceivedImage; // Image opened by the receiver
+	SharedImageRequest m_ReceivedImageKey; // Format of the image opened
+	ULONGLONG m_ImageRequestTime; // Receiver time of the last request
+	LONG64 m_ReceivedImageFrame; // Receiver last frame copied
+	unsigned int m_ImageRetry; // Receiver calls until the next open attempt
+	bool CreateSharedImages();
+	void ReleaseSharedImages();
+	void WriteSharedImages(ID3D11Texture2D* pTexture);
+	bool ReadSharedImage(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert);
+	bool RequestSharedImage(const SharedImageRequest &key);
+
+	// Frame cache
+	// One receiver reads back each frame for all receivers (see SetFrameCache)
+	bool m_bFrameCache; // Receiver option
+	SpoutSharedMemory m_FrameCacheMemory;
+	unsigned int m_FrameCacheWidth; // Size and format of the cache opened
+	unsigned int m_FrameCacheHeight;
+	DWORD m_dwFrameCacheFormat;
+	LONG64 m_FrameCacheLast; // Last frame received
+	LONG64 m_StagingFrame[2]; // Sender frame copied to each staging texture
+	bool OpenFrameCache();
+	void ReleaseFrameCache();
+	bool ReceiveFrameCache(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert);
+	bool ReadFrameCache(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert, LONG64 minframe);
+
+	bool CheckSender(unsigned int width, unsigned int height, DWORD dwFormat, unsigned int arraysize = 1);
+	void CreateSenderMips(bool bMips);
+	bool CreateSenderTexture(unsigned int width, unsigned int height, DWORD dwFormat, unsigned int arraysize, unsigned int miplevels);
+	void ReleaseSenderNTHandle();
+	void GenerateSenderMips();
+	void ReleaseSwapChainWait();
 	ID3D11Texture2D* CheckSenderTexture(char *sendername, HANDLE dxShareHandle);
 
+	// Adapter bridge
+	// The sender texture is opened by a device on the sender adapter and
+	// copied to staging textures. The last completed is copied to a
+	// class texture on the receiving device in place of the shared texture.
+	ID3D11Device* m_pBridgeDevice; // Device on the sender adapter
+	ID3D11DeviceContext* m_pBridgeContext;
+	ID3D11Texture2D* m_pBridgeShared; // Sender texture opened by the bridge device
+	ID3D11Texture2D* m_pBridgeStaging[SPOUT_BRIDGE_STAGING];
+	LONG64 m_BridgeCopy[SPOUT_BRIDGE_STAGING]; // Copy number, 0 if not pending
+	LONG64 m_BridgeCount; // Copies made
+	int m_BridgeNext; // Next staging texture
+	spoutFrameCount m_BridgeFrame; // Sender mutex and frame count for the bridge
+	ID3D11Texture2D* OpenBridge(const char* sendername, HANDLE dxShareHandle);
+	void CloseBridge();
+	void UpdateBridge();
+
+	// Sender replicas
+	// Each frame is copied to the next of a ring of staging textures and
+	// the last completed updates a shared texture on each replica adapter,
+	// so that a frame is read back once for all the receivers on them.
+	int m_ReplicaAdapter[SPOUT_MAX_REPLICAS]; // Adapters requested
+	int m_nReplicaAdapters;
+	ID3D11Device* m_pReplicaDevice[SPOUT_MAX_REPLICAS]; // Device on each replica adapter
+	ID3D11DeviceContext* m_pReplicaContext[SPOUT_MAX_REPLICAS];
+	ID3D11Texture2D* m_pReplicaTexture[SPOUT_MAX_REPLICAS]; // Shared replica textures
+	int m_nReplicas; // Replicas created
+	ID3D11Texture2D* m_pReplicaStaging[SPOUT_BRIDGE_STAGING];
+	LONG64 m_ReplicaCopy[SPOUT_BRIDGE_STAGING]; // Copy number, 0 if not pending
+	LONG64 m_ReplicaCount; // Copies made
+	int m_ReplicaNext; // Next staging texture
+	SpoutSharedMemory m_ReplicaMemory;
+	bool CreateReplicas(unsigned int width, unsigned int height, DWORD dwFormat);
+	void ReleaseReplicas();
+	bool WriteReplicas(ID3D11Texture2D* pTexture);
+	ID3D11Texture2D* OpenReplica(const char* sendername);
+
 	bool ReceiveSenderData();
+	bool IsReceiverIdle();
 	void CreateReceiver(const char * sendername, unsigned int width, unsigned int height, DWORD dwFormat);
 	
 	// Read pixels from a staging texture
 	bool ReadPixelData(ID3D11Texture2D* pStagingSource, unsigned char* destpixels,
-		unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap);
+		unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap,
+		unsigned int destPitch = 0);
+	// Copy mapped pixels of the sender format to a user buffer
+	void CopyPixelData(const void* pSource, unsigned int srcPitch,
+		unsigned int srcWidth, unsigned int srcHeight, unsigned char* destpixels,
+		unsigned int width, unsigned int height, bool bRGB, bool bInvert, bool bSwap,
+		unsigned int destPitch = 0);
+	// Read the changed regions from a staging texture
+	bool ReadDirtyPixels(ID3D11Texture2D* pStagingSource, unsigned char* destpixels,
+		const RECT* pRects, unsigned int nRects, bool bInvert);
+	// Copy the changed regions of recent frames
+	void CopyDirtyRects(ID3D11Texture2D* pDest, ID3D11Texture2D* pSource, unsigned int nFrames);
 	
 	// Create or update staging textures
 	bool CheckStagingTextures(unsigned int width, unsigned int height, DWORD dwFormat = DXGI_FORMAT_B8G8R8A8_UNORM);
 
+	// Compute shader conversion for ReceiveImage
+	// The sender texture is converted to the receiving buffer format and size
+	// and copied to staging buffers that are read by a single memcpy
+	bool m_bComputeConversion;
+	bool m_bComputeRGB; // RGB pixels packed on the GPU
+	int m_ResampleMode; // 0 nearest, 1 bilinear, 2 box
+	SpoutToneMap m_ToneMap; // Floating point senders tone mapped to 8 bit
+	float m_ToneMapExposure;
+	bool IsToneMapped();
+	ID3D11ComputeShader* m_pConvertShader;
+	ID3D11ComputeShader* m_pConvertYUVShader; // Planar YUV for ReceiveImageYUV
+	ID3D11Buffer* m_pConvertConstants;
+	ID3D11Buffer* m_pConvertBuffer;
+	ID3D11UnorderedAccessView* m_pConvertUAV;
+	ID3D11Buffer* m_pConvertStaging[2];
+	unsigned int m_ConvertSize; // Bytes of converted pixel data
+	ID3D11ShaderResourceView* m_pConvertSRV;
+	ID3D11Texture2D* m_pConvertSource; // Texture of the shader resource view
+	bool CreateConvertShader(bool bYUV = false);
+	ID3D11ComputeShader* CompileComputeShader(const char* shader);
+	bool CheckConvertBuffers(unsigned int size);
+	bool ConvertPixelData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+		bool bRGB, bool bInvert, bool bSwap);
+	bool ConvertYUVData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+		SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert);
+	bool DispatchConvert(ID3D11ComputeShader* pShader, ID3D11Texture2D* pSource,
+		unsigned int width, unsigned int height, unsigned int mode, unsigned int flags);
+	bool ReadConvertedData(unsigned char* destpixels, unsigned int size,
+		unsigned int lines = 0, unsigned int destPitch = 0);
+	void ReleaseConvert();
+
+	// Histograms and waveform by compute shader (AnalyzeTexture)
+	bool m_bReceiveAnalysis;
+	ID3D11ComputeShader* m_pScopeShader;
+	ID3D11Buffer* m_pScopeBuffer;
+	ID3D11UnorderedAccessView* m_pScopeUAV;
+	ID3D11Buffer* m_pScopeStaging[2];
+	bool m_bScopePending[2]; // Copied and not yet replaced
+	int m_ScopeIndex; // Next staging buffer to copy to
+	ID3D11ShaderResourceView* m_pScopeSRV;
+	ID3D11Texture2D* m_pScopeSource; // Texture of the shader resource view
+	bool CheckScopeBuffers();
+	void ReleaseScope();
+
+	// Video processor for ReceiveImage and ReceiveImageYUV
+	// The sender texture is scaled or converted by the video engine
+	// to an output texture and copied to staging textures of the output size
+	bool m_bVideoProcessing;
+	ID3D11VideoDevice* m_pVPDevice;
+	ID3D11VideoContext* m_pVPContext;
+	ID3D11VideoProcessorEnumerator* m_pVPEnum;
+	ID3D11VideoProcessor* m_pVPProcessor;
+	ID3D11Texture2D* m_pVPTexture; // Output texture
+	ID3D11VideoProcessorOutputView* m_pVPOutputView;
+	ID3D11VideoProcessorInputView* m_pVPInputView; // Input view of m_pVPSource
+	ID3D11Texture2D* m_pVPSource; // Texture of the input view
+	ID3D11Texture2D* m_pVPStaging[2];
+	unsigned int m_VPInputWidth;
+	unsigned int m_VPInputHeight;
+	unsigned int m_VPOutputWidth;
+	unsigned int m_VPOutputHeight;
+	DXGI_FORMAT m_VPOutputFormat;
+	bool CheckVideoProcessor(ID3D11Texture2D* pSource, unsigned int width, unsigned int height, DXGI_FORMAT format);
+	bool ProcessVideoData(ID3D11Texture2D* pSource, unsigned int width, unsigned int height,
+		DXGI_FORMAT format, SpoutYUVMatrix matrix = SPOUT_YUV_BT709, bool bFullRange = false);
+	bool ReadVideoYUV(unsigned char* destpixels, unsigned int width, unsigned int height, bool bInvert);
+	void ReleaseVideoProcessor();
+
+	// Banded readback for ReceiveImage
+	// Bands of the sender texture are copied to separate staging textures
+	// with an event query for each so that conversion overlaps the transfer
+	int m_nReadBands;
+	ID3D11Texture2D* m_pBandStaging[SPOUT_READBACK_BANDS];
+	ID3D11Query* m_pBandQuery[SPOUT_READBACK_BANDS];
+	unsigned int m_BandWidth;
+	unsigned int m_BandHeight; // Lines of each band
+	DWORD m_dwBandFormat;
+	bool CheckReadbackBands(unsigned int width, unsigned int height, DWORD dwFormat);
+	bool ReadBandedPixels(unsigned char* destpixels, bool bRGB, bool bInvert, unsigned int destPitch = 0);
+	void ReleaseReadbackBands();
+
 	// Create or update class texture
 	bool CheckTexture(unsigned int width, unsigned int height, DWORD dwFormat);
+	// Create or update the application texture set by SetReceiverTexture
+	bool CheckReceiverTexture(unsigned int width, unsigned int height, DWORD dwFormat, bool &bCreated);
 
 	void SelectSenderPanel();
 	bool CheckSpoutPanel(char *sendername, int maxchars = 256);
+	bool IsSenderSelected();
+	bool IsSpoutPanelClosed();
+	void ReleaseSpoutPanel();
+
+};
+
+//
+// Latest frame returned by spoutReceiveThread::AcquireFrame
+//
+struct SpoutThreadFrame {
+	const unsigned char* data; // First pixel of the top line or null if no frame
+	unsigned int width; // Width in pixels
+	unsigned int height; // Height in lines
+	unsigned int pitch; // Bytes per line
+	bool bRGB; // rgb or rgba pixels
+	LONG64 frame; // Sender frame number
+};
+
+// New frame callback of spoutReceiveThread, called on the receiving thread.
+// The pixels remain valid until the callback returns.
+typedef void (*SpoutFrameCallback)(const SpoutThreadFrame &frame, void* pUserData);
+
+//
+// Receive to pixel buffers on a dedicated thread.
+//
+// The thread has its own spoutDX object and D3D11 device. It finds the sender,
+// copies to staging textures, maps and converts to the back buffer of three.
+// A completed frame is exchanged with the latest buffer and AcquireFrame
+// exchanges the latest with the buffer held by the application.
+// Neither thread waits for the other except for the exchange.
+//
+class SPOUT_DLLEXP spoutReceiveThread {
+
+public:
+
+	spoutReceiveThread();
+	~spoutReceiveThread();
+
+	// Start receiving from a sender or the active sender if null
+	bool Start(const char* sendername = nullptr, bool bRGB = false, bool bInvert = false);
+	// Stop the thread and release buffers
+	void Stop();
+	// Thread is running
+	bool IsRunning();
+	// Connected to a sender
+	bool IsConnected();
+	// Latest frame received (non-blocking)
+	bool AcquireFrame(SpoutThreadFrame &frame);
+	// Wait for a new frame
+	bool WaitFrame(SpoutThreadFrame &frame, DWORD dwTimeout = INFINITE);
+	// Event signalled for each new frame
+	HANDLE GetFrameEvent();
+	// Function called on the thread for each new frame
+	void SetFrameCallback(SpoutFrameCallback callback, void* pUserData = nullptr);
+
+protected:
+
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	CRITICAL_SECTION m_Lock; // For buffer exchange
+	unsigned char* m_pBuffer[3];
+	unsigned int m_BufferSize[3]; // Bytes allocated
+	unsigned int m_BufferWidth[3];
+	unsigned int m_BufferHeight[3];
+	LONG64 m_BufferFrame[3];
+	int m_Back; // Written by the thread
+	int m_Ready; // Latest frame completed
+	int m_Front; // Held by the application
+	bool m_bReadyNew; // Latest frame not acquired
+	HANDLE m_hFrameEvent; // Signalled for a new frame
+	SpoutFrameCallback m_FrameCallback;
+	void* m_pCallbackData;
+	volatile LONG m_bConnected;
+	char m_SenderName[256];
+	bool m_bRGB;
+	bool m_bInvert;
+
+	static DWORD WINAPI ReceiveThread(LPVOID lpParameter);
+	void ReceiveLoop();
+	bool CheckBuffer(int index, unsigned int width, unsigned int height);
+
+};
+
+//
+// Receive from a number of senders with one device
+//
+
+// Maximum senders of a receiver group
+#define SPOUT_GROUP_MAX 128
+// Textures in the group texture pool
+#define SPOUT_GROUP_POOL (SPOUT_GROUP_MAX*2)
+
+// New frame callback of spoutReceiverGroup
+//    index - sender index returned by AddSender
+//    pTexture - receiver copy of the sender texture
+typedef void (*SpoutGroupCallback)(int index, const char* sendername, ID3D11Texture2D* pTexture, void* pUserData);
+
+// Sender received by spoutReceiverGroup
+struct SpoutGroupSender {
+	char name[256];
+	bool bConnected;
+	HANDLE shareHandle;
+	unsigned int width;
+	unsigned int height;
+	DWORD format;
+	ID3D11Texture2D* pSharedTexture; // Sender shared texture
+	ID3D11Texture2D* pTexture; // Receiver copy from the texture pool
+	spoutFrameCount* pFrame; // Access mutex and frame count
+	LONG64 frame; // Sender frame number of the last copy
+	SpoutGroupCallback callback;
+	void* pUserData;
+};
+
+// Texture of the spoutReceiverGroup pool
+struct SpoutPoolTexture {
+	ID3D11Texture2D* pTexture;
+	unsigned int width;
+	unsigned int height;
+	DWORD format;
+	bool bStaging;
+	bool bInUse;
+};
+
+class SPOUT_DLLEXP spoutReceiverGroup {
+
+public:
+
+	spoutReceiverGroup();
+	~spoutReceiverGroup();
+
+	// Initialize with a device or create one
+	bool OpenDirectX11(ID3D11Device* pDevice = nullptr);
+	// Release senders, textures and the device
+	void CloseDirectX11();
+	// Group device
+	ID3D11Device* GetDX11Device();
+	// Group immediate context
+	ID3D11DeviceContext* GetDX11Context();
+
+	// Add a sender to receive. Returns the index or -1.
+	int AddSender(const char* sendername, SpoutGroupCallback callback = nullptr, void* pUserData = nullptr);
+	// Remove a sender
+	void RemoveSender(int index);
+	// Remove all senders
+	void RemoveAllSenders();
+	// Receive new frames of all senders. Returns the number received.
+	int ReceiveAll();
+
+	// Connected to a sender
+	bool IsConnected(int index);
+	// Receiver copy of the sender texture
+	ID3D11Texture2D* GetSenderTexture(int index);
+	// Sender width
+	unsigned int GetSenderWidth(int index);
+	// Sender height
+	unsigned int GetSenderHeight(int index);
+	// Sender texture format
+	DXGI_FORMAT GetSenderFormat(int index);
+	// Sender frame number of the last texture received
+	LONG64 GetSenderFrame(int index);
+	// Read the last texture received to an rgba or rgb buffer of the sender size
+	bool ReadPixels(int index, unsigned char* pixels, bool bRGB = false, bool bInvert = false);
+
+protected:
+
+	ID3D11Device* m_pd3dDevice;
+	ID3D11DeviceContext* m_pImmediateContext;
+	bool m_bClassDevice;
+	spoutDirectX spoutdx;
+	spoutSenderNames sendernames;
+	spoutCopy spoutcopy;
+
+	SpoutGroupSender* m_pSenders[SPOUT_GROUP_MAX];
+	SpoutPoolTexture m_Pool[SPOUT_GROUP_POOL];
+	LONG m_SenderGeneration; // Sender change count of the last check
+	DWORD m_dwSenderCheck;
+
+	bool CheckSender(SpoutGroupSender* pSender);
+	void ReleaseSender(SpoutGroupSender* pSender);
+	bool ReceiveSender(int index);
+	ID3D11Texture2D* AcquirePoolTexture(unsigned int width, unsigned int height, DWORD format, bool bStaging);
+	void ReleasePoolTexture(ID3D11Texture2D* pTexture);
+	void ReleasePool();
 
 };
 
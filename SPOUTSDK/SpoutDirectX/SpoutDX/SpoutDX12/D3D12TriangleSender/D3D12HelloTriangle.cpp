@@ -3,7 +3,7 @@
 // 
 // This is a sender using "spoutDX12" and "SpoutDX" support classes
 //
-// bool spoutDX12::SendDX11Resource(ID3D12Resource* pResource)
+// bool spoutDX12::SendDX12Resource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES InitialState)
 //
 // Search on "SPOUT" for additions.
 // - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -25,7 +25,6 @@
 // SPOUT
 #include "..\SpoutDX12.h"
 spoutDX12 sender;
-ComPtr<ID3D11Resource> m_wrappedBackBuffers[3]; // D3D12 backbuffers wrapped for use with D3D11
 
 
 D3D12HelloTriangle::D3D12HelloTriangle(UINT width, UINT height, std::wstring name) :
@@ -165,11 +164,6 @@ void D3D12HelloTriangle::LoadPipeline()
             ThrowIfFailed(m_swapChain->GetBuffer(n, IID_PPV_ARGS(&m_renderTargets[n])));
             m_device->CreateRenderTargetView(m_renderTargets[n].Get(), nullptr, rtvHandle);
             rtvHandle.Offset(1, m_rtvDescriptorSize);
-
-			// SPOUT
-			// Create a wrapped 11on12 resource of this back buffer
-			// using the class D3D11on12 device created by "OpenDirectX12"
-			sender.WrapDX12Resource(m_renderTargets[n].Get(), &m_wrappedBackBuffers[n], D3D12_RESOURCE_STATE_RENDER_TARGET);
         }
 
     }
@@ -326,11 +320,13 @@ void D3D12HelloTriangle::OnRender()
 	//
 	// SPOUT
 	//
-	// Send the wrapped D3D11on12 backbuffer texture resource.
+	// Send the backbuffer texture resource.
 	//
-	// SendDX11Resource handles D3D11on12 wrap Acquire and Release,
+	// SendDX12Resource wraps each back buffer for D3D11on12 on first use
+	// and retains it. It handles wrap Acquire and Release,
 	// texture sync, sender creation and resize updates.
-	sender.SendDX11Resource(m_wrappedBackBuffers[m_frameIndex].Get());
+	// Call sender.ClearWrappedResources() before a swap chain resize.
+	sender.SendDX12Resource(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
 
 	// Present the frame.
 	ThrowIfFailed(m_swapChain->Present(1, 0));
@@ -10,6 +10,28 @@
 //		26.01.21	- First working version
 //		01.03.21	- Cleanup
 //		11.06.21	- Add documentation
+//		14.10.26	- Add native D3D12 sharing without D3D11on12.
+//					  OpenDirectX12Native, SendDX12Resource, IsDirectX12Native,
+//					  GetDX12Fence, GetDX12FenceValue. ReceiveDX12Resource uses
+//					  the native copy if open. A D3D12 copy queue copies to or from
+//					  a texture shared with a D3D11 device on the same adapter
+//					  with a shared fence for sync on the GPU.
+//					- Add ReceiveDX12Image. Copy queue readback to a ring of
+//					  fence tracked readback buffers.
+//					- Add SendDX12Resource for D3D11on12 with a cache of wrapped
+//					  resources keyed by the D3D12 resource. Add ClearWrappedResources.
+//		15.10.26	- Add SetDX12MemoryShare. Native send copies each frame on the
+//					  copy queue directly to the sender memory ring, opened as a
+//					  D3D12 heap by OpenExistingHeapFromAddress.
+//					- Add SetDX12TextureRing. Native send copies each frame to the
+//					  next of a ring of named shared D3D12 textures and signals a
+//					  shared ring fence with the frame number for receivers.
+//					- Add ReceiveDX12Shared, SetDX12ReceiveHeap, TransitionDX12Shared
+//					  and ClearDX12Shared. Shared resources and shader resource views
+//					  are cached for each sender share handle.
+//					- SetDX12TextureRing - minimum of 3 ring textures
+//					- CreateMemoryRing - the ring name has the frame size
+//					  (SpoutMemoryRingName). A new ring is created for a different size.
 //
 // ====================================================================================
 /*
@@ -58,12 +80,99 @@ spoutDX12::spoutDX12() {
 	m_pd3d11On12Device = nullptr; // D3D11on12 device
 	m_bClassDevice = false; // External or class D3D12 device
 	m_pReceivedResource11 = nullptr; // The wrapped D3D11 resource for D3D12
+	for (int i = 0; i < SPOUT_DX12_WRAPPED; i++) {
+		m_pWrapKey[i] = nullptr;
+		m_pWrapped[i] = nullptr;
+		m_WrapState[i] = D3D12_RESOURCE_STATE_COMMON;
+		m_WrapUsed[i] = 0;
+	}
+	m_WrapCount = 0;
 	m_pAdapterDX12 = nullptr; // Current IDXGIAdapter1 graphics adapter
 
+	// Native sharing
+	m_bNative = false;
+	m_pCopyQueue = nullptr;
+	m_pCopyAllocator = nullptr;
+	m_pCopyList = nullptr;
+	m_pFence12 = nullptr;
+	m_pFence11 = nullptr;
+	m_pContext4 = nullptr;
+	m_FenceValue = 0;
+	m_CopyValue = 0;
+	m_hFenceEvent = NULL;
+	m_pBridge12 = nullptr;
+	m_pBridge11 = nullptr;
+	m_BridgeWidth = 0;
+	m_BridgeHeight = 0;
+	m_BridgeFormat = DXGI_FORMAT_UNKNOWN;
+
+	// Readback ring
+	for (int i = 0; i < SPOUT_DX12_READBACK; i++) {
+		m_pReadback[i] = nullptr;
+		m_pReadbackAllocator[i] = nullptr;
+		m_pReadbackList[i] = nullptr;
+		m_ReadbackValue[i] = 0;
+	}
+	m_ReadbackLast = 0;
+	m_ReadbackNext = 0;
+	m_ReadbackFootprint = {};
+
+	// Memory ring
+	m_bMemoryRing = false;
+	m_pRingHeap = nullptr;
+	m_pRingBuffer = nullptr;
+	for (int i = 0; i < SPOUT_MEMORY_SLOTS; i++) {
+		m_pRingAllocator[i] = nullptr;
+		m_pRingList[i] = nullptr;
+		m_RingValue[i] = 0;
+		m_RingFrame[i] = 0;
+	}
+	m_RingLast = 0;
+	m_RingWidth = 0;
+	m_RingHeight = 0;
+
+	// Native texture ring
+	m_nDX12Ring = 0;
+	m_nDX12RingOpen = 0;
+	for (int i = 0; i < 4; i++) {
+		m_pDX12Ring12[i] = nullptr;
+		m_pDX12Ring11[i] = nullptr;
+		m_hDX12Ring[i] = NULL;
+		m_pDX12RingAllocator[i] = nullptr;
+		m_pDX12RingList[i] = nullptr;
+		m_DX12RingValue[i] = 0;
+	}
+	m_pDX12RingFence = nullptr;
+	m_pDX12RingFence11 = nullptr;
+	m_hDX12RingFence = NULL;
+	m_DX12RingFrame = 0;
+	m_DX12RingId = 0;
+	m_DX12RingWidth = 0;
+	m_DX12RingHeight = 0;
+	m_DX12RingFormat = DXGI_FORMAT_UNKNOWN;
+	m_DX12RingSender[0] = 0;
+
+	// Received resource cache
+	m_pSharedHeap = nullptr;
+	m_SharedFirst = 0;
+	m_SharedIncrement = 0;
+	for (int i = 0; i < SPOUT_DX12_SHARED; i++) {
+		m_SharedKey[i] = NULL;
+		m_pShared12[i] = nullptr;
+		m_pShared11[i] = nullptr;
+		m_SharedState[i] = D3D12_RESOURCE_STATE_COMMON;
+		m_SharedUsed[i] = 0;
+	}
+	m_SharedCount = 0;
+	m_SharedLast = -1;
+
 }
 
 spoutDX12::~spoutDX12() {
 
+	ReleaseNativeCopy();
+	ClearWrappedResources();
+
 	if (m_pd3dDevice12) m_pd3dDevice12->Release();
 	if (m_pd3dDevice11) m_pd3dDevice11->Release();
 	if (m_pd3dDeviceContext11) m_pd3dDeviceContext11->Release();
@@ -145,6 +254,12 @@ void spoutDX12::CloseDirectX12()
 		return;
 	}
 
+	// Release native copy objects
+	ReleaseNativeCopy();
+
+	// Release cached wrapped resources
+	ClearWrappedResources();
+
 	// Release class D3D11on12
 	if (m_pd3dDevice11) m_pd3dDevice11->Release(); // D3D11 device
 	if (m_pd3dDeviceContext11) m_pd3dDeviceContext11->Release(); // D3D11 context
@@ -182,6 +297,60 @@ bool spoutDX12::SendDX11Resource(ID3D11Resource *pWrappedResource)
 
 }
 
+// Function: SendDX12Resource
+// Send a D3D12 texture resource by a cached D3D11on12 wrapped resource.
+//
+// The wrapped resource is created on first use and retained for
+// following frames so that each send is an acquire, copy and release.
+// InitialState is the state of the resource when it is sent,
+// for example D3D12_RESOURCE_STATE_RENDER_TARGET for a back buffer.
+// The resource is returned in the present state.
+//
+// Wrapped resources hold a reference to the D3D12 resource. Call
+// ClearWrappedResources before a swap chain ResizeBuffers.
+//
+// If native sharing is open (OpenDirectX12Native), the resource
+// must be in the common state and is sent by the copy queue.
+bool spoutDX12::SendDX12Resource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES InitialState)
+{
+	if (!pResource)
+		return false;
+
+	if (m_bNative) {
+		if (InitialState != D3D12_RESOURCE_STATE_COMMON) {
+			SpoutLogWarning("spoutDX12::SendDX12Resource - native sharing requires the common state");
+			return false;
+		}
+		return SendDX12Resource(pResource, nullptr, 0);
+	}
+
+	ID3D11Resource* pWrapped = GetWrappedResource(pResource, InitialState);
+	if (!pWrapped)
+		return false;
+
+	return SendDX11Resource(pWrapped);
+}
+
+// Function: ClearWrappedResources
+// Release cached wrapped resources.
+//
+// Call before the D3D12 resources are released or resized.
+// Resources are wrapped again when next sent.
+void spoutDX12::ClearWrappedResources()
+{
+	for (int i = 0; i < SPOUT_DX12_WRAPPED; i++) {
+		if (m_pWrapped[i])
+			m_pWrapped[i]->Release();
+		m_pWrapKey[i] = nullptr;
+		m_pWrapped[i] = nullptr;
+		m_WrapUsed[i] = 0;
+	}
+	m_WrapCount = 0;
+	// Release the D3D12 references held by the device
+	if (m_pd3dDeviceContext11)
+		m_pd3dDeviceContext11->Flush();
+}
+
 // Function: ReceiveDX12Resource
 // Receive a texture from a sender to a D3D12 texture resource.
 bool spoutDX12::ReceiveDX12Resource(ID3D12Resource** ppDX12Resource)
@@ -205,6 +374,10 @@ bool spoutDX12::ReceiveDX12Resource(ID3D12Resource** ppDX12Resource)
 			// If the sender is new or changed, return to update the receiving D3D12 texture resource.
 			// The application detects the change with IsUpdated().
 
+			// Release the native bridge texture and readback for the new size
+			ReleaseReadback();
+			ReleaseBridgeTexture();
+
 			// Release the wrapped 11On12 D3D11 resource because
 			// it has to be re-created for the new receiving texture
 			if (m_pReceivedResource11)
@@ -222,6 +395,14 @@ bool spoutDX12::ReceiveDX12Resource(ID3D12Resource** ppDX12Resource)
 			return false;
 		}
 
+		// Native copy without D3D11on12
+		if (m_bNative) {
+			if (!ReceiveDX12Native(pDX12Resource))
+				return false;
+			m_bConnected = true;
+			return true;
+		}
+
 		// Is a wrapped resource created yet?
 		if (!m_pReceivedResource11) {
 			// For a receiver the texture will be created to be copied to
@@ -254,6 +435,8 @@ bool spoutDX12::ReceiveDX12Resource(ID3D12Resource** ppDX12Resource)
 	else {
 		// There is no sender or the connected sender closed.
 		ReleaseReceiver();
+		ReleaseReadback();
+		ReleaseBridgeTexture();
 		// Release the wrapped 11On12 D3D11 resource
 		if (m_pReceivedResource11)
 			m_pReceivedResource11->Release();
@@ -468,6 +651,418 @@ bool spoutDX12::CreateDX12texture(ID3D12Device* pd3dDevice12,
 }
 
 
+//
+// Group: Native DirectX12
+//
+// Sharing without D3D11on12.
+//
+// A D3D12 copy queue copies to or from a bridge texture that is
+// shared with a D3D11 device created on the same adapter.
+// D3D11 copies between the bridge texture and the sender shared texture.
+// A shared fence orders the D3D12 and D3D11 copies on the GPU
+// and neither waits on the CPU.
+//
+
+// Function: OpenDirectX12Native
+// Initialize DirectX 12 for native sharing using the D3D12 device passed in,
+// or a class D3D12 device if null.
+//
+// Create a D3D12 copy queue, a shared fence and a class D3D11 device
+// on the adapter of the D3D12 device.
+bool spoutDX12::OpenDirectX12Native(ID3D12Device* pd3dDevice12)
+{
+	if (m_pd3dDevice12) {
+		if (m_bNative)
+			return true;
+		SpoutLogWarning("spoutDX12::OpenDirectX12Native - DirectX 12 already open for D3D11on12");
+		return false;
+	}
+
+	if (pd3dDevice12) {
+		SpoutLogNotice("spoutDX12::OpenDirectX12Native(0x%.7X)", PtrToUint(pd3dDevice12));
+		m_pd3dDevice12 = pd3dDevice12;
+		m_pd3dDevice12->AddRef(); // Released by CloseDirectX12
+		m_bClassDevice = false;
+	}
+	else {
+		SpoutLogNotice("spoutDX12::OpenDirectX12Native() - class device");
+		if (!CreateDX12device()) {
+			SpoutLogWarning("spoutDX12::OpenDirectX12Native - Could not create DX12 device");
+			return false;
+		}
+	}
+
+	// The D3D11 device must use the same adapter as the D3D12 device
+	IDXGIFactory4* pFactory4 = nullptr;
+	IDXGIAdapter* pAdapter = nullptr;
+	if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&pFactory4)))) {
+		pFactory4->EnumAdapterByLuid(m_pd3dDevice12->GetAdapterLuid(), IID_PPV_ARGS(&pAdapter));
+		pFactory4->Release();
+	}
+	if (pAdapter)
+		spoutdx.SetAdapterPointer(pAdapter); // Released by spoutdx
+
+	// Class D3D11 device for textures and copy
+	OpenDirectX11();
+	if (!m_pd3dDevice) {
+		SpoutLogWarning("spoutDX12::OpenDirectX12Native - Could not create DX11 device");
+		CloseDirectX12();
+		return false;
+	}
+
+	if (!CreateNativeCopy()) {
+		CloseDirectX12();
+		return false;
+	}
+
+	m_bNative = true;
+
+	return true;
+}
+
+// Function: IsDirectX12Native
+// Native sharing is open.
+bool spoutDX12::IsDirectX12Native()
+{
+	return m_bNative;
+}
+
+// Function: SendDX12Resource
+// Send a D3D12 texture resource.
+//
+// The resource should be in the common (present) state.
+// It is used by a copy queue and returns to the common state.
+// If the application passes a fence, the copy waits on the GPU
+// until the value is signalled. Use after the commands that
+// render to the resource have been submitted.
+bool spoutDX12::SendDX12Resource(ID3D12Resource* pResource, ID3D12Fence* pWaitFence, UINT64 WaitValue)
+{
+	if (!m_bNative || !pResource)
+		return false;
+
+	const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D) {
+		SpoutLogWarning("spoutDX12::SendDX12Resource - not a 2D texture");
+		return false;
+	}
+
+	// Copy to the next texture of a native ring once the sender is named.
+	// The memory ring is copied from the bridge texture and uses the bridge.
+	if (m_nDX12Ring > 1 && !m_bMemoryRing && m_SenderName[0]) {
+		if (m_nDX12RingOpen < 2 || strcmp(m_DX12RingSender, m_SenderName) != 0
+			|| m_DX12RingWidth != (unsigned int)desc.Width || m_DX12RingHeight != desc.Height
+			|| m_DX12RingFormat != desc.Format) {
+			// Use the bridge texture if the ring cannot be created
+			if (!CreateDX12Ring((unsigned int)desc.Width, desc.Height, desc.Format))
+				m_nDX12Ring = 0;
+		}
+		if (m_nDX12RingOpen > 1)
+			return SendDX12Ring(pResource, pWaitFence, WaitValue);
+	}
+
+	// Create or resize the bridge texture
+	if (!m_pBridge12 || m_BridgeWidth != (unsigned int)desc.Width
+		|| m_BridgeHeight != desc.Height || m_BridgeFormat != desc.Format) {
+		if (!CreateBridgeTexture((unsigned int)desc.Width, desc.Height, desc.Format))
+			return false;
+	}
+
+	// Wait for the application to render the resource
+	if (pWaitFence)
+		m_pCopyQueue->Wait(pWaitFence, WaitValue);
+
+	// Copy the resource to the bridge texture
+	if (!CopyDX12Resource(m_pBridge12, pResource))
+		return false;
+
+	// The D3D11 copy waits on the GPU for the D3D12 copy.
+	// SendTexture handles sender creation and resizing.
+	m_pContext4->Wait(m_pFence11, m_CopyValue);
+	const bool bRet = SendTexture(m_pBridge11);
+
+	// The next D3D12 copy to the bridge texture waits for the D3D11 copy
+	m_pContext4->Signal(m_pFence11, ++m_FenceValue);
+	m_pImmediateContext->Flush();
+
+	// Copy to the memory ring after the sender is created
+	if (bRet && m_bMemoryRing) {
+		PublishMemoryRing();
+		QueueMemoryRing();
+	}
+
+	return bRet;
+}
+
+// Function: GetDX12Fence
+// Fence signalled when a native copy is complete.
+//
+// A receiver can wait on the application command queue
+// for the fence value before using the received texture.
+ID3D12Fence* spoutDX12::GetDX12Fence()
+{
+	return m_pFence12;
+}
+
+// Function: GetDX12FenceValue
+// Fence value of the last native copy.
+UINT64 spoutDX12::GetDX12FenceValue()
+{
+	return m_CopyValue;
+}
+
+// Function: SetDX12MemoryShare
+// Copy each frame sent by the copy queue directly to the sender memory ring.
+//
+// Requires native sharing (OpenDirectX12Native). In addition to the shared
+// texture, each frame sent by SendDX12Resource is written to the memory share
+// ring "<sendername>_memring_<width>x<height>" (SpoutMemoryRing) for CPU receivers.
+// The ring map is opened as a D3D12 heap (OpenExistingHeapFromAddress) and the
+// copy queue writes the pixels to the frame slot, so there is no staging
+// texture, map or CPU copy. A frame is published when its copy is complete,
+// one frame after it is sent.
+//
+// The sender format must be DXGI_FORMAT_R8G8B8A8_UNORM and the width
+// a multiple of 64 pixels for the 256 byte line pitch of a copy queue copy.
+// The option is disabled if these are not met or the heap cannot be opened.
+void spoutDX12::SetDX12MemoryShare(bool bMemory)
+{
+	if (!bMemory)
+		ReleaseMemoryRing();
+	m_bMemoryRing = bMemory;
+}
+
+// Function: GetDX12MemoryShare
+// Memory ring option.
+bool spoutDX12::GetDX12MemoryShare()
+{
+	return m_bMemoryRing;
+}
+
+// Function: SetDX12TextureRing
+// Copy each frame sent to the next of a ring of shared D3D12 textures.
+//
+// Requires native sharing (OpenDirectX12Native). SendDX12Resource copies
+// each frame on the copy queue to the next of 3-4 D3D12 textures shared by
+// named NT handles "<sendername>_SpoutRing_<id>" and signals a shared ring
+// fence with the frame number. The ring map "<sendername>_SpoutRing" is the
+// same as for a D3D11 sender (SetTextureRing), with the fence flags, so that
+// a spoutDX receiver waits on the GPU for the frame it reads. The copy queue
+// does not wait for receivers. A frame is dropped if the copy to the same
+// ring texture is not yet complete.
+//
+// The sender shared texture is updated from the ring texture on the D3D11
+// device for other receivers. Zero or one disables the ring. 2 is increased
+// to 3 so that receivers are not copying the texture being written.
+// The ring is not used with the memory share option (SetDX12MemoryShare).
+void spoutDX12::SetDX12TextureRing(int nTextures)
+{
+	if (nTextures < 2) nTextures = 0;
+	else if (nTextures < 3) nTextures = 3;
+	if (nTextures > 4) nTextures = 4;
+	if (nTextures != m_nDX12Ring)
+		ReleaseDX12Ring();
+	m_nDX12Ring = nTextures;
+	// The sender shared texture is not written to a D3D11 ring as well
+	SetTextureRing(0);
+}
+
+// Function: GetDX12TextureRing
+// Number of native ring textures.
+int spoutDX12::GetDX12TextureRing()
+{
+	return m_nDX12Ring;
+}
+
+// Function: SetDX12ReceiveHeap
+// Descriptor heap for shader resource views of received resources.
+//
+// A shader visible CBV_SRV_UAV heap of the application with SPOUT_DX12_SHARED
+// descriptors free from the first index. ReceiveDX12Shared writes the
+// view of each cached resource once to its own descriptor.
+void spoutDX12::SetDX12ReceiveHeap(ID3D12DescriptorHeap* pHeap, UINT firstIndex)
+{
+	ClearDX12Shared();
+	m_pSharedHeap = pHeap;
+	m_SharedFirst = firstIndex;
+	if (m_pd3dDevice12)
+		m_SharedIncrement = m_pd3dDevice12->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+// Function: ReceiveDX12Shared
+// Receive a sender texture to a cached shared resource with a shader resource view.
+//
+// Requires native sharing (OpenDirectX12Native).
+//
+// Unlike ReceiveDX12Resource, the application does not create a texture.
+// A D3D12 resource shared with the D3D11 device is created for each sender
+// share handle and cached, with its view in the heap set by SetDX12ReceiveHeap,
+// so a change of sender or a reconnect to a previous sender does not open
+// resources or write descriptors again. The resource and the GPU descriptor
+// handle of the view are returned for the current sender.
+//
+// The D3D11 copy of a new frame waits on the GPU for the commands already
+// submitted to the application queue, and the queue waits for the copy.
+// The resource is in the common state after each receive.
+// Use TransitionDX12Shared to record barriers.
+bool spoutDX12::ReceiveDX12Shared(ID3D12CommandQueue* pQueue,
+	D3D12_GPU_DESCRIPTOR_HANDLE* pSRV, ID3D12Resource** ppResource)
+{
+	if (!m_bNative || !pQueue)
+		return false;
+
+	if (!ReceiveSenderData() || !m_pSharedTexture) {
+		// There is no sender or the connected sender closed.
+		// Cached resources are retained for reconnection.
+		ReleaseReceiver();
+		m_SharedLast = -1;
+		m_bConnected = false;
+		return false;
+	}
+
+	const int slot = GetSharedEntry();
+	if (slot < 0)
+		return false;
+
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (frame.GetNewFrame()) {
+			// Wait on the GPU for the application to use the previous frame
+			pQueue->Signal(m_pFence12, ++m_FenceValue);
+			m_pContext4->Wait(m_pFence11, m_FenceValue);
+			m_pImmediateContext->CopyResource(m_pShared11[slot], m_pSharedTexture);
+			m_pContext4->Signal(m_pFence11, ++m_FenceValue);
+			m_pImmediateContext->Flush();
+			// The application queue waits on the GPU for the copy
+			pQueue->Wait(m_pFence12, m_FenceValue);
+		}
+	}
+	frame.AllowTextureAccess(m_pSharedTexture);
+
+	// A simultaneous access resource decays to the common state
+	// after the command lists that use it have been executed
+	m_SharedState[slot] = D3D12_RESOURCE_STATE_COMMON;
+	m_SharedLast = slot;
+
+	if (pSRV && m_pSharedHeap) {
+		pSRV->ptr = m_pSharedHeap->GetGPUDescriptorHandleForHeapStart().ptr
+			+ (UINT64)(m_SharedFirst + slot)*m_SharedIncrement;
+	}
+	if (ppResource)
+		*ppResource = m_pShared12[slot];
+
+	m_bConnected = true;
+
+	return true;
+}
+
+// Function: TransitionDX12Shared
+// Record a barrier for the last received resource if the state is different.
+//
+// The tracked state is reset to common by each receive.
+void spoutDX12::TransitionDX12Shared(ID3D12GraphicsCommandList* pList, D3D12_RESOURCE_STATES state)
+{
+	if (!pList || m_SharedLast < 0 || !m_pShared12[m_SharedLast])
+		return;
+
+	if (m_SharedState[m_SharedLast] == state)
+		return;
+
+	D3D12_RESOURCE_BARRIER barrier = {};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Transition.pResource = m_pShared12[m_SharedLast];
+	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	barrier.Transition.StateBefore = m_SharedState[m_SharedLast];
+	barrier.Transition.StateAfter = state;
+	pList->ResourceBarrier(1, &barrier);
+	m_SharedState[m_SharedLast] = state;
+}
+
+// Function: ClearDX12Shared
+// Release the cached received resources.
+//
+// Call when the application queue no longer uses them.
+void spoutDX12::ClearDX12Shared()
+{
+	for (int i = 0; i < SPOUT_DX12_SHARED; i++) {
+		if (m_pShared11[i]) m_pShared11[i]->Release();
+		if (m_pShared12[i]) m_pShared12[i]->Release();
+		m_SharedKey[i] = NULL;
+		m_pShared11[i] = nullptr;
+		m_pShared12[i] = nullptr;
+		m_SharedState[i] = D3D12_RESOURCE_STATE_COMMON;
+		m_SharedUsed[i] = 0;
+	}
+	m_SharedCount = 0;
+	m_SharedLast = -1;
+	if (m_pImmediateContext)
+		m_pImmediateContext->Flush();
+}
+
+// Function: ReceiveDX12Image
+// Receive a sender texture to a pixel buffer.
+//
+// Requires native sharing (OpenDirectX12Native).
+//
+// Each new frame is copied on the copy queue to the next of a ring of
+// readback buffers and the pixels of the latest completed copy are read.
+// The received pixels are one or two frames behind the sender but
+// neither the application render queue nor the CPU wait for the GPU.
+// If all buffers are still being copied, the frame is skipped.
+//
+// As for ReceiveImage, the pixel buffer is RGBA or RGB if bRGB is true,
+// and is resampled if the size is different to the sender.
+bool spoutDX12::ReceiveDX12Image(unsigned char* pixels, unsigned int width, unsigned int height,
+	bool bRGB, bool bInvert)
+{
+	if (!m_bNative || !pixels)
+		return false;
+
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	if (ReceiveSenderData()) {
+
+		if (!m_pSharedTexture)
+			return false;
+
+		// If the sender is new or changed, return to update the pixel buffer.
+		// The application detects the change with IsUpdated().
+		if (m_bUpdated) {
+			ReleaseReadback();
+			ReleaseBridgeTexture();
+			return true;
+		}
+
+		// Copy the sender texture to the bridge texture if it has a new frame
+		bool bCopy = false;
+		if (!CopySenderTexture(bCopy))
+			return false;
+
+		if (!m_pReadback[0] && !CreateReadback())
+			return false;
+
+		// Queue a copy of the new frame to a readback buffer
+		if (bCopy)
+			QueueReadback();
+
+		// Read the latest completed buffer
+		ReadReadback(pixels, width, height, bRGB, bInvert);
+
+		m_bConnected = true;
+	}
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		ReleaseReadback();
+		ReleaseBridgeTexture();
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+}
+
+
 //
 // Adapter functions
 //
@@ -647,3 +1242,950 @@ void spoutDX12::GetHardwareAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppAd
 	*ppAdapter = adapter;
 
 }
+
+// Create the native copy queue, command list and shared fence.
+bool spoutDX12::CreateNativeCopy()
+{
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	HRESULT hr = m_pd3dDevice12->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_pCopyQueue));
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_pCopyAllocator));
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_pCopyAllocator, nullptr, IID_PPV_ARGS(&m_pCopyList));
+	if (SUCCEEDED(hr))
+		hr = m_pCopyList->Close(); // Reset for each copy
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CreateNativeCopy - could not create copy queue (0x%.7X)", (unsigned int)hr);
+		ReleaseNativeCopy();
+		return false;
+	}
+
+	// Fence shared by D3D12 and D3D11 (Windows 10 1703 and later)
+	HANDLE hFence = NULL;
+	hr = m_pd3dDevice12->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_pFence12));
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateSharedHandle(m_pFence12, nullptr, GENERIC_ALL, nullptr, &hFence);
+	if (SUCCEEDED(hr)) {
+		ID3D11Device5* pDevice5 = nullptr;
+		hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pDevice5));
+		if (SUCCEEDED(hr)) {
+			hr = pDevice5->OpenSharedFence(hFence, IID_PPV_ARGS(&m_pFence11));
+			pDevice5->Release();
+		}
+		CloseHandle(hFence);
+	}
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(IID_PPV_ARGS(&m_pContext4));
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CreateNativeCopy - could not create shared fence (0x%.7X)", (unsigned int)hr);
+		ReleaseNativeCopy();
+		return false;
+	}
+
+	m_hFenceEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	m_FenceValue = 0;
+	m_CopyValue = 0;
+
+	SpoutLogNotice("spoutDX12::CreateNativeCopy - copy queue (0x%.7X), fence (0x%.7X)",
+		PtrToUint(m_pCopyQueue), PtrToUint(m_pFence12));
+
+	return true;
+}
+
+// Release the native copy objects and bridge texture.
+void spoutDX12::ReleaseNativeCopy()
+{
+	// Wait for the last copy before release
+	if (m_pFence12 && m_hFenceEvent && m_pFence12->GetCompletedValue() < m_CopyValue) {
+		if (SUCCEEDED(m_pFence12->SetEventOnCompletion(m_CopyValue, m_hFenceEvent)))
+			WaitForSingleObject(m_hFenceEvent, 1000);
+	}
+
+	ReleaseReadback();
+	ReleaseMemoryRing();
+	ReleaseDX12Ring();
+	ClearDX12Shared();
+	ReleaseBridgeTexture();
+
+	if (m_pContext4) m_pContext4->Release();
+	if (m_pFence11) m_pFence11->Release();
+	if (m_pFence12) m_pFence12->Release();
+	if (m_pCopyList) m_pCopyList->Release();
+	if (m_pCopyAllocator) m_pCopyAllocator->Release();
+	if (m_pCopyQueue) m_pCopyQueue->Release();
+	if (m_hFenceEvent) CloseHandle(m_hFenceEvent);
+	m_pContext4 = nullptr;
+	m_pFence11 = nullptr;
+	m_pFence12 = nullptr;
+	m_pCopyList = nullptr;
+	m_pCopyAllocator = nullptr;
+	m_pCopyQueue = nullptr;
+	m_hFenceEvent = NULL;
+	m_FenceValue = 0;
+	m_CopyValue = 0;
+	m_bNative = false;
+}
+
+// Create a D3D12 texture shared with the D3D11 device.
+bool spoutDX12::CreateBridgeTexture(unsigned int width, unsigned int height, DXGI_FORMAT format)
+{
+	ReleaseBridgeTexture();
+
+	if (!CreateSharedTexture(width, height, format, &m_pBridge12, &m_pBridge11))
+		return false;
+
+	m_BridgeWidth = width;
+	m_BridgeHeight = height;
+	m_BridgeFormat = format;
+
+	SpoutLogNotice("spoutDX12::CreateBridgeTexture - %dx%d, format %d", width, height, format);
+
+	return true;
+}
+
+// Create a D3D12 texture shared with the D3D11 device.
+bool spoutDX12::CreateSharedTexture(unsigned int width, unsigned int height, DXGI_FORMAT format,
+	ID3D12Resource** ppResource12, ID3D11Texture2D** ppTexture11)
+{
+	// Use the default format for zero or DX9 formats
+	DXGI_FORMAT texformat = format;
+	if (format == 0 || format == 21 || format == 22) // D3DFMT_A8R8G8B8 = 21
+		texformat = DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	D3D12_RESOURCE_DESC textureDesc = {};
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.DepthOrArraySize = 1;
+	textureDesc.MipLevels = 1;
+	textureDesc.Format = texformat;
+	textureDesc.SampleDesc.Count = 1;
+	// Accessed by both devices and by the copy queue without barriers
+	textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
+
+	ID3D12Resource* pResource12 = nullptr;
+	ID3D11Texture2D* pTexture11 = nullptr;
+	DX12_HEAP_PROPERTIES heapprop = DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT hr = m_pd3dDevice12->CreateCommittedResource(
+		&heapprop,
+		D3D12_HEAP_FLAG_SHARED,
+		&textureDesc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&pResource12));
+
+	// Open the texture on the D3D11 device with an NT handle
+	HANDLE hShare = NULL;
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateSharedHandle(pResource12, nullptr, GENERIC_ALL, nullptr, &hShare);
+	if (SUCCEEDED(hr)) {
+		ID3D11Device1* pDevice1 = nullptr;
+		hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pDevice1));
+		if (SUCCEEDED(hr)) {
+			hr = pDevice1->OpenSharedResource1(hShare, IID_PPV_ARGS(&pTexture11));
+			pDevice1->Release();
+		}
+		CloseHandle(hShare);
+	}
+
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CreateSharedTexture - failed (0x%.7X)", (unsigned int)hr);
+		if (pTexture11) pTexture11->Release();
+		if (pResource12) pResource12->Release();
+		return false;
+	}
+
+	*ppResource12 = pResource12;
+	*ppTexture11 = pTexture11;
+
+	return true;
+}
+
+// Release the bridge texture.
+void spoutDX12::ReleaseBridgeTexture()
+{
+	if (m_pBridge11) m_pBridge11->Release();
+	if (m_pBridge12) m_pBridge12->Release();
+	m_pBridge11 = nullptr;
+	m_pBridge12 = nullptr;
+	m_BridgeWidth = 0;
+	m_BridgeHeight = 0;
+	m_BridgeFormat = DXGI_FORMAT_UNKNOWN;
+}
+
+// Copy between D3D12 resources on the copy queue.
+//
+// The copy waits on the GPU for the last fence value signalled by D3D11
+// and signals a new value when complete (GetDX12FenceValue).
+bool spoutDX12::CopyDX12Resource(ID3D12Resource* pDest, ID3D12Resource* pSource)
+{
+	// The command allocator can be reset after the previous copy is complete.
+	// This is normally the case after a frame.
+	if (m_pFence12->GetCompletedValue() < m_CopyValue) {
+		if (FAILED(m_pFence12->SetEventOnCompletion(m_CopyValue, m_hFenceEvent))
+			|| WaitForSingleObject(m_hFenceEvent, 67) != WAIT_OBJECT_0) {
+			SpoutLogWarning("spoutDX12::CopyDX12Resource - previous copy not complete");
+			return false;
+		}
+	}
+
+	HRESULT hr = m_pCopyAllocator->Reset();
+	if (SUCCEEDED(hr))
+		hr = m_pCopyList->Reset(m_pCopyAllocator, nullptr);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CopyDX12Resource - could not reset command list (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	m_pCopyList->CopyResource(pDest, pSource);
+	m_pCopyList->Close();
+
+	// Wait for D3D11 before the copy
+	m_pCopyQueue->Wait(m_pFence12, m_FenceValue);
+	ID3D12CommandList* pLists[] = { m_pCopyList };
+	m_pCopyQueue->ExecuteCommandLists(1, pLists);
+	m_CopyValue = ++m_FenceValue;
+	m_pCopyQueue->Signal(m_pFence12, m_CopyValue);
+
+	return true;
+}
+
+// Native receive from the sender shared texture to a D3D12 resource.
+bool spoutDX12::ReceiveDX12Native(ID3D12Resource* pDX12Resource)
+{
+	bool bCopy = false;
+	if (!CopySenderTexture(bCopy))
+		return false;
+
+	// The copy queue waits on the GPU for the D3D11 copy
+	if (bCopy)
+		return CopyDX12Resource(pDX12Resource, m_pBridge12);
+
+	return true;
+}
+
+// Copy the sender shared texture to the bridge texture if there is a new frame.
+// The D3D11 copy signals the shared fence for the following copy queue copy.
+bool spoutDX12::CopySenderTexture(bool &bCopy)
+{
+	bCopy = false;
+
+	if (!m_pBridge12 || m_BridgeWidth != m_Width || m_BridgeHeight != m_Height
+		|| m_BridgeFormat != (DXGI_FORMAT)m_dwFormat) {
+		ReleaseReadback();
+		if (!CreateBridgeTexture(m_Width, m_Height, (DXGI_FORMAT)m_dwFormat))
+			return false;
+	}
+
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (frame.GetNewFrame()) {
+			// Wait on the GPU for the last copy from the bridge texture
+			m_pContext4->Wait(m_pFence11, m_CopyValue);
+			m_pImmediateContext->CopyResource(m_pBridge11, m_pSharedTexture);
+			m_pContext4->Signal(m_pFence11, ++m_FenceValue);
+			m_pImmediateContext->Flush();
+			bCopy = true;
+		}
+	}
+	frame.AllowTextureAccess(m_pSharedTexture);
+
+	return true;
+}
+
+// Create the readback buffers and command lists for the bridge texture.
+bool spoutDX12::CreateReadback()
+{
+	ReleaseReadback();
+
+	if (!m_pBridge12)
+		return false;
+
+	// Buffer layout for a copy of the bridge texture
+	const D3D12_RESOURCE_DESC texDesc = m_pBridge12->GetDesc();
+	UINT64 totalBytes = 0;
+	m_pd3dDevice12->GetCopyableFootprints(&texDesc, 0, 1, 0, &m_ReadbackFootprint, nullptr, nullptr, &totalBytes);
+
+	D3D12_RESOURCE_DESC bufferDesc = {};
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = totalBytes;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	DX12_HEAP_PROPERTIES heapprop = DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	HRESULT hr = S_OK;
+	for (int i = 0; i < SPOUT_DX12_READBACK && SUCCEEDED(hr); i++) {
+		hr = m_pd3dDevice12->CreateCommittedResource(&heapprop, D3D12_HEAP_FLAG_NONE,
+			&bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_pReadback[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pd3dDevice12->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_pReadbackAllocator[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pd3dDevice12->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_pReadbackAllocator[i], nullptr, IID_PPV_ARGS(&m_pReadbackList[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pReadbackList[i]->Close();
+	}
+
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CreateReadback - failed (0x%.7X)", (unsigned int)hr);
+		ReleaseReadback();
+		return false;
+	}
+
+	SpoutLogNotice("spoutDX12::CreateReadback - %d buffers of %u bytes", SPOUT_DX12_READBACK, (unsigned int)totalBytes);
+
+	return true;
+}
+
+// Release the readback buffers after the last copy is complete.
+void spoutDX12::ReleaseReadback()
+{
+	if (!m_pReadback[0])
+		return;
+
+	// Wait for copies in progress
+	if (m_pFence12 && m_hFenceEvent && m_pFence12->GetCompletedValue() < m_CopyValue) {
+		if (SUCCEEDED(m_pFence12->SetEventOnCompletion(m_CopyValue, m_hFenceEvent)))
+			WaitForSingleObject(m_hFenceEvent, 1000);
+	}
+
+	for (int i = 0; i < SPOUT_DX12_READBACK; i++) {
+		if (m_pReadbackList[i]) m_pReadbackList[i]->Release();
+		if (m_pReadbackAllocator[i]) m_pReadbackAllocator[i]->Release();
+		if (m_pReadback[i]) m_pReadback[i]->Release();
+		m_pReadbackList[i] = nullptr;
+		m_pReadbackAllocator[i] = nullptr;
+		m_pReadback[i] = nullptr;
+		m_ReadbackValue[i] = 0;
+	}
+	m_ReadbackLast = 0;
+	m_ReadbackNext = 0;
+}
+
+// Copy the bridge texture to the next readback buffer on the copy queue.
+// The frame is skipped if the buffer is still being copied.
+bool spoutDX12::QueueReadback()
+{
+	const int slot = m_ReadbackNext;
+	if (m_pFence12->GetCompletedValue() < m_ReadbackValue[slot])
+		return false;
+
+	HRESULT hr = m_pReadbackAllocator[slot]->Reset();
+	if (SUCCEEDED(hr))
+		hr = m_pReadbackList[slot]->Reset(m_pReadbackAllocator[slot], nullptr);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::QueueReadback - could not reset command list (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	D3D12_TEXTURE_COPY_LOCATION dest = {};
+	dest.pResource = m_pReadback[slot];
+	dest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	dest.PlacedFootprint = m_ReadbackFootprint;
+
+	D3D12_TEXTURE_COPY_LOCATION source = {};
+	source.pResource = m_pBridge12;
+	source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	source.SubresourceIndex = 0;
+
+	m_pReadbackList[slot]->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+	m_pReadbackList[slot]->Close();
+
+	// Wait for the D3D11 copy to the bridge texture
+	m_pCopyQueue->Wait(m_pFence12, m_FenceValue);
+	ID3D12CommandList* pLists[] = { m_pReadbackList[slot] };
+	m_pCopyQueue->ExecuteCommandLists(1, pLists);
+	m_CopyValue = ++m_FenceValue;
+	m_pCopyQueue->Signal(m_pFence12, m_CopyValue);
+
+	m_ReadbackValue[slot] = m_CopyValue;
+	m_ReadbackNext = (slot + 1) % SPOUT_DX12_READBACK;
+
+	return true;
+}
+
+// Read the latest completed readback buffer not read before.
+bool spoutDX12::ReadReadback(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert)
+{
+	const UINT64 completed = m_pFence12->GetCompletedValue();
+	int slot = -1;
+	UINT64 value = m_ReadbackLast;
+	for (int i = 0; i < SPOUT_DX12_READBACK; i++) {
+		if (m_ReadbackValue[i] > value && m_ReadbackValue[i] <= completed) {
+			value = m_ReadbackValue[i];
+			slot = i;
+		}
+	}
+	if (slot < 0)
+		return false; // No new frame yet
+
+	const UINT64 bytes = m_ReadbackFootprint.Offset
+		+ (UINT64)m_ReadbackFootprint.Footprint.RowPitch * m_ReadbackFootprint.Footprint.Height;
+	D3D12_RANGE readRange = { 0, (SIZE_T)bytes };
+	void* pData = nullptr;
+	if (FAILED(m_pReadback[slot]->Map(0, &readRange, &pData)))
+		return false;
+
+	const LONG64 copyStart = timer.Start();
+	CopyPixelData(static_cast<unsigned char*>(pData) + m_ReadbackFootprint.Offset,
+		m_ReadbackFootprint.Footprint.RowPitch,
+		m_ReadbackFootprint.Footprint.Width, m_ReadbackFootprint.Footprint.Height,
+		pixels, width, height, bRGB, bInvert, false);
+	timer.Stop("spoutCopy", copyStart);
+
+	// Nothing was written
+	D3D12_RANGE writeRange = { 0, 0 };
+	m_pReadback[slot]->Unmap(0, &writeRange);
+
+	m_ReadbackLast = value;
+
+	return true;
+}
+
+//
+// Memory ring written by the copy queue (SetDX12MemoryShare)
+//
+// The ring map has a 64k page for the header and slots aligned for
+// copy queue placement. The header offset gives the first slot
+// so that receivers find the pixels (SpoutMemoryRingSlot).
+//
+
+// Create the sender memory ring and open it as a D3D12 heap
+bool spoutDX12::CreateMemoryRing(unsigned int width, unsigned int height)
+{
+	// A ring of a different size has a different name.
+	// The previous ring is closed for receivers by ReleaseMemoryRing.
+	char mapname[SpoutMaxSenderNameLen+32]={};
+	SpoutMemoryRingName(mapname, SpoutMaxSenderNameLen+32, m_SenderName, width, height);
+	if (m_pRingBuffer && width == m_RingWidth && height == m_RingHeight
+		&& m_MemoryRing.Name() && strcmp(mapname, m_MemoryRing.Name()) == 0)
+		return true;
+
+	ReleaseMemoryRing();
+
+	// Lines are copied with the pitch of the ring pixels
+	const uint64_t pitch = (uint64_t)width * 4;
+	if (pitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT != 0) {
+		SpoutLogWarning("spoutDX12::CreateMemoryRing - width %d is not a multiple of 64, memory share disabled", width);
+		m_bMemoryRing = false;
+		return false;
+	}
+
+	// Slots aligned for copy placement after a 64k header page.
+	// The heap size is a multiple of 64k.
+	const uint64_t align = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	const uint64_t page = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	const uint64_t capacity = ((pitch * height + align - 1) / align) * align;
+	const uint64_t mapsize = ((page + capacity * SPOUT_MEMORY_SLOTS + page - 1) / page) * page;
+	if (capacity > 0xFFFFFFFF || mapsize > (uint64_t)SIZE_MAX) {
+		SpoutLogWarning("spoutDX12::CreateMemoryRing - %dx%d too large", width, height);
+		m_bMemoryRing = false;
+		return false;
+	}
+
+	const SpoutCreateResult result = m_MemoryRing.Create(mapname, mapsize);
+	if (result == SPOUT_CREATE_FAILED) {
+		SpoutLogError("spoutDX12::CreateMemoryRing - could not create [%s]", mapname);
+		return false;
+	}
+
+	// A ring of this size created before is used again if receivers still
+	// have it open, unless another writer created it with a different layout
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (result == SPOUT_ALREADY_EXISTS && pRing->capacity != 0
+		&& (pRing->capacity != capacity || pRing->offset != page)) {
+		SpoutLogWarning("spoutDX12::CreateMemoryRing - [%s] has a different layout", mapname);
+		m_MemoryRing.Close();
+		return false;
+	}
+
+	// The map view is allocation aligned and opened as a heap in system memory.
+	// A buffer placed on the whole heap is the destination of the copies.
+	ID3D12Device3* pDevice3 = nullptr;
+	HRESULT hr = m_pd3dDevice12->QueryInterface(IID_PPV_ARGS(&pDevice3));
+	if (SUCCEEDED(hr)) {
+		hr = pDevice3->OpenExistingHeapFromAddress(pRing, IID_PPV_ARGS(&m_pRingHeap));
+		pDevice3->Release();
+	}
+	if (SUCCEEDED(hr)) {
+		D3D12_RESOURCE_DESC bufferDesc = {};
+		bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		bufferDesc.Width = m_pRingHeap->GetDesc().SizeInBytes;
+		bufferDesc.Height = 1;
+		bufferDesc.DepthOrArraySize = 1;
+		bufferDesc.MipLevels = 1;
+		bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+		bufferDesc.SampleDesc.Count = 1;
+		bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+		bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER;
+		hr = m_pd3dDevice12->CreatePlacedResource(m_pRingHeap, 0, &bufferDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_pRingBuffer));
+	}
+	for (int i = 0; i < SPOUT_MEMORY_SLOTS && SUCCEEDED(hr); i++) {
+		hr = m_pd3dDevice12->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_pRingAllocator[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pd3dDevice12->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_pRingAllocator[i], nullptr, IID_PPV_ARGS(&m_pRingList[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pRingList[i]->Close();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDX12::CreateMemoryRing - could not open the map as a heap (0x%.7X), memory share disabled", (unsigned int)hr);
+		ReleaseMemoryRing();
+		m_bMemoryRing = false;
+		return false;
+	}
+
+	// Mapping objects are initially zeros
+	pRing->capacity = (uint32_t)capacity;
+	pRing->offset = (uint32_t)page;
+	pRing->width = width;
+	pRing->height = height;
+	m_RingLast = pRing->latest;
+	m_RingWidth = width;
+	m_RingHeight = height;
+	InterlockedExchange((volatile LONG*)&pRing->magic, (LONG)SPOUT_MEMORY_RING);
+
+	SpoutLogNotice("spoutDX12::CreateMemoryRing - [%s] %d slots", mapname, SPOUT_MEMORY_SLOTS);
+
+	return true;
+}
+
+// Close the memory ring after the last copy is complete
+void spoutDX12::ReleaseMemoryRing()
+{
+	// Wait for copies in progress
+	if (m_pRingBuffer && m_pFence12 && m_hFenceEvent && m_pFence12->GetCompletedValue() < m_CopyValue) {
+		if (SUCCEEDED(m_pFence12->SetEventOnCompletion(m_CopyValue, m_hFenceEvent)))
+			WaitForSingleObject(m_hFenceEvent, 1000);
+	}
+
+	// Receivers release a closed ring
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (pRing)
+		InterlockedExchange((volatile LONG*)&pRing->magic, 0);
+
+	for (int i = 0; i < SPOUT_MEMORY_SLOTS; i++) {
+		if (m_pRingList[i]) m_pRingList[i]->Release();
+		if (m_pRingAllocator[i]) m_pRingAllocator[i]->Release();
+		m_pRingList[i] = nullptr;
+		m_pRingAllocator[i] = nullptr;
+		m_RingValue[i] = 0;
+		m_RingFrame[i] = 0;
+	}
+	if (m_pRingBuffer) m_pRingBuffer->Release();
+	if (m_pRingHeap) m_pRingHeap->Release();
+	m_pRingBuffer = nullptr;
+	m_pRingHeap = nullptr;
+
+	// The heap must be released before the map
+	m_MemoryRing.Close();
+	m_RingLast = 0;
+	m_RingWidth = 0;
+	m_RingHeight = 0;
+}
+
+// Copy the bridge texture to the next memory ring slot on the copy queue.
+// The frame is skipped if the slot is still being copied.
+bool spoutDX12::QueueMemoryRing()
+{
+	if (m_BridgeFormat != DXGI_FORMAT_R8G8B8A8_UNORM) {
+		SpoutLogWarning("spoutDX12::QueueMemoryRing - format %d is not RGBA, memory share disabled", m_BridgeFormat);
+		m_bMemoryRing = false;
+		return false;
+	}
+
+	if (!CreateMemoryRing(m_BridgeWidth, m_BridgeHeight))
+		return false;
+
+	const LONG64 ringframe = m_RingLast + 1;
+	const int slot = (int)(ringframe % SPOUT_MEMORY_SLOTS);
+	if (m_RingValue[slot] != 0)
+		return false;
+
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+
+	HRESULT hr = m_pRingAllocator[slot]->Reset();
+	if (SUCCEEDED(hr))
+		hr = m_pRingList[slot]->Reset(m_pRingAllocator[slot], nullptr);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::QueueMemoryRing - could not reset command list (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	// Odd sequence while the slot is written
+	InterlockedExchange64(&pRing->sequence[slot], ringframe * 2 - 1);
+	pRing->width = m_RingWidth;
+	pRing->height = m_RingHeight;
+	pRing->size[slot] = 0; // Not compressed
+
+	D3D12_TEXTURE_COPY_LOCATION dest = {};
+	dest.pResource = m_pRingBuffer;
+	dest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	dest.PlacedFootprint.Offset = (UINT64)(SpoutMemoryRingSlot(pRing, slot) - reinterpret_cast<unsigned char*>(pRing));
+	dest.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	dest.PlacedFootprint.Footprint.Width = m_RingWidth;
+	dest.PlacedFootprint.Footprint.Height = m_RingHeight;
+	dest.PlacedFootprint.Footprint.Depth = 1;
+	dest.PlacedFootprint.Footprint.RowPitch = m_RingWidth * 4;
+
+	D3D12_TEXTURE_COPY_LOCATION source = {};
+	source.pResource = m_pBridge12;
+	source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	source.SubresourceIndex = 0;
+
+	m_pRingList[slot]->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+	m_pRingList[slot]->Close();
+
+	// Wait for the D3D11 copy from the bridge texture
+	m_pCopyQueue->Wait(m_pFence12, m_FenceValue);
+	ID3D12CommandList* pLists[] = { m_pRingList[slot] };
+	m_pCopyQueue->ExecuteCommandLists(1, pLists);
+	m_CopyValue = ++m_FenceValue;
+	m_pCopyQueue->Signal(m_pFence12, m_CopyValue);
+
+	m_RingValue[slot] = m_CopyValue;
+	m_RingFrame[slot] = ringframe;
+	m_RingLast = ringframe;
+
+	return true;
+}
+
+// Publish the memory ring slots with completed copies.
+void spoutDX12::PublishMemoryRing()
+{
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (!pRing || !m_pFence12)
+		return;
+
+	const UINT64 completed = m_pFence12->GetCompletedValue();
+	for (int i = 0; i < SPOUT_MEMORY_SLOTS; i++) {
+		if (m_RingValue[i] == 0 || m_RingValue[i] > completed)
+			continue;
+		// Complete and publish if later than the latest frame
+		InterlockedExchange64(&pRing->sequence[i], m_RingFrame[i] * 2);
+		if (m_RingFrame[i] > InterlockedCompareExchange64(&pRing->latest, 0, 0))
+			InterlockedExchange64(&pRing->latest, m_RingFrame[i]);
+		m_RingValue[i] = 0;
+	}
+}
+
+// Create the native ring textures, ring fence and ring map.
+bool spoutDX12::CreateDX12Ring(unsigned int width, unsigned int height, DXGI_FORMAT format)
+{
+	ReleaseDX12Ring();
+
+	// Use the default format for zero or DX9 formats
+	DXGI_FORMAT texformat = format;
+	if (format == 0 || format == 21 || format == 22) // D3DFMT_A8R8G8B8 = 21
+		texformat = DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	D3D12_RESOURCE_DESC textureDesc = {};
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.DepthOrArraySize = 1;
+	textureDesc.MipLevels = 1;
+	textureDesc.Format = texformat;
+	textureDesc.SampleDesc.Count = 1;
+	// Accessed by the copy queue and by D3D11 devices without barriers
+	textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
+	DX12_HEAP_PROPERTIES heapprop = DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+
+	ID3D11Device1* pDevice1 = nullptr;
+	HRESULT hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pDevice1));
+
+	SharedTextureRing ring = {};
+	ring.count = (uint32_t)m_nDX12Ring;
+	for (int i = 0; i < m_nDX12Ring && SUCCEEDED(hr); i++) {
+		hr = m_pd3dDevice12->CreateCommittedResource(&heapprop, D3D12_HEAP_FLAG_SHARED,
+			&textureDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&m_pDX12Ring12[i]));
+		// Receivers open the texture by name.
+		// A new identifier for each texture avoids the names of a previous ring.
+		const unsigned int id = ++m_DX12RingId;
+		if (SUCCEEDED(hr)) {
+			wchar_t sharename[256]={};
+			swprintf_s(sharename, 256, L"%S_SpoutRing_%u", m_SenderName, id);
+			hr = m_pd3dDevice12->CreateSharedHandle(m_pDX12Ring12[i], nullptr, GENERIC_ALL, sharename, &m_hDX12Ring[i]);
+		}
+		if (SUCCEEDED(hr))
+			hr = pDevice1->OpenSharedResource1(m_hDX12Ring[i], IID_PPV_ARGS(&m_pDX12Ring11[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pd3dDevice12->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_pDX12RingAllocator[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pd3dDevice12->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_pDX12RingAllocator[i], nullptr, IID_PPV_ARGS(&m_pDX12RingList[i]));
+		if (SUCCEEDED(hr))
+			hr = m_pDX12RingList[i]->Close(); // Reset for each copy
+		ring.shareHandle[i] = id;
+	}
+	if (pDevice1) pDevice1->Release();
+
+	// Ring fence signalled with the frame number.
+	// The handle is kept open for receivers to duplicate.
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_pDX12RingFence));
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice12->CreateSharedHandle(m_pDX12RingFence, nullptr, GENERIC_ALL, nullptr, &m_hDX12RingFence);
+	if (SUCCEEDED(hr)) {
+		ID3D11Device5* pDevice5 = nullptr;
+		hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pDevice5));
+		if (SUCCEEDED(hr)) {
+			hr = pDevice5->OpenSharedFence(m_hDX12RingFence, IID_PPV_ARGS(&m_pDX12RingFence11));
+			pDevice5->Release();
+		}
+	}
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::CreateDX12Ring - failed (0x%.7X)", (unsigned int)hr);
+		ReleaseDX12Ring();
+		return false;
+	}
+
+	// The first texture written will be index 0
+	ring.index = m_nDX12Ring-1;
+	ring.width = width;
+	ring.height = height;
+	ring.format = (uint32_t)texformat;
+	ring.flags = SPOUT_RING_NTNAME | SPOUT_RING_FENCE;
+	ring.processId = GetCurrentProcessId();
+	ring.fenceHandle = (uint64_t)(ULONG_PTR)m_hDX12RingFence;
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutRing";
+	if (m_DX12RingMemory.Create(mapname.c_str(), (int)sizeof(SharedTextureRing)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutDX12::CreateDX12Ring - could not create ring map");
+		ReleaseDX12Ring();
+		return false;
+	}
+	char* pBuf = m_DX12RingMemory.Lock();
+	if (!pBuf) {
+		ReleaseDX12Ring();
+		return false;
+	}
+	memcpy(pBuf, &ring, sizeof(SharedTextureRing));
+	m_DX12RingMemory.Unlock();
+
+	m_nDX12RingOpen = m_nDX12Ring;
+	m_DX12RingWidth = width;
+	m_DX12RingHeight = height;
+	m_DX12RingFormat = format;
+	strcpy_s(m_DX12RingSender, 256, m_SenderName);
+
+	SpoutLogNotice("spoutDX12::CreateDX12Ring - [%s] %d textures %dx%d", mapname.c_str(), m_nDX12Ring, width, height);
+
+	return true;
+}
+
+// Release the native ring textures, ring fence and ring map.
+void spoutDX12::ReleaseDX12Ring()
+{
+	// Wait for the last copy to the ring before release
+	if (m_pDX12RingFence && m_hFenceEvent && m_pDX12RingFence->GetCompletedValue() < m_DX12RingFrame) {
+		if (SUCCEEDED(m_pDX12RingFence->SetEventOnCompletion(m_DX12RingFrame, m_hFenceEvent)))
+			WaitForSingleObject(m_hFenceEvent, 1000);
+	}
+
+	for (int i = 0; i < 4; i++) {
+		if (m_pDX12Ring11[i]) m_pDX12Ring11[i]->Release();
+		if (m_pDX12Ring12[i]) m_pDX12Ring12[i]->Release();
+		if (m_pDX12RingList[i]) m_pDX12RingList[i]->Release();
+		if (m_pDX12RingAllocator[i]) m_pDX12RingAllocator[i]->Release();
+		if (m_hDX12Ring[i]) CloseHandle(m_hDX12Ring[i]);
+		m_pDX12Ring11[i] = nullptr;
+		m_pDX12Ring12[i] = nullptr;
+		m_pDX12RingList[i] = nullptr;
+		m_pDX12RingAllocator[i] = nullptr;
+		m_hDX12Ring[i] = NULL;
+		m_DX12RingValue[i] = 0;
+	}
+	if (m_pDX12RingFence11) m_pDX12RingFence11->Release();
+	if (m_pDX12RingFence) m_pDX12RingFence->Release();
+	if (m_hDX12RingFence) CloseHandle(m_hDX12RingFence);
+	m_pDX12RingFence11 = nullptr;
+	m_pDX12RingFence = nullptr;
+	m_hDX12RingFence = NULL;
+	m_DX12RingMemory.Close();
+
+	// Flush to release the D3D11 textures now
+	if (m_pImmediateContext)
+		m_pImmediateContext->Flush();
+
+	m_nDX12RingOpen = 0;
+	m_DX12RingFrame = 0;
+	m_DX12RingWidth = 0;
+	m_DX12RingHeight = 0;
+	m_DX12RingFormat = DXGI_FORMAT_UNKNOWN;
+	m_DX12RingSender[0] = 0;
+}
+
+// Copy a D3D12 resource to the next native ring texture on the copy queue.
+//
+// The ring fence is signalled with the frame number and the index
+// is published without waiting for the copy. The sender shared texture
+// is then updated from the ring texture after a D3D11 wait on the GPU.
+bool spoutDX12::SendDX12Ring(ID3D12Resource* pResource, ID3D12Fence* pWaitFence, UINT64 WaitValue)
+{
+	SharedTextureRing* pRing = reinterpret_cast<SharedTextureRing*>(m_DX12RingMemory.Buffer());
+	if (!pRing)
+		return false;
+
+	const UINT64 ringframe = m_DX12RingFrame + 1;
+	const int index = (int)((ringframe - 1) % (UINT64)m_nDX12RingOpen);
+
+	// The command allocator can be reset after the last copy to the texture.
+	// The frame is dropped rather than waiting if it is not complete.
+	if (m_pDX12RingFence->GetCompletedValue() < m_DX12RingValue[index]) {
+		m_SendOverrun++;
+		return false;
+	}
+
+	HRESULT hr = m_pDX12RingAllocator[index]->Reset();
+	if (SUCCEEDED(hr))
+		hr = m_pDX12RingList[index]->Reset(m_pDX12RingAllocator[index], nullptr);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDX12::SendDX12Ring - could not reset command list (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+	m_pDX12RingList[index]->CopyResource(m_pDX12Ring12[index], pResource);
+	m_pDX12RingList[index]->Close();
+
+	// Wait for the application to render the resource
+	// and for the D3D11 copy from the previous ring texture
+	if (pWaitFence)
+		m_pCopyQueue->Wait(pWaitFence, WaitValue);
+	m_pCopyQueue->Wait(m_pFence12, m_FenceValue);
+	ID3D12CommandList* pLists[] = { m_pDX12RingList[index] };
+	m_pCopyQueue->ExecuteCommandLists(1, pLists);
+	m_pCopyQueue->Signal(m_pDX12RingFence, ringframe);
+	m_DX12RingValue[index] = ringframe;
+	m_DX12RingFrame = ringframe;
+
+	// Publish the frame. Receivers wait on the GPU for the ring fence.
+	InterlockedExchange(&pRing->index, (LONG)index);
+	InterlockedExchange64(&pRing->frame, (LONG64)ringframe);
+
+	// Update the sender shared texture for other receivers.
+	// SendTexture handles sender creation and resizing.
+	m_pContext4->Wait(m_pDX12RingFence11, ringframe);
+	const bool bRet = SendTexture(m_pDX12Ring11[index]);
+	m_pContext4->Signal(m_pFence11, ++m_FenceValue);
+	m_pImmediateContext->Flush();
+
+	return bRet;
+}
+
+// Find or create a cached wrapped resource for a D3D12 resource.
+//
+// The wrapped resource holds a reference to the D3D12 resource, so the
+// resource pointer cannot be re-used for another resource while cached.
+// The least recently used entry is replaced if the cache is full.
+ID3D11Resource* spoutDX12::GetWrappedResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES InitialState)
+{
+	int slot = -1;
+	for (int i = 0; i < SPOUT_DX12_WRAPPED; i++) {
+		if (m_pWrapKey[i] == pResource) {
+			if (m_WrapState[i] == InitialState) {
+				m_WrapUsed[i] = ++m_WrapCount;
+				return m_pWrapped[i];
+			}
+			// Wrap again for a different state
+			slot = i;
+			break;
+		}
+	}
+
+	// Empty or least recently used entry
+	if (slot < 0) {
+		slot = 0;
+		for (int i = 0; i < SPOUT_DX12_WRAPPED; i++) {
+			if (!m_pWrapKey[i]) {
+				slot = i;
+				break;
+			}
+			if (m_WrapUsed[i] < m_WrapUsed[slot])
+				slot = i;
+		}
+	}
+
+	if (m_pWrapped[slot])
+		m_pWrapped[slot]->Release();
+	m_pWrapKey[slot] = nullptr;
+	m_pWrapped[slot] = nullptr;
+
+	ID3D11Resource* pWrapped = nullptr;
+	if (!WrapDX12Resource(pResource, &pWrapped, InitialState))
+		return nullptr;
+
+	m_pWrapKey[slot] = pResource;
+	m_pWrapped[slot] = pWrapped;
+	m_WrapState[slot] = InitialState;
+	m_WrapUsed[slot] = ++m_WrapCount;
+
+	return pWrapped;
+}
+
+// Find or create a cached shared resource for the sender share handle.
+//
+// The view of a new resource is written to its descriptor.
+// The least recently used entry is replaced if the cache is full.
+int spoutDX12::GetSharedEntry()
+{
+	int slot = -1;
+	for (int i = 0; i < SPOUT_DX12_SHARED; i++) {
+		if (m_SharedKey[i] == m_dxShareHandle && m_pShared12[i]) {
+			// A handle can be re-used by a later sender of a different size
+			const D3D12_RESOURCE_DESC desc = m_pShared12[i]->GetDesc();
+			if ((unsigned int)desc.Width == m_Width && desc.Height == m_Height) {
+				m_SharedUsed[i] = ++m_SharedCount;
+				return i;
+			}
+			slot = i;
+			break;
+		}
+	}
+
+	// Empty or least recently used entry
+	if (slot < 0) {
+		slot = 0;
+		for (int i = 0; i < SPOUT_DX12_SHARED; i++) {
+			if (!m_SharedKey[i]) {
+				slot = i;
+				break;
+			}
+			if (m_SharedUsed[i] < m_SharedUsed[slot])
+				slot = i;
+		}
+	}
+
+	if (m_pShared11[slot]) m_pShared11[slot]->Release();
+	if (m_pShared12[slot]) m_pShared12[slot]->Release();
+	m_SharedKey[slot] = NULL;
+	m_pShared11[slot] = nullptr;
+	m_pShared12[slot] = nullptr;
+
+	if (!CreateSharedTexture(m_Width, m_Height, (DXGI_FORMAT)m_dwFormat, &m_pShared12[slot], &m_pShared11[slot]))
+		return -1;
+
+	// Shader resource view in the application heap
+	if (m_pSharedHeap) {
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Format = m_pShared12[slot]->GetDesc().Format; // SRV and texture format must match
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = 1;
+		D3D12_CPU_DESCRIPTOR_HANDLE hCpu = m_pSharedHeap->GetCPUDescriptorHandleForHeapStart();
+		hCpu.ptr += (SIZE_T)(m_SharedFirst + slot)*m_SharedIncrement;
+		m_pd3dDevice12->CreateShaderResourceView(m_pShared12[slot], &srvDesc, hCpu);
+	}
+
+	m_SharedKey[slot] = m_dxShareHandle;
+	m_SharedState[slot] = D3D12_RESOURCE_STATE_COMMON;
+	m_SharedUsed[slot] = ++m_SharedCount;
+
+	SpoutLogNotice("spoutDX12::GetSharedEntry - entry %d, %dx%d", slot, m_Width, m_Height);
+
+	return slot;
+}
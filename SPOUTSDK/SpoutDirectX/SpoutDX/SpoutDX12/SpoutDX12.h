@@ -39,6 +39,15 @@
 #pragma comment (lib, "d3d12.lib")// the Direct3D 11 Library file
 #pragma comment (lib, "DXGI.lib") // for CreateDXGIFactory1
 
+// Number of readback buffers for ReceiveDX12Image
+#define SPOUT_DX12_READBACK 3
+
+// Number of cached D3D11on12 wrapped resources for SendDX12Resource
+#define SPOUT_DX12_WRAPPED 8
+
+// Number of cached shared resources and descriptors for ReceiveDX12Shared
+#define SPOUT_DX12_SHARED 4
+
 
 // Copied from Microsoft examples
 struct DX12_HEAP_PROPERTIES : public D3D12_HEAP_PROPERTIES
@@ -95,9 +104,56 @@ class spoutDX12 : public spoutDX {
 		// Send wrapped D3D11on12 D3D11 texture resource
 		bool SendDX11Resource(ID3D11Resource *pWrappedResource);
 
+		// Send a D3D12 texture resource by a cached D3D11on12 wrapped resource.
+		// InitialState is the state of the resource when sent.
+		bool SendDX12Resource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES InitialState);
+		// Release cached wrapped resources before the D3D12 resources are released or resized
+		void ClearWrappedResources();
+
 		// Receive a texture from a sender to a D3D12 texture resource
 		bool ReceiveDX12Resource(ID3D12Resource** ppDX12Resource);
 
+		//
+		// Native D3D12 sharing without D3D11on12
+		//
+
+		// Initialize DirectX 12 with a D3D12 copy queue and a D3D11 device on the same adapter
+		bool OpenDirectX12Native(ID3D12Device* pd3dDevice12 = nullptr);
+		// Native sharing is open
+		bool IsDirectX12Native();
+		// Send a D3D12 texture resource in the common state.
+		// The copy waits for the application fence value if a fence is passed in.
+		bool SendDX12Resource(ID3D12Resource* pResource, ID3D12Fence* pWaitFence = nullptr, UINT64 WaitValue = 0);
+		// Fence signalled when a native copy is complete
+		ID3D12Fence* GetDX12Fence();
+		// Fence value of the last native copy
+		UINT64 GetDX12FenceValue();
+		// Receive a sender texture to a pixel buffer by the copy queue readback ring.
+		// Pixels are received from a recent frame without waiting for the GPU.
+		bool ReceiveDX12Image(unsigned char* pixels, unsigned int width, unsigned int height,
+			bool bRGB = false, bool bInvert = false);
+		// Copy each frame sent by the copy queue directly to the sender memory ring.
+		// The ring map is opened as a D3D12 heap so there is no staging copy.
+		void SetDX12MemoryShare(bool bMemory = true);
+		// Memory ring option
+		bool GetDX12MemoryShare();
+		// Copy each frame sent to the next of a ring of shared D3D12 textures (3-4)
+		// with a shared fence so that receivers do not stall the copy queue
+		void SetDX12TextureRing(int nTextures);
+		// Number of native ring textures
+		int GetDX12TextureRing();
+		// Descriptor heap for shader resource views of received resources.
+		// SPOUT_DX12_SHARED descriptors are used from the first index.
+		void SetDX12ReceiveHeap(ID3D12DescriptorHeap* pHeap, UINT firstIndex = 0);
+		// Receive a sender texture to a cached shared resource with a shader resource view.
+		// The application queue waits on the GPU for the copy.
+		bool ReceiveDX12Shared(ID3D12CommandQueue* pQueue,
+			D3D12_GPU_DESCRIPTOR_HANDLE* pSRV = nullptr, ID3D12Resource** ppResource = nullptr);
+		// Record a barrier for the last received resource if the state is different
+		void TransitionDX12Shared(ID3D12GraphicsCommandList* pList, D3D12_RESOURCE_STATES state);
+		// Release the cached received resources
+		void ClearDX12Shared();
+
 		// Create a D3D11on12 device
 		ID3D11On12Device* CreateDX11on12device(ID3D12Device* pDevice12, IUnknown** ppCommandQueue = nullptr);
 
@@ -144,9 +200,109 @@ class spoutDX12 : public spoutDX {
 		// The wrapped D3D11 resource for D3D12
 		ID3D11Resource* m_pReceivedResource11;
 
+		// Wrapped resource cache
+		ID3D12Resource* m_pWrapKey[SPOUT_DX12_WRAPPED]; // D3D12 resource
+		ID3D11Resource* m_pWrapped[SPOUT_DX12_WRAPPED]; // Wrapped D3D11 resource
+		D3D12_RESOURCE_STATES m_WrapState[SPOUT_DX12_WRAPPED]; // Wrapped initial state
+		unsigned int m_WrapUsed[SPOUT_DX12_WRAPPED]; // Last use for replacement
+		unsigned int m_WrapCount; // Use count
+		ID3D11Resource* GetWrappedResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES InitialState);
+
 		// Class adapter pointer
 		IDXGIAdapter1* m_pAdapterDX12;
 
+		// Native sharing
+		bool m_bNative;
+		ID3D12CommandQueue* m_pCopyQueue; // D3D12 copy queue
+		ID3D12CommandAllocator* m_pCopyAllocator;
+		ID3D12GraphicsCommandList* m_pCopyList;
+		ID3D12Fence* m_pFence12; // Shared fence for D3D12 and D3D11
+		ID3D11Fence* m_pFence11; // The shared fence opened by D3D11
+		ID3D11DeviceContext4* m_pContext4; // For D3D11 fence signal and wait
+		UINT64 m_FenceValue; // Last fence value signalled
+		UINT64 m_CopyValue; // Fence value of the last copy queue submission
+		HANDLE m_hFenceEvent; // Fence completion event
+		ID3D12Resource* m_pBridge12; // Shared texture for D3D12 and D3D11
+		ID3D11Texture2D* m_pBridge11; // The bridge texture opened by D3D11
+		unsigned int m_BridgeWidth;
+		unsigned int m_BridgeHeight;
+		DXGI_FORMAT m_BridgeFormat;
+		bool CreateNativeCopy();
+		void ReleaseNativeCopy();
+		bool CreateBridgeTexture(unsigned int width, unsigned int height, DXGI_FORMAT format);
+		void ReleaseBridgeTexture();
+		bool CopyDX12Resource(ID3D12Resource* pDest, ID3D12Resource* pSource);
+		bool ReceiveDX12Native(ID3D12Resource* pDX12Resource);
+		bool CopySenderTexture(bool &bCopy);
+
+		// Readback ring
+		ID3D12Resource* m_pReadback[SPOUT_DX12_READBACK]; // Readback buffers
+		ID3D12CommandAllocator* m_pReadbackAllocator[SPOUT_DX12_READBACK];
+		ID3D12GraphicsCommandList* m_pReadbackList[SPOUT_DX12_READBACK];
+		UINT64 m_ReadbackValue[SPOUT_DX12_READBACK]; // Fence value of each copy
+		UINT64 m_ReadbackLast; // Fence value of the last buffer read
+		int m_ReadbackNext; // Next buffer to copy to
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_ReadbackFootprint; // Buffer layout
+		bool CreateReadback();
+		void ReleaseReadback();
+		bool QueueReadback();
+		bool ReadReadback(unsigned char* pixels, unsigned int width, unsigned int height, bool bRGB, bool bInvert);
+
+		// Memory ring written by the copy queue (SetDX12MemoryShare)
+		bool m_bMemoryRing;
+		SpoutSharedMemory m_MemoryRing; // "<sendername>_memring_<width>x<height>"
+		ID3D12Heap* m_pRingHeap; // The ring map opened as a D3D12 heap
+		ID3D12Resource* m_pRingBuffer; // Buffer placed on the whole heap
+		ID3D12CommandAllocator* m_pRingAllocator[SPOUT_MEMORY_SLOTS];
+		ID3D12GraphicsCommandList* m_pRingList[SPOUT_MEMORY_SLOTS];
+		UINT64 m_RingValue[SPOUT_MEMORY_SLOTS]; // Fence value of each copy, 0 when published
+		LONG64 m_RingFrame[SPOUT_MEMORY_SLOTS]; // Ring frame of each copy
+		LONG64 m_RingLast; // Last ring frame queued
+		unsigned int m_RingWidth;
+		unsigned int m_RingHeight;
+		bool CreateMemoryRing(unsigned int width, unsigned int height);
+		void ReleaseMemoryRing();
+		bool QueueMemoryRing();
+		void PublishMemoryRing();
+
+		// Native texture ring (SetDX12TextureRing)
+		int m_nDX12Ring; // Number of ring textures required
+		int m_nDX12RingOpen; // Number of ring textures created
+		ID3D12Resource* m_pDX12Ring12[4]; // Shared ring textures
+		ID3D11Texture2D* m_pDX12Ring11[4]; // Ring textures opened by D3D11
+		HANDLE m_hDX12Ring[4]; // Named NT handles "<sendername>_SpoutRing_<id>"
+		ID3D12CommandAllocator* m_pDX12RingAllocator[4];
+		ID3D12GraphicsCommandList* m_pDX12RingList[4];
+		UINT64 m_DX12RingValue[4]; // Ring frame of the last copy to each texture
+		ID3D12Fence* m_pDX12RingFence; // Signalled with the ring frame number
+		ID3D11Fence* m_pDX12RingFence11; // The ring fence opened by D3D11
+		HANDLE m_hDX12RingFence; // NT handle duplicated by receivers
+		UINT64 m_DX12RingFrame; // Last ring frame
+		unsigned int m_DX12RingId; // Identifier for texture names
+		unsigned int m_DX12RingWidth;
+		unsigned int m_DX12RingHeight;
+		DXGI_FORMAT m_DX12RingFormat;
+		char m_DX12RingSender[256]; // Sender name of the ring map
+		SpoutSharedMemory m_DX12RingMemory; // "<sendername>_SpoutRing"
+		bool CreateDX12Ring(unsigned int width, unsigned int height, DXGI_FORMAT format);
+		void ReleaseDX12Ring();
+		bool SendDX12Ring(ID3D12Resource* pResource, ID3D12Fence* pWaitFence, UINT64 WaitValue);
+
+		// Received resource cache (ReceiveDX12Shared)
+		ID3D12DescriptorHeap* m_pSharedHeap; // Application descriptor heap
+		UINT m_SharedFirst; // First descriptor index
+		UINT m_SharedIncrement; // Descriptor size
+		HANDLE m_SharedKey[SPOUT_DX12_SHARED]; // Sender share handle
+		ID3D12Resource* m_pShared12[SPOUT_DX12_SHARED]; // Shared D3D12 resource
+		ID3D11Texture2D* m_pShared11[SPOUT_DX12_SHARED]; // The resource opened by D3D11
+		D3D12_RESOURCE_STATES m_SharedState[SPOUT_DX12_SHARED]; // Tracked resource state
+		unsigned int m_SharedUsed[SPOUT_DX12_SHARED]; // Last use for replacement
+		unsigned int m_SharedCount; // Use count
+		int m_SharedLast; // Entry of the last receive
+		int GetSharedEntry();
+		bool CreateSharedTexture(unsigned int width, unsigned int height, DXGI_FORMAT format,
+			ID3D12Resource** ppResource12, ID3D11Texture2D** ppTexture11);
+
 };
 
 #endif
@@ -14,6 +14,9 @@
 //		07.03.21	- Change HoldFps to allow numerator and denominator
 //		11.06.21	- Add documentation
 //		27.10.21	- ReceiveSenderData - use LongToHandle before cast
+//		14.10.26	- Add SendDX9image and ReceiveDX9image using a ring of
+//					  system memory surfaces with an event query for each.
+//					  WriteDX9memory - optional query issued without waiting.
 //
 // ====================================================================================
 /*
@@ -64,11 +67,27 @@ spoutDX9::spoutDX9() {
 	m_SenderName[0]=0;
 	m_Width = 0;
 	m_Height = 0;
+	m_bUpdated = false;
+	m_bConnected = false;
+	m_bNewFrame = false;
+
+	for (int i = 0; i < SPOUT_DX9_SURFACES; i++) {
+		m_pSysSurface[i] = nullptr;
+		m_pSysQuery[i] = nullptr;
+		m_SysFrame[i] = 0;
+	}
+	m_SysCount = 0;
+	m_SysLast = 0;
+	m_SysIndex = 0;
+	m_SysWidth = 0;
+	m_SysHeight = 0;
+	m_SysFormat = D3DFMT_UNKNOWN;
 
 }
 
 spoutDX9::~spoutDX9() {
 
+	ReleaseSystemSurfaces();
 	ReleaseDX9sender();
 	CloseDirectX9();
 
@@ -155,6 +174,9 @@ void spoutDX9::CloseDirectX9()
 {
 	SpoutLogNotice("spoutDX9::CloseDirectX9");
 
+	// Surfaces of the device
+	ReleaseSystemSurfaces();
+
 	if (m_pD3D) {
 		// Release device before the object
 		if (m_pDevice)
@@ -354,6 +376,71 @@ bool spoutDX9::SendDX9surface(IDirect3DSurface9* pSurface)
 	return true;
 }
 
+//---------------------------------------------------------
+// Function: SendDX9image
+// Send rgba pixels.
+//
+// The pixels are written to the next of a ring of system memory surfaces
+// and copied to the sender shared texture by UpdateSurface.
+// The copy is submitted without waiting for it to complete. A surface
+// is only waited on if the copy from it is still in progress when
+// used again, so the device pipeline is not drained for every frame.
+bool spoutDX9::SendDX9image(const unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert)
+{
+	if (!pixels || width == 0 || height == 0)
+		return false;
+
+	if (!OpenDirectX9())
+		return false;
+
+	// Create or update the sender
+	if (!CheckDX9sender(width, height, (DWORD)D3DFMT_A8R8G8B8))
+		return false;
+
+	if (!CheckSystemSurfaces(width, height, D3DFMT_A8R8G8B8))
+		return false;
+
+	// Wait only if the last copy from this surface is not complete
+	const int slot = m_SysIndex;
+	if (m_SysFrame[slot] > 0) {
+		while (S_FALSE == m_pSysQuery[slot]->GetData(NULL, 0, D3DGETDATA_FLUSH));
+	}
+
+	D3DLOCKED_RECT lockedRect = {};
+	if (FAILED(m_pSysSurface[slot]->LockRect(&lockedRect, NULL, 0))) {
+		SpoutLogError("spoutDX9::SendDX9image - LockRect failed");
+		return false;
+	}
+
+	// rgba to D3DFMT_A8R8G8B8 (bgra in memory) allowing for the surface pitch
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char* src = pixels + (size_t)(bInvert ? (height - 1 - y) : y) * width * 4;
+		unsigned char* dst = static_cast<unsigned char*>(lockedRect.pBits) + (size_t)y * lockedRect.Pitch;
+		for (unsigned int x = 0; x < width; x++) {
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+			dst[3] = src[3];
+			src += 4;
+			dst += 4;
+		}
+	}
+	m_pSysSurface[slot]->UnlockRect();
+
+	if (frame.CheckTextureAccess()) {
+		// Copy to the shared texture and issue the query of this surface
+		if (WriteDX9memory(m_pDevice, m_pSysSurface[slot], m_pSharedTexture, m_pSysQuery[slot])) {
+			m_SysFrame[slot] = ++m_SysCount;
+			m_SysIndex = (slot + 1) % SPOUT_DX9_SURFACES;
+		}
+		// Signal a new frame while the mutex is locked
+		frame.SetNewFrame();
+		frame.AllowTextureAccess();
+	}
+
+	return true;
+}
+
 
 //---------------------------------------------------------
 // Function: ReleaseSender
@@ -492,6 +579,81 @@ bool spoutDX9::ReceiveDX9Texture(LPDIRECT3DTEXTURE9 &pTexture)
 
 }
 
+//---------------------------------------------------------
+// Function: ReceiveDX9image
+// Receive rgba pixels of the sender size.
+//
+// Each new frame is copied by GetRenderTargetData to the next of a ring of
+// system memory surfaces. The pixels are read from the latest surface that
+// the GPU has finished copying, so the lock does not wait for the copy and
+// the pixels can be a frame or two behind the sender.
+//
+// If the sender has changed size, IsUpdated() returns true and the
+// application should re-allocate the pixel buffer.
+bool spoutDX9::ReceiveDX9image(unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert)
+{
+	if (!pixels)
+		return false;
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		if (!m_dxShareHandle)
+			return false;
+
+		// Return to update the pixel buffer
+		if (m_bUpdated) {
+			// The shared texture is opened again from the new share handle
+			if (m_pSharedTexture)
+				m_pSharedTexture->Release();
+			m_pSharedTexture = nullptr;
+			ReleaseSystemSurfaces();
+			return true;
+		}
+
+		// Open the sender shared texture
+		if (!m_pSharedTexture) {
+			if (!CreateSharedDX9Texture(m_pDevice, m_Width, m_Height,
+				(D3DFORMAT)m_dwFormat, m_pSharedTexture, m_dxShareHandle))
+				return false;
+		}
+
+		if (!CheckSystemSurfaces(m_Width, m_Height, (D3DFORMAT)m_dwFormat))
+			return false;
+
+		if (frame.CheckTextureAccess()) {
+			m_bNewFrame = false;
+			if (frame.GetNewFrame()) {
+				// Queue a copy to the next surface
+				const int slot = m_SysIndex;
+				IDirect3DSurface9* pSurface = nullptr;
+				if (SUCCEEDED(m_pSharedTexture->GetSurfaceLevel(0, &pSurface))) {
+					if (SUCCEEDED(m_pDevice->GetRenderTargetData(pSurface, m_pSysSurface[slot]))) {
+						m_pSysQuery[slot]->Issue(D3DISSUE_END);
+						m_SysFrame[slot] = ++m_SysCount;
+						m_SysIndex = (slot + 1) % SPOUT_DX9_SURFACES;
+						m_bNewFrame = true;
+					}
+					pSurface->Release();
+				}
+			}
+		}
+		frame.AllowTextureAccess();
+
+		// Read the latest completed copy
+		ReadSystemSurface(pixels, width, height, bInvert);
+
+		m_bConnected = true;
+
+	}
+	else {
+		ReleaseReceiver();
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+}
+
 
 //---------------------------------------------------------
 // Function: ReleaseReceiver
@@ -512,6 +674,8 @@ void spoutDX9::ReleaseReceiver()
 	// Wait 4 frames in case the same sender opens again
 	Sleep(67);
 
+	ReleaseSystemSurfaces();
+
 	if (m_pSharedTexture)
 		m_pSharedTexture->Release();
 	m_pSharedTexture = nullptr;
@@ -786,7 +950,7 @@ bool spoutDX9::CheckDX9sender(unsigned int width, unsigned int height, DWORD dwF
 		if (m_pSharedTexture) m_pSharedTexture->Release();
 		m_pSharedTexture = nullptr;
 		m_dxShareHandle = nullptr;
-		CreateSharedDX9Texture(m_pDevice, m_Width, m_Height, (D3DFORMAT)m_dwFormat, m_pSharedTexture, m_dxShareHandle);
+		CreateSharedDX9Texture(m_pDevice, width, height, (D3DFORMAT)dwFormat, m_pSharedTexture, m_dxShareHandle);
 		// Update the sender and class variables
 		sendernames.UpdateSender(m_SenderName, width, height, m_dxShareHandle, dwFormat);
 		m_Width = width;
@@ -800,7 +964,126 @@ bool spoutDX9::CheckDX9sender(unsigned int width, unsigned int height, DWORD dwF
 }
 
 
-bool spoutDX9::WriteDX9memory(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 source_surface, LPDIRECT3DTEXTURE9 dxTexture)
+//
+// SYSTEM MEMORY SURFACE RING
+//
+//    Surfaces in D3DPOOL_SYSTEMMEM, each with an event query, shared by
+//    SendDX9image (UpdateSurface) and ReceiveDX9image (GetRenderTargetData)
+//
+bool spoutDX9::CheckSystemSurfaces(unsigned int width, unsigned int height, D3DFORMAT format)
+{
+	if (!m_pDevice)
+		return false;
+
+	if (m_pSysSurface[0] && width == m_SysWidth && height == m_SysHeight && format == m_SysFormat)
+		return true;
+
+	ReleaseSystemSurfaces();
+
+	for (int i = 0; i < SPOUT_DX9_SURFACES; i++) {
+		if (FAILED(m_pDevice->CreateOffscreenPlainSurface(width, height, format,
+			D3DPOOL_SYSTEMMEM, &m_pSysSurface[i], NULL))
+			|| FAILED(m_pDevice->CreateQuery(D3DQUERYTYPE_EVENT, &m_pSysQuery[i]))) {
+			SpoutLogError("spoutDX9::CheckSystemSurfaces - could not create surface %d (%dx%d, format %d)",
+				i, width, height, (int)format);
+			ReleaseSystemSurfaces();
+			return false;
+		}
+	}
+
+	m_SysWidth = width;
+	m_SysHeight = height;
+	m_SysFormat = format;
+
+	SpoutLogNotice("spoutDX9::CheckSystemSurfaces - %d surfaces %dx%d, format %d",
+		SPOUT_DX9_SURFACES, width, height, (int)format);
+
+	return true;
+}
+
+void spoutDX9::ReleaseSystemSurfaces()
+{
+	for (int i = 0; i < SPOUT_DX9_SURFACES; i++) {
+		if (m_pSysQuery[i])
+			m_pSysQuery[i]->Release();
+		m_pSysQuery[i] = nullptr;
+		if (m_pSysSurface[i])
+			m_pSysSurface[i]->Release();
+		m_pSysSurface[i] = nullptr;
+		m_SysFrame[i] = 0;
+	}
+	m_SysCount = 0;
+	m_SysLast = 0;
+	m_SysIndex = 0;
+	m_SysWidth = 0;
+	m_SysHeight = 0;
+	m_SysFormat = D3DFMT_UNKNOWN;
+}
+
+// Has the GPU finished the last copy to or from the surface
+bool spoutDX9::IsSystemSurfaceReady(int index)
+{
+	if (!m_pSysQuery[index] || m_SysFrame[index] == 0)
+		return false;
+	return (m_pSysQuery[index]->GetData(NULL, 0, D3DGETDATA_FLUSH) == S_OK);
+}
+
+// Read rgba pixels from the latest completed surface not already read
+bool spoutDX9::ReadSystemSurface(unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert)
+{
+	if (width != m_SysWidth || height != m_SysHeight)
+		return false;
+
+	if (m_SysFormat != D3DFMT_A8R8G8B8 && m_SysFormat != D3DFMT_X8R8G8B8) {
+		SpoutLogWarning("spoutDX9::ReadSystemSurface - format %d not supported", (int)m_SysFormat);
+		return false;
+	}
+
+	// Latest copy that has completed
+	int slot = -1;
+	for (int i = 0; i < SPOUT_DX9_SURFACES; i++) {
+		if (m_SysFrame[i] > m_SysLast && IsSystemSurfaceReady(i)) {
+			if (slot < 0 || m_SysFrame[i] > m_SysFrame[slot])
+				slot = i;
+		}
+	}
+	if (slot < 0)
+		return false; // Nothing new yet
+
+	D3DLOCKED_RECT lockedRect = {};
+	if (FAILED(m_pSysSurface[slot]->LockRect(&lockedRect, NULL, D3DLOCK_READONLY | D3DLOCK_DONOTWAIT)))
+		return false; // Try again next time
+
+	// bgra in memory to rgba allowing for the surface pitch
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char* src = static_cast<const unsigned char*>(lockedRect.pBits) + (size_t)y * lockedRect.Pitch;
+		unsigned char* dst = pixels + (size_t)(bInvert ? (height - 1 - y) : y) * width * 4;
+		for (unsigned int x = 0; x < width; x++) {
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+			dst[3] = (m_SysFormat == D3DFMT_X8R8G8B8) ? 255 : src[3];
+			src += 4;
+			dst += 4;
+		}
+	}
+	m_pSysSurface[slot]->UnlockRect();
+
+	m_SysLast = m_SysFrame[slot];
+
+	return true;
+}
+
+
+//
+// COPY FROM A SYSTEM MEMORY SURFACE TO THE SHARED DX9 TEXTURE
+//
+//    If a query is passed in, it is issued after the copy and the commands
+//    are flushed without waiting. The caller tests the query before the
+//    system memory surface is written again.
+//
+bool spoutDX9::WriteDX9memory(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 source_surface, LPDIRECT3DTEXTURE9 dxTexture,
+	IDirect3DQuery9* pQuery)
 {
 	IDirect3DSurface9* texture_surface = nullptr;
 	IDirect3DQuery9* pEventQuery = nullptr;
@@ -813,6 +1096,13 @@ bool spoutDX9::WriteDX9memory(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 so
 		//    The destination surface must have been created with D3DPOOL_DEFAULT.
 		//    Neither surface can be locked or holding an outstanding device context.
 		hr = pDevice->UpdateSurface(source_surface, NULL, texture_surface, NULL);
+		texture_surface->Release();
+		if (SUCCEEDED(hr) && pQuery) {
+			// Submit the copy for the receiver
+			pQuery->Issue(D3DISSUE_END);
+			pQuery->GetData(NULL, 0, D3DGETDATA_FLUSH);
+			return true;
+		}
 		if (SUCCEEDED(hr)) {
 			// It is necessary to flush the command queue 
 			// or the data is not ready for the receiver to read.
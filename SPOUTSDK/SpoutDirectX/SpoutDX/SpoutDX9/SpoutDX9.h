@@ -46,6 +46,9 @@
 
 using namespace spoututils;
 
+// Number of system memory surfaces for SendDX9image and ReceiveDX9image
+#define SPOUT_DX9_SURFACES 3
+
 class SPOUT_DLLEXP spoutDX9 {
 
 	public:
@@ -82,6 +85,8 @@ class SPOUT_DLLEXP spoutDX9 {
 		bool SetSenderName(const char* sendername = nullptr);
 		// Send a DirectX9 surface
 		bool SendDX9surface(IDirect3DSurface9* pSurface);
+		// Send rgba pixels by a ring of system memory surfaces
+		bool SendDX9image(const unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert = false);
 		// Close sender and free resources
 		void ReleaseDX9sender();
 		// Sender status
@@ -105,6 +110,8 @@ class SPOUT_DLLEXP spoutDX9 {
 		void SetReceiverName(const char * sendername);
 		// Receive a DirectX 9 texture from a sender
 		bool ReceiveDX9Texture(LPDIRECT3DTEXTURE9 &pTexture);
+		// Receive rgba pixels of the sender size by a ring of system memory surfaces
+		bool ReceiveDX9image(unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert = false);
 		// Close receiver and free resources
 		void ReleaseReceiver();
 		// Open sender selection dialog
@@ -164,10 +171,26 @@ class SPOUT_DLLEXP spoutDX9 {
 		bool m_bClassDevice;
 		SHELLEXECUTEINFOA m_ShExecInfo;
 
+		// System memory surface ring
+		IDirect3DSurface9* m_pSysSurface[SPOUT_DX9_SURFACES];
+		IDirect3DQuery9* m_pSysQuery[SPOUT_DX9_SURFACES]; // Event query of the last copy
+		unsigned int m_SysFrame[SPOUT_DX9_SURFACES]; // Copy number, 0 if not used
+		unsigned int m_SysCount; // Copies made
+		unsigned int m_SysLast; // Copy number of the last surface read
+		int m_SysIndex; // Next surface
+		unsigned int m_SysWidth;
+		unsigned int m_SysHeight;
+		D3DFORMAT m_SysFormat;
+		bool CheckSystemSurfaces(unsigned int width, unsigned int height, D3DFORMAT format);
+		void ReleaseSystemSurfaces();
+		bool IsSystemSurfaceReady(int index);
+		bool ReadSystemSurface(unsigned char* pixels, unsigned int width, unsigned int height, bool bInvert);
+
 		// Check that a sender is up to date
 		bool CheckDX9sender(unsigned int width, unsigned int height, DWORD dwFormat);
 		// Write to a DirectX9 system memory surface
-		bool WriteDX9memory(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 surface, LPDIRECT3DTEXTURE9 dxTexture);
+		bool WriteDX9memory(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 surface, LPDIRECT3DTEXTURE9 dxTexture,
+			IDirect3DQuery9* pQuery = nullptr);
 		// Copy from a GPU DX9 surface to the DX9 shared texture
 		bool WriteDX9surface(IDirect3DDevice9Ex* pDevice, LPDIRECT3DSURFACE9 surface, LPDIRECT3DTEXTURE9 dxTexture);
 
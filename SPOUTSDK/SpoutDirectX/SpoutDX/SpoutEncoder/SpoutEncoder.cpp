@@ -0,0 +1,853 @@
+//
+//		spoutEncoder.cpp
+//
+//		Functions to encode a Spout sender with a hardware video encoder
+//		Base class spoutDX for the D3D11 device and Spout functions.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. The sender shared texture is converted to NV12
+//					  by the D3D11 video processor and passed as a DXGI surface
+//					  to a Media Foundation hardware encoder without CPU readback.
+//					- Add SetEncodeSlices. Low latency rate control without B frames.
+//					  Packets have the sender frame number.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutEncoder.h"
+
+//
+// Class: spoutEncoder
+//
+// Functions to encode a Spout sender with a hardware video encoder.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// The class creates a D3D11 device with video support, shared with a
+// Media Foundation hardware encoder transform by an IMFDXGIDeviceManager.
+// Each new sender frame is converted from the shared texture to one of
+// a ring of NV12 textures by the D3D11 video processor (BT.709, studio range)
+// and passed to the encoder as a DXGI surface buffer. Pixels are not read
+// back to the CPU. Encoded H.264 or HEVC packets are collected from the
+// encoder events and held until the application takes them with GetPacket.
+//
+// The hardware encoder is asynchronous. A frame is only passed when the
+// encoder has asked for input, otherwise it is counted as dropped, so that
+// the NV12 textures are not overwritten while the encoder uses them.
+//
+// Refer to source code for further details.
+//
+
+spoutEncoder::spoutEncoder() {
+
+	m_bEncoding = false;
+	m_bEncoderStarted = false;
+	m_Codec = SPOUT_ENCODE_H264;
+	m_Bitrate = 0;
+	m_Fps = 60;
+	m_EncodeWidth = 0;
+	m_EncodeHeight = 0;
+
+	m_pEncodeDevice = nullptr;
+	m_pDeviceManager = nullptr;
+	m_ResetToken = 0;
+	m_bMFStarted = false;
+
+	m_pEncoder = nullptr;
+	m_pEncoderEvents = nullptr;
+	m_pCodecAPI = nullptr;
+	m_InputStream = 0;
+	m_OutputStream = 0;
+	m_bProvidesSamples = false;
+	m_OutputSize = 0;
+	m_NeedInput = 0;
+	m_bKeyframe = false;
+	m_nSlices = 0;
+
+	m_pEncodeVideoDevice = nullptr;
+	m_pEncodeVideoContext = nullptr;
+	m_pEncodeEnum = nullptr;
+	m_pEncodeProcessor = nullptr;
+	m_pEncodeInputView = nullptr;
+	m_pEncodeSource = nullptr;
+	for (int i = 0; i < SPOUT_ENCODE_SURFACES; i++) {
+		m_pSurface[i] = nullptr;
+		m_pSurfaceView[i] = nullptr;
+	}
+	m_SurfaceIndex = 0;
+
+	m_StartTime = 0;
+	LARGE_INTEGER frequency={};
+	QueryPerformanceFrequency(&frequency);
+	m_Frequency = frequency.QuadPart;
+	m_EncodedFrames = 0;
+	m_EncodeDropped = 0;
+
+}
+
+spoutEncoder::~spoutEncoder() {
+
+	StopEncoding();
+	ReleaseEncoder();
+
+	if (m_pDeviceManager) m_pDeviceManager->Release();
+	m_pDeviceManager = nullptr;
+
+	// Release receiver objects before the device
+	if (m_bConnected)
+		ReleaseReceiver();
+	m_bConnected = false;
+	CloseDirectX11();
+	if (m_pEncodeDevice) m_pEncodeDevice->Release();
+	m_pEncodeDevice = nullptr;
+
+	if (m_bMFStarted)
+		MFShutdown();
+
+}
+
+//
+// Group: Encode
+//
+
+//---------------------------------------------------------
+// Function: StartEncoding
+// Start encoding with the codec, bit rate and frame rate.
+//
+//   codec - SPOUT_ENCODE_H264 or SPOUT_ENCODE_HEVC
+//   bitrate - bits per second, 0 for a default from the size and frame rate
+//   fps - frame rate used for sample durations and rate control
+//
+//   The encoder is created when the first frame is received
+//   and the sender size is known.
+bool spoutEncoder::StartEncoding(SpoutEncodeCodec codec, unsigned int bitrate, unsigned int fps)
+{
+	if (!CreateEncodeDevice())
+		return false;
+
+	StopEncoding();
+
+	m_Codec = codec;
+	m_Bitrate = bitrate;
+	m_Fps = (fps > 0) ? fps : 60;
+	m_EncodedFrames = 0;
+	m_EncodeDropped = 0;
+	m_StartTime = 0;
+	m_Packets.clear();
+	m_FrameTimes.clear();
+	m_bEncoderStarted = false;
+	m_bEncoding = true;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Encode
+// Receive from the sender and encode a new frame.
+//
+//   Call at the sender frame rate or faster.
+//   Encoded packets are collected for GetPacket.
+//   The encoder is created again if the sender size changes.
+//   Returns false if not encoding or there is no sender.
+bool spoutEncoder::Encode()
+{
+	if (!m_bEncoding)
+		return false;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle()) {
+		ProcessEvents();
+		return true;
+	}
+
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return false;
+	}
+
+	if (m_bUpdated) {
+		// The encoder output size is fixed
+		if (m_bEncoderStarted && ((m_Width & ~1u) != m_EncodeWidth || (m_Height & ~1u) != m_EncodeHeight)) {
+			SpoutLogNotice("spoutEncoder::Encode - sender changed to %dx%d, encoder restarted", m_Width, m_Height);
+			ReleaseEncoder();
+		}
+		// The input view is created again for the new sender texture
+		if (m_pEncodeInputView) m_pEncodeInputView->Release();
+		m_pEncodeInputView = nullptr;
+		m_pEncodeSource = nullptr;
+		// There is no receiving texture for the application to update
+		m_bUpdated = false;
+	}
+
+	if (!m_bEncoderStarted) {
+		if (!CreateEncoder(m_Width, m_Height)) {
+			m_bEncoding = false;
+			return false;
+		}
+	}
+
+	m_bConnected = true;
+
+	// Input requests and output ready since the last frame
+	ProcessEvents();
+
+	int index = -1;
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (frame.GetNewFrame()) {
+			if (m_NeedInput > 0) {
+				index = m_SurfaceIndex;
+				m_SurfaceIndex = (m_SurfaceIndex + 1) % SPOUT_ENCODE_SURFACES;
+				if (!ConvertFrame(m_pSharedTexture, index))
+					index = -1;
+			}
+			else {
+				m_EncodeDropped++;
+			}
+		}
+		// The sender is free as soon as the conversion is queued
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	if (index >= 0) {
+		LARGE_INTEGER received={};
+		QueryPerformanceCounter(&received);
+		if (m_StartTime == 0)
+			m_StartTime = received.QuadPart;
+		const LONG64 timestamp = (received.QuadPart - m_StartTime)*10000000LL/m_Frequency;
+		if (SubmitFrame(index, timestamp)) {
+			m_EncodedFrames++;
+			// The sender frame number of the packet is found from the timestamp
+			m_FrameTimes.push_back(std::make_pair(timestamp, frame.GetSenderFrame64()));
+			if (m_FrameTimes.size() > SPOUT_ENCODE_PACKETS)
+				m_FrameTimes.pop_front();
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: StopEncoding
+// Drain the encoder and stop encoding.
+//
+//   Packets of the frames already passed to the encoder
+//   are collected and remain available to GetPacket.
+void spoutEncoder::StopEncoding()
+{
+	if (!m_bEncoding)
+		return;
+
+	m_bEncoding = false;
+
+	if (m_pEncoder && m_bEncoderStarted) {
+		m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0);
+		if (SUCCEEDED(m_pEncoder->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, 0))) {
+			// Wait up to half a second for the remaining output
+			for (int i = 0; i < 500; i++) {
+				if (ProcessEvents())
+					break;
+				Sleep(1);
+			}
+		}
+		SpoutLogNotice("spoutEncoder::StopEncoding - %llu frames, %llu dropped",
+			m_EncodedFrames, m_EncodeDropped);
+	}
+
+	ReleaseEncoder();
+}
+
+//---------------------------------------------------------
+// Function: IsEncoding
+// Encoding in progress
+bool spoutEncoder::IsEncoding()
+{
+	return m_bEncoding;
+}
+
+//---------------------------------------------------------
+// Function: GetPacket
+// Get the oldest encoded packet.
+//
+//   Returns false if there are no packets waiting.
+//   Packets are discarded, oldest first, if more than
+//   SPOUT_ENCODE_PACKETS are waiting.
+bool spoutEncoder::GetPacket(SpoutEncodedPacket &packet)
+{
+	if (m_Packets.empty())
+		return false;
+
+	packet = std::move(m_Packets.front());
+	m_Packets.pop_front();
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetPacketCount
+// Number of encoded packets waiting
+int spoutEncoder::GetPacketCount()
+{
+	return (int)m_Packets.size();
+}
+
+//---------------------------------------------------------
+// Function: RequestKeyframe
+// Encode the next frame as a key frame.
+//
+//   For example when a new client joins a stream.
+void spoutEncoder::RequestKeyframe()
+{
+	m_bKeyframe = true;
+}
+
+//---------------------------------------------------------
+// Function: SetEncodeSlices
+// Number of slices for each frame.
+//
+//   A frame is divided into horizontal slices that are
+//   decoded independently, so that a lost network packet
+//   affects only part of the frame. Zero for the encoder default.
+//   Applies when the encoder is next created.
+void spoutEncoder::SetEncodeSlices(int nSlices)
+{
+	m_nSlices = (nSlices > 0) ? nSlices : 0;
+}
+
+//---------------------------------------------------------
+// Function: GetEncodeSlices
+// Number of slices
+int spoutEncoder::GetEncodeSlices()
+{
+	return m_nSlices;
+}
+
+//---------------------------------------------------------
+// Function: GetEncodedFrames
+// Frames encoded
+unsigned __int64 spoutEncoder::GetEncodedFrames()
+{
+	return m_EncodedFrames;
+}
+
+//---------------------------------------------------------
+// Function: GetEncodeDropped
+// Sender frames not encoded because the encoder was busy
+unsigned __int64 spoutEncoder::GetEncodeDropped()
+{
+	return m_EncodeDropped;
+}
+
+//
+// Protected
+//
+
+// Create a D3D11 device with video support and the DXGI device manager
+bool spoutEncoder::CreateEncodeDevice()
+{
+	if (m_pEncodeDevice && m_pDeviceManager)
+		return true;
+
+	if (!m_bMFStarted) {
+		const HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+		if (FAILED(hr)) {
+			SpoutLogError("spoutEncoder::CreateEncodeDevice - MFStartup failed (0x%.7X)", (unsigned int)hr);
+			return false;
+		}
+		m_bMFStarted = true;
+	}
+
+	if (!m_pEncodeDevice) {
+		// A device of the class is used by the encoder from its own thread
+		const UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT;
+		const D3D_FEATURE_LEVEL levels[] = { D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
+		HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
+			levels, 2, D3D11_SDK_VERSION, &m_pEncodeDevice, nullptr, nullptr);
+		// Feature level 11.1 is not recognised before Windows 8
+		if (hr == E_INVALIDARG) {
+			hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
+				&levels[1], 1, D3D11_SDK_VERSION, &m_pEncodeDevice, nullptr, nullptr);
+		}
+		if (FAILED(hr)) {
+			SpoutLogError("spoutEncoder::CreateEncodeDevice - could not create device (0x%.7X)", (unsigned int)hr);
+			m_pEncodeDevice = nullptr;
+			return false;
+		}
+
+		ID3D10Multithread* pMultithread = nullptr;
+		if (SUCCEEDED(m_pEncodeDevice->QueryInterface(IID_PPV_ARGS(&pMultithread)))) {
+			pMultithread->SetMultithreadProtected(TRUE);
+			pMultithread->Release();
+		}
+
+		if (!OpenDirectX11(m_pEncodeDevice))
+			return false;
+	}
+
+	HRESULT hr = MFCreateDXGIDeviceManager(&m_ResetToken, &m_pDeviceManager);
+	if (SUCCEEDED(hr))
+		hr = m_pDeviceManager->ResetDevice(m_pEncodeDevice, m_ResetToken);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutEncoder::CreateEncodeDevice - could not create device manager (0x%.7X)", (unsigned int)hr);
+		if (m_pDeviceManager) m_pDeviceManager->Release();
+		m_pDeviceManager = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+// Create the hardware encoder and the NV12 conversion for the sender size
+bool spoutEncoder::CreateEncoder(unsigned int width, unsigned int height)
+{
+	ReleaseEncoder();
+
+	// Even size for 4:2:0
+	const unsigned int ew = width & ~1u;
+	const unsigned int eh = height & ~1u;
+	if (ew == 0 || eh == 0)
+		return false;
+
+	const GUID subtype = (m_Codec == SPOUT_ENCODE_HEVC) ? MFVideoFormat_HEVC : MFVideoFormat_H264;
+
+	MFT_REGISTER_TYPE_INFO input = { MFMediaType_Video, MFVideoFormat_NV12 };
+	MFT_REGISTER_TYPE_INFO output = { MFMediaType_Video, subtype };
+	IMFActivate** ppActivate = nullptr;
+	UINT32 count = 0;
+	HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_ENCODER,
+		MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
+		&input, &output, &ppActivate, &count);
+	if (FAILED(hr) || count == 0) {
+		SpoutLogWarning("spoutEncoder::CreateEncoder - no hardware %s encoder", (m_Codec == SPOUT_ENCODE_HEVC) ? "HEVC" : "H.264");
+		if (ppActivate) CoTaskMemFree(ppActivate);
+		return false;
+	}
+	hr = ppActivate[0]->ActivateObject(IID_PPV_ARGS(&m_pEncoder));
+	for (UINT32 i = 0; i < count; i++)
+		ppActivate[i]->Release();
+	CoTaskMemFree(ppActivate);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncoder - could not activate encoder (0x%.7X)", (unsigned int)hr);
+		m_pEncoder = nullptr;
+		return false;
+	}
+
+	// Hardware encoders are asynchronous and must be unlocked
+	IMFAttributes* pAttributes = nullptr;
+	if (SUCCEEDED(m_pEncoder->GetAttributes(&pAttributes))) {
+		pAttributes->SetUINT32(MF_TRANSFORM_ASYNC_UNLOCK, TRUE);
+		pAttributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+		pAttributes->Release();
+	}
+	hr = m_pEncoder->QueryInterface(IID_PPV_ARGS(&m_pEncoderEvents));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncoder - encoder is not asynchronous");
+		m_pEncoderEvents = nullptr;
+		ReleaseEncoder();
+		return false;
+	}
+	// Optional, for key frame requests and low latency settings
+	if (FAILED(m_pEncoder->QueryInterface(IID_PPV_ARGS(&m_pCodecAPI))))
+		m_pCodecAPI = nullptr;
+	if (m_pCodecAPI) {
+		VARIANT var={};
+		var.vt = VT_UI4;
+		// Each frame is output as soon as it is encoded
+		var.ulVal = 0;
+		m_pCodecAPI->SetValue(&CODECAPI_AVEncMPVDefaultBPictureCount, &var);
+		var.ulVal = eAVEncCommonRateControlMode_LowDelayVBR;
+		m_pCodecAPI->SetValue(&CODECAPI_AVEncCommonRateControlMode, &var);
+		if (m_nSlices > 0) {
+			// Slices of whole macroblock rows
+			const unsigned int rows = (eh + 15)/16;
+			var.ulVal = 2;
+			m_pCodecAPI->SetValue(&CODECAPI_AVEncSliceControlMode, &var);
+			var.ulVal = (rows + m_nSlices - 1)/m_nSlices;
+			m_pCodecAPI->SetValue(&CODECAPI_AVEncSliceControlSize, &var);
+		}
+	}
+
+	// Stream identifiers are zero if not implemented
+	m_InputStream = 0;
+	m_OutputStream = 0;
+	m_pEncoder->GetStreamIDs(1, &m_InputStream, 1, &m_OutputStream);
+
+	// Input surfaces from the class device
+	hr = m_pEncoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, reinterpret_cast<ULONG_PTR>(m_pDeviceManager));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncoder - could not set device manager (0x%.7X)", (unsigned int)hr);
+		ReleaseEncoder();
+		return false;
+	}
+
+	// Default bit rate of 0.1 bits per pixel per frame
+	const unsigned int bitrate = (m_Bitrate > 0) ? m_Bitrate
+		: (unsigned int)((unsigned __int64)ew*eh*m_Fps/10);
+
+	// The output type is set before the input type
+	IMFMediaType* pType = nullptr;
+	hr = MFCreateMediaType(&pType);
+	if (SUCCEEDED(hr)) {
+		pType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+		pType->SetGUID(MF_MT_SUBTYPE, subtype);
+		pType->SetUINT32(MF_MT_AVG_BITRATE, bitrate);
+		pType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+		pType->SetUINT32(MF_MT_MPEG2_PROFILE, (m_Codec == SPOUT_ENCODE_HEVC)
+			? (UINT32)eAVEncH265VProfile_Main_420_8 : (UINT32)eAVEncH264VProfile_High);
+		MFSetAttributeSize(pType, MF_MT_FRAME_SIZE, ew, eh);
+		MFSetAttributeRatio(pType, MF_MT_FRAME_RATE, m_Fps, 1);
+		MFSetAttributeRatio(pType, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+		hr = m_pEncoder->SetOutputType(m_OutputStream, pType, 0);
+		pType->Release();
+	}
+	if (SUCCEEDED(hr))
+		hr = MFCreateMediaType(&pType);
+	if (SUCCEEDED(hr)) {
+		pType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+		pType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_NV12);
+		pType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+		MFSetAttributeSize(pType, MF_MT_FRAME_SIZE, ew, eh);
+		MFSetAttributeRatio(pType, MF_MT_FRAME_RATE, m_Fps, 1);
+		MFSetAttributeRatio(pType, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+		hr = m_pEncoder->SetInputType(m_InputStream, pType, 0);
+		pType->Release();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncoder - %dx%d not supported (0x%.7X)", ew, eh, (unsigned int)hr);
+		ReleaseEncoder();
+		return false;
+	}
+
+	// Output samples are allocated by the encoder or by the class
+	MFT_OUTPUT_STREAM_INFO info={};
+	m_pEncoder->GetOutputStreamInfo(m_OutputStream, &info);
+	m_bProvidesSamples = (info.dwFlags & (MFT_OUTPUT_STREAM_PROVIDES_SAMPLES | MFT_OUTPUT_STREAM_CAN_PROVIDE_SAMPLES)) != 0;
+	m_OutputSize = (info.cbSize > 0) ? info.cbSize : ew*eh*3/2;
+
+	if (!CreateEncodeProcessor(width, height)) {
+		ReleaseEncoder();
+		return false;
+	}
+
+	m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+	m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+
+	m_EncodeWidth = ew;
+	m_EncodeHeight = eh;
+	m_NeedInput = 0;
+	m_bEncoderStarted = true;
+
+	SpoutLogNotice("spoutEncoder::CreateEncoder - %s %dx%d, %d fps, %u bps",
+		(m_Codec == SPOUT_ENCODE_HEVC) ? "HEVC" : "H.264", ew, eh, m_Fps, bitrate);
+
+	return true;
+}
+
+// Create the video processor and NV12 textures for the encoder input
+bool spoutEncoder::CreateEncodeProcessor(unsigned int width, unsigned int height)
+{
+	ReleaseEncodeProcessor();
+
+	const unsigned int ew = width & ~1u;
+	const unsigned int eh = height & ~1u;
+
+	HRESULT hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&m_pEncodeVideoDevice));
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(IID_PPV_ARGS(&m_pEncodeVideoContext));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncodeProcessor - no video device (0x%.7X)", (unsigned int)hr);
+		ReleaseEncodeProcessor();
+		return false;
+	}
+
+	D3D11_VIDEO_PROCESSOR_CONTENT_DESC content={};
+	content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+	content.InputWidth   = width;
+	content.InputHeight  = height;
+	content.OutputWidth  = ew;
+	content.OutputHeight = eh;
+	content.Usage = D3D11_VIDEO_USAGE_OPTIMAL_SPEED;
+	hr = m_pEncodeVideoDevice->CreateVideoProcessorEnumerator(&content, &m_pEncodeEnum);
+	if (SUCCEEDED(hr))
+		hr = m_pEncodeVideoDevice->CreateVideoProcessor(m_pEncodeEnum, 0, &m_pEncodeProcessor);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::CreateEncodeProcessor - could not create video processor (0x%.7X)", (unsigned int)hr);
+		ReleaseEncodeProcessor();
+		return false;
+	}
+
+	// RGB full range in, BT.709 studio range out
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE incs={};
+	incs.RGB_Range = 0; // 0-255
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE outcs={};
+	outcs.YCbCr_Matrix = 1; // BT.709
+	outcs.Nominal_Range = D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+	m_pEncodeVideoContext->VideoProcessorSetStreamColorSpace(m_pEncodeProcessor, 0, &incs);
+	m_pEncodeVideoContext->VideoProcessorSetOutputColorSpace(m_pEncodeProcessor, &outcs);
+	m_pEncodeVideoContext->VideoProcessorSetStreamFrameFormat(m_pEncodeProcessor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+	m_pEncodeVideoContext->VideoProcessorSetStreamAutoProcessingMode(m_pEncodeProcessor, 0, FALSE);
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = ew;
+	desc.Height = eh;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_NV12;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_VIDEO_ENCODER;
+
+	D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd={};
+	ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+	for (int i = 0; i < SPOUT_ENCODE_SURFACES; i++) {
+		hr = m_pd3dDevice->CreateTexture2D(&desc, nullptr, &m_pSurface[i]);
+		if (SUCCEEDED(hr))
+			hr = m_pEncodeVideoDevice->CreateVideoProcessorOutputView(m_pSurface[i], m_pEncodeEnum, &ovd, &m_pSurfaceView[i]);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutEncoder::CreateEncodeProcessor - could not create NV12 texture (0x%.7X)", (unsigned int)hr);
+			ReleaseEncodeProcessor();
+			return false;
+		}
+	}
+	m_SurfaceIndex = 0;
+
+	return true;
+}
+
+// Convert a texture to an NV12 encoder input texture on the GPU
+bool spoutEncoder::ConvertFrame(ID3D11Texture2D* pTexture, int index)
+{
+	if (!m_pEncodeProcessor || !m_pSurfaceView[index] || !pTexture)
+		return false;
+
+	// Input view of the sender shared texture
+	if (pTexture != m_pEncodeSource || !m_pEncodeInputView) {
+		if (m_pEncodeInputView) m_pEncodeInputView->Release();
+		m_pEncodeInputView = nullptr;
+		m_pEncodeSource = nullptr;
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd={};
+		ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		const HRESULT hr = m_pEncodeVideoDevice->CreateVideoProcessorInputView(pTexture, m_pEncodeEnum, &ivd, &m_pEncodeInputView);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutEncoder::ConvertFrame - could not create input view (0x%.7X)", (unsigned int)hr);
+			m_pEncodeInputView = nullptr;
+			return false;
+		}
+		m_pEncodeSource = pTexture;
+	}
+
+	D3D11_VIDEO_PROCESSOR_STREAM stream={};
+	stream.Enable = TRUE;
+	stream.pInputSurface = m_pEncodeInputView;
+	const HRESULT hr = m_pEncodeVideoContext->VideoProcessorBlt(m_pEncodeProcessor, m_pSurfaceView[index], 0, 1, &stream);
+
+	return SUCCEEDED(hr);
+}
+
+// Pass an NV12 texture to the encoder as a DXGI surface sample
+bool spoutEncoder::SubmitFrame(int index, LONG64 timestamp)
+{
+	IMFMediaBuffer* pBuffer = nullptr;
+	IMFSample* pSample = nullptr;
+	HRESULT hr = MFCreateDXGISurfaceBuffer(__uuidof(ID3D11Texture2D), m_pSurface[index], 0, FALSE, &pBuffer);
+	if (SUCCEEDED(hr)) {
+		// The buffer length is the size of the NV12 image
+		IMF2DBuffer* p2DBuffer = nullptr;
+		DWORD length = 0;
+		if (SUCCEEDED(pBuffer->QueryInterface(IID_PPV_ARGS(&p2DBuffer)))) {
+			p2DBuffer->GetContiguousLength(&length);
+			p2DBuffer->Release();
+		}
+		pBuffer->SetCurrentLength(length);
+		hr = MFCreateSample(&pSample);
+	}
+	if (SUCCEEDED(hr))
+		hr = pSample->AddBuffer(pBuffer);
+	if (SUCCEEDED(hr)) {
+		pSample->SetSampleTime(timestamp);
+		pSample->SetSampleDuration(10000000LL/m_Fps);
+		if (m_bKeyframe && m_pCodecAPI) {
+			VARIANT var={};
+			var.vt = VT_UI4;
+			var.ulVal = 1;
+			m_pCodecAPI->SetValue(&CODECAPI_AVEncVideoForceKeyFrame, &var);
+		}
+		m_bKeyframe = false;
+		hr = m_pEncoder->ProcessInput(m_InputStream, pSample, 0);
+	}
+	if (pSample) pSample->Release();
+	if (pBuffer) pBuffer->Release();
+
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutEncoder::SubmitFrame - encoder input failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+	m_NeedInput--;
+
+	return true;
+}
+
+// Handle the encoder events waiting without blocking.
+// Returns true when a drain is complete.
+bool spoutEncoder::ProcessEvents()
+{
+	bool bDrained = false;
+	while (m_pEncoderEvents) {
+		IMFMediaEvent* pEvent = nullptr;
+		// MF_E_NO_EVENTS_AVAILABLE if there are no more
+		if (FAILED(m_pEncoderEvents->GetEvent(MF_EVENT_FLAG_NO_WAIT, &pEvent)))
+			break;
+		MediaEventType type = MEUnknown;
+		pEvent->GetType(&type);
+		pEvent->Release();
+		if (type == METransformNeedInput)
+			m_NeedInput++;
+		else if (type == METransformHaveOutput)
+			ReadOutput();
+		else if (type == METransformDrainComplete)
+			bDrained = true;
+	}
+	return bDrained;
+}
+
+// Read an encoded sample to the packet queue
+bool spoutEncoder::ReadOutput()
+{
+	MFT_OUTPUT_DATA_BUFFER output={};
+	output.dwStreamID = m_OutputStream;
+	if (!m_bProvidesSamples) {
+		IMFMediaBuffer* pBuffer = nullptr;
+		if (FAILED(MFCreateSample(&output.pSample)))
+			return false;
+		if (SUCCEEDED(MFCreateMemoryBuffer(m_OutputSize, &pBuffer))) {
+			output.pSample->AddBuffer(pBuffer);
+			pBuffer->Release();
+		}
+	}
+
+	DWORD status = 0;
+	HRESULT hr = m_pEncoder->ProcessOutput(0, 1, &output, &status);
+	if (output.pEvents)
+		output.pEvents->Release();
+
+	if (hr == MF_E_TRANSFORM_STREAM_CHANGE) {
+		// The encoder has changed the output type, so set it again
+		IMFMediaType* pType = nullptr;
+		if (SUCCEEDED(m_pEncoder->GetOutputAvailableType(m_OutputStream, 0, &pType))) {
+			m_pEncoder->SetOutputType(m_OutputStream, pType, 0);
+			pType->Release();
+		}
+	}
+	else if (SUCCEEDED(hr) && output.pSample) {
+		IMFMediaBuffer* pBuffer = nullptr;
+		if (SUCCEEDED(output.pSample->ConvertToContiguousBuffer(&pBuffer))) {
+			BYTE* pData = nullptr;
+			DWORD length = 0;
+			if (SUCCEEDED(pBuffer->Lock(&pData, nullptr, &length))) {
+				SpoutEncodedPacket packet;
+				packet.data.assign(pData, pData + length);
+				pBuffer->Unlock();
+				LONGLONG time = 0;
+				output.pSample->GetSampleTime(&time);
+				packet.timestamp = time;
+				packet.keyframe = (MFGetAttributeUINT32(output.pSample, MFSampleExtension_CleanPoint, FALSE) != 0);
+				packet.frame = 0;
+				while (!m_FrameTimes.empty() && m_FrameTimes.front().first <= time) {
+					if (m_FrameTimes.front().first == time)
+						packet.frame = m_FrameTimes.front().second;
+					m_FrameTimes.pop_front();
+				}
+				// Discard the oldest if the application has not taken them
+				if (m_Packets.size() >= SPOUT_ENCODE_PACKETS)
+					m_Packets.pop_front();
+				m_Packets.push_back(std::move(packet));
+			}
+			pBuffer->Release();
+		}
+	}
+
+	if (output.pSample)
+		output.pSample->Release();
+
+	return SUCCEEDED(hr);
+}
+
+// Release the encoder and the NV12 conversion
+void spoutEncoder::ReleaseEncoder()
+{
+	if (m_pEncoder && m_bEncoderStarted)
+		m_pEncoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+
+	if (m_pCodecAPI) m_pCodecAPI->Release();
+	if (m_pEncoderEvents) m_pEncoderEvents->Release();
+	if (m_pEncoder) {
+		// Release the encoder reference to the device manager
+		m_pEncoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, 0);
+		m_pEncoder->Release();
+	}
+	m_pCodecAPI = nullptr;
+	m_pEncoderEvents = nullptr;
+	m_pEncoder = nullptr;
+
+	ReleaseEncodeProcessor();
+
+	m_InputStream = 0;
+	m_OutputStream = 0;
+	m_NeedInput = 0;
+	m_EncodeWidth = 0;
+	m_EncodeHeight = 0;
+	m_bEncoderStarted = false;
+}
+
+// Release the video processor and NV12 textures
+void spoutEncoder::ReleaseEncodeProcessor()
+{
+	if (m_pEncodeInputView) m_pEncodeInputView->Release();
+	for (int i = 0; i < SPOUT_ENCODE_SURFACES; i++) {
+		if (m_pSurfaceView[i]) m_pSurfaceView[i]->Release();
+		if (m_pSurface[i]) m_pSurface[i]->Release();
+		m_pSurfaceView[i] = nullptr;
+		m_pSurface[i] = nullptr;
+	}
+	if (m_pEncodeProcessor) m_pEncodeProcessor->Release();
+	if (m_pEncodeEnum) m_pEncodeEnum->Release();
+	if (m_pEncodeVideoContext) m_pEncodeVideoContext->Release();
+	if (m_pEncodeVideoDevice) m_pEncodeVideoDevice->Release();
+	m_pEncodeInputView = nullptr;
+	m_pEncodeSource = nullptr;
+	m_pEncodeProcessor = nullptr;
+	m_pEncodeEnum = nullptr;
+	m_pEncodeVideoContext = nullptr;
+	m_pEncodeVideoDevice = nullptr;
+	m_SurfaceIndex = 0;
+
+	// Flush now to avoid deferred object destruction
+	if (m_pImmediateContext)
+		m_pImmediateContext->Flush();
+}
@@ -0,0 +1,156 @@
+/*
+
+	spoutEncoder.h
+
+	Functions to encode a Spout sender with a hardware video encoder
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutEncoder__
+#define __spoutEncoder__
+
+#include "..\SpoutDX.h" // Base class
+#include <mfapi.h>
+#include <mftransform.h>
+#include <mferror.h>
+#include <codecapi.h>
+#include <vector>
+#include <deque>
+
+#pragma comment (lib, "mfplat.lib")
+#pragma comment (lib, "mfuuid.lib")
+
+// NV12 encoder input textures in use at once
+#define SPOUT_ENCODE_SURFACES 4
+// Encoded packets held before the oldest are discarded
+#define SPOUT_ENCODE_PACKETS 64
+
+// Video codec of the encoder
+enum SpoutEncodeCodec {
+	SPOUT_ENCODE_H264 = 0,
+	SPOUT_ENCODE_HEVC
+};
+
+//
+// Encoded packet
+//
+struct SpoutEncodedPacket {
+	std::vector<unsigned char> data; // Encoded bytes (Annex B)
+	LONG64 timestamp; // Presentation time in 100 nanosecond units
+	LONG64 frame; // Sender frame number
+	bool keyframe; // Packet can be decoded without earlier packets
+};
+
+class spoutEncoder : public spoutDX {
+
+	public:
+
+		spoutEncoder();
+		~spoutEncoder();
+
+		// Start encoding with the codec, bit rate (0 for default) and frame rate
+		bool StartEncoding(SpoutEncodeCodec codec = SPOUT_ENCODE_H264,
+			unsigned int bitrate = 0, unsigned int fps = 60);
+		// Receive from the sender and encode a new frame
+		bool Encode();
+		// Drain the encoder and stop encoding
+		void StopEncoding();
+		// Encoding in progress
+		bool IsEncoding();
+		// Get the oldest encoded packet
+		bool GetPacket(SpoutEncodedPacket &packet);
+		// Number of encoded packets waiting
+		int GetPacketCount();
+		// Encode the next frame as a key frame
+		void RequestKeyframe();
+		// Number of slices for each frame (0 for the encoder default)
+		void SetEncodeSlices(int nSlices);
+		// Number of slices
+		int GetEncodeSlices();
+		// Frames encoded
+		unsigned __int64 GetEncodedFrames();
+		// Sender frames not encoded because the encoder was busy
+		unsigned __int64 GetEncodeDropped();
+
+	protected:
+
+		bool m_bEncoding;
+		bool m_bEncoderStarted; // Encoder created for the first frame
+		SpoutEncodeCodec m_Codec;
+		unsigned int m_Bitrate;
+		unsigned int m_Fps;
+		unsigned int m_EncodeWidth;
+		unsigned int m_EncodeHeight;
+
+		// Device with video support shared with the encoder
+		ID3D11Device* m_pEncodeDevice;
+		IMFDXGIDeviceManager* m_pDeviceManager;
+		UINT m_ResetToken;
+		bool m_bMFStarted;
+
+		// Hardware encoder transform
+		IMFTransform* m_pEncoder;
+		IMFMediaEventGenerator* m_pEncoderEvents;
+		ICodecAPI* m_pCodecAPI;
+		DWORD m_InputStream;
+		DWORD m_OutputStream;
+		bool m_bProvidesSamples; // Encoder allocates the output samples
+		DWORD m_OutputSize; // Output buffer size if not
+		int m_NeedInput; // Input requests not yet met
+		bool m_bKeyframe; // Key frame requested
+		int m_nSlices; // Slices for each frame
+
+		// GPU conversion of the sender texture to NV12
+		ID3D11VideoDevice* m_pEncodeVideoDevice;
+		ID3D11VideoContext* m_pEncodeVideoContext;
+		ID3D11VideoProcessorEnumerator* m_pEncodeEnum;
+		ID3D11VideoProcessor* m_pEncodeProcessor;
+		ID3D11VideoProcessorInputView* m_pEncodeInputView;
+		ID3D11Texture2D* m_pEncodeSource; // Texture of the input view
+		ID3D11Texture2D* m_pSurface[SPOUT_ENCODE_SURFACES]; // NV12 encoder input
+		ID3D11VideoProcessorOutputView* m_pSurfaceView[SPOUT_ENCODE_SURFACES];
+		int m_SurfaceIndex;
+
+		// Timing and counts
+		LONG64 m_StartTime; // Performance counter of the first frame
+		LONG64 m_Frequency;
+		unsigned __int64 m_EncodedFrames;
+		unsigned __int64 m_EncodeDropped;
+		std::deque<SpoutEncodedPacket> m_Packets;
+		std::deque<std::pair<LONG64, LONG64>> m_FrameTimes; // Timestamp and sender frame passed to the encoder
+
+		bool CreateEncodeDevice();
+		bool CreateEncoder(unsigned int width, unsigned int height);
+		bool CreateEncodeProcessor(unsigned int width, unsigned int height);
+		bool ConvertFrame(ID3D11Texture2D* pTexture, int index);
+		bool SubmitFrame(int index, LONG64 timestamp);
+		bool ProcessEvents();
+		bool ReadOutput();
+		void ReleaseEncoder();
+		void ReleaseEncodeProcessor();
+
+};
+
+#endif
@@ -0,0 +1,851 @@
+//
+//		spoutRecorder.cpp
+//
+//		Functions to record a Spout sender to disk as raw frames
+//		Base class spoutDX for the D3D11 device and Spout functions.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. Frames are read from the mapped staging texture
+//					  and written with unbuffered overlapped writes to a file
+//					  allocated at the start, with an index of frame number,
+//					  timestamp and size for random access.
+//					- Play back through a file mapping. Frames are uploaded with two
+//					  staging textures in turn and sent at the recorded frame rate.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutRecorder.h"
+
+//
+// Class: spoutRecorder
+//
+// Functions to record a Spout sender to disk as raw frames.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// The sender texture is copied to two staging textures in turn as for
+// ReceiveImage. The staging texture of the last frame is mapped and the
+// rows copied once to a page aligned buffer, which is written to the file
+// without system buffering while the next frames are received.
+// Several writes can be in progress. A buffer is re-used when its write
+// has completed, and the wait is counted as a stall.
+//
+// The file is allocated for the maximum number of frames when the first
+// frame is received, so that writes do not extend the file. Each frame
+// has a slot aligned to SPOUT_RECORD_ALIGN. The header and an index of
+// frame number, timestamp and size are written when recording stops
+// and the unused space is removed.
+//
+// A recording is played back through a mapped view of a window of frames.
+// The frames after the one sent are prefetched from disk. Each frame is
+// copied from the view to one of two staging textures in turn and sent
+// with SendTexture at the recorded frame rate.
+//
+// Use separate objects to record and play back at the same time.
+//
+// Refer to source code for further details.
+//
+
+spoutRecorder::spoutRecorder() {
+
+	m_RecordPath[0] = 0;
+	m_hRecordFile = NULL;
+	m_bRecording = false;
+	m_bRecordStarted = false;
+	m_MaxFrames = 0;
+	ZeroMemory(&m_RecordHeader, sizeof(m_RecordHeader));
+	ZeroMemory(m_pRecordBuffer, sizeof(m_pRecordBuffer));
+	ZeroMemory(m_RecordOverlap, sizeof(m_RecordOverlap));
+	ZeroMemory(m_bRecordPending, sizeof(m_bRecordPending));
+	m_RecordStalls = 0;
+	m_RecordDropped = 0;
+	m_StagedFrame[0] = m_StagedFrame[1] = -1;
+	m_StagedTime[0] = m_StagedTime[1] = 0;
+	m_LastFrame = 0;
+
+	m_hPlayFile = NULL;
+	m_hPlayMapping = NULL;
+	ZeroMemory(&m_PlayHeader, sizeof(m_PlayHeader));
+	m_pPlayView = nullptr;
+	m_PlayViewOffset = 0;
+	m_PlayViewSize = 0;
+	m_PlayFrame = 0;
+	m_pPlayStaging[0] = m_pPlayStaging[1] = nullptr;
+	m_PlayStagingIndex = 0;
+
+	// Not available for Windows 7
+	m_pPrefetchVirtualMemory = (PrefetchVirtualMemoryPROC)GetProcAddress(
+		GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory");
+
+}
+
+spoutRecorder::~spoutRecorder() {
+
+	StopRecording();
+	CloseRecording();
+
+}
+
+//
+// Group: Record
+//
+
+//---------------------------------------------------------
+// Function: StartRecording
+// Start recording to a file with space for a number of frames.
+//
+//   The file is created when the first frame is received
+//   and the sender size and format are known.
+//   An existing file is replaced.
+bool spoutRecorder::StartRecording(const char* filepath, unsigned int maxframes)
+{
+	if (!filepath || !*filepath || maxframes == 0)
+		return false;
+
+	if (!OpenDirectX11())
+		return false;
+
+	StopRecording();
+
+	strcpy_s(m_RecordPath, MAX_PATH, filepath);
+	m_MaxFrames = maxframes;
+	m_RecordIndex.clear();
+	m_RecordIndex.reserve(maxframes);
+	m_RecordStalls = 0;
+	m_RecordDropped = 0;
+	m_StagedFrame[0] = m_StagedFrame[1] = -1;
+	m_LastFrame = 0;
+	m_bRecordStarted = false;
+	m_bRecording = true;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Record
+// Receive from the sender and write a new frame.
+//
+//   Call at the sender frame rate or faster.
+//   Each frame is written when the next one is received.
+//   Recording stops if the sender size or format changes,
+//   or when the file is full.
+//   Returns false if not recording or there is no sender.
+bool spoutRecorder::Record()
+{
+	if (!m_bRecording)
+		return false;
+
+	// Return if the sender has not signalled a new frame (SetIdleReceive)
+	if (IsReceiverIdle())
+		return true;
+
+	// A staging texture cannot be mapped twice
+	ReleaseImageView();
+
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return false;
+	}
+
+	if (m_bUpdated) {
+		// Frames of a different size or format cannot be added to the file
+		if (m_bRecordStarted && (m_Width != m_RecordHeader.width
+			|| m_Height != m_RecordHeader.height || m_dwFormat != m_RecordHeader.format)) {
+			SpoutLogWarning("spoutRecorder::Record - sender changed to %dx%d, recording stopped", m_Width, m_Height);
+			StopRecording();
+			return false;
+		}
+		CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+		m_StagedFrame[0] = m_StagedFrame[1] = -1;
+		// There is no receiving buffer for the application to update
+		m_bUpdated = false;
+	}
+
+	if (!m_bRecordStarted && !CreateRecordFile()) {
+		m_bRecording = false;
+		return false;
+	}
+
+	CheckStagingTextures(m_Width, m_Height, m_dwFormat);
+	if (!m_pStaging[0] || !m_pStaging[1])
+		return false;
+
+	m_bConnected = true;
+
+	bool bNewFrame = false;
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (frame.GetNewFrame()) {
+			m_Index = (m_Index + 1) % 2;
+			m_NextIndex = (m_Index + 1) % 2;
+			CopySenderTexture(m_pStaging[m_Index]);
+			LARGE_INTEGER received={};
+			QueryPerformanceCounter(&received);
+			m_StagedFrame[m_Index] = frame.GetSenderFrame64();
+			m_StagedTime[m_Index] = received.QuadPart;
+			bNewFrame = true;
+		}
+		// The sender is free as soon as the copy is queued
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	// Write the previous frame while the new one is copied
+	if (bNewFrame && m_StagedFrame[m_NextIndex] >= 0) {
+		D3D11_MAPPED_SUBRESOURCE mapped={};
+		m_pImmediateContext->Flush();
+		if (SUCCEEDED(m_pImmediateContext->Map(m_pStaging[m_NextIndex], 0, D3D11_MAP_READ, 0, &mapped))) {
+			const bool bWritten = WriteFrame(mapped, m_StagedFrame[m_NextIndex], m_StagedTime[m_NextIndex]);
+			m_pImmediateContext->Unmap(m_pStaging[m_NextIndex], 0);
+			m_StagedFrame[m_NextIndex] = -1;
+			if (!bWritten) {
+				StopRecording();
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: StopRecording
+// Complete the file and stop recording.
+//
+//   Writes the last frame, waits for writes in progress
+//   and then writes the index and header.
+void spoutRecorder::StopRecording()
+{
+	if (!m_bRecording)
+		return;
+
+	m_bRecording = false;
+
+	if (m_bRecordStarted && m_hRecordFile) {
+
+		// The last frame received is still in a staging texture
+		if (m_StagedFrame[m_Index] >= 0 && m_pStaging[m_Index]
+			&& m_RecordIndex.size() < m_MaxFrames) {
+			D3D11_MAPPED_SUBRESOURCE mapped={};
+			m_pImmediateContext->Flush();
+			if (SUCCEEDED(m_pImmediateContext->Map(m_pStaging[m_Index], 0, D3D11_MAP_READ, 0, &mapped))) {
+				WriteFrame(mapped, m_StagedFrame[m_Index], m_StagedTime[m_Index]);
+				m_pImmediateContext->Unmap(m_pStaging[m_Index], 0);
+			}
+		}
+		m_StagedFrame[0] = m_StagedFrame[1] = -1;
+
+		for (int i = 0; i < SPOUT_RECORD_BUFFERS; i++)
+			WaitRecordBuffer(i);
+
+		// The index follows the last frame
+		m_RecordHeader.frames = m_RecordIndex.size();
+		m_RecordHeader.indexoffset = SPOUT_RECORD_ALIGN + m_RecordHeader.frames*m_RecordHeader.slotsize;
+		const unsigned __int64 indexbytes = m_RecordHeader.frames*sizeof(SpoutRecordIndex);
+		const unsigned __int64 alignedbytes = (indexbytes + SPOUT_RECORD_ALIGN - 1) & ~((unsigned __int64)SPOUT_RECORD_ALIGN - 1);
+
+		// Unbuffered writes must be from aligned memory
+		const unsigned __int64 buffersize = (alignedbytes > SPOUT_RECORD_ALIGN) ? alignedbytes : SPOUT_RECORD_ALIGN;
+		unsigned char* pAligned = (unsigned char*)VirtualAlloc(nullptr, (SIZE_T)buffersize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		if (pAligned) {
+			if (indexbytes > 0) {
+				ZeroMemory(pAligned, (size_t)alignedbytes);
+				memcpy(pAligned, m_RecordIndex.data(), (size_t)indexbytes);
+				WriteAligned(pAligned, (DWORD)alignedbytes, m_RecordHeader.indexoffset);
+			}
+			ZeroMemory(pAligned, SPOUT_RECORD_ALIGN);
+			memcpy(pAligned, &m_RecordHeader, sizeof(SpoutRecordHeader));
+			WriteAligned(pAligned, SPOUT_RECORD_ALIGN, 0);
+			VirtualFree(pAligned, 0, MEM_RELEASE);
+		}
+
+		// Remove the space allocated for frames not recorded
+		FILE_END_OF_FILE_INFO eof={};
+		eof.EndOfFile.QuadPart = (LONGLONG)(m_RecordHeader.indexoffset + indexbytes);
+		SetFileInformationByHandle(m_hRecordFile, FileEndOfFileInfo, &eof, sizeof(eof));
+
+		SpoutLogNotice("spoutRecorder::StopRecording - %llu frames, %llu stalls, %llu dropped",
+			m_RecordHeader.frames, m_RecordStalls, m_RecordDropped);
+	}
+
+	ReleaseRecord();
+
+}
+
+//---------------------------------------------------------
+// Function: IsRecording
+// Recording in progress
+bool spoutRecorder::IsRecording()
+{
+	return m_bRecording;
+}
+
+//---------------------------------------------------------
+// Function: GetRecordedFrames
+// Frames written
+unsigned __int64 spoutRecorder::GetRecordedFrames()
+{
+	return m_RecordIndex.size();
+}
+
+//---------------------------------------------------------
+// Function: GetRecordStalls
+// Writes that had to wait for a buffer.
+//
+//   Stalls show that the disk cannot keep up with the sender.
+unsigned __int64 spoutRecorder::GetRecordStalls()
+{
+	return m_RecordStalls;
+}
+
+//---------------------------------------------------------
+// Function: GetRecordDropped
+// Sender frames missed.
+//
+//   From the sender frame count. Zero if the sender does not count frames.
+unsigned __int64 spoutRecorder::GetRecordDropped()
+{
+	return m_RecordDropped;
+}
+
+//
+// Group: Play back
+//
+
+//---------------------------------------------------------
+// Function: OpenRecording
+// Open a recording to read frames
+bool spoutRecorder::OpenRecording(const char* filepath, SpoutRecordHeader &header)
+{
+	if (!filepath || !*filepath)
+		return false;
+
+	CloseRecording();
+
+	m_hPlayFile = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (m_hPlayFile == INVALID_HANDLE_VALUE) {
+		m_hPlayFile = NULL;
+		SpoutLogError("spoutRecorder::OpenRecording - could not open %s", filepath);
+		return false;
+	}
+
+	DWORD dwRead = 0;
+	if (!ReadFile(m_hPlayFile, &m_PlayHeader, sizeof(SpoutRecordHeader), &dwRead, NULL)
+		|| dwRead != sizeof(SpoutRecordHeader)
+		|| memcmp(m_PlayHeader.id, "SPOUTREC", 8) != 0
+		|| m_PlayHeader.version != SPOUT_RECORD_VERSION) {
+		SpoutLogError("spoutRecorder::OpenRecording - %s is not a recording", filepath);
+		CloseRecording();
+		return false;
+	}
+
+	// Frame index
+	m_PlayIndex.resize((size_t)m_PlayHeader.frames);
+	if (m_PlayHeader.frames > 0) {
+		const DWORD dwIndex = (DWORD)(m_PlayHeader.frames*sizeof(SpoutRecordIndex));
+		LARGE_INTEGER pos={};
+		pos.QuadPart = (LONGLONG)m_PlayHeader.indexoffset;
+		if (!SetFilePointerEx(m_hPlayFile, pos, NULL, FILE_BEGIN)
+			|| !ReadFile(m_hPlayFile, m_PlayIndex.data(), dwIndex, &dwRead, NULL)
+			|| dwRead != dwIndex) {
+			SpoutLogError("spoutRecorder::OpenRecording - could not read the index of %s", filepath);
+			CloseRecording();
+			return false;
+		}
+	}
+
+	// Frames are read through a mapped view
+	if (m_PlayHeader.frames > 0) {
+		m_hPlayMapping = CreateFileMappingA(m_hPlayFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!m_hPlayMapping) {
+			SpoutLogError("spoutRecorder::OpenRecording - could not map %s (%d)", filepath, GetLastError());
+			CloseRecording();
+			return false;
+		}
+	}
+	m_PlayFrame = 0;
+
+	header = m_PlayHeader;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetRecordingFrames
+// Number of frames in the open recording
+unsigned __int64 spoutRecorder::GetRecordingFrames()
+{
+	return m_PlayIndex.size();
+}
+
+//---------------------------------------------------------
+// Function: ReadRecordedFrame
+// Read a frame of the open recording.
+//
+//   The buffer must be the frame size of the header
+//   (pitch x height). Rows are in the sender format.
+bool spoutRecorder::ReadRecordedFrame(unsigned __int64 index, unsigned char* pixels, SpoutRecordIndex* pEntry)
+{
+	if (!pixels)
+		return false;
+
+	const unsigned char* pFrame = GetFrameView(index);
+	if (!pFrame)
+		return false;
+
+	const SpoutRecordIndex &entry = m_PlayIndex[(size_t)index];
+	memcpy(pixels, pFrame, entry.size);
+
+	if (pEntry)
+		*pEntry = entry;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SendRecordedFrame
+// Send a frame of the open recording.
+//
+//   The sender is created with the recording size and format.
+//   Set the sender name with SetSenderName before the first frame.
+bool spoutRecorder::SendRecordedFrame(unsigned __int64 index)
+{
+	const unsigned char* pFrame = GetFrameView(index);
+	if (!pFrame)
+		return false;
+
+	if (!OpenDirectX11())
+		return false;
+
+	// Upload staging textures of the recording size and format
+	if (!m_pPlayStaging[0] || !m_pPlayStaging[1]) {
+		for (int i = 0; i < 2; i++) {
+			if (!spoutdx.CreateDX11StagingTexture(m_pd3dDevice, m_PlayHeader.width, m_PlayHeader.height,
+				(DXGI_FORMAT)m_PlayHeader.format, &m_pPlayStaging[i])) {
+				SpoutLogError("spoutRecorder::SendRecordedFrame - could not create staging textures");
+				return false;
+			}
+		}
+	}
+
+	// Write to the staging texture not used for the last frame
+	// so that Map does not wait for the copy to the sender texture
+	m_PlayStagingIndex = (m_PlayStagingIndex + 1) % 2;
+	ID3D11Texture2D* pStaging = m_pPlayStaging[m_PlayStagingIndex];
+	D3D11_MAPPED_SUBRESOURCE mapped={};
+	if (FAILED(m_pImmediateContext->Map(pStaging, 0, D3D11_MAP_WRITE, 0, &mapped)))
+		return false;
+
+	const unsigned int pitch = m_PlayHeader.pitch;
+	unsigned char* pDest = (unsigned char*)mapped.pData;
+	if (mapped.RowPitch == pitch) {
+		memcpy(pDest, pFrame, m_PlayHeader.framesize);
+	}
+	else {
+		for (unsigned int y = 0; y < m_PlayHeader.height; y++)
+			memcpy(pDest + (size_t)y*mapped.RowPitch, pFrame + (size_t)y*pitch, pitch);
+	}
+	m_pImmediateContext->Unmap(pStaging, 0);
+
+	// Read the next frames from disk while this one is sent
+	PrefetchFrames(index + 1, SPOUT_PLAY_PREFETCH);
+
+	return SendTexture(pStaging);
+}
+
+//---------------------------------------------------------
+// Function: PlayRecording
+// Send the next frame at the recorded frame rate.
+//
+//   Call in a loop. HoldFps waits for the recorded frame rate.
+//   Returns false at the end if not looping, or if a frame cannot be sent.
+bool spoutRecorder::PlayRecording(bool bLoop)
+{
+	if (m_PlayIndex.empty())
+		return false;
+
+	if (m_PlayFrame >= m_PlayIndex.size()) {
+		if (!bLoop)
+			return false;
+		m_PlayFrame = 0;
+	}
+
+	if (!SendRecordedFrame(m_PlayFrame))
+		return false;
+	m_PlayFrame++;
+
+	const double fps = GetRecordingFps();
+	if (fps > 0.0)
+		HoldFps((int)(fps + 0.5));
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SetPlayFrame
+// Set the frame to send next
+void spoutRecorder::SetPlayFrame(unsigned __int64 index)
+{
+	m_PlayFrame = index;
+}
+
+//---------------------------------------------------------
+// Function: GetPlayFrame
+// Frame to send next
+unsigned __int64 spoutRecorder::GetPlayFrame()
+{
+	return m_PlayFrame;
+}
+
+//---------------------------------------------------------
+// Function: GetRecordingFps
+// Average frame rate of the open recording.
+//
+//   From the timestamps of the first and last frames.
+//   Zero if there are less than two frames.
+double spoutRecorder::GetRecordingFps()
+{
+	if (m_PlayIndex.size() < 2 || m_PlayHeader.frequency <= 0)
+		return 0.0;
+
+	const LONG64 elapsed = m_PlayIndex.back().timestamp - m_PlayIndex.front().timestamp;
+	if (elapsed <= 0)
+		return 0.0;
+
+	return (double)(m_PlayIndex.size() - 1)*(double)m_PlayHeader.frequency/(double)elapsed;
+}
+
+//---------------------------------------------------------
+// Function: CloseRecording
+// Close the open recording
+void spoutRecorder::CloseRecording()
+{
+	ReleasePlayView();
+	if (m_hPlayMapping)
+		CloseHandle(m_hPlayMapping);
+	m_hPlayMapping = NULL;
+	for (int i = 0; i < 2; i++) {
+		if (m_pPlayStaging[i])
+			spoutdx.ReleaseDX11Texture(m_pd3dDevice, m_pPlayStaging[i]);
+		m_pPlayStaging[i] = nullptr;
+	}
+	m_PlayFrame = 0;
+	if (m_hPlayFile)
+		CloseHandle(m_hPlayFile);
+	m_hPlayFile = NULL;
+	m_PlayIndex.clear();
+	ZeroMemory(&m_PlayHeader, sizeof(m_PlayHeader));
+}
+
+//
+// Protected
+//
+
+// Create and allocate the file for the sender size and format
+bool spoutRecorder::CreateRecordFile()
+{
+	const unsigned int pitch = m_Width*GetFormatBytes(m_dwFormat);
+	const unsigned __int64 framesize = (unsigned __int64)pitch*m_Height;
+	const unsigned __int64 slotsize = (framesize + SPOUT_RECORD_ALIGN - 1) & ~((unsigned __int64)SPOUT_RECORD_ALIGN - 1);
+	if (framesize == 0 || slotsize > MAXDWORD) {
+		SpoutLogError("spoutRecorder::CreateRecordFile - %dx%d frames cannot be recorded", m_Width, m_Height);
+		return false;
+	}
+
+	// Writes go directly to the disk and do not wait for completion
+	m_hRecordFile = CreateFileA(m_RecordPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, NULL);
+	if (m_hRecordFile == INVALID_HANDLE_VALUE) {
+		m_hRecordFile = NULL;
+		SpoutLogError("spoutRecorder::CreateRecordFile - could not create %s (%d)", m_RecordPath, GetLastError());
+		return false;
+	}
+
+	// Allocate the file for all frames and the index
+	const unsigned __int64 indexbytes = m_MaxFrames*sizeof(SpoutRecordIndex);
+	FILE_END_OF_FILE_INFO eof={};
+	eof.EndOfFile.QuadPart = (LONGLONG)(SPOUT_RECORD_ALIGN + m_MaxFrames*slotsize
+		+ ((indexbytes + SPOUT_RECORD_ALIGN - 1) & ~((unsigned __int64)SPOUT_RECORD_ALIGN - 1)));
+	if (!SetFileInformationByHandle(m_hRecordFile, FileEndOfFileInfo, &eof, sizeof(eof))) {
+		SpoutLogError("spoutRecorder::CreateRecordFile - could not allocate %lld bytes", eof.EndOfFile.QuadPart);
+		ReleaseRecord();
+		return false;
+	}
+
+	// Without a valid data length, writes beyond it are held
+	// while the file system writes zeros up to the write position.
+	// SetFileValidData needs the volume maintenance privilege.
+	HANDLE hToken = NULL;
+	if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken)) {
+		TOKEN_PRIVILEGES tp={};
+		tp.PrivilegeCount = 1;
+		tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+		if (LookupPrivilegeValueA(NULL, "SeManageVolumePrivilege", &tp.Privileges[0].Luid))
+			AdjustTokenPrivileges(hToken, FALSE, &tp, 0, NULL, NULL);
+		CloseHandle(hToken);
+	}
+	if (!SetFileValidData(m_hRecordFile, eof.EndOfFile.QuadPart))
+		SpoutLogNotice("spoutRecorder::CreateRecordFile - valid data length not set (%d). Run as administrator for full speed.", GetLastError());
+
+	// Page aligned write buffers
+	for (int i = 0; i < SPOUT_RECORD_BUFFERS; i++) {
+		m_pRecordBuffer[i] = (unsigned char*)VirtualAlloc(nullptr, (SIZE_T)slotsize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		m_RecordOverlap[i].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		m_bRecordPending[i] = false;
+		if (!m_pRecordBuffer[i] || !m_RecordOverlap[i].hEvent) {
+			SpoutLogError("spoutRecorder::CreateRecordFile - could not create write buffers");
+			ReleaseRecord();
+			return false;
+		}
+	}
+
+	ZeroMemory(&m_RecordHeader, sizeof(m_RecordHeader));
+	memcpy(m_RecordHeader.id, "SPOUTREC", 8);
+	m_RecordHeader.version = SPOUT_RECORD_VERSION;
+	m_RecordHeader.width = m_Width;
+	m_RecordHeader.height = m_Height;
+	m_RecordHeader.format = m_dwFormat;
+	m_RecordHeader.pitch = pitch;
+	m_RecordHeader.framesize = (unsigned int)framesize;
+	m_RecordHeader.slotsize = slotsize;
+	LARGE_INTEGER frequency={};
+	QueryPerformanceFrequency(&frequency);
+	m_RecordHeader.frequency = frequency.QuadPart;
+
+	SpoutLogNotice("spoutRecorder::CreateRecordFile - %s, %dx%d, %llu frames", m_RecordPath, m_Width, m_Height, m_MaxFrames);
+
+	m_bRecordStarted = true;
+
+	return true;
+}
+
+// Copy a mapped staging texture to the next buffer and start the write
+bool spoutRecorder::WriteFrame(const D3D11_MAPPED_SUBRESOURCE &mapped, LONG64 framenumber, LONG64 timestamp)
+{
+	if (m_RecordIndex.size() >= m_MaxFrames) {
+		SpoutLogWarning("spoutRecorder::WriteFrame - %llu frames recorded, file is full", m_MaxFrames);
+		return false;
+	}
+
+	const int b = (int)(m_RecordIndex.size() % SPOUT_RECORD_BUFFERS);
+	if (m_bRecordPending[b]) {
+		if (!HasOverlappedIoCompleted(&m_RecordOverlap[b]))
+			m_RecordStalls++;
+		if (!WaitRecordBuffer(b))
+			return false;
+	}
+
+	// Remove the row padding of the staging texture
+	const unsigned int pitch = m_RecordHeader.pitch;
+	const unsigned char* pSource = (const unsigned char*)mapped.pData;
+	unsigned char* pDest = m_pRecordBuffer[b];
+	if (mapped.RowPitch == pitch) {
+		memcpy(pDest, pSource, m_RecordHeader.framesize);
+	}
+	else {
+		for (unsigned int y = 0; y < m_RecordHeader.height; y++)
+			memcpy(pDest + (size_t)y*pitch, pSource + (size_t)y*mapped.RowPitch, pitch);
+	}
+
+	SpoutRecordIndex entry={};
+	entry.frame = framenumber;
+	entry.timestamp = timestamp;
+	entry.offset = SPOUT_RECORD_ALIGN + m_RecordIndex.size()*m_RecordHeader.slotsize;
+	entry.size = m_RecordHeader.framesize;
+
+	// The whole slot is written so that the size is sector aligned
+	const HANDLE hEvent = m_RecordOverlap[b].hEvent;
+	ZeroMemory(&m_RecordOverlap[b], sizeof(OVERLAPPED));
+	m_RecordOverlap[b].hEvent = hEvent;
+	m_RecordOverlap[b].Offset = (DWORD)(entry.offset & 0xFFFFFFFF);
+	m_RecordOverlap[b].OffsetHigh = (DWORD)(entry.offset >> 32);
+	if (!WriteFile(m_hRecordFile, pDest, (DWORD)m_RecordHeader.slotsize, NULL, &m_RecordOverlap[b])
+		&& GetLastError() != ERROR_IO_PENDING) {
+		SpoutLogError("spoutRecorder::WriteFrame - write failed (%d)", GetLastError());
+		return false;
+	}
+	m_bRecordPending[b] = true;
+
+	// Sender frames missed since the last one written
+	if (m_LastFrame > 0 && framenumber > m_LastFrame + 1)
+		m_RecordDropped += (unsigned __int64)(framenumber - m_LastFrame - 1);
+	m_LastFrame = framenumber;
+
+	m_RecordIndex.push_back(entry);
+
+	return true;
+}
+
+// Write an aligned buffer and wait for completion
+bool spoutRecorder::WriteAligned(unsigned char* buffer, DWORD size, unsigned __int64 offset)
+{
+	OVERLAPPED ov={};
+	ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!ov.hEvent)
+		return false;
+	ov.Offset = (DWORD)(offset & 0xFFFFFFFF);
+	ov.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD dwWritten = 0;
+	bool bResult = (WriteFile(m_hRecordFile, buffer, size, NULL, &ov) || GetLastError() == ERROR_IO_PENDING);
+	if (bResult)
+		bResult = (GetOverlappedResult(m_hRecordFile, &ov, &dwWritten, TRUE) && dwWritten == size);
+	CloseHandle(ov.hEvent);
+	if (!bResult)
+		SpoutLogError("spoutRecorder::WriteAligned - write failed (%d)", GetLastError());
+	return bResult;
+}
+
+// Wait for the write of a buffer to complete
+bool spoutRecorder::WaitRecordBuffer(int index)
+{
+	if (!m_bRecordPending[index])
+		return true;
+
+	m_bRecordPending[index] = false;
+	DWORD dwWritten = 0;
+	if (!GetOverlappedResult(m_hRecordFile, &m_RecordOverlap[index], &dwWritten, TRUE)) {
+		SpoutLogError("spoutRecorder::WaitRecordBuffer - write failed (%d)", GetLastError());
+		return false;
+	}
+	return true;
+}
+
+// Close the file and free the write buffers
+void spoutRecorder::ReleaseRecord()
+{
+	if (m_hRecordFile)
+		CloseHandle(m_hRecordFile);
+	m_hRecordFile = NULL;
+
+	for (int i = 0; i < SPOUT_RECORD_BUFFERS; i++) {
+		if (m_pRecordBuffer[i])
+			VirtualFree(m_pRecordBuffer[i], 0, MEM_RELEASE);
+		m_pRecordBuffer[i] = nullptr;
+		if (m_RecordOverlap[i].hEvent)
+			CloseHandle(m_RecordOverlap[i].hEvent);
+		ZeroMemory(&m_RecordOverlap[i], sizeof(OVERLAPPED));
+		m_bRecordPending[i] = false;
+	}
+
+	m_bRecordStarted = false;
+	m_bRecording = false;
+}
+
+// Mapped frame of the open recording.
+// A view of a window of frames is mapped when the frame is not in the current view.
+const unsigned char* spoutRecorder::GetFrameView(unsigned __int64 index)
+{
+	if (!m_hPlayMapping || index >= m_PlayIndex.size())
+		return nullptr;
+
+	const SpoutRecordIndex &entry = m_PlayIndex[(size_t)index];
+	if (!m_pPlayView || entry.offset < m_PlayViewOffset
+		|| entry.offset + entry.size > m_PlayViewOffset + m_PlayViewSize) {
+
+		ReleasePlayView();
+
+		// Views start at a multiple of the allocation granularity
+		SYSTEM_INFO info={};
+		GetSystemInfo(&info);
+		const unsigned __int64 start = entry.offset & ~((unsigned __int64)info.dwAllocationGranularity - 1);
+
+		// A window of frames, less for large frames
+		unsigned __int64 frames = SPOUT_PLAY_WINDOW;
+		while (frames > 1 && frames*m_PlayHeader.slotsize > SPOUT_PLAY_VIEW_MAX)
+			frames--;
+		unsigned __int64 last = index + frames - 1;
+		if (last >= m_PlayIndex.size())
+			last = m_PlayIndex.size() - 1;
+		const unsigned __int64 end = m_PlayIndex[(size_t)last].offset + m_PlayIndex[(size_t)last].size;
+
+		m_pPlayView = (const unsigned char*)MapViewOfFile(m_hPlayMapping, FILE_MAP_READ,
+			(DWORD)(start >> 32), (DWORD)(start & 0xFFFFFFFF), (SIZE_T)(end - start));
+		if (!m_pPlayView) {
+			SpoutLogError("spoutRecorder::GetFrameView - could not map frame %llu (%d)", index, GetLastError());
+			return nullptr;
+		}
+		m_PlayViewOffset = start;
+		m_PlayViewSize = end - start;
+
+		PrefetchFrames(index, SPOUT_PLAY_PREFETCH);
+	}
+
+	return m_pPlayView + (entry.offset - m_PlayViewOffset);
+}
+
+// Read frames of the current view from disk before they are used
+void spoutRecorder::PrefetchFrames(unsigned __int64 index, unsigned __int64 count)
+{
+	if (!m_pPrefetchVirtualMemory || !m_pPlayView || index >= m_PlayIndex.size())
+		return;
+
+	unsigned __int64 last = index + count - 1;
+	if (last >= m_PlayIndex.size())
+		last = m_PlayIndex.size() - 1;
+
+	// Frames in the view
+	unsigned __int64 start = m_PlayIndex[(size_t)index].offset;
+	unsigned __int64 end = m_PlayIndex[(size_t)last].offset + m_PlayIndex[(size_t)last].size;
+	if (start < m_PlayViewOffset)
+		start = m_PlayViewOffset;
+	if (end > m_PlayViewOffset + m_PlayViewSize)
+		end = m_PlayViewOffset + m_PlayViewSize;
+	if (end <= start)
+		return;
+
+	SpoutMemoryRange range={};
+	range.VirtualAddress = (PVOID)(m_pPlayView + (start - m_PlayViewOffset));
+	range.NumberOfBytes = (SIZE_T)(end - start);
+	m_pPrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+// Unmap the view of the open recording
+void spoutRecorder::ReleasePlayView()
+{
+	if (m_pPlayView)
+		UnmapViewOfFile(m_pPlayView);
+	m_pPlayView = nullptr;
+	m_PlayViewOffset = 0;
+	m_PlayViewSize = 0;
+}
+
+// Bytes per pixel of a sender format
+unsigned int spoutRecorder::GetFormatBytes(DWORD dwFormat)
+{
+	switch (dwFormat) {
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+			return 8;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			return 16;
+		default:
+			return 4;
+	}
+}
@@ -0,0 +1,181 @@
+/*
+
+	spoutRecorder.h
+
+	Functions to record a Spout sender to disk as raw frames
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutRecorder__
+#define __spoutRecorder__
+
+#include "..\SpoutDX.h" // Base class
+#include <vector>
+
+// File alignment of the header, frames and index.
+// Unbuffered writes must be multiples of the volume sector size.
+#define SPOUT_RECORD_ALIGN 4096
+// Frame writes that can be in progress at once
+#define SPOUT_RECORD_BUFFERS 8
+// Recording file version
+#define SPOUT_RECORD_VERSION 1
+// Frames of a recording mapped at once for play back
+#define SPOUT_PLAY_WINDOW 32
+// Largest view of a recording mapped at once
+#define SPOUT_PLAY_VIEW_MAX (256*1024*1024)
+// Frames read ahead of the frame sent
+#define SPOUT_PLAY_PREFETCH 4
+
+//
+// Recording file header (first SPOUT_RECORD_ALIGN bytes of the file)
+//
+struct SpoutRecordHeader {
+	char id[8]; // "SPOUTREC"
+	unsigned int version; // SPOUT_RECORD_VERSION
+	unsigned int width; // Frame width
+	unsigned int height; // Frame height
+	DWORD format; // DXGI format of the frames
+	unsigned int pitch; // Bytes per row of frame data
+	unsigned int framesize; // Bytes of frame data
+	unsigned __int64 slotsize; // File bytes for each frame
+	unsigned __int64 frames; // Number of frames recorded
+	unsigned __int64 indexoffset; // File position of the frame index
+	LONG64 frequency; // Performance counter frequency of the timestamps
+};
+
+//
+// Frame index entry, one for each frame recorded
+//
+struct SpoutRecordIndex {
+	LONG64 frame; // Sender frame number
+	LONG64 timestamp; // Performance counter when received
+	unsigned __int64 offset; // File position of the frame
+	unsigned int size; // Bytes of frame data
+	unsigned int reserved;
+};
+
+class spoutRecorder : public spoutDX {
+
+	public:
+
+		spoutRecorder();
+		~spoutRecorder();
+
+		//
+		// Record
+		//
+
+		// Start recording to a file with space for a number of frames
+		bool StartRecording(const char* filepath, unsigned int maxframes);
+		// Receive from the sender and write a new frame
+		bool Record();
+		// Complete the file and stop recording
+		void StopRecording();
+		// Recording in progress
+		bool IsRecording();
+		// Frames written
+		unsigned __int64 GetRecordedFrames();
+		// Writes that had to wait for a buffer
+		unsigned __int64 GetRecordStalls();
+		// Sender frames missed
+		unsigned __int64 GetRecordDropped();
+
+		//
+		// Play back
+		//
+
+		// Open a recording to read frames
+		bool OpenRecording(const char* filepath, SpoutRecordHeader &header);
+		// Number of frames in the open recording
+		unsigned __int64 GetRecordingFrames();
+		// Read a frame of the open recording
+		bool ReadRecordedFrame(unsigned __int64 index, unsigned char* pixels, SpoutRecordIndex* pEntry = nullptr);
+		// Send a frame of the open recording
+		bool SendRecordedFrame(unsigned __int64 index);
+		// Send the next frame at the recorded frame rate
+		bool PlayRecording(bool bLoop = true);
+		// Set the frame to send next
+		void SetPlayFrame(unsigned __int64 index);
+		// Frame to send next
+		unsigned __int64 GetPlayFrame();
+		// Average frame rate of the open recording
+		double GetRecordingFps();
+		// Close the open recording
+		void CloseRecording();
+
+	protected:
+
+		// Record
+		char m_RecordPath[MAX_PATH];
+		HANDLE m_hRecordFile;
+		bool m_bRecording;
+		bool m_bRecordStarted; // File created for the first frame
+		unsigned __int64 m_MaxFrames;
+		SpoutRecordHeader m_RecordHeader;
+		std::vector<SpoutRecordIndex> m_RecordIndex;
+		unsigned char* m_pRecordBuffer[SPOUT_RECORD_BUFFERS];
+		OVERLAPPED m_RecordOverlap[SPOUT_RECORD_BUFFERS];
+		bool m_bRecordPending[SPOUT_RECORD_BUFFERS];
+		unsigned __int64 m_RecordStalls;
+		unsigned __int64 m_RecordDropped;
+		// Frame number and time of each staging texture
+		LONG64 m_StagedFrame[2];
+		LONG64 m_StagedTime[2];
+		LONG64 m_LastFrame;
+
+		bool CreateRecordFile();
+		bool WriteFrame(const D3D11_MAPPED_SUBRESOURCE &mapped, LONG64 framenumber, LONG64 timestamp);
+		bool WriteAligned(unsigned char* buffer, DWORD size, unsigned __int64 offset);
+		bool WaitRecordBuffer(int index);
+		void ReleaseRecord();
+		unsigned int GetFormatBytes(DWORD dwFormat);
+
+		// Play back
+		HANDLE m_hPlayFile;
+		HANDLE m_hPlayMapping;
+		SpoutRecordHeader m_PlayHeader;
+		std::vector<SpoutRecordIndex> m_PlayIndex;
+		const unsigned char* m_pPlayView; // Mapped view of a window of frames
+		unsigned __int64 m_PlayViewOffset; // File position of the view
+		unsigned __int64 m_PlayViewSize; // Bytes of the view
+		unsigned __int64 m_PlayFrame; // Frame to send next
+		ID3D11Texture2D* m_pPlayStaging[2]; // Upload staging textures
+		int m_PlayStagingIndex;
+
+		// PrefetchVirtualMemory (Windows 8 and later)
+		struct SpoutMemoryRange {
+			PVOID VirtualAddress;
+			SIZE_T NumberOfBytes;
+		};
+		typedef BOOL(WINAPI* PrefetchVirtualMemoryPROC)(HANDLE, ULONG_PTR, SpoutMemoryRange*, ULONG);
+		PrefetchVirtualMemoryPROC m_pPrefetchVirtualMemory;
+
+		const unsigned char* GetFrameView(unsigned __int64 index);
+		void PrefetchFrames(unsigned __int64 index, unsigned __int64 count);
+		void ReleasePlayView();
+
+};
+
+#endif
@@ -0,0 +1,835 @@
+//
+//		spoutVK.cpp
+//
+//		Functions to manage Vulkan texture sharing by way of external memory
+//		Base class spoutDX for sending and receiving functions.
+//
+// ====================================================================================
+//		Revisions :
+//		14.10.26	- Start class. Sender shared textures are imported as Vulkan
+//					  images by VK_KHR_external_memory_win32 and copied on the
+//					  application queue. A D3D11 fence imported as a Vulkan
+//					  timeline semaphore orders the Vulkan copy with D3D11.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutVK.h"
+
+//
+// Class: spoutVK
+//
+// Functions to manage Vulkan texture sharing by way of external memory.
+//
+// Base class is spoutDX for D3D11 and Spout functions.
+//
+// The sender shared texture is created or opened by a class D3D11 device on the
+// same adapter as the Vulkan device, and imported as a Vulkan image from the
+// share handle. Copy to or from the application image is made on the application
+// Vulkan queue without transfer by way of OpenGL or system memory.
+//
+// D3D11 and Vulkan work is ordered on the GPU by a shared D3D11 fence that is
+// imported as a Vulkan timeline semaphore. The sender mutex, frame counting
+// and sender names are managed by the base class.
+//
+// Calls must be made from the thread that submits to the application queue.
+//
+// Refer to source code for further details.
+//
+
+spoutVK::spoutVK() {
+
+	m_vkPhysicalDevice = VK_NULL_HANDLE;
+	m_vkDevice = VK_NULL_HANDLE;
+	m_vkQueue = VK_NULL_HANDLE;
+	m_vkQueueFamily = 0;
+	m_bVulkan = false;
+
+	m_pfnGetMemoryWin32HandleProperties = nullptr;
+	m_pfnImportSemaphoreWin32Handle = nullptr;
+
+	m_vkCommandPool = VK_NULL_HANDLE;
+	for (int i = 0; i < SPOUT_VK_FRAMES; i++) {
+		m_vkCommandBuffer[i] = VK_NULL_HANDLE;
+		m_vkFence[i] = VK_NULL_HANDLE;
+	}
+	m_vkFrame = 0;
+
+	m_pFence11 = nullptr;
+	m_pContext4 = nullptr;
+	m_vkSemaphore = VK_NULL_HANDLE;
+	m_FenceValue = 0;
+
+	m_vkSharedImage = VK_NULL_HANDLE;
+	m_vkSharedMemory = VK_NULL_HANDLE;
+	m_vkShareHandle = nullptr;
+	m_vkSharedFormat = VK_FORMAT_UNDEFINED;
+
+}
+
+spoutVK::~spoutVK() {
+
+	CloseVulkan();
+
+}
+
+//
+// Group: Vulkan
+//
+
+// Function: OpenVulkan
+// Initialize Vulkan using the application device and queue.
+//
+// The device must be created for Vulkan 1.2 or later with the timelineSemaphore
+// feature and the VK_KHR_external_memory_win32 and VK_KHR_external_semaphore_win32
+// extensions enabled. A class D3D11 device is created on the same adapter.
+bool spoutVK::OpenVulkan(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex)
+{
+	if (m_bVulkan)
+		return true;
+
+	if (physicalDevice == VK_NULL_HANDLE || device == VK_NULL_HANDLE || queue == VK_NULL_HANDLE) {
+		SpoutLogError("spoutVK::OpenVulkan - null device or queue");
+		return false;
+	}
+
+	m_vkPhysicalDevice = physicalDevice;
+	m_vkDevice = device;
+	m_vkQueue = queue;
+	m_vkQueueFamily = queueFamilyIndex;
+
+	// Extension functions
+	m_pfnGetMemoryWin32HandleProperties = reinterpret_cast<PFN_vkGetMemoryWin32HandlePropertiesKHR>(
+		vkGetDeviceProcAddr(device, "vkGetMemoryWin32HandlePropertiesKHR"));
+	m_pfnImportSemaphoreWin32Handle = reinterpret_cast<PFN_vkImportSemaphoreWin32HandleKHR>(
+		vkGetDeviceProcAddr(device, "vkImportSemaphoreWin32HandleKHR"));
+	if (!m_pfnGetMemoryWin32HandleProperties || !m_pfnImportSemaphoreWin32Handle) {
+		SpoutLogError("spoutVK::OpenVulkan - external memory or semaphore win32 extension not enabled");
+		CloseVulkan();
+		return false;
+	}
+
+	// The D3D11 device must use the same adapter as the Vulkan device
+	VkPhysicalDeviceIDProperties idProps = {};
+	idProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+	VkPhysicalDeviceProperties2 props = {};
+	props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	props.pNext = &idProps;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+	if (idProps.deviceLUIDValid && !m_pd3dDevice) {
+		LUID luid = {};
+		memcpy(&luid, idProps.deviceLUID, sizeof(LUID));
+		IDXGIFactory4* pFactory4 = nullptr;
+		IDXGIAdapter* pAdapter = nullptr;
+		if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&pFactory4)))) {
+			pFactory4->EnumAdapterByLuid(luid, IID_PPV_ARGS(&pAdapter));
+			pFactory4->Release();
+		}
+		if (pAdapter)
+			spoutdx.SetAdapterPointer(pAdapter); // Released by spoutdx
+	}
+
+	// Class D3D11 device for the shared texture and fence
+	if (!OpenDirectX11()) {
+		SpoutLogError("spoutVK::OpenVulkan - could not create DX11 device");
+		CloseVulkan();
+		return false;
+	}
+
+	if (!CreateVkCommands() || !CreateVkFence()) {
+		CloseVulkan();
+		return false;
+	}
+
+	m_bVulkan = true;
+
+	SpoutLogNotice("spoutVK::OpenVulkan - %s", props.properties.deviceName);
+
+	return true;
+}
+
+// Function: CloseVulkan
+// Release Vulkan resources.
+// The application device and queue are not released.
+void spoutVK::CloseVulkan()
+{
+	if (m_vkDevice != VK_NULL_HANDLE) {
+		// Wait for submitted copies
+		for (int i = 0; i < SPOUT_VK_FRAMES; i++) {
+			if (m_vkFence[i] != VK_NULL_HANDLE)
+				vkWaitForFences(m_vkDevice, 1, &m_vkFence[i], VK_TRUE, 1000000000ULL);
+		}
+		ReleaseSharedImage();
+		ReleaseVkFence();
+		ReleaseVkCommands();
+	}
+
+	m_pfnGetMemoryWin32HandleProperties = nullptr;
+	m_pfnImportSemaphoreWin32Handle = nullptr;
+	m_vkPhysicalDevice = VK_NULL_HANDLE;
+	m_vkDevice = VK_NULL_HANDLE;
+	m_vkQueue = VK_NULL_HANDLE;
+	m_vkQueueFamily = 0;
+	m_bVulkan = false;
+}
+
+// Function: IsVulkanOpen
+// Vulkan is initialized
+bool spoutVK::IsVulkanOpen()
+{
+	return m_bVulkan;
+}
+
+//
+// Group: Sender
+//
+
+// Function: SendVkImage
+// Send a Vulkan image.
+//
+// The image is in the layout given and is returned to it after the copy.
+// An undefined layout is returned as VK_IMAGE_LAYOUT_GENERAL.
+// The image must have been created with VK_IMAGE_USAGE_TRANSFER_SRC_BIT.
+// If a semaphore is passed in, the copy waits for it to be signalled.
+bool spoutVK::SendVkImage(VkImage image, VkImageLayout layout,
+	unsigned int width, unsigned int height, VkFormat format,
+	VkSemaphore waitSemaphore)
+{
+	if (!m_bVulkan || image == VK_NULL_HANDLE || width == 0 || height == 0)
+		return false;
+
+	const DXGI_FORMAT dxformat = VkToDXGIformat(format);
+	if (dxformat == DXGI_FORMAT_UNKNOWN) {
+		SpoutLogWarning("spoutVK::SendVkImage - format %d not supported", (int)format);
+		return false;
+	}
+
+	// Create or update the sender
+	if (!CheckSender(width, height, (DWORD)dxformat))
+		return false;
+
+	// Import the shared texture if created or re-created
+	if (m_dxShareHandle != m_vkShareHandle) {
+		if (!ImportSharedTexture(m_dxShareHandle, width, height, DXGItoVkFormat(dxformat)))
+			return false;
+	}
+	if (m_vkSharedImage == VK_NULL_HANDLE)
+		return false;
+
+	// Check the sender mutex for access the shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		VkCommandBuffer commandBuffer = BeginVkCommands();
+		if (commandBuffer != VK_NULL_HANDLE) {
+			// Acquire the shared image from D3D11. The contents are replaced.
+			ImageBarrier(commandBuffer, image, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+			ImageBarrier(commandBuffer, m_vkSharedImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_QUEUE_FAMILY_EXTERNAL, m_vkQueueFamily);
+
+			VkImageCopy region = {};
+			region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.srcSubresource.layerCount = 1;
+			region.dstSubresource = region.srcSubresource;
+			region.extent.width = width;
+			region.extent.height = height;
+			region.extent.depth = 1;
+			vkCmdCopyImage(commandBuffer,
+				image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				m_vkSharedImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &region);
+
+			// Release the shared image to D3D11
+			ImageBarrier(commandBuffer, m_vkSharedImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+				m_vkQueueFamily, VK_QUEUE_FAMILY_EXTERNAL);
+			ImageBarrier(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				(layout == VK_IMAGE_LAYOUT_UNDEFINED) ? VK_IMAGE_LAYOUT_GENERAL : layout,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+
+			if (SubmitVkCommands(commandBuffer, waitSemaphore)) {
+				// Convert to the YUV texture if used.
+				// The D3D11 context waits for the Vulkan copy.
+				WriteYUV(m_pSharedTexture);
+				m_pImmediateContext->Flush();
+			}
+		}
+		// Signal a new frame while the mutex is locked
+		frame.SetNewFrame();
+		// Allow access to the shared texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	return true;
+}
+
+//
+// Group: Receiver
+//
+
+// Function: ReceiveVkImage
+// Receive a sender texture to a Vulkan image.
+//
+// The image is in the layout given and is returned to it after the copy.
+// An undefined layout is returned as VK_IMAGE_LAYOUT_GENERAL.
+// The image must have been created with VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+// If the image is a different size, the sender texture is scaled by vkCmdBlitImage.
+//
+// If the sender has changed, IsUpdated() returns true and the application
+// should re-create the image with the sender size and format. See GetSenderVkFormat.
+bool spoutVK::ReceiveVkImage(VkImage image, VkImageLayout layout, unsigned int width, unsigned int height)
+{
+	if (!m_bVulkan || image == VK_NULL_HANDLE || width == 0 || height == 0)
+		return false;
+
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		// Was the shared texture pointer retrieved ?
+		if (!m_pSharedTexture)
+			return false;
+
+		// Return to update the receiving image
+		if (m_bUpdated) {
+			ReleaseSharedImage();
+			return true;
+		}
+
+		// Import the sender shared texture
+		if (m_dxShareHandle != m_vkShareHandle) {
+			if (!ImportSharedTexture(m_dxShareHandle, m_Width, m_Height, DXGItoVkFormat((DXGI_FORMAT)m_dwFormat)))
+				return false;
+		}
+		if (m_vkSharedImage == VK_NULL_HANDLE)
+			return false;
+
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			// Check if the sender has produced a new frame.
+			if (frame.GetNewFrame()) {
+				VkCommandBuffer commandBuffer = BeginVkCommands();
+				if (commandBuffer != VK_NULL_HANDLE) {
+					// Acquire the shared image from D3D11
+					ImageBarrier(commandBuffer, m_vkSharedImage, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						VK_QUEUE_FAMILY_EXTERNAL, m_vkQueueFamily);
+					ImageBarrier(commandBuffer, image, layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+
+					if (width == m_Width && height == m_Height) {
+						VkImageCopy region = {};
+						region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+						region.srcSubresource.layerCount = 1;
+						region.dstSubresource = region.srcSubresource;
+						region.extent.width = width;
+						region.extent.height = height;
+						region.extent.depth = 1;
+						vkCmdCopyImage(commandBuffer,
+							m_vkSharedImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							1, &region);
+					}
+					else {
+						VkImageBlit region = {};
+						region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+						region.srcSubresource.layerCount = 1;
+						region.dstSubresource = region.srcSubresource;
+						region.srcOffsets[1].x = (int32_t)m_Width;
+						region.srcOffsets[1].y = (int32_t)m_Height;
+						region.srcOffsets[1].z = 1;
+						region.dstOffsets[1].x = (int32_t)width;
+						region.dstOffsets[1].y = (int32_t)height;
+						region.dstOffsets[1].z = 1;
+						vkCmdBlitImage(commandBuffer,
+							m_vkSharedImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							1, &region, VK_FILTER_LINEAR);
+					}
+
+					// Release the shared image to D3D11
+					ImageBarrier(commandBuffer, m_vkSharedImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+						m_vkQueueFamily, VK_QUEUE_FAMILY_EXTERNAL);
+					ImageBarrier(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						(layout == VK_IMAGE_LAYOUT_UNDEFINED) ? VK_IMAGE_LAYOUT_GENERAL : layout,
+						VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+
+					// The sender cannot write to the shared texture
+					// until the D3D11 context has waited for the copy
+					if (SubmitVkCommands(commandBuffer, VK_NULL_HANDLE))
+						m_pImmediateContext->Flush();
+				}
+			}
+			// Allow access to the shared texture
+			frame.AllowTextureAccess(m_pSharedTexture);
+		}
+		m_bConnected = true;
+
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseSharedImage();
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
+
+	// ReceiveVkImage fails if there is no sender or the connected sender closed.
+	return m_bConnected;
+}
+
+// Function: GetSharedImage
+// The sender shared texture imported as a Vulkan image.
+//
+// The image is valid until the sender changes and is in the general layout
+// owned by VK_QUEUE_FAMILY_EXTERNAL. Access outside SendVkImage or
+// ReceiveVkImage must be synchronised by the application.
+VkImage spoutVK::GetSharedImage()
+{
+	return m_vkSharedImage;
+}
+
+// Function: GetSenderVkFormat
+// Received sender texture format
+VkFormat spoutVK::GetSenderVkFormat()
+{
+	return DXGItoVkFormat((DXGI_FORMAT)m_dwFormat);
+}
+
+// Function: GetVkSemaphore
+// Timeline semaphore signalled by the Vulkan copy.
+// The application can wait for GetVkSemaphoreValue before re-using a sent image.
+VkSemaphore spoutVK::GetVkSemaphore()
+{
+	return m_vkSemaphore;
+}
+
+// Function: GetVkSemaphoreValue
+// Semaphore value of the last copy
+UINT64 spoutVK::GetVkSemaphoreValue()
+{
+	return m_FenceValue;
+}
+
+//
+// Group: Formats
+//
+
+// Function: DXGItoVkFormat
+// Vulkan format for a DXGI format.
+// VK_FORMAT_UNDEFINED if there is no equivalent.
+VkFormat spoutVK::DXGItoVkFormat(DXGI_FORMAT format)
+{
+	switch (format) {
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM: // Alpha is ignored
+			return VK_FORMAT_B8G8R8A8_UNORM;
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+			return VK_FORMAT_B8G8R8A8_SRGB;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			return VK_FORMAT_R8G8B8A8_SRGB;
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+			return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+			return VK_FORMAT_R16G16B16A16_UNORM;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			return VK_FORMAT_R16G16B16A16_SFLOAT;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			return VK_FORMAT_R32G32B32A32_SFLOAT;
+		default:
+			return VK_FORMAT_UNDEFINED;
+	}
+}
+
+// Function: VkToDXGIformat
+// DXGI format for a Vulkan format.
+// DXGI_FORMAT_UNKNOWN if there is no equivalent.
+DXGI_FORMAT spoutVK::VkToDXGIformat(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_B8G8R8A8_UNORM:
+			return DXGI_FORMAT_B8G8R8A8_UNORM;
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+			return DXGI_FORMAT_R10G10B10A2_UNORM;
+		case VK_FORMAT_R16G16B16A16_UNORM:
+			return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default:
+			return DXGI_FORMAT_UNKNOWN;
+	}
+}
+
+//
+// Protected
+//
+
+// Command pool and a ring of command buffers, each with a fence
+// that is signalled when the command buffer can be used again
+bool spoutVK::CreateVkCommands()
+{
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = m_vkQueueFamily;
+	if (vkCreateCommandPool(m_vkDevice, &poolInfo, nullptr, &m_vkCommandPool) != VK_SUCCESS) {
+		SpoutLogError("spoutVK::CreateVkCommands - could not create command pool");
+		return false;
+	}
+
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = m_vkCommandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = SPOUT_VK_FRAMES;
+	if (vkAllocateCommandBuffers(m_vkDevice, &allocInfo, m_vkCommandBuffer) != VK_SUCCESS) {
+		SpoutLogError("spoutVK::CreateVkCommands - could not allocate command buffers");
+		return false;
+	}
+
+	// Fences are created signalled for the first use
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	for (int i = 0; i < SPOUT_VK_FRAMES; i++) {
+		if (vkCreateFence(m_vkDevice, &fenceInfo, nullptr, &m_vkFence[i]) != VK_SUCCESS) {
+			SpoutLogError("spoutVK::CreateVkCommands - could not create fence");
+			return false;
+		}
+	}
+	m_vkFrame = 0;
+
+	return true;
+}
+
+void spoutVK::ReleaseVkCommands()
+{
+	for (int i = 0; i < SPOUT_VK_FRAMES; i++) {
+		if (m_vkFence[i] != VK_NULL_HANDLE)
+			vkDestroyFence(m_vkDevice, m_vkFence[i], nullptr);
+		m_vkFence[i] = VK_NULL_HANDLE;
+		m_vkCommandBuffer[i] = VK_NULL_HANDLE; // Freed with the pool
+	}
+	if (m_vkCommandPool != VK_NULL_HANDLE)
+		vkDestroyCommandPool(m_vkDevice, m_vkCommandPool, nullptr);
+	m_vkCommandPool = VK_NULL_HANDLE;
+	m_vkFrame = 0;
+}
+
+// Shared D3D11 fence imported as a Vulkan timeline semaphore
+bool spoutVK::CreateVkFence()
+{
+	ID3D11Device5* pDevice5 = nullptr;
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (FAILED(hr)) {
+		SpoutLogError("spoutVK::CreateVkFence - ID3D11Device5 not available");
+		return false;
+	}
+
+	HANDLE hFence = NULL;
+	hr = pDevice5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pFence11));
+	pDevice5->Release();
+	if (SUCCEEDED(hr))
+		hr = m_pFence11->CreateSharedHandle(NULL, GENERIC_ALL, NULL, &hFence);
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pContext4));
+	if (FAILED(hr)) {
+		SpoutLogError("spoutVK::CreateVkFence - could not create D3D11 fence (0x%.7X)", (unsigned int)hr);
+		if (hFence) CloseHandle(hFence);
+		return false;
+	}
+
+	VkSemaphoreTypeCreateInfo typeInfo = {};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+	VkResult result = vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &m_vkSemaphore);
+	if (result == VK_SUCCESS) {
+		// The D3D12 fence handle type is also used for D3D11 fences
+		VkImportSemaphoreWin32HandleInfoKHR importInfo = {};
+		importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR;
+		importInfo.semaphore = m_vkSemaphore;
+		importInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_D3D12_FENCE_BIT;
+		importInfo.handle = hFence;
+		result = m_pfnImportSemaphoreWin32Handle(m_vkDevice, &importInfo);
+	}
+
+	// Importing does not transfer ownership of an NT handle
+	CloseHandle(hFence);
+
+	if (result != VK_SUCCESS) {
+		SpoutLogError("spoutVK::CreateVkFence - could not import fence (%d)", (int)result);
+		return false;
+	}
+
+	m_FenceValue = 0;
+
+	return true;
+}
+
+void spoutVK::ReleaseVkFence()
+{
+	if (m_vkSemaphore != VK_NULL_HANDLE)
+		vkDestroySemaphore(m_vkDevice, m_vkSemaphore, nullptr);
+	m_vkSemaphore = VK_NULL_HANDLE;
+	if (m_pContext4) m_pContext4->Release();
+	m_pContext4 = nullptr;
+	if (m_pFence11) m_pFence11->Release();
+	m_pFence11 = nullptr;
+	m_FenceValue = 0;
+}
+
+// Import a D3D11 shared texture handle as a Vulkan image.
+// The image is created with the same size and format as the texture.
+// The handle is retained even if the import fails so that it is not tried again.
+bool spoutVK::ImportSharedTexture(HANDLE dxShareHandle, unsigned int width, unsigned int height, VkFormat format)
+{
+	ReleaseSharedImage();
+	m_vkShareHandle = dxShareHandle;
+
+	if (!dxShareHandle || format == VK_FORMAT_UNDEFINED) {
+		SpoutLogWarning("spoutVK::ImportSharedTexture - no handle or format not supported (%d)", (int)m_dwFormat);
+		return false;
+	}
+
+	// Legacy share handles of Spout shared textures
+	const VkExternalMemoryHandleTypeFlagBits handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_KMT_BIT;
+
+	VkExternalMemoryImageCreateInfo externalInfo = {};
+	externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
+	externalInfo.handleTypes = handleType;
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.pNext = &externalInfo;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (vkCreateImage(m_vkDevice, &imageInfo, nullptr, &m_vkSharedImage) != VK_SUCCESS) {
+		SpoutLogWarning("spoutVK::ImportSharedTexture - could not create image");
+		m_vkSharedImage = VK_NULL_HANDLE;
+		return false;
+	}
+
+	// Memory types that can import the handle
+	VkMemoryWin32HandlePropertiesKHR handleProps = {};
+	handleProps.sType = VK_STRUCTURE_TYPE_MEMORY_WIN32_HANDLE_PROPERTIES_KHR;
+	if (m_pfnGetMemoryWin32HandleProperties(m_vkDevice, handleType, dxShareHandle, &handleProps) != VK_SUCCESS) {
+		SpoutLogWarning("spoutVK::ImportSharedTexture - handle 0x%.7X not supported", PtrToUint(dxShareHandle));
+		ReleaseSharedImage();
+		return false;
+	}
+
+	VkMemoryRequirements requirements = {};
+	vkGetImageMemoryRequirements(m_vkDevice, m_vkSharedImage, &requirements);
+	uint32_t memoryBits = requirements.memoryTypeBits & handleProps.memoryTypeBits;
+	if (memoryBits == 0)
+		memoryBits = handleProps.memoryTypeBits;
+	uint32_t memoryType = 0;
+	while (memoryType < 32 && !(memoryBits & (1u << memoryType)))
+		memoryType++;
+	if (memoryType == 32) {
+		SpoutLogWarning("spoutVK::ImportSharedTexture - no memory type");
+		ReleaseSharedImage();
+		return false;
+	}
+
+	// Shared textures require a dedicated allocation
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = {};
+	dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+	dedicatedInfo.image = m_vkSharedImage;
+
+	VkImportMemoryWin32HandleInfoKHR importInfo = {};
+	importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR;
+	importInfo.pNext = &dedicatedInfo;
+	importInfo.handleType = handleType;
+	importInfo.handle = dxShareHandle;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.pNext = &importInfo;
+	allocInfo.allocationSize = requirements.size;
+	allocInfo.memoryTypeIndex = memoryType;
+	if (vkAllocateMemory(m_vkDevice, &allocInfo, nullptr, &m_vkSharedMemory) != VK_SUCCESS
+		|| vkBindImageMemory(m_vkDevice, m_vkSharedImage, m_vkSharedMemory, 0) != VK_SUCCESS) {
+		SpoutLogWarning("spoutVK::ImportSharedTexture - could not import handle 0x%.7X", PtrToUint(dxShareHandle));
+		ReleaseSharedImage();
+		return false;
+	}
+
+	m_vkSharedFormat = format;
+
+	SpoutLogNotice("spoutVK::ImportSharedTexture - %dx%d, format %d, handle 0x%.7X",
+		width, height, (int)format, PtrToUint(dxShareHandle));
+
+	return true;
+}
+
+void spoutVK::ReleaseSharedImage()
+{
+	if (m_vkDevice != VK_NULL_HANDLE && (m_vkSharedImage != VK_NULL_HANDLE || m_vkSharedMemory != VK_NULL_HANDLE)) {
+		// Copies using the image must be complete
+		for (int i = 0; i < SPOUT_VK_FRAMES; i++) {
+			if (m_vkFence[i] != VK_NULL_HANDLE)
+				vkWaitForFences(m_vkDevice, 1, &m_vkFence[i], VK_TRUE, 1000000000ULL);
+		}
+		if (m_vkSharedImage != VK_NULL_HANDLE)
+			vkDestroyImage(m_vkDevice, m_vkSharedImage, nullptr);
+		if (m_vkSharedMemory != VK_NULL_HANDLE)
+			vkFreeMemory(m_vkDevice, m_vkSharedMemory, nullptr);
+	}
+	m_vkSharedImage = VK_NULL_HANDLE;
+	m_vkSharedMemory = VK_NULL_HANDLE;
+	m_vkShareHandle = nullptr;
+	m_vkSharedFormat = VK_FORMAT_UNDEFINED;
+}
+
+// Begin the next command buffer of the ring.
+// Wait only if the last submission of that command buffer is not complete.
+VkCommandBuffer spoutVK::BeginVkCommands()
+{
+	const int slot = m_vkFrame;
+	if (vkWaitForFences(m_vkDevice, 1, &m_vkFence[slot], VK_TRUE, 1000000000ULL) != VK_SUCCESS) {
+		SpoutLogWarning("spoutVK::BeginVkCommands - timeout waiting for command buffer %d", slot);
+		return VK_NULL_HANDLE;
+	}
+	vkResetFences(m_vkDevice, 1, &m_vkFence[slot]);
+
+	VkCommandBuffer commandBuffer = m_vkCommandBuffer[slot];
+	vkResetCommandBuffer(commandBuffer, 0);
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	return commandBuffer;
+}
+
+// Submit a command buffer begun by BeginVkCommands.
+//
+// The D3D11 context signals the shared fence for the Vulkan submission
+// to wait on, and waits for the value signalled when the submission is
+// complete. Neither the CPU or GPU waits, and D3D11 commands that use the
+// shared texture after this are ordered after the Vulkan copy.
+bool spoutVK::SubmitVkCommands(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore)
+{
+	const int slot = m_vkFrame;
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		// The fence was reset, so submit nothing to signal it again
+		vkQueueSubmit(m_vkQueue, 0, nullptr, m_vkFence[slot]);
+		return false;
+	}
+
+	// Prior D3D11 work on the shared texture
+	const UINT64 waitValue = m_FenceValue + 1;
+	m_pContext4->Signal(m_pFence11, waitValue);
+	m_pImmediateContext->Flush();
+
+	const UINT64 signalValue = waitValue + 1;
+	VkSemaphore waitSemaphores[2] = { m_vkSemaphore, waitSemaphore };
+	UINT64 waitValues[2] = { waitValue, 0 }; // A binary semaphore value is ignored
+	VkPipelineStageFlags waitStages[2] = { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+	const uint32_t waitCount = (waitSemaphore != VK_NULL_HANDLE) ? 2 : 1;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = waitCount;
+	timelineInfo.pWaitSemaphoreValues = waitValues;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = waitCount;
+	submitInfo.pWaitSemaphores = waitSemaphores;
+	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &m_vkSemaphore;
+
+	m_FenceValue = waitValue;
+	if (vkQueueSubmit(m_vkQueue, 1, &submitInfo, m_vkFence[slot]) != VK_SUCCESS) {
+		SpoutLogWarning("spoutVK::SubmitVkCommands - submit failed");
+		vkQueueSubmit(m_vkQueue, 0, nullptr, m_vkFence[slot]);
+		return false;
+	}
+	m_FenceValue = signalValue;
+	m_vkFrame = (slot + 1) % SPOUT_VK_FRAMES;
+
+	// Following D3D11 work waits for the copy
+	m_pContext4->Wait(m_pFence11, signalValue);
+
+	return true;
+}
+
+// Image layout transition with optional transfer of queue family ownership
+void spoutVK::ImageBarrier(VkCommandBuffer commandBuffer, VkImage image,
+	VkImageLayout oldLayout, VkImageLayout newLayout,
+	uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
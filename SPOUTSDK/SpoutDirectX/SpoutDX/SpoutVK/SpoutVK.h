@@ -0,0 +1,128 @@
+/*
+
+	spoutVK.h
+
+	Functions to manage Vulkan texture sharing by way of external memory
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutVK__
+#define __spoutVK__
+
+#include "..\SpoutDX.h" // Base class
+
+#define VK_USE_PLATFORM_WIN32_KHR // for external memory and semaphore win32 handles
+#include <vulkan/vulkan.h>
+#include <dxgi1_4.h> // for IDXGIFactory4::EnumAdapterByLuid
+#pragma comment (lib, "vulkan-1.lib") // Vulkan loader
+#pragma comment (lib, "DXGI.lib") // for CreateDXGIFactory1
+
+// Number of command buffers for sending and receiving
+#define SPOUT_VK_FRAMES 3
+
+class spoutVK : public spoutDX {
+
+	public:
+
+		spoutVK();
+		~spoutVK();
+
+		// Initialize Vulkan with the application device and queue.
+		// The device must be Vulkan 1.2 with timeline semaphores and the extensions
+		// VK_KHR_external_memory_win32 and VK_KHR_external_semaphore_win32 enabled.
+		bool OpenVulkan(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex);
+		// Release Vulkan resources
+		void CloseVulkan();
+		// Vulkan is initialized
+		bool IsVulkanOpen();
+
+		// Send a Vulkan image in the given layout.
+		// The copy waits for the semaphore if one is passed in.
+		bool SendVkImage(VkImage image, VkImageLayout layout,
+			unsigned int width, unsigned int height, VkFormat format,
+			VkSemaphore waitSemaphore = VK_NULL_HANDLE);
+		// Receive a sender texture to a Vulkan image in the given layout.
+		// The image should be the sender size and format and re-created if IsUpdated() is true.
+		bool ReceiveVkImage(VkImage image, VkImageLayout layout, unsigned int width, unsigned int height);
+		// The sender shared texture imported as a Vulkan image
+		VkImage GetSharedImage();
+		// Received sender texture format
+		VkFormat GetSenderVkFormat();
+		// Timeline semaphore signalled when a copy is complete
+		VkSemaphore GetVkSemaphore();
+		// Semaphore value of the last copy
+		UINT64 GetVkSemaphoreValue();
+
+		// Vulkan format for a DXGI format
+		static VkFormat DXGItoVkFormat(DXGI_FORMAT format);
+		// DXGI format for a Vulkan format
+		static DXGI_FORMAT VkToDXGIformat(VkFormat format);
+
+	protected:
+
+		// Application Vulkan objects
+		VkPhysicalDevice m_vkPhysicalDevice;
+		VkDevice m_vkDevice;
+		VkQueue m_vkQueue;
+		uint32_t m_vkQueueFamily;
+		bool m_bVulkan;
+
+		// Extension functions
+		PFN_vkGetMemoryWin32HandlePropertiesKHR m_pfnGetMemoryWin32HandleProperties;
+		PFN_vkImportSemaphoreWin32HandleKHR m_pfnImportSemaphoreWin32Handle;
+
+		// Command buffers
+		VkCommandPool m_vkCommandPool;
+		VkCommandBuffer m_vkCommandBuffer[SPOUT_VK_FRAMES];
+		VkFence m_vkFence[SPOUT_VK_FRAMES]; // Signalled when the command buffer can be used again
+		int m_vkFrame; // Next command buffer
+
+		// Shared fence for D3D11 and Vulkan
+		ID3D11Fence* m_pFence11;
+		ID3D11DeviceContext4* m_pContext4; // For D3D11 fence signal and wait
+		VkSemaphore m_vkSemaphore; // The fence imported as a timeline semaphore
+		UINT64 m_FenceValue; // Last fence value signalled
+
+		// Shared texture imported by Vulkan
+		VkImage m_vkSharedImage;
+		VkDeviceMemory m_vkSharedMemory;
+		HANDLE m_vkShareHandle; // Handle of the imported texture
+		VkFormat m_vkSharedFormat;
+
+		bool CreateVkCommands();
+		void ReleaseVkCommands();
+		bool CreateVkFence();
+		void ReleaseVkFence();
+		bool ImportSharedTexture(HANDLE dxShareHandle, unsigned int width, unsigned int height, VkFormat format);
+		void ReleaseSharedImage();
+		VkCommandBuffer BeginVkCommands();
+		bool SubmitVkCommands(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore);
+		void ImageBarrier(VkCommandBuffer commandBuffer, VkImage image,
+			VkImageLayout oldLayout, VkImageLayout newLayout,
+			uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+
+};
+
+#endif
@@ -0,0 +1,1710 @@
+//
+//		spoutVirtualCam.cpp
+//
+//		Windows 11 Media Foundation virtual camera of a Spout sender
+//		Base class spoutDX for the D3D11 device and Spout functions.
+//
+// ====================================================================================
+//		Revisions :
+//		15.10.26	- Start class. A media source for MFCreateVirtualCamera receives
+//					  the sender on the Frame Server device and converts it to NV12
+//					  DXGI surface samples with the D3D11 video processor.
+//					  There is no CPU pixel path.
+//					- The media source runs in session 0 and cannot open the sender.
+//					  Add a session bridge created by the media source in the global
+//					  namespace and written by a thread of the application.
+//
+// ====================================================================================
+/*
+
+	Copyright (c) 2026. Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SpoutVirtualCam.h"
+
+//
+// Class: spoutVirtualCam
+//
+// Windows 11 Media Foundation virtual camera of a Spout sender.
+//
+// SpoutCam is a DirectShow filter and reads every frame back to the CPU.
+// The spoutMediaSource class is a Media Foundation media source which
+// Windows 11 presents as a camera to all applications by MFCreateVirtualCamera.
+// The Frame Server creates the source from its class ID and passes the
+// D3D11 device used for camera samples. The Frame Server is a service
+// in session 0 and cannot open the sender of the user session, so the
+// source creates a session bridge texture in the global namespace.
+// The spoutVirtualCam class of the application receives the active
+// sender and writes it to the bridge texture on the GPU. The source
+// converts the bridge texture with the D3D11 video processor to NV12
+// (BT.709, studio range) at the camera resolution selected by the
+// application. The NV12 textures are passed as DXGI surface samples.
+// Pixels are not read back to the CPU.
+//
+// The source is built into a COM dll (SpoutVirtualCam.def) registered
+// with regsvr32. The application adds and removes the camera with the
+// spoutVirtualCam class and must be running for the camera to show the sender.
+//
+// Refer to source code for further details.
+//
+
+// Capture pin category (PINNAME_VIDEO_CAPTURE)
+static const GUID g_PinCategoryCapture =
+	{ 0xfb6c4281, 0x0353, 0x11d1, { 0x90, 0x5f, 0x00, 0x00, 0xc0, 0xcc, 0x16, 0xba } };
+
+// Camera resolutions offered, the first is the default
+static const unsigned int g_CamSizes[][2] = { {1920, 1080}, {1280, 720}, {640, 360} };
+
+// Objects and server locks for DllCanUnloadNow
+static volatile LONG g_cObjects = 0;
+static volatile LONG g_cServerLocks = 0;
+
+// Hardware device of the default adapter with video support
+static HRESULT CreateVideoDevice(ID3D11Device** ppDevice)
+{
+	const UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT;
+	const D3D_FEATURE_LEVEL levels[] = { D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
+	HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
+		levels, 2, D3D11_SDK_VERSION, ppDevice, nullptr, nullptr);
+	if (SUCCEEDED(hr)) {
+		ID3D10Multithread* pMultithread = nullptr;
+		if (SUCCEEDED((*ppDevice)->QueryInterface(IID_PPV_ARGS(&pMultithread)))) {
+			pMultithread->SetMultithreadProtected(TRUE);
+			pMultithread->Release();
+		}
+	}
+	return hr;
+}
+
+
+//
+// spoutVirtualCamReceiver
+//
+
+spoutVirtualCamReceiver::spoutVirtualCamReceiver() {
+
+	m_pCamVideoDevice = nullptr;
+	m_pCamVideoContext = nullptr;
+	m_pCamEnum = nullptr;
+	m_pCamProcessor = nullptr;
+	m_pCamInputView = nullptr;
+	m_pCamSource = nullptr;
+	m_CamInputWidth = 0;
+	m_CamInputHeight = 0;
+	m_CamOutputWidth = 0;
+	m_CamOutputHeight = 0;
+
+	m_hBridgeMap = NULL;
+	m_pBridge = nullptr;
+	m_pBridgeTexture = nullptr;
+	m_pBridgeMutex = nullptr;
+	m_hBridgeShare = NULL;
+	m_BridgeGeneration = 0;
+	m_bBridgeCreated = false;
+	m_BridgeRetry = 0;
+
+}
+
+spoutVirtualCamReceiver::~spoutVirtualCamReceiver() {
+
+	CloseCamera();
+
+}
+
+//---------------------------------------------------------
+// Function: OpenCamera
+// Use the camera device for the sender and the conversion.
+//
+//   The device is owned by the caller.
+bool spoutVirtualCamReceiver::OpenCamera(ID3D11Device* pDevice)
+{
+	if (!pDevice)
+		return false;
+
+	if (m_pd3dDevice == pDevice)
+		return true;
+
+	CloseCamera();
+
+	if (!OpenDirectX11(pDevice) || !m_pImmediateContext)
+		return false;
+
+	HRESULT hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&m_pCamVideoDevice));
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(IID_PPV_ARGS(&m_pCamVideoContext));
+	if (FAILED(hr)) {
+		SpoutLogError("spoutVirtualCamReceiver::OpenCamera - no video device (0x%.7X)", (unsigned int)hr);
+		CloseCamera();
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveFrame
+// Convert the sender to a texture.
+//
+//   Used by the application to write the sender to the bridge texture.
+//   The sender is scaled to fit the texture size with the
+//   aspect ratio retained and the remainder is black.
+//   The texture is all black if there is no sender, so that
+//   the camera continues while the sender is not running.
+bool spoutVirtualCamReceiver::ReceiveFrame(ID3D11Texture2D* pOutput, UINT subresource)
+{
+	if (!pOutput || !m_pCamVideoDevice)
+		return false;
+
+	bool bSender = false;
+	if (ReceiveSenderData()) {
+		if (m_bUpdated) {
+			// The input view is created again for the new sender texture
+			if (m_pCamInputView) m_pCamInputView->Release();
+			m_pCamInputView = nullptr;
+			m_pCamSource = nullptr;
+			m_bUpdated = false;
+		}
+		m_bConnected = true;
+		bSender = (m_pSharedTexture != nullptr);
+	}
+	else if (m_bConnected) {
+		// The connected sender closed
+		ReleaseReceiver();
+		m_bConnected = false;
+	}
+
+	if (bSender && frame.CheckTextureAccess(m_pSharedTexture)) {
+		frame.GetNewFrame();
+		const bool bResult = ConvertFrame(m_pSharedTexture, m_Width, m_Height, pOutput, subresource);
+		frame.AllowTextureAccess(m_pSharedTexture);
+		return bResult;
+	}
+
+	return ConvertFrame(nullptr, 0, 0, pOutput, subresource);
+}
+
+//---------------------------------------------------------
+// Function: CloseCamera
+// Release the sender, the bridge, the conversion and the camera device.
+void spoutVirtualCamReceiver::CloseCamera()
+{
+	CloseBridge();
+	ReleaseCamProcessor();
+	if (m_pCamVideoContext) m_pCamVideoContext->Release();
+	if (m_pCamVideoDevice) m_pCamVideoDevice->Release();
+	m_pCamVideoContext = nullptr;
+	m_pCamVideoDevice = nullptr;
+
+	if (m_bConnected)
+		ReleaseReceiver();
+	m_bConnected = false;
+	if (m_pd3dDevice)
+		CloseDirectX11();
+}
+
+//
+// Session bridge
+//
+// The Frame Server service creates the media source in session 0.
+// Sender names and shared textures are created in the user session
+// and cannot be opened by the media source. The media source creates
+// a shared memory map and a named shared texture with a keyed mutex
+// in the global namespace, which requires the "Create global objects"
+// privilege of a service. The application opens them from the user
+// session and writes the sender to the texture on a thread.
+// The media source converts the texture to the camera samples.
+//
+
+//---------------------------------------------------------
+// Function: CreateBridge
+// Create the bridge map and texture on the camera device.
+//
+//   Called by the media source. Access is allowed for the system,
+//   local service and interactive users. The camera is black until
+//   the application writes a frame.
+bool spoutVirtualCamReceiver::CreateBridge()
+{
+	if (m_pBridge)
+		return true;
+
+	if (!m_pd3dDevice)
+		return false;
+
+	PSECURITY_DESCRIPTOR pSD = nullptr;
+	if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(L"D:(A;;GA;;;SY)(A;;GA;;;LS)(A;;GA;;;IU)",
+		SDDL_REVISION_1, &pSD, nullptr)) {
+		SpoutLogError("spoutVirtualCamReceiver::CreateBridge - could not create security descriptor (%d)", GetLastError());
+		return false;
+	}
+	SECURITY_ATTRIBUTES sa={};
+	sa.nLength = sizeof(SECURITY_ATTRIBUTES);
+	sa.lpSecurityDescriptor = pSD;
+	sa.bInheritHandle = FALSE;
+
+	m_bBridgeCreated = true;
+	m_hBridgeMap = CreateFileMappingW(INVALID_HANDLE_VALUE, &sa, PAGE_READWRITE,
+		0, sizeof(SpoutVirtualCamBridge), SPOUT_VIRTUALCAM_BRIDGE);
+	if (m_hBridgeMap) {
+		m_pBridge = static_cast<SpoutVirtualCamBridge*>(MapViewOfFile(m_hBridgeMap,
+			FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SpoutVirtualCamBridge)));
+	}
+	if (!m_pBridge) {
+		SpoutLogError("spoutVirtualCamReceiver::CreateBridge - could not create bridge map (%d)", GetLastError());
+		LocalFree(pSD);
+		CloseBridge();
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = SPOUT_VIRTUALCAM_WIDTH;
+	desc.Height = SPOUT_VIRTUALCAM_HEIGHT;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_NTHANDLE | D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX;
+	HRESULT hr = m_pd3dDevice->CreateTexture2D(&desc, nullptr, &m_pBridgeTexture);
+	if (SUCCEEDED(hr)) {
+		IDXGIResource1* pResource = nullptr;
+		hr = m_pBridgeTexture->QueryInterface(IID_PPV_ARGS(&pResource));
+		if (SUCCEEDED(hr)) {
+			hr = pResource->CreateSharedHandle(&sa, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+				SPOUT_VIRTUALCAM_FRAME, &m_hBridgeShare);
+			pResource->Release();
+		}
+	}
+	if (SUCCEEDED(hr))
+		hr = m_pBridgeTexture->QueryInterface(IID_PPV_ARGS(&m_pBridgeMutex));
+	LocalFree(pSD);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutVirtualCamReceiver::CreateBridge - could not create bridge texture (0x%.7X)", (unsigned int)hr);
+		CloseBridge();
+		return false;
+	}
+
+	// The application opens the new texture
+	m_pBridge->time = 0;
+	m_BridgeGeneration = InterlockedIncrement(&m_pBridge->generation);
+	InterlockedExchange(&m_pBridge->magic, SPOUT_VIRTUALCAM_MAGIC);
+
+	SpoutLogNotice("spoutVirtualCamReceiver::CreateBridge - %dx%d", SPOUT_VIRTUALCAM_WIDTH, SPOUT_VIRTUALCAM_HEIGHT);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: OpenBridge
+// Open the bridge created by the media source.
+//
+//   Called by the application for each frame. The bridge exists
+//   while an application uses the camera. It is opened again if the
+//   media source creates a new texture. The texture must be on the
+//   same graphics adapter as the application device.
+bool spoutVirtualCamReceiver::OpenBridge()
+{
+	if (m_pBridge) {
+		if (m_pBridge->magic == SPOUT_VIRTUALCAM_MAGIC && m_pBridge->generation == m_BridgeGeneration)
+			return (m_pBridgeTexture != nullptr);
+		// The media source closed or created a new texture
+		CloseBridge();
+	}
+
+	if (!m_pd3dDevice)
+		return false;
+
+	// No bridge until an application opens the camera
+	m_hBridgeMap = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, SPOUT_VIRTUALCAM_BRIDGE);
+	if (!m_hBridgeMap)
+		return false;
+	m_pBridge = static_cast<SpoutVirtualCamBridge*>(MapViewOfFile(m_hBridgeMap,
+		FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SpoutVirtualCamBridge)));
+	if (!m_pBridge || m_pBridge->magic != SPOUT_VIRTUALCAM_MAGIC) {
+		CloseBridge();
+		return false;
+	}
+
+	// Not tried again until the generation changes
+	m_BridgeGeneration = m_pBridge->generation;
+
+	ID3D11Device1* pDevice1 = nullptr;
+	HRESULT hr = m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pDevice1));
+	if (SUCCEEDED(hr)) {
+		hr = pDevice1->OpenSharedResourceByName(SPOUT_VIRTUALCAM_FRAME,
+			DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, IID_PPV_ARGS(&m_pBridgeTexture));
+		pDevice1->Release();
+	}
+	if (SUCCEEDED(hr))
+		hr = m_pBridgeTexture->QueryInterface(IID_PPV_ARGS(&m_pBridgeMutex));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutVirtualCamReceiver::OpenBridge - could not open bridge texture (0x%.7X)", (unsigned int)hr);
+		if (m_pBridgeTexture) m_pBridgeTexture->Release();
+		m_pBridgeTexture = nullptr;
+		m_pBridgeMutex = nullptr;
+		return false;
+	}
+
+	SpoutLogNotice("spoutVirtualCamReceiver::OpenBridge - opened");
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: WriteBridge
+// Write the sender to the bridge texture.
+//
+//   Called by the application. Black is written if there is no
+//   sender so that the media source knows the application is running.
+bool spoutVirtualCamReceiver::WriteBridge()
+{
+	if (!m_pBridge || !m_pBridgeTexture || !m_pBridgeMutex)
+		return false;
+
+	if (m_pBridgeMutex->AcquireSync(0, 1000/SPOUT_VIRTUALCAM_FPS) != S_OK)
+		return false;
+	const bool bResult = ReceiveFrame(m_pBridgeTexture, 0);
+	m_pBridgeMutex->ReleaseSync(0);
+
+	if (bResult)
+		m_pBridge->time = GetTickCount();
+
+	return bResult;
+}
+
+//---------------------------------------------------------
+// Function: ReadBridge
+// Convert the bridge texture to an NV12 texture.
+//
+//   Called by the media source for each camera sample.
+//   The bridge is created if it does not exist, at most once a second.
+//   The texture is black if the application has not written
+//   a frame within the last second.
+bool spoutVirtualCamReceiver::ReadBridge(ID3D11Texture2D* pOutput, UINT subresource)
+{
+	if (!pOutput || !m_pCamVideoDevice)
+		return false;
+
+	if (!m_pBridge && GetTickCount() - m_BridgeRetry > 1000) {
+		m_BridgeRetry = GetTickCount();
+		CreateBridge();
+	}
+
+	if (!m_pBridge || !m_pBridgeMutex || GetTickCount() - m_pBridge->time > 1000)
+		return ConvertFrame(nullptr, 0, 0, pOutput, subresource);
+
+	// The sample is not changed if the application holds the texture
+	if (m_pBridgeMutex->AcquireSync(0, 1000/SPOUT_VIRTUALCAM_FPS) != S_OK)
+		return true;
+	const bool bResult = ConvertFrame(m_pBridgeTexture, SPOUT_VIRTUALCAM_WIDTH, SPOUT_VIRTUALCAM_HEIGHT, pOutput, subresource);
+	m_pBridgeMutex->ReleaseSync(0);
+
+	return bResult;
+}
+
+//---------------------------------------------------------
+// Function: CloseBridge
+// Close the bridge.
+//
+//   The application closes the bridge when the media source that created it closes.
+void spoutVirtualCamReceiver::CloseBridge()
+{
+	if (m_pBridge && m_bBridgeCreated)
+		InterlockedExchange(&m_pBridge->magic, 0);
+
+	// The input and output views hold the bridge texture
+	if (m_pBridgeTexture)
+		ReleaseCamProcessor();
+	if (m_pBridgeMutex) m_pBridgeMutex->Release();
+	if (m_pBridgeTexture) m_pBridgeTexture->Release();
+	if (m_hBridgeShare) CloseHandle(m_hBridgeShare);
+	if (m_pBridge) UnmapViewOfFile(m_pBridge);
+	if (m_hBridgeMap) CloseHandle(m_hBridgeMap);
+	m_pBridgeMutex = nullptr;
+	m_pBridgeTexture = nullptr;
+	m_hBridgeShare = NULL;
+	m_pBridge = nullptr;
+	m_hBridgeMap = NULL;
+	m_BridgeGeneration = 0;
+	m_bBridgeCreated = false;
+}
+
+// Convert a texture to the output texture, black if there is no input.
+// The input is scaled to fit the output size with the aspect ratio retained.
+bool spoutVirtualCamReceiver::ConvertFrame(ID3D11Texture2D* pInput, unsigned int width, unsigned int height,
+	ID3D11Texture2D* pOutput, UINT subresource)
+{
+	D3D11_TEXTURE2D_DESC desc={};
+	pOutput->GetDesc(&desc);
+
+	bool bInput = (pInput && width > 0 && height > 0);
+
+	// Processor for the input and output sizes
+	const unsigned int inwidth = bInput ? width : desc.Width;
+	const unsigned int inheight = bInput ? height : desc.Height;
+	if (!m_pCamProcessor
+		|| inwidth != m_CamInputWidth || inheight != m_CamInputHeight
+		|| desc.Width != m_CamOutputWidth || desc.Height != m_CamOutputHeight) {
+		if (!CreateCamProcessor(inwidth, inheight, desc.Width, desc.Height))
+			return false;
+	}
+
+	ID3D11VideoProcessorOutputView* pView = GetCamOutputView(pOutput, subresource);
+	if (!pView)
+		return false;
+
+	// Input view of the texture
+	if (bInput && (pInput != m_pCamSource || !m_pCamInputView)) {
+		if (m_pCamInputView) m_pCamInputView->Release();
+		m_pCamInputView = nullptr;
+		m_pCamSource = nullptr;
+		D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC ivd={};
+		ivd.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+		const HRESULT hr = m_pCamVideoDevice->CreateVideoProcessorInputView(pInput, m_pCamEnum, &ivd, &m_pCamInputView);
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutVirtualCamReceiver::ConvertFrame - could not create input view (0x%.7X)", (unsigned int)hr);
+			m_pCamInputView = nullptr;
+			bInput = false;
+		}
+		else {
+			m_pCamSource = pInput;
+		}
+	}
+
+	// Input fitted to the output size
+	if (bInput) {
+		const double scale = (std::min)(static_cast<double>(desc.Width)/static_cast<double>(width),
+			static_cast<double>(desc.Height)/static_cast<double>(height));
+		const LONG dw = static_cast<LONG>(static_cast<double>(width)*scale) & ~1L;
+		const LONG dh = static_cast<LONG>(static_cast<double>(height)*scale) & ~1L;
+		RECT dest={};
+		dest.left = ((LONG)desc.Width - dw)/2 & ~1L;
+		dest.top = ((LONG)desc.Height - dh)/2 & ~1L;
+		dest.right = dest.left + dw;
+		dest.bottom = dest.top + dh;
+		m_pCamVideoContext->VideoProcessorSetStreamDestRect(m_pCamProcessor, 0, TRUE, &dest);
+	}
+
+	// A disabled stream fills the output with the background colour
+	D3D11_VIDEO_PROCESSOR_STREAM stream={};
+	stream.Enable = bInput ? TRUE : FALSE;
+	stream.pInputSurface = bInput ? m_pCamInputView : nullptr;
+	const HRESULT hr = m_pCamVideoContext->VideoProcessorBlt(m_pCamProcessor, pView, 0, 1, &stream);
+
+	return SUCCEEDED(hr);
+}
+
+// Video processor from the input size to the output size
+bool spoutVirtualCamReceiver::CreateCamProcessor(unsigned int inwidth, unsigned int inheight,
+	unsigned int outwidth, unsigned int outheight)
+{
+	ReleaseCamProcessor();
+
+	D3D11_VIDEO_PROCESSOR_CONTENT_DESC content={};
+	content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+	content.InputWidth   = inwidth;
+	content.InputHeight  = inheight;
+	content.OutputWidth  = outwidth;
+	content.OutputHeight = outheight;
+	content.Usage = D3D11_VIDEO_USAGE_OPTIMAL_SPEED;
+	HRESULT hr = m_pCamVideoDevice->CreateVideoProcessorEnumerator(&content, &m_pCamEnum);
+	if (SUCCEEDED(hr))
+		hr = m_pCamVideoDevice->CreateVideoProcessor(m_pCamEnum, 0, &m_pCamProcessor);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutVirtualCamReceiver::CreateCamProcessor - could not create video processor (0x%.7X)", (unsigned int)hr);
+		ReleaseCamProcessor();
+		return false;
+	}
+
+	// RGB full range in, BT.709 studio range out
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE incs={};
+	incs.RGB_Range = 0; // 0-255
+	D3D11_VIDEO_PROCESSOR_COLOR_SPACE outcs={};
+	outcs.YCbCr_Matrix = 1; // BT.709
+	outcs.Nominal_Range = D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+	m_pCamVideoContext->VideoProcessorSetStreamColorSpace(m_pCamProcessor, 0, &incs);
+	m_pCamVideoContext->VideoProcessorSetOutputColorSpace(m_pCamProcessor, &outcs);
+	m_pCamVideoContext->VideoProcessorSetStreamFrameFormat(m_pCamProcessor, 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+	m_pCamVideoContext->VideoProcessorSetStreamAutoProcessingMode(m_pCamProcessor, 0, FALSE);
+
+	// Black outside the sender
+	D3D11_VIDEO_COLOR black={};
+	black.YCbCr.Y = 16.0f/255.0f;
+	black.YCbCr.Cb = 0.5f;
+	black.YCbCr.Cr = 0.5f;
+	black.YCbCr.A = 1.0f;
+	m_pCamVideoContext->VideoProcessorSetOutputBackgroundColor(m_pCamProcessor, TRUE, &black);
+
+	m_CamInputWidth = inwidth;
+	m_CamInputHeight = inheight;
+	m_CamOutputWidth = outwidth;
+	m_CamOutputHeight = outheight;
+
+	return true;
+}
+
+// Output view of a camera sample texture.
+// The sample allocator recycles a small number of textures
+// so the views are retained until the camera size changes.
+ID3D11VideoProcessorOutputView* spoutVirtualCamReceiver::GetCamOutputView(ID3D11Texture2D* pOutput, UINT subresource)
+{
+	for (size_t i = 0; i < m_CamViews.size(); i++) {
+		if (m_CamViews[i].pTexture == pOutput && m_CamViews[i].subresource == subresource)
+			return m_CamViews[i].pView;
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pOutput->GetDesc(&desc);
+
+	D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC ovd={};
+	if (desc.ArraySize > 1) {
+		ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2DARRAY;
+		ovd.Texture2DArray.FirstArraySlice = subresource;
+		ovd.Texture2DArray.ArraySize = 1;
+	}
+	else {
+		ovd.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+	}
+
+	ID3D11VideoProcessorOutputView* pView = nullptr;
+	const HRESULT hr = m_pCamVideoDevice->CreateVideoProcessorOutputView(pOutput, m_pCamEnum, &ovd, &pView);
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutVirtualCamReceiver::GetCamOutputView - could not create output view (0x%.7X)", (unsigned int)hr);
+		return nullptr;
+	}
+
+	// The view holds a reference to the texture
+	CamOutputView view = { pOutput, subresource, pView };
+	m_CamViews.push_back(view);
+
+	return pView;
+}
+
+void spoutVirtualCamReceiver::ReleaseCamProcessor()
+{
+	for (size_t i = 0; i < m_CamViews.size(); i++)
+		m_CamViews[i].pView->Release();
+	m_CamViews.clear();
+	if (m_pCamInputView) m_pCamInputView->Release();
+	if (m_pCamProcessor) m_pCamProcessor->Release();
+	if (m_pCamEnum) m_pCamEnum->Release();
+	m_pCamInputView = nullptr;
+	m_pCamSource = nullptr;
+	m_pCamProcessor = nullptr;
+	m_pCamEnum = nullptr;
+	m_CamInputWidth = 0;
+	m_CamInputHeight = 0;
+	m_CamOutputWidth = 0;
+	m_CamOutputHeight = 0;
+}
+
+
+//
+// spoutMediaStream
+//
+
+spoutMediaStream::spoutMediaStream(spoutMediaSource* pSource) {
+
+	m_cRef = 1;
+	InitializeCriticalSection(&m_Lock);
+	m_pSource = pSource;
+	m_pSource->AddRef();
+	m_pEventQueue = nullptr;
+	m_pStreamDescriptor = nullptr;
+	m_State = MF_STREAM_STATE_STOPPED;
+	m_bShutdown = false;
+
+	m_pDeviceManager = nullptr;
+	m_pOwnManager = nullptr;
+	m_pOwnDevice = nullptr;
+	m_ResetToken = 0;
+	m_hDevice = NULL;
+	m_pAllocator = nullptr;
+	m_bReceiver = false;
+
+	InterlockedIncrement(&g_cObjects);
+
+}
+
+spoutMediaStream::~spoutMediaStream() {
+
+	Shutdown();
+	DeleteCriticalSection(&m_Lock);
+	InterlockedDecrement(&g_cObjects);
+
+}
+
+STDMETHODIMP spoutMediaStream::QueryInterface(REFIID riid, void** ppv)
+{
+	if (!ppv)
+		return E_POINTER;
+
+	if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFMediaEventGenerator)
+		|| riid == __uuidof(IMFMediaStream) || riid == __uuidof(IMFMediaStream2)) {
+		*ppv = static_cast<IMFMediaStream2*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*ppv = nullptr;
+	return E_NOINTERFACE;
+}
+
+STDMETHODIMP_(ULONG) spoutMediaStream::AddRef()
+{
+	return InterlockedIncrement(&m_cRef);
+}
+
+STDMETHODIMP_(ULONG) spoutMediaStream::Release()
+{
+	const ULONG count = InterlockedDecrement(&m_cRef);
+	if (count == 0)
+		delete this;
+	return count;
+}
+
+STDMETHODIMP spoutMediaStream::BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState)
+{
+	EnterCriticalSection(&m_Lock);
+	const HRESULT hr = m_bShutdown ? MF_E_SHUTDOWN : m_pEventQueue->BeginGetEvent(pCallback, punkState);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent)
+{
+	EnterCriticalSection(&m_Lock);
+	const HRESULT hr = m_bShutdown ? MF_E_SHUTDOWN : m_pEventQueue->EndGetEvent(pResult, ppEvent);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent)
+{
+	// Not within the lock, GetEvent can block
+	IMFMediaEventQueue* pQueue = nullptr;
+	EnterCriticalSection(&m_Lock);
+	if (!m_bShutdown) {
+		pQueue = m_pEventQueue;
+		pQueue->AddRef();
+	}
+	LeaveCriticalSection(&m_Lock);
+	if (!pQueue)
+		return MF_E_SHUTDOWN;
+	const HRESULT hr = pQueue->GetEvent(dwFlags, ppEvent);
+	pQueue->Release();
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue)
+{
+	EnterCriticalSection(&m_Lock);
+	const HRESULT hr = m_bShutdown ? MF_E_SHUTDOWN : m_pEventQueue->QueueEventParamVar(met, guidExtendedType, hrStatus, pvValue);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::GetMediaSource(IMFMediaSource** ppMediaSource)
+{
+	if (!ppMediaSource)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = MF_E_SHUTDOWN;
+	if (!m_bShutdown)
+		hr = m_pSource->QueryInterface(IID_PPV_ARGS(ppMediaSource));
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::GetStreamDescriptor(IMFStreamDescriptor** ppStreamDescriptor)
+{
+	if (!ppStreamDescriptor)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = MF_E_SHUTDOWN;
+	if (!m_bShutdown) {
+		*ppStreamDescriptor = m_pStreamDescriptor;
+		m_pStreamDescriptor->AddRef();
+		hr = S_OK;
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+//---------------------------------------------------------
+// Function: RequestSample
+// Queue an NV12 sample of the sender.
+//
+//   The Frame Server requests samples at the camera frame rate.
+//   A sample from the allocator is a DXGI surface of the
+//   Frame Server device which the bridge texture written
+//   by the application is converted to.
+STDMETHODIMP spoutMediaStream::RequestSample(IUnknown* pToken)
+{
+	EnterCriticalSection(&m_Lock);
+
+	HRESULT hr = S_OK;
+	if (m_bShutdown)
+		hr = MF_E_SHUTDOWN;
+	else if (m_State != MF_STREAM_STATE_RUNNING || !m_pAllocator)
+		hr = MF_E_INVALIDREQUEST;
+
+	IMFSample* pSample = nullptr;
+	IMFMediaBuffer* pBuffer = nullptr;
+	IMFDXGIBuffer* pDXGIBuffer = nullptr;
+	ID3D11Texture2D* pTexture = nullptr;
+	UINT subresource = 0;
+
+	if (SUCCEEDED(hr))
+		hr = m_pAllocator->AllocateSample(&pSample);
+	if (SUCCEEDED(hr))
+		hr = pSample->GetBufferByIndex(0, &pBuffer);
+	if (SUCCEEDED(hr))
+		hr = pBuffer->QueryInterface(IID_PPV_ARGS(&pDXGIBuffer));
+	if (SUCCEEDED(hr))
+		hr = pDXGIBuffer->GetResource(IID_PPV_ARGS(&pTexture));
+	if (SUCCEEDED(hr))
+		hr = pDXGIBuffer->GetSubresourceIndex(&subresource);
+
+	if (SUCCEEDED(hr)) {
+		// The device is locked while the immediate context is used
+		ID3D11Device* pDevice = nullptr;
+		hr = m_pDeviceManager->LockDevice(m_hDevice, IID_PPV_ARGS(&pDevice), TRUE);
+		if (SUCCEEDED(hr)) {
+			if (!m_Receiver.ReadBridge(pTexture, subresource))
+				SpoutLogWarning("spoutMediaStream::RequestSample - frame conversion failed");
+			m_pDeviceManager->UnlockDevice(m_hDevice, FALSE);
+			pDevice->Release();
+		}
+	}
+
+	if (SUCCEEDED(hr)) {
+		pSample->SetSampleTime(MFGetSystemTime());
+		pSample->SetSampleDuration(10000000LL/SPOUT_VIRTUALCAM_FPS);
+		if (pToken)
+			pSample->SetUnknown(MFSampleExtension_Token, pToken);
+		hr = m_pEventQueue->QueueEventParamUnk(MEMediaSample, GUID_NULL, S_OK, pSample);
+	}
+
+	if (pTexture) pTexture->Release();
+	if (pDXGIBuffer) pDXGIBuffer->Release();
+	if (pBuffer) pBuffer->Release();
+	if (pSample) pSample->Release();
+
+	LeaveCriticalSection(&m_Lock);
+
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::SetStreamState(MF_STREAM_STATE value)
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = S_OK;
+	if (m_bShutdown)
+		hr = MF_E_SHUTDOWN;
+	else if (value != m_State) {
+		if (value == MF_STREAM_STATE_STOPPED)
+			hr = Stop();
+		else if (value == MF_STREAM_STATE_RUNNING && m_pDeviceManager)
+			m_State = MF_STREAM_STATE_RUNNING;
+		else if (value == MF_STREAM_STATE_PAUSED && m_State == MF_STREAM_STATE_RUNNING)
+			m_State = MF_STREAM_STATE_PAUSED;
+		else
+			hr = MF_E_INVALID_STATE_TRANSITION;
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaStream::GetStreamState(MF_STREAM_STATE* value)
+{
+	if (!value)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	*value = m_State;
+	LeaveCriticalSection(&m_Lock);
+	return m_bShutdown ? MF_E_SHUTDOWN : S_OK;
+}
+
+// Event queue and stream descriptor with the NV12 camera types
+HRESULT spoutMediaStream::Initialize()
+{
+	HRESULT hr = MFCreateEventQueue(&m_pEventQueue);
+	if (FAILED(hr))
+		return hr;
+
+	IMFMediaType* pTypes[_countof(g_CamSizes)]={};
+	for (int i = 0; SUCCEEDED(hr) && i < _countof(g_CamSizes); i++) {
+		const UINT32 width = g_CamSizes[i][0];
+		const UINT32 height = g_CamSizes[i][1];
+		hr = MFCreateMediaType(&pTypes[i]);
+		if (SUCCEEDED(hr)) {
+			pTypes[i]->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+			pTypes[i]->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_NV12);
+			MFSetAttributeSize(pTypes[i], MF_MT_FRAME_SIZE, width, height);
+			MFSetAttributeRatio(pTypes[i], MF_MT_FRAME_RATE, SPOUT_VIRTUALCAM_FPS, 1);
+			MFSetAttributeRatio(pTypes[i], MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+			pTypes[i]->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+			pTypes[i]->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE);
+			pTypes[i]->SetUINT32(MF_MT_DEFAULT_STRIDE, width);
+			pTypes[i]->SetUINT32(MF_MT_SAMPLE_SIZE, width*height*3/2);
+			pTypes[i]->SetUINT32(MF_MT_VIDEO_NOMINAL_RANGE, MFNominalRange_16_235);
+			pTypes[i]->SetUINT32(MF_MT_YUV_MATRIX, MFVideoTransferMatrix_BT709);
+		}
+	}
+
+	if (SUCCEEDED(hr))
+		hr = MFCreateStreamDescriptor(0, _countof(g_CamSizes), pTypes, &m_pStreamDescriptor);
+
+	if (SUCCEEDED(hr)) {
+		IMFMediaTypeHandler* pHandler = nullptr;
+		hr = m_pStreamDescriptor->GetMediaTypeHandler(&pHandler);
+		if (SUCCEEDED(hr)) {
+			hr = pHandler->SetCurrentMediaType(pTypes[0]);
+			pHandler->Release();
+		}
+	}
+
+	// Stream attributes for the Frame Server
+	if (SUCCEEDED(hr)) {
+		m_pStreamDescriptor->SetGUID(MF_DEVICESTREAM_STREAM_CATEGORY, g_PinCategoryCapture);
+		m_pStreamDescriptor->SetUINT32(MF_DEVICESTREAM_STREAM_ID, 0);
+		m_pStreamDescriptor->SetUINT32(MF_DEVICESTREAM_FRAMESERVER_SHARED, 1);
+		m_pStreamDescriptor->SetUINT32(MF_DEVICESTREAM_ATTRIBUTE_FRAMESOURCE_TYPES, MFFrameSourceTypes_Color);
+	}
+
+	for (int i = 0; i < _countof(g_CamSizes); i++) {
+		if (pTypes[i]) pTypes[i]->Release();
+	}
+
+	return hr;
+}
+
+// Start with the current media type of the stream descriptor
+HRESULT spoutMediaStream::Start(IMFDXGIDeviceManager* pManager)
+{
+	EnterCriticalSection(&m_Lock);
+
+	HRESULT hr = m_bShutdown ? MF_E_SHUTDOWN : S_OK;
+
+	IMFMediaType* pType = nullptr;
+	if (SUCCEEDED(hr)) {
+		IMFMediaTypeHandler* pHandler = nullptr;
+		hr = m_pStreamDescriptor->GetMediaTypeHandler(&pHandler);
+		if (SUCCEEDED(hr)) {
+			hr = pHandler->GetCurrentMediaType(&pType);
+			pHandler->Release();
+		}
+	}
+
+	if (SUCCEEDED(hr))
+		hr = CreateStreamDevice(pManager);
+
+	// NV12 render target samples of the camera size
+	if (SUCCEEDED(hr) && !m_pAllocator)
+		hr = MFCreateVideoSampleAllocatorEx(IID_PPV_ARGS(&m_pAllocator));
+	if (SUCCEEDED(hr)) {
+		m_pAllocator->UninitializeSampleAllocator();
+		hr = m_pAllocator->SetDirectXManager(m_pDeviceManager);
+	}
+	if (SUCCEEDED(hr)) {
+		IMFAttributes* pAttributes = nullptr;
+		hr = MFCreateAttributes(&pAttributes, 2);
+		if (SUCCEEDED(hr)) {
+			pAttributes->SetUINT32(MF_SA_D3D11_BINDFLAGS, D3D11_BIND_RENDER_TARGET);
+			pAttributes->SetUINT32(MF_SA_D3D11_USAGE, D3D11_USAGE_DEFAULT);
+			hr = m_pAllocator->InitializeSampleAllocatorEx(2, SPOUT_VIRTUALCAM_SAMPLES, pAttributes, pType);
+			pAttributes->Release();
+		}
+	}
+
+	if (SUCCEEDED(hr)) {
+		m_State = MF_STREAM_STATE_RUNNING;
+		PROPVARIANT time;
+		PropVariantInit(&time);
+		time.vt = VT_I8;
+		time.hVal.QuadPart = MFGetSystemTime();
+		hr = m_pEventQueue->QueueEventParamVar(MEStreamStarted, GUID_NULL, S_OK, &time);
+		UINT32 width = 0;
+		UINT32 height = 0;
+		MFGetAttributeSize(pType, MF_MT_FRAME_SIZE, &width, &height);
+		SpoutLogNotice("spoutMediaStream::Start - %ux%u NV12", width, height);
+	}
+	else {
+		SpoutLogError("spoutMediaStream::Start - failed (0x%.7X)", (unsigned int)hr);
+	}
+
+	if (pType) pType->Release();
+
+	LeaveCriticalSection(&m_Lock);
+
+	return hr;
+}
+
+HRESULT spoutMediaStream::Stop()
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = MF_E_SHUTDOWN;
+	if (!m_bShutdown) {
+		m_State = MF_STREAM_STATE_STOPPED;
+		hr = m_pEventQueue->QueueEventParamVar(MEStreamStopped, GUID_NULL, S_OK, nullptr);
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+void spoutMediaStream::Shutdown()
+{
+	EnterCriticalSection(&m_Lock);
+	if (!m_bShutdown) {
+		m_bShutdown = true;
+		m_State = MF_STREAM_STATE_STOPPED;
+		ReleaseStreamDevice();
+		if (m_pEventQueue) {
+			m_pEventQueue->Shutdown();
+			m_pEventQueue->Release();
+			m_pEventQueue = nullptr;
+		}
+		if (m_pStreamDescriptor) m_pStreamDescriptor->Release();
+		m_pStreamDescriptor = nullptr;
+		// Release the source to break the reference cycle
+		if (m_pSource) m_pSource->Release();
+		m_pSource = nullptr;
+	}
+	LeaveCriticalSection(&m_Lock);
+}
+
+bool spoutMediaStream::IsActive()
+{
+	return (m_State != MF_STREAM_STATE_STOPPED);
+}
+
+// Device of the Frame Server device manager, or a device
+// with video support and a device manager created for it
+HRESULT spoutMediaStream::CreateStreamDevice(IMFDXGIDeviceManager* pManager)
+{
+	if (m_bReceiver && (!pManager || pManager == m_pDeviceManager))
+		return S_OK;
+
+	ReleaseStreamDevice();
+
+	HRESULT hr = S_OK;
+	if (pManager) {
+		m_pDeviceManager = pManager;
+		m_pDeviceManager->AddRef();
+	}
+	else {
+		hr = CreateVideoDevice(&m_pOwnDevice);
+		if (SUCCEEDED(hr))
+			hr = MFCreateDXGIDeviceManager(&m_ResetToken, &m_pOwnManager);
+		if (SUCCEEDED(hr))
+			hr = m_pOwnManager->ResetDevice(m_pOwnDevice, m_ResetToken);
+		if (FAILED(hr)) {
+			SpoutLogError("spoutMediaStream::CreateStreamDevice - could not create device (0x%.7X)", (unsigned int)hr);
+			ReleaseStreamDevice();
+			return hr;
+		}
+		m_pDeviceManager = m_pOwnManager;
+		m_pDeviceManager->AddRef();
+	}
+
+	ID3D11Device* pDevice = nullptr;
+	hr = m_pDeviceManager->OpenDeviceHandle(&m_hDevice);
+	if (SUCCEEDED(hr))
+		hr = m_pDeviceManager->GetVideoService(m_hDevice, IID_PPV_ARGS(&pDevice));
+	if (SUCCEEDED(hr)) {
+		m_bReceiver = m_Receiver.OpenCamera(pDevice);
+		pDevice->Release(); // The device manager holds the device
+		if (!m_bReceiver)
+			hr = E_FAIL;
+	}
+	if (FAILED(hr)) {
+		SpoutLogError("spoutMediaStream::CreateStreamDevice - could not use the device (0x%.7X)", (unsigned int)hr);
+		ReleaseStreamDevice();
+	}
+
+	return hr;
+}
+
+void spoutMediaStream::ReleaseStreamDevice()
+{
+	if (m_pAllocator) {
+		m_pAllocator->UninitializeSampleAllocator();
+		m_pAllocator->Release();
+		m_pAllocator = nullptr;
+	}
+	m_Receiver.CloseCamera();
+	m_bReceiver = false;
+	if (m_pDeviceManager) {
+		if (m_hDevice)
+			m_pDeviceManager->CloseDeviceHandle(m_hDevice);
+		m_pDeviceManager->Release();
+	}
+	m_hDevice = NULL;
+	m_pDeviceManager = nullptr;
+	if (m_pOwnManager) m_pOwnManager->Release();
+	if (m_pOwnDevice) m_pOwnDevice->Release();
+	m_pOwnManager = nullptr;
+	m_pOwnDevice = nullptr;
+}
+
+
+//
+// spoutMediaSource
+//
+
+spoutMediaSource::spoutMediaSource() {
+
+	m_cRef = 1;
+	InitializeCriticalSection(&m_Lock);
+	m_pEventQueue = nullptr;
+	m_pAttributes = nullptr;
+	m_pPresentationDescriptor = nullptr;
+	m_pDeviceManager = nullptr;
+	m_pStream = nullptr;
+	m_bMFStarted = false;
+	m_bShutdown = false;
+
+	InterlockedIncrement(&g_cObjects);
+
+}
+
+spoutMediaSource::~spoutMediaSource() {
+
+	Shutdown();
+	if (m_bMFStarted)
+		MFShutdown();
+	DeleteCriticalSection(&m_Lock);
+	InterlockedDecrement(&g_cObjects);
+
+}
+
+STDMETHODIMP spoutMediaSource::QueryInterface(REFIID riid, void** ppv)
+{
+	if (!ppv)
+		return E_POINTER;
+
+	if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFMediaEventGenerator)
+		|| riid == __uuidof(IMFMediaSource) || riid == __uuidof(IMFMediaSourceEx))
+		*ppv = static_cast<IMFMediaSourceEx*>(this);
+	else if (riid == __uuidof(IMFGetService))
+		*ppv = static_cast<IMFGetService*>(this);
+	else if (riid == __uuidof(IKsControl))
+		*ppv = static_cast<IKsControl*>(this);
+	else {
+		*ppv = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	AddRef();
+	return S_OK;
+}
+
+STDMETHODIMP_(ULONG) spoutMediaSource::AddRef()
+{
+	return InterlockedIncrement(&m_cRef);
+}
+
+STDMETHODIMP_(ULONG) spoutMediaSource::Release()
+{
+	const ULONG count = InterlockedDecrement(&m_cRef);
+	if (count == 0)
+		delete this;
+	return count;
+}
+
+STDMETHODIMP spoutMediaSource::BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState)
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		hr = m_pEventQueue->BeginGetEvent(pCallback, punkState);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent)
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		hr = m_pEventQueue->EndGetEvent(pResult, ppEvent);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent)
+{
+	// Not within the lock, GetEvent can block
+	IMFMediaEventQueue* pQueue = nullptr;
+	EnterCriticalSection(&m_Lock);
+	if (SUCCEEDED(CheckShutdown())) {
+		pQueue = m_pEventQueue;
+		pQueue->AddRef();
+	}
+	LeaveCriticalSection(&m_Lock);
+	if (!pQueue)
+		return MF_E_SHUTDOWN;
+	const HRESULT hr = pQueue->GetEvent(dwFlags, ppEvent);
+	pQueue->Release();
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue)
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		hr = m_pEventQueue->QueueEventParamVar(met, guidExtendedType, hrStatus, pvValue);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::CreatePresentationDescriptor(IMFPresentationDescriptor** ppPresentationDescriptor)
+{
+	if (!ppPresentationDescriptor)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		hr = m_pPresentationDescriptor->Clone(ppPresentationDescriptor);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::GetCharacteristics(DWORD* pdwCharacteristics)
+{
+	if (!pdwCharacteristics)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	const HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		*pdwCharacteristics = MFMEDIASOURCE_IS_LIVE;
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+// A camera cannot be paused
+STDMETHODIMP spoutMediaSource::Pause()
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr))
+		hr = MF_E_INVALID_STATE_TRANSITION;
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::Shutdown()
+{
+	EnterCriticalSection(&m_Lock);
+	if (!m_bShutdown) {
+		m_bShutdown = true;
+		if (m_pStream) {
+			m_pStream->Shutdown();
+			m_pStream->Release();
+			m_pStream = nullptr;
+		}
+		if (m_pEventQueue) {
+			m_pEventQueue->Shutdown();
+			m_pEventQueue->Release();
+			m_pEventQueue = nullptr;
+		}
+		if (m_pPresentationDescriptor) m_pPresentationDescriptor->Release();
+		if (m_pAttributes) m_pAttributes->Release();
+		if (m_pDeviceManager) m_pDeviceManager->Release();
+		m_pPresentationDescriptor = nullptr;
+		m_pAttributes = nullptr;
+		m_pDeviceManager = nullptr;
+	}
+	LeaveCriticalSection(&m_Lock);
+	return S_OK;
+}
+
+//---------------------------------------------------------
+// Function: Start
+// Start the camera stream.
+//
+//   The stream uses the media type selected on the
+//   stream descriptor of the presentation descriptor.
+STDMETHODIMP spoutMediaSource::Start(IMFPresentationDescriptor* pPresentationDescriptor,
+	const GUID* pguidTimeFormat, const PROPVARIANT* pvarStartPosition)
+{
+	if (!pPresentationDescriptor || !pvarStartPosition)
+		return E_INVALIDARG;
+	if (pguidTimeFormat && *pguidTimeFormat != GUID_NULL)
+		return MF_E_UNSUPPORTED_TIME_FORMAT;
+
+	EnterCriticalSection(&m_Lock);
+
+	HRESULT hr = CheckShutdown();
+
+	// Media type selected by the application
+	BOOL bSelected = FALSE;
+	IMFStreamDescriptor* pDescriptor = nullptr;
+	if (SUCCEEDED(hr))
+		hr = pPresentationDescriptor->GetStreamDescriptorByIndex(0, &bSelected, &pDescriptor);
+	if (SUCCEEDED(hr)) {
+		IMFMediaTypeHandler* pHandler = nullptr;
+		IMFMediaType* pType = nullptr;
+		if (SUCCEEDED(pDescriptor->GetMediaTypeHandler(&pHandler))) {
+			if (SUCCEEDED(pHandler->GetCurrentMediaType(&pType))) {
+				IMFStreamDescriptor* pStreamDescriptor = nullptr;
+				IMFMediaTypeHandler* pStreamHandler = nullptr;
+				if (SUCCEEDED(m_pStream->GetStreamDescriptor(&pStreamDescriptor))) {
+					if (SUCCEEDED(pStreamDescriptor->GetMediaTypeHandler(&pStreamHandler))) {
+						pStreamHandler->SetCurrentMediaType(pType);
+						pStreamHandler->Release();
+					}
+					pStreamDescriptor->Release();
+				}
+				pType->Release();
+			}
+			pHandler->Release();
+		}
+		pDescriptor->Release();
+	}
+
+	if (SUCCEEDED(hr) && bSelected) {
+		const MediaEventType met = m_pStream->IsActive() ? MEUpdatedStream : MENewStream;
+		hr = m_pEventQueue->QueueEventParamUnk(met, GUID_NULL, S_OK, static_cast<IMFMediaStream*>(m_pStream));
+		if (SUCCEEDED(hr))
+			hr = m_pStream->Start(m_pDeviceManager);
+	}
+
+	if (SUCCEEDED(hr)) {
+		PROPVARIANT time;
+		PropVariantInit(&time);
+		time.vt = VT_I8;
+		time.hVal.QuadPart = MFGetSystemTime();
+		hr = m_pEventQueue->QueueEventParamVar(MESourceStarted, GUID_NULL, S_OK, &time);
+	}
+
+	LeaveCriticalSection(&m_Lock);
+
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::Stop()
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr) && m_pStream->IsActive())
+		hr = m_pStream->Stop();
+	if (SUCCEEDED(hr))
+		hr = m_pEventQueue->QueueEventParamVar(MESourceStopped, GUID_NULL, S_OK, nullptr);
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::GetSourceAttributes(IMFAttributes** ppAttributes)
+{
+	if (!ppAttributes)
+		return E_POINTER;
+	EnterCriticalSection(&m_Lock);
+	const HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr)) {
+		*ppAttributes = m_pAttributes;
+		m_pAttributes->AddRef();
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+// The stream descriptor holds the stream attributes
+STDMETHODIMP spoutMediaSource::GetStreamAttributes(DWORD dwStreamIdentifier, IMFAttributes** ppAttributes)
+{
+	if (!ppAttributes)
+		return E_POINTER;
+	if (dwStreamIdentifier != 0)
+		return MF_E_INVALIDSTREAMNUMBER;
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr)) {
+		IMFStreamDescriptor* pDescriptor = nullptr;
+		hr = m_pStream->GetStreamDescriptor(&pDescriptor);
+		if (SUCCEEDED(hr)) {
+			hr = pDescriptor->QueryInterface(IID_PPV_ARGS(ppAttributes));
+			pDescriptor->Release();
+		}
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+//---------------------------------------------------------
+// Function: SetD3DManager
+// Device manager of the Frame Server.
+//
+//   Camera samples are allocated on the device of this manager.
+//   Without one, the stream creates its own device.
+STDMETHODIMP spoutMediaSource::SetD3DManager(IUnknown* pManager)
+{
+	EnterCriticalSection(&m_Lock);
+	HRESULT hr = CheckShutdown();
+	if (SUCCEEDED(hr)) {
+		if (m_pDeviceManager) m_pDeviceManager->Release();
+		m_pDeviceManager = nullptr;
+		if (pManager)
+			hr = pManager->QueryInterface(IID_PPV_ARGS(&m_pDeviceManager));
+	}
+	LeaveCriticalSection(&m_Lock);
+	return hr;
+}
+
+STDMETHODIMP spoutMediaSource::GetService(REFGUID guidService, REFIID riid, LPVOID* ppvObject)
+{
+	UNREFERENCED_PARAMETER(guidService);
+	UNREFERENCED_PARAMETER(riid);
+	if (!ppvObject)
+		return E_POINTER;
+	*ppvObject = nullptr;
+	return MF_E_UNSUPPORTED_SERVICE;
+}
+
+// There are no camera controls
+STDMETHODIMP spoutMediaSource::KsProperty(PKSPROPERTY Property, ULONG PropertyLength,
+	LPVOID PropertyData, ULONG DataLength, ULONG* BytesReturned)
+{
+	UNREFERENCED_PARAMETER(Property);
+	UNREFERENCED_PARAMETER(PropertyLength);
+	UNREFERENCED_PARAMETER(PropertyData);
+	UNREFERENCED_PARAMETER(DataLength);
+	if (BytesReturned) *BytesReturned = 0;
+	return HRESULT_FROM_WIN32(ERROR_SET_NOT_FOUND);
+}
+
+STDMETHODIMP spoutMediaSource::KsMethod(PKSMETHOD Method, ULONG MethodLength,
+	LPVOID MethodData, ULONG DataLength, ULONG* BytesReturned)
+{
+	UNREFERENCED_PARAMETER(Method);
+	UNREFERENCED_PARAMETER(MethodLength);
+	UNREFERENCED_PARAMETER(MethodData);
+	UNREFERENCED_PARAMETER(DataLength);
+	if (BytesReturned) *BytesReturned = 0;
+	return HRESULT_FROM_WIN32(ERROR_SET_NOT_FOUND);
+}
+
+STDMETHODIMP spoutMediaSource::KsEvent(PKSEVENT Event, ULONG EventLength,
+	LPVOID EventData, ULONG DataLength, ULONG* BytesReturned)
+{
+	UNREFERENCED_PARAMETER(Event);
+	UNREFERENCED_PARAMETER(EventLength);
+	UNREFERENCED_PARAMETER(EventData);
+	UNREFERENCED_PARAMETER(DataLength);
+	if (BytesReturned) *BytesReturned = 0;
+	return HRESULT_FROM_WIN32(ERROR_SET_NOT_FOUND);
+}
+
+// Event queue, attributes, stream and presentation descriptor
+HRESULT spoutMediaSource::Initialize()
+{
+	HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+	if (FAILED(hr))
+		return hr;
+	m_bMFStarted = true;
+
+	hr = MFCreateEventQueue(&m_pEventQueue);
+	if (SUCCEEDED(hr))
+		hr = MFCreateAttributes(&m_pAttributes, 1);
+
+	if (SUCCEEDED(hr)) {
+		m_pStream = new spoutMediaStream(this);
+		hr = m_pStream->Initialize();
+	}
+
+	if (SUCCEEDED(hr)) {
+		IMFStreamDescriptor* pDescriptor = nullptr;
+		hr = m_pStream->GetStreamDescriptor(&pDescriptor);
+		if (SUCCEEDED(hr)) {
+			hr = MFCreatePresentationDescriptor(1, &pDescriptor, &m_pPresentationDescriptor);
+			pDescriptor->Release();
+		}
+	}
+	if (SUCCEEDED(hr))
+		hr = m_pPresentationDescriptor->SelectStream(0);
+
+	if (FAILED(hr))
+		SpoutLogError("spoutMediaSource::Initialize - failed (0x%.7X)", (unsigned int)hr);
+
+	return hr;
+}
+
+HRESULT spoutMediaSource::CheckShutdown()
+{
+	return m_bShutdown ? MF_E_SHUTDOWN : S_OK;
+}
+
+
+//
+// spoutVirtualCam
+//
+
+spoutVirtualCam::spoutVirtualCam() {
+
+	m_pCamera = nullptr;
+	m_bMFStarted = false;
+	m_pBridgeDevice = nullptr;
+	m_hBridgeThread = NULL;
+	m_hBridgeStop = NULL;
+
+}
+
+spoutVirtualCam::~spoutVirtualCam() {
+
+	Stop();
+	if (m_bMFStarted)
+		MFShutdown();
+
+}
+
+//---------------------------------------------------------
+// Function: Start
+// Add the camera to the system and start it.
+//
+//   name - camera name shown by applications
+//
+//   The camera is available to all applications of the user
+//   until Stop or the application closes. The media source
+//   dll must be registered (regsvr32 SpoutVirtualCam.dll).
+//   Requires Windows 11.
+//
+//   The media source runs in the Frame Server service and cannot
+//   receive the sender of the user session. A thread of the application
+//   receives the active sender and writes it to the session bridge
+//   created by the media source while an application uses the camera.
+bool spoutVirtualCam::Start(const wchar_t* name)
+{
+	if (m_pCamera)
+		return true;
+
+	if (!m_bMFStarted) {
+		const HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+		if (FAILED(hr)) {
+			SpoutLogError("spoutVirtualCam::Start - MFStartup failed (0x%.7X)", (unsigned int)hr);
+			return false;
+		}
+		m_bMFStarted = true;
+	}
+
+	wchar_t clsid[40]={};
+	StringFromGUID2(CLSID_SpoutVirtualCam, clsid, 40);
+
+	HRESULT hr = MFCreateVirtualCamera(MFVirtualCameraType_SoftwareCameraSource,
+		MFVirtualCameraLifetime_Session, MFVirtualCameraAccess_CurrentUser,
+		name, clsid, nullptr, 0, &m_pCamera);
+	if (SUCCEEDED(hr))
+		hr = m_pCamera->Start(nullptr);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutVirtualCam::Start - could not create virtual camera (0x%.7X)", (unsigned int)hr);
+		if (m_pCamera) {
+			m_pCamera->Shutdown();
+			m_pCamera->Release();
+		}
+		m_pCamera = nullptr;
+		return false;
+	}
+
+	// Device for the sender and the bridge texture
+	hr = CreateVideoDevice(&m_pBridgeDevice);
+	if (SUCCEEDED(hr) && m_BridgeWriter.OpenCamera(m_pBridgeDevice)) {
+		m_hBridgeStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+		if (m_hBridgeStop)
+			m_hBridgeThread = CreateThread(NULL, 0, BridgeThread, this, 0, NULL);
+	}
+	if (!m_hBridgeThread) {
+		SpoutLogError("spoutVirtualCam::Start - could not start bridge thread (0x%.7X, %d)", (unsigned int)hr, GetLastError());
+		Stop();
+		return false;
+	}
+
+	SpoutLogNotice("spoutVirtualCam::Start - started");
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Stop
+// Remove the camera
+void spoutVirtualCam::Stop()
+{
+	if (m_hBridgeThread) {
+		SetEvent(m_hBridgeStop);
+		WaitForSingleObject(m_hBridgeThread, INFINITE);
+		CloseHandle(m_hBridgeThread);
+		m_hBridgeThread = NULL;
+	}
+	if (m_hBridgeStop) {
+		CloseHandle(m_hBridgeStop);
+		m_hBridgeStop = NULL;
+	}
+	m_BridgeWriter.CloseCamera();
+	if (m_pBridgeDevice) m_pBridgeDevice->Release();
+	m_pBridgeDevice = nullptr;
+
+	if (!m_pCamera)
+		return;
+
+	m_pCamera->Stop();
+	m_pCamera->Remove();
+	m_pCamera->Shutdown();
+	m_pCamera->Release();
+	m_pCamera = nullptr;
+
+	SpoutLogNotice("spoutVirtualCam::Stop");
+}
+
+//---------------------------------------------------------
+// Function: IsStarted
+// Camera added
+bool spoutVirtualCam::IsStarted()
+{
+	return (m_pCamera != nullptr);
+}
+
+// Write the sender to the bridge at the camera frame rate.
+// The bridge is opened when an application opens the camera.
+DWORD WINAPI spoutVirtualCam::BridgeThread(LPVOID lpParameter)
+{
+	spoutVirtualCam* pCam = static_cast<spoutVirtualCam*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_FRAME);
+	while (WaitForSingleObject(pCam->m_hBridgeStop, 1000/SPOUT_VIRTUALCAM_FPS) == WAIT_TIMEOUT) {
+		if (pCam->m_BridgeWriter.OpenBridge())
+			pCam->m_BridgeWriter.WriteBridge();
+	}
+	EndSpoutThread(SPOUT_THREAD_FRAME, hTask);
+	return 0;
+}
+
+
+//
+// COM server of the media source (SpoutVirtualCam.def)
+//
+
+class spoutVirtualCamFactory : public IClassFactory {
+
+	public:
+
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv)
+		{
+			if (!ppv)
+				return E_POINTER;
+			if (riid == __uuidof(IUnknown) || riid == __uuidof(IClassFactory)) {
+				*ppv = static_cast<IClassFactory*>(this);
+				return S_OK;
+			}
+			*ppv = nullptr;
+			return E_NOINTERFACE;
+		}
+
+		// Static object
+		STDMETHODIMP_(ULONG) AddRef() { return 2; }
+		STDMETHODIMP_(ULONG) Release() { return 1; }
+
+		STDMETHODIMP CreateInstance(IUnknown* pUnkOuter, REFIID riid, void** ppv)
+		{
+			if (!ppv)
+				return E_POINTER;
+			*ppv = nullptr;
+			if (pUnkOuter)
+				return CLASS_E_NOAGGREGATION;
+			spoutMediaSource* pSource = new spoutMediaSource();
+			HRESULT hr = pSource->Initialize();
+			if (SUCCEEDED(hr))
+				hr = pSource->QueryInterface(riid, ppv);
+			// The stream releases the source at shutdown
+			if (FAILED(hr))
+				pSource->Shutdown();
+			pSource->Release();
+			return hr;
+		}
+
+		STDMETHODIMP LockServer(BOOL bLock)
+		{
+			if (bLock)
+				InterlockedIncrement(&g_cServerLocks);
+			else
+				InterlockedDecrement(&g_cServerLocks);
+			return S_OK;
+		}
+
+};
+
+static spoutVirtualCamFactory g_Factory;
+
+STDAPI DllGetClassObject(REFCLSID rclsid, REFIID riid, LPVOID* ppv)
+{
+	if (rclsid != CLSID_SpoutVirtualCam)
+		return CLASS_E_CLASSNOTAVAILABLE;
+	return g_Factory.QueryInterface(riid, ppv);
+}
+
+STDAPI DllCanUnloadNow()
+{
+	return (g_cObjects == 0 && g_cServerLocks == 0) ? S_OK : S_FALSE;
+}
+
+// Register the class for all users, so that the Frame Server
+// service can create the source. Requires administrator.
+STDAPI DllRegisterServer()
+{
+	HMODULE hModule = NULL;
+	char path[MAX_PATH]={};
+	if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+		reinterpret_cast<LPCSTR>(&DllRegisterServer), &hModule)
+		|| !GetModuleFileNameA(hModule, path, MAX_PATH))
+		return HRESULT_FROM_WIN32(GetLastError());
+
+	wchar_t wclsid[40]={};
+	char clsid[40]={};
+	StringFromGUID2(CLSID_SpoutVirtualCam, wclsid, 40);
+	WideCharToMultiByte(CP_ACP, 0, wclsid, -1, clsid, 40, NULL, NULL);
+
+	char subkey[MAX_PATH]={};
+	sprintf_s(subkey, MAX_PATH, "Software\\Classes\\CLSID\\%s\\InprocServer32", clsid);
+	HKEY hKey = NULL;
+	LONG result = RegCreateKeyExA(HKEY_LOCAL_MACHINE, subkey, 0, NULL, 0, KEY_WRITE, NULL, &hKey, NULL);
+	if (result == ERROR_SUCCESS) {
+		result = RegSetValueExA(hKey, NULL, 0, REG_SZ, (const BYTE*)path, (DWORD)strlen(path)+1);
+		if (result == ERROR_SUCCESS)
+			result = RegSetValueExA(hKey, "ThreadingModel", 0, REG_SZ, (const BYTE*)"Both", 5);
+		RegCloseKey(hKey);
+	}
+
+	return HRESULT_FROM_WIN32(result);
+}
+
+STDAPI DllUnregisterServer()
+{
+	wchar_t wclsid[40]={};
+	char clsid[40]={};
+	StringFromGUID2(CLSID_SpoutVirtualCam, wclsid, 40);
+	WideCharToMultiByte(CP_ACP, 0, wclsid, -1, clsid, 40, NULL, NULL);
+
+	char subkey[MAX_PATH]={};
+	sprintf_s(subkey, MAX_PATH, "Software\\Classes\\CLSID\\%s", clsid);
+	const LONG result = RegDeleteTreeA(HKEY_LOCAL_MACHINE, subkey);
+
+	return (result == ERROR_SUCCESS || result == ERROR_FILE_NOT_FOUND) ? S_OK : HRESULT_FROM_WIN32(result);
+}
@@ -0,0 +1,304 @@
+/*
+
+	spoutVirtualCam.h
+
+	Windows 11 Media Foundation virtual camera of a Spout sender
+
+	Copyright (c) 2026, Lynn Jarvis. All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without modification,
+	are permitted provided that the following conditions are met:
+
+		1. Redistributions of source code must retain the above copyright notice,
+		   this list of conditions and the following disclaimer.
+
+		2. Redistributions in binary form must reproduce the above copyright notice,
+		   this list of conditions and the following disclaimer in the documentation
+		   and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"	AND ANY
+	EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+	OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE	ARE DISCLAIMED.
+	IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+	INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+	PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+	LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+#ifndef __spoutVirtualCam__
+#define __spoutVirtualCam__
+
+#include "..\SpoutDX.h" // Base class
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mferror.h>
+#include <mfvirtualcamera.h> // Windows 11 SDK
+#include <ks.h>
+#include <ksproxy.h> // for IKsControl
+#include <sddl.h> // for ConvertStringSecurityDescriptorToSecurityDescriptor
+#include <vector>
+
+#pragma comment (lib, "mfplat.lib")
+#pragma comment (lib, "mfuuid.lib")
+#pragma comment (lib, "mfsensorgroup.lib") // for MFCreateVirtualCamera
+
+// Class ID of the Spout camera media source
+// {5A0E3F2C-7B1D-4C8E-9F36-2D41A8C0B917}
+static const CLSID CLSID_SpoutVirtualCam =
+	{ 0x5a0e3f2c, 0x7b1d, 0x4c8e, { 0x9f, 0x36, 0x2d, 0x41, 0xa8, 0xc0, 0xb9, 0x17 } };
+
+// Camera frame rate
+#define SPOUT_VIRTUALCAM_FPS 30
+// NV12 samples allocated for the camera stream
+#define SPOUT_VIRTUALCAM_SAMPLES 8
+
+// Session bridge.
+// The media source runs in the Frame Server service in session 0 and
+// cannot open the sender names and shared textures of the user session.
+// The source creates the bridge in the global namespace and the
+// application writes the sender to it from the user session.
+#define SPOUT_VIRTUALCAM_BRIDGE L"Global\\SpoutVirtualCamBridge"
+#define SPOUT_VIRTUALCAM_FRAME L"Global\\SpoutVirtualCamFrame"
+#define SPOUT_VIRTUALCAM_MAGIC 0x53564342 // "SVCB"
+// Bridge texture size. The camera sizes have the same aspect ratio.
+#define SPOUT_VIRTUALCAM_WIDTH 1920
+#define SPOUT_VIRTUALCAM_HEIGHT 1080
+
+// Shared memory of the session bridge
+struct SpoutVirtualCamBridge {
+	volatile LONG magic; // SPOUT_VIRTUALCAM_MAGIC while the media source has the bridge
+	volatile LONG generation; // Incremented for each bridge texture created
+	volatile DWORD time; // GetTickCount of the last frame written by the application
+	DWORD reserved[5];
+};
+
+//
+// Receives the sender and converts it to the bridge texture (application)
+// or converts the bridge texture to NV12 camera samples (media source)
+//
+class spoutVirtualCamReceiver : public spoutDX {
+
+	public:
+
+		spoutVirtualCamReceiver();
+		~spoutVirtualCamReceiver();
+
+		// Use the camera device
+		bool OpenCamera(ID3D11Device* pDevice);
+		// Convert the sender to a texture, black if there is no sender
+		bool ReceiveFrame(ID3D11Texture2D* pOutput, UINT subresource);
+		// Release the sender, the bridge and the camera device
+		void CloseCamera();
+
+		// Session bridge
+		// Create the bridge (media source)
+		bool CreateBridge();
+		// Open the bridge created by the media source (application)
+		bool OpenBridge();
+		// Write the sender to the bridge (application)
+		bool WriteBridge();
+		// Convert the bridge to an NV12 texture (media source)
+		bool ReadBridge(ID3D11Texture2D* pOutput, UINT subresource);
+		// Close the bridge
+		void CloseBridge();
+
+	protected:
+
+		ID3D11VideoDevice* m_pCamVideoDevice;
+		ID3D11VideoContext* m_pCamVideoContext;
+		ID3D11VideoProcessorEnumerator* m_pCamEnum;
+		ID3D11VideoProcessor* m_pCamProcessor;
+		ID3D11VideoProcessorInputView* m_pCamInputView;
+		ID3D11Texture2D* m_pCamSource; // Texture of the input view
+		unsigned int m_CamInputWidth;
+		unsigned int m_CamInputHeight;
+		unsigned int m_CamOutputWidth;
+		unsigned int m_CamOutputHeight;
+
+		// Output views of the camera sample textures
+		struct CamOutputView {
+			ID3D11Texture2D* pTexture;
+			UINT subresource;
+			ID3D11VideoProcessorOutputView* pView;
+		};
+		std::vector<CamOutputView> m_CamViews;
+
+		// Session bridge
+		HANDLE m_hBridgeMap;
+		SpoutVirtualCamBridge* m_pBridge;
+		ID3D11Texture2D* m_pBridgeTexture;
+		IDXGIKeyedMutex* m_pBridgeMutex;
+		HANDLE m_hBridgeShare; // Named handle of the bridge texture
+		LONG m_BridgeGeneration; // Generation of the bridge texture opened
+		bool m_bBridgeCreated; // Bridge created by this object
+		DWORD m_BridgeRetry; // Time of the last attempt to create the bridge
+
+		bool ConvertFrame(ID3D11Texture2D* pInput, unsigned int width, unsigned int height,
+			ID3D11Texture2D* pOutput, UINT subresource);
+		bool CreateCamProcessor(unsigned int inwidth, unsigned int inheight,
+			unsigned int outwidth, unsigned int outheight);
+		ID3D11VideoProcessorOutputView* GetCamOutputView(ID3D11Texture2D* pOutput, UINT subresource);
+		void ReleaseCamProcessor();
+
+};
+
+class spoutMediaSource;
+
+//
+// Video stream of the camera media source
+//
+class spoutMediaStream : public IMFMediaStream2 {
+
+	public:
+
+		spoutMediaStream(spoutMediaSource* pSource);
+
+		// IUnknown
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv);
+		STDMETHODIMP_(ULONG) AddRef();
+		STDMETHODIMP_(ULONG) Release();
+
+		// IMFMediaEventGenerator
+		STDMETHODIMP BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState);
+		STDMETHODIMP EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent);
+		STDMETHODIMP GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent);
+		STDMETHODIMP QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue);
+
+		// IMFMediaStream
+		STDMETHODIMP GetMediaSource(IMFMediaSource** ppMediaSource);
+		STDMETHODIMP GetStreamDescriptor(IMFStreamDescriptor** ppStreamDescriptor);
+		STDMETHODIMP RequestSample(IUnknown* pToken);
+
+		// IMFMediaStream2
+		STDMETHODIMP SetStreamState(MF_STREAM_STATE value);
+		STDMETHODIMP GetStreamState(MF_STREAM_STATE* value);
+
+		HRESULT Initialize();
+		HRESULT Start(IMFDXGIDeviceManager* pManager);
+		HRESULT Stop();
+		void Shutdown();
+		bool IsActive();
+
+	protected:
+
+		~spoutMediaStream();
+
+		volatile LONG m_cRef;
+		CRITICAL_SECTION m_Lock;
+		spoutMediaSource* m_pSource;
+		IMFMediaEventQueue* m_pEventQueue;
+		IMFStreamDescriptor* m_pStreamDescriptor;
+		MF_STREAM_STATE m_State;
+		bool m_bShutdown;
+
+		// Camera samples
+		IMFDXGIDeviceManager* m_pDeviceManager;
+		IMFDXGIDeviceManager* m_pOwnManager; // Created if the source has none
+		ID3D11Device* m_pOwnDevice;
+		UINT m_ResetToken;
+		HANDLE m_hDevice;
+		IMFVideoSampleAllocatorEx* m_pAllocator;
+		spoutVirtualCamReceiver m_Receiver;
+		bool m_bReceiver;
+
+		HRESULT CreateStreamDevice(IMFDXGIDeviceManager* pManager);
+		void ReleaseStreamDevice();
+
+};
+
+//
+// Camera media source created by the Frame Server from the class ID
+//
+class spoutMediaSource : public IMFMediaSourceEx, public IMFGetService, public IKsControl {
+
+	public:
+
+		spoutMediaSource();
+
+		// IUnknown
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv);
+		STDMETHODIMP_(ULONG) AddRef();
+		STDMETHODIMP_(ULONG) Release();
+
+		// IMFMediaEventGenerator
+		STDMETHODIMP BeginGetEvent(IMFAsyncCallback* pCallback, IUnknown* punkState);
+		STDMETHODIMP EndGetEvent(IMFAsyncResult* pResult, IMFMediaEvent** ppEvent);
+		STDMETHODIMP GetEvent(DWORD dwFlags, IMFMediaEvent** ppEvent);
+		STDMETHODIMP QueueEvent(MediaEventType met, REFGUID guidExtendedType, HRESULT hrStatus, const PROPVARIANT* pvValue);
+
+		// IMFMediaSource
+		STDMETHODIMP CreatePresentationDescriptor(IMFPresentationDescriptor** ppPresentationDescriptor);
+		STDMETHODIMP GetCharacteristics(DWORD* pdwCharacteristics);
+		STDMETHODIMP Pause();
+		STDMETHODIMP Shutdown();
+		STDMETHODIMP Start(IMFPresentationDescriptor* pPresentationDescriptor, const GUID* pguidTimeFormat, const PROPVARIANT* pvarStartPosition);
+		STDMETHODIMP Stop();
+
+		// IMFMediaSourceEx
+		STDMETHODIMP GetSourceAttributes(IMFAttributes** ppAttributes);
+		STDMETHODIMP GetStreamAttributes(DWORD dwStreamIdentifier, IMFAttributes** ppAttributes);
+		STDMETHODIMP SetD3DManager(IUnknown* pManager);
+
+		// IMFGetService
+		STDMETHODIMP GetService(REFGUID guidService, REFIID riid, LPVOID* ppvObject);
+
+		// IKsControl
+		STDMETHODIMP KsProperty(PKSPROPERTY Property, ULONG PropertyLength, LPVOID PropertyData, ULONG DataLength, ULONG* BytesReturned);
+		STDMETHODIMP KsMethod(PKSMETHOD Method, ULONG MethodLength, LPVOID MethodData, ULONG DataLength, ULONG* BytesReturned);
+		STDMETHODIMP KsEvent(PKSEVENT Event, ULONG EventLength, LPVOID EventData, ULONG DataLength, ULONG* BytesReturned);
+
+		HRESULT Initialize();
+
+	protected:
+
+		~spoutMediaSource();
+
+		volatile LONG m_cRef;
+		CRITICAL_SECTION m_Lock;
+		IMFMediaEventQueue* m_pEventQueue;
+		IMFAttributes* m_pAttributes;
+		IMFPresentationDescriptor* m_pPresentationDescriptor;
+		IMFDXGIDeviceManager* m_pDeviceManager; // From the Frame Server
+		spoutMediaStream* m_pStream;
+		bool m_bMFStarted;
+		bool m_bShutdown;
+
+		HRESULT CheckShutdown();
+
+};
+
+//
+// Application control of the virtual camera
+//
+class spoutVirtualCam {
+
+	public:
+
+		spoutVirtualCam();
+		~spoutVirtualCam();
+
+		// Add the camera to the system for this session and start it
+		bool Start(const wchar_t* name = L"Spout Camera");
+		// Remove the camera
+		void Stop();
+		// Camera added
+		bool IsStarted();
+
+	protected:
+
+		IMFVirtualCamera* m_pCamera;
+		bool m_bMFStarted;
+
+		// Writes the sender to the session bridge
+		spoutVirtualCamReceiver m_BridgeWriter;
+		ID3D11Device* m_pBridgeDevice;
+		HANDLE m_hBridgeThread;
+		HANDLE m_hBridgeStop;
+		static DWORD WINAPI BridgeThread(LPVOID lpParameter);
+
+};
+
+#endif
@@ -269,6 +269,73 @@
 //					  by OpenGL/DirectX interop
 //		07.12.23	- use _access in place of shlwapi Path functions
 //	Version 2.007.013
+//		14.10.26	- ReceiveSenderData - without a sender, check for one only if
+//					  the sender change count has changed, or once a second
+//					- Add ReceiveImage with pixel buffer width and height
+//					  for GPU resample to a different size
+//					- Add ReceiveTexture for a region of the sender texture
+//					- Add SetDirtyRects
+//					- Add GetSenderFrameAge and GetSenderMissedFrames
+//					- Add WaitFrameSync for a number of senders
+//					- ReceiveSenderData - use spoutDirectX::OpenSharedTexture to re-use
+//					  sender textures already opened. Release them if the sender closes.
+//					- CreateSender, InitReceiver - set the share mode for telemetry
+//					- Add GetSenderFrameStats and ResetSenderFrameStats
+//					- SendFbo - use the host viewport if the state is shadowed
+//					- DrawSharedTexture, DrawToSharedTexture - core profile versions
+//					  using spoutShaders::Draw if legacyOpenGL is not defined
+//					- ReceiveSenderData - add RelinkReceiver for a size or format change
+//					  of the same sender instead of releasing and re-creating everything
+//					- Add PrepareSender
+//					- Add SetPreconnect and GetPreconnect to open sender textures
+//					  on a thread when senders change (see spoutDirectX::StartPreopen)
+//					- Add SetSenderArraySize and GetSenderArraySize for array texture
+//					  senders and receivers. The views are shared with one sender name,
+//					  access mutex and frame count.
+//					- DrawSharedTexture, DrawToSharedTexture - GPU time of the draw
+//					  shader recorded as "GPUShader" (see spoutGL::EnableGPUTiming)
+//					- CheckSender - update the sender heartbeat for cleanup
+//					- Add GetSenderList. CheckSender records the sender adapter.
+//		15.10.26	- Add ReceiveImageYUV for planar NV12 or I420 pixels
+//					  converted by compute shader (see spoutGL::ReadGLDXyuv)
+//					- ReceiveSenderData - open sender textures shared by a named NT handle
+//					- RelinkReceiver - use ReleaseInteropObject for a texture linked by memory object
+//					- ReceiveImage - without an OpenGL context, initialize DirectX only
+//					  (OpenHeadless) and receive by DirectX staging textures or shared memory
+//					- CheckSender, InitReceiver - select texture or CPU share by measured
+//					  performance for share mode 3 (CalibrateShareMode)
+//					- ReceiveTexture, ReceiveImage - release retained resources after a
+//					  time without frames or over the video memory budget (CheckResources)
+//					- CheckSender - record the memory held with telemetry (CheckTelemetryMemory)
+//					- Add EnableContentHash, IsContentHashEnabled, SetSkipUnchanged
+//					  and GetSkipUnchanged to skip receiving frames with unchanged content
+//					- Add ReceiveImageView and ReleaseImageView to access the mapped
+//					  sender frame without copy (SpoutLibrary for managed-language hosts)
+//					- ReleaseSender, ReleaseReceiver - close named data channels
+//					- ReceiveSenderData - do not read the sender information if the
+//					  sender information change count is unchanged (CheckSenderInfoChange)
+//					- Add SendImage with source line pitch so that padded images
+//					  do not need RemovePadding before sending
+//					- Add ReceiveImage with destination line pitch
+//					- Add SetSendReadback, GetSendReadback and ReadSendReadback
+//					  for sender CPU read back of the frames sent without waiting
+//					- Add SetReceiveAnalysis and GetReceiveAnalysis for histograms
+//					  and waveform of the received texture without pixel read back
+//					- Add GetSenderNames to copy the sender names without allocation
+//					- SelectSenderPanel registers a wait for the SpoutPanel process.
+//					  CheckSpoutPanel tests a flag set when it closes instead of the mutex,
+//					  and the receiver does not search for senders while the panel is open.
+//					- Add SelectSender(name) and SelectSender(index) to select a sender
+//					  without SpoutPanel
+//					- Add BeginFrame and EndFrame to render directly to the shared texture
+//					  with a class framebuffer, without a copy from an application texture
+//					- Add StartReceiveThread, StopReceiveThread, IsReceiveThread and
+//					  GetReceiveThreadTexture to receive on a thread with a hidden
+//					  OpenGL context sharing objects with the application context
+//					- 2.006 memory share mode - senders write pixels to the memory ring
+//					  (WriteMemoryPixels, WriteMemoryTexture) and there is no shared texture.
+//					- Senders write to the memory ring only if SetMemoryRingSend is set for
+//					  the sender. The user 2.006 memory share mode is for receivers only.
 //
 // ====================================================================================
 /*
@@ -299,6 +366,12 @@
 
 #include "Spout.h"
 
+// Wait callback for the SpoutPanel process (SelectSenderPanel)
+static VOID CALLBACK SpoutPanelClosed(PVOID lpParameter, BOOLEAN /* TimerOrWaitFired */)
+{
+	InterlockedExchange(static_cast<volatile LONG*>(lpParameter), 1);
+}
+
 
 // Class: Spout
 //
@@ -359,11 +432,32 @@ Spout::Spout()
 	// Adapter index and name are retrieved with create sender or receiver
 	m_AdapterName[0] = 0;
 	m_bAdapt = false; // Receiver adapt to the sender adapter
+	m_bFrameBegun = false;
+	m_bFrameLocked = false;
+
+	// Receive thread
+	m_hReceiveThread = NULL;
+	m_hReceiveStop = NULL;
+	m_hReceiveWnd = NULL;
+	m_hReceiveDC = NULL;
+	m_hReceiveRC = NULL;
+	m_ReceiveThreadName[0] = 0;
+	m_bReceiveThreadInvert = false;
+	InitializeSRWLock(&m_ReceiveLock);
+	ZeroMemory(m_ReceiveTexture, sizeof(m_ReceiveTexture));
+	ZeroMemory(m_ReceiveRelease, sizeof(m_ReceiveRelease));
+	m_ReceiveLatest = -1;
+	m_ReceiveInUse = -1;
+	m_bReceiveNew = false;
 
 }
 
 Spout::~Spout()
 {
+	// The wait callback must not run after the class is destroyed
+	ReleaseSpoutPanel();
+	// Stop the receive thread before its context is released
+	StopReceiveThread();
 	// ~spoutGL will release dependent objects
 }
 
@@ -443,6 +537,34 @@ void Spout::SetSenderFormat(DWORD dwFormat)
 	SetDX11format(static_cast<DXGI_FORMAT>(dwFormat));
 }
 
+//---------------------------------------------------------
+// Function: SetSenderArraySize
+// Set the number of views of an array texture sender.
+//
+//    For stereo or multi-camera senders, the views are shared as one
+//    DirectX array texture with one sender name, access mutex and frame count.
+//    SendTexture then requires a GL_TEXTURE_2D_ARRAY texture with the same
+//    number of layers, and all layers are copied without invert.
+//    Array texture senders require GL/DX interop (texture share).
+//    An existing sender is released and created again on the next send.
+void Spout::SetSenderArraySize(unsigned int arraysize)
+{
+	if (arraysize < 1) arraysize = 1;
+	if (arraysize > SPOUT_USAGE_ARRAY_MASK) arraysize = SPOUT_USAGE_ARRAY_MASK;
+	if (arraysize == m_ArraySize)
+		return;
+
+	// Release the sender and keep the name to create it again
+	if (m_bInitialized) {
+		char sendername[256]={};
+		strcpy_s(sendername, 256, m_SenderName);
+		ReleaseSender();
+		strcpy_s(m_SenderName, 256, sendername);
+	}
+
+	m_ArraySize = arraysize;
+}
+
 //---------------------------------------------------------
 // Function: ReleaseSender
 // Close sender and release resources.
@@ -452,6 +574,14 @@ void Spout::ReleaseSender()
 {
 	SpoutLogNotice("Spout::ReleaseSender(%s)", m_SenderName);
 
+	// Unlock if a frame was begun and not ended
+	if (m_bFrameLocked) {
+		UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+	m_bFrameBegun = false;
+	m_bFrameLocked = false;
+
 	if (m_bInitialized) {
 		sendernames.ReleaseSenderName(m_SenderName);
 		m_SenderName[0]=0;
@@ -462,6 +592,10 @@ void Spout::ReleaseSender()
 
 	// Close 2.006 or buffer shared memory if used
 	memoryshare.Close();
+	CloseDataChannels();
+
+	// Close the memory share ring for receivers
+	CloseMemoryRing(true);
 
 	// Release sync event if used
 	frame.CloseFrameSync();
@@ -505,10 +639,12 @@ bool Spout::SendFbo(GLuint FboID, unsigned int fbowidth, unsigned int fboheight,
 		// performance is affected.
 		if (width == 0 || height == 0) {
 			// Get the viewport size
-			unsigned int vpdims[4]={0};
-			glGetIntegerv(GL_VIEWPORT, (GLint*)vpdims);
-			width  = vpdims[2];
-			height = vpdims[3];
+			// The host viewport is used if the state is shadowed
+			GLint vpdims[4]={0};
+			if (!m_bStateShadow || !GetHostViewport(vpdims))
+				glGetIntegerv(GL_VIEWPORT, vpdims);
+			width  = (unsigned int)vpdims[2];
+			height = (unsigned int)vpdims[3];
 		}
 	}
 
@@ -517,6 +653,11 @@ bool Spout::SendFbo(GLuint FboID, unsigned int fbowidth, unsigned int fboheight,
 		return false;
 	}
 
+	// Memory ring send (SetMemoryRingSend)
+	// Pixels of the fbo bound for read are written to the memory ring
+	if (m_bMemoryRingSend)
+		return WriteMemoryTexture(m_SenderName, 0, 0, width, height, bInvert, FboID);
+
 	// All clear to send the fbo texture
 	if(m_bTextureShare) {
 		// 3840-2160 - 60fps (0.45 msec per frame)
@@ -563,11 +704,22 @@ bool Spout::SendTexture(GLuint TextureID, GLuint TextureTarget,
 	if (!CheckSender(width, height))
 		return false;
 
+	// Memory ring send (SetMemoryRingSend)
+	if (m_bMemoryRingSend)
+		return WriteMemoryTexture(m_SenderName, TextureID, TextureTarget, width, height, bInvert, HostFBO);
+
 	if (m_bTextureShare) { // if GL/DX interop compatible
 		// Send OpenGL texture 
 		// 3840-2160 - 60fps (0.45 msec per frame)
 		return WriteGLDXtexture(TextureID, TextureTarget, width, height, bInvert, HostFBO);
 	}
+
+	// Array texture senders require texture share
+	if (m_ArraySize > 1) {
+		SpoutLogWarning("Spout::SendTexture - array texture sender requires GL/DX interop");
+		return false;
+	}
+
 	else if (m_bCPUshare) {
 		// Auto share enabled for DirectX CPU backup
 		// 3840-2160 47fps (6-7 msec per frame with PBOs)
@@ -591,6 +743,21 @@ bool Spout::SendTexture(GLuint TextureID, GLuint TextureTarget,
 //     The ID of a currently bound fbo should be passed in.
 //
 bool Spout::SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, GLuint HostFBO)
+{
+	return SendImage(pixels, width, height, 0, glFormat, bInvert, HostFBO);
+}
+
+//---------------------------------------------------------
+// Function: SendImage
+// Send pixel image with a source line pitch
+//
+//     pitch is the bytes of each line including padding, for example
+//     capture card or video decoder frames, or 0 for packed pixels.
+//     The padding is skipped while the pixels are copied,
+//     so RemovePadding is not required before sending.
+//
+bool Spout::SendImage(const unsigned char* pixels, unsigned int width, unsigned int height,
+	unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFBO)
 {
 	// Dimensions should be the same as the sender
 	if (!pixels || width == 0 || height == 0)
@@ -615,22 +782,158 @@ bool Spout::SendImage(const unsigned char* pixels, unsigned int width, unsigned
 	if (!CheckSender(width, height))
 		return false;
 
+	// Memory ring send (SetMemoryRingSend)
+	// Pixels are converted to rgba by the CPU and do not need BGRA extensions
+	if (m_bMemoryRingSend)
+		return WriteMemoryPixels(m_SenderName, pixels, width, height, glFormat, bInvert, pitch);
+
 	//
 	// Write pixel data to the rgba shared texture according to pixel format
 	//
 	if (m_bTextureShare) {
 		// Texture share compatible
-		return WriteGLDXpixels(pixels, width, height, glformat, bInvert, HostFBO);
+		return WriteGLDXpixels(pixels, width, height, glformat, bInvert, HostFBO, pitch);
 	}
 	else if (m_bCPUshare) {
 		// Auto share enabled for DirectX CPU backup
-		return WriteDX11pixels(pixels, width, height, glformat, bInvert);
+		return WriteDX11pixels(pixels, width, height, glformat, bInvert, pitch);
 	}
 
 	return false;
 
 }
 
+//---------------------------------------------------------
+// Function: BeginFrame
+// Begin rendering directly to the shared texture
+//
+//   Returns a class framebuffer with the shared texture attached and bound
+//   for draw. Set the viewport to the sender size, render the frame and call
+//   EndFrame to send it. There is no copy from an application texture or fbo
+//   as with SendTexture or SendFbo.
+//
+//   For texture share, the interop object and sender mutex are locked from
+//   BeginFrame until EndFrame, so the frame should be rendered and EndFrame
+//   called without delay. For CPU share, a class texture is attached and
+//   copied to the shared texture by EndFrame.
+//
+//   The shared texture is not inverted as it is by SendFbo and SendTexture,
+//   so render with the Y axis flipped for receivers to show the image upright.
+//
+//   Returns zero if the sender could not be created or receivers have
+//   access to the shared texture. The frame is not sent.
+//
+GLuint Spout::BeginFrame(unsigned int width, unsigned int height)
+{
+	if (m_bFrameBegun) {
+		SpoutLogWarning("Spout::BeginFrame - EndFrame has not been called");
+		return m_SharedFbo;
+	}
+
+	if (width == 0 || height == 0)
+		return 0;
+
+	// Create or update the sender
+	if (!CheckSender(width, height))
+		return 0;
+
+	if (m_ArraySize > 1) {
+		SpoutLogWarning("Spout::BeginFrame - not available for an array texture sender");
+		return 0;
+	}
+
+	if (!m_bTextureShare && !m_bCPUshare && !m_bMemoryRingSend)
+		return 0;
+
+	if (m_SharedFbo == 0)
+		glGenFramebuffersEXT(1, &m_SharedFbo);
+
+	GLuint TextureID = m_glTexture;
+	if (m_bTextureShare) {
+		// Only for GL/DX interop mode
+		if (!m_hInteropDevice || !m_hInteropObject)
+			return 0;
+		SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+		// Wait for access to the shared texture
+		if (!frame.CheckTextureAccess(m_pSharedTexture))
+			return 0;
+		// Lock the interop object until EndFrame
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) != S_OK) {
+			frame.AllowTextureAccess(m_pSharedTexture);
+			return 0;
+		}
+		m_bFrameLocked = true;
+	}
+	else {
+		// Render to a class texture copied to the shared texture by EndFrame
+		CheckOpenGLTexture(m_TexID, GL_RGBA, width, height);
+		TextureID = m_TexID;
+	}
+
+	// The texture is attached each frame because the linked
+	// texture is created again if the sender size changes
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_SharedFbo);
+	glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, TextureID, 0);
+	const GLenum status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+	if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+		PrintFBOstatus(status);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+		if (m_bFrameLocked) {
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+			frame.AllowTextureAccess(m_pSharedTexture);
+			m_bFrameLocked = false;
+		}
+		return 0;
+	}
+
+	m_bFrameBegun = true;
+
+	return m_SharedFbo;
+}
+
+//---------------------------------------------------------
+// Function: EndFrame
+// Send the frame rendered after BeginFrame
+//
+//   The host framebuffer is bound on return (default 0).
+//
+bool Spout::EndFrame(GLuint HostFBO)
+{
+	if (!m_bFrameBegun)
+		return false;
+
+	m_bFrameBegun = false;
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+
+	if (!m_bFrameLocked) {
+		// Memory ring send - write the class texture to the memory ring
+		if (m_bMemoryRingSend)
+			return WriteMemoryTexture(m_SenderName, m_TexID, GL_TEXTURE_2D, m_Width, m_Height, false, HostFBO);
+		// CPU share - copy the class texture to the shared texture
+		return WriteDX11texture(m_TexID, GL_TEXTURE_2D, m_Width, m_Height, false, HostFBO);
+	}
+
+	m_bFrameLocked = false;
+
+	// Content hash published with the frame if enabled (EnableContentHash)
+	if (m_bContentHash)
+		WriteContentHash();
+	// Increment the sender frame counter while locked
+	frame.SetNewFrame();
+	// Unlock the interop object
+	UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+	// Copy for CPU read back after unlock (SetSendReadback)
+	WriteSendReadback();
+	// Release mutex and allow access to the texture
+	frame.AllowTextureAccess(m_pSharedTexture);
+	// Read back of earlier frames without the texture locked
+	PollSendReadback();
+
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
+	return true;
+}
+
 //---------------------------------------------------------
 // Function: IsInitialized
 // Initialization status
@@ -734,11 +1037,17 @@ bool Spout::GetGLDX()
 //   If no name is specified, the receiver will connect to the active sender
 void Spout::SetReceiverName(const char * SenderName)
 {
+	// Update the sender opened by the pre-connect thread
+	if (spoutdx.IsPreopen())
+		spoutdx.SetPreopenSender(SenderName);
+
 	if (SenderName) {
 		if (*SenderName) {
 			// Connect to the specified sender
 			strcpy_s(m_SenderNameSetup, 256, SenderName);
 			strcpy_s(m_SenderName, 256, SenderName);
+			// Look for the sender on the next receive
+			m_dwSenderCheck = 0;
 			return;
 		}
 	}
@@ -746,7 +1055,32 @@ void Spout::SetReceiverName(const char * SenderName)
 	// Connect to the active sender
 	m_SenderNameSetup[0] = 0;
 	m_SenderName[0] = 0;
+	m_dwSenderCheck = 0;
+
+}
+
+//---------------------------------------------------------
+// Function: SetPreconnect
+// Open sender textures on a thread when senders change.
+//
+//   When the sender specified by SetReceiverName, or the active sender,
+//   is created or changes size, the sender texture is opened on a thread
+//   and retained. ReceiveTexture then uses the opened texture without
+//   OpenSharedResource and only the OpenGL interop object is created.
+//   The thread starts on the next receive after DirectX is initialized.
+void Spout::SetPreconnect(bool bPreconnect)
+{
+	m_bPreconnect = bPreconnect;
+	if (!bPreconnect)
+		spoutdx.StopPreopen();
+}
 
+//---------------------------------------------------------
+// Function: GetPreconnect
+// Pre-connect status
+bool Spout::GetPreconnect()
+{
+	return m_bPreconnect;
 }
 
 //---------------------------------------------------------
@@ -786,6 +1120,7 @@ void Spout::ReleaseReceiver()
 
 	// Close shared memory and sync event if used
 	memoryshare.Close();
+	CloseDataChannels();
 	frame.CloseFrameSync();
 
 	m_bConnected = false;
@@ -824,6 +1159,8 @@ bool Spout::ReceiveTexture()
 //		- UnBindSharedTexture();
 //		- GetSharedTextureID();
 //
+//   or for the life of a block with spoutSharedTextureScope (SpoutGL.h).
+//
 //   As with SendTexture, the host fbo argument is optional (default 0)
 //   but an fbo ID is necessary if it is currently bound, then that binding
 //   is restored. Otherwise the binding is lost.
@@ -910,6 +1247,43 @@ bool Spout::ReceiveTexture(GLuint TextureID, GLuint TextureTarget, bool bInvert,
 		m_bConnected = false;
 	}
 
+	// Release retained resources if idle or over the memory budget
+	CheckResources(m_bConnected);
+
+	return m_bConnected;
+}
+
+//---------------------------------------------------------
+// Function: ReceiveTexture
+// Copy a region of the sender shared texture.
+//
+//    The region from xoffset, yoffset (top left) of size width x height
+//    is copied to the origin of the receiving texture.
+//    The receiving texture must be at least the region size
+//    and the region must be within the sender texture.
+//    Sender changes are handled with IsUpdated() as for the whole texture.
+//
+//    A region is copied only for texture share. For 2.006 memoryshare
+//    or CPU share, the receiver connects but the texture is not updated.
+//
+bool Spout::ReceiveTexture(GLuint TextureID, GLuint TextureTarget,
+	unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+	bool bInvert, GLuint HostFbo)
+{
+	if (m_bUpdated && TextureID != 0 && TextureTarget != 0)
+		return true;
+
+	// Connect to a sender without a texture copy
+	if (!ReceiveTexture(0, 0, false, HostFbo))
+		return false;
+
+	// The application detects a sender change with IsUpdated()
+	if (m_bUpdated)
+		return true;
+
+	if (m_bTextureShare && m_dxShareHandle && !m_bMemoryShare)
+		ReadGLDXtexture(TextureID, TextureTarget, xoffset, yoffset, width, height, bInvert, HostFbo);
+
 	return m_bConnected;
 }
 
@@ -987,6 +1361,17 @@ DWORD Spout::GetSenderFormat()
 	return m_dwFormat;
 }
 
+//---------------------------------------------------------
+// Function: GetSenderArraySize
+// Get sender number of views
+//    An array texture sender is received to a GL_TEXTURE_2D_ARRAY texture
+//    with the same number of layers, or the first view to a GL_TEXTURE_2D texture.
+//    Pixels are received from the first view.
+unsigned int Spout::GetSenderArraySize()
+{
+	return m_ArraySize;
+}
+
 //---------------------------------------------------------
 // Function: GetSenderName
 // Get sender name
@@ -1028,6 +1413,42 @@ long Spout::GetSenderFrame()
 	return frame.GetSenderFrame();
 }
 
+//---------------------------------------------------------
+// Function: GetSenderFrameAge
+// Time in msec from sender publish to receipt of the last frame.
+// Zero for a sender of an earlier version.
+double Spout::GetSenderFrameAge()
+{
+	return frame.GetFrameAge();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderMissedFrames
+// Number of sender frames not received since connection
+LONG64 Spout::GetSenderMissedFrames()
+{
+	return frame.GetMissedFrames();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderFrameStats
+// Frame statistics since connection or for the last second.
+// New frames received, sender frames skipped, receive calls for a frame
+// already received, the largest number of frames skipped at one time
+// and the longest time between new frames. Frame counting must be enabled.
+void Spout::GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow)
+{
+	frame.GetFrameStats(stats, bWindow);
+}
+
+//---------------------------------------------------------
+// Function: ResetSenderFrameStats
+// Reset frame statistics
+void Spout::ResetSenderFrameStats()
+{
+	frame.ResetFrameStats();
+}
+
 //---------------------------------------------------------
 // Function: GetSenderHandle
 // Received sender share handle
@@ -1063,6 +1484,168 @@ bool Spout::SelectSender()
 	return SelectSenderPanel();
 }
 
+//---------------------------------------------------------
+// Function: SelectSender
+// Select a sender without SpoutPanel.
+//   The sender becomes the active sender and the receiver
+//   switches to it on the next receive, as for SpoutPanel.
+//   For a sender list shown by the application (see GetSenderNames).
+bool Spout::SelectSender(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return false;
+
+	// The sender must exist
+	SharedTextureInfo info={};
+	if (!sendernames.getSharedInfo(sendername, &info)) {
+		SpoutLogWarning("Spout::SelectSender - sender [%s] not found", sendername);
+		return false;
+	}
+
+	sendernames.SetActiveSender(sendername);
+	strcpy_s(m_SelectedSender, 256, sendername);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SelectSender
+// Select a sender by index of the sender list (see GetSender)
+bool Spout::SelectSender(int index)
+{
+	char sendername[256]={};
+	if (!sendernames.GetSender(index, sendername, 256))
+		return false;
+	return SelectSender(sendername);
+}
+
+//---------------------------------------------------------
+// Function: StartReceiveThread
+// Receive on a thread with a hidden OpenGL context.
+//
+//   The interop lock, texture copy and any read back are done by a thread
+//   with its own context, sharing objects with the application context,
+//   so that the application rendering thread does not wait for them.
+//   Call with the application context current. The sender is received
+//   to a ring of textures by a receiver of the thread, and the latest is
+//   retrieved with GetReceiveThreadTexture.
+//
+//   sendername - sender to receive, or the active sender if null
+//   bInvert    - invert the texture received
+//
+bool Spout::StartReceiveThread(const char* sendername, bool bInvert)
+{
+	if (m_hReceiveThread)
+		StopReceiveThread();
+
+	if (!CreateReceiveContext())
+		return false;
+
+	if (sendername && *sendername)
+		strcpy_s(m_ReceiveThreadName, 256, sendername);
+	else
+		m_ReceiveThreadName[0] = 0;
+	m_bReceiveThreadInvert = bInvert;
+	ZeroMemory(m_ReceiveTexture, sizeof(m_ReceiveTexture));
+	ZeroMemory(m_ReceiveRelease, sizeof(m_ReceiveRelease));
+	m_ReceiveLatest = -1;
+	m_ReceiveInUse = -1;
+	m_bReceiveNew = false;
+
+	m_hReceiveStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!m_hReceiveStop) {
+		SpoutLogError("Spout::StartReceiveThread - could not create stop event (%d)", GetLastError());
+		ReleaseReceiveContext();
+		return false;
+	}
+
+	m_hReceiveThread = CreateThread(NULL, 0, ReceiveThread, this, 0, NULL);
+	if (!m_hReceiveThread) {
+		SpoutLogError("Spout::StartReceiveThread - could not create thread (%d)", GetLastError());
+		CloseHandle(m_hReceiveStop);
+		m_hReceiveStop = NULL;
+		ReleaseReceiveContext();
+		return false;
+	}
+
+	SpoutLogNotice("Spout::StartReceiveThread (%s)", m_ReceiveThreadName[0] ? m_ReceiveThreadName : "active sender");
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: StopReceiveThread
+// Stop the receive thread.
+//
+//   The textures of the thread are deleted
+//   and must not be used after this call.
+void Spout::StopReceiveThread()
+{
+	if (m_hReceiveThread) {
+		SetEvent(m_hReceiveStop);
+		WaitForSingleObject(m_hReceiveThread, INFINITE);
+		CloseHandle(m_hReceiveThread);
+		m_hReceiveThread = NULL;
+		SpoutLogNotice("Spout::StopReceiveThread");
+	}
+	if (m_hReceiveStop) {
+		CloseHandle(m_hReceiveStop);
+		m_hReceiveStop = NULL;
+	}
+	ReleaseReceiveContext();
+	m_ReceiveLatest = -1;
+	m_ReceiveInUse = -1;
+	m_bReceiveNew = false;
+}
+
+//---------------------------------------------------------
+// Function: IsReceiveThread
+// The receive thread is running
+bool Spout::IsReceiveThread()
+{
+	return (m_hReceiveThread != NULL);
+}
+
+//---------------------------------------------------------
+// Function: GetReceiveThreadTexture
+// Latest texture received by the thread.
+//
+//   Returns false if there is no new frame since the last call.
+//   The texture returned is not written by the thread until the
+//   next frame is retrieved. A GPU wait for the copy to the texture
+//   is queued on the calling context (glWaitSync), so the texture
+//   can be used at once. The fence is also returned for applications
+//   that synchronise the texture themselves.
+//   The texture size changes with the sender size.
+//
+bool Spout::GetReceiveThreadTexture(SpoutThreadTexture &texture)
+{
+	if (!m_hReceiveThread)
+		return false;
+
+	AcquireSRWLockExclusive(&m_ReceiveLock);
+	if (!m_bReceiveNew || m_ReceiveLatest < 0) {
+		ReleaseSRWLockExclusive(&m_ReceiveLock);
+		return false;
+	}
+	// The thread waits on the GPU for use of the previous texture to finish
+	if (m_ReceiveInUse >= 0 && glFenceSync && !m_ReceiveRelease[m_ReceiveInUse]) {
+		m_ReceiveRelease[m_ReceiveInUse] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		// Flush for the fence to be seen by the thread context
+		glFlush();
+	}
+	m_ReceiveInUse = m_ReceiveLatest;
+	m_bReceiveNew = false;
+	texture = m_ReceiveTexture[m_ReceiveInUse];
+	ReleaseSRWLockExclusive(&m_ReceiveLock);
+
+	// Wait on the GPU for the copy by the thread
+	if (texture.sync && glWaitSync)
+		glWaitSync(texture.sync, 0, GL_TIMEOUT_IGNORED);
+
+	return true;
+}
+
 //
 // Group: Frame counting
 //
@@ -1170,6 +1753,21 @@ bool Spout::WaitFrameSync(const char *SenderName, DWORD dwTimeout)
 	return frame.WaitFrameSync(SenderName, dwTimeout);
 }
 
+// -----------------------------------------------
+// Function: WaitFrameSync
+// Wait or test for the sync events of a number of senders.
+//
+// Wait until any of the sync events is signalled or the timeout elapses.
+// bSignalled is an array of "count" flags which are set true for the
+// senders that signalled. Returns the number of senders that signalled.
+// 
+int Spout::WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout)
+{
+	if (!SenderNames || !m_bInitialized)
+		return 0;
+	return frame.WaitFrameSync(SenderNames, count, bSignalled, dwTimeout);
+}
+
 // -----------------------------------------------
 // Function: EnableFrameSync
 // Enable / disabley frame sync
@@ -1186,6 +1784,149 @@ bool Spout::IsFrameSyncEnabled()
 	return frame.IsFrameSyncEnabled();
 }
 
+// -----------------------------------------------
+// Function: SetDirtyRects
+// Set the changed regions of the next frame sent.
+//   Rectangles are pixels from the top left of the shared texture
+//   with right and bottom exclusive. They are published with the
+//   frame so that receivers can read back only the changed regions.
+//   The whole texture is still copied to the shared texture.
+//   Frames sent without rectangles are published as a change
+//   of the whole texture. Call after the sender has been created.
+bool Spout::SetDirtyRects(const RECT* pRects, unsigned int nRects)
+{
+	if (!m_bInitialized)
+		return false;
+	return frame.SetDirtyRects(m_SenderName, pRects, nRects);
+}
+
+// -----------------------------------------------
+// Function: EnableContentHash
+// Sender publish a GPU hash of the frame content with each frame.
+//
+//   A compute shader reduces the shared texture to a 64 bit hash
+//   after each copy, which is published with the frame number.
+//   Receivers with SetSkipUnchanged then skip the copy or read back
+//   of frames that are the same as the last. Requires OpenGL 4.3,
+//   texture share and a shared texture format of 8 bit RGBA or BGRA.
+void Spout::EnableContentHash(bool bHash)
+{
+	m_bContentHash = bHash;
+}
+
+// -----------------------------------------------
+// Function: IsContentHashEnabled
+// Content hash option
+bool Spout::IsContentHashEnabled()
+{
+	return m_bContentHash;
+}
+
+// -----------------------------------------------
+// Function: SetSendReadback
+// Sender read back the frames sent to CPU memory without waiting.
+//
+//   Each frame sent is copied to the next of a ring of staging textures.
+//   The copies are mapped without waiting when complete, one or two frames
+//   later, and passed to the callback if one is set. The latest can also
+//   be copied to a pixel buffer by ReadSendReadback.
+//   The callback is called on the sending thread during SendTexture,
+//   SendFbo or SendImage, and the pixels are valid until it returns.
+//   For texture share and CPU share senders.
+void Spout::SetSendReadback(bool bReadback, SpoutReadbackCallback callback, void* pUserData)
+{
+	m_ReadbackCallback = callback;
+	m_pReadbackUserData = pUserData;
+	if (!bReadback)
+		ReleaseSendReadback();
+	m_bSendReadback = bReadback;
+}
+
+// -----------------------------------------------
+// Function: GetSendReadback
+// Read back option
+bool Spout::GetSendReadback()
+{
+	return m_bSendReadback;
+}
+
+// -----------------------------------------------
+// Function: ReadSendReadback
+// Copy the latest frame read back to a pixel buffer of the sender size.
+//
+//   Does not wait. Returns false if no frame has been read back
+//   since the last call. The sender frame number is returned in pFrame.
+bool Spout::ReadSendReadback(unsigned char* pixels, GLenum glFormat, bool bInvert, LONG64* pFrame)
+{
+	if (!m_bSendReadback || !pixels)
+		return false;
+
+	// Complete any copies ready since the last frame was sent
+	PollSendReadback();
+
+	if (m_ReadbackLatest < 0 || m_ReadbackFrame[m_ReadbackLatest] == m_ReadbackLastRead)
+		return false;
+
+	// The copy is complete so the map does not wait
+	const int index = m_ReadbackLatest;
+	if (!ReadPixelData(m_pReadbackStaging[index], pixels, m_Width, m_Height, glFormat, bInvert))
+		return false;
+
+	m_ReadbackLastRead = m_ReadbackFrame[index];
+	if (pFrame)
+		*pFrame = m_ReadbackLastRead;
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: SetSkipUnchanged
+// Receiver skip frames with the same content as the last received.
+//
+//   A frame with the same content hash as the last is not received
+//   and IsFrameNew returns false. Frames of senders that do not publish
+//   a content hash are always received. Frame counting must be enabled.
+void Spout::SetSkipUnchanged(bool bSkip)
+{
+	frame.SetSkipUnchanged(bSkip);
+}
+
+// -----------------------------------------------
+// Function: GetSkipUnchanged
+// Skip unchanged frames option
+bool Spout::GetSkipUnchanged()
+{
+	return frame.GetSkipUnchanged();
+}
+
+// -----------------------------------------------
+// Function: SetReceiveAnalysis
+// Receiver histograms and waveform of each frame received by compute shader.
+//
+//   The linked shared texture is analyzed after the copy by ReceiveTexture
+//   with the interop object still locked (see spoutShaders::Analyze).
+//   Only the result of a few KB is read back (GetReceiveAnalysis),
+//   so monitoring does not need ReceiveImage for the whole frame.
+//   Requires OpenGL 4.3, texture share and an 8 bit RGBA or BGRA sender.
+void Spout::SetReceiveAnalysis(bool bAnalyze)
+{
+	m_bReceiveAnalysis = bAnalyze;
+}
+
+// -----------------------------------------------
+// Function: GetReceiveAnalysis
+// Latest histograms and waveform of the frames received.
+//
+//   The result is normally from the frame before the last received,
+//   so that there is no wait for the GPU. Set bWait to wait for the last.
+//   Returns false if there is no new result.
+bool Spout::GetReceiveAnalysis(SpoutScopeData &data, bool bWait)
+{
+	if (!m_bReceiveAnalysis || !m_pShaders)
+		return false;
+	return m_pShaders->GetAnalysis(data, bWait);
+}
+
 
 //
 // Group: Sender names
@@ -1209,6 +1950,17 @@ bool Spout::GetSender(int index, char* sendername, int MaxSize)
 	return sendernames.GetSender(index, sendername, MaxSize);
 }
 
+//---------------------------------------------------------
+// Function: GetSenderNames
+// Copy the sender names to a buffer of maxsenders names, each of maxlength bytes.
+// The names are in the same order as GetSender and there is no allocation,
+// so that a sender list can be updated every frame.
+// Returns the number of names copied, or the number of senders if names is null.
+int Spout::GetSenderNames(char* names, int maxsenders, int maxlength)
+{
+	return sendernames.GetSenderNames(names, maxsenders, maxlength);
+}
+
 //---------------------------------------------------------
 // Function: GetSenderInfo
 // Sender information
@@ -1220,9 +1972,18 @@ bool Spout::GetSenderInfo(const char* sendername, unsigned int &width, unsigned
 }
 
 //---------------------------------------------------------
-// Function: GetActiveSender
-// Current active sender name
-bool Spout::GetActiveSender(char* Sendername)
+// Function: GetSenderList
+// Details of all senders in one call.
+// Returns the number of senders copied, or the number of senders if pSenders is null.
+int Spout::GetSenderList(SpoutSenderDetails* pSenders, int maxsenders)
+{
+	return sendernames.GetSenderList(pSenders, maxsenders);
+}
+
+//---------------------------------------------------------
+// Function: GetActiveSender
+// Current active sender name
+bool Spout::GetActiveSender(char* Sendername)
 {
 	if (!Sendername)
 		return false;
@@ -1660,6 +2421,76 @@ bool Spout::CreateSender(const char* name, unsigned int width, unsigned int heig
 
 }
 
+//---------------------------------------------------------
+// Function: PrepareSender
+// Create a sender and allocate resources used for sending.
+//
+// Resources are otherwise created by the first frame sent,
+// which can take much longer than following frames.
+// An OpenGL context is required. No frame is sent.
+//
+//   - Shared texture, interop and sender (as for CreateSender)
+//   - Framebuffer with the shared texture attached
+//   - First lock of the shared texture
+//   - For CPU share, the staging texture and PBOs
+//
+// Compute shaders are compiled when first used.
+// The program binary cache avoids compiling again
+// for the next run (see spoutShaders::SetBinaryCache).
+bool Spout::PrepareSender(const char* name, unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	if (width == 0 || height == 0)
+		return false;
+
+	if (!CreateSender(name, width, height, dwFormat))
+		return false;
+
+	SpoutLogNotice("Spout::PrepareSender(%s, %dx%d)", name, width, height);
+
+	if (m_bTextureShare) {
+		// Retained framebuffer for copy to the shared texture
+		GetTextureFbo(m_glTexture, GL_TEXTURE_2D);
+		// The first lock of the mutex and interop object
+		if (frame.CheckTextureAccess(m_pSharedTexture)) {
+			if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK)
+				UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+			frame.AllowTextureAccess(m_pSharedTexture);
+		}
+	}
+	else if (m_bCPUshare) {
+		// Staging texture used by WriteDX11texture
+		if (!CheckStagingTextures(width, height, 1))
+			return false;
+		// Row pitch of the staging texture for the PBO size
+		D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+		if (m_bPBOavailable
+			&& SUCCEEDED(spoutdx.GetDX11Context()->Map(m_pStaging[0], 0, D3D11_MAP_WRITE, 0, &mappedSubResource))) {
+			spoutdx.GetDX11Context()->Unmap(m_pStaging[0], 0);
+			if (m_pbo[0] == 0) {
+				glGenBuffers(m_nBuffers, m_pbo);
+				PboIndex = 0;
+				NextPboIndex = 0;
+			}
+			// Allocate the data store of each PBO.
+			// There is no data to map until the first frame.
+			const GLsizeiptr buffersize = (GLsizeiptr)(mappedSubResource.RowPitch * height);
+			for (int i = 0; i < m_nBuffers; i++) {
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[i]);
+				glBufferData(GL_PIXEL_PACK_BUFFER, GetPboAllocation(buffersize), 0, GL_STREAM_READ);
+				m_pboSize[i] = 0;
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+	}
+
+	// Submit the work so that it is complete before the first frame
+	spoutdx.Flush();
+	glFlush();
+
+	return true;
+
+}
+
 //---------------------------------------------------------
 // Function: UpdateSender
 // Update a sender
@@ -1765,6 +2596,32 @@ bool Spout::ReceiveTexture(char* name, unsigned int &width, unsigned int &height
 // Function: ReceiveImage
 // Receive image pixels
 bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, GLuint HostFbo)
+{
+	return ReceiveImage(pixels, 0, 0, glFormat, bInvert, HostFbo);
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImage
+// Receive image pixels to a buffer of given size
+//   Zero width and height is the sender size.
+//   For a different size, the shared texture is resampled on the GPU
+//   (see SetResampleMode) so that the data read back is the size of
+//   the buffer. Requires texture share and OpenGL 4.3.
+bool Spout::ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+	GLenum glFormat, bool bInvert, GLuint HostFbo)
+{
+	return ReceiveImage(pixels, width, height, 0, glFormat, bInvert, HostFbo);
+}
+
+//---------------------------------------------------------
+// Function: ReceiveImage
+// Receive image pixels to a buffer with a line pitch
+//   pitch is the bytes of each line including padding, for example
+//   an FFmpeg frame linesize, or 0 for packed pixels.
+//   Lines are written at the pitch directly from the mapped staging
+//   texture by spoutCopy, so the buffer must be the sender size.
+bool Spout::ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+	unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFbo)
 {
 	// The receiving pixel buffer is created after the first update
 	// so the pixel pointer can be NULL here
@@ -1775,8 +2632,14 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 		return true;
 	}
 
-	// Make sure OpenGL and DirectX are initialized
-	if (!OpenSpout()) {
+	// Make sure OpenGL and DirectX are initialized.
+	// Without an OpenGL context, initialize DirectX only
+	// and receive by way of DirectX or shared memory.
+	if (!wglGetCurrentContext() && !spoutdx.GetDX11Device()) {
+		if (!OpenHeadless())
+			return false;
+	}
+	else if (!OpenSpout()) {
 		return false;
 	}
 
@@ -1786,8 +2649,9 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 	}
 
 	// Check for BGRA support
+	// DirectX and shared memory pixels are converted without OpenGL
 	GLenum glformat = glFormat;
-	if (!m_bBGRAavailable) {
+	if (!m_bBGRAavailable && !m_bHeadless) {
 		// If the bgra extensions are not available and the user
 		// provided GL_BGR_EXT or GL_BGRA_EXT do not use them
 		if (glFormat == GL_BGR_EXT) glformat = GL_RGB; // GL_BGR_EXT
@@ -1816,6 +2680,23 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 			return false;
 		}
 
+		// Pixel buffer size
+		if (width == 0 || height == 0) {
+			width = m_Width;
+			height = m_Height;
+		}
+		const bool bResample = (width != m_Width || height != m_Height);
+
+		// Buffer lines with padding
+		const unsigned int rowbytes = width*((glFormat == GL_RGB || glFormat == GL_BGR_EXT) ? 3 : 4);
+		if (pitch > 0 && pitch < rowbytes)
+			return false;
+		const bool bPitch = (pitch > rowbytes);
+		if (!bPitch)
+			pitch = 0;
+		if (bPitch && bResample)
+			return false;
+
 		//
 		// Found a sender
 		//
@@ -1826,11 +2707,15 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 		// Was the sender's shared texture handle null ?
 		if (!m_dxShareHandle || m_bMemoryShare) {
 			// Possible existence of sender memory share map
-			// Currently only works for Texture share mode
-			if (m_bTextureShare) {
+			// Texture share mode or without OpenGL
+			if ((m_bTextureShare || m_bHeadless) && !bResample && !bPitch) {
 				ReadMemoryPixels(m_SenderName, pixels, m_Width, m_Height, glFormat, bInvert);
 			}
 		}
+		else if (bPitch && (m_bTextureShare || m_bCPUshare)) {
+			// Lines at the buffer pitch via DX11 staging textures
+			ReadDX11pixels(pixels, m_Width, m_Height, glformat, bInvert, pitch);
+		}
 		else if (m_bTextureShare) {
 			// Texture share compatible
 			// Read pixels using OpenGL via PBO
@@ -1839,9 +2724,10 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 			// 3840x2160 RGB 5 msec/frame RGBA 6 msec/frame
 			// FBO (ReadTextureData) - slower than DirectX method
 			// (3840x2160 RGB 30-60 msec/frame RGBA 30-60 msec/frame)
-			ReadGLDXpixels(pixels, m_Width, m_Height, glformat, bInvert, HostFbo);
+			// Resampled to the pixel buffer size if different
+			ReadGLDXpixels(pixels, width, height, glformat, bInvert, HostFbo);
 		}
-		else if (m_bCPUshare) {
+		else if (m_bCPUshare && !bResample) {
 			// Auto share enabled for DirectX CPU backup
 			// Read pixels via DX11 staging textures to an rgba or rgb buffer
 			// 1920x1080 RGB 7 msec/frame RGBA 2 msec/frame
@@ -1858,11 +2744,189 @@ bool Spout::ReceiveImage(unsigned char* pixels, GLenum glFormat, bool bInvert, G
 		m_bConnected = false;
 	}
 
+	// Release retained resources if idle or over the memory budget
+	CheckResources(m_bConnected);
+
 	// ReceiveImage fails if there is no sender or the connected sender closed.
 	return m_bConnected;
 
 } // end ReceiveImage
 
+//---------------------------------------------------------
+// Function: ReceiveImageYUV
+// Receive image pixels converted to planar YUV
+//
+//   For encoders that take NV12 or I420 input.
+//   The shared texture is converted by compute shader and only
+//   the YUV data is read back, half the size of RGBA pixels.
+//   Width and height must be even and the buffer width*height*3/2 bytes.
+//   The shared texture is sampled nearest for a different size.
+//   Requires texture share and OpenGL 4.3.
+bool Spout::ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+	SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert, GLuint HostFbo)
+{
+	// Return if flagged for update
+	// The update flag is reset when the receiving application calls IsUpdated()
+	if (m_bUpdated) {
+		return true;
+	}
+
+	// Make sure OpenGL and DirectX are initialized
+	if (!OpenSpout()) {
+		return false;
+	}
+
+	// Try to receive texture details from a sender
+	if (ReceiveSenderData()) {
+
+		if (m_bUpdated) {
+			// If the sender is new or changed, return to update the receiving buffer.
+			if (m_bTextureShare) {
+				// Flag "true" for receive
+				if (!CreateInterop(m_Width, m_Height, m_dwFormat, true)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// The receiving pixel buffer is created after the first update
+		if (!pixels || width < 2 || height < 2 || (width & 1) || (height & 1)) {
+			return false;
+		}
+
+		// Texture share only
+		if (m_dxShareHandle && !m_bMemoryShare && m_bTextureShare) {
+			ReadGLDXyuv(pixels, width, height, layout, matrix, bFullRange, bInvert, HostFbo);
+		}
+
+		m_bConnected = true;
+	} // sender exists
+	else {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		// Let the application know.
+		m_bConnected = false;
+	}
+
+	return m_bConnected;
+
+} // end ReceiveImageYUV
+
+//---------------------------------------------------------
+// Function: ReceiveImageView
+// Receive a view of the mapped sender frame without copy to a pixel buffer
+//
+//   The sender shared texture is copied to a ring of DirectX staging textures
+//   and the texture written on the previous frame is mapped for read.
+//   The view returns a pointer to the mapped data, the line pitch,
+//   width, height, DXGI format and sender frame number.
+//   For hosts that use the data directly, for example managed languages
+//   that wrap the pointer without copy to their own buffer.
+//
+//   The data remains valid until ReleaseImageView is called.
+//   ReleaseImageView must be called before the next ReceiveImageView
+//   or other receive functions. Any existing view is released here.
+//
+//   For a new sender or sender size change, IsUpdated() returns true
+//   and there is no image data until the following frame.
+//   Requires a texture sender. Memory share senders are not supported.
+bool Spout::ReceiveImageView(SpoutImageView &view)
+{
+	ReleaseImageView();
+	view = {};
+
+	// Return if flagged for update
+	if (m_bUpdated)
+		return false;
+
+	// Make sure DirectX is initialized
+	if (!wglGetCurrentContext() && !spoutdx.GetDX11Device()) {
+		if (!OpenHeadless())
+			return false;
+	}
+	else if (!OpenSpout()) {
+		return false;
+	}
+
+	// Try to receive texture details from a sender
+	if (!ReceiveSenderData()) {
+		// There is no sender or the connected sender closed.
+		ReleaseReceiver();
+		m_bConnected = false;
+		return false;
+	}
+
+	m_bConnected = true;
+
+	// If the sender is new or changed, return to update.
+	// The application detects the change with IsUpdated().
+	if (m_bUpdated) {
+		if (m_bTextureShare)
+			CreateInterop(m_Width, m_Height, m_dwFormat, true);
+		return false;
+	}
+
+	// The shared texture is needed for the staging copy
+	if (!m_dxShareHandle || m_bMemoryShare || !m_pSharedTexture)
+		return false;
+
+	// At least two staging textures are required
+	const int nStaging = (m_nStaging > 1) ? m_nStaging : 2;
+	if (!CheckStagingTextures(m_Width, m_Height, nStaging))
+		return false;
+
+	// Access the sender shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		// Copy a new frame to the current staging texture
+		if (frame.GetNewFrame()) {
+			m_Index = (m_Index + 1) % nStaging;
+			m_NextIndex = (m_Index + 1) % nStaging;
+			spoutdx.BeginGPUTime(spoutdx.GetDX11Context(), "GPUStagingCopy");
+			spoutdx.CopySharedTexture(spoutdx.GetDX11Context(), m_pStaging[m_Index], m_pSharedTexture);
+			spoutdx.EndGPUTime(spoutdx.GetDX11Context());
+			// Whole frames are copied, so changed regions start again
+			frame.ResetDirtyRects();
+			m_pDirtyPixels = nullptr;
+		}
+		// Allow access to the shared texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	// Map the oldest while the current one is occupied
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource = {};
+	spoutdx.GetDX11Context()->Flush();
+	const HRESULT hr = spoutdx.GetDX11Context()->Map(m_pStaging[m_NextIndex], 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	if (FAILED(hr)) {
+		SpoutLogWarning("Spout::ReceiveImageView - staging texture map failed (0x%.7X)", (unsigned int)hr);
+		return false;
+	}
+
+	m_pMappedStaging = m_pStaging[m_NextIndex];
+	view.data   = static_cast<const unsigned char*>(mappedSubResource.pData);
+	view.pitch  = mappedSubResource.RowPitch;
+	view.width  = m_Width;
+	view.height = m_Height;
+	view.format = m_dwFormat;
+	view.frame  = frame.GetSenderFrame();
+
+	// Release retained resources if idle or over the memory budget
+	CheckResources(m_bConnected);
+
+	return true;
+
+}
+
+//---------------------------------------------------------
+// Function: ReleaseImageView
+// Release the view returned by ReceiveImageView
+void Spout::ReleaseImageView()
+{
+	if (m_pMappedStaging && spoutdx.GetDX11Context())
+		spoutdx.GetDX11Context()->Unmap(m_pMappedStaging, 0);
+	m_pMappedStaging = nullptr;
+}
+
 //---------------------------------------------------------
 // Function: SelectSenderPanel
 // Open dialog for the user to select a sender
@@ -1929,6 +2993,8 @@ bool Spout::SelectSenderPanel(const char* message)
 	if (!hMutex1) {
 		// No mutex, so not running, so can open it
 		// Use ShellExecuteEx so we can test its return value later
+		// Release a previous wait and process handle
+		ReleaseSpoutPanel();
 		ZeroMemory(&m_ShExecInfo, sizeof(m_ShExecInfo));
 		m_ShExecInfo.cbSize = sizeof(SHELLEXECUTEINFO);
 		m_ShExecInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
@@ -1941,6 +3007,16 @@ bool Spout::SelectSenderPanel(const char* message)
 		m_ShExecInfo.hInstApp = NULL;
 		ShellExecuteExA(&m_ShExecInfo);
 
+		// Wait for the process to close on a thread pool thread
+		// so that the receiver does not test for it every frame
+		m_SpoutPanelClosed = 0;
+		if (m_ShExecInfo.hProcess) {
+			if (!RegisterWaitForSingleObject(&m_hSpoutPanelWait, m_ShExecInfo.hProcess,
+				SpoutPanelClosed, (PVOID)&m_SpoutPanelClosed, INFINITE, WT_EXECUTEONLYONCE)) {
+				m_hSpoutPanelWait = NULL;
+			}
+		}
+
 		//
 		// The flag "m_bSpoutPanelOpened" is set here to indicate that the user
 		// has opened the panel to select a sender. This flag is local to 
@@ -2015,11 +3091,14 @@ bool Spout::SelectSenderPanel(const char* message)
 } // end SelectSenderPanel
 
 //
-// Group: Legacy OpenGL Draw functions
+// Group: OpenGL Draw functions
 //
 // These functions are retained for compatibility with existing 2.006 code.
 //
-// Enabled for build with "legacyOpenGL" defined in SpoutCommon.h
+// For a build with "legacyOpenGL" defined in SpoutCommon.h, immediate mode
+// drawing is used and a compatibility context is required.
+// Otherwise the functions draw with a vertex array and shader program
+// (spoutShaders::Draw) and can be used with a core profile context.
 //
 #ifdef legacyOpenGL
 
@@ -2147,6 +3226,108 @@ bool Spout::DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget,
 
 	return bRet;
 
+} // end DrawToSharedTexture
+
+#else
+
+//---------------------------------------------------------
+// Function: DrawSharedTexture
+// Render the sender shared OpenGL texture to the bound framebuffer and viewport
+bool Spout::DrawSharedTexture(float max_x, float max_y, float aspect, bool bInvert, GLuint HostFBO)
+{
+	UNREFERENCED_PARAMETER(HostFBO);
+	if (!m_hInteropDevice || !m_hInteropObject)
+		return false;
+
+	if (!(m_caps & GLEXT_SUPPORT_DRAW))
+		return false;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	bool bRet = false;
+
+	// Wait for access to the shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		// go ahead and access the shared texture to draw it
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+			BeginGLTime("GPUShader");
+			bRet = m_pShaders->Draw(m_glTexture, max_x, max_y, aspect, bInvert);
+			EndGLTime();
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject); // unlock dx object
+		} // lock failed
+		// Release mutex and allow access to the texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	} // mutex lock failed
+
+	return bRet;
+
+} // end DrawSharedTexture
+
+//---------------------------------------------------------
+// Function: DrawToSharedTexture
+// Render OpenGL texture to the sender shared OpenGL texture.
+// The texture target must be GL_TEXTURE_2D.
+bool Spout::DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height,
+	float max_x, float max_y, float aspect,
+	bool bInvert, GLuint HostFBO)
+{
+	if (!m_hInteropDevice || !m_hInteropObject)
+		return false;
+
+	if (width != (unsigned  int)m_Width || height != (unsigned  int)m_Height)
+		return false;
+
+	if (TextureTarget != GL_TEXTURE_2D || !(m_caps & GLEXT_SUPPORT_DRAW))
+		return false;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	bool bRet = false;
+
+	// Wait for access to the shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+			// Draw the input texture into the shared texture via an fbo
+			GLenum status = GL_FRAMEBUFFER_COMPLETE_EXT;
+			const GLuint drawFbo = GetTextureFbo(m_glTexture, GL_TEXTURE_2D);
+			if (drawFbo) {
+				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, drawFbo);
+			}
+			else {
+				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+				glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_glTexture, 0);
+				status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+			}
+			if (status == GL_FRAMEBUFFER_COMPLETE_EXT) {
+				GLint viewport[4]={};
+				if (!m_bStateShadow || !GetHostViewport(viewport))
+					glGetIntegerv(GL_VIEWPORT, viewport);
+				glViewport(0, 0, (GLsizei)m_Width, (GLsizei)m_Height);
+				glClearColor(0.f, 0.f, 0.f, 1.f);
+				glClear(GL_COLOR_BUFFER_BIT);
+				BeginGLTime("GPUShader");
+				bRet = m_pShaders->Draw(TextureID, max_x, max_y, aspect, bInvert);
+				EndGLTime();
+				glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+			}
+			else {
+				PrintFBOstatus(status);
+			}
+			if (!drawFbo)
+				glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, 0, 0);
+			// restore the previous fbo - default is 0
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+		} // end interop lock
+		// Release mutex and allow access to the texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	} // mutex access failed
+
+	return bRet;
+
 } // end DrawToSharedTexture
 #endif
 
@@ -2183,7 +3364,18 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 		// Make sure that Spout has been initialized and an OpenGL context is available
 		if (OpenSpout()) {
 
-			if (m_bTextureShare) {
+			// Texture or CPU share by measured performance if selected by the user
+			if (!m_bMemoryRingSend)
+				CalibrateShareMode(width, height);
+
+			if (m_bMemoryRingSend) {
+				// Memory ring send (SetMemoryRingSend). There is no shared texture and receivers
+				// read the pixels from the memory ring created with the first frame.
+				m_bTextureShare = false;
+				m_bCPUshare = false;
+				m_dxShareHandle = nullptr;
+			}
+			else if (m_bTextureShare) {
 				// Create interop for GL/DX transfer
 				// Flag "false" for sender so that a new shared texture and handle are created.
 				// For a receiver the shared texture is created from the sender share handle.
@@ -2221,6 +3413,15 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 				//
 				SetSenderID(m_SenderName, m_bCPUshare, m_bUseGLDX);
 
+				// Record the number of views of an array texture sender
+				if (m_ArraySize > 1 && m_bTextureShare)
+					sendernames.SetSenderArraySize(m_SenderName, m_ArraySize);
+
+				// Record the adapter for the sender list
+				LUID luid={};
+				if (spoutdx.GetDeviceAdapterLuid(spoutdx.GetDX11Device(), luid))
+					sendernames.SetSenderAdapterLuid(m_SenderName, luid);
+
 				m_Width = width;
 				m_Height = height;
 
@@ -2229,6 +3430,7 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 
 				// Enable frame counting so the receiver gets frame number and fps
 				frame.EnableFrameCount(m_SenderName);
+				frame.SetTelemetryMode(m_bMemoryRingSend ? 1 : (m_bCPUshare ? 2 : 0));
 				
 				m_bInitialized = true;
 			}
@@ -2246,7 +3448,10 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 	else if (m_Width != width || m_Height != height) {
 
 		// Update the shared textures and interop
-		if (m_bTextureShare) {
+		if (m_bMemoryRingSend) {
+			// A memory ring of the new size is created with the next frame
+		}
+		else if (m_bTextureShare) {
 			// The linked textures cannot be re-sized so have to 
 			// be re-created. The interop object handle is then
 			// re-created from the linking of the new textures.
@@ -2284,6 +3489,8 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 			m_dwFormat = m_DX11format;
 			return false;
 		}
+		if (m_ArraySize > 1 && m_bTextureShare)
+			sendernames.SetSenderArraySize(m_SenderName, m_ArraySize);
 
 		m_Width = width;
 		m_Height = height;
@@ -2291,6 +3498,12 @@ bool Spout::CheckSender(unsigned int width, unsigned int height)
 
 	// endif initialization or size checks
 
+	// Let cleanup know that the sender is alive
+	sendernames.SetSenderHeartbeat(m_SenderName);
+
+	// Memory held by the sender for telemetry
+	CheckTelemetryMemory();
+
 	return true;
 }
 
@@ -2303,11 +3516,15 @@ void Spout::InitReceiver(const char * SenderName, unsigned int width, unsigned i
 
 	SpoutLogNotice("Spout::InitReceiver(%s, %dx%d)", SenderName, width, height);
 
+	// Texture or CPU share by measured performance if selected by the user
+	CalibrateShareMode(width, height);
+
 	// Create a named sender mutex for access to the sender's shared texture
 	frame.CreateAccessMutex(SenderName);
 
 	// Enable frame counting to get the sender frame number and fps
 	frame.EnableFrameCount(SenderName);
+	frame.SetTelemetryMode(m_bMemoryShare ? 1 : (m_bCPUshare ? 2 : 0));
 
 	// Set class globals
 	strcpy_s(m_SenderName, 256, SenderName);
@@ -2326,6 +3543,36 @@ bool Spout::ReceiveSenderData()
 {
 	m_bUpdated = false;
 
+	// Start the pre-connect thread if enabled
+	if (m_bPreconnect && !spoutdx.IsPreopen() && spoutdx.GetDX11Device())
+		spoutdx.StartPreopen(spoutdx.GetDX11Device(), m_SenderNameSetup);
+
+	// Release retained sender textures of senders that have closed
+	if (spoutdx.GetSharedTextureCount() > 0) {
+		const LONG generation = sendernames.GetSenderGeneration();
+		if (generation != m_SharedGeneration) {
+			m_SharedGeneration = generation;
+			spoutdx.CheckSharedTextures(sendernames);
+		}
+	}
+
+	// Without a sender, look for one only if a sender has been created,
+	// updated or closed, or at intervals for senders of earlier versions.
+	// This avoids opening the sender maps every frame while waiting.
+	if (!m_bSenderFound && !IsSenderSelected()
+		&& !sendernames.CheckSenderChange(m_SenderGeneration, m_dwSenderCheck))
+		return false;
+
+	// For a connected sender, read the sender information again only if
+	// the sender has changed it, any sender has been created, updated
+	// or closed, or at intervals in case the sender process has closed.
+	// Otherwise the test is two integer reads without opening a map.
+	if (m_bSenderFound && m_bInitialized && !IsSenderSelected()
+		&& !sendernames.CheckSenderInfoChange(m_SenderName, m_SenderInfoChange,
+			m_SenderInfoGeneration, m_dwSenderInfoCheck))
+		return true;
+	m_bSenderFound = false;
+
 	// Initialization is recorded in this class for sender or receiver
 	// m_Width or m_Height are established when the receiver connects to a sender
 
@@ -2359,6 +3606,8 @@ bool Spout::ReceiveSenderData()
 	SharedTextureInfo info;
 	if (sendernames.getSharedInfo(sendername, &info)) {
 
+		m_bSenderFound = true;
+
 		width = info.width;
 		height = info.height;
 		dxShareHandle = UIntToPtr(info.shareHandle);
@@ -2416,8 +3665,15 @@ bool Spout::ReceiveSenderData()
 		// Open the sender share handle to produce a new received texture
 		if (dxShareHandle != m_dxShareHandle || strcmp(sendername, m_SenderName) != 0) {
 
-			// Release everything to start again
-			ReleaseReceiver();
+			// For a size or format change of the same sender, only the
+			// sender texture and interop object are replaced (RelinkReceiver).
+			// Otherwise release everything to start again.
+			const bool bRelink = (m_bInitialized && m_dxShareHandle && m_pSharedTexture
+				&& strcmp(sendername, m_SenderName) == 0);
+			if (bRelink)
+				RelinkReceiver();
+			else
+				ReleaseReceiver();
 
 			// Update the sender share handle
 			m_dxShareHandle = dxShareHandle;
@@ -2425,7 +3681,9 @@ bool Spout::ReceiveSenderData()
 			// Get a new shared texture pointer from the share handle
 			if (m_dxShareHandle) {
 
-				if(spoutdx.OpenDX11shareHandle(spoutdx.GetDX11Device(), &m_pSharedTexture, dxShareHandle)) {
+				// A texture opened before for the sender is used without OpenSharedResource
+				if(spoutdx.OpenSharedTexture(spoutdx.GetDX11Device(), &m_pSharedTexture, dxShareHandle, sendername,
+					(info.usage & SPOUT_USAGE_NTHANDLE) != 0)) {
 
 					// Get the texture details
 					D3D11_TEXTURE2D_DESC desc={};
@@ -2436,6 +3694,9 @@ bool Spout::ReceiveSenderData()
 						return false;
 					}
 
+					// Number of views of an array texture sender
+					m_ArraySize = (desc.ArraySize > 1) ? desc.ArraySize : 1;
+
 					// For incorrect sender information, use dimensions and format
 					// of the D3D11 texture generated by OpenDX11shareHandle
 					if (width != (DWORD)desc.Width)	    width = (DWORD)desc.Width;
@@ -2461,8 +3722,17 @@ bool Spout::ReceiveSenderData()
 					}
 
 					// If the received texture is successfully updated, initialize again
-					// with the new sender name, width, height and format
-					InitReceiver(sendername, width, height, dwFormat);
+					// with the new sender name, width, height and format.
+					// The access mutex and frame count of the same sender are retained.
+					if (bRelink) {
+						m_Width = width;
+						m_Height = height;
+						m_dwFormat = dwFormat;
+						m_DX11format = (DXGI_FORMAT)m_dwFormat;
+					}
+					else {
+						InitReceiver(sendername, width, height, dwFormat);
+					}
 
 					// The application can now access and copy the sender texture.
 					// Signal the application to update the receiving texture or image
@@ -2488,6 +3758,11 @@ bool Spout::ReceiveSenderData()
 					if (m_pSharedTexture) 
 						spoutdx.ReleaseDX11Texture(GetDX11Device(), m_pSharedTexture);
 					m_pSharedTexture = nullptr;
+					// Complete the release if the receiver was re-linked
+					if (bRelink) {
+						ReleaseReceiver();
+						m_dxShareHandle = dxShareHandle;
+					}
 
 				} // endif OpenDX11shareHandle fail
 
@@ -2499,75 +3774,344 @@ bool Spout::ReceiveSenderData()
 	} // endif find sender
 
 	// There is no sender or the connected sender closed
+	spoutdx.EvictSharedTexture(sendername);
 	return false;
 
 }
 
+//---------------------------------------------------------
+// Prepare for a new texture of the connected sender.
+//
+// The sender texture is replaced if the sender size or format changes.
+// Only the previous sender texture and interop object are released.
+// The interop device, framebuffers, PBOs, access mutex and frame count
+// are retained for the new texture, and there is no wait as for
+// ReleaseReceiver, so that a sender that resizes continuously
+// does not cause the receiver to be rebuilt for every change.
+// The interop object is registered again by CreateInterop.
+void Spout::RelinkReceiver()
+{
+	SpoutLogNotice("Spout::RelinkReceiver");
+
+	// Un-register the previous sender texture but retain the interop device
+	if (m_hInteropDevice && m_hInteropObject && wglGetCurrentContext()) {
+		if (!ReleaseInteropObject())
+			SpoutLogWarning("Spout::RelinkReceiver - could not un-register interop");
+	}
+	m_hInteropObject = nullptr;
+	m_bInteropFailed = false;
+
+	// Release the previous sender texture
+	if (m_pSharedTexture) {
+		spoutdx.ReleaseDX11Texture(GetDX11Device(), m_pSharedTexture);
+		m_pSharedTexture = nullptr;
+	}
+	m_dxShareHandle = nullptr;
+
+}
+
 //---------------------------------------------------------
 // Check whether SpoutPanel opened and return the new sender name
+// or return a sender selected by SelectSender
 bool Spout::CheckSpoutPanel(char *sendername, int maxchars)
 {
 	if (!sendername)
 		return false;
 
-	// If SpoutPanel has been activated, test if the user has clicked OK
-	if (m_bSpoutPanelOpened) { // User has activated spout panel
-		SharedTextureInfo TextureInfo = {};
-		HANDLE hMutex = NULL;
-		DWORD dwExitCode = 0;
-		char newname[256]={};
-		bool bRet = false;
+	// Sender selected without SpoutPanel
+	if (m_SelectedSender[0]) {
+		strcpy_s(sendername, maxchars, m_SelectedSender);
+		m_SelectedSender[0] = 0;
+		return true;
+	}
+
+	// If SpoutPanel has been activated, test if it has closed.
+	// The process wait sets a flag, so there are no registry reads
+	// or process checks while the panel is open.
+	if (!IsSpoutPanelClosed())
+		return false;
+
+	m_bSpoutPanelOpened = false; // Don't do this part again
+	m_bSpoutPanelActive = false;
+
+	// Get the exit code from SpoutPanel
+	DWORD dwExitCode = 1;
+	if (m_ShExecInfo.hProcess)
+		GetExitCodeProcess(m_ShExecInfo.hProcess, &dwExitCode);
+	ReleaseSpoutPanel();
 
-		// Must find the mutex to signify that SpoutPanel has opened
-		// and then wait for the mutex to close
-		hMutex = OpenMutexA(MUTEX_ALL_ACCESS, 0, "SpoutPanel");
+	// Only act if exit code = 0 (OK)
+	if (dwExitCode != 0)
+		return false;
 
-		// Has it been activated 
-		if (!m_bSpoutPanelActive) {
-			// If the mutex has been found, set the active flag true and quit
-			// otherwise on the next round it will test for the mutex closed
-			if (hMutex) m_bSpoutPanelActive = true;
+	// SpoutPanel has been activated and OK clicked
+	// Test the active sender which should have been set by SpoutPanel
+	SharedTextureInfo TextureInfo = {};
+	char newname[256]={};
+	if (!sendernames.GetActiveSender(newname)) {
+		// Otherwise the sender might not be registered.
+		// SpoutPanel always writes the selected sender name to the registry.
+		if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "Sendername", newname)) {
+			// Register the sender if it exists
+			if (newname[0] != 0) {
+				if (sendernames.getSharedInfo(newname, &TextureInfo)) {
+					// Register in the list of senders and make it the active sender
+					sendernames.RegisterSenderName(newname);
+					sendernames.SetActiveSender(newname);
+				}
+			}
 		}
-		else if (!hMutex) { // It has now closed
-			m_bSpoutPanelOpened = false; // Don't do this part again
-			m_bSpoutPanelActive = false;
-			// call GetExitCodeProcess() with the hProcess member of
-			// global SHELLEXECUTEINFO to get the exit code from SpoutPanel
-			if (m_ShExecInfo.hProcess) {
-				GetExitCodeProcess(m_ShExecInfo.hProcess, &dwExitCode);
-				// Only act if exit code = 0 (OK)
-				if (dwExitCode == 0) {
-					// SpoutPanel has been activated and OK clicked
-					// Test the active sender which should have been set by SpoutPanel
-					newname[0] = 0;
-					if (!sendernames.GetActiveSender(newname)) {
-						// Otherwise the sender might not be registered.
-						// SpoutPanel always writes the selected sender name to the registry.
-						if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\SpoutPanel", "Sendername", newname)) {
-							// Register the sender if it exists
-							if (newname[0] != 0) {
-								if (sendernames.getSharedInfo(newname, &TextureInfo)) {
-									// Register in the list of senders and make it the active sender
-									sendernames.RegisterSenderName(newname);
-									sendernames.SetActiveSender(newname);
-								}
-							}
-						}
-					}
-					// Now do we have a valid sender name ?
-					if (newname[0] != 0) {
-						// Pass back the new name
-						strcpy_s(sendername, maxchars, newname);
-						bRet = true;
-					} // endif valid sender name
-				} // endif SpoutPanel OK
-			} // got the exit code
-		} // endif no mutex so SpoutPanel has closed
-		// If we opened the mutex, close it now or it is never released
-		if (hMutex) CloseHandle(hMutex);
-		return bRet;
-	} // SpoutPanel has not been opened
+	}
+
+	// Now do we have a valid sender name ?
+	if (newname[0] == 0)
+		return false;
+
+	// Pass back the new name
+	strcpy_s(sendername, maxchars, newname);
+
+	return true;
+
+}
 
+//---------------------------------------------------------
+// A sender has been selected by SelectSender or SpoutPanel has closed
+bool Spout::IsSenderSelected()
+{
+	return (m_SelectedSender[0] != 0 || IsSpoutPanelClosed());
+}
+
+//---------------------------------------------------------
+// SpoutPanel opened by SelectSenderPanel has closed
+bool Spout::IsSpoutPanelClosed()
+{
+	if (!m_bSpoutPanelOpened)
+		return false;
+
+	// Flag set by the process wait
+	if (m_hSpoutPanelWait)
+		return (InterlockedCompareExchange(&m_SpoutPanelClosed, 0, 0) != 0);
+
+	// Without a registered wait, test the process without waiting
+	if (m_ShExecInfo.hProcess)
+		return (WaitForSingleObject(m_ShExecInfo.hProcess, 0) == WAIT_OBJECT_0);
+
+	// SpoutPanel did not start
+	m_bSpoutPanelOpened = false;
 	return false;
+}
+
+//---------------------------------------------------------
+// Release the SpoutPanel process wait and process handle
+void Spout::ReleaseSpoutPanel()
+{
+	// Wait for a callback in progress to complete
+	if (m_hSpoutPanelWait)
+		UnregisterWaitEx(m_hSpoutPanelWait, INVALID_HANDLE_VALUE);
+	m_hSpoutPanelWait = NULL;
+	if (m_ShExecInfo.hProcess)
+		CloseHandle(m_ShExecInfo.hProcess);
+	m_ShExecInfo.hProcess = NULL;
+}
+
+//---------------------------------------------------------
+// Create the hidden window and OpenGL context of the receive thread.
+// The context has the pixel format, version and profile of the current
+// application context and shares objects with it.
+bool Spout::CreateReceiveContext()
+{
+	const HDC hAppDC = wglGetCurrentDC();
+	const HGLRC hAppRC = wglGetCurrentContext();
+	if (!hAppDC || !hAppRC) {
+		SpoutLogWarning("Spout::CreateReceiveContext - no OpenGL context");
+		return false;
+	}
+
+	// Extensions for the context and sync objects
+	if (!LoadGLextensions())
+		return false;
+
+	m_hReceiveWnd = CreateWindowA("BUTTON", "SpoutReceiveThread",
+		WS_OVERLAPPEDWINDOW | CS_OWNDC, 0, 0, 32, 32, NULL, NULL, NULL, NULL);
+	if (m_hReceiveWnd)
+		m_hReceiveDC = GetDC(m_hReceiveWnd);
+	if (!m_hReceiveDC) {
+		SpoutLogError("Spout::CreateReceiveContext - no window");
+		ReleaseReceiveContext();
+		return false;
+	}
+
+	// The same pixel format as the application context
+	PIXELFORMATDESCRIPTOR pfd={};
+	const int iFormat = GetPixelFormat(hAppDC);
+	if (iFormat == 0
+		|| DescribePixelFormat(hAppDC, iFormat, sizeof(pfd), &pfd) == 0
+		|| !SetPixelFormat(m_hReceiveDC, iFormat, &pfd)) {
+		SpoutLogError("Spout::CreateReceiveContext - pixel format error (%d)", GetLastError());
+		ReleaseReceiveContext();
+		return false;
+	}
+
+	// Version and profile of the application context
+	if (m_bCONTEXTavailable && wglCreateContextAttribsARB) {
+		GLint major = 0;
+		GLint minor = 0;
+		GLint profile = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		if (major > 3 || (major == 3 && minor >= 2))
+			glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+		glGetError(); // Clear the error of an earlier version
+		if (major >= 3) {
+			const int attribs[] = {
+				WGL_CONTEXT_MAJOR_VERSION_ARB, major,
+				WGL_CONTEXT_MINOR_VERSION_ARB, minor,
+				WGL_CONTEXT_PROFILE_MASK_ARB, profile ? profile : WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB,
+				0 };
+			m_hReceiveRC = wglCreateContextAttribsARB(m_hReceiveDC, hAppRC, attribs);
+		}
+	}
+	// Otherwise share objects with wglShareLists
+	if (!m_hReceiveRC) {
+		m_hReceiveRC = wglCreateContext(m_hReceiveDC);
+		if (m_hReceiveRC && !wglShareLists(hAppRC, m_hReceiveRC)) {
+			wglDeleteContext(m_hReceiveRC);
+			m_hReceiveRC = NULL;
+		}
+	}
+	if (!m_hReceiveRC) {
+		SpoutLogError("Spout::CreateReceiveContext - could not create shared context");
+		ReleaseReceiveContext();
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Release the context and window of the receive thread
+void Spout::ReleaseReceiveContext()
+{
+	if (m_hReceiveRC)
+		wglDeleteContext(m_hReceiveRC);
+	m_hReceiveRC = NULL;
+	if (m_hReceiveDC)
+		ReleaseDC(m_hReceiveWnd, m_hReceiveDC);
+	m_hReceiveDC = NULL;
+	if (m_hReceiveWnd)
+		DestroyWindow(m_hReceiveWnd);
+	m_hReceiveWnd = NULL;
+}
+
+DWORD WINAPI Spout::ReceiveThread(LPVOID lpParameter)
+{
+	Spout* pSpout = static_cast<Spout*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_WORKER);
+	pSpout->ReceiveLoop();
+	EndSpoutThread(SPOUT_THREAD_WORKER, hTask);
+	return 0;
+}
+
+//---------------------------------------------------------
+// Receive to the next free texture of the ring with the thread context
+void Spout::ReceiveLoop()
+{
+	if (!wglMakeCurrent(m_hReceiveDC, m_hReceiveRC)) {
+		SpoutLogError("Spout::ReceiveLoop - could not make the context current");
+		return;
+	}
+
+	// Receiver of the thread
+	Spout* pReceiver = new Spout;
+	if (m_ReceiveThreadName[0])
+		pReceiver->SetReceiverName(m_ReceiveThreadName);
+
+	while (WaitForSingleObject(m_hReceiveStop, 0) != WAIT_OBJECT_0) {
+
+		// A texture that is not the latest or in use by the application
+		AcquireSRWLockExclusive(&m_ReceiveLock);
+		int index = 0;
+		while (index == m_ReceiveLatest || index == m_ReceiveInUse)
+			index++;
+		const GLsync release = m_ReceiveRelease[index];
+		m_ReceiveRelease[index] = nullptr;
+		ReleaseSRWLockExclusive(&m_ReceiveLock);
+		SpoutThreadTexture &tex = m_ReceiveTexture[index];
+
+		// Wait on the GPU for the application to finish with the texture
+		if (release) {
+			if (glWaitSync)
+				glWaitSync(release, 0, GL_TIMEOUT_IGNORED);
+			glDeleteSync(release);
+		}
+
+		// Allocate the texture for the sender size
+		const unsigned int width = pReceiver->GetSenderWidth();
+		const unsigned int height = pReceiver->GetSenderHeight();
+		if (width > 0 && height > 0 && (tex.texture == 0 || tex.width != width || tex.height != height)) {
+			if (tex.texture == 0)
+				glGenTextures(1, &tex.texture);
+			glBindTexture(GL_TEXTURE_2D, tex.texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			tex.width = width;
+			tex.height = height;
+		}
+
+		bool bNewFrame = false;
+		if (tex.texture == 0) {
+			// Connect to find the sender size
+			pReceiver->ReceiveTexture();
+			pReceiver->IsUpdated();
+		}
+		else if (pReceiver->ReceiveTexture(tex.texture, GL_TEXTURE_2D, m_bReceiveThreadInvert)) {
+			// For a sender change, the texture is allocated on the next cycle
+			if (!pReceiver->IsUpdated() && pReceiver->IsFrameNew())
+				bNewFrame = true;
+		}
+
+		if (bNewFrame) {
+			if (tex.sync)
+				glDeleteSync(tex.sync);
+			tex.sync = nullptr;
+			if (glFenceSync) {
+				tex.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				// Flush for the fence to be seen by the application context
+				glFlush();
+			}
+			else {
+				glFinish();
+			}
+			tex.frame = pReceiver->GetSenderFrame();
+			strcpy_s(tex.sendername, 256, pReceiver->GetSenderName());
+			// Publish the texture for GetReceiveThreadTexture
+			AcquireSRWLockExclusive(&m_ReceiveLock);
+			m_ReceiveLatest = index;
+			m_bReceiveNew = true;
+			ReleaseSRWLockExclusive(&m_ReceiveLock);
+		}
+		else {
+			// Wait for the next frame
+			WaitForSingleObject(m_hReceiveStop, pReceiver->IsConnected() ? 1 : 10);
+		}
+	}
+
+	// Release the textures and receiver with the thread context current
+	for (int i = 0; i < SPOUT_THREAD_TEXTURES; i++) {
+		if (m_ReceiveRelease[i])
+			glDeleteSync(m_ReceiveRelease[i]);
+		if (m_ReceiveTexture[i].sync)
+			glDeleteSync(m_ReceiveTexture[i].sync);
+		if (m_ReceiveTexture[i].texture)
+			glDeleteTextures(1, &m_ReceiveTexture[i].texture);
+	}
+	ZeroMemory(m_ReceiveTexture, sizeof(m_ReceiveTexture));
+	ZeroMemory(m_ReceiveRelease, sizeof(m_ReceiveRelease));
+	delete pReceiver;
 
+	wglMakeCurrent(NULL, NULL);
 }
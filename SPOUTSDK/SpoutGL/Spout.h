@@ -34,6 +34,21 @@
 
 #include "SpoutGL.h"
 
+// Textures written in turn by the receive thread
+#define SPOUT_THREAD_TEXTURES 3
+
+//
+// Texture received by the receive thread (see Spout::StartReceiveThread)
+//
+struct SpoutThreadTexture {
+	GLuint texture; // RGBA GL_TEXTURE_2D shared with the application context
+	GLsync sync; // Fence after the copy to the texture
+	unsigned int width;
+	unsigned int height;
+	long frame; // Sender frame number
+	char sendername[256];
+};
+
 class SPOUT_DLLEXP Spout : public spoutGL {
 
 	public:
@@ -50,6 +65,9 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	void SetSenderName(const char* sendername = nullptr);
 	// Set sender DX11 shared texture format
 	void SetSenderFormat(DWORD dwFormat);
+	// Set the number of views of an array texture sender
+	//   The texture sent is GL_TEXTURE_2D_ARRAY with the same number of layers
+	void SetSenderArraySize(unsigned int arraysize);
 	// Release sender and resources
 	void ReleaseSender();
 	// Send OpenGL framebuffer
@@ -64,6 +82,14 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	bool SendTexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = true, GLuint HostFBO = 0);
 	// Send image pixels
 	bool SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFBO = 0);
+	// Send image pixels with a line pitch including padding
+	bool SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int pitch, GLenum glFormat, bool bInvert = false, GLuint HostFBO = 0);
+	// Begin rendering directly to the shared texture
+	//   Returns a framebuffer with the shared texture attached, bound for draw.
+	//   The image is not inverted. Render with the Y axis flipped.
+	GLuint BeginFrame(unsigned int width, unsigned int height);
+	// Send the frame rendered after BeginFrame and bind the host framebuffer
+	bool EndFrame(GLuint HostFBO = 0);
 	// Sender status
 	bool IsInitialized();
 	// Sender name
@@ -92,6 +118,11 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	//   If that sender closes, the receiver will wait for the nominated sender to open 
 	//   If no name is specified, the receiver will connect to the active sender
 	void SetReceiverName(const char * sendername = nullptr);
+	// Open sender textures on a thread when senders change
+	//   The receiver then connects without opening the texture
+	void SetPreconnect(bool bPreconnect = true);
+	// Pre-connect status
+	bool GetPreconnect();
 	// Close receiver and release resources ready to connect to another sender
 	void ReleaseReceiver();
 	// Receive shared texture
@@ -104,12 +135,37 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	//   For no change, copy the sender shared texture to the application texture
 	//   The texture must be RGBA of dimension (width * height) 
 	bool ReceiveTexture(GLuint TextureID, GLuint TextureTarget, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive a region of the sender texture
+	//   The region from xoffset, yoffset (top left) of size width x height
+	//   is copied to a texture of at least the region size
+	bool ReceiveTexture(GLuint TextureID, GLuint TextureTarget,
+		unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+		bool bInvert = false, GLuint HostFbo = 0);
 	// Receive image pixels
 	//   Connect to a sender and inform the application to update
 	//   the receiving buffer if it has changed dimensions
 	//   For no change, copy the sender shared texture to the pixel buffer
 	//   The receiving image can be RGBA, BGRA, RGB or BGR formats of dimension (width * height) 
 	bool ReceiveImage(unsigned char* pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive image pixels to a buffer of given size
+	//   The shared texture is resampled on the GPU if the size is different
+	bool ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+		GLenum glFormat, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive image pixels to a buffer with a line pitch including padding
+	//   Zero width and height is the sender size. The buffer must be the sender size.
+	bool ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+		unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFbo);
+	// Receive image pixels converted to planar YUV on the GPU
+	//   NV12 or I420, BT.601 or BT.709, limited or full range
+	//   Width and height must be even. The buffer size is width*height*3/2.
+	bool ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+		SpoutYUVLayout layout = SPOUT_YUV_NV12, SpoutYUVMatrix matrix = SPOUT_YUV_BT709,
+		bool bFullRange = false, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive a view of the mapped sender frame without copy to a pixel buffer
+	//   Valid until ReleaseImageView or the next receive call
+	bool ReceiveImageView(SpoutImageView &view);
+	// Release the view returned by ReceiveImageView
+	void ReleaseImageView();
 	// Query whether the sender has changed
 	//   Checked at every cycle before receiving data
 	bool IsUpdated();
@@ -128,10 +184,20 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	unsigned int GetSenderHeight();
 	// Received sender DX11 texture format
 	DWORD GetSenderFormat();
+	// Received sender number of views (1 for a single texture)
+	unsigned int GetSenderArraySize();
 	// Received sender frame rate
 	double GetSenderFps();
 	// Received sender frame number
 	long GetSenderFrame();
+	// Time in msec from sender publish to receipt of the last frame
+	double GetSenderFrameAge();
+	// Number of sender frames not received
+	LONG64 GetSenderMissedFrames();
+	// Frame statistics since connection or for the last second
+	void GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow = false);
+	// Reset frame statistics
+	void ResetSenderFrameStats();
 	// Received sender share handle
 	HANDLE GetSenderHandle();
 	// Received sender sharing method
@@ -140,6 +206,20 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	bool GetSenderGLDX();
 	// Open sender selection dialog
 	bool SelectSender();
+	// Select a sender without the dialog
+	bool SelectSender(const char* sendername);
+	// Select a sender by index of the sender list
+	bool SelectSender(int index);
+	// Receive on a thread with a hidden OpenGL context sharing objects with the application context
+	//   Call with the application context current
+	bool StartReceiveThread(const char* sendername = nullptr, bool bInvert = false);
+	// Stop the receive thread
+	void StopReceiveThread();
+	// Receive thread status
+	bool IsReceiveThread();
+	// Latest texture received by the thread
+	//   Returns false if there is no new frame since the last call
+	bool GetReceiveThreadTexture(SpoutThreadTexture &texture);
 
 	//
 	// Frame count
@@ -157,10 +237,32 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	void SetFrameSync(const char* SenderName);
 	// Wait or test for a sync event
 	bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
+	// Wait or test for the sync events of a number of senders
+	int WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout = 0);
 	// Enable / disable frame sync
 	void EnableFrameSync(bool bSync = true);
 	// Check for frame sync option
 	bool IsFrameSyncEnabled();
+	// Set the changed regions of the next frame sent
+	bool SetDirtyRects(const RECT* pRects, unsigned int nRects);
+	// Sender publish a GPU hash of the frame content with each frame
+	void EnableContentHash(bool bHash = true);
+	// Content hash option
+	bool IsContentHashEnabled();
+	// Sender read back the frames sent to CPU memory without waiting
+	void SetSendReadback(bool bReadback = true, SpoutReadbackCallback callback = nullptr, void* pUserData = nullptr);
+	// Read back option
+	bool GetSendReadback();
+	// Copy the latest frame read back to a pixel buffer of the sender size
+	bool ReadSendReadback(unsigned char* pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, LONG64* pFrame = nullptr);
+	// Receiver skip frames with the same content as the last received
+	void SetSkipUnchanged(bool bSkip = true);
+	// Skip unchanged frames option
+	bool GetSkipUnchanged();
+	// Receiver histograms and waveform of each frame received by compute shader
+	void SetReceiveAnalysis(bool bAnalyze = true);
+	// Latest histograms and waveform of the frames received
+	bool GetReceiveAnalysis(SpoutScopeData &data, bool bWait = false);
 
 	//
 	// Sender names
@@ -170,8 +272,12 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	int GetSenderCount();
 	// Sender item name
 	bool GetSender(int index, char* sendername, int MaxSize = 256);
+	// Copy the sender names to a buffer without allocation
+	int GetSenderNames(char* names, int maxsenders, int maxlength = 256);
 	// Sender information
 	bool GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat);
+	// Details of all senders
+	int GetSenderList(SpoutSenderDetails* pSenders, int maxsenders);
 	// Current active sender
 	bool GetActiveSender(char* sendername);
 	// Set sender as active
@@ -225,6 +331,8 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 
 	// Create a sender
 	bool CreateSender(const char *Sendername, unsigned int width = 0, unsigned int height = 0, DWORD dwFormat = 0);
+	// Create a sender and allocate resources used for sending
+	bool PrepareSender(const char* Sendername, unsigned int width, unsigned int height, DWORD dwFormat = 0);
 	// Update a sender
 	bool UpdateSender(const char* Sendername, unsigned int width, unsigned int height);
 
@@ -246,14 +354,13 @@ class SPOUT_DLLEXP Spout : public spoutGL {
 	// Receiver detect sender selection
 	bool CheckSpoutPanel(char *sendername, int maxchars = 256);
 
-	// Legacy OpenGL Draw functions
-	// See _SpoutCommon.h_ #define legacyOpenGL
-#ifdef legacyOpenGL
+	// OpenGL Draw functions
+	// Immediate mode if _SpoutCommon.h_ #define legacyOpenGL
+	// Otherwise core profile with a vertex array and shader program
 	// Render the shared texture
 	bool DrawSharedTexture(float max_x = 1.0, float max_y = 1.0, float aspect = 1.0, bool bInvert = true, GLuint HostFBO = 0);
 	// Render a texture to the shared texture. 
 	bool DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, float max_x = 1.0, float max_y = 1.0, float aspect = 1.0, bool bInvert = false, GLuint HostFBO = 0);
-#endif // #endif legacyOpenGL
 
 
 protected:
@@ -264,6 +371,14 @@ protected:
 	void InitReceiver(const char * sendername, unsigned int width, unsigned int height, DWORD dwFormat);
 	// Receiver find sender and retrieve information
 	bool ReceiveSenderData();
+	// Receiver release the previous texture for a sender texture change
+	void RelinkReceiver();
+	// A sender has been selected or SpoutPanel has closed
+	bool IsSenderSelected();
+	// SpoutPanel process has closed
+	bool IsSpoutPanelClosed();
+	// Release the SpoutPanel wait and process handle
+	void ReleaseSpoutPanel();
 
 	//
 	// Class globals
@@ -272,6 +387,27 @@ protected:
 	// Graphics adapter name
 	char m_AdapterName[256];
 	bool m_bAdapt; // Receiver adapt to the sender adapter
+	bool m_bFrameBegun; // BeginFrame has bound the shared framebuffer
+	bool m_bFrameLocked; // BeginFrame has locked the interop object and sender mutex
+
+	// Receive thread with a shared OpenGL context (StartReceiveThread)
+	static DWORD WINAPI ReceiveThread(LPVOID lpParameter);
+	void ReceiveLoop();
+	bool CreateReceiveContext();
+	void ReleaseReceiveContext();
+	HANDLE m_hReceiveThread;
+	HANDLE m_hReceiveStop;
+	HWND m_hReceiveWnd; // Hidden window of the thread context
+	HDC m_hReceiveDC;
+	HGLRC m_hReceiveRC; // Context sharing objects with the application context
+	char m_ReceiveThreadName[256];
+	bool m_bReceiveThreadInvert;
+	SRWLOCK m_ReceiveLock; // For the textures passed to the application
+	SpoutThreadTexture m_ReceiveTexture[SPOUT_THREAD_TEXTURES];
+	int m_ReceiveLatest; // Latest texture written, -1 if none
+	int m_ReceiveInUse; // Texture returned to the application, -1 if none
+	bool m_bReceiveNew; // The latest texture has not been returned
+	GLsync m_ReceiveRelease[SPOUT_THREAD_TEXTURES]; // Fence after application use of a texture
 
 
 };
@@ -5,7 +5,7 @@
 //
 // Includes header for common utilities namespace "SpoutUtils".
 //
-// Optional _#define legacyOpenGL_ to enable legacy draw functions
+// Optional _#define legacyOpenGL_ for immediate mode draw functions
 //
 
 /*
@@ -66,9 +66,10 @@
 
 //
 // This definition enables legacy OpenGL rendering code
-// used for shared texture Draw functions in SpoutGLDXinterop.cpp
+// used for shared texture Draw functions in Spout.cpp
 // Not required unless compatibility with OpenGL < 3 is necessary
-// Disabled by default for OpenGL 4 compliance
+// Disabled by default for OpenGL 4 compliance. The Draw functions
+// then use a vertex array and shader program (core profile).
 // * Note that the same definition is necessary in SpoutGLextensions.h
 //   so that SpoutGLextensions can be used independently of the Spout library.
 //
@@ -72,9 +72,55 @@
 	07.10.23 - Conditional compile options for _M_ARM64 in CheckSSE and header
 	20.10.23 - FlipBuffer / CopyPixels - default pitch width*4
 	Version 2.007.013
+	14.10.26 - CheckSSE - add AVX2 and AVX512 detection
+			   Add memcpy_avx2, rgba_bgra_avx2, rgba_bgra_avx512,
+			   rgba_to_rgb_avx2 and rgb_to_rgba_avx2
+			   Add SelectFunctions for runtime selection by function pointer
+			   RGBA/BGRA, RGBA/RGB and RGB/RGBA conversions use AVX2 if available
+			 - Add SetCopyThreads, SetCopyThreshold and StripeRows
+			   for conversion of large images by the system thread pool
+			 - Add SetInstructionLevel and GetInstructionLevel
+			   to compare conversion methods
+			 - Add rgb10a2_to_rgba, rgb10a2_to_rgb, rgba16f_to_rgba, rgba16f_to_rgb
+			   and rgba16f_to_rgba32f for 10 bit and half float textures
+			   CheckSSE - add F16C detection
+	15.10.26 - Add SetStreamThreshold and GetStreamThreshold.
+			   Images larger than the processor cache are copied with streaming stores
+			   and smaller images with memcpy so that they remain in the cache.
+			   Add CopyLine for CopyPixels, FlipBuffer, RemovePadding and rgba2rgba
+			 - memcpy_sse2 - align the destination and copy the start and end bytes
+			 - Streaming stores for RGBA/BGRA, RGBA/RGB and RGB/RGBA conversions
+			 - Add rgba_to_rgb_neon, rgb_to_rgba_neon and rgba_bgra_neon for ARM64
+			   instead of SSE functions translated by sse2neon
+			 - Add ConvertPixels for conversion between 8 bit OpenGL or DXGI formats
+			   from a table of pixel layouts. Conversions without an SSE, AVX2
+			   or NEON function use a line function compiled for each layout.
+			 - bgr2rgba with destination pitch - swap red and blue
+			 - Pool threads copying stripes use the worker thread settings
+			   (spoututils::BeginSpoutThread) and are restored after each image
+			 - Add EncodePixels and DecodePixels for lossless compression
+			   of memory share frames
+			 - CopyLine - streaming copy without sfence for each line.
+			   CopyPixels, FlipBuffer, RemovePadding and rgba2rgba call
+			   EndCopyLines for a single sfence after all the lines.
 */
 
 #include "SpoutCopy.h"
+#include "SpoutUtils.h" // for thread scheduling
+
+// Target attributes for AVX functions with Clang and GCC.
+// Not required for MSVC.
+#if defined(__clang__) || defined(__GNUC__)
+#define SPOUT_TARGET_AVX2 __attribute__((target("avx2")))
+#define SPOUT_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define SPOUT_TARGET_F16C __attribute__((target("avx2,f16c")))
+#define SPOUT_TARGET_XSAVE __attribute__((target("xsave")))
+#else
+#define SPOUT_TARGET_AVX2
+#define SPOUT_TARGET_AVX512
+#define SPOUT_TARGET_F16C
+#define SPOUT_TARGET_XSAVE
+#endif
 
 //
 // Class: spoutCopy
@@ -88,7 +134,15 @@ spoutCopy::spoutCopy() {
 	m_bSSE2 = false;
 	m_bSSE3 = false;
 	m_bSSSE3 = false;
-	CheckSSE(); // SSE available - sets m_bSSE2, m_bSSE3, m_bSSSE3
+	m_bAVX2 = false;
+	m_bAVX512 = false;
+	m_bF16C = false;
+	m_bNEON = false;
+	CheckSSE(); // SSE available - sets m_bSSE2, m_bSSE3, m_bSSSE3, m_bAVX2, m_bAVX512
+	SelectFunctions(); // Function pointers for the fastest methods
+	m_nCopyThreads = 1; // Single thread
+	m_CopyThreshold = 4*1024*1024; // 4 MB (1920x1080 RGB)
+	m_StreamThreshold = GetCacheSize(); // Last level cache
 }
 
 
@@ -96,9 +150,243 @@ spoutCopy::~spoutCopy() {
 
 }
 
+//
+// Group: Multiple threads
+//
+// Large images can be divided into row stripes and each stripe
+// converted by a thread of the system thread pool. 
+// The calling thread converts one stripe and waits for the others.
+// Resampling functions do not use multiple threads.
+//
+
+//---------------------------------------------------------
+// Function: SetCopyThreads
+// Number of threads for conversion of large images
+//
+//    0 - number of processors
+//    1 - single thread (default)
+//    Maximum 64
+void spoutCopy::SetCopyThreads(int nThreads)
+{
+	if (nThreads <= 0) {
+		SYSTEM_INFO info={};
+		GetSystemInfo(&info);
+		nThreads = (int)info.dwNumberOfProcessors;
+	}
+	if (nThreads > 64) nThreads = 64;
+	m_nCopyThreads = nThreads;
+}
+
+//---------------------------------------------------------
+// Function: GetCopyThreads
+// Number of threads for conversion of large images
+int spoutCopy::GetCopyThreads()
+{
+	return m_nCopyThreads;
+}
+
+//---------------------------------------------------------
+// Function: SetCopyThreshold
+// Minimum image size in bytes for multiple threads
+//    Default 4 MB
+void spoutCopy::SetCopyThreshold(unsigned int nBytes)
+{
+	m_CopyThreshold = nBytes;
+}
+
+//---------------------------------------------------------
+// Function: GetCopyThreshold
+// Minimum image size in bytes for multiple threads
+unsigned int spoutCopy::GetCopyThreshold()
+{
+	return m_CopyThreshold;
+}
+
+//
+// Group: Streaming stores
+//
+// An image larger than the processor cache is copied with streaming
+// (non-temporal) stores that bypass the cache. The image then does not
+// displace data in use by other threads, such as the render thread.
+// Smaller images are copied with normal stores and remain in the cache
+// for the next operation.
+//
+
+//---------------------------------------------------------
+// Function: SetStreamThreshold
+// Minimum image size in bytes for streaming stores
+//    Default size of the last level cache
+//    0 - all images
+void spoutCopy::SetStreamThreshold(unsigned int nBytes)
+{
+	m_StreamThreshold = nBytes;
+}
+
+//---------------------------------------------------------
+// Function: GetStreamThreshold
+// Minimum image size in bytes for streaming stores
+unsigned int spoutCopy::GetStreamThreshold()
+{
+	return m_StreamThreshold;
+}
+
+// Size of the last level processor cache in bytes
+unsigned int spoutCopy::GetCacheSize()
+{
+	unsigned int cachesize = 0;
+	DWORD dwSize = 0;
+	GetLogicalProcessorInformation(nullptr, &dwSize);
+	const DWORD count = dwSize/sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+	if (count > 0) {
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION* info = new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[count];
+		if (GetLogicalProcessorInformation(info, &dwSize)) {
+			BYTE level = 0;
+			for (DWORD i = 0; i < count; i++) {
+				if (info[i].Relationship == RelationCache
+					&& info[i].Cache.Type != CacheInstruction
+					&& info[i].Cache.Level >= level) {
+					if (info[i].Cache.Level > level) cachesize = 0;
+					level = info[i].Cache.Level;
+					if (info[i].Cache.Size > cachesize)
+						cachesize = (unsigned int)info[i].Cache.Size;
+				}
+			}
+		}
+		delete[] info;
+	}
+	if (cachesize == 0)
+		cachesize = 8*1024*1024; // 8 MB if not found
+	return cachesize;
+}
+
+//
+// Group: Instruction sets
+//
+// The fastest methods available are selected when the class is created.
+// A lower level limits the methods used, for example to compare
+// SSE and AVX conversions on the same computer.
+//
+
+//---------------------------------------------------------
+// Function: SetInstructionLevel
+// Highest instruction set to use
+//    SPOUT_COPY_SCALAR - no SSE or AVX
+//    SPOUT_COPY_SSE2, SPOUT_COPY_SSE3, SPOUT_COPY_SSSE3
+//    SPOUT_COPY_AVX2, SPOUT_COPY_AVX512 (default)
+// Instructions not supported by the CPU remain unused.
+// For ARM64, SPOUT_COPY_SSSE3 or higher selects NEON functions.
+void spoutCopy::SetInstructionLevel(SpoutCopyLevel level)
+{
+	CheckSSE();
+	if (level < SPOUT_COPY_AVX512) m_bAVX512 = false;
+	if (level < SPOUT_COPY_AVX2)   m_bAVX2 = false;
+	if (level < SPOUT_COPY_AVX2)   m_bF16C = false;
+	if (level < SPOUT_COPY_SSSE3)  m_bSSSE3 = false;
+	if (level < SPOUT_COPY_SSSE3)  m_bNEON = false;
+	if (level < SPOUT_COPY_SSE3)   m_bSSE3 = false;
+	if (level < SPOUT_COPY_SSE2)   m_bSSE2 = false;
+	SelectFunctions();
+}
+
+//---------------------------------------------------------
+// Function: GetInstructionLevel
+// Highest instruction set in use
+SpoutCopyLevel spoutCopy::GetInstructionLevel()
+{
+	if (m_bAVX512) return SPOUT_COPY_AVX512;
+	if (m_bAVX2)   return SPOUT_COPY_AVX2;
+	if (m_bSSSE3)  return SPOUT_COPY_SSSE3;
+	if (m_bSSE3)   return SPOUT_COPY_SSE3;
+	if (m_bSSE2)   return SPOUT_COPY_SSE2;
+	return SPOUT_COPY_SCALAR;
+}
+
+// True while a stripe is being copied, so that a function
+// called for a stripe does not divide it again
+static thread_local bool t_bStripe = false;
+
+// True if the image being copied is larger than the stream threshold.
+// Set by StripeRows for the whole image and retained for each stripe.
+static thread_local bool t_bStream = false;
+
+// Stripes of one image shared by the pool threads
+struct SpoutStripeJob {
+	void (*run)(const void* func, unsigned int y0, unsigned int y1);
+	const void* func;
+	unsigned int height;
+	unsigned int rows; // Rows per stripe
+	LONG stripes; // Number of stripes
+	volatile LONG next; // Next stripe to copy
+	bool stream; // Streaming stores
+};
+
+// Copy stripes until none are left
+static void RunStripeJob(SpoutStripeJob* job)
+{
+	t_bStripe = true;
+	t_bStream = job->stream;
+	LONG i = InterlockedIncrement(&job->next) - 1;
+	while (i < job->stripes) {
+		const unsigned int y0 = (unsigned int)i * job->rows;
+		unsigned int y1 = y0 + job->rows;
+		if (y1 > job->height || i == job->stripes - 1) y1 = job->height;
+		job->run(job->func, y0, y1);
+		i = InterlockedIncrement(&job->next) - 1;
+	}
+	t_bStripe = false;
+}
+
+// Pool threads have the worker settings only while copying stripes
+static void CALLBACK StripeCallback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK)
+{
+	const HANDLE hTask = spoututils::BeginSpoutThread(spoututils::SPOUT_THREAD_WORKER);
+	RunStripeJob(static_cast<SpoutStripeJob*>(context));
+	spoututils::EndSpoutThread(spoututils::SPOUT_THREAD_WORKER, hTask);
+}
+
+template <typename F>
+bool spoutCopy::StripeRows(unsigned int height, uint64_t bytes, const F& func) const
+{
+	// Streaming stores for an image larger than the cache
+	if (!t_bStripe)
+		t_bStream = (bytes >= (uint64_t)m_StreamThreshold);
+
+	if (m_nCopyThreads < 2 || t_bStripe || bytes < (uint64_t)m_CopyThreshold)
+		return false;
+
+	// Stripes are a multiple of 16 rows to retain 16 byte alignment
+	unsigned int rows = (height + m_nCopyThreads - 1) / m_nCopyThreads;
+	rows = (rows + 15) & ~15u;
+	const LONG stripes = (LONG)((height + rows - 1) / rows);
+	if (stripes < 2)
+		return false;
+
+	SpoutStripeJob job = {};
+	job.run = [](const void* f, unsigned int y0, unsigned int y1) { (*static_cast<const F*>(f))(y0, y1); };
+	job.func = &func;
+	job.height = height;
+	job.rows = rows;
+	job.stripes = stripes;
+	job.next = 0;
+	job.stream = t_bStream;
+
+	PTP_WORK work = CreateThreadpoolWork(StripeCallback, &job, nullptr);
+	if (!work)
+		return false;
+
+	// The calling thread copies stripes as well
+	for (LONG i = 1; i < stripes; i++)
+		SubmitThreadpoolWork(work);
+	RunStripeJob(&job);
+	WaitForThreadpoolWorkCallbacks(work, FALSE);
+	CloseThreadpoolWork(work);
+
+	return true;
+}
+
 //---------------------------------------------------------
 // Function: CopyPixels
-// Copy image pixels and select fastest method based on image width.
+// Copy image pixels and select fastest method based on image size.
 void spoutCopy::CopyPixels(const unsigned char *source, unsigned char *dest,
 	unsigned int width, unsigned int height, 
 	GLenum glFormat, bool bInvert) const
@@ -109,27 +397,20 @@ void spoutCopy::CopyPixels(const unsigned char *source, unsigned char *dest,
 	else if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
 		Size = width*height * 3;
 
+	// Multiple threads for large images
+	if (StripeRows(height, Size, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		CopyPixels(source + (uint64_t)y0 * (Size / height), dest + (uint64_t)ys * (Size / height),
+			width, y1 - y0, glFormat, bInvert);
+	}))
+		return;
+
 	if (bInvert) {
 		FlipBuffer(source, dest, width, height, glFormat);
 	}
 	else {
-		// Avoid warning C26474 and use implicit cast where possible
-		if (width < 320) { // Too small for assembler
-			// memcpy(reinterpret_cast<void *>(dest), reinterpret_cast<const void *>(source), Size);
-			memcpy(dest, source, Size);
-		}
-		else if ((Size % 16) == 0 && m_bSSE2) { // 16 byte aligned SSE assembler
-			// memcpy_sse2(reinterpret_cast<void *>(dest),	reinterpret_cast<const void *>(source), Size);
-			memcpy_sse2(dest, source, Size);
-		}
-		else if ((Size % 4) == 0) { // 4 byte aligned assembler
-			__movsd(reinterpret_cast<unsigned long *>(dest),
-				reinterpret_cast<const unsigned long *>(source), Size / 4);
-		}
-		else { // Default is standard memcpy
-			// memcpy(reinterpret_cast<void *>(dest), reinterpret_cast<const void *>(source), Size);
-			memcpy(dest, source, Size);
-		}
+		CopyLine(dest, source, Size);
+		EndCopyLines();
 	}
 }
 
@@ -148,26 +429,22 @@ void spoutCopy::FlipBuffer(const unsigned char *src,
 	else if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
 		pitch = width * 3; // RGB format specified (RGB float not supported)
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)pitch * height, [&](unsigned int y0, unsigned int y1) {
+		FlipBuffer(src + (uint64_t)y0 * pitch, dst + (uint64_t)(height - y1) * pitch,
+			width, y1 - y0, glFormat);
+	}))
+		return;
+
 	unsigned int line_s = 0;
 	unsigned int line_t = (height - 1)*pitch;
 
 	for (unsigned int y = 0; y<height; y++) {
-		// Avoid warning C26474 and use implicit cast where possible
-		if (width < 320 || height < 240) // too small for assembler
-			memcpy((dst + line_t), (src + line_s), pitch);
-			// memcpy(reinterpret_cast<void *>(dst + line_t), reinterpret_cast<const void *>(src + line_s), pitch);
-		else if ((pitch % 16) == 0 && m_bSSE2) // use sse assembler function
-			memcpy_sse2((dst + line_t), (src + line_s), pitch);
-			// memcpy_sse2(reinterpret_cast<void *>(dst + line_t),	reinterpret_cast<const void *>(src + line_s), pitch);
-		else if ((pitch % 4) == 0) // use 4 byte move assembler function
-			__movsd(reinterpret_cast<unsigned long *>(dst + line_t),
-				reinterpret_cast<const unsigned long *>(src + line_s), pitch / 4);
-		else
-			memcpy((dst + line_t), (src + line_s), pitch);
-			// memcpy(reinterpret_cast<void *>(dst + line_t), reinterpret_cast<const void *>(src + line_s), pitch);
+		CopyLine((dst + line_t), (src + line_s), pitch);
 		line_s += pitch;
 		line_t -= pitch;
 	}
+	EndCopyLines();
 
 }
 
@@ -183,27 +460,44 @@ void spoutCopy::RemovePadding(const unsigned char *source, unsigned char *dest,
 	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
 		pitch = width*3; // rgb
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)pitch * height, [&](unsigned int y0, unsigned int y1) {
+		RemovePadding(source + (uint64_t)y0 * stride, dest + (uint64_t)y0 * pitch,
+			width, y1 - y0, stride, glFormat);
+	}))
+		return;
+
 	// Remove the padding (stride-pitch)
 	for (unsigned int y = 0; y < height; y++) {
-		// Avoid warning C26474 and use implicit cast where possible
-		if (pitch < 320 || stride < 320) { // too small for assembler
-			// memcpy(reinterpret_cast<void *>(dest), reinterpret_cast<const void *>(source), pitch);
-			memcpy(dest, source, pitch);
-		}
-		else if ((pitch % 16) == 0 && (stride % 16) == 0 && m_bSSE2) { // use sse
-			// memcpy_sse2(reinterpret_cast<void *>(dest), reinterpret_cast<const void *>(source), pitch);
-			memcpy_sse2(dest, source, pitch);
-		}
-		else if ((pitch % 4) == 0 && (stride % 4) == 0) { // 4 byte move
-			__movsd(reinterpret_cast<unsigned long *>(dest), reinterpret_cast<const unsigned long *>(source), pitch/4);
-		}
-		else {
-			// memcpy(reinterpret_cast<void *>(dest), reinterpret_cast<const void *>(source), pitch);
-			memcpy(dest, source, pitch);
-		}
+		CopyLine(dest, source, pitch);
 		source += stride;
 		dest   += pitch;
 	}
+	EndCopyLines();
+}
+
+//---------------------------------------------------------
+// Function: CopyLine
+// Copy a line or an image with the method selected by StripeRows.
+//
+//    Streaming stores for an image larger than the stream threshold.
+//    Otherwise memcpy so that the image remains in the cache.
+//    EndCopyLines must be called after the last line.
+void spoutCopy::CopyLine(void* dst, const void* src, size_t Size) const
+{
+	if (t_bStream && Size >= 1280 && (m_bAVX2 || m_bSSE2))
+		(this->*m_pStreamCopy)(dst, src, Size);
+	else
+		memcpy(dst, src, Size);
+}
+
+//---------------------------------------------------------
+// Function: EndCopyLines
+// One sfence for all the streaming stores of CopyLine
+void spoutCopy::EndCopyLines() const
+{
+	if (t_bStream && (m_bAVX2 || m_bSSE2))
+		_mm_sfence(); // Streaming stores complete
 }
 
 //
@@ -224,7 +518,17 @@ void spoutCopy::RemovePadding(const unsigned char *source, unsigned char *dest,
 //---------------------------------------------------------
 // Function: memcpy_sse2
 // SSE2 version of memcpy
+//
+//    Any size or alignment. The destination is aligned to 16 bytes
+//    for streaming stores. Start and end bytes use memcpy.
 void spoutCopy::memcpy_sse2(void* dst, const void* src, size_t Size) const
+{
+	streamcopy_sse2(dst, src, Size);
+	_mm_sfence(); // Streaming stores complete
+}
+
+// SSE2 streaming copy without sfence (CopyLine)
+void spoutCopy::streamcopy_sse2(void* dst, const void* src, size_t Size) const
 {
 
 	if (!dst || !src)
@@ -232,7 +536,16 @@ void spoutCopy::memcpy_sse2(void* dst, const void* src, size_t Size) const
 
 	auto pSrc = static_cast<const char *>(src); // Source buffer
 	auto pDst = static_cast<char *>(dst); // Destination buffer
-	const unsigned int n = (unsigned int)Size >> 7; // Counter = size divided by 128 (8 * 128bit registers)
+
+	// Align the destination
+	size_t head = (16 - (reinterpret_cast<uintptr_t>(pDst) & 15)) & 15;
+	if (head > Size) head = Size;
+	if (head > 0) {
+		memcpy(pDst, pSrc, head);
+		pSrc += head;
+		pDst += head;
+		Size -= head;
+	}
 
 	__m128i Reg0={};
 	__m128i Reg1={};
@@ -242,32 +555,26 @@ void spoutCopy::memcpy_sse2(void* dst, const void* src, size_t Size) const
 	__m128i Reg5={};
 	__m128i Reg6={};
 	__m128i Reg7={};
-	for (unsigned int Index = n; Index > 0; --Index) {
+	for (size_t Index = Size >> 7; Index > 0; --Index) { // Counter = size divided by 128 (8 * 128bit registers)
 
-		// SSE2 prefetch
+		// SSE2 prefetch two cache lines, 256 bytes ahead
 		_mm_prefetch(pSrc + 256, _MM_HINT_NTA);
-		_mm_prefetch(pSrc + 256 + 64, _MM_HINT_NTA); // ??? TODO : why
-
-		// TODO - research and optimize - minor (0.1msec) speed difference noted
-		// _mm_prefetch(pSrc, _MM_HINT_NTA);
+		_mm_prefetch(pSrc + 256 + 64, _MM_HINT_NTA);
 
 		// move data from src to registers
 		// 8 x 128 bit (16 bytes each)
 		// Increment source pointer by 16 bytes each
 		// for a total of 128 bytes per cycle
-		Reg0 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc));
-		Reg1 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 16));
-		Reg2 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 32));
-		Reg3 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 48));
-		Reg4 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 64));
-		Reg5 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 80));
-		Reg6 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 96));
-		Reg7 = _mm_load_si128(reinterpret_cast<const __m128i *>(pSrc + 112));
+		Reg0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc));
+		Reg1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 16));
+		Reg2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 32));
+		Reg3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 48));
+		Reg4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 64));
+		Reg5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 80));
+		Reg6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 96));
+		Reg7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 112));
 
 		// move data from registers to dest
-		// TODO
-		// _mm_prefetch((const char*)(pSrc + 256), _MM_HINT_NTA);
-
 		_mm_stream_si128(reinterpret_cast<__m128i *>(pDst), Reg0);
 		_mm_stream_si128(reinterpret_cast<__m128i *>(pDst + 16), Reg1);
 		_mm_stream_si128(reinterpret_cast<__m128i *>(pDst + 32), Reg2);
@@ -281,8 +588,398 @@ void spoutCopy::memcpy_sse2(void* dst, const void* src, size_t Size) const
 		pDst += 128;
 	}
 
+	// Remaining bytes
+	Size &= 127;
+	if (Size > 0)
+		memcpy(pDst, pSrc, Size);
+
+}
+
+//---------------------------------------------------------
+// Function: memcpy_avx2
+// AVX2 version of memcpy
+//
+//    Any size or alignment. The destination is aligned to 32 bytes
+//    for streaming stores. Start and end bytes use memcpy.
+void spoutCopy::memcpy_avx2(void* dst, const void* src, size_t Size) const
+{
+	streamcopy_avx2(dst, src, Size);
+#ifndef _M_ARM64
+	_mm_sfence(); // Streaming stores complete
+#endif
+}
+
+// AVX2 streaming copy without sfence (CopyLine)
+SPOUT_TARGET_AVX2
+void spoutCopy::streamcopy_avx2(void* dst, const void* src, size_t Size) const
+{
+	if (!dst || !src)
+		return;
+
+#ifdef _M_ARM64
+	memcpy(dst, src, Size);
+#else
+	auto pSrc = static_cast<const char *>(src); // Source buffer
+	auto pDst = static_cast<char *>(dst); // Destination buffer
+
+	// Align the destination
+	size_t head = (32 - (reinterpret_cast<uintptr_t>(pDst) & 31)) & 31;
+	if (head > Size) head = Size;
+	if (head > 0) {
+		memcpy(pDst, pSrc, head);
+		pSrc += head;
+		pDst += head;
+		Size -= head;
+	}
+
+	// 4 * 256bit registers, 128 bytes per cycle
+	for (size_t Index = Size >> 7; Index > 0; --Index) {
+		_mm_prefetch(pSrc + 256, _MM_HINT_NTA);
+		_mm_prefetch(pSrc + 256 + 64, _MM_HINT_NTA);
+		const __m256i Reg0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pSrc));
+		const __m256i Reg1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pSrc + 32));
+		const __m256i Reg2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pSrc + 64));
+		const __m256i Reg3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pSrc + 96));
+		_mm256_stream_si256(reinterpret_cast<__m256i *>(pDst), Reg0);
+		_mm256_stream_si256(reinterpret_cast<__m256i *>(pDst + 32), Reg1);
+		_mm256_stream_si256(reinterpret_cast<__m256i *>(pDst + 64), Reg2);
+		_mm256_stream_si256(reinterpret_cast<__m256i *>(pDst + 96), Reg3);
+		pSrc += 128;
+		pDst += 128;
+	}
+
+	// Remaining bytes
+	Size &= 127;
+	if (Size > 0)
+		memcpy(pDst, pSrc, Size);
+#endif
+
+} // end streamcopy_avx2
+
+//
+// Group: Lossless compression
+//
+// EncodePixels compresses rgba pixels for transfer by shared memory
+// where bandwidth is limited, for example into a virtual machine.
+// The image is a stream of 32 bit pixels coded with 32 bit tokens.
+// The top two bits of a token are the type and the rest the pixel count.
+//
+//    SPOUT_CODEC_LITERAL - pixels follow the token
+//    SPOUT_CODEC_UP      - pixels are the same as the line above
+//    SPOUT_CODEC_RUN     - one pixel follows, repeated for the count
+//
+// Matching spans are found four pixels at a time with SSE2.
+// Desktop, user interface and graphic content compresses well.
+// Noisy or photographic content does not and is not compressed.
+//
+
+#define SPOUT_CODEC_LITERAL 0u
+#define SPOUT_CODEC_UP      1u
+#define SPOUT_CODEC_RUN     2u
+#define SPOUT_CODEC_COUNT   0x3FFFFFFFu
+
+//---------------------------------------------------------
+// Function: MatchPixels
+// Number of pixels from the start that are the same in both buffers.
+// The buffers can overlap.
+size_t spoutCopy::MatchPixels(const uint32_t* a, const uint32_t* b, size_t count)
+{
+	size_t i = 0;
+	while (i + 4 <= count) {
+		const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+		const int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		if (mask != 0xF) {
+			unsigned long first = 0;
+			_BitScanForward(&first, (unsigned long)(~mask & 0xF));
+			return i + first;
+		}
+		i += 4;
+	}
+	while (i < count && a[i] == b[i])
+		i++;
+	return i;
+}
+
+//---------------------------------------------------------
+// Function: EncodePixels
+// Compress rgba pixels to a buffer of maximum size.
+// Returns the compressed bytes, or 0 if they are not smaller than the maximum.
+unsigned int spoutCopy::EncodePixels(const unsigned char* rgba, unsigned char* dest,
+	unsigned int width, unsigned int height, unsigned int maxbytes) const
+{
+	if (!rgba || !dest || width == 0 || height == 0)
+		return 0;
+
+	const size_t npixels = (size_t)width * height;
+	if (npixels > SPOUT_CODEC_COUNT)
+		return 0;
+
+	const uint32_t* pix = reinterpret_cast<const uint32_t*>(rgba);
+	unsigned char* out = dest;
+	unsigned char* const end = dest + maxbytes;
+	size_t literal = 0; // Start of pixels not yet written
+	size_t i = 0;
+
+	// Write a token and the pixels that follow it
+	auto Token = [&](uint32_t type, size_t count, const uint32_t* pixels, size_t npix) -> bool {
+		const size_t bytes = 4 + npix * 4;
+		if ((size_t)(end - out) < bytes)
+			return false;
+		const uint32_t token = (type << 30) | (uint32_t)count;
+		memcpy(out, &token, 4);
+		if (npix > 0)
+			memcpy(out + 4, pixels, npix * 4);
+		out += bytes;
+		return true;
+	};
+
+	while (i < npixels) {
+		// Pixels the same as the line above
+		const size_t up = (i >= width) ? MatchPixels(pix + i, pix + i - width, npixels - i) : 0;
+		// Pixels the same as this one
+		const size_t run = 1 + MatchPixels(pix + i + 1, pix + i, npixels - i - 1);
+		if (up < 2 && run < 3) {
+			i++; // Literal
+			continue;
+		}
+		if (i > literal && !Token(SPOUT_CODEC_LITERAL, i - literal, pix + literal, i - literal))
+			return 0;
+		if (up >= run) {
+			if (!Token(SPOUT_CODEC_UP, up, nullptr, 0))
+				return 0;
+			i += up;
+		}
+		else {
+			if (!Token(SPOUT_CODEC_RUN, run, pix + i, 1))
+				return 0;
+			i += run;
+		}
+		literal = i;
+	}
+	if (i > literal && !Token(SPOUT_CODEC_LITERAL, i - literal, pix + literal, i - literal))
+		return 0;
+
+	// Not smaller than the maximum
+	if (out >= end)
+		return 0;
+
+	return (unsigned int)(out - dest);
+
+} // end EncodePixels
+
+//---------------------------------------------------------
+// Function: DecodePixels
+// Decompress pixels compressed by EncodePixels.
+//
+//    Returns false if the data is incomplete or not the image size.
+//    The source can be shared memory written during the decode,
+//    so all counts are checked against the source and image size.
+bool spoutCopy::DecodePixels(const unsigned char* source, unsigned int size,
+	unsigned char* rgba, unsigned int width, unsigned int height) const
+{
+	if (!source || !rgba || width == 0 || height == 0)
+		return false;
+
+	const size_t npixels = (size_t)width * height;
+	uint32_t* pix = reinterpret_cast<uint32_t*>(rgba);
+	const unsigned char* in = source;
+	const unsigned char* const end = source + size;
+	size_t i = 0;
+
+	while (i < npixels) {
+		if (end - in < 4)
+			return false;
+		uint32_t token = 0;
+		memcpy(&token, in, 4);
+		in += 4;
+		const uint32_t type = token >> 30;
+		const size_t count = token & SPOUT_CODEC_COUNT;
+		if (count == 0 || count > npixels - i)
+			return false;
+
+		if (type == SPOUT_CODEC_LITERAL) {
+			if ((size_t)(end - in) < count * 4)
+				return false;
+			memcpy(pix + i, in, count * 4);
+			in += count * 4;
+		}
+		else if (type == SPOUT_CODEC_UP) {
+			if (i < width)
+				return false;
+			// The span can be longer than a line.
+			// Copy a line at a time so that source and destination do not overlap.
+			size_t done = 0;
+			while (done < count) {
+				const size_t n = (count - done < width) ? count - done : width;
+				memcpy(pix + i + done, pix + i + done - width, n * 4);
+				done += n;
+			}
+		}
+		else if (type == SPOUT_CODEC_RUN) {
+			if (end - in < 4)
+				return false;
+			uint32_t value = 0;
+			memcpy(&value, in, 4);
+			in += 4;
+			for (size_t n = 0; n < count; n++)
+				pix[i + n] = value;
+		}
+		else {
+			return false;
+		}
+		i += count;
+	}
+
+	return true;
+
+} // end DecodePixels
+
+//
+// Group: Pixel layouts
+//
+// ConvertPixels converts between 8 bit pixel layouts identified by
+// OpenGL format (GL_RGBA, GL_BGRA_EXT, GL_RGB, GL_BGR_EXT) or DXGI
+// texture format (DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM).
+// The layout table gives the bytes per pixel and channel order of each format.
+// Conversions use the SSE, AVX2 or NEON functions if available.
+// Others use a line function compiled for the source and destination
+// layouts, so that the loop has no branches and can be vectorised.
+//
+
+// Layout of an 8 bit format
+struct SpoutPixelLayout {
+	DWORD format; // OpenGL or DXGI format
+	unsigned int bytes; // Bytes per pixel
+	bool bBGR; // Blue first
+};
+
+static const SpoutPixelLayout PixelLayouts[] = {
+	{ GL_RGBA,     4, false },
+	{ GL_BGRA_EXT, 4, true  },
+	{ GL_RGB,      3, false },
+	{ GL_BGR_EXT,  3, true  },
+	{ 28, 4, false }, // DXGI_FORMAT_R8G8B8A8_UNORM
+	{ 29, 4, false }, // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	{ 87, 4, true  }, // DXGI_FORMAT_B8G8R8A8_UNORM
+	{ 88, 4, true  }, // DXGI_FORMAT_B8G8R8X8_UNORM
+	{ 91, 4, true  }, // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+};
+
+static const SpoutPixelLayout* GetPixelLayout(DWORD format)
+{
+	for (const SpoutPixelLayout& layout : PixelLayouts) {
+		if (layout.format == format)
+			return &layout;
+	}
+	return nullptr;
+}
+
+// Convert one line. Alpha is copied, or 255 for a 3 byte source.
+template <unsigned int SrcBytes, unsigned int DstBytes, bool bSwapRB>
+static void ConvertLine(const unsigned char* src, unsigned char* dst, unsigned int width)
+{
+	const unsigned int ir = bSwapRB ? 2 : 0;
+	const unsigned int ib = bSwapRB ? 0 : 2;
+	for (unsigned int x = 0; x < width; x++) {
+		dst[ir] = src[0];
+		dst[1]  = src[1];
+		dst[ib] = src[2];
+		if (DstBytes == 4)
+			dst[3] = (SrcBytes == 4) ? src[3] : (unsigned char)255;
+		src += SrcBytes;
+		dst += DstBytes;
+	}
 }
 
+// Line functions indexed by 4 byte source, 4 byte destination and red/blue swap
+typedef void (*SpoutConvertLine)(const unsigned char* src, unsigned char* dst, unsigned int width);
+static const SpoutConvertLine ConvertLines[2][2][2] = {
+	{ { ConvertLine<3, 3, false>, ConvertLine<3, 3, true> }, { ConvertLine<3, 4, false>, ConvertLine<3, 4, true> } },
+	{ { ConvertLine<4, 3, false>, ConvertLine<4, 3, true> }, { ConvertLine<4, 4, false>, ConvertLine<4, 4, true> } }
+};
+
+//---------------------------------------------------------
+// Function: ConvertPixels
+// Convert 8 bit pixels between OpenGL or DXGI formats
+// allowing for source and destination line pitch.
+// A zero pitch is the width of the format.
+// Returns false if a format is not in the layout table.
+bool spoutCopy::ConvertPixels(const void* source, void* dest, unsigned int width, unsigned int height,
+	DWORD sourceFormat, DWORD destFormat,
+	unsigned int sourcePitch, unsigned int destPitch, bool bInvert) const
+{
+	if (!source || !dest || width == 0 || height == 0)
+		return false;
+
+	const SpoutPixelLayout* src = GetPixelLayout(sourceFormat);
+	const SpoutPixelLayout* dst = GetPixelLayout(destFormat);
+	if (!src || !dst)
+		return false;
+
+	if (sourcePitch == 0) sourcePitch = width * src->bytes;
+	if (destPitch == 0) destPitch = width * dst->bytes;
+	const bool bSwapRB = (src->bBGR != dst->bBGR);
+
+	//
+	// SSE, AVX2 or NEON functions
+	//
+
+	// RGBA > RGBA, RGBA > BGRA
+	if (src->bytes == 4 && dst->bytes == 4) {
+		if (bSwapRB)
+			rgba2bgra(source, dest, width, height, sourcePitch, destPitch, bInvert);
+		else
+			rgba2rgba(source, dest, width, height, sourcePitch, destPitch, bInvert);
+		return true;
+	}
+
+	// RGBA > RGB without destination padding
+	if (src->bytes == 4 && dst->bytes == 3 && destPitch == width * 3) {
+		rgba2rgb(source, dest, width, height, sourcePitch, bInvert, false, bSwapRB);
+		return true;
+	}
+
+	// RGB > RGBA without source padding
+	if (src->bytes == 3 && dst->bytes == 4 && sourcePitch == width * 3) {
+		if (bSwapRB)
+			rgb2bgra(source, dest, width, height, destPitch, bInvert);
+		else
+			rgb2rgba(source, dest, width, height, destPitch, bInvert);
+		return true;
+	}
+
+	//
+	// Line functions
+	//
+
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		ConvertPixels(static_cast<const unsigned char*>(source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(dest) + (uint64_t)ys * destPitch,
+			width, y1 - y0, sourceFormat, destFormat, sourcePitch, destPitch, bInvert);
+	}))
+		return true;
+
+	const SpoutConvertLine line = ConvertLines[src->bytes == 4][dst->bytes == 4][bSwapRB];
+	auto s = static_cast<const unsigned char*>(source);
+	auto d = static_cast<unsigned char*>(dest);
+	int64_t step = (int64_t)destPitch;
+	if (bInvert) {
+		d += (uint64_t)(height - 1) * destPitch; // beginning of the last line
+		step = -step; // move up a line for invert
+	}
+	for (unsigned int y = 0; y < height; y++) {
+		line(s, d, width);
+		s += sourcePitch;
+		d += step;
+	}
+
+	return true;
+
+} // end ConvertPixels
+
 //
 // Group: RGBA <> RGBA
 //
@@ -296,6 +993,15 @@ void spoutCopy::rgba2rgba(const void* rgba_source, void* rgba_dest,
 	if (!rgba_source || !rgba_dest)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2rgba(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, sourcePitch, bInvert);
+	}))
+		return;
+
 	for (unsigned int y = 0; y < height; y++) {
 
 		// Start of buffers
@@ -322,8 +1028,9 @@ void spoutCopy::rgba2rgba(const void* rgba_source, void* rgba_dest,
 			dest   += YxW;
 		}
 		// Copy the line as fast as possible
-		CopyPixels((const unsigned char*)source, (unsigned char*)dest, width, 1);
+		CopyLine(dest, source, (size_t)width*4);
 	}
+	EndCopyLines();
 }
 
 //---------------------------------------------------------
@@ -336,6 +1043,15 @@ void spoutCopy::rgba2rgba(const void* rgba_source, void* rgba_dest,
 	if (!rgba_source || !rgba_dest)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2rgba(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * destPitch,
+			width, y1 - y0, sourcePitch, destPitch, bInvert);
+	}))
+		return;
+
 	// For all rows
 	for (unsigned int y = 0; y < height; y++) {
 		
@@ -356,8 +1072,9 @@ void spoutCopy::rgba2rgba(const void* rgba_source, void* rgba_dest,
 			dest   += (unsigned long)(y * destPitch / 4);
 		}
 		// Copy the line as fast as possible
-		CopyPixels((const unsigned char*)source, (unsigned char*)dest, width, 1);
+		CopyLine(dest, source, (size_t)width*4);
 	}
+	EndCopyLines();
 }
 
 // Adapted from :
@@ -415,15 +1132,16 @@ void spoutCopy::rgba2bgra(const void* rgba_source, void* bgra_dest,
 	if (!rgba_source || !bgra_dest)
 		return;
 
-	if ((width % 16) == 0) { // 16 byte aligned width
-		if (m_bSSE2 && m_bSSSE3) // SSE3 available
-			rgba_bgra_sse3(rgba_source, bgra_dest, width, height, bInvert);
-		else if (m_bSSE2) // SSE2 available
-			rgba_bgra_sse2(rgba_source, bgra_dest, width, height, bInvert);
-	}
-	else {
-		rgba_bgra(rgba_source, bgra_dest, width, height, bInvert);
-	}
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2bgra(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * width * 4,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	rgba_bgra_fast(rgba_source, bgra_dest, width, height, bInvert);
 }
 
 //---------------------------------------------------------
@@ -435,6 +1153,15 @@ void spoutCopy::rgba2bgra(const void *rgba_source, void *bgra_dest,
 	if (!rgba_source || !bgra_dest)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2bgra(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, sourcePitch, bInvert);
+	}))
+		return;
+
 	for (unsigned int y = 0; y < height; y++) {
 
 		// Start of buffers
@@ -459,15 +1186,7 @@ void spoutCopy::rgba2bgra(const void *rgba_source, void *bgra_dest,
 			dest += YxW;
 		}
 		// Copy the line
-		if ((width % 16) == 0) { // 16 byte aligned width
-			if (m_bSSE2 && m_bSSSE3) // SSE3 available
-				rgba_bgra_sse3(source, dest, width, 1, bInvert);
-			else if (m_bSSE2) // SSE2 available
-				rgba_bgra_sse2(source, dest, width, 1, bInvert);
-		}
-		else {
-			rgba_bgra(source, dest, width, 1, bInvert);
-		}
+		rgba_bgra_fast(source, dest, width, 1, bInvert);
 	}
 }
 
@@ -481,6 +1200,15 @@ void spoutCopy::rgba2bgra(const void* rgba_source, void* bgra_dest,
 	if (!rgba_source || !bgra_dest)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2bgra(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * destPitch,
+			width, y1 - y0, sourcePitch, destPitch, bInvert);
+	}))
+		return;
+
 	for (unsigned int y = 0; y < height; y++) {
 
 		// Start of buffers
@@ -504,15 +1232,7 @@ void spoutCopy::rgba2bgra(const void* rgba_source, void* bgra_dest,
 			dest += YxDP;
 		}
 		// Copy the line
-		if ((width % 16) == 0) { // 16 byte aligned width
-			if (m_bSSE2 && m_bSSSE3) // SSE3 available
-				rgba_bgra_sse3(source, dest, width, 1, bInvert);
-			else if (m_bSSE2) // SSE2 available
-				rgba_bgra_sse2(source, dest, width, 1, bInvert);
-		}
-		else {
-			rgba_bgra(source, dest, width, 1, bInvert);
-		}
+		rgba_bgra_fast(source, dest, width, 1, bInvert);
 
 	}
 }
@@ -545,6 +1265,15 @@ void spoutCopy::rgba2rgb(const void* rgba_source, void* rgb_dest,
 	if (!rgb || !rgba)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2rgb(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * (rgba_pitch ? rgba_pitch : width * 4),
+			static_cast<unsigned char*>(rgb_dest) + (uint64_t)ys * width * 3,
+			width, y1 - y0, rgba_pitch ? rgba_pitch : width * 4, bInvert, bMirror, bSwapRB);
+	}))
+		return;
+
 	//
 	// SSE3 copy
 	// No mirror option, image size 16 bit byte aligned, SSE3 intrinsics support
@@ -561,10 +1290,12 @@ void spoutCopy::rgba2rgb(const void* rgba_source, void* rgb_dest,
 	//   1920x1080   9.3 msec
 	//   3840x2160  35.9 msec
 	//
+	// AVX2 is not limited to 16 byte aligned width
+	//
 	unsigned int pitch = rgba_pitch;
 	if(pitch == 0) pitch = width*4;
-	if (!bMirror && width >= 320 && (width % 16) == 0 && m_bSSE3) {
-		rgba_to_rgb_sse3(rgba_source, rgb_dest, width, height, pitch, bInvert, bSwapRB);
+	if (!bMirror && width >= 320 && (m_bAVX2 || m_bNEON || ((width % 16) == 0 && m_bSSE3))) {
+		(this->*m_pRgbaRgb)(rgba_source, rgb_dest, width, height, pitch, bInvert, bSwapRB);
 		return;
 	}
 
@@ -629,6 +1360,21 @@ void spoutCopy::rgb2rgba(const void *rgb_source, void *rgba_dest, unsigned int w
 	if (!rgb || !rgba)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgb2rgba(static_cast<const unsigned char*>(rgb_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(rgb_source, rgba_dest, width, height, width*4, bInvert, false);
+		return;
+	}
+
 	const uint64_t rgbsize  = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t rgbpitch = (uint64_t)width * 3;
 
@@ -666,6 +1412,21 @@ void spoutCopy::rgb2rgba(const void *rgb_source, void *rgba_dest,
 	if (!rgb || !rgba)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgb2rgba(static_cast<const unsigned char*>(rgb_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * dest_pitch,
+			width, y1 - y0, dest_pitch, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(rgb_source, rgba_dest, width, height, dest_pitch, bInvert, false);
+		return;
+	}
+
 	// RGB source does not have padding
 	const uint64_t rgbsize      = (uint64_t )width * (uint64_t)height * 3;
 	const uint64_t rgbpitch     = (uint64_t)width * 3;
@@ -707,6 +1468,21 @@ void spoutCopy::bgr2rgba(const void *bgr_source, void *rgba_dest, unsigned int w
 	if (!bgr || !rgba)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		bgr2rgba(static_cast<const unsigned char*>(bgr_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(bgr_source, rgba_dest, width, height, width*4, bInvert, true);
+		return;
+	}
+
 	const uint64_t bgrsize = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t bgrpitch = (uint64_t)width * 3;
 
@@ -744,6 +1520,21 @@ void spoutCopy::bgr2rgba(const void *bgr_source, void *rgba_dest,
 	if (!bgr || !rgba)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		bgr2rgba(static_cast<const unsigned char*>(bgr_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * dest_pitch,
+			width, y1 - y0, dest_pitch, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(bgr_source, rgba_dest, width, height, dest_pitch, bInvert, true);
+		return;
+	}
+
 	// BGR buffer dest does not have padding
 	const uint64_t bgrsize = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t bgrpitch = (uint64_t)width * 3;
@@ -759,9 +1550,9 @@ void spoutCopy::bgr2rgba(const void *bgr_source, void *rgba_dest,
 
 	for (unsigned int y = 0; y < height; y++) {
 		for (unsigned int x = 0; x < width; x++) {
-			*(rgba + 0) = *(bgr + 0); // blu
+			*(rgba + 0) = *(bgr + 2); // red
 			*(rgba + 1) = *(bgr + 1); // grn
-			*(rgba + 2) = *(bgr + 2); // red
+			*(rgba + 2) = *(bgr + 0); // blu
 			*(rgba + 3) = (unsigned char)255; // alpha
 			bgr += 3;
 			rgba += 4;
@@ -785,6 +1576,21 @@ void spoutCopy::rgb2bgra(const void *rgb_source, void *bgra_dest, unsigned int w
 	if (!rgb || !bgra)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgb2bgra(static_cast<const unsigned char*>(rgb_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(rgb_source, bgra_dest, width, height, width*4, bInvert, true);
+		return;
+	}
+
 	const uint64_t rgbsize = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t rgbpitch = (uint64_t)width * 3;
 
@@ -822,6 +1628,21 @@ void spoutCopy::rgb2bgra(const void *rgb_source, void *bgra_dest,
 	if (!rgb || !bgra)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgb2bgra(static_cast<const unsigned char*>(rgb_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * dest_pitch,
+			width, y1 - y0, dest_pitch, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(rgb_source, bgra_dest, width, height, dest_pitch, bInvert, true);
+		return;
+	}
+
 	// RGB source does not have padding
 	const uint64_t rgbsize = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t rgbpitch = (uint64_t)width * 3;
@@ -1141,9 +1962,768 @@ void spoutCopy::rgba_to_rgb_sse3(const void* rgba_source, void* rgb_dest,
 
 } // end rgba_to_rgb_sse
 
-
 //---------------------------------------------------------
-// Function: bgr2bgra
+// Function: rgba_to_rgb_avx2
+// RGBA to RGB/BGR with source line pitch
+//
+//    Eight pixels are shuffled to 12 bytes in each 128 bit lane
+//    and the lanes permuted to 24 contiguous bytes. 32 bytes are
+//    stored and the last 8 over-written by the next pixels, so the
+//    end of each line is copied byte by byte.
+//    Source and destination need not be aligned.
+//
+//    For streaming stores, sixteen pixels are shuffled to
+//    three 128 bit registers without over-write.
+//
+SPOUT_TARGET_AVX2
+void spoutCopy::rgba_to_rgb_avx2(const void* rgba_source, void* rgb_dest,
+	unsigned int width, unsigned int height, unsigned int rgba_pitch,
+	bool bInvert, bool bSwapRB) const
+{
+	auto rgba = static_cast<const unsigned char*>(rgba_source);
+	auto rgb = static_cast<unsigned char*>(rgb_dest);
+	if (!rgba || !rgb)
+		return;
+
+#ifdef _M_ARM64
+	rgba_to_rgb_sse3(rgba_source, rgb_dest, width, height, rgba_pitch, bInvert, bSwapRB);
+#else
+	const uint64_t rgbpitch = (uint64_t)width * 3;
+	if (rgba_pitch == 0) rgba_pitch = width * 4;
+
+	const __m256i shuffle = bSwapRB ?
+		_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+						 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+		_mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+						 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+	const __m128i shuffle128 = _mm256_castsi256_si128(shuffle);
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+	const bool bStream = t_bStream;
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		const unsigned char* src = rgba + (uint64_t)y * rgba_pitch;
+		unsigned char* dst = rgb + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbpitch;
+
+		unsigned int x = 0;
+		if (bStream) {
+			// Align the destination
+			for (; x < width && (reinterpret_cast<uintptr_t>(dst + x * 3) & 15) != 0; x++) {
+				dst[x * 3 + ir] = src[x * 4 + 0];
+				dst[x * 3 + 1]  = src[x * 4 + 1];
+				dst[x * 3 + ib] = src[x * 4 + 2];
+			}
+			for (; x + 16 <= width; x += 16) {
+				_mm_prefetch(reinterpret_cast<const char*>(src + x * 4 + 256), _MM_HINT_NTA);
+				const __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4)), shuffle128);
+				const __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 16)), shuffle128);
+				const __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 32)), shuffle128);
+				const __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 48)), shuffle128);
+				// 12 bytes of each register to 48 contiguous bytes
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + x * 3), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + x * 3 + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dst + x * 3 + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+			}
+		}
+		for (; x + 11 <= width; x += 8) {
+			__m256i pix = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+			pix = _mm256_shuffle_epi8(pix, shuffle);
+			pix = _mm256_permutevar8x32_epi32(pix, permute);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 3), pix);
+		}
+		for (; x < width; x++) {
+			dst[x * 3 + ir] = src[x * 4 + 0];
+			dst[x * 3 + 1]  = src[x * 4 + 1];
+			dst[x * 3 + ib] = src[x * 4 + 2];
+		}
+	}
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
+#endif
+
+} // end rgba_to_rgb_avx2
+
+//---------------------------------------------------------
+// Function: rgb_to_rgba_avx2
+// RGB/BGR to RGBA/BGRA with destination line pitch
+//
+//    24 bytes are loaded and permuted so that each 128 bit lane
+//    holds 4 pixels, then shuffled to 4 bytes per pixel with alpha 255.
+//    32 bytes are loaded, so the end of each line is copied byte by byte.
+//    Source and destination need not be aligned.
+//    Streaming stores are aligned to 32 bytes.
+//
+SPOUT_TARGET_AVX2
+void spoutCopy::rgb_to_rgba_avx2(const void* rgb_source, void* rgba_dest,
+	unsigned int width, unsigned int height, unsigned int rgba_pitch,
+	bool bInvert, bool bSwapRB) const
+{
+	auto rgb = static_cast<const unsigned char*>(rgb_source);
+	auto rgba = static_cast<unsigned char*>(rgba_dest);
+	if (!rgb || !rgba)
+		return;
+
+	const uint64_t rgbpitch = (uint64_t)width * 3;
+	if (rgba_pitch == 0) rgba_pitch = width * 4;
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+
+#ifndef _M_ARM64
+	const __m256i permute = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+	const __m256i shuffle = bSwapRB ?
+		_mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+						 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+		_mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+						 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+	const bool bStream = t_bStream && (reinterpret_cast<uintptr_t>(rgba) & 3) == 0 && (rgba_pitch & 3) == 0;
+#endif
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		const unsigned char* src = rgb + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbpitch;
+		unsigned char* dst = rgba + (uint64_t)y * rgba_pitch;
+
+		unsigned int x = 0;
+#ifndef _M_ARM64
+		if (bStream) {
+			// Align the destination
+			for (; x < width && (reinterpret_cast<uintptr_t>(dst + x * 4) & 31) != 0; x++) {
+				dst[x * 4 + 0] = src[x * 3 + ir];
+				dst[x * 4 + 1] = src[x * 3 + 1];
+				dst[x * 4 + 2] = src[x * 3 + ib];
+				dst[x * 4 + 3] = 255;
+			}
+			for (; x + 11 <= width; x += 8) {
+				_mm_prefetch(reinterpret_cast<const char*>(src + x * 3 + 256), _MM_HINT_NTA);
+				__m256i pix = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 3));
+				pix = _mm256_permutevar8x32_epi32(pix, permute);
+				pix = _mm256_or_si256(_mm256_shuffle_epi8(pix, shuffle), alpha);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + x * 4), pix);
+			}
+		}
+		for (; x + 11 <= width; x += 8) {
+			__m256i pix = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 3));
+			pix = _mm256_permutevar8x32_epi32(pix, permute);
+			pix = _mm256_or_si256(_mm256_shuffle_epi8(pix, shuffle), alpha);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), pix);
+		}
+#endif
+		for (; x < width; x++) {
+			dst[x * 4 + 0] = src[x * 3 + ir];
+			dst[x * 4 + 1] = src[x * 3 + 1];
+			dst[x * 4 + 2] = src[x * 3 + ib];
+			dst[x * 4 + 3] = 255;
+		}
+	}
+#ifndef _M_ARM64
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
+#endif
+
+} // end rgb_to_rgba_avx2
+
+//
+// Group: NEON
+//
+// Native ARM64 functions. The SSE functions are translated by sse2neon
+// for ARM64, but the byte shuffles of RGB and RGBA conversion become
+// long instruction sequences. NEON structure loads and stores
+// de-interleave and interleave the pixel components directly.
+// Without NEON, the functions copy byte by byte.
+//
+
+//---------------------------------------------------------
+// Function: rgba_to_rgb_neon
+// RGBA to RGB/BGR with source line pitch
+//
+//    Sixteen pixels are loaded to separate red, green, blue and alpha
+//    registers (vld4q_u8) and stored as 48 bytes of RGB (vst3q_u8).
+//    Source and destination need not be aligned.
+//
+void spoutCopy::rgba_to_rgb_neon(const void* rgba_source, void* rgb_dest,
+	unsigned int width, unsigned int height, unsigned int rgba_pitch,
+	bool bInvert, bool bSwapRB) const
+{
+	auto rgba = static_cast<const unsigned char*>(rgba_source);
+	auto rgb = static_cast<unsigned char*>(rgb_dest);
+	if (!rgba || !rgb)
+		return;
+
+	const uint64_t rgbpitch = (uint64_t)width * 3;
+	if (rgba_pitch == 0) rgba_pitch = width * 4;
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		const unsigned char* src = rgba + (uint64_t)y * rgba_pitch;
+		unsigned char* dst = rgb + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbpitch;
+
+		unsigned int x = 0;
+#ifdef _M_ARM64
+		for (; x + 16 <= width; x += 16) {
+			const uint8x16x4_t pix = vld4q_u8(src + x * 4);
+			uint8x16x3_t out;
+			out.val[0] = bSwapRB ? pix.val[2] : pix.val[0];
+			out.val[1] = pix.val[1];
+			out.val[2] = bSwapRB ? pix.val[0] : pix.val[2];
+			vst3q_u8(dst + x * 3, out);
+		}
+#endif
+		for (; x < width; x++) {
+			dst[x * 3 + ir] = src[x * 4 + 0];
+			dst[x * 3 + 1]  = src[x * 4 + 1];
+			dst[x * 3 + ib] = src[x * 4 + 2];
+		}
+	}
+
+} // end rgba_to_rgb_neon
+
+//---------------------------------------------------------
+// Function: rgb_to_rgba_neon
+// RGB/BGR to RGBA/BGRA with destination line pitch
+//
+//    Sixteen pixels are loaded to separate red, green and blue
+//    registers (vld3q_u8) and stored with alpha 255 as 64 bytes
+//    of RGBA (vst4q_u8). Source and destination need not be aligned.
+//
+void spoutCopy::rgb_to_rgba_neon(const void* rgb_source, void* rgba_dest,
+	unsigned int width, unsigned int height, unsigned int rgba_pitch,
+	bool bInvert, bool bSwapRB) const
+{
+	auto rgb = static_cast<const unsigned char*>(rgb_source);
+	auto rgba = static_cast<unsigned char*>(rgba_dest);
+	if (!rgb || !rgba)
+		return;
+
+	const uint64_t rgbpitch = (uint64_t)width * 3;
+	if (rgba_pitch == 0) rgba_pitch = width * 4;
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+
+#ifdef _M_ARM64
+	const uint8x16_t alpha = vdupq_n_u8(255);
+#endif
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		const unsigned char* src = rgb + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbpitch;
+		unsigned char* dst = rgba + (uint64_t)y * rgba_pitch;
+
+		unsigned int x = 0;
+#ifdef _M_ARM64
+		for (; x + 16 <= width; x += 16) {
+			const uint8x16x3_t pix = vld3q_u8(src + x * 3);
+			uint8x16x4_t out;
+			out.val[0] = bSwapRB ? pix.val[2] : pix.val[0];
+			out.val[1] = pix.val[1];
+			out.val[2] = bSwapRB ? pix.val[0] : pix.val[2];
+			out.val[3] = alpha;
+			vst4q_u8(dst + x * 4, out);
+		}
+#endif
+		for (; x < width; x++) {
+			dst[x * 4 + 0] = src[x * 3 + ir];
+			dst[x * 4 + 1] = src[x * 3 + 1];
+			dst[x * 4 + 2] = src[x * 3 + ib];
+			dst[x * 4 + 3] = 255;
+		}
+	}
+
+} // end rgb_to_rgba_neon
+
+//---------------------------------------------------------
+// Function: rgba_bgra_neon
+// RGBA to BGRA
+//
+//    Sixteen pixels are loaded to separate component registers
+//    (vld4q_u8) and stored with red and blue exchanged (vst4q_u8).
+//    Source and destination need not be aligned.
+//
+void spoutCopy::rgba_bgra_neon(const void* rgba_source, void* bgra_dest, unsigned int width, unsigned int height, bool bInvert) const
+{
+	if (!rgba_source || !bgra_dest)
+		return;
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		auto source = static_cast<const unsigned __int32*>(rgba_source);
+		auto dest = static_cast<unsigned __int32*>(bgra_dest);
+
+		// Increment to current line
+		if (bInvert)
+			source += (unsigned long)((height - 1 - y) * width);
+		else
+			source += (unsigned long)(y * width);
+		dest += (unsigned long)(y * width); // dest is not inverted
+
+		unsigned int x = 0;
+#ifdef _M_ARM64
+		for (; x + 16 <= width; x += 16) {
+			uint8x16x4_t pix = vld4q_u8(reinterpret_cast<const uint8_t*>(&source[x]));
+			const uint8x16_t red = pix.val[0];
+			pix.val[0] = pix.val[2];
+			pix.val[2] = red;
+			vst4q_u8(reinterpret_cast<uint8_t*>(&dest[x]), pix);
+		}
+#endif
+		for (; x < width; x++) {
+			const auto rgbapix = source[x];
+			dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
+		}
+	}
+
+} // end rgba_bgra_neon
+
+//
+// Group: High bit depth
+//
+// DXGI_FORMAT_R10G10B10A2_UNORM and DXGI_FORMAT_R16G16B16A16_FLOAT
+// textures received to 8 bit or float pixel buffers.
+//
+// 10 bit components are reduced to 8 bits and 2 bit alpha expanded.
+// Half floats are clamped to 0-1 for 8 bit output.
+// AVX2 is used for 10 bit conversion if available, otherwise SSE2.
+// F16C is used for half float conversion with AVX2.
+//
+
+// Half float to float without F16C
+static inline float HalfToFloat(uint16_t h)
+{
+	const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1f;
+	uint32_t mantissa = h & 0x3ff;
+	uint32_t bits = 0;
+	if (exponent == 0) {
+		if (mantissa == 0) {
+			bits = sign; // Zero
+		}
+		else {
+			// Denormal - normalise the mantissa
+			exponent = 127 - 15 + 1;
+			while (!(mantissa & 0x400)) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3ff;
+			bits = sign | (exponent << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 31) {
+		bits = sign | 0x7f800000 | (mantissa << 13); // Infinity or NaN
+	}
+	else {
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+	float f = 0.0f;
+	memcpy(&f, &bits, 4);
+	return f;
+}
+
+// Float clamped to 0-1 to a byte
+static inline unsigned char FloatToByte(float f)
+{
+	if (!(f > 0.0f)) return 0; // Negative or NaN
+	if (f >= 1.0f) return 255;
+	return (unsigned char)(f * 255.0f + 0.5f);
+}
+
+//---------------------------------------------------------
+// Function: rgb10a2_to_rgba
+// Copy 10 bit RGBA to 8 bit RGBA or BGRA allowing for source line pitch
+//
+//    DXGI_FORMAT_R10G10B10A2_UNORM
+//    bSwapRB - BGRA output
+//
+void spoutCopy::rgb10a2_to_rgba(const void* source, void* rgba_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bInvert, bool bSwapRB) const
+{
+	if (!source || !rgba_dest)
+		return;
+
+	if (sourcePitch == 0) sourcePitch = width * 4;
+	const uint64_t rgbapitch = (uint64_t)width * 4;
+
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgb10a2_to_rgba(static_cast<const unsigned char*>(source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * rgbapitch,
+			width, y1 - y0, sourcePitch, bInvert, bSwapRB);
+	}))
+		return;
+
+	auto src = static_cast<const unsigned char*>(source);
+	auto dst = static_cast<unsigned char*>(rgba_dest);
+	for (unsigned int y = 0; y < height; y++) {
+		rgb10a2_line(src + (uint64_t)y * sourcePitch,
+			dst + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbapitch,
+			width, bSwapRB);
+	}
+}
+
+//---------------------------------------------------------
+// Function: rgb10a2_to_rgb
+// Copy 10 bit RGBA to 8 bit RGB or BGR allowing for source line pitch
+//
+//    bSwapRB - BGR output
+//
+void spoutCopy::rgb10a2_to_rgb(const void* source, void* rgb_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bInvert, bool bSwapRB) const
+{
+	highbit_to_rgb(source, rgb_dest, width, height, sourcePitch, false, bInvert, bSwapRB);
+}
+
+//---------------------------------------------------------
+// Function: rgba16f_to_rgba
+// Copy half float RGBA to 8 bit RGBA or BGRA allowing for source line pitch
+//
+//    DXGI_FORMAT_R16G16B16A16_FLOAT
+//    Values are clamped to 0-1
+//    bSwapRB - BGRA output
+//
+void spoutCopy::rgba16f_to_rgba(const void* source, void* rgba_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bInvert, bool bSwapRB) const
+{
+	if (!source || !rgba_dest)
+		return;
+
+	if (sourcePitch == 0) sourcePitch = width * 8;
+	const uint64_t rgbapitch = (uint64_t)width * 4;
+
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 8, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba16f_to_rgba(static_cast<const unsigned char*>(source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(rgba_dest) + (uint64_t)ys * rgbapitch,
+			width, y1 - y0, sourcePitch, bInvert, bSwapRB);
+	}))
+		return;
+
+	auto src = static_cast<const unsigned char*>(source);
+	auto dst = static_cast<unsigned char*>(rgba_dest);
+	for (unsigned int y = 0; y < height; y++) {
+		rgba16f_line(src + (uint64_t)y * sourcePitch,
+			dst + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbapitch,
+			width, bSwapRB);
+	}
+}
+
+//---------------------------------------------------------
+// Function: rgba16f_to_rgb
+// Copy half float RGBA to 8 bit RGB or BGR allowing for source line pitch
+//
+//    Values are clamped to 0-1
+//    bSwapRB - BGR output
+//
+void spoutCopy::rgba16f_to_rgb(const void* source, void* rgb_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bInvert, bool bSwapRB) const
+{
+	highbit_to_rgb(source, rgb_dest, width, height, sourcePitch, true, bInvert, bSwapRB);
+}
+
+//---------------------------------------------------------
+// Function: rgba16f_to_rgba32f
+// Copy half float RGBA to float RGBA allowing for source line pitch
+//
+//    The destination is width*height*4 floats
+//    bClamp - clamp values to 0-1
+//
+void spoutCopy::rgba16f_to_rgba32f(const void* source, float* rgba_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bInvert, bool bClamp) const
+{
+	if (!source || !rgba_dest)
+		return;
+
+	if (sourcePitch == 0) sourcePitch = width * 8;
+	const uint64_t floatpitch = (uint64_t)width * 4; // floats
+
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 16, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba16f_to_rgba32f(static_cast<const unsigned char*>(source) + (uint64_t)y0 * sourcePitch,
+			rgba_dest + (uint64_t)ys * floatpitch,
+			width, y1 - y0, sourcePitch, bInvert, bClamp);
+	}))
+		return;
+
+	auto src = static_cast<const unsigned char*>(source);
+	for (unsigned int y = 0; y < height; y++) {
+		float* dst = rgba_dest + (uint64_t)(bInvert ? (height - 1 - y) : y) * floatpitch;
+		if (m_bF16C)
+			rgba16f_float_line_f16c(src + (uint64_t)y * sourcePitch, dst, width, bClamp);
+		else
+			rgba16f_float_line(src + (uint64_t)y * sourcePitch, dst, width, bClamp);
+	}
+}
+
+// 10 bit or half float to RGB/BGR.
+// Each line is converted to RGBA and then to RGB using the fastest method.
+void spoutCopy::highbit_to_rgb(const void* source, void* rgb_dest,
+	unsigned int width, unsigned int height, unsigned int sourcePitch,
+	bool bHalf, bool bInvert, bool bSwapRB) const
+{
+	if (!source || !rgb_dest || width == 0)
+		return;
+
+	if (sourcePitch == 0) sourcePitch = width * (bHalf ? 8 : 4);
+	const uint64_t rgbpitch = (uint64_t)width * 3;
+
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		highbit_to_rgb(static_cast<const unsigned char*>(source) + (uint64_t)y0 * sourcePitch,
+			static_cast<unsigned char*>(rgb_dest) + (uint64_t)ys * rgbpitch,
+			width, y1 - y0, sourcePitch, bHalf, bInvert, bSwapRB);
+	}))
+		return;
+
+	// One RGBA line
+	unsigned char* line = new unsigned char[(size_t)width * 4];
+
+	auto src = static_cast<const unsigned char*>(source);
+	auto dst = static_cast<unsigned char*>(rgb_dest);
+	for (unsigned int y = 0; y < height; y++) {
+		if (bHalf)
+			rgba16f_line(src + (uint64_t)y * sourcePitch, line, width, false);
+		else
+			rgb10a2_line(src + (uint64_t)y * sourcePitch, line, width, false);
+		rgba2rgb(line, dst + (uint64_t)(bInvert ? (height - 1 - y) : y) * rgbpitch,
+			width, 1, width * 4, false, false, bSwapRB);
+	}
+
+	delete[] line;
+}
+
+// 10 bit line using the fastest method
+void spoutCopy::rgb10a2_line(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const
+{
+	if (m_bAVX2) {
+		rgb10a2_line_avx2(source, rgba_dest, width, bSwapRB);
+		return;
+	}
+	if (m_bSSE2) {
+		rgb10a2_line_sse2(source, rgba_dest, width, bSwapRB);
+		return;
+	}
+
+	auto src = static_cast<const unsigned __int32*>(source);
+	auto dst = static_cast<unsigned __int32*>(rgba_dest);
+	const int rs = bSwapRB ? 16 : 0;
+	const int bs = bSwapRB ? 0 : 16;
+	for (unsigned int x = 0; x < width; x++) {
+		const unsigned __int32 p = src[x];
+		dst[x] = (((p >> 2) & 0xff) << rs)
+			| (((p >> 12) & 0xff) << 8)
+			| (((p >> 22) & 0xff) << bs)
+			| ((p >> 30) * 0x55) << 24;
+	}
+}
+
+//
+// SSE2 10 bit line
+// 4 pixels at a time. Source and destination need not be aligned.
+//
+//    The top 8 bits of each 10 bit component are masked and shifted
+//    to bytes. The 2 bit alpha is multiplied by 0x55.
+//
+void spoutCopy::rgb10a2_line_sse2(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const
+{
+	auto src = static_cast<const unsigned __int32*>(source);
+	auto dst = static_cast<unsigned __int32*>(rgba_dest);
+	const int rs = bSwapRB ? 16 : 0;
+	const int bs = bSwapRB ? 0 : 16;
+
+	const __m128i mask = _mm_set1_epi32(0xff);
+	const __m128i a55 = _mm_set1_epi32(0x55);
+
+	unsigned int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[x]));
+		__m128i r = _mm_and_si128(_mm_srli_epi32(p, 2), mask);
+		const __m128i g = _mm_and_si128(_mm_srli_epi32(p, 12), mask);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(p, 22), mask);
+		const __m128i a = _mm_mullo_epi16(_mm_srli_epi32(p, 30), a55);
+		if (bSwapRB) {
+			const __m128i t = r; r = b; b = t;
+		}
+		__m128i out = _mm_or_si128(r, _mm_slli_epi32(g, 8));
+		out = _mm_or_si128(out, _mm_slli_epi32(b, 16));
+		out = _mm_or_si128(out, _mm_slli_epi32(a, 24));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[x]), out);
+	}
+	for (; x < width; x++) {
+		const unsigned __int32 p = src[x];
+		dst[x] = (((p >> 2) & 0xff) << rs)
+			| (((p >> 12) & 0xff) << 8)
+			| (((p >> 22) & 0xff) << bs)
+			| ((p >> 30) * 0x55) << 24;
+	}
+}
+
+//
+// AVX2 version of rgb10a2_line_sse2
+// 8 pixels at a time. Source and destination need not be aligned.
+//
+SPOUT_TARGET_AVX2
+void spoutCopy::rgb10a2_line_avx2(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const
+{
+#ifdef _M_ARM64
+	rgb10a2_line_sse2(source, rgba_dest, width, bSwapRB);
+#else
+	auto src = static_cast<const unsigned __int32*>(source);
+	auto dst = static_cast<unsigned __int32*>(rgba_dest);
+	const int rs = bSwapRB ? 16 : 0;
+	const int bs = bSwapRB ? 0 : 16;
+
+	const __m256i mask = _mm256_set1_epi32(0xff);
+	const __m256i a55 = _mm256_set1_epi32(0x55);
+
+	unsigned int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[x]));
+		__m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 2), mask);
+		const __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 12), mask);
+		__m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 22), mask);
+		const __m256i a = _mm256_mullo_epi16(_mm256_srli_epi32(p, 30), a55);
+		if (bSwapRB) {
+			const __m256i t = r; r = b; b = t;
+		}
+		__m256i out = _mm256_or_si256(r, _mm256_slli_epi32(g, 8));
+		out = _mm256_or_si256(out, _mm256_slli_epi32(b, 16));
+		out = _mm256_or_si256(out, _mm256_slli_epi32(a, 24));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[x]), out);
+	}
+	for (; x < width; x++) {
+		const unsigned __int32 p = src[x];
+		dst[x] = (((p >> 2) & 0xff) << rs)
+			| (((p >> 12) & 0xff) << 8)
+			| (((p >> 22) & 0xff) << bs)
+			| ((p >> 30) * 0x55) << 24;
+	}
+#endif
+}
+
+// Half float line using the fastest method
+void spoutCopy::rgba16f_line(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const
+{
+	if (m_bF16C) {
+		rgba16f_line_f16c(source, rgba_dest, width, bSwapRB);
+		return;
+	}
+
+	auto src = static_cast<const uint16_t*>(source);
+	auto dst = static_cast<unsigned char*>(rgba_dest);
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+	for (unsigned int x = 0; x < width; x++) {
+		dst[x * 4 + ir] = FloatToByte(HalfToFloat(src[x * 4 + 0]));
+		dst[x * 4 + 1]  = FloatToByte(HalfToFloat(src[x * 4 + 1]));
+		dst[x * 4 + ib] = FloatToByte(HalfToFloat(src[x * 4 + 2]));
+		dst[x * 4 + 3]  = FloatToByte(HalfToFloat(src[x * 4 + 3]));
+	}
+}
+
+//
+// F16C half float line
+// 4 pixels at a time. Source and destination need not be aligned.
+//
+//    Two pixels are converted to 8 floats by each load,
+//    clamped to 0-1, scaled to 0-255 and packed to bytes.
+//    The pack is within 128 bit lanes, so the pixels are
+//    then permuted to the original order.
+//
+SPOUT_TARGET_F16C
+void spoutCopy::rgba16f_line_f16c(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const
+{
+	auto src = static_cast<const uint16_t*>(source);
+	auto dst = static_cast<unsigned char*>(rgba_dest);
+	const int ir = bSwapRB ? 2 : 0;
+	const int ib = bSwapRB ? 0 : 2;
+
+	unsigned int x = 0;
+#ifndef _M_ARM64
+	const __m256 zero  = _mm256_setzero_ps();
+	const __m256 one   = _mm256_set1_ps(1.0f);
+	const __m256 scale = _mm256_set1_ps(255.0f);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	const __m128i swap = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	for (; x + 4 <= width; x += 4) {
+		__m256 f0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[x * 4])));
+		__m256 f1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[x * 4 + 8])));
+		// Maximum first to replace NaN with zero
+		f0 = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(f0, zero), one), scale);
+		f1 = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(f1, zero), one), scale);
+		__m256i p = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+		p = _mm256_packus_epi16(p, p);
+		p = _mm256_permutevar8x32_epi32(p, order);
+		__m128i out = _mm256_castsi256_si128(p);
+		if (bSwapRB)
+			out = _mm_shuffle_epi8(out, swap);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[x * 4]), out);
+	}
+#endif
+	for (; x < width; x++) {
+		dst[x * 4 + ir] = FloatToByte(HalfToFloat(src[x * 4 + 0]));
+		dst[x * 4 + 1]  = FloatToByte(HalfToFloat(src[x * 4 + 1]));
+		dst[x * 4 + ib] = FloatToByte(HalfToFloat(src[x * 4 + 2]));
+		dst[x * 4 + 3]  = FloatToByte(HalfToFloat(src[x * 4 + 3]));
+	}
+}
+
+// Half float to float line without F16C
+void spoutCopy::rgba16f_float_line(const void* source, float* rgba_dest, unsigned int width, bool bClamp) const
+{
+	auto src = static_cast<const uint16_t*>(source);
+	const unsigned int n = width * 4;
+	for (unsigned int i = 0; i < n; i++) {
+		float f = HalfToFloat(src[i]);
+		if (bClamp)
+			f = (f > 0.0f) ? ((f < 1.0f) ? f : 1.0f) : 0.0f;
+		rgba_dest[i] = f;
+	}
+}
+
+//
+// F16C half float to float line
+// 2 pixels at a time. Source and destination need not be aligned.
+//
+SPOUT_TARGET_F16C
+void spoutCopy::rgba16f_float_line_f16c(const void* source, float* rgba_dest, unsigned int width, bool bClamp) const
+{
+	auto src = static_cast<const uint16_t*>(source);
+	const unsigned int n = width * 4;
+
+	unsigned int i = 0;
+#ifndef _M_ARM64
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one  = _mm256_set1_ps(1.0f);
+	for (; i + 8 <= n; i += 8) {
+		__m256 f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i])));
+		if (bClamp)
+			f = _mm256_min_ps(_mm256_max_ps(f, zero), one);
+		_mm256_storeu_ps(&rgba_dest[i], f);
+	}
+#endif
+	for (; i < n; i++) {
+		float f = HalfToFloat(src[i]);
+		if (bClamp)
+			f = (f > 0.0f) ? ((f < 1.0f) ? f : 1.0f) : 0.0f;
+		rgba_dest[i] = f;
+	}
+}
+
+
+//---------------------------------------------------------
+// Function: bgr2bgra
 //
 void spoutCopy::bgr2bgra(const void *bgr_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert) const
 {
@@ -1153,6 +2733,21 @@ void spoutCopy::bgr2bgra(const void *bgr_source, void *bgra_dest, unsigned int w
 	if (!bgr || !bgra)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		bgr2bgra(static_cast<const unsigned char*>(bgr_source) + (uint64_t)y0 * width * 3,
+			static_cast<unsigned char*>(bgra_dest) + (uint64_t)ys * width * 4,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbRgba)(bgr_source, bgra_dest, width, height, width*4, bInvert, false);
+		return;
+	}
+
 	const uint64_t bgrsize = (uint64_t)width * (uint64_t)height * 3;
 	const uint64_t bgrpitch = (uint64_t)width * 3;
 
@@ -1189,6 +2784,21 @@ void spoutCopy::rgba2bgr(const void *rgba_source, void *bgr_dest, unsigned int w
 	if (!rgba || !bgr)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2bgr(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * width * 4,
+			static_cast<unsigned char*>(bgr_dest) + (uint64_t)ys * width * 3,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbaRgb)(rgba_source, bgr_dest, width, height, width*4, bInvert, true);
+		return;
+	}
+
 	uint64_t bgrsize = (uint64_t)width * (uint64_t)height * 3;
 	uint64_t bgrpitch = (uint64_t)width * 3;
 
@@ -1225,6 +2835,21 @@ void spoutCopy::rgba2bgr(const void *rgba_source, void *bgr_dest,
 	if (!rgba || !bgr)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		rgba2bgr(static_cast<const unsigned char*>(rgba_source) + (uint64_t)y0 * rgba_pitch,
+			static_cast<unsigned char*>(bgr_dest) + (uint64_t)ys * width * 3,
+			width, y1 - y0, rgba_pitch, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbaRgb)(rgba_source, bgr_dest, width, height, rgba_pitch, bInvert, true);
+		return;
+	}
+
 	// RGB dest does not have padding
 	uint64_t rgbsize = (uint64_t)width * (uint64_t)height * 3;
 	uint64_t rgbpitch = (uint64_t)width * 3;
@@ -1355,6 +2980,21 @@ void spoutCopy::bgra2rgb(const void *bgra_source, void *rgb_dest, unsigned int w
 	if (!bgra || !rgb)
 		return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		bgra2rgb(static_cast<const unsigned char*>(bgra_source) + (uint64_t)y0 * width * 4,
+			static_cast<unsigned char*>(rgb_dest) + (uint64_t)ys * width * 3,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbaRgb)(bgra_source, rgb_dest, width, height, width*4, bInvert, true);
+		return;
+	}
+
 	uint64_t rgbsize = (uint64_t)width * (uint64_t)height * 3;
 	uint64_t rgbpitch = (uint64_t)width * 3;
 
@@ -1389,6 +3029,21 @@ void spoutCopy::bgra2bgr(const void *bgra_source, void *bgr_dest, unsigned int w
 	auto bgr = static_cast<unsigned char*>(bgr_dest); // BGR
 	if (!bgra || !bgr) return;
 
+	// Multiple threads for large images
+	if (StripeRows(height, (uint64_t)width * height * 4, [&](unsigned int y0, unsigned int y1) {
+		const unsigned int ys = bInvert ? height - y1 : y0;
+		bgra2bgr(static_cast<const unsigned char*>(bgra_source) + (uint64_t)y0 * width * 4,
+			static_cast<unsigned char*>(bgr_dest) + (uint64_t)ys * width * 3,
+			width, y1 - y0, bInvert);
+	}))
+		return;
+
+	// AVX2 or NEON if available
+	if ((m_bAVX2 || m_bNEON) && width >= 16) {
+		(this->*m_pRgbaRgb)(bgra_source, bgr_dest, width, height, width*4, bInvert, false);
+		return;
+	}
+
 	uint64_t bgrsize = (uint64_t)width * (uint64_t)height * 3;
 	uint64_t bgrpitch = (uint64_t)width * 3;
 
@@ -1458,12 +3113,25 @@ void spoutCopy::bgra2bgr(const void *bgra_source, void *bgr_dest, unsigned int w
 //
 // For intrinsics and SSE : https://software.intel.com/sites/landingpage/IntrinsicsGuide/
 //
+// XCR0 register for operating system support of AVX state
+#ifndef _M_ARM64
+SPOUT_TARGET_XSAVE
+static unsigned long long GetXCR0()
+{
+	return (unsigned long long)_xgetbv(0);
+}
+#endif
+
 void spoutCopy::CheckSSE()
 {
 #ifdef _M_ARM64 // All SSE will be routed to NEON
 	m_bSSE2 = true;
 	m_bSSE3 = true;
 	m_bSSSE3 = true;
+	m_bAVX2 = false; // No NEON equivalent
+	m_bAVX512 = false;
+	m_bF16C = false;
+	m_bNEON = true; // Native NEON functions
 #else
 	// An array of four integers that contains the information returned
 	// in EAX (0), EBX (1), ECX (2), and EDX (3) about supported features of the CPU.
@@ -1485,11 +3153,76 @@ void spoutCopy::CheckSSE()
 		// SSSE3 | [bit 9] ECX
 		// SSSE3 = (cpuid02 & (0x1 << 9)
 		m_bSSSE3 = ((CPUInfo[2] & (0x1 << 9)) || false);
+
+		// AVX instructions also need operating system support
+		// OSXSAVE | [bit 27] ECX
+		// AVX     | [bit 28] ECX
+		const bool bOSXSAVE = ((CPUInfo[2] & (0x1 << 27)) || false);
+		const bool bAVX = ((CPUInfo[2] & (0x1 << 28)) || false);
+		// F16C    | [bit 29] ECX
+		const bool bF16C = ((CPUInfo[2] & (0x1 << 29)) || false);
+		if (bOSXSAVE && bAVX && nIds >= 7) {
+			// XMM and YMM state (bits 1-2)
+			// Opmask and ZMM state (bits 5-7)
+			const unsigned long long xcr0 = GetXCR0();
+			const bool bOSAVX = ((xcr0 & 0x6) == 0x6);
+			const bool bOSAVX512 = ((xcr0 & 0xE6) == 0xE6);
+			// Get info for id "7"
+			// AVX2     | [bit 5]  EBX
+			// AVX512F  | [bit 16] EBX
+			// AVX512BW | [bit 30] EBX
+			__cpuidex(CPUInfo, 7, 0);
+			m_bAVX2 = bOSAVX && ((CPUInfo[1] & (0x1 << 5)) || false);
+			m_bAVX512 = m_bAVX2 && bOSAVX512
+				&& ((CPUInfo[1] & (0x1 << 16)) || false)
+				&& ((CPUInfo[1] & (0x1 << 30)) || false);
+			// Half float conversion is used with AVX2
+			m_bF16C = m_bAVX2 && bF16C;
+		}
 	}
 #endif
 
 }
 
+//
+// Select functions for the instructions available.
+// The SSE2/SSE3 functions require 16 byte aligned width.
+// The AVX and NEON functions are not limited by width or alignment.
+//
+void spoutCopy::SelectFunctions()
+{
+	m_pStreamCopy = &spoutCopy::streamcopy_sse2;
+	m_pRgbaRgb = &spoutCopy::rgba_to_rgb_sse3;
+	m_pRgbRgba = &spoutCopy::rgb_to_rgba_neon; // Byte copy without NEON
+	m_pRgbaBgra = &spoutCopy::rgba_bgra;
+	if (m_bSSE2)
+		m_pRgbaBgra = &spoutCopy::rgba_bgra_sse2;
+	if (m_bSSE2 && m_bSSSE3)
+		m_pRgbaBgra = &spoutCopy::rgba_bgra_sse3;
+	if (m_bNEON) {
+		m_pRgbaRgb = &spoutCopy::rgba_to_rgb_neon;
+		m_pRgbaBgra = &spoutCopy::rgba_bgra_neon;
+	}
+	if (m_bAVX2) {
+		m_pStreamCopy = &spoutCopy::streamcopy_avx2;
+		m_pRgbaRgb = &spoutCopy::rgba_to_rgb_avx2;
+		m_pRgbRgba = &spoutCopy::rgb_to_rgba_avx2;
+		m_pRgbaBgra = &spoutCopy::rgba_bgra_avx2;
+	}
+	if (m_bAVX512)
+		m_pRgbaBgra = &spoutCopy::rgba_bgra_avx512;
+}
+
+// Copy rgba to bgra using the selected function
+void spoutCopy::rgba_bgra_fast(const void* rgba_source, void* bgra_dest,
+	unsigned int width, unsigned int height, bool bInvert) const
+{
+	if (m_bAVX2 || m_bNEON || (width % 16) == 0) // AVX, NEON or 16 byte aligned width
+		(this->*m_pRgbaBgra)(rgba_source, bgra_dest, width, height, bInvert);
+	else
+		rgba_bgra(rgba_source, bgra_dest, width, height, bInvert);
+}
+
 
 // Copy rgba to bgra without SSE
 void spoutCopy::rgba_bgra(const void* rgba_source, void* bgra_dest,
@@ -1551,6 +3284,7 @@ void spoutCopy::rgba_bgra_sse2(const void* rgba_source, void* bgra_dest, unsigne
 		return;
 
 	const __m128i brMask = _mm_set1_epi32(0x00ff00ff); // argb
+	const bool bStream = t_bStream;
 
 	for (unsigned int y = 0; y < height; y++) {
 
@@ -1591,7 +3325,10 @@ void spoutCopy::rgba_bgra_sse2(const void* rgba_source, void* bgra_dest, unsigne
 			// Swap b and r
 			const __m128i brSwapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(brComponents, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
 			const __m128i result = _mm_or_si128(gaComponents, brSwapped);
-			_mm_store_si128(reinterpret_cast<__m128i*>(&dest[x]), result);
+			if (bStream)
+				_mm_stream_si128(reinterpret_cast<__m128i*>(&dest[x]), result);
+			else
+				_mm_store_si128(reinterpret_cast<__m128i*>(&dest[x]), result);
 		}
 
 		// Perform leftover writes
@@ -1600,6 +3337,8 @@ void spoutCopy::rgba_bgra_sse2(const void* rgba_source, void* bgra_dest, unsigne
 			dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
 		}
 	}
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
 
 } // end rgba_bgra_sse2
 
@@ -1614,6 +3353,7 @@ void spoutCopy::rgba_bgra_sse3(const void* rgba_source, void* bgra_dest, unsigne
 {
 	// Shuffling mask (RGBA -> BGRA) x 4, in reverse byte order
 	static const __m128i m = _mm_set_epi8(15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2);
+	const bool bStream = t_bStream;
 
 	for (unsigned int y = 0; y < height; y++) {
 
@@ -1651,12 +3391,148 @@ void spoutCopy::rgba_bgra_sse3(const void* rgba_source, void* bgra_dest, unsigne
 			p3 = _mm_shuffle_epi8(p3, m);
 			p4 = _mm_shuffle_epi8(p4, m);
 
-			_mm_store_si128(dst, p1); // SSE2
-			_mm_store_si128(dst + 1, p2);
-			_mm_store_si128(dst + 2, p3);
-			_mm_store_si128(dst + 3, p4);
+			if (bStream) {
+				_mm_stream_si128(dst, p1); // SSE2
+				_mm_stream_si128(dst + 1, p2);
+				_mm_stream_si128(dst + 2, p3);
+				_mm_stream_si128(dst + 3, p4);
+			}
+			else {
+				_mm_store_si128(dst, p1); // SSE2
+				_mm_store_si128(dst + 1, p2);
+				_mm_store_si128(dst + 2, p3);
+				_mm_store_si128(dst + 3, p4);
+			}
 
 		}
 	}
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
 
 } // end rgba_bgra_sse3
+
+//
+// AVX2 version of rgba_bgra_sse3
+// 8 pixels at a time. Source and destination need not be aligned.
+// Streaming stores are aligned to 32 bytes.
+//
+SPOUT_TARGET_AVX2
+void spoutCopy::rgba_bgra_avx2(const void* rgba_source, void* bgra_dest, unsigned int width, unsigned int height, bool bInvert) const
+{
+	if (!rgba_source || !bgra_dest)
+		return;
+
+#ifdef _M_ARM64
+	rgba_bgra_sse3(rgba_source, bgra_dest, width, height, bInvert);
+#else
+	const __m256i m = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+									   2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	const bool bStream = t_bStream && (reinterpret_cast<uintptr_t>(bgra_dest) & 3) == 0;
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		auto source = static_cast<const unsigned __int32*>(rgba_source);
+		auto dest = static_cast<unsigned __int32*>(bgra_dest);
+
+		// Increment to current line
+		if (bInvert)
+			source += (unsigned long)((height - 1 - y) * width);
+		else
+			source += (unsigned long)(y * width);
+		dest += (unsigned long)(y * width); // dest is not inverted
+
+		unsigned int x = 0;
+		if (bStream) {
+			// Align the destination
+			for (; x < width && (reinterpret_cast<uintptr_t>(&dest[x]) & 31) != 0; x++) {
+				const auto rgbapix = source[x];
+				dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
+			}
+			for (; x + 16 <= width; x += 16) {
+				_mm_prefetch(reinterpret_cast<const char*>(&source[x + 64]), _MM_HINT_NTA);
+				__m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&source[x]));
+				__m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&source[x + 8]));
+				p1 = _mm256_shuffle_epi8(p1, m);
+				p2 = _mm256_shuffle_epi8(p2, m);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(&dest[x]), p1);
+				_mm256_stream_si256(reinterpret_cast<__m256i*>(&dest[x + 8]), p2);
+			}
+		}
+		for (; x + 16 <= width; x += 16) {
+			__m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&source[x]));
+			__m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&source[x + 8]));
+			p1 = _mm256_shuffle_epi8(p1, m);
+			p2 = _mm256_shuffle_epi8(p2, m);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[x]), p1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest[x + 8]), p2);
+		}
+		for (; x < width; x++) {
+			const auto rgbapix = source[x];
+			dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
+		}
+	}
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
+#endif
+
+} // end rgba_bgra_avx2
+
+//
+// AVX512 version of rgba_bgra_sse3
+// 16 pixels at a time. Source and destination need not be aligned.
+// Streaming stores are aligned to 64 bytes.
+//
+SPOUT_TARGET_AVX512
+void spoutCopy::rgba_bgra_avx512(const void* rgba_source, void* bgra_dest, unsigned int width, unsigned int height, bool bInvert) const
+{
+	if (!rgba_source || !bgra_dest)
+		return;
+
+#ifdef _M_ARM64
+	rgba_bgra_sse3(rgba_source, bgra_dest, width, height, bInvert);
+#else
+	const __m512i m = _mm512_broadcast_i32x4(
+		_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+	const bool bStream = t_bStream && (reinterpret_cast<uintptr_t>(bgra_dest) & 3) == 0;
+
+	for (unsigned int y = 0; y < height; y++) {
+
+		auto source = static_cast<const unsigned __int32*>(rgba_source);
+		auto dest = static_cast<unsigned __int32*>(bgra_dest);
+
+		// Increment to current line
+		if (bInvert)
+			source += (unsigned long)((height - 1 - y) * width);
+		else
+			source += (unsigned long)(y * width);
+		dest += (unsigned long)(y * width); // dest is not inverted
+
+		unsigned int x = 0;
+		if (bStream) {
+			// Align the destination
+			for (; x < width && (reinterpret_cast<uintptr_t>(&dest[x]) & 63) != 0; x++) {
+				const auto rgbapix = source[x];
+				dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
+			}
+			for (; x + 16 <= width; x += 16) {
+				_mm_prefetch(reinterpret_cast<const char*>(&source[x + 64]), _MM_HINT_NTA);
+				__m512i p = _mm512_loadu_si512(reinterpret_cast<const void*>(&source[x]));
+				p = _mm512_shuffle_epi8(p, m);
+				_mm512_stream_si512(reinterpret_cast<void*>(&dest[x]), p);
+			}
+		}
+		for (; x + 16 <= width; x += 16) {
+			__m512i p = _mm512_loadu_si512(reinterpret_cast<const void*>(&source[x]));
+			p = _mm512_shuffle_epi8(p, m);
+			_mm512_storeu_si512(reinterpret_cast<void*>(&dest[x]), p);
+		}
+		for (; x < width; x++) {
+			const auto rgbapix = source[x];
+			dest[x] = (_rotl(rgbapix, 16) & 0x00ff00ff) | (rgbapix & 0xff00ff00);
+		}
+	}
+	if (bStream)
+		_mm_sfence(); // Streaming stores complete
+#endif
+
+} // end rgba_bgra_avx512
@@ -40,12 +40,89 @@
 #include <intrin.h> // for cpuid to test for SSE2
 #ifdef _M_ARM64
 #include <sse2neon.h> // for NEON
+#include <arm_neon.h> // for NEON functions
 #else
 #include <emmintrin.h> // for SSE2
 #include <tmmintrin.h> // for SSSE3
+#include <immintrin.h> // for AVX2 and AVX512
 #endif
 #include <cmath> // For compatibility with Clang. PR#81
 #include <stdint.h> // for _uint32 etc
+#include <string.h> // for memcpy
+
+// Instruction sets used for conversion
+enum SpoutCopyLevel {
+	SPOUT_COPY_SCALAR,
+	SPOUT_COPY_SSE2,
+	SPOUT_COPY_SSE3,
+	SPOUT_COPY_SSSE3,
+	SPOUT_COPY_AVX2,
+	SPOUT_COPY_AVX512
+};
+
+// Planar YUV layouts for receiving functions
+// Y plane followed by interleaved UV (NV12) or U and V planes (I420)
+// Width and height must be even. The buffer size is width*height*3/2.
+enum SpoutYUVLayout {
+	SPOUT_YUV_NV12,
+	SPOUT_YUV_I420
+};
+
+// YUV colour matrix
+enum SpoutYUVMatrix {
+	SPOUT_YUV_BT601,
+	SPOUT_YUV_BT709
+};
+
+// Tone mapping of a floating point sender texture (linear, 1.0 = SDR white)
+// to 8 bit sRGB for receivers of 8 bit textures or pixels
+enum SpoutToneMap {
+	SPOUT_TONEMAP_NONE,
+	SPOUT_TONEMAP_REINHARD, // Luminance Reinhard
+	SPOUT_TONEMAP_ACES // ACES filmic curve fit
+};
+
+// Image analysis computed by compute shader for monitoring
+// without reading back the frame (spoutShaders::Analyze, spoutDX::AnalyzeTexture).
+// Levels are 8 bit. Luma is BT.709.
+#define SPOUT_SCOPE_LEVELS 256 // Histogram levels
+#define SPOUT_WAVEFORM_COLUMNS 128 // Waveform columns across the image
+#define SPOUT_WAVEFORM_LEVELS 64 // Waveform luma levels of each column (4 levels each)
+// Words of the shader output buffer
+#define SPOUT_SCOPE_WORDS (4*SPOUT_SCOPE_LEVELS + SPOUT_WAVEFORM_COLUMNS*SPOUT_WAVEFORM_LEVELS)
+
+struct SpoutScopeData {
+	unsigned int histogram[4][SPOUT_SCOPE_LEVELS]; // Red, green, blue and luma pixel counts
+	unsigned int waveform[SPOUT_WAVEFORM_COLUMNS][SPOUT_WAVEFORM_LEVELS]; // Luma pixel counts of each column
+	unsigned int minimum[4]; // Red, green, blue and luma from the histograms
+	unsigned int maximum[4];
+	float average[4];
+	unsigned int pixels; // Pixels analysed
+};
+
+// Copy the shader output buffer and calculate minimum, maximum and average
+inline void SpoutScopeResult(const unsigned int* pBuffer, SpoutScopeData &data)
+{
+	memcpy(data.histogram, pBuffer, sizeof(data.histogram));
+	memcpy(data.waveform, pBuffer + 4*SPOUT_SCOPE_LEVELS, sizeof(data.waveform));
+	data.pixels = 0;
+	for (int c = 0; c < 4; c++) {
+		uint64_t count = 0;
+		uint64_t sum = 0;
+		data.minimum[c] = 0;
+		data.maximum[c] = 0;
+		for (unsigned int i = 0; i < SPOUT_SCOPE_LEVELS; i++) {
+			const unsigned int n = data.histogram[c][i];
+			if (n == 0) continue;
+			if (count == 0) data.minimum[c] = i;
+			data.maximum[c] = i;
+			count += n;
+			sum += (uint64_t)n * i;
+		}
+		data.average[c] = count > 0 ? (float)((double)sum / (double)count) : 0.0f;
+		data.pixels = (unsigned int)count;
+	}
+}
 
 class SPOUT_DLLEXP spoutCopy {
 
@@ -54,6 +131,46 @@ class SPOUT_DLLEXP spoutCopy {
 		spoutCopy();
 		~spoutCopy();
 
+		//
+		// Multiple threads
+		//
+		// Large images are divided into row stripes and converted
+		// by the system thread pool. Disabled by default.
+		//
+
+		// Number of threads (0 - processors, 1 - disable)
+		void SetCopyThreads(int nThreads = 0);
+		// Number of threads in use
+		int GetCopyThreads();
+		// Minimum image size in bytes for multiple threads
+		void SetCopyThreshold(unsigned int nBytes);
+		// Minimum image size for multiple threads
+		unsigned int GetCopyThreshold();
+
+		//
+		// Streaming stores
+		//
+		// Images larger than the processor cache are copied
+		// with streaming stores that bypass the cache.
+		//
+
+		// Minimum image size in bytes for streaming stores (0 - all images)
+		void SetStreamThreshold(unsigned int nBytes);
+		// Minimum image size for streaming stores
+		unsigned int GetStreamThreshold();
+
+		//
+		// Instruction sets
+		//
+		// The fastest available are used by default.
+		// A lower level can be set to compare conversion methods.
+		//
+
+		// Highest instruction set to use
+		void SetInstructionLevel(SpoutCopyLevel level = SPOUT_COPY_AVX512);
+		// Highest instruction set in use
+		SpoutCopyLevel GetInstructionLevel();
+
 		// Copy image pixels and select fastest method based on image width
 		void CopyPixels(const unsigned char *src, unsigned char *dst,
 						unsigned int width, unsigned int height, 
@@ -69,9 +186,33 @@ class SPOUT_DLLEXP spoutCopy {
 			unsigned int width, unsigned int height,
 			unsigned int source_stride, GLenum glFormat) const;
 
-		// SSE2 version of memcpy
+		// SSE2 version of memcpy with streaming stores
 		void memcpy_sse2(void* dst, const void* src, size_t size) const;
 
+		// AVX2 version of memcpy with streaming stores
+		void memcpy_avx2(void* dst, const void* src, size_t size) const;
+
+		//
+		// Lossless compression
+		//
+
+		// Compress rgba pixels to a buffer of maximum size.
+		// Returns the compressed bytes, or 0 if not smaller than the maximum.
+		unsigned int EncodePixels(const unsigned char* rgba, unsigned char* dest,
+			unsigned int width, unsigned int height, unsigned int maxbytes) const;
+		// Decompress pixels compressed by EncodePixels
+		bool DecodePixels(const unsigned char* source, unsigned int size,
+			unsigned char* rgba, unsigned int width, unsigned int height) const;
+
+		//
+		// Pixel layouts
+		//
+
+		// Convert 8 bit pixels between OpenGL or DXGI formats allowing for source and destination pitch
+		bool ConvertPixels(const void* source, void* dest, unsigned int width, unsigned int height,
+			DWORD sourceFormat, DWORD destFormat,
+			unsigned int sourcePitch = 0, unsigned int destPitch = 0, bool bInvert = false) const;
+
 		//
 		// RGBA <> RGBA
 		//
@@ -147,6 +288,44 @@ class SPOUT_DLLEXP spoutCopy {
 			bool bInvert = false, // Flip image
 			bool bSwapRB = false) const; // Swap RG (BGR)
 
+		//
+		// AVX2 functions
+		//
+		// RGBA to RGB/BGR with source line pitch
+		// Any width, 8 pixels at a time
+		//
+		void rgba_to_rgb_avx2(const void* rgba_source, void* rgb_dest,
+			unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, // line byte pitch
+			bool bInvert = false, // Flip image
+			bool bSwapRB = false) const; // Swap RG (BGR)
+
+		// RGB/BGR to RGBA/BGRA with destination line pitch
+		void rgb_to_rgba_avx2(const void* rgb_source, void* rgba_dest,
+			unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, // line byte pitch
+			bool bInvert = false, // Flip image
+			bool bSwapRB = false) const; // Swap RG (BGRA)
+
+		//
+		// NEON functions for ARM64
+		//
+		// RGBA to RGB/BGR with source line pitch
+		// Any width, 16 pixels at a time
+		//
+		void rgba_to_rgb_neon(const void* rgba_source, void* rgb_dest,
+			unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, // line byte pitch
+			bool bInvert = false, // Flip image
+			bool bSwapRB = false) const; // Swap RG (BGR)
+
+		// RGB/BGR to RGBA/BGRA with destination line pitch
+		void rgb_to_rgba_neon(const void* rgb_source, void* rgba_dest,
+			unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, // line byte pitch
+			bool bInvert = false, // Flip image
+			bool bSwapRB = false) const; // Swap RG (BGRA)
+
 		//
 		// Byte functions
 		//
@@ -199,6 +378,29 @@ class SPOUT_DLLEXP spoutCopy {
 		// Copy BGRA to BGR
 		void bgra2bgr (const void* bgra_source, void *bgr_dest,  unsigned int width, unsigned int height, bool bInvert = false) const;
 
+		//
+		// High bit depth formats
+		//
+		// DXGI_FORMAT_R10G10B10A2_UNORM and DXGI_FORMAT_R16G16B16A16_FLOAT
+		// to 8 bit or float pixels allowing for source line pitch.
+		//
+
+		// Copy 10 bit RGBA to 8 bit RGBA or BGRA
+		void rgb10a2_to_rgba(const void* source, void* rgba_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bInvert = false, bool bSwapRB = false) const;
+		// Copy 10 bit RGBA to 8 bit RGB or BGR
+		void rgb10a2_to_rgb(const void* source, void* rgb_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bInvert = false, bool bSwapRB = false) const;
+		// Copy half float RGBA to 8 bit RGBA or BGRA clamped to 0-1
+		void rgba16f_to_rgba(const void* source, void* rgba_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bInvert = false, bool bSwapRB = false) const;
+		// Copy half float RGBA to 8 bit RGB or BGR clamped to 0-1
+		void rgba16f_to_rgb(const void* source, void* rgb_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bInvert = false, bool bSwapRB = false) const;
+		// Copy half float RGBA to float RGBA with optional clamp to 0-1
+		void rgba16f_to_rgba32f(const void* source, float* rgba_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bInvert = false, bool bClamp = false) const;
+
 
 
 	protected :
@@ -207,10 +409,66 @@ class SPOUT_DLLEXP spoutCopy {
 		bool m_bSSE2;
 		bool m_bSSE3;
 		bool m_bSSSE3;
+		bool m_bAVX2;
+		bool m_bAVX512; // AVX512F and AVX512BW
+		bool m_bF16C; // Half float conversion with AVX2
+		bool m_bNEON; // ARM64
+
+		// Select functions for the instructions available
+		void SelectFunctions();
+		void (spoutCopy::*m_pStreamCopy)(void* dst, const void* src, size_t size) const;
+		void (spoutCopy::*m_pRgbaBgra)(const void* rgba_source, void* bgra_dest, unsigned int width, unsigned int height, bool bInvert) const;
+		void (spoutCopy::*m_pRgbaRgb)(const void* rgba_source, void* rgb_dest, unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, bool bInvert, bool bSwapRB) const;
+		void (spoutCopy::*m_pRgbRgba)(const void* rgb_source, void* rgba_dest, unsigned int width, unsigned int height,
+			unsigned int rgba_pitch, bool bInvert, bool bSwapRB) const;
+
+		// Multiple threads
+		int m_nCopyThreads;
+		unsigned int m_CopyThreshold;
+
+		// Streaming stores
+		unsigned int m_StreamThreshold;
+		static unsigned int GetCacheSize();
+		// Copy with streaming stores if selected for the image
+		void CopyLine(void* dst, const void* src, size_t size) const;
+		// Complete the streaming stores of CopyLine
+		void EndCopyLines() const;
+		// Streaming store copies without sfence
+		void streamcopy_sse2(void* dst, const void* src, size_t size) const;
+		void streamcopy_avx2(void* dst, const void* src, size_t size) const;
+
+		// Pixels the same in both buffers from the start (EncodePixels)
+		static size_t MatchPixels(const uint32_t* a, const uint32_t* b, size_t count);
+
+		// Divide an image into row stripes for multiple threads.
+		// The function receives the first row and the end row of each stripe.
+		// Returns false if the image is not divided.
+		// Also selects streaming stores for the image.
+		template <typename F>
+		bool StripeRows(unsigned int height, uint64_t bytes, const F& func) const;
+
+		// Copy rgba to bgra using the selected function
+		void rgba_bgra_fast(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
 
 		void rgba_bgra(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
 		void rgba_bgra_sse2(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
 		void rgba_bgra_sse3(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
+		void rgba_bgra_avx2(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
+		void rgba_bgra_avx512(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
+		void rgba_bgra_neon(const void *rgba_source, void *bgra_dest, unsigned int width, unsigned int height, bool bInvert = false) const;
+
+		// Single line high bit depth conversion using the fastest method
+		void rgb10a2_line(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const;
+		void rgb10a2_line_sse2(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const;
+		void rgb10a2_line_avx2(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const;
+		void rgba16f_line(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const;
+		void rgba16f_line_f16c(const void* source, void* rgba_dest, unsigned int width, bool bSwapRB) const;
+		void rgba16f_float_line(const void* source, float* rgba_dest, unsigned int width, bool bClamp) const;
+		void rgba16f_float_line_f16c(const void* source, float* rgba_dest, unsigned int width, bool bClamp) const;
+		// 10 bit or half float to RGB/BGR by way of an RGBA line
+		void highbit_to_rgb(const void* source, void* rgb_dest, unsigned int width, unsigned int height,
+			unsigned int sourcePitch, bool bHalf, bool bInvert, bool bSwapRB) const;
 
 };
 
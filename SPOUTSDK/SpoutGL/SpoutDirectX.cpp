@@ -158,6 +158,48 @@
 //		07.08.23	- Comment out code for debug layers
 //		19.10.23	- GetNumAdapters - remove unused adapter description and output list
 //	Version 2.007.013
+//		14.10.26	- Add ID3D11Fence functions CreateDX11Fence, SignalFence, WaitFence, SetFenceEvent
+//					  Wait - use the class fence if available instead of polling an event query
+//					- Add OpenSharedTexture to retain opened sender textures by share handle
+//					  and sender name. Add EvictSharedTexture, CheckSharedTextures,
+//					  ReleaseSharedTextures and GetSharedTextureCount
+//					- Add process staging texture pool. AcquireStagingTexture,
+//					  ReleaseStagingTexture and ReleaseStagingPool
+//					- CloseDirectX11 - release DirectX 11.1 interfaces of an external device
+//					  and clear the device pointer so that it is not used after release
+//					- Add ProbeAdapters and SetFastestAdapter to select the adapter
+//					  with the lowest copy latency. The result is recorded in the registry.
+//					- GetNumAdapters, GetAdapterName, GetAdapterIndex, GetAdapterInfo
+//					  and FindNVIDIA - use a process adapter table that is enumerated
+//					  again when adapters change
+//					- Add StartPreopen, SetPreopenSender, StopPreopen and IsPreopen
+//					  to open sender textures on a thread when senders change.
+//					  Lock the shared texture cache for access by the thread.
+//					- CreateSharedDX11Texture and CreateDX11Texture - add array size
+//					  argument for array texture senders. Add CopySharedTexture.
+//					- CreateSharedDX11Texture - add mip levels argument for a mip chain
+//					  generated by the sender. CopySharedTexture copies the top level
+//					  if the number of levels is different.
+//					- Add EnableGPUTiming, BeginGPUTime, EndGPUTime and ReadGPUTimes.
+//					  Disjoint and timestamp queries in a ring of SPOUT_GPU_QUERIES
+//					  scopes record GPU copy times in a spoutTimer without waiting.
+//					- Add GetDeviceAdapterLuid and GetAdapterIndex for an adapter LUID
+//					  to record the adapter of a sender.
+//		15.10.26	- CreateSharedDX11Texture - add a name for an NT handle and test the
+//					  feature level of the device used. Query IDXGIResource1 for CreateSharedHandle.
+//					  Add GetSharedTextureName and OpenDX11shareName to open a sender texture
+//					  by name with OpenSharedResourceByName. OpenSharedTexture - add NT handle option.
+//					- PreopenThread - use the housekeeping thread settings (BeginSpoutThread)
+//					- Add SetGPUPriority and GetGPUPriority. CreateDX11device sets the
+//					  GPU thread priority of devices created by the class.
+//					- Add TrimDevice, GetMemoryBudget and CheckMemoryBudget
+//					  to release retained textures if idle or over the video memory budget.
+//					- Add GetTextureBytes and AddTextureUsage for memory usage queries.
+//					- Add IsUnifiedMemory, SetUnifiedMemory and CreateDX11MappableTexture.
+//					  AcquireStagingTexture creates default textures with CPU access,
+//					  mapped directly, on devices with unified memory.
+//					- CreateDX11Fence - record failure for the device so that Wait
+//					  uses the query without trying to create the fence each time.
 //
 // ====================================================================================
 /*
@@ -187,6 +229,128 @@
 */
 
 #include "SpoutDirectX.h"
+#include "SpoutSenderNames.h" // for CheckSharedTextures
+
+//
+// Process staging texture pool
+//
+// Idle staging textures returned by ReleaseStagingTexture are retained
+// for SPOUT_STAGING_IDLE msec and given to the next AcquireStagingTexture
+// of the same device, size, format and CPU access by any object in the process.
+//
+struct SpoutStagingEntry {
+	ID3D11Device* pDevice; // For comparison only
+	ID3D11Texture2D* pTexture;
+	unsigned int width;
+	unsigned int height;
+	DXGI_FORMAT format;
+	UINT cpuAccess;
+	DWORD dwTime; // Time returned to the pool
+};
+static SpoutStagingEntry g_StagingPool[SPOUT_STAGING_POOL]={};
+static SRWLOCK g_StagingLock = SRWLOCK_INIT;
+
+// Release idle textures retained too long
+// Called with the pool lock
+static void EvictStagingPool(DWORD dwNow)
+{
+	for (int i = 0; i < SPOUT_STAGING_POOL; i++) {
+		SpoutStagingEntry& entry = g_StagingPool[i];
+		if (entry.pTexture && (dwNow - entry.dwTime) > SPOUT_STAGING_IDLE) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutStagingEntry));
+		}
+	}
+}
+
+//
+// Process adapter table
+//
+// Adapter descriptions and the name of the first output of each adapter
+// are enumerated once for all adapter queries in the process.
+// They are enumerated again when DXGI signals that adapters have been
+// added or removed (IDXGIFactory7::RegisterAdaptersChangedEvent) or,
+// if the notification is not available, after SPOUT_ADAPTER_REFRESH msec.
+//
+struct SpoutAdapterEntry {
+	DXGI_ADAPTER_DESC desc;
+	char name[256]; // Description
+	char output[64]; // First output device name
+};
+static SpoutAdapterEntry g_Adapters[SPOUT_MAX_ADAPTERS]={};
+static int g_nAdapters = -1; // Not enumerated yet
+static DWORD g_dwAdapterTime = 0; // Time of enumeration
+static HANDLE g_hAdapterEvent = NULL; // Signalled when adapters change
+static IUnknown* g_pAdapterFactory = nullptr; // Factory registered for the event
+static SRWLOCK g_AdapterLock = SRWLOCK_INIT;
+
+// Enumerate adapters if not done yet or if they have changed
+// Called with the adapter lock
+static bool CheckAdapterTable()
+{
+	const DWORD dwNow = GetTickCount();
+	if (g_nAdapters >= 0) {
+		if (g_hAdapterEvent) {
+			if (WaitForSingleObject(g_hAdapterEvent, 0) == WAIT_TIMEOUT)
+				return true;
+		}
+		else if ((dwNow - g_dwAdapterTime) < SPOUT_ADAPTER_REFRESH) {
+			return true;
+		}
+	}
+
+	// A factory enumerates the adapters present when it was created
+	IDXGIFactory1* _dxgi_factory1 = nullptr;
+	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1)) || !_dxgi_factory1) {
+		SpoutLogError("spoutDirectX - could not create DXGI factory for adapters");
+		return false;
+	}
+
+#ifdef __IDXGIFactory7_INTERFACE_DEFINED__
+	// Register for adapter change notification once for the process.
+	// The factory is retained for the registration.
+	if (!g_pAdapterFactory) {
+		IDXGIFactory7* pFactory7 = nullptr;
+		if (SUCCEEDED(_dxgi_factory1->QueryInterface(__uuidof(IDXGIFactory7), (void**)&pFactory7))) {
+			DWORD dwCookie = 0;
+			HANDLE hEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+			if (hEvent && SUCCEEDED(pFactory7->RegisterAdaptersChangedEvent(hEvent, &dwCookie))) {
+				g_hAdapterEvent = hEvent;
+				g_pAdapterFactory = pFactory7;
+			}
+			else {
+				if (hEvent) CloseHandle(hEvent);
+				pFactory7->Release();
+			}
+		}
+	}
+#endif
+
+	g_nAdapters = 0;
+	IDXGIAdapter* adapter1_ptr = nullptr;
+	for (UINT i = 0; i < SPOUT_MAX_ADAPTERS && _dxgi_factory1->EnumAdapters(i, &adapter1_ptr) != DXGI_ERROR_NOT_FOUND; i++) {
+		if (!adapter1_ptr) break;
+		SpoutAdapterEntry& entry = g_Adapters[g_nAdapters];
+		ZeroMemory(&entry, sizeof(SpoutAdapterEntry));
+		size_t charsConverted = 0;
+		adapter1_ptr->GetDesc(&entry.desc);
+		wcstombs_s(&charsConverted, entry.name, 256, entry.desc.Description, 255);
+		IDXGIOutput* p_output = nullptr;
+		if (adapter1_ptr->EnumOutputs(0, &p_output) != DXGI_ERROR_NOT_FOUND && p_output) {
+			DXGI_OUTPUT_DESC desc_out={};
+			p_output->GetDesc(&desc_out);
+			wcstombs_s(&charsConverted, entry.output, 64, desc_out.DeviceName, 63);
+			p_output->Release();
+		}
+		adapter1_ptr->Release();
+		g_nAdapters++;
+	}
+	_dxgi_factory1->Release();
+
+	g_dwAdapterTime = dwNow;
+
+	return true;
+}
 
 //
 // Class: spoutDirectX
@@ -204,16 +368,54 @@ spoutDirectX::spoutDirectX() {
 	m_bClassDevice		= true;
 	m_driverType		= D3D_DRIVER_TYPE_NULL;
 	m_featureLevel		= D3D_FEATURE_LEVEL_11_0;
+	m_GPUPriority		= 0; // Default GPU thread priority
 
 	// For feature leve 11.1 if available
 	m_pd3dDevice1        = nullptr;
 	m_pImmediateContext1 = nullptr;
 
+	// For ID3D11Fence if available
+	m_pd3dDevice5        = nullptr;
+	m_pImmediateContext4 = nullptr;
+	m_pFence             = nullptr;
+	m_hFenceEvent        = NULL;
+	m_FenceValue         = 0;
+	m_bFenceUnsupported  = false;
+
 	// Output graphics adapter
 	// Programmer can set for an application
 	m_AdapterIndex  = 0; // Adapter index
 	m_pAdapterDX11  = nullptr; // DX11 adapter pointer
 
+	// Shared textures retained by OpenSharedTexture
+	ZeroMemory(m_SharedCache, sizeof(m_SharedCache));
+	InitializeSRWLock(&m_SharedLock);
+
+	// Pre-open thread
+	m_hPreopenThread = NULL;
+	m_hPreopenStop   = NULL;
+	m_pPreopenDevice = nullptr;
+	m_PreopenName[0] = 0;
+
+	// GPU timing
+	m_pGPUTimer  = nullptr;
+	m_pGPUDevice = nullptr;
+	ZeroMemory(m_GPUQuery, sizeof(m_GPUQuery));
+	m_GPUWrite   = 0;
+	m_GPURead    = 0;
+	m_GPUPending = 0;
+	m_bGPUScope  = false;
+
+	// Video memory budget
+	m_pBudgetAdapter = nullptr;
+	m_hBudgetEvent   = NULL;
+	m_dwBudgetCookie = 0;
+	m_dwBudgetTime   = 0;
+	m_bBudgetChecked = false;
+
+	// Mappable default textures on unified memory devices
+	m_bUnifiedMemory = true;
+
 }
 
 spoutDirectX::~spoutDirectX() {
@@ -221,6 +423,14 @@ spoutDirectX::~spoutDirectX() {
 	try {
 		// Release adapter pointer if specified by SetAdapter
 		if (m_pAdapterDX11) m_pAdapterDX11->Release();
+		// Stop the pre-open thread before the textures are released
+		StopPreopen();
+		// Release shared textures retained by OpenSharedTexture
+		ReleaseSharedTextures();
+		// Release GPU timing queries
+		ReleaseGPUTiming();
+		// Release the video memory budget adapter
+		ReleaseBudgetAdapter();
 	}
 	catch (...) {
 		MessageBoxA(NULL, "Exception in spoutDriectX destructor", NULL, MB_OK);
@@ -307,6 +517,28 @@ void spoutDirectX::CloseDirectX11()
 	}
 
 
+	// Release the fence if created
+	// and test again for the next device
+	ReleaseDX11Fence();
+	m_bFenceUnsupported = false;
+
+	// Stop the pre-open thread using the device
+	if (m_pPreopenDevice == m_pd3dDevice)
+		StopPreopen();
+
+	// Release GPU timing queries of the device
+	if (m_pGPUDevice == m_pd3dDevice)
+		ReleaseGPUTiming();
+
+	// Release the video memory budget adapter of the device
+	ReleaseBudgetAdapter();
+
+	// Release shared textures retained for the device
+	ReleaseSharedTextures(m_pd3dDevice);
+
+	// Release idle staging textures of the device
+	ReleaseStagingPool(m_pd3dDevice);
+
 	// Release m_pImmediateContext if created
 	if (m_pImmediateContext) {
 		m_pImmediateContext->ClearState();
@@ -327,6 +559,15 @@ void spoutDirectX::CloseDirectX11()
 	else {
 		// An application device was used (SetDX11Device). Do not release it.
 		SpoutLogNotice("spoutDirectX::CloseDirectX11 - external device used (0x%.7X)", PtrToUint(m_pd3dDevice));
+		// Release the DirectX 11.1 interfaces queried from the device
+		if (m_pImmediateContext1) m_pImmediateContext1->Release();
+		m_pImmediateContext1 = nullptr;
+		if (m_pd3dDevice1) m_pd3dDevice1->Release();
+		m_pd3dDevice1 = nullptr;
+		// The external device is no longer used by the class.
+		// It can be released by the application or by the process
+		// interop context that shares it, so do not retain the pointer.
+		m_pd3dDevice = nullptr;
 		// Release adapter pointer if specified by SetAdapter
 		// Normally done in destructor
 		if (m_pAdapterDX11)
@@ -497,6 +738,18 @@ ID3D11Device* spoutDirectX::CreateDX11device()
 	// m_pImmediateContext has also been created by D3D11CreateDevice
 	SpoutLogNotice("    Device (0x%.7X) - Context (0x%.7X)", PtrToUint(pd3dDevice), PtrToUint(m_pImmediateContext));
 
+	// GPU thread priority if set by SetGPUPriority
+	if (m_GPUPriority != 0) {
+		IDXGIDevice* pDXGIDevice = nullptr;
+		if (SUCCEEDED(pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&pDXGIDevice)))) {
+			if (SUCCEEDED(pDXGIDevice->SetGPUThreadPriority(m_GPUPriority)))
+				SpoutLogNotice("    GPU thread priority %d", m_GPUPriority);
+			else
+				SpoutLogWarning("spoutDirectX::CreateDX11device - could not set GPU thread priority %d", m_GPUPriority);
+			pDXGIDevice->Release();
+		}
+	}
+
 	return pd3dDevice;
 
 } // end CreateDX11device
@@ -521,6 +774,281 @@ D3D_FEATURE_LEVEL spoutDirectX::GetDX11FeatureLevel()
 	return m_featureLevel;
 }
 
+//---------------------------------------------------------
+// Function: SetGPUPriority
+// Set the GPU thread priority of devices created by the class.
+//
+// Spout copies on a class device are scheduled by the GPU with this
+// priority relative to other devices, so that they are not delayed
+// by heavy rendering or compute of other applications. D3D11 has one
+// queue for each device, so a class device is also the dedicated
+// context for the shared texture copy.
+//
+//   -7 to 7, default 0. Positive values raise the priority.
+//
+// Set before OpenDirectX11 or the first send or receive.
+// Applies immediately to a class device that has already been created.
+// An application device set by OpenDirectX11 or SetDX11Device is not
+// changed because the priority would apply to all its rendering.
+// Priority above zero may not be allowed for processes without
+// the increase scheduling priority privilege.
+bool spoutDirectX::SetGPUPriority(int priority)
+{
+	if (priority < -7 || priority > 7) {
+		SpoutLogWarning("spoutDirectX::SetGPUPriority(%d) - priority must be -7 to 7", priority);
+		return false;
+	}
+	m_GPUPriority = priority;
+
+	// Apply to a class device already created
+	if (!m_pd3dDevice || !m_bClassDevice)
+		return true;
+
+	bool bSet = false;
+	IDXGIDevice* pDXGIDevice = nullptr;
+	if (SUCCEEDED(m_pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&pDXGIDevice)))) {
+		bSet = SUCCEEDED(pDXGIDevice->SetGPUThreadPriority(priority));
+		pDXGIDevice->Release();
+	}
+	if (!bSet)
+		SpoutLogWarning("spoutDirectX::SetGPUPriority(%d) - could not set GPU thread priority", priority);
+
+	return bSet;
+}
+
+//---------------------------------------------------------
+// Function: GetGPUPriority
+// GPU thread priority of devices created by the class
+int spoutDirectX::GetGPUPriority()
+{
+	return m_GPUPriority;
+}
+
+//---------------------------------------------------------
+// Function: TrimDevice
+// Release retained textures and trim the class device.
+//
+// Idle staging textures and shared textures retained for the
+// device are released. For a class device, driver memory
+// that is no longer used is then released by IDXGIDevice3::Trim,
+// as required when an application is suspended.
+// An application device is not trimmed because the pipeline
+// state of the application must be cleared first.
+bool spoutDirectX::TrimDevice()
+{
+	if (!m_pd3dDevice)
+		return false;
+
+	ReleaseStagingPool(m_pd3dDevice);
+	ReleaseSharedTextures(m_pd3dDevice);
+
+	if (!m_bClassDevice || !m_pImmediateContext)
+		return true;
+
+	// Pipeline state must be cleared before Trim
+	m_pImmediateContext->ClearState();
+	m_pImmediateContext->Flush();
+
+	IDXGIDevice3* pDXGIDevice3 = nullptr;
+	if (FAILED(m_pd3dDevice->QueryInterface(__uuidof(IDXGIDevice3), reinterpret_cast<void**>(&pDXGIDevice3)))) {
+		SpoutLogWarning("spoutDirectX::TrimDevice - IDXGIDevice3 not supported");
+		return false;
+	}
+	pDXGIDevice3->Trim();
+	pDXGIDevice3->Release();
+
+	SpoutLogNotice("spoutDirectX::TrimDevice(0x%.7X)", PtrToUint(m_pd3dDevice));
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryBudget
+// Local video memory budget and current usage of the class device adapter.
+// Requires Windows 10 (IDXGIAdapter3).
+bool spoutDirectX::GetMemoryBudget(UINT64 &budget, UINT64 &usage)
+{
+	budget = 0;
+	usage = 0;
+	if (!OpenBudgetAdapter())
+		return false;
+
+	DXGI_QUERY_VIDEO_MEMORY_INFO info={};
+	if (FAILED(m_pBudgetAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+		return false;
+
+	budget = info.Budget;
+	usage = info.CurrentUsage;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: CheckMemoryBudget
+// Video memory usage exceeds the budget.
+//
+// The budget is queried when the operating system signals a change
+// and at most once a second for changes of usage by this process.
+// Retained textures can then be released before resources that
+// are in use fail to be created.
+bool spoutDirectX::CheckMemoryBudget()
+{
+	if (!OpenBudgetAdapter())
+		return false;
+
+	const DWORD dwNow = GetTickCount();
+	if (WaitForSingleObject(m_hBudgetEvent, 0) != WAIT_OBJECT_0
+		&& (dwNow - m_dwBudgetTime) < 1000)
+		return false;
+	m_dwBudgetTime = dwNow;
+
+	UINT64 budget = 0;
+	UINT64 usage = 0;
+	if (!GetMemoryBudget(budget, usage) || usage <= budget)
+		return false;
+
+	SpoutLogWarning("spoutDirectX::CheckMemoryBudget - usage %llu MB exceeds budget %llu MB",
+		usage/(1024*1024), budget/(1024*1024));
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetTextureBytes
+// Bytes of a texture of the given size and format.
+//
+// Including all array slices and mip levels. The figure is the size
+// of the pixel data and does not include driver padding or alignment.
+UINT64 spoutDirectX::GetTextureBytes(unsigned int width, unsigned int height, DXGI_FORMAT format,
+	unsigned int arraysize, unsigned int miplevels)
+{
+	// Bytes per pixel, or of the luminance plane for NV12 and P010
+	UINT64 bytes = 4;
+	switch (format) {
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			bytes = 16;
+			break;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R16G16B16A16_SNORM:
+		case DXGI_FORMAT_R32G32_FLOAT:
+			bytes = 8;
+			break;
+		case DXGI_FORMAT_R16_UNORM:
+		case DXGI_FORMAT_R16_FLOAT:
+		case DXGI_FORMAT_R8G8_UNORM:
+		case DXGI_FORMAT_P010:
+			bytes = 2;
+			break;
+		case DXGI_FORMAT_R8_UNORM:
+		case DXGI_FORMAT_NV12:
+			bytes = 1;
+			break;
+		default:
+			break;
+	}
+
+	const bool bYUV = (format == DXGI_FORMAT_NV12 || format == DXGI_FORMAT_P010);
+	if (arraysize == 0) arraysize = 1;
+	if (miplevels == 0) miplevels = 1;
+
+	UINT64 total = 0;
+	unsigned int w = width;
+	unsigned int h = height;
+	for (unsigned int level = 0; level < miplevels; level++) {
+		UINT64 size = (UINT64)w*(UINT64)h*bytes;
+		if (bYUV) size += size/2; // Chroma plane at half resolution
+		total += size;
+		if (w > 1) w /= 2;
+		if (h > 1) h /= 2;
+	}
+
+	return total*arraysize;
+}
+
+//---------------------------------------------------------
+// Function: AddTextureUsage
+// Add the bytes of a texture to memory usage by category and heap.
+//
+// The category is found from the texture description. Staging textures
+// are in system memory and others in video memory. Null textures are ignored.
+void spoutDirectX::AddTextureUsage(SpoutMemoryUsage& usage, ID3D11Texture2D* pTexture)
+{
+	if (!pTexture)
+		return;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pTexture->GetDesc(&desc);
+	const UINT64 bytes = GetTextureBytes(desc.Width, desc.Height, desc.Format, desc.ArraySize, desc.MipLevels);
+
+	// Including default textures with CPU access on a unified memory device
+	if (desc.Usage == D3D11_USAGE_STAGING || desc.CPUAccessFlags != 0) {
+		usage.staging += bytes;
+		usage.system += bytes;
+	}
+	else {
+		if (desc.MiscFlags & (D3D11_RESOURCE_MISC_SHARED
+			| D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX
+			| D3D11_RESOURCE_MISC_SHARED_NTHANDLE))
+			usage.shared += bytes;
+		else
+			usage.textures += bytes;
+		usage.video += bytes;
+	}
+	usage.total += bytes;
+}
+
+// Adapter of the class device for video memory budget queries
+// and the budget change notification event
+bool spoutDirectX::OpenBudgetAdapter()
+{
+	if (m_pBudgetAdapter)
+		return true;
+	if (!m_pd3dDevice || m_bBudgetChecked)
+		return false;
+
+	// Tested once for the device
+	m_bBudgetChecked = true;
+
+	IDXGIDevice* pDXGIDevice = nullptr;
+	IDXGIAdapter* pAdapter = nullptr;
+	if (SUCCEEDED(m_pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&pDXGIDevice)))) {
+		if (SUCCEEDED(pDXGIDevice->GetAdapter(&pAdapter))) {
+			(void)pAdapter->QueryInterface(__uuidof(IDXGIAdapter3), reinterpret_cast<void**>(&m_pBudgetAdapter));
+			pAdapter->Release();
+		}
+		pDXGIDevice->Release();
+	}
+	if (!m_pBudgetAdapter)
+		return false;
+
+	// Auto reset event, signalled for the first query
+	m_hBudgetEvent = CreateEventA(NULL, FALSE, TRUE, NULL);
+	if (!m_hBudgetEvent
+		|| FAILED(m_pBudgetAdapter->RegisterVideoMemoryBudgetChangeNotificationEvent(m_hBudgetEvent, &m_dwBudgetCookie))) {
+		ReleaseBudgetAdapter();
+		return false;
+	}
+
+	return true;
+}
+
+void spoutDirectX::ReleaseBudgetAdapter()
+{
+	if (m_pBudgetAdapter) {
+		if (m_hBudgetEvent)
+			m_pBudgetAdapter->UnregisterVideoMemoryBudgetChangeNotification(m_dwBudgetCookie);
+		m_pBudgetAdapter->Release();
+	}
+	m_pBudgetAdapter = nullptr;
+	if (m_hBudgetEvent)
+		CloseHandle(m_hBudgetEvent);
+	m_hBudgetEvent = NULL;
+	m_dwBudgetCookie = 0;
+	// Test again for another device
+	m_bBudgetChecked = false;
+}
+
 //
 // Group: DirectX11 texture
 //
@@ -528,13 +1056,27 @@ D3D_FEATURE_LEVEL spoutDirectX::GetDX11FeatureLevel()
 //---------------------------------------------------------
 // Function: CreateSharedDX11Texture
 // Create a DirectX11 shared texture
+//
+// An array size greater than 1 creates an array texture with a view
+// for each camera or eye that is shared with the one share handle.
+// Mip levels other than 1 create a mip chain that the sender updates
+// with GenerateMips. Zero creates the full chain.
+// Receivers can then copy a smaller level for a scaled-down image.
+//
+// If bNThandle is specified and the device supports D3D_FEATURE_LEVEL_11_1,
+// the texture is shared by an NT handle. If a name is also specified,
+// receivers can open the texture by name (OpenDX11shareName).
+// An NT handle returned must be closed by the caller with CloseHandle
+// when the texture is released. Otherwise a legacy handle is returned.
 bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 	unsigned int width,
 	unsigned int height,
 	DXGI_FORMAT format,
 	ID3D11Texture2D** ppSharedTexture,
 	HANDLE& dxShareHandle,
-	bool bKeyed, bool bNThandle)
+	bool bKeyed, bool bNThandle,
+	unsigned int arraysize, unsigned int miplevels,
+	const char* sharename)
 {
 	if (!pd3dDevice) {
 		SpoutLogWarning("spoutDirectX::CreateSharedDX11Texture NULL device");
@@ -559,6 +1101,10 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 
 	SpoutLogNotice("spoutDirectX::CreateSharedDX11Texture");
 	SpoutLogNotice("    pDevice = 0x%.7X, width = %d, height = %d, format = 0x%X (%d)", PtrToUint(pd3dDevice), width, height, format, format);
+	if (arraysize > 1)
+		SpoutLogNotice("    array size = %d", arraysize);
+	if (miplevels != 1)
+		SpoutLogNotice("    mip levels = %d", miplevels);
 
 	// Use the format passed in
 	// If that is zero or DX9 format, use the default format
@@ -595,7 +1141,9 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 		desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
 	// An NT handle is created only if the bNThandle argument is specified
 	// and the graphics hardware supports D3D_FEATURE_LEVEL_11_1
-	if (bNThandle && m_featureLevel > D3D_FEATURE_LEVEL_11_0) {
+	if (bNThandle && pd3dDevice->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_1)
+		bNThandle = false;
+	if (bNThandle) {
 		SpoutLog("    spoutDirectX::CreateSharedDX11Texture : D3D11_RESOURCE_MISC_SHARED_NTHANDLE");
 		desc.MiscFlags |= D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
 	}
@@ -606,8 +1154,11 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 	// The default sampler mode, with no anti-aliasing, has a count of 1 and a quality level of 0.
 	desc.SampleDesc.Quality = 0;
 	desc.SampleDesc.Count	= 1;
-	desc.MipLevels			= 1;
-	desc.ArraySize			= 1;
+	desc.MipLevels			= miplevels;
+	desc.ArraySize			= (arraysize > 1) ? arraysize : 1;
+	// A mip chain is generated from the top level by GenerateMips
+	if (miplevels != 1)
+		desc.MiscFlags |= D3D11_RESOURCE_MISC_GENERATE_MIPS;
 
 	const HRESULT res = pd3dDevice->CreateTexture2D(&desc, NULL, ppSharedTexture);
 	if (FAILED(res)) {
@@ -645,7 +1196,7 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 	// of the resource can be obtained by querying the resource for the IDXGIResource 
 	// interface and then calling GetSharedHandle (or CreateSharedHandle).
 	IDXGIResource1* pOtherResource(NULL);
-	if (FAILED(pTexture->QueryInterface(__uuidof(IDXGIResource), (void**)&pOtherResource))) {
+	if (FAILED(pTexture->QueryInterface(__uuidof(IDXGIResource1), (void**)&pOtherResource))) {
 		SpoutLogWarning("spoutDirectX::CreateSharedDX11Texture - QueryInterface error");
 		return false;
 	}
@@ -655,10 +1206,24 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 	}
 
 	// NT handle
-	if (bNThandle && m_featureLevel > D3D_FEATURE_LEVEL_11_0) {
-		SpoutLog("    CreateSharedTexture - NT handle");
+	if (bNThandle) {
 		// The calling application should release the NT handle.
-		pOtherResource->CreateSharedHandle(NULL, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, NULL, &dxShareHandle);
+		// A name is in the session namespace for OpenSharedResourceByName.
+		wchar_t wname[256]={};
+		if (sharename && *sharename)
+			MultiByteToWideChar(CP_ACP, 0, sharename, -1, wname, 256);
+		SpoutLog("    CreateSharedTexture - NT handle [%s]", (sharename && *sharename) ? sharename : "");
+		const HRESULT hr = pOtherResource->CreateSharedHandle(NULL, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+			wname[0] ? wname : NULL, &dxShareHandle);
+		if (FAILED(hr)) {
+			// E_ACCESSDENIED if the name is already used
+			SpoutLogError("spoutDirectX::CreateSharedDX11Texture - CreateSharedHandle failed : error = 0x%.7X", LOWORD(hr));
+			pOtherResource->Release();
+			(*ppSharedTexture)->Release();
+			*ppSharedTexture = nullptr;
+			dxShareHandle = nullptr;
+			return false;
+		}
 	}
 	else {
 		// Return the shared texture handle if bNThandle is not specified.
@@ -680,12 +1245,32 @@ bool spoutDirectX::CreateSharedDX11Texture(ID3D11Device* pd3dDevice,
 
 }
 
+//---------------------------------------------------------
+// Function: GetSharedTextureName
+// Name of a sender texture shared by a named NT handle.
+//   "<sendername>_SpoutTexture_<id>"
+// The identifier is recorded in the shareHandle field of the sender
+// information in place of a handle and changes when the texture is
+// re-created, so that the name of a released texture is not re-used.
+// Back slashes are reserved for object namespaces and are replaced.
+void spoutDirectX::GetSharedTextureName(const char* sendername, HANDLE dxShareHandle, char* sharename, int maxchars)
+{
+	if (!sendername || !sharename || maxchars < 1)
+		return;
+
+	sprintf_s(sharename, maxchars, "%s_SpoutTexture_%u", sendername, PtrToUint(dxShareHandle));
+	for (char* p = sharename; *p; p++) {
+		if (*p == '\\') *p = '_';
+	}
+}
+
 //---------------------------------------------------------
 // Function: CreateDX11Texture
 // Create a DirectX texture which is not shared
 bool spoutDirectX::CreateDX11Texture(ID3D11Device* pd3dDevice, 
 	unsigned int width, unsigned int height,
-	DXGI_FORMAT format,	ID3D11Texture2D** ppTexture)
+	DXGI_FORMAT format,	ID3D11Texture2D** ppTexture,
+	unsigned int arraysize)
 {
 	if (width == 0 || height == 0)
 		return false;
@@ -723,7 +1308,7 @@ bool spoutDirectX::CreateDX11Texture(ID3D11Device* pd3dDevice,
 	desc.SampleDesc.Quality = 0;
 	desc.SampleDesc.Count = 1;
 	desc.MipLevels = 1;
-	desc.ArraySize = 1;
+	desc.ArraySize = (arraysize > 1) ? arraysize : 1;
 
 	HRESULT res = 0;
 	res = pd3dDevice->CreateTexture2D(&desc, NULL, ppTexture);
@@ -754,6 +1339,28 @@ bool spoutDirectX::CreateDX11Texture(ID3D11Device* pd3dDevice,
 
 }
 
+//---------------------------------------------------------
+// Function: CopySharedTexture
+// Copy a texture, or the first view and top mip level to a single texture.
+//   CopyResource requires textures with the same array size and mip levels.
+//   Staging textures for pixel access have one view and one level, so the
+//   first view and the top level of the sender texture are copied.
+void spoutDirectX::CopySharedTexture(ID3D11DeviceContext* pContext, ID3D11Texture2D* pDest, ID3D11Texture2D* pSource)
+{
+	if (!pContext || !pDest || !pSource)
+		return;
+
+	D3D11_TEXTURE2D_DESC srcdesc={};
+	D3D11_TEXTURE2D_DESC dstdesc={};
+	pSource->GetDesc(&srcdesc);
+	pDest->GetDesc(&dstdesc);
+
+	if (srcdesc.ArraySize == dstdesc.ArraySize && srcdesc.MipLevels == dstdesc.MipLevels)
+		pContext->CopyResource(pDest, pSource);
+	else
+		pContext->CopySubresourceRegion(pDest, 0, 0, 0, 0, pSource, 0, nullptr);
+}
+
 //---------------------------------------------------------
 // Function: CreateDX11StagingTexture
 // Create a DirectX 11 staging texture for read and write
@@ -823,6 +1430,224 @@ bool spoutDirectX::CreateDX11StagingTexture(ID3D11Device* pd3dDevice,
 
 }
 
+//---------------------------------------------------------
+// Function: AcquireStagingTexture
+// Staging texture from the process staging pool or a new one.
+//
+// An existing texture is returned to the pool first.
+// The contents of a texture from the pool are undefined.
+// Return the texture with ReleaseStagingTexture when it
+// is no longer needed. It must not be mapped.
+bool spoutDirectX::AcquireStagingTexture(ID3D11Device* pDevice,
+	unsigned int width, unsigned int height, DXGI_FORMAT format,
+	ID3D11Texture2D** ppStagingTexture, UINT cpuAccess)
+{
+	if (!pDevice || !ppStagingTexture)
+		return false;
+
+	if (*ppStagingTexture) {
+		ReleaseStagingTexture(*ppStagingTexture);
+		*ppStagingTexture = nullptr;
+	}
+
+	// Zero or DX9 format as for CreateDX11StagingTexture
+	if (format == 0 || format == 21 || format == 22)
+		format = DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	// Idle texture of the same description
+	ID3D11Texture2D* pTexture = nullptr;
+	AcquireSRWLockExclusive(&g_StagingLock);
+	EvictStagingPool(GetTickCount());
+	for (int i = 0; i < SPOUT_STAGING_POOL; i++) {
+		SpoutStagingEntry& entry = g_StagingPool[i];
+		if (entry.pTexture && entry.pDevice == pDevice
+			&& entry.width == width && entry.height == height
+			&& entry.format == format && entry.cpuAccess == cpuAccess) {
+			pTexture = entry.pTexture;
+			ZeroMemory(&entry, sizeof(SpoutStagingEntry));
+			break;
+		}
+	}
+	ReleaseSRWLockExclusive(&g_StagingLock);
+
+	if (pTexture) {
+		*ppStagingTexture = pTexture;
+		return true;
+	}
+
+	if (cpuAccess == (D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE)) {
+		// With unified memory, a default texture is mapped directly without a staging copy
+		if (m_bUnifiedMemory && IsUnifiedMemory(pDevice)
+			&& CreateDX11MappableTexture(pDevice, width, height, format, ppStagingTexture))
+			return true;
+		return CreateDX11StagingTexture(pDevice, width, height, format, ppStagingTexture);
+	}
+
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = format;
+	desc.SampleDesc.Count = 1;
+	desc.CPUAccessFlags = cpuAccess;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	const HRESULT hr = pDevice->CreateTexture2D(&desc, NULL, ppStagingTexture);
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDirectX::AcquireStagingTexture - CreateTexture2D failed (0x%.7X)", LOWORD(hr));
+		*ppStagingTexture = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: IsUnifiedMemory
+// Device with unified memory that can map default textures.
+//
+// Integrated and Arm graphics share system memory with the CPU.
+// If the driver also supports mapping default textures, textures
+// used for CPU read and write can be default textures mapped directly
+// instead of staging textures. The copy to or from the shared texture
+// then stays in the GPU layout and there is no staging read back.
+bool spoutDirectX::IsUnifiedMemory(ID3D11Device* pDevice)
+{
+	if (!pDevice)
+		return false;
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS2 options={};
+	if (FAILED(pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS2, &options, sizeof(options))))
+		return false;
+
+	return (options.UnifiedMemoryArchitecture && options.MapOnDefaultTextures);
+}
+
+//---------------------------------------------------------
+// Function: SetUnifiedMemory
+// Use mappable default textures instead of staging textures with unified memory.
+//
+// Enabled by default. Used by AcquireStagingTexture for textures created after the change.
+void spoutDirectX::SetUnifiedMemory(bool bUnified)
+{
+	m_bUnifiedMemory = bUnified;
+}
+
+//---------------------------------------------------------
+// Function: GetUnifiedMemory
+// Unified memory option
+bool spoutDirectX::GetUnifiedMemory()
+{
+	return m_bUnifiedMemory;
+}
+
+//---------------------------------------------------------
+// Function: CreateDX11MappableTexture
+// Create a default texture with CPU access that can be mapped directly.
+//
+// For a device with unified memory (IsUnifiedMemory). The texture has
+// row major layout so that Map returns a pointer to the pixels in the
+// same way as a staging texture. Returns false if it is not supported.
+bool spoutDirectX::CreateDX11MappableTexture(ID3D11Device* pDevice,
+	unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppTexture)
+{
+	if (!pDevice || !ppTexture)
+		return false;
+
+	ID3D11Device3* pDevice3 = nullptr;
+	if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(&pDevice3))))
+		return false;
+
+	D3D11_TEXTURE2D_DESC1 desc={};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
+	desc.BindFlags = 0;
+	desc.TextureLayout = D3D11_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	ID3D11Texture2D1* pTexture = nullptr;
+	HRESULT hr = pDevice3->CreateTexture2D1(&desc, nullptr, &pTexture);
+	pDevice3->Release();
+	if (SUCCEEDED(hr)) {
+		hr = pTexture->QueryInterface(IID_PPV_ARGS(ppTexture));
+		pTexture->Release();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDirectX::CreateDX11MappableTexture - not supported (0x%.7X)", LOWORD(hr));
+		*ppTexture = nullptr;
+		return false;
+	}
+
+	SpoutLogNotice("spoutDirectX::CreateDX11MappableTexture(%d, %d, %d) - 0x%.7X",
+		width, height, format, PtrToUint(*ppTexture));
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReleaseStagingTexture
+// Return a staging texture to the process staging pool.
+//
+// The texture is retained for SPOUT_STAGING_IDLE msec.
+// If the pool is full, the texture idle for longest is released.
+void spoutDirectX::ReleaseStagingTexture(ID3D11Texture2D* pStagingTexture)
+{
+	if (!pStagingTexture)
+		return;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pStagingTexture->GetDesc(&desc);
+	ID3D11Device* pDevice = nullptr;
+	pStagingTexture->GetDevice(&pDevice);
+	if (pDevice) pDevice->Release(); // For comparison only
+
+	const DWORD dwNow = GetTickCount();
+	AcquireSRWLockExclusive(&g_StagingLock);
+	EvictStagingPool(dwNow);
+	int slot = -1;
+	for (int i = 0; i < SPOUT_STAGING_POOL; i++) {
+		if (!g_StagingPool[i].pTexture) {
+			slot = i;
+			break;
+		}
+		if (slot < 0 || g_StagingPool[i].dwTime < g_StagingPool[slot].dwTime)
+			slot = i;
+	}
+	SpoutStagingEntry& entry = g_StagingPool[slot];
+	if (entry.pTexture)
+		entry.pTexture->Release();
+	entry.pDevice = pDevice;
+	entry.pTexture = pStagingTexture;
+	entry.width = desc.Width;
+	entry.height = desc.Height;
+	entry.format = desc.Format;
+	entry.cpuAccess = desc.CPUAccessFlags;
+	entry.dwTime = dwNow;
+	ReleaseSRWLockExclusive(&g_StagingLock);
+}
+
+//---------------------------------------------------------
+// Function: ReleaseStagingPool
+// Release idle staging textures of a device or all devices if null
+void spoutDirectX::ReleaseStagingPool(ID3D11Device* pDevice)
+{
+	AcquireSRWLockExclusive(&g_StagingLock);
+	for (int i = 0; i < SPOUT_STAGING_POOL; i++) {
+		SpoutStagingEntry& entry = g_StagingPool[i];
+		if (entry.pTexture && (!pDevice || entry.pDevice == pDevice)) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutStagingEntry));
+		}
+	}
+	ReleaseSRWLockExclusive(&g_StagingLock);
+}
+
 //---------------------------------------------------------
 // Function: OpenDX11shareHandle
 // Retrieve the pointer of a DirectX11 shared texture
@@ -877,10 +1702,356 @@ bool spoutDirectX::OpenDX11shareHandle(ID3D11Device* pDevice, ID3D11Texture2D**
 
 }
 
-//
-// Group: DirectX11 utiities
-//
-
+//---------------------------------------------------------
+// Function: OpenDX11shareName
+// Retrieve the pointer of a DirectX11 shared texture by the name of its NT handle.
+//   The device must support D3D_FEATURE_LEVEL_11_1 (ID3D11Device1).
+bool spoutDirectX::OpenDX11shareName(ID3D11Device* pDevice, ID3D11Texture2D** ppSharedTexture, const char* sharename)
+{
+	if (!pDevice || !ppSharedTexture || !sharename || !*sharename) {
+		SpoutLogError("spoutDirectX::OpenDX11shareName - null sources");
+		return false;
+	}
+
+	ID3D11Device1* pDevice1 = nullptr;
+	if (FAILED(pDevice->QueryInterface(__uuidof(ID3D11Device1), (void**)&pDevice1)) || !pDevice1) {
+		SpoutLogError("spoutDirectX::OpenDX11shareName - ID3D11Device1 not supported");
+		return false;
+	}
+
+	wchar_t wname[256]={};
+	MultiByteToWideChar(CP_ACP, 0, sharename, -1, wname, 256);
+
+	HRESULT hr = 0;
+	try {
+		hr = pDevice1->OpenSharedResourceByName(wname, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE,
+			__uuidof(ID3D11Texture2D), (void**)(ppSharedTexture));
+	}
+	catch (...) {
+		pDevice1->Release();
+		SpoutLogError("spoutDirectX::OpenDX11shareName - exception opening [%s]", sharename);
+		return false;
+	}
+	pDevice1->Release();
+
+	if (FAILED(hr)) {
+		SpoutLogError("spoutDirectX::OpenDX11shareName [%s] failed : error = %d (0x%.7X)", sharename, LOWORD(hr), LOWORD(hr));
+		return false;
+	}
+
+	return true;
+
+}
+
+//---------------------------------------------------------
+// Function: OpenSharedTexture
+// Retrieve a sender shared texture pointer using textures already opened.
+//
+// OpenSharedResource is an expensive driver call. A texture opened
+// for a sender share handle is retained, so that a receiver that
+// re-connects or switches between senders uses the same texture
+// without opening it again.
+//
+// The texture returned has a reference for the caller and is
+// released as for OpenDX11shareHandle. The reference retained 
+// is released by EvictSharedTexture for the sender, when the sender
+// texture changes, by CheckSharedTextures if the sender has closed,
+// or when the device is released.
+//
+// The share handle remains valid while the texture is retained,
+// so it cannot be re-used for the texture of a different sender.
+//
+// The cache is locked so that textures can be opened
+// by the pre-open thread (StartPreopen).
+//
+// For a sender texture shared by a named NT handle (SPOUT_USAGE_NTHANDLE),
+// the share handle is the identifier of the name and the texture is opened
+// by name (OpenDX11shareName).
+bool spoutDirectX::OpenSharedTexture(ID3D11Device* pDevice, ID3D11Texture2D** ppSharedTexture, HANDLE dxShareHandle, const char* sendername, bool bNThandle)
+{
+	if (!sendername || !*sendername)
+		return OpenDX11shareHandle(pDevice, ppSharedTexture, dxShareHandle);
+
+	if (!pDevice || !ppSharedTexture || !dxShareHandle) {
+		SpoutLogError("spoutDirectX::OpenSharedTexture - null sources");
+		return false;
+	}
+
+	AcquireSRWLockExclusive(&m_SharedLock);
+
+	int slot = -1;
+	for (int i = 0; i < SPOUT_SHARED_CACHE; i++) {
+		SpoutSharedEntry& entry = m_SharedCache[i];
+		if (!entry.pTexture) {
+			if (slot < 0) slot = i;
+			continue;
+		}
+		if (strcmp(entry.sendername, sendername) != 0)
+			continue;
+		if (entry.pDevice == pDevice && entry.dxShareHandle == dxShareHandle) {
+			// Already opened
+			entry.pTexture->AddRef();
+			entry.dwTime = GetTickCount();
+			*ppSharedTexture = entry.pTexture;
+			ReleaseSRWLockExclusive(&m_SharedLock);
+			return true;
+		}
+		// The texture of the sender has changed
+		if (entry.pDevice == pDevice) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutSharedEntry));
+			if (slot < 0) slot = i;
+		}
+	}
+
+	bool bOpened = false;
+	if (bNThandle) {
+		char sharename[256]={};
+		GetSharedTextureName(sendername, dxShareHandle, sharename, 256);
+		bOpened = OpenDX11shareName(pDevice, ppSharedTexture, sharename);
+	}
+	else {
+		bOpened = OpenDX11shareHandle(pDevice, ppSharedTexture, dxShareHandle);
+	}
+	if (!bOpened) {
+		ReleaseSRWLockExclusive(&m_SharedLock);
+		return false;
+	}
+
+	// Replace the least recently opened if the cache is full
+	if (slot < 0) {
+		slot = 0;
+		for (int i = 1; i < SPOUT_SHARED_CACHE; i++) {
+			if ((GetTickCount() - m_SharedCache[i].dwTime) > (GetTickCount() - m_SharedCache[slot].dwTime))
+				slot = i;
+		}
+		m_SharedCache[slot].pTexture->Release();
+	}
+
+	SpoutSharedEntry& entry = m_SharedCache[slot];
+	entry.pDevice = pDevice;
+	entry.dxShareHandle = dxShareHandle;
+	strcpy_s(entry.sendername, 256, sendername);
+	entry.pTexture = *ppSharedTexture;
+	entry.pTexture->AddRef(); // Reference retained
+	entry.dwTime = GetTickCount();
+
+	ReleaseSRWLockExclusive(&m_SharedLock);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: EvictSharedTexture
+// Release retained shared textures of a sender
+void spoutDirectX::EvictSharedTexture(const char* sendername)
+{
+	if (!sendername)
+		return;
+
+	AcquireSRWLockExclusive(&m_SharedLock);
+	for (int i = 0; i < SPOUT_SHARED_CACHE; i++) {
+		SpoutSharedEntry& entry = m_SharedCache[i];
+		if (entry.pTexture && strcmp(entry.sendername, sendername) == 0) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutSharedEntry));
+		}
+	}
+	ReleaseSRWLockExclusive(&m_SharedLock);
+}
+
+//---------------------------------------------------------
+// Function: CheckSharedTextures
+// Release retained shared textures of senders that have closed
+// or have a different share handle.
+void spoutDirectX::CheckSharedTextures(spoutSenderNames& sendernames)
+{
+	AcquireSRWLockExclusive(&m_SharedLock);
+	for (int i = 0; i < SPOUT_SHARED_CACHE; i++) {
+		SpoutSharedEntry& entry = m_SharedCache[i];
+		if (!entry.pTexture)
+			continue;
+		SharedTextureInfo info={};
+		if (!sendernames.getSharedInfo(entry.sendername, &info)
+			|| (HANDLE)(LongToHandle((long)info.shareHandle)) != entry.dxShareHandle) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutSharedEntry));
+		}
+	}
+	ReleaseSRWLockExclusive(&m_SharedLock);
+}
+
+//---------------------------------------------------------
+// Function: ReleaseSharedTextures
+// Release all retained shared textures of a device or all devices if null
+void spoutDirectX::ReleaseSharedTextures(ID3D11Device* pDevice)
+{
+	AcquireSRWLockExclusive(&m_SharedLock);
+	for (int i = 0; i < SPOUT_SHARED_CACHE; i++) {
+		SpoutSharedEntry& entry = m_SharedCache[i];
+		if (entry.pTexture && (!pDevice || entry.pDevice == pDevice)) {
+			entry.pTexture->Release();
+			ZeroMemory(&entry, sizeof(SpoutSharedEntry));
+		}
+	}
+	ReleaseSRWLockExclusive(&m_SharedLock);
+}
+
+//---------------------------------------------------------
+// Function: GetSharedTextureCount
+// Number of retained shared textures
+int spoutDirectX::GetSharedTextureCount()
+{
+	int count = 0;
+	AcquireSRWLockShared(&m_SharedLock);
+	for (int i = 0; i < SPOUT_SHARED_CACHE; i++) {
+		if (m_SharedCache[i].pTexture)
+			count++;
+	}
+	ReleaseSRWLockShared(&m_SharedLock);
+	return count;
+}
+
+//---------------------------------------------------------
+// Function: StartPreopen
+// Open sender textures on a thread when senders change.
+//
+//   pDevice    - device used by the receiver
+//   sendername - sender to pre-open or the active sender if null
+//
+// When a sender is created or its texture changes, OpenSharedResource
+// is called on the thread and the texture is retained as for OpenSharedTexture.
+// The receiver then finds the texture already opened when it connects.
+// D3D11 device creation functions are thread safe. The device must not
+// be created with D3D11_CREATE_DEVICE_SINGLETHREADED.
+bool spoutDirectX::StartPreopen(ID3D11Device* pDevice, const char* sendername)
+{
+	if (!pDevice)
+		return false;
+
+	if (m_hPreopenThread)
+		StopPreopen();
+
+	m_pPreopenDevice = pDevice;
+	SetPreopenSender(sendername);
+
+	m_hPreopenStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!m_hPreopenStop) {
+		SpoutLogError("spoutDirectX::StartPreopen - could not create stop event (%d)", GetLastError());
+		m_pPreopenDevice = nullptr;
+		return false;
+	}
+
+	m_hPreopenThread = CreateThread(NULL, 0, PreopenThread, this, 0, NULL);
+	if (!m_hPreopenThread) {
+		SpoutLogError("spoutDirectX::StartPreopen - could not create thread (%d)", GetLastError());
+		CloseHandle(m_hPreopenStop);
+		m_hPreopenStop = NULL;
+		m_pPreopenDevice = nullptr;
+		return false;
+	}
+
+	SpoutLogNotice("spoutDirectX::StartPreopen (%s)", m_PreopenName[0] ? m_PreopenName : "active sender");
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SetPreopenSender
+// Sender to pre-open or the active sender if null
+void spoutDirectX::SetPreopenSender(const char* sendername)
+{
+	AcquireSRWLockExclusive(&m_SharedLock);
+	if (sendername && *sendername)
+		strcpy_s(m_PreopenName, 256, sendername);
+	else
+		m_PreopenName[0] = 0;
+	ReleaseSRWLockExclusive(&m_SharedLock);
+}
+
+//---------------------------------------------------------
+// Function: StopPreopen
+// Stop the pre-open thread.
+// Textures already opened are retained.
+void spoutDirectX::StopPreopen()
+{
+	if (m_hPreopenThread) {
+		SetEvent(m_hPreopenStop);
+		WaitForSingleObject(m_hPreopenThread, INFINITE);
+		CloseHandle(m_hPreopenThread);
+		m_hPreopenThread = NULL;
+		SpoutLogNotice("spoutDirectX::StopPreopen");
+	}
+	if (m_hPreopenStop) {
+		CloseHandle(m_hPreopenStop);
+		m_hPreopenStop = NULL;
+	}
+	m_pPreopenDevice = nullptr;
+}
+
+//---------------------------------------------------------
+// Function: IsPreopen
+// The pre-open thread is running
+bool spoutDirectX::IsPreopen()
+{
+	return (m_hPreopenThread != NULL);
+}
+
+DWORD WINAPI spoutDirectX::PreopenThread(LPVOID lpParameter)
+{
+	spoutDirectX* pDX = static_cast<spoutDirectX*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_HOUSEKEEPING);
+	pDX->PreopenLoop();
+	EndSpoutThread(SPOUT_THREAD_HOUSEKEEPING, hTask);
+	return 0;
+}
+
+// Open the sender texture for each sender change until the stop event is set
+void spoutDirectX::PreopenLoop()
+{
+	// Sender maps opened for this thread
+	spoutSenderNames sendernames;
+	LONG generation = 0;
+	DWORD dwCheck = 0;
+	HANDLE hOpened = nullptr;
+
+	while (WaitForSingleObject(m_hPreopenStop, SPOUT_PREOPEN_POLL) == WAIT_TIMEOUT) {
+
+		// Created, updated or closed senders
+		// or at intervals for senders of earlier versions
+		if (!sendernames.CheckSenderChange(generation, dwCheck))
+			continue;
+
+		char sendername[256]={};
+		AcquireSRWLockShared(&m_SharedLock);
+		strcpy_s(sendername, 256, m_PreopenName);
+		ReleaseSRWLockShared(&m_SharedLock);
+		if (!sendername[0] && !sendernames.GetActiveSender(sendername))
+			continue;
+
+		SharedTextureInfo info={};
+		if (!sendernames.getSharedInfo(sendername, &info))
+			continue;
+
+		// Open once for each share handle
+		const HANDLE dxShareHandle = LongToHandle((long)info.shareHandle);
+		if (!dxShareHandle || dxShareHandle == hOpened)
+			continue;
+		hOpened = dxShareHandle;
+
+		// The texture is retained by the cache
+		ID3D11Texture2D* pTexture = nullptr;
+		if (OpenSharedTexture(m_pPreopenDevice, &pTexture, dxShareHandle, sendername, (info.usage & SPOUT_USAGE_NTHANDLE) != 0)) {
+			pTexture->Release();
+			SpoutLogNotice("spoutDirectX::PreopenLoop - opened [%s] 0x%.7X", sendername, PtrToUint(dxShareHandle));
+		}
+	}
+}
+
+//
+// Group: DirectX11 utiities
+//
+
 //---------------------------------------------------------
 // Function: ReleaseDX11Texture
 // Release a texture resource created with a class device
@@ -934,6 +2105,25 @@ unsigned long spoutDirectX::ReleaseDX11Device(ID3D11Device* pd3dDevice)
 
 	SpoutLogNotice("spoutDirectX::ReleaseDX11Device(0x%.7X)", PtrToUint(pd3dDevice));
 
+	// Release the fence if created
+	// and test again for the next device
+	ReleaseDX11Fence();
+	m_bFenceUnsupported = false;
+
+	// Stop the pre-open thread using the device
+	if (m_pPreopenDevice == pd3dDevice)
+		StopPreopen();
+
+	// Release GPU timing queries of the device
+	if (m_pGPUDevice == pd3dDevice)
+		ReleaseGPUTiming();
+
+	// Release shared textures retained for the device
+	ReleaseSharedTextures(pd3dDevice);
+
+	// Release idle staging textures of the device
+	ReleaseStagingPool(pd3dDevice);
+
 	// Release feature level 1 context and device if created
 	// TOD : refcount
 	if (m_pImmediateContext1) {
@@ -1036,6 +2226,14 @@ void spoutDirectX::Wait(ID3D11Device* pd3dDevice, ID3D11DeviceContext* pImmediat
 	if (!pd3dDevice || !pImmediateContext)
 		return;
 
+	// For the class device, wait on the fence if available
+	// to avoid burning CPU polling the query.
+	// The fence is not created again if it is not supported.
+	if (pImmediateContext == m_pImmediateContext && (m_pFence || (!m_bFenceUnsupported && CreateDX11Fence()))) {
+		if (WaitFence(SignalFence()))
+			return;
+	}
+
 	// https://msdn.microsoft.com/en-us/library/windows/desktop/ff476578%28v=vs.85%29.aspx
 	// When the GPU is finished, ID3D11DeviceContext::GetData will return S_OK.
 	// When using this type of query, ID3D11DeviceContext::Begin is disabled.
@@ -1052,42 +2250,309 @@ void spoutDirectX::Wait(ID3D11Device* pd3dDevice, ID3D11DeviceContext* pImmediat
 	}
 }
 
+//
+// Group: DirectX11 fence
+//
+// ID3D11Fence requires Windows 10 Creators Update and ID3D11Device5.
+// The GPU signals the fence when commands queued before SignalFence complete
+// and an event is set by the driver. A thread can block on the event
+// using a kernel wait without polling, or register a thread pool callback
+// with RegisterWaitForSingleObject using an event passed to SetFenceEvent.
+//
+
+//---------------------------------------------------------
+// Function: CreateDX11Fence
+// Create a fence for the class device
+bool spoutDirectX::CreateDX11Fence()
+{
+	if (m_pFence)
+		return true;
+
+	// Creation failed for this device
+	if (m_bFenceUnsupported)
+		return false;
+
+	if (!m_pd3dDevice || !m_pImmediateContext)
+		return false;
+
+	HRESULT hr = m_pd3dDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&m_pd3dDevice5));
+	if (SUCCEEDED(hr))
+		hr = m_pImmediateContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pImmediateContext4));
+	if (SUCCEEDED(hr))
+		hr = m_pd3dDevice5->CreateFence(0, D3D11_FENCE_FLAG_NONE, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pFence));
+	if (SUCCEEDED(hr)) {
+		m_hFenceEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+		if (!m_hFenceEvent)
+			hr = E_FAIL;
+	}
+
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutDirectX::CreateDX11Fence - fence not available (0x%.7X)", (unsigned int)hr);
+		ReleaseDX11Fence();
+		// Do not try again until the device is released
+		m_bFenceUnsupported = true;
+		return false;
+	}
+
+	m_FenceValue = 0;
+	SpoutLogNotice("spoutDirectX::CreateDX11Fence - created fence (0x%.7X)", PtrToUint(m_pFence));
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReleaseDX11Fence
+// Release the class fence
+void spoutDirectX::ReleaseDX11Fence()
+{
+	if (m_hFenceEvent) CloseHandle(m_hFenceEvent);
+	m_hFenceEvent = NULL;
+	if (m_pFence) m_pFence->Release();
+	m_pFence = nullptr;
+	if (m_pImmediateContext4) m_pImmediateContext4->Release();
+	m_pImmediateContext4 = nullptr;
+	if (m_pd3dDevice5) m_pd3dDevice5->Release();
+	m_pd3dDevice5 = nullptr;
+	m_FenceValue = 0;
+}
+
+//---------------------------------------------------------
+// Function: IsFenceAvailable
+// Fence availability (creates the fence if not already)
+bool spoutDirectX::IsFenceAvailable()
+{
+	return CreateDX11Fence();
+}
+
+//---------------------------------------------------------
+// Function: SignalFence
+// Signal the fence on the immediate context and flush.
+// Returns the value that the GPU will reach when all prior commands
+// have completed, or zero if the fence is not available.
+UINT64 spoutDirectX::SignalFence()
+{
+	if (!m_pFence || !m_pImmediateContext4)
+		return 0;
+
+	m_FenceValue++;
+	if (FAILED(m_pImmediateContext4->Signal(m_pFence, m_FenceValue)))
+		return 0;
+	m_pImmediateContext4->Flush();
+
+	return m_FenceValue;
+}
+
+//---------------------------------------------------------
+// Function: WaitFence
+// Block the calling thread until the GPU reaches a fence value
+// or the timeout (msec) expires. No CPU is used while waiting.
+bool spoutDirectX::WaitFence(UINT64 value, DWORD dwTimeout)
+{
+	if (!m_pFence || !m_hFenceEvent || value == 0)
+		return false;
+
+	// Already complete
+	if (m_pFence->GetCompletedValue() >= value)
+		return true;
+
+	if (FAILED(m_pFence->SetEventOnCompletion(value, m_hFenceEvent)))
+		return false;
+
+	return (WaitForSingleObject(m_hFenceEvent, dwTimeout) == WAIT_OBJECT_0);
+}
+
+//---------------------------------------------------------
+// Function: SetFenceEvent
+// Set an application event which is signalled when the GPU reaches a fence value.
+// The event can be waited on, or used with RegisterWaitForSingleObject
+// for a callback on completion.
+bool spoutDirectX::SetFenceEvent(UINT64 value, HANDLE hEvent)
+{
+	if (!m_pFence || !hEvent || value == 0)
+		return false;
+
+	return SUCCEEDED(m_pFence->SetEventOnCompletion(value, hEvent));
+}
+
+//---------------------------------------------------------
+// Function: GetFenceValue
+// Last fence value signalled
+UINT64 spoutDirectX::GetFenceValue()
+{
+	return m_FenceValue;
+}
 
 //
-// Group: Graphics adapter
+// Group: GPU timing
 //
-// Return graphics adapter number and names.
-// Get and set adapter index for the DirectX device.
+// CPU timers around a copy only measure submission.
+// GPU timing records the time between timestamps written by
+// the GPU before and after a copy, in the same spoutTimer as
+// the CPU scopes of the object.
 //
-// Note that both the Sender and Receiver must use the same graphics adapter.
+// Each scope has a disjoint query and two timestamp queries.
+// Up to SPOUT_GPU_QUERIES scopes are in flight, so results are
+// read a few frames later without waiting for the GPU. A scope is
+// not timed if all are in flight, and the time is not recorded
+// if the GPU frequency changed during the scope.
+//
+//   spoutdx.BeginGPUTime(pContext, "GPUSharedCopy");
+//   pContext->CopyResource(pDest, pSource);
+//   spoutdx.EndGPUTime(pContext);
 //
 
 //---------------------------------------------------------
-// Function: GetNumAdapters
-// Get the number of graphics adapters in the system
-int spoutDirectX::GetNumAdapters()
+// Function: EnableGPUTiming
+// Record the GPU time of copies in a timer, or stop with null.
+// Times are recorded if the timer is also enabled.
+void spoutDirectX::EnableGPUTiming(spoutTimer* pTimer)
 {
-	IDXGIFactory1* _dxgi_factory1 = nullptr;
-	IDXGIAdapter* adapter1_ptr = nullptr;
-	UINT32 i = 0;
+	if (!pTimer)
+		ReleaseGPUTiming();
+	m_pGPUTimer = pTimer;
+}
 
-	// Enum Adapters first : multiple video cards
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1))) {
-		SpoutLogError("spoutDirectX::GetNumAdapters - No adapters found");
-		return 0;
+//---------------------------------------------------------
+// Function: IsGPUTiming
+// GPU timing enabled
+bool spoutDirectX::IsGPUTiming()
+{
+	return (m_pGPUTimer && m_pGPUTimer->IsEnabled());
+}
+
+//---------------------------------------------------------
+// Function: BeginGPUTime
+// Start GPU timing of a named scope on a context.
+// The name must be a string literal or persist for the life of the timer.
+// Queries are created for the device of the context when first used.
+void spoutDirectX::BeginGPUTime(ID3D11DeviceContext* pContext, const char* name)
+{
+	if (!pContext || !name || m_bGPUScope || !IsGPUTiming())
+		return;
+
+	ID3D11Device* pDevice = nullptr;
+	pContext->GetDevice(&pDevice);
+	if (!pDevice)
+		return;
+
+	// Queries of a different device
+	if (m_pGPUDevice && m_pGPUDevice != pDevice)
+		ReleaseGPUTiming();
+
+	if (!m_pGPUDevice) {
+		D3D11_QUERY_DESC disjoint = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+		D3D11_QUERY_DESC timestamp = { D3D11_QUERY_TIMESTAMP, 0 };
+		HRESULT hr = S_OK;
+		for (int i = 0; i < SPOUT_GPU_QUERIES && SUCCEEDED(hr); i++) {
+			hr = pDevice->CreateQuery(&disjoint, &m_GPUQuery[i].pDisjoint);
+			if (SUCCEEDED(hr)) hr = pDevice->CreateQuery(&timestamp, &m_GPUQuery[i].pBegin);
+			if (SUCCEEDED(hr)) hr = pDevice->CreateQuery(&timestamp, &m_GPUQuery[i].pEnd);
+		}
+		m_pGPUDevice = pDevice;
+		if (FAILED(hr)) {
+			SpoutLogWarning("spoutDirectX::BeginGPUTime - could not create queries (0x%.7X)", (unsigned int)hr);
+			ReleaseGPUTiming();
+			m_pGPUTimer = nullptr;
+			pDevice->Release();
+			return;
+		}
+		SpoutLogNotice("spoutDirectX::BeginGPUTime - created %d timing queries", SPOUT_GPU_QUERIES);
 	}
-	if (!_dxgi_factory1) return 0;
+	pDevice->Release();
 
-	for (i = 0; _dxgi_factory1->EnumAdapters( i, &adapter1_ptr ) != DXGI_ERROR_NOT_FOUND; i++ )	{
-		if (!adapter1_ptr) break;
+	// Read completed scopes to free the ring
+	ReadGPUTimes(pContext);
+	if (m_GPUPending >= SPOUT_GPU_QUERIES)
+		return;
 
-		adapter1_ptr->Release();
+	SpoutGPUQuery& query = m_GPUQuery[m_GPUWrite];
+	query.name = name;
+	pContext->Begin(query.pDisjoint);
+	pContext->End(query.pBegin);
+	m_bGPUScope = true;
+}
+
+//---------------------------------------------------------
+// Function: EndGPUTime
+// End GPU timing of the scope started by BeginGPUTime
+void spoutDirectX::EndGPUTime(ID3D11DeviceContext* pContext)
+{
+	if (!pContext || !m_bGPUScope)
+		return;
+
+	SpoutGPUQuery& query = m_GPUQuery[m_GPUWrite];
+	pContext->End(query.pEnd);
+	pContext->End(query.pDisjoint);
+	m_GPUWrite = (m_GPUWrite + 1) % SPOUT_GPU_QUERIES;
+	m_GPUPending++;
+	m_bGPUScope = false;
+}
+
+//---------------------------------------------------------
+// Function: ReadGPUTimes
+// Record the GPU time of scopes that have completed.
+// Results are polled without flushing the context and
+// the oldest scope that is not complete stops the read.
+void spoutDirectX::ReadGPUTimes(ID3D11DeviceContext* pContext)
+{
+	if (!pContext || !m_pGPUDevice)
+		return;
+
+	while (m_GPUPending > 0) {
+		SpoutGPUQuery& query = m_GPUQuery[m_GPURead];
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint={};
+		if (pContext->GetData(query.pDisjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+		UINT64 begin = 0;
+		UINT64 end = 0;
+		if (pContext->GetData(query.pBegin, &begin, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK
+			|| pContext->GetData(query.pEnd, &end, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+		if (!disjoint.Disjoint && disjoint.Frequency > 0 && end >= begin && m_pGPUTimer)
+			m_pGPUTimer->Record(query.name, static_cast<double>(end - begin)*1000.0/static_cast<double>(disjoint.Frequency));
+		m_GPURead = (m_GPURead + 1) % SPOUT_GPU_QUERIES;
+		m_GPUPending--;
 	}
+}
 
-	_dxgi_factory1->Release();
+//---------------------------------------------------------
+// Function: ReleaseGPUTiming
+// Release GPU timing queries.
+// They are created again by BeginGPUTime if timing is enabled.
+void spoutDirectX::ReleaseGPUTiming()
+{
+	for (int i = 0; i < SPOUT_GPU_QUERIES; i++) {
+		if (m_GPUQuery[i].pDisjoint) m_GPUQuery[i].pDisjoint->Release();
+		if (m_GPUQuery[i].pBegin) m_GPUQuery[i].pBegin->Release();
+		if (m_GPUQuery[i].pEnd) m_GPUQuery[i].pEnd->Release();
+	}
+	ZeroMemory(m_GPUQuery, sizeof(m_GPUQuery));
+	m_pGPUDevice = nullptr;
+	m_GPUWrite   = 0;
+	m_GPURead    = 0;
+	m_GPUPending = 0;
+	m_bGPUScope  = false;
+}
 
-	return i;
 
+//
+// Group: Graphics adapter
+//
+// Return graphics adapter number and names.
+// Get and set adapter index for the DirectX device.
+//
+// Note that both the Sender and Receiver must use the same graphics adapter.
+//
+
+//---------------------------------------------------------
+// Function: GetNumAdapters
+// Get the number of graphics adapters in the system
+int spoutDirectX::GetNumAdapters()
+{
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	const int n = CheckAdapterTable() ? g_nAdapters : 0;
+	ReleaseSRWLockExclusive(&g_AdapterLock);
+	return n;
 }
 
 //---------------------------------------------------------
@@ -1095,39 +2560,18 @@ int spoutDirectX::GetNumAdapters()
 // Get the name of an adapter index
 bool spoutDirectX::GetAdapterName(int index, char *adaptername, int maxchars)
 {
-	if (!adaptername)
+	if (!adaptername || maxchars <= 0)
 		return false;
 
-	IDXGIFactory1* _dxgi_factory1 = nullptr;
-	IDXGIAdapter* adapter1_ptr = nullptr;
-
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1))) {
-		SpoutLogError("spoutDirectX::GetAdapterName - Could not create CreateDXGIFactory1");
-		return false;
-	}
-	if(!_dxgi_factory1)	return false;
-	
-	for (int i = 0; _dxgi_factory1->EnumAdapters(i, &adapter1_ptr) != DXGI_ERROR_NOT_FOUND; i++) {
-		if (!adapter1_ptr) break;
-		
-		// Break if the requested index is found
-		// Return the adapter name.
-		if(i == index) {
-			DXGI_ADAPTER_DESC desc;
-			adapter1_ptr->GetDesc( &desc );
-			size_t charsConverted = 0;
-			const size_t maxBytes = static_cast<size_t>(maxchars);
-			wcstombs_s(&charsConverted, adaptername, maxBytes, desc.Description, maxBytes - 1);
-			adapter1_ptr->Release();
-			_dxgi_factory1->Release();
-			return true;
-		}
-		adapter1_ptr->Release();
+	bool bFound = false;
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	if (CheckAdapterTable() && index >= 0 && index < g_nAdapters) {
+		strncpy_s(adaptername, (size_t)maxchars, g_Adapters[index].name, _TRUNCATE);
+		bFound = true;
 	}
+	ReleaseSRWLockExclusive(&g_AdapterLock);
 
-	_dxgi_factory1->Release();
-
-	return false;
+	return bFound;
 }
 
 //---------------------------------------------------------
@@ -1139,39 +2583,70 @@ int spoutDirectX::GetAdapterIndex(const char* adaptername)
 	if (!adaptername)
 		return -1;
 
-	IDXGIFactory1* _dxgi_factory1 = nullptr;
-	IDXGIAdapter* adapter1_ptr = nullptr;
-	DXGI_ADAPTER_DESC desc={};
-	size_t charsConverted = 0;
-	char name[256]={}; // Maximum size of desc.Description in bytes (WCHAR 128)
-
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1))) {
-		SpoutLogError("spoutDirectX::GetAdapterIndex - Could not create CreateDXGIFactory1");
-		return -1;
+	int index = -1;
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	if (CheckAdapterTable()) {
+		for (int i = 0; i < g_nAdapters; i++) {
+			if (strcmp(g_Adapters[i].name, adaptername) == 0) {
+				index = i;
+				break;
+			}
+		}
 	}
-	if(!_dxgi_factory1) return false;
+	ReleaseSRWLockExclusive(&g_AdapterLock);
 
-	for (UINT32 i = 0; _dxgi_factory1->EnumAdapters(i, &adapter1_ptr) != DXGI_ERROR_NOT_FOUND; i++) {
-		if (adapter1_ptr) {
+	// -1 if the adapter name was not found
+	return index;
+}
 
-			adapter1_ptr->GetDesc(&desc);
-			// Convert wide char description for comparison with requested name
-			wcstombs_s(&charsConverted, name, 256, desc.Description, 256);
-			if (charsConverted > 0) {
-				// Break if the same name is found and return the adapter index
-				if (strcmp(name, adaptername) == 0) {
-					adapter1_ptr->Release();
-					_dxgi_factory1->Release();
-					return i;
-				}
+//---------------------------------------------------------
+// Function: GetAdapterIndex
+// Get the index of an adapter LUID.
+// Return -1 if the adapter was not found,
+int spoutDirectX::GetAdapterIndex(LUID luid)
+{
+	int index = -1;
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	if (CheckAdapterTable()) {
+		for (int i = 0; i < g_nAdapters; i++) {
+			if (g_Adapters[i].desc.AdapterLuid.LowPart == luid.LowPart
+				&& g_Adapters[i].desc.AdapterLuid.HighPart == luid.HighPart) {
+				index = i;
+				break;
 			}
-			adapter1_ptr->Release();
 		}
 	}
-	_dxgi_factory1->Release();
+	ReleaseSRWLockExclusive(&g_AdapterLock);
 
-	// -1 if the adapter name was not found
-	return -1;
+	return index;
+}
+
+//---------------------------------------------------------
+// Function: GetDeviceAdapterLuid
+// Get the LUID of the adapter of a device.
+// The LUID identifies the adapter for all processes.
+bool spoutDirectX::GetDeviceAdapterLuid(ID3D11Device* pd3dDevice, LUID &luid)
+{
+	if (!pd3dDevice)
+		return false;
+
+	IDXGIDevice* pDXGIDevice = nullptr;
+	if (FAILED(pd3dDevice->QueryInterface(__uuidof(IDXGIDevice), (void**)&pDXGIDevice)) || !pDXGIDevice)
+		return false;
+
+	bool bResult = false;
+	IDXGIAdapter* pAdapter = nullptr;
+	if (SUCCEEDED(pDXGIDevice->GetAdapter(&pAdapter)) && pAdapter) {
+		DXGI_ADAPTER_DESC desc={};
+		if (SUCCEEDED(pAdapter->GetDesc(&desc))) {
+			luid = desc.AdapterLuid;
+			bResult = true;
+		}
+		pAdapter->Release();
+	}
+	pDXGIDevice->Release();
+
+	return bResult;
 }
 
 //---------------------------------------------------------
@@ -1271,45 +2746,22 @@ bool spoutDirectX::GetAdapterInfo(char* adaptername, char* output, int maxchars)
 // Get the description and output display name for a given adapter
 bool spoutDirectX::GetAdapterInfo(int index, char* adaptername, char* output, int maxchars)
 {
-	if (!adaptername || !output)
-		return false;
-
-	IDXGIFactory1* _dxgi_factory1 = nullptr;
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1))) {
-		SpoutLogError("spoutDirectX::GetAdapterInfo - Could not create CreateDXGIFactory1");
+	if (!adaptername || !output || maxchars <= 0)
 		return false;
-	}
-	if (!_dxgi_factory1) return 0;
-
 
-	IDXGIAdapter* adapter1_ptr = nullptr;
-	size_t charsConverted = 0;
-	const size_t maxBytes = static_cast<size_t>(maxchars);
 	*adaptername = 0;
 	*output = 0;
-	if(_dxgi_factory1->EnumAdapters(index, &adapter1_ptr) != DXGI_ERROR_NOT_FOUND) {
-		if (adapter1_ptr) {
-			// Adapter name
-			DXGI_ADAPTER_DESC desc;
-			adapter1_ptr->GetDesc(&desc);
-			wcstombs_s(&charsConverted, adaptername, maxBytes, desc.Description, maxBytes-1);
-			// Find the first output (index 0) on which the desktop primary is displayed.
-			IDXGIOutput* p_output = nullptr;
-			if (adapter1_ptr->EnumOutputs(0, &p_output) != DXGI_ERROR_NOT_FOUND) {
-				if (p_output) {
-					DXGI_OUTPUT_DESC desc_out;
-					p_output->GetDesc(&desc_out);
-					wcstombs_s(&charsConverted, output, maxBytes, desc_out.DeviceName, maxBytes - 1);
-					// TODO : if (desc_out.AttachedToDesktop)
-					p_output->Release();
-				}
-			}
-			adapter1_ptr->Release();
-		}
 
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	const bool bTable = CheckAdapterTable();
+	if (bTable && index >= 0 && index < g_nAdapters) {
+		strncpy_s(adaptername, (size_t)maxchars, g_Adapters[index].name, _TRUNCATE);
+		// The first output (index 0) on which the desktop primary is displayed.
+		strncpy_s(output, (size_t)maxchars, g_Adapters[index].output, _TRUNCATE);
 	}
-	_dxgi_factory1->Release();
-	return true;
+	ReleaseSRWLockExclusive(&g_AdapterLock);
+
+	return bTable;
 }
 
 //---------------------------------------------------------
@@ -1365,71 +2817,211 @@ void spoutDirectX::SetAdapterPointer(IDXGIAdapter* pAdapter)
 // For purposes where NVIDIA hardware acceleration is used (e.g. FFmpeg)
 bool spoutDirectX::FindNVIDIA(int& nAdapter)
 {
-	IDXGIFactory1* _dxgi_factory1 = nullptr;
-	IDXGIAdapter* adapter1_ptr = nullptr;
-	DXGI_ADAPTER_DESC desc={};
-	UINT32 i = 0;
 	bool bFound = false;
 
-	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&_dxgi_factory1)))
-		return false;
-	if (!_dxgi_factory1) return false;
-
-	for (i = 0; _dxgi_factory1->EnumAdapters(i, &adapter1_ptr) != DXGI_ERROR_NOT_FOUND; i++) {
-		if (!adapter1_ptr) break;
-		adapter1_ptr->GetDesc(&desc);
-		DXGI_OUTPUT_DESC desc_out={};
-		IDXGIOutput* p_output = nullptr;
-		// TODO 
-		// if(adapter1_ptr->EnumOutputs(0, &p_output ) == DXGI_ERROR_NOT_FOUND) {
-		//		if(!p_output) continue;
-		//		if(p_output == 0) {
-		//			printf("  No outputs\n");
-		//			continue;
-		//		}
-		//	}
-		for (int j = 0; adapter1_ptr->EnumOutputs(j, &p_output) != DXGI_ERROR_NOT_FOUND; j++) {
-			if (p_output) {
-				p_output->GetDesc(&desc_out);
-				// printf( "  Output : %d\n", j );
-				// printf( "    Name %S\n", desc_out.DeviceName );
-				// printf( "    Attached to desktop : (%d) %s\n", desc_out.AttachedToDesktop, desc_out.AttachedToDesktop ? "yes" : "no" );
-				// printf( "    Rotation : %d\n", desc_out.Rotation );
-				// printf( "    Left     : %d\n", desc_out.DesktopCoordinates.left );
-				// printf( "    Top      : %d\n", desc_out.DesktopCoordinates.top );
-				// printf( "    Right    : %d\n", desc_out.DesktopCoordinates.right );
-				// printf( "    Bottom   : %d\n", desc_out.DesktopCoordinates.bottom );
-				p_output->Release();
+	//	0x10DE	NVIDIA
+	//	0x163C	intel
+	//	0x8086  Intel
+	//	0x8087  Intel
+	AcquireSRWLockExclusive(&g_AdapterLock);
+	if (CheckAdapterTable()) {
+		for (int i = 0; i < g_nAdapters; i++) {
+			if (wcsstr(g_Adapters[i].desc.Description, L"NVIDIA")) {
+				nAdapter = i;
+				bFound = true;
+				break;
 			}
 		}
-		adapter1_ptr->Release();
+	}
+	ReleaseSRWLockExclusive(&g_AdapterLock);
 
-		if (wcsstr(desc.Description, L"NVIDIA")) {
-			// printf("spoutDirectX::FindNVIDIA - Found NVIDIA adapter %d (%S)\n", i, desc.Description);
-			bFound = true;
-			break;
+	return bFound;
+}
+
+//---------------------------------------------------------
+// Function: ProbeAdapters
+// Measure the copy latency of each graphics adapter and return the fastest.
+//
+// A texture is copied on a test device for each adapter. For readback (bReadback true)
+// the copy is to a staging texture which is then mapped, as for sharing by CPU memory.
+// Otherwise the copy is between two textures and the GPU is waited on.
+// The software adapter (Microsoft Basic Render Driver) is skipped.
+// The fastest adapter name is recorded in the registry for SetFastestAdapter.
+// Returns -1 if no adapter could be tested.
+int spoutDirectX::ProbeAdapters(bool bReadback, unsigned int width, unsigned int height)
+{
+	int fastest = -1;
+	double fastestms = 0.0;
+	char adaptername[256]={};
+
+	if (width == 0 || height == 0) {
+		width = 1920;
+		height = 1080;
+	}
+
+	SpoutLogNotice("spoutDirectX::ProbeAdapters(%s, %dx%d)", bReadback ? "readback" : "texture", width, height);
+
+	const int nAdapters = GetNumAdapters();
+	for (int i = 0; i < nAdapters; i++) {
+		IDXGIAdapter* pAdapter = GetAdapterPointer(i);
+		if (!pAdapter) continue;
+
+		DXGI_ADAPTER_DESC desc={};
+		pAdapter->GetDesc(&desc);
+		if (desc.VendorId == 0x1414) { // Microsoft Basic Render Driver
+			pAdapter->Release();
+			continue;
 		}
 
+		const double ms = ProbeAdapter(pAdapter, bReadback, width, height);
+		pAdapter->Release();
+
+		GetAdapterName(i, adaptername, 256);
+		if (ms > 0.0) {
+			SpoutLogNotice("    adapter %d [%s] %.3f msec", i, adaptername, ms);
+			if (fastest < 0 || ms < fastestms) {
+				fastest = i;
+				fastestms = ms;
+			}
+		}
+		else {
+			SpoutLogWarning("    adapter %d [%s] could not be tested", i, adaptername);
+		}
 	}
 
-	_dxgi_factory1->Release();
+	if (fastest < 0) {
+		SpoutLogError("spoutDirectX::ProbeAdapters - no adapter could be tested");
+		return -1;
+	}
 
-	if (bFound) {
-		// printf// ("spoutDirectX::FindNVIDIA - Found NVIDIA adapter %d (%S)\n", i, desc.Description);
-		nAdapter = i;
-		//	0x10DE	NVIDIA
-		//	0x163C	intel
-		//	0x8086  Intel
-		//	0x8087  Intel
-		// printf("Vendor    = %d [0x%.7X]\n", desc.VendorId, desc.VendorId);
-		// printf("Revision  = %d [0x%.7X]\n", desc.Revision, desc.Revision);
-		// printf("Device ID = %d [0x%.7X]\n", desc.DeviceId, desc.DeviceId);
-		// printf("SubSys ID = %d [0x%.7X]\n", desc.SubSysId, desc.SubSysId);
-		return true;
+	// Record the adapter name rather than the index
+	// in case the adapter order changes
+	if (GetAdapterName(fastest, adaptername, 256)) {
+		WritePathToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout",
+			bReadback ? "ProbeAdapterReadback" : "ProbeAdapterTexture", adaptername);
 	}
 
-	return false;
+	SpoutLogNotice("    fastest adapter %d [%s] %.3f msec", fastest, adaptername, fastestms);
+
+	return fastest;
+}
+
+//---------------------------------------------------------
+// Function: SetFastestAdapter
+// Set the graphics adapter with the lowest copy latency.
+//
+// The adapter recorded by a previous ProbeAdapters is used if it is still present
+// unless bProbe is true. Otherwise the adapters are probed.
+// As for SetAdapter, this must be called before DirectX is initialized.
+bool spoutDirectX::SetFastestAdapter(bool bReadback, bool bProbe)
+{
+	int index = -1;
+
+	if (!bProbe) {
+		char adaptername[256]={};
+		if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout",
+			bReadback ? "ProbeAdapterReadback" : "ProbeAdapterTexture", adaptername, 256)
+			&& adaptername[0]) {
+			index = GetAdapterIndex(adaptername);
+			if (index >= 0)
+				SpoutLogNotice("spoutDirectX::SetFastestAdapter - recorded adapter %d [%s]", index, adaptername);
+		}
+	}
+
+	// No record or the recorded adapter was removed
+	if (index < 0)
+		index = ProbeAdapters(bReadback);
+
+	if (index < 0)
+		return false;
+
+	return SetAdapter(index);
+}
+
+//---------------------------------------------------------
+// Function: ProbeAdapter
+// Average copy latency in milliseconds of one adapter.
+// A test device is created so that the class device is not affected.
+// Returns zero for failure.
+double spoutDirectX::ProbeAdapter(IDXGIAdapter* pAdapter, bool bReadback, unsigned int width, unsigned int height)
+{
+	if (!pAdapter)
+		return 0.0;
+
+	ID3D11Device* pDevice = nullptr;
+	ID3D11DeviceContext* pContext = nullptr;
+	const D3D_FEATURE_LEVEL featureLevels[] = {
+		D3D_FEATURE_LEVEL_11_1,
+		D3D_FEATURE_LEVEL_11_0,
+		D3D_FEATURE_LEVEL_10_1,
+		D3D_FEATURE_LEVEL_10_0,
+	};
+	if (FAILED(D3D11CreateDevice(pAdapter, D3D_DRIVER_TYPE_UNKNOWN, NULL, 0,
+		featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION,
+		&pDevice, NULL, &pContext)) || !pDevice || !pContext) {
+		if (pContext) pContext->Release();
+		if (pDevice) pDevice->Release();
+		return 0.0;
+	}
+
+	double ms = 0.0;
+	ID3D11Texture2D* pSource = nullptr;
+	ID3D11Texture2D* pDest = nullptr;
+	D3D11_TEXTURE2D_DESC desc={};
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+
+	bool bTextures = SUCCEEDED(pDevice->CreateTexture2D(&desc, NULL, &pSource));
+	if (bTextures) {
+		if (bReadback) {
+			desc.Usage = D3D11_USAGE_STAGING;
+			desc.BindFlags = 0;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		}
+		bTextures = SUCCEEDED(pDevice->CreateTexture2D(&desc, NULL, &pDest));
+	}
+
+	if (bTextures) {
+		const int nWarmup = 3;
+		const int nFrames = 10;
+		LARGE_INTEGER frequency={};
+		LARGE_INTEGER start={};
+		LARGE_INTEGER end={};
+		QueryPerformanceFrequency(&frequency);
+		for (int i = 0; i < nWarmup + nFrames; i++) {
+			if (i == nWarmup)
+				QueryPerformanceCounter(&start);
+			pContext->CopyResource(pDest, pSource);
+			if (bReadback) {
+				// Map waits for the copy to complete
+				D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+				if (FAILED(pContext->Map(pDest, 0, D3D11_MAP_READ, 0, &mappedSubResource))) {
+					bTextures = false;
+					break;
+				}
+				pContext->Unmap(pDest, 0);
+			}
+			else {
+				Wait(pDevice, pContext);
+			}
+		}
+		QueryPerformanceCounter(&end);
+		if (bTextures && frequency.QuadPart > 0)
+			ms = (double)(end.QuadPart - start.QuadPart)*1000.0/(double)frequency.QuadPart/(double)nFrames;
+	}
+
+	if (pDest) pDest->Release();
+	if (pSource) pSource->Release();
+	pContext->Release();
+	pDevice->Release();
 
+	return ms;
 }
 
 
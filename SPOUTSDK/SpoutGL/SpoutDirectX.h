@@ -36,6 +36,7 @@
 #include <d3d9.h> // For format definitions
 #include <d3d11.h>
 #include <d3d11_1.h>
+#include <d3d11_4.h> // For ID3D11Fence
 #include <ntverp.h>
 
 //
@@ -61,6 +62,68 @@
 
 using namespace spoututils;
 
+class spoutSenderNames; // for CheckSharedTextures
+
+// Shared textures retained by OpenSharedTexture
+#define SPOUT_SHARED_CACHE 8
+// Time in msec between sender change checks of the pre-open thread
+#define SPOUT_PREOPEN_POLL 2
+
+// Idle staging textures retained for the process by ReleaseStagingTexture
+#define SPOUT_STAGING_POOL 16
+// Time in msec that an idle staging texture is retained
+#define SPOUT_STAGING_IDLE 5000
+
+// Adapters recorded for the process by adapter queries
+#define SPOUT_MAX_ADAPTERS 16
+// Time in msec before adapters are enumerated again if change notification is not available
+#define SPOUT_ADAPTER_REFRESH 2000
+
+// GPU timing scopes in flight before their results are read
+#define SPOUT_GPU_QUERIES 8
+
+// Timestamp queries of a GPU timing scope
+struct SpoutGPUQuery {
+	ID3D11Query* pDisjoint; // D3D11_QUERY_TIMESTAMP_DISJOINT
+	ID3D11Query* pBegin; // D3D11_QUERY_TIMESTAMP
+	ID3D11Query* pEnd;
+	const char* name; // Scope name recorded in the timer
+};
+
+// Memory held by a sender or receiver (GetMemoryUsage)
+struct SpoutMemoryUsage {
+	// By category
+	UINT64 shared;    // Shared textures
+	UINT64 textures;  // Textures that are not shared
+	UINT64 staging;   // Staging textures for CPU access
+	UINT64 buffers;   // OpenGL pixel buffers
+	UINT64 maps;      // Shared memory maps
+	// By heap
+	UINT64 video;     // Video memory (shared and other textures)
+	UINT64 system;    // System memory (staging textures and pixel buffers)
+	UINT64 sharedmap; // Shared memory maps
+	UINT64 total;
+};
+
+// Read-only view of a mapped staging texture (ReceiveImageView)
+struct SpoutImageView {
+	const unsigned char* data; // First pixel of the top line
+	unsigned int pitch; // Bytes per line including padding
+	unsigned int width; // Width in pixels
+	unsigned int height; // Height in lines
+	DWORD format; // DXGI texture format
+	long frame; // Sender frame number
+};
+
+// Shared texture opened by OpenSharedTexture
+struct SpoutSharedEntry {
+	ID3D11Device* pDevice; // Device used to open the texture
+	HANDLE dxShareHandle; // Sender share handle
+	char sendername[256];
+	ID3D11Texture2D* pTexture; // Reference retained by the cache
+	DWORD dwTime; // Time last opened (GetTickCount)
+};
+
 class SPOUT_DLLEXP spoutDirectX {
 
 	public:
@@ -86,19 +149,73 @@ class SPOUT_DLLEXP spoutDirectX {
 		ID3D11DeviceContext* GetDX11Context();
 		// Return the device feature level
 		D3D_FEATURE_LEVEL GetDX11FeatureLevel();
+		// Set the GPU thread priority of devices created by the class (-7 to 7)
+		bool SetGPUPriority(int priority);
+		// GPU thread priority of devices created by the class
+		int GetGPUPriority();
+		// Release retained textures and trim the class device
+		bool TrimDevice();
+		// Local video memory budget and current usage of the class device adapter
+		bool GetMemoryBudget(UINT64 &budget, UINT64 &usage);
+		// Video memory usage exceeds the budget
+		bool CheckMemoryBudget();
+		// Bytes of a texture of the given size and format
+		UINT64 GetTextureBytes(unsigned int width, unsigned int height, DXGI_FORMAT format,
+			unsigned int arraysize = 1, unsigned int miplevels = 1);
+		// Add the bytes of a texture to memory usage by category and heap
+		void AddTextureUsage(SpoutMemoryUsage& usage, ID3D11Texture2D* pTexture);
 
 		//
 		// DirectX11 texture
 		//
 
 		// Create a DirectX11 shared texture
-		bool CreateSharedDX11Texture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppSharedTexture, HANDLE &dxShareHandle, bool bKeyed = false, bool bNThandle = false);
+		bool CreateSharedDX11Texture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppSharedTexture, HANDLE &dxShareHandle, bool bKeyed = false, bool bNThandle = false, unsigned int arraysize = 1, unsigned int miplevels = 1, const char* sharename = nullptr);
+		// Name of a sender texture shared by a named NT handle
+		void GetSharedTextureName(const char* sendername, HANDLE dxShareHandle, char* sharename, int maxchars);
 		// Create a DirectX texture which is not shared
-		bool CreateDX11Texture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppTexture);
+		bool CreateDX11Texture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppTexture, unsigned int arraysize = 1);
+		// Copy a texture, or the first view and top mip level to a single texture
+		void CopySharedTexture(ID3D11DeviceContext* pContext, ID3D11Texture2D* pDest, ID3D11Texture2D* pSource);
 		// Create a DirectX 11 staging texture for read and write
 		bool CreateDX11StagingTexture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** pStagingTexture);
+		// Staging texture from the process staging pool or a new one
+		bool AcquireStagingTexture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppStagingTexture,
+			UINT cpuAccess = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE);
+		// Device with unified memory that can map default textures
+		bool IsUnifiedMemory(ID3D11Device* pDevice);
+		// Use mappable default textures instead of staging textures with unified memory
+		void SetUnifiedMemory(bool bUnified = true);
+		// Unified memory option
+		bool GetUnifiedMemory();
+		// Create a default texture with CPU access that can be mapped directly
+		bool CreateDX11MappableTexture(ID3D11Device* pDevice, unsigned int width, unsigned int height, DXGI_FORMAT format, ID3D11Texture2D** ppTexture);
+		// Return a staging texture to the process staging pool
+		void ReleaseStagingTexture(ID3D11Texture2D* pStagingTexture);
+		// Release idle staging textures of a device or all devices
+		void ReleaseStagingPool(ID3D11Device* pDevice = nullptr);
 		// Retrieve the pointer of a DirectX11 shared texture
 		bool OpenDX11shareHandle(ID3D11Device* pDevice, ID3D11Texture2D** ppSharedTexture, HANDLE dxShareHandle);
+		// Retrieve the pointer of a DirectX11 shared texture by the name of its NT handle
+		bool OpenDX11shareName(ID3D11Device* pDevice, ID3D11Texture2D** ppSharedTexture, const char* sharename);
+		// Retrieve a sender shared texture pointer using textures already opened
+		bool OpenSharedTexture(ID3D11Device* pDevice, ID3D11Texture2D** ppSharedTexture, HANDLE dxShareHandle, const char* sendername, bool bNThandle = false);
+		// Release retained shared textures of a sender
+		void EvictSharedTexture(const char* sendername);
+		// Release retained shared textures of senders that have closed or changed
+		void CheckSharedTextures(spoutSenderNames& sendernames);
+		// Release all retained shared textures of a device or all devices
+		void ReleaseSharedTextures(ID3D11Device* pDevice = nullptr);
+		// Number of retained shared textures
+		int GetSharedTextureCount();
+		// Open sender textures on a thread when senders change
+		bool StartPreopen(ID3D11Device* pDevice, const char* sendername = nullptr);
+		// Sender to pre-open or the active sender if null
+		void SetPreopenSender(const char* sendername = nullptr);
+		// Stop the pre-open thread
+		void StopPreopen();
+		// The pre-open thread is running
+		bool IsPreopen();
 
 		//
 		// DirectX11 utilities
@@ -117,6 +234,42 @@ class SPOUT_DLLEXP spoutDirectX {
 		// Wait for completion after flush
 		void Wait(ID3D11Device* pd3dDevice, ID3D11DeviceContext* pImmediateContext);
 
+		//
+		// DirectX11 fence (Windows 10 and later)
+		//
+
+		// Create a fence for the class device
+		bool CreateDX11Fence();
+		// Release the class fence
+		void ReleaseDX11Fence();
+		// Fence availability
+		bool IsFenceAvailable();
+		// Signal the fence on the immediate context and return the new value
+		UINT64 SignalFence();
+		// Wait for the GPU to reach a fence value without polling
+		bool WaitFence(UINT64 value, DWORD dwTimeout = INFINITE);
+		// Set an event which is signalled when the GPU reaches a fence value
+		bool SetFenceEvent(UINT64 value, HANDLE hEvent);
+		// Last fence value signalled
+		UINT64 GetFenceValue();
+
+		//
+		// GPU timing
+		//
+
+		// Record the GPU time of copies in a timer, or stop with null
+		void EnableGPUTiming(spoutTimer* pTimer);
+		// GPU timing enabled
+		bool IsGPUTiming();
+		// Start GPU timing of a named scope on a context
+		void BeginGPUTime(ID3D11DeviceContext* pContext, const char* name);
+		// End GPU timing of the scope started by BeginGPUTime
+		void EndGPUTime(ID3D11DeviceContext* pContext);
+		// Record the GPU time of scopes that have completed without waiting
+		void ReadGPUTimes(ID3D11DeviceContext* pContext);
+		// Release GPU timing queries
+		void ReleaseGPUTiming();
+
 		//
 		// Graphics adapter
 		//
@@ -127,6 +280,10 @@ class SPOUT_DLLEXP spoutDirectX {
 		bool GetAdapterName(int index, char *adaptername, int maxchars);
 		// Get the index of an adapter name
 		int GetAdapterIndex(const char* adaptername);
+		// Get the index of an adapter LUID
+		int GetAdapterIndex(LUID luid);
+		// Get the LUID of the adapter of a device
+		bool GetDeviceAdapterLuid(ID3D11Device* pd3dDevice, LUID &luid);
 		// Get the current adapter index
 		int GetAdapter();
 		// Set graphics adapter for CreateDX11device from an index
@@ -141,6 +298,10 @@ class SPOUT_DLLEXP spoutDirectX {
 		void SetAdapterPointer(IDXGIAdapter* pAdapter);
 		// Find the index of the NVIDIA adapter in a multi-adapter system
 		bool FindNVIDIA(int &nAdapter);
+		// Measure the copy latency of each adapter and return the fastest
+		int ProbeAdapters(bool bReadback = true, unsigned int width = 1920, unsigned int height = 1080);
+		// Set the adapter with the lowest copy latency recorded or probed
+		bool SetFastestAdapter(bool bReadback = true, bool bProbe = false);
 
 
 // Windows 10 Vers 1803, build 17134 or later
@@ -168,6 +329,11 @@ class SPOUT_DLLEXP spoutDirectX {
 	protected:
 
 		void DebugLog(ID3D11Device* pd3dDevice, const char* format, ...);
+		double ProbeAdapter(IDXGIAdapter* pAdapter, bool bReadback, unsigned int width, unsigned int height);
+		bool OpenBudgetAdapter();
+		void ReleaseBudgetAdapter();
+		static DWORD WINAPI PreopenThread(LPVOID lpParameter);
+		void PreopenLoop();
 		int						m_AdapterIndex; // Adapter index
 		IDXGIAdapter*			m_pAdapterDX11; // Adapter pointer
 		ID3D11Device*           m_pd3dDevice;   // DX11 device
@@ -175,8 +341,34 @@ class SPOUT_DLLEXP spoutDirectX {
 		bool					m_bClassDevice;
 		D3D_DRIVER_TYPE			m_driverType;
 		D3D_FEATURE_LEVEL		m_featureLevel;
+		int						m_GPUPriority; // GPU thread priority of class devices
 		ID3D11Device1*          m_pd3dDevice1;
 		ID3D11DeviceContext1*   m_pImmediateContext1;
+		ID3D11Device5*          m_pd3dDevice5;
+		ID3D11DeviceContext4*   m_pImmediateContext4;
+		ID3D11Fence*            m_pFence;
+		HANDLE                  m_hFenceEvent;
+		UINT64                  m_FenceValue;
+		bool                    m_bFenceUnsupported; // CreateDX11Fence failed for the device
+		SpoutSharedEntry        m_SharedCache[SPOUT_SHARED_CACHE]; // Opened shared textures
+		SRWLOCK                 m_SharedLock; // For the shared texture cache and pre-open sender
+		HANDLE                  m_hPreopenThread;
+		HANDLE                  m_hPreopenStop;
+		ID3D11Device*           m_pPreopenDevice; // Device used by the pre-open thread
+		char                    m_PreopenName[256]; // Sender to pre-open, active sender if empty
+		spoutTimer*             m_pGPUTimer; // Timer for GPU times, null if disabled
+		ID3D11Device*           m_pGPUDevice; // Device of the GPU timing queries
+		SpoutGPUQuery           m_GPUQuery[SPOUT_GPU_QUERIES]; // Ring of GPU timing scopes
+		int                     m_GPUWrite; // Next scope to begin
+		int                     m_GPURead; // Oldest scope in flight
+		int                     m_GPUPending; // Scopes in flight
+		bool                    m_bGPUScope; // A scope has begun and not ended
+		IDXGIAdapter3*          m_pBudgetAdapter; // Adapter for video memory budget
+		HANDLE                  m_hBudgetEvent; // Budget change notification
+		DWORD                   m_dwBudgetCookie;
+		DWORD                   m_dwBudgetTime; // Time of the last budget query
+		bool                    m_bBudgetChecked; // Budget adapter tested
+		bool                    m_bUnifiedMemory; // Mappable default textures on a unified memory device
 
 };
 
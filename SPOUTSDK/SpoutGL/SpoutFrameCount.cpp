@@ -86,6 +86,88 @@
 //					  Change timeout log from error to warning
 //		13.08.23	- EnableFrameCount - correct semaphore name
 //	Version 2.007.013
+//		14.10.26	- Add shared fence synchronisation option
+//					  CreateSharedFence, OpenSharedFence, SignalSharedFence, WaitSharedFence
+//					  CheckTextureAccess/AllowTextureAccess - use the shared fence if open
+//					- Add SetDirtyRects, ReadDirtyRects, GetDirtyRects, GetDirtyFrames
+//					  ResetDirtyRects and CloseDirtyRects for partial texture updates.
+//					  SetNewFrame - publish the dirty rectangles of the frame.
+//					- Shared 64 bit frame counter and sender time in "<sendername>_SpoutFrame"
+//					  SetNewFrame - interlocked increment and a single ReleaseSemaphore
+//					  for receivers of earlier versions. GetNewFrame - read the counter
+//					  without a kernel call if the sender has created it.
+//					  Sender fps from the sender frame times. Add GetSenderFrame64.
+//					- SpoutFrameInfo with size and version for extension and
+//					  GPU copy completion time. GetNewFrame records the frame age
+//					  and missed frames. Add GetFrameAge, GetFrameCopyTime, GetMissedFrames,
+//					  EnableFrameTiming, IsFrameTimingEnabled, CreateFrameTiming, CloseFrameTiming
+//					- CheckTextureAccess, AllowTextureAccess and HoldFps TraceLogging events
+//					- HoldFps - wait for an absolute frame deadline with a high resolution
+//					  waitable timer and spin for the final msec without timeBeginPeriod.
+//					  Add EnableFpsTimer, IsFpsTimerEnabled
+//					- Add WaitFrameSync for the sync events of a number of senders
+//					- Add CreateFrameData, WriteFrameData, ReadFrameData and CloseFrameData
+//					  for data tagged with the frame number in "<sendername>_SpoutData"
+//					- Add CheckTextureAccess and CheckAccess with a timeout,
+//					  SetAccessTimeout and GetAccessTimeout
+//					- SetNewFrame signals frame events "<sendername>_SpoutFrameEvent0" and "1"
+//					  with the shared frame counter. Add WaitNewFrame for idle receivers.
+//					- Add ResetNewFrame
+//					- Add telemetry for all senders and receivers in "SpoutTelemetry"
+//					  SetTelemetry, EnableTelemetry, IsTelemetryEnabled, SetTelemetryMode
+//					  and ReadTelemetry. SetNewFrame and GetNewFrame update the entry.
+//					- Add receiver frame statistics for skipped and repeated frames
+//					  and the largest gap between frames received, since connection
+//					  and for a time window. GetFrameStats, ResetFrameStats, SetFrameStatsWindow
+//					- Add GetFramePacing and PaceReceive. The sender frame interval and
+//					  jitter are predicted from the sender frame times so that a receiver
+//					  can wait for a frame that is due, or delay presentation, to reduce
+//					  judder for a sender with a different frame rate to the display.
+//					- Sender frame rate recorded in the shared frame counter
+//					  for the sender list (spoutSenderNames::GetSenderList)
+//					- Add a frame clock "<clockname>_SpoutClock" published by a timing master
+//					  for senders in other processes to lock their frames to.
+//					  CreateFrameClock, TickFrameClock, OpenFrameClock, WaitFrameClock,
+//					  GetFrameClockTick and CloseFrameClock. HoldFps deadline wait in WaitDeadline.
+//					- Add frame acknowledgement "<sendername>_SpoutAck" for senders that
+//					  must not drop frames. RegisterFrameAck, AckFrame, UnregisterFrameAck,
+//					  WaitFrameAck, GetFrameAckReceivers and CloseFrameAck.
+//					- AckFrame and WaitFrameAck for a frame number, IsFrameAckRegistered
+//					  for frames of a sender texture ring (spoutDX::SetSendPolicy)
+//					- Add SetTelemetryMemory. Telemetry entries record the memory held
+//					  by the sender or receiver in place of the reserved field.
+//					- SpoutFrameInfo version 2 with a GPU hash of the frame content.
+//					  Add SetContentHash for senders and SetSkipUnchanged, GetSkipUnchanged
+//					  and GetContentHash for receivers. GetNewFrame returns false for a frame
+//					  with the same content as the last received if SetSkipUnchanged is set.
+//					- Add control messages "<sendername>_SpoutMessages". Lock-free
+//					  single-producer/single-consumer rings in each direction with a wake
+//					  event for a blocked consumer. OpenControlMessages, WriteControlMessage,
+//					  ReadControlMessage, WaitControlMessage, GetControlMessageCount
+//					  and CloseControlMessages.
+//					- Add EnableFrameCountUID and WaitFrameSyncUID for a sender ID
+//					  (spoutSenderNames::GetSenderUID). The sync event is retained
+//					  while the sender ID is registered.
+//					- Add EnableAccessStats, GetAccessStats and ResetAccessStats.
+//					  Wait and hold times, timeouts and contention of the named and
+//					  keyed mutex are recorded, with the holder and the number waiting
+//					  shared in "<sendername>_SpoutAccess". Telemetry version 2 entries
+//					  include the statistics. A wait longer than a threshold is logged
+//					  and traced.
+//					- Add StartVBlankTiming, StopVBlankTiming, WaitVBlankReceive and
+//					  GetVBlankTiming. A thread waits for the vertical blanks of a display
+//					  output so that a receiver can receive just before scan-out.
+//					- Add CreateFrameSlices, BeginFrameSlices, SignalFrameSlice,
+//					  OpenFrameSlices, GetFrameSlices, WaitFrameSlice and CloseFrameSlices.
+//					  Slices of a frame published with the shared fence value after each
+//					  slice in "<sendername>_SpoutSlices" (spoutDX::SetSendSlices).
+//					- GetNewFrame - trace the receiver check for a new frame
+//					- CheckTextureAccess, AllowTextureAccess - use the named access mutex
+//					  with the shared fence for receivers without it. Add SetFenceOnly
+//					  and IsFenceOnly to use the fence alone.
+//					- CheckTextureAccess - a receiver takes the access mutex before it reads
+//					  the fence value. The sender publishes the value it will signal after
+//					  the write in progress and the receiver waits for it.
 //
 // ====================================================================================
 //
@@ -114,6 +196,8 @@
 */
 
 #include "SpoutFrameCount.h"
+#include "SpoutSenderNames.h" // for sender IDs
+#include <math.h> // for fabs
 
 //
 // Class: spoutFrameCount
@@ -127,19 +211,74 @@
 spoutFrameCount::spoutFrameCount()
 {
 	m_hAccessMutex = NULL;
+	m_dwAccessTimeout = 67; // 4 frames at 60fps
 	m_hCountSemaphore = NULL;
 	m_hSyncEvent = NULL;
+	m_hWaitSyncEvent = NULL;
+	m_WaitSyncUID = 0;
 	m_SenderName[0] = 0;
 	m_CountSemaphoreName[0] = 0;
 	
 	m_FrameCount = 0L;
 	m_LastFrameCount = 0L;
+	m_bRepeatFrame = false;
 	m_FrameTimeTotal = 0.0;
 	m_FrameTimeNumber = 0.0;
 	m_lastFrame = 0.0;
+
+	// Frame content hash
+	m_ContentHash = 0;
+	m_LastContentHash = 0;
+	m_bSkipUnchanged = false;
+
+	// Shared frame counter
+	m_pFrameInfo = nullptr;
+	m_LastFrameTime = 0;
+	m_FrameRetry = 0;
+	m_FrameAge = 0.0;
+	m_FrameCopyTime = 0.0;
+	m_MissedFrames = 0;
+
+	// Frame events
+	m_hFrameEvent[0] = NULL;
+	m_hFrameEvent[1] = NULL;
+	m_bFrameEventSender = false;
+	m_FrameEventRetry = 0;
+
+	// Receiver frame statistics
+	ZeroMemory(&m_FrameStats, sizeof(m_FrameStats));
+	ZeroMemory(&m_WindowStats, sizeof(m_WindowStats));
+	ZeroMemory(&m_LastWindowStats, sizeof(m_LastWindowStats));
+	m_WindowStart = 0;
+	m_dwStatsWindow = 1000;
+	m_LastReceiveTime = 0;
+
+	// Receiver frame pacing
+	m_hPaceTimer = NULL;
+	m_pVBlankOutput = nullptr;
+	m_hVBlankThread = NULL;
+	m_hVBlankStop = NULL;
+	m_VBlankTime = 0;
+	m_VBlankPeriod = 0;
+	m_VBlankOffset = 2.0;
+	ResetFramePacing();
+
+	// Frame timing
+	m_bFrameTiming = false; // default disabled
+	m_pTimingFence = nullptr;
+	m_pTimingContext = nullptr;
+	m_hTimingEvent = NULL;
+	m_hTimingWait = NULL;
+	ZeroMemory(m_PublishTime, sizeof(m_PublishTime));
+	LARGE_INTEGER frequency={};
+	QueryPerformanceFrequency(&frequency);
+	m_CounterFrequency = static_cast<double>(frequency.QuadPart)/1000.0;
 	m_SystemFps = GetRefreshRate(); // System refresh rate
 	m_SenderFps = m_SystemFps; // Default sender fps is system refresh rate
 	m_PeriodMin = 0; // For setting Windows time period
+	m_bFpsTimer = true; // High resolution timer for HoldFps
+	m_hFpsTimer = NULL;
+	m_FpsDeadline = 0;
 	m_bIsNewFrame = true; // Default true for apps without frame count
 
 	// Check the registry setting for frame counting between sender and receiver
@@ -160,6 +299,71 @@ spoutFrameCount::spoutFrameCount()
 	// Sync enabled/disabled
 	m_bFrameSync = true; // default enabled
 
+	// Shared fence
+	m_bFenceSync = false; // default disabled
+	m_bFenceOnly = false; // the access mutex is also used
+	m_bFenceSender = false;
+	m_pSharedFence = nullptr;
+	m_pFenceContext = nullptr;
+	m_hSharedFence = NULL;
+	m_FenceValue = 0;
+
+	// Frame data
+	m_bDataSender = false;
+	m_DataRetry = 0;
+
+	// Dirty rectangles
+	m_bDirtySender = false;
+	m_DirtyFrame = 0;
+	m_DirtyRetry = 0;
+	m_nDirtyPending = 0;
+	m_DirtyHead = 0;
+	m_DirtyFrames = 0;
+	ZeroMemory(m_DirtyPending, sizeof(m_DirtyPending));
+	ZeroMemory(m_DirtyHistory, sizeof(m_DirtyHistory));
+	ZeroMemory(m_nDirtyHistory, sizeof(m_nDirtyHistory));
+
+	// Frame slices
+	m_bSliceSender = false;
+	m_SliceFrame = 0;
+	m_SliceRetry = 0;
+
+	// Telemetry
+	m_bTelemetry = false; // default not set
+	DWORD dwTelemetry = 0;
+	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Telemetry", &dwTelemetry)) {
+		m_bTelemetry = (dwTelemetry == 1);
+	}
+	m_TelemetryName[0] = 0;
+	m_TelemetryMode = 0;
+	m_TelemetryMemoryBytes = 0;
+	m_TelemetryRetry = 0;
+	m_pTelemetry = nullptr;
+
+	// Texture access statistics
+	m_bAccessStats = false;
+	m_AccessWarnMsec = 0.0;
+	m_AccessStats = {};
+	m_AccessStart = 0;
+	m_AccessName[0] = 0;
+	m_pAccessInfo = nullptr;
+
+	// Frame clock
+	m_pClock = nullptr;
+	m_bClockMaster = false;
+	m_ClockTick = 0;
+
+	// Frame acknowledgement
+	m_pAck = nullptr;
+	m_pAckEntry = nullptr;
+	m_hAckEvent = NULL;
+	m_AckSenderName[0] = 0;
+
+	// Control messages
+	m_pMessages = nullptr;
+	m_MessageRing = SPOUT_MESSAGE_TO_RECEIVER;
+	m_hMessageEvent[0] = m_hMessageEvent[1] = NULL;
+
 #ifdef USE_CHRONO
 
 	// For HoldFps
@@ -195,6 +399,18 @@ spoutFrameCount::~spoutFrameCount()
 	if (m_hCountSemaphore) CloseHandle(m_hCountSemaphore);
 	if (m_hAccessMutex) CloseHandle(m_hAccessMutex);
 	if (m_hSyncEvent) CloseHandle(m_hSyncEvent);
+	if (m_hWaitSyncEvent) CloseHandle(m_hWaitSyncEvent);
+	if (m_hFpsTimer) CloseHandle(m_hFpsTimer);
+	StopVBlankTiming();
+	if (m_hPaceTimer) CloseHandle(m_hPaceTimer);
+	CloseFrameEvents();
+	CloseSharedFence();
+	CloseFrameTiming();
+	CloseTelemetry();
+	CloseAccessInfo();
+	CloseFrameClock();
+	CloseFrameAck();
+	CloseControlMessages();
 
 }
 
@@ -234,6 +450,23 @@ void spoutFrameCount::SetFrameCount(bool bEnable)
 	}
 }
 
+// -----------------------------------------------
+// Function: EnableFrameCountUID
+// Enable frame counting for a sender by ID.
+//
+// The sender name is found from the ID (spoutSenderNames::GetSenderUID).
+// Returns false if the sender is not found.
+bool spoutFrameCount::EnableFrameCountUID(uint64_t senderuid)
+{
+	char sendername[256]={};
+	if (!spoutSenderNames::FindSenderUID(senderuid, sendername, 256)) {
+		SpoutLogWarning("SpoutFrameCount::EnableFrameCountUID - sender ID not found");
+		return false;
+	}
+	EnableFrameCount(sendername);
+	return true;
+}
+
 // -----------------------------------------------
 // Function: EnableFrameCount
 // Enable frame counting for this sender.
@@ -250,6 +483,9 @@ void spoutFrameCount::EnableFrameCount(const char* SenderName)
 
 	SpoutLogNotice("SpoutFrameCount::EnableFrameCount - [%s]", SenderName);
 
+	// Name recorded with telemetry, independent of frame counting
+	strcpy_s(m_TelemetryName, 256, SenderName);
+
 	// Return if frame counting not recorded in the registry
 	// Subsequently SetNewFrame and GetNewFrame return without action
 	if (!m_bFrameCount) {
@@ -266,6 +502,10 @@ void spoutFrameCount::EnableFrameCount(const char* SenderName)
 	// Reset frame count, comparator and fps variables
 	m_FrameCount = 0L;
 	m_LastFrameCount = 0L;
+	m_ContentHash = 0;
+	m_LastContentHash = 0;
+	ResetFrameStats();
+	ResetFramePacing();
 	m_FrameTimeTotal = 0.0;
 	m_FrameTimeNumber = 0.0;
 	m_SenderFps = m_SystemFps; // Default sender fps is system refresh rate
@@ -393,10 +633,373 @@ double spoutFrameCount::GetSenderFps()
 // Function: GetSenderFrame
 // Received frame count
 long spoutFrameCount::GetSenderFrame()
+{
+	return static_cast<long>(m_FrameCount);
+}
+
+// -----------------------------------------------
+// Function: GetSenderFrame64
+// Received frame count (64 bit)
+LONG64 spoutFrameCount::GetSenderFrame64()
 {
 	return m_FrameCount;
 }
 
+// -----------------------------------------------
+// Function: GetFrameAge
+// Time in msec from sender publish to receipt of the last frame.
+// Zero for a sender of an earlier version.
+double spoutFrameCount::GetFrameAge()
+{
+	return m_FrameAge;
+}
+
+// -----------------------------------------------
+// Function: GetFrameCopyTime
+// Sender GPU copy time in msec of the last frame completed.
+// Zero if the sender has not enabled frame timing.
+double spoutFrameCount::GetFrameCopyTime()
+{
+	return m_FrameCopyTime;
+}
+
+// -----------------------------------------------
+// Function: GetMissedFrames
+// Number of sender frames not received since the receiver connected
+LONG64 spoutFrameCount::GetMissedFrames()
+{
+	return m_MissedFrames;
+}
+
+// -----------------------------------------------
+// Function: SetSkipUnchanged
+// Receiver skip frames with the same content hash as the last received.
+//
+// A sender with the content hash option publishes a GPU hash of each frame.
+// If the hash of a new frame is the same as that of the last frame received,
+// GetNewFrame returns false so that the copy or read back is skipped,
+// and IsFrameNew is false for the application. For static content such as
+// slides, user interfaces or paused media, the receiving cost falls close to zero.
+// Frames without a hash, or from senders of earlier versions, are always received.
+void spoutFrameCount::SetSkipUnchanged(bool bSkip)
+{
+	m_bSkipUnchanged = bSkip;
+}
+
+// -----------------------------------------------
+// Function: GetSkipUnchanged
+// Skip unchanged frames option
+bool spoutFrameCount::GetSkipUnchanged()
+{
+	return m_bSkipUnchanged;
+}
+
+// -----------------------------------------------
+// Function: GetContentHash
+// Content hash of the last frame received.
+// Zero if the sender did not publish a hash for the frame.
+uint64_t spoutFrameCount::GetContentHash()
+{
+	return m_LastContentHash;
+}
+
+// -----------------------------------------------
+// Function: GetFrameStats
+// Receiver frame statistics.
+//
+// The number of new frames received, sender frames skipped because the
+// receiver was slower than the sender, receive calls that returned a frame
+// already received, the largest number of frames skipped at one time
+// and the longest time between new frames.
+//
+// Statistics are since the receiver connected to the sender or since ResetFrameStats,
+// or for the last completed window of time (SetFrameStatsWindow) if bWindow is true.
+// Frame counting must be enabled.
+void spoutFrameCount::GetFrameStats(SpoutFrameStats &stats, bool bWindow)
+{
+	if (bWindow)
+		stats = m_LastWindowStats;
+	else
+		stats = m_FrameStats;
+}
+
+// -----------------------------------------------
+// Function: ResetFrameStats
+// Reset receiver frame statistics
+void spoutFrameCount::ResetFrameStats()
+{
+	ZeroMemory(&m_FrameStats, sizeof(m_FrameStats));
+	ZeroMemory(&m_WindowStats, sizeof(m_WindowStats));
+	ZeroMemory(&m_LastWindowStats, sizeof(m_LastWindowStats));
+	m_WindowStart = 0;
+	m_LastReceiveTime = 0;
+}
+
+// -----------------------------------------------
+// Function: SetFrameStatsWindow
+// Window for frame statistics in msec (default 1000)
+void spoutFrameCount::SetFrameStatsWindow(DWORD dwMsec)
+{
+	if (dwMsec == 0)
+		dwMsec = 1000;
+	m_dwStatsWindow = dwMsec;
+	ZeroMemory(&m_WindowStats, sizeof(m_WindowStats));
+	m_WindowStart = 0;
+}
+
+// -----------------------------------------------
+// Function: GetFramePacing
+// Receiver frame pacing predicted from the sender frame times.
+//
+// A receiver that renders at the display refresh rate and receives
+// whatever frame is current sees judder from a sender with a different
+// frame rate, for example 50 or 59.94 fps to a 60 Hz display. When a sender
+// frame is published close to the time of the receive, it is received
+// on some refresh cycles and not others.
+//
+// The sender frame interval and jitter are predicted from the publish
+// times of the frames received, or from the receive times and sender fps
+// for a sender of an earlier version. Then :
+//
+//   next    - time until the next sender frame is due
+//   delay   - wait before receiving. If the next frame is due within
+//             SPOUT_PACE_WINDOW of the refresh interval, the receiver can
+//             wait for it rather than receive it one refresh later.
+//             Otherwise zero.
+//   latency - presentation delay after the sender frame time, for
+//             a receiver that buffers frames and presents them by time, so that
+//             each frame is available before the refresh that presents it.
+//
+// "refresh" is the receiver refresh rate in Hz, the system refresh rate if zero.
+// Frame counting must be enabled. Returns false until frames have been received.
+bool spoutFrameCount::GetFramePacing(SpoutFramePacing &pacing, double refresh)
+{
+	ZeroMemory(&pacing, sizeof(SpoutFramePacing));
+
+	if (refresh <= 0.0)
+		refresh = m_SystemFps;
+	if (refresh <= 0.0)
+		refresh = 60.0;
+	pacing.refresh = 1000.0/refresh;
+
+	if (m_PaceTime == 0 || m_PaceInterval <= 0.0)
+		return false;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	pacing.interval = m_PaceInterval;
+	pacing.jitter   = m_PaceJitter;
+
+	// The frame after the last one received.
+	// If it is overdue, it is probably available now.
+	const double elapsed = static_cast<double>(now.QuadPart - m_PaceTime)/m_CounterFrequency;
+	pacing.next = m_PaceInterval - elapsed;
+
+	// Wait for a frame that is due soon
+	const double margin = 2.0*m_PaceJitter + SPOUT_PACE_MARGIN;
+	if (pacing.next > 0.0 && pacing.next + margin < pacing.refresh*SPOUT_PACE_WINDOW)
+		pacing.delay = pacing.next + margin;
+
+	pacing.latency = pacing.refresh + margin;
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: PaceReceive
+// Receiver wait for the next sender frame if it is due within the refresh interval.
+//
+// Call before receiving. The wait is the delay of GetFramePacing
+// with a high resolution waitable timer and spin for the final msec.
+// Returns the time waited in msec.
+double spoutFrameCount::PaceReceive(double refresh)
+{
+	SpoutFramePacing pacing={};
+	if (!GetFramePacing(pacing, refresh) || pacing.delay <= 0.0)
+		return 0.0;
+
+	LARGE_INTEGER start={};
+	QueryPerformanceCounter(&start);
+	const LONG64 deadline = start.QuadPart + static_cast<LONG64>(pacing.delay*m_CounterFrequency);
+
+	WaitPaceDeadline(deadline, pacing.delay);
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	return static_cast<double>(now.QuadPart - start.QuadPart)/m_CounterFrequency;
+}
+
+// -----------------------------------------------
+// Function: StartVBlankTiming
+// Start vertical blank timing of a display output.
+//
+//   hMonitor - monitor of the output, for example MonitorFromWindow
+//              for the receiver window. The primary monitor if null.
+//   offset   - msec before the vertical blank for WaitVBlankReceive
+//
+// A receiver that presents to a display can then receive the newest
+// sender frame just before scan-out rather than up to a frame early.
+// A Spout thread waits for each vertical blank of the output
+// (IDXGIOutput::WaitForVBlank) and records the time and the
+// measured refresh period. The system refresh rate does not
+// line up with the vertical blanks of a particular output.
+bool spoutFrameCount::StartVBlankTiming(HMONITOR hMonitor, double offset)
+{
+	StopVBlankTiming();
+
+	if (!hMonitor) {
+		const POINT pt = { 0, 0 };
+		hMonitor = MonitorFromPoint(pt, MONITOR_DEFAULTTOPRIMARY);
+	}
+	SetVBlankOffset(offset);
+
+	// The output of the monitor on any adapter
+	IDXGIFactory1* pFactory = nullptr;
+	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&pFactory)) || !pFactory) {
+		SpoutLogError("spoutFrameCount::StartVBlankTiming - could not create factory");
+		return false;
+	}
+	IDXGIAdapter1* pAdapter = nullptr;
+	for (UINT i = 0; !m_pVBlankOutput && pFactory->EnumAdapters1(i, &pAdapter) != DXGI_ERROR_NOT_FOUND; i++) {
+		IDXGIOutput* pOutput = nullptr;
+		for (UINT j = 0; !m_pVBlankOutput && pAdapter->EnumOutputs(j, &pOutput) != DXGI_ERROR_NOT_FOUND; j++) {
+			DXGI_OUTPUT_DESC desc={};
+			if (SUCCEEDED(pOutput->GetDesc(&desc)) && desc.Monitor == hMonitor)
+				m_pVBlankOutput = pOutput;
+			else
+				pOutput->Release();
+		}
+		pAdapter->Release();
+	}
+	pFactory->Release();
+
+	if (!m_pVBlankOutput) {
+		SpoutLogWarning("spoutFrameCount::StartVBlankTiming - output not found");
+		return false;
+	}
+
+	InterlockedExchange64(&m_VBlankTime, 0);
+	InterlockedExchange64(&m_VBlankPeriod, 0);
+	m_hVBlankStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (m_hVBlankStop)
+		m_hVBlankThread = CreateThread(NULL, 0, VBlankThread, (LPVOID)this, 0, NULL);
+	if (!m_hVBlankThread) {
+		SpoutLogError("spoutFrameCount::StartVBlankTiming - could not create thread");
+		StopVBlankTiming();
+		return false;
+	}
+
+	SpoutLogNotice("spoutFrameCount::StartVBlankTiming - offset %.2f msec", m_VBlankOffset);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: StopVBlankTiming
+// Stop vertical blank timing
+void spoutFrameCount::StopVBlankTiming()
+{
+	if (m_hVBlankThread) {
+		SetEvent(m_hVBlankStop);
+		WaitForSingleObject(m_hVBlankThread, INFINITE);
+		CloseHandle(m_hVBlankThread);
+		m_hVBlankThread = NULL;
+	}
+	if (m_hVBlankStop) {
+		CloseHandle(m_hVBlankStop);
+		m_hVBlankStop = NULL;
+	}
+	if (m_pVBlankOutput) {
+		m_pVBlankOutput->Release();
+		m_pVBlankOutput = nullptr;
+	}
+	InterlockedExchange64(&m_VBlankTime, 0);
+	InterlockedExchange64(&m_VBlankPeriod, 0);
+}
+
+// -----------------------------------------------
+// Function: IsVBlankTiming
+// Vertical blank timing status
+bool spoutFrameCount::IsVBlankTiming()
+{
+	return (m_hVBlankThread != NULL);
+}
+
+// -----------------------------------------------
+// Function: SetVBlankOffset
+// Msec before the vertical blank to receive.
+//
+// Allow for the receive, render and present time of the application
+// so that the frame is presented at the vertical blank.
+void spoutFrameCount::SetVBlankOffset(double offset)
+{
+	m_VBlankOffset = (offset > 0.0) ? offset : 0.0;
+}
+
+// -----------------------------------------------
+// Function: WaitVBlankReceive
+// Wait until the offset before the next vertical blank.
+//
+// Call before receiving. The next vertical blank is predicted from
+// the last one and the measured period. If the offset time has passed,
+// the wait is for the vertical blank after that.
+// The wait is with a high resolution waitable timer
+// and spin for the final msec, as for PaceReceive.
+// Returns msec from return to the vertical blank,
+// or zero without waiting if vertical blank timing is not started.
+double spoutFrameCount::WaitVBlankReceive()
+{
+	const LONG64 vblank = InterlockedCompareExchange64(&m_VBlankTime, 0, 0);
+	const LONG64 period = InterlockedCompareExchange64(&m_VBlankPeriod, 0, 0);
+	if (vblank == 0 || period <= 0)
+		return 0.0;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	// The next vertical blank with time for the offset
+	const LONG64 offset = static_cast<LONG64>(m_VBlankOffset*m_CounterFrequency);
+	LONG64 next = vblank + period;
+	if (next - offset < now.QuadPart)
+		next += ((now.QuadPart - (next - offset))/period + 1)*period;
+	const LONG64 deadline = next - offset;
+
+	WaitPaceDeadline(deadline, static_cast<double>(deadline - now.QuadPart)/m_CounterFrequency);
+
+	QueryPerformanceCounter(&now);
+
+	return static_cast<double>(next - now.QuadPart)/m_CounterFrequency;
+}
+
+// -----------------------------------------------
+// Function: GetVBlankTiming
+// Measured refresh period and msec until the next vertical blank.
+//
+// Returns false until two vertical blanks have been timed.
+bool spoutFrameCount::GetVBlankTiming(double &period, double &next)
+{
+	period = 0.0;
+	next = 0.0;
+
+	const LONG64 vblank = InterlockedCompareExchange64(&m_VBlankTime, 0, 0);
+	const LONG64 counts = InterlockedCompareExchange64(&m_VBlankPeriod, 0, 0);
+	if (vblank == 0 || counts <= 0)
+		return false;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	LONG64 due = vblank + counts;
+	if (due < now.QuadPart)
+		due += ((now.QuadPart - due)/counts + 1)*counts;
+
+	period = static_cast<double>(counts)/m_CounterFrequency;
+	next = static_cast<double>(due - now.QuadPart)/m_CounterFrequency;
+
+	return true;
+}
+
 
 // -----------------------------------------------
 // Function: HoldFps
@@ -406,7 +1009,13 @@ long spoutFrameCount::GetSenderFrame()
 // have frame rate control. Must be called every frame.
 // The sender will then signal a new frame at the target rate.
 //
-// Note that this function is affected by changes to Windows timer 
+// The default method waits for an absolute deadline with a high resolution
+// waitable timer and spins for the final msec. The deadline advances by the
+// frame time each frame, so there is no drift, and the system timer resolution
+// is not changed. If the timer cannot be created (before Windows 10 1803) 
+// or is disabled by EnableFpsTimer(false), the thread sleeps as follows.
+//
+// Note that sleep is affected by changes to Windows timer 
 // resolution since Windows 10 Version 2004 (April 2020)
 // https://randomascii.wordpress.com/2020/10/04/windows-timer-resolution-the-great-rule-change/
 //
@@ -424,12 +1033,16 @@ void spoutFrameCount::HoldFps(int fps)
 	if (fps <= 0)
 		return;
 
-	// Reduce Windows timer period to minimum
-	StartTimePeriod();
-
 	// Target frame time
 	const double target = (1000000.0/static_cast<double>(fps))/1000.0; // msec
 
+	// High resolution timer
+	if (m_bFpsTimer && HoldFpsTimer(target))
+		return;
+
+	// Reduce Windows timer period to minimum
+	StartTimePeriod();
+
 #ifdef USE_CHRONO
 
 	// Time now end point
@@ -440,6 +1053,7 @@ void spoutFrameCount::HoldFps(int fps)
 
 	// Sleep to reach the target frame time
 	if (elapsedTime < target) {
+		SpoutTrace(SPOUT_TRACE_HOLD_FPS, m_SenderName, m_FrameCount, target - elapsedTime);
 		std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(target - elapsedTime)));
 	}
 
@@ -452,8 +1066,10 @@ void spoutFrameCount::HoldFps(int fps)
 	double elapsedTime = EndTiming();
 
 	// Sleep to reach the target frame time
-	if (elapsedTime < target)
+	if (elapsedTime < target) {
+		SpoutTrace(SPOUT_TRACE_HOLD_FPS, m_SenderName, m_FrameCount, target - elapsedTime);
 		Sleep((DWORD)(target - elapsedTime));
+	}
 
 	// Set start time for the next frame
 	StartTiming();
@@ -465,6 +1081,29 @@ void spoutFrameCount::HoldFps(int fps)
 
 }
 
+// -----------------------------------------------
+// Function: EnableFpsTimer
+// Use a high resolution waitable timer for HoldFps
+// If disabled, HoldFps sleeps with timeBeginPeriod
+void spoutFrameCount::EnableFpsTimer(bool bEnable)
+{
+	m_bFpsTimer = bEnable;
+	m_FpsDeadline = 0; // Start a new deadline
+	if (!bEnable && m_hFpsTimer) {
+		CloseHandle(m_hFpsTimer);
+		m_hFpsTimer = NULL;
+	}
+}
+
+// -----------------------------------------------
+// Function: IsFpsTimerEnabled
+// High resolution timer used by HoldFps
+bool spoutFrameCount::IsFpsTimerEnabled()
+{
+	return m_bFpsTimer;
+}
+
+
 
 // -----------------------------------------------
 // Function: SetNewFrame
@@ -472,46 +1111,139 @@ void spoutFrameCount::HoldFps(int fps)
 //
 // Used by a sender for every update of the shared texture.
 // This function is called within a sender mutex lock so that
-// the receiver will not read the semaphore count while the
+// the receiver will not read the count while the
 // sender is incrementing it.
 // Used internally to set frame status if frame counting is enabled.
+//
+// The shared frame counter is incremented with an interlocked operation.
+// The semaphore count is also incremented for receivers of earlier versions
+// with a single ReleaseSemaphore. A wait before the release is not necessary.
+//
 void spoutFrameCount::SetNewFrame()
 {
+	// Dirty rectangles of this frame, independent of frame counting
+	if (m_bDirtySender)
+		WriteDirtyRects();
+
 	// Return silently if frame counting is disabled
-	if (!m_bFrameCount || m_bCountDisabled)
+	if (!m_bFrameCount || m_bCountDisabled) {
+		WriteTelemetry(SPOUT_TELEMETRY_SENDER);
 		return;
+	}
 
-	// Access the frame count semaphore
-	// Note: WaitForSingle object will always succeed because
-	// the lock count (sender frame count) is greater than zero,
-	// but must be called before ReleaseSemaphore can be called
-	// or there is an error.
-	const DWORD dwWaitResult = WaitForSingleObject(m_hCountSemaphore, 0);
-	switch (dwWaitResult) {
-		case WAIT_OBJECT_0:
-			// Release the frame counting semaphore to increase it's count.
-			// so that the receiver can retrieve the new count.
-			// Increment by 2 because WaitForSingleObject decremented it.
-			if (ReleaseSemaphore(m_hCountSemaphore, 2, NULL) == false) {
-				SpoutLogError("spoutFrameCount::SetNewFrame - ReleaseSemaphore failed");
-			}
-			else {
-				// Increment the sender frame count
-				m_FrameCount++;
-				// Update the sender fps calculations for the new frame
-				UpdateSenderFps(1);
+	// Shared frame information, created with the first frame
+	if (m_pFrameInfo || OpenFrameInfo(true)) {
+		LARGE_INTEGER now={};
+		QueryPerformanceCounter(&now);
+		m_FrameCount = m_pFrameInfo->frame + 1;
+		// The event of the following frame is reset before the counter
+		// is written, so that a receiver that reads this frame number
+		// can wait on it (WaitNewFrame)
+		const bool bEvents = (m_hFrameEvent[0] || OpenFrameEvents(true));
+		if (bEvents)
+			ResetEvent(m_hFrameEvent[(m_FrameCount+1) & 1]);
+		WriteFrameInfo(m_FrameCount, now.QuadPart);
+		if (bEvents)
+			SetEvent(m_hFrameEvent[m_FrameCount & 1]);
+		// Signal the timing fence after the copy to the shared texture
+		if (m_pTimingContext) {
+			m_PublishTime[m_FrameCount % 8] = now.QuadPart;
+			if (SUCCEEDED(m_pTimingContext->Signal(m_pTimingFence, (UINT64)m_FrameCount))) {
+				m_pTimingFence->SetEventOnCompletion((UINT64)m_FrameCount, m_hTimingEvent);
+				m_pTimingContext->Flush();
 			}
-			return;
-		case WAIT_ABANDONED:
-			SpoutLogError("SpoutFrameCount::SetNewFrame - WAIT_ABANDONED");
-			break;
-		case WAIT_FAILED:
-			SpoutLogError("SpoutFrameCount::SetNewFrame - WAIT_FAILED");
-			break;
-		default:
-			break;
+		}
+	}
+	else {
+		m_FrameCount++;
 	}
 
+	// Release the frame counting semaphore to increase its count
+	// so that the receiver can retrieve the new count.
+	if (m_hCountSemaphore && ReleaseSemaphore(m_hCountSemaphore, 1, NULL) == false)
+		SpoutLogError("spoutFrameCount::SetNewFrame - ReleaseSemaphore failed");
+
+	// Update the sender fps calculations for the new frame
+	UpdateSenderFps(1);
+
+	// Frame rate for the sender list
+	if (m_pFrameInfo)
+		m_pFrameInfo->fps = m_SenderFps;
+
+	WriteTelemetry(SPOUT_TELEMETRY_SENDER);
+
+}
+
+// -----------------------------------------------
+// Function: ResetNewFrame
+// The next GetNewFrame returns true for the current sender frame.
+//
+// Used by a receiver that has updated its copy of the sender texture
+// after the frame count was read, so that the copy is received even
+// if the sender does not produce another frame.
+//
+void spoutFrameCount::ResetNewFrame()
+{
+	m_bRepeatFrame = true;
+}
+
+// -----------------------------------------------
+// Function: SetContentHash
+// Sender content hash published with the next frame.
+//
+// Set before SetNewFrame. The hash applies to that frame only
+// and zero means that it has not been computed.
+// See spoutShaders::Hash for OpenGL senders.
+void spoutFrameCount::SetContentHash(uint64_t hash)
+{
+	m_ContentHash = hash;
+}
+
+// -----------------------------------------------
+// Function: WaitNewFrame
+// Test or wait for a new frame signalled by the sender frame event.
+//
+// For a receiver to return before anything else if the sender has not
+// produced a frame since the last one received. The sender frame counter
+// is read without a kernel call, and only a wait with a timeout uses the
+// sender frame event. The sender sets one event for odd frame numbers and
+// another for even, and resets the event of the following frame before
+// writing the frame number, so that any number of receivers can wait.
+//
+// Returns false if there is no new frame, and IsFrameNew is then false.
+// Returns true if there may be a new frame, or if the sender does not
+// signal frame events, and GetNewFrame is used as usual.
+//
+bool spoutFrameCount::WaitNewFrame(DWORD dwTimeout)
+{
+	if (!m_bFrameCount || m_bCountDisabled)
+		return true;
+
+	// The first frame and a frame to be received again
+	if (m_LastFrameCount == 0 || m_bRepeatFrame)
+		return true;
+
+	// Senders of earlier versions have no frame counter or events
+	if (!OpenFrameInfo(false))
+		return true;
+	if (!m_hFrameEvent[0] && !OpenFrameEvents(false))
+		return true;
+
+	LONG64 framecount = 0;
+	LONG64 frametime = 0;
+	if (!ReadFrameInfo(framecount, frametime) || framecount != m_LastFrameCount)
+		return true;
+
+	// Wait for the event of the following frame. The sender also sets
+	// both events when it closes. If the sender produces two frames
+	// between the test above and the wait, the wait returns with the
+	// next frame or the timeout.
+	if (dwTimeout > 0
+		&& WaitForSingleObject(m_hFrameEvent[(m_LastFrameCount+1) & 1], dwTimeout) == WAIT_OBJECT_0)
+		return true;
+
+	m_bIsNewFrame = false;
+	return false;
 }
 
 // -----------------------------------------------
@@ -531,45 +1263,60 @@ void spoutFrameCount::SetNewFrame()
 //
 bool spoutFrameCount::GetNewFrame()
 {
-	long framecount = 0;
+	LONG64 framecount = 0;
+	LONG64 frametime = 0;
 
 	// Return silently if disabled
-	if (!m_bFrameCount || m_bCountDisabled)
+	if (!m_bFrameCount || m_bCountDisabled) {
+		WriteTelemetry(SPOUT_TELEMETRY_RECEIVER);
 		return true;
+	}
 
-	// A receiver creates or opens a named semaphore when it connects to a sender
-	// Do not block if semaphore creation failed so that ReceiveTexture can still be called
-	if (!m_hCountSemaphore) {
-		return true;
+	if (OpenFrameInfo(false)) {
+		// Shared frame information created by the sender
+		// Read without a kernel call
+		if (!ReadFrameInfo(framecount, frametime))
+			return true; // do not block
 	}
+	else {
+		// A receiver creates or opens a named semaphore when it connects to a sender
+		// Do not block if semaphore creation failed so that ReceiveTexture can still be called
+		if (!m_hCountSemaphore) {
+			return true;
+		}
 
-	// Access the frame count semaphore
-	// WaitForSingleObject decrements the semaphore's count by one.
-	const DWORD dwWaitResult = WaitForSingleObject(m_hCountSemaphore, 0);
-	switch (dwWaitResult) {
-		case WAIT_OBJECT_0:
-			// Call ReleaseSemaphore with a release count of 1 to return it
-			// to what it was before the wait and record the previous count.
-			// The next time round it will either be the same count because
-			// the receiver released it, or increased because the sender
-			// released and incremented it.
-			if (ReleaseSemaphore(m_hCountSemaphore, 1, &framecount) == false) {
-				SpoutLogError("spoutFrameCount::GetNewFrame - ReleaseSemaphore failed");
-				return true; // do not block
-			}
-			break;
-		case WAIT_ABANDONED :
-			SpoutLogWarning("SpoutFrameCount::GetNewFrame - WAIT_ABANDONED");
-			break;
-		case WAIT_FAILED :
-			SpoutLogWarning("SpoutFrameCount::GetNewFrame - WAIT_FAILED");
-			break;
-		default :
-			break;
+		// Sender of an earlier version
+		// Access the frame count semaphore
+		// WaitForSingleObject decrements the semaphore's count by one.
+		long semaphorecount = 0;
+		const DWORD dwWaitResult = WaitForSingleObject(m_hCountSemaphore, 0);
+		switch (dwWaitResult) {
+			case WAIT_OBJECT_0:
+				// Call ReleaseSemaphore with a release count of 1 to return it
+				// to what it was before the wait and record the previous count.
+				// The next time round it will either be the same count because
+				// the receiver released it, or increased because the sender
+				// released and incremented it.
+				if (ReleaseSemaphore(m_hCountSemaphore, 1, &semaphorecount) == false) {
+					SpoutLogError("spoutFrameCount::GetNewFrame - ReleaseSemaphore failed");
+					return true; // do not block
+				}
+				break;
+			case WAIT_ABANDONED :
+				SpoutLogWarning("SpoutFrameCount::GetNewFrame - WAIT_ABANDONED");
+				break;
+			case WAIT_FAILED :
+				SpoutLogWarning("SpoutFrameCount::GetNewFrame - WAIT_FAILED");
+				break;
+			default :
+				break;
+		}
+		framecount = semaphorecount;
 	}
 
 	// Update the global frame count
 	m_FrameCount = framecount;
+	SpoutTrace(SPOUT_TRACE_RECEIVE_CHECK, m_SenderName, framecount);
 
 	// Set a new frame by default, but test below and set false if this frame and the last are the same.
 	m_bIsNewFrame = true;
@@ -582,9 +1329,21 @@ bool spoutFrameCount::GetNewFrame()
 	// produced a new frame and incremented the counter.
 	// Return false if this frame and the last are the same.
 	if (framecount == m_LastFrameCount) {
-		m_bIsNewFrame = false;
-		return false;
+		// Unless the frame is to be received again (ResetNewFrame).
+		// Sender fps is not updated for the same frame.
+		m_bIsNewFrame = m_bRepeatFrame;
+		m_bRepeatFrame = false;
+		UpdateFrameStats(0, false);
+		WriteTelemetry(SPOUT_TELEMETRY_RECEIVER);
+		return m_bIsNewFrame;
 	}
+	m_bRepeatFrame = false;
+
+	// Skip a frame with the same content as the last received (SetSkipUnchanged).
+	// The frame is counted for statistics and the sender frame rate as usual.
+	if (m_bSkipUnchanged && m_ContentHash != 0 && m_ContentHash == m_LastContentHash)
+		m_bIsNewFrame = false;
+	m_LastContentHash = m_ContentHash;
 
 	//
 	// Update the sender fps calculations.
@@ -592,46 +1351,170 @@ bool spoutFrameCount::GetNewFrame()
 	// The sender might have produced more than one frame if the receiver is slower.
 	// Pass the number of frames produced since the last. If m_LastFrameCount = 0, 
 	// the receiver has just started. Give it a frame to get the next frame count.
-	if(m_LastFrameCount > 0)
-		UpdateSenderFps(framecount - m_LastFrameCount);
+	// Frames missed since the last
+	LONG64 skipped = 0;
+	if (m_LastFrameCount > 0 && framecount > m_LastFrameCount+1)
+		skipped = framecount - m_LastFrameCount - 1;
+	m_MissedFrames += skipped;
+	UpdateFrameStats(skipped, true);
+	UpdateFramePacing(framecount, frametime);
+
+	// Time since the sender published the frame
+	if (frametime > 0) {
+		LARGE_INTEGER now={};
+		QueryPerformanceCounter(&now);
+		m_FrameAge = static_cast<double>(now.QuadPart - frametime)/m_CounterFrequency;
+	}
+
+	// Use the sender frame times if available.
+	if (m_LastFrameCount > 0) {
+		if (frametime > 0 && m_LastFrameTime > 0 && frametime > m_LastFrameTime)
+			UpdateSenderFps((long)(framecount - m_LastFrameCount), static_cast<double>(frametime - m_LastFrameTime)/m_CounterFrequency);
+		else
+			UpdateSenderFps((long)(framecount - m_LastFrameCount));
+	}
 
 	m_LastFrameCount = framecount;
+	m_LastFrameTime = frametime;
 
-	return true;
+	WriteTelemetry(SPOUT_TELEMETRY_RECEIVER);
+
+	return m_bIsNewFrame;
 
 }
 
 
-// -----------------------------------------------
-// Function: CleanupFrameCount
-// For class cleanup functions
-void spoutFrameCount::CleanupFrameCount()
+// Update receiver frame statistics for a receive call.
+// The current window is completed when the window time has elapsed.
+void spoutFrameCount::UpdateFrameStats(LONG64 skipped, bool bNew)
 {
-	SpoutLogNotice("SpoutFrameCount::CleanupFrameCount");
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
 
-	try {
-		// Close the frame count semaphore. If another application first
-		// opened the semaphore it will not be finally closed here.
-		if (m_hCountSemaphore) CloseHandle(m_hCountSemaphore);
-		m_hCountSemaphore = NULL;
+	if (m_WindowStart == 0)
+		m_WindowStart = now.QuadPart;
 
-		// Close the texture access mutex
-		if (m_hAccessMutex) CloseHandle(m_hAccessMutex);
-		m_hAccessMutex = NULL;
+	if (static_cast<double>(now.QuadPart - m_WindowStart)/m_CounterFrequency >= static_cast<double>(m_dwStatsWindow)) {
+		m_LastWindowStats = m_WindowStats;
+		ZeroMemory(&m_WindowStats, sizeof(m_WindowStats));
+		m_WindowStart = now.QuadPart;
+	}
 
-		// Close the sync event
+	if (!bNew) {
+		// The same frame as the last
+		m_FrameStats.repeated++;
+		m_WindowStats.repeated++;
+		return;
+	}
+
+	m_FrameStats.received++;
+	m_WindowStats.received++;
+	m_FrameStats.missed += skipped;
+	m_WindowStats.missed += skipped;
+	if (skipped > m_FrameStats.maxgap) m_FrameStats.maxgap = skipped;
+	if (skipped > m_WindowStats.maxgap) m_WindowStats.maxgap = skipped;
+
+	if (m_LastReceiveTime > 0) {
+		const double interval = static_cast<double>(now.QuadPart - m_LastReceiveTime)/m_CounterFrequency;
+		if (interval > m_FrameStats.maxinterval) m_FrameStats.maxinterval = interval;
+		if (interval > m_WindowStats.maxinterval) m_WindowStats.maxinterval = interval;
+	}
+	m_LastReceiveTime = now.QuadPart;
+}
+
+// Update the predicted sender frame interval for a new frame.
+// The sender publish time is used if known, otherwise the time received.
+void spoutFrameCount::UpdateFramePacing(LONG64 framecount, LONG64 frametime)
+{
+	if (frametime <= 0)
+		frametime = m_LastReceiveTime;
+	if (frametime <= 0)
+		return;
+
+	if (m_PaceTime > 0 && framecount > m_PaceFrame && frametime > m_PaceTime) {
+		const double frames = static_cast<double>(framecount - m_PaceFrame);
+		const double interval = static_cast<double>(frametime - m_PaceTime)/m_CounterFrequency/frames;
+		if (m_PaceInterval <= 0.0) {
+			// First interval
+			m_PaceInterval = interval;
+			m_PaceJitter = 0.0;
+		}
+		else if (interval < 4.0*m_PaceInterval) {
+			// Damping to stabilise, as for the sender fps.
+			// The interval is retained if the sender paused.
+			const double deviation = fabs(interval - m_PaceInterval);
+			m_PaceInterval = 0.95*m_PaceInterval + 0.05*interval;
+			m_PaceJitter = 0.9*m_PaceJitter + 0.1*deviation;
+		}
+	}
+
+	m_PaceFrame = framecount;
+	m_PaceTime = frametime;
+}
+
+// Reset receiver frame pacing for a new sender
+void spoutFrameCount::ResetFramePacing()
+{
+	m_PaceFrame = 0;
+	m_PaceTime = 0;
+	m_PaceInterval = 0.0;
+	m_PaceJitter = 0.0;
+}
+
+// -----------------------------------------------
+// Function: CleanupFrameCount
+// For class cleanup functions
+void spoutFrameCount::CleanupFrameCount()
+{
+	SpoutLogNotice("SpoutFrameCount::CleanupFrameCount");
+
+	try {
+		// Close the frame count semaphore. If another application first
+		// opened the semaphore it will not be finally closed here.
+		if (m_hCountSemaphore) CloseHandle(m_hCountSemaphore);
+		m_hCountSemaphore = NULL;
+
+		// Close the texture access mutex
+		if (m_hAccessMutex) CloseHandle(m_hAccessMutex);
+		m_hAccessMutex = NULL;
+
+		// Close the sync event
 		// Also closed in sender/receiver release
 		CloseFrameSync();
 
+		// Close the shared fence if open
+		CloseSharedFence();
+
+		// Close the dirty rectangle map if open
+		CloseDirtyRects();
+
+		// Close the frame slice map if open
+		CloseFrameSlices();
+
+		// Close the frame data map if open
+		CloseFrameData();
+
+		// Close the shared frame counter and frame events
+		CloseFrameInfo();
+		CloseFrameEvents();
+
+		// Release the telemetry entry
+		CloseTelemetry();
+
 		// Clear the sender name in case the same one opens again
 		m_SenderName[0] = 0;
+		m_TelemetryName[0] = 0;
 
 		// Reset counters
 		m_FrameCount = 0L;
 		m_LastFrameCount = 0L;
+		m_bRepeatFrame = false;
+		m_ContentHash = 0;
+		m_LastContentHash = 0;
 		m_FrameTimeTotal = 0.0;
 		m_FrameTimeNumber = 0.0;
 		m_SenderFps = m_SystemFps; // Default sender fps is system refresh rate
+		ResetFramePacing();
 	}
 	catch (...) {
 		SpoutLogError("SpoutFrameCount::CleanupFrameCount caused an exception");
@@ -658,17 +1541,61 @@ void spoutFrameCount::CleanupFrameCount()
 //
 bool spoutFrameCount::CheckTextureAccess(ID3D11Texture2D* D3D11texture)
 {
+	return CheckTextureAccess(D3D11texture, m_dwAccessTimeout);
+}
+
+// -----------------------------------------------
+// Function: CheckTextureAccess
+// Test for texture access with a timeout in msec.
+//
+// A short timeout allows real time threads to skip
+// the frame instead of waiting for the default 4 frames.
+//
+bool spoutFrameCount::CheckTextureAccess(ID3D11Texture2D* D3D11texture, DWORD dwTimeout)
+{
+	bool bAccess = false;
+
+	// Wait time for a trace event
+	const bool bTrace = SpoutTraceEnabled();
+	LARGE_INTEGER start={};
+	if (bTrace)
+		QueryPerformanceCounter(&start);
+
 	// Test for a keyed mutex.
 	// If no texture was passed in, the function returns false
 	if (IsKeyedMutex(D3D11texture)) {
 		// Use a keyed mutex if the DX11 texture supports it
-		return CheckKeyedAccess(D3D11texture);
+		bAccess = CheckKeyedAccess(D3D11texture, dwTimeout);
+	}
+	else if (m_pSharedFence) {
+		// The named mutex is still used unless all senders and receivers
+		// are known to use the fence (SetFenceOnly). A receiver of an earlier
+		// version, or one that could not open the fence, relies on the mutex.
+		bAccess = m_bFenceOnly ? true : CheckAccess(dwTimeout);
+		if (bAccess) {
+			// The sender publishes the value it signals after this write.
+			// The receiver queues a GPU wait and does not block. With the
+			// mutex, the value read is that of the last complete write.
+			if (m_bFenceSender)
+				BeginSharedFenceWrite();
+			else
+				WaitSharedFence();
+		}
 	}
 	else {
 		// Texture is not keyed or no texture passed in. Use the named mutex.
 		// Returns true without blocking if the mutex does not exist
-		return CheckAccess();
+		bAccess = CheckAccess(dwTimeout);
+	}
+
+	if (bTrace && bAccess) {
+		LARGE_INTEGER end={};
+		QueryPerformanceCounter(&end);
+		SpoutTrace(SPOUT_TRACE_ACCESS_ACQUIRE, m_SenderName, m_FrameCount,
+			static_cast<double>(end.QuadPart - start.QuadPart)/m_CounterFrequency);
 	}
+
+	return bAccess;
 }
 
 // -----------------------------------------------
@@ -676,12 +1603,24 @@ bool spoutFrameCount::CheckTextureAccess(ID3D11Texture2D* D3D11texture)
 // Release mutex and allow texture access
 bool spoutFrameCount::AllowTextureAccess(ID3D11Texture2D* D3D11texture)
 {
+	SpoutTrace(SPOUT_TRACE_ACCESS_RELEASE, m_SenderName, m_FrameCount);
+
 	// Test for a keyed mutex.
 	// If no texture was passed in, the function returns false
 	if (IsKeyedMutex(D3D11texture)) {
 		// Use a keyed mutex if the DX11 texture supports it
 		return(AllowKeyedAccess(D3D11texture));
 	}
+	else if (m_pSharedFence) {
+		// Shared fence. The sender signals after writing.
+		bool bRet = true;
+		if (m_bFenceSender)
+			bRet = SignalSharedFence();
+		// Release the named mutex unless the fence is the only sync
+		if (!m_bFenceOnly)
+			AllowAccess();
+		return bRet;
+	}
 	else {
 		// Texture is not keyed or no texture passed in, use the named mutex
 		// Do not block if the mutex does not exist
@@ -743,6 +1682,11 @@ bool spoutFrameCount::CreateAccessMutex(const char *SenderName)
 	// Save the handle for access
 	m_hAccessMutex = hMutex;
 
+	// Contention information if access statistics are enabled
+	strcpy_s(m_AccessName, 256, SenderName);
+	if (m_bAccessStats)
+		OpenAccessInfo();
+
 	return true;
 
 }
@@ -758,6 +1702,8 @@ void spoutFrameCount::CloseAccessMutex()
 	SpoutLogNotice("SpoutFrameCount::CloseAccessMutex");
 	if (m_hAccessMutex) CloseHandle(m_hAccessMutex);
 	m_hAccessMutex = NULL;
+	CloseAccessInfo();
+	m_AccessName[0] = 0;
 }
 
 // -----------------------------------------------
@@ -773,6 +1719,14 @@ void spoutFrameCount::CloseAccessMutex()
 // sole access and rely on the interop locks.
 //
 bool spoutFrameCount::CheckAccess()
+{
+	return CheckAccess(m_dwAccessTimeout);
+}
+
+// -----------------------------------------------
+// Function: CheckAccess
+// Test access using a named mutex with a timeout in msec
+bool spoutFrameCount::CheckAccess(DWORD dwTimeout)
 {
 	// Don't block if no mutex for Spout1 apps or if called when the sender has closed.
 	// AllowAccess also tests for a null handle before releasing the mutex.
@@ -786,7 +1740,10 @@ bool spoutFrameCount::CheckAccess()
 	// Note that NVIDIA "Threaded optimization" can cause a delay for WaitForSingleObject
 	// and can be set OFF by the NVIDIA control panel or by SpoutSettings.
 	//
-	const DWORD dwWaitResult = WaitForSingleObject(m_hAccessMutex, 67); // timeout 4 frames at 60fps
+	LONG holder = 0;
+	const LONG64 start = BeginAccessWait(holder);
+	const DWORD dwWaitResult = WaitForSingleObject(m_hAccessMutex, dwTimeout);
+	EndAccessWait(start, holder, (dwWaitResult == WAIT_OBJECT_0), (dwWaitResult == WAIT_TIMEOUT));
 	switch (dwWaitResult) {
 		case WAIT_OBJECT_0 : // 0
 			// The state of the object is signalled.
@@ -824,9 +1781,195 @@ void spoutFrameCount::AllowAccess()
 	// Release ownership of the mutex object.
 	// The caller must call ReleaseMutex once for each time that the mutex satisfied a wait.
 	// The ReleaseMutex function fails if the caller does not own the mutex object
-	if (m_hAccessMutex)
+	if (m_hAccessMutex) {
+		EndAccessHold();
 		ReleaseMutex(m_hAccessMutex);
+	}
+
+}
+
+// -----------------------------------------------
+// Function: SetAccessTimeout
+// Set the access timeout in msec for CheckTextureAccess and CheckAccess.
+// Default 67 msec, 4 frames at 60fps.
+void spoutFrameCount::SetAccessTimeout(DWORD dwTimeout)
+{
+	m_dwAccessTimeout = dwTimeout;
+}
+
+// -----------------------------------------------
+// Function: GetAccessTimeout
+// Access timeout
+DWORD spoutFrameCount::GetAccessTimeout()
+{
+	return m_dwAccessTimeout;
+}
+
+// -----------------------------------------------
+// Function: EnableAccessStats
+// Record texture access wait and hold times and contention.
+//
+//   warnmsec - log and trace a wait longer than this (0 for none)
+//
+// Applies to the sender named mutex and keyed mutex textures.
+// The process holding access and the number waiting are shared
+// in "<sendername>_SpoutAccess" by all senders and receivers
+// with statistics enabled. The statistics are also recorded
+// in the telemetry entry if telemetry is enabled.
+// Disabled by default.
+void spoutFrameCount::EnableAccessStats(bool bEnable, double warnmsec)
+{
+	m_bAccessStats = bEnable;
+	m_AccessWarnMsec = (warnmsec > 0.0) ? warnmsec : 0.0;
+	if (bEnable) {
+		if (m_AccessName[0])
+			OpenAccessInfo();
+	}
+	else {
+		CloseAccessInfo();
+		m_AccessStart = 0;
+	}
+}
+
+// -----------------------------------------------
+// Function: IsAccessStatsEnabled
+// Access statistics status
+bool spoutFrameCount::IsAccessStatsEnabled()
+{
+	return m_bAccessStats;
+}
+
+// -----------------------------------------------
+// Function: GetAccessStats
+// Texture access statistics since enabled or reset
+void spoutFrameCount::GetAccessStats(SpoutAccessStats &stats)
+{
+	stats = m_AccessStats;
+}
+
+// -----------------------------------------------
+// Function: ResetAccessStats
+// Reset access statistics
+void spoutFrameCount::ResetAccessStats()
+{
+	m_AccessStats = {};
+}
+
+// Open the contention information of the sender of the access mutex
+bool spoutFrameCount::OpenAccessInfo()
+{
+	if (m_pAccessInfo)
+		return true;
+
+	std::string mapname = m_AccessName;
+	mapname += "_SpoutAccess";
+	if (m_AccessMemory.Create(mapname.c_str(), (int)sizeof(SpoutAccessInfo)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::OpenAccessInfo - could not create [%s]", mapname.c_str());
+		return false;
+	}
+	m_pAccessInfo = reinterpret_cast<SpoutAccessInfo*>(m_AccessMemory.Buffer());
+
+	return (m_pAccessInfo != nullptr);
+}
+
+// Close the contention information
+void spoutFrameCount::CloseAccessInfo()
+{
+	// Holding access
+	if (m_pAccessInfo && m_AccessStart != 0)
+		InterlockedCompareExchange(&m_pAccessInfo->holder, 0, (LONG)GetCurrentProcessId());
+	m_pAccessInfo = nullptr;
+	m_AccessMemory.Close();
+}
+
+// Start of an access wait.
+// Returns the start time, or zero if statistics are not enabled.
+// The process holding access is returned.
+LONG64 spoutFrameCount::BeginAccessWait(LONG &holder)
+{
+	holder = 0;
+	if (!m_bAccessStats)
+		return 0;
+
+	if (m_pAccessInfo) {
+		holder = InterlockedCompareExchange(&m_pAccessInfo->holder, 0, 0);
+		const LONG waiting = InterlockedIncrement(&m_pAccessInfo->waiting);
+		if (waiting > m_AccessStats.contenders)
+			m_AccessStats.contenders = waiting;
+	}
+
+	LARGE_INTEGER start={};
+	QueryPerformanceCounter(&start);
+	return start.QuadPart;
+}
+
+// End of an access wait
+void spoutFrameCount::EndAccessWait(LONG64 start, LONG holder, bool bAccess, bool bTimeout)
+{
+	if (start == 0)
+		return;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	const double msec = static_cast<double>(now.QuadPart - start)/m_CounterFrequency;
+
+	LONG64 acquired = 0;
+	if (m_pAccessInfo) {
+		acquired = InterlockedCompareExchange64(&m_pAccessInfo->acquired, 0, 0);
+		InterlockedDecrement(&m_pAccessInfo->waiting);
+		if (bAccess) {
+			InterlockedExchange(&m_pAccessInfo->holder, (LONG)GetCurrentProcessId());
+			InterlockedExchange64(&m_pAccessInfo->acquired, now.QuadPart);
+		}
+	}
+
+	m_AccessStats.waittime += msec;
+	if (msec > m_AccessStats.maxwait)
+		m_AccessStats.maxwait = msec;
+	if (holder != 0 || msec > SPOUT_ACCESS_WAIT_MSEC) {
+		m_AccessStats.waits++;
+		if (holder != 0)
+			m_AccessStats.holder = (DWORD)holder;
+	}
+	if (bTimeout)
+		m_AccessStats.timeouts++;
+	if (bAccess) {
+		m_AccessStats.accesses++;
+		m_AccessStart = now.QuadPart;
+	}
+
+	// Wait longer than the threshold
+	if (m_AccessWarnMsec > 0.0 && msec > m_AccessWarnMsec) {
+		if (holder != 0 && acquired != 0) {
+			SpoutLogWarning("spoutFrameCount - [%s] access wait %.3f msec%s, held by process %d for %.3f msec",
+				m_AccessName, msec, bTimeout ? " (timeout)" : "", holder,
+				static_cast<double>(now.QuadPart - acquired)/m_CounterFrequency);
+		}
+		else {
+			SpoutLogWarning("spoutFrameCount - [%s] access wait %.3f msec%s",
+				m_AccessName, msec, bTimeout ? " (timeout)" : "");
+		}
+		SpoutTrace(SPOUT_TRACE_ACCESS_WAIT, m_AccessName, m_FrameCount, msec);
+	}
+}
 
+// End of access before release
+void spoutFrameCount::EndAccessHold()
+{
+	if (m_AccessStart == 0)
+		return;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	const double msec = static_cast<double>(now.QuadPart - m_AccessStart)/m_CounterFrequency;
+	m_AccessStart = 0;
+
+	m_AccessStats.holdtime += msec;
+	if (msec > m_AccessStats.maxhold)
+		m_AccessStats.maxhold = msec;
+
+	if (m_pAccessInfo)
+		InterlockedCompareExchange(&m_pAccessInfo->holder, 0, (LONG)GetCurrentProcessId());
 }
 
 // -----------------------------------------------
@@ -924,6 +2067,169 @@ bool spoutFrameCount::WaitFrameSync(const char *sendername, DWORD dwTimeout)
 
 }
 
+// -----------------------------------------------
+// Function: WaitFrameSyncUID
+// Wait or test for the sync event of a sender by ID.
+//
+// The event is opened by the first call and retained
+// while the sender ID is registered, so that the name is
+// not used for each frame. Returns true without waiting
+// if the sender has not created a sync event, and false
+// if the sender is not found.
+bool spoutFrameCount::WaitFrameSyncUID(uint64_t senderuid, DWORD dwTimeout)
+{
+	if (!m_bFrameSync)
+		return false;
+
+	// The sender has been released or is different
+	if (m_hWaitSyncEvent && (senderuid != m_WaitSyncUID || !spoutSenderNames::FindSenderUID(senderuid))) {
+		CloseHandle(m_hWaitSyncEvent);
+		m_hWaitSyncEvent = NULL;
+		m_WaitSyncUID = 0;
+	}
+
+	if (!m_hWaitSyncEvent) {
+		char sendername[256]={};
+		if (!spoutSenderNames::FindSenderUID(senderuid, sendername, 256))
+			return false;
+		char SyncEventName[256]={};
+		sprintf_s(SyncEventName, 256, "%s_Sync_Event", sendername);
+		m_hWaitSyncEvent = OpenEventA(EVENT_ALL_ACCESS, TRUE, SyncEventName);
+		// Do not block if the sender has not created a sync event
+		if (!m_hWaitSyncEvent)
+			return true;
+		m_WaitSyncUID = senderuid;
+	}
+
+	const DWORD dwWaitResult = WaitForSingleObject(m_hWaitSyncEvent, dwTimeout);
+	if (dwWaitResult == WAIT_OBJECT_0)
+		return true;
+	if (dwWaitResult == WAIT_TIMEOUT)
+		SpoutLogWarning("spoutFrameCount::WaitFrameSyncUID - WAIT_TIMEOUT");
+	else
+		SpoutLogError("spoutFrameCount::WaitFrameSyncUID - wait error (%d)", GetLastError());
+
+	return false;
+}
+
+// -----------------------------------------------
+// Function: WaitFrameSync
+// Wait or test for the sync events of a number of senders.
+//
+// Wait until any of the sync events is signalled or the timeout elapses.
+//   names      - array of sender names
+//   count      - number of names
+//   bSignalled - array of "count" flags set true for senders that signalled
+//   dwTimeout  - msec
+//
+// Returns the number of senders that signalled.
+//
+// A sender that has not created a sync event does not block
+// and is returned as signalled, the same as for a single sender.
+//
+// Events are waited in groups of MAXIMUM_WAIT_OBJECTS (64).
+// For one group, the wait is a single WaitForMultipleObjects.
+// For more than one, each group is waited in turn for 1 msec
+// until an event is signalled or the timeout elapses.
+int spoutFrameCount::WaitFrameSync(const char* const* names, int count, bool* bSignalled, DWORD dwTimeout)
+{
+	if (!names || !bSignalled || count <= 0)
+		return 0;
+
+	for (int i = 0; i < count; i++)
+		bSignalled[i] = false;
+
+	if (!m_bFrameSync)
+		return 0;
+
+	std::vector<HANDLE> events(count, NULL);
+	char SyncEventName[256]={};
+	int nSignalled = 0;
+	int nEvents = 0;
+	for (int i = 0; i < count; i++) {
+		if (!names[i] || !names[i][0])
+			continue;
+		sprintf_s(SyncEventName, 256, "%s_Sync_Event", names[i]);
+		events[i] = OpenEventA(EVENT_ALL_ACCESS, TRUE, SyncEventName);
+		if (events[i]) {
+			nEvents++;
+		}
+		else {
+			// Do not block if the sender has not created a sync event
+			bSignalled[i] = true;
+			nSignalled++;
+		}
+	}
+
+	if (nSignalled == 0 && nEvents > 0) {
+
+		// Handles to wait on and their sender index
+		std::vector<HANDLE> handles;
+		std::vector<int> index;
+		for (int i = 0; i < count; i++) {
+			if (events[i]) {
+				handles.push_back(events[i]);
+				index.push_back(i);
+			}
+		}
+
+		const int nGroups = (nEvents + MAXIMUM_WAIT_OBJECTS - 1)/MAXIMUM_WAIT_OBJECTS;
+		const ULONGLONG start = GetTickCount64();
+		int group = 0;
+		bool bWait = true;
+		int first = -1; // index of the first event signalled
+		do {
+			const int offset = group*MAXIMUM_WAIT_OBJECTS;
+			const DWORD nHandles = (DWORD)((nEvents - offset < MAXIMUM_WAIT_OBJECTS) ? nEvents - offset : MAXIMUM_WAIT_OBJECTS);
+			DWORD dwWait = dwTimeout;
+			if (nGroups > 1) {
+				// 1 msec for each group within the timeout
+				const ULONGLONG elapsed = GetTickCount64() - start;
+				dwWait = (dwTimeout == INFINITE || elapsed < dwTimeout) ? 1 : 0;
+			}
+			const DWORD dwWaitResult = WaitForMultipleObjects(nHandles, &handles[offset], FALSE, dwWait);
+			if (dwWaitResult < WAIT_OBJECT_0 + nHandles) {
+				first = offset + (int)(dwWaitResult - WAIT_OBJECT_0);
+			}
+			else if (dwWaitResult == WAIT_FAILED) {
+				SpoutLogError("spoutFrameCount::WaitFrameSync - WAIT_FAILED (%d)", GetLastError());
+				bWait = false;
+			}
+			else if (dwWaitResult >= WAIT_ABANDONED_0 && dwWaitResult < WAIT_ABANDONED_0 + nHandles) {
+				SpoutLogError("spoutFrameCount::WaitFrameSync - WAIT_ABANDONED");
+				bWait = false;
+			}
+			else if (nGroups == 1 || (dwTimeout != INFINITE && GetTickCount64() - start >= dwTimeout)) {
+				// WAIT_TIMEOUT
+				if (dwTimeout > 0)
+					SpoutLogWarning("spoutFrameCount::WaitFrameSync - WAIT_TIMEOUT");
+				bWait = false;
+			}
+			group = (group + 1) % nGroups;
+		} while (first < 0 && bWait);
+
+		if (first >= 0) {
+			// The successful wait reset the first event
+			bSignalled[index[first]] = true;
+			nSignalled++;
+			// Test the others without waiting
+			for (int i = 0; i < nEvents; i++) {
+				if (i != first && WaitForSingleObject(handles[i], 0) == WAIT_OBJECT_0) {
+					bSignalled[index[i]] = true;
+					nSignalled++;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (events[i]) CloseHandle(events[i]);
+	}
+
+	return nSignalled;
+
+}
+
 
 // -----------------------------------------------
 // Function: CloseFrameSync
@@ -935,6 +2241,11 @@ void spoutFrameCount::CloseFrameSync()
 		CloseHandle(m_hSyncEvent);
 		m_hSyncEvent = NULL;
 	}
+	if (m_hWaitSyncEvent) {
+		CloseHandle(m_hWaitSyncEvent);
+		m_hWaitSyncEvent = NULL;
+	}
+	m_WaitSyncUID = 0;
 }
 
 
@@ -958,7 +2269,7 @@ void spoutFrameCount::CloseFrameSync()
 // These functions provide equivalent results to the general mutex functions
 // for applications that produce keyed mutex textures.
 //
-bool spoutFrameCount::CheckKeyedAccess(ID3D11Texture2D* pTexture)
+bool spoutFrameCount::CheckKeyedAccess(ID3D11Texture2D* pTexture, DWORD dwTimeout)
 {
 	// 85-90 microseconds
 	if (pTexture) {
@@ -966,7 +2277,10 @@ bool spoutFrameCount::CheckKeyedAccess(ID3D11Texture2D* pTexture)
 		// Check the keyed mutex
 		pTexture->QueryInterface(__uuidof(IDXGIKeyedMutex), (void**)&pDXGIKeyedMutex); // PR#81
 		if (pDXGIKeyedMutex) {
-			const HRESULT hr = pDXGIKeyedMutex->AcquireSync(0, 67);
+			LONG holder = 0;
+			const LONG64 start = BeginAccessWait(holder);
+			const HRESULT hr = pDXGIKeyedMutex->AcquireSync(0, dwTimeout);
+			EndAccessWait(start, holder, (hr == S_OK), (hr == static_cast<HRESULT>(WAIT_TIMEOUT)));
 			switch (hr) {
 				case S_OK:
 					// Sync was acquired
@@ -1007,6 +2321,7 @@ bool spoutFrameCount::AllowKeyedAccess(ID3D11Texture2D* pTexture)
 		IDXGIKeyedMutex* pDXGIKeyedMutex = nullptr;
 		pTexture->QueryInterface(__uuidof(IDXGIKeyedMutex), (void**)&pDXGIKeyedMutex);
 		if (pDXGIKeyedMutex) {
+			EndAccessHold();
 			pDXGIKeyedMutex->ReleaseSync(0);
 			pDXGIKeyedMutex->Release();
 			return true;
@@ -1019,7 +2334,7 @@ bool spoutFrameCount::AllowKeyedAccess(ID3D11Texture2D* pTexture)
 // -----------------------------------------------
 // Calculate the sender frames per second
 // Applications before 2.007 have a frame rate dependent on the system fps
-void spoutFrameCount::UpdateSenderFps(long framecount)
+void spoutFrameCount::UpdateSenderFps(long framecount, double senderframetime)
 {
 	if (m_bCountDisabled)
 		return;
@@ -1039,6 +2354,9 @@ void spoutFrameCount::UpdateSenderFps(long framecount)
 		// Msecs between this frame and the last
 		double frametime = thisFrame - m_lastFrame;
 #endif
+		// Msecs between the sender frames if known
+		if (senderframetime > 0.0)
+			frametime = senderframetime;
 		
 		if (frametime > 1.0) { // > 1 msec
 
@@ -1088,67 +2406,396 @@ void spoutFrameCount::UpdateSenderFps(long framecount)
 
 
 // -----------------------------------------------
-// Reduce Windows timing period to the minimum
-// supported by the system (usually 1 msec)
-void spoutFrameCount::StartTimePeriod()
+// Shared frame counter "<sendername>_SpoutFrame".
+// The sender creates the map with the first frame.
+// A receiver opens it if the sender has created it, retrying at intervals,
+// and uses the semaphore count for senders of earlier versions.
+bool spoutFrameCount::OpenFrameInfo(bool bSender)
 {
-	TIMECAPS tc={};
-	m_PeriodMin = 0; // To allow for errors
-	MMRESULT mres = timeGetDevCaps(&tc, sizeof(TIMECAPS));
-	if (mres == MMSYSERR_NOERROR) {
-		mres = timeBeginPeriod(tc.wPeriodMin);
-		if (mres == TIMERR_NOERROR)
-			m_PeriodMin = tc.wPeriodMin;
+	if (!m_SenderName[0])
+		return false;
+
+	if (m_pFrameInfo)
+		return true;
+
+	std::string mapname = m_SenderName;
+	mapname += "_SpoutFrame";
+
+	if (m_FrameRetry > 0) {
+		m_FrameRetry--;
+		return false;
 	}
-}
 
+	if (bSender) {
+		if (m_FrameMemory.Create(mapname.c_str(), (int)sizeof(SpoutFrameInfo)) == SPOUT_CREATE_FAILED) {
+			SpoutLogWarning("spoutFrameCount::OpenFrameInfo - could not create [%s]", mapname.c_str());
+			m_FrameRetry = 60;
+			return false;
+		}
+	}
+	else {
+		// No warning for a sender of an earlier version
+		if (!m_FrameMemory.Open(mapname.c_str())) {
+			m_FrameRetry = 60;
+			return false;
+		}
+	}
+
+	m_pFrameInfo = reinterpret_cast<SpoutFrameInfo*>(m_FrameMemory.Buffer());
+	if (m_pFrameInfo && bSender && m_pFrameInfo->size == 0) {
+		// New map
+		m_pFrameInfo->size = (uint32_t)sizeof(SpoutFrameInfo);
+		m_pFrameInfo->version = SPOUT_FRAMEINFO_VERSION;
+	}
+	m_LastFrameTime = 0;
+	SpoutLogNotice("spoutFrameCount::OpenFrameInfo - [%s]", mapname.c_str());
+
+	return (m_pFrameInfo != nullptr);
+}
 
 // -----------------------------------------------
-// Reset Windows timing period
-void spoutFrameCount::EndTimePeriod()
+// Close the shared frame counter
+void spoutFrameCount::CloseFrameInfo()
 {
-	if (m_PeriodMin > 0) {
-		timeEndPeriod(m_PeriodMin);
-		m_PeriodMin = 0;
-	}
+	// The timing callback writes to the map
+	CloseFrameTiming();
+	m_FrameMemory.Close();
+	m_pFrameInfo = nullptr;
+	m_LastFrameTime = 0;
+	m_FrameRetry = 0;
+	m_FrameAge = 0.0;
+	m_FrameCopyTime = 0.0;
+	m_MissedFrames = 0;
 }
 
-
 // -----------------------------------------------
-//
-// Enable sync event
-//
-//   Create a named event that can be used to signal
-//   from one application to another.
-//
-//   If used for frame sychronisation, the event name is 
-//   derived from the sender name and is closed when a sender
-//   closes or receiver releases connection.
-//   A sender name must be established by the sender or receiver.
-//   Only effective between one sender / receiver pair.
-//
-//   This function is used by the first call to SetFrameSync.
-void spoutFrameCount::OpenFrameSync(const char* SenderName)
+// Frame events "<sendername>_SpoutFrameEvent0" and "1".
+// The sender creates them with the shared frame counter.
+// A receiver opens them if the sender has created them, retrying at intervals.
+bool spoutFrameCount::OpenFrameEvents(bool bSender)
 {
-	// A sender name is required
-	if (!SenderName || !*SenderName) {
-		SpoutLogWarning("spoutFrameCount::OpenFrameSync - no sender name");
-		return;
-	}
+	if (!m_SenderName[0])
+		return false;
 
-	// Return if already enabled for this sender
-	if (m_hSyncEvent && strcmp(SenderName, m_SenderName) == 0) {
-		return;
-	}
+	if (m_hFrameEvent[0])
+		return true;
 
-	// Close any existing event for a new sender
-	if (m_hSyncEvent) {
-		CloseHandle(m_hSyncEvent);
-		m_hSyncEvent = NULL;
+	if (m_FrameEventRetry > 0) {
+		m_FrameEventRetry--;
+		return false;
 	}
 
-	// Set the new name for subsequent checks
-	strcpy_s(m_SenderName, 256, SenderName);
+	char eventname[256]={};
+	for (int i = 0; i < 2; i++) {
+		sprintf_s(eventname, 256, "%s_SpoutFrameEvent%d", m_SenderName, i);
+		if (bSender)
+			m_hFrameEvent[i] = CreateEventA(NULL, TRUE, FALSE, eventname); // manual reset
+		else
+			m_hFrameEvent[i] = OpenEventA(SYNCHRONIZE, FALSE, eventname);
+		if (!m_hFrameEvent[i]) {
+			// No warning for a receiver of a sender of an earlier version
+			if (bSender)
+				SpoutLogWarning("spoutFrameCount::OpenFrameEvents - could not create [%s]", eventname);
+			if (i > 0) {
+				CloseHandle(m_hFrameEvent[0]);
+				m_hFrameEvent[0] = NULL;
+			}
+			m_FrameEventRetry = 60;
+			return false;
+		}
+	}
+	m_bFrameEventSender = bSender;
+
+	return true;
+}
+
+// -----------------------------------------------
+// Close the frame events.
+// A sender sets both so that waiting receivers find that it has closed.
+void spoutFrameCount::CloseFrameEvents()
+{
+	for (int i = 0; i < 2; i++) {
+		if (m_hFrameEvent[i]) {
+			if (m_bFrameEventSender)
+				SetEvent(m_hFrameEvent[i]);
+			CloseHandle(m_hFrameEvent[i]);
+			m_hFrameEvent[i] = NULL;
+		}
+	}
+	m_bFrameEventSender = false;
+	m_FrameEventRetry = 0;
+}
+
+// -----------------------------------------------
+// Sender write the sequence number and publish time of a frame
+void spoutFrameCount::WriteFrameInfo(LONG64 framecount, LONG64 frametime)
+{
+	const bool bHash = (m_pFrameInfo->size >= offsetof(SpoutFrameInfo, hash)+sizeof(uint64_t));
+	InterlockedIncrement(&m_pFrameInfo->lock); // odd while writing
+	m_pFrameInfo->time  = frametime;
+	m_pFrameInfo->frame = framecount;
+	if (bHash) {
+		// The hash applies to this frame only
+		m_pFrameInfo->hash = m_ContentHash;
+		m_pFrameInfo->hashframe = (m_ContentHash != 0) ? framecount : 0;
+	}
+	InterlockedIncrement(&m_pFrameInfo->lock);
+	m_ContentHash = 0;
+}
+
+// -----------------------------------------------
+// Receiver read the sequence number, publish time and content hash
+// of the last frame and the GPU copy time if the sender records it.
+// Returns false if the sender was writing and the values were not consistent.
+bool spoutFrameCount::ReadFrameInfo(LONG64 &framecount, LONG64 &frametime)
+{
+	// Senders of earlier versions have no content hash
+	const bool bHash = (m_pFrameInfo->size >= offsetof(SpoutFrameInfo, hash)+sizeof(uint64_t));
+	LONG64 hashframe = 0;
+	uint64_t hash = 0;
+	for (int i = 0; i < 4; i++) {
+		const LONG lock = InterlockedCompareExchange(&m_pFrameInfo->lock, 0, 0);
+		if ((lock & 1) == 0) {
+			framecount = m_pFrameInfo->frame;
+			frametime  = m_pFrameInfo->time;
+			if (bHash) {
+				hashframe = m_pFrameInfo->hashframe;
+				hash = m_pFrameInfo->hash;
+			}
+			if (InterlockedCompareExchange(&m_pFrameInfo->lock, 0, 0) == lock)
+				break;
+		}
+		if (i == 3)
+			return false;
+		YieldProcessor();
+	}
+	m_ContentHash = (hashframe != 0 && hashframe == framecount) ? hash : 0;
+
+	// Copy time is extra information, no retry
+	if (m_pFrameInfo->size >= offsetof(SpoutFrameInfo, copyticks)+sizeof(LONG64)) {
+		const LONG lock = InterlockedCompareExchange(&m_pFrameInfo->copylock, 0, 0);
+		if ((lock & 1) == 0) {
+			const LONG64 copyticks = m_pFrameInfo->copyticks;
+			if (InterlockedCompareExchange(&m_pFrameInfo->copylock, 0, 0) == lock && copyticks > 0)
+				m_FrameCopyTime = static_cast<double>(copyticks)/m_CounterFrequency;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------
+// HoldFps wait for the frame deadline
+// The deadline is a performance counter value advanced
+// by the frame time for each call. The timer waits until
+// SPOUT_HOLD_SPIN_MSEC before the deadline and the remaining
+// time is taken by spinning on the counter.
+// If the frame has taken longer than the target time, the
+// deadline is reset without waiting.
+// Returns false if the timer cannot be created.
+bool spoutFrameCount::HoldFpsTimer(double target)
+{
+	if (!m_hFpsTimer) {
+		m_hFpsTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if (!m_hFpsTimer) {
+			// Not supported before Windows 10 1803
+			SpoutLogWarning("spoutFrameCount::HoldFps - high resolution timer not available (%d)", GetLastError());
+			m_bFpsTimer = false;
+			return false;
+		}
+		m_FpsDeadline = 0;
+	}
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	const LONG64 period = static_cast<LONG64>(target*m_CounterFrequency);
+
+	// First frame or the last frame was later than the deadline
+	if (m_FpsDeadline == 0 || now.QuadPart >= m_FpsDeadline + period) {
+		m_FpsDeadline = now.QuadPart;
+		return true;
+	}
+
+	// Deadline for this frame
+	m_FpsDeadline += period;
+
+	SpoutTrace(SPOUT_TRACE_HOLD_FPS, m_SenderName, m_FrameCount,
+		static_cast<double>(m_FpsDeadline - now.QuadPart)/m_CounterFrequency);
+
+	WaitDeadline(m_FpsDeadline);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Receiver wait until a performance counter value "wait" msec ahead
+// with the pacing timer and spin for the final msec.
+void spoutFrameCount::WaitPaceDeadline(LONG64 deadline, double wait)
+{
+	if (!m_hPaceTimer)
+		m_hPaceTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	if (wait > SPOUT_HOLD_SPIN_MSEC) {
+		wait -= SPOUT_HOLD_SPIN_MSEC;
+		LARGE_INTEGER due={};
+		due.QuadPart = -static_cast<LONGLONG>(wait*10000.0); // 100 nsec relative
+		if (m_hPaceTimer && SetWaitableTimer(m_hPaceTimer, &due, 0, NULL, NULL, FALSE))
+			WaitForSingleObject(m_hPaceTimer, INFINITE);
+		else
+			Sleep(static_cast<DWORD>(wait));
+	}
+
+	// Spin for the remaining time
+	LARGE_INTEGER now={};
+	do {
+		YieldProcessor();
+		QueryPerformanceCounter(&now);
+	} while (now.QuadPart < deadline);
+}
+
+// Vertical blank timing thread
+DWORD WINAPI spoutFrameCount::VBlankThread(LPVOID lpParameter)
+{
+	spoutFrameCount* pFrame = static_cast<spoutFrameCount*>(lpParameter);
+	HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_FRAME);
+	pFrame->VBlankLoop();
+	EndSpoutThread(SPOUT_THREAD_FRAME, hTask);
+	return 0;
+}
+
+// Wait for each vertical blank and record the time and period.
+// The period is averaged and intervals of missed or extra vertical
+// blanks are not used unless the refresh rate has changed.
+void spoutFrameCount::VBlankLoop()
+{
+	LONG64 last = 0;
+	LONG64 period = 0;
+	int outliers = 0;
+	while (WaitForSingleObject(m_hVBlankStop, 0) == WAIT_TIMEOUT) {
+		if (FAILED(m_pVBlankOutput->WaitForVBlank())) {
+			// Output off or removed
+			last = 0;
+			Sleep(16);
+			continue;
+		}
+		LARGE_INTEGER now={};
+		QueryPerformanceCounter(&now);
+		if (last != 0) {
+			const LONG64 counts = now.QuadPart - last;
+			if (period == 0 || outliers > 8) {
+				period = counts;
+				outliers = 0;
+			}
+			else if (counts > period/2 && counts < period*3/2) {
+				period += (counts - period)/8;
+				outliers = 0;
+			}
+			else {
+				outliers++;
+			}
+			InterlockedExchange64(&m_VBlankPeriod, period);
+		}
+		InterlockedExchange64(&m_VBlankTime, now.QuadPart);
+		last = now.QuadPart;
+	}
+}
+
+// -----------------------------------------------
+// Wait until a performance counter value.
+// The timer waits until SPOUT_HOLD_SPIN_MSEC before
+// the deadline and the remaining time is taken by spinning.
+// Sleep is used if the high resolution timer is not available.
+void spoutFrameCount::WaitDeadline(LONG64 deadline)
+{
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	const double remaining = static_cast<double>(deadline - now.QuadPart)/m_CounterFrequency; // msec
+
+	// Timer wait until the spin time before the deadline
+	if (remaining > SPOUT_HOLD_SPIN_MSEC) {
+		if (!m_hFpsTimer && m_bFpsTimer)
+			m_hFpsTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		LARGE_INTEGER due={};
+		due.QuadPart = -static_cast<LONGLONG>((remaining - SPOUT_HOLD_SPIN_MSEC)*10000.0); // 100 nsec relative
+		if (m_hFpsTimer && SetWaitableTimer(m_hFpsTimer, &due, 0, NULL, NULL, FALSE)) {
+			WaitForSingleObject(m_hFpsTimer, INFINITE);
+		}
+		else {
+			StartTimePeriod();
+			Sleep(static_cast<DWORD>(remaining - SPOUT_HOLD_SPIN_MSEC));
+			EndTimePeriod();
+		}
+	}
+
+	// Spin for the remaining time
+	do {
+		YieldProcessor();
+		QueryPerformanceCounter(&now);
+	} while (now.QuadPart < deadline);
+}
+
+// -----------------------------------------------
+// Reduce Windows timing period to the minimum
+// supported by the system (usually 1 msec)
+void spoutFrameCount::StartTimePeriod()
+{
+	TIMECAPS tc={};
+	m_PeriodMin = 0; // To allow for errors
+	MMRESULT mres = timeGetDevCaps(&tc, sizeof(TIMECAPS));
+	if (mres == MMSYSERR_NOERROR) {
+		mres = timeBeginPeriod(tc.wPeriodMin);
+		if (mres == TIMERR_NOERROR)
+			m_PeriodMin = tc.wPeriodMin;
+	}
+}
+
+
+// -----------------------------------------------
+// Reset Windows timing period
+void spoutFrameCount::EndTimePeriod()
+{
+	if (m_PeriodMin > 0) {
+		timeEndPeriod(m_PeriodMin);
+		m_PeriodMin = 0;
+	}
+}
+
+
+// -----------------------------------------------
+//
+// Enable sync event
+//
+//   Create a named event that can be used to signal
+//   from one application to another.
+//
+//   If used for frame sychronisation, the event name is 
+//   derived from the sender name and is closed when a sender
+//   closes or receiver releases connection.
+//   A sender name must be established by the sender or receiver.
+//   Only effective between one sender / receiver pair.
+//
+//   This function is used by the first call to SetFrameSync.
+void spoutFrameCount::OpenFrameSync(const char* SenderName)
+{
+	// A sender name is required
+	if (!SenderName || !*SenderName) {
+		SpoutLogWarning("spoutFrameCount::OpenFrameSync - no sender name");
+		return;
+	}
+
+	// Return if already enabled for this sender
+	if (m_hSyncEvent && strcmp(SenderName, m_SenderName) == 0) {
+		return;
+	}
+
+	// Close any existing event for a new sender
+	if (m_hSyncEvent) {
+		CloseHandle(m_hSyncEvent);
+		m_hSyncEvent = NULL;
+	}
+
+	// Set the new name for subsequent checks
+	strcpy_s(m_SenderName, 256, SenderName);
 
 	//
 	// Create or open an event with this sender name
@@ -1200,6 +2847,1953 @@ bool spoutFrameCount::IsFrameSyncEnabled()
 }
 
 
+//
+// Group: Shared fence
+//
+//   An optional addition to the texture access mutex using ID3D11Fence.
+//   Requires Windows 10 Creators Update and ID3D11Device5 for both sender and receiver.
+//
+//   The sender creates a shared fence and saves the NT handle, process ID 
+//   and the last value signalled in a shared memory map "<sendername>_SpoutFence".
+//   After writing to the shared texture the sender signals the fence on the GPU.
+//   The receiver queues a GPU wait for that value before copying from the shared texture.
+//   The fence itself does not block a CPU thread.
+//
+//   The fence only orders the receiver after the sender. The sender publishes the
+//   value it will signal before each write, so that a receiver which reads during
+//   the write waits for it to complete. The fence does not prevent the sender
+//   starting a write while a receiver reads, so it should be used where tearing 
+//   is acceptable or the sender writes to more than one texture.
+//
+//   The option must be enabled by both sender and receiver before the sender is created
+//   or the receiver connects. If the sender has not created a fence, the receiver uses
+//   the access mutex as before.
+//
+//   The named access mutex is still taken with the fence, because receivers of an
+//   earlier version or that could not open the fence rely on it. If all senders and
+//   receivers of the application are known to use the fence, SetFenceOnly removes
+//   the mutex so that neither sender nor receiver blocks a CPU thread.
+//
+
+// -----------------------------------------------
+// Function: EnableFenceSync
+// Enable / disable shared fence synchronisation
+void spoutFrameCount::EnableFenceSync(bool bFence)
+{
+	m_bFenceSync = bFence;
+	if (!m_bFenceSync)
+		CloseSharedFence();
+}
+
+// -----------------------------------------------
+// Function: IsFenceSyncEnabled
+// Check for shared fence option
+bool spoutFrameCount::IsFenceSyncEnabled()
+{
+	return m_bFenceSync;
+}
+
+// -----------------------------------------------
+// Function: SetFenceOnly
+// Use the shared fence without the named access mutex.
+//
+// Only for applications where all senders and receivers use the fence.
+// A receiver that does not use the fence could then read the texture
+// while the sender is writing to it. Disabled by default.
+void spoutFrameCount::SetFenceOnly(bool bFenceOnly)
+{
+	m_bFenceOnly = bFenceOnly;
+}
+
+// -----------------------------------------------
+// Function: IsFenceOnly
+// Shared fence used without the named access mutex
+bool spoutFrameCount::IsFenceOnly()
+{
+	return m_bFenceOnly;
+}
+
+// -----------------------------------------------
+// Function: IsSharedFence
+// Is a shared fence open
+bool spoutFrameCount::IsSharedFence()
+{
+	return (m_pSharedFence != nullptr);
+}
+
+// -----------------------------------------------
+// Function: CreateSharedFence
+// Sender create a shared fence and shared memory for the fence information
+bool spoutFrameCount::CreateSharedFence(const char* SenderName, ID3D11Device* pDevice)
+{
+	if (!m_bFenceSync || !SenderName || !*SenderName || !pDevice)
+		return false;
+
+	CloseSharedFence();
+
+	ID3D11Device5* pDevice5 = nullptr;
+	ID3D11DeviceContext* pContext = nullptr;
+	HRESULT hr = pDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutFrameCount::CreateSharedFence - ID3D11Device5 not available");
+		return false;
+	}
+
+	hr = pDevice5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pSharedFence));
+	pDevice5->Release();
+	if (SUCCEEDED(hr))
+		hr = m_pSharedFence->CreateSharedHandle(NULL, GENERIC_ALL, NULL, &m_hSharedFence);
+	if (SUCCEEDED(hr)) {
+		pDevice->GetImmediateContext(&pContext);
+		hr = pContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pFenceContext));
+		pContext->Release();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutFrameCount::CreateSharedFence - could not create fence (0x%.7X)", (unsigned int)hr);
+		CloseSharedFence();
+		return false;
+	}
+
+	// Fence information map
+	std::string mapname = SenderName;
+	mapname += "_SpoutFence";
+	if (m_FenceMemory.Create(mapname.c_str(), (int)sizeof(SpoutFenceInfo)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::CreateSharedFence - could not create fence map");
+		CloseSharedFence();
+		return false;
+	}
+
+	char* pBuf = m_FenceMemory.Lock();
+	if (!pBuf) {
+		CloseSharedFence();
+		return false;
+	}
+	SpoutFenceInfo* pInfo = reinterpret_cast<SpoutFenceInfo*>(pBuf);
+	pInfo->processId = GetCurrentProcessId();
+	pInfo->reserved = 0;
+	pInfo->fenceHandle = (uint64_t)(ULONG_PTR)m_hSharedFence;
+	pInfo->fenceValue = 0;
+	m_FenceMemory.Unlock();
+
+	m_FenceValue = 0;
+	m_bFenceSender = true;
+
+	SpoutLogNotice("spoutFrameCount::CreateSharedFence - [%s] handle 0x%.7X", mapname.c_str(), PtrToUint(m_hSharedFence));
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: OpenSharedFence
+// Receiver open the sender's shared fence
+bool spoutFrameCount::OpenSharedFence(const char* SenderName, ID3D11Device* pDevice)
+{
+	if (!m_bFenceSync || !SenderName || !*SenderName || !pDevice)
+		return false;
+
+	CloseSharedFence();
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutFence";
+	// Do not warn if the sender has not created a fence
+	if (!m_FenceMemory.Open(mapname.c_str()))
+		return false;
+
+	SpoutFenceInfo info = {};
+	char* pBuf = m_FenceMemory.Lock();
+	if (pBuf) {
+		memcpy(&info, pBuf, sizeof(SpoutFenceInfo));
+		m_FenceMemory.Unlock();
+	}
+	if (info.processId == 0 || info.fenceHandle == 0) {
+		m_FenceMemory.Close();
+		return false;
+	}
+
+	// Duplicate the sender's NT handle into this process
+	HANDLE hFence = NULL;
+	HANDLE hProcess = OpenProcess(PROCESS_DUP_HANDLE, FALSE, info.processId);
+	if (hProcess) {
+		DuplicateHandle(hProcess, (HANDLE)(ULONG_PTR)info.fenceHandle,
+			GetCurrentProcess(), &hFence, 0, FALSE, DUPLICATE_SAME_ACCESS);
+		CloseHandle(hProcess);
+	}
+	if (!hFence) {
+		SpoutLogWarning("spoutFrameCount::OpenSharedFence - could not duplicate fence handle (%lu)", GetLastError());
+		m_FenceMemory.Close();
+		return false;
+	}
+
+	ID3D11Device5* pDevice5 = nullptr;
+	ID3D11DeviceContext* pContext = nullptr;
+	HRESULT hr = pDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (SUCCEEDED(hr)) {
+		hr = pDevice5->OpenSharedFence(hFence, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pSharedFence));
+		pDevice5->Release();
+	}
+	// The device has its own reference after OpenSharedFence
+	CloseHandle(hFence);
+	if (SUCCEEDED(hr)) {
+		pDevice->GetImmediateContext(&pContext);
+		hr = pContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pFenceContext));
+		pContext->Release();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutFrameCount::OpenSharedFence - could not open fence (0x%.7X)", (unsigned int)hr);
+		CloseSharedFence();
+		return false;
+	}
+
+	m_bFenceSender = false;
+
+	SpoutLogNotice("spoutFrameCount::OpenSharedFence - [%s]", mapname.c_str());
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: CloseSharedFence
+// Close the shared fence and fence information map
+void spoutFrameCount::CloseSharedFence()
+{
+	if (m_pFenceContext) m_pFenceContext->Release();
+	m_pFenceContext = nullptr;
+	if (m_pSharedFence) m_pSharedFence->Release();
+	m_pSharedFence = nullptr;
+	if (m_hSharedFence) CloseHandle(m_hSharedFence);
+	m_hSharedFence = NULL;
+	m_FenceMemory.Close();
+	m_FenceValue = 0;
+	m_bFenceSender = false;
+}
+
+// -----------------------------------------------
+// Function: SignalSharedFence
+// Sender signal the fence on the GPU after writing to the shared texture
+// and save the value for receivers
+bool spoutFrameCount::SignalSharedFence()
+{
+	if (!m_pSharedFence || !m_pFenceContext || !m_bFenceSender)
+		return false;
+
+	m_FenceValue++;
+	if (FAILED(m_pFenceContext->Signal(m_pSharedFence, m_FenceValue)))
+		return false;
+	m_pFenceContext->Flush();
+
+	// Aligned 64 bit write without the map mutex
+	char* pBuf = m_FenceMemory.Buffer();
+	if (pBuf) {
+		SpoutFenceInfo* pInfo = reinterpret_cast<SpoutFenceInfo*>(pBuf);
+		InterlockedExchange64(&pInfo->fenceValue, (LONG64)m_FenceValue);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: BeginSharedFenceWrite
+// Sender publish the value it will signal after writing to the shared texture.
+// A receiver that reads the texture during the write waits for that value.
+bool spoutFrameCount::BeginSharedFenceWrite()
+{
+	if (!m_pSharedFence || !m_bFenceSender)
+		return false;
+
+	char* pBuf = m_FenceMemory.Buffer();
+	if (!pBuf)
+		return false;
+
+	SpoutFenceInfo* pInfo = reinterpret_cast<SpoutFenceInfo*>(pBuf);
+	InterlockedExchange64(&pInfo->writeValue, (LONG64)(m_FenceValue + 1));
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: WaitSharedFence
+// Receiver queue a GPU wait for the last value signalled by the sender,
+// or the value the sender will signal after a write in progress.
+// Commands submitted after this wait until the sender's GPU work completes.
+bool spoutFrameCount::WaitSharedFence()
+{
+	if (!m_pSharedFence || !m_pFenceContext || m_bFenceSender)
+		return false;
+
+	char* pBuf = m_FenceMemory.Buffer();
+	if (!pBuf)
+		return false;
+
+	// The sender sets the write value before writing and the
+	// fence value after signalling, so the larger is the last
+	// complete write or the one in progress. The write value
+	// is zero for a sender of an earlier version.
+	SpoutFenceInfo* pInfo = reinterpret_cast<SpoutFenceInfo*>(pBuf);
+	const UINT64 signalled = (UINT64)InterlockedCompareExchange64(&pInfo->fenceValue, 0, 0);
+	const UINT64 writing = (UINT64)InterlockedCompareExchange64(&pInfo->writeValue, 0, 0);
+	const UINT64 value = (writing > signalled) ? writing : signalled;
+	if (value == 0)
+		return true; // Nothing signalled yet
+
+	return SUCCEEDED(m_pFenceContext->Wait(m_pSharedFence, value));
+}
+
+
+//
+// Group: Frame timing
+//
+//   A sender can record when the GPU has completed the copy of each frame
+//   to the shared texture. SetNewFrame signals a fence with the frame sequence
+//   number after the copy. A thread pool wait on the fence completion event
+//   writes the completion time to the frame information map, so the sender
+//   thread does not wait. Requires ID3D11Device5 (Windows 10 Creators Update).
+//
+//   Receivers read the time with GetFrameCopyTime. GetFrameAge and
+//   GetMissedFrames do not need the option.
+//
+
+// -----------------------------------------------
+// Function: EnableFrameTiming
+// Enable / disable sender GPU copy completion timing
+void spoutFrameCount::EnableFrameTiming(bool bTiming)
+{
+	m_bFrameTiming = bTiming;
+	if (!m_bFrameTiming)
+		CloseFrameTiming();
+}
+
+// -----------------------------------------------
+// Function: IsFrameTimingEnabled
+// Check for frame timing option
+bool spoutFrameCount::IsFrameTimingEnabled()
+{
+	return m_bFrameTiming;
+}
+
+// -----------------------------------------------
+// Function: CreateFrameTiming
+// Sender create a fence to time GPU copy completion
+bool spoutFrameCount::CreateFrameTiming(ID3D11Device* pDevice)
+{
+	if (!m_bFrameTiming || !pDevice)
+		return false;
+
+	CloseFrameTiming();
+
+	ID3D11Device5* pDevice5 = nullptr;
+	ID3D11DeviceContext* pContext = nullptr;
+	HRESULT hr = pDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutFrameCount::CreateFrameTiming - ID3D11Device5 not available");
+		return false;
+	}
+	hr = pDevice5->CreateFence(0, D3D11_FENCE_FLAG_NONE, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pTimingFence));
+	pDevice5->Release();
+	if (SUCCEEDED(hr)) {
+		pDevice->GetImmediateContext(&pContext);
+		hr = pContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pTimingContext));
+		pContext->Release();
+	}
+	if (SUCCEEDED(hr)) {
+		// Auto reset event and a persistent thread pool wait
+		m_hTimingEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (!m_hTimingEvent
+			|| !RegisterWaitForSingleObject(&m_hTimingWait, m_hTimingEvent, TimingCallback, this, INFINITE, WT_EXECUTEDEFAULT))
+			hr = E_FAIL;
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutFrameCount::CreateFrameTiming - could not create fence (0x%.7X)", (unsigned int)hr);
+		CloseFrameTiming();
+		return false;
+	}
+
+	SpoutLogNotice("spoutFrameCount::CreateFrameTiming");
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: CloseFrameTiming
+// Close frame timing
+void spoutFrameCount::CloseFrameTiming()
+{
+	// Wait for a callback in progress
+	if (m_hTimingWait) UnregisterWaitEx(m_hTimingWait, INVALID_HANDLE_VALUE);
+	m_hTimingWait = NULL;
+	if (m_hTimingEvent) CloseHandle(m_hTimingEvent);
+	m_hTimingEvent = NULL;
+	if (m_pTimingContext) m_pTimingContext->Release();
+	m_pTimingContext = nullptr;
+	if (m_pTimingFence) m_pTimingFence->Release();
+	m_pTimingFence = nullptr;
+	ZeroMemory(m_PublishTime, sizeof(m_PublishTime));
+}
+
+// Thread pool callback when the timing fence reaches a frame value
+VOID CALLBACK spoutFrameCount::TimingCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired)
+{
+	UNREFERENCED_PARAMETER(TimerOrWaitFired);
+	spoutFrameCount* pFrame = static_cast<spoutFrameCount*>(lpParameter);
+	if (pFrame)
+		pFrame->WriteCopyTime();
+}
+
+// Write the GPU copy completion time of the last frame completed
+void spoutFrameCount::WriteCopyTime()
+{
+	if (!m_pTimingFence || !m_pFrameInfo)
+		return;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+	const LONG64 copyframe = (LONG64)m_pTimingFence->GetCompletedValue();
+	const LONG64 publish = m_PublishTime[copyframe % 8];
+	if (copyframe == 0 || publish == 0 || now.QuadPart < publish)
+		return;
+
+	InterlockedIncrement(&m_pFrameInfo->copylock); // odd while writing
+	m_pFrameInfo->copyframe = copyframe;
+	m_pFrameInfo->copyticks = now.QuadPart - publish;
+	InterlockedIncrement(&m_pFrameInfo->copylock);
+}
+
+
+//
+// Group: Dirty rectangles
+//
+//   A sender that changes only part of the texture can publish the changed
+//   regions of each frame in a shared memory map "<sendername>_SpoutDirty".
+//   The rectangles are written by SetNewFrame while the texture access lock is held
+//   so that a receiver reading them with the same lock sees the matching texture.
+//
+//   Once the map is created, every frame is published. Frames sent without
+//   rectangles are recorded as a change of the whole texture.
+//
+//   A receiver keeps the rectangles of the last few frames. If a frame is missed
+//   or the whole texture changed, the history is reset and the receiver must
+//   copy the whole texture until each of its staging textures has been updated.
+//
+
+// -----------------------------------------------
+// Function: SetDirtyRects
+// Sender set the changed regions of the next frame.
+// The map is created with the first call.
+// More than SPOUT_MAX_DIRTY_RECTS rectangles are merged to one.
+// Null rectangles or zero count sends the whole texture.
+bool spoutFrameCount::SetDirtyRects(const char* SenderName, const RECT* pRects, unsigned int nRects)
+{
+	if (!SenderName || !*SenderName)
+		return false;
+
+	if (!m_bDirtySender) {
+		// Nothing to do until a sender first sets rectangles
+		if (!pRects || nRects == 0)
+			return true;
+		std::string mapname = SenderName;
+		mapname += "_SpoutDirty";
+		if (m_DirtyMemory.Create(mapname.c_str(), (int)sizeof(SpoutDirtyRects)) == SPOUT_CREATE_FAILED) {
+			SpoutLogWarning("spoutFrameCount::SetDirtyRects - could not create map");
+			return false;
+		}
+		m_bDirtySender = true;
+		m_DirtyFrame = 0;
+		SpoutLogNotice("spoutFrameCount::SetDirtyRects - [%s]", mapname.c_str());
+	}
+
+	m_nDirtyPending = 0;
+	if (!pRects || nRects == 0)
+		return true;
+
+	if (nRects <= SPOUT_MAX_DIRTY_RECTS) {
+		memcpy(m_DirtyPending, pRects, nRects*sizeof(RECT));
+		m_nDirtyPending = nRects;
+	}
+	else {
+		// Bounding rectangle
+		RECT bounds = pRects[0];
+		for (unsigned int i = 1; i < nRects; i++) {
+			if (pRects[i].left   < bounds.left)   bounds.left   = pRects[i].left;
+			if (pRects[i].top    < bounds.top)    bounds.top    = pRects[i].top;
+			if (pRects[i].right  > bounds.right)  bounds.right  = pRects[i].right;
+			if (pRects[i].bottom > bounds.bottom) bounds.bottom = pRects[i].bottom;
+		}
+		m_DirtyPending[0] = bounds;
+		m_nDirtyPending = 1;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: ReadDirtyRects
+// Receiver read the changed regions of the frame received.
+// Call within the texture access lock after GetNewFrame.
+// Returns false if the whole texture has to be copied.
+bool spoutFrameCount::ReadDirtyRects(const char* SenderName)
+{
+	if (!OpenDirtyRects(SenderName)) {
+		m_DirtyFrames = 0;
+		return false;
+	}
+
+	SpoutDirtyRects dirty={};
+	char* pBuf = m_DirtyMemory.Lock();
+	if (!pBuf) {
+		m_DirtyFrames = 0;
+		return false;
+	}
+	memcpy(&dirty, pBuf, sizeof(SpoutDirtyRects));
+	m_DirtyMemory.Unlock();
+
+	const unsigned int index = (m_DirtyHead + 1) % SPOUT_DIRTY_HISTORY;
+	if (m_DirtyFrame > 0 && dirty.frame == m_DirtyFrame) {
+		// The same frame received again
+		m_nDirtyHistory[index] = 0;
+	}
+	else if (m_DirtyFrame > 0 && dirty.frame == m_DirtyFrame+1
+		&& dirty.count > 0 && dirty.count <= SPOUT_MAX_DIRTY_RECTS) {
+		memcpy(m_DirtyHistory[index], dirty.rects, dirty.count*sizeof(RECT));
+		m_nDirtyHistory[index] = dirty.count;
+	}
+	else {
+		// Missed frame or whole texture
+		m_DirtyFrame = dirty.frame;
+		m_DirtyFrames = 0;
+		return false;
+	}
+
+	m_DirtyHead = index;
+	m_DirtyFrame = dirty.frame;
+	if (m_DirtyFrames < SPOUT_DIRTY_HISTORY)
+		m_DirtyFrames++;
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: GetDirtyFrames
+// Number of consecutive frames received with known changed regions.
+// A receiver copying to a ring of N staging textures can copy only
+// the changed regions if this is at least N.
+unsigned int spoutFrameCount::GetDirtyFrames()
+{
+	return m_DirtyFrames;
+}
+
+// -----------------------------------------------
+// Function: GetDirtyRects
+// Changed regions of a frame received "age" frames ago (0 for the last).
+// The count is zero if nothing changed.
+bool spoutFrameCount::GetDirtyRects(unsigned int age, const RECT** ppRects, unsigned int &nRects)
+{
+	if (!ppRects || age >= m_DirtyFrames)
+		return false;
+
+	const unsigned int index = (m_DirtyHead + SPOUT_DIRTY_HISTORY - age) % SPOUT_DIRTY_HISTORY;
+	*ppRects = m_DirtyHistory[index];
+	nRects = m_nDirtyHistory[index];
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: ResetDirtyRects
+// Receiver copy the whole texture for the following frames.
+// For example when staging textures are re-created.
+void spoutFrameCount::ResetDirtyRects()
+{
+	m_DirtyFrames = 0;
+	m_DirtyFrame = 0;
+}
+
+// -----------------------------------------------
+// Function: CloseDirtyRects
+// Close the dirty rectangle map
+void spoutFrameCount::CloseDirtyRects()
+{
+	m_DirtyMemory.Close();
+	m_bDirtySender = false;
+	m_DirtyFrame = 0;
+	m_DirtyRetry = 0;
+	m_nDirtyPending = 0;
+	m_DirtyFrames = 0;
+}
+
+// Receiver open the dirty rectangle map of the sender.
+// The sender creates the map when it first sets rectangles,
+// so retry at intervals while it is not found.
+bool spoutFrameCount::OpenDirtyRects(const char* SenderName)
+{
+	if (!SenderName || !*SenderName || m_bDirtySender)
+		return false;
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutDirty";
+	if (m_DirtyMemory.Buffer()) {
+		if (m_DirtyMemory.Name() && strcmp(m_DirtyMemory.Name(), mapname.c_str()) == 0)
+			return true;
+		// Different sender
+		CloseDirtyRects();
+	}
+
+	if (m_DirtyRetry > 0) {
+		m_DirtyRetry--;
+		return false;
+	}
+
+	// No warning if the sender does not publish rectangles
+	if (!m_DirtyMemory.Open(mapname.c_str())) {
+		m_DirtyRetry = 60;
+		return false;
+	}
+	m_DirtyFrame = 0;
+	m_DirtyFrames = 0;
+
+	SpoutLogNotice("spoutFrameCount::OpenDirtyRects - [%s]", mapname.c_str());
+
+	return true;
+}
+
+// Sender write the pending rectangles for a new frame.
+// Called by SetNewFrame within the texture access lock.
+void spoutFrameCount::WriteDirtyRects()
+{
+	char* pBuf = m_DirtyMemory.Lock();
+	if (!pBuf)
+		return;
+
+	SpoutDirtyRects* pDirty = reinterpret_cast<SpoutDirtyRects*>(pBuf);
+	m_DirtyFrame++;
+	pDirty->frame = m_DirtyFrame;
+	pDirty->count = m_nDirtyPending;
+	if (m_nDirtyPending > 0)
+		memcpy(pDirty->rects, m_DirtyPending, m_nDirtyPending*sizeof(RECT));
+	m_DirtyMemory.Unlock();
+
+	// The whole texture for the next frame unless rectangles are set again
+	m_nDirtyPending = 0;
+}
+
+
+//
+// Group: Frame slices
+//
+//   For very low latency, a sender can copy a frame to the shared texture
+//   in horizontal slices and publish each slice as soon as it is copied
+//   (spoutDX::SetSendSlices). Receivers copy each slice when it is published
+//   instead of waiting for the whole frame.
+//
+//   Slice i is the rows from i*height/count to (i+1)*height/count.
+//   The sender signals the shared fence after each slice and saves the fence
+//   value and the frame number for the slice in a shared memory map
+//   "<sendername>_SpoutSlices". A receiver waits for the slice frame number
+//   to advance and queues a GPU wait for the fence value before the copy.
+//   A slice receiver does not use the texture access mutex, so shared
+//   fence synchronisation must be enabled by both (EnableFenceSync).
+//   The sender takes the mutex while each slice is written for receivers
+//   without the fence, unless the fence is the only sync (SetFenceOnly).
+//
+
+// -----------------------------------------------
+// Function: CreateFrameSlices
+// Sender create the slice map for the number of slices of each frame.
+// Requires the shared fence (CreateSharedFence).
+bool spoutFrameCount::CreateFrameSlices(const char* SenderName, unsigned int nSlices)
+{
+	if (!SenderName || !*SenderName || nSlices < 2 || nSlices > SPOUT_MAX_SLICES)
+		return false;
+
+	if (!m_pSharedFence || !m_bFenceSender)
+		return false;
+
+	if (!m_bSliceSender) {
+		std::string mapname = SenderName;
+		mapname += "_SpoutSlices";
+		if (m_SliceMemory.Create(mapname.c_str(), (int)sizeof(SpoutFrameSlices)) == SPOUT_CREATE_FAILED) {
+			SpoutLogWarning("spoutFrameCount::CreateFrameSlices - could not create map");
+			return false;
+		}
+		m_bSliceSender = true;
+		// Continue the frame numbers of an existing map
+		SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+		m_SliceFrame = pSlices->frame;
+		SpoutLogNotice("spoutFrameCount::CreateFrameSlices - [%s] %d slices", mapname.c_str(), nSlices);
+	}
+
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (!pSlices)
+		return false;
+	if (pSlices->count != nSlices)
+		InterlockedExchange((volatile LONG*)&pSlices->count, (LONG)nSlices);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: BeginFrameSlices
+// Sender begin the slices of a new frame.
+// Returns the frame number of the slices.
+LONG64 spoutFrameCount::BeginFrameSlices()
+{
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (!m_bSliceSender || !pSlices)
+		return 0;
+
+	m_SliceFrame++;
+	InterlockedExchange64(&pSlices->frame, m_SliceFrame);
+
+	return m_SliceFrame;
+}
+
+// -----------------------------------------------
+// Function: SignalFrameSlice
+// Sender publish a slice after the copy to the shared texture.
+// The fence is signalled and the command queue flushed.
+bool spoutFrameCount::SignalFrameSlice(unsigned int slice)
+{
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (!m_bSliceSender || !pSlices || slice >= pSlices->count)
+		return false;
+
+	if (!SignalSharedFence())
+		return false;
+
+	// The fence value before the frame number.
+	// A receiver that reads the frame number waits for at least this value.
+	InterlockedExchange64(&pSlices->fence[slice], (LONG64)m_FenceValue);
+	InterlockedExchange64(&pSlices->sequence[slice], m_SliceFrame);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: OpenFrameSlices
+// Receiver open the slice map of the sender.
+// Returns false if the sender does not send slices
+// or the receiver has not opened the shared fence.
+bool spoutFrameCount::OpenFrameSlices(const char* SenderName)
+{
+	if (!SenderName || !*SenderName || m_bSliceSender)
+		return false;
+
+	if (!m_pSharedFence || m_bFenceSender)
+		return false;
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutSlices";
+	if (m_SliceMemory.Buffer()) {
+		if (m_SliceMemory.Name() && strcmp(m_SliceMemory.Name(), mapname.c_str()) == 0)
+			return true;
+		// Different sender
+		CloseFrameSlices();
+	}
+
+	if (m_SliceRetry > 0) {
+		m_SliceRetry--;
+		return false;
+	}
+
+	// No warning if the sender does not send slices
+	if (!m_SliceMemory.Open(mapname.c_str())) {
+		m_SliceRetry = 60;
+		return false;
+	}
+
+	SpoutLogNotice("spoutFrameCount::OpenFrameSlices - [%s]", mapname.c_str());
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: GetFrameSlices
+// Number of slices of each frame, 0 if the sender does not send slices
+unsigned int spoutFrameCount::GetFrameSlices()
+{
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (!pSlices)
+		return 0;
+
+	const unsigned int count = pSlices->count;
+	return (count <= SPOUT_MAX_SLICES) ? count : 0;
+}
+
+// -----------------------------------------------
+// Function: WaitFrameSlice
+// Receiver wait for a slice with a frame number of at least "minframe".
+//
+//   Returns the frame number of the slice and queues a GPU wait for the
+//   slice fence value. Commands submitted after this wait until the
+//   sender's copy of the slice is complete. The CPU waits up to the
+//   timeout (0 to return at once) for the slice frame number to advance.
+bool spoutFrameCount::WaitFrameSlice(unsigned int slice, LONG64 minframe, LONG64 &sliceframe, DWORD dwTimeout)
+{
+	sliceframe = 0;
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (!pSlices || m_bSliceSender || slice >= SPOUT_MAX_SLICES)
+		return false;
+
+	if (!m_pSharedFence || !m_pFenceContext || m_bFenceSender)
+		return false;
+
+	LARGE_INTEGER start={};
+	QueryPerformanceCounter(&start);
+	for (;;) {
+		sliceframe = InterlockedCompareExchange64(&pSlices->sequence[slice], 0, 0);
+		if (sliceframe >= minframe && sliceframe > 0)
+			break;
+		LARGE_INTEGER now={};
+		QueryPerformanceCounter(&now);
+		if (static_cast<double>(now.QuadPart - start.QuadPart)/m_CounterFrequency >= (double)dwTimeout)
+			return false;
+		YieldProcessor();
+	}
+
+	// A later copy of the slice has a higher fence value,
+	// so the value read after the frame number is at least that of the frame.
+	const UINT64 value = (UINT64)InterlockedCompareExchange64(&pSlices->fence[slice], 0, 0);
+	if (value == 0)
+		return false;
+
+	return SUCCEEDED(m_pFenceContext->Wait(m_pSharedFence, value));
+}
+
+// -----------------------------------------------
+// Function: CloseFrameSlices
+// Close the slice map.
+// Receivers of a sender that closes the map return to whole frames.
+void spoutFrameCount::CloseFrameSlices()
+{
+	SpoutFrameSlices* pSlices = reinterpret_cast<SpoutFrameSlices*>(m_SliceMemory.Buffer());
+	if (m_bSliceSender && pSlices)
+		InterlockedExchange((volatile LONG*)&pSlices->count, 0);
+	m_SliceMemory.Close();
+	m_bSliceSender = false;
+	m_SliceFrame = 0;
+	m_SliceRetry = 0;
+}
+
+
+//
+// Group: Frame data
+//
+//   A sender can publish data with its frames, for example tracking or
+//   timecode, in a shared memory map "<sendername>_SpoutData".
+//
+//   Each write is saved to the next of SPOUT_FRAMEDATA_SLOTS slots and
+//   tagged with the number of the frame that it is sent with.
+//   A receiver finds the data of the frame it has received, or of any
+//   recent frame, without waiting for the sender. The sender does not
+//   wait for receivers. A slot over-written while it is read is detected
+//   by the slot lock count and the data is not returned.
+//
+//   Frame numbers are those of the shared frame counter, so frame counting
+//   must be enabled for data to be matched to frames.
+//
+
+// -----------------------------------------------
+// Function: CreateFrameData
+// Sender create the frame data map for a maximum data length.
+// Optional. The map is created by the first WriteFrameData
+// for the length written, or at least 4096 bytes, if it does not exist.
+bool spoutFrameCount::CreateFrameData(const char* SenderName, unsigned int maxlength)
+{
+	if (!SenderName || !*SenderName || maxlength == 0)
+		return false;
+
+	if (m_bDataSender)
+		return true;
+
+	// Multiple of 16 bytes for each slot
+	const unsigned int capacity = (maxlength + 15) & ~15u;
+	const uint64_t mapsize = sizeof(SpoutFrameData) + (uint64_t)capacity * SPOUT_FRAMEDATA_SLOTS;
+	if (mapsize > 0x7FFFFFFF) {
+		SpoutLogWarning("spoutFrameCount::CreateFrameData - %u bytes too large", maxlength);
+		return false;
+	}
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutData";
+	const SpoutCreateResult result = m_DataMemory.Create(mapname.c_str(), (int)mapsize);
+	if (result == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::CreateFrameData - could not create map");
+		return false;
+	}
+
+	SpoutFrameData* pData = reinterpret_cast<SpoutFrameData*>(m_DataMemory.Buffer());
+	if (result == SPOUT_ALREADY_EXISTS && pData->capacity != 0 && pData->capacity < capacity) {
+		// Opened by a receiver with the size of a previous sender
+		SpoutLogWarning("spoutFrameCount::CreateFrameData - existing map of %u bytes", pData->capacity);
+		m_DataMemory.Close();
+		return false;
+	}
+
+	// Mapping objects are initially zeros
+	if (pData->capacity == 0) {
+		pData->size = (uint32_t)sizeof(SpoutFrameData);
+		pData->version = SPOUT_FRAMEDATA_VERSION;
+		pData->capacity = capacity;
+		pData->slots = SPOUT_FRAMEDATA_SLOTS;
+	}
+	m_bDataSender = true;
+
+	SpoutLogNotice("spoutFrameCount::CreateFrameData - [%s] %u bytes", mapname.c_str(), pData->capacity);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: WriteFrameData
+// Sender write data sent with the next frame.
+// More than one write for a frame replaces the data for that frame.
+bool spoutFrameCount::WriteFrameData(const char* SenderName, const char* data, unsigned int length)
+{
+	if (!data || length == 0)
+		return false;
+
+	if (!m_bDataSender && !CreateFrameData(SenderName, (length > 4096) ? length : 4096))
+		return false;
+
+	SpoutFrameData* pData = reinterpret_cast<SpoutFrameData*>(m_DataMemory.Buffer());
+	if (!pData)
+		return false;
+
+	if (length > pData->capacity) {
+		SpoutLogWarning("spoutFrameCount::WriteFrameData - %u bytes exceeds %u", length, pData->capacity);
+		return false;
+	}
+
+	// The frame number that SetNewFrame will send
+	const LONG64 framenumber = (m_pFrameInfo ? m_pFrameInfo->frame : m_FrameCount) + 1;
+
+	const unsigned int index = (unsigned int)(pData->writes % SPOUT_FRAMEDATA_SLOTS);
+	SpoutFrameDataSlot* pSlot = &pData->slot[index];
+	char* pSlotData = reinterpret_cast<char*>(pData + 1) + (uint64_t)index * pData->capacity;
+
+	// Odd lock count while the slot is written
+	InterlockedIncrement64(&pSlot->lock);
+	pSlot->frame = framenumber;
+	pSlot->length = length;
+	memcpy(pSlotData, data, length);
+	InterlockedIncrement64(&pSlot->lock);
+	InterlockedIncrement64(&pData->writes);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: ReadFrameData
+// Receiver read the data sent with a frame.
+//
+// framenumber - sender frame number (GetSenderFrame64)
+//               0 for the frame last received
+//
+// Returns the number of bytes copied, limited to maxlength, or zero
+// if there is no data for the frame or it has been over-written.
+int spoutFrameCount::ReadFrameData(const char* SenderName, char* data, unsigned int maxlength, LONG64 framenumber)
+{
+	if (!data || maxlength == 0 || !OpenFrameData(SenderName))
+		return 0;
+
+	SpoutFrameData* pData = reinterpret_cast<SpoutFrameData*>(m_DataMemory.Buffer());
+	if (!pData || pData->capacity == 0)
+		return 0;
+
+	if (framenumber == 0)
+		framenumber = m_FrameCount;
+
+	// From the latest write back
+	const LONG64 writes = InterlockedCompareExchange64(&pData->writes, 0, 0);
+	for (int i = 0; i < SPOUT_FRAMEDATA_SLOTS && i < writes; i++) {
+		const unsigned int index = (unsigned int)((writes - 1 - i) % SPOUT_FRAMEDATA_SLOTS);
+		SpoutFrameDataSlot* pSlot = &pData->slot[index];
+		const LONG64 lock = InterlockedCompareExchange64(&pSlot->lock, 0, 0);
+		if (lock & 1)
+			continue; // Being written
+		if (pSlot->frame != framenumber)
+			continue;
+		unsigned int length = pSlot->length;
+		if (length > pData->capacity) length = pData->capacity;
+		if (length > maxlength) length = maxlength;
+		memcpy(data, reinterpret_cast<const char*>(pData + 1) + (uint64_t)index * pData->capacity, length);
+		MemoryBarrier();
+		// Over-written while it was copied
+		if (InterlockedCompareExchange64(&pSlot->lock, 0, 0) != lock)
+			return 0;
+		return (int)length;
+	}
+
+	return 0;
+}
+
+// -----------------------------------------------
+// Function: CloseFrameData
+// Close the frame data map
+void spoutFrameCount::CloseFrameData()
+{
+	m_DataMemory.Close();
+	m_bDataSender = false;
+	m_DataRetry = 0;
+}
+
+// Receiver open the frame data map of the sender.
+// Retry at intervals while it is not found.
+bool spoutFrameCount::OpenFrameData(const char* SenderName)
+{
+	if (!SenderName || !*SenderName || m_bDataSender)
+		return false;
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutData";
+	if (m_DataMemory.Buffer()) {
+		if (m_DataMemory.Name() && strcmp(m_DataMemory.Name(), mapname.c_str()) == 0)
+			return true;
+		// Different sender
+		CloseFrameData();
+	}
+
+	if (m_DataRetry > 0) {
+		m_DataRetry--;
+		return false;
+	}
+
+	// No warning if the sender does not publish data
+	if (!m_DataMemory.Open(mapname.c_str())) {
+		m_DataRetry = 60;
+		return false;
+	}
+
+	SpoutLogNotice("spoutFrameCount::OpenFrameData - [%s]", mapname.c_str());
+
+	return true;
+}
+
+//
+// Group: Telemetry
+//
+// Senders and receivers with telemetry enabled record the sender name,
+// frame number, fps, missed frames, GPU copy time and share mode
+// in an entry of the system wide shared memory map "SpoutTelemetry".
+// The entry is updated with every frame by SetNewFrame or GetNewFrame
+// without locks or kernel calls. An application such as a dashboard can
+// sample all entries at any time with ReadTelemetry without affecting
+// the senders and receivers.
+//
+// Telemetry is enabled globally by the registry "Telemetry" value
+// (SetTelemetry) or for an application by EnableTelemetry.
+//
+
+// -----------------------------------------------
+// Function: SetTelemetry
+// Enable or disable telemetry globally by registry setting
+void spoutFrameCount::SetTelemetry(bool bEnable)
+{
+	WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Telemetry", bEnable ? 1 : 0);
+	EnableTelemetry(bEnable);
+}
+
+// -----------------------------------------------
+// Function: EnableTelemetry
+// Enable or disable telemetry for this application
+void spoutFrameCount::EnableTelemetry(bool bEnable)
+{
+	m_bTelemetry = bEnable;
+	if (!m_bTelemetry)
+		CloseTelemetry();
+}
+
+// -----------------------------------------------
+// Function: IsTelemetryEnabled
+// Is telemetry enabled
+bool spoutFrameCount::IsTelemetryEnabled()
+{
+	return m_bTelemetry;
+}
+
+// -----------------------------------------------
+// Function: SetTelemetryMode
+// Share mode recorded with telemetry.
+//  0 - texture, 1 - memory, 2 - CPU
+void spoutFrameCount::SetTelemetryMode(int sharemode)
+{
+	m_TelemetryMode = sharemode;
+}
+
+// -----------------------------------------------
+// Function: SetTelemetryMemory
+// Memory held by the sender or receiver recorded with telemetry.
+// See spoutGL::GetMemoryUsage and spoutDX::GetMemoryUsage.
+void spoutFrameCount::SetTelemetryMemory(uint64_t bytes)
+{
+	m_TelemetryMemoryBytes = bytes;
+}
+
+// -----------------------------------------------
+// Function: ReadTelemetry
+// Copy the telemetry of all running senders and receivers.
+//
+// Entries of processes that have closed without releasing them are skipped.
+// For a sample rate of once a second or so, the cost to the senders
+// and receivers is only that of the entry update.
+// Returns the number of entries copied.
+int spoutFrameCount::ReadTelemetry(SpoutTelemetryEntry* pEntries, int maxentries)
+{
+	if (!pEntries || maxentries <= 0)
+		return 0;
+
+	// Open the map if this is not a sender or receiver that has created it
+	if (!m_TelemetryMemory.Buffer()) {
+		if (!m_TelemetryMemory.Open("SpoutTelemetry"))
+			return 0; // No sender or receiver with telemetry enabled
+	}
+
+	const SpoutTelemetry* pTelemetry = reinterpret_cast<const SpoutTelemetry*>(m_TelemetryMemory.Buffer());
+	if (!pTelemetry || pTelemetry->version != SPOUT_TELEMETRY_VERSION)
+		return 0;
+
+	int count = 0;
+	for (int i = 0; i < SPOUT_TELEMETRY_ENTRIES && count < maxentries; i++) {
+		const SpoutTelemetryEntry* pEntry = &pTelemetry->entry[i];
+		const LONG owner = pEntry->owner;
+		if (owner == 0 || !IsProcessRunning((DWORD)owner))
+			continue;
+		// Copy the entry unless it is being written, with a few retries
+		for (int retry = 0; retry < 4; retry++) {
+			const LONG lock = pEntry->lock;
+			if (lock & 1) {
+				YieldProcessor();
+				continue;
+			}
+			MemoryBarrier();
+			memcpy(&pEntries[count], (const void*)pEntry, sizeof(SpoutTelemetryEntry));
+			MemoryBarrier();
+			if (pEntry->lock == lock && pEntries[count].name[0]) {
+				pEntries[count].name[255] = 0;
+				count++;
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+
+// Claim a telemetry entry for this sender or receiver.
+// Retry at intervals if the map could not be created or all entries are used.
+bool spoutFrameCount::OpenTelemetry()
+{
+	if (m_pTelemetry)
+		return true;
+
+	if (m_TelemetryRetry > 0) {
+		m_TelemetryRetry--;
+		return false;
+	}
+	m_TelemetryRetry = 600;
+
+	if (!m_TelemetryMemory.Buffer()) {
+		if (m_TelemetryMemory.Create("SpoutTelemetry", sizeof(SpoutTelemetry)) == SPOUT_CREATE_FAILED) {
+			SpoutLogWarning("spoutFrameCount::OpenTelemetry - could not create map");
+			return false;
+		}
+	}
+
+	SpoutTelemetry* pTelemetry = reinterpret_cast<SpoutTelemetry*>(m_TelemetryMemory.Buffer());
+	if (!pTelemetry)
+		return false;
+
+	// A map of an earlier version has smaller entries
+	if (pTelemetry->version != 0 && pTelemetry->version != SPOUT_TELEMETRY_VERSION) {
+		SpoutLogWarning("spoutFrameCount::OpenTelemetry - version %u map in use", pTelemetry->version);
+		m_TelemetryMemory.Close();
+		return false;
+	}
+
+	// The same values are written by all processes
+	pTelemetry->size = (uint32_t)sizeof(SpoutTelemetry);
+	pTelemetry->entries = SPOUT_TELEMETRY_ENTRIES;
+	pTelemetry->entrysize = (uint32_t)sizeof(SpoutTelemetryEntry);
+	pTelemetry->version = SPOUT_TELEMETRY_VERSION;
+
+	const LONG processId = (LONG)GetCurrentProcessId();
+
+	// A free entry
+	for (int i = 0; i < SPOUT_TELEMETRY_ENTRIES; i++) {
+		if (InterlockedCompareExchange(&pTelemetry->entry[i].owner, processId, 0) == 0) {
+			m_pTelemetry = &pTelemetry->entry[i];
+			break;
+		}
+	}
+
+	// Or an entry of a process that closed without releasing it
+	if (!m_pTelemetry) {
+		for (int i = 0; i < SPOUT_TELEMETRY_ENTRIES; i++) {
+			const LONG owner = pTelemetry->entry[i].owner;
+			if (owner != 0 && owner != processId && !IsProcessRunning((DWORD)owner)
+				&& InterlockedCompareExchange(&pTelemetry->entry[i].owner, processId, owner) == owner) {
+				m_pTelemetry = &pTelemetry->entry[i];
+				break;
+			}
+		}
+	}
+
+	if (!m_pTelemetry) {
+		SpoutLogWarning("spoutFrameCount::OpenTelemetry - no free entry");
+		return false;
+	}
+
+	m_TelemetryRetry = 0;
+
+	SpoutLogNotice("spoutFrameCount::OpenTelemetry - entry %d", (int)(m_pTelemetry - pTelemetry->entry));
+
+	return true;
+}
+
+// Update the telemetry entry
+void spoutFrameCount::WriteTelemetry(uint32_t role)
+{
+	if (!m_bTelemetry || !m_TelemetryName[0])
+		return;
+
+	if (!m_pTelemetry && !OpenTelemetry())
+		return;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	InterlockedIncrement(&m_pTelemetry->lock); // odd while written
+	m_pTelemetry->role = role;
+	m_pTelemetry->sharemode = (uint32_t)m_TelemetryMode;
+	m_pTelemetry->time = now.QuadPart;
+	m_pTelemetry->frame = m_FrameCount;
+	m_pTelemetry->missed = m_MissedFrames;
+	m_pTelemetry->fps = m_SenderFps;
+	m_pTelemetry->copytime = m_FrameCopyTime;
+	m_pTelemetry->memory = m_TelemetryMemoryBytes;
+	if (strcmp(m_pTelemetry->name, m_TelemetryName) != 0)
+		strcpy_s(m_pTelemetry->name, 256, m_TelemetryName);
+	m_pTelemetry->accesses = m_AccessStats.accesses;
+	m_pTelemetry->waits = m_AccessStats.waits;
+	m_pTelemetry->timeouts = m_AccessStats.timeouts;
+	m_pTelemetry->waittime = m_AccessStats.waittime;
+	m_pTelemetry->maxwait = m_AccessStats.maxwait;
+	m_pTelemetry->holdtime = m_AccessStats.holdtime;
+	m_pTelemetry->maxhold = m_AccessStats.maxhold;
+	m_pTelemetry->contenders = (uint32_t)m_AccessStats.contenders;
+	m_pTelemetry->holder = (uint32_t)m_AccessStats.holder;
+	InterlockedIncrement(&m_pTelemetry->lock);
+}
+
+// Release the telemetry entry
+void spoutFrameCount::CloseTelemetry()
+{
+	if (m_pTelemetry) {
+		InterlockedIncrement(&m_pTelemetry->lock);
+		m_pTelemetry->name[0] = 0;
+		InterlockedIncrement(&m_pTelemetry->lock);
+		InterlockedExchange(&m_pTelemetry->owner, 0);
+		m_pTelemetry = nullptr;
+	}
+	m_TelemetryMemory.Close();
+	m_TelemetryRetry = 0;
+}
+
+// Is a process still running
+bool spoutFrameCount::IsProcessRunning(DWORD dwProcessId)
+{
+	HANDLE hProcess = OpenProcess(SYNCHRONIZE, FALSE, dwProcessId);
+	if (!hProcess) {
+		// A process of another user can exist without access
+		return (GetLastError() == ERROR_ACCESS_DENIED);
+	}
+	const bool bRunning = (WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT);
+	CloseHandle(hProcess);
+	return bRunning;
+}
+
+
+//
+// Group: Frame clock
+//
+// Senders in separate processes, for example one for each output of
+// a media server, each pace their frames independently and drift
+// relative to each other. A frame clock locks them together.
+//
+// A timing master creates the clock "<clockname>_SpoutClock" and
+// publishes the number and time of each tick with TickFrameClock,
+// after its own frame wait, for example following Present or HoldFps.
+// Senders open the clock and call WaitFrameClock in place of HoldFps.
+// The next tick time is predicted from the last tick published and
+// the period, and the wait is the same as HoldFps. The tick number
+// returned identifies the content frame, so that all outputs present
+// the same frame in the same refresh interval.
+//
+// If the master stops, senders continue with the last tick and period
+// and remain locked to each other.
+//
+
+// -----------------------------------------------
+// Function: CreateFrameClock
+// Timing master create a frame clock.
+//
+// The frame rate sets the tick period. If not specified, the
+// system refresh rate is used. Fails if the clock has a running master.
+bool spoutFrameCount::CreateFrameClock(const char* clockname, double fps)
+{
+	if (!clockname || !*clockname)
+		return false;
+
+	CloseFrameClock();
+
+	if (fps <= 0.0)
+		fps = m_SystemFps;
+	if (fps <= 0.0)
+		fps = 60.0;
+
+	std::string mapname = clockname;
+	mapname += "_SpoutClock";
+
+	if (m_ClockMemory.Create(mapname.c_str(), (int)sizeof(SpoutFrameClock)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::CreateFrameClock - could not create [%s]", mapname.c_str());
+		return false;
+	}
+	m_pClock = reinterpret_cast<SpoutFrameClock*>(m_ClockMemory.Buffer());
+	if (!m_pClock) {
+		m_ClockMemory.Close();
+		return false;
+	}
+
+	// One master for each clock
+	const LONG processId = (LONG)GetCurrentProcessId();
+	const LONG owner = InterlockedCompareExchange(&m_pClock->master, processId, 0);
+	if (owner != 0 && owner != processId) {
+		if (IsProcessRunning((DWORD)owner)
+			|| InterlockedCompareExchange(&m_pClock->master, processId, owner) != owner) {
+			SpoutLogWarning("spoutFrameCount::CreateFrameClock - [%s] has a timing master", mapname.c_str());
+			m_pClock = nullptr;
+			m_ClockMemory.Close();
+			return false;
+		}
+	}
+
+	InterlockedIncrement(&m_pClock->lock);
+	m_pClock->size = (uint32_t)sizeof(SpoutFrameClock);
+	m_pClock->version = SPOUT_CLOCK_VERSION;
+	m_pClock->period = static_cast<LONG64>(m_CounterFrequency*1000.0/fps);
+	InterlockedIncrement(&m_pClock->lock);
+
+	m_bClockMaster = true;
+	m_ClockTick = m_pClock->tick;
+
+	SpoutLogNotice("spoutFrameCount::CreateFrameClock - [%s] %.2f fps", mapname.c_str(), fps);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: TickFrameClock
+// Timing master publish a tick of the frame clock.
+//
+// Call once for each frame at the time that senders should lock to.
+// Returns the tick number, or zero if this is not the timing master.
+LONG64 spoutFrameCount::TickFrameClock()
+{
+	if (!m_pClock || !m_bClockMaster)
+		return 0;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	m_ClockTick++;
+	InterlockedIncrement(&m_pClock->lock); // odd while writing
+	m_pClock->time = now.QuadPart;
+	m_pClock->tick = m_ClockTick;
+	InterlockedIncrement(&m_pClock->lock);
+
+	return m_ClockTick;
+}
+
+// -----------------------------------------------
+// Function: OpenFrameClock
+// Open the frame clock of a timing master.
+//
+// Fails if the master has not created the clock.
+bool spoutFrameCount::OpenFrameClock(const char* clockname)
+{
+	if (!clockname || !*clockname)
+		return false;
+
+	CloseFrameClock();
+
+	std::string mapname = clockname;
+	mapname += "_SpoutClock";
+
+	if (!m_ClockMemory.Open(mapname.c_str()))
+		return false;
+
+	m_pClock = reinterpret_cast<SpoutFrameClock*>(m_ClockMemory.Buffer());
+	if (!m_pClock || m_pClock->version != SPOUT_CLOCK_VERSION) {
+		SpoutLogWarning("spoutFrameCount::OpenFrameClock - [%s] is not a frame clock", mapname.c_str());
+		m_pClock = nullptr;
+		m_ClockMemory.Close();
+		return false;
+	}
+	m_bClockMaster = false;
+	m_ClockTick = 0;
+
+	SpoutLogNotice("spoutFrameCount::OpenFrameClock - [%s]", mapname.c_str());
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: WaitFrameClock
+// Wait for the next tick of the frame clock.
+//
+// Used by a sender in place of HoldFps, before sending a frame.
+// The next tick is predicted from the last tick published by the
+// master and the period. A tick is not returned twice, so a sender
+// that takes longer than the period skips to the following tick.
+// Returns the tick number for the frame, or zero if there is no clock
+// or the master has not published a tick.
+LONG64 spoutFrameCount::WaitFrameClock()
+{
+	if (!m_pClock)
+		return 0;
+
+	LONG64 tick = 0;
+	LONG64 time = 0;
+	LONG64 period = 0;
+	if (!ReadFrameClock(tick, time, period) || tick == 0 || period <= 0)
+		return 0;
+
+	LARGE_INTEGER now={};
+	QueryPerformanceCounter(&now);
+
+	// The first tick after now
+	LONG64 next = tick;
+	if (now.QuadPart >= time)
+		next += (now.QuadPart - time)/period + 1;
+	// and after the last one waited for
+	if (next <= m_ClockTick)
+		next = m_ClockTick + 1;
+
+	WaitDeadline(time + (next - tick)*period);
+	m_ClockTick = next;
+
+	return next;
+}
+
+// -----------------------------------------------
+// Function: GetFrameClockTick
+// Number of the last tick published by the timing master
+LONG64 spoutFrameCount::GetFrameClockTick()
+{
+	LONG64 tick = 0;
+	LONG64 time = 0;
+	LONG64 period = 0;
+	if (!m_pClock || !ReadFrameClock(tick, time, period))
+		return 0;
+	return tick;
+}
+
+// -----------------------------------------------
+// Function: CloseFrameClock
+// Close the frame clock.
+//
+// The timing master releases the clock for another master.
+void spoutFrameCount::CloseFrameClock()
+{
+	if (m_pClock && m_bClockMaster)
+		InterlockedCompareExchange(&m_pClock->master, 0, (LONG)GetCurrentProcessId());
+	m_ClockMemory.Close();
+	m_pClock = nullptr;
+	m_bClockMaster = false;
+	m_ClockTick = 0;
+}
+
+// Read the last tick, time and period consistently
+bool spoutFrameCount::ReadFrameClock(LONG64 &tick, LONG64 &time, LONG64 &period)
+{
+	for (int i = 0; i < 4; i++) {
+		const LONG lock = InterlockedCompareExchange(&m_pClock->lock, 0, 0);
+		if ((lock & 1) == 0) {
+			tick = m_pClock->tick;
+			time = m_pClock->time;
+			period = m_pClock->period;
+			if (InterlockedCompareExchange(&m_pClock->lock, 0, 0) == lock)
+				return true;
+		}
+		YieldProcessor();
+	}
+	return false;
+}
+
+
+//
+// Group: Frame acknowledgement
+//
+// A sender that must not drop frames, such as an offline render,
+// can wait until all receivers have used each frame before sending
+// the next. Receivers opt in with RegisterFrameAck and call AckFrame
+// after each frame has been received and copied. The sender calls
+// WaitFrameAck after sending a frame.
+//
+// Acknowledgements are in shared memory "<sendername>_SpoutAck".
+// If no receiver has registered, WaitFrameAck reads the receiver count
+// and returns without a kernel call. Frame counting must be enabled
+// for the frame numbers.
+//
+
+// -----------------------------------------------
+// Function: RegisterFrameAck
+// Receiver register to acknowledge the frames of a sender.
+//
+// The sender waits for this receiver from the next frame.
+bool spoutFrameCount::RegisterFrameAck(const char* SenderName)
+{
+	if (!SenderName || !*SenderName)
+		return false;
+
+	if (m_pAckEntry && strcmp(m_AckSenderName, SenderName) == 0)
+		return true;
+
+	UnregisterFrameAck();
+
+	if (!OpenFrameAck(SenderName))
+		return false;
+
+	const LONG processId = (LONG)GetCurrentProcessId();
+	for (int i = 0; i < SPOUT_ACK_RECEIVERS && !m_pAckEntry; i++) {
+		SpoutAckEntry* pEntry = &m_pAck->entry[i];
+		const LONG owner = pEntry->owner;
+		// A free entry or one of a process that closed without releasing it
+		if ((owner == 0 || (owner != processId && !IsProcessRunning((DWORD)owner)))
+			&& InterlockedCompareExchange(&pEntry->owner, processId, owner) == owner) {
+			// Acknowledged up to the frame received so far
+			InterlockedExchange64(&pEntry->frame, m_FrameCount);
+			if (owner == 0)
+				InterlockedIncrement(&m_pAck->receivers);
+			m_pAckEntry = pEntry;
+		}
+	}
+
+	if (!m_pAckEntry) {
+		SpoutLogWarning("spoutFrameCount::RegisterFrameAck - [%s] no free entry", SenderName);
+		CloseFrameAck();
+		return false;
+	}
+
+	SpoutLogNotice("spoutFrameCount::RegisterFrameAck - [%s] entry %d", SenderName, (int)(m_pAckEntry - m_pAck->entry));
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: AckFrame
+// Receiver acknowledge the frame received.
+//
+// Call after the frame has been received and copied,
+// so that the sender can overwrite the shared texture.
+bool spoutFrameCount::AckFrame()
+{
+	return AckFrame(m_FrameCount);
+}
+
+// -----------------------------------------------
+// Function: AckFrame
+// Receiver acknowledge a frame number.
+//
+// For frames numbered other than by the sender frame count,
+// such as the frames of a sender texture ring.
+bool spoutFrameCount::AckFrame(LONG64 framenumber)
+{
+	if (!m_pAckEntry)
+		return false;
+
+	InterlockedExchange64(&m_pAckEntry->frame, framenumber);
+	if (m_hAckEvent)
+		SetEvent(m_hAckEvent);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: UnregisterFrameAck
+// Receiver remove the registration.
+//
+// The sender no longer waits for this receiver.
+void spoutFrameCount::UnregisterFrameAck()
+{
+	CloseFrameAck();
+}
+
+// -----------------------------------------------
+// Function: WaitFrameAck
+// Sender wait until all registered receivers have acknowledged the last frame.
+//
+// Call after sending a frame. Returns true at once if no receiver has registered.
+// A receiver that has closed without removing its registration is removed.
+// Returns false if the timeout elapses first.
+bool spoutFrameCount::WaitFrameAck(DWORD dwTimeout)
+{
+	return WaitFrameAck(m_FrameCount, dwTimeout);
+}
+
+// -----------------------------------------------
+// Function: WaitFrameAck
+// Sender wait until all registered receivers have acknowledged a frame number.
+//
+// For a sender that can be more than one frame ahead of the receivers.
+bool spoutFrameCount::WaitFrameAck(LONG64 framenumber, DWORD dwTimeout)
+{
+	if (!m_pAck && !OpenFrameAck(m_SenderName))
+		return true;
+
+	// No receiver has registered
+	if (InterlockedCompareExchange(&m_pAck->receivers, 0, 0) <= 0)
+		return true;
+
+	const LONG64 target = framenumber;
+	const DWORD dwStart = GetTickCount();
+	bool bChecked = false; // receivers checked for closed processes
+	for (;;) {
+		// Receivers that have not acknowledged the frame
+		int pending = 0;
+		for (int i = 0; i < SPOUT_ACK_RECEIVERS; i++) {
+			const SpoutAckEntry* pEntry = &m_pAck->entry[i];
+			if (pEntry->owner != 0 && InterlockedCompareExchange64((volatile LONG64*)&pEntry->frame, 0, 0) < target)
+				pending++;
+		}
+		if (pending == 0)
+			return true;
+
+		DWORD dwWait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			const DWORD dwElapsed = GetTickCount() - dwStart;
+			dwWait = (dwElapsed < dwTimeout) ? dwTimeout - dwElapsed : 0;
+		}
+
+		// Receivers set the event after each acknowledgement.
+		// Check for closed receivers every 100 msec.
+		const DWORD dwResult = WaitForSingleObject(m_hAckEvent, (dwWait > 100) ? 100 : dwWait);
+		if (dwResult == WAIT_OBJECT_0)
+			continue;
+		if (dwResult != WAIT_TIMEOUT) {
+			SpoutLogError("spoutFrameCount::WaitFrameAck - wait failed (%d)", GetLastError());
+			return false;
+		}
+
+		// Remove receivers that have closed
+		for (int i = 0; i < SPOUT_ACK_RECEIVERS; i++) {
+			SpoutAckEntry* pEntry = &m_pAck->entry[i];
+			const LONG owner = pEntry->owner;
+			if (owner != 0 && pEntry->frame < target && !IsProcessRunning((DWORD)owner)
+				&& InterlockedCompareExchange(&pEntry->owner, 0, owner) == owner) {
+				InterlockedDecrement(&m_pAck->receivers);
+				SpoutLogWarning("spoutFrameCount::WaitFrameAck - receiver process %d closed", owner);
+			}
+		}
+
+		if (dwWait <= 100) {
+			if (bChecked) {
+				SpoutLogWarning("spoutFrameCount::WaitFrameAck - frame %lld not acknowledged", target);
+				return false;
+			}
+			// One more check after removing closed receivers
+			bChecked = true;
+		}
+	}
+}
+
+// -----------------------------------------------
+// Function: IsFrameAckRegistered
+// Is this receiver registered to acknowledge frames
+bool spoutFrameCount::IsFrameAckRegistered()
+{
+	return (m_pAckEntry != nullptr);
+}
+
+// -----------------------------------------------
+// Function: GetFrameAckReceivers
+// Sender number of registered receivers
+int spoutFrameCount::GetFrameAckReceivers()
+{
+	if (!m_pAck && !OpenFrameAck(m_SenderName))
+		return 0;
+	return (int)InterlockedCompareExchange(&m_pAck->receivers, 0, 0);
+}
+
+// -----------------------------------------------
+// Function: CloseFrameAck
+// Close the acknowledgement map.
+//
+// A receiver releases its entry.
+void spoutFrameCount::CloseFrameAck()
+{
+	if (m_pAckEntry) {
+		if (InterlockedCompareExchange(&m_pAckEntry->owner, 0, (LONG)GetCurrentProcessId()) == (LONG)GetCurrentProcessId())
+			InterlockedDecrement(&m_pAck->receivers);
+		// The sender may be waiting for this receiver
+		if (m_hAckEvent)
+			SetEvent(m_hAckEvent);
+		m_pAckEntry = nullptr;
+	}
+	if (m_hAckEvent)
+		CloseHandle(m_hAckEvent);
+	m_hAckEvent = NULL;
+	m_AckMemory.Close();
+	m_pAck = nullptr;
+	m_AckSenderName[0] = 0;
+}
+
+// Create or open the acknowledgement map and event of a sender.
+// The sender or the first receiver to register creates them.
+bool spoutFrameCount::OpenFrameAck(const char* SenderName)
+{
+	if (!SenderName || !*SenderName)
+		return false;
+
+	if (m_pAck)
+		return true;
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutAck";
+	if (m_AckMemory.Create(mapname.c_str(), (int)sizeof(SpoutFrameAck)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::OpenFrameAck - could not create [%s]", mapname.c_str());
+		return false;
+	}
+	m_pAck = reinterpret_cast<SpoutFrameAck*>(m_AckMemory.Buffer());
+	if (!m_pAck) {
+		m_AckMemory.Close();
+		return false;
+	}
+	if (m_pAck->size == 0) {
+		// New map
+		m_pAck->size = (uint32_t)sizeof(SpoutFrameAck);
+		m_pAck->version = SPOUT_ACK_VERSION;
+	}
+
+	std::string eventname = SenderName;
+	eventname += "_SpoutAckEvent";
+	m_hAckEvent = CreateEventA(NULL, FALSE, FALSE, eventname.c_str()); // auto reset
+	if (!m_hAckEvent) {
+		SpoutLogWarning("spoutFrameCount::OpenFrameAck - could not create [%s]", eventname.c_str());
+		m_AckMemory.Close();
+		m_pAck = nullptr;
+		return false;
+	}
+
+	strcpy_s(m_AckSenderName, 256, SenderName);
+
+	return true;
+}
+
+
+//
+// Group: Control messages
+//
+// Short messages such as "switch scene" or "freeze" between a sender
+// and a receiver, without the registry or a locked memory buffer.
+// Each direction is a single-producer/single-consumer ring in
+// shared memory "<sendername>_SpoutMessages", so there is one
+// sender and one receiver for the messages of a sender name.
+// Writing never blocks. If the consumer has not read the messages
+// and the ring is full, WriteControlMessage returns false.
+// A consumer can poll ReadControlMessage or block in WaitControlMessage.
+//
+
+// -----------------------------------------------
+// Function: OpenControlMessages
+// Open the control message rings of a sender.
+//
+// The sender writes messages for the receiver and reads
+// messages from it. The receiver does the opposite.
+bool spoutFrameCount::OpenControlMessages(const char* SenderName, bool bSender)
+{
+	if (!SenderName || !*SenderName)
+		return false;
+
+	CloseControlMessages();
+
+	std::string mapname = SenderName;
+	mapname += "_SpoutMessages";
+	if (m_MessageMemory.Create(mapname.c_str(), (int)sizeof(SpoutMessages)) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutFrameCount::OpenControlMessages - could not create [%s]", mapname.c_str());
+		return false;
+	}
+	m_pMessages = reinterpret_cast<SpoutMessages*>(m_MessageMemory.Buffer());
+	if (!m_pMessages) {
+		m_MessageMemory.Close();
+		return false;
+	}
+	if (m_pMessages->size == 0) {
+		// New map
+		m_pMessages->size = (uint32_t)sizeof(SpoutMessages);
+		m_pMessages->version = SPOUT_MESSAGE_VERSION;
+		m_pMessages->slots = SPOUT_MESSAGE_SLOTS;
+		m_pMessages->length = SPOUT_MESSAGE_LENGTH;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		std::string eventname = SenderName;
+		eventname += "_SpoutMessageEvent";
+		eventname += std::to_string(i);
+		m_hMessageEvent[i] = CreateEventA(NULL, FALSE, FALSE, eventname.c_str()); // auto reset
+		if (!m_hMessageEvent[i]) {
+			SpoutLogWarning("spoutFrameCount::OpenControlMessages - could not create [%s]", eventname.c_str());
+			CloseControlMessages();
+			return false;
+		}
+	}
+
+	m_MessageRing = bSender ? SPOUT_MESSAGE_TO_RECEIVER : SPOUT_MESSAGE_TO_SENDER;
+	SpoutLogNotice("spoutFrameCount::OpenControlMessages - [%s] %s", SenderName, bSender ? "sender" : "receiver");
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: WriteControlMessage
+// Write a control message.
+//
+// The message is up to SPOUT_MESSAGE_LENGTH bytes, with an optional
+// type identifier for the application. Returns false without waiting
+// if the ring is full because the other side has not read the messages.
+bool spoutFrameCount::WriteControlMessage(const char* data, unsigned int length, uint32_t id)
+{
+	if (!m_pMessages || (length > 0 && !data))
+		return false;
+
+	if (length > SPOUT_MESSAGE_LENGTH) {
+		SpoutLogWarning("spoutFrameCount::WriteControlMessage - %u bytes, maximum %d", length, SPOUT_MESSAGE_LENGTH);
+		return false;
+	}
+
+	SpoutMessageRing* pRing = &m_pMessages->ring[m_MessageRing];
+	const LONG64 write = pRing->write; // Written only by this producer
+	if (write - InterlockedCompareExchange64(&pRing->read, 0, 0) >= SPOUT_MESSAGE_SLOTS)
+		return false; // Full
+
+	SpoutMessageSlot* pSlot = &pRing->slot[write % SPOUT_MESSAGE_SLOTS];
+	pSlot->length = length;
+	pSlot->id = id;
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	pSlot->time = count.QuadPart;
+	if (length > 0)
+		memcpy(pSlot->data, data, length);
+
+	// Publish the message after the slot has been written
+	InterlockedExchange64(&pRing->write, write + 1);
+
+	// Wake a consumer blocked in WaitControlMessage
+	if (InterlockedCompareExchange(&pRing->waiting, 0, 0) != 0)
+		SetEvent(m_hMessageEvent[m_MessageRing]);
+
+	return true;
+}
+
+// -----------------------------------------------
+// Function: ReadControlMessage
+// Read the next control message.
+//
+// Returns the number of bytes copied, or -1 if there is no message.
+// A message longer than maxlength is truncated.
+int spoutFrameCount::ReadControlMessage(char* data, unsigned int maxlength, uint32_t* pId)
+{
+	if (!m_pMessages)
+		return -1;
+
+	SpoutMessageRing* pRing = &m_pMessages->ring[1 - m_MessageRing];
+	const LONG64 read = pRing->read; // Written only by this consumer
+	if (InterlockedCompareExchange64(&pRing->write, 0, 0) == read)
+		return -1; // Empty
+
+	const SpoutMessageSlot* pSlot = &pRing->slot[read % SPOUT_MESSAGE_SLOTS];
+	unsigned int length = pSlot->length;
+	if (length > SPOUT_MESSAGE_LENGTH) length = SPOUT_MESSAGE_LENGTH;
+	if (length > maxlength) length = maxlength;
+	if (length > 0 && data)
+		memcpy(data, pSlot->data, length);
+	else
+		length = 0;
+	if (pId)
+		*pId = pSlot->id;
+
+	// Release the slot to the producer
+	InterlockedExchange64(&pRing->read, read + 1);
+
+	return (int)length;
+}
+
+// -----------------------------------------------
+// Function: WaitControlMessage
+// Wait for a control message.
+//
+// Returns true if a message is ready to read
+// or false if none arrived within the timeout.
+bool spoutFrameCount::WaitControlMessage(DWORD dwTimeout)
+{
+	if (!m_pMessages)
+		return false;
+
+	const int ring = 1 - m_MessageRing;
+	SpoutMessageRing* pRing = &m_pMessages->ring[ring];
+	const DWORD dwStart = GetTickCount();
+	for (;;) {
+		if (GetControlMessageCount() > 0)
+			return true;
+
+		// Signal the producer, then check again in case
+		// a message was written before it saw the flag
+		InterlockedExchange(&pRing->waiting, 1);
+		if (GetControlMessageCount() > 0) {
+			InterlockedExchange(&pRing->waiting, 0);
+			return true;
+		}
+
+		DWORD dwWait = dwTimeout;
+		if (dwTimeout != INFINITE) {
+			const DWORD dwElapsed = GetTickCount() - dwStart;
+			dwWait = (dwElapsed < dwTimeout) ? (dwTimeout - dwElapsed) : 0;
+		}
+		const DWORD dwResult = WaitForSingleObject(m_hMessageEvent[ring], dwWait);
+		InterlockedExchange(&pRing->waiting, 0);
+		if (dwResult == WAIT_OBJECT_0)
+			continue; // The event can remain set from a message already read
+		if (dwResult != WAIT_TIMEOUT)
+			SpoutLogError("spoutFrameCount::WaitControlMessage - wait failed (%d)", GetLastError());
+		return (GetControlMessageCount() > 0);
+	}
+}
+
+// -----------------------------------------------
+// Function: GetControlMessageCount
+// Number of control messages waiting to be read
+int spoutFrameCount::GetControlMessageCount()
+{
+	if (!m_pMessages)
+		return 0;
+	SpoutMessageRing* pRing = &m_pMessages->ring[1 - m_MessageRing];
+	return (int)(InterlockedCompareExchange64(&pRing->write, 0, 0) - InterlockedCompareExchange64(&pRing->read, 0, 0));
+}
+
+// -----------------------------------------------
+// Function: CloseControlMessages
+// Close the control message rings
+void spoutFrameCount::CloseControlMessages()
+{
+	for (int i = 0; i < 2; i++) {
+		if (m_hMessageEvent[i])
+			CloseHandle(m_hMessageEvent[i]);
+		m_hMessageEvent[i] = NULL;
+	}
+	m_MessageMemory.Close();
+	m_pMessages = nullptr;
+	m_MessageRing = SPOUT_MESSAGE_TO_RECEIVER;
+}
+
+
 // ===============================================================================
 
 
@@ -38,8 +38,11 @@
 #include "SpoutSharedMemory.h"
 
 #include <d3d11.h>
+#include <d3d11_4.h> // for shared fence
+#include <stdint.h>
 #pragma comment (lib, "d3d11.lib") // for keyed mutex texture access
 #pragma comment (lib, "Winmm.lib") // for timer resolution functions 
+#pragma comment (lib, "DXGI.lib") // for CreateDXGIFactory1
 
 using namespace spoututils;
 
@@ -50,6 +53,292 @@ using namespace spoututils;
 #include <thread>
 #endif
 
+// High resolution waitable timer for HoldFps
+// Windows 10 1803 and later
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+// Final msec of the frame time waited by spinning
+#define SPOUT_HOLD_SPIN_MSEC 1.0
+
+// Receiver frame pacing
+// Msec allowed after the predicted sender frame time for the frame to be available
+#define SPOUT_PACE_MARGIN 0.5
+// Part of the refresh interval that a receiver waits for a frame that is due
+#define SPOUT_PACE_WINDOW 0.5
+
+//
+// Shared fence information saved to shared memory
+// "<sendername>_SpoutFence" by a sender using fence synchronisation.
+// The NT handle is valid in the sender process and is duplicated by the receiver.
+//
+struct SpoutFenceInfo {			// 32 bytes total
+	uint32_t processId;			// 4 bytes : sender process ID
+	uint32_t reserved;			// 4 bytes : alignment
+	uint64_t fenceHandle;		// 8 bytes : shared fence NT handle
+	volatile LONG64 fenceValue;	// 8 bytes : last value signalled by the sender
+	volatile LONG64 writeValue;	// 8 bytes : value signalled after the write in progress
+};
+
+//
+// Frame information saved to shared memory "<sendername>_SpoutFrame".
+// The sender records the sequence number and publish time of each frame
+// so that a receiver can read them without the kernel transitions
+// of the frame count semaphore. Times are QueryPerformanceCounter values,
+// which are the same for all processes.
+// "lock" and "copylock" are odd while the fields following them are written.
+// "lock" also covers "hashframe" and "hash" (version 2).
+// "size" and "version" allow the structure to be extended.
+//
+#define SPOUT_FRAMEINFO_VERSION 2
+struct SpoutFrameInfo {			// 72 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	volatile LONG lock;			// 4 bytes : frame and time update
+	volatile LONG copylock;		// 4 bytes : copyframe and copyticks update
+	volatile LONG64 frame;		// 8 bytes : sequence number of the last frame sent
+	volatile LONG64 time;		// 8 bytes : time the last frame was published
+	volatile LONG64 copyframe;	// 8 bytes : last frame with the GPU copy complete
+	volatile LONG64 copyticks;	// 8 bytes : counts from publish to GPU copy completion
+	volatile double fps;		// 8 bytes : sender frame rate
+	volatile LONG64 hashframe;	// 8 bytes : frame of the content hash, 0 if not computed
+	volatile uint64_t hash;		// 8 bytes : GPU hash of the frame content
+};
+
+//
+// Dirty rectangles saved to shared memory "<sendername>_SpoutDirty"
+// by a sender that changes only part of the texture each frame.
+// "frame" is incremented for every frame sent after the map is created.
+// "count" zero means the whole texture has changed.
+// Rectangles are pixels from the top left of the shared texture
+// with right and bottom exclusive, the same as D3D11_RECT.
+//
+#define SPOUT_MAX_DIRTY_RECTS 16
+#define SPOUT_DIRTY_HISTORY 4
+struct SpoutDirtyRects {		// 272 bytes total
+	LONG64 frame;				// 8 bytes : frame the rectangles apply to
+	uint32_t count;				// 4 bytes : number of rectangles, 0 for the whole texture
+	uint32_t reserved;			// 4 bytes : alignment
+	RECT rects[SPOUT_MAX_DIRTY_RECTS]; // 256 bytes : changed regions
+};
+
+//
+// Frame slices saved to shared memory "<sendername>_SpoutSlices"
+// by a sender that publishes horizontal slices of each frame as they are copied.
+// Slice i is the rows from i*height/count to (i+1)*height/count of the texture.
+// "sequence" is the frame number of the last copy of each slice and
+// "fence" the shared fence value signalled after it.
+//
+#define SPOUT_MAX_SLICES 16
+struct SpoutFrameSlices {		// 272 bytes total
+	volatile uint32_t count;	// 4 bytes : number of slices of each frame
+	uint32_t reserved;			// 4 bytes : alignment
+	volatile LONG64 frame;		// 8 bytes : frame of the slices being sent
+	volatile LONG64 sequence[SPOUT_MAX_SLICES]; // 128 bytes : frame of each slice
+	volatile LONG64 fence[SPOUT_MAX_SLICES]; // 128 bytes : fence value of each slice
+};
+
+//
+// Frame data saved to shared memory "<sendername>_SpoutData"
+// by a sender that publishes data with its frames.
+// Each write is saved to the next slot and tagged with the number
+// of the frame that it is sent with. "lock" is odd while the slot is written.
+// The data of each slot, "capacity" bytes, follows the structure.
+//
+#define SPOUT_FRAMEDATA_VERSION 1
+#define SPOUT_FRAMEDATA_SLOTS 8
+struct SpoutFrameDataSlot {		// 24 bytes total
+	volatile LONG64 lock;		// 8 bytes : odd while written
+	LONG64 frame;				// 8 bytes : frame the data is sent with
+	uint32_t length;			// 4 bytes : number of data bytes
+	uint32_t reserved;			// 4 bytes : alignment
+};
+struct SpoutFrameData {			// 216 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	uint32_t capacity;			// 4 bytes : data bytes of each slot
+	uint32_t slots;				// 4 bytes : number of slots
+	volatile LONG64 writes;		// 8 bytes : number of writes
+	SpoutFrameDataSlot slot[SPOUT_FRAMEDATA_SLOTS]; // 192 bytes : slot information
+};
+
+//
+// Telemetry saved to shared memory "SpoutTelemetry" by senders and receivers
+// with telemetry enabled, for monitoring by other applications.
+// Each sender or receiver claims a free entry by writing its process ID
+// to "owner" and updates the entry with every frame.
+// "lock" is odd while the fields following it are written.
+//
+// Version 2 adds texture access statistics, zero unless they are enabled
+// (see spoutFrameCount::EnableAccessStats).
+//
+#define SPOUT_TELEMETRY_VERSION 2
+#define SPOUT_TELEMETRY_ENTRIES 128
+#define SPOUT_TELEMETRY_SENDER 1
+#define SPOUT_TELEMETRY_RECEIVER 2
+struct SpoutTelemetryEntry {	// 384 bytes total
+	volatile LONG owner;		// 4 bytes : process ID, 0 for a free entry
+	volatile LONG lock;			// 4 bytes : odd while the entry is written
+	uint32_t role;				// 4 bytes : SPOUT_TELEMETRY_SENDER or SPOUT_TELEMETRY_RECEIVER
+	uint32_t sharemode;			// 4 bytes : 0 texture, 1 memory, 2 CPU
+	LONG64 time;				// 8 bytes : time of the last update (QueryPerformanceCounter)
+	LONG64 frame;				// 8 bytes : sender frame number
+	LONG64 missed;				// 8 bytes : sender frames not received
+	double fps;					// 8 bytes : sender frame rate
+	double copytime;			// 8 bytes : sender GPU copy time in msec
+	uint64_t memory;			// 8 bytes : bytes held by the sender or receiver
+	char name[256];				// 256 bytes : sender name
+	LONG64 accesses;			// 8 bytes : texture accesses acquired
+	LONG64 waits;				// 8 bytes : accesses that waited for another holder
+	LONG64 timeouts;			// 8 bytes : access checks that timed out
+	double waittime;			// 8 bytes : total msec waiting for access
+	double maxwait;				// 8 bytes : longest wait in msec
+	double holdtime;			// 8 bytes : total msec holding access
+	double maxhold;				// 8 bytes : longest hold in msec
+	uint32_t contenders;		// 4 bytes : most waiting for access at once
+	uint32_t holder;			// 4 bytes : process last found holding access
+};
+struct SpoutTelemetry {			// 49168 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	uint32_t entries;			// 4 bytes : number of entries
+	uint32_t entrysize;			// 4 bytes : size of each entry
+	SpoutTelemetryEntry entry[SPOUT_TELEMETRY_ENTRIES];
+};
+
+//
+// Texture access contention saved to shared memory "<sendername>_SpoutAccess"
+// by senders and receivers with access statistics enabled.
+// "holder" is the process that last acquired access, cleared on release,
+// and "waiting" is the number of senders and receivers waiting for access.
+// Applies to the sender named mutex and keyed mutex textures.
+//
+struct SpoutAccessInfo {		// 16 bytes total
+	volatile LONG holder;		// 4 bytes : process holding access, 0 if none
+	volatile LONG waiting;		// 4 bytes : number waiting for access
+	volatile LONG64 acquired;	// 8 bytes : time access was acquired (QueryPerformanceCounter)
+};
+
+//
+// Texture access statistics of a sender or receiver (see EnableAccessStats)
+// A wait longer than SPOUT_ACCESS_WAIT_MSEC, or with another holder
+// recorded when the wait started, is counted as a contended wait.
+//
+#define SPOUT_ACCESS_WAIT_MSEC 0.25
+struct SpoutAccessStats {
+	LONG64 accesses;			// accesses acquired
+	LONG64 waits;				// accesses that waited for another holder
+	LONG64 timeouts;			// access checks that timed out
+	double waittime;			// total msec waiting for access
+	double maxwait;				// longest wait in msec
+	double holdtime;			// total msec between access and release
+	double maxhold;				// longest hold in msec
+	LONG contenders;			// most senders and receivers waiting at once
+	DWORD holder;				// process last found holding access when waiting
+};
+
+//
+// Frame clock saved to shared memory "<clockname>_SpoutClock"
+// by a timing master for senders in other processes to lock to.
+// The master publishes the number and time of each tick. Times are
+// QueryPerformanceCounter values, which are the same for all processes.
+// "lock" is odd while the tick is written.
+//
+#define SPOUT_CLOCK_VERSION 1
+struct SpoutFrameClock {		// 40 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	volatile LONG lock;			// 4 bytes : odd while the tick is written
+	volatile LONG master;		// 4 bytes : process ID of the timing master
+	volatile LONG64 tick;		// 8 bytes : number of the last tick
+	volatile LONG64 time;		// 8 bytes : time of the last tick
+	volatile LONG64 period;		// 8 bytes : counts between ticks
+};
+
+//
+// Frame acknowledgement saved to shared memory "<sendername>_SpoutAck"
+// for a sender that must not drop frames.
+// Receivers claim an entry by writing their process ID to "owner"
+// and write the number of each frame after they have used it.
+// The sender waits until every registered receiver has acknowledged
+// the frame sent. Receivers set the event "<sendername>_SpoutAckEvent"
+// after each acknowledgement.
+//
+#define SPOUT_ACK_VERSION 1
+#define SPOUT_ACK_RECEIVERS 16
+struct SpoutAckEntry {			// 16 bytes total
+	volatile LONG owner;		// 4 bytes : receiver process ID, 0 for a free entry
+	uint32_t reserved;			// 4 bytes : alignment
+	volatile LONG64 frame;		// 8 bytes : last frame acknowledged
+};
+struct SpoutFrameAck {			// 272 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	volatile LONG receivers;	// 4 bytes : number of registered receivers
+	uint32_t reserved;			// 4 bytes : alignment
+	SpoutAckEntry entry[SPOUT_ACK_RECEIVERS]; // 256 bytes : receiver entries
+};
+
+//
+// Control messages saved to shared memory "<sendername>_SpoutMessages".
+// Two single-producer/single-consumer rings, one for messages from the
+// sender to a receiver and one for messages from a receiver to the sender.
+// "write" is advanced only by the producer and "read" only by the consumer,
+// so neither side locks. The producer sets the event
+// "<sendername>_SpoutMessageEvent<ring>" only if "waiting" is set
+// by a consumer blocked in WaitControlMessage.
+//
+#define SPOUT_MESSAGE_VERSION 1
+#define SPOUT_MESSAGE_SLOTS 64
+#define SPOUT_MESSAGE_LENGTH 240
+#define SPOUT_MESSAGE_TO_RECEIVER 0
+#define SPOUT_MESSAGE_TO_SENDER 1
+struct SpoutMessageSlot {		// 256 bytes total
+	uint32_t length;			// 4 bytes : number of message bytes
+	uint32_t id;				// 4 bytes : message type defined by the application
+	LONG64 time;				// 8 bytes : time written (QueryPerformanceCounter)
+	char data[SPOUT_MESSAGE_LENGTH]; // 240 bytes : message
+};
+struct SpoutMessageRing {		// 16512 bytes total
+	volatile LONG64 write;		// 8 bytes : messages written
+	char pad0[56];				// 56 bytes : producer and consumer on separate cache lines
+	volatile LONG64 read;		// 8 bytes : messages read
+	volatile LONG waiting;		// 4 bytes : consumer waiting for the event
+	char pad1[52];				// 52 bytes : alignment
+	SpoutMessageSlot slot[SPOUT_MESSAGE_SLOTS]; // 16384 bytes : messages
+};
+struct SpoutMessages {			// 33088 bytes total
+	uint32_t size;				// 4 bytes : size of the structure
+	uint32_t version;			// 4 bytes : structure version
+	uint32_t slots;				// 4 bytes : messages in each ring
+	uint32_t length;			// 4 bytes : maximum message length
+	char reserved[48];			// 48 bytes : alignment
+	SpoutMessageRing ring[2];	// 33024 bytes : SPOUT_MESSAGE_TO_RECEIVER, SPOUT_MESSAGE_TO_SENDER
+};
+
+//
+// Receiver frame statistics
+//
+struct SpoutFrameStats {
+	LONG64 received;			// new sender frames received
+	LONG64 missed;				// sender frames skipped
+	LONG64 repeated;			// receive calls that returned a frame already received
+	LONG64 maxgap;				// largest number of sender frames skipped at one time
+	double maxinterval;			// longest time in msec between new frames
+};
+
+//
+// Receiver frame pacing
+//
+struct SpoutFramePacing {
+	double interval;			// predicted sender frame interval in msec
+	double jitter;				// mean deviation of sender frame intervals in msec
+	double next;				// msec until the next sender frame is due, negative if late
+	double refresh;				// receiver refresh interval in msec
+	double delay;				// recommended wait in msec before receiving
+	double latency;				// recommended presentation delay in msec after the sender frame
+};
+
 class SPOUT_DLLEXP spoutFrameCount {
 
 	public:
@@ -65,6 +354,8 @@ class SPOUT_DLLEXP spoutFrameCount {
 	void SetFrameCount(bool bEnable);
 	// Enable frame counting for this sender
 	void EnableFrameCount(const char* SenderName);
+	// Enable frame counting for a sender by ID (spoutSenderNames::GetSenderUID)
+	bool EnableFrameCountUID(uint64_t senderuid);
 	// Disable frame counting
 	void DisableFrameCount();
 	// Pause frame counting
@@ -77,8 +368,48 @@ class SPOUT_DLLEXP spoutFrameCount {
 	double GetSenderFps();
 	// Received frame count
 	long GetSenderFrame();
+	// Received frame count (64 bit)
+	LONG64 GetSenderFrame64();
+	// Time in msec from sender publish to receipt of the last frame
+	double GetFrameAge();
+	// Sender GPU copy time in msec of the last frame completed
+	double GetFrameCopyTime();
+	// Number of sender frames not received
+	LONG64 GetMissedFrames();
+	// Receiver skip frames with the same content hash as the last received
+	void SetSkipUnchanged(bool bSkip = true);
+	// Skip unchanged frames option
+	bool GetSkipUnchanged();
+	// Content hash of the last frame received (0 if not published)
+	uint64_t GetContentHash();
+	// Receiver frame statistics since connection or for the last window
+	void GetFrameStats(SpoutFrameStats &stats, bool bWindow = false);
+	// Reset receiver frame statistics
+	void ResetFrameStats();
+	// Window for frame statistics in msec (default 1000)
+	void SetFrameStatsWindow(DWORD dwMsec = 1000);
+	// Receiver frame pacing predicted from the sender frame times
+	bool GetFramePacing(SpoutFramePacing &pacing, double refresh = 0.0);
+	// Receiver wait for the next sender frame if it is due within the refresh interval
+	double PaceReceive(double refresh = 0.0);
+	// Start vertical blank timing of the display output of a monitor (primary if null)
+	bool StartVBlankTiming(HMONITOR hMonitor = NULL, double offset = 2.0);
+	// Stop vertical blank timing
+	void StopVBlankTiming();
+	// Vertical blank timing status
+	bool IsVBlankTiming();
+	// Msec before the vertical blank to receive
+	void SetVBlankOffset(double offset);
+	// Wait until the offset before the next vertical blank
+	double WaitVBlankReceive();
+	// Measured refresh period and msec until the next vertical blank
+	bool GetVBlankTiming(double &period, double &next);
 	// Frame rate control
 	void HoldFps(int fps);
+	// HoldFps wait with a high resolution timer (default enabled)
+	void EnableFpsTimer(bool bEnable = true);
+	// High resolution timer used by HoldFps
+	bool IsFpsTimerEnabled();
 
 	//
 	// Used by other classes
@@ -88,6 +419,12 @@ class SPOUT_DLLEXP spoutFrameCount {
 	void SetNewFrame();
 	// Receiver read the semaphore count
 	bool GetNewFrame();
+	// The next GetNewFrame returns true for the current sender frame
+	void ResetNewFrame();
+	// Receiver test or wait for the sender frame event (false if there is no new frame)
+	bool WaitNewFrame(DWORD dwTimeout = 0);
+	// Sender content hash published with the next frame (0 if not computed)
+	void SetContentHash(uint64_t hash);
 	// For class cleanup functions
 	void CleanupFrameCount();
 
@@ -99,6 +436,8 @@ class SPOUT_DLLEXP spoutFrameCount {
 
 	// Test for texture access using a named sender mutex or keyed texture mutex 
 	bool CheckTextureAccess(ID3D11Texture2D* D3D11texture = nullptr);
+	// Test for texture access with a timeout in msec
+	bool CheckTextureAccess(ID3D11Texture2D* D3D11texture, DWORD dwTimeout);
 	// Release mutex and allow texture access
 	bool AllowTextureAccess(ID3D11Texture2D* D3D11texture = nullptr);
 
@@ -112,8 +451,22 @@ class SPOUT_DLLEXP spoutFrameCount {
 	void CloseAccessMutex();
 	// Test access using a named mutex
 	bool CheckAccess();
+	// Test access using a named mutex with a timeout in msec
+	bool CheckAccess(DWORD dwTimeout);
+	// Set the access timeout in msec (default 67, 4 frames at 60fps)
+	void SetAccessTimeout(DWORD dwTimeout = 67);
+	// Access timeout
+	DWORD GetAccessTimeout();
 	// Allow access after gaining ownership
 	void AllowAccess();
+	// Record texture access wait and hold times and contention
+	void EnableAccessStats(bool bEnable = true, double warnmsec = 0.0);
+	// Access statistics status
+	bool IsAccessStatsEnabled();
+	// Texture access statistics
+	void GetAccessStats(SpoutAccessStats &stats);
+	// Reset access statistics
+	void ResetAccessStats();
 	// Test for keyed mutex
 	bool IsKeyedMutex(ID3D11Texture2D* D3D11texture);
 
@@ -125,6 +478,10 @@ class SPOUT_DLLEXP spoutFrameCount {
 	void SetFrameSync(const char* name);
 	// Wait or test for a sync event
 	bool WaitFrameSync(const char *name, DWORD dwTimeout = 0);
+	// Wait for the sync events of a number of senders
+	int WaitFrameSync(const char* const* names, int count, bool* bSignalled, DWORD dwTimeout = 0);
+	// Wait or test for the sync event of a sender by ID
+	bool WaitFrameSyncUID(uint64_t senderuid, DWORD dwTimeout = 0);
 	// Close sync event
 	void CloseFrameSync();
 	// Enable / disable frame sync
@@ -132,13 +489,191 @@ class SPOUT_DLLEXP spoutFrameCount {
 	// Check for frame sync option
 	bool IsFrameSyncEnabled();
 
+	//
+	// Shared fence (Windows 10 and later)
+	//
+
+	// Enable / disable shared fence synchronisation
+	void EnableFenceSync(bool bFence = true);
+	// Check for shared fence option
+	bool IsFenceSyncEnabled();
+	// Use the shared fence without the access mutex (all receivers use the fence)
+	void SetFenceOnly(bool bFenceOnly = true);
+	// Shared fence used without the access mutex
+	bool IsFenceOnly();
+	// Sender create a shared fence
+	bool CreateSharedFence(const char* SenderName, ID3D11Device* pDevice);
+	// Receiver open the sender's shared fence
+	bool OpenSharedFence(const char* SenderName, ID3D11Device* pDevice);
+	// Close the shared fence
+	void CloseSharedFence();
+	// Sender signal the fence after writing to the shared texture
+	bool SignalSharedFence();
+	// Sender publish the value signalled after the write in progress
+	bool BeginSharedFenceWrite();
+	// Receiver queue a GPU wait for the last value signalled by the sender
+	bool WaitSharedFence();
+	// Is a shared fence open
+	bool IsSharedFence();
+
+	//
+	// Frame timing (Windows 10 and later)
+	//
+
+	// Enable / disable sender GPU copy completion timing
+	void EnableFrameTiming(bool bTiming = true);
+	// Check for frame timing option
+	bool IsFrameTimingEnabled();
+	// Sender create a fence to time GPU copy completion
+	bool CreateFrameTiming(ID3D11Device* pDevice);
+	// Close frame timing
+	void CloseFrameTiming();
+
+	//
+	// Dirty rectangles
+	//
+
+	// Sender set the changed regions of the next frame
+	bool SetDirtyRects(const char* SenderName, const RECT* pRects, unsigned int nRects);
+	// Receiver read the changed regions of the frame received
+	bool ReadDirtyRects(const char* SenderName);
+	// Number of consecutive frames received with known changed regions
+	unsigned int GetDirtyFrames();
+	// Changed regions of a frame received "age" frames ago
+	bool GetDirtyRects(unsigned int age, const RECT** ppRects, unsigned int &nRects);
+	// Receiver copy the whole texture for the following frames
+	void ResetDirtyRects();
+	// Close the dirty rectangle map
+	void CloseDirtyRects();
+
+	//
+	// Frame slices
+	//
+
+	// Sender create the slice map for the number of slices of each frame
+	bool CreateFrameSlices(const char* SenderName, unsigned int nSlices);
+	// Sender begin the slices of a new frame
+	LONG64 BeginFrameSlices();
+	// Sender publish a slice after the copy to the shared texture
+	bool SignalFrameSlice(unsigned int slice);
+	// Receiver open the slice map of the sender
+	bool OpenFrameSlices(const char* SenderName);
+	// Number of slices of each frame, 0 if the sender does not send slices
+	unsigned int GetFrameSlices();
+	// Receiver wait for a slice and queue a GPU wait for its copy
+	bool WaitFrameSlice(unsigned int slice, LONG64 minframe, LONG64 &sliceframe, DWORD dwTimeout = 0);
+	// Close the slice map
+	void CloseFrameSlices();
+
+	//
+	// Frame data
+	//
+
+	// Sender create the frame data map for a maximum data length
+	bool CreateFrameData(const char* SenderName, unsigned int maxlength);
+	// Sender write data sent with the next frame
+	bool WriteFrameData(const char* SenderName, const char* data, unsigned int length);
+	// Receiver read the data sent with a frame (0 for the frame received)
+	int ReadFrameData(const char* SenderName, char* data, unsigned int maxlength, LONG64 framenumber = 0);
+	// Close the frame data map
+	void CloseFrameData();
+
+	//
+	// Telemetry
+	//
+
+	// Enable or disable telemetry globally by registry setting
+	void SetTelemetry(bool bEnable);
+	// Enable or disable telemetry for this application
+	void EnableTelemetry(bool bEnable = true);
+	// Is telemetry enabled
+	bool IsTelemetryEnabled();
+	// Share mode recorded with telemetry (0 texture, 1 memory, 2 CPU)
+	void SetTelemetryMode(int sharemode);
+	// Memory held by the sender or receiver recorded with telemetry
+	void SetTelemetryMemory(uint64_t bytes);
+	// Copy the telemetry of all running senders and receivers
+	int ReadTelemetry(SpoutTelemetryEntry* pEntries, int maxentries);
+
+	//
+	// Frame clock
+	//
+
+	// Timing master create a frame clock for a frame rate
+	bool CreateFrameClock(const char* clockname, double fps = 0.0);
+	// Timing master publish a tick of the frame clock
+	LONG64 TickFrameClock();
+	// Open the frame clock of a timing master
+	bool OpenFrameClock(const char* clockname);
+	// Wait for the next tick of the frame clock
+	LONG64 WaitFrameClock();
+	// Number of the last tick published by the timing master
+	LONG64 GetFrameClockTick();
+	// Close the frame clock
+	void CloseFrameClock();
+
+	//
+	// Frame acknowledgement
+	//
+
+	// Receiver register to acknowledge the frames of a sender
+	bool RegisterFrameAck(const char* SenderName);
+	// Receiver acknowledge the frame received
+	bool AckFrame();
+	// Receiver acknowledge a frame number
+	bool AckFrame(LONG64 framenumber);
+	// Receiver remove the registration
+	void UnregisterFrameAck();
+	// Sender wait until all registered receivers have acknowledged the last frame
+	bool WaitFrameAck(DWORD dwTimeout = INFINITE);
+	// Sender wait until all registered receivers have acknowledged a frame number
+	bool WaitFrameAck(LONG64 framenumber, DWORD dwTimeout);
+	// Is this receiver registered to acknowledge frames
+	bool IsFrameAckRegistered();
+	// Sender number of registered receivers
+	int GetFrameAckReceivers();
+	// Close the acknowledgement map
+	void CloseFrameAck();
+
+	//
+	// Control messages
+	//
+
+	// Open the control message rings of a sender (bSender true for the sender)
+	bool OpenControlMessages(const char* SenderName, bool bSender);
+	// Write a control message. False if the ring is full.
+	bool WriteControlMessage(const char* data, unsigned int length, uint32_t id = 0);
+	// Read the next control message, -1 if there is none
+	int ReadControlMessage(char* data, unsigned int maxlength, uint32_t* pId = nullptr);
+	// Wait for a control message
+	bool WaitControlMessage(DWORD dwTimeout = INFINITE);
+	// Number of control messages waiting to be read
+	int GetControlMessageCount();
+	// Close the control message rings
+	void CloseControlMessages();
+
 protected:
 
 	// Texture access named mutex
 	HANDLE m_hAccessMutex;
+	DWORD m_dwAccessTimeout;
+
+	// Texture access statistics
+	bool m_bAccessStats;
+	double m_AccessWarnMsec; // log a wait longer than this, 0 for none
+	SpoutAccessStats m_AccessStats;
+	LONG64 m_AccessStart; // time access was acquired
+	char m_AccessName[256]; // sender of the access mutex
+	SpoutAccessInfo* m_pAccessInfo;
+	SpoutSharedMemory m_AccessMemory;
+	bool OpenAccessInfo();
+	void CloseAccessInfo();
+	LONG64 BeginAccessWait(LONG &holder);
+	void EndAccessWait(LONG64 start, LONG holder, bool bAccess, bool bTimeout);
+	void EndAccessHold();
 
 	// DX11 texture keyed mutex checks
-	bool CheckKeyedAccess(ID3D11Texture2D* D3D11texture);
+	bool CheckKeyedAccess(ID3D11Texture2D* D3D11texture, DWORD dwTimeout);
 	bool AllowKeyedAccess(ID3D11Texture2D* D3D11texture);
 
 	// Frame count semaphore
@@ -149,8 +684,9 @@ protected:
 	HANDLE m_hCountSemaphore; // semaphore handle
 	char m_CountSemaphoreName[256]; // semaphore name
 	char m_SenderName[256]; // sender currently connected to a receiver
-	long m_FrameCount; // sender frame count
-	long m_LastFrameCount; // receiver frame comparator
+	LONG64 m_FrameCount; // sender frame count
+	LONG64 m_LastFrameCount; // receiver frame comparator
+	bool m_bRepeatFrame; // receiver the current frame is new again (ResetNewFrame)
 	double m_FrameTimeTotal;
 	double m_FrameTimeNumber;
 	double m_lastFrame;
@@ -158,17 +694,162 @@ protected:
 	// Sender frame timing
 	double m_SystemFps;
 	double m_SenderFps;
-	void UpdateSenderFps(long framecount = 0);
+	void UpdateSenderFps(long framecount = 0, double frametime = 0.0);
+
+	// Shared frame counter
+	SpoutSharedMemory m_FrameMemory;
+	SpoutFrameInfo* m_pFrameInfo; // counter in the map
+	LONG64 m_LastFrameTime; // sender time of the last frame received
+	double m_CounterFrequency; // performance counter frequency (counts/msec)
+	unsigned int m_FrameRetry; // receiver calls until the next map open attempt
+	double m_FrameAge; // msec from publish to receipt
+	double m_FrameCopyTime; // msec from publish to GPU copy completion
+	LONG64 m_MissedFrames;
+
+	// Frame content hash
+	uint64_t m_ContentHash; // sender hash for the next frame, receiver hash of the frame read
+	uint64_t m_LastContentHash; // receiver hash of the last frame received
+	bool m_bSkipUnchanged; // receiver option
+
+	// Receiver frame statistics
+	SpoutFrameStats m_FrameStats; // since connection
+	SpoutFrameStats m_WindowStats; // current window
+	SpoutFrameStats m_LastWindowStats; // last completed window
+	LONG64 m_WindowStart; // counter value at the start of the window
+	DWORD m_dwStatsWindow; // window msec
+	LONG64 m_LastReceiveTime; // counter value of the last new frame
+	void UpdateFrameStats(LONG64 skipped, bool bNew);
+
+	// Receiver frame pacing
+	LONG64 m_PaceFrame; // sender frame of the last pacing update
+	LONG64 m_PaceTime; // sender or receiver time of that frame
+	double m_PaceInterval; // predicted sender frame interval in msec
+	double m_PaceJitter; // mean deviation of the frame interval in msec
+	HANDLE m_hPaceTimer; // waitable timer for PaceReceive
+	void UpdateFramePacing(LONG64 framecount, LONG64 frametime);
+	void ResetFramePacing();
+	void WaitPaceDeadline(LONG64 deadline, double wait);
+
+	// Vertical blank timing
+	IDXGIOutput* m_pVBlankOutput; // output waited on by the thread
+	HANDLE m_hVBlankThread;
+	HANDLE m_hVBlankStop;
+	volatile LONG64 m_VBlankTime; // time of the last vertical blank
+	volatile LONG64 m_VBlankPeriod; // counts between vertical blanks
+	double m_VBlankOffset; // msec before the vertical blank to receive
+	static DWORD WINAPI VBlankThread(LPVOID lpParameter);
+	void VBlankLoop();
+
+	bool OpenFrameInfo(bool bSender);
+	void CloseFrameInfo();
+
+	// Frame events "<sendername>_SpoutFrameEvent0" and "1"
+	HANDLE m_hFrameEvent[2]; // manual reset, set for odd and even frames
+	bool m_bFrameEventSender; // the events were created by this sender
+	unsigned int m_FrameEventRetry; // receiver calls until the next open attempt
+	bool OpenFrameEvents(bool bSender);
+	void CloseFrameEvents();
+	void WriteFrameInfo(LONG64 framecount, LONG64 frametime);
+	bool ReadFrameInfo(LONG64 &framecount, LONG64 &frametime);
+
+	// Frame timing
+	bool m_bFrameTiming; // frame timing option
+	ID3D11Fence* m_pTimingFence;
+	ID3D11DeviceContext4* m_pTimingContext;
+	HANDLE m_hTimingEvent; // set when the fence reaches a value
+	HANDLE m_hTimingWait; // thread pool wait for the event
+	LONG64 m_PublishTime[8]; // publish times of recent frames by sequence number
+	static VOID CALLBACK TimingCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired);
+	void WriteCopyTime();
 
 	// Windows minimum time period
 	UINT m_PeriodMin;
 	void StartTimePeriod();
 	void EndTimePeriod();
 
+	// High resolution timer for HoldFps
+	bool m_bFpsTimer; // timer option
+	HANDLE m_hFpsTimer; // waitable timer
+	LONG64 m_FpsDeadline; // counter value at the end of the frame time
+	bool HoldFpsTimer(double target);
+	void WaitDeadline(LONG64 deadline);
+
 	// Sync event
 	bool m_bFrameSync;
 	HANDLE m_hSyncEvent;
 	void OpenFrameSync(const char* SenderName);
+	HANDLE m_hWaitSyncEvent; // sync event opened by WaitFrameSyncUID
+	uint64_t m_WaitSyncUID; // sender ID of the event
+
+	// Shared fence
+	bool m_bFenceSync; // shared fence option
+	bool m_bFenceOnly; // shared fence without the access mutex
+	bool m_bFenceSender; // the fence was created by this sender
+	ID3D11Fence* m_pSharedFence;
+	ID3D11DeviceContext4* m_pFenceContext;
+	HANDLE m_hSharedFence; // NT handle (sender)
+	UINT64 m_FenceValue;
+	SpoutSharedMemory m_FenceMemory;
+
+	// Dirty rectangles
+	bool m_bDirtySender; // the map was created by this sender
+	LONG64 m_DirtyFrame; // last frame written or read
+	unsigned int m_DirtyRetry; // receiver calls until the next map open attempt
+	RECT m_DirtyPending[SPOUT_MAX_DIRTY_RECTS]; // sender rectangles for the next frame
+	unsigned int m_nDirtyPending;
+	RECT m_DirtyHistory[SPOUT_DIRTY_HISTORY][SPOUT_MAX_DIRTY_RECTS]; // receiver rectangles of recent frames
+	unsigned int m_nDirtyHistory[SPOUT_DIRTY_HISTORY];
+	unsigned int m_DirtyHead; // history index of the last frame
+	unsigned int m_DirtyFrames; // consecutive frames with known changes
+	SpoutSharedMemory m_DirtyMemory;
+	bool OpenDirtyRects(const char* SenderName);
+	void WriteDirtyRects();
+
+	// Frame slices
+	bool m_bSliceSender; // the map was created by this sender
+	LONG64 m_SliceFrame; // frame of the slices being sent
+	unsigned int m_SliceRetry; // receiver calls until the next map open attempt
+	SpoutSharedMemory m_SliceMemory;
+
+	// Frame data
+	bool m_bDataSender; // the map was created by this sender
+	unsigned int m_DataRetry; // receiver calls until the next map open attempt
+	SpoutSharedMemory m_DataMemory;
+	bool OpenFrameData(const char* SenderName);
+
+	// Telemetry
+	bool m_bTelemetry; // telemetry option
+	char m_TelemetryName[256]; // sender name recorded
+	int m_TelemetryMode; // share mode recorded
+	uint64_t m_TelemetryMemoryBytes; // memory recorded
+	unsigned int m_TelemetryRetry; // calls until the next entry claim attempt
+	SpoutTelemetryEntry* m_pTelemetry; // entry of this sender or receiver
+	SpoutSharedMemory m_TelemetryMemory;
+	bool OpenTelemetry();
+	void WriteTelemetry(uint32_t role);
+	void CloseTelemetry();
+	static bool IsProcessRunning(DWORD dwProcessId);
+
+	// Frame clock
+	SpoutSharedMemory m_ClockMemory;
+	SpoutFrameClock* m_pClock; // clock in the map
+	bool m_bClockMaster; // the clock was created by this process
+	LONG64 m_ClockTick; // last tick published or waited for
+	bool ReadFrameClock(LONG64 &tick, LONG64 &time, LONG64 &period);
+
+	// Frame acknowledgement
+	SpoutSharedMemory m_AckMemory;
+	SpoutFrameAck* m_pAck; // acknowledgements in the map
+	SpoutAckEntry* m_pAckEntry; // entry of this receiver
+	HANDLE m_hAckEvent; // set by receivers after an acknowledgement
+	char m_AckSenderName[256]; // sender of the map
+	bool OpenFrameAck(const char* SenderName);
+
+	// Control messages
+	SpoutSharedMemory m_MessageMemory;
+	SpoutMessages* m_pMessages; // rings in the map
+	int m_MessageRing; // ring written by this process
+	HANDLE m_hMessageEvent[2]; // set by the producer of each ring
 
 #ifdef USE_CHRONO
 
@@ -164,6 +164,153 @@
 //		14.12.23	- WriteGLDXpixels - return WriteGLDXtexture instead of true
 //					- CreateOpenGL return false if extensions fail to load
 //	Version 2.007.013
+//		14.10.26	- ReadDX11texture, ReadDX11pixels - ring of up to 4 staging textures
+//					  so that the copy of a new frame does not block mapping of an earlier one.
+//					  Add SetStagingBuffers/GetStagingBuffers and ReleaseStagingTextures.
+//					- Add sender change count members for ReceiveSenderData
+//					- ReadGLDXpixels, WriteGLDXpixels - optional compute shader conversion
+//					  Add SetComputeConversion/GetComputeConversion,
+//					  UnloadComputePixels and LoadComputePixels
+//					- ReadGLDXpixels - resample on the GPU if the pixel buffer is a 
+//					  different size than the sender. Add SetResampleMode/GetResampleMode
+//					- Add CopyTextureRegion and ReadGLDXtexture for a region of the
+//					  shared texture. CopyTexture calls CopyTextureRegion.
+//					- ReadDX11pixels - copy and read only the changed regions
+//					  if the sender publishes dirty rectangles
+//					- Add spoutTimer "timer" for scoped timing of WriteGLDXtexture, ReadGLDXtexture,
+//					  ReadDX11pixels, texture access, interop lock/unlock and pixel copy
+//					- WriteGLDXtexture, ReadGLDXtexture and staging map TraceLogging events
+//					- Initialize m_SharedGeneration for Spout::ReceiveSenderData
+//					- CheckStagingTextures - staging textures from the spoutDirectX
+//					  process pool. ReleaseStagingTextures returns them to the pool.
+//					- Add interop group functions AddInteropSender, RemoveInteropSender,
+//					  LockInteropSenders and UnlockInteropSenders to link the textures
+//					  of a number of senders with the class interop device and lock
+//					  or unlock them all with one call for each frame.
+//					  CleanupInterop releases the group objects before the device.
+//					- Add SetSharedInterop/GetSharedInterop for a process interop context.
+//					  Instances on the same OpenGL context share one DirectX 11 device
+//					  and GL/DX interop device, reference counted by OpenDirectX and CleanupDX11.
+//					  OpenInteropDevice and CloseInteropDevice used throughout.
+//					- UnloadTexturePixels - optional persistent mapped PBOs created by
+//					  glBufferStorage and read after a fence for each buffer instead
+//					  of map and unmap for every frame. Add SetPersistentBufferMode,
+//					  GetPersistentBufferMode, IsPersistentBufferAvailable,
+//					  UnloadPersistentPixels and ReleasePersistentBuffers.
+//					- WriteGLDXpixels - upload pixels by a ring of unpack PBOs (LoadTexturePixels)
+//					  if buffering is enabled, persistent mapped if SetPersistentBufferMode.
+//					- WriteDX11pixels - write to a ring of staging textures mapped with
+//					  D3D11_MAP_FLAG_DO_NOT_WAIT, using the next if one is still in use.
+//					  WritePixelData - map for write with optional map flags.
+//					- ReadPixelData - convert 10 bit and half float staging textures
+//					  to 8 bit pixels by the spoutCopy high bit depth functions.
+//					- Memory share ring "<sendername>_memring" of frame slots with
+//					  sequence numbers. WriteMemoryPixels writes a free slot and
+//					  ReadMemoryPixels and ReadMemoryTexture read the latest complete
+//					  slot without the map mutex. The 2.006 locked map is read
+//					  if the sender has no ring. WriteMemoryPixels - correct map creation.
+//					- Add SetMemoryLargePages and GetMemoryLargePages
+//					- Add CreateFrameData, WriteFrameData and ReadFrameData
+//					- Add LockMemoryBuffer, UnlockMemoryBuffer
+//					- CreateMemoryRing - allow a ring larger than 2GB
+//					- GLDXready - record the compatibility test result in the registry
+//					  for the adapter, driver version and OpenGL renderer and use it
+//					  instead of repeating the test. OpenSpout(true) repeats the test.
+//					- Constructor - do not load extensions. They are loaded by OpenSpout
+//					  or when first queried.
+//					- ReadDX11texture - do not read back the staging texture if there
+//					  is no new frame. The receiving texture is unchanged.
+//					- ReadMemoryTexture - check for a new frame as for ReadMemoryPixels
+//					- BindSharedTexture - keep the sender mutex locked until
+//					  UnBindSharedTexture and do not unlock the interop object
+//					  if it could not be locked. Add spoutSharedTextureScope.
+//					- Retain framebuffers with textures attached for copy so that
+//					  textures are not attached and detached for every frame.
+//					  Use direct state access if available.
+//					  Add SetFramebufferCache, GetFramebufferCache, RemoveFramebufferCache.
+//					- CopyTextureRegion - use glCopyImageSubData if there is no invert
+//					  and the formats are compatible. The method is recorded for each
+//					  pair of formats. Use the compute shader copy for invert if there
+//					  is no fbo blit and both textures are GL_RGBA8.
+//					- UnloadTexturePixels, UnloadComputePixels - record PBO sizes
+//					  instead of querying them for every frame
+//					- Add SetStateShadow, SetHostViewport to avoid OpenGL state and
+//					  error queries for each frame
+//					- Add SetDebugOutput for asynchronous OpenGL error reporting (KHR_debug).
+//					  No glGetError for each frame in release builds.
+//					- UnloadTexturePixels, UnloadComputePixels - PBOs are not deleted for
+//					  a size change. The data store is allocated with headroom (GetPboAllocation).
+//					- CheckOpenGLTexture - use a pool of immutable textures by size
+//					  and format instead of deleting and re-creating the class texture.
+//					  Add ReleaseTexturePool.
+//					- Initialize m_bPreconnect for Spout::SetPreconnect
+//					- Add m_ArraySize for array texture senders. CreateInterop links
+//					  an array texture to GL_TEXTURE_2D_ARRAY. WriteGLDXtexture and
+//					  ReadGLDXtexture copy the views with CopyTextureLayers.
+//					  Pixel reads use the first view (spoutDirectX::CopySharedTexture).
+//					  LinkGLDXtextures - add texture target argument.
+//					- Add EnableGPUTiming. GL_TIMESTAMP queries record the GPU time
+//					  of shared texture copies and shaders, and DirectX timestamp
+//					  queries the time of staging copies, in the timer.
+//		15.10.26	- Add SetComputeRGB. ReadGLDXpixels to an RGB buffer packs
+//					  the pixels by compute shader before the PBO read.
+//					- Add ReadGLDXyuv and UnloadComputeYUV for planar NV12 or I420
+//					  pixels converted by compute shader before the PBO read.
+//					- CheckInteropSender - open sender textures shared by a named NT handle
+//					- Add SetMemoryObject to link the shared texture by memory object
+//					  (EXT_memory_object_win32) and synchronise with a DirectX fence imported
+//					  as a semaphore (EXT_semaphore_win32) instead of the interop lock.
+//					  NV_DX_interop is used if the extensions or the texture format are not
+//					  supported. Add ReleaseInteropObject and IsMEMORYavailable.
+//					- WritePixelData, ReadPixelData - use spoutCopy::ConvertPixels
+//					  to select the conversion for the pixel buffer and texture formats.
+//					- Add OpenHeadless and IsHeadless. ReceiveImage without an OpenGL context
+//					  uses DirectX and shared memory only.
+//					- ReadMemoryPixels - convert to BGRA, RGB or BGR pixels
+//					- Add share mode 3 (auto) to GetShareMode and SetShareMode.
+//					  CalibrateShareMode times texture and CPU share at the sender size
+//					  and records the faster for the adapter and driver version.
+//					- Add SetIdleTrim and TrimResources. CheckResources releases retained
+//					  textures after a time without frames or if video memory usage
+//					  exceeds the budget.
+//					- Add GetMemoryUsage for the textures, buffers and shared memory
+//					  held by a sender or receiver. CheckTelemetryMemory records the
+//					  total with telemetry.
+//					- WriteGLDXtexture - publish a content hash of the shared texture
+//					  with the frame if the content hash option is enabled.
+//					- ReleaseStagingTextures - unmap a staging texture mapped by ReceiveImageView
+//					- Add named data channels (CreateDataChannel, WriteDataChannel,
+//					  ReadDataChannel) with a retained map for each channel
+//					- WriteGLDXpixels, WriteDX11pixels, WritePixelData - optional
+//					  source line pitch for images with padding
+//					- ReadDX11pixels, ReadPixelData - optional destination line pitch
+//					- Add WriteSendReadback, PollSendReadback and ReleaseSendReadback
+//					  for CPU read back of the frames sent without waiting (SetSendReadback)
+//					- Memory ring slot address by SpoutMemoryRingSlot for a ring
+//					  with slots at an offset written by the D3D12 copy queue
+//					- ReadGLDXtexture - analyze the linked texture after the copy
+//					  if enabled (SetReceiveAnalysis, ReadAnalysis)
+//					- CleanupGL - delete the framebuffer used by Spout::BeginFrame
+//					- Add SetPinnedMemoryMode. UnloadTexturePixels and ReadTextureData
+//					  read directly to a stable application buffer pinned as the
+//					  store of a pixel buffer (GL_AMD_pinned_memory).
+//					- Add SetToneMapping. ReadGLDXtexture and ReadGLDXpixels tone map
+//					  a floating point sender to an 8 bit texture before the copy or read.
+//					- Add SetMemoryCompression. WriteMemoryPixels compresses memory ring
+//					  frames (spoutCopy::EncodePixels) while that takes less time than
+//					  writing the pixels. BeginMemoryRingRead decompresses them.
+//					- Trace the pixel conversion of staging texture writes and reads
+//					  for the flight recorder (SpoutUtils).
+//					- SetComputeRGB - default false. Compute shader RGB packing is optional.
+//					- Memory share ring - senders in 2.006 memory share mode write to the
+//					  ring (WriteMemoryPixels, WriteMemoryTexture). The ring name has the
+//					  frame size and a new ring is created for a different size.
+//					  Data sharing functions are available in memory share mode.
+//					- Add SetMemoryRingSend. Senders write to the memory ring only if set
+//					  for the sender. The user 2.006 memory share mode is again for
+//					  receivers only and the data sharing functions are not available.
+//					- ReadDX11texture - receive the frame again if access to the shared
+//					  texture times out after checking for a new frame.
 //
 // ====================================================================================
 //
@@ -192,6 +339,25 @@
 
 #include "SpoutGL.h"
 
+//
+// Process interop contexts
+//
+// Instances that enable SetSharedInterop use one DirectX 11 device
+// and one GL/DX interop device for each OpenGL context of the process,
+// for example plugins of the same host. This avoids device creation
+// for every instance, driver memory for each device and synchronization
+// between devices. The context is released with the last instance.
+//
+#define SPOUT_INTEROP_CONTEXTS 8
+struct SpoutInteropContext {
+	HGLRC hRc; // OpenGL context
+	spoutDirectX* pdx; // Owner of the shared DirectX device
+	HANDLE hInteropDevice; // Shared GL/DX interop device
+	LONG refs; // Number of instances using the context
+};
+static SpoutInteropContext g_InteropContexts[SPOUT_INTEROP_CONTEXTS]={};
+static SRWLOCK g_InteropContextLock = SRWLOCK_INIT;
+
 // ================================================
 
 
@@ -205,19 +371,49 @@ spoutGL::spoutGL()
 	m_SenderNameSetup[0] = 0;
 	m_Width = 0;
 	m_Height = 0;
+	m_ArraySize = 1;
 
 	m_bAuto = true;
 	m_bCPU = false;
 	m_bUseGLDX = true;
 	m_bTextureShare = true;
 	m_bCPUshare = false; // Texture share assumed by default
+	m_bHeadless = false;
 	m_bSenderCPU = false;
 	m_bSenderGLDX = true;
 	
 	m_bConnected = false;
 	m_bInitialized = false;
+	m_bSenderFound = false;
+	m_SenderGeneration = 0;
+	m_dwSenderCheck = 0;
+	m_SharedGeneration = 0;
+	m_SenderInfoChange = 0;
+	m_SenderInfoGeneration = 0;
+	m_dwSenderInfoCheck = 0;
+	m_bPreconnect = false;
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		m_pInteropSenders[i] = nullptr;
+		m_hInteropLocked[i] = nullptr;
+	}
+	m_nInteropLocked = 0;
+	m_InteropGeneration = 0;
+	m_dwInteropCheck = 0;
+	m_bSharedInterop = false;
+	m_SharedInterop = -1;
+	m_bMemoryObject = false;
+	m_glMemoryObject = 0;
+	m_glSemaphore = 0;
+	m_pInteropFence = nullptr;
+	m_pInteropFenceContext = nullptr;
+	m_hInteropFence = nullptr;
+	m_InteropFenceValue = 0;
 	m_bSpoutPanelOpened = false;
 	m_bSpoutPanelActive = false;
+	ZeroMemory(&m_ShExecInfo, sizeof(m_ShExecInfo));
+	m_hSpoutPanelWait = NULL;
+	m_SpoutPanelClosed = 0;
+	m_SelectedSender[0] = 0;
 	m_bUpdated = false;
 	m_bMirror = false;
 	m_bSwapRB = false;
@@ -228,16 +424,48 @@ spoutGL::spoutGL()
 	m_TexWidth = 0;
 	m_TexHeight = 0;
 	m_TexFormat = GL_RGBA;
+	ZeroMemory(m_TexPool, sizeof(m_TexPool));
+	m_TexPoolUsed = 0;
+	m_dwIdleTrim = 60000;
+	m_dwLastFrame = GetTickCount();
+	m_bTrimmed = false;
+	m_dwMemoryTime = 0;
 	m_fbo = 0;
+	m_SharedFbo = 0;
+	ZeroMemory(m_TextureFbo, sizeof(m_TextureFbo));
+	m_TextureFboUsed = 0;
+	m_bFramebufferCache = false;
+	ZeroMemory(m_CopyFormat, sizeof(m_CopyFormat));
+	m_nCopyFormats = 0;
+	m_bStateShadow = false;
+	ZeroMemory(m_HostViewport, sizeof(m_HostViewport));
+	m_bDebugOutput = false;
+
+	// GPU timing
+	m_bGPUTiming = false;
+	ZeroMemory(m_glQuery, sizeof(m_glQuery));
+	ZeroMemory(m_glQueryName, sizeof(m_glQueryName));
+	m_glQueryWrite = 0;
+	m_glQueryRead = 0;
+	m_glQueryPending = 0;
+	m_glScopeDepth = 0;
+	m_bGLScope = false;
 
 	m_dxShareHandle = NULL; // Shared texture handle
 	m_pSharedTexture = nullptr; // DX11 shared texture
 	m_DX11format = DXGI_FORMAT_B8G8R8A8_UNORM; // Default compatible with DX9
 	m_dwFormat = m_DX11format;
-	m_pStaging[0] = nullptr; // DX11 staging textures
-	m_pStaging[1] = nullptr;
+	m_pStaging[0] = m_pStaging[1] = nullptr; // DX11 staging textures
+	m_pStaging[2] = m_pStaging[3] = nullptr;
 	m_Index = 0;
 	m_NextIndex = 0;
+	m_WriteIndex = 0;
+	m_nStaging = 1; // Single staging texture for ReadDX11texture by default
+	m_pMappedStaging = nullptr;
+	m_pDirtyPixels = nullptr;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++)
+		m_DataChannels[i] = {};
+	m_bDirtyInvert = false;
 
 	m_hInteropDevice = NULL;
 	m_hInteropObject = NULL;
@@ -259,13 +487,73 @@ spoutGL::spoutGL()
 	m_bCOPYavailable = false;
 	m_bPBOavailable = true; // Assume true until tested by LoadGLextensions
 	m_bCONTEXTavailable = false;
+	m_bDSAavailable = false;
+	m_bMEMORYavailable = false;
+	m_bPINNEDavailable = false;
 
 	// PBO support
 	PboIndex = 0;
 	NextPboIndex = 0;
 	m_pbo[0] = m_pbo[1] = m_pbo[2] = m_pbo[3] = 0;
+	ZeroMemory(m_pboSize, sizeof(m_pboSize));
+	m_pboAlloc = 0;
 	m_nBuffers = 2; // default number of buffers used
 
+	// Persistent mapped PBOs
+	m_bPersistentPbo = false;
+	for (int i = 0; i < 4; i++) {
+		m_persistentPbo[i] = 0;
+		m_pPersistentMap[i] = nullptr;
+		m_persistentSync[i] = nullptr;
+	}
+	m_persistentSize = 0;
+	m_nPersistent = 0;
+	m_persistentIndex = 0;
+
+	// Pinned memory PBO
+	m_bPinnedMemory = false;
+	m_pinnedPbo = 0;
+	m_pPinnedData = nullptr;
+	m_pinnedSize = 0;
+	m_bPinnedFailed = false;
+
+	// Unpack PBOs
+	for (int i = 0; i < 4; i++) {
+		m_unpackPbo[i] = 0;
+		m_pUnpackMap[i] = nullptr;
+		m_unpackSync[i] = nullptr;
+	}
+	m_unpackSize = 0;
+	m_nUnpack = 0;
+	m_unpackIndex = 0;
+	m_bUnpackPersistent = false;
+
+	// Compute shader pixel conversion
+	m_pShaders = nullptr;
+	m_ssbo = 0;
+	m_ssboSize = 0;
+	m_bComputeConversion = false;
+	m_bContentHash = false;
+	m_bReceiveAnalysis = false;
+	m_bSendReadback = false;
+	m_ReadbackCallback = nullptr;
+	m_pReadbackUserData = nullptr;
+	for (int i = 0; i < SPOUT_READBACK_STAGING; i++) {
+		m_pReadbackStaging[i] = nullptr;
+		m_ReadbackFrame[i] = 0;
+		m_bReadbackPending[i] = false;
+	}
+	m_ReadbackIndex = 0;
+	m_ReadbackLatest = -1;
+	m_ReadbackLastRead = -1;
+	m_bComputeRGB = false;
+	m_resampleTexture = 0;
+	m_resampleWidth = 0;
+	m_resampleHeight = 0;
+	m_ResampleMode = 1; // bilinear
+	m_ToneMap = SPOUT_TONEMAP_NONE;
+	m_ToneMapExposure = 1.0f;
+
 	// Check the user selected Auto share mode
 	DWORD dwValue = 0;
 	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Auto", &dwValue))
@@ -275,6 +563,11 @@ spoutGL::spoutGL()
 	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "CPU", &dwValue))
 		m_bCPU = (dwValue == 1);
 
+	// Check the user selected share mode by measured performance
+	m_bCalibrate = false;
+	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Calibrate", &dwValue))
+		m_bCalibrate = (dwValue == 1);
+
 	// Check the user selected buffering mode
 	if (ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Buffering", &dwValue))
 		m_bPBOavailable = (dwValue == 1);
@@ -301,9 +594,16 @@ spoutGL::spoutGL()
 	// Only set if 2.006 SpoutSettings has been used
 	// Removed by 2.007 SpoutSettings
 	m_bMemoryShare = GetMemoryShareMode();
+	m_MemoryRingFrame = 0;
+	m_bMemoryCompress = false;
+	m_bMemoryCompressed = false;
+	m_bMemoryRingSend = false;
+	m_MemoryRawTime = 0.0;
+	m_MemoryCodecTime = 0.0;
+	m_MemoryCodecFrames = 0;
 
-	// Extensions are loaded in OpenSpout() if a context is not available here
-	LoadGLextensions();
+	// Extensions are loaded by OpenSpout() for the first send or receive,
+	// or when first queried, so that construction is fast.
 
 }
 
@@ -329,15 +629,21 @@ spoutGL::~spoutGL()
 
 		// Close 2.006 or buffer shared memory if used
 		memoryshare.Close();
+		CloseMemoryRing();
+		CloseDataChannels();
 
 		// Release sync event if used
 		frame.CloseFrameSync();
 
-		// Release interop
+		// Release interop group senders and interop
+		RemoveInteropSenders();
 		CleanupInterop();
 
 		// Release OpenGL resources 
 		CleanupGL();
+		ReleaseTexturePool();
+		if (m_pShaders) delete m_pShaders;
+		m_pShaders = nullptr;
 
 		// Finally release DirectX resources and device
 		CleanupDX11();
@@ -368,15 +674,14 @@ bool spoutGL::BindSharedTexture()
 			// Bind our shared OpenGL texture
 			glBindTexture(GL_TEXTURE_2D, m_glTexture);
 			// Leave interop and mutex both locked for success
+			// They are released by UnBindSharedTexture
 			bRet = true;
 		}
 		else {
-			// Release interop lock and allow texture access for fail
-			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+			// Release mutex and allow texture access for fail
+			frame.AllowTextureAccess(m_pSharedTexture);
 			bRet = false;
 		}
-		// Release mutex and allow access to the texture
-		frame.AllowTextureAccess(m_pSharedTexture);
 	}
 
 	return bRet;
@@ -471,6 +776,213 @@ bool spoutGL::IsGLDXready()
 	return m_bUseGLDX;
 }
 
+//---------------------------------------------------------
+// Function: IsHeadless
+// Receiving by DirectX without OpenGL (see OpenHeadless)
+bool spoutGL::IsHeadless()
+{
+	return m_bHeadless;
+}
+
+//---------------------------------------------------------
+// Function: SetSharedInterop
+// Share DirectX and GL/DX interop devices with other instances.
+//
+// Instances on the same OpenGL context that enable shared interop
+// use the same DirectX 11 device and GL/DX interop device.
+// The immediate context of the device is shared, so the instances
+// must be used from the thread of the OpenGL context.
+// Set before the first send or receive. A device already
+// created is not changed until it is released.
+void spoutGL::SetSharedInterop(bool bShared)
+{
+	m_bSharedInterop = bShared;
+}
+
+//---------------------------------------------------------
+// Function: GetSharedInterop
+// Shared interop devices enabled
+bool spoutGL::GetSharedInterop()
+{
+	return m_bSharedInterop;
+}
+
+//---------------------------------------------------------
+// Function: SetMemoryObject
+// Link the shared texture by memory object instead of NV_DX_interop.
+//
+// The DirectX shared texture is imported to OpenGL as a memory object
+// (EXT_memory_object_win32) and access is synchronised on the GPU by a
+// DirectX fence imported as an OpenGL semaphore (EXT_semaphore_win32).
+// There is no interop lock and unlock for each frame.
+//
+// NV_DX_interop is used if the extensions are not available or
+// for texture formats with a different channel order in OpenGL,
+// including the default DXGI_FORMAT_B8G8R8A8_UNORM. Use
+// SetDX11format(DXGI_FORMAT_R8G8B8A8_UNORM) for a sender.
+// Takes effect when the shared texture is next linked.
+void spoutGL::SetMemoryObject(bool bMemory)
+{
+	m_bMemoryObject = bMemory;
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryObject
+// Memory object option
+bool spoutGL::GetMemoryObject()
+{
+	return m_bMemoryObject;
+}
+
+//---------------------------------------------------------
+// Function: IsMemoryObject
+// Shared texture linked by memory object
+bool spoutGL::IsMemoryObject()
+{
+	return (m_hInteropObject == SPOUT_INTEROP_MEMORY);
+}
+
+//
+// Group: Resources
+//
+// Textures of the class texture pool, the process staging texture pool
+// and sender textures opened for re-use are retained after a receiver
+// has disconnected. They are released after a time without frames
+// (SetIdleTrim) or at once if video memory usage exceeds the budget
+// of the adapter. Resources in use by a connected receiver are not
+// released for the budget. They are re-created when required.
+//
+
+//---------------------------------------------------------
+// Function: SetIdleTrim
+// Release retained resources after a time without frames.
+//   msec - 0 to disable (default 60000)
+void spoutGL::SetIdleTrim(DWORD dwMsec)
+{
+	m_dwIdleTrim = dwMsec;
+}
+
+//---------------------------------------------------------
+// Function: GetIdleTrim
+// Time without frames before retained resources are released
+DWORD spoutGL::GetIdleTrim()
+{
+	return m_dwIdleTrim;
+}
+
+//---------------------------------------------------------
+// Function: TrimResources
+// Release retained resources and trim the DirectX device.
+// Call when the application is suspended or minimized.
+void spoutGL::TrimResources()
+{
+	SpoutLogNotice("spoutGL::TrimResources");
+
+	if (wglGetCurrentContext()) {
+		ReleaseTexturePool();
+		ReleaseUnpackBuffers();
+	}
+	// Staging textures are released if not connected
+	if (!m_pSharedTexture)
+		ReleaseStagingTextures();
+
+	spoutdx.TrimDevice();
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryUsage
+// Memory held by this sender or receiver by category and heap.
+//
+// Shared, class and pool textures are in video memory. Staging textures and
+// OpenGL pixel buffers are counted as system memory. Shared memory maps
+// are counted by their size. The figures are found from the resources
+// held at the time of the query, so are current after any are created or released.
+// The process staging pool and shared textures retained by OpenSharedTexture
+// are shared by all senders and receivers and are not included.
+bool spoutGL::GetMemoryUsage(SpoutMemoryUsage& usage)
+{
+	usage = {};
+
+	// DirectX textures
+	spoutdx.AddTextureUsage(usage, m_pSharedTexture);
+	for (int i = 0; i < 4; i++)
+		spoutdx.AddTextureUsage(usage, m_pStaging[i]);
+
+	// OpenGL textures
+	UINT64 bytes = 0;
+	for (int i = 0; i < SPOUT_TEXTURE_POOL; i++) {
+		if (m_TexPool[i].id > 0)
+			bytes += spoutdx.GetTextureBytes(m_TexPool[i].width, m_TexPool[i].height, DX11format(m_TexPool[i].format));
+	}
+	if (m_TexID > 0 && !IsPoolTexture(m_TexID))
+		bytes += spoutdx.GetTextureBytes(m_TexWidth, m_TexHeight, DX11format((GLint)m_TexFormat));
+	if (m_resampleTexture > 0)
+		bytes += spoutdx.GetTextureBytes(m_resampleWidth, m_resampleHeight, DXGI_FORMAT_R8G8B8A8_UNORM);
+	usage.textures += bytes;
+	usage.video += bytes;
+
+	// OpenGL pixel buffers
+	bytes = 0;
+	for (int i = 0; i < 4; i++) {
+		if (m_pbo[i] > 0) bytes += (UINT64)m_pboAlloc;
+		if (m_unpackPbo[i] > 0) bytes += (UINT64)m_unpackSize;
+		if (m_persistentPbo[i] > 0) bytes += (UINT64)m_persistentSize;
+	}
+	if (m_ssbo > 0)
+		bytes += (UINT64)m_ssboSize;
+	usage.buffers += bytes;
+	usage.system += bytes;
+
+	// Shared memory
+	bytes = (UINT64)memoryshare.Size64() + (UINT64)m_MemoryRing.Size64();
+	usage.maps += bytes;
+	usage.sharedmap += bytes;
+
+	usage.total = usage.video + usage.system + usage.sharedmap;
+
+	return (usage.total > 0);
+}
+
+// Release retained resources after a time without frames
+// or pools first if video memory usage exceeds the budget
+void spoutGL::CheckResources(bool bFrame)
+{
+	const DWORD dwNow = GetTickCount();
+	if (bFrame) {
+		m_dwLastFrame = dwNow;
+		m_bTrimmed = false;
+	}
+	else if (m_dwIdleTrim > 0 && !m_bTrimmed && (dwNow - m_dwLastFrame) > m_dwIdleTrim) {
+		SpoutLogNotice("spoutGL::CheckResources - no frames for %u msec", dwNow - m_dwLastFrame);
+		TrimResources();
+		m_bTrimmed = true;
+	}
+
+	if (spoutdx.CheckMemoryBudget()) {
+		if (wglGetCurrentContext())
+			ReleaseTexturePool();
+		spoutdx.ReleaseStagingPool(spoutdx.GetDX11Device());
+		spoutdx.ReleaseSharedTextures(spoutdx.GetDX11Device());
+	}
+
+	CheckTelemetryMemory();
+}
+
+// Record the memory held with telemetry once a second
+void spoutGL::CheckTelemetryMemory()
+{
+	if (!frame.IsTelemetryEnabled())
+		return;
+
+	const DWORD dwNow = GetTickCount();
+	if ((dwNow - m_dwMemoryTime) > 1000) {
+		SpoutMemoryUsage usage;
+		GetMemoryUsage(usage);
+		frame.SetTelemetryMemory(usage.total);
+		m_dwMemoryTime = dwNow;
+	}
+}
+
 //
 // Group: For direct access if necessary
 //
@@ -530,6 +1042,7 @@ bool spoutGL::OpenSpout(bool bRetest)
 	m_bUseGLDX = false;
 	m_bTextureShare = false;
 	m_bCPUshare = false;
+	m_bHeadless = false;
 
 	// DirectX capability is the minimum
 	if (!OpenDirectX()) {
@@ -583,7 +1096,7 @@ bool spoutGL::OpenSpout(bool bRetest)
 	//   Neither method  - do not process at all
 	//
 
-	if (GLDXready()) {
+	if (GLDXready(!bRetest)) {
 		// GL/DX compatible -  m_bUseGLDX is set true
 		SpoutLogNotice("    GL/DX interop compatible");
 	}
@@ -624,12 +1137,57 @@ bool spoutGL::OpenSpout(bool bRetest)
 
 }
 
+//---------------------------------------------------------
+// Function: OpenHeadless
+// Initialize DirectX only for CPU receive without an OpenGL context.
+//
+// Used by ReceiveImage if no OpenGL context is current, so that services
+// and applications without a desktop can receive pixels without the
+// window and OpenGL context of CreateOpenGL. OpenGL extensions are not
+// loaded. Sender textures are read by DirectX staging textures and
+// 2.006 memoryshare senders from shared memory.
+//
+// If an OpenGL context is created later, OpenSpout(true) re-tests
+// for texture sharing.
+bool spoutGL::OpenHeadless()
+{
+	if (spoutdx.GetDX11Device() != nullptr)
+		return true;
+
+	SpoutLog("");
+	SpoutLogNotice("spoutGL::OpenHeadless - DirectX without OpenGL - this 0x%.7X", PtrToUint(this));
+
+	// The shared interop device requires OpenGL
+	if (!spoutdx.OpenDirectX11()) {
+		SpoutLogFatal("spoutGL::OpenHeadless - Could not initialize DirectX 11");
+		return false;
+	}
+
+	m_bUseGLDX = false;
+	m_bTextureShare = false;
+	m_bCPUshare = true;
+	m_bHeadless = true;
+
+	SpoutLogNotice("    Using CPU DirectX methods");
+
+	return true;
+}
+
 //---------------------------------------------------------
 // Function: OpenDirectX
 // Initialize DirectX (D3D11 only)
 bool spoutGL::OpenDirectX()
 {
 	SpoutLogNotice("spoutGL::OpenDirectX");
+
+	// The device of the process interop context is
+	// used as an external device by the spoutDirectX class
+	if (m_bSharedInterop && !spoutdx.GetDX11Device()) {
+		ID3D11Device* pDevice = AcquireSharedInterop();
+		if (pDevice)
+			return spoutdx.OpenDirectX11(pDevice);
+	}
+
 	return spoutdx.OpenDirectX11();
 }
 
@@ -1013,7 +1571,7 @@ bool spoutGL::IsSpoutInitialized()
 //
 //	o m_bUseGLDX - true for GL/DX interop availability
 //
-bool spoutGL::GLDXready()
+bool spoutGL::GLDXready(bool bCache)
 {
 	// === Simulate failure for debugging ===
 	// SpoutLogNotice("spoutGL::GLDXready - simulated compatibility failure");
@@ -1035,6 +1593,27 @@ bool spoutGL::GLDXready()
 		return m_bUseGLDX;
 	}
 
+	//
+	// The result of the last test is recorded in the registry with the
+	// graphics adapter IDs, driver version and OpenGL renderer.
+	// For the same graphics, use the result instead of repeating the test.
+	// The adapter LUID is not used because it changes when the system restarts.
+	//
+	char gldxkey[MAX_PATH]={};
+	const bool bKey = m_bGLDXavailable && GetGLDXkey(gldxkey, MAX_PATH);
+	if (bCache && bKey) {
+		char recorded[MAX_PATH]={};
+		DWORD dwGLDX = 0;
+		if (ReadPathFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "GLDXkey", recorded, MAX_PATH)
+			&& strcmp(recorded, gldxkey) == 0
+			&& ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "GLDX", &dwGLDX)) {
+			m_bUseGLDX = (dwGLDX == 1);
+			m_bGLDXdone = true;
+			SpoutLogNotice("spoutGL::GLDXready - recorded result (%s)", m_bUseGLDX ? "compatible" : "not compatible");
+			return m_bUseGLDX;
+		}
+	}
+
 	//
 	// Test whether the NVIDIA OpenGL/DirectX interop extensions function correctly.
 	//
@@ -1104,9 +1683,8 @@ bool spoutGL::GLDXready()
 		// Release the interop objects created for the test
 		// They are re-created in CreateInterop
 		wglDXUnregisterObjectNV(m_hInteropDevice, m_hInteropObject);
-		wglDXCloseDeviceNV(m_hInteropDevice);
 		m_hInteropObject = nullptr;
-		m_hInteropDevice = nullptr;
+		CloseInteropDevice();
 
 		// Release the test textures after the interop objects have been released
 		spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), pTexture);
@@ -1150,10 +1728,164 @@ bool spoutGL::GLDXready()
 	// Set a class flag so the test is not repeated
 	m_bGLDXdone = true;
 
+	// Record the result for these graphics
+	if (bKey) {
+		WritePathToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "GLDXkey", gldxkey);
+		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "GLDX", m_bUseGLDX ? 1 : 0);
+	}
+
 	return m_bUseGLDX;
 
 }
 
+//---------------------------------------------------------
+// Function: CalibrateShareMode
+// Select texture or CPU share by measured performance.
+//
+// For share mode 3 (see SetShareMode), a sender or receiver times
+// each available method for a few frames at the sender size and
+// uses the faster. Applies only if the system is GL/DX compatible
+// and CPU mode has not been forced.
+//
+// The result is recorded in the registry for the graphics adapter,
+// driver version and resolution, so the timing is done only once.
+// A different driver version clears the results for the adapter
+// and the methods are timed again.
+//
+// Memory share is not timed because it is for receiving from
+// 2.006 senders only.
+bool spoutGL::CalibrateShareMode(unsigned int width, unsigned int height)
+{
+	if (!m_bCalibrate || !m_bUseGLDX || m_bCPU || m_bHeadless || width == 0 || height == 0)
+		return false;
+
+	if (!spoutdx.GetDX11Device() || !wglGetCurrentContext())
+		return false;
+
+	// Graphics identity "VVVV-DDDD-SSSSSSSS-driver renderer"
+	char gldxkey[MAX_PATH]={};
+	if (!GetGLDXkey(gldxkey, MAX_PATH))
+		return false;
+
+	// Results for each adapter are recorded under a subkey of the adapter IDs
+	char subkey[MAX_PATH]={};
+	sprintf_s(subkey, MAX_PATH, "Software\\Leading Edge\\Spout\\Calibration\\%.18s", gldxkey);
+	char resolution[32]={};
+	sprintf_s(resolution, 32, "%dx%d", width, height);
+
+	// Use the recorded result for the same driver and resolution
+	char recorded[MAX_PATH]={};
+	DWORD dwMode = 0;
+	if (ReadPathFromRegistry(HKEY_CURRENT_USER, subkey, "Key", recorded, MAX_PATH)
+		&& strcmp(recorded, gldxkey) == 0) {
+		if (ReadDwordFromRegistry(HKEY_CURRENT_USER, subkey, resolution, &dwMode)) {
+			m_bTextureShare = (dwMode == 0);
+			m_bCPUshare = (dwMode == 2);
+			SpoutLogNotice("spoutGL::CalibrateShareMode - recorded %s share for %s", m_bCPUshare ? "CPU" : "texture", resolution);
+			return true;
+		}
+	}
+	else {
+		// Driver changed, remove the results of the previous driver
+		RemoveSubKey(HKEY_CURRENT_USER, subkey);
+	}
+
+	SpoutLogNotice("spoutGL::CalibrateShareMode - timing texture and CPU share at %s", resolution);
+
+	// Source texture for both methods
+	GLuint srcTexture = 0;
+	InitTexture(srcTexture, GL_RGBA, width, height);
+
+	// Shared texture for both methods
+	ID3D11Texture2D* pTexture = nullptr;
+	HANDLE dxShareHandle = nullptr;
+	if (!spoutdx.CreateSharedDX11Texture(spoutdx.GetDX11Device(),
+		width, height, (DXGI_FORMAT)m_dwFormat, &pTexture, dxShareHandle)) {
+		RemoveFramebufferCache(srcTexture);
+		glDeleteTextures(1, &srcTexture);
+		return false;
+	}
+
+	//
+	// Texture share
+	//
+	// Copy to an OpenGL texture linked to the shared texture
+	// by a separate interop device, as for WriteGLDXtexture.
+	// The first frame is not timed.
+	//
+	double texturetime = 0.0;
+	GLuint glTexture = 0;
+	glGenTextures(1, &glTexture);
+	const HANDLE hDevice = wglDXOpenDeviceNV(spoutdx.GetDX11Device());
+	if (hDevice) {
+		HANDLE hObject = wglDXRegisterObjectNV(hDevice, pTexture, glTexture, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
+		if (hObject) {
+			for (int i = 0; i <= SPOUT_CALIBRATION_FRAMES; i++) {
+				if (i == 1) StartTiming();
+				if (wglDXLockObjectsNV(hDevice, 1, &hObject)) {
+					CopyTexture(srcTexture, GL_TEXTURE_2D, glTexture, GL_TEXTURE_2D, width, height, true);
+					wglDXUnlockObjectsNV(hDevice, 1, &hObject);
+				}
+				glFinish();
+				spoutdx.Flush();
+			}
+			texturetime = EndTiming()/(double)SPOUT_CALIBRATION_FRAMES;
+			wglDXUnregisterObjectNV(hDevice, hObject);
+		}
+		wglDXCloseDeviceNV(hDevice);
+	}
+	RemoveFramebufferCache(glTexture);
+	glDeleteTextures(1, &glTexture);
+
+	//
+	// CPU share
+	//
+	// Read the OpenGL texture to a staging texture and copy
+	// to the shared texture, as for WriteDX11texture.
+	//
+	double cputime = 0.0;
+	ID3D11Texture2D* pStaging = nullptr;
+	if (spoutdx.AcquireStagingTexture(spoutdx.GetDX11Device(), width, height, (DXGI_FORMAT)m_dwFormat, &pStaging)) {
+		D3D11_MAPPED_SUBRESOURCE mapped={};
+		for (int i = 0; i <= SPOUT_CALIBRATION_FRAMES; i++) {
+			if (i == 1) StartTiming();
+			if (SUCCEEDED(spoutdx.GetDX11Context()->Map(pStaging, 0, D3D11_MAP_WRITE, 0, &mapped))) {
+				ReadTextureData(srcTexture, GL_TEXTURE_2D, width, height, mapped.RowPitch,
+					(unsigned char*)mapped.pData, GL_BGRA_EXT, true, 0);
+				spoutdx.GetDX11Context()->Unmap(pStaging, 0);
+				spoutdx.GetDX11Context()->CopyResource(pTexture, pStaging);
+			}
+			spoutdx.Flush();
+		}
+		cputime = EndTiming()/(double)SPOUT_CALIBRATION_FRAMES;
+		spoutdx.ReleaseStagingTexture(pStaging);
+	}
+
+	spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), pTexture);
+	spoutdx.Flush();
+	RemoveFramebufferCache(srcTexture);
+	glDeleteTextures(1, &srcTexture);
+
+	if (texturetime <= 0.0 && cputime <= 0.0) {
+		SpoutLogWarning("spoutGL::CalibrateShareMode - timing failed");
+		return false;
+	}
+
+	// Texture share unless CPU share is faster or texture share failed
+	m_bCPUshare = (texturetime <= 0.0 || (cputime > 0.0 && cputime < texturetime));
+	m_bTextureShare = !m_bCPUshare;
+
+	SpoutLogNotice("    texture %.3f msec, CPU %.3f msec - using %s share",
+		texturetime, cputime, m_bCPUshare ? "CPU" : "texture");
+
+	// Record the result for this driver and resolution
+	WritePathToRegistry(HKEY_CURRENT_USER, subkey, "Key", gldxkey);
+	WriteDwordToRegistry(HKEY_CURRENT_USER, subkey, resolution, m_bCPUshare ? 2 : 0);
+
+	return true;
+
+}
+
 
 //---------------------------------------------------------
 bool spoutGL::SetHostPath(const char *sendername)
@@ -1251,6 +1983,11 @@ bool spoutGL::CreateInterop(unsigned int width, unsigned int height, DWORD dwFor
 
 		// Use the texture already created from the sender share handle for linking to OpenGL.
 		pLinkedTexture = m_pSharedTexture;
+
+		// An array texture sender has more than one view
+		D3D11_TEXTURE2D_DESC desc={};
+		m_pSharedTexture->GetDesc(&desc);
+		m_ArraySize = (desc.ArraySize > 1) ? desc.ArraySize : 1;
 	}
 	else {
 		// A sender creates or re-creates the linked DX11 texture
@@ -1261,7 +1998,8 @@ bool spoutGL::CreateInterop(unsigned int width, unsigned int height, DWORD dwFor
 			(DXGI_FORMAT)format, // Default DXGI_FORMAT_B8G8R8A8_UNORM
 			&m_pSharedTexture,
 			m_dxShareHandle, // Handle for receivers
-			false, false)) { // Keyed shared texture, NT handle - defaults false
+			false, false, // Keyed shared texture, NT handle - defaults false
+			m_ArraySize)) { // Views of an array texture sender
 				if (m_pSharedTexture) m_pSharedTexture->Release();
 				m_pSharedTexture = nullptr;
 				m_dxShareHandle = nullptr;
@@ -1279,22 +2017,38 @@ bool spoutGL::CreateInterop(unsigned int width, unsigned int height, DWORD dwFor
 
 	// Create or re-create the class OpenGL texture.
 	// The texture has body after it is linked to the shared DirectX texture.
-	if (m_glTexture) glDeleteTextures(1, &m_glTexture);
+	if (m_glTexture) {
+		RemoveFramebufferCache(m_glTexture);
+		glDeleteTextures(1, &m_glTexture);
+	}
 	glGenTextures(1, &m_glTexture);
 
 	// The interop may already be released but check
 	// here so the function can be used independently.
 	if (m_hInteropDevice && m_hInteropObject) {
 		SpoutLogNotice("    Re-registering interop");
-		wglDXUnregisterObjectNV(m_hInteropDevice, m_hInteropObject);
-		m_hInteropObject = nullptr;
+		ReleaseInteropObject();
+	}
+	m_hInteropObject = nullptr;
+
+	const GLenum glTarget = (m_ArraySize > 1) ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+
+	// Link by memory object if enabled and supported (SetMemoryObject).
+	// The interop device is opened as for NV_DX_interop so that
+	// the interop checks are the same for both.
+	if (m_bMemoryObject && m_bMEMORYavailable) {
+		if (!m_hInteropDevice)
+			m_hInteropDevice = OpenInteropDevice((void*)spoutdx.GetDX11Device());
+		if (m_hInteropDevice && LinkMemoryObject(pLinkedTexture, m_glTexture, glTarget))
+			m_hInteropObject = SPOUT_INTEROP_MEMORY;
 	}
 
 	// Link the shared DirectX texture to the OpenGL texture
 	// This registers for interop and associates the opengl texture with the dx texture
 	// by calling wglDXRegisterObjectNV which returns a handle to the interop object
 	// to manage access to the textures. An interop device is created if it does not exist yet.
-	m_hInteropObject = LinkGLDXtextures((void*)spoutdx.GetDX11Device(), pLinkedTexture, m_glTexture);
+	if (!m_hInteropObject)
+		m_hInteropObject = LinkGLDXtextures((void*)spoutdx.GetDX11Device(), pLinkedTexture, m_glTexture, glTarget);
 	if (!m_hInteropObject) {
 		SpoutLogFatal("spoutGL::CreateInterop - LinkGLDXtextures failed");
 		// Write diagnostics to a log file
@@ -1324,6 +2078,7 @@ bool spoutGL::CreateInterop(unsigned int width, unsigned int height, DWORD dwFor
 	// Also reset staging texture index
 	m_Index = 0;
 	m_NextIndex = 0;
+	m_WriteIndex = 0;
 
 	// Clear interop failed flag
 	m_bInteropFailed = false;
@@ -1339,9 +2094,10 @@ bool spoutGL::CreateInterop(unsigned int width, unsigned int height, DWORD dwFor
 //	IN	pSharedTexture  Pointer to shared the DirectX texture
 //	IN	dxShareHandle   Handle of the DirectX texture to be shared
 //	IN	glTextureID     ID of the OpenGL texture that is to be linked to the shared DirectX texture
+//	IN	glTarget        GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY for an array texture
 //	Returns             Handle to the GL/DirectX interop object (the shared texture)
 //
-HANDLE spoutGL::LinkGLDXtextures(void* pDXdevice, void* pSharedTexture,  GLuint glTexture)
+HANDLE spoutGL::LinkGLDXtextures(void* pDXdevice, void* pSharedTexture,  GLuint glTexture, GLenum glTarget)
 {
 	HANDLE hInteropObject = nullptr;
 	DWORD dwError = 0;
@@ -1363,7 +2119,7 @@ HANDLE spoutGL::LinkGLDXtextures(void* pDXdevice, void* pSharedTexture,  GLuint
 	// The return value is a handle to a GL/DirectX interop device.
 	if (!m_hInteropDevice) {
 		try {
-			m_hInteropDevice = wglDXOpenDeviceNV(pDXdevice);
+			m_hInteropDevice = OpenInteropDevice(pDXdevice);
 		}
 		catch (...) {
 			SpoutLogError("spoutGL::LinkGLDXtextures - wglDXOpenDeviceNV exception");
@@ -1412,7 +2168,7 @@ HANDLE spoutGL::LinkGLDXtextures(void* pDXdevice, void* pSharedTexture,  GLuint
 		hInteropObject = wglDXRegisterObjectNV(m_hInteropDevice,
 			pSharedTexture,	// DX texture
 			glTexture,		// OpenGL texture
-			GL_TEXTURE_2D,	// Must be TEXTURE_2D - multisampling not supported
+			glTarget,		// TEXTURE_2D or TEXTURE_2D_ARRAY - multisampling not supported
 			WGL_ACCESS_READ_WRITE_NV); // A sender will write and a receiver will read
 	}
 	catch (...) {
@@ -1448,10 +2204,16 @@ HANDLE spoutGL::LinkGLDXtextures(void* pDXdevice, void* pSharedTexture,  GLuint
 		SpoutLogError("%s", tmp);
 
 		// Error so close interop device
-		if (m_hInteropDevice) {
-			wglDXCloseDeviceNV(m_hInteropDevice);
-			m_hInteropDevice = nullptr;
+		// unless it is used by interop group senders
+		bool bGroup = false;
+		for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+			if (m_pInteropSenders[i] && m_pInteropSenders[i]->hInteropObject) {
+				bGroup = true;
+				break;
+			}
 		}
+		if (m_hInteropDevice && !bGroup)
+			CloseInteropDevice();
 
 	}
 
@@ -1512,8 +2274,14 @@ HRESULT spoutGL::LockInteropObject(HANDLE hDevice, HANDLE *hObject)
 		return E_HANDLE;
 	}
 
+	// Texture linked by memory object
+	if (*hObject == SPOUT_INTEROP_MEMORY)
+		return LockMemoryObject();
+
 	// lock dx object
+	const LONG64 start = timer.Start();
 	if (wglDXLockObjectsNV(hDevice, 1, hObject)) {
+		timer.Stop("LockInterop", start);
 		return S_OK;
 	}
 	else {
@@ -1557,7 +2325,13 @@ HRESULT spoutGL::UnlockInteropObject(HANDLE hDevice, HANDLE *hObject)
 		return E_HANDLE;
 	}
 
+	// Texture linked by memory object
+	if (*hObject == SPOUT_INTEROP_MEMORY)
+		return UnlockMemoryObject();
+
+	const LONG64 start = timer.Start();
 	if (wglDXUnlockObjectsNV(hDevice, 1, hObject)) {
+		timer.Stop("UnlockInterop", start);
 		return S_OK;
 	}
 	else {
@@ -1586,462 +2360,2300 @@ HRESULT spoutGL::UnlockInteropObject(HANDLE hDevice, HANDLE *hObject)
 
 } // end UnlockInteropObject
 
-
-// Clean up the gldx interop
-bool spoutGL::CleanupInterop()
+//
+// Release the interop object of the shared texture.
+// A texture linked by memory object releases the memory object
+// and semaphore. Otherwise the NV_DX_interop object is un-registered.
+// Requires an OpenGL context.
+//
+bool spoutGL::ReleaseInteropObject()
 {
-	// Clear interop failure flag
-	m_bInteropFailed = false;
-
-	// Already released ?
-	if (m_hInteropDevice || m_hInteropObject) {
-		// These things need an opengl context so check
-		if (wglGetCurrentContext()) {
-			SpoutLogNotice("spoutGL::CleanupInterop - interop device = 0x%7.7X, interop object = 0x%7.7X", PtrToUint(m_hInteropDevice), PtrToUint(m_hInteropObject));
-			if (m_hInteropDevice && m_hInteropObject) {
-				SpoutLogNotice("    wglDXUnregisterObjectNV");
-				if (!wglDXUnregisterObjectNV(m_hInteropDevice, m_hInteropObject)) {
-					SpoutLogWarning("spoutGL::CleanupInterop - could not un-register interop");
-				}
-				m_hInteropObject = nullptr;
-			}
-			else {
-				if (!m_hInteropDevice)
-					SpoutLogWarning("spoutGL::CleanupInterop - null interop device");
-				if (!m_hInteropObject)
-					SpoutLogWarning("spoutGL::CleanupInterop - null interop object");
-			}
-			if (m_hInteropDevice) {
-				SpoutLogNotice("    wglDXCloseDeviceNV");
-				if (!wglDXCloseDeviceNV(m_hInteropDevice)) {
-					SpoutLogWarning("spoutGL::CleanupInterop - could not close interop");
-				}
-				m_hInteropDevice = nullptr;
-			}
-		}
-		else {
-			SpoutLogWarning("spoutGL::CleanupInterop() - no GL context");
-		}
+	bool bResult = true;
+	if (m_hInteropObject == SPOUT_INTEROP_MEMORY) {
+		ReleaseMemoryObject();
+	}
+	else if (m_hInteropDevice && m_hInteropObject) {
+		if (!wglDXUnregisterObjectNV(m_hInteropDevice, m_hInteropObject))
+			bResult = false;
 	}
-
 	m_hInteropObject = nullptr;
-	m_hInteropDevice = nullptr;
-
-	return true;
-
+	return bResult;
 }
 
-//---------------------------------------------------------
-void spoutGL::CleanupGL()
+//
+// Link a shared DirectX texture to an OpenGL texture by memory object.
+//
+// The texture is imported by its share handle, or by a new NT handle
+// for a texture shared by NT handle. The OpenGL texture must not have
+// storage yet. Only formats with the same channel order in OpenGL are
+// imported, so that the texture can be written and read as for NV_DX_interop.
+//
+bool spoutGL::LinkMemoryObject(ID3D11Texture2D* pSharedTexture, GLuint glTexture, GLenum glTarget)
 {
-	SpoutLogNotice("spoutGL::CleanupGL");
-
-	// Release OpenGL resources if there is a context
-	if (wglGetCurrentContext()) {
-
-		// Make sure no texture is bound
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		// Delete the fbo before the texture
-		if (m_fbo > 0) glDeleteFramebuffersEXT(1, &m_fbo);
-		m_fbo = 0;
-
-		// Delete the linked OpenGL texture
-		if (m_glTexture > 0) glDeleteTextures(1, &m_glTexture);
-		m_glTexture = 0;
+	if (!pSharedTexture || !glTexture || !m_bMEMORYavailable)
+		return false;
 
-		if (m_TexID > 0)
-			glDeleteTextures(1, &m_TexID);
+	D3D11_TEXTURE2D_DESC desc={};
+	pSharedTexture->GetDesc(&desc);
 
-		if (m_pbo[0] > 0)
-			glDeleteBuffers(m_nBuffers, m_pbo);
+	GLenum glformat = 0;
+	GLuint64 bytes = 0; // Bytes per pixel
+	switch (desc.Format) {
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+			glformat = GL_RGBA8;
+			bytes = 4;
+			break;
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+			glformat = GL_RGB10_A2;
+			bytes = 4;
+			break;
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+			glformat = GL_RGBA16;
+			bytes = 8;
+			break;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			glformat = GL_RGBA16F;
+			bytes = 8;
+			break;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+			glformat = GL_RGBA32F;
+			bytes = 16;
+			break;
+		default:
+			break;
+	}
+	if (glformat == 0 || desc.MipLevels != 1) {
+		SpoutLogNotice("spoutGL::LinkMemoryObject - format %d (%d levels) not supported, using NV_DX_interop",
+			desc.Format, desc.MipLevels);
+		return false;
+	}
 
-		m_TexID = 0;
-		m_pbo[0] = m_pbo[1] = m_pbo[2] = m_pbo[3] = 0;
+	// Handle of the texture for import.
+	// An NT handle is not owned by OpenGL and is closed after import.
+	HANDLE hShare = nullptr;
+	GLenum handletype = GL_HANDLE_TYPE_D3D11_IMAGE_KMT_EXT;
+	IDXGIResource1* pResource = nullptr;
+	if (FAILED(pSharedTexture->QueryInterface(__uuidof(IDXGIResource1), (void**)&pResource)) || !pResource) {
+		SpoutLogWarning("spoutGL::LinkMemoryObject - QueryInterface error");
+		return false;
+	}
+	if ((desc.MiscFlags & D3D11_RESOURCE_MISC_SHARED_NTHANDLE) != 0) {
+		handletype = GL_HANDLE_TYPE_D3D11_IMAGE_EXT;
+		pResource->CreateSharedHandle(NULL, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, NULL, &hShare);
 	}
 	else {
-		SpoutLogWarning("spoutGL::CleanupGL() - no GL context");
+		pResource->GetSharedHandle(&hShare);
+	}
+	pResource->Release();
+	if (!hShare) {
+		SpoutLogWarning("spoutGL::LinkMemoryObject - no share handle");
+		return false;
 	}
 
-	// Release the received D3D11 shared texture
-	if (m_pSharedTexture) {
-		spoutdx.ReleaseDX11Texture(GetDX11Device(), m_pSharedTexture);
-		m_pSharedTexture = nullptr;
+	// Fence for synchronisation with the DirectX device
+	if (!m_pInteropFence && !CreateInteropFence()) {
+		if (handletype == GL_HANDLE_TYPE_D3D11_IMAGE_EXT)
+			CloseHandle(hShare);
+		return false;
 	}
 
-	// The share handle is created again for a sender
-	// and retrieved from the sender for a receiver
-	m_dxShareHandle = nullptr;
+	// Clear previous errors
+	while (glGetError() != GL_NO_ERROR) {}
 
-	// Staging textures for CPU share are also released in CleanupDX11
-	// But release them here to allow for situations where DirectX is not released
-	if (m_pStaging[0]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[0]);
-	if (m_pStaging[1]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[1]);
-	m_pStaging[0] = nullptr;
-	m_pStaging[1] = nullptr;
-	m_Index = 0;
-	m_NextIndex = 0;
+	const GLint dedicated = GL_TRUE;
+	glCreateMemoryObjectsEXT(1, &m_glMemoryObject);
+	glMemoryObjectParameterivEXT(m_glMemoryObject, GL_DEDICATED_MEMORY_OBJECT_EXT, &dedicated);
+	glImportMemoryWin32HandleEXT(m_glMemoryObject,
+		(GLuint64)desc.Width*(GLuint64)desc.Height*bytes*(GLuint64)desc.ArraySize, handletype, hShare);
+	if (handletype == GL_HANDLE_TYPE_D3D11_IMAGE_EXT)
+		CloseHandle(hShare);
+
+	glBindTexture(glTarget, glTexture);
+	if (glTarget == GL_TEXTURE_2D_ARRAY)
+		glTexStorageMem3DEXT(glTarget, 1, glformat, desc.Width, desc.Height, desc.ArraySize, m_glMemoryObject, 0);
+	else
+		glTexStorageMem2DEXT(glTarget, 1, glformat, desc.Width, desc.Height, m_glMemoryObject, 0);
+	glBindTexture(glTarget, 0);
+
+	// The texture has no storage if the import failed
+	const GLenum err = glGetError();
+	if (err != GL_NO_ERROR) {
+		SpoutLogWarning("spoutGL::LinkMemoryObject - import failed (0x%X), using NV_DX_interop", err);
+		ReleaseMemoryObject();
+		return false;
+	}
+
+	SpoutLogNotice("spoutGL::LinkMemoryObject - texture 0x%.7X linked to GL texture %d by memory object %d",
+		PtrToUint(pSharedTexture), glTexture, m_glMemoryObject);
+
+	return true;
+}
+
+//
+// Create a shared DirectX fence on the class device
+// and import it to OpenGL as a semaphore
+//
+bool spoutGL::CreateInteropFence()
+{
+	ID3D11Device* pDevice = spoutdx.GetDX11Device();
+	if (!pDevice)
+		return false;
+
+	ID3D11Device5* pDevice5 = nullptr;
+	HRESULT hr = pDevice->QueryInterface(__uuidof(ID3D11Device5), reinterpret_cast<void**>(&pDevice5));
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutGL::CreateInteropFence - ID3D11Device5 not available");
+		return false;
+	}
+	hr = pDevice5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, __uuidof(ID3D11Fence), reinterpret_cast<void**>(&m_pInteropFence));
+	pDevice5->Release();
+	if (SUCCEEDED(hr))
+		hr = m_pInteropFence->CreateSharedHandle(NULL, GENERIC_ALL, NULL, &m_hInteropFence);
+	if (SUCCEEDED(hr)) {
+		ID3D11DeviceContext* pContext = nullptr;
+		pDevice->GetImmediateContext(&pContext);
+		hr = pContext->QueryInterface(__uuidof(ID3D11DeviceContext4), reinterpret_cast<void**>(&m_pInteropFenceContext));
+		pContext->Release();
+	}
+	if (FAILED(hr)) {
+		SpoutLogWarning("spoutGL::CreateInteropFence - could not create fence (0x%.7X)", (unsigned int)hr);
+		ReleaseMemoryObject();
+		return false;
+	}
+
+	// The NT handle remains owned by this class
+	glGenSemaphoresEXT(1, &m_glSemaphore);
+	glImportSemaphoreWin32HandleEXT(m_glSemaphore, GL_HANDLE_TYPE_D3D12_FENCE_EXT, m_hInteropFence);
+	m_InteropFenceValue = 0;
+
+	return true;
+}
+
+//
+// Release the memory object, semaphore and interop fence.
+// The OpenGL texture retains its storage until it is deleted.
+//
+void spoutGL::ReleaseMemoryObject()
+{
+	if (wglGetCurrentContext()) {
+		if (m_glMemoryObject) glDeleteMemoryObjectsEXT(1, &m_glMemoryObject);
+		if (m_glSemaphore) glDeleteSemaphoresEXT(1, &m_glSemaphore);
+	}
+	m_glMemoryObject = 0;
+	m_glSemaphore = 0;
+
+	if (m_pInteropFenceContext) m_pInteropFenceContext->Release();
+	m_pInteropFenceContext = nullptr;
+	if (m_pInteropFence) m_pInteropFence->Release();
+	m_pInteropFence = nullptr;
+	if (m_hInteropFence) CloseHandle(m_hInteropFence);
+	m_hInteropFence = nullptr;
+	m_InteropFenceValue = 0;
+}
+
+//
+// OpenGL access to a texture linked by memory object.
+// DirectX signals the fence after the commands queued for the texture
+// and OpenGL waits for it on the GPU. The CPU does not wait.
+//
+HRESULT spoutGL::LockMemoryObject()
+{
+	if (!m_pInteropFence || !m_pInteropFenceContext || !m_glSemaphore)
+		return E_HANDLE;
+
+	const LONG64 start = timer.Start();
+
+	m_InteropFenceValue++;
+	if (FAILED(m_pInteropFenceContext->Signal(m_pInteropFence, m_InteropFenceValue)))
+		return E_FAIL;
+	m_pInteropFenceContext->Flush();
+
+	const GLuint64 value = m_InteropFenceValue;
+	const GLenum layout = GL_LAYOUT_GENERAL_EXT;
+	glSemaphoreParameterui64vEXT(m_glSemaphore, GL_D3D12_FENCE_VALUE_EXT, &value);
+	glWaitSemaphoreEXT(m_glSemaphore, 0, nullptr, 1, &m_glTexture, &layout);
+
+	timer.Stop("LockInterop", start);
+
+	return S_OK;
+}
+
+//
+// End OpenGL access to a texture linked by memory object.
+// OpenGL signals the semaphore after its commands for the texture
+// and DirectX commands queued after this wait for it on the GPU.
+//
+HRESULT spoutGL::UnlockMemoryObject()
+{
+	if (!m_pInteropFence || !m_pInteropFenceContext || !m_glSemaphore)
+		return E_HANDLE;
+
+	const LONG64 start = timer.Start();
+
+	m_InteropFenceValue++;
+	const GLuint64 value = m_InteropFenceValue;
+	const GLenum layout = GL_LAYOUT_GENERAL_EXT;
+	glSemaphoreParameterui64vEXT(m_glSemaphore, GL_D3D12_FENCE_VALUE_EXT, &value);
+	glSignalSemaphoreEXT(m_glSemaphore, 0, nullptr, 1, &m_glTexture, &layout);
+	glFlush();
+
+	if (FAILED(m_pInteropFenceContext->Wait(m_pInteropFence, m_InteropFenceValue)))
+		return E_FAIL;
+	m_pInteropFenceContext->Flush();
+
+	timer.Stop("UnlockInterop", start);
+
+	return S_OK;
+}
+
+
+// Clean up the gldx interop
+bool spoutGL::CleanupInterop()
+{
+	// Clear interop failure flag
+	m_bInteropFailed = false;
+
+	// Interop group objects are registered with the same device
+	// Release them so that they are linked again after the device is closed
+	ReleaseInteropSenders();
+
+	// Already released ?
+	if (m_hInteropDevice || m_hInteropObject) {
+		// These things need an opengl context so check
+		if (wglGetCurrentContext()) {
+			SpoutLogNotice("spoutGL::CleanupInterop - interop device = 0x%7.7X, interop object = 0x%7.7X", PtrToUint(m_hInteropDevice), PtrToUint(m_hInteropObject));
+			if (m_hInteropDevice && m_hInteropObject) {
+				SpoutLogNotice("    %s", IsMemoryObject() ? "ReleaseMemoryObject" : "wglDXUnregisterObjectNV");
+				if (!ReleaseInteropObject()) {
+					SpoutLogWarning("spoutGL::CleanupInterop - could not un-register interop");
+				}
+			}
+			else {
+				if (!m_hInteropDevice)
+					SpoutLogWarning("spoutGL::CleanupInterop - null interop device");
+				if (!m_hInteropObject)
+					SpoutLogWarning("spoutGL::CleanupInterop - null interop object");
+			}
+			if (m_hInteropDevice) {
+				// A shared interop device is closed with the process interop context
+				if (IsSharedInteropDevice(m_hInteropDevice)) {
+					SpoutLogNotice("    shared interop device retained");
+				}
+				else {
+					SpoutLogNotice("    wglDXCloseDeviceNV");
+					if (!wglDXCloseDeviceNV(m_hInteropDevice)) {
+						SpoutLogWarning("spoutGL::CleanupInterop - could not close interop");
+					}
+				}
+				m_hInteropDevice = nullptr;
+			}
+		}
+		else {
+			SpoutLogWarning("spoutGL::CleanupInterop() - no GL context");
+		}
+	}
+
+	// Fence and memory object if not released with a context
+	ReleaseMemoryObject();
+	m_hInteropObject = nullptr;
+	m_hInteropDevice = nullptr;
+
+	return true;
+
+}
+
+//---------------------------------------------------------
+// Function: AcquireSharedInterop
+// Add this instance to the process interop context of the current OpenGL context.
+// The context and DirectX device are created by the first instance.
+// Returns the shared DirectX device or null for no OpenGL context.
+ID3D11Device* spoutGL::AcquireSharedInterop()
+{
+	const HGLRC hRc = wglGetCurrentContext();
+	if (!hRc) {
+		SpoutLogWarning("spoutGL::AcquireSharedInterop - no GL context");
+		return nullptr;
+	}
+
+	ID3D11Device* pDevice = nullptr;
+
+	AcquireSRWLockExclusive(&g_InteropContextLock);
+
+	// Already added
+	if (m_SharedInterop >= 0) {
+		pDevice = g_InteropContexts[m_SharedInterop].pdx->GetDX11Device();
+		ReleaseSRWLockExclusive(&g_InteropContextLock);
+		return pDevice;
+	}
+
+	int index = -1;
+	int free = -1;
+	for (int i = 0; i < SPOUT_INTEROP_CONTEXTS; i++) {
+		if (g_InteropContexts[i].hRc == hRc) {
+			index = i;
+			break;
+		}
+		if (!g_InteropContexts[i].hRc && free < 0)
+			free = i;
+	}
+
+	if (index < 0) {
+		if (free < 0) {
+			ReleaseSRWLockExclusive(&g_InteropContextLock);
+			SpoutLogWarning("spoutGL::AcquireSharedInterop - maximum %d contexts", SPOUT_INTEROP_CONTEXTS);
+			return nullptr;
+		}
+		// Create the shared device on the adapter of this instance
+		spoutDirectX* pdx = new spoutDirectX;
+		if (spoutdx.GetAdapter() > 0)
+			pdx->SetAdapter(spoutdx.GetAdapter());
+		if (!pdx->OpenDirectX11()) {
+			delete pdx;
+			ReleaseSRWLockExclusive(&g_InteropContextLock);
+			SpoutLogError("spoutGL::AcquireSharedInterop - could not create device");
+			return nullptr;
+		}
+		g_InteropContexts[free].hRc = hRc;
+		g_InteropContexts[free].pdx = pdx;
+		g_InteropContexts[free].hInteropDevice = nullptr;
+		g_InteropContexts[free].refs = 0;
+		index = free;
+	}
+
+	g_InteropContexts[index].refs++;
+	m_SharedInterop = index;
+	pDevice = g_InteropContexts[index].pdx->GetDX11Device();
+
+	SpoutLogNotice("spoutGL::AcquireSharedInterop - context %d, device 0x%.7X, %d instances",
+		index, PtrToUint(pDevice), g_InteropContexts[index].refs);
+
+	ReleaseSRWLockExclusive(&g_InteropContextLock);
+
+	return pDevice;
+}
+
+//---------------------------------------------------------
+// Function: ReleaseSharedInterop
+// Remove this instance from the process interop context.
+// The interop device and DirectX device are released with the last instance.
+void spoutGL::ReleaseSharedInterop()
+{
+	AcquireSRWLockExclusive(&g_InteropContextLock);
+
+	if (m_SharedInterop < 0) {
+		ReleaseSRWLockExclusive(&g_InteropContextLock);
+		return;
+	}
+
+	SpoutInteropContext& context = g_InteropContexts[m_SharedInterop];
+	context.refs--;
+	SpoutLogNotice("spoutGL::ReleaseSharedInterop - context %d, %d instances", m_SharedInterop, context.refs);
+
+	if (context.refs <= 0) {
+		if (context.hInteropDevice) {
+			// The interop device requires the OpenGL context it was opened with
+			if (wglGetCurrentContext() == context.hRc)
+				wglDXCloseDeviceNV(context.hInteropDevice);
+			else
+				SpoutLogWarning("spoutGL::ReleaseSharedInterop - interop device not closed, GL context is not current");
+		}
+		if (context.pdx) {
+			context.pdx->CloseDirectX11();
+			delete context.pdx;
+		}
+		ZeroMemory(&context, sizeof(SpoutInteropContext));
+	}
+	m_SharedInterop = -1;
+
+	ReleaseSRWLockExclusive(&g_InteropContextLock);
+}
+
+//---------------------------------------------------------
+// Function: OpenInteropDevice
+// Open a GL/DX interop device for a DirectX device.
+// The interop device of the process interop context is returned
+// for the shared DirectX device and opened by the first instance.
+HANDLE spoutGL::OpenInteropDevice(void* pDXdevice)
+{
+	if (m_SharedInterop < 0)
+		return wglDXOpenDeviceNV(pDXdevice);
+
+	HANDLE hInteropDevice = nullptr;
+	AcquireSRWLockExclusive(&g_InteropContextLock);
+	SpoutInteropContext& context = g_InteropContexts[m_SharedInterop];
+	if (context.pdx && pDXdevice == context.pdx->GetDX11Device()) {
+		if (!context.hInteropDevice)
+			context.hInteropDevice = wglDXOpenDeviceNV(pDXdevice);
+		hInteropDevice = context.hInteropDevice;
+	}
+	else {
+		hInteropDevice = wglDXOpenDeviceNV(pDXdevice);
+	}
+	ReleaseSRWLockExclusive(&g_InteropContextLock);
+
+	return hInteropDevice;
+}
+
+//---------------------------------------------------------
+// Function: CloseInteropDevice
+// Close the class interop device unless it is shared
+void spoutGL::CloseInteropDevice()
+{
+	if (!m_hInteropDevice)
+		return;
+	if (!IsSharedInteropDevice(m_hInteropDevice))
+		wglDXCloseDeviceNV(m_hInteropDevice);
+	m_hInteropDevice = nullptr;
+}
+
+//---------------------------------------------------------
+// Function: IsSharedInteropDevice
+// The interop device is that of the process interop context
+bool spoutGL::IsSharedInteropDevice(HANDLE hInteropDevice)
+{
+	if (m_SharedInterop < 0 || !hInteropDevice)
+		return false;
+	AcquireSRWLockShared(&g_InteropContextLock);
+	const bool bShared = (g_InteropContexts[m_SharedInterop].hInteropDevice == hInteropDevice);
+	ReleaseSRWLockShared(&g_InteropContextLock);
+	return bShared;
+}
+
+//
+// Interop group
+//
+// A receiver that composites a number of senders, for example
+// a GL compositor of 12 senders, would otherwise need an interop
+// device and a separate lock and unlock for the texture of each.
+// The group textures are registered with the class interop device
+// and a sender change is checked once for all senders. 
+// LockInteropSenders then locks all textures with one wglDXLockObjectsNV
+// call and UnlockInteropSenders unlocks them with one wglDXUnlockObjectsNV.
+//
+// The sender texture access mutex is held from lock to unlock
+// so that the senders do not write while the textures are read.
+// Keep the time between lock and unlock as short as possible.
+//
+//    if (receiver.LockInteropSenders() > 0) {
+//        for (int i = 0; i < count; i++) {
+//            GLuint tex = receiver.GetInteropSenderTexture(i);
+//            if (tex > 0) ... draw the texture
+//        }
+//        receiver.UnlockInteropSenders();
+//    }
+//
+// An OpenGL context is required for all functions.
+//
+
+//---------------------------------------------------------
+// Function: AddInteropSender
+// Add a sender to the interop group
+//
+// The sender does not have to be running.
+// The texture is linked when the sender is found by LockInteropSenders.
+// Returns the index of the sender in the group or -1 if the group is full.
+int spoutGL::AddInteropSender(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return -1;
+
+	// Unlock before the group changes
+	UnlockInteropSenders();
+
+	// Already in the group
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		if (m_pInteropSenders[i] && strcmp(m_pInteropSenders[i]->name, sendername) == 0)
+			return i;
+	}
+
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		if (!m_pInteropSenders[i]) {
+			SpoutInteropSender* pSender = new SpoutInteropSender;
+			ZeroMemory(pSender, sizeof(SpoutInteropSender));
+			strcpy_s(pSender->name, 256, sendername);
+			pSender->pFrame = new spoutFrameCount;
+			m_pInteropSenders[i] = pSender;
+			// Check the senders at the next lock
+			m_dwInteropCheck = 0;
+			SpoutLogNotice("spoutGL::AddInteropSender(%s) - index %d", sendername, i);
+			return i;
+		}
+	}
+
+	SpoutLogWarning("spoutGL::AddInteropSender(%s) - maximum %d senders", sendername, SPOUT_INTEROP_MAX);
+
+	return -1;
+}
+
+//---------------------------------------------------------
+// Function: RemoveInteropSender
+// Remove a sender from the interop group
+void spoutGL::RemoveInteropSender(int index)
+{
+	if (index < 0 || index >= SPOUT_INTEROP_MAX || !m_pInteropSenders[index])
+		return;
+
+	UnlockInteropSenders();
+
+	SpoutLogNotice("spoutGL::RemoveInteropSender(%d) - %s", index, m_pInteropSenders[index]->name);
+	ReleaseInteropSender(m_pInteropSenders[index]);
+	delete m_pInteropSenders[index]->pFrame;
+	delete m_pInteropSenders[index];
+	m_pInteropSenders[index] = nullptr;
+}
+
+//---------------------------------------------------------
+// Function: RemoveInteropSenders
+// Remove all senders from the interop group
+void spoutGL::RemoveInteropSenders()
+{
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++)
+		RemoveInteropSender(i);
+}
+
+//---------------------------------------------------------
+// Function: LockInteropSenders
+// Check the group senders and lock their textures for OpenGL
+//
+// Senders are checked once for all when a sender has been
+// created, updated or closed, or at one second intervals.
+// Textures are linked again if the sender texture has changed.
+// Returns the number of textures locked. UnlockInteropSenders
+// must be called after the textures are used.
+int spoutGL::LockInteropSenders()
+{
+	// Already locked
+	if (m_nInteropLocked > 0)
+		return m_nInteropLocked;
+
+	if (!wglGetCurrentContext() || !OpenSpout())
+		return 0;
+
+	if (!m_bUseGLDX || !wglDXLockObjectsNV || !wglDXUnlockObjectsNV)
+		return 0;
+
+	// One check for all senders
+	const bool bChanged = sendernames.CheckSenderChange(m_InteropGeneration, m_dwInteropCheck);
+
+	int nLocked = 0;
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		SpoutInteropSender* pSender = m_pInteropSenders[i];
+		if (!pSender)
+			continue;
+		pSender->bLocked = false;
+		pSender->bNewFrame = false;
+		if (bChanged)
+			CheckInteropSender(pSender);
+		if (!pSender->hInteropObject)
+			continue;
+		// Hold the sender access mutex until unlock
+		if (pSender->pFrame->CheckTextureAccess(pSender->pSharedTexture)) {
+			pSender->bLocked = true;
+			pSender->bNewFrame = pSender->pFrame->GetNewFrame();
+			m_hInteropLocked[nLocked] = pSender->hInteropObject;
+			nLocked++;
+		}
+	}
+
+	if (nLocked == 0)
+		return 0;
+
+	// Lock all objects together
+	if (!wglDXLockObjectsNV(m_hInteropDevice, nLocked, m_hInteropLocked)) {
+		const DWORD dwError = GetLastError();
+		SpoutLogError("spoutGL::LockInteropSenders - wglDXLockObjectsNV error %lu (0x%.X)", dwError, LOWORD(dwError));
+		for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+			SpoutInteropSender* pSender = m_pInteropSenders[i];
+			if (pSender && pSender->bLocked) {
+				pSender->pFrame->AllowTextureAccess(pSender->pSharedTexture);
+				pSender->bLocked = false;
+				pSender->bNewFrame = false;
+			}
+		}
+		return 0;
+	}
+
+	m_nInteropLocked = nLocked;
+
+	return nLocked;
+}
+
+//---------------------------------------------------------
+// Function: UnlockInteropSenders
+// Unlock the textures locked by LockInteropSenders
+bool spoutGL::UnlockInteropSenders()
+{
+	if (m_nInteropLocked == 0)
+		return false;
+
+	bool bResult = true;
+	if (!wglDXUnlockObjectsNV(m_hInteropDevice, m_nInteropLocked, m_hInteropLocked)) {
+		SpoutLogError("spoutGL::UnlockInteropSenders - wglDXUnlockObjectsNV error");
+		bResult = false;
+	}
+
+	// Allow the senders to write
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		SpoutInteropSender* pSender = m_pInteropSenders[i];
+		if (pSender && pSender->bLocked) {
+			pSender->pFrame->AllowTextureAccess(pSender->pSharedTexture);
+			pSender->bLocked = false;
+		}
+	}
+	m_nInteropLocked = 0;
+
+	return bResult;
+}
+
+//---------------------------------------------------------
+// Function: GetInteropSenderTexture
+// OpenGL texture of a group sender
+//
+// Valid between LockInteropSenders and UnlockInteropSenders.
+// Returns 0 if the sender texture is not locked.
+GLuint spoutGL::GetInteropSenderTexture(int index)
+{
+	if (index < 0 || index >= SPOUT_INTEROP_MAX || !m_pInteropSenders[index])
+		return 0;
+	if (!m_pInteropSenders[index]->bLocked)
+		return 0;
+	return m_pInteropSenders[index]->glTexture;
+}
+
+//---------------------------------------------------------
+// Function: GetInteropSenderWidth
+// Width of a group sender texture
+unsigned int spoutGL::GetInteropSenderWidth(int index)
+{
+	if (index < 0 || index >= SPOUT_INTEROP_MAX || !m_pInteropSenders[index])
+		return 0;
+	return m_pInteropSenders[index]->width;
+}
+
+//---------------------------------------------------------
+// Function: GetInteropSenderHeight
+// Height of a group sender texture
+unsigned int spoutGL::GetInteropSenderHeight(int index)
+{
+	if (index < 0 || index >= SPOUT_INTEROP_MAX || !m_pInteropSenders[index])
+		return 0;
+	return m_pInteropSenders[index]->height;
+}
+
+//---------------------------------------------------------
+// Function: IsInteropSenderNew
+// Group sender texture has been locked with a new frame
+//
+// Always true for senders that do not enable frame counting.
+bool spoutGL::IsInteropSenderNew(int index)
+{
+	if (index < 0 || index >= SPOUT_INTEROP_MAX || !m_pInteropSenders[index])
+		return false;
+	return m_pInteropSenders[index]->bNewFrame;
+}
+
+//---------------------------------------------------------
+// Check a group sender and link its texture if it has changed
+bool spoutGL::CheckInteropSender(SpoutInteropSender* pSender)
+{
+	SharedTextureInfo info={};
+	if (!sendernames.getSharedInfo(pSender->name, &info)) {
+		// Sender closed
+		if (pSender->dxShareHandle) {
+			ReleaseInteropSender(pSender);
+			spoutdx.EvictSharedTexture(pSender->name);
+		}
+		return false;
+	}
+
+	HANDLE dxShareHandle = UIntToPtr(info.shareHandle);
+	if (!dxShareHandle)
+		return false;
+
+	// Same texture
+	if (dxShareHandle == pSender->dxShareHandle && pSender->hInteropObject)
+		return true;
+
+	// Sender texture changed
+	ReleaseInteropSender(pSender);
+
+	if (!spoutdx.OpenSharedTexture(spoutdx.GetDX11Device(), &pSender->pSharedTexture, dxShareHandle, pSender->name,
+		(info.usage & SPOUT_USAGE_NTHANDLE) != 0))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc={};
+	pSender->pSharedTexture->GetDesc(&desc);
+	if (desc.Width == 0 || desc.Height == 0) {
+		pSender->pSharedTexture->Release();
+		pSender->pSharedTexture = nullptr;
+		return false;
+	}
+
+	// Link to a new OpenGL texture with the class interop device
+	glGenTextures(1, &pSender->glTexture);
+	pSender->hInteropObject = LinkGLDXtextures(spoutdx.GetDX11Device(), pSender->pSharedTexture, pSender->glTexture);
+	if (!pSender->hInteropObject) {
+		SpoutLogError("spoutGL::CheckInteropSender(%s) - could not link texture", pSender->name);
+		ReleaseInteropSender(pSender);
+		return false;
+	}
+
+	pSender->dxShareHandle = dxShareHandle;
+	pSender->width = desc.Width;
+	pSender->height = desc.Height;
+	pSender->format = (DWORD)desc.Format;
+
+	// Access mutex and frame count for the sender
+	pSender->pFrame->CloseAccessMutex();
+	pSender->pFrame->CleanupFrameCount();
+	pSender->pFrame->CreateAccessMutex(pSender->name);
+	pSender->pFrame->EnableFrameCount(pSender->name);
+
+	SpoutLogNotice("spoutGL::CheckInteropSender(%s) - linked %dx%d texture %d",
+		pSender->name, pSender->width, pSender->height, pSender->glTexture);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Release the interop object and textures of a group sender
+void spoutGL::ReleaseInteropSender(SpoutInteropSender* pSender)
+{
+	if (!pSender)
+		return;
+
+	if (pSender->hInteropObject && m_hInteropDevice && wglGetCurrentContext())
+		wglDXUnregisterObjectNV(m_hInteropDevice, pSender->hInteropObject);
+	pSender->hInteropObject = nullptr;
+
+	if (pSender->glTexture > 0 && wglGetCurrentContext()) {
+		RemoveFramebufferCache(pSender->glTexture);
+		glDeleteTextures(1, &pSender->glTexture);
+	}
+	pSender->glTexture = 0;
+
+	if (pSender->pSharedTexture)
+		pSender->pSharedTexture->Release();
+	pSender->pSharedTexture = nullptr;
+
+	pSender->dxShareHandle = nullptr;
+	pSender->width = 0;
+	pSender->height = 0;
+	pSender->format = 0;
+	pSender->bLocked = false;
+	pSender->bNewFrame = false;
+}
+
+//---------------------------------------------------------
+// Release the interop objects of all group senders
+// The senders remain in the group and are linked again by LockInteropSenders
+void spoutGL::ReleaseInteropSenders()
+{
+	UnlockInteropSenders();
+
+	bool bReleased = false;
+	for (int i = 0; i < SPOUT_INTEROP_MAX; i++) {
+		if (m_pInteropSenders[i] && m_pInteropSenders[i]->hInteropObject) {
+			ReleaseInteropSender(m_pInteropSenders[i]);
+			bReleased = true;
+		}
+	}
+
+	// Check the senders at the next lock
+	if (bReleased)
+		m_dwInteropCheck = 0;
+}
+
+//---------------------------------------------------------
+void spoutGL::CleanupGL()
+{
+	SpoutLogNotice("spoutGL::CleanupGL");
+
+	// Release OpenGL resources if there is a context
+	if (wglGetCurrentContext()) {
+
+		// Make sure no texture is bound
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		// Delete the fbos before the textures
+		if (m_fbo > 0) glDeleteFramebuffersEXT(1, &m_fbo);
+		m_fbo = 0;
+		if (m_SharedFbo > 0) glDeleteFramebuffersEXT(1, &m_SharedFbo);
+		m_SharedFbo = 0;
+		RemoveFramebufferCache();
+
+		// Delete the linked OpenGL texture
+		if (m_glTexture > 0) glDeleteTextures(1, &m_glTexture);
+		m_glTexture = 0;
+
+		// The class texture is retained by the texture pool
+		// for re-use by another sender of the same size and format.
+		// Any other texture is deleted.
+		if (m_TexID > 0 && !IsPoolTexture(m_TexID))
+			glDeleteTextures(1, &m_TexID);
+
+		if (m_pbo[0] > 0)
+			glDeleteBuffers(m_nBuffers, m_pbo);
+
+		if (m_ssbo > 0)
+			glDeleteBuffers(1, &m_ssbo);
+		m_ssbo = 0;
+		m_ssboSize = 0;
+
+		if (m_resampleTexture > 0)
+			glDeleteTextures(1, &m_resampleTexture);
+		m_resampleTexture = 0;
+		m_resampleWidth = 0;
+		m_resampleHeight = 0;
+
+		m_TexID = 0;
+		m_pbo[0] = m_pbo[1] = m_pbo[2] = m_pbo[3] = 0;
+		ZeroMemory(m_pboSize, sizeof(m_pboSize));
+		m_pboAlloc = 0;
+
+		ReleasePersistentBuffers();
+		ReleasePinnedBuffer();
+		m_pPinnedData = nullptr;
+		m_pinnedSize = 0;
+		ReleaseUnpackBuffers();
+		ReleaseGLTiming();
+	}
+	else {
+		SpoutLogWarning("spoutGL::CleanupGL() - no GL context");
+	}
+
+	// Release the received D3D11 shared texture
+	if (m_pSharedTexture) {
+		spoutdx.ReleaseDX11Texture(GetDX11Device(), m_pSharedTexture);
+		m_pSharedTexture = nullptr;
+	}
+
+	// The share handle is created again for a sender
+	// and retrieved from the sender for a receiver
+	m_dxShareHandle = nullptr;
+
+	// Staging textures for CPU share are also released in CleanupDX11
+	// But release them here to allow for situations where DirectX is not released
+	ReleaseStagingTextures();
+	ReleaseSendReadback();
+
+	m_Width = 0;
+	m_Height = 0;
+
+	// ReleaseReceiver calls CleanupGL before restoring m_SenderName
+	// ReleaseSender clears the name
+
+	// Flush D3D11 context to avoid deferred release
+	spoutdx.Flush();
+
+	// Do not close DirectX device
+
+}
+
+// If a class OpenGL texture has not been created or it is a different size,
+// use a pool texture of that size and format or create a new one.
+// Typically used for texture copy and invert
+void spoutGL::CheckOpenGLTexture(GLuint &texID, GLenum GLformat, unsigned int width,  unsigned int height)
+{
+	if (texID == 0 || texID != m_TexID 
+			|| GLformat != m_TexFormat 
+			|| width    != m_TexWidth 
+			|| height   != m_TexHeight) {
+		const GLuint poolID = GetPoolTexture(GLformat, width, height);
+		if (poolID > 0) {
+			// A texture that is not in the pool is not needed
+			if (texID > 0 && !IsPoolTexture(texID)) {
+				RemoveFramebufferCache(texID);
+				glDeleteTextures(1, &texID);
+			}
+			texID = poolID;
+		}
+		else {
+			// A pool texture is not deleted by InitTexture
+			if (IsPoolTexture(texID))
+				texID = 0;
+			InitTexture(texID, GLformat, width, height);
+		}
+		m_TexID = texID;
+		m_TexWidth  = width;
+		m_TexHeight = height;
+		m_TexFormat = (DWORD)GLformat;
+	}
+}
+
+// Pool texture of the given size and format.
+// A new texture with immutable storage is created if there is none.
+// The least recently used is replaced if the pool is full.
+// Returns zero if immutable textures are not supported.
+GLuint spoutGL::GetPoolTexture(GLenum GLformat, unsigned int width, unsigned int height)
+{
+	if (!glCreateTextures || !glTextureStorage2D || width == 0 || height == 0)
+		return 0;
+
+	// Immutable storage requires a sized format
+	GLenum storageformat = 0;
+	switch (GLformat) {
+		case GL_RGBA:
+		case GL_RGBA8:
+			storageformat = GL_RGBA8;
+			break;
+		case GL_RGBA16:
+		case GL_RGBA16F:
+		case GL_RGBA32F:
+			storageformat = GLformat;
+			break;
+		default:
+			// Created by InitTexture
+			return 0;
+	}
+
+	const HGLRC context = wglGetCurrentContext();
+	if (!context)
+		return 0;
+
+	int slot = -1;
+	for (int i = 0; i < SPOUT_TEXTURE_POOL; i++) {
+		SpoutPoolTexture* pTex = &m_TexPool[i];
+		// Textures of another context are not used or deleted
+		if (pTex->id && pTex->context != context)
+			ZeroMemory(pTex, sizeof(SpoutPoolTexture));
+		if (pTex->id == 0) {
+			if (slot < 0) slot = i;
+			continue;
+		}
+		if (pTex->format == GLformat && pTex->width == width && pTex->height == height) {
+			pTex->used = ++m_TexPoolUsed;
+			return pTex->id;
+		}
+	}
+
+	// Replace the least recently used
+	if (slot < 0) {
+		slot = 0;
+		for (int i = 1; i < SPOUT_TEXTURE_POOL; i++) {
+			if (m_TexPool[i].used < m_TexPool[slot].used)
+				slot = i;
+		}
+		RemoveFramebufferCache(m_TexPool[slot].id);
+		glDeleteTextures(1, &m_TexPool[slot].id);
+		if (m_TexID == m_TexPool[slot].id)
+			m_TexID = 0;
+		ZeroMemory(&m_TexPool[slot], sizeof(SpoutPoolTexture));
+	}
+
+	GLuint texID = 0;
+	glCreateTextures(GL_TEXTURE_2D, 1, &texID);
+	if (texID == 0)
+		return 0;
+	glTextureStorage2D(texID, 1, storageformat, (GLsizei)width, (GLsizei)height);
+
+	// Parameters as for InitTexture
+	GLint texturebinding = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texturebinding);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, texturebinding);
+
+	SpoutPoolTexture* pTex = &m_TexPool[slot];
+	pTex->id = texID;
+	pTex->format = GLformat;
+	pTex->width = width;
+	pTex->height = height;
+	pTex->context = context;
+	pTex->used = ++m_TexPoolUsed;
+
+	return texID;
+}
+
+// The texture is retained by the texture pool
+bool spoutGL::IsPoolTexture(GLuint texID)
+{
+	if (texID == 0)
+		return false;
+	for (int i = 0; i < SPOUT_TEXTURE_POOL; i++) {
+		if (m_TexPool[i].id == texID)
+			return true;
+	}
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: ReleaseTexturePool
+//   Delete the class textures retained for re-use.
+//
+//   Textures used for copy and invert are retained by size and format
+//   so that a receiver that changes between senders of different size
+//   does not delete and create them again. They are released by the
+//   destructor. Call before the OpenGL context is deleted.
+void spoutGL::ReleaseTexturePool()
+{
+	const HGLRC context = wglGetCurrentContext();
+	for (int i = 0; i < SPOUT_TEXTURE_POOL; i++) {
+		SpoutPoolTexture* pTex = &m_TexPool[i];
+		if (pTex->id && pTex->context == context) {
+			RemoveFramebufferCache(pTex->id);
+			glDeleteTextures(1, &pTex->id);
+		}
+		if (pTex->id == m_TexID) {
+			m_TexID = 0;
+			m_TexWidth = m_TexHeight = 0;
+		}
+	}
+	ZeroMemory(m_TexPool, sizeof(m_TexPool));
+}
+
+// Initialize OpenGL texture
+
+void spoutGL::InitTexture(GLuint &texID, GLenum GLformat, unsigned int width, unsigned int height)
+{
+	if (texID != 0) {
+		RemoveFramebufferCache(texID);
+		glDeleteTextures(1, &texID);
+	}
+	glGenTextures(1, &texID);
+
+	// Get current texture binding
+	GLint texturebinding;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texturebinding);
+
+	// Pixel type
+	GLenum type = GL_UNSIGNED_BYTE; // 8 bit RGBA
+	if (GLformat == GL_RGBA16) // Bit depth 16 bits
+		type = GL_UNSIGNED_SHORT;
+	else if (GLformat == GL_RGBA16F || GLformat == GL_RGBA32F) // float
+		type = GL_FLOAT;
+
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GLformat, width, height, 0, GL_RGBA, type, NULL);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, texturebinding);
+
+}
+
+
+//
+// COPY AN OPENGL TEXTURE TO THE SHARED OPENGL TEXTURE
+//
+// Allows for a texture attached to the fbo
+// where the input texture can be larger than the shared texture
+// and Width and height are the used portion. Only the used part is copied.
+//
+bool spoutGL::WriteGLDXtexture(GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+{
+	// Only for GL/DX interop mode
+	if (!m_hInteropDevice || !m_hInteropObject)
+		return false;
+
+	// Specify greater here because the width/height passed can be smaller
+	if (width > m_Width || height > m_Height)
+		return false;
+
+	spoutTimerScope scope(&timer, "WriteGLDXtexture");
+
+	SpoutTrace(SPOUT_TRACE_SEND_BEGIN, m_SenderName, frame.GetSenderFrame64());
+
+	// Create an fbo if not already
+	if (m_fbo == 0)
+		glGenFramebuffersEXT(1, &m_fbo);
+
+	// Wait for access to the shared texture
+	const LONG64 accessStart = timer.Start();
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		timer.Stop("CheckAccess", accessStart);
+		bool bWritten = false;
+		// lock dx interop object
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+			// Write to the shared texture
+			// The views of an array texture are copied without invert
+			BeginGLTime("GPUSharedCopy");
+			if (m_ArraySize > 1)
+				bWritten = CopyTextureLayers(TextureID, TextureTarget, m_glTexture, GL_TEXTURE_2D_ARRAY, width, height);
+			else
+				bWritten = SetSharedTextureData(TextureID, TextureTarget, width, height, bInvert, HostFBO);
+			EndGLTime();
+			if (bWritten) {
+				// Content hash published with the frame if enabled (EnableContentHash)
+				if (m_bContentHash && m_ArraySize == 1)
+					WriteContentHash();
+				// Increment the sender frame counter for successful write
+				frame.SetNewFrame();
+			}
+			// unlock dx object
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+		}
+		// Copy for CPU read back after unlock (SetSendReadback)
+		if (bWritten)
+			WriteSendReadback();
+		// Release mutex and allow access to the texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	// Read back of earlier frames without the texture locked
+	PollSendReadback();
+
+	SpoutTrace(SPOUT_TRACE_SEND_END, m_SenderName, frame.GetSenderFrame64());
+
+	return true;
+
+} // end WriteGLDXTexture
+
+
+// Hash of the shared texture content for the next frame published.
+// Receivers can skip copies of frames with the same content (SetSkipUnchanged).
+// The hash is computed after the copy to the shared texture with the interop
+// object locked, so the wait for the result is short.
+void spoutGL::WriteContentHash()
+{
+	// The compute shader reads 8 bit RGBA
+	if (m_DX11format != DXGI_FORMAT_B8G8R8A8_UNORM && m_DX11format != DXGI_FORMAT_R8G8B8A8_UNORM)
+		return;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	uint64_t hash = 0;
+	if (!m_pShaders->Hash(m_glTexture, m_Width, m_Height, hash)) {
+		SpoutLogWarning("spoutGL::WriteContentHash - compute shader not available, content hash disabled");
+		m_bContentHash = false;
+		return;
+	}
+	frame.SetContentHash(hash);
+}
+
+// Histograms and waveform of the linked shared texture for a receiver.
+// The dispatch is not waited for. The result is read by GetReceiveAnalysis.
+void spoutGL::ReadAnalysis()
+{
+	// The compute shader reads 8 bit RGBA
+	if (m_DX11format != DXGI_FORMAT_B8G8R8A8_UNORM && m_DX11format != DXGI_FORMAT_R8G8B8A8_UNORM)
+		return;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	if (!m_pShaders->Analyze(m_glTexture, m_Width, m_Height)) {
+		SpoutLogWarning("spoutGL::ReadAnalysis - compute shader not available, analysis disabled");
+		m_bReceiveAnalysis = false;
+	}
+}
+
+//
+// CPU read back of the frames sent (SetSendReadback)
+//
+
+// Copy the shared texture to the next staging texture of the read back ring.
+// Called after a successful write with the shared texture locked.
+// The copy is not waited for. PollSendReadback maps it when complete.
+void spoutGL::WriteSendReadback()
+{
+	if (!m_bSendReadback || !m_pSharedTexture || !spoutdx.GetDX11Context())
+		return;
+
+	D3D11_TEXTURE2D_DESC desc = { 0 };
+	m_pSharedTexture->GetDesc(&desc);
+
+	// Create or re-create the staging textures for the sender size and format
+	D3D11_TEXTURE2D_DESC stagingdesc = { 0 };
+	if (m_pReadbackStaging[0])
+		m_pReadbackStaging[0]->GetDesc(&stagingdesc);
+	if (!m_pReadbackStaging[0] || stagingdesc.Width != desc.Width
+		|| stagingdesc.Height != desc.Height || stagingdesc.Format != desc.Format) {
+		ReleaseSendReadback();
+		for (int i = 0; i < SPOUT_READBACK_STAGING; i++) {
+			if (!spoutdx.AcquireStagingTexture(spoutdx.GetDX11Device(), desc.Width, desc.Height, desc.Format, &m_pReadbackStaging[i])) {
+				SpoutLogWarning("spoutGL::WriteSendReadback - could not create staging textures, read back disabled");
+				ReleaseSendReadback();
+				m_bSendReadback = false;
+				return;
+			}
+		}
+	}
+
+	// The oldest is replaced if the ring is full.
+	// Its frame is dropped if the copy is still not complete.
+	const int index = m_ReadbackIndex;
+	if (m_ReadbackLatest == index)
+		m_ReadbackLatest = -1;
+	spoutdx.GetDX11Context()->CopyResource(m_pReadbackStaging[index], m_pSharedTexture);
+	// Submit the copy now
+	spoutdx.GetDX11Context()->Flush();
+	m_ReadbackFrame[index] = frame.GetSenderFrame64();
+	m_bReadbackPending[index] = true;
+	m_ReadbackIndex = (index + 1) % SPOUT_READBACK_STAGING;
+}
+
+// Map the staging textures with copies complete, oldest first, without waiting.
+// Each is passed to the read back callback if one has been set
+// and becomes the latest for ReadSendReadback.
+void spoutGL::PollSendReadback()
+{
+	if (!m_bSendReadback || !spoutdx.GetDX11Context())
+		return;
+
+	for (int i = 0; i < SPOUT_READBACK_STAGING; i++) {
+		// The next to copy to is the oldest
+		const int n = (m_ReadbackIndex + i) % SPOUT_READBACK_STAGING;
+		if (!m_bReadbackPending[n] || !m_pReadbackStaging[n])
+			continue;
+		D3D11_MAPPED_SUBRESOURCE mapped = {};
+		const HRESULT hr = spoutdx.GetDX11Context()->Map(m_pReadbackStaging[n], 0,
+			D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+		// Later copies are not complete either
+		if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+			break;
+		m_bReadbackPending[n] = false;
+		if (FAILED(hr))
+			continue;
+		if (m_ReadbackCallback) {
+			D3D11_TEXTURE2D_DESC desc = { 0 };
+			m_pReadbackStaging[n]->GetDesc(&desc);
+			SpoutReadbackFrame readback = {};
+			readback.data = static_cast<const unsigned char*>(mapped.pData);
+			readback.width = desc.Width;
+			readback.height = desc.Height;
+			readback.pitch = mapped.RowPitch;
+			readback.dwFormat = (DWORD)desc.Format;
+			readback.frame = m_ReadbackFrame[n];
+			m_ReadbackCallback(readback, m_pReadbackUserData);
+		}
+		spoutdx.GetDX11Context()->Unmap(m_pReadbackStaging[n], 0);
+		m_ReadbackLatest = n;
+	}
+}
+
+// Release the read back staging textures and reset the ring
+void spoutGL::ReleaseSendReadback()
+{
+	for (int i = 0; i < SPOUT_READBACK_STAGING; i++) {
+		// Return to the process pool
+		if (m_pReadbackStaging[i])
+			spoutdx.ReleaseStagingTexture(m_pReadbackStaging[i]);
+		m_pReadbackStaging[i] = nullptr;
+		m_ReadbackFrame[i] = 0;
+		m_bReadbackPending[i] = false;
+	}
+	m_ReadbackIndex = 0;
+	m_ReadbackLatest = -1;
+	m_ReadbackLastRead = -1;
+}
 
-	m_Width = 0;
-	m_Height = 0;
+//
+// COPY THE SHARED OPENGL TEXTURE TO AN OPENGL TEXTURE
+//
+bool spoutGL::ReadGLDXtexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+{
+	// No interop, no copy
+	if (!m_hInteropDevice || !m_hInteropObject) {
+		return false;
+	}
 
-	// ReleaseReceiver calls CleanupGL before restoring m_SenderName
-	// ReleaseSender clears the name
+	// No shared DX11 texture, no copy
+	if (!m_pSharedTexture)
+		return false;
 
-	// Flush D3D11 context to avoid deferred release
-	spoutdx.Flush();
+	// No texture read or zero OpenGL texture (allowed for by ReceiveTexture)
+	// the shared texture can be accessed directly
+	if (TextureID == 0) {
+		return true;
+	}
 
-	// Do not close DirectX device
+	// width and height must be the same as the shared texture
+	if (width != m_Width || height != m_Height) {
+		return false;
+	}
+
+	// No new frame, do not block
+	// GetNewFrame updates sender frame count and fps
+	if (!frame.GetNewFrame()) {
+		return true;
+	}
+
+	// Read the shared texture if the sender has produced a new frame
+	bool bRet = true; // Error only if texture read fails
+	spoutTimerScope scope(&timer, "ReadGLDXtexture");
+
+	// Wait for access to the shared texture
+	const LONG64 accessStart = timer.Start();
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		timer.Stop("CheckAccess", accessStart);
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+			// Copy the linked OpenGL texture (m_glTexture) to the user OpenGL texture
+			BeginGLTime("GPUSharedCopy");
+			if (m_ArraySize > 1)
+				bRet = CopyTextureLayers(m_glTexture, GL_TEXTURE_2D_ARRAY, TextureID, TextureTarget, width, height);
+			else if (IsToneMapped() && ToneMapSharedTexture(bInvert))
+				// Copy the 8 bit texture (m_TexID), already inverted if necessary
+				bRet = CopyTexture(m_TexID, GL_TEXTURE_2D, TextureID, TextureTarget, width, height, false, HostFBO);
+			else
+				bRet = CopyTexture(m_glTexture, GL_TEXTURE_2D, TextureID, TextureTarget, width, height, bInvert, HostFBO);
+			EndGLTime();
+			// Histograms and waveform in the same lock as the copy (SetReceiveAnalysis)
+			if (bRet && m_bReceiveAnalysis && m_ArraySize == 1)
+				ReadAnalysis();
+			SpoutTrace(SPOUT_TRACE_RECEIVE_COPY, m_SenderName, frame.GetSenderFrame64());
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+		}
+		// Release mutex and allow access to the texture
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	return bRet;
+
+} // end ReadGLDXTexture
+
+// Copy a region of the shared texture to an OpenGL texture of the region size
+bool spoutGL::ReadGLDXtexture(GLuint TextureID, GLuint TextureTarget,
+	unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+	bool bInvert, GLuint HostFBO)
+{
+	if (!m_hInteropDevice || !m_hInteropObject || !m_pSharedTexture)
+		return false;
+
+	if (TextureID == 0)
+		return true;
+
+	// The region must be within the shared texture
+	if (width == 0 || height == 0
+		|| xoffset >= m_Width || yoffset >= m_Height
+		|| width > m_Width - xoffset || height > m_Height - yoffset) {
+		SpoutLogWarning("spoutGL::ReadGLDXtexture - region %d, %d, %dx%d is not within %dx%d",
+			xoffset, yoffset, width, height, m_Width, m_Height);
+		return false;
+	}
+
+	if (!frame.GetNewFrame())
+		return true;
+
+	bool bRet = true;
+	spoutTimerScope scope(&timer, "ReadGLDXtexture");
+	const LONG64 accessStart = timer.Start();
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		timer.Stop("CheckAccess", accessStart);
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+			// Rows of the linked OpenGL texture are in the same order as 
+			// the DirectX texture, so the offsets are from the top left
+			BeginGLTime("GPUSharedCopy");
+			bRet = CopyTextureRegion(m_glTexture, GL_TEXTURE_2D, TextureID, TextureTarget,
+				xoffset, yoffset, width, height, bInvert, HostFBO);
+			EndGLTime();
+			SpoutTrace(SPOUT_TRACE_RECEIVE_COPY, m_SenderName, frame.GetSenderFrame64());
+			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+		}
+		frame.AllowTextureAccess(m_pSharedTexture);
+	}
+
+	return bRet;
 
 }
 
-// If a class OpenGL texture has not been created or it is a different size, create a new one
-// Typically used for texture copy and invert
-void spoutGL::CheckOpenGLTexture(GLuint &texID, GLenum GLformat, unsigned int width,  unsigned int height)
+
+// Interop must be locked for this function to access the shared texture
+bool spoutGL::SetSharedTextureData(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
 {
-	if (texID == 0 || texID != m_TexID 
-			|| GLformat != m_TexFormat 
-			|| width    != m_TexWidth 
-			|| height   != m_TexHeight) {
-		InitTexture(texID, GLformat, width, height);
-		m_TexID = texID;
-		m_TexWidth  = width;
-		m_TexHeight = height;
-		m_TexFormat = (DWORD)GLformat;
+	GLenum status = 0;
+	bool bRet = false;
+
+	// "TextureID" can be zero if it is attached to the fbo
+	// m_fbo is a local FBO, "m_glTexture" is destination texture,
+	// width/height are the dimensions of the destination texture.
+	// Because two fbos are used, the input texture can be larger than the shared texture
+	// Width and height are the used portion and only the used part is copied
+	if (TextureID == 0 && HostFBO >= 0) {
+		if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT) {
+			// The input texture is attached to attachment point 0 of the fbo passed in (HostFBO)
+			const GLuint drawFbo = GetTextureFbo(m_glTexture, GL_TEXTURE_2D);
+			if (drawFbo) {
+				// Bind the retained fbo with the shared texture attached for draw
+				glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, drawFbo);
+				status = GL_FRAMEBUFFER_COMPLETE_EXT;
+			}
+			else {
+				// Bind our local fbo for draw
+				glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, m_fbo);
+				// Draw to the first attachment point
+				glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+				// Attach the texture we write into (the shared texture)
+				glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_glTexture, 0);
+				// Check draw fbo for completeness
+				status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+			}
+			if (status == GL_FRAMEBUFFER_COMPLETE_EXT) {
+				if (m_bBLITavailable) {
+					if (bInvert)
+						// Copy from one framebuffer to the other while flipping upside down 
+						glBlitFramebufferEXT(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+					else
+						// Do not flip during blit
+						glBlitFramebufferEXT(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+				}
+				else {
+					// No fbo blit extension
+					// Copy from the host fbo (input texture attached) to the shared texture
+					glBindTexture(GL_TEXTURE_2D, m_glTexture);
+					glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+					glBindTexture(GL_TEXTURE_2D, 0);
+				}
+				bRet = true;
+			}
+			else {
+				PrintFBOstatus(status);
+				bRet = false;
+			}
+		}
+		else {
+			PrintFBOstatus(status);
+			bRet = false;
+		}
+		// restore host fbo
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+	}
+	else if (TextureID > 0) {
+		// There is a valid texture passed in, copy the input texture to the
+		// destination shared texture (m_glTexture), inverting as necessary.
+		// Both textures must be the same size.
+		bRet = CopyTexture(TextureID, TextureTarget, m_glTexture, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
 	}
+
+	return bRet;
+
 }
 
-// Initialize OpenGL texture
+//
+// COPY IMAGE PIXELS TO THE OPENGL SHARED TEXTURE
+//
+bool spoutGL::WriteGLDXpixels(const unsigned char* pixels,
+	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, GLuint HostFBO,
+	unsigned int pitch)
+{
+	if (width != m_Width || height != m_Height || !pixels)
+		return false;
 
-void spoutGL::InitTexture(GLuint &texID, GLenum GLformat, unsigned int width, unsigned int height)
+	// Padded lines are unpacked by OpenGL from the source pitch
+	// without compute conversion or PBOs that require packed pixels
+	const unsigned int bytes = (glFormat == GL_RGB || glFormat == GL_BGR_EXT) ? 3 : 4;
+	if (pitch > 0 && pitch != width*bytes) {
+		// Lines aligned to 2, 4 or 8 bytes, otherwise the line length in pixels
+		GLint alignment = 0;
+		GLint rowlength = 0;
+		for (GLint a = 8; a > 1; a /= 2) {
+			if (pitch == ((width*bytes + a - 1) / a) * a) {
+				alignment = a;
+				break;
+			}
+		}
+		if (alignment == 0) {
+			if (pitch % bytes != 0) {
+				SpoutLogWarning("spoutGL::WriteGLDXpixels - pitch %d not supported", pitch);
+				return false;
+			}
+			alignment = 1;
+			rowlength = (GLint)(pitch / bytes);
+		}
+		CheckOpenGLTexture(m_TexID, glFormat, width, height);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, rowlength);
+		glBindTexture(GL_TEXTURE_2D, m_TexID);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		return WriteGLDXtexture(m_TexID, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
+	}
+
+	// Compute shader conversion from the pixel format to a local RGBA8 texture
+	// with invert, then copy to the shared texture without invert
+	if (m_bComputeConversion && (m_caps & GLEXT_SUPPORT_COMPUTE)) {
+		CheckOpenGLTexture(m_TexID, GL_RGBA8, width, height);
+		if (LoadComputePixels(pixels, m_TexID, width, height, glFormat, bInvert))
+			return WriteGLDXtexture(m_TexID, GL_TEXTURE_2D, width, height, false, HostFBO);
+		// Use the default method if the shader fails
+		SpoutLogWarning("spoutGL::WriteGLDXpixels - compute conversion failed");
+		m_bComputeConversion = false;
+	}
+
+	// Use a GL texture so that WriteTexture can be used
+	// Create or resize a local OpenGL texture
+	CheckOpenGLTexture(m_TexID, glFormat, width, height);
+
+	// Transfer the pixels to the local texture
+	// Asynchronous by unpack PBOs if buffering is enabled
+	if (!m_bPBOavailable || !LoadTexturePixels(m_TexID, width, height, pixels, glFormat)) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // In case of RGB pixel data
+		glBindTexture(GL_TEXTURE_2D, m_TexID);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+
+	// Write the local texture to the shared texture and invert if necessary
+	return WriteGLDXtexture(m_TexID, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
+
+} // end WriteGLDXpixels
+
+
+//
+// COPY OPENGL SHARED TEXTURE TO IMAGE PIXELS
+//
+bool spoutGL::ReadGLDXpixels(unsigned char* pixels,
+	unsigned int width, unsigned int height,
+	GLenum glFormat, bool bInvert, GLuint HostFBO)
 {
-	if (texID != 0) glDeleteTextures(1, &texID);
-	glGenTextures(1, &texID);
+	if (!m_hInteropDevice || !m_hInteropObject) {
+		return false;
+	}
 
-	// Get current texture binding
-	GLint texturebinding;
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texturebinding);
+	// A pixel buffer of different size is resampled by compute shader
+	// so that the data read back is the size of the buffer
+	const bool bResample = (width != m_Width || height != m_Height);
+	if (bResample) {
+		if (width == 0 || height == 0 || !m_bPBOavailable || !(m_caps & GLEXT_SUPPORT_COMPUTE))
+			return false;
+	}
 
-	// Pixel type
-	GLenum type = GL_UNSIGNED_BYTE; // 8 bit RGBA
-	if (GLformat == GL_RGBA16) // Bit depth 16 bits
-		type = GL_UNSIGNED_SHORT;
-	else if (GLformat == GL_RGBA16F || GLformat == GL_RGBA32F) // float
-		type = GL_FLOAT;
+	// No new frame, do not block
+	if (!frame.GetNewFrame())
+		return true;
+
+	// Read texture pixels for a new frame
+	bool bRet = true; // Error only if pixel read fails
+
+	// retrieve opengl texture data directly to image pixels
+
+	// Wait for access to the shared texture
+	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+
+		// lock gl/dx interop object for access by OpenGL
+		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+
+			// Set single pixel alignment in case of rgb source
+			if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+			// Compute shader conversion to the final pixel layout in a PBO.
+			// The shared texture is copied to a local RGBA8 texture for the shader.
+			// RGB pixels are packed on the GPU to reduce the data read back.
+			const bool bRGB = (glFormat == GL_RGB || glFormat == GL_BGR_EXT);
+			bool bCompute = false;
+			if (bResample) {
+				bRet = ResampleComputePixels(pixels, width, height, glFormat, bInvert, HostFBO);
+				bCompute = true;
+			}
+			else if (IsToneMapped() && ToneMapSharedTexture(bInvert)) {
+				// A floating point sender is tone mapped to the 8 bit local texture
+				// and read as for an 8 bit sender
+				if (m_bPBOavailable)
+					bRet = UnloadTexturePixels(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				else
+					bRet = ReadTextureData(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				bCompute = true;
+			}
+			else if ((m_bComputeConversion || (bRGB && m_bComputeRGB))
+				&& m_bPBOavailable && (m_caps & GLEXT_SUPPORT_COMPUTE)) {
+				CheckOpenGLTexture(m_TexID, GL_RGBA8, width, height);
+				CopyTexture(m_glTexture, GL_TEXTURE_2D, m_TexID, GL_TEXTURE_2D, width, height, false, HostFBO);
+				bCompute = UnloadComputePixels(m_TexID, width, height, pixels, glFormat, bInvert);
+				if (!bCompute) {
+					// Use the default method if the shader fails
+					SpoutLogWarning("spoutGL::ReadGLDXpixels - compute conversion failed");
+					m_bComputeConversion = false;
+					m_bComputeRGB = false;
+				}
+			}
+
+			if (bCompute) {
+				// Pixels already copied
+			}
+			else if (bInvert) {
+				// Create or resize a local OpenGL texture
+				CheckOpenGLTexture(m_TexID, glFormat, width, height);
+				// Copy the shared texture to the local texture, inverting if necessary
+				CopyTexture(m_glTexture, GL_TEXTURE_2D, m_TexID, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
+				// Extract the pixels from the local texture - changing to the user passed format
+				// Use PBO method for maximum speed. ReadTextureData using glReadPixels is half the
+				// speed of using DX11 texture directly (ReadDX11pixels). Note that ReadDX11pixels
+				// has texture access and new frame checks and cannot be used if those checks
+				// have already been made.
+				if (m_bPBOavailable) {
+					bRet = UnloadTexturePixels(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				}
+				else {
+					bRet = ReadTextureData(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				}
+			}
+			else {
+				// Extract the pixels directly from the shared texture 
+				// dest must be RGBA or RGB width x height
+				if (m_bPBOavailable) {
+					bRet = UnloadTexturePixels(m_glTexture, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				}
+				else {
+					bRet = ReadTextureData(m_glTexture, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
+				}
+			}
+
+			// default alignment
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+		} // interop lock failed
+
+		// Ensure interop object is unlocked
+		UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
 
-	glBindTexture(GL_TEXTURE_2D, texID);
-	glTexImage2D(GL_TEXTURE_2D, 0, GLformat, width, height, 0, GL_RGBA, type, NULL);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glBindTexture(GL_TEXTURE_2D, texturebinding);
+		// Release mutex and allow access to the texture
+		frame.AllowTextureAccess(m_pSharedTexture);
 
-}
+	} // mutex access failed
+
+	return bRet;
 
+} // end ReadGLDXpixels 
 
 //
-// COPY AN OPENGL TEXTURE TO THE SHARED OPENGL TEXTURE
+// COPY OPENGL SHARED TEXTURE TO PLANAR YUV PIXELS
 //
-// Allows for a texture attached to the fbo
-// where the input texture can be larger than the shared texture
-// and Width and height are the used portion. Only the used part is copied.
+// The shared texture is copied to a local RGBA8 texture and converted
+// to NV12 or I420 by compute shader. The buffer is width*height*3/2 bytes.
+// The texture is sampled nearest if the buffer is a different size.
+// Requires OpenGL 4.3 compute shaders and PBO support.
 //
-bool spoutGL::WriteGLDXtexture(GLuint TextureID, GLuint TextureTarget,
-	unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+bool spoutGL::ReadGLDXyuv(unsigned char* pixels,
+	unsigned int width, unsigned int height,
+	SpoutYUVLayout layout, SpoutYUVMatrix matrix,
+	bool bFullRange, bool bInvert, GLuint HostFBO)
 {
-	// Only for GL/DX interop mode
-	if (!m_hInteropDevice || !m_hInteropObject)
+	if (!m_hInteropDevice || !m_hInteropObject || !pixels)
 		return false;
 
-	// Specify greater here because the width/height passed can be smaller
-	if (width > m_Width || height > m_Height)
+	if (!m_bPBOavailable || !(m_caps & GLEXT_SUPPORT_COMPUTE))
 		return false;
 
-	// Create an fbo if not already
-	if (m_fbo == 0)
-		glGenFramebuffersEXT(1, &m_fbo);
+	// No new frame, do not block
+	if (!frame.GetNewFrame())
+		return true;
+
+	bool bRet = false;
 
 	// Wait for access to the shared texture
 	if (frame.CheckTextureAccess(m_pSharedTexture)) {
-		// lock dx interop object
+		// lock gl/dx interop object for access by OpenGL
 		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
-			// Write to the shared texture
-			if (SetSharedTextureData(TextureID, TextureTarget, width, height, bInvert, HostFBO)) {
-				// Increment the sender frame counter for successful write
-				frame.SetNewFrame();
-			}
-			// unlock dx object
-			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+			// Local texture of the sender size for the shader
+			CheckOpenGLTexture(m_TexID, GL_RGBA8, m_Width, m_Height);
+			if (CopyTexture(m_glTexture, GL_TEXTURE_2D, m_TexID, GL_TEXTURE_2D, m_Width, m_Height, false, HostFBO))
+				bRet = UnloadComputeYUV(m_TexID, width, height, pixels, layout, matrix, bFullRange, bInvert);
+			if (!bRet)
+				SpoutLogWarning("spoutGL::ReadGLDXyuv - compute conversion failed");
 		}
+		// Ensure interop object is unlocked
+		UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
 		// Release mutex and allow access to the texture
 		frame.AllowTextureAccess(m_pSharedTexture);
 	}
 
-	return true;
+	return bRet;
 
-} // end WriteGLDXTexture
+} // end ReadGLDXyuv
 
 
 //
-// COPY THE SHARED OPENGL TEXTURE TO AN OPENGL TEXTURE
+// Asynchronous Read-back from an OpenGL texture
 //
-bool spoutGL::ReadGLDXtexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+// Used by a receiver to read pixels from a shared texture (ReceiveImage)
+//
+// Adapted from : http://www.songho.ca/opengl/gl_pbo.html
+// Also see : https://www.seas.upenn.edu/~pcozzi/OpenGLInsights/OpenGLInsights-AsynchronousBufferTransfers.pdf
+//
+bool spoutGL::UnloadTexturePixels(GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height, unsigned int rowpitch,
+	unsigned char* data, GLenum glFormat,
+	bool bInvert, GLuint HostFBO)
 {
-	// No interop, no copy
-	if (!m_hInteropDevice || !m_hInteropObject) {
-		return false;
-	}
+	void *pboMemory = nullptr;
+	int channels = 4; // RGBA or RGB
 
-	// No shared DX11 texture, no copy
-	if (!m_pSharedTexture)
+	if (!data) {
 		return false;
+	}
 
-	// No texture read or zero OpenGL texture (allowed for by ReceiveTexture)
-	// the shared texture can be accessed directly
-	if (TextureID == 0) {
+	// Read directly to the application buffer if pinned memory is enabled
+	if (!bInvert && UnloadPinnedPixels(TextureID, TextureTarget,
+		width, height, rowpitch, data, glFormat, HostFBO)) {
 		return true;
 	}
 
-	// width and height must be the same as the shared texture
-	if (width != m_Width || height != m_Height) {
-		return false;
+	// Persistent mapped buffers if enabled
+	if (m_bPersistentPbo && IsPersistentBufferAvailable()) {
+		return UnloadPersistentPixels(TextureID, TextureTarget,
+			width, height, rowpitch, data, glFormat, bInvert, HostFBO);
 	}
 
-	// No new frame, do not block
-	// GetNewFrame updates sender frame count and fps
-	if (!frame.GetNewFrame()) {
-		return true;
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT) {
+		channels = 3;
 	}
 
-	// Read the shared texture if the sender has produced a new frame
-	bool bRet = true; // Error only if texture read fails
+	// Casting first avoids warning C26451: Arithmetic overflow - with VS2022 code review
+	// https://docs.microsoft.com/en-us/visualstudio/code-quality/c26451
+	uint64_t pitch = rowpitch; // row pitch passed in
+	const uint64_t uw = static_cast<uint64_t>(width);
+	if (rowpitch == 0)
+		pitch = uw * channels; // RGB or RGBA
 
-	// Wait for access to the shared texture
-	if (frame.CheckTextureAccess(m_pSharedTexture)) {
-		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
-			// Copy the linked OpenGL texture (m_glTexture) to the user OpenGL texture
-			bRet = CopyTexture(m_glTexture, GL_TEXTURE_2D, TextureID, TextureTarget, width, height, bInvert, HostFBO);
-			UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+	// Create class fbo if not already
+	if (m_fbo == 0) {
+		SpoutLogNotice("spoutGL::UnloadTexturePixels - creating FBO");
+		glGenFramebuffersEXT(1, &m_fbo);
+	}
+
+	// Create pbos if not already
+	if (m_pbo[0] == 0) {
+		SpoutLogNotice("spoutGL::UnloadTexturePixels - creating %d PBOs", m_nBuffers);
+		glGenBuffers(m_nBuffers, m_pbo);
+		PboIndex = 0;
+		NextPboIndex = 0;
+	}
+
+	PboIndex = (PboIndex + 1) % m_nBuffers;
+	NextPboIndex = (PboIndex + 1) % m_nBuffers;
+
+	// If Texture ID is zero, the texture is already attached to the Host Fbo and we do nothing.
+	// If not, we need to attach the user texture to the class fbo we created.
+	if (TextureID > 0) {
+		const GLuint readFbo = GetTextureFbo(TextureID, TextureTarget);
+		if (readFbo) {
+			// Retained fbo with the texture attached to point 0
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, readFbo);
 		}
-		// Release mutex and allow access to the texture
-		frame.AllowTextureAccess(m_pSharedTexture);
+		else {
+			// Attach the texture to point 0
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+			glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, TextureTarget, TextureID, 0);
+		}
+		// Set the target framebuffer to read
+		glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+	}
+	else if (HostFBO == 0) {
+		// If no texture ID, a Host FBO must be provided
+		// testing only - error log will repeat
+		return false;
 	}
 
-	return bRet;
+	// Bind the PBO
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[PboIndex]);
 
-} // end ReadGLDXTexture
+	// Null existing PBO data to avoid a stall
+	// This allocates memory for at least pitch*height.
+	// For a size change, a PBO with data of the previous size
+	// is not mapped (see below) and the PBOs are not re-created.
+	const GLsizeiptr buffersize = (GLsizeiptr)(pitch * height);
+	glBufferData(GL_PIXEL_PACK_BUFFER, GetPboAllocation(buffersize), 0, GL_STREAM_READ);
+	m_pboSize[PboIndex] = buffersize;
+
+	// Read pixels from framebuffer to PBO - glReadPixels() should return immediately.
+	const GLint rowbytes = (int)pitch / channels; // row length in pixels
+	glPixelStorei(GL_PACK_ROW_LENGTH, rowbytes); // row length in pixels
+	glReadPixels(0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)0);
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 
+	// If there is data in the next pbo from the previous call, read it back
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[NextPboIndex]);
 
-// Interop must be locked for this function to access the shared texture
-bool spoutGL::SetSharedTextureData(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+	// Map the PBO to process its data by CPU
+	// The next pbo has no data store the first time
+	if (m_pboSize[NextPboIndex] == buffersize)
+		pboMemory = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+	// The next pbo is not mapped until it has been filled with data,
+	// so there is no error to remove (see CopyTextureRegion)
+
+	if (pboMemory && data) {
+		// Update data directly from the mapped buffer.
+		spoutcopy.CopyPixels((const unsigned char*)pboMemory, (unsigned char*)data, rowbytes, height, glFormat, bInvert);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	// skip the copy rather than return false.
+
+	// Back to conventional pixel operation
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// Restore the previous fbo binding
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+
+	return true;
+
+}
+
+//
+// Read-back from an OpenGL texture using persistent mapped PBOs
+//
+// The buffers are created once with glBufferStorage and remain mapped.
+// A fence is inserted after glReadPixels to each buffer, and the CPU
+// copies from the mapped pointer of the previous buffer when its fence
+// has signalled. This avoids glBufferData, glMapBuffer and glUnmapBuffer
+// for every frame and the implicit stall if the map waits for the GPU.
+// GL_MAP_COHERENT_BIT ensures that data is visible after the fence.
+//
+bool spoutGL::UnloadPersistentPixels(GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height, unsigned int rowpitch,
+	unsigned char* data, GLenum glFormat, bool bInvert, GLuint HostFBO)
 {
-	GLenum status = 0;
-	bool bRet = false;
+	int channels = 4; // RGBA or RGB
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
 
-	// "TextureID" can be zero if it is attached to the fbo
-	// m_fbo is a local FBO, "m_glTexture" is destination texture,
-	// width/height are the dimensions of the destination texture.
-	// Because two fbos are used, the input texture can be larger than the shared texture
-	// Width and height are the used portion and only the used part is copied
-	if (TextureID == 0 && HostFBO >= 0) {
-		if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT) {
-			// The input texture is attached to attachment point 0 of the fbo passed in (HostFBO)
-			// Bind our local fbo for draw
-			glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, m_fbo);
-			// Draw to the first attachment point
-			glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
-			// Attach the texture we write into (the shared texture)
-			glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_glTexture, 0);
-			// Check draw fbo for completeness
-			status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
-			if (status == GL_FRAMEBUFFER_COMPLETE_EXT) {
-				if (m_bBLITavailable) {
-					if (bInvert)
-						// Copy from one framebuffer to the other while flipping upside down 
-						glBlitFramebufferEXT(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-					else
-						// Do not flip during blit
-						glBlitFramebufferEXT(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-				}
-				else {
-					// No fbo blit extension
-					// Copy from the host fbo (input texture attached) to the shared texture
-					glBindTexture(GL_TEXTURE_2D, m_glTexture);
-					glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
-					glBindTexture(GL_TEXTURE_2D, 0);
-				}
-				bRet = true;
-			}
-			else {
-				PrintFBOstatus(status);
-				bRet = false;
+	uint64_t pitch = rowpitch;
+	const uint64_t uw = static_cast<uint64_t>(width);
+	if (rowpitch == 0)
+		pitch = uw * channels;
+	const GLsizeiptr buffersize = (GLsizeiptr)(pitch * height);
+
+	if (TextureID == 0 && HostFBO == 0)
+		return false;
+
+	if (m_fbo == 0) {
+		SpoutLogNotice("spoutGL::UnloadPersistentPixels - creating FBO");
+		glGenFramebuffersEXT(1, &m_fbo);
+	}
+
+	// Re-create the buffers for a change of size or number
+	if (m_nPersistent > 0 && (buffersize != m_persistentSize || m_nPersistent != m_nBuffers))
+		ReleasePersistentBuffers();
+
+	// Create persistent mapped buffers if not already
+	if (m_nPersistent == 0) {
+		m_nPersistent = m_nBuffers;
+		if (m_nPersistent < 2) m_nPersistent = 2;
+		if (m_nPersistent > 4) m_nPersistent = 4;
+		SpoutLogNotice("spoutGL::UnloadPersistentPixels - creating %d persistent PBOs (%d bytes)", m_nPersistent, (int)buffersize);
+		glGenBuffers(m_nPersistent, m_persistentPbo);
+		const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		for (int i = 0; i < m_nPersistent; i++) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, m_persistentPbo[i]);
+			glBufferStorage(GL_PIXEL_PACK_BUFFER, buffersize, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+			m_pPersistentMap[i] = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buffersize, flags);
+			if (!m_pPersistentMap[i]) {
+				SpoutLogWarning("spoutGL::UnloadPersistentPixels - could not map persistent buffer, using PBO map");
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				ReleasePersistentBuffers();
+				// Do not try again
+				m_bPersistentPbo = false;
+				return UnloadTexturePixels(TextureID, TextureTarget,
+					width, height, rowpitch, data, glFormat, bInvert, HostFBO);
 			}
 		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		m_persistentSize = buffersize;
+		m_persistentIndex = 0;
+	}
+
+	const int index = m_persistentIndex;
+	const int next = (index + 1) % m_nPersistent;
+	m_persistentIndex = next;
+
+	// Attach the texture to the class fbo as for UnloadTexturePixels
+	if (TextureID > 0) {
+		const GLuint readFbo = GetTextureFbo(TextureID, TextureTarget);
+		if (readFbo) {
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, readFbo);
+		}
 		else {
-			PrintFBOstatus(status);
-			bRet = false;
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+			glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, TextureTarget, TextureID, 0);
 		}
-		// restore host fbo
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+		glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
 	}
-	else if (TextureID > 0) {
-		// There is a valid texture passed in, copy the input texture to the
-		// destination shared texture (m_glTexture), inverting as necessary.
-		// Both textures must be the same size.
-		bRet = CopyTexture(TextureID, TextureTarget, m_glTexture, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
+
+	// Read pixels to the current buffer and fence the read
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_persistentPbo[index]);
+	const GLint rowbytes = (int)pitch / channels; // row length in pixels
+	glPixelStorei(GL_PACK_ROW_LENGTH, rowbytes);
+	glReadPixels(0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)0);
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if (m_persistentSync[index])
+		glDeleteSync(m_persistentSync[index]);
+	m_persistentSync[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	// Copy from the next buffer, filled by a previous call, when its read is complete.
+	// The wait is normally satisfied at once because the read was at least one frame ago.
+	if (m_persistentSync[next]) {
+		const GLenum result = glClientWaitSync(m_persistentSync[next], GL_SYNC_FLUSH_COMMANDS_BIT, 4000000); // 4 msec
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+			spoutcopy.CopyPixels((const unsigned char*)m_pPersistentMap[next], data, rowbytes, height, glFormat, bInvert);
+			glDeleteSync(m_persistentSync[next]);
+			m_persistentSync[next] = nullptr;
+		}
+		// Skip the copy for timeout rather than return false
+	}
+
+	// Restore the previous fbo binding
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+
+	return true;
+}
+
+//
+// Upload to an OpenGL texture using a ring of unpack PBOs
+//
+// Used by a sender to write pixels to the shared texture (SendImage)
+//
+// The pixels are copied to a PBO and glTexSubImage2D is sourced from it,
+// so the call returns as soon as the copy is done and the driver transfers
+// from the buffer while the next frame is copied to the next buffer.
+//
+// By default each buffer is orphaned with glBufferData before it is mapped
+// so that the map does not wait for the previous upload from it.
+// With SetPersistentBufferMode, the buffers are created once with glBufferStorage,
+// remain mapped and are written to directly after a fence for the last upload has signalled.
+//
+bool spoutGL::LoadTexturePixels(GLuint TextureID, unsigned int width, unsigned int height,
+	const unsigned char* data, GLenum glFormat)
+{
+	if (!data || TextureID == 0)
+		return false;
+
+	uint64_t channels = 4; // RGBA or BGRA
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
+	else if (glFormat == GL_LUMINANCE)
+		channels = 1;
+	const GLsizeiptr buffersize = (GLsizeiptr)(static_cast<uint64_t>(width)*height*channels);
+
+	const bool bPersistent = m_bPersistentPbo && IsPersistentBufferAvailable();
+
+	// Re-create the buffers for a change of size, number or mode
+	if (m_nUnpack > 0 && (buffersize != m_unpackSize || m_nUnpack != m_nBuffers
+		|| bPersistent != m_bUnpackPersistent))
+		ReleaseUnpackBuffers();
+
+	// Create the buffers if not already
+	if (m_nUnpack == 0) {
+		m_nUnpack = m_nBuffers;
+		if (m_nUnpack < 2) m_nUnpack = 2;
+		if (m_nUnpack > 4) m_nUnpack = 4;
+		SpoutLogNotice("spoutGL::LoadTexturePixels - creating %d %sPBOs (%d bytes)",
+			m_nUnpack, bPersistent ? "persistent " : "", (int)buffersize);
+		glGenBuffers(m_nUnpack, m_unpackPbo);
+		if (bPersistent) {
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			for (int i = 0; i < m_nUnpack; i++) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_unpackPbo[i]);
+				glBufferStorage(GL_PIXEL_UNPACK_BUFFER, buffersize, nullptr, flags);
+				m_pUnpackMap[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffersize, flags);
+				if (!m_pUnpackMap[i]) {
+					SpoutLogWarning("spoutGL::LoadTexturePixels - could not map persistent buffer");
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					ReleaseUnpackBuffers();
+					m_bPersistentPbo = false;
+					return false;
+				}
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		m_unpackSize = buffersize;
+		m_unpackIndex = 0;
+		m_bUnpackPersistent = bPersistent;
+	}
+
+	const int index = m_unpackIndex;
+	m_unpackIndex = (index + 1) % m_nUnpack;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_unpackPbo[index]);
+
+	void* pboMemory = nullptr;
+	if (m_bUnpackPersistent) {
+		// Wait until the last upload from this buffer is complete.
+		// Normally already signalled because it was (buffers-1) frames ago.
+		if (m_unpackSync[index]) {
+			const GLenum result = glClientWaitSync(m_unpackSync[index], GL_SYNC_FLUSH_COMMANDS_BIT, 16000000); // 16 msec
+			glDeleteSync(m_unpackSync[index]);
+			m_unpackSync[index] = nullptr;
+			if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				return false;
+			}
+		}
+		pboMemory = m_pUnpackMap[index];
+	}
+	else {
+		// Orphan the buffer so that the map does not wait for a previous upload from it
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, buffersize, 0, GL_STREAM_DRAW);
+		pboMemory = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
 	}
 
-	return bRet;
-
-}
-
-//
-// COPY IMAGE PIXELS TO THE OPENGL SHARED TEXTURE
-//
-bool spoutGL::WriteGLDXpixels(const unsigned char* pixels,
-	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, GLuint HostFBO)
-{
-	if (width != m_Width || height != m_Height || !pixels)
+	if (!pboMemory) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 		return false;
+	}
 
-	// Use a GL texture so that WriteTexture can be used
-	// Create or resize a local OpenGL texture
-	CheckOpenGLTexture(m_TexID, glFormat, width, height);
+	// Copy the pixels to the buffer (CPU)
+	spoutcopy.CopyPixels(data, (unsigned char*)pboMemory, width, height, glFormat, false);
 
-	// Transfer the pixels to the local texture
+	if (!m_bUnpackPersistent)
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// Upload from the buffer (GPU) - glTexSubImage2D returns immediately
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // In case of RGB pixel data
-	glBindTexture(GL_TEXTURE_2D, m_TexID);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)pixels);
+	glBindTexture(GL_TEXTURE_2D, TextureID);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)0);
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-	// Write the local texture to the shared texture and invert if necessary
-	return WriteGLDXtexture(m_TexID, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
+	// Fence the upload so that the buffer is not written until it is complete
+	if (m_bUnpackPersistent)
+		m_unpackSync[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-} // end WriteGLDXpixels
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Release unpack PBOs and fences
+void spoutGL::ReleaseUnpackBuffers()
+{
+	if (m_nUnpack == 0)
+		return;
+
+	if (wglGetCurrentContext()) {
+		for (int i = 0; i < m_nUnpack; i++) {
+			if (m_unpackSync[i])
+				glDeleteSync(m_unpackSync[i]);
+			if (m_pUnpackMap[i] && m_unpackPbo[i]) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_unpackPbo[i]);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			}
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(m_nUnpack, m_unpackPbo);
+	}
 
+	for (int i = 0; i < 4; i++) {
+		m_unpackPbo[i] = 0;
+		m_pUnpackMap[i] = nullptr;
+		m_unpackSync[i] = nullptr;
+	}
+	m_unpackSize = 0;
+	m_nUnpack = 0;
+	m_unpackIndex = 0;
+	m_bUnpackPersistent = false;
+}
 
 //
-// COPY OPENGL SHARED TEXTURE TO IMAGE PIXELS
+// Read-back from an OpenGL texture directly to application memory
 //
-bool spoutGL::ReadGLDXpixels(unsigned char* pixels,
-	unsigned int width, unsigned int height,
-	GLenum glFormat, bool bInvert, GLuint HostFBO)
+// With GL_AMD_pinned_memory, a buffer can use the application buffer as its
+// data store. glReadPixels to that buffer is transferred by the GPU to the
+// application memory and there is no map or copy of a PBO.
+//
+// The buffer is pinned when the same address and size are passed again,
+// so that a buffer re-allocated for each frame is not pinned. The read is
+// complete when the fence signals, so the pixels are of the current frame.
+// Returns false if the memory could not be pinned and the PBO method is used.
+//
+bool spoutGL::UnloadPinnedPixels(GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height, unsigned int rowpitch,
+	unsigned char* data, GLenum glFormat, GLuint HostFBO)
 {
-	if (!m_hInteropDevice || !m_hInteropObject) {
+	if (!m_bPinnedMemory || !data || !IsPinnedMemoryAvailable() || !m_bFBOavailable)
 		return false;
-	}
 
-	if (width != m_Width || height != m_Height) {
+	if (TextureID == 0 && HostFBO == 0)
+		return false;
+
+	int channels = 4; // RGBA or RGB
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
+
+	uint64_t pitch = rowpitch;
+	const uint64_t uw = static_cast<uint64_t>(width);
+	if (rowpitch == 0)
+		pitch = uw * channels;
+	const GLsizeiptr buffersize = (GLsizeiptr)(pitch * height);
+
+	// The application buffer must be the same as the last read
+	if (data != m_pPinnedData || buffersize != m_pinnedSize) {
+		ReleasePinnedBuffer();
+		m_pPinnedData = data;
+		m_pinnedSize = buffersize;
 		return false;
 	}
 
-	// No new frame, do not block
-	if (!frame.GetNewFrame())
-		return true;
+	// Pin the application buffer if not already
+	if (m_pinnedPbo == 0) {
 
-	// Read texture pixels for a new frame
-	bool bRet = true; // Error only if pixel read fails
+		// Already tried for this buffer
+		if (m_bPinnedFailed)
+			return false;
 
-	// retrieve opengl texture data directly to image pixels
+		// The memory must be page aligned
+		if ((reinterpret_cast<uintptr_t>(data) & 4095) != 0) {
+			SpoutLogNotice("spoutGL::UnloadPinnedPixels - buffer is not page aligned, using PBO");
+			m_bPinnedFailed = true;
+			return false;
+		}
 
-	// Wait for access to the shared texture
-	if (frame.CheckTextureAccess(m_pSharedTexture)) {
+		while (glGetError() != GL_NO_ERROR) {} // Clear previous errors
+		glGenBuffers(1, &m_pinnedPbo);
+		glBindBuffer(GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD, m_pinnedPbo);
+		glBufferData(GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD, buffersize, data, GL_STREAM_READ);
+		glBindBuffer(GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD, 0);
+		if (glGetError() != GL_NO_ERROR) {
+			SpoutLogWarning("spoutGL::UnloadPinnedPixels - could not pin the buffer, using PBO");
+			glDeleteBuffers(1, &m_pinnedPbo);
+			m_pinnedPbo = 0;
+			m_bPinnedFailed = true;
+			return false;
+		}
+		SpoutLogNotice("spoutGL::UnloadPinnedPixels - pinned %d bytes at 0x%.7X", (int)buffersize, PtrToUint(data));
+	}
 
-		// lock gl/dx interop object for access by OpenGL
-		if (LockInteropObject(m_hInteropDevice, &m_hInteropObject) == S_OK) {
+	if (m_fbo == 0) {
+		SpoutLogNotice("spoutGL::UnloadPinnedPixels - creating FBO");
+		glGenFramebuffersEXT(1, &m_fbo);
+	}
 
-			// Set single pixel alignment in case of rgb source
-			if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
-				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	// Attach the texture to the class fbo as for UnloadTexturePixels
+	if (TextureID > 0) {
+		const GLuint readFbo = GetTextureFbo(TextureID, TextureTarget);
+		if (readFbo) {
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, readFbo);
+		}
+		else {
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+			glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, TextureTarget, TextureID, 0);
+		}
+		glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+	}
 
-			if (bInvert) {
-				// Create or resize a local OpenGL texture
-				CheckOpenGLTexture(m_TexID, glFormat, width, height);
-				// Copy the shared texture to the local texture, inverting if necessary
-				CopyTexture(m_glTexture, GL_TEXTURE_2D, m_TexID, GL_TEXTURE_2D, width, height, bInvert, HostFBO);
-				// Extract the pixels from the local texture - changing to the user passed format
-				// Use PBO method for maximum speed. ReadTextureData using glReadPixels is half the
-				// speed of using DX11 texture directly (ReadDX11pixels). Note that ReadDX11pixels
-				// has texture access and new frame checks and cannot be used if those checks
-				// have already been made.
-				if (m_bPBOavailable) {
-					bRet = UnloadTexturePixels(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
-				}
-				else {
-					bRet = ReadTextureData(m_TexID, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
-				}
-			}
-			else {
-				// Extract the pixels directly from the shared texture 
-				// dest must be RGBA or RGB width x height
-				if (m_bPBOavailable) {
-					bRet = UnloadTexturePixels(m_glTexture, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
-				}
-				else {
-					bRet = ReadTextureData(m_glTexture, GL_TEXTURE_2D, width, height, 0, pixels, glFormat, false, HostFBO);
-				}
-			}
+	// Read pixels to the pinned buffer
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pinnedPbo);
+	const GLint rowbytes = (int)pitch / channels; // row length in pixels
+	glPixelStorei(GL_PACK_ROW_LENGTH, rowbytes);
+	glReadPixels(0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)0);
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-			// default alignment
-			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	// Wait for the transfer to the application buffer
+	GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	if (sync) {
+		const GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 msec
+		if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+			glFinish();
+		glDeleteSync(sync);
+	}
+	else {
+		glFinish();
+	}
 
-		} // interop lock failed
+	// Restore the previous fbo binding
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
 
-		// Ensure interop object is unlocked
-		UnlockInteropObject(m_hInteropDevice, &m_hInteropObject);
+	return true;
+}
 
-		// Release mutex and allow access to the texture
-		frame.AllowTextureAccess(m_pSharedTexture);
+//---------------------------------------------------------
+// Release the buffer using pinned application memory.
+// The application buffer can then be freed.
+void spoutGL::ReleasePinnedBuffer()
+{
+	if (m_pinnedPbo > 0 && wglGetCurrentContext()) {
+		// Wait for any read to the application memory
+		glFinish();
+		glDeleteBuffers(1, &m_pinnedPbo);
+	}
+	m_pinnedPbo = 0;
+	m_bPinnedFailed = false;
+}
 
-	} // mutex access failed
+//---------------------------------------------------------
+// Release persistent mapped PBOs and fences
+void spoutGL::ReleasePersistentBuffers()
+{
+	if (m_nPersistent == 0)
+		return;
 
-	return bRet;
+	if (wglGetCurrentContext()) {
+		for (int i = 0; i < m_nPersistent; i++) {
+			if (m_persistentSync[i])
+				glDeleteSync(m_persistentSync[i]);
+			if (m_pPersistentMap[i] && m_persistentPbo[i]) {
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, m_persistentPbo[i]);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glDeleteBuffers(m_nPersistent, m_persistentPbo);
+	}
+
+	for (int i = 0; i < 4; i++) {
+		m_persistentPbo[i] = 0;
+		m_pPersistentMap[i] = nullptr;
+		m_persistentSync[i] = nullptr;
+	}
+	m_persistentSize = 0;
+	m_nPersistent = 0;
+	m_persistentIndex = 0;
+}
 
-} // end ReadGLDXpixels 
 
 
 //
-// Asynchronous Read-back from an OpenGL texture
-//
-// Used by a receiver to read pixels from a shared texture (ReceiveImage)
+// Size of the PBO data store for pixel data of a given size
 //
-// Adapted from : http://www.songho.ca/opengl/gl_pbo.html
-// Also see : https://www.seas.upenn.edu/~pcozzi/OpenGLInsights/OpenGLInsights-AsynchronousBufferTransfers.pdf
+// The first allocation is the data size. If the data size changes,
+// the allocation is increased with headroom (SPOUT_RESIZE_HEADROOM)
+// and is retained until the data is larger or less than half,
+// so that a sender that resizes continuously does not cause
+// a re-allocation of different size for every frame.
 //
-bool spoutGL::UnloadTexturePixels(GLuint TextureID, GLuint TextureTarget,
-	unsigned int width, unsigned int height, unsigned int rowpitch,
-	unsigned char* data, GLenum glFormat,
-	bool bInvert, GLuint HostFBO)
+GLsizeiptr spoutGL::GetPboAllocation(GLsizeiptr datasize)
 {
-	void *pboMemory = nullptr;
-	int channels = 4; // RGBA or RGB
+	if (m_pboAlloc == 0) {
+		m_pboAlloc = datasize;
+	}
+	else if (datasize > m_pboAlloc || datasize < m_pboAlloc/2) {
+		m_pboAlloc = datasize + datasize/SPOUT_RESIZE_HEADROOM;
+		// Whole 4K pages
+		m_pboAlloc = (m_pboAlloc + 4095) & ~((GLsizeiptr)4095);
+	}
+	return m_pboAlloc;
+}
 
-	if (!data) {
+//
+// Read-back from an OpenGL texture using a compute shader
+//
+// Pixel format conversion, invert and RGB packing are done by the shader
+// so that the PBO contains the final pixel layout.
+// The texture internal format must be GL_RGBA8.
+// A ring of PBOs is used as for UnloadTexturePixels.
+//
+bool spoutGL::UnloadComputePixels(GLuint TextureID, unsigned int width, unsigned int height,
+	unsigned char* data, GLenum glFormat, bool bInvert)
+{
+	if (!data || TextureID == 0)
 		return false;
-	}
 
-	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT) {
-		channels = 3;
-	}
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
 
-	// Casting first avoids warning C26451: Arithmetic overflow - with VS2022 code review
-	// https://docs.microsoft.com/en-us/visualstudio/code-quality/c26451
-	uint64_t pitch = rowpitch; // row pitch passed in
-	const uint64_t uw = static_cast<uint64_t>(width);
-	if (rowpitch == 0)
-		pitch = uw * channels; // RGB or RGBA
+	uint64_t channels = 4; // RGBA or RGB
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
 
-	// Create class fbo if not already
-	if (m_fbo == 0) {
-		SpoutLogNotice("spoutGL::UnloadTexturePixels - creating FBO");
-		glGenFramebuffersEXT(1, &m_fbo);
-	}
+	// The shader writes whole 32 bit words
+	const uint64_t datasize = static_cast<uint64_t>(width)*height*channels;
+	const GLint buffersize = (GLint)((datasize + 3) & ~3ULL);
 
 	// Create pbos if not already
 	if (m_pbo[0] == 0) {
-		SpoutLogNotice("spoutGL::UnloadTexturePixels - creating %d PBOs", m_nBuffers);
+		SpoutLogNotice("spoutGL::UnloadComputePixels - creating %d PBOs", m_nBuffers);
 		glGenBuffers(m_nBuffers, m_pbo);
 		PboIndex = 0;
 		NextPboIndex = 0;
@@ -2050,75 +4662,219 @@ bool spoutGL::UnloadTexturePixels(GLuint TextureID, GLuint TextureTarget,
 	PboIndex = (PboIndex + 1) % m_nBuffers;
 	NextPboIndex = (PboIndex + 1) % m_nBuffers;
 
-	// If Texture ID is zero, the texture is already attached to the Host Fbo and we do nothing.
-	// If not, we need to attach the user texture to the class fbo we created.
-	if (TextureID > 0) {
-		// Attach the texture to point 0
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
-		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, TextureTarget, TextureID, 0);
-		// Set the target framebuffer to read
-		glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
-	}
-	else if (HostFBO == 0) {
-		// If no texture ID, a Host FBO must be provided
-		// testing only - error log will repeat
+	// Null existing PBO data to avoid a stall
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_pbo[PboIndex]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GetPboAllocation((GLsizeiptr)buffersize), 0, GL_STREAM_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	m_pboSize[PboIndex] = (GLsizeiptr)buffersize;
+
+	// Texture to PBO in the final pixel layout
+	BeginGLTime("GPUShader");
+	const bool bUnloaded = m_pShaders->Unload(TextureID, m_pbo[PboIndex], width, height,
+		(unsigned int)(width*channels), glFormat, bInvert);
+	EndGLTime();
+	if (!bUnloaded)
 		return false;
+
+	// If there is data in the next pbo from the previous call, read it back
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[NextPboIndex]);
+
+	// Skip a pbo of a different size or not filled yet
+	if (m_pboSize[NextPboIndex] == (GLsizeiptr)buffersize) {
+		void* pboMemory = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+		if (pboMemory) {
+			// No conversion needed
+			spoutcopy.CopyPixels((const unsigned char*)pboMemory, data, width, height, glFormat, false);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
 	}
 
-	// Bind the PBO
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[PboIndex]);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-	// Check it's size
-	GLint size = 0;
-	glGetBufferParameteriv(GL_PIXEL_PACK_BUFFER, GL_BUFFER_SIZE, &size);
-	if (size > 0 && size != (int)(pitch * height)) {
-		// All PBOs must be re-created
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
-		glDeleteBuffers(m_nBuffers, m_pbo);
-		m_pbo[0] = m_pbo[1] = m_pbo[2] = m_pbo[3] = 0;
+	return true;
+}
+
+//
+// Read-back of planar YUV from an OpenGL texture using a compute shader
+//
+// NV12 or I420 of width*height*3/2 bytes. The texture internal format
+// must be GL_RGBA8. A ring of PBOs is used as for UnloadComputePixels.
+//
+bool spoutGL::UnloadComputeYUV(GLuint TextureID, unsigned int width, unsigned int height,
+	unsigned char* data, SpoutYUVLayout layout, SpoutYUVMatrix matrix,
+	bool bFullRange, bool bInvert)
+{
+	if (!data || TextureID == 0)
 		return false;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	// Y plane and two chroma planes of quarter size
+	// The shader writes whole 32 bit words
+	const uint64_t datasize = static_cast<uint64_t>(width)*height*3/2;
+	const GLint buffersize = (GLint)((datasize + 3) & ~3ULL);
+
+	// Create pbos if not already
+	if (m_pbo[0] == 0) {
+		SpoutLogNotice("spoutGL::UnloadComputeYUV - creating %d PBOs", m_nBuffers);
+		glGenBuffers(m_nBuffers, m_pbo);
+		PboIndex = 0;
+		NextPboIndex = 0;
 	}
 
-	// Null existing PBO data to avoid a stall
-	// This allocates memory for the PBO pitch*height wide
-	const GLsizeiptr buffersize = (GLsizeiptr)(pitch * height);
-	glBufferData(GL_PIXEL_PACK_BUFFER, buffersize, 0, GL_STREAM_READ);
+	PboIndex = (PboIndex + 1) % m_nBuffers;
+	NextPboIndex = (PboIndex + 1) % m_nBuffers;
 
-	// Read pixels from framebuffer to PBO - glReadPixels() should return immediately.
-	const GLint rowbytes = (int)pitch / channels; // row length in pixels
-	glPixelStorei(GL_PACK_ROW_LENGTH, rowbytes); // row length in pixels
-	glReadPixels(0, 0, width, height, glFormat, GL_UNSIGNED_BYTE, (GLvoid *)0);
-	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	// Null existing PBO data to avoid a stall
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_pbo[PboIndex]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GetPboAllocation((GLsizeiptr)buffersize), 0, GL_STREAM_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	m_pboSize[PboIndex] = (GLsizeiptr)buffersize;
+
+	// Texture to PBO as planar YUV
+	BeginGLTime("GPUShader");
+	const bool bUnloaded = m_pShaders->UnloadYUV(TextureID, m_pbo[PboIndex], width, height,
+		layout == SPOUT_YUV_I420, matrix == SPOUT_YUV_BT709, bFullRange, bInvert);
+	EndGLTime();
+	if (!bUnloaded)
+		return false;
 
 	// If there is data in the next pbo from the previous call, read it back
 	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[NextPboIndex]);
 
-	// Map the PBO to process its data by CPU
-	pboMemory = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	// Skip a pbo of a different size or not filled yet
+	if (m_pboSize[NextPboIndex] == (GLsizeiptr)buffersize) {
+		void* pboMemory = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+		if (pboMemory) {
+			// Already in the layout of the receiving buffer
+			memcpy(data, pboMemory, (size_t)datasize);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return true;
+}
+
+//
+// Read pixels of a different size than the shared texture
+//
+// The shared texture is copied to a local RGBA8 texture and resampled
+// to a texture of the pixel buffer size, so that readback scales
+// with the size of the pixel buffer rather than the sender.
+// The interop object must be locked.
+//
+bool spoutGL::ResampleComputePixels(unsigned char* pixels, unsigned int width, unsigned int height,
+	GLenum glFormat, bool bInvert, GLuint HostFBO)
+{
+	if (!pixels || width == 0 || height == 0)
+		return false;
+
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
+
+	// Local texture of the sender size
+	CheckOpenGLTexture(m_TexID, GL_RGBA8, m_Width, m_Height);
+	if (!CopyTexture(m_glTexture, GL_TEXTURE_2D, m_TexID, GL_TEXTURE_2D, m_Width, m_Height, false, HostFBO))
+		return false;
+
+	// Texture of the pixel buffer size
+	if (m_resampleTexture == 0 || width != m_resampleWidth || height != m_resampleHeight) {
+		InitTexture(m_resampleTexture, GL_RGBA8, width, height);
+		m_resampleWidth = width;
+		m_resampleHeight = height;
+	}
+
+	BeginGLTime("GPUShader");
+	const bool bResampled = m_pShaders->Resample(m_TexID, m_resampleTexture, width, height, m_ResampleMode);
+	EndGLTime();
+	if (!bResampled) {
+		SpoutLogWarning("spoutGL::ResampleComputePixels - resample failed");
+		return false;
+	}
+
+	return UnloadComputePixels(m_resampleTexture, width, height, pixels, glFormat, bInvert);
+}
+
+//
+// Tone map the linked texture of a floating point sender
+// to the local 8 bit texture (m_TexID) of the sender size.
+// Copy or read back is then a quarter or an eighth of the float data.
+// The interop object must be locked.
+//
+bool spoutGL::ToneMapSharedTexture(bool bInvert)
+{
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
 
-	// glMapBuffer can return NULL when called the first time
-	// when the next pbo has not been filled with data yet
-	glGetError(); // remove the last error
+	CheckOpenGLTexture(m_TexID, GL_RGBA8, m_Width, m_Height);
 
-	if (pboMemory && data) {
-		// Update data directly from the mapped buffer.
-		spoutcopy.CopyPixels((const unsigned char*)pboMemory, (unsigned char*)data, rowbytes, height, glFormat, bInvert);
-		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	BeginGLTime("GPUShader");
+	const bool bMapped = m_pShaders->ToneMap(m_glTexture, m_TexID, m_Width, m_Height,
+		m_ToneMap, m_ToneMapExposure, bInvert);
+	EndGLTime();
+	if (!bMapped) {
+		// Use the default copy if the shader fails
+		SpoutLogWarning("spoutGL::ToneMapSharedTexture - tone map failed");
+		m_ToneMap = SPOUT_TONEMAP_NONE;
 	}
-	// skip the copy rather than return false.
 
-	// Back to conventional pixel operation
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return bMapped;
+}
 
-	// Restore the previous fbo binding
-	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+// Tone mapping is enabled and the sender texture is floating point
+bool spoutGL::IsToneMapped()
+{
+	return (m_ToneMap != SPOUT_TONEMAP_NONE
+		&& (m_caps & GLEXT_SUPPORT_COMPUTE) && m_ArraySize == 1
+		&& (m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT
+		 || m_dwFormat == DXGI_FORMAT_R32G32B32A32_FLOAT));
+}
 
-	return true;
+//
+// Upload pixels to an OpenGL texture using a compute shader
+//
+// The pixels are copied to a buffer object without conversion.
+// Pixel format conversion and invert are done by the shader.
+// The texture internal format must be GL_RGBA8.
+//
+bool spoutGL::LoadComputePixels(const unsigned char* data, GLuint TextureID,
+	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+{
+	if (!data || TextureID == 0)
+		return false;
 
-}
+	if (!m_pShaders)
+		m_pShaders = new spoutShaders;
 
+	uint64_t channels = 4;
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
+
+	// The shader reads whole 32 bit words
+	const uint64_t datasize = static_cast<uint64_t>(width)*height*channels;
+	const GLsizeiptr buffersize = (GLsizeiptr)((datasize + 3) & ~3ULL);
+
+	if (m_ssbo == 0)
+		glGenBuffers(1, &m_ssbo);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssbo);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, buffersize, 0, GL_STREAM_DRAW);
+	m_ssboSize = buffersize;
+	void* pBuffer = glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_WRITE_ONLY);
+	if (!pBuffer) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return false;
+	}
+	spoutcopy.CopyPixels(data, (unsigned char*)pBuffer, width, height, glFormat, false);
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
+	return m_pShaders->Load(m_ssbo, TextureID, width, height,
+		(unsigned int)(width*channels), glFormat, bInvert);
+}
 
 //
 // Copy OpenGL to DirectX 11 texture via CPU if the GL/DX interop is not available
@@ -2196,14 +4952,48 @@ bool spoutGL::ReadDX11texture(GLuint TextureID, GLuint TextureTarget,
 	if (!spoutdx.GetDX11Context())
 		return false;
 
-	// Only one staging texture is required because GPU write is to OpenGL
-	if (!CheckStagingTextures(width, height, 1)) {
+	// Only one staging texture is required because GPU write is to OpenGL.
+	// If more are set by SetStagingBuffers, they are used in a ring
+	// in the same way as PBOs, with a delay of (m_nStaging-1) frames.
+	if (!CheckStagingTextures(width, height, m_nStaging)) {
 		return false;
 	}
 
-	// Read from from the sender shared texture to a staging texture
-	if (!ReadTexture(&m_pStaging[0])) {
-		return false;
+	ID3D11Texture2D* pStaging = m_pStaging[0];
+	if (m_nStaging > 1) {
+		// No new frame, do not block. The OpenGL texture is unchanged.
+		if (!frame.GetNewFrame())
+			return true;
+		// Copy the sender shared texture to the next staging texture in the ring
+		// If access times out, receive the frame next time
+		if (!frame.CheckTextureAccess(m_pSharedTexture)) {
+			frame.ResetNewFrame();
+			return false;
+		}
+		m_Index = (m_Index + 1) % m_nStaging;
+		m_NextIndex = (m_Index + 1) % m_nStaging;
+		spoutdx.BeginGPUTime(spoutdx.GetDX11Context(), "GPUStagingCopy");
+		spoutdx.CopySharedTexture(spoutdx.GetDX11Context(), m_pStaging[m_Index], m_pSharedTexture);
+		spoutdx.EndGPUTime(spoutdx.GetDX11Context());
+		frame.AllowTextureAccess(m_pSharedTexture);
+		// Map the oldest, which was copied (m_nStaging-1) frames ago
+		// and should be ready without waiting for the GPU
+		pStaging = m_pStaging[m_NextIndex];
+	}
+	else {
+		// No new frame, do not block. The OpenGL texture is unchanged.
+		if (!frame.GetNewFrame())
+			return true;
+		// Read from from the sender shared texture to a staging texture
+		// If access times out, receive the frame next time
+		if (!frame.CheckTextureAccess(m_pSharedTexture)) {
+			frame.ResetNewFrame();
+			return false;
+		}
+		spoutdx.BeginGPUTime(spoutdx.GetDX11Context(), "GPUStagingCopy");
+		spoutdx.CopySharedTexture(spoutdx.GetDX11Context(), m_pStaging[0], m_pSharedTexture);
+		spoutdx.EndGPUTime(spoutdx.GetDX11Context());
+		frame.AllowTextureAccess(m_pSharedTexture);
 	}
 
 	// Update the application receiving OpenGL texture from the DX11 staging texture
@@ -2215,7 +5005,7 @@ bool spoutGL::ReadDX11texture(GLuint TextureID, GLuint TextureTarget,
 	spoutdx.GetDX11Context()->Flush();
 
 	// Map the staging texture to access the sender pixels
-	if (SUCCEEDED(spoutdx.GetDX11Context()->Map(m_pStaging[0], 0, D3D11_MAP_READ, 0, &mappedSubResource))) {
+	if (SUCCEEDED(spoutdx.GetDX11Context()->Map(pStaging, 0, D3D11_MAP_READ, 0, &mappedSubResource))) {
 
 		if (bInvert) {
 			// Create or resize a local OpenGL texture
@@ -2243,7 +5033,7 @@ bool spoutGL::ReadDX11texture(GLuint TextureID, GLuint TextureTarget,
 		if(bInvert)	
 			CopyTexture(m_TexID, GL_TEXTURE_2D, TextureID, TextureTarget, width, height, bInvert, HostFBO);
 
-		spoutdx.GetDX11Context()->Unmap(m_pStaging[0], 0);
+		spoutdx.GetDX11Context()->Unmap(pStaging, 0);
 
 		return true;
 	}
@@ -2267,6 +5057,9 @@ bool spoutGL::ReadDX11texture(GLuint TextureID, GLuint TextureTarget,
 //      - void SetFrameSync(const char* SenderName);
 //      - bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
 //
+//   The functions are not available in 2.006 memory share mode
+//   because 2.006 senders write the frame pixels to the "_map" buffer.
+//
 
 //---------------------------------------------------------
 // Function: WriteMemoryBuffer
@@ -2389,6 +5182,68 @@ int spoutGL::ReadMemoryBuffer(const char* name, char* data, int maxlength)
 	return nbytes;
 }
 
+//---------------------------------------------------------
+// Function: LockMemoryBuffer
+// Lock sender shared memory for read without copy.
+//
+//    Returns the number of bytes available and a pointer to the data
+//    in the memory map, or zero if the sender has no buffer.
+//    The sender cannot write to the buffer until UnlockMemoryBuffer
+//    is called, so use the data and unlock as soon as possible.
+//    The map remains open until the receiver is released.
+//    See also spoutMemoryBufferScope (SpoutSharedMemory.h).
+int spoutGL::LockMemoryBuffer(const char* name, const char** ppData)
+{
+	if (!ppData)
+		return 0;
+	*ppData = nullptr;
+
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return 0;
+
+	if (!name || !*name) {
+		SpoutLogError("spoutGL::LockMemoryBuffer - no name");
+		return 0;
+	}
+
+	// Open the sender's map if not done already
+	if (!memoryshare.Name()) {
+		std::string namestring = name;
+		namestring += "_map";
+		if (!memoryshare.Open(namestring.c_str()))
+			return 0;
+		SpoutLogNotice("spoutGL::LockMemoryBuffer - opened sender memory map [%s]", memoryshare.Name());
+	}
+
+	const char* pBuffer = memoryshare.Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::LockMemoryBuffer - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes available is saved as the first 16 bytes
+	char size[16]={};
+	memcpy(size, pBuffer, 15);
+	const int nbytes = atoi(size);
+	if (nbytes <= 0) {
+		memoryshare.Unlock();
+		return 0;
+	}
+
+	*ppData = pBuffer + 16;
+
+	return nbytes;
+}
+
+//---------------------------------------------------------
+// Function: UnlockMemoryBuffer
+// Unlock shared memory locked by LockMemoryBuffer
+void spoutGL::UnlockMemoryBuffer()
+{
+	memoryshare.Unlock();
+}
+
 //---------------------------------------------------------
 // Function: CreateMemoryBuffer
 // Create a shared memory buffer.
@@ -2471,51 +5326,386 @@ bool spoutGL::DeleteMemoryBuffer()
 
 
 //---------------------------------------------------------
-// Function: GetMemoryBufferSize
-// Get the number of bytes available for data transfer.
+// Function: GetMemoryBufferSize
+// Get the number of bytes available for data transfer.
+//
+int spoutGL::GetMemoryBufferSize(const char *name)
+{
+	// A writer has created the map (Create) and set the map size.
+	// The data length is recorded in the first 16 bytes.
+	// Another 16 bytes is added to allow for a terminating NULL. (See CreateMemoryBuffer)
+	// The remaining length is the number of bytes available for data transfer.
+	if (memoryshare.Size() > 32) {
+		return memoryshare.Size()-32;
+	}
+
+	// A reader must read the map to get the size.
+	// The size is not set in the SpoutSharedMemory class.
+	// Open a shared memory map for the buffer if it not already.
+	// (after a map is opened, the name is saved in the SpoutSharedMemory class).
+	if (!memoryshare.Name()) {
+		// Create a name for the map
+		std::string namestring = name;
+		namestring += "_map";
+		// Open the shared memory map.
+		// This also creates a mutex for the receiver to lock and unlock the map for reads.
+		if (!memoryshare.Open(namestring.c_str())) {
+			return 0;
+		}
+		SpoutLogNotice("spoutGL::GetMemoryBufferSize - opened sender memory map [%s]", memoryshare.Name());
+	}
+
+	// The map is open and a name for it has been recorded
+	char* pBuffer = memoryshare.Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::GetMemoryBufferSize - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes of the memory map available for data transfer
+	// is saved in the first 16 bytes.
+	*(pBuffer + 15) = 0; // End for atoi
+	const int nbytes = atoi(pBuffer);
+
+	memoryshare.Unlock();
+
+	return nbytes;
+
+}
+
+//---------------------------------------------------------
+// Function: CreateDataChannel
+// Create a named data channel.
+//
+//    Channels are shared memory buffers in the same format as
+//    CreateMemoryBuffer, so they can be read by ReadMemoryBuffer.
+//    Each channel has its own map, which is created once and retained,
+//    so that several independent streams of data can be written
+//    without re-opening a map for each. Up to SPOUT_DATA_CHANNELS
+//    channels are available. The channels are closed when the sender
+//    or receiver is released (see CloseDataChannels).
+bool spoutGL::CreateDataChannel(const char* name, int length)
+{
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return false;
+
+	if (!name || !*name || length <= 0) {
+		SpoutLogError("spoutGL::CreateDataChannel - no name or length");
+		return false;
+	}
+
+	if (FindDataChannel(name) >= 0) {
+		SpoutLogWarning("spoutGL::CreateDataChannel - channel [%s] already exists", name);
+		return false;
+	}
+
+	// A free channel
+	int index = -1;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		if (!m_DataChannels[i].pMap) {
+			index = i;
+			break;
+		}
+	}
+	if (index < 0) {
+		SpoutLogError("spoutGL::CreateDataChannel - all %d channels used", SPOUT_DATA_CHANNELS);
+		return false;
+	}
+
+	std::string namestring = name;
+	namestring += "_map";
+
+	// The first 16 bytes record the number of bytes available
+	// and another 16 bytes allow for a null terminator
+	SpoutSharedMemory* pMap = new SpoutSharedMemory;
+	if (pMap->Create(namestring.c_str(), (ULONGLONG)length + 32) == SPOUT_CREATE_FAILED) {
+		SpoutLogError("spoutGL::CreateDataChannel - could not create shared memory [%s]", namestring.c_str());
+		delete pMap;
+		return false;
+	}
+
+	char* pBuffer = pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::CreateDataChannel - no buffer lock");
+		delete pMap;
+		return false;
+	}
+	_itoa_s(length, pBuffer, 16, 10);
+	*(pBuffer + 16) = 0;
+	pMap->Unlock();
+
+	strcpy_s(m_DataChannels[index].name, 256, name);
+	m_DataChannels[index].pMap = pMap;
+	m_DataChannels[index].size = length;
+	SpoutLogNotice("spoutGL::CreateDataChannel - created channel [%s] %d bytes", name, length);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: WriteDataChannel
+// Write data to a named data channel.
+//
+//    The channel is created on the first write at the length given
+//    if it has not been created in advance (see CreateDataChannel).
+//    Data longer than the channel is truncated.
+bool spoutGL::WriteDataChannel(const char* name, const char* data, int length)
+{
+	if (!name || !*name || !data || length <= 0)
+		return false;
+
+	int index = FindDataChannel(name);
+	if (index < 0) {
+		if (!CreateDataChannel(name, length))
+			return false;
+		index = FindDataChannel(name);
+	}
+
+	// A channel opened for read cannot be written
+	SpoutDataChannel& channel = m_DataChannels[index];
+	if (channel.size <= 0) {
+		SpoutLogError("spoutGL::WriteDataChannel - channel [%s] is open for read", name);
+		return false;
+	}
+
+	if (length > channel.size)
+		length = channel.size;
+
+	char* pBuffer = channel.pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::WriteDataChannel - no buffer lock");
+		return false;
+	}
+	memcpy(pBuffer + 16, data, length);
+	*(pBuffer + 16 + length) = 0;
+	channel.pMap->Unlock();
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ReadDataChannel
+// Read data from a named data channel.
+//
+//    The channel map is opened on the first read and retained.
+//    Returns the number of bytes copied, or zero if the channel
+//    has not been created by a sender.
+int spoutGL::ReadDataChannel(const char* name, char* data, int maxlength)
+{
+	// Quit if 2.006 memoryshare mode
+	if (m_bMemoryShare)
+		return 0;
+
+	if (!name || !*name || !data || maxlength <= 0)
+		return 0;
+
+	int index = FindDataChannel(name);
+	if (index < 0) {
+		// A free channel
+		for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+			if (!m_DataChannels[i].pMap) {
+				index = i;
+				break;
+			}
+		}
+		if (index < 0) {
+			SpoutLogError("spoutGL::ReadDataChannel - all %d channels used", SPOUT_DATA_CHANNELS);
+			return 0;
+		}
+		// Open the sender's map. Zero if it does not exist yet.
+		std::string namestring = name;
+		namestring += "_map";
+		SpoutSharedMemory* pMap = new SpoutSharedMemory;
+		if (!pMap->Open(namestring.c_str())) {
+			delete pMap;
+			return 0;
+		}
+		strcpy_s(m_DataChannels[index].name, 256, name);
+		m_DataChannels[index].pMap = pMap;
+		m_DataChannels[index].size = 0; // Opened for read
+		SpoutLogNotice("spoutGL::ReadDataChannel - opened channel [%s]", name);
+	}
+
+	SpoutSharedMemory* pMap = m_DataChannels[index].pMap;
+	const char* pBuffer = pMap->Lock();
+	if (!pBuffer) {
+		SpoutLogError("spoutGL::ReadDataChannel - no buffer lock");
+		return 0;
+	}
+
+	// The number of bytes available is saved as the first 16 bytes
+	char size[16]={};
+	memcpy(size, pBuffer, 15);
+	int nbytes = atoi(size);
+	if (nbytes > maxlength)
+		nbytes = maxlength;
+	if (nbytes > 0)
+		memcpy(data, pBuffer + 16, nbytes);
+
+	pMap->Unlock();
+
+	return (nbytes > 0) ? nbytes : 0;
+}
+
+//---------------------------------------------------------
+// Function: CloseDataChannel
+// Close a named data channel
+void spoutGL::CloseDataChannel(const char* name)
+{
+	const int index = FindDataChannel(name);
+	if (index < 0)
+		return;
+	delete m_DataChannels[index].pMap; // Closes the map
+	m_DataChannels[index] = {};
+}
+
+//---------------------------------------------------------
+// Function: CloseDataChannels
+// Close all data channels
+void spoutGL::CloseDataChannels()
+{
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		delete m_DataChannels[i].pMap;
+		m_DataChannels[i] = {};
+	}
+}
+
+// Index of a named data channel or -1
+int spoutGL::FindDataChannel(const char* name)
+{
+	if (!name || !*name)
+		return -1;
+	for (int i = 0; i < SPOUT_DATA_CHANNELS; i++) {
+		if (m_DataChannels[i].pMap && strcmp(m_DataChannels[i].name, name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+//---------------------------------------------------------
+// Function: SetMemoryLargePages
+// Allocate shared memory with large pages if available.
+//
+// Applies to memory buffers (CreateMemoryBuffer, WriteMemoryBuffer)
+// and memory share (WriteMemoryPixels) created after this call.
+// Large enough maps are allocated with large pages if the process
+// has the "Lock pages in memory" user right (see SpoutSharedMemory::SetLargePages).
+// Otherwise default pages are used.
+void spoutGL::SetMemoryLargePages(bool bLarge)
+{
+	memoryshare.SetLargePages(bLarge);
+	m_MemoryRing.SetLargePages(bLarge);
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryLargePages
+// Large pages enabled by SetMemoryLargePages
+bool spoutGL::GetMemoryLargePages()
+{
+	return memoryshare.GetLargePages();
+}
+
+//---------------------------------------------------------
+// Function: SetMemoryCompression
+// Lossless compression of memory share frames.
+//
+// For memory share where shared memory bandwidth is limited,
+// such as into a virtual machine or a sandboxed process.
+// WriteMemoryPixels times frames written compressed and as pixels
+// and compresses them while that is faster for the content.
+// The other method is timed again every 60 frames.
+// Receivers decompress the frames. Receivers before this
+// version cannot read a compressed memory share sender.
+void spoutGL::SetMemoryCompression(bool bCompress)
+{
+	m_bMemoryCompress = bCompress;
+	m_bMemoryCompressed = false;
+	m_MemoryRawTime = 0.0;
+	m_MemoryCodecTime = 0.0;
+	m_MemoryCodecFrames = 0;
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryCompression
+// Compression enabled by SetMemoryCompression
+bool spoutGL::GetMemoryCompression()
+{
+	return m_bMemoryCompress;
+}
+
+//---------------------------------------------------------
+// Function: IsMemoryCompressed
+// The last memory share frame was written compressed
+bool spoutGL::IsMemoryCompressed()
+{
+	return m_bMemoryCompressed;
+}
+
+//---------------------------------------------------------
+// Function: SetMemoryRingSend
+// Send frames through the memory ring instead of a shared texture.
+//
+// For a sender where texture sharing is not available, such as into
+// a virtual machine. The sender has no shared texture and the frames
+// are written to the memory ring "<sendername>_memring_<width>x<height>".
+// Only receivers that read the memory ring receive the sender.
+// Set for this sender only and before the sender is created.
+void spoutGL::SetMemoryRingSend(bool bRing)
+{
+	m_bMemoryRingSend = bRing;
+}
+
+//---------------------------------------------------------
+// Function: GetMemoryRingSend
+// Memory ring send enabled by SetMemoryRingSend
+bool spoutGL::GetMemoryRingSend()
+{
+	return m_bMemoryRingSend;
+}
+
+//---------------------------------------------------------
+// Function: CreateFrameData
+// Create a frame data buffer.
+//
+//    Optional. Sets the maximum length of data for each frame.
+//    Otherwise the buffer is created by the first WriteFrameData
+//    for at least 4096 bytes.
+bool spoutGL::CreateFrameData(int maxlength)
+{
+	if (!m_SenderName[0] || maxlength <= 0)
+		return false;
+	return frame.CreateFrameData(m_SenderName, (unsigned int)maxlength);
+}
+
+//---------------------------------------------------------
+// Function: WriteFrameData
+// Write data sent with the next frame.
+//
+//    Unlike WriteMemoryBuffer, each write is tagged with the number
+//    of the frame that it is sent with and saved in the next of a number
+//    of buffers. Receivers do not lock out the sender.
+//    Call before sending the frame. Frame counting must be enabled.
+bool spoutGL::WriteFrameData(const char* data, int length)
+{
+	if (!m_SenderName[0] || !data || length <= 0)
+		return false;
+	return frame.WriteFrameData(m_SenderName, data, (unsigned int)length);
+}
+
+//---------------------------------------------------------
+// Function: ReadFrameData
+// Read the data sent with a frame.
 //
-int spoutGL::GetMemoryBufferSize(const char *name)
+//    framenumber - sender frame number, 0 for the frame received (GetSenderFrame)
+//
+//    Returns the number of bytes read, or zero if no data was sent with the frame
+//    or it has been replaced by later frames.
+int spoutGL::ReadFrameData(char* data, int maxlength, long framenumber)
 {
-	// A writer has created the map (Create) and set the map size.
-	// The data length is recorded in the first 16 bytes.
-	// Another 16 bytes is added to allow for a terminating NULL. (See CreateMemoryBuffer)
-	// The remaining length is the number of bytes available for data transfer.
-	if (memoryshare.Size() > 32) {
-		return memoryshare.Size()-32;
-	}
-
-	// A reader must read the map to get the size.
-	// The size is not set in the SpoutSharedMemory class.
-	// Open a shared memory map for the buffer if it not already.
-	// (after a map is opened, the name is saved in the SpoutSharedMemory class).
-	if (!memoryshare.Name()) {
-		// Create a name for the map
-		std::string namestring = name;
-		namestring += "_map";
-		// Open the shared memory map.
-		// This also creates a mutex for the receiver to lock and unlock the map for reads.
-		if (!memoryshare.Open(namestring.c_str())) {
-			return 0;
-		}
-		SpoutLogNotice("spoutGL::GetMemoryBufferSize - opened sender memory map [%s]", memoryshare.Name());
-	}
-
-	// The map is open and a name for it has been recorded
-	char* pBuffer = memoryshare.Lock();
-	if (!pBuffer) {
-		SpoutLogError("spoutGL::GetMemoryBufferSize - no buffer lock");
+	if (!m_SenderName[0] || !data || maxlength <= 0)
 		return 0;
-	}
-
-	// The number of bytes of the memory map available for data transfer
-	// is saved in the first 16 bytes.
-	*(pBuffer + 15) = 0; // End for atoi
-	const int nbytes = atoi(pBuffer);
-
-	memoryshare.Unlock();
-
-	return nbytes;
-
+	return frame.ReadFrameData(m_SenderName, data, (unsigned int)maxlength, (LONG64)framenumber);
 }
 
 
@@ -2524,6 +5714,12 @@ bool spoutGL::ReadTextureData(GLuint SourceID, GLuint SourceTarget,
 	unsigned int width, unsigned int height, unsigned int pitch,
 	unsigned char* dest, GLenum GLformat, bool bInvert, GLuint HostFBO)
 {
+	// Read directly to the application buffer if pinned memory is enabled
+	if (!bInvert && UnloadPinnedPixels(SourceID, SourceTarget,
+		width, height, pitch, dest, GLformat, HostFBO)) {
+		return true;
+	}
+
 	if (!m_bFBOavailable || GLformat == GL_RGB || GLformat == GL_BGR_EXT) {
 
 		if (bInvert) {
@@ -2645,13 +5841,15 @@ bool spoutGL::ReadTextureData(GLuint SourceID, GLuint SourceTarget,
 // Use staging texture to support RGBA/RGB
 //
 bool spoutGL::WriteDX11pixels(const unsigned char* pixels,
-	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, unsigned int pitch)
 {
 	if (width != m_Width || height != m_Height || !pixels)
 		return false;
 
-	// if(!CheckStagingTextures(width, height, 1))
-	if (!CheckStagingTextures(width, height, 2))
+	// At least two staging textures are used in a ring
+	// so that the sender does not wait for the copy of the previous frame
+	const int nStaging = (m_nStaging > 1) ? m_nStaging : 2;
+	if (!CheckStagingTextures(width, height, nStaging))
 		return false;
 
 	// 1) pixels (RGBA or RGB) -> staging texture (RGBA) - CPU
@@ -2669,13 +5867,36 @@ bool spoutGL::WriteDX11pixels(const unsigned char* pixels,
 	//
 	// Access the sender shared texture
 	if (frame.CheckTextureAccess(m_pSharedTexture)) {
-		// Map the staging texture and write pixels to it (CPU)
-		WritePixelData(pixels, m_pStaging[0], width, height, glFormat, bInvert);
+		// Map a staging texture and write pixels to it (CPU)
+		// Starting with the next in the ring, the map returns at once
+		// if the texture is still being copied, and the following one is tried.
+		int index = -1;
+		for (int i = 0; i < nStaging; i++) {
+			const int n = (m_WriteIndex + i) % nStaging;
+			if (WritePixelData(pixels, m_pStaging[n], width, height, glFormat, bInvert, D3D11_MAP_FLAG_DO_NOT_WAIT, pitch)) {
+				index = n;
+				break;
+			}
+		}
+		// All are in use, so wait for the next
+		if (index < 0) {
+			index = m_WriteIndex;
+			if (!WritePixelData(pixels, m_pStaging[index], width, height, glFormat, bInvert, 0, pitch)) {
+				frame.AllowTextureAccess(m_pSharedTexture);
+				return false;
+			}
+		}
+		m_WriteIndex = (index + 1) % nStaging;
 		// Copy from the staging texture to the sender shared texture (GPU)
-		spoutdx.GetDX11Context()->CopyResource(m_pSharedTexture, m_pStaging[0]);
+		spoutdx.BeginGPUTime(spoutdx.GetDX11Context(), "GPUStagingCopy");
+		spoutdx.GetDX11Context()->CopyResource(m_pSharedTexture, m_pStaging[index]);
+		spoutdx.EndGPUTime(spoutdx.GetDX11Context());
 		spoutdx.GetDX11Context()->Flush();
 		frame.SetNewFrame();
+		// Copy for CPU read back (SetSendReadback)
+		WriteSendReadback();
 		frame.AllowTextureAccess(m_pSharedTexture);
+		PollSendReadback();
 		return true;
 	}
 	return false;
@@ -2685,12 +5906,16 @@ bool spoutGL::WriteDX11pixels(const unsigned char* pixels,
 
 // Receive from a sender via DX11 staging textures to an rgba or rgb buffer of variable size
 // A new shared texture pointer (m_pSharedTexture) is retrieved if the sender changed
-bool spoutGL::ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+// pitch - bytes of each line of the pixel buffer including padding, 0 if there is no padding
+bool spoutGL::ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigned int height,
+	GLenum glFormat, bool bInvert, unsigned int pitch)
 {
 	if (!pixels)
 		return false;
 
-	if (!CheckStagingTextures(width, height, 2)) {
+	// At least two staging textures are required
+	const int nStaging = (m_nStaging > 1) ? m_nStaging : 2;
+	if (!CheckStagingTextures(width, height, nStaging)) {
 		return false;
 	}
 
@@ -2699,16 +5924,44 @@ bool spoutGL::ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigne
 		return true;
 	
 	// If the sender has produced a new frame.
-	// Read from the sender GPU texture to CPU pixels via two staging textures
+	// Read from the sender GPU texture to CPU pixels via a ring of staging textures
+
+	spoutTimerScope scope(&timer, "ReadDX11pixels");
 
 	// Access the sender shared texture
+	const LONG64 accessStart = timer.Start();
 	if (frame.CheckTextureAccess(m_pSharedTexture)) {
-		m_Index = (m_Index + 1) % 2;
-		m_NextIndex = (m_Index + 1) % 2;
-		// Copy from the sender's shared texture to the first staging texture
-		spoutdx.GetDX11Context()->CopyResource(m_pStaging[m_Index], m_pSharedTexture);
-		// Map and read from the second while the first is occupied
-		ReadPixelData(m_pStaging[m_NextIndex], pixels, m_Width, m_Height, glFormat, bInvert);
+		timer.Stop("CheckAccess", accessStart);
+		m_Index = (m_Index + 1) % nStaging;
+		m_NextIndex = (m_Index + 1) % nStaging;
+		// Only the changed regions if the sender publishes them
+		// and every staging texture has a whole frame
+		const RECT* pRects = nullptr;
+		unsigned int nRects = 0;
+		if (frame.ReadDirtyRects(m_SenderName) && frame.GetDirtyFrames() >= (unsigned int)nStaging) {
+			// Regions changed since the current staging texture was last written
+			CopyDirtyRects(m_pStaging[m_Index], m_pSharedTexture, nStaging);
+			// The pixel buffer has the frame before the oldest staging texture.
+			// Direct copy for the same pixel format as the staging textures.
+			const bool bDirect = pitch == 0 && ((glFormat == GL_RGBA && m_dwFormat == 28)
+				|| (glFormat == GL_BGRA_EXT && m_dwFormat == 87));
+			if (bDirect && pixels == m_pDirtyPixels && bInvert == m_bDirtyInvert
+				&& frame.GetDirtyRects(nStaging-1, &pRects, nRects))
+				ReadDirtyPixels(m_pStaging[m_NextIndex], pixels, pRects, nRects, bInvert);
+			else
+				ReadPixelData(m_pStaging[m_NextIndex], pixels, m_Width, m_Height, glFormat, bInvert, pitch);
+		}
+		else {
+			// Copy from the sender's shared texture to the current staging texture
+			spoutdx.BeginGPUTime(spoutdx.GetDX11Context(), "GPUStagingCopy");
+			spoutdx.CopySharedTexture(spoutdx.GetDX11Context(), m_pStaging[m_Index], m_pSharedTexture);
+			spoutdx.EndGPUTime(spoutdx.GetDX11Context());
+			// Map and read from the oldest while the current one is occupied
+			ReadPixelData(m_pStaging[m_NextIndex], pixels, m_Width, m_Height, glFormat, bInvert, pitch);
+		}
+		// Changed regions are read only to packed pixels
+		m_pDirtyPixels = (pitch == 0) ? pixels : nullptr;
+		m_bDirtyInvert = bInvert;
 		// Allow access to the shared texture
 		frame.AllowTextureAccess(m_pSharedTexture);
 		return true;
@@ -2720,8 +5973,12 @@ bool spoutGL::ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigne
 
 
 // RGBA/RGB/BGRA/BGR supported
+//    mapFlags - 0 to wait for the GPU or D3D11_MAP_FLAG_DO_NOT_WAIT
+//               to return false if the texture is still in use
+//    pitch    - bytes per line of the pixels, 0 if there is no padding
 bool spoutGL::WritePixelData(const unsigned char* pixels, ID3D11Texture2D* pStagingTexture,
-	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, UINT mapFlags,
+	unsigned int pitch)
 {
 	if (!spoutdx.GetDX11Context() || !pStagingTexture || !pixels)
 		return false;
@@ -2738,48 +5995,24 @@ bool spoutGL::WritePixelData(const unsigned char* pixels, ID3D11Texture2D* pStag
 	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
 	// Make sure all commands are done before mapping the staging texture
 	spoutdx.GetDX11Context()->Flush();
-	// Map waits for GPU access
-	const HRESULT hr = spoutdx.GetDX11Context()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	// Map waits for GPU access unless D3D11_MAP_FLAG_DO_NOT_WAIT
+	// DXGI_ERROR_WAS_STILL_DRAWING is returned if the texture is in use
+	const HRESULT hr = spoutdx.GetDX11Context()->Map(pStagingTexture, 0, D3D11_MAP_WRITE, mapFlags, &mappedSubResource);
 	if (SUCCEEDED(hr)) {
+		SpoutTrace(SPOUT_TRACE_CONVERT_BEGIN, m_SenderName, frame.GetSenderFrame64());
+		const LONG64 copyStart = timer.Start();
 		//
 		// Copy from the pixel buffer to the staging texture
 		//
 		// The shared texture format is BGRA or RGBA and the staging textures are the same format.
 		// If the texture format is BGRA and the receiving pixel buffer is RGBA/RGB or vice-versa,
 		// the data has to be converted from BGRA to RGBA/RGB or RGBA to BGRA/BGR during the pixel copy.
+		// The conversion is selected by spoutCopy from the pixel buffer and staging texture formats.
 		//
-		if (glFormat == GL_RGBA) { // RGBA pixel buffer
-			if (m_dwFormat == 28) // RGBA staging textures
-				spoutcopy.rgba2rgba((const void *)pixels, mappedSubResource.pData,
-					width, height, width*4, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgba2bgra((const void *)pixels, mappedSubResource.pData, 
-					width, height, width*4, mappedSubResource.RowPitch, bInvert);
-		}
-		else if (glFormat == GL_BGRA_EXT) { // BGRA pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.rgba2bgra((const void *)pixels, mappedSubResource.pData,
-					width, height, width * 4, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgba2rgba((const void *)pixels, mappedSubResource.pData,
-					width, height, width*4, mappedSubResource.RowPitch, bInvert);
-		}
-		else if (glFormat == GL_RGB) { // RGB pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.rgb2rgba((const void *)pixels, mappedSubResource.pData, 
-					width, height, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgb2bgra((const void *)pixels, mappedSubResource.pData,
-					width, height, mappedSubResource.RowPitch, bInvert);
-		}
-		else if (glFormat == GL_BGR_EXT) { // BGR pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.bgr2rgba((const void *)pixels, mappedSubResource.pData,
-					width, height, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgb2rgba((const void *)pixels, mappedSubResource.pData,
-					width, height, mappedSubResource.RowPitch, bInvert);
-		}
+		spoutcopy.ConvertPixels((const void *)pixels, mappedSubResource.pData, width, height,
+			(DWORD)glFormat, m_dwFormat, pitch, mappedSubResource.RowPitch, bInvert);
+		timer.Stop("spoutCopy", copyStart);
+		SpoutTrace(SPOUT_TRACE_CONVERT_END, m_SenderName, frame.GetSenderFrame64());
 		spoutdx.GetDX11Context()->Unmap(pStagingTexture, 0);
 
 		return true;
@@ -2795,7 +6028,7 @@ bool spoutGL::WritePixelData(const unsigned char* pixels, ID3D11Texture2D* pStag
 // COPY FROM A DX11 STAGING TEXTURE TO A USER RGBA/RGB/BGR PIXEL BUFFER
 //
 bool spoutGL::ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pixels,
-	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, unsigned int pitch)
 {
 	if (!spoutdx.GetDX11Context() || !pStagingTexture || !pixels)
 		return false;
@@ -2813,8 +6046,12 @@ bool spoutGL::ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pix
 	// Make sure all commands are done before mapping the staging texture
 	spoutdx.GetDX11Context()->Flush();
 	// Map waits for GPU access
+	SpoutTrace(SPOUT_TRACE_MAP_BEGIN, m_SenderName, frame.GetSenderFrame64());
 	const HRESULT hr = spoutdx.GetDX11Context()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	SpoutTrace(SPOUT_TRACE_MAP_END, m_SenderName, frame.GetSenderFrame64());
 	if (SUCCEEDED(hr)) {
+		SpoutTrace(SPOUT_TRACE_CONVERT_BEGIN, m_SenderName, frame.GetSenderFrame64());
+		const LONG64 copyStart = timer.Start();
 		//
 		// Copy from staging texture to the pixel buffer
 		//
@@ -2822,31 +6059,51 @@ bool spoutGL::ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pix
 		// If the texture format is BGRA and the receiving pixel buffer is RGBA/RGB or vice-versa,
 		// the data has to be converted from BGRA to RGBA/RGB or RGBA to BGRA/BGR during the pixel copy.
 		//
-		if (glFormat == GL_RGBA) { // RGBA pixel buffer
-			if (m_dwFormat == 28) // RGBA staging textures
-				spoutcopy.rgba2rgba(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgba2bgra(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert);
+		// 10 bit and half float textures are converted to 8 bit.
+		// A buffer with padding is written line by line at the pitch.
+		//
+		const bool bRGBA = (glFormat == GL_RGBA || glFormat == GL_BGRA_EXT);
+		if (pitch > 0 && pitch != width*(bRGBA ? 4 : 3)
+			&& (m_dwFormat == DXGI_FORMAT_R10G10B10A2_UNORM || m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT)) {
+			const unsigned char* src = static_cast<const unsigned char*>(mappedSubResource.pData);
+			const bool bSwap = (glFormat == GL_BGRA_EXT || glFormat == GL_BGR_EXT);
+			for (unsigned int y = 0; y < height; y++) {
+				const unsigned char* line = src + (uint64_t)(bInvert ? (height - 1 - y) : y) * mappedSubResource.RowPitch;
+				unsigned char* dest = pixels + (uint64_t)y * pitch;
+				if (m_dwFormat == DXGI_FORMAT_R10G10B10A2_UNORM) {
+					if (bRGBA)
+						spoutcopy.rgb10a2_to_rgba(line, dest, width, 1, mappedSubResource.RowPitch, false, bSwap);
+					else
+						spoutcopy.rgb10a2_to_rgb(line, dest, width, 1, mappedSubResource.RowPitch, false, bSwap);
+				}
+				else {
+					if (bRGBA)
+						spoutcopy.rgba16f_to_rgba(line, dest, width, 1, mappedSubResource.RowPitch, false, bSwap);
+					else
+						spoutcopy.rgba16f_to_rgb(line, dest, width, 1, mappedSubResource.RowPitch, false, bSwap);
+				}
+			}
 		}
-		else if (glFormat == GL_BGRA_EXT) { // BGRA pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.rgba2bgra(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert);
+		else if (m_dwFormat == DXGI_FORMAT_R10G10B10A2_UNORM) {
+			if (glFormat == GL_RGBA || glFormat == GL_BGRA_EXT)
+				spoutcopy.rgb10a2_to_rgba(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert, glFormat == GL_BGRA_EXT);
 			else
-				spoutcopy.rgba2rgba(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert);
+				spoutcopy.rgb10a2_to_rgb(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert, glFormat == GL_BGR_EXT);
 		}
-		else if (glFormat == GL_RGB) { // RGB pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.rgba2rgb(mappedSubResource.pData, pixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert);
+		else if (m_dwFormat == DXGI_FORMAT_R16G16B16A16_FLOAT) {
+			if (glFormat == GL_RGBA || glFormat == GL_BGRA_EXT)
+				spoutcopy.rgba16f_to_rgba(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert, glFormat == GL_BGRA_EXT);
 			else
-				spoutcopy.rgba2bgr(mappedSubResource.pData, pixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert);
+				spoutcopy.rgba16f_to_rgb(mappedSubResource.pData, pixels, width, height, mappedSubResource.RowPitch, bInvert, glFormat == GL_BGR_EXT);
 		}
-		else if (glFormat == GL_BGR_EXT) { // BGR pixel buffer
-			if (m_dwFormat == 28)
-				spoutcopy.rgba2bgr(mappedSubResource.pData, pixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert);
-			else
-				spoutcopy.rgba2rgb(mappedSubResource.pData, pixels, m_Width, m_Height, mappedSubResource.RowPitch, bInvert);
+		else {
+			// 8 bit RGBA or BGRA to an RGBA, BGRA, RGB or BGR pixel buffer
+			spoutcopy.ConvertPixels(mappedSubResource.pData, pixels, width, height,
+				m_dwFormat, (DWORD)glFormat, mappedSubResource.RowPitch, pitch, bInvert);
 		}
 
+		timer.Stop("spoutCopy", copyStart);
+		SpoutTrace(SPOUT_TRACE_CONVERT_END, m_SenderName, frame.GetSenderFrame64());
 		spoutdx.GetDX11Context()->Unmap(pStagingTexture, 0);
 
 		return true;
@@ -2856,9 +6113,79 @@ bool spoutGL::ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pix
 
 } // end ReadPixelData
 
+// Region of a dirty rectangle within the texture
+static bool DirtyRectBox(const RECT &rect, unsigned int width, unsigned int height, D3D11_BOX &box)
+{
+	const LONG right  = (rect.right  < (LONG)width)  ? rect.right  : (LONG)width;
+	const LONG bottom = (rect.bottom < (LONG)height) ? rect.bottom : (LONG)height;
+	if (rect.left < 0 || rect.top < 0 || rect.left >= right || rect.top >= bottom)
+		return false;
+	box.left   = (UINT)rect.left;
+	box.top    = (UINT)rect.top;
+	box.right  = (UINT)right;
+	box.bottom = (UINT)bottom;
+	box.front  = 0;
+	box.back   = 1;
+	return true;
+}
+
+// Read the changed regions from a staging texture of the same pixel format
+// to a pixel buffer of the sender size that has the previous frame
+bool spoutGL::ReadDirtyPixels(ID3D11Texture2D* pStagingTexture, unsigned char* pixels,
+	const RECT* pRects, unsigned int nRects, bool bInvert)
+{
+	if (!spoutdx.GetDX11Context() || !pStagingTexture || !pixels)
+		return false;
+
+	// Nothing changed
+	if (!pRects || nRects == 0)
+		return true;
+
+	D3D11_MAPPED_SUBRESOURCE mappedSubResource={};
+	spoutdx.GetDX11Context()->Flush();
+	SpoutTrace(SPOUT_TRACE_MAP_BEGIN, m_SenderName, frame.GetSenderFrame64());
+	const HRESULT hr = spoutdx.GetDX11Context()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &mappedSubResource);
+	SpoutTrace(SPOUT_TRACE_MAP_END, m_SenderName, frame.GetSenderFrame64());
+	if (FAILED(hr))
+		return false;
+
+	const unsigned char* pSource = static_cast<const unsigned char*>(mappedSubResource.pData);
+	D3D11_BOX box={};
+	for (unsigned int i = 0; i < nRects; i++) {
+		if (!DirtyRectBox(pRects[i], m_Width, m_Height, box))
+			continue;
+		// Destination rows are reversed for invert
+		const unsigned int desty = bInvert ? m_Height - box.bottom : box.top;
+		spoutcopy.rgba2rgba(pSource + (uint64_t)box.top*mappedSubResource.RowPitch + (uint64_t)box.left*4,
+			pixels + ((uint64_t)desty*m_Width + box.left)*4,
+			box.right-box.left, box.bottom-box.top,
+			mappedSubResource.RowPitch, m_Width*4, bInvert);
+	}
+	spoutdx.GetDX11Context()->Unmap(pStagingTexture, 0);
+
+	return true;
+}
+
+// Copy the regions changed in the last nFrames frames received
+// to a staging texture that has the frame received before them
+void spoutGL::CopyDirtyRects(ID3D11Texture2D* pDest, ID3D11Texture2D* pSource, unsigned int nFrames)
+{
+	const RECT* pRects = nullptr;
+	unsigned int nRects = 0;
+	D3D11_BOX box={};
+	for (unsigned int age = 0; age < nFrames; age++) {
+		if (!frame.GetDirtyRects(age, &pRects, nRects))
+			continue;
+		for (unsigned int i = 0; i < nRects; i++) {
+			if (DirtyRectBox(pRects[i], m_Width, m_Height, box))
+				spoutdx.GetDX11Context()->CopySubresourceRegion(pDest, 0, box.left, box.top, 0, pSource, 0, &box);
+		}
+	}
+}
+
 
 // Create class staging textures for changed size or if they do not exist yet
-// Two are available but only one can be allocated to save memory
+// Up to four are available but only one can be allocated to save memory
 // Format is the same as the shared texture - m_dwFormat
 bool spoutGL::CheckStagingTextures(unsigned int width, unsigned int height, int nTextures)
 {
@@ -2866,18 +6193,18 @@ bool spoutGL::CheckStagingTextures(unsigned int width, unsigned int height, int
 		return false;
 	}
 
+	if (nTextures < 1) nTextures = 1;
+	if (nTextures > 4) nTextures = 4;
+
 	D3D11_TEXTURE2D_DESC desc = { 0 };
 
 	if (m_pStaging[0]) {
 
 		// Get the size to test for change
 		m_pStaging[0]->GetDesc(&desc);
-		if (desc.Width != width || desc.Height != height) {
+		if (desc.Width != width || desc.Height != height || !m_pStaging[nTextures-1]) {
 			// Staging textures must not be mapped before release
-			if (m_pStaging[0]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[0]);
-			if (m_pStaging[1]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[1]);
-			m_pStaging[0] = nullptr;
-			m_pStaging[1] = nullptr;
+			ReleaseStagingTextures();
 
 			// Flush context to avoid deferred release
 			spoutdx.Flush();
@@ -2889,11 +6216,9 @@ bool spoutGL::CheckStagingTextures(unsigned int width, unsigned int height, int
 		}
 	}
 
-	if (!spoutdx.CreateDX11StagingTexture(spoutdx.GetDX11Device(), width, height, (DXGI_FORMAT)m_dwFormat, &m_pStaging[0]))
-		return false;
-
-	if (nTextures > 1) {
-		if (!spoutdx.CreateDX11StagingTexture(spoutdx.GetDX11Device(), width, height, (DXGI_FORMAT)m_dwFormat, &m_pStaging[1]))
+	for (int i = 0; i < nTextures; i++) {
+		// Textures of the same size and format released by other objects are re-used
+		if (!spoutdx.AcquireStagingTexture(spoutdx.GetDX11Device(), width, height, (DXGI_FORMAT)m_dwFormat, &m_pStaging[i]))
 			return false;
 	}
 
@@ -2904,21 +6229,44 @@ bool spoutGL::CheckStagingTextures(unsigned int width, unsigned int height, int
 	// Reset staging texture index
 	m_Index = 0;
 	m_NextIndex = 0;
+	m_WriteIndex = 0;
+
+	// New staging textures are copied whole
+	frame.ResetDirtyRects();
+	m_pDirtyPixels = nullptr;
 
 	// Also reset PBO index
 	PboIndex = 0;
 	NextPboIndex = 0;
 
 	// Did something go wrong somehow
-	if (!m_pStaging[0])
-		return false;
-	if (nTextures > 1 && !m_pStaging[1])
-		return false;
+	for (int i = 0; i < nTextures; i++) {
+		if (!m_pStaging[i])
+			return false;
+	}
 
 	return true;
 
 } // end CheckStagingTextures
 
+// Release all class staging textures and reset the ring index
+void spoutGL::ReleaseStagingTextures()
+{
+	// Staging textures must not be mapped before release
+	if (m_pMappedStaging && spoutdx.GetDX11Context())
+		spoutdx.GetDX11Context()->Unmap(m_pMappedStaging, 0);
+	m_pMappedStaging = nullptr;
+
+	for (int i = 0; i < 4; i++) {
+		// Return to the process pool
+		spoutdx.ReleaseStagingTexture(m_pStaging[i]);
+		m_pStaging[i] = nullptr;
+	}
+	m_Index = 0;
+	m_NextIndex = 0;
+	m_WriteIndex = 0;
+}
+
 
 //
 // Memoryshare functions - receive only
@@ -2930,6 +6278,37 @@ bool spoutGL::CheckStagingTextures(unsigned int width, unsigned int height, int
 bool spoutGL::ReadMemoryTexture(const char* sendername, GLuint TexID, GLuint TextureTarget,
 	unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
 {
+	// No new frame, do not block. The OpenGL texture is unchanged.
+	if (!frame.GetNewFrame())
+		return true;
+
+	// Memory ring if the sender has created one.
+	// The "_map" buffer of a ring sender can have data (WriteMemoryBuffer).
+	if (OpenMemoryRing(sendername, width, height)) {
+		LONG64 ringframe = 0;
+		const unsigned char* pSlot = BeginMemoryRingRead(width, height, ringframe);
+		if (!pSlot)
+			return true; // No new frame
+		// glTexSubImage2D copies the pixels before it returns
+		// so that the slot can be checked for over-write after upload
+		bool bRet = true;
+		if (bInvert) {
+			CheckOpenGLTexture(m_TexID, GL_RGBA, width, height);
+			glBindTexture(GL_TEXTURE_2D, m_TexID);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid*)pSlot);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			if (EndMemoryRingRead(ringframe))
+				bRet = CopyTexture(m_TexID, GL_TEXTURE_2D, TexID, TextureTarget, width, height, true, HostFBO);
+		}
+		else {
+			glBindTexture(TextureTarget, TexID);
+			glTexSubImage2D(TextureTarget, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid*)pSlot);
+			glBindTexture(TextureTarget, 0);
+			EndMemoryRingRead(ringframe);
+		}
+		return bRet;
+	}
+
 	// Open a shared memory map if it not already
 	if (!memoryshare.Name()) {
 		// Create a name for the map from the sender name
@@ -2981,7 +6360,8 @@ bool spoutGL::ReadMemoryTexture(const char* sendername, GLuint TexID, GLuint Tex
 bool spoutGL::ReadMemoryPixels(const char* sendername, unsigned char* pixels,
 	unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
 {
-	if (!pixels || glFormat != GL_RGBA) {
+	// Memory pixels are RGBA and converted for other formats
+	if (!pixels || !(glFormat == GL_RGBA || glFormat == GL_BGRA_EXT || glFormat == GL_RGB || glFormat == GL_BGR_EXT)) {
 		SpoutLogError("spoutGLDXinterop::ReadMemoryPixels - no data or incorrect format");
 		return false;
 	}
@@ -2990,6 +6370,28 @@ bool spoutGL::ReadMemoryPixels(const char* sendername, unsigned char* pixels,
 	if (!frame.GetNewFrame())
 		return true;
 
+	// Memory ring if the sender has created one
+	if (OpenMemoryRing(sendername, width, height)) {
+		// The slot can be over-written by the sender while it is copied.
+		// Copy again from the latest frame if it has been.
+		for (int i = 0; i < SPOUT_MEMORY_SLOTS; i++) {
+			LONG64 ringframe = 0;
+			const unsigned char* pSlot = BeginMemoryRingRead(width, height, ringframe);
+			if (!pSlot) {
+				if (ringframe == 0)
+					return true; // No new frame
+				continue; // Over-written
+			}
+			if (glFormat == GL_RGBA)
+				spoutcopy.CopyPixels(pSlot, pixels, width, height, glFormat, bInvert);
+			else
+				spoutcopy.ConvertPixels(pSlot, pixels, width, height, GL_RGBA, glFormat, 0, 0, bInvert);
+			if (EndMemoryRingRead(ringframe))
+				return true;
+		}
+		return false;
+	}
+
 	// Open a shared memory map if it not already
 	if (!memoryshare.Name()) {
 		// Create a name for the map from the sender name
@@ -3010,7 +6412,10 @@ bool spoutGL::ReadMemoryPixels(const char* sendername, unsigned char* pixels,
 
 	// Query a new frame and read pixels while the buffer is locked
 	// Read pixels from shared memory
-	spoutcopy.CopyPixels((unsigned char*)pBuffer, pixels, width, height, glFormat, bInvert);
+	if (glFormat == GL_RGBA)
+		spoutcopy.CopyPixels((unsigned char*)pBuffer, pixels, width, height, glFormat, bInvert);
+	else
+		spoutcopy.ConvertPixels(pBuffer, pixels, width, height, GL_RGBA, glFormat, 0, 0, bInvert);
 
 	memoryshare.Unlock();
 
@@ -3018,40 +6423,281 @@ bool spoutGL::ReadMemoryPixels(const char* sendername, unsigned char* pixels,
 
 }
 
+//
+// Write an OpenGL texture to shared memory.
+// If TextureID is zero, the texture attached to the fbo bound for read.
+//
+bool spoutGL::WriteMemoryTexture(const char* sendername, GLuint TextureID, GLuint TextureTarget,
+	unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO)
+{
+	// Read to the class buffer and write the pixels to the memory ring
+	const size_t bytes = (size_t)width * height * 4;
+	if (m_MemoryRingPixels.size() < bytes)
+		m_MemoryRingPixels.resize(bytes);
+
+	if (TextureID == 0) {
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)m_MemoryRingPixels.data());
+	}
+	else if (!ReadTextureData(TextureID, TextureTarget, width, height, width * 4,
+		m_MemoryRingPixels.data(), GL_RGBA, false, HostFBO)) {
+		return false;
+	}
+
+	return WriteMemoryPixels(sendername, m_MemoryRingPixels.data(), width, height, GL_RGBA, bInvert);
+}
+
 //
 // Write image pixels to shared memory
 //
-bool spoutGL::WriteMemoryPixels(const char *sendername, const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert)
+// RGBA, BGRA, RGB and BGR pixels are written to the memory ring as RGBA.
+// pitch is the bytes of each source line, or 0 for packed pixels.
+//
+bool spoutGL::WriteMemoryPixels(const char *sendername, const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, unsigned int pitch)
 {
-	if (!pixels || glFormat != GL_RGBA) {
+	if (!pixels || !(glFormat == GL_RGBA || glFormat == GL_BGRA_EXT || glFormat == GL_RGB || glFormat == GL_BGR_EXT)) {
 		SpoutLogError("spoutGLDXinterop::WriteMemoryPixels - no data or incorrect format");
 		return false;
 	}
 
-	// Create a shared memory map if it does not exist yet
-	char* pBuffer = nullptr;
-	if (memoryshare.Size() == 0) {
-		// Create a name for the map from the sender name
-		std::string namestring = sendername;
-		namestring += "_map";
-		if (memoryshare.Create(sendername, width*4*height) != SPOUT_CREATE_FAILED) {
-			SpoutLogError("SpoutSharedMemory::WriteMemoryPixels - could not create shared memory");
-			return false;
-		}
-		pBuffer = memoryshare.Lock();
-		if (!pBuffer) {
-			SpoutLogError("SpoutSharedMemory::WriteMemoryPixels - no buffer lock");
-			return false;
+	// Create the memory ring, or a new ring for a different size
+	if (!CreateMemoryRing(sendername, width, height))
+		return false;
+
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (!pRing)
+		return false;
+
+	// Write the slot after the latest frame. Receivers can still
+	// be reading the latest frame and the one before it.
+	const LONG64 ringframe = m_MemoryRingFrame + 1;
+	const int slot = (int)(ringframe % SPOUT_MEMORY_SLOTS);
+	unsigned char* pSlot = SpoutMemoryRingSlot(pRing, slot);
+
+	// Packed rgba pixels are copied or compressed, others are converted
+	const bool bPacked = (glFormat == GL_RGBA && (pitch == 0 || pitch == width * 4));
+
+	// Compress if it has been faster than writing pixels.
+	// Time the other method at intervals for a change of content.
+	bool bCompress = false;
+	if (m_bMemoryCompress && !bInvert && bPacked) {
+		m_MemoryCodecFrames++;
+		bCompress = (m_MemoryCodecTime <= m_MemoryRawTime);
+		if (m_MemoryCodecFrames >= 60) {
+			bCompress = !bCompress;
+			m_MemoryCodecFrames = 0;
 		}
 	}
 
-	// Write pixel data to shared memory
-	spoutcopy.CopyPixels(pixels, (unsigned char *)pBuffer, width, height, glFormat, bInvert);
+	LARGE_INTEGER start = {};
+	if (m_bMemoryCompress)
+		QueryPerformanceCounter(&start);
+
+	// Odd sequence while the slot is written
+	InterlockedExchange64(&pRing->sequence[slot], ringframe * 2 - 1);
+	pRing->width = width;
+	pRing->height = height;
+	unsigned int size = 0;
+	if (bCompress)
+		size = spoutcopy.EncodePixels(pixels, pSlot, width, height, width * height * 4);
+	if (!bPacked)
+		spoutcopy.ConvertPixels(pixels, pSlot, width, height, glFormat, GL_RGBA, pitch, 0, bInvert);
+	else if (size == 0)
+		spoutcopy.CopyPixels(pixels, pSlot, width, height, glFormat, bInvert);
+	pRing->size[slot] = size;
+
+	if (m_bMemoryCompress) {
+		// Average time of each method. A frame that could not be
+		// compressed includes the time of both.
+		LARGE_INTEGER end = {};
+		LARGE_INTEGER frequency = {};
+		QueryPerformanceCounter(&end);
+		QueryPerformanceFrequency(&frequency);
+		const double msec = (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart;
+		double& average = bCompress ? m_MemoryCodecTime : m_MemoryRawTime;
+		average = (average == 0.0) ? msec : average * 0.9 + msec * 0.1;
+	}
+	m_bMemoryCompressed = (size > 0);
+
+	// Complete and publish as the latest frame
+	InterlockedExchange64(&pRing->sequence[slot], ringframe * 2);
+	InterlockedExchange64(&pRing->latest, ringframe);
+	m_MemoryRingFrame = ringframe;
+
+	// Increment the sender frame counter for receivers
+	frame.SetNewFrame();
 
-	memoryshare.Unlock();
+	return true;
+
+}
+
+//
+// Memory share ring
+//
+// The ring map "<sendername>_memring_<width>x<height>" has a header with the
+// frame size and sequence numbers, followed by SPOUT_MEMORY_SLOTS slots of
+// rgba pixels (SpoutMemoryRing). For a different size, the writer closes the
+// ring and creates one with the name of the new size, so that a map is never
+// created again while receivers have it open.
+// A slot with a size has compressed pixels (SetMemoryCompression).
+// The writer copies each frame to the slot after the latest frame and
+// then publishes it. Receivers copy the latest frame and check that the
+// slot sequence has not changed during the copy. Neither waits for the other.
+//
+
+// Writer - create the ring map for the frame size
+bool spoutGL::CreateMemoryRing(const char* sendername, unsigned int width, unsigned int height)
+{
+	if (!sendername || !*sendername || width == 0 || height == 0)
+		return false;
+
+	const uint64_t bytes = (uint64_t)width * height * 4;
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (pRing) {
+		if (width == pRing->width && height == pRing->height)
+			return true;
+		// A different size. Close the ring so that receivers
+		// release it and create a new one with a new name.
+		CloseMemoryRing(true);
+	}
+
+	// Slot capacity is 32 bit and the whole ring is mapped
+	const uint64_t mapsize = sizeof(SpoutMemoryRing) + bytes * SPOUT_MEMORY_SLOTS;
+	if (bytes > 0xFFFFFFFF || mapsize > (uint64_t)SIZE_MAX) {
+		SpoutLogWarning("spoutGL::CreateMemoryRing - %dx%d too large", width, height);
+		return false;
+	}
+
+	char mapname[SpoutMaxSenderNameLen+32]={};
+	SpoutMemoryRingName(mapname, SpoutMaxSenderNameLen+32, sendername, width, height);
+	const SpoutCreateResult result = m_MemoryRing.Create(mapname, mapsize);
+	if (result == SPOUT_CREATE_FAILED) {
+		SpoutLogError("spoutGL::CreateMemoryRing - could not create [%s]", mapname);
+		return false;
+	}
+
+	// A ring of this size created before is used again
+	// if receivers still have it open. The frame continues
+	// from the latest so that they find new frames.
+	pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (result == SPOUT_ALREADY_EXISTS && pRing->capacity != 0
+		&& (pRing->capacity != (uint32_t)bytes || pRing->offset != 0)) {
+		// Created by another writer with a different layout
+		SpoutLogWarning("spoutGL::CreateMemoryRing - [%s] has a different layout", mapname);
+		m_MemoryRing.Close();
+		return false;
+	}
+
+	// Mapping objects are initially zeros
+	pRing->capacity = (uint32_t)bytes;
+	pRing->width = width;
+	pRing->height = height;
+	m_MemoryRingFrame = pRing->latest;
+	InterlockedExchange((volatile LONG*)&pRing->magic, (LONG)SPOUT_MEMORY_RING);
+
+	SpoutLogNotice("spoutGL::CreateMemoryRing - [%s] %d slots", mapname, SPOUT_MEMORY_SLOTS);
 
 	return true;
+}
+
+// Receiver - open the sender's ring map for the sender size if it has one
+bool spoutGL::OpenMemoryRing(const char* sendername, unsigned int width, unsigned int height)
+{
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (pRing) {
+		if (pRing->magic == SPOUT_MEMORY_RING && pRing->width == width && pRing->height == height)
+			return true;
+		// Closed by the writer or a different size
+		CloseMemoryRing();
+	}
+
+	if (!sendername || !*sendername || width == 0 || height == 0)
+		return false;
+
+	char mapname[SpoutMaxSenderNameLen+32]={};
+	SpoutMemoryRingName(mapname, SpoutMaxSenderNameLen+32, sendername, width, height);
+	if (!m_MemoryRing.Open(mapname))
+		return false;
+
+	pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (!pRing || pRing->magic != SPOUT_MEMORY_RING) {
+		m_MemoryRing.Close();
+		return false;
+	}
+
+	m_MemoryRingFrame = 0;
+	SpoutLogNotice("spoutGL::OpenMemoryRing - opened [%s]", mapname);
+
+	return true;
+}
+
+// Close the ring map.
+// A writer closes the ring for receivers first (bWriter).
+void spoutGL::CloseMemoryRing(bool bWriter)
+{
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (bWriter && pRing)
+		InterlockedExchange((volatile LONG*)&pRing->magic, 0);
+	m_MemoryRing.Close();
+	m_MemoryRingFrame = 0;
+	std::vector<unsigned char>().swap(m_MemoryRingPixels);
+}
+
+// Receiver - pixels of the latest complete frame.
+// Returns null with ringframe = 0 for no new frame or a different size.
+// The pixels must be checked by EndMemoryRingRead after they are copied.
+const unsigned char* spoutGL::BeginMemoryRingRead(unsigned int width, unsigned int height, LONG64 &ringframe)
+{
+	ringframe = 0;
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (!pRing)
+		return nullptr;
+
+	const LONG64 latest = InterlockedCompareExchange64(&pRing->latest, 0, 0);
+	if (latest == 0 || latest == m_MemoryRingFrame)
+		return nullptr;
+
+	if (pRing->width != width || pRing->height != height)
+		return nullptr;
+
+	// The slot must still have the latest frame
+	const int slot = (int)(latest % SPOUT_MEMORY_SLOTS);
+	if (InterlockedCompareExchange64(&pRing->sequence[slot], 0, 0) != latest * 2) {
+		ringframe = latest; // Over-written, try again
+		return nullptr;
+	}
+
+	ringframe = latest;
+
+	// Compressed pixels are decompressed to a buffer. The slot is checked
+	// by EndMemoryRingRead and is over-written if the data is not complete.
+	const unsigned int size = pRing->size[slot];
+	if (size > 0) {
+		const size_t bytes = (size_t)width * height * 4;
+		if (m_MemoryRingPixels.size() < bytes)
+			m_MemoryRingPixels.resize(bytes);
+		if (size > pRing->capacity
+			|| !spoutcopy.DecodePixels(SpoutMemoryRingSlot(pRing, slot), size, m_MemoryRingPixels.data(), width, height))
+			return nullptr;
+		return m_MemoryRingPixels.data();
+	}
 
+	return SpoutMemoryRingSlot(pRing, slot);
+}
+
+// Receiver - true if the slot was not over-written while it was copied
+bool spoutGL::EndMemoryRingRead(LONG64 ringframe)
+{
+	SpoutMemoryRing* pRing = reinterpret_cast<SpoutMemoryRing*>(m_MemoryRing.Buffer());
+	if (!pRing || ringframe == 0)
+		return false;
+
+	const int slot = (int)(ringframe % SPOUT_MEMORY_SLOTS);
+	MemoryBarrier();
+	if (InterlockedCompareExchange64(&pRing->sequence[slot], 0, 0) != ringframe * 2)
+		return false;
+
+	m_MemoryRingFrame = ringframe;
+	return true;
 }
 
 //
@@ -3112,12 +6758,7 @@ void spoutGL::CleanupDX11()
 		m_dxShareHandle = nullptr;
 
 		// Release staging texture if they have been used
-		if (m_pStaging[0]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[0]);
-		if (m_pStaging[1]) spoutdx.ReleaseDX11Texture(spoutdx.GetDX11Device(), m_pStaging[1]);
-		m_pStaging[0] = nullptr;
-		m_pStaging[1] = nullptr;
-		m_Index = 0;
-		m_NextIndex = 0;
+		ReleaseStagingTextures();
 
 		// Flush context to avoid deferred release
 		spoutdx.Flush();
@@ -3129,6 +6770,10 @@ void spoutGL::CleanupDX11()
 		// spoutdx.GetDX11Context() and spoutdx.GetDX11Device() are copies of these
 		spoutdx.CloseDirectX11();
 
+		// Release this instance from the process interop context
+		// The shared device is released with the last instance
+		ReleaseSharedInterop();
+
 	}
 	else {
 		SpoutLogNotice("spoutGL::CleanupDX11() - device closed");
@@ -3162,6 +6807,9 @@ bool spoutGL::LoadGLextensions()
 	m_bBGRAavailable = false;
 	m_bCOPYavailable = false;
 	m_bCONTEXTavailable = false;
+	m_bDSAavailable = false;
+	m_bMEMORYavailable = false;
+	m_bPINNEDavailable = false;
 
 	m_caps = loadGLextensions(); // in spoutGLextensions
 
@@ -3187,6 +6835,9 @@ bool spoutGL::LoadGLextensions()
 	if (m_caps & GLEXT_SUPPORT_BGRA)      m_bBGRAavailable = true;
 	if (m_caps & GLEXT_SUPPORT_COPY)      m_bCOPYavailable = true;
 	if (m_caps & GLEXT_SUPPORT_CONTEXT)   m_bCONTEXTavailable = true;
+	if (m_caps & GLEXT_SUPPORT_DSA)       m_bDSAavailable = true;
+	if (m_caps & GLEXT_SUPPORT_MEMORY)    m_bMEMORYavailable = true;
+	if (m_caps & GLEXT_SUPPORT_PINNED)    m_bPINNEDavailable = true;
 
 	// Test PBO availability unless user has checked buffering OFF (sets m_bPBOavailable false)
 	// m_bPBOavailable can also be set by the application with SetBufferMode()
@@ -3225,43 +6876,103 @@ bool spoutGL::LoadGLextensions()
 //---------------------------------------------------------
 bool spoutGL::IsGLDXavailable()
 {
+	CheckGLextensions();
 	return m_bGLDXavailable;
 }
 
 //---------------------------------------------------------
 bool spoutGL::IsBLITavailable()
 {
+	CheckGLextensions();
 	return m_bBLITavailable;
 }
 
 //---------------------------------------------------------
 bool spoutGL::IsSWAPavailable()
 {
+	CheckGLextensions();
 	return m_bSWAPavailable;
 }
 
 //---------------------------------------------------------
 bool spoutGL::IsBGRAavailable()
 {
+	CheckGLextensions();
 	return m_bBGRAavailable;
 }
 
 //---------------------------------------------------------
 bool spoutGL::IsCOPYavailable()
 {
+	CheckGLextensions();
 	return m_bCOPYavailable;
 }
 
 //---------------------------------------------------------
 bool spoutGL::IsPBOavailable()
 {
+	CheckGLextensions();
 	return m_bPBOavailable;
 }
 
-//---------------------------------------------------------
-bool spoutGL::IsCONTEXTavailable()
-{
-	return m_bCONTEXTavailable;
+//---------------------------------------------------------
+bool spoutGL::IsCONTEXTavailable()
+{
+	CheckGLextensions();
+	return m_bCONTEXTavailable;
+}
+
+//---------------------------------------------------------
+bool spoutGL::IsMEMORYavailable()
+{
+	CheckGLextensions();
+	return m_bMEMORYavailable;
+}
+
+//---------------------------------------------------------
+// Load extensions when first needed if there is a context.
+// No warning if there is no context yet.
+bool spoutGL::CheckGLextensions()
+{
+	if (m_bExtensionsLoaded)
+		return true;
+	if (!wglGetCurrentContext())
+		return false;
+	return LoadGLextensions();
+}
+
+//---------------------------------------------------------
+// Graphics identity for the recorded GL/DX compatibility test.
+// DirectX 11 adapter vendor, device and subsystem IDs, user mode
+// driver version and the OpenGL renderer of the current context.
+bool spoutGL::GetGLDXkey(char* key, int maxchars)
+{
+	if (!key || maxchars <= 0 || !spoutdx.GetDX11Device())
+		return false;
+
+	const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	if (!renderer)
+		return false;
+
+	IDXGIDevice* pDXGIDevice = nullptr;
+	IDXGIAdapter* pAdapter = nullptr;
+	DXGI_ADAPTER_DESC desc={};
+	LARGE_INTEGER umdVersion={};
+	bool bKey = false;
+	if (SUCCEEDED(spoutdx.GetDX11Device()->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&pDXGIDevice)))) {
+		if (SUCCEEDED(pDXGIDevice->GetAdapter(&pAdapter))) {
+			if (SUCCEEDED(pAdapter->GetDesc(&desc))
+				&& SUCCEEDED(pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion))) {
+				sprintf_s(key, maxchars, "%.4X-%.4X-%.8X-%.16llX %.128s",
+					desc.VendorId, desc.DeviceId, desc.SubSysId, umdVersion.QuadPart, renderer);
+				bKey = true;
+			}
+			pAdapter->Release();
+		}
+		pDXGIDevice->Release();
+	}
+
+	return bKey;
 }
 
 // 
@@ -3288,7 +6999,14 @@ void spoutGL::SaveOpenGLstate(unsigned int width, unsigned int height, bool bFit
 	glPushAttrib(GL_TRANSFORM_BIT);
 
 	// find the current viewport dimensions in order to scale to the aspect ratio required
-	glGetFloatv(GL_VIEWPORT, dim);
+	GLint viewport[4]={};
+	if (m_bStateShadow && GetHostViewport(viewport)) {
+		for (int i = 0; i < 4; i++)
+			dim[i] = (float)viewport[i];
+	}
+	else {
+		glGetFloatv(GL_VIEWPORT, dim);
+	}
 
 	// Fit to window
 	if (bFitWindow) {
@@ -3517,7 +7235,7 @@ void spoutGL::DoDiagnostics(const char *error = nullptr)
 					// Test compatibility
 					// Repeat the test if already done
 					m_bGLDXdone = false;
-					if (!GLDXready()) {
+					if (!GLDXready(false)) {
 						SpoutLogWarning("OpenGL/DX11 texture sharing failed");
 					}
 					else {
@@ -3607,6 +7325,182 @@ bool spoutGL::GLerror() {
 	return bError;
 }
 
+// Debug output message callback.
+// Called by the driver, possibly from another thread.
+static void APIENTRY GLdebugMessage(GLenum source, GLenum type, GLuint id,
+	GLenum severity, GLsizei length, const char* message, const void* userParam)
+{
+	UNREFERENCED_PARAMETER(source);
+	UNREFERENCED_PARAMETER(length);
+	UNREFERENCED_PARAMETER(userParam);
+	if (type == GL_DEBUG_TYPE_ERROR)
+		SpoutLogError("    GLdebug - OpenGL error %u (0x%.4X) : %s", id, severity, message);
+	else
+		SpoutLogWarning("    GLdebug - OpenGL message %u (0x%.4X) : %s", id, severity, message);
+}
+
+//---------------------------------------------------------
+// Function: SetDebugOutput
+//   Asynchronous OpenGL error reporting (KHR_debug).
+//
+//   Errors and high severity messages are logged by the driver
+//   as they occur instead of by glGetError after each copy.
+//   glGetError is not used for each frame in release builds,
+//   so this is the way to show OpenGL errors for a release build.
+//   Requires OpenGL 4.3 or a KHR_debug context. Messages may not
+//   be generated unless the context is created with the debug flag.
+//   DoDiagnostics and PrintFBOstatus still check errors with GLerror.
+bool spoutGL::SetDebugOutput(bool bDebug)
+{
+	if (!wglGetCurrentContext()) {
+		SpoutLogWarning("spoutGL::SetDebugOutput - no OpenGL context");
+		return false;
+	}
+
+	if (m_caps == 0 && !LoadGLextensions())
+		return false;
+
+	if (!(m_caps & GLEXT_SUPPORT_DEBUG)) {
+		SpoutLogWarning("spoutGL::SetDebugOutput - debug output not supported");
+		m_bDebugOutput = false;
+		return false;
+	}
+
+	if (bDebug) {
+		// Errors of any severity and other messages of high severity
+		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_HIGH, 0, nullptr, GL_TRUE);
+		glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+		glDebugMessageCallback(GLdebugMessage, nullptr);
+		// Not GL_DEBUG_OUTPUT_SYNCHRONOUS, which would stall the driver
+		glEnable(GL_DEBUG_OUTPUT);
+	}
+	else {
+		glDisable(GL_DEBUG_OUTPUT);
+		glDebugMessageCallback(nullptr, nullptr);
+	}
+	m_bDebugOutput = bDebug;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetDebugOutput
+//   Asynchronous OpenGL error reporting enabled
+bool spoutGL::GetDebugOutput()
+{
+	return m_bDebugOutput;
+}
+
+//---------------------------------------------------------
+// Function: EnableGPUTiming
+//   Record the GPU time of texture copies and shaders in the timer.
+//
+//   CPU scopes only measure the time to submit the commands.
+//   GL_TIMESTAMP queries before and after the copy of the linked
+//   texture record "GPUSharedCopy" and compute or draw shaders
+//   record "GPUShader". For CPU sharing, DirectX timestamp queries
+//   record the staging texture copy as "GPUStagingCopy".
+//   Results are read a few frames later without waiting for the GPU
+//   and recorded if the timer is also enabled (timer.Enable()).
+//   OpenGL timing requires OpenGL 3.3 or ARB_timer_query.
+void spoutGL::EnableGPUTiming(bool bEnable)
+{
+	if (!bEnable)
+		ReleaseGLTiming();
+	m_bGPUTiming = bEnable;
+	spoutdx.EnableGPUTiming(bEnable ? &timer : nullptr);
+}
+
+//---------------------------------------------------------
+// Function: IsGPUTiming
+//   GPU timing status
+bool spoutGL::IsGPUTiming()
+{
+	return m_bGPUTiming;
+}
+
+// Start a GL_TIMESTAMP query pair for a named scope.
+// Queries are created in the current context when first used.
+// A scope is not timed if all the queries are in flight.
+// A scope within another, such as a shader copy within a
+// texture copy, is included in the time of the outer scope.
+void spoutGL::BeginGLTime(const char* name)
+{
+	if (m_glScopeDepth++ > 0)
+		return;
+
+	if (!m_bGPUTiming || !name || !timer.IsEnabled())
+		return;
+
+	if (!(m_caps & GLEXT_SUPPORT_TIMER))
+		return;
+
+	if (m_glQuery[0][0] == 0) {
+		glGenQueries(SPOUT_GL_QUERIES*2, &m_glQuery[0][0]);
+		SpoutLogNotice("spoutGL::BeginGLTime - created %d timer queries", SPOUT_GL_QUERIES*2);
+	}
+
+	// Read completed scopes to free the ring
+	ReadGLTimes();
+	if (m_glQueryPending >= SPOUT_GL_QUERIES)
+		return;
+
+	m_glQueryName[m_glQueryWrite] = name;
+	glQueryCounter(m_glQuery[m_glQueryWrite][0], GL_TIMESTAMP);
+	m_bGLScope = true;
+}
+
+// End the scope started by BeginGLTime
+void spoutGL::EndGLTime()
+{
+	if (m_glScopeDepth > 0)
+		m_glScopeDepth--;
+
+	if (m_glScopeDepth > 0 || !m_bGLScope)
+		return;
+
+	glQueryCounter(m_glQuery[m_glQueryWrite][1], GL_TIMESTAMP);
+	m_glQueryWrite = (m_glQueryWrite + 1) % SPOUT_GL_QUERIES;
+	m_glQueryPending++;
+	m_bGLScope = false;
+}
+
+// Record the time of completed scopes in the timer.
+// The oldest scope that is not available stops the read.
+void spoutGL::ReadGLTimes()
+{
+	while (m_glQueryPending > 0) {
+		GLint available = 0;
+		glGetQueryObjectiv(m_glQuery[m_glQueryRead][1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(m_glQuery[m_glQueryRead][0], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(m_glQuery[m_glQueryRead][1], GL_QUERY_RESULT, &end);
+		// Nanoseconds
+		if (end >= begin)
+			timer.Record(m_glQueryName[m_glQueryRead], static_cast<double>(end - begin)/1000000.0);
+		m_glQueryRead = (m_glQueryRead + 1) % SPOUT_GL_QUERIES;
+		m_glQueryPending--;
+	}
+}
+
+// Delete the timer queries. Requires the context they were created in.
+void spoutGL::ReleaseGLTiming()
+{
+	if (m_glQuery[0][0] > 0 && wglGetCurrentContext())
+		glDeleteQueries(SPOUT_GL_QUERIES*2, &m_glQuery[0][0]);
+	ZeroMemory(m_glQuery, sizeof(m_glQuery));
+	ZeroMemory(m_glQueryName, sizeof(m_glQueryName));
+	m_glQueryWrite = 0;
+	m_glQueryRead = 0;
+	m_glQueryPending = 0;
+	m_glScopeDepth = 0;
+	m_bGLScope = false;
+}
+
 //
 // Group: User registry settings recorded by "SpoutSettings"
 //
@@ -3628,7 +7522,7 @@ bool spoutGL::GetBufferMode()
 // Set application buffering mode
 void spoutGL::SetBufferMode(bool bActive)
 {
-	if (m_bExtensionsLoaded) {
+	if (CheckGLextensions()) {
 		if (bActive) {
 			if (m_caps & GLEXT_SUPPORT_PBO) {
 				m_bPBOavailable = true;
@@ -3659,6 +7553,199 @@ void spoutGL::SetBuffers(int nBuffers)
 	m_nBuffers = nBuffers;
 }
 
+//---------------------------------------------------------
+// Function: GetStagingBuffers
+// Get number of staging textures used for CPU receive
+int spoutGL::GetStagingBuffers()
+{
+	return m_nStaging;
+}
+
+//---------------------------------------------------------
+// Function: SetStagingBuffers
+// Set number of staging textures used for CPU receive (1-4).
+//
+// With more than one, ReadDX11texture and ReadDX11pixels copy each new frame
+// to the next staging texture in a ring and map the oldest, so that
+// mapping does not wait for the GPU copy to complete.
+// The received frame is delayed by (nBuffers-1) frames.
+// ReadDX11pixels always uses at least two.
+void spoutGL::SetStagingBuffers(int nBuffers)
+{
+	if (nBuffers < 1) nBuffers = 1;
+	if (nBuffers > 4) nBuffers = 4;
+	if (nBuffers != m_nStaging) {
+		// Re-created by CheckStagingTextures
+		ReleaseStagingTextures();
+		m_nStaging = nBuffers;
+	}
+}
+
+//---------------------------------------------------------
+// Function: GetPersistentBufferMode
+// Get persistent mapped pixel buffer mode
+bool spoutGL::GetPersistentBufferMode()
+{
+	return m_bPersistentPbo;
+}
+
+//---------------------------------------------------------
+// Function: SetPersistentBufferMode
+// Set persistent mapped pixel buffers for OpenGL pixel read and upload.
+//
+// Buffering mode must also be enabled (SetBufferMode).
+// Pixel buffers are created once, remain mapped and are read after
+// a fence so that there is no map and unmap for each frame.
+// Requires OpenGL 4.4 or ARB_buffer_storage (IsPersistentBufferAvailable).
+void spoutGL::SetPersistentBufferMode(bool bActive)
+{
+	if (!bActive && m_nPersistent > 0)
+		ReleasePersistentBuffers();
+	// Unpack buffers are re-created for a change of mode by LoadTexturePixels
+	m_bPersistentPbo = bActive;
+}
+
+//---------------------------------------------------------
+// Function: IsPersistentBufferAvailable
+// Persistent mapped pixel buffers supported
+bool spoutGL::IsPersistentBufferAvailable()
+{
+	return (CheckGLextensions() && (m_caps & GLEXT_SUPPORT_PBO)
+		&& glBufferStorage && glMapBufferRange
+		&& glFenceSync && glClientWaitSync && glDeleteSync);
+}
+
+//---------------------------------------------------------
+// Function: GetPinnedMemoryMode
+// Get pinned memory pixel read mode
+bool spoutGL::GetPinnedMemoryMode()
+{
+	return m_bPinnedMemory;
+}
+
+//---------------------------------------------------------
+// Function: SetPinnedMemoryMode
+// Set pixel read directly to the application buffer.
+//
+// With GL_AMD_pinned_memory, the application pixel buffer passed to
+// ReceiveImage is used as the store of a pixel buffer, so that pixels
+// are read to it by the GPU without a copy from a mapped PBO.
+// The buffer is pinned after it has been passed twice with the same
+// address and size, and is released when the address or size changes.
+// It must be page aligned. Disable pinned mode before the buffer is freed.
+// The PBO method is used if the buffer could not be pinned or for invert.
+void spoutGL::SetPinnedMemoryMode(bool bActive)
+{
+	if (!bActive) {
+		ReleasePinnedBuffer();
+		m_pPinnedData = nullptr;
+		m_pinnedSize = 0;
+	}
+	m_bPinnedMemory = bActive;
+}
+
+//---------------------------------------------------------
+// Function: IsPinnedMemoryAvailable
+// Pinned memory supported (AMD_pinned_memory)
+bool spoutGL::IsPinnedMemoryAvailable()
+{
+	return (CheckGLextensions() && m_bPINNEDavailable
+		&& glFenceSync && glClientWaitSync && glDeleteSync);
+}
+
+//---------------------------------------------------------
+// Function: GetComputeConversion
+// Get compute shader pixel conversion
+bool spoutGL::GetComputeConversion()
+{
+	return m_bComputeConversion;
+}
+
+//---------------------------------------------------------
+// Function: SetComputeConversion
+// Set compute shader pixel conversion for pixel send and receive.
+//
+// ReadGLDXpixels and WriteGLDXpixels convert between the shared texture
+// and RGBA, BGRA, RGB or BGR pixels with invert in one compute dispatch
+// instead of glTexSubImage2D / glReadPixels format conversion.
+// Requires OpenGL 4.3. Reverts to the default method if the shader fails.
+void spoutGL::SetComputeConversion(bool bCompute)
+{
+	m_bComputeConversion = bCompute;
+}
+
+//---------------------------------------------------------
+// Function: GetComputeRGB
+// Get compute shader RGB packing for pixel receive
+bool spoutGL::GetComputeRGB()
+{
+	return m_bComputeRGB;
+}
+
+//---------------------------------------------------------
+// Function: SetComputeRGB
+// Set compute shader RGB packing for pixel receive (default false).
+//
+// ReadGLDXpixels to GL_RGB or GL_BGR_EXT pixels packs three bytes
+// per pixel by compute shader, so the PBO read is a quarter smaller
+// and there is no conversion by the driver.
+// Requires OpenGL 4.3. Disabled if the shader fails.
+void spoutGL::SetComputeRGB(bool bCompute)
+{
+	m_bComputeRGB = bCompute;
+}
+
+//---------------------------------------------------------
+// Function: GetResampleMode
+// Get resample mode for receiving pixels of different size
+int spoutGL::GetResampleMode()
+{
+	return m_ResampleMode;
+}
+
+//---------------------------------------------------------
+// Function: SetResampleMode
+// Set resample mode for receiving pixels of different size.
+//
+// If the ReceiveImage pixel buffer is a different size than the sender,
+// the shared texture is resampled by compute shader before readback.
+//   0 - nearest
+//   1 - bilinear (default)
+//   2 - box, for reduction by more than half
+// Requires OpenGL 4.3.
+void spoutGL::SetResampleMode(int mode)
+{
+	if (mode < 0) mode = 0;
+	if (mode > 2) mode = 2;
+	m_ResampleMode = mode;
+}
+
+//---------------------------------------------------------
+// Function: GetToneMapping
+// Get tone mapping of floating point senders
+SpoutToneMap spoutGL::GetToneMapping()
+{
+	return m_ToneMap;
+}
+
+//---------------------------------------------------------
+// Function: SetToneMapping
+// Set tone mapping of floating point senders to 8 bit textures and pixels.
+//
+// A sender texture of DXGI_FORMAT_R16G16B16A16_FLOAT or R32G32B32A32_FLOAT
+// (linear, 1.0 = SDR white) is tone mapped and quantised to a local 8 bit
+// sRGB texture by compute shader before the copy by ReceiveTexture or the
+// read back by ReceiveImage. The data read back is then the same as for
+// an 8 bit sender instead of values clamped by the copy.
+//   mode     - SPOUT_TONEMAP_NONE, SPOUT_TONEMAP_REINHARD or SPOUT_TONEMAP_ACES
+//   exposure - scale of the linear values before mapping
+// Requires OpenGL 4.3. Disabled if the shader fails.
+void spoutGL::SetToneMapping(SpoutToneMap mode, float exposure)
+{
+	m_ToneMap = mode;
+	m_ToneMapExposure = (exposure > 0.0f) ? exposure : 1.0f;
+}
+
 //---------------------------------------------------------
 // Function: GetMaxSenders
 // Get user Maximum senders allowed
@@ -3736,13 +7823,15 @@ bool spoutGL::SetCPUmode(bool bCPU)
 
 // Function: GetShareMode
 // Get user share mode
-//  0 - texture, 1 - memory, 2 - CPU
+//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 int spoutGL::GetShareMode()
 {
 	DWORD dwMem = 0;
 	DWORD dwCPU = 0;
+	DWORD dwCalibrate = 0;
 	ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", &dwMem);
 	ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "CPU", &dwCPU);
+	ReadDwordFromRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Calibrate", &dwCalibrate);
 
 	if (dwCPU > 0) {
 		return 2;
@@ -3750,6 +7839,9 @@ int spoutGL::GetShareMode()
 	if (dwMem > 0) {
 		return 1;
 	}
+	if (dwCalibrate > 0) {
+		return 3;
+	}
 
 	// 0 : Texture share default
 	return 0;
@@ -3759,9 +7851,15 @@ int spoutGL::GetShareMode()
 //---------------------------------------------------------
 // Function: SetShareMode
 // Set user share mode
-//  0 - texture, 1 - memory, 2 - CPU
+//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
+//
+// For auto, texture or CPU share is selected by timing each
+// at the sender size (see CalibrateShareMode). Takes effect
+// for applications started after the change.
 void spoutGL::SetShareMode(int mode)
 {
+	WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "Calibrate", (mode == 3) ? 1 : 0);
+
 	switch (mode) {
 
 	case 1: // Memory
@@ -3772,7 +7870,7 @@ void spoutGL::SetShareMode(int mode)
 		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", 0);
 		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "CPU", 1);
 		break;
-	default: // 0 - Texture
+	default: // 0 - Texture, 3 - Auto
 		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "MemoryShare", 0);
 		WriteDwordToRegistry(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout", "CPU", 0);
 		break;
@@ -3887,11 +7985,35 @@ bool spoutGL::CopyTexture(GLuint SourceID, GLuint SourceTarget,
 	GLuint DestID, GLuint DestTarget, unsigned int width, unsigned int height,
 	bool bInvert, GLuint HostFBO)
 {
+	return CopyTextureRegion(SourceID, SourceTarget, DestID, DestTarget,
+		0, 0, width, height, bInvert, HostFBO);
+}
+
+//---------------------------------------------------------
+// Function: CopyTextureRegion
+//   Copy a region of an OpenGL texture with optional invert
+//   The region from xoffset, yoffset of size width x height
+//   is copied to the origin of the destination texture.
+//   The destination texture must be at least the region size.
+//
+bool spoutGL::CopyTextureRegion(GLuint SourceID, GLuint SourceTarget,
+	GLuint DestID, GLuint DestTarget,
+	unsigned int xoffset, unsigned int yoffset,
+	unsigned int width, unsigned int height,
+	bool bInvert, GLuint HostFBO)
+{
 
 	// printf("SourceID = %d, SourceTarget = 0x%X\n", SourceID, SourceTarget); // 0xDE1
 	// printf("DestID   = %d, DestTarget = 0x%X\n", DestID, DestTarget);
 	// return false;
 
+	//
+	// Image copy if there is no invert and the formats are compatible
+	//
+	if (!bInvert && m_bCOPYavailable
+		&& CopyTextureImage(SourceID, SourceTarget, DestID, DestTarget, xoffset, yoffset, width, height))
+		return true;
+
 	//
 	// Fbo blit (0.05 - 0.20 msec)
 	//
@@ -3900,6 +8022,55 @@ bool spoutGL::CopyTexture(GLuint SourceID, GLuint SourceTarget,
 	if (m_fbo == 0)
 		glGenFramebuffersEXT(1, &m_fbo);
 
+	// Retained framebuffers with the textures attached.
+	// If only one is retained, the other texture is attached to the class fbo.
+	if (m_bBLITavailable) {
+		GLuint readFbo = GetTextureFbo(SourceID, SourceTarget);
+		GLuint drawFbo = GetTextureFbo(DestID, DestTarget);
+		if (readFbo != drawFbo && (!readFbo || !drawFbo)) {
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+			if (!readFbo)
+				glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, SourceTarget, SourceID, 0);
+			else
+				glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, DestTarget, DestID, 0);
+			glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+			glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+			if (glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT) {
+				if (!readFbo) readFbo = m_fbo;
+				else drawFbo = m_fbo;
+			}
+			else {
+				// Attach both below
+				glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, 0, 0);
+				readFbo = drawFbo = 0;
+			}
+		}
+		if (readFbo && drawFbo) {
+			// Each framebuffer reads and draws colour attachment 0
+			const GLint dstY0 = bInvert ? (GLint)height : 0;
+			const GLint dstY1 = bInvert ? 0 : (GLint)height;
+#ifdef USE_FBO_EXTENSIONS
+			if (m_bDSAavailable) {
+				// No change of framebuffer binding
+				glBlitNamedFramebuffer(readFbo, drawFbo,
+					xoffset, yoffset, xoffset+width, yoffset+height,
+					0, dstY0, width, dstY1,
+					GL_COLOR_BUFFER_BIT, GL_NEAREST);
+				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+				return true;
+			}
+#endif
+			glBindFramebufferEXT(READ_FRAMEBUFFER_EXT, readFbo);
+			glBindFramebufferEXT(DRAW_FRAMEBUFFER_EXT, drawFbo);
+			glBlitFramebufferEXT(xoffset, yoffset, xoffset+width, yoffset+height,
+				0, dstY0, width, dstY1,
+				GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			// Restore the previous fbo - default is 0
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
+			return true;
+		}
+	}
+
 	// Bind the FBO (for both, READ_FRAMEBUFFER_EXT and DRAW_FRAMEBUFFER_EXT)
 	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
 
@@ -3917,26 +8088,39 @@ bool spoutGL::CopyTexture(GLuint SourceID, GLuint SourceTarget,
 			if (bInvert) {
 				// Copy one texture buffer to the other while flipping upside down
 				// (OpenGL and DirectX have different texture origins)
-				glBlitFramebufferEXT(0, 0, // srcX0, srcY0,
-					width, height,         // srcX1, srcY1
-					0, height,             // dstX0, dstY0,
-					width, 0,              // dstX1, dstY1,
+				glBlitFramebufferEXT(xoffset, yoffset, // srcX0, srcY0,
+					xoffset+width, yoffset+height,     // srcX1, srcY1
+					0, height,                         // dstX0, dstY0,
+					width, 0,                          // dstX1, dstY1,
 					GL_COLOR_BUFFER_BIT, GL_NEAREST);
 			}
 			else {
 				// Do not flip during blit
-				glBlitFramebufferEXT(0, 0, // srcX0, srcY0,
-					width, height,         // srcX1, srcY1
-					0, 0,                  // dstX0, dstY0,
-					width, height,         // dstX1, dstY1,
+				glBlitFramebufferEXT(xoffset, yoffset, // srcX0, srcY0,
+					xoffset+width, yoffset+height,     // srcX1, srcY1
+					0, 0,                              // dstX0, dstY0,
+					width, height,                     // dstX1, dstY1,
 					GL_COLOR_BUFFER_BIT, GL_NEAREST);
 			}
 		}
+		else if (bInvert && xoffset == 0 && yoffset == 0
+			&& SourceTarget == GL_TEXTURE_2D && DestTarget == GL_TEXTURE_2D
+			&& (m_caps & GLEXT_SUPPORT_COMPUTE)
+			&& GetTextureFormat(SourceID, SourceTarget) == GL_RGBA8
+			&& GetTextureFormat(DestID, DestTarget) == GL_RGBA8) {
+			// No fbo blit extension
+			// glCopyTexSubImage2D cannot invert, use the compute shader copy
+			if (!m_pShaders)
+				m_pShaders = new spoutShaders;
+			BeginGLTime("GPUShader");
+			m_pShaders->Copy(SourceID, DestID, width, height, true);
+			EndGLTime();
+		}
 		else {
 			// No fbo blit extension
 			// Copy from the fbo (source texture attached) to the dest texture
 			glBindTexture(DestTarget, DestID);
-			glCopyTexSubImage2D(DestTarget, 0, 0, 0, 0, 0, width, height);
+			glCopyTexSubImage2D(DestTarget, 0, 0, 0, xoffset, yoffset, width, height);
 			glBindTexture(DestTarget, 0);
 		}
 	}
@@ -3958,11 +8142,271 @@ bool spoutGL::CopyTexture(GLuint SourceID, GLuint SourceTarget,
 	// Restore the previous fbo - default is 0
 	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, HostFBO);
 
-	GLerror(); // Show errors
+	// Show errors for debug builds only.
+	// For release builds, use SetDebugOutput.
+#ifdef _DEBUG
+	if (!m_bStateShadow && !m_bDebugOutput)
+		GLerror();
+#endif
+
+	return true;
+
+} // end CopyTextureRegion
+
+//---------------------------------------------------------
+// Function: SetFramebufferCache
+//   Retain framebuffers for application textures used for copy.
+//
+//   A framebuffer is retained with the texture attached so that
+//   the texture is not attached and detached for every copy.
+//   This is always done for textures created by the class.
+//   If enabled for application textures, a texture that has 
+//   been used must be removed with RemoveFramebufferCache
+//   before it is deleted, because OpenGL can re-use the name.
+//
+void spoutGL::SetFramebufferCache(bool bCache)
+{
+	if (!bCache && m_bFramebufferCache && wglGetCurrentContext()) {
+		// Remove application textures
+		for (int i = 0; i < SPOUT_FBO_CACHE; i++) {
+			const GLuint texture = m_TextureFbo[i].texture;
+			if (texture && texture != m_glTexture && texture != m_TexID && texture != m_resampleTexture)
+				RemoveFramebufferCache(texture);
+		}
+	}
+	m_bFramebufferCache = bCache;
+}
+
+//---------------------------------------------------------
+// Function: GetFramebufferCache
+//   Retain framebuffers for application textures
+bool spoutGL::GetFramebufferCache()
+{
+	return m_bFramebufferCache;
+}
+
+//---------------------------------------------------------
+// Function: RemoveFramebufferCache
+//   Release the retained framebuffer of a texture.
+//   Zero texture ID releases all.
+//   Requires the OpenGL context of the texture.
+void spoutGL::RemoveFramebufferCache(GLuint TextureID)
+{
+	for (int i = 0; i < SPOUT_FBO_CACHE; i++) {
+		SpoutTextureFbo* pFbo = &m_TextureFbo[i];
+		if (pFbo->fbo && (TextureID == 0 || pFbo->texture == TextureID)) {
+			glDeleteFramebuffersEXT(1, &pFbo->fbo);
+			ZeroMemory(pFbo, sizeof(SpoutTextureFbo));
+		}
+	}
+}
+
+// Retained framebuffer with a texture attached to colour attachment 0.
+// Returns zero if the texture should be attached to the class fbo.
+GLuint spoutGL::GetTextureFbo(GLuint TextureID, GLuint TextureTarget)
+{
+	if (TextureID == 0)
+		return 0;
+
+	// Application textures only if enabled
+	if (!m_bFramebufferCache
+		&& TextureID != m_glTexture && TextureID != m_TexID && TextureID != m_resampleTexture)
+		return 0;
+
+	int oldest = 0;
+	for (int i = 0; i < SPOUT_FBO_CACHE; i++) {
+		SpoutTextureFbo* pFbo = &m_TextureFbo[i];
+		if (pFbo->fbo && pFbo->texture == TextureID && pFbo->target == TextureTarget) {
+			pFbo->used = ++m_TextureFboUsed;
+			return pFbo->fbo;
+		}
+		if (pFbo->used < m_TextureFbo[oldest].used)
+			oldest = i;
+	}
+
+	// Attach the texture to the least recently used framebuffer.
+	// Framebuffer completeness is checked once when it is attached.
+	SpoutTextureFbo* pFbo = &m_TextureFbo[oldest];
+	GLenum status = 0;
+#ifdef USE_FBO_EXTENSIONS
+	if (m_bDSAavailable && TextureTarget == GL_TEXTURE_2D) {
+		if (!pFbo->fbo)
+			glCreateFramebuffers(1, &pFbo->fbo);
+		glNamedFramebufferTexture(pFbo->fbo, GL_COLOR_ATTACHMENT0_EXT, TextureID, 0);
+		status = glCheckNamedFramebufferStatusEXT(pFbo->fbo, GL_FRAMEBUFFER_EXT);
+	}
+	else
+#endif
+	{
+		// Restore the read and draw bindings after attach
+		GLint readFbo = 0;
+		GLint drawFbo = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING_EXT, &readFbo);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING_EXT, &drawFbo);
+		if (!pFbo->fbo)
+			glGenFramebuffersEXT(1, &pFbo->fbo);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, pFbo->fbo);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, TextureTarget, TextureID, 0);
+		status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+		glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, (GLuint)readFbo);
+		glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, (GLuint)drawFbo);
+	}
+
+	if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+		// Use the class fbo for this texture
+		glDeleteFramebuffersEXT(1, &pFbo->fbo);
+		ZeroMemory(pFbo, sizeof(SpoutTextureFbo));
+		return 0;
+	}
+
+	pFbo->texture = TextureID;
+	pFbo->target = TextureTarget;
+	pFbo->format = GLformat(TextureID, TextureTarget);
+	pFbo->used = ++m_TextureFboUsed;
+
+	return pFbo->fbo;
+}
+
+// Internal format of a texture.
+// Retained framebuffers record the format when the texture is attached.
+GLint spoutGL::GetTextureFormat(GLuint TextureID, GLuint TextureTarget)
+{
+	if (TextureID == 0)
+		return 0;
+	for (int i = 0; i < SPOUT_FBO_CACHE; i++) {
+		if (m_TextureFbo[i].fbo && m_TextureFbo[i].texture == TextureID
+			&& m_TextureFbo[i].target == TextureTarget && m_TextureFbo[i].format != 0)
+			return m_TextureFbo[i].format;
+	}
+	// No query for each frame if the state is shadowed
+	if (m_bStateShadow)
+		return 0;
+	return GLformat(TextureID, TextureTarget);
+}
+
+//---------------------------------------------------------
+// Function: SetStateShadow
+//   Avoid OpenGL state and error queries for each frame.
+//
+//   Some drivers with threaded optimization synchronize
+//   for every glGet query. If the state is shadowed :
+//
+//   - Framebuffer bindings are not queried. The host passes
+//     the bound framebuffer as HostFBO as for the default mode.
+//   - The viewport is not queried if set by SetHostViewport.
+//   - Texture formats are not queried for application textures
+//     without a retained framebuffer (see SetFramebufferCache).
+//     The copy is then by fbo blit.
+//   - OpenGL errors are not checked after texture and pixel copy.
+//
+void spoutGL::SetStateShadow(bool bShadow)
+{
+	m_bStateShadow = bShadow;
+}
+
+//---------------------------------------------------------
+// Function: GetStateShadow
+//   OpenGL state queries avoided
+bool spoutGL::GetStateShadow()
+{
+	return m_bStateShadow;
+}
+
+//---------------------------------------------------------
+// Function: SetHostViewport
+//   Host viewport used instead of a query if the state is shadowed.
+//   Zero width or height removes it.
+void spoutGL::SetHostViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	m_HostViewport[0] = x;
+	m_HostViewport[1] = y;
+	m_HostViewport[2] = (GLint)width;
+	m_HostViewport[3] = (GLint)height;
+}
+
+//---------------------------------------------------------
+// Function: GetHostViewport
+//   Host viewport set by SetHostViewport.
+//   Returns false if not set.
+bool spoutGL::GetHostViewport(GLint viewport[4])
+{
+	if (m_HostViewport[2] <= 0 || m_HostViewport[3] <= 0)
+		return false;
+	viewport[0] = m_HostViewport[0];
+	viewport[1] = m_HostViewport[1];
+	viewport[2] = m_HostViewport[2];
+	viewport[3] = m_HostViewport[3];
+	return true;
+}
+
+// Copy the views of the linked array texture by glCopyImageSubData.
+// All views are copied between array textures. For a GL_TEXTURE_2D
+// source or destination, only the first view is copied.
+// The textures must be the same format class and the views are not inverted.
+bool spoutGL::CopyTextureLayers(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
+	unsigned int width, unsigned int height)
+{
+	if (SourceID == 0 || DestID == 0 || !glCopyImageSubData)
+		return false;
+
+	GLsizei layers = 1;
+	if (SourceTarget == GL_TEXTURE_2D_ARRAY && DestTarget == GL_TEXTURE_2D_ARRAY)
+		layers = (GLsizei)m_ArraySize;
+
+	glCopyImageSubData(SourceID, SourceTarget, 0, 0, 0, 0,
+		DestID, DestTarget, 0, 0, 0, 0, (GLsizei)width, (GLsizei)height, layers);
 
 	return true;
+}
+
+// Copy by glCopyImageSubData without framebuffers.
+// glCopyImageSubData requires formats of the same size and class.
+// Rather than a table of compatible formats, the first copy for
+// a pair of formats is tested for error and the result recorded.
+// Returns false if the copy should be done by fbo blit.
+bool spoutGL::CopyTextureImage(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
+	unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height)
+{
+	if (SourceID == 0 || DestID == 0)
+		return false;
+
+	const GLint srcformat = GetTextureFormat(SourceID, SourceTarget);
+	const GLint dstformat = GetTextureFormat(DestID, DestTarget);
+	if (srcformat == 0 || dstformat == 0)
+		return false;
+
+	// Method recorded for the formats
+	for (int i = 0; i < m_nCopyFormats; i++) {
+		if (m_CopyFormat[i].source == srcformat && m_CopyFormat[i].dest == dstformat) {
+			if (m_CopyFormat[i].method != SPOUT_COPY_IMAGE)
+				return false;
+			glCopyImageSubData(SourceID, SourceTarget, 0, (GLint)xoffset, (GLint)yoffset, 0,
+				DestID, DestTarget, 0, 0, 0, 0, (GLsizei)width, (GLsizei)height, 1);
+			return true;
+		}
+	}
+
+	// Test the copy for the new pair of formats
+	while (glGetError() != GL_NO_ERROR) {} // Clear previous errors
+	glCopyImageSubData(SourceID, SourceTarget, 0, (GLint)xoffset, (GLint)yoffset, 0,
+		DestID, DestTarget, 0, 0, 0, 0, (GLsizei)width, (GLsizei)height, 1);
+	const int method = (glGetError() == GL_NO_ERROR) ? SPOUT_COPY_IMAGE : SPOUT_COPY_BLIT;
 
-} // end CopyTexture
+	// Record the method, replacing the oldest if the table is full
+	if (m_nCopyFormats == SPOUT_COPY_FORMATS) {
+		memmove(&m_CopyFormat[0], &m_CopyFormat[1], sizeof(SpoutCopyFormat)*(SPOUT_COPY_FORMATS-1));
+		m_nCopyFormats--;
+	}
+	m_CopyFormat[m_nCopyFormats].source = srcformat;
+	m_CopyFormat[m_nCopyFormats].dest = dstformat;
+	m_CopyFormat[m_nCopyFormats].method = method;
+	m_nCopyFormats++;
+
+	SpoutLogNotice("spoutGL::CopyTextureImage - %s copy for formats 0x%X to 0x%X",
+		(method == SPOUT_COPY_IMAGE) ? "image" : "blit", srcformat, dstformat);
+
+	return (method == SPOUT_COPY_IMAGE);
+}
 
 //---------------------------------------------------------
 // Function: RemovePadding
@@ -4044,10 +8488,13 @@ bool spoutGL::WriteTexture(ID3D11Texture2D** texture)
 		spoutdx.GetDX11Context()->Flush();
 		// Increment the sender frame counter
 		frame.SetNewFrame();
+		// Copy for CPU read back (SetSendReadback)
+		WriteSendReadback();
 		// Release mutex and allow access to the texture
 		frame.AllowTextureAccess(m_pSharedTexture);
 		bRet = true;
 	}
+	PollSendReadback();
 
 	return bRet;
 }
@@ -4109,9 +8556,13 @@ bool spoutGL::WriteTextureReadback(ID3D11Texture2D** texture,
 
 		// Increment the sender frame counter
 		frame.SetNewFrame();
+		// Copy for CPU read back (SetSendReadback)
+		// The OpenGL texture read back above remains on the GPU
+		WriteSendReadback();
 		// Release mutex and allow access to the texture
 		frame.AllowTextureAccess(m_pSharedTexture);
 	}
+	PollSendReadback();
 
 	return bRet;
 }
@@ -40,6 +40,7 @@
 #include "SpoutDirectX.h" // for DX11 shared textures
 #include "SpoutFrameCount.h" // for mutex lock and new frame signal
 #include "SpoutCopy.h" // for pixel copy
+#include "SpoutShaders.h" // for compute shader pixel conversion
 
 #include <direct.h> // for _getcwd
 #include <TlHelp32.h> // for PROCESSENTRY32
@@ -51,6 +52,90 @@
 // Used throughout
 using namespace spoututils;
 
+// Maximum number of senders in the interop group
+#define SPOUT_INTEROP_MAX 64
+
+// Interop object of a shared texture linked by memory object (SetMemoryObject)
+#define SPOUT_INTEROP_MEMORY ((HANDLE)(LONG_PTR)-1)
+
+// Sender texture linked to OpenGL by AddInteropSender
+struct SpoutInteropSender {
+	char name[256];
+	HANDLE dxShareHandle; // Sender share handle
+	ID3D11Texture2D* pSharedTexture; // Opened sender texture
+	GLuint glTexture; // Linked OpenGL texture
+	HANDLE hInteropObject; // Interop object registered with the class interop device
+	unsigned int width;
+	unsigned int height;
+	DWORD format;
+	spoutFrameCount* pFrame; // Access mutex and frame count for the sender
+	bool bLocked; // Locked by LockInteropSenders
+	bool bNewFrame; // New frame when locked
+};
+
+// Number of framebuffers retained with a texture attached
+#define SPOUT_FBO_CACHE 8
+
+// Headroom for pixel buffers re-allocated for a size change (1/4)
+// so that a continuously resizing sender does not re-allocate for every frame
+#define SPOUT_RESIZE_HEADROOM 4
+
+// Framebuffer with a texture attached to colour attachment 0
+struct SpoutTextureFbo {
+	GLuint fbo;
+	GLuint texture;
+	GLuint target;
+	GLint format; // Texture internal format
+	unsigned int used; // Last use for replacement
+};
+
+// Texture copy method selected for a pair of internal formats
+#define SPOUT_COPY_BLIT  0 // glBlitFramebuffer
+#define SPOUT_COPY_IMAGE 1 // glCopyImageSubData
+#define SPOUT_COPY_FORMATS 8
+struct SpoutCopyFormat {
+	GLint source;
+	GLint dest;
+	int method;
+};
+
+// GL timestamp query pairs in flight before their results are read
+#define SPOUT_GL_QUERIES 8
+
+// Frames timed for each method by share mode calibration
+#define SPOUT_CALIBRATION_FRAMES 10
+
+// Class textures retained for re-use by size and format
+#define SPOUT_TEXTURE_POOL 4
+struct SpoutPoolTexture {
+	GLuint id;
+	GLenum format; // Format requested
+	unsigned int width;
+	unsigned int height;
+	HGLRC context; // Context the texture was created in
+	unsigned int used; // Last use for replacement
+};
+
+// Staging textures for CPU read back of the frames sent (SetSendReadback)
+#define SPOUT_READBACK_STAGING 3
+
+//
+// Frame sent and read back to CPU memory
+//
+struct SpoutReadbackFrame {
+	const unsigned char* data; // First pixel of the top line
+	unsigned int width; // Width in pixels
+	unsigned int height; // Height in lines
+	unsigned int pitch; // Bytes per line
+	DWORD dwFormat; // DXGI format of the sender texture
+	LONG64 frame; // Sender frame number
+};
+
+// Sender read back callback, called on the sending thread
+// one or two frames after the frame was sent.
+// The pixels remain valid until the callback returns.
+typedef void (*SpoutReadbackCallback)(const SpoutReadbackFrame &frame, void* pUserData);
+
 
 class SPOUT_DLLEXP spoutGL {
 
@@ -85,6 +170,33 @@ class SPOUT_DLLEXP spoutGL {
 	void SetCPUshare(bool bCPU = true);
 	// OpenGL texture share compatibility
 	bool IsGLDXready();
+	// Receiving by DirectX without OpenGL (see OpenHeadless)
+	bool IsHeadless();
+	// Share DirectX and GL/DX interop devices with other instances on the same OpenGL context
+	void SetSharedInterop(bool bShared = true);
+	// Shared interop devices enabled
+	bool GetSharedInterop();
+	// Link the shared texture by memory object instead of NV_DX_interop
+	void SetMemoryObject(bool bMemory = true);
+	// Memory object option
+	bool GetMemoryObject();
+	// Shared texture linked by memory object
+	bool IsMemoryObject();
+
+	//
+	// Resources
+	//
+
+	// Release retained resources after a time without frames
+	//   msec - 0 to disable (default 60000)
+	void SetIdleTrim(DWORD dwMsec);
+	// Time without frames before retained resources are released
+	DWORD GetIdleTrim();
+	// Release retained resources and trim the DirectX device.
+	// For example when the application is suspended.
+	void TrimResources();
+	// Memory held by this sender or receiver by category and heap
+	bool GetMemoryUsage(SpoutMemoryUsage& usage);
 
 	//
 	// User settings recorded in the registry by "SpoutSettings"
@@ -98,6 +210,39 @@ class SPOUT_DLLEXP spoutGL {
 	int GetBuffers();
 	// Set application number of pixel buffers
 	void SetBuffers(int nBuffers);
+	// Get number of staging textures for CPU receive
+	int GetStagingBuffers();
+	// Set number of staging textures for CPU receive (1-4)
+	void SetStagingBuffers(int nBuffers);
+	// Get persistent mapped pixel buffer mode
+	bool GetPersistentBufferMode();
+	// Set persistent mapped pixel buffers for OpenGL pixel read and upload
+	void SetPersistentBufferMode(bool bActive = true);
+	// Persistent mapped pixel buffers supported (OpenGL 4.4 or ARB_buffer_storage)
+	bool IsPersistentBufferAvailable();
+	// Get pinned memory pixel read mode
+	bool GetPinnedMemoryMode();
+	// Set pixel read directly to the application buffer (AMD_pinned_memory)
+	void SetPinnedMemoryMode(bool bActive = true);
+	// Pinned memory supported (AMD_pinned_memory)
+	bool IsPinnedMemoryAvailable();
+	// Get compute shader pixel conversion
+	bool GetComputeConversion();
+	// Set compute shader pixel conversion for pixel send and receive
+	void SetComputeConversion(bool bCompute = true);
+	// Get compute shader RGB packing for pixel receive
+	bool GetComputeRGB();
+	// Set compute shader RGB packing for pixel receive (default false)
+	void SetComputeRGB(bool bCompute = true);
+	// Get resample mode for receiving pixels of different size
+	int GetResampleMode();
+	// Set resample mode for receiving pixels of different size
+	//   0 nearest, 1 bilinear, 2 box
+	void SetResampleMode(int mode);
+	// Get tone mapping of floating point senders
+	SpoutToneMap GetToneMapping();
+	// Set tone mapping of floating point senders to 8 bit textures and pixels
+	void SetToneMapping(SpoutToneMap mode = SPOUT_TONEMAP_ACES, float exposure = 1.0f);
 	// Get user Maximum senders allowed
 	int GetMaxSenders();
 	// Set user Maximum senders allowed
@@ -120,10 +265,10 @@ class SPOUT_DLLEXP spoutGL {
 	// Set user CPU mode
 	bool SetCPUmode(bool bCPU);
 	// Get user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	int GetShareMode();
 	// Set user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	void SetShareMode(int mode);
 
 	//
@@ -146,11 +291,46 @@ class SPOUT_DLLEXP spoutGL {
 	// Copy OpenGL texture with optional invert
 	bool CopyTexture(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
 		unsigned int width, unsigned int height, bool bInvert = false, GLuint HostFBO = 0);
+	// Copy a region of an OpenGL texture with optional invert
+	bool CopyTextureRegion(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
+		unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+		bool bInvert = false, GLuint HostFBO = 0);
+	// Retain framebuffers for application textures used for copy.
+	//   Framebuffers are always retained for textures created by the class.
+	//   An application texture that has been used must then be removed with
+	//   RemoveFramebufferCache before it is deleted.
+	void SetFramebufferCache(bool bCache = true);
+	// Retain framebuffers for application textures
+	bool GetFramebufferCache();
+	// Release the retained framebuffer of a texture (zero for all)
+	//   Requires the OpenGL context of the texture
+	void RemoveFramebufferCache(GLuint TextureID = 0);
+	// Delete the class textures retained for re-use
+	//   Requires the OpenGL context of the textures
+	void ReleaseTexturePool();
+	// Avoid OpenGL state and error queries for each frame.
+	//   The host passes the framebuffer binding (HostFBO) and,
+	//   if the viewport is used, sets it with SetHostViewport.
+	void SetStateShadow(bool bShadow = true);
+	// OpenGL state queries avoided
+	bool GetStateShadow();
+	// Host viewport used instead of a query if the state is shadowed
+	void SetHostViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	// Host viewport set by SetHostViewport. Returns false if not set.
+	bool GetHostViewport(GLint viewport[4]);
 	// Correct for image stride
 	void RemovePadding(const unsigned char *source, unsigned char *dest,
 		unsigned int width, unsigned int height, unsigned int stride, GLenum glFormat = GL_RGBA);
 	// OpenGL error reprting
 	bool GLerror();
+	// Asynchronous OpenGL error reporting (KHR_debug)
+	bool SetDebugOutput(bool bDebug = true);
+	// Asynchronous OpenGL error reporting enabled
+	bool GetDebugOutput();
+	// Record the GPU time of texture copies and shaders in the timer
+	void EnableGPUTiming(bool bEnable = true);
+	// GPU timing status
+	bool IsGPUTiming();
 
 	// DX11 texture read
 	//  o Copy from the shared DX11 texture to a DX11 texture
@@ -170,6 +350,8 @@ class SPOUT_DLLEXP spoutGL {
 	//     o Compatibility test for use or GL/DX interop
 	//     o Optionally re-test compatibility even if already initialized
 	bool OpenSpout(bool bRetest = false);
+	// Initialize DirectX only for CPU receive without an OpenGL context
+	bool OpenHeadless();
 	// Initialize DirectX
 	bool OpenDirectX();
 	// Close DirectX and free resources
@@ -201,7 +383,10 @@ class SPOUT_DLLEXP spoutGL {
 	// Class initialization status
 	bool IsSpoutInitialized();
 	// Perform tests for GL/DX interop availability and compatibility
-	bool GLDXready();
+	// The result recorded for the same graphics is used unless bCache is false
+	bool GLDXready(bool bCache = true);
+	// Select texture or CPU share by measured performance at the sender size
+	bool CalibrateShareMode(unsigned int width, unsigned int height);
 	// Set host path to sender shared memory
 	bool SetHostPath(const char *sendername);
 	// Set sender PartnerID field with CPU sharing method and GL/DX compatibility
@@ -230,6 +415,7 @@ class SPOUT_DLLEXP spoutGL {
 	bool IsCOPYavailable(); // copy extensions available
 	bool IsPBOavailable();  // pbo extensions supported
 	bool IsCONTEXTavailable(); // Context extension supported
+	bool IsMEMORYavailable(); // Memory object and semaphore extensions supported
 
 	//
 	// Legacy OpenGL functions
@@ -246,11 +432,38 @@ class SPOUT_DLLEXP spoutGL {
 	//
 
 	// Link a shared DirectX texture to an OpenGL texture
-	HANDLE LinkGLDXtextures(void* pDXdevice, void* pSharedTexture, GLuint glTextureID);
+	//   glTarget - GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY for an array texture
+	HANDLE LinkGLDXtextures(void* pDXdevice, void* pSharedTexture, GLuint glTextureID, GLenum glTarget = GL_TEXTURE_2D);
 	// Return a handle to the the DX/GL interop device
 	HANDLE GetInteropDevice();
 	// Return a handle to the the DX/GL interop ojject
 	HANDLE GetInteropObject();
+
+	//
+	// Interop group
+	//
+	// Sender textures linked to OpenGL with the class interop device
+	// and locked together with one call for each frame
+	//
+
+	// Add a sender to the group. Returns the index or -1.
+	int AddInteropSender(const char* sendername);
+	// Remove a sender from the group
+	void RemoveInteropSender(int index);
+	// Remove all senders from the group
+	void RemoveInteropSenders();
+	// Check the group senders and lock their textures for OpenGL
+	int LockInteropSenders();
+	// Unlock the textures locked by LockInteropSenders
+	bool UnlockInteropSenders();
+	// OpenGL texture of a group sender, valid between lock and unlock
+	GLuint GetInteropSenderTexture(int index);
+	// Width of a group sender texture
+	unsigned int GetInteropSenderWidth(int index);
+	// Height of a group sender texture
+	unsigned int GetInteropSenderHeight(int index);
+	// Group sender texture has been locked with a new frame
+	bool IsInteropSenderNew(int index);
 	// Pointer to the shared DirectX texture
 	ID3D11Texture2D* GetDXsharedTexture();
 	// Create OpenGL texture
@@ -274,12 +487,46 @@ class SPOUT_DLLEXP spoutGL {
 	bool WriteMemoryBuffer(const char *name, const char* data, int length);
 	// Read data from shared memory
 	int ReadMemoryBuffer(const char* name, char* data, int maxlength);
+	// Lock shared memory for read without copy
+	int LockMemoryBuffer(const char* name, const char** ppData);
+	// Unlock shared memory locked by LockMemoryBuffer
+	void UnlockMemoryBuffer();
 	// Create a shared memory buffer
 	bool CreateMemoryBuffer(const char *name, int length);
 	// Delete a shared memory buffer
 	bool DeleteMemoryBuffer();
 	// Get the number of bytes available for data transfer
 	int GetMemoryBufferSize(const char *name);
+	// Create a named data channel with a retained shared memory map
+	bool CreateDataChannel(const char* name, int length);
+	// Write data to a named data channel
+	bool WriteDataChannel(const char* name, const char* data, int length);
+	// Read data from a named data channel
+	int  ReadDataChannel(const char* name, char* data, int maxlength);
+	// Close a named data channel
+	void CloseDataChannel(const char* name);
+	// Close all data channels
+	void CloseDataChannels();
+	// Large pages for memory share and memory buffers
+	void SetMemoryLargePages(bool bLarge = true);
+	// Large pages enabled
+	bool GetMemoryLargePages();
+	// Lossless compression of memory share frames
+	void SetMemoryCompression(bool bCompress = true);
+	// Memory share compression enabled
+	bool GetMemoryCompression();
+	// Last memory share frame written compressed
+	bool IsMemoryCompressed();
+	// Send frames through the memory ring instead of a shared texture
+	void SetMemoryRingSend(bool bRing = true);
+	// Memory ring send enabled
+	bool GetMemoryRingSend();
+	// Create a frame data buffer
+	bool CreateFrameData(int maxlength);
+	// Write data sent with the next frame
+	bool WriteFrameData(const char* data, int length);
+	// Read the data sent with a frame
+	int ReadFrameData(char* data, int maxlength, long framenumber = 0);
 
 	//
 	// For external access
@@ -293,16 +540,23 @@ class SPOUT_DLLEXP spoutGL {
 	spoutSenderNames sendernames;
 	// Frame counting management
 	spoutFrameCount frame;
+	// Scoped timing of texture and pixel transfer stages
+	spoutTimer timer;
 
 protected :
 	
 	// For 2.006(receive only) / WriteMemoryBuffer / ReadMemoryBuffer
 	SpoutSharedMemory memoryshare;
 
+	// Named data channels
+	SpoutDataChannel m_DataChannels[SPOUT_DATA_CHANNELS];
+	int FindDataChannel(const char* name);
+
 	// GL/DX functions
 	bool CreateInterop(unsigned int width, unsigned int height, DWORD dwFormat, bool bReceive);
 	HRESULT LockInteropObject(HANDLE hDevice, HANDLE *hObject);
 	HRESULT UnlockInteropObject(HANDLE hDevice, HANDLE *hObject);
+	bool ReleaseInteropObject();
 	void CleanupGL(); // Free OpenGL resources
 
 	// OpenGL texture create
@@ -311,17 +565,109 @@ protected :
 	// OpenGL texture copy
 	bool WriteGLDXtexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = true, GLuint HostFBO = 0);
 	bool ReadGLDXtexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = false, GLuint HostFBO = 0);
+	bool ReadGLDXtexture(GLuint TextureID, GLuint TextureTarget,
+		unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+		bool bInvert, GLuint HostFBO);
 	bool SetSharedTextureData(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert, GLuint HostFBO);
 	
 	// OpenGL pixel copy
-	bool WriteGLDXpixels(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFBO = 0);
+	bool WriteGLDXpixels(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFBO = 0, unsigned int pitch = 0);
 	bool ReadGLDXpixels(unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFBO = 0);
+	bool ReadGLDXyuv(unsigned char* pixels, unsigned int width, unsigned int height,
+		SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert, GLuint HostFBO = 0);
 	
 	// PBOs for OpenGL pixel copy
 	GLuint m_pbo[4];
+	GLsizeiptr m_pboSize[4]; // Size of the data in each PBO
+	GLsizeiptr m_pboAlloc; // Size of the data store allocated for all PBOs
+	GLsizeiptr GetPboAllocation(GLsizeiptr datasize);
 	int PboIndex;
 	int NextPboIndex;
 	int m_nBuffers;
+
+	// Persistent mapped PBOs with a fence for each
+	bool UnloadPersistentPixels(GLuint TextureID, GLuint TextureTarget,
+		unsigned int width, unsigned int height, unsigned int rowpitch,
+		unsigned char* data, GLenum glFormat, bool bInvert, GLuint HostFBO);
+	void ReleasePersistentBuffers();
+
+	// Unpack PBOs for OpenGL pixel upload
+	bool LoadTexturePixels(GLuint TextureID, unsigned int width, unsigned int height,
+		const unsigned char* data, GLenum glFormat);
+	void ReleaseUnpackBuffers();
+	GLuint m_unpackPbo[4];
+	void* m_pUnpackMap[4]; // Retained mapped pointers for persistent mode
+	GLsync m_unpackSync[4]; // Fence after the upload from each buffer (persistent mode)
+	GLsizeiptr m_unpackSize; // Size of each buffer
+	int m_nUnpack; // Number of buffers created
+	int m_unpackIndex;
+	bool m_bUnpackPersistent; // Buffers are persistent mapped
+	bool m_bPersistentPbo; // Persistent mode set by SetPersistentBufferMode
+	GLuint m_persistentPbo[4];
+	void* m_pPersistentMap[4]; // Retained mapped pointers
+	GLsync m_persistentSync[4]; // Fence after glReadPixels to each buffer
+	GLsizeiptr m_persistentSize; // Size of each buffer
+	int m_nPersistent; // Number of buffers created
+	int m_persistentIndex;
+
+	// Pixel read to application memory pinned as a buffer store (AMD_pinned_memory)
+	bool UnloadPinnedPixels(GLuint TextureID, GLuint TextureTarget,
+		unsigned int width, unsigned int height, unsigned int rowpitch,
+		unsigned char* data, GLenum glFormat, GLuint HostFBO);
+	void ReleasePinnedBuffer();
+	bool m_bPinnedMemory; // Pinned mode set by SetPinnedMemoryMode
+	GLuint m_pinnedPbo; // Buffer with the application memory as store
+	unsigned char* m_pPinnedData; // Application buffer of the last read
+	GLsizeiptr m_pinnedSize; // Size of the application buffer
+	bool m_bPinnedFailed; // Application buffer could not be pinned
+
+	// Compute shader pixel conversion
+	bool UnloadComputePixels(GLuint TextureID, unsigned int width, unsigned int height,
+		unsigned char* data, GLenum glFormat, bool bInvert);
+	bool LoadComputePixels(const unsigned char* data, GLuint TextureID,
+		unsigned int width, unsigned int height, GLenum glFormat, bool bInvert);
+	bool UnloadComputeYUV(GLuint TextureID, unsigned int width, unsigned int height,
+		unsigned char* data, SpoutYUVLayout layout, SpoutYUVMatrix matrix,
+		bool bFullRange, bool bInvert);
+	spoutShaders* m_pShaders; // Created when first used
+	GLuint m_ssbo; // Buffer for pixel upload
+	GLsizeiptr m_ssboSize; // Size of the buffer data store
+	bool m_bComputeConversion;
+	bool m_bContentHash; // Publish a content hash with each frame
+	void WriteContentHash();
+	bool m_bReceiveAnalysis; // Histograms and waveform of each frame received
+	void ReadAnalysis();
+
+	// CPU read back of the frames sent (SetSendReadback)
+	// Each frame is copied to the next staging texture of a ring
+	// and mapped without waiting when the copy is complete.
+	bool m_bSendReadback;
+	SpoutReadbackCallback m_ReadbackCallback;
+	void* m_pReadbackUserData;
+	ID3D11Texture2D* m_pReadbackStaging[SPOUT_READBACK_STAGING];
+	LONG64 m_ReadbackFrame[SPOUT_READBACK_STAGING]; // Sender frame copied
+	bool m_bReadbackPending[SPOUT_READBACK_STAGING]; // Copy not yet complete
+	int m_ReadbackIndex; // Next staging texture to copy to
+	int m_ReadbackLatest; // Latest completed, -1 if none
+	LONG64 m_ReadbackLastRead; // Frame returned by the last ReadSendReadback
+	void WriteSendReadback();
+	void PollSendReadback();
+	void ReleaseSendReadback();
+	bool m_bComputeRGB; // RGB pixels packed on the GPU
+
+	// Resample for receiving pixels of different size
+	bool ResampleComputePixels(unsigned char* pixels, unsigned int width, unsigned int height,
+		GLenum glFormat, bool bInvert, GLuint HostFBO);
+	GLuint m_resampleTexture; // Texture of the receiving pixel size
+	unsigned int m_resampleWidth;
+	unsigned int m_resampleHeight;
+	int m_ResampleMode;
+
+	// Tone mapping of floating point senders to the local 8 bit texture
+	bool IsToneMapped();
+	bool ToneMapSharedTexture(bool bInvert);
+	SpoutToneMap m_ToneMap;
+	float m_ToneMapExposure;
 	
 	// OpenGL <-> DX11
 	// WriteDX11texture - public
@@ -329,21 +675,47 @@ protected :
 	bool ReadTextureData(GLuint SourceID, GLuint SourceTarget, unsigned int width, unsigned int height, unsigned int pitch, unsigned char* dest, GLenum GLformat, bool bInvert, GLuint HostFBO);
 	
 	// Pixels <-> DX11
-	bool WriteDX11pixels(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false);
-	bool ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false);
-	bool WritePixelData(const unsigned char* pixels, ID3D11Texture2D* pStagingTexture, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert);
-	bool ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert);
+	bool WriteDX11pixels(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, unsigned int pitch = 0);
+	bool ReadDX11pixels(unsigned char * pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, unsigned int pitch = 0);
+	bool WritePixelData(const unsigned char* pixels, ID3D11Texture2D* pStagingTexture, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, UINT mapFlags = 0, unsigned int pitch = 0);
+	bool ReadPixelData(ID3D11Texture2D* pStagingTexture, unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat, bool bInvert, unsigned int pitch = 0);
+	bool ReadDirtyPixels(ID3D11Texture2D* pStagingTexture, unsigned char* pixels, const RECT* pRects, unsigned int nRects, bool bInvert);
+	void CopyDirtyRects(ID3D11Texture2D* pDest, ID3D11Texture2D* pSource, unsigned int nFrames);
 
 	// Staging textures for DX11 CPU copy
-	ID3D11Texture2D* m_pStaging[2];
+	// A ring of up to 4 is used for receive, similar to the PBO ring
+	ID3D11Texture2D* m_pStaging[4];
 	int m_Index;
 	int m_NextIndex;
+	int m_WriteIndex; // Next staging texture for WriteDX11pixels
+	unsigned char* m_pDirtyPixels; // Pixel buffer updated by the last ReadDX11pixels
+	bool m_bDirtyInvert;
+	int m_nStaging; // Number of staging textures used for CPU receive
+	ID3D11Texture2D* m_pMappedStaging; // Staging texture mapped by ReceiveImageView
 	bool CheckStagingTextures(unsigned int width, unsigned int height, int nTextures);
+	void ReleaseStagingTextures();
 
 	// 2.006 shared memory
 	bool ReadMemoryTexture(const char* sendername, GLuint TexID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = false, GLuint HostFBO = 0);
 	bool ReadMemoryPixels(const char* sendername, unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false);
-	bool WriteMemoryPixels(const char *sendername, const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false);
+	bool WriteMemoryPixels(const char *sendername, const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, unsigned int pitch = 0);
+	bool WriteMemoryTexture(const char* sendername, GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = false, GLuint HostFBO = 0);
+
+	// Memory share ring without a mutex
+	SpoutSharedMemory m_MemoryRing;
+	LONG64 m_MemoryRingFrame; // Frame last read or written
+	std::vector<unsigned char> m_MemoryRingPixels; // Decompressed frame or texture pixels to write
+	bool m_bMemoryCompress; // Compression enabled by SetMemoryCompression
+	bool m_bMemoryCompressed; // Last frame written compressed
+	bool m_bMemoryRingSend; // Sender frames written to the memory ring (SetMemoryRingSend)
+	double m_MemoryRawTime; // Average msec to write a frame as pixels
+	double m_MemoryCodecTime; // Average msec to write a frame compressed
+	unsigned int m_MemoryCodecFrames; // Frames since the other method was timed
+	bool CreateMemoryRing(const char* sendername, unsigned int width, unsigned int height);
+	bool OpenMemoryRing(const char* sendername, unsigned int width, unsigned int height);
+	void CloseMemoryRing(bool bWriter = false);
+	const unsigned char* BeginMemoryRingRead(unsigned int width, unsigned int height, LONG64 &ringframe);
+	bool EndMemoryRingRead(LONG64 ringframe);
 
 	// Utility
 	bool OpenDeviceKey(const char* key, int maxsize, char* description, char* version);
@@ -362,13 +734,58 @@ protected :
 	char m_SenderNameSetup[256];
 	unsigned int m_Width;
 	unsigned int m_Height;
+	unsigned int m_ArraySize; // Views of an array texture sender (1 for a single texture)
 
 	// Utility
 	GLuint m_fbo; // Fbo used for OpenGL functions
+	GLuint m_SharedFbo; // Fbo for rendering to the shared texture (Spout::BeginFrame)
+	SpoutTextureFbo m_TextureFbo[SPOUT_FBO_CACHE]; // Retained framebuffers for texture copy
+	unsigned int m_TextureFboUsed; // Use count for replacement
+	bool m_bFramebufferCache; // Retain framebuffers for application textures
+	bool m_bStateShadow; // No OpenGL state queries for each frame
+	GLint m_HostViewport[4]; // Host viewport for the shadow state
+	bool m_bDebugOutput; // OpenGL errors reported by debug output
+	// GPU timing with GL_TIMESTAMP queries
+	void BeginGLTime(const char* name);
+	void EndGLTime();
+	void ReadGLTimes();
+	void ReleaseGLTiming();
+	bool m_bGPUTiming; // Set by EnableGPUTiming
+	GLuint m_glQuery[SPOUT_GL_QUERIES][2]; // Begin and end timestamps of each scope
+	const char* m_glQueryName[SPOUT_GL_QUERIES];
+	int m_glQueryWrite; // Next scope to begin
+	int m_glQueryRead; // Oldest scope in flight
+	int m_glQueryPending; // Scopes in flight
+	int m_glScopeDepth; // Nested scopes are timed by the outer scope
+	bool m_bGLScope; // Queries of the outer scope have begun
+	// Framebuffer with the texture attached, or zero to attach to m_fbo
+	GLuint GetTextureFbo(GLuint TextureID, GLuint TextureTarget);
+	// Internal format of a texture, from the retained framebuffers if possible
+	GLint GetTextureFormat(GLuint TextureID, GLuint TextureTarget);
+	// Copy by glCopyImageSubData if the method for the formats allows it
+	bool CopyTextureImage(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
+		unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height);
+	// Copy the views of the linked array texture by glCopyImageSubData
+	bool CopyTextureLayers(GLuint SourceID, GLuint SourceTarget, GLuint DestID, GLuint DestTarget,
+		unsigned int width, unsigned int height);
+	SpoutCopyFormat m_CopyFormat[SPOUT_COPY_FORMATS]; // Copy method for format pairs
+	int m_nCopyFormats;
 	GLuint m_TexID; // Class texture used for invert copy
 	unsigned int m_TexWidth;
 	unsigned int m_TexHeight;
 	DWORD m_TexFormat;
+	SpoutPoolTexture m_TexPool[SPOUT_TEXTURE_POOL]; // Textures for CheckOpenGLTexture
+	unsigned int m_TexPoolUsed; // Use count for replacement
+
+	// Release of retained resources
+	DWORD m_dwIdleTrim; // Time without frames before release (msec)
+	DWORD m_dwLastFrame; // Time of the last frame received
+	bool m_bTrimmed; // Released since the last frame
+	DWORD m_dwMemoryTime; // Time of the last telemetry memory update
+	void CheckTelemetryMemory();
+	void CheckResources(bool bFrame);
+	GLuint GetPoolTexture(GLenum GLformat, unsigned int width, unsigned int height);
+	bool IsPoolTexture(GLuint texID);
 
 	// Shared texture
 	GLuint m_glTexture; // OpenGL shared texture
@@ -382,6 +799,40 @@ protected :
 	HANDLE m_hInteropObject; // Handle to the DX/GL interop object (the shared texture)
 	bool m_bInteropFailed = false; // Interop failure flag to avoid repeats
 
+	// Process interop context shared with other instances
+	bool m_bSharedInterop; // Shared interop enabled by SetSharedInterop
+	int m_SharedInterop; // Index of the process interop context used or -1
+	ID3D11Device* AcquireSharedInterop();
+	void ReleaseSharedInterop();
+	HANDLE OpenInteropDevice(void* pDXdevice);
+	void CloseInteropDevice();
+	bool IsSharedInteropDevice(HANDLE hInteropDevice);
+
+	// Shared texture linked by memory object (EXT_memory_object_win32)
+	// and synchronised by a DirectX fence imported as a semaphore (EXT_semaphore_win32)
+	bool m_bMemoryObject; // Memory object enabled by SetMemoryObject
+	GLuint m_glMemoryObject; // Memory object of the shared texture
+	GLuint m_glSemaphore; // Semaphore imported from the interop fence
+	ID3D11Fence* m_pInteropFence; // Shared fence on the class device
+	ID3D11DeviceContext4* m_pInteropFenceContext;
+	HANDLE m_hInteropFence; // NT handle of the fence
+	UINT64 m_InteropFenceValue; // Last value signalled by DirectX or OpenGL
+	bool LinkMemoryObject(ID3D11Texture2D* pSharedTexture, GLuint glTexture, GLenum glTarget);
+	bool CreateInteropFence();
+	void ReleaseMemoryObject();
+	HRESULT LockMemoryObject();
+	HRESULT UnlockMemoryObject();
+
+	// Interop group senders, pointers to avoid C4251 warnings
+	SpoutInteropSender* m_pInteropSenders[SPOUT_INTEROP_MAX];
+	HANDLE m_hInteropLocked[SPOUT_INTEROP_MAX]; // Objects locked by LockInteropSenders
+	int m_nInteropLocked; // Number of locked objects
+	LONG m_InteropGeneration; // Sender change count of the last group check
+	DWORD m_dwInteropCheck; // Time of the last group check
+	bool CheckInteropSender(SpoutInteropSender* pSender);
+	void ReleaseInteropSender(SpoutInteropSender* pSender);
+	void ReleaseInteropSenders();
+
 	// General
 	HWND m_hWnd; // OpenGL window
 	int m_SpoutVersion; // Spout version
@@ -391,6 +842,16 @@ protected :
 	HWND m_hwndButton;
 	HGLRC m_hRc;
 
+	// Sender change count and time of the last check for a sender
+	bool m_bSenderFound;
+	LONG m_SenderGeneration;
+	DWORD m_dwSenderCheck;
+	LONG m_SharedGeneration; // Sender change count of the last shared texture check
+	LONG m_SenderInfoChange; // Connected sender information change count of the last check
+	LONG m_SenderInfoGeneration; // Sender change count of the last connected sender check
+	DWORD m_dwSenderInfoCheck;
+	bool m_bPreconnect; // Open sender textures on a thread (SetPreconnect)
+
 	// Status flags
 	bool m_bConnected;
 	bool m_bUpdated;
@@ -398,14 +859,18 @@ protected :
 	bool m_bMirror;  // Mirror image (used for SpoutCam)
 	bool m_bSwapRB;  // RGB <> BGR (used for SpoutCam)
 	bool m_bGLDXdone; // Compatibility test done
+	bool GetGLDXkey(char* key, int maxchars); // Graphics identity for the recorded test
+	bool CheckGLextensions(); // Load extensions when first needed
 
 	// Sharing modes
 	bool m_bAuto;         // Auto share mode - user set
 	bool m_bCPU;          // Global CPU mode - user set
+	bool m_bCalibrate;    // Share mode by measured performance - user set
 	bool m_bUseGLDX;      // Hardware GL/DX interop compatibility
 	bool m_bTextureShare; // Using texture sharing methods
 	bool m_bCPUshare;     // Using CPU sharing methods
 	bool m_bMemoryShare;  // Using 2.006 memoryshare methods
+	bool m_bHeadless;     // Using DirectX CPU methods without OpenGL
 	
 	// Sender sharing modes
 	bool m_bSenderCPU;    // Sender using CPU sharing methods
@@ -415,6 +880,9 @@ protected :
 	bool m_bSpoutPanelOpened;
 	bool m_bSpoutPanelActive;
 	SHELLEXECUTEINFOA m_ShExecInfo;
+	HANDLE m_hSpoutPanelWait; // Wait registered for the SpoutPanel process
+	volatile LONG m_SpoutPanelClosed; // Set by the wait when SpoutPanel closes
+	char m_SelectedSender[256]; // Sender selected without SpoutPanel
 
 	// OpenGL extensions
 	unsigned int m_caps;
@@ -426,9 +894,51 @@ protected :
 	bool m_bBGRAavailable;
 	bool m_bCOPYavailable;
 	bool m_bCONTEXTavailable;
+	bool m_bDSAavailable;
+	bool m_bMEMORYavailable;
+	bool m_bPINNEDavailable;
 	bool m_bExtensionsLoaded;
 
 
 };
 
+// Bind the OpenGL shared texture of a receiver for the life of a block.
+// The texture can be drawn directly without a copy to an application texture.
+// The interop object and sender mutex are locked until the scope closes,
+// so the scope should not be held longer than necessary.
+//
+//   receiver.ReceiveTexture(); // Connect without copy
+//   {
+//       spoutSharedTextureScope shared(receiver.spout);
+//       if (shared.IsBound()) {
+//           // Draw with GL_TEXTURE_2D shared.GetID()
+//       }
+//   }
+class spoutSharedTextureScope {
+public:
+	spoutSharedTextureScope(spoutGL& spout) : m_pSpout(&spout), m_bNewFrame(false) {
+		m_bBound = spout.BindSharedTexture();
+		// Update the frame count while the texture is locked
+		if (m_bBound)
+			m_bNewFrame = spout.frame.GetNewFrame();
+	}
+	~spoutSharedTextureScope() { if (m_bBound) m_pSpout->UnBindSharedTexture(); }
+	// The texture is bound and locked
+	bool IsBound() const { return m_bBound; }
+	// The sender has produced a new frame
+	bool IsFrameNew() const { return m_bNewFrame; }
+	// OpenGL texture name
+	GLuint GetID() const { return m_bBound ? m_pSpout->GetSharedTextureID() : 0; }
+	unsigned int GetWidth() const { return m_pSpout->m_Width; }
+	unsigned int GetHeight() const { return m_pSpout->m_Height; }
+	// Sender frame number
+	LONG64 GetFrame() const { return m_pSpout->frame.GetSenderFrame64(); }
+private:
+	spoutSharedTextureScope(const spoutSharedTextureScope&);
+	spoutSharedTextureScope& operator=(const spoutSharedTextureScope&);
+	spoutGL* m_pSpout;
+	bool m_bBound;
+	bool m_bNewFrame;
+};
+
 #endif
@@ -62,6 +62,28 @@
 //						  GL_ATTACHED_SHADERS, GL_INFO_LOG_LENGTH
 //						  Add glGetProgramInfoLog, glGetShaderInfoLog, glGetIntegeri_v
 //	Version 2.007.013
+//			14.10.26	- Add glBindBufferBase and shader storage buffer defines
+//						- Add glUniform1fv
+//						- Add glGetProgramBinary, glProgramBinary, glProgramParameteri
+//						  (optional, not tested by loadComputeShaderExtensions)
+//						- Add GL_MAX_COMPUTE_SHARED_MEMORY_SIZE define
+//						- Header sync object function declarations match the
+//						  definitions (glClientWaitSync, glDeleteSync, glFenceSync)
+//						  Add GL_CLIENT_STORAGE_BIT define
+//						- Add glCreateFramebuffers, glNamedFramebufferTexture,
+//						  glBlitNamedFramebuffer and GLEXT_SUPPORT_DSA
+//						- Add glDebugMessageCallback, glDebugMessageControl,
+//						  debug output defines and GLEXT_SUPPORT_DEBUG
+//						- Add vertex array functions for core profile drawing
+//						  and GLEXT_SUPPORT_DRAW
+//						- Add GL_TEXTURE_2D_ARRAY define
+//						- Add timer query functions, GL_TIMESTAMP define
+//						  and GLEXT_SUPPORT_TIMER
+//			15.10.26	- Add memory object and semaphore functions (EXT_memory_object_win32,
+//						  EXT_semaphore_win32) and GLEXT_SUPPORT_MEMORY
+//						- Add glWaitSync (optional, not tested by loadPBOextensions)
+//						  and GL_TIMEOUT_IGNORED define
+//						- Add GLEXT_SUPPORT_PINNED for GL_AMD_pinned_memory
 //
 
 	Copyright (c) 2014-2024, Lynn Jarvis. All rights reserved.
@@ -122,6 +144,10 @@ glGetRenderbufferParameterivEXTPROC		glGetRenderbufferParameterivEXT	= NULL;
 glIsFramebufferEXTPROC					glIsFramebufferEXT				= NULL;
 glIsRenderbufferEXTPROC					glIsRenderbufferEXT				= NULL;
 glRenderbufferStorageEXTPROC			glRenderbufferStorageEXT		= NULL;
+// Direct state access
+glCreateFramebuffersPROC				glCreateFramebuffers			= NULL;
+glNamedFramebufferTexturePROC			glNamedFramebufferTexture		= NULL;
+glBlitNamedFramebufferPROC				glBlitNamedFramebuffer			= NULL;
 #endif
 
 // FBO blit extensions
@@ -150,6 +176,7 @@ glGetTextureParameterivPROC             glGetTextureParameteriv         = NULL;
 glClientWaitSyncPROC					glClientWaitSync				= NULL;
 glDeleteSyncPROC						glDeleteSync					= NULL;
 glFenceSyncPROC							glFenceSync						= NULL;
+glWaitSyncPROC							glWaitSync						= NULL;
 
 #endif
 
@@ -183,13 +210,25 @@ glDispatchComputePROC    glDispatchCompute  = NULL;
 glDeleteProgramPROC      glDeleteProgram    = NULL;
 glDeleteShaderPROC       glDeleteShader     = NULL;
 glMemoryBarrierPROC      glMemoryBarrier    = NULL;
+glBindBufferBasePROC     glBindBufferBase   = NULL;
 glActiveTexturePROC      glActiveTexture    = NULL;
 glUniform1iPROC          glUniform1i        = NULL;
 glUniform1fPROC          glUniform1f        = NULL;
+glUniform1fvPROC         glUniform1fv       = NULL;
+glGetProgramBinaryPROC   glGetProgramBinary = NULL;
+glProgramBinaryPROC      glProgramBinary    = NULL;
+glProgramParameteriPROC  glProgramParameteri = NULL;
 glGetUniformLocationPROC glGetUniformLocation = NULL;
 glTextureStorage2DPROC   glTextureStorage2D  = NULL;
 glCreateTexturesPROC     glCreateTextures    = NULL;
 
+glGenVertexArraysPROC         glGenVertexArrays         = NULL;
+glBindVertexArrayPROC         glBindVertexArray         = NULL;
+glDeleteVertexArraysPROC      glDeleteVertexArrays      = NULL;
+glVertexAttribPointerPROC     glVertexAttribPointer     = NULL;
+glEnableVertexAttribArrayPROC glEnableVertexAttribArray = NULL;
+glGetShaderivPROC             glGetShaderiv             = NULL;
+
 glCreateMemoryObjectsEXTPROC      glCreateMemoryObjectsEXT = NULL;
 glDeleteMemoryObjectsEXTPROC      glDeleteMemoryObjectsEXT = NULL;
 glTexStorageMem2DEXTPROC          glTexStorageMem2DEXT = NULL;
@@ -205,6 +244,37 @@ glGetMemoryObjectParameterivEXTPROC glGetMemoryObjectParameterivEXT = NULL;
 //---------------------------
 PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB = NULL;
 
+//-------------
+// Debug output
+//-------------
+glDebugMessageCallbackPROC glDebugMessageCallback = NULL;
+glDebugMessageControlPROC  glDebugMessageControl  = NULL;
+
+//--------------
+// Timer queries
+//--------------
+glGenQueriesPROC          glGenQueries          = NULL;
+glDeleteQueriesPROC       glDeleteQueries       = NULL;
+glQueryCounterPROC        glQueryCounter        = NULL;
+glGetQueryObjectivPROC    glGetQueryObjectiv    = NULL;
+glGetQueryObjectui64vPROC glGetQueryObjectui64v = NULL;
+
+//-----------------------------------------
+// External memory objects and semaphores
+//-----------------------------------------
+glCreateMemoryObjectsEXTPROC        glCreateMemoryObjectsEXT        = NULL;
+glDeleteMemoryObjectsEXTPROC        glDeleteMemoryObjectsEXT        = NULL;
+glMemoryObjectParameterivEXTPROC    glMemoryObjectParameterivEXT    = NULL;
+glImportMemoryWin32HandleEXTPROC    glImportMemoryWin32HandleEXT    = NULL;
+glTexStorageMem2DEXTPROC            glTexStorageMem2DEXT            = NULL;
+glTexStorageMem3DEXTPROC            glTexStorageMem3DEXT            = NULL;
+glGenSemaphoresEXTPROC              glGenSemaphoresEXT              = NULL;
+glDeleteSemaphoresEXTPROC           glDeleteSemaphoresEXT           = NULL;
+glSemaphoreParameterui64vEXTPROC    glSemaphoreParameterui64vEXT    = NULL;
+glImportSemaphoreWin32HandleEXTPROC glImportSemaphoreWin32HandleEXT = NULL;
+glWaitSemaphoreEXTPROC              glWaitSemaphoreEXT              = NULL;
+glSignalSemaphoreEXTPROC            glSignalSemaphoreEXT            = NULL;
+
 #endif
 
 //
@@ -393,6 +463,7 @@ bool loadPBOextensions()
 	glClientWaitSync	= (glClientWaitSyncPROC)wglGetProcAddress("glClientWaitSync");
 	glDeleteSync		= (glDeleteSyncPROC)wglGetProcAddress("glDeleteSync");
 	glFenceSync			= (glFenceSyncPROC)wglGetProcAddress("glFenceSync");
+	glWaitSync			= (glWaitSyncPROC)wglGetProcAddress("glWaitSync");
 
 	if (glGenBuffers  != NULL && glDeleteBuffers  != NULL
 		&& glBindBuffer  != NULL && glBufferData     != NULL
@@ -474,9 +545,15 @@ bool loadComputeShaderExtensions()
 	glDeleteProgram    = (glDeleteProgramPROC)wglGetProcAddress("glDeleteProgram");
 	glDeleteShader     = (glDeleteShaderPROC)wglGetProcAddress("glDeleteShader");
 	glMemoryBarrier    = (glMemoryBarrierPROC)wglGetProcAddress("glMemoryBarrier");
+	glBindBufferBase   = (glBindBufferBasePROC)wglGetProcAddress("glBindBufferBase");
 	glActiveTexture    = (glActiveTexturePROC)wglGetProcAddress("glActiveTexture");
 	glUniform1i        = (glUniform1iPROC)wglGetProcAddress("glUniform1i");
 	glUniform1f        = (glUniform1fPROC)wglGetProcAddress("glUniform1f");
+	glUniform1fv       = (glUniform1fvPROC)wglGetProcAddress("glUniform1fv");
+	// Optional
+	glGetProgramBinary  = (glGetProgramBinaryPROC)wglGetProcAddress("glGetProgramBinary");
+	glProgramBinary     = (glProgramBinaryPROC)wglGetProcAddress("glProgramBinary");
+	glProgramParameteri = (glProgramParameteriPROC)wglGetProcAddress("glProgramParameteri");
 	glGetUniformLocation = (glGetUniformLocationPROC)wglGetProcAddress("glGetUniformLocation");
 	glTextureStorage2D   = (glTextureStorage2DPROC)wglGetProcAddress("glTextureStorage2D");
 	glCreateTextures     = (glCreateTexturesPROC)wglGetProcAddress("glCreateTextures");
@@ -510,8 +587,10 @@ bool loadComputeShaderExtensions()
 		&& glActiveTexture != NULL
 		&& glUniform1i != NULL
 		&& glUniform1f != NULL
+		&& glUniform1fv != NULL
 		&& glDeleteShader != NULL
 		&& glMemoryBarrier != NULL
+		&& glBindBufferBase != NULL
 		&& glGetUniformLocation != NULL
 		&& glTextureStorage2D != NULL
 		&& glCreateTextures != NULL
@@ -539,6 +618,65 @@ bool loadComputeShaderExtensions()
 
 }
 
+//
+// Vertex arrays for core profile drawing
+// Shader functions are loaded by loadComputeShaderExtensions
+//
+bool loadDrawExtensions()
+{
+
+#ifdef USE_COMPUTE_EXTENSIONS
+
+	#ifdef USE_GLEW
+	   return false;
+	#else
+
+	glGenVertexArrays         = (glGenVertexArraysPROC)wglGetProcAddress("glGenVertexArrays");
+	glBindVertexArray         = (glBindVertexArrayPROC)wglGetProcAddress("glBindVertexArray");
+	glDeleteVertexArrays      = (glDeleteVertexArraysPROC)wglGetProcAddress("glDeleteVertexArrays");
+	glVertexAttribPointer     = (glVertexAttribPointerPROC)wglGetProcAddress("glVertexAttribPointer");
+	glEnableVertexAttribArray = (glEnableVertexAttribArrayPROC)wglGetProcAddress("glEnableVertexAttribArray");
+	glGetShaderiv             = (glGetShaderivPROC)wglGetProcAddress("glGetShaderiv");
+
+	if (glGenVertexArrays != NULL
+		&& glBindVertexArray != NULL
+		&& glDeleteVertexArrays != NULL
+		&& glVertexAttribPointer != NULL
+		&& glEnableVertexAttribArray != NULL
+		&& glGetShaderiv != NULL
+		&& glGetShaderInfoLog != NULL
+		&& glDetachShader != NULL
+		&& glDeleteProgram != NULL
+		&& glCreateProgram != NULL
+		&& glCreateShader != NULL
+		&& glShaderSource != NULL
+		&& glCompileShader != NULL
+		&& glAttachShader != NULL
+		&& glLinkProgram != NULL
+		&& glGetProgramiv != NULL
+		&& glUseProgram != NULL
+		&& glDeleteShader != NULL
+		&& glActiveTexture != NULL
+		&& glUniform1i != NULL
+		&& glUniform1fv != NULL
+		&& glGetUniformLocation != NULL
+		&& glGenBuffers != NULL
+		&& glBindBuffer != NULL
+		&& glBufferData != NULL) {
+			return true;
+	}
+	else {
+		return false;
+	}
+	#endif
+
+#else
+	// Shader extensions defined elsewhere
+	return true;
+#endif
+
+}
+
 bool loadContextExtension()
 {
 
@@ -575,6 +713,160 @@ bool loadContextExtension()
 }
 
 
+//
+// Debug output functions (KHR_debug)
+//
+bool loadDebugExtensions()
+{
+
+#ifdef USE_GLEW
+	if (glDebugMessageCallback && glDebugMessageControl)
+		return true;
+	else
+		return false;
+#else
+
+	glDebugMessageCallback = (glDebugMessageCallbackPROC)wglGetProcAddress("glDebugMessageCallback");
+	glDebugMessageControl  = (glDebugMessageControlPROC)wglGetProcAddress("glDebugMessageControl");
+
+	if (glDebugMessageCallback != NULL
+	 && glDebugMessageControl  != NULL) {
+		return true;
+	}
+	else {
+		return false;
+	}
+#endif
+
+}
+
+//
+// Timer query functions (ARB_timer_query)
+//
+bool loadTimerExtensions()
+{
+
+#ifdef USE_GLEW
+	if (glGenQueries && glDeleteQueries && glQueryCounter
+		&& glGetQueryObjectiv && glGetQueryObjectui64v)
+		return true;
+	else
+		return false;
+#else
+
+	glGenQueries          = (glGenQueriesPROC)wglGetProcAddress("glGenQueries");
+	glDeleteQueries       = (glDeleteQueriesPROC)wglGetProcAddress("glDeleteQueries");
+	glQueryCounter        = (glQueryCounterPROC)wglGetProcAddress("glQueryCounter");
+	glGetQueryObjectiv    = (glGetQueryObjectivPROC)wglGetProcAddress("glGetQueryObjectiv");
+	glGetQueryObjectui64v = (glGetQueryObjectui64vPROC)wglGetProcAddress("glGetQueryObjectui64v");
+
+	if (glGenQueries != NULL
+	 && glDeleteQueries != NULL
+	 && glQueryCounter != NULL
+	 && glGetQueryObjectiv != NULL
+	 && glGetQueryObjectui64v != NULL) {
+		return true;
+	}
+	else {
+		return false;
+	}
+#endif
+
+}
+
+//
+// External memory objects and semaphores imported from DirectX
+// (EXT_memory_object_win32, EXT_semaphore_win32)
+//
+bool loadMemoryObjectExtensions()
+{
+
+#ifdef USE_GLEW
+	if (glCreateMemoryObjectsEXT && glDeleteMemoryObjectsEXT && glMemoryObjectParameterivEXT
+		&& glImportMemoryWin32HandleEXT && glTexStorageMem2DEXT && glTexStorageMem3DEXT
+		&& glGenSemaphoresEXT && glDeleteSemaphoresEXT && glSemaphoreParameterui64vEXT
+		&& glImportSemaphoreWin32HandleEXT && glWaitSemaphoreEXT && glSignalSemaphoreEXT)
+		return true;
+	else
+		return false;
+#else
+
+	// Both extensions are needed for texture import and synchronisation
+	if (!isExtensionSupported("GL_EXT_memory_object_win32")
+		|| !isExtensionSupported("GL_EXT_semaphore_win32"))
+		return false;
+
+	glCreateMemoryObjectsEXT        = (glCreateMemoryObjectsEXTPROC)wglGetProcAddress("glCreateMemoryObjectsEXT");
+	glDeleteMemoryObjectsEXT        = (glDeleteMemoryObjectsEXTPROC)wglGetProcAddress("glDeleteMemoryObjectsEXT");
+	glMemoryObjectParameterivEXT    = (glMemoryObjectParameterivEXTPROC)wglGetProcAddress("glMemoryObjectParameterivEXT");
+	glImportMemoryWin32HandleEXT    = (glImportMemoryWin32HandleEXTPROC)wglGetProcAddress("glImportMemoryWin32HandleEXT");
+	glTexStorageMem2DEXT            = (glTexStorageMem2DEXTPROC)wglGetProcAddress("glTexStorageMem2DEXT");
+	glTexStorageMem3DEXT            = (glTexStorageMem3DEXTPROC)wglGetProcAddress("glTexStorageMem3DEXT");
+	glGenSemaphoresEXT              = (glGenSemaphoresEXTPROC)wglGetProcAddress("glGenSemaphoresEXT");
+	glDeleteSemaphoresEXT           = (glDeleteSemaphoresEXTPROC)wglGetProcAddress("glDeleteSemaphoresEXT");
+	glSemaphoreParameterui64vEXT    = (glSemaphoreParameterui64vEXTPROC)wglGetProcAddress("glSemaphoreParameterui64vEXT");
+	glImportSemaphoreWin32HandleEXT = (glImportSemaphoreWin32HandleEXTPROC)wglGetProcAddress("glImportSemaphoreWin32HandleEXT");
+	glWaitSemaphoreEXT              = (glWaitSemaphoreEXTPROC)wglGetProcAddress("glWaitSemaphoreEXT");
+	glSignalSemaphoreEXT            = (glSignalSemaphoreEXTPROC)wglGetProcAddress("glSignalSemaphoreEXT");
+
+	if (glCreateMemoryObjectsEXT        != NULL
+	 && glDeleteMemoryObjectsEXT        != NULL
+	 && glMemoryObjectParameterivEXT    != NULL
+	 && glImportMemoryWin32HandleEXT    != NULL
+	 && glTexStorageMem2DEXT            != NULL
+	 && glTexStorageMem3DEXT            != NULL
+	 && glGenSemaphoresEXT              != NULL
+	 && glDeleteSemaphoresEXT           != NULL
+	 && glSemaphoreParameterui64vEXT    != NULL
+	 && glImportSemaphoreWin32HandleEXT != NULL
+	 && glWaitSemaphoreEXT              != NULL
+	 && glSignalSemaphoreEXT            != NULL) {
+		return true;
+	}
+	else {
+		return false;
+	}
+#endif
+
+}
+
+//
+// Direct state access framebuffer functions
+//
+bool loadDSAextensions()
+{
+
+#ifdef USE_FBO_EXTENSIONS
+
+#ifdef USE_GLEW
+	if (glCreateFramebuffers && glNamedFramebufferTexture && glBlitNamedFramebuffer)
+		return true;
+	else
+		return false;
+#else
+
+	glCreateFramebuffers      = (glCreateFramebuffersPROC)wglGetProcAddress("glCreateFramebuffers");
+	glNamedFramebufferTexture = (glNamedFramebufferTexturePROC)wglGetProcAddress("glNamedFramebufferTexture");
+	glBlitNamedFramebuffer    = (glBlitNamedFramebufferPROC)wglGetProcAddress("glBlitNamedFramebuffer");
+
+	if (glCreateFramebuffers      != NULL
+	 && glNamedFramebufferTexture != NULL
+	 && glBlitNamedFramebuffer    != NULL) {
+		return true;
+	}
+	else {
+		return false;
+	}
+#endif
+
+#else
+	// FBO functions defined elsewhere
+	return false;
+#endif
+
+}
+
+
 bool InitializeGlew()
 {
 #ifdef USE_GLEW
@@ -680,6 +972,36 @@ unsigned int loadGLextensions() {
 		ExtLog(SPOUT_EXT_LOG_WARNING, "loadGLextensions : loadContextExtension fail");
 	}
 
+	// Direct state access is optional
+	if (loadDSAextensions()) {
+		caps |= GLEXT_SUPPORT_DSA;
+	}
+
+	// Debug output is optional
+	if (loadDebugExtensions()) {
+		caps |= GLEXT_SUPPORT_DEBUG;
+	}
+
+	// Core profile drawing is optional
+	if (loadDrawExtensions()) {
+		caps |= GLEXT_SUPPORT_DRAW;
+	}
+
+	// Timer queries are optional
+	if (loadTimerExtensions()) {
+		caps |= GLEXT_SUPPORT_TIMER;
+	}
+
+	// Memory objects and semaphores are optional
+	if (loadMemoryObjectExtensions()) {
+		caps |= GLEXT_SUPPORT_MEMORY;
+	}
+
+	// Application memory as a buffer store is optional (AMD)
+	if ((caps & GLEXT_SUPPORT_PBO) && isExtensionSupported("GL_AMD_pinned_memory")) {
+		caps |= GLEXT_SUPPORT_PINNED;
+	}
+
 	// Load wgl interop extensions
 	if (loadInteropExtensions()) {
 		caps |= GLEXT_SUPPORT_NVINTEROP;
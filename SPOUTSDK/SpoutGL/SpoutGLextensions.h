@@ -164,6 +164,10 @@ enum ExtLogLevel {
 #define GL_CLAMP_TO_EDGE 0x812F
 #endif
 
+#ifndef GL_TEXTURE_2D_ARRAY
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#endif
+
 // FRAMEBUFFER
 #ifndef GL_READ_FRAMEBUFFER
 #define GL_READ_FRAMEBUFFER 0x8CA8
@@ -302,6 +306,12 @@ enum ExtLogLevel {
 #define GLEXT_SUPPORT_COPY			 64
 #define GLEXT_SUPPORT_COMPUTE		128
 #define GLEXT_SUPPORT_CONTEXT       256
+#define GLEXT_SUPPORT_DSA           512
+#define GLEXT_SUPPORT_DEBUG        1024
+#define GLEXT_SUPPORT_DRAW         2048
+#define GLEXT_SUPPORT_TIMER        4096
+#define GLEXT_SUPPORT_MEMORY       8192
+#define GLEXT_SUPPORT_PINNED      16384
 
 //-----------------------------------------------------
 // GL consts that are needed and aren't present in GL.h
@@ -487,6 +497,18 @@ extern glIsFramebufferEXTPROC						glIsFramebufferEXT;
 extern glIsRenderbufferEXTPROC						glIsRenderbufferEXT;
 extern glRenderbufferStorageEXTPROC					glRenderbufferStorageEXT;
 
+// Direct state access framebuffer functions (OpenGL 4.5)
+// Optional, not required for FBO support
+typedef void   (APIENTRY *glCreateFramebuffersPROC)		(GLsizei n, GLuint* framebuffers);
+typedef void   (APIENTRY *glNamedFramebufferTexturePROC)	(GLuint framebuffer, GLenum attachment, GLuint texture, GLint level);
+typedef void   (APIENTRY *glBlitNamedFramebufferPROC)	(GLuint readFramebuffer, GLuint drawFramebuffer,
+	GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+	GLbitfield mask, GLenum filter);
+
+extern glCreateFramebuffersPROC						glCreateFramebuffers;
+extern glNamedFramebufferTexturePROC				glNamedFramebufferTexture;
+extern glBlitNamedFramebufferPROC					glBlitNamedFramebuffer;
+
 #endif // USE_FBO_EXTENSIONS
 
 //-------------------
@@ -545,6 +567,9 @@ extern PFNWGLGETSWAPINTERVALEXTPROC    wglGetSwapIntervalEXT;
 #ifndef GL_MAP_COHERENT_BIT
 #define GL_MAP_COHERENT_BIT				0x0080 
 #endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT			0x0200
+#endif
 
 //
 // Optional flag bits
@@ -564,6 +589,13 @@ extern PFNWGLGETSWAPINTERVALEXTPROC    wglGetSwapIntervalEXT;
 #ifndef GL_SYNC_FLUSH_COMMANDS_BIT
 #define GL_SYNC_FLUSH_COMMANDS_BIT		0x0001
 #endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED				0xFFFFFFFFFFFFFFFFull
+#endif
+// AMD_pinned_memory buffer target
+#ifndef GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD
+#define GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD 0x9160
+#endif
 
 
 //
@@ -640,10 +672,12 @@ typedef uint64_t GLuint64;
 typedef GLenum(APIENTRY *glClientWaitSyncPROC) (GLsync sync, GLbitfield flags, GLuint64 timeout);
 typedef void   (APIENTRY *glDeleteSyncPROC) (GLsync sync);
 typedef GLsync(APIENTRY *glFenceSyncPROC) (GLenum condition, GLbitfield flags);
+typedef void   (APIENTRY *glWaitSyncPROC) (GLsync sync, GLbitfield flags, GLuint64 timeout);
 
-extern glClientWaitSyncPROC glClientWaitSyncEXT;
-extern glDeleteSyncPROC     glDeleteSyncEXT;
-extern glFenceSyncPROC      glFenceSyncEXT;
+extern glClientWaitSyncPROC glClientWaitSync;
+extern glDeleteSyncPROC     glDeleteSync;
+extern glFenceSyncPROC      glFenceSync;
+extern glWaitSyncPROC       glWaitSync;
 
 #endif // USE_PBO_EXTENSIONS
 
@@ -674,6 +708,10 @@ extern glGetInternalFormativPROC glGetInternalFormativ;
 #define GL_MAX_COMPUTE_WORK_GROUP_SIZE    0x91BF
 #endif
 
+#ifndef GL_MAX_COMPUTE_SHARED_MEMORY_SIZE
+#define GL_MAX_COMPUTE_SHARED_MEMORY_SIZE 0x8262
+#endif
+
 #ifndef GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS
 #define GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS 0x90EB
 #endif
@@ -729,6 +767,27 @@ typedef void   (APIENTRY* glDeleteProgramPROC) (GLuint program);
 typedef void   (APIENTRY* glDeleteShaderPROC) (GLuint shader);
 
 typedef void   (APIENTRY* glMemoryBarrierPROC) (GLbitfield barriers);
+typedef void   (APIENTRY* glBindBufferBasePROC) (GLenum target, GLuint index, GLuint buffer);
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+#ifndef GL_TEXTURE_UPDATE_BARRIER_BIT
+#define GL_TEXTURE_UPDATE_BARRIER_BIT 0x00000100
+#endif
+
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+#ifndef GL_FRAMEBUFFER_BARRIER_BIT
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#endif
+
+#ifndef GL_PIXEL_BUFFER_BARRIER_BIT
+#define GL_PIXEL_BUFFER_BARRIER_BIT 0x00000080
+#endif
 
 #ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
 #define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
@@ -755,6 +814,7 @@ extern glDispatchComputePROC    glDispatchCompute;
 extern glDeleteProgramPROC      glDeleteProgram;
 extern glDeleteShaderPROC       glDeleteShader;
 extern glMemoryBarrierPROC      glMemoryBarrier;
+extern glBindBufferBasePROC     glBindBufferBase;
 
 typedef void (APIENTRY* glActiveTexturePROC)(GLenum texture);
 extern glActiveTexturePROC      glActiveTexture;
@@ -762,6 +822,25 @@ typedef void (APIENTRY* glUniform1iPROC) (GLint location, GLint v0);
 extern glUniform1iPROC          glUniform1i;
 typedef void (APIENTRY* glUniform1fPROC) (GLint location, float v0);
 extern glUniform1fPROC          glUniform1f;
+typedef void (APIENTRY* glUniform1fvPROC) (GLint location, GLsizei count, const float* value);
+extern glUniform1fvPROC         glUniform1fv;
+
+// Program binary (OpenGL 4.1)
+// Optional, not required for compute shader support
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+typedef void (APIENTRY* glGetProgramBinaryPROC) (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+extern glGetProgramBinaryPROC   glGetProgramBinary;
+typedef void (APIENTRY* glProgramBinaryPROC) (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+extern glProgramBinaryPROC      glProgramBinary;
+typedef void (APIENTRY* glProgramParameteriPROC) (GLuint program, GLenum pname, GLint value);
+extern glProgramParameteriPROC  glProgramParameteri;
 typedef GLint (APIENTRY* glGetUniformLocationPROC) (GLuint program, const char* name);
 extern glGetUniformLocationPROC glGetUniformLocation;
 
@@ -772,6 +851,53 @@ extern glTextureStorage2DPROC glTextureStorage2D;
 typedef void (APIENTRY * glCreateTexturesPROC) (GLenum target, GLsizei n, GLuint* textures);
 extern glCreateTexturesPROC glCreateTextures;
 
+// Vertex and fragment shader drawing (OpenGL 3.3 core profile)
+// Optional, not required for compute shader support
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+#ifndef GL_CURRENT_PROGRAM
+#define GL_CURRENT_PROGRAM 0x8B8D
+#endif
+
+#ifndef GL_VERTEX_ARRAY_BINDING
+#define GL_VERTEX_ARRAY_BINDING 0x85B5
+#endif
+
+#ifndef GL_ARRAY_BUFFER_BINDING
+#define GL_ARRAY_BUFFER_BINDING 0x8894
+#endif
+
+#ifndef GL_ACTIVE_TEXTURE
+#define GL_ACTIVE_TEXTURE 0x84E0
+#endif
+
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+
+typedef void (APIENTRY* glGenVertexArraysPROC) (GLsizei n, GLuint* arrays);
+extern glGenVertexArraysPROC glGenVertexArrays;
+typedef void (APIENTRY* glBindVertexArrayPROC) (GLuint array);
+extern glBindVertexArrayPROC glBindVertexArray;
+typedef void (APIENTRY* glDeleteVertexArraysPROC) (GLsizei n, const GLuint* arrays);
+extern glDeleteVertexArraysPROC glDeleteVertexArrays;
+typedef void (APIENTRY* glVertexAttribPointerPROC) (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+extern glVertexAttribPointerPROC glVertexAttribPointer;
+typedef void (APIENTRY* glEnableVertexAttribArrayPROC) (GLuint index);
+extern glEnableVertexAttribArrayPROC glEnableVertexAttribArray;
+typedef void (APIENTRY* glGetShaderivPROC) (GLuint shader, GLenum pname, GLint* param);
+extern glGetShaderivPROC glGetShaderiv;
+
 // https://registry.khronos.org/OpenGL/extensions/EXT/EXT_external_objects.txt
 // void CreateMemoryObjectsEXT(sizei n,	uint* memoryObjects);
 // void DeleteMemoryObjectsEXT(sizei n, const uint* memoryObjects);
@@ -854,6 +980,90 @@ extern PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB;
 #define		ERROR_INVALID_VERSION_ARB               0x2095
 #define		ERROR_INVALID_PROFILE_ARB               0x2096
 
+//----------------------------------
+// Debug output (KHR_debug, OpenGL 4.3)
+//----------------------------------
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS             0x8242
+#define GL_DEBUG_SOURCE_API                     0x8246
+#define GL_DEBUG_TYPE_ERROR                     0x824C
+#define GL_DEBUG_SEVERITY_HIGH                  0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM                0x9147
+#define GL_DEBUG_SEVERITY_LOW                   0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION          0x826B
+#define GL_DEBUG_OUTPUT                         0x92E0
+
+typedef void (APIENTRY *GLDEBUGPROC)(GLenum source, GLenum type, GLuint id,
+	GLenum severity, GLsizei length, const char* message, const void* userParam);
+#endif
+typedef void (APIENTRY *glDebugMessageCallbackPROC) (GLDEBUGPROC callback, const void* userParam);
+typedef void (APIENTRY *glDebugMessageControlPROC) (GLenum source, GLenum type, GLenum severity,
+	GLsizei count, const GLuint* ids, GLboolean enabled);
+extern glDebugMessageCallbackPROC glDebugMessageCallback;
+extern glDebugMessageControlPROC  glDebugMessageControl;
+
+//----------------------------------
+// Timer queries (ARB_timer_query, OpenGL 3.3)
+//----------------------------------
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP                            0x8E28
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT                         0x8866
+#define GL_QUERY_RESULT_AVAILABLE               0x8867
+#endif
+typedef void (APIENTRY *glGenQueriesPROC) (GLsizei n, GLuint* ids);
+typedef void (APIENTRY *glDeleteQueriesPROC) (GLsizei n, const GLuint* ids);
+typedef void (APIENTRY *glQueryCounterPROC) (GLuint id, GLenum target);
+typedef void (APIENTRY *glGetQueryObjectivPROC) (GLuint id, GLenum pname, GLint* params);
+typedef void (APIENTRY *glGetQueryObjectui64vPROC) (GLuint id, GLenum pname, GLuint64* params);
+extern glGenQueriesPROC          glGenQueries;
+extern glDeleteQueriesPROC       glDeleteQueries;
+extern glQueryCounterPROC        glQueryCounter;
+extern glGetQueryObjectivPROC    glGetQueryObjectiv;
+extern glGetQueryObjectui64vPROC glGetQueryObjectui64v;
+
+//----------------------------------
+// External memory objects and semaphores
+// (EXT_memory_object_win32, EXT_semaphore_win32)
+//----------------------------------
+#ifndef GL_HANDLE_TYPE_D3D11_IMAGE_EXT
+#define GL_DEDICATED_MEMORY_OBJECT_EXT          0x9581
+#define GL_HANDLE_TYPE_D3D11_IMAGE_EXT          0x958B
+#define GL_HANDLE_TYPE_D3D11_IMAGE_KMT_EXT      0x958C
+#define GL_LAYOUT_GENERAL_EXT                   0x958D
+#define GL_HANDLE_TYPE_D3D12_FENCE_EXT          0x9594
+#define GL_D3D12_FENCE_VALUE_EXT                0x9595
+#endif
+typedef void (APIENTRY *glCreateMemoryObjectsEXTPROC) (GLsizei n, GLuint* memoryObjects);
+typedef void (APIENTRY *glDeleteMemoryObjectsEXTPROC) (GLsizei n, const GLuint* memoryObjects);
+typedef void (APIENTRY *glMemoryObjectParameterivEXTPROC) (GLuint memoryObject, GLenum pname, const GLint* params);
+typedef void (APIENTRY *glImportMemoryWin32HandleEXTPROC) (GLuint memory, GLuint64 size, GLenum handleType, void* handle);
+typedef void (APIENTRY *glTexStorageMem2DEXTPROC) (GLenum target, GLsizei levels, GLenum internalFormat,
+	GLsizei width, GLsizei height, GLuint memory, GLuint64 offset);
+typedef void (APIENTRY *glTexStorageMem3DEXTPROC) (GLenum target, GLsizei levels, GLenum internalFormat,
+	GLsizei width, GLsizei height, GLsizei depth, GLuint memory, GLuint64 offset);
+typedef void (APIENTRY *glGenSemaphoresEXTPROC) (GLsizei n, GLuint* semaphores);
+typedef void (APIENTRY *glDeleteSemaphoresEXTPROC) (GLsizei n, const GLuint* semaphores);
+typedef void (APIENTRY *glSemaphoreParameterui64vEXTPROC) (GLuint semaphore, GLenum pname, const GLuint64* params);
+typedef void (APIENTRY *glImportSemaphoreWin32HandleEXTPROC) (GLuint semaphore, GLenum handleType, void* handle);
+typedef void (APIENTRY *glWaitSemaphoreEXTPROC) (GLuint semaphore, GLuint numBufferBarriers, const GLuint* buffers,
+	GLuint numTextureBarriers, const GLuint* textures, const GLenum* srcLayouts);
+typedef void (APIENTRY *glSignalSemaphoreEXTPROC) (GLuint semaphore, GLuint numBufferBarriers, const GLuint* buffers,
+	GLuint numTextureBarriers, const GLuint* textures, const GLenum* dstLayouts);
+extern glCreateMemoryObjectsEXTPROC        glCreateMemoryObjectsEXT;
+extern glDeleteMemoryObjectsEXTPROC        glDeleteMemoryObjectsEXT;
+extern glMemoryObjectParameterivEXTPROC    glMemoryObjectParameterivEXT;
+extern glImportMemoryWin32HandleEXTPROC    glImportMemoryWin32HandleEXT;
+extern glTexStorageMem2DEXTPROC            glTexStorageMem2DEXT;
+extern glTexStorageMem3DEXTPROC            glTexStorageMem3DEXT;
+extern glGenSemaphoresEXTPROC              glGenSemaphoresEXT;
+extern glDeleteSemaphoresEXTPROC           glDeleteSemaphoresEXT;
+extern glSemaphoreParameterui64vEXTPROC    glSemaphoreParameterui64vEXT;
+extern glImportSemaphoreWin32HandleEXTPROC glImportSemaphoreWin32HandleEXT;
+extern glWaitSemaphoreEXTPROC              glWaitSemaphoreEXT;
+extern glSignalSemaphoreEXTPROC            glSignalSemaphoreEXT;
+
 #endif // end GLEW
 
 //----------------
@@ -869,6 +1079,11 @@ bool loadPBOextensions();
 bool loadCopyExtensions();
 bool loadComputeShaderExtensions();
 bool loadContextExtension();
+bool loadDSAextensions();
+bool loadDebugExtensions();
+bool loadDrawExtensions();
+bool loadTimerExtensions();
+bool loadMemoryObjectExtensions();
 bool isExtensionSupported(const char *extension);
 void ExtLog(ExtLogLevel level, const char* format, ...);
 
@@ -79,6 +79,27 @@
 //		04.08.23	- Add format functions
 //		07.08.23	- Add frame sync option functions
 //	Version 2.007.013
+//		14.10.26	- Add ReceiveImage with pixel buffer width and height
+//					- Add ReceiveTexture for a region of the sender texture
+//					- Add GetSenderFrameAge and GetSenderMissedFrames
+//					- Add WaitFrameSync for a number of senders
+//					- Add SetSharedInterop and GetSharedInterop
+//					- Add ReadFrameData
+//					- Add LockMemoryBuffer and UnlockMemoryBuffer
+//					- Add GetSenderFrameStats and ResetSenderFrameStats
+//					- DrawSharedTexture - available without legacyOpenGL (core profile)
+//					- Add SetPreconnect and GetPreconnect
+//					- Add GetSenderArraySize
+//		15.10.26	- Add ReceiveImageYUV
+//					- Add SetSkipUnchanged and GetSkipUnchanged
+//					- Add ReceiveImageView and ReleaseImageView
+//					- Add ReadDataChannel and CloseDataChannel
+//					- Add ReceiveImage with destination line pitch
+//					- Add SetReceiveAnalysis and GetReceiveAnalysis
+//					- Add GetSenderNames
+//					- Add SelectSender(name) and SelectSender(index)
+//					- Add StartReceiveThread, StopReceiveThread, IsReceiveThread
+//					  and GetReceiveThreadTexture
 //
 // ====================================================================================
 //
@@ -147,6 +168,18 @@ void SpoutReceiver::SetReceiverName(const char * SenderName)
 	spout.SetReceiverName(SenderName);
 }
 
+//---------------------------------------------------------
+void SpoutReceiver::SetPreconnect(bool bPreconnect)
+{
+	spout.SetPreconnect(bPreconnect);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::GetPreconnect()
+{
+	return spout.GetPreconnect();
+}
+
 
 //---------------------------------------------------------
 // Release receiver and resources
@@ -168,6 +201,14 @@ bool SpoutReceiver::ReceiveTexture(GLuint TextureID, GLuint TextureTarget, bool
 	return spout.ReceiveTexture(TextureID, TextureTarget, bInvert, HostFbo);
 }
 
+//---------------------------------------------------------
+bool SpoutReceiver::ReceiveTexture(GLuint TextureID, GLuint TextureTarget,
+	unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+	bool bInvert, GLuint HostFbo)
+{
+	return spout.ReceiveTexture(TextureID, TextureTarget, xoffset, yoffset, width, height, bInvert, HostFbo);
+}
+
 //---------------------------------------------------------
 bool SpoutReceiver::ReceiveImage(char* Sendername, unsigned int &width, unsigned int &height,
 	unsigned char* pixels, GLenum glFormat, bool bInvert, GLuint HostFBO)
@@ -199,6 +240,12 @@ DWORD SpoutReceiver::GetSenderFormat()
 	return spout.GetSenderFormat();
 }
 
+//---------------------------------------------------------
+unsigned int SpoutReceiver::GetSenderArraySize()
+{
+	return spout.GetSenderArraySize();
+}
+
 //---------------------------------------------------------
 const char * SpoutReceiver::GetSenderName()
 {
@@ -229,6 +276,30 @@ long SpoutReceiver::GetSenderFrame()
 	return spout.GetSenderFrame();
 }
 
+//---------------------------------------------------------
+double SpoutReceiver::GetSenderFrameAge()
+{
+	return spout.GetSenderFrameAge();
+}
+
+//---------------------------------------------------------
+LONG64 SpoutReceiver::GetSenderMissedFrames()
+{
+	return spout.GetSenderMissedFrames();
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow)
+{
+	spout.GetSenderFrameStats(stats, bWindow);
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::ResetSenderFrameStats()
+{
+	spout.ResetSenderFrameStats();
+}
+
 //---------------------------------------------------------
 HANDLE SpoutReceiver::GetSenderHandle()
 {
@@ -253,6 +324,42 @@ void SpoutReceiver::SelectSender()
 	spout.SelectSenderPanel();
 }
 
+//---------------------------------------------------------
+bool SpoutReceiver::SelectSender(const char* sendername)
+{
+	return spout.SelectSender(sendername);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::SelectSender(int index)
+{
+	return spout.SelectSender(index);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::StartReceiveThread(const char* sendername, bool bInvert)
+{
+	return spout.StartReceiveThread(sendername, bInvert);
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::StopReceiveThread()
+{
+	spout.StopReceiveThread();
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::IsReceiveThread()
+{
+	return spout.IsReceiveThread();
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::GetReceiveThreadTexture(SpoutThreadTexture &texture)
+{
+	return spout.GetReceiveThreadTexture(texture);
+}
+
 //
 // Frame count
 //
@@ -293,6 +400,12 @@ bool SpoutReceiver::WaitFrameSync(const char *SenderName, DWORD dwTimeout)
 	return spout.WaitFrameSync(SenderName, dwTimeout);
 }
 
+//---------------------------------------------------------
+int SpoutReceiver::WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout)
+{
+	return spout.WaitFrameSync(SenderNames, count, bSignalled, dwTimeout);
+}
+
 //---------------------------------------------------------
 void SpoutReceiver::EnableFrameSync(bool bSync)
 {
@@ -305,18 +418,72 @@ bool SpoutReceiver::IsFrameSyncEnabled()
 	return spout.IsFrameSyncEnabled();
 }
 
+//---------------------------------------------------------
+void SpoutReceiver::SetSkipUnchanged(bool bSkip)
+{
+	spout.SetSkipUnchanged(bSkip);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::GetSkipUnchanged()
+{
+	return spout.GetSkipUnchanged();
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::SetReceiveAnalysis(bool bAnalyze)
+{
+	spout.SetReceiveAnalysis(bAnalyze);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::GetReceiveAnalysis(SpoutScopeData &data, bool bWait)
+{
+	return spout.GetReceiveAnalysis(data, bWait);
+}
+
 //---------------------------------------------------------
 int SpoutReceiver::ReadMemoryBuffer(const char* name, char* data, int maxlength)
 {
 	return spout.ReadMemoryBuffer(name, data, maxlength);
 }
 
+//---------------------------------------------------------
+int SpoutReceiver::LockMemoryBuffer(const char* name, const char** ppData)
+{
+	return spout.LockMemoryBuffer(name, ppData);
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::UnlockMemoryBuffer()
+{
+	spout.UnlockMemoryBuffer();
+}
+
 //---------------------------------------------------------
 int SpoutReceiver::GetMemoryBufferSize(const char* name)
 {
 	return spout.GetMemoryBufferSize(name);
 }
 
+//---------------------------------------------------------
+int SpoutReceiver::ReadDataChannel(const char* name, char* data, int maxlength)
+{
+	return spout.ReadDataChannel(name, data, maxlength);
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::CloseDataChannel(const char* name)
+{
+	spout.CloseDataChannel(name);
+}
+
+//---------------------------------------------------------
+int SpoutReceiver::ReadFrameData(char* data, int maxlength, long framenumber)
+{
+	return spout.ReadFrameData(data, maxlength, framenumber);
+}
+
 
 //
 // OpenGL shared texture access
@@ -374,6 +541,18 @@ bool SpoutReceiver::IsGLDXready()
 	return spout.IsGLDXready();
 }
 
+//---------------------------------------------------------
+void SpoutReceiver::SetSharedInterop(bool bShared)
+{
+	spout.SetSharedInterop(bShared);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::GetSharedInterop()
+{
+	return spout.GetSharedInterop();
+}
+
 //
 // Sender names
 //
@@ -391,6 +570,13 @@ bool SpoutReceiver::GetSender(int index, char* sendername, int sendernameMaxSize
 	return spout.GetSender(index, sendername, sendernameMaxSize);
 }
 
+//---------------------------------------------------------
+// Copy the sender names to a buffer without allocation
+int SpoutReceiver::GetSenderNames(char* names, int maxsenders, int maxlength)
+{
+	return spout.GetSenderNames(names, maxsenders, maxlength);
+}
+
 //---------------------------------------------------------
 bool SpoutReceiver::GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat)
 {
@@ -700,6 +886,39 @@ bool SpoutReceiver::ReceiveImage(unsigned char *pixels, GLenum glFormat, bool bI
 	return spout.ReceiveImage(pixels, glFormat, bInvert, HostFbo);
 }
 
+//---------------------------------------------------------
+bool SpoutReceiver::ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+	GLenum glFormat, bool bInvert, GLuint HostFbo)
+{
+	return spout.ReceiveImage(pixels, width, height, glFormat, bInvert, HostFbo);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+	unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFbo)
+{
+	return spout.ReceiveImage(pixels, width, height, pitch, glFormat, bInvert, HostFbo);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+	SpoutYUVLayout layout, SpoutYUVMatrix matrix, bool bFullRange, bool bInvert, GLuint HostFbo)
+{
+	return spout.ReceiveImageYUV(pixels, width, height, layout, matrix, bFullRange, bInvert, HostFbo);
+}
+
+//---------------------------------------------------------
+bool SpoutReceiver::ReceiveImageView(SpoutImageView &view)
+{
+	return spout.ReceiveImageView(view);
+}
+
+//---------------------------------------------------------
+void SpoutReceiver::ReleaseImageView()
+{
+	spout.ReleaseImageView();
+}
+
 //---------------------------------------------------------
 bool SpoutReceiver::SelectSenderPanel(const char *message)
 {
@@ -713,12 +932,10 @@ bool SpoutReceiver::CheckSenderPanel(char *sendername, int maxchars)
 }
 
 
-// Legacy OpenGL Draw function
-#ifdef legacyOpenGL
+// OpenGL Draw function
 
 //---------------------------------------------------------
 bool SpoutReceiver::DrawSharedTexture(float max_x, float max_y, float aspect, bool bInvert, GLuint HostFBO)
 {
 	return spout.DrawSharedTexture(max_x, max_y, aspect, bInvert, HostFBO);
 }
-#endif
@@ -44,22 +44,48 @@ class SPOUT_DLLEXP SpoutReceiver {
 	//   If that sender closes, the application will wait for the nominated sender to open 
 	//   If no name is specified, the receiver will connect to the active sender
 	void SetReceiverName(const char * sendername = nullptr);
+	// Open sender textures on a thread when senders change
+	void SetPreconnect(bool bPreconnect = true);
+	// Pre-connect status
+	bool GetPreconnect();
 	// Close receiver and release resources ready to connect to another sender
 	void ReleaseReceiver();
 	// Receive shared texture
 	//   Connect to a sender and retrieve texture details ready for access
-	//	 (see BindSharedTexture and UnBindSharedTexture)
+	//	 (see BindSharedTexture and UnBindSharedTexture
+	//	 or spoutSharedTextureScope for the "spout" member)
 	bool ReceiveTexture();
 	// Receive OpenGL texture
 	// 	 Connect to a sender and inform the application to update
 	//   the receiving texture if it has changed dimensions
 	//   For no change, copy the sender shared texture to the application texture
 	bool ReceiveTexture(GLuint TextureID, GLuint TextureTarget, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive a region of the sender texture
+	bool ReceiveTexture(GLuint TextureID, GLuint TextureTarget,
+		unsigned int xoffset, unsigned int yoffset, unsigned int width, unsigned int height,
+		bool bInvert = false, GLuint HostFbo = 0);
 	// Receive image pixels
 	//   Connect to a sender and inform the application to update
 	//   the receiving buffer if it has changed dimensions
 	//   For no change, copy the sender shared texture to the pixel buffer
 	bool ReceiveImage(unsigned char* pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive image pixels to a buffer of given size
+	//   The shared texture is resampled on the GPU if the size is different
+	bool ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+		GLenum glFormat, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive image pixels to a buffer with a line pitch including padding
+	//   Lines are written at the pitch directly from the staging texture
+	bool ReceiveImage(unsigned char* pixels, unsigned int width, unsigned int height,
+		unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFbo);
+	// Receive image pixels converted to planar YUV (NV12 or I420) on the GPU
+	//   Width and height must be even. The buffer size is width*height*3/2.
+	bool ReceiveImageYUV(unsigned char* pixels, unsigned int width, unsigned int height,
+		SpoutYUVLayout layout = SPOUT_YUV_NV12, SpoutYUVMatrix matrix = SPOUT_YUV_BT709,
+		bool bFullRange = false, bool bInvert = false, GLuint HostFbo = 0);
+	// Receive a view of the mapped sender frame without copy to a pixel buffer
+	bool ReceiveImageView(SpoutImageView &view);
+	// Release the view returned by ReceiveImageView
+	void ReleaseImageView();
 	// Query whether the sender has changed
 	//   Checked at every cycle before receiving data
 	bool IsUpdated();
@@ -78,10 +104,20 @@ class SPOUT_DLLEXP SpoutReceiver {
 	unsigned int GetSenderHeight();
 	// Received sender DX11 texture format
 	DWORD GetSenderFormat();
+	// Received sender number of views (1 for a single texture)
+	unsigned int GetSenderArraySize();
 	// Received sender frame rate
 	double GetSenderFps();
 	// Received sender frame number
 	long GetSenderFrame();
+	// Time in msec from sender publish to receipt of the last frame
+	double GetSenderFrameAge();
+	// Number of sender frames not received
+	LONG64 GetSenderMissedFrames();
+	// Frame statistics since connection or for the last second
+	void GetSenderFrameStats(SpoutFrameStats &stats, bool bWindow = false);
+	// Reset frame statistics
+	void ResetSenderFrameStats();
 	// Received sender share handle
 	HANDLE GetSenderHandle();
 	// Received sender sharing method
@@ -90,6 +126,20 @@ class SPOUT_DLLEXP SpoutReceiver {
 	bool GetSenderGLDX();
 	// Open sender selection dialog
 	void SelectSender();
+	// Select a sender without the dialog
+	bool SelectSender(const char* sendername);
+	// Select a sender by index of the sender list
+	bool SelectSender(int index);
+	// Receive on a thread with a hidden OpenGL context sharing objects with the application context
+	//   Call with the application context current
+	bool StartReceiveThread(const char* sendername = nullptr, bool bInvert = false);
+	// Stop the receive thread
+	void StopReceiveThread();
+	// Receive thread status
+	bool IsReceiveThread();
+	// Latest texture received by the thread
+	//   Returns false if there is no new frame since the last call
+	bool GetReceiveThreadTexture(SpoutThreadTexture &texture);
 
 	//
 	// Frame count
@@ -107,10 +157,20 @@ class SPOUT_DLLEXP SpoutReceiver {
 	void SetFrameSync(const char* SenderName);
 	// Wait or test for a sync event
 	bool WaitFrameSync(const char *SenderName, DWORD dwTimeout = 0);
+	// Wait or test for the sync events of a number of senders
+	int WaitFrameSync(const char* const* SenderNames, int count, bool* bSignalled, DWORD dwTimeout = 0);
 	// Enable / disable frame sync
 	void EnableFrameSync(bool bSync = true);
 	// Check for frame sync option
 	bool IsFrameSyncEnabled();
+	// Skip frames with the same content as the last received
+	void SetSkipUnchanged(bool bSkip = true);
+	// Skip unchanged frames option
+	bool GetSkipUnchanged();
+	// Histograms and waveform of each frame received by compute shader
+	void SetReceiveAnalysis(bool bAnalyze = true);
+	// Latest histograms and waveform of the frames received
+	bool GetReceiveAnalysis(SpoutScopeData &data, bool bWait = false);
 
 	//
 	// Data sharing
@@ -118,8 +178,18 @@ class SPOUT_DLLEXP SpoutReceiver {
 
 	// Read data
 	int ReadMemoryBuffer(const char* name, char* data, int maxlength);
+	// Lock data for read without copy
+	int LockMemoryBuffer(const char* name, const char** ppData);
+	// Unlock data locked by LockMemoryBuffer
+	void UnlockMemoryBuffer();
 	// Get the size of a shared memory buffer
 	int GetMemoryBufferSize(const char* name);
+	// Read data from a named data channel
+	int ReadDataChannel(const char* name, char* data, int maxlength);
+	// Close a named data channel
+	void CloseDataChannel(const char* name);
+	// Read the data sent with a frame
+	int ReadFrameData(char* data, int maxlength, long framenumber = 0);
 
 	//
 	// OpenGL shared texture access
@@ -147,6 +217,10 @@ class SPOUT_DLLEXP SpoutReceiver {
 	void SetCPUshare(bool bCPU = true);
 	// OpenGL texture share compatibility
 	bool IsGLDXready();
+	// Share DirectX and GL/DX interop devices with other instances on the same OpenGL context
+	void SetSharedInterop(bool bShared = true);
+	// Shared interop devices enabled
+	bool GetSharedInterop();
 
 	//
 	// Sender names
@@ -156,6 +230,8 @@ class SPOUT_DLLEXP SpoutReceiver {
 	int GetSenderCount();
 	// Sender item name
 	bool GetSender(int index, char* sendername, int MaxSize = 256);
+	// Copy the sender names to a buffer without allocation
+	int GetSenderNames(char* names, int maxsenders, int maxlength = 256);
 	// Sender information
 	bool GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat);
 	// Current active sender
@@ -229,10 +305,10 @@ class SPOUT_DLLEXP SpoutReceiver {
 	// Set user CPU mode
 	bool SetCPUmode(bool bCPU);
 	// Get user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	int GetShareMode();
 	// Set user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	void SetShareMode(int mode);
 
 	//
@@ -301,12 +377,11 @@ class SPOUT_DLLEXP SpoutReceiver {
 	bool CheckSenderPanel(char *sendername, int maxchars = 256);
 
 
-	// Legacy OpenGL Draw function
-	// See _SpoutCommon.h_ #define legacyOpenGL
-#ifdef legacyOpenGL
+	// OpenGL Draw function
+	// Immediate mode if _SpoutCommon.h_ #define legacyOpenGL
+	// Otherwise core profile with a vertex array and shader program
 	// Render the shared texture
 	bool DrawSharedTexture(float max_x = 1.0, float max_y = 1.0, float aspect = 1.0, bool bInvert = true, GLuint HostFBO = 0);
-#endif
 
 	// For access to all functions
 	Spout spout;
@@ -79,6 +79,20 @@
 //		04.08.23	- Add format functions
 //		07.08.23	- Add frame sync option functions
 //	Version 2.007.013
+//		14.10.26	- Add SetDirtyRects
+//					- Add SetSharedInterop and GetSharedInterop
+//					- Add SetMemoryLargePages and GetMemoryLargePages
+//					- Add CreateFrameData and WriteFrameData
+//					- DrawToSharedTexture - available without legacyOpenGL (core profile)
+//					- Add PrepareSender
+//					- Add SetSenderArraySize
+//		15.10.26	- Add EnableContentHash and IsContentHashEnabled
+//		15.10.26	- Add CreateDataChannel, WriteDataChannel and CloseDataChannel
+//		15.10.26	- Add SendImage with source line pitch
+//		15.10.26	- Add SetSendReadback, GetSendReadback and ReadSendReadback
+//		15.10.26	- Add BeginFrame and EndFrame
+//		15.10.26	- Add SetMemoryCompression and GetMemoryCompression
+//		15.10.26	- Add SetMemoryRingSend and GetMemoryRingSend
 //
 // ====================================================================================
 /*
@@ -155,6 +169,12 @@ void SpoutSender::SetSenderFormat(DWORD dwFormat)
 	spout.SetSenderFormat(dwFormat);
 }
 
+//---------------------------------------------------------
+void SpoutSender::SetSenderArraySize(unsigned int arraysize)
+{
+	spout.SetSenderArraySize(arraysize);
+}
+
 //---------------------------------------------------------
 void SpoutSender::ReleaseSender()
 {
@@ -180,6 +200,25 @@ bool SpoutSender::SendImage(const unsigned char* pixels, unsigned int width, uns
 	return spout.SendImage(pixels, width, height, glFormat, bInvert, HostFBO);
 }
 
+//---------------------------------------------------------
+bool SpoutSender::SendImage(const unsigned char* pixels, unsigned int width, unsigned int height,
+	unsigned int pitch, GLenum glFormat, bool bInvert, GLuint HostFBO)
+{
+	return spout.SendImage(pixels, width, height, pitch, glFormat, bInvert, HostFBO);
+}
+
+//---------------------------------------------------------
+GLuint SpoutSender::BeginFrame(unsigned int width, unsigned int height)
+{
+	return spout.BeginFrame(width, height);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::EndFrame(GLuint HostFBO)
+{
+	return spout.EndFrame(HostFBO);
+}
+
 //---------------------------------------------------------
 bool SpoutSender::IsInitialized()
 {
@@ -286,6 +325,42 @@ bool SpoutSender::IsFrameSyncEnabled()
 	return spout.IsFrameSyncEnabled();
 }
 
+//---------------------------------------------------------
+bool SpoutSender::SetDirtyRects(const RECT* pRects, unsigned int nRects)
+{
+	return spout.SetDirtyRects(pRects, nRects);
+}
+
+//---------------------------------------------------------
+void SpoutSender::EnableContentHash(bool bHash)
+{
+	spout.EnableContentHash(bHash);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::IsContentHashEnabled()
+{
+	return spout.IsContentHashEnabled();
+}
+
+//---------------------------------------------------------
+void SpoutSender::SetSendReadback(bool bReadback, SpoutReadbackCallback callback, void* pUserData)
+{
+	spout.SetSendReadback(bReadback, callback, pUserData);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::GetSendReadback()
+{
+	return spout.GetSendReadback();
+}
+
+//---------------------------------------------------------
+bool SpoutSender::ReadSendReadback(unsigned char* pixels, GLenum glFormat, bool bInvert, LONG64* pFrame)
+{
+	return spout.ReadSendReadback(pixels, glFormat, bInvert, pFrame);
+}
+
 
 //
 // Data sharing
@@ -315,6 +390,72 @@ int SpoutSender::GetMemoryBufferSize(const char* name)
 	return spout.GetMemoryBufferSize(name);
 }
 
+//---------------------------------------------------------
+bool SpoutSender::CreateDataChannel(const char* name, int length)
+{
+	return spout.CreateDataChannel(name, length);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::WriteDataChannel(const char* name, const char* data, int length)
+{
+	return spout.WriteDataChannel(name, data, length);
+}
+
+//---------------------------------------------------------
+void SpoutSender::CloseDataChannel(const char* name)
+{
+	spout.CloseDataChannel(name);
+}
+
+//---------------------------------------------------------
+void SpoutSender::SetMemoryLargePages(bool bLarge)
+{
+	spout.SetMemoryLargePages(bLarge);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::GetMemoryLargePages()
+{
+	return spout.GetMemoryLargePages();
+}
+
+//---------------------------------------------------------
+void SpoutSender::SetMemoryCompression(bool bCompress)
+{
+	spout.SetMemoryCompression(bCompress);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::GetMemoryCompression()
+{
+	return spout.GetMemoryCompression();
+}
+
+//---------------------------------------------------------
+void SpoutSender::SetMemoryRingSend(bool bRing)
+{
+	spout.SetMemoryRingSend(bRing);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::GetMemoryRingSend()
+{
+	return spout.GetMemoryRingSend();
+}
+
+//---------------------------------------------------------
+bool SpoutSender::CreateFrameData(int maxlength)
+{
+	return spout.CreateFrameData(maxlength);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::WriteFrameData(const char* data, int length)
+{
+	return spout.WriteFrameData(data, length);
+}
+
 
 //
 // OpenGL shared texture access
@@ -372,6 +513,18 @@ bool SpoutSender::IsGLDXready()
 	return spout.IsGLDXready();
 }
 
+//---------------------------------------------------------
+void SpoutSender::SetSharedInterop(bool bShared)
+{
+	spout.SetSharedInterop(bShared);
+}
+
+//---------------------------------------------------------
+bool SpoutSender::GetSharedInterop()
+{
+	return spout.GetSharedInterop();
+}
+
 //
 // Sender names
 //
@@ -677,14 +830,21 @@ bool SpoutSender::CreateSender(const char* name, unsigned int width, unsigned in
 	return spout.CreateSender(name, width, height, dwFormat);
 }
 
+//---------------------------------------------------------
+// Function: PrepareSender
+// Create a sender and allocate resources used for sending
+bool SpoutSender::PrepareSender(const char* name, unsigned int width, unsigned int height, DWORD dwFormat)
+{
+	return spout.PrepareSender(name, width, height, dwFormat);
+}
+
 //---------------------------------------------------------
 bool SpoutSender::UpdateSender(const char* name, unsigned int width, unsigned int height)
 {
 	return spout.UpdateSender(name, width, height);
 }
 
-// Legacy OpenGL DrawTo function
-#ifdef legacyOpenGL
+// OpenGL DrawTo function
 
 //---------------------------------------------------------
 bool SpoutSender::DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget,
@@ -695,5 +855,4 @@ bool SpoutSender::DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget,
 	return spout.DrawToSharedTexture(TextureID, TextureTarget,
 		width, height, max_x, max_y, aspect, bInvert, HostFBO);
 
-}
-#endif
\ No newline at end of file
+}
\ No newline at end of file
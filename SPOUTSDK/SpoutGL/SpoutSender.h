@@ -44,6 +44,8 @@ class SPOUT_DLLEXP SpoutSender {
 	void SetSenderName(const char* sendername = nullptr);
 	// Set the sender DX11 shared texture format
 	void SetSenderFormat(DWORD dwFormat);
+	// Set the number of views of an array texture sender
+	void SetSenderArraySize(unsigned int arraysize);
 	// Close sender and free resources
 	//   A sender is created or updated by all sending functions
 	void ReleaseSender();
@@ -60,6 +62,18 @@ class SPOUT_DLLEXP SpoutSender {
 	bool SendTexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, bool bInvert = true, GLuint HostFBO = 0);
 	// Send image pixels
 	bool SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFBO = 0);
+	// Send image pixels with a line pitch including padding
+	bool SendImage(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int pitch, GLenum glFormat, bool bInvert = false, GLuint HostFBO = 0);
+	// Begin rendering directly to the shared texture
+	//   Returns a framebuffer with the shared texture attached, bound for draw.
+	//   The image is not inverted. Render with the Y axis flipped.
+	GLuint BeginFrame(unsigned int width, unsigned int height);
+	// Send the frame rendered after BeginFrame and bind the host framebuffer
+	bool EndFrame(GLuint HostFBO = 0);
+	// Create a sender and allocate resources used for sending
+	//   So that the first frame is sent as fast as any other.
+	//   An OpenGL context is required.
+	bool PrepareSender(const char* sendername, unsigned int width, unsigned int height, DWORD dwFormat = 0);
 	// Sender status
 	bool IsInitialized();
 	// Sender name
@@ -99,6 +113,18 @@ class SPOUT_DLLEXP SpoutSender {
 	void EnableFrameSync(bool bSync = true);
 	// Check for frame sync option
 	bool IsFrameSyncEnabled();
+	// Set the changed regions of the next frame sent
+	bool SetDirtyRects(const RECT* pRects, unsigned int nRects);
+	// Publish a GPU hash of the frame content with each frame
+	void EnableContentHash(bool bHash = true);
+	// Content hash option
+	bool IsContentHashEnabled();
+	// Read back the frames sent to CPU memory without waiting
+	void SetSendReadback(bool bReadback = true, SpoutReadbackCallback callback = nullptr, void* pUserData = nullptr);
+	// Read back option
+	bool GetSendReadback();
+	// Copy the latest frame read back to a pixel buffer of the sender size
+	bool ReadSendReadback(unsigned char* pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, LONG64* pFrame = nullptr);
 
 
 	//
@@ -113,6 +139,28 @@ class SPOUT_DLLEXP SpoutSender {
 	bool DeleteMemoryBuffer();
 	// Get the size of a shared memory buffer
 	int GetMemoryBufferSize(const char* name);
+	// Create a named data channel
+	bool CreateDataChannel(const char* name, int length);
+	// Write data to a named data channel
+	bool WriteDataChannel(const char* name, const char* data, int length);
+	// Close a named data channel
+	void CloseDataChannel(const char* name);
+	// Large pages for shared memory buffers
+	void SetMemoryLargePages(bool bLarge = true);
+	// Large pages enabled
+	bool GetMemoryLargePages();
+	// Lossless compression of memory share frames
+	void SetMemoryCompression(bool bCompress = true);
+	// Memory share compression enabled
+	bool GetMemoryCompression();
+	// Send frames through the memory ring instead of a shared texture
+	void SetMemoryRingSend(bool bRing = true);
+	// Memory ring send enabled
+	bool GetMemoryRingSend();
+	// Create a frame data buffer
+	bool CreateFrameData(int maxlength);
+	// Write data sent with the next frame
+	bool WriteFrameData(const char* data, int length);
 
 	//
 	// OpenGL shared texture access
@@ -141,6 +189,10 @@ class SPOUT_DLLEXP SpoutSender {
 
 	// OpenGL texture share compatibility
 	bool IsGLDXready();
+	// Share DirectX and GL/DX interop devices with other instances on the same OpenGL context
+	void SetSharedInterop(bool bShared = true);
+	// Shared interop devices enabled
+	bool GetSharedInterop();
 
 	//
 	// Sender names
@@ -223,10 +275,10 @@ class SPOUT_DLLEXP SpoutSender {
 	// Set user CPU mode
 	bool SetCPUmode(bool bCPU);
 	// Get user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	int GetShareMode();
 	// Set user share mode
-	//  0 - texture, 1 - memory, 2 - CPU
+	//  0 - texture, 1 - memory, 2 - CPU, 3 - auto by measured performance
 	void SetShareMode(int mode);
 
 	//
@@ -285,12 +337,11 @@ class SPOUT_DLLEXP SpoutSender {
 	// Update a sender
 	bool UpdateSender(const char* Sendername, unsigned int width, unsigned int height);
 
-	// Legacy OpenGL DrawTo function
-	// See _SpoutCommon.h_ #define legacyOpenGL
-#ifdef legacyOpenGL
+	// OpenGL DrawTo function
+	// Immediate mode if _SpoutCommon.h_ #define legacyOpenGL
+	// Otherwise core profile with a vertex array and shader program
 	// Render a texture to the shared texture. 
 	bool DrawToSharedTexture(GLuint TextureID, GLuint TextureTarget, unsigned int width, unsigned int height, float max_x = 1.0, float max_y = 1.0, float aspect = 1.0, bool bInvert = false, GLuint HostFBO = 0);
-#endif
 
 	// For access to all functions
 	Spout spout;
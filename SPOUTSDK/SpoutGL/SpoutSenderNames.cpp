@@ -104,6 +104,65 @@
 			   Remove unused d3d9.h and d3d11.h from header
 	16.12.23 - SetSenderInfo - correct buffer size for GetModuleFileNameA
 	Version 2.007.013
+	14.10.26 - Add sender name set generation map "SpoutSenderNamesGeneration"
+			   Writes to the sender set increment the generation before and after
+			   GetSenderSet - copy the names without the map mutex and retry
+			   if the generation changed. Re-use the parsed set if the names are unchanged.
+			 - Add sender change count to the generation map for receivers.
+			   Incremented by CreateSender, UpdateSender, SetActiveSender and sender name set writes.
+			   Add GetSenderGeneration, CheckSenderChange and WaitSenderChange.
+			 - Add optional cache of sender information maps for getSharedInfo
+			   SetSenderInfoCache / GetSenderInfoCache. CleanSenders does not use the cache.
+			 - Add SetSenderArraySize and GetSenderArraySize. The number of views of
+			   an array texture sender is recorded in the low byte of the usage field.
+			 - Add SetSenderMipLevels and GetSenderMipLevels. The number of mip levels
+			   is recorded in the second byte of the usage field.
+			 - Add sender name index map "SpoutSenderNamesIndex". An open addressing
+			   hash table of name slots used by RegisterSenderName, ReleaseSenderName
+			   and FindSenderName instead of parsing the whole name set.
+			 - Add sender name segments "SpoutSenderNames_1" etc. for names after
+			   a full sender names map. The number of segments is recorded in the
+			   generation map. Add GetSenderCapacity.
+			 - Add sender liveness following the information in the sender map.
+			   The sender process and a heartbeat are recorded by UpdateSender and
+			   SetSenderHeartbeat. CleanSenders removes senders with a closed process.
+			   Add IsSenderAlive, StartSenderCleanup and StopSenderCleanup.
+			 - Add process sender service StartSenderService, StopSenderService,
+			   IsSenderServiceRunning and GetSenderSnapshot. A thread cleans senders,
+			   validates the active sender and publishes a snapshot of the senders
+			   used by GetSenderCount, GetSender, GetSenderNameInfo and GetActiveSender.
+			 - Add GetSenderList for the details of all senders in one call.
+			   Add SetSenderAdapterLuid and GetSenderAdapterLuid.
+			   Liveness of a sender map opened by another process is not limited by
+			   the map size, which is not known for an opened map.
+	15.10.26 - Add SetSenderNTHandle and GetSenderNTHandle. A sender texture shared
+			   by a named NT handle is recorded in the third byte of the usage field.
+			 - Cleanup and service threads use the housekeeping thread settings
+			   (spoututils::BeginSpoutThread)
+			 - Add a sender information change count to the liveness block in place
+			   of the reserved field. Incremented by SetSenderInfo and setSharedInfo.
+			   Add CheckSenderInfoChange and CloseSenderInfoChange for receivers.
+			 - Add GetSenderNames to copy the names to a caller buffer without allocation.
+			   GetSender and GetSenderNameInfo index the name set cache
+			   instead of copying the set for every call.
+			 - Add 64 bit sender IDs assigned when the sender information map
+			   is created and recorded after the liveness block. A table of IDs
+			   "SpoutSenderUIDs" is written with the name set.
+			   Add GetSenderUID, FindSenderUID, GetSenderUIDInfo and CloseSenderUIDInfo.
+			 - RegisterSenderName, ReleaseSenderName and FindSenderName search
+			   the name slots within the map lock if a name is not in the index,
+			   which applications of earlier versions do not update.
+			 - Add a name set checksum to the generation map. The set is read without
+			   the map mutex only if the copy has the checksum recorded with the
+			   generation, and otherwise within the mutex, because applications
+			   of earlier versions change the set without the generation.
+			 - readSharedInfo - the information change count is odd while
+			   SetSenderInfo and setSharedInfo write. A copy without the map mutex
+			   is used if the count is even and unchanged, in place of comparing
+			   two copies.
+			 - Add checkSenderSegments. Names in the segments are moved back to the
+			   sender names map if an application of an earlier version has
+			   released a name and written the map compact without them.
 
 	- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 	Copyright (c) 2014-2024, Lynn Jarvis. All rights reserved.
@@ -131,6 +190,7 @@
 
 */
 #include "SpoutSenderNames.h"
+#include "SpoutFrameCount.h" // for SpoutFrameInfo
 #include <assert.h>
 
 //
@@ -141,9 +201,39 @@
 // Refer to source code for documentation.
 //
 
+// Process sender service (StartSenderService)
+static SRWLOCK g_ServiceLock = SRWLOCK_INIT; // snapshot
+static SRWLOCK g_ServiceStartLock = SRWLOCK_INIT; // start and stop
+static HANDLE g_hServiceThread = NULL;
+static HANDLE g_hServiceStop = NULL;
+static LONG g_ServiceUsers = 0;
+static DWORD g_dwServiceInterval = 100;
+static bool g_bSnapshot = false; // snapshot published
+static std::vector<SpoutSenderSnapshotEntry>* g_pSnapshot = nullptr;
+static char g_SnapshotActive[SpoutMaxSenderNameLen]={};
+
+// Sender ID table (FindSenderUID)
+static SRWLOCK g_SenderUIDLock = SRWLOCK_INIT;
+static SpoutSharedMemory g_SenderUIDs;
+
+// Order of the sender name set for GetSenderNames
+static int compareSenderNames(const void* a, const void* b)
+{
+	return strcmp(static_cast<const char*>(a), static_cast<const char*>(b));
+}
+
 spoutSenderNames::spoutSenderNames() {
 
 	m_senders = new std::unordered_map<std::string, SpoutSharedMemory*>();
+	m_pNamesCache = new std::vector<char>();
+	m_pSetCache = new std::set<std::string>();
+	m_pNamesRead = new std::vector<char>();
+	m_pInfoCache = new std::unordered_map<std::string, SpoutSharedMemory*>();
+	m_pUIDCache = new std::unordered_map<uint64_t, SpoutSharedMemory*>();
+	m_bInfoCache = false;
+	m_InfoGeneration = 0;
+	m_dwInfoTime = 0;
+	m_InfoChangeName[0] = 0;
 
 	// 15.09.18 - moved from interop class
 	// 06.06.19 - increase default maximum number of senders from 10 to 256
@@ -154,15 +244,29 @@ spoutSenderNames::spoutSenderNames() {
 	// If the registry read fails, the default will be used
 	m_MaxSenders = (int)dwSenders;
 
+	m_HeartbeatTime = 0;
+	m_hCleanupThread = NULL;
+	m_hCleanupStop = NULL;
+	m_dwCleanupInterval = 1000;
+
 }
 
 spoutSenderNames::~spoutSenderNames() {
 
+	StopSenderCleanup();
+
 	for (auto itr = m_senders->begin(); itr != m_senders->end(); itr++)
 	{
 		delete itr->second;
 	}
 	delete m_senders;
+	delete m_pNamesCache;
+	delete m_pSetCache;
+	delete m_pNamesRead;
+	clearInfoCache();
+	delete m_pInfoCache;
+	CloseSenderUIDInfo();
+	delete m_pUIDCache;
 
 }
 
@@ -180,6 +284,9 @@ bool spoutSenderNames::RegisterSenderName(const char* Sendername) {
 	std::pair<std::set<std::string>::iterator, bool> ret;
 	std::set<std::string> SenderNames; // set of names
 
+	if (!Sendername || !Sendername[0])
+		return false;
+
 	// Create the shared memory for the sender name set if it does not exist
 	if (!CreateSenderSet()) {
 		return false;
@@ -188,13 +295,47 @@ bool spoutSenderNames::RegisterSenderName(const char* Sendername) {
 	char *pBuf = m_senderNames.Lock();
 	if (!pBuf) return false;
 
+	// Add the name after the last using the name index if available
+	if (checkSenderNameIndex()) {
+		SenderNameIndex* pIndex = getSenderNameIndex();
+		const uint32_t hash = hashSenderName(Sendername);
+		if (findSenderSlot(Sendername, hash) >= 0) {
+			// See if there are any dangling entries that aren't valid anymore
+			cleanSenderSet();
+			if (!checkSenderNameIndex() || findSenderSlot(Sendername, hash) >= 0) {
+				m_senderNames.Unlock();
+				return false;
+			}
+		}
+		// A full sender names map continues in a segment
+		const int slot = (int)pIndex->count;
+		char* pSlot = getSenderSlot(slot, true);
+		if (!pSlot) {
+			SpoutLogWarning("spoutSenderNames::RegisterSenderName - Sender exceeds max senders (%d)\n", getMaxSenderSlots());
+			m_senderNames.Unlock();
+			return true;
+		}
+		beginSenderSetWrite();
+		strcpy_s(pSlot, SpoutMaxSenderNameLen, Sendername);
+		// Terminate the list
+		char* pNext = getSenderSlot(slot+1);
+		if (pNext) *pNext = 0;
+		endSenderSetWrite();
+		insertSenderNameIndex(hash, slot);
+		pIndex->count++;
+		InterlockedExchange(&pIndex->names, getSenderSetGeneration()->names);
+		SetActiveSender(Sendername);
+		m_senderNames.Unlock();
+		return true;
+	}
+
 	// Register the sender name in the list of spout senders
-	readSenderSetFromBuffer(pBuf, SenderNames, m_MaxSenders);
+	readSenderSet(pBuf, SenderNames);
 
 	// Check whether the sender registration will exceed the maximum number of senders
 	// If this fails, just skip the registration
-	if ((int)SenderNames.size() == m_MaxSenders) {
-		SpoutLogWarning("spoutSenderNames::RegisterSenderName - Sender exceeds max senders (%d)\n", m_MaxSenders);
+	if ((int)SenderNames.size() >= getMaxSenderSlots()) {
+		SpoutLogWarning("spoutSenderNames::RegisterSenderName - Sender exceeds max senders (%d)\n", getMaxSenderSlots());
 		m_senderNames.Unlock();
 		return true;
 	}
@@ -207,13 +348,13 @@ bool spoutSenderNames::RegisterSenderName(const char* Sendername) {
 	if(!ret.second) {
 		// See if there are any dangling entries that aren't valid anymore
 		cleanSenderSet();
-		readSenderSetFromBuffer(pBuf, SenderNames, m_MaxSenders);
+		readSenderSet(pBuf, SenderNames);
 		ret = SenderNames.insert(Sendername);
 	}
 
 	if(ret.second) {
 		// write the new map to shared memory
-		writeBufferFromSenderSet(SenderNames, pBuf, m_MaxSenders);
+		writeSenderSet(SenderNames, pBuf);
 		// Set the current sender name as active.
 		// The active sender is the one selected by the user or the last one 
 		// opened by the user, so don't limit to the first sender in the list.
@@ -244,6 +385,8 @@ bool spoutSenderNames::ReleaseSenderName(const char* Sendername)
 	char *pBuf = m_senderNames.Lock();
 	if (!pBuf) return false;
 
+	releaseSenderUID(Sendername);
+
 	const auto foundSender = m_senders->find(Sendername);
 	if (foundSender != m_senders->end()) {
 		// This also deletes the sender shared memory
@@ -251,8 +394,48 @@ bool spoutSenderNames::ReleaseSenderName(const char* Sendername)
 		m_senders->erase(Sendername);
 	}
 
+	// Replace the name with the last using the name index if available
+	if (checkSenderNameIndex()) {
+		SenderNameIndex* pIndex = getSenderNameIndex();
+		SenderNameIndexEntry* pEntries = getSenderNameEntries();
+		int entry = -1;
+		const int slot = findSenderSlot(Sendername, hashSenderName(Sendername), &entry);
+		char* pLast = getSenderSlot((int)pIndex->count-1);
+		if (slot < 0 || !pLast) {
+			m_senderNames.Unlock();
+			return false;
+		}
+		const int last = (int)pIndex->count-1;
+		int lastentry = -1;
+		if (slot != last) {
+			strcpy_s(name, SpoutMaxSenderNameLen, pLast);
+			findSenderNameSlot(name, hashSenderName(name), &lastentry);
+		}
+		beginSenderSetWrite();
+		if (slot != last)
+			memcpy(getSenderSlot(slot), pLast, SpoutMaxSenderNameLen);
+		*pLast = 0;
+		endSenderSetWrite();
+		pEntries[entry].slot = SPOUT_NAMEINDEX_DELETED;
+		pIndex->deleted++;
+		if (lastentry >= 0)
+			pEntries[lastentry].slot = slot;
+		pIndex->count--;
+		InterlockedExchange(&pIndex->names, getSenderSetGeneration()->names);
+		// Was it the active sender ?
+		if (pIndex->count > 0) {
+			if ((getActiveSenderName(&name[0]) && strcmp(&name[0], &Sendername[0]) == 0) || pIndex->count == 1) {
+				// It was, so make the first in the list active instead
+				strcpy_s(name, SpoutMaxSenderNameLen, pBuf);
+				setActiveSenderName(&name[0]);
+			}
+		}
+		m_senderNames.Unlock();
+		return true;
+	}
+
 	// Read the buffer to a set to iterate through the names
-	readSenderSetFromBuffer(pBuf, SenderNames, m_MaxSenders);
+	readSenderSet(pBuf, SenderNames);
 
 	// Discovered that the project properties had been set to CLI
 	// Properties -> General -> Common Language Runtime Support
@@ -263,7 +446,7 @@ bool spoutSenderNames::ReleaseSenderName(const char* Sendername)
 	if(SenderNames.find(Sendername) != SenderNames.end() ) {
 		SenderNames.erase(Sendername);
 		// Write the sender names back to the buffer
-		writeBufferFromSenderSet(SenderNames, pBuf, m_MaxSenders);
+		writeSenderSet(SenderNames, pBuf);
 		// Is there a set left ?
 		if(SenderNames.size() > 0) {
 			// Was it the active sender ?
@@ -294,6 +477,19 @@ bool spoutSenderNames::FindSenderName(const char* Sendername)
 	if (!Sendername)
 		return false;
 
+	// Find the name from the name index without the map lock.
+	// A name not in the index is searched within the lock, because
+	// applications of earlier versions do not update the index.
+	if (CreateSenderSet()) {
+		if (findSenderNameNoLock(Sendername) > 0)
+			return true;
+		if (!m_senderNames.Lock())
+			return false;
+		const bool bFound = (scanSenderNameSlot(Sendername) >= 0);
+		m_senderNames.Unlock();
+		return bFound;
+	}
+
 	std::string namestring = "";
 	std::set<std::string> SenderNames;
 	// Get the current list to update the passed list
@@ -307,6 +503,168 @@ bool spoutSenderNames::FindSenderName(const char* Sendername)
 	return false;
 }
 
+// ===============================================================================
+//	Sender IDs
+//
+//	A sender is assigned a 64 bit ID when its information map is created.
+//	The ID is recorded in the information map and in the "SpoutSenderUIDs"
+//	table with the sender name. A receiver can get the ID of a sender once
+//	and then find the sender and read its information by ID without names.
+//	The ID is removed from the table when the sender is released, and a
+//	sender created again with the same name has a new ID.
+//	Senders of earlier versions do not have an ID.
+// ===============================================================================
+
+//---------------------------------------------------------
+// Function: GetSenderUID
+// ID of a sender.
+//    Returns zero if the sender is not found,
+//    or is an earlier version without an ID.
+uint64_t spoutSenderNames::GetSenderUID(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return 0;
+
+	// A sender of this process
+	const auto foundSender = m_senders->find(sendername);
+	if (foundSender != m_senders->end()) {
+		const SharedSenderUID* pUID = getSharedSenderUID(foundSender->second);
+		return pUID ? (uint64_t)pUID->uid : 0;
+	}
+
+	SpoutSharedMemory mem;
+	if (!mem.Open(sendername))
+		return 0;
+
+	const SharedSenderUID* pUID = getSharedSenderUID(&mem);
+	if (!pUID)
+		return 0;
+
+	// The map could remain open after the sender has been released
+	const uint64_t uid = (uint64_t)pUID->uid;
+	if (uid == SPOUT_SENDERUID_EMPTY || !FindSenderUID(uid))
+		return 0;
+
+	return uid;
+}
+
+//---------------------------------------------------------
+// Function: FindSenderUID
+// Find a sender by ID.
+//    sendername - optional, receives the sender name
+//    maxlength  - size of the name buffer
+//
+// The table is read without the sender names map lock.
+// IDs are compared and the name is only copied if requested.
+bool spoutSenderNames::FindSenderUID(uint64_t uid, char* sendername, int maxlength)
+{
+	if (uid == SPOUT_SENDERUID_EMPTY || uid == SPOUT_SENDERUID_DELETED)
+		return false;
+
+	SenderUIDTable* pTable = getSenderUIDTable();
+	SenderUIDEntry* pEntries = getSenderUIDEntries(pTable);
+	if (!pEntries)
+		return false;
+
+	char name[SpoutMaxSenderNameLen]={};
+	const uint32_t mask = pTable->capacity-1;
+
+	// Try again if the table is rebuilt meanwhile
+	for (int i = 0; i < 4; i++) {
+		const LONG write = InterlockedCompareExchange(&pTable->write, 0, 0);
+		if (write & 1) {
+			YieldProcessor();
+			continue;
+		}
+		bool bFound = false;
+		for (uint32_t j = 0; j < pTable->capacity; j++) {
+			SenderUIDEntry* pEntry = &pEntries[(uint32_t)(uid + j) & mask];
+			const uint64_t entry = (uint64_t)InterlockedCompareExchange64(&pEntry->uid, 0, 0);
+			if (entry == SPOUT_SENDERUID_EMPTY)
+				break;
+			if (entry == uid) {
+				if (sendername) {
+					memcpy(name, pEntry->name, SpoutMaxSenderNameLen);
+					MemoryBarrier();
+					// Released while the name was copied
+					if ((uint64_t)InterlockedCompareExchange64(&pEntry->uid, 0, 0) != uid)
+						break;
+				}
+				bFound = true;
+				break;
+			}
+		}
+		MemoryBarrier();
+		if (InterlockedCompareExchange(&pTable->write, 0, 0) != write)
+			continue;
+		if (bFound && sendername) {
+			name[SpoutMaxSenderNameLen-1] = 0;
+			strncpy_s(sendername, maxlength, name, _TRUNCATE);
+		}
+		return bFound;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderUIDInfo
+// Sender information by ID.
+//
+// The sender information map is opened by the first call
+// and retained for subsequent calls. The ID is checked in the
+// table for every call, so that a sender that has been released
+// is not returned, and the map is closed.
+// Returns false if the sender is not found.
+bool spoutSenderNames::GetSenderUIDInfo(uint64_t uid, SharedTextureInfo* info)
+{
+	if (!info)
+		return false;
+
+	const auto itr = m_pUIDCache->find(uid);
+	if (!FindSenderUID(uid)) {
+		if (itr != m_pUIDCache->end()) {
+			delete itr->second;
+			m_pUIDCache->erase(itr);
+		}
+		return false;
+	}
+
+	SpoutSharedMemory* mem = nullptr;
+	if (itr != m_pUIDCache->end()) {
+		mem = itr->second;
+	}
+	else {
+		char name[SpoutMaxSenderNameLen]={};
+		if (!FindSenderUID(uid, name))
+			return false;
+		mem = new SpoutSharedMemory();
+		const SharedSenderUID* pUID = nullptr;
+		if (mem->Open(name))
+			pUID = getSharedSenderUID(mem);
+		if (!pUID || (uint64_t)pUID->uid != uid) {
+			delete mem;
+			return false;
+		}
+		(*m_pUIDCache)[uid] = mem;
+	}
+
+	return readSharedInfo(mem, info);
+}
+
+//---------------------------------------------------------
+// Function: CloseSenderUIDInfo
+// Close sender information maps retained by GetSenderUIDInfo
+void spoutSenderNames::CloseSenderUIDInfo()
+{
+	if (!m_pUIDCache)
+		return;
+	for (auto itr = m_pUIDCache->begin(); itr != m_pUIDCache->end(); itr++) {
+		delete itr->second;
+	}
+	m_pUIDCache->clear();
+}
+
 //---------------------------------------------------------
 // Function: cleanSenderSet
 // Go through the full list of sender names and clean up
@@ -324,7 +682,7 @@ void spoutSenderNames::cleanSenderSet()
 	}
 
 	std::set<std::string> SenderNames;
-	readSenderSetFromBuffer(pBuf, SenderNames, m_MaxSenders);
+	readSenderSet(pBuf, SenderNames);
 
 	bool changed = false;
 
@@ -342,6 +700,7 @@ void spoutSenderNames::cleanSenderSet()
 		if (!mem.Open((*itr).c_str()))
 		{
 			changed = true;
+			releaseSenderUID((*itr).c_str());
 			SenderNames.erase(itr++);
 		}
 		else
@@ -353,7 +712,7 @@ void spoutSenderNames::cleanSenderSet()
 
 	if (changed)
 	{
-		writeBufferFromSenderSet(SenderNames, pBuf, m_MaxSenders);
+		writeSenderSet(SenderNames, pBuf);
 	}
 
 	m_senderNames.Unlock();
@@ -376,11 +735,59 @@ bool spoutSenderNames::GetSenderNames(std::set<std::string> *Sendernames)
 	return false;
 }
 
+//---------------------------------------------------------
+// Function: GetSenderNames
+// Copy the sender names to a buffer without allocation.
+//
+//    names      - buffer of maxsenders names, each of maxlength bytes
+//    maxlength  - bytes for each name, longer names are truncated
+//
+//    The names are in the same order as GetSender.
+//    Returns the number of names copied, or the number
+//    of senders if names is null.
+//    Suitable for a sender list that is updated every frame.
+int spoutSenderNames::GetSenderNames(char* names, int maxsenders, int maxlength)
+{
+	if (names && (maxsenders <= 0 || maxlength <= 0))
+		return 0;
+
+	// Snapshot of the sender service if running
+	int count = 0;
+	if (getSnapshotNames(names, maxsenders, maxlength, count))
+		return count;
+
+	if (!CreateSenderSet())
+		return 0;
+
+	// Read without locking if possible
+	count = readSenderNamesNoLock(names, maxsenders, maxlength);
+	if (count < 0) {
+		if (!m_senderNames.Lock())
+			return 0;
+		checkSenderSegments();
+		uint32_t checksum = 0;
+		count = copySenderNames(names, maxsenders, maxlength, &checksum);
+		setSenderSetChecksum((LONG)checksum);
+		m_senderNames.Unlock();
+	}
+
+	// Sort in the order of the sender name set
+	if (names && count > 1)
+		qsort(names, (size_t)count, (size_t)maxlength, compareSenderNames);
+
+	return count;
+}
+
 //---------------------------------------------------------
 // Function: GetSenderCount
 // Number of senders in the list
 int spoutSenderNames::GetSenderCount() {
 
+	// Snapshot of the sender service if running
+	int count = 0;
+	if (getSnapshotCount(count))
+		return count;
+
 	std::set<std::string> SenderSet;
 	std::set<std::string>::iterator iter;
 	std::string namestring;
@@ -436,27 +843,22 @@ int spoutSenderNames::GetSenderCount() {
 // Sender item name
 bool spoutSenderNames::GetSender(int index, char* sendername, int sendernameMaxSize)
 {
-	std::set<std::string> SenderNameSet;
-	std::set<std::string>::iterator iter;
-	std::string namestring;
-	int i = 0;
-
-	if (GetSenderNames(&SenderNameSet)) {
-		if (SenderNameSet.size() < (unsigned int)index) {
-			return false;
-		}
-		i = 0;
-		for (iter = SenderNameSet.begin(); iter != SenderNameSet.end(); iter++) {
-			namestring = *iter; // the name string
-			if (i == index) {
-				strcpy_s(sendername, sendernameMaxSize, namestring.c_str());
-				break;
-			}
-			i++;
-		}
+	// Snapshot of the sender service if running
+	if (getSnapshotSender(index, sendername, sendernameMaxSize, nullptr))
 		return true;
-	}
-	return false;
+
+	// The name set cache is parsed again only if the names have changed
+	if (index < 0 || !updateSenderSetCache())
+		return false;
+
+	if ((unsigned int)index >= m_pSetCache->size())
+		return false;
+
+	std::set<std::string>::const_iterator iter = m_pSetCache->begin();
+	std::advance(iter, index);
+	strcpy_s(sendername, sendernameMaxSize, iter->c_str());
+
+	return true;
 
 }
 
@@ -474,32 +876,32 @@ bool spoutSenderNames::GetSender(int index, char* sendername, int sendernameMaxS
 //
 bool spoutSenderNames::GetSenderNameInfo(int index, char* sendername, int sendernameMaxSize, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle)
 {
-	std::set<std::string> SenderNameSet;
-	std::set<std::string>::iterator iter;
-	std::string namestring;
-	int i = 0;
 	DWORD format = 0;
 
-	if(GetSenderNames(&SenderNameSet)) {
-		if(SenderNameSet.size() < (unsigned int)index)
-			return false;
+	// Snapshot of the sender service if running
+	SharedTextureInfo info={};
+	if (getSnapshotSender(index, sendername, sendernameMaxSize, &info)) {
+		width = info.width;
+		height = info.height;
+		dxShareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
+		return true;
+	}
 
-		i = 0;
-		for(iter = SenderNameSet.begin(); iter != SenderNameSet.end(); iter++) {
-			namestring = *iter; // he 256 byte name string
-			if(i == index) {
-				strcpy_s(sendername, (rsize_t)sendernameMaxSize, namestring.c_str()); // return the name
-				break;
-			}
-			i++;
-		}
-		
-		// Does the retrieved sender exist or has it crashed?
-		// Find out by getting the sender info and returning it
-		if(GetSenderInfo(sendername, width, height, dxShareHandle, format))
-			return true;
+	// The name set cache is parsed again only if the names have changed
+	if (index < 0 || !updateSenderSetCache())
+		return false;
 
-	}
+	if ((unsigned int)index >= m_pSetCache->size())
+		return false;
+
+	std::set<std::string>::const_iterator iter = m_pSetCache->begin();
+	std::advance(iter, index);
+	strcpy_s(sendername, (rsize_t)sendernameMaxSize, iter->c_str()); // return the name
+
+	// Does the retrieved sender exist or has it crashed?
+	// Find out by getting the sender info and returning it
+	if(GetSenderInfo(sendername, width, height, dxShareHandle, format))
+		return true;
 
 	return false;
 
@@ -523,6 +925,114 @@ int spoutSenderNames::GetMaxSenders()
 	return m_MaxSenders;
 }
 
+//---------------------------------------------------------
+// Function: GetSenderCapacity
+// Number of senders that can be registered.
+//
+// The sender names map and all the segments that can follow it.
+// Independent of the maximum set by other applications.
+int spoutSenderNames::GetSenderCapacity()
+{
+	if (!CreateSenderSet())
+		return 0;
+	return getMaxSenderSlots();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderList
+// Details of all senders in one call.
+//
+//    pSenders - array of maxsenders entries to receive the details
+//
+//    Returns the number of senders copied, or the number
+//    of senders if pSenders is null.
+//    The names are read again if senders change while the
+//    details are read, so that the list is one sender set.
+int spoutSenderNames::GetSenderList(SpoutSenderDetails* pSenders, int maxsenders)
+{
+	std::set<std::string> SenderSet;
+	int count = 0;
+
+	for (int i = 0; i < 3; i++) {
+
+		const LONG generation = GetSenderGeneration();
+		if (!GetSenderNames(&SenderSet))
+			return 0;
+
+		if (!pSenders || maxsenders <= 0)
+			return (int)SenderSet.size();
+
+		count = 0;
+		for (auto iter = SenderSet.begin(); iter != SenderSet.end() && count < maxsenders; iter++) {
+			if (readSenderDetails(iter->c_str(), pSenders[count]))
+				count++;
+		}
+
+		// Zero for senders of earlier versions
+		if (GetSenderGeneration() == generation)
+			break;
+	}
+
+	return count;
+
+} // end GetSenderList
+
+// Sender information, adapter, frame and frame rate
+bool spoutSenderNames::readSenderDetails(const char* sendername, SpoutSenderDetails &details)
+{
+	ZeroMemory(&details, sizeof(SpoutSenderDetails));
+
+	SpoutSharedMemory mem;
+	if (!mem.Open(sendername))
+		return false;
+
+	SharedTextureInfo info={};
+	const char* pBuf = mem.Lock();
+	if (!pBuf)
+		return false;
+	__movsd((unsigned long *)&info, (unsigned long const *)pBuf, sizeof(SharedTextureInfo) / 4);
+	const SharedSenderAlive* pAlive = getSenderAlive(&mem);
+	if (pAlive)
+		details.adapter = pAlive->adapter;
+	mem.Unlock();
+
+	strcpy_s(details.name, SpoutMaxSenderNameLen, sendername);
+	details.width  = (unsigned int)info.width;
+	details.height = (unsigned int)info.height;
+	details.format = (DWORD)info.format;
+#if defined _M_X64 || defined _M_ARM64
+	details.shareHandle = (HANDLE)(LongToHandle((long)info.shareHandle));
+#else
+	details.shareHandle = (HANDLE)info.shareHandle;
+#endif
+	// The path is saved as byte chars
+	memcpy(details.hostpath, info.description, 256);
+	details.hostpath[255] = 0;
+
+	// Shared frame counter of senders with frame counting enabled
+	std::string mapname = sendername;
+	mapname += "_SpoutFrame";
+	SpoutSharedMemory framemem;
+	if (framemem.Open(mapname.c_str()) && framemem.Buffer()) {
+		const SpoutFrameInfo* pInfo = reinterpret_cast<const SpoutFrameInfo*>(framemem.Buffer());
+		for (int i = 0; i < 4; i++) {
+			const LONG lock = InterlockedCompareExchange((volatile LONG*)&pInfo->lock, 0, 0);
+			if ((lock & 1) == 0) {
+				const LONG64 frame = pInfo->frame;
+				if (InterlockedCompareExchange((volatile LONG*)&pInfo->lock, 0, 0) == lock) {
+					details.frame = frame;
+					break;
+				}
+			}
+			YieldProcessor();
+		}
+		if (pInfo->size >= offsetof(SpoutFrameInfo, fps)+sizeof(double))
+			details.fps = pInfo->fps;
+	}
+
+	return true;
+}
+
 //---------------------------------------------------------
 // Function: GetSenderInfo
 // Retrieves the info from the requested sender.
@@ -615,8 +1125,12 @@ bool spoutSenderNames::SetSenderInfo(const char* sendername, unsigned int width,
 	memcpy(&info.description[0], &exepath[0], 256); // wchar 128
 
 	// Set data to the memory map
+	beginSenderInfoChange(senderInfoMap);
 	__movsd((unsigned long *)pBuf, (unsigned long const *)&info, sizeof(SharedTextureInfo) / 4); // 280 bytes
 
+	// Let a connected receiver know
+	setSenderInfoChange(senderInfoMap);
+
 	senderInfoMap->Unlock();
 	
 	return true;
@@ -667,67 +1181,232 @@ bool spoutSenderNames::SetSenderID(const char *sendername, bool bCPU, bool bGLDX
 	return false;
 }
 
-//
-// Active Sender
-//
-// Functions to set or get the active Sender name.
-// The "active" Sender is the one of the multiple Senders
-// that is top of the list or is the one selected by the user from this list. 
-// This active Sender information is saved in a separated shared
-// memory from other Senders, identified by the name "ActiveSenderName"
-// so it can be recalled at any time by clients if the user
-// has selected a required Sender from a dialog or executable.
-// The dialog or executable sets the info of the selected Sender
-// into the ActiveSender shared memory so the clients can picks it up.
-// !!! The active Sender has to be a member of the Sender list !!!
-
 //---------------------------------------------------------
-// Function: SetActiveSender
-// Set the active sender, the first retrieved by a receiver
-bool spoutSenderNames::SetActiveSender(const char *Sendername)
+// Function: SetSenderArraySize
+// Set the number of views of an array texture sender
+// to the low byte of the usage field in sender shared memory.
+// SetSenderInfo clears the usage field, so a sender sets this
+// after CreateSender and UpdateSender.
+bool spoutSenderNames::SetSenderArraySize(const char *sendername, unsigned int arraysize)
 {
-	std::set<std::string> SenderNames;
-
-	if (!Sendername)
-		return false;
+	SharedTextureInfo info;
 
-	if (!CreateSenderSet())	{
-		return false;
+	if (getSharedInfo(sendername, &info)) {
+		if (arraysize > SPOUT_USAGE_ARRAY_MASK)
+			arraysize = SPOUT_USAGE_ARRAY_MASK;
+		info.usage = (info.usage & ~SPOUT_USAGE_ARRAY_MASK) | (arraysize > 1 ? arraysize : 0);
+		setSharedInfo(sendername, &info);
+		return true;
 	}
 
-	// Keep the sender set locked for this entire operation
-	if (!m_senderNames.Lock())
-	{
-		return false;
-	}
+	return false;
+}
 
-	// Get the current list to check whether the passed name is in it
-	if(GetSenderSet(SenderNames)) {
-		if(SenderNames.find(Sendername) != SenderNames.end() ) {
-			if(setActiveSenderName(Sendername)) { // set the active Sender name to shared memory
-				m_senderNames.Unlock();
-				return true;
-			}
-		}
-	}
+//---------------------------------------------------------
+// Function: GetSenderArraySize
+// Number of views of the sender texture.
+// 1 for a single texture or senders of earlier versions.
+unsigned int spoutSenderNames::GetSenderArraySize(const char *sendername)
+{
+	SharedTextureInfo info;
 
-	m_senderNames.Unlock();
-	return false;
+	if (getSharedInfo(sendername, &info)) {
+		const unsigned int arraysize = (info.usage & SPOUT_USAGE_ARRAY_MASK);
+		if (arraysize > 1)
+			return arraysize;
+	}
 
-} // end SetActiveSender
+	return 1;
+}
 
 //---------------------------------------------------------
-// Function: GetActiveSender
-// Retrieve the current active Sender name
-bool spoutSenderNames::GetActiveSender(char *Sendername, const int maxlength)
+// Function: SetSenderMipLevels
+// Set the number of mip levels of the sender texture
+// to the second byte of the usage field in sender shared memory.
+// As for SetSenderArraySize, a sender sets this after
+// CreateSender and UpdateSender.
+bool spoutSenderNames::SetSenderMipLevels(const char *sendername, unsigned int miplevels)
 {
-	if (!Sendername)
-		return false;
+	SharedTextureInfo info;
+
+	if (getSharedInfo(sendername, &info)) {
+		if (miplevels > (SPOUT_USAGE_MIPS_MASK >> SPOUT_USAGE_MIPS_SHIFT))
+			miplevels = (SPOUT_USAGE_MIPS_MASK >> SPOUT_USAGE_MIPS_SHIFT);
+		info.usage &= ~SPOUT_USAGE_MIPS_MASK;
+		if (miplevels > 1)
+			info.usage |= (miplevels << SPOUT_USAGE_MIPS_SHIFT);
+		setSharedInfo(sendername, &info);
+		return true;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderMipLevels
+// Number of mip levels of the sender texture.
+// 1 without a mip chain or for senders of earlier versions.
+unsigned int spoutSenderNames::GetSenderMipLevels(const char *sendername)
+{
+	SharedTextureInfo info;
+
+	if (getSharedInfo(sendername, &info)) {
+		const unsigned int miplevels = (info.usage & SPOUT_USAGE_MIPS_MASK) >> SPOUT_USAGE_MIPS_SHIFT;
+		if (miplevels > 1)
+			return miplevels;
+	}
+
+	return 1;
+}
+
+//---------------------------------------------------------
+// Function: SetSenderNTHandle
+// Record that the sender texture is shared by a named NT handle
+// in the usage field of sender shared memory. The shareHandle
+// field is then the identifier of the texture name.
+// As for SetSenderArraySize, a sender sets this after
+// CreateSender and UpdateSender.
+bool spoutSenderNames::SetSenderNTHandle(const char *sendername, bool bNThandle)
+{
+	SharedTextureInfo info;
+
+	if (getSharedInfo(sendername, &info)) {
+		if (bNThandle)
+			info.usage |= SPOUT_USAGE_NTHANDLE;
+		else
+			info.usage &= ~SPOUT_USAGE_NTHANDLE;
+		setSharedInfo(sendername, &info);
+		return true;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderNTHandle
+// Sender texture shared by a named NT handle.
+// False for a legacy share handle or senders of earlier versions.
+bool spoutSenderNames::GetSenderNTHandle(const char *sendername)
+{
+	SharedTextureInfo info;
+
+	if (getSharedInfo(sendername, &info))
+		return ((info.usage & SPOUT_USAGE_NTHANDLE) != 0);
+
+	return false;
+}
+
+//---------------------------------------------------------
+// Function: SetSenderAdapterLuid
+// Record the adapter of the sender texture
+// following the sender information.
+// For a sender created by this object.
+bool spoutSenderNames::SetSenderAdapterLuid(const char *sendername, LUID luid)
+{
+	if (!sendername)
+		return false;
+
+	const auto foundSender = m_senders->find(sendername);
+	if (foundSender == m_senders->end() || !foundSender->second)
+		return false;
+
+	SharedSenderAlive* pAlive = getSenderAlive(foundSender->second);
+	if (!pAlive)
+		return false;
+
+	pAlive->adapter = luid;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderAdapterLuid
+// Adapter of the sender texture.
+// Returns false if the sender has not recorded it.
+bool spoutSenderNames::GetSenderAdapterLuid(const char *sendername, LUID &luid)
+{
+	if (!sendername || !*sendername)
+		return false;
+
+	SpoutSharedMemory mem;
+	if (!mem.Open(sendername))
+		return false;
+
+	const SharedSenderAlive* pAlive = getSenderAlive(&mem);
+	if (!pAlive || (pAlive->adapter.LowPart == 0 && pAlive->adapter.HighPart == 0))
+		return false;
+
+	luid = pAlive->adapter;
+
+	return true;
+}
+
+//
+// Active Sender
+//
+// Functions to set or get the active Sender name.
+// The "active" Sender is the one of the multiple Senders
+// that is top of the list or is the one selected by the user from this list. 
+// This active Sender information is saved in a separated shared
+// memory from other Senders, identified by the name "ActiveSenderName"
+// so it can be recalled at any time by clients if the user
+// has selected a required Sender from a dialog or executable.
+// The dialog or executable sets the info of the selected Sender
+// into the ActiveSender shared memory so the clients can picks it up.
+// !!! The active Sender has to be a member of the Sender list !!!
+
+//---------------------------------------------------------
+// Function: SetActiveSender
+// Set the active sender, the first retrieved by a receiver
+bool spoutSenderNames::SetActiveSender(const char *Sendername)
+{
+	std::set<std::string> SenderNames;
+
+	if (!Sendername)
+		return false;
+
+	if (!CreateSenderSet())	{
+		return false;
+	}
+
+	// Keep the sender set locked for this entire operation
+	if (!m_senderNames.Lock())
+	{
+		return false;
+	}
+
+	// Get the current list to check whether the passed name is in it
+	if(GetSenderSet(SenderNames)) {
+		if(SenderNames.find(Sendername) != SenderNames.end() ) {
+			if(setActiveSenderName(Sendername)) { // set the active Sender name to shared memory
+				setSenderChange();
+				m_senderNames.Unlock();
+				return true;
+			}
+		}
+	}
+
+	m_senderNames.Unlock();
+	return false;
+
+} // end SetActiveSender
+
+//---------------------------------------------------------
+// Function: GetActiveSender
+// Retrieve the current active Sender name
+bool spoutSenderNames::GetActiveSender(char *Sendername, const int maxlength)
+{
+	if (!Sendername)
+		return false;
 
 	// name will never be larger than this (default is 256)
 	char ActiveName[2048]={};
 	SharedTextureInfo info={};
 
+	// Snapshot of the sender service if running
+	if (getSnapshotActive(Sendername, maxlength, nullptr))
+		return true;
+
 	if(getActiveSenderName(&ActiveName[0])) {
 		// Does it still exist ?
 		if(getSharedInfo(&ActiveName[0], &info)) {
@@ -811,6 +1490,7 @@ bool spoutSenderNames::CreateSender(const char *sendername, unsigned int width,
 	RegisterSenderName(sendername);
 
 	// Save the texture info for this sender
+	// The sender change count is incremented after the info is written
 	if (!UpdateSender(sendername, width, height, hSharehandle, dwFormat))
 		return false;
 
@@ -828,7 +1508,7 @@ bool spoutSenderNames::UpdateSender(const char *sendername, unsigned int width,
 
 		// Create or open a shared memory map for this sender - allocate enough for the texture info
 		SpoutSharedMemory *senderInfoMem = new SpoutSharedMemory();
-		const SpoutCreateResult result = senderInfoMem->Create(sendername, sizeof(SharedTextureInfo));
+		const SpoutCreateResult result = senderInfoMem->Create(sendername, sizeof(SharedTextureInfo)+sizeof(SharedSenderAlive)+sizeof(SharedSenderUID));
 		if (result == SPOUT_CREATE_FAILED) {
 			delete senderInfoMem;
 			m_senderNames.Unlock();
@@ -837,13 +1517,172 @@ bool spoutSenderNames::UpdateSender(const char *sendername, unsigned int width,
 		// The sender's information remains until it closes
 		// and is saved in the m_senders set
 		(*m_senders)[sendername] = senderInfoMem;
+		// Sender ID for receivers
+		setSenderUID(sendername, senderInfoMem);
 	}
 
 	// Save the info for this sender in the sender shared memory map
-	return SetSenderInfo(sendername, width, height, hSharehandle, dwFormat);
+	if (!SetSenderInfo(sendername, width, height, hSharehandle, dwFormat))
+		return false;
+
+	// Sender process and heartbeat
+	setSenderAlive(m_senders->find(sendername)->second);
+
+	// Let receivers know
+	setSenderChange();
+
+	return true;
 		
 } // end UpdateSender
 
+// ===============================================================================
+//	Sender change notification
+//
+//	The sender change count in the "SpoutSenderNamesGeneration" map is
+//	incremented when a sender is created, updated or closed, or the active
+//	sender is changed. A receiver can compare it with a previous value instead
+//	of opening the sender name and sender information maps each frame.
+//	Senders of earlier Spout versions do not change the count,
+//	so a receiver should still check for senders at intervals.
+// ===============================================================================
+
+//---------------------------------------------------------
+// Function: GetSenderGeneration
+// Sender change count
+//    Returns zero if the generation map is not available
+LONG spoutSenderNames::GetSenderGeneration()
+{
+	if (!CreateSenderSet())
+		return 0;
+
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pGeneration)
+		return 0;
+
+	return InterlockedCompareExchange(&pGeneration->changes, 0, 0);
+
+} // end GetSenderGeneration
+
+//---------------------------------------------------------
+// Function: CheckSenderChange
+// Test for sender change since a previous check
+//    generation - sender change count of the previous check
+//    dwTime - time of the previous check (GetTickCount)
+//    dwInterval - maximum interval in milliseconds between checks
+//
+//    Returns true if the sender change count is different or
+//    the interval has elapsed. The generation and time are then updated.
+//    Always true for the first check (dwTime zero).
+bool spoutSenderNames::CheckSenderChange(LONG &generation, DWORD &dwTime, DWORD dwInterval)
+{
+	const DWORD dwNow = GetTickCount();
+
+	if (!CreateSenderSet() || !getSenderSetGeneration()) {
+		dwTime = dwNow;
+		return true;
+	}
+
+	const LONG current = GetSenderGeneration();
+	if (dwTime != 0 && current == generation && (dwNow - dwTime) < dwInterval)
+		return false;
+
+	generation = current;
+	dwTime = dwNow ? dwNow : 1;
+
+	return true;
+
+} // end CheckSenderChange
+
+//---------------------------------------------------------
+// Function: WaitSenderChange
+// Wait for a sender change
+//    generation - sender change count to compare
+//    dwTimeout - wait timeout in milliseconds
+//
+//    The change count is tested at millisecond intervals.
+//    Returns true if it has changed, false for timeout.
+bool spoutSenderNames::WaitSenderChange(LONG generation, DWORD dwTimeout)
+{
+	const DWORD dwStart = GetTickCount();
+	do {
+		if (GetSenderGeneration() != generation)
+			return true;
+		Sleep(1);
+	} while ((GetTickCount() - dwStart) < dwTimeout);
+
+	return false;
+
+} // end WaitSenderChange
+
+//---------------------------------------------------------
+// Function: CheckSenderInfoChange
+// Test for a change of the information of a connected sender
+//    sendername - name of the connected sender
+//    changes - sender information change count of the previous check
+//    generation - sender change count of the previous check
+//    dwTime - time of the previous check (GetTickCount)
+//    dwInterval - maximum interval in milliseconds between checks
+//
+//    The information map of the sender is retained, so that the test is
+//    two integer reads without opening a map or copying the information.
+//    Returns false if neither the information change count of the sender
+//    nor the sender change count has changed within the interval and the
+//    sender information does not need to be read again.
+//    Otherwise the counts and time are updated and the map is closed,
+//    so that a sender that has closed is not kept open.
+//    Always true for the first check (dwTime zero) and for senders
+//    of earlier versions that do not record the change count.
+bool spoutSenderNames::CheckSenderInfoChange(const char* sendername, LONG &changes, LONG &generation, DWORD &dwTime, DWORD dwInterval)
+{
+	if (!sendername || !*sendername)
+		return true;
+
+	// The counts of a different sender cannot be compared
+	const bool bSame = (strcmp(sendername, m_InfoChangeName) == 0);
+	if (!bSame)
+		CloseSenderInfoChange();
+
+	// Open the information map of the sender if not already
+	if (!m_InfoChangeMap.Name()) {
+		if (!m_InfoChangeMap.Open(sendername))
+			return true;
+	}
+
+	const SharedSenderAlive* pAlive = getSenderAlive(&m_InfoChangeMap);
+	if (!pAlive || pAlive->processId == 0) {
+		// Earlier version
+		CloseSenderInfoChange();
+		return true;
+	}
+
+	const DWORD dwNow = GetTickCount();
+	const LONG current = InterlockedCompareExchange((volatile LONG*)&pAlive->changes, 0, 0);
+	const LONG currentGeneration = GetSenderGeneration();
+	if (bSame && dwTime != 0 && current == changes && currentGeneration == generation
+		&& (dwNow - dwTime) < dwInterval)
+		return false;
+
+	changes = current;
+	generation = currentGeneration;
+	dwTime = dwNow ? dwNow : 1;
+
+	// Close the map for the sender information to be read again
+	m_InfoChangeMap.Close();
+	strcpy_s(m_InfoChangeName, 256, sendername);
+
+	return true;
+
+} // end CheckSenderInfoChange
+
+//---------------------------------------------------------
+// Function: CloseSenderInfoChange
+// Close the sender information map retained by CheckSenderInfoChange
+void spoutSenderNames::CloseSenderInfoChange()
+{
+	m_InfoChangeMap.Close();
+	m_InfoChangeName[0] = 0;
+}
+
 // ===============================================================================
 //	Functions to retrieve information about the shared texture of a sender
 //
@@ -979,20 +1818,25 @@ void spoutSenderNames::CleanSenders()
 	std::set<std::string> Senders;
 	std::set<std::string>::iterator iter;
 	std::string namestring;
-	SharedTextureInfo info={};
+
+	// Cached maps would keep the information of a closed sender
+	clearInfoCache();
+	CloseSenderUIDInfo();
 
 	// get the sender name list in shared memory into a local list
 	GetSenderNames(&Senders);
 
 	// Now we have a local set of names "Senders"
 	// Run through the set and check whether the sender exists
-	// If it does not exist, release from the sender list
+	// If it does not exist, release from the sender list.
+	// The map of a sender that has crashed can still be open by
+	// a receiver, so the sender process is also tested.
 	if (Senders.size() > 0) {
 		for (iter = Senders.begin(); iter != Senders.end(); iter++) {
 			namestring = *iter; // the Sender name string
 			strcpy_s(name, namestring.c_str());
 			// we have the name already, so look for it's info
-			if (!getSharedInfo(&name[0], &info)) {
+			if (!IsSenderAlive(&name[0])) {
 				SpoutLogWarning("spoutSenderNames::CleanSenders - removing [%s]", &name[0]);
 				// Sender does not exist any more so remove from the names list
 				ReleaseSenderName(&name[0]);
@@ -1004,60 +1848,726 @@ void spoutSenderNames::CleanSenders()
 	Senders.clear();
 
 }
-// ================================================
-
 
+//---------------------------------------------------------
+// Function: SetSenderHeartbeat
+// Sender update of the heartbeat while sending.
 //
-// Protected
+// Called for every frame sent. The heartbeat is written at
+// SPOUT_HEARTBEAT_INTERVAL msec intervals so that cleanup can
+// find that a sender is alive without a process test.
+void spoutSenderNames::SetSenderHeartbeat(const char* sendername)
+{
+	const ULONGLONG now = GetTickCount64();
+	if (!sendername || now - m_HeartbeatTime < SPOUT_HEARTBEAT_INTERVAL)
+		return;
+	m_HeartbeatTime = now;
+
+	const auto foundSender = m_senders->find(sendername);
+	if (foundSender == m_senders->end() || !foundSender->second)
+		return;
+
+	SpoutSharedMemory* pMem = foundSender->second;
+	SharedSenderAlive* pAlive = getSenderAlive(pMem);
+	if (pAlive) {
+		InterlockedExchange64(&pAlive->heartbeat, (LONG64)now);
+	}
+}
+
+//---------------------------------------------------------
+// Function: IsSenderAlive
+// Test whether the sender process is running.
 //
+// False if the sender map does not exist, or the process recorded
+// by a sender of this version has closed. Senders of earlier versions
+// are alive if the map exists.
+bool spoutSenderNames::IsSenderAlive(const char* sendername)
+{
+	if (!sendername || !*sendername)
+		return false;
 
-///////////////////////////////////////////////////
-// Private functions for multiple Sender support //
-///////////////////////////////////////////////////
+	// A sender of this process
+	if (m_senders->find(sendername) != m_senders->end())
+		return true;
 
-void spoutSenderNames::readSenderSetFromBuffer(const char* buffer, std::set<std::string>& SenderNames, int maxSenders)
+	SpoutSharedMemory mem;
+	if (!mem.Open(sendername))
+		return false;
+
+	return (checkSenderAlive(&mem) != 0);
+}
+
+//---------------------------------------------------------
+// Function: StartSenderCleanup
+// Release orphaned senders on a thread at intervals.
+//
+// Senders that crash can leave their names in the list until
+// CleanSenders is called. The thread tests all registered senders
+// at the interval in msec. Sender maps are kept open between tests
+// so that a test is a read of the heartbeat, or a process test if
+// it is not recent. A sender is released if its map has closed or
+// its process has closed. Stopped when the object is destroyed.
+bool spoutSenderNames::StartSenderCleanup(DWORD dwInterval)
 {
-	const char* buf = buffer;
-	if (!buf)
-		return;
+	if (m_hCleanupThread)
+		return true;
 
-	// first empty the set
-	if(SenderNames.size() > 0) {
-		SenderNames.erase (SenderNames.begin(), SenderNames.end() );
-	}
+	m_dwCleanupInterval = dwInterval > 0 ? dwInterval : 1000;
+	m_hCleanupStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (!m_hCleanupStop)
+		return false;
 
-	char name[SpoutMaxSenderNameLen]={};		// char array to test for nulls
-	int i = 0;
-	do {
-		// the actual string retrieved from shared memory should terminate
-		// with a null within the 256 chars.
-		// At the end of the map there will be a null in the data.
-		// Must use a character array to ensure testing for null.
-		strncpy_s(name, buf, SpoutMaxSenderNameLen);
-		if(name[0] > 0) {
-			// insert name into set
-			SenderNames.insert(&name[0]);
-		}
-		// increment by 256 bytes for the next name
-		buf += SpoutMaxSenderNameLen;
-		i++;
-	} while (name[0] > 0 && i < maxSenders); // maxSenders has to be passed because this function is static
+	m_hCleanupThread = CreateThread(NULL, 0, CleanupThread, (LPVOID)this, 0, NULL);
+	if (!m_hCleanupThread) {
+		SpoutLogError("spoutSenderNames::StartSenderCleanup - could not create thread");
+		CloseHandle(m_hCleanupStop);
+		m_hCleanupStop = NULL;
+		return false;
+	}
+	SpoutLogNotice("spoutSenderNames::StartSenderCleanup - %d msec", m_dwCleanupInterval);
 
+	return true;
 }
 
-void spoutSenderNames::writeBufferFromSenderSet(const std::set<std::string>& SenderNames, char* buffer, int maxSenders)
+//---------------------------------------------------------
+// Function: StopSenderCleanup
+// Stop the cleanup thread
+void spoutSenderNames::StopSenderCleanup()
 {
-	char* buf = buffer; // pointer within the buffer
-	if (!buf)
+	if (!m_hCleanupThread)
 		return;
 
-	std::string namestring;
-	int i = 0;
-	std::set<std::string>::iterator iter;
+	SetEvent(m_hCleanupStop);
+	WaitForSingleObject(m_hCleanupThread, INFINITE);
+	CloseHandle(m_hCleanupThread);
+	CloseHandle(m_hCleanupStop);
+	m_hCleanupThread = NULL;
+	m_hCleanupStop = NULL;
+}
 
-	for(iter = SenderNames.begin(); iter != SenderNames.end(); iter++) {
-		namestring = *iter; // the string to copy to the buffer
-		// copy it with 256 max length although only the string length will be copied
+DWORD WINAPI spoutSenderNames::CleanupThread(LPVOID lpParameter)
+{
+	spoutSenderNames* pThis = reinterpret_cast<spoutSenderNames*>(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_HOUSEKEEPING);
+	pThis->CleanupLoop();
+	EndSpoutThread(SPOUT_THREAD_HOUSEKEEPING, hTask);
+	return 0;
+}
+
+// The thread uses its own object for the sender names
+// so that this object is not changed.
+void spoutSenderNames::CleanupLoop()
+{
+	spoutSenderNames names;
+	std::unordered_map<std::string, SpoutSharedMemory*> maps;
+	std::set<std::string> Senders;
+
+	while (WaitForSingleObject(m_hCleanupStop, m_dwCleanupInterval) == WAIT_TIMEOUT) {
+
+		if (!names.GetSenderNames(&Senders))
+			continue;
+
+		// Close the maps of senders that have been released
+		for (auto itr = maps.begin(); itr != maps.end(); ) {
+			if (Senders.find(itr->first) == Senders.end()) {
+				delete itr->second;
+				itr = maps.erase(itr);
+			}
+			else {
+				itr++;
+			}
+		}
+
+		for (auto iter = Senders.begin(); iter != Senders.end(); iter++) {
+			SpoutSharedMemory* pMem = nullptr;
+			const auto found = maps.find(*iter);
+			if (found != maps.end()) {
+				pMem = found->second;
+			}
+			else {
+				pMem = new SpoutSharedMemory();
+				if (!pMem->Open(iter->c_str())) {
+					delete pMem;
+					pMem = nullptr;
+				}
+				else {
+					maps[*iter] = pMem;
+				}
+			}
+			if (!pMem || checkSenderAlive(pMem) == 0) {
+				SpoutLogWarning("spoutSenderNames::CleanupLoop - removing [%s]", iter->c_str());
+				if (pMem) {
+					delete pMem;
+					maps.erase(*iter);
+				}
+				names.ReleaseSenderName(iter->c_str());
+			}
+		}
+	}
+
+	for (auto itr = maps.begin(); itr != maps.end(); itr++)
+		delete itr->second;
+}
+
+// Liveness block of a sender information map.
+// The size of a map opened rather than created is not known, but the view
+// is at least one page and the block is zero for senders of earlier versions.
+SharedSenderAlive* spoutSenderNames::getSenderAlive(SpoutSharedMemory* pMem)
+{
+	if (!pMem || !pMem->Buffer())
+		return nullptr;
+
+	if (pMem->Size() > 0 && pMem->Size() < (int)(sizeof(SharedTextureInfo)+sizeof(SharedSenderAlive)))
+		return nullptr;
+
+	return reinterpret_cast<SharedSenderAlive*>(pMem->Buffer()+sizeof(SharedTextureInfo));
+}
+
+// Liveness in a sender information map.
+// 1 if alive, 0 if the sender process has closed, -1 for a sender
+// of an earlier version without the process recorded.
+int spoutSenderNames::checkSenderAlive(SpoutSharedMemory* pMem)
+{
+	const SharedSenderAlive* pAlive = getSenderAlive(pMem);
+	if (!pAlive || pAlive->processId == 0)
+		return -1;
+
+	// Recent heartbeat
+	const LONG64 heartbeat = InterlockedCompareExchange64((volatile LONG64*)&pAlive->heartbeat, 0, 0);
+	if (heartbeat > 0 && GetTickCount64() - (ULONGLONG)heartbeat < SPOUT_HEARTBEAT_TIMEOUT)
+		return 1;
+
+	// Test the process
+	HANDLE hProcess = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)pAlive->processId);
+	if (!hProcess) {
+		// No process with the ID. Otherwise the process
+		// could be of another user and is assumed alive.
+		return (GetLastError() == ERROR_INVALID_PARAMETER) ? 0 : 1;
+	}
+	int alive = (WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT) ? 1 : 0;
+	if (alive && pAlive->processTime != 0) {
+		// A different process with the same ID
+		FILETIME created={}, exited={}, kernel={}, user={};
+		if (GetProcessTimes(hProcess, &created, &exited, &kernel, &user)) {
+			const uint64_t time = ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+			if (time != pAlive->processTime)
+				alive = 0;
+		}
+	}
+	CloseHandle(hProcess);
+
+	return alive;
+}
+
+// Increment the information change count of a sender map
+// before the information is written. The count is then odd.
+void spoutSenderNames::beginSenderInfoChange(SpoutSharedMemory* pMem)
+{
+	SharedSenderAlive* pAlive = getSenderAlive(pMem);
+	if (pAlive)
+		InterlockedIncrement(&pAlive->changes);
+}
+
+// Increment the information change count of a sender map
+// after the information has been written. The count is then even.
+void spoutSenderNames::setSenderInfoChange(SpoutSharedMemory* pMem)
+{
+	SharedSenderAlive* pAlive = getSenderAlive(pMem);
+	if (pAlive)
+		InterlockedIncrement(&pAlive->changes);
+}
+
+// Record the process and heartbeat in the information map of a sender of this process
+void spoutSenderNames::setSenderAlive(SpoutSharedMemory* pMem)
+{
+	SharedSenderAlive* pAlive = getSenderAlive(pMem);
+	if (!pAlive)
+		return;
+
+	FILETIME created={}, exited={}, kernel={}, user={};
+	uint64_t time = 0;
+	if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+		time = ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+	pAlive->processTime = time;
+	pAlive->processId = (uint32_t)GetCurrentProcessId();
+	InterlockedExchange64(&pAlive->heartbeat, (LONG64)GetTickCount64());
+}
+
+// Sender ID block of a sender information map.
+// Zero for senders of earlier versions, as for the liveness block.
+SharedSenderUID* spoutSenderNames::getSharedSenderUID(SpoutSharedMemory* pMem)
+{
+	if (!pMem || !pMem->Buffer())
+		return nullptr;
+
+	if (pMem->Size() > 0 && pMem->Size() < (int)(sizeof(SharedTextureInfo)+sizeof(SharedSenderAlive)+sizeof(SharedSenderUID)))
+		return nullptr;
+
+	return reinterpret_cast<SharedSenderUID*>(pMem->Buffer()+sizeof(SharedTextureInfo)+sizeof(SharedSenderAlive));
+}
+
+// Record the ID of a sender of this process.
+// The ID of an existing map is retained if it is still in the table
+// for the same name, otherwise a new ID is assigned.
+void spoutSenderNames::setSenderUID(const char* sendername, SpoutSharedMemory* pMem)
+{
+	SharedSenderUID* pUID = getSharedSenderUID(pMem);
+	if (!pUID || !CreateSenderSet())
+		return;
+
+	if (!m_senderNames.Lock())
+		return;
+
+	char name[SpoutMaxSenderNameLen]={};
+	const uint64_t uid = (uint64_t)pUID->uid;
+	if (uid == SPOUT_SENDERUID_EMPTY || !FindSenderUID(uid, name) || strcmp(name, sendername) != 0)
+		InterlockedExchange64(&pUID->uid, (LONG64)registerSenderUID(sendername));
+
+	m_senderNames.Unlock();
+}
+
+// Sender ID table.
+// Opened once for the process. The capacity is set by the first to create it.
+SenderUIDTable* spoutSenderNames::getSenderUIDTable()
+{
+	AcquireSRWLockShared(&g_SenderUIDLock);
+	char* pBuf = g_SenderUIDs.Buffer();
+	ReleaseSRWLockShared(&g_SenderUIDLock);
+
+	const int size = (int)(sizeof(SenderUIDTable) + SPOUT_SENDERUID_ENTRIES*sizeof(SenderUIDEntry));
+	if (!pBuf) {
+		AcquireSRWLockExclusive(&g_SenderUIDLock);
+		if (!g_SenderUIDs.Buffer()) {
+			if (g_SenderUIDs.Create("SpoutSenderUIDs", size) == SPOUT_CREATE_FAILED) {
+				g_SenderUIDs.Close();
+			}
+			else {
+				SenderUIDTable* pTable = reinterpret_cast<SenderUIDTable*>(g_SenderUIDs.Buffer());
+				InterlockedCompareExchange((volatile LONG*)&pTable->capacity, SPOUT_SENDERUID_ENTRIES, 0);
+			}
+		}
+		pBuf = g_SenderUIDs.Buffer();
+		ReleaseSRWLockExclusive(&g_SenderUIDLock);
+	}
+
+	SenderUIDTable* pTable = reinterpret_cast<SenderUIDTable*>(pBuf);
+	if (!pTable || pTable->capacity != SPOUT_SENDERUID_ENTRIES)
+		return nullptr;
+
+	return pTable;
+}
+
+// Sender ID table entries following the header
+SenderUIDEntry* spoutSenderNames::getSenderUIDEntries(SenderUIDTable* pTable)
+{
+	if (!pTable)
+		return nullptr;
+	return reinterpret_cast<SenderUIDEntry*>(reinterpret_cast<char*>(pTable) + sizeof(SenderUIDTable));
+}
+
+// Assign a new ID to a sender name and add it to the table.
+// Any ID that remains for the same name is removed.
+// Within the sender names map lock.
+uint64_t spoutSenderNames::registerSenderUID(const char* sendername)
+{
+	SenderUIDTable* pTable = getSenderUIDTable();
+	if (!pTable)
+		return SPOUT_SENDERUID_EMPTY;
+
+	releaseSenderUID(sendername);
+
+	// Too few empty entries for short probes
+	if ((pTable->count + pTable->deleted + 1)*4 > pTable->capacity*3)
+		buildSenderUIDTable(pTable);
+	if ((pTable->count + 1)*4 > pTable->capacity*3) {
+		SpoutLogWarning("spoutSenderNames::registerSenderUID - sender ID table is full");
+		return SPOUT_SENDERUID_EMPTY;
+	}
+
+	const uint64_t uid = (uint64_t)InterlockedIncrement64(&pTable->next);
+	insertSenderUID(pTable, uid, sendername);
+
+	return uid;
+}
+
+// Remove the ID of a sender name from the table.
+// The table is searched for the name, so that an ID is also
+// removed for a sender of another process that has closed.
+// Within the sender names map lock.
+void spoutSenderNames::releaseSenderUID(const char* sendername)
+{
+	SenderUIDTable* pTable = getSenderUIDTable();
+	SenderUIDEntry* pEntries = getSenderUIDEntries(pTable);
+	if (!pEntries || !sendername)
+		return;
+
+	for (uint32_t i = 0; i < pTable->capacity; i++) {
+		const uint64_t uid = (uint64_t)pEntries[i].uid;
+		if (uid == SPOUT_SENDERUID_EMPTY || uid == SPOUT_SENDERUID_DELETED)
+			continue;
+		if (strncmp(pEntries[i].name, sendername, SpoutMaxSenderNameLen) == 0) {
+			InterlockedExchange64(&pEntries[i].uid, (LONG64)SPOUT_SENDERUID_DELETED);
+			if (pTable->count > 0)
+				pTable->count--;
+			pTable->deleted++;
+		}
+	}
+}
+
+// Add an ID at the first empty or deleted entry.
+// The name is written before the ID.
+void spoutSenderNames::insertSenderUID(SenderUIDTable* pTable, uint64_t uid, const char* sendername)
+{
+	SenderUIDEntry* pEntries = getSenderUIDEntries(pTable);
+	if (!pEntries)
+		return;
+
+	const uint32_t mask = pTable->capacity-1;
+	for (uint32_t i = 0; i < pTable->capacity; i++) {
+		SenderUIDEntry* pEntry = &pEntries[(uint32_t)(uid + i) & mask];
+		const uint64_t entry = (uint64_t)pEntry->uid;
+		if (entry == SPOUT_SENDERUID_EMPTY || entry == SPOUT_SENDERUID_DELETED) {
+			if (entry == SPOUT_SENDERUID_DELETED && pTable->deleted > 0)
+				pTable->deleted--;
+			strncpy_s(pEntry->name, SpoutMaxSenderNameLen, sendername, _TRUNCATE);
+			MemoryBarrier();
+			InterlockedExchange64(&pEntry->uid, (LONG64)uid);
+			pTable->count++;
+			return;
+		}
+	}
+}
+
+// Rebuild the table without deleted entries.
+// "write" is odd meanwhile so that readers try again.
+void spoutSenderNames::buildSenderUIDTable(SenderUIDTable* pTable)
+{
+	SenderUIDEntry* pEntries = getSenderUIDEntries(pTable);
+	if (!pEntries)
+		return;
+
+	std::vector<std::pair<uint64_t, std::string>> senders;
+	char name[SpoutMaxSenderNameLen]={};
+	for (uint32_t i = 0; i < pTable->capacity; i++) {
+		const uint64_t uid = (uint64_t)pEntries[i].uid;
+		if (uid != SPOUT_SENDERUID_EMPTY && uid != SPOUT_SENDERUID_DELETED) {
+			strncpy_s(name, pEntries[i].name, _TRUNCATE);
+			senders.push_back(std::make_pair(uid, std::string(name)));
+		}
+	}
+
+	InterlockedIncrement(&pTable->write);
+	for (uint32_t i = 0; i < pTable->capacity; i++)
+		pEntries[i].uid = (LONG64)SPOUT_SENDERUID_EMPTY;
+	pTable->count = 0;
+	pTable->deleted = 0;
+	for (size_t i = 0; i < senders.size(); i++)
+		insertSenderUID(pTable, senders[i].first, senders[i].second.c_str());
+	MemoryBarrier();
+	InterlockedIncrement(&pTable->write);
+}
+
+// ===============================================================================
+//	Sender service
+//
+//	Sender discovery otherwise opens the sender name, active sender and
+//	sender information maps within calls such as GetSenderCount and
+//	GetActiveSender, and orphaned senders are removed by CleanSenders in
+//	user calls. The sender service is one thread for the process that does
+//	this at intervals and publishes a snapshot of the senders and the active
+//	sender. While it runs, GetSenderCount, GetSender, GetSenderNameInfo and
+//	GetActiveSender of all objects return the snapshot without kernel calls.
+//	Information of a connected sender is still read directly by receivers
+//	so that a size change is found immediately.
+// ===============================================================================
+
+//---------------------------------------------------------
+// Function: StartSenderService
+// Start the process sender service thread.
+//
+// The sender change count is tested at the interval in msec and the
+// snapshot is updated if it has changed, or once a second for senders
+// of earlier versions. Orphaned senders are removed once a second.
+// The service is shared by all users in the process and stops when
+// all have called StopSenderService.
+bool spoutSenderNames::StartSenderService(DWORD dwInterval)
+{
+	AcquireSRWLockExclusive(&g_ServiceStartLock);
+
+	if (g_hServiceThread) {
+		g_ServiceUsers++;
+		ReleaseSRWLockExclusive(&g_ServiceStartLock);
+		return true;
+	}
+
+	g_dwServiceInterval = dwInterval > 0 ? dwInterval : 100;
+	g_hServiceStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+	if (g_hServiceStop)
+		g_hServiceThread = CreateThread(NULL, 0, ServiceThread, NULL, 0, NULL);
+	if (!g_hServiceThread) {
+		SpoutLogError("spoutSenderNames::StartSenderService - could not create thread");
+		if (g_hServiceStop) CloseHandle(g_hServiceStop);
+		g_hServiceStop = NULL;
+		ReleaseSRWLockExclusive(&g_ServiceStartLock);
+		return false;
+	}
+	g_ServiceUsers = 1;
+	SpoutLogNotice("spoutSenderNames::StartSenderService - %d msec", g_dwServiceInterval);
+
+	ReleaseSRWLockExclusive(&g_ServiceStartLock);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: StopSenderService
+// Stop the sender service when all users have stopped it
+void spoutSenderNames::StopSenderService()
+{
+	AcquireSRWLockExclusive(&g_ServiceStartLock);
+
+	if (g_hServiceThread && --g_ServiceUsers <= 0) {
+		SetEvent(g_hServiceStop);
+		WaitForSingleObject(g_hServiceThread, INFINITE);
+		CloseHandle(g_hServiceThread);
+		CloseHandle(g_hServiceStop);
+		g_hServiceThread = NULL;
+		g_hServiceStop = NULL;
+		g_ServiceUsers = 0;
+		// Discovery reads the maps again
+		AcquireSRWLockExclusive(&g_ServiceLock);
+		g_bSnapshot = false;
+		if (g_pSnapshot) delete g_pSnapshot;
+		g_pSnapshot = nullptr;
+		g_SnapshotActive[0] = 0;
+		ReleaseSRWLockExclusive(&g_ServiceLock);
+		SpoutLogNotice("spoutSenderNames::StopSenderService");
+	}
+
+	ReleaseSRWLockExclusive(&g_ServiceStartLock);
+}
+
+//---------------------------------------------------------
+// Function: IsSenderServiceRunning
+// Sender service status
+bool spoutSenderNames::IsSenderServiceRunning()
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	const bool bRunning = g_bSnapshot;
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bRunning;
+}
+
+//---------------------------------------------------------
+// Function: GetSenderSnapshot
+// Copy of the sender snapshot.
+//
+// The senders in name order and optionally the active sender name.
+// Returns false if the service is not running.
+bool spoutSenderNames::GetSenderSnapshot(std::vector<SpoutSenderSnapshotEntry>& senders, char* activesender, int maxlength)
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	const bool bSnapshot = g_bSnapshot;
+	if (bSnapshot) {
+		senders = *g_pSnapshot;
+		if (activesender)
+			strcpy_s(activesender, maxlength, g_SnapshotActive);
+	}
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bSnapshot;
+}
+
+DWORD WINAPI spoutSenderNames::ServiceThread(LPVOID lpParameter)
+{
+	UNREFERENCED_PARAMETER(lpParameter);
+	const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_HOUSEKEEPING);
+	ServiceLoop();
+	EndSpoutThread(SPOUT_THREAD_HOUSEKEEPING, hTask);
+	return 0;
+}
+
+// The service uses its own object for the sender names
+void spoutSenderNames::ServiceLoop()
+{
+	spoutSenderNames names;
+	std::set<std::string> Senders;
+	std::vector<SpoutSenderSnapshotEntry> snapshot;
+	char active[SpoutMaxSenderNameLen]={};
+	LONG generation = 0;
+	DWORD dwTime = 0;
+	DWORD dwClean = 0;
+	DWORD dwWait = 0;
+
+	while (WaitForSingleObject(g_hServiceStop, dwWait) == WAIT_TIMEOUT) {
+		dwWait = g_dwServiceInterval;
+
+		// Remove orphaned senders once a second
+		if (GetTickCount()-dwClean >= 1000) {
+			names.CleanSenders();
+			dwClean = GetTickCount();
+		}
+
+		// Update the snapshot if senders have changed or once a second
+		if (!names.CheckSenderChange(generation, dwTime, 1000))
+			continue;
+
+		snapshot.clear();
+		if (names.GetSenderNames(&Senders)) {
+			for (auto iter = Senders.begin(); iter != Senders.end(); iter++) {
+				SpoutSenderSnapshotEntry entry={};
+				strcpy_s(entry.name, SpoutMaxSenderNameLen, iter->c_str());
+				if (names.openSharedInfo(entry.name, &entry.info))
+					snapshot.push_back(entry);
+			}
+		}
+
+		// Validate the active sender. If it has closed,
+		// the first sender becomes active.
+		active[0] = 0;
+		if (names.getActiveSenderName(active)) {
+			bool bFound = false;
+			for (size_t i = 0; i < snapshot.size() && !bFound; i++)
+				bFound = (strcmp(snapshot[i].name, active) == 0);
+			if (!bFound)
+				active[0] = 0;
+		}
+		if (!active[0] && !snapshot.empty()) {
+			strcpy_s(active, SpoutMaxSenderNameLen, snapshot[0].name);
+			names.setActiveSenderName(active);
+		}
+
+		// Publish
+		AcquireSRWLockExclusive(&g_ServiceLock);
+		if (!g_pSnapshot)
+			g_pSnapshot = new std::vector<SpoutSenderSnapshotEntry>();
+		g_pSnapshot->swap(snapshot);
+		strcpy_s(g_SnapshotActive, SpoutMaxSenderNameLen, active);
+		g_bSnapshot = true;
+		ReleaseSRWLockExclusive(&g_ServiceLock);
+	}
+}
+
+// Number of senders in the snapshot
+bool spoutSenderNames::getSnapshotCount(int &count)
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	const bool bSnapshot = g_bSnapshot;
+	if (bSnapshot)
+		count = (int)g_pSnapshot->size();
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bSnapshot;
+}
+
+// Sender of the snapshot by index
+bool spoutSenderNames::getSnapshotSender(int index, char* sendername, int maxlength, SharedTextureInfo* info)
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	const bool bSnapshot = g_bSnapshot && index >= 0 && index < (int)g_pSnapshot->size();
+	if (bSnapshot) {
+		const SpoutSenderSnapshotEntry &entry = (*g_pSnapshot)[index];
+		if (sendername)
+			strcpy_s(sendername, maxlength, entry.name);
+		if (info)
+			*info = entry.info;
+	}
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bSnapshot;
+}
+
+// Names of the snapshot, in the order of the sender name set
+bool spoutSenderNames::getSnapshotNames(char* names, int maxsenders, int maxlength, int &count)
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	const bool bSnapshot = g_bSnapshot;
+	if (bSnapshot) {
+		count = (int)g_pSnapshot->size();
+		if (names) {
+			if (count > maxsenders)
+				count = maxsenders;
+			for (int i = 0; i < count; i++)
+				strncpy_s(names + (size_t)i*maxlength, (rsize_t)maxlength, (*g_pSnapshot)[i].name, _TRUNCATE);
+		}
+	}
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bSnapshot;
+}
+
+// Active sender of the snapshot
+bool spoutSenderNames::getSnapshotActive(char* sendername, int maxlength, SharedTextureInfo* info)
+{
+	AcquireSRWLockShared(&g_ServiceLock);
+	bool bSnapshot = g_bSnapshot && g_SnapshotActive[0];
+	if (bSnapshot) {
+		bSnapshot = false;
+		for (size_t i = 0; i < g_pSnapshot->size(); i++) {
+			const SpoutSenderSnapshotEntry &entry = (*g_pSnapshot)[i];
+			if (strcmp(entry.name, g_SnapshotActive) == 0) {
+				if (sendername)
+					strcpy_s(sendername, maxlength, entry.name);
+				if (info)
+					*info = entry.info;
+				bSnapshot = true;
+				break;
+			}
+		}
+	}
+	ReleaseSRWLockShared(&g_ServiceLock);
+	return bSnapshot;
+}
+// ================================================
+
+
+//
+// Protected
+//
+
+///////////////////////////////////////////////////
+// Private functions for multiple Sender support //
+///////////////////////////////////////////////////
+
+void spoutSenderNames::readSenderSetFromBuffer(const char* buffer, std::set<std::string>& SenderNames, int maxSenders)
+{
+	const char* buf = buffer;
+	if (!buf)
+		return;
+
+	// first empty the set
+	if(SenderNames.size() > 0) {
+		SenderNames.erase (SenderNames.begin(), SenderNames.end() );
+	}
+
+	char name[SpoutMaxSenderNameLen]={};		// char array to test for nulls
+	int i = 0;
+	do {
+		// the actual string retrieved from shared memory should terminate
+		// with a null within the 256 chars.
+		// At the end of the map there will be a null in the data.
+		// Must use a character array to ensure testing for null.
+		strncpy_s(name, buf, SpoutMaxSenderNameLen);
+		if(name[0] > 0) {
+			// insert name into set
+			SenderNames.insert(&name[0]);
+		}
+		// increment by 256 bytes for the next name
+		buf += SpoutMaxSenderNameLen;
+		i++;
+	} while (name[0] > 0 && i < maxSenders); // maxSenders has to be passed because this function is static
+
+}
+
+void spoutSenderNames::writeBufferFromSenderSet(const std::set<std::string>& SenderNames, char* buffer, int maxSenders)
+{
+	char* buf = buffer; // pointer within the buffer
+	if (!buf)
+		return;
+
+	std::string namestring;
+	int i = 0;
+	std::set<std::string>::iterator iter;
+
+	for(iter = SenderNames.begin(); iter != SenderNames.end(); iter++) {
+		namestring = *iter; // the string to copy to the buffer
+		// copy it with 256 max length although only the string length will be copied
 		strcpy_s(buf, SpoutMaxSenderNameLen, namestring.c_str());
 		// move the buffer pointer on for the next Sender name
 		buf += SpoutMaxSenderNameLen;
@@ -1093,10 +2603,691 @@ bool spoutSenderNames::CreateSenderSet()
 		return false;
 	}
 
+	// Generation counter for the sender name set.
+	// Failure is not an error, the set is then read within the map lock.
+	if (!m_senderGeneration.Buffer())
+		m_senderGeneration.Create("SpoutSenderNamesGeneration", sizeof(SenderSetGeneration));
+
+	// Name segments created by other applications
+	openSenderSegments();
+
+	// Name index with at least twice as many entries as name slots
+	// including all segments. Failure is not an error, the name set is then searched.
+	if (!m_senderIndex.Buffer() && m_senderGeneration.Buffer()) {
+		uint32_t capacity = 16;
+		while (capacity < (uint32_t)getMaxSenderSlots()*2)
+			capacity *= 2;
+		const int size = (int)(sizeof(SenderNameIndex) + capacity*sizeof(SenderNameIndexEntry));
+		const SpoutCreateResult indexresult = m_senderIndex.Create("SpoutSenderNamesIndex", size);
+		SenderNameIndex* pIndex = getSenderNameIndex();
+		if (indexresult == SPOUT_CREATE_FAILED || !pIndex) {
+			m_senderIndex.Close();
+		}
+		else if (indexresult == SPOUT_CREATE_SUCCESS || pIndex->size == 0) {
+			// New index, built with the next change within the map lock
+			pIndex->size = (uint32_t)sizeof(SenderNameIndex);
+			pIndex->version = SPOUT_NAMEINDEX_VERSION;
+			pIndex->capacity = capacity;
+			InterlockedExchange(&pIndex->names, -1);
+		}
+	}
+
 	return true;
 
 } // end CreateSenderSet
 
+// Sender name set generation map
+SenderSetGeneration* spoutSenderNames::getSenderSetGeneration()
+{
+	return reinterpret_cast<SenderSetGeneration*>(m_senderGeneration.Buffer());
+}
+
+// Increment the sender change count
+void spoutSenderNames::setSenderChange()
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (pGeneration)
+		InterlockedIncrement(&pGeneration->changes);
+}
+
+// Write the sender name set to the locked sender names buffer.
+// The generation is odd while the buffer is being written so that
+// a reader without the lock can detect a change and try again.
+// Names after a full sender names map are written to segments.
+void spoutSenderNames::writeSenderSet(const std::set<std::string>& SenderNames, char* buffer)
+{
+	beginSenderSetWrite();
+	const int primary = getPrimarySlots();
+	writeBufferFromSenderSet(SenderNames, buffer, primary);
+	if ((int)SenderNames.size() >= primary) {
+		int slot = 0;
+		for (auto iter = SenderNames.begin(); iter != SenderNames.end(); iter++, slot++) {
+			if (slot < primary)
+				continue;
+			char* pSlot = getSenderSlot(slot, true);
+			if (!pSlot) {
+				SpoutLogWarning("spoutSenderNames::writeSenderSet - Sender exceeds max senders (%d)", getMaxSenderSlots());
+				break;
+			}
+			strcpy_s(pSlot, SpoutMaxSenderNameLen, iter->c_str());
+		}
+		// Terminate the list
+		char* pSlot = getSenderSlot(slot);
+		if (pSlot) *pSlot = 0;
+	}
+	endSenderSetWrite();
+	// The slots of all names can change
+	buildSenderNameIndex();
+}
+
+// Read the sender name set from the locked sender names buffer
+// and the segments following it
+void spoutSenderNames::readSenderSet(const char* buffer, std::set<std::string>& SenderNames)
+{
+	checkSenderSegments();
+	readSenderSetFromBuffer(buffer, SenderNames, getPrimarySlots());
+
+	// Segment names follow a full sender names map
+	const int primary = getPrimarySlots();
+	if (primary == 0 || !buffer[(primary-1)*SpoutMaxSenderNameLen])
+		return;
+	char name[SpoutMaxSenderNameLen]={};
+	const int slots = getSenderSlots();
+	for (int i = primary; i < slots; i++) {
+		const char* pSlot = getSenderSlot(i);
+		if (!pSlot) break;
+		strncpy_s(name, pSlot, _TRUNCATE);
+		if (!name[0]) break;
+		SenderNames.insert(name);
+	}
+}
+
+// Start a change of the locked sender names buffer.
+// The name index is marked out of date and the generation is odd.
+void spoutSenderNames::beginSenderSetWrite()
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	if (pIndex) InterlockedExchange(&pIndex->names, -1);
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (pGeneration) InterlockedIncrement(&pGeneration->names); // odd
+}
+
+// End a change of the locked sender names buffer.
+// The checksum of the new set is recorded with the generation.
+// The name index is valid again when it has been updated.
+void spoutSenderNames::endSenderSetWrite()
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (pGeneration) {
+		InterlockedExchange(&pGeneration->checksum, getSenderSetChecksum());
+		InterlockedIncrement(&pGeneration->names); // even
+	}
+	setSenderChange();
+}
+
+// Checksum of the names in the locked sender names buffer and segments
+// up to the first empty slot. The low bit is set so that it is not zero.
+LONG spoutSenderNames::getSenderSetChecksum()
+{
+	uint32_t checksum = 2166136261u;
+	const int slots = getSenderSlots();
+	for (int i = 0; i < slots; i++) {
+		const char* pSlot = getSenderSlot(i);
+		if (!pSlot || !pSlot[0]) break;
+		checksum = checksumSenderName(checksum, pSlot);
+	}
+	return (LONG)(checksum | 1);
+}
+
+// Record the checksum of a name set read within the map lock.
+// A set changed by an application of an earlier version
+// can then be read without the lock until it changes again.
+void spoutSenderNames::setSenderSetChecksum(LONG checksum)
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (pGeneration && pGeneration->checksum != checksum)
+		InterlockedExchange(&pGeneration->checksum, checksum);
+}
+
+// Add a name to the FNV-1a checksum of a name set.
+// The terminating null separates the names.
+uint32_t spoutSenderNames::checksumSenderName(uint32_t checksum, const char* sendername)
+{
+	const unsigned char* p = (const unsigned char*)sendername;
+	for (int i = 0; i < SpoutMaxSenderNameLen-1 && p[i]; i++) {
+		checksum ^= p[i];
+		checksum *= 16777619u;
+	}
+	return checksum*16777619u;
+}
+
+//
+// Sender name segments
+//
+// The sender names map has the size set by the first application to create it
+// (SetMaxSenders). All applications must otherwise agree on the maximum.
+// When the map is full, further names continue in segment maps
+// "SpoutSenderNames_1", "SpoutSenderNames_2" etc. of SPOUT_SEGMENT_SENDERS names.
+// Slots are numbered from the start of the sender names map through the
+// segments, and the names are compact over all of them. The number of
+// segments created is recorded in the generation map. Segments are
+// created within the map lock and never removed, and are opened by every
+// application that uses the sender names, so that they remain while any
+// of them is running. Applications of earlier versions find the names
+// in the sender names map only.
+//
+
+// Number of name slots in the sender names map.
+// An existing map could have been created with a different maximum.
+int spoutSenderNames::getPrimarySlots()
+{
+	return m_senderNames.Size()/SpoutMaxSenderNameLen;
+}
+
+// Number of name slots in the sender names map and the segments created
+int spoutSenderNames::getSenderSlots()
+{
+	int segments = 0;
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (pGeneration)
+		segments = (int)InterlockedCompareExchange(&pGeneration->segments, 0, 0);
+	if (segments > SPOUT_SENDER_SEGMENTS)
+		segments = SPOUT_SENDER_SEGMENTS;
+	return getPrimarySlots() + segments*SPOUT_SEGMENT_SENDERS;
+}
+
+// Maximum number of name slots with all segments
+int spoutSenderNames::getMaxSenderSlots()
+{
+	if (!getSenderSetGeneration())
+		return getPrimarySlots();
+	return getPrimarySlots() + SPOUT_SENDER_SEGMENTS*SPOUT_SEGMENT_SENDERS;
+}
+
+// Name slot in the sender names map or a segment.
+// A segment is created if it does not exist (bCreate) within the map lock.
+// Returns null for a slot beyond the segments.
+char* spoutSenderNames::getSenderSlot(int slot, bool bCreate)
+{
+	char* pBuf = m_senderNames.Buffer();
+	if (!pBuf || slot < 0)
+		return nullptr;
+
+	const int primary = getPrimarySlots();
+	if (slot < primary)
+		return pBuf + slot*SpoutMaxSenderNameLen;
+
+	const int segment = (slot-primary)/SPOUT_SEGMENT_SENDERS;
+	if (segment >= SPOUT_SENDER_SEGMENTS)
+		return nullptr;
+	if (!m_senderSegments[segment].Buffer() && !openSenderSegment(segment, bCreate))
+		return nullptr;
+
+	return m_senderSegments[segment].Buffer() + ((slot-primary)%SPOUT_SEGMENT_SENDERS)*SpoutMaxSenderNameLen;
+}
+
+// Open a segment that has been created, or create the next.
+bool spoutSenderNames::openSenderSegment(int segment, bool bCreate)
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pGeneration || segment >= SPOUT_SENDER_SEGMENTS)
+		return false;
+
+	const LONG segments = InterlockedCompareExchange(&pGeneration->segments, 0, 0);
+	if (segment > segments || (segment == segments && !bCreate))
+		return false;
+
+	char mapname[64]={};
+	sprintf_s(mapname, 64, "SpoutSenderNames_%d", segment+1);
+	if (m_senderSegments[segment].Create(mapname, SPOUT_SEGMENT_SENDERS*SpoutMaxSenderNameLen) == SPOUT_CREATE_FAILED) {
+		SpoutLogWarning("spoutSenderNames::openSenderSegment - could not create [%s]", mapname);
+		return false;
+	}
+
+	if (segment == segments) {
+		InterlockedExchange(&pGeneration->segments, segments+1);
+		SpoutLogNotice("spoutSenderNames::openSenderSegment - created [%s]", mapname);
+	}
+
+	return true;
+}
+
+// Open all segments created by other applications
+void spoutSenderNames::openSenderSegments()
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pGeneration)
+		return;
+
+	LONG segments = InterlockedCompareExchange(&pGeneration->segments, 0, 0);
+	if (segments > SPOUT_SENDER_SEGMENTS)
+		segments = SPOUT_SENDER_SEGMENTS;
+	for (int i = 0; i < (int)segments; i++) {
+		if (!m_senderSegments[i].Buffer())
+			openSenderSegment(i, false);
+	}
+}
+
+// Move segment names back to the sender names map within the map lock.
+// An application of an earlier version that releases a name writes the
+// sender names map compact without the segments. The map is then not full
+// but names remain in the segments after an empty slot, where the set read,
+// the name index and the slot searches, which stop at the first empty slot,
+// do not find them. A name that the earlier application has also added
+// to the sender names map is removed from the segment.
+// Returns true if the names have been moved.
+bool spoutSenderNames::checkSenderSegments()
+{
+	const int primary = getPrimarySlots();
+	const int slots = getSenderSlots();
+	if (primary == 0 || slots <= primary)
+		return false;
+
+	// The sender names map is full or there are no segment names
+	const char* pLast = getSenderSlot(primary-1);
+	const char* pFirst = getSenderSlot(primary);
+	if (!pLast || *pLast != 0 || !pFirst || *pFirst == 0)
+		return false;
+
+	beginSenderSetWrite();
+
+	std::set<std::string> SenderNames;
+	int next = 0;
+	for (; next < primary; next++) {
+		const char* pSlot = getSenderSlot(next);
+		if (!pSlot || !pSlot[0]) break;
+		SenderNames.insert(pSlot);
+	}
+
+	// Segment names are compact from the first segment slot.
+	// Each is moved to the next empty slot, which is always before it.
+	char name[SpoutMaxSenderNameLen]={};
+	int moved = 0;
+	for (int i = primary; i < slots; i++) {
+		char* pSlot = getSenderSlot(i);
+		if (!pSlot || !pSlot[0]) break;
+		strncpy_s(name, pSlot, _TRUNCATE);
+		*pSlot = 0;
+		if (!SenderNames.insert(name).second)
+			continue;
+		char* pNext = getSenderSlot(next++);
+		if (pNext) strcpy_s(pNext, SpoutMaxSenderNameLen, name);
+		moved++;
+	}
+
+	endSenderSetWrite();
+	// The slots of the moved names have changed
+	buildSenderNameIndex();
+
+	SpoutLogNotice("spoutSenderNames::checkSenderSegments - %d segment names moved", moved);
+
+	return true;
+}
+
+// Sender name index header
+SenderNameIndex* spoutSenderNames::getSenderNameIndex()
+{
+	return reinterpret_cast<SenderNameIndex*>(m_senderIndex.Buffer());
+}
+
+// Sender name index entries following the header
+SenderNameIndexEntry* spoutSenderNames::getSenderNameEntries()
+{
+	char* pBuf = m_senderIndex.Buffer();
+	if (!pBuf)
+		return nullptr;
+	return reinterpret_cast<SenderNameIndexEntry*>(pBuf + sizeof(SenderNameIndex));
+}
+
+// FNV-1a hash of a sender name
+uint32_t spoutSenderNames::hashSenderName(const char* sendername)
+{
+	uint32_t hash = 2166136261u;
+	for (const unsigned char* p = (const unsigned char*)sendername; *p; p++) {
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Check the name index within the map lock.
+// The index is rebuilt if it is not valid for the current name set,
+// or if a sender of an earlier version has changed the set.
+// Returns false if there is no index.
+bool spoutSenderNames::checkSenderNameIndex()
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pIndex || !pGeneration || !m_senderNames.Buffer())
+		return false;
+
+	// The index is rebuilt if segment names are moved
+	checkSenderSegments();
+
+	if (pIndex->size < sizeof(SenderNameIndex) || pIndex->version != SPOUT_NAMEINDEX_VERSION
+		|| m_senderIndex.Size() < (int)(sizeof(SenderNameIndex) + pIndex->capacity*sizeof(SenderNameIndexEntry)))
+		return false;
+
+	// Earlier versions do not change the generation, but the name set is compact.
+	// The count is out of date if the name at "count" is not empty or the last is.
+	const int count = (int)pIndex->count;
+	bool bValid = (pIndex->names == pGeneration->names && count <= getSenderSlots());
+	if (bValid) {
+		const char* pSlot = getSenderSlot(count);
+		if (pSlot && *pSlot != 0)
+			bValid = false;
+	}
+	if (bValid && count > 0) {
+		const char* pSlot = getSenderSlot(count-1);
+		if (!pSlot || *pSlot == 0)
+			bValid = false;
+	}
+	// Too few empty entries for short probes
+	if (bValid && (pIndex->count + pIndex->deleted)*4 > pIndex->capacity*3)
+		bValid = false;
+
+	if (!bValid)
+		buildSenderNameIndex();
+
+	return true;
+}
+
+// Build the name index from the locked sender names buffer and segments
+void spoutSenderNames::buildSenderNameIndex()
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	SenderNameIndexEntry* pEntries = getSenderNameEntries();
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pIndex || !pEntries || !pGeneration)
+		return;
+
+	InterlockedExchange(&pIndex->names, -1);
+	for (uint32_t i = 0; i < pIndex->capacity; i++) {
+		pEntries[i].hash = 0;
+		pEntries[i].slot = SPOUT_NAMEINDEX_EMPTY;
+	}
+	pIndex->count = 0;
+	pIndex->deleted = 0;
+
+	char name[SpoutMaxSenderNameLen]={};
+	const int slots = getSenderSlots();
+	for (int i = 0; i < slots; i++) {
+		const char* pSlot = getSenderSlot(i);
+		if (!pSlot) break;
+		strncpy_s(name, pSlot, _TRUNCATE);
+		if (!name[0]) break;
+		insertSenderNameIndex(hashSenderName(name), i);
+		pIndex->count++;
+	}
+	InterlockedExchange(&pIndex->names, pGeneration->names);
+}
+
+// Slot of a name and its index entry.
+// Entries are probed from the hash until an empty entry.
+int spoutSenderNames::findSenderNameSlot(const char* sendername, uint32_t hash, int* pEntry)
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	SenderNameIndexEntry* pEntries = getSenderNameEntries();
+	if (!pIndex || !pEntries || pIndex->capacity == 0)
+		return -1;
+
+	const uint32_t mask = pIndex->capacity-1;
+	for (uint32_t i = 0; i < pIndex->capacity; i++) {
+		const uint32_t e = (hash + i) & mask;
+		const int slot = pEntries[e].slot;
+		if (slot == SPOUT_NAMEINDEX_EMPTY)
+			break;
+		if (slot >= 0 && pEntries[e].hash == hash) {
+			const char* pSlot = getSenderSlot(slot);
+			if (pSlot && strncmp(pSlot, sendername, SpoutMaxSenderNameLen) == 0) {
+				if (pEntry) *pEntry = (int)e;
+				return slot;
+			}
+		}
+	}
+	return -1;
+}
+
+// Slot of a name within the map lock.
+// The index can be out of date if an application of an earlier version
+// has changed the name set without the generation. A name not in the
+// index is searched in the name slots, and the index is rebuilt if found.
+int spoutSenderNames::findSenderSlot(const char* sendername, uint32_t hash, int* pEntry)
+{
+	int slot = findSenderNameSlot(sendername, hash, pEntry);
+	if (slot < 0 && scanSenderNameSlot(sendername) >= 0) {
+		SpoutLogNotice("spoutSenderNames::findSenderSlot - [%s] not in the name index, rebuilding", sendername);
+		buildSenderNameIndex();
+		slot = findSenderNameSlot(sendername, hash, pEntry);
+	}
+	return slot;
+}
+
+// Slot of a name searched in the locked sender names buffer
+// and segments up to the first empty slot. -1 if not found.
+int spoutSenderNames::scanSenderNameSlot(const char* sendername)
+{
+	checkSenderSegments();
+	const int slots = getSenderSlots();
+	for (int i = 0; i < slots; i++) {
+		const char* pSlot = getSenderSlot(i);
+		if (!pSlot || !pSlot[0]) break;
+		if (strncmp(pSlot, sendername, SpoutMaxSenderNameLen) == 0)
+			return i;
+	}
+	return -1;
+}
+
+// Add a name slot to the index at the first empty or deleted entry
+void spoutSenderNames::insertSenderNameIndex(uint32_t hash, int slot)
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	SenderNameIndexEntry* pEntries = getSenderNameEntries();
+	if (!pIndex || !pEntries || pIndex->capacity == 0)
+		return;
+
+	const uint32_t mask = pIndex->capacity-1;
+	for (uint32_t i = 0; i < pIndex->capacity; i++) {
+		const uint32_t e = (hash + i) & mask;
+		if (pEntries[e].slot < 0) {
+			if (pEntries[e].slot == SPOUT_NAMEINDEX_DELETED && pIndex->deleted > 0)
+				pIndex->deleted--;
+			pEntries[e].hash = hash;
+			pEntries[e].slot = slot;
+			return;
+		}
+	}
+}
+
+// Find a name using the index without the map lock.
+// The generation is checked before and after, so that a name set
+// or index changed meanwhile is not used. A name that is not found
+// could be in a name set changed by an application of an earlier version
+// and is searched within the lock by the caller.
+int spoutSenderNames::findSenderNameNoLock(const char* sendername)
+{
+	SenderNameIndex* pIndex = getSenderNameIndex();
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pIndex || !pGeneration || !m_senderNames.Buffer())
+		return -1;
+
+	const LONG generation = InterlockedCompareExchange(&pGeneration->names, 0, 0);
+	if ((generation & 1) || InterlockedCompareExchange(&pIndex->names, 0, 0) != generation)
+		return -1;
+
+	// Earlier versions do not change the generation
+	const int count = (int)pIndex->count;
+	if (count > getSenderSlots())
+		return -1;
+	const char* pSlot = getSenderSlot(count);
+	if (pSlot && *pSlot != 0)
+		return -1;
+
+	const int slot = findSenderNameSlot(sendername, hashSenderName(sendername));
+
+	MemoryBarrier();
+	if (InterlockedCompareExchange(&pGeneration->names, 0, 0) != generation
+		|| InterlockedCompareExchange(&pIndex->names, 0, 0) != generation)
+		return -1;
+
+	return (slot >= 0) ? 1 : 0;
+}
+
+// Read the sender name set without the map mutex.
+// Names are copied up to the first empty entry and the copy
+// is retried if a writer changed the generation meanwhile.
+// The copy is not used if the checksum is not the one recorded
+// with the generation, because the set has been changed by an
+// application of an earlier version, and the set is then read
+// within the map mutex. If the names are the same as the last read,
+// the previous set is used.
+bool spoutSenderNames::readSenderSetNoLock(std::set<std::string>& SenderNames)
+{
+	if (!readSenderSetCache())
+		return false;
+	SenderNames = *m_pSetCache;
+	return true;
+}
+
+// Update the name set cache without the map mutex.
+// The names are read to a retained buffer and the set
+// is parsed again only if they differ from the last read.
+bool spoutSenderNames::readSenderSetCache()
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pGeneration || !m_senderNames.Buffer())
+		return false;
+
+	// Names in the sender names map and segments
+	const int nSenders = getSenderSlots();
+	if (nSenders <= 0)
+		return false;
+
+	char name[SpoutMaxSenderNameLen]={};
+	std::vector<char> &names = *m_pNamesRead;
+	for (int tries = 0; tries < 4; tries++) {
+		const LONG generation = InterlockedCompareExchange(&pGeneration->names, 0, 0);
+		if (generation & 1) {
+			// A writer is changing the set
+			YieldProcessor();
+			continue;
+		}
+		const LONG checksum = InterlockedCompareExchange(&pGeneration->checksum, 0, 0);
+		if (checksum == 0)
+			return false; // Not recorded, use the lock
+		uint32_t namesum = 2166136261u;
+		names.clear();
+		for (int i = 0; i < nSenders; i++) {
+			const char* src = getSenderSlot(i);
+			if (!src) break;
+			memcpy(name, src, SpoutMaxSenderNameLen);
+			name[SpoutMaxSenderNameLen-1] = 0;
+			if (!name[0]) break;
+			namesum = checksumSenderName(namesum, name);
+			names.insert(names.end(), name, name+SpoutMaxSenderNameLen);
+		}
+		MemoryBarrier();
+		if (InterlockedCompareExchange(&pGeneration->names, 0, 0) == generation) {
+			// Changed without the generation, use the lock
+			if ((LONG)(namesum | 1) != checksum)
+				return false;
+			// Consistent copy. Parse it unless it is the same as last time.
+			if (names != *m_pNamesCache) {
+				m_pSetCache->clear();
+				for (size_t j = 0; j < names.size(); j += SpoutMaxSenderNameLen)
+					m_pSetCache->insert(&names[j]);
+				m_pNamesCache->swap(names);
+			}
+			return true;
+		}
+	}
+
+	// Changed during every try, use the lock
+	return false;
+}
+
+// Update the name set cache, with the map mutex
+// if the names changed during every read without it
+bool spoutSenderNames::updateSenderSetCache()
+{
+	if (!CreateSenderSet())
+		return false;
+
+	if (readSenderSetCache())
+		return true;
+
+	char* pBuf = m_senderNames.Lock();
+	if (!pBuf)
+		return false;
+	readSenderSet(pBuf, *m_pSetCache);
+	setSenderSetChecksum(getSenderSetChecksum());
+	// Parsed again on the next read without the lock
+	m_pNamesCache->clear();
+	m_senderNames.Unlock();
+
+	return true;
+}
+
+// Copy sender names from the sender names map and segments
+// up to the first empty slot. Returns the number of names,
+// or the number of senders if names is null.
+// The checksum of all the names is returned if pChecksum is not null.
+int spoutSenderNames::copySenderNames(char* names, int maxsenders, int maxlength, uint32_t* pChecksum)
+{
+	const int nSenders = getSenderSlots();
+	// Limit to the slot size
+	const rsize_t maxchars = (rsize_t)((maxlength < SpoutMaxSenderNameLen ? maxlength : SpoutMaxSenderNameLen) - 1);
+	uint32_t checksum = 2166136261u;
+	int count = 0;
+	for (int i = 0; i < nSenders; i++) {
+		const char* pSlot = getSenderSlot(i);
+		if (!pSlot || !pSlot[0])
+			break;
+		if (pChecksum)
+			checksum = checksumSenderName(checksum, pSlot);
+		if (names && count < maxsenders)
+			strncpy_s(names + (size_t)count*maxlength, (rsize_t)maxlength, pSlot, maxchars);
+		else if (names && !pChecksum)
+			break;
+		count++;
+	}
+	if (pChecksum)
+		*pChecksum = checksum | 1;
+	if (names && count > maxsenders)
+		count = maxsenders;
+	return count;
+}
+
+// Copy sender names without the map mutex.
+// The copy is retried if a writer changed the generation meanwhile.
+// Returns -1 if the names changed during every try, or if the
+// checksum is not the one recorded with the generation.
+int spoutSenderNames::readSenderNamesNoLock(char* names, int maxsenders, int maxlength)
+{
+	SenderSetGeneration* pGeneration = getSenderSetGeneration();
+	if (!pGeneration || !m_senderNames.Buffer())
+		return -1;
+
+	for (int tries = 0; tries < 4; tries++) {
+		const LONG generation = InterlockedCompareExchange(&pGeneration->names, 0, 0);
+		if (generation & 1) {
+			// A writer is changing the set
+			YieldProcessor();
+			continue;
+		}
+		const LONG checksum = InterlockedCompareExchange(&pGeneration->checksum, 0, 0);
+		if (checksum == 0)
+			return -1;
+		uint32_t namesum = 0;
+		const int count = copySenderNames(names, maxsenders, maxlength, &namesum);
+		MemoryBarrier();
+		if (InterlockedCompareExchange(&pGeneration->names, 0, 0) == generation)
+			return ((LONG)namesum == checksum) ? count : -1;
+	}
+
+	return -1;
+}
+
 bool spoutSenderNames::GetSenderSet(std::set<std::string>& SenderNames) {
 
 	char* pBuf = nullptr;
@@ -1106,6 +3297,10 @@ bool spoutSenderNames::GetSenderSet(std::set<std::string>& SenderNames) {
 		return false;
 	}
 
+	// Read without locking if possible
+	if (readSenderSetNoLock(SenderNames))
+		return true;
+
 	pBuf = m_senderNames.Lock();
 	if (!pBuf) {
 		return false;
@@ -1114,6 +3309,7 @@ bool spoutSenderNames::GetSenderSet(std::set<std::string>& SenderNames) {
 	// The data has been stored with 256 bytes reserved for each Sender name
 	// and nothing will have changed with the map yet
 	if(!*pBuf) { // no senders yet
+		setSenderSetChecksum(getSenderSetChecksum());
 		m_senderNames.Unlock();
 		return true;
 	}
@@ -1121,7 +3317,8 @@ bool spoutSenderNames::GetSenderSet(std::set<std::string>& SenderNames) {
 	// Read back from the mapped memory buffer and rebuild the set that was passed in
 	// The set will then contain the senders currently in the memory map
 	// and allow for any that have been added or deleted
-	readSenderSetFromBuffer(pBuf, SenderNames, m_MaxSenders);
+	readSenderSet(pBuf, SenderNames);
+	setSenderSetChecksum(getSenderSetChecksum());
 
 	m_senderNames.Unlock();
 
@@ -1189,6 +3386,16 @@ bool spoutSenderNames::getActiveSenderName(char *SenderName, const int maxchars)
 // Does not have to be the info of this instance
 // so the creation pointer and handle may not be known
 bool spoutSenderNames::getSharedInfo(const char* sharedMemoryName, SharedTextureInfo* info) 
+{
+	if (m_bInfoCache && getCachedInfo(sharedMemoryName, info))
+		return true;
+
+	return openSharedInfo(sharedMemoryName, info);
+
+} // end getSharedInfo
+
+// Open the sender information map, read and close again
+bool spoutSenderNames::openSharedInfo(const char* sharedMemoryName, SharedTextureInfo* info) 
 {
 	SpoutSharedMemory mem;
 	// Open is possibly faster than Create because the function is called all the time
@@ -1203,7 +3410,119 @@ bool spoutSenderNames::getSharedInfo(const char* sharedMemoryName, SharedTexture
 
 	return false;
 
-} // end getSharedInfo
+} // end openSharedInfo
+
+//---------------------------------------------------------
+// Function: SetSenderInfoCache
+// Keep sender information maps open between getSharedInfo calls
+//
+//   A receiver that checks sender information every frame then avoids
+//   opening and closing the map each time. The maps are closed 
+//   when the sender change count changes (see GetSenderGeneration)
+//   and at one second intervals, so that a closed sender is detected 
+//   if it is an earlier Spout version that does not change the count.
+//   Only senders in the sender name list are cached.
+//   Disabled by default.
+void spoutSenderNames::SetSenderInfoCache(bool bCache)
+{
+	m_bInfoCache = bCache;
+	if (!bCache)
+		clearInfoCache();
+}
+
+//---------------------------------------------------------
+// Function: GetSenderInfoCache
+// Sender information cache status
+bool spoutSenderNames::GetSenderInfoCache()
+{
+	return m_bInfoCache;
+}
+
+// Read sender information from a cached map
+bool spoutSenderNames::getCachedInfo(const char* sendername, SharedTextureInfo* info)
+{
+	if (!sendername || !*sendername || !info)
+		return false;
+
+	// Close the cached maps if a sender has changed or at intervals
+	const LONG generation = GetSenderGeneration();
+	const DWORD dwNow = GetTickCount();
+	if (generation != m_InfoGeneration || (dwNow - m_dwInfoTime) > 1000) {
+		clearInfoCache();
+		m_InfoGeneration = generation;
+		m_dwInfoTime = dwNow;
+	}
+
+	SpoutSharedMemory* mem = nullptr;
+	const auto itr = m_pInfoCache->find(sendername);
+	if (itr != m_pInfoCache->end()) {
+		mem = itr->second;
+	}
+	else {
+		// Only cache registered senders
+		if (!FindSenderName(sendername))
+			return false;
+		mem = new SpoutSharedMemory();
+		if (!mem->Open(sendername)) {
+			delete mem;
+			return false;
+		}
+		(*m_pInfoCache)[sendername] = mem;
+	}
+
+	return readSharedInfo(mem, info);
+
+}
+
+// Read sender information from an open map.
+// The information is copied without the map mutex if the sender records
+// the information change count. The copy is consistent if the count is even
+// before the copy and unchanged after it, and is retried otherwise.
+// The mutex is used for a sender of an earlier version without the count,
+// or if the sender is writing during every try.
+bool spoutSenderNames::readSharedInfo(SpoutSharedMemory* mem, SharedTextureInfo* info)
+{
+	const char* pBuf = mem->Buffer();
+	if (!pBuf)
+		return false;
+
+	const SharedSenderAlive* pAlive = getSenderAlive(mem);
+	if (pAlive && pAlive->processId != 0) {
+		volatile LONG* pChanges = (volatile LONG*)&pAlive->changes;
+		for (int tries = 0; tries < 4; tries++) {
+			const LONG changes = InterlockedCompareExchange(pChanges, 0, 0);
+			if (changes & 1) {
+				// The sender is writing
+				YieldProcessor();
+				continue;
+			}
+			memcpy((void*)info, (const void*)pBuf, sizeof(SharedTextureInfo));
+			MemoryBarrier();
+			if (InterlockedCompareExchange(pChanges, 0, 0) == changes)
+				return true;
+		}
+	}
+
+	pBuf = mem->Lock();
+	if (!pBuf)
+		return false;
+	__movsd((unsigned long *)info, (unsigned long const *)pBuf, sizeof(SharedTextureInfo) / 4);
+	mem->Unlock();
+
+	return true;
+
+}
+
+// Close all cached sender information maps
+void spoutSenderNames::clearInfoCache()
+{
+	if (!m_pInfoCache)
+		return;
+	for (auto itr = m_pInfoCache->begin(); itr != m_pInfoCache->end(); itr++) {
+		delete itr->second;
+	}
+	m_pInfoCache->clear();
+}
 
 // 12.06.15 - Added to allow direct modification of a sender's information in shared memory
 bool spoutSenderNames::setSharedInfo(const char* sharedMemoryName, const SharedTextureInfo* info) 
@@ -1220,8 +3539,12 @@ bool spoutSenderNames::setSharedInfo(const char* sharedMemoryName, const SharedT
 		return false;
 	}
 
+	beginSenderInfoChange(&mem);
 	__movsd((unsigned long *)pBuf, (unsigned long const *)info, sizeof(SharedTextureInfo) / 4); // 280 bytes
 
+	// Let a connected receiver know
+	setSenderInfoChange(&mem);
+
 	mem.Unlock();
 	
 	return true;
@@ -69,16 +69,314 @@
 // https://msdn.microsoft.com/en-us/library/aa384267%28VS.85%29.aspx
 // in SpoutGLDXinterop.cpp and SpoutSenderNames
 //
+// The low byte of the usage field is the number of views of an array
+// texture sender (SetSenderArraySize). Zero or one for a single texture.
+// The next byte is the number of mip levels of a sender texture with
+// a mip chain (SetSenderMipLevels). Zero or one for no mip chain.
+// The next bit is set if the sender texture is shared by a named NT handle
+// (SetSenderNTHandle). The shareHandle field is then the identifier of the
+// texture name rather than a handle (see spoutDirectX::GetSharedTextureName).
+//
+#define SPOUT_USAGE_ARRAY_MASK 0x000000FF
+#define SPOUT_USAGE_MIPS_MASK  0x0000FF00
+#define SPOUT_USAGE_MIPS_SHIFT 8
+#define SPOUT_USAGE_NTHANDLE   0x00010000
+
 struct SharedTextureInfo {		// 280 bytes total
 	uint32_t shareHandle;		// 4 bytes : texture handle
 	uint32_t width;				// 4 bytes : texture width
 	uint32_t height;			// 4 bytes : texture height
 	uint32_t format;			// 4 bytes : texture pixel format
-	uint32_t usage;				// 4 bytes : texture usage
+	uint32_t usage;				// 4 bytes : texture usage (array size in the low byte)
 	uint8_t  description[256];	// 256 bytes : description
 	uint32_t partnerId;			// 4 bytes : ID
 };
 
+//
+// Shared texture ring information saved to shared memory "<sendername>_SpoutRing"
+// by a sender that writes to more than one shared texture.
+// The index of the last texture written is updated atomically and can be read
+// by a receiver without locking.
+// A D3D12 sender (spoutDX12::SetDX12TextureRing) shares the textures by named
+// NT handles "<sendername>_SpoutRing_<id>" with the identifiers in place of the
+// share handles, and signals a shared fence with the frame number when each
+// texture has been written. Receivers wait for the frame on the GPU.
+// The textures of a D3D11 sender have a keyed mutex which the sender
+// acquires while writing and receivers acquire while copying.
+//
+#define SPOUT_RING_NTNAME 1 // Textures opened by name
+#define SPOUT_RING_FENCE  2 // Fence signalled with the frame number
+#define SPOUT_RING_KEYED  4 // Textures with a keyed mutex
+
+struct SharedTextureRing {		// 64 bytes total
+	uint32_t count;				// 4 bytes : number of textures (2-4)
+	volatile LONG index;		// 4 bytes : index of the last texture written
+	uint32_t shareHandle[4];	// 16 bytes : texture handles
+	uint32_t width;				// 4 bytes : texture width
+	uint32_t height;			// 4 bytes : texture height
+	uint32_t format;			// 4 bytes : texture pixel format
+	uint32_t ordered;			// 4 bytes : receivers read frames in order (send queue)
+	volatile LONG64 frame;		// 8 bytes : number of frames written
+	uint32_t flags;				// 4 bytes : SPOUT_RING_NTNAME, SPOUT_RING_FENCE
+	uint32_t processId;			// 4 bytes : sender process for the fence handle
+	uint64_t fenceHandle;		// 8 bytes : NT handle of the sender fence
+};
+
+//
+// Preview texture information saved to shared memory "<sendername>_SpoutPreview"
+// by a sender that also writes a reduced size copy of its texture.
+// SharedTextureInfo is unchanged for compatibility with existing receivers.
+// The frame count is incremented after each preview update.
+// The same layout is used for the NV12 or P010 texture "<sendername>_SpoutYUV"
+// with level zero (see spoutDX::SetYUVFormat).
+//
+struct SharedTexturePreview {	// 32 bytes total
+	uint32_t shareHandle;		// 4 bytes : preview texture handle
+	uint32_t width;				// 4 bytes : preview width
+	uint32_t height;			// 4 bytes : preview height
+	uint32_t format;			// 4 bytes : texture format
+	uint32_t level;				// 4 bytes : mip level of the sender texture
+	uint32_t reserved;			// 4 bytes : alignment
+	volatile LONG64 frame;		// 8 bytes : number of previews written
+};
+
+//
+// Receiver image requests saved to shared memory "<sendername>_SpoutImages"
+// by a sender that converts pixels once for all receivers of the same image
+// format and size (see spoutDX::SetSharedImages). A receiver claims an entry
+// and renews the request time while it receives. The sender writes each
+// requested image to "<sendername>_SpoutImage_<width>x<height>_<flags>".
+// An entry that is not renewed for SPOUT_IMAGE_TIMEOUT msec is free again.
+//
+#define SPOUT_SHARED_IMAGES 4 // image formats converted by the sender
+#define SPOUT_IMAGE_RGB 1 // 3 bytes per pixel
+#define SPOUT_IMAGE_INVERT 2 // bottom line first
+#define SPOUT_IMAGE_TIMEOUT 2000 // msec before a request expires
+#define SPOUT_IMAGE_FREE 0
+#define SPOUT_IMAGE_CLAIMED 1 // entry being written by a receiver
+#define SPOUT_IMAGE_REQUESTED 2
+
+struct SharedImageRequest {		// 24 bytes total
+	volatile LONG state;		// 4 bytes : free, claimed or requested
+	uint32_t flags;				// 4 bytes : SPOUT_IMAGE_RGB and SPOUT_IMAGE_INVERT
+	uint32_t width;				// 4 bytes : image width
+	uint32_t height;			// 4 bytes : image height
+	volatile LONG64 time;		// 8 bytes : time of the last request (GetTickCount64)
+};
+
+//
+// Header of a shared image followed by two pixel buffers of pitch*height bytes.
+// The sequence of a buffer is odd while it is written. "index" is the
+// buffer last written, so that a receiver copies one while the sender
+// writes the other.
+//
+struct SharedImageHeader {		// 48 bytes total
+	volatile LONG index;		// 4 bytes : buffer last written
+	uint32_t pitch;				// 4 bytes : bytes per line
+	uint32_t width;				// 4 bytes : image width
+	uint32_t height;			// 4 bytes : image height
+	volatile LONG64 sequence[2];// 16 bytes : write sequence of each buffer
+	volatile LONG64 frame[2];	// 16 bytes : frame number of each buffer
+};
+
+//
+// Frame read back by a receiver and shared with other receivers of the sender
+// in shared memory "<sendername>_SpoutFrameCache_<width>x<height>_<format>"
+// (see spoutDX::SetFrameCache). Two slots of pitch*height bytes of the sender
+// format follow the header. "claim" is the sender frame that a receiver is
+// reading back. One receiver at a time writes a slot and the sequence of
+// the slot is odd while it is written.
+//
+#define SPOUT_FRAMECACHE_WAIT 4 // msec to wait for another receiver
+struct SharedFrameCache {		// 64 bytes total
+	uint32_t width;				// 4 bytes : sender width
+	uint32_t height;			// 4 bytes : sender height
+	uint32_t format;			// 4 bytes : sender texture format
+	uint32_t pitch;				// 4 bytes : bytes per line of a slot
+	volatile LONG64 claim;		// 8 bytes : sender frame being read back
+	volatile LONG64 sequence[2];// 16 bytes : write sequence of each slot
+	volatile LONG64 frame[2];	// 16 bytes : sender frame of each slot
+	volatile LONG index;		// 4 bytes : slot last written
+	volatile LONG writer;		// 4 bytes : non zero while a receiver writes a slot
+};
+
+//
+// Atlas region information saved to shared memory "<sendername>_SpoutAtlas"
+// by a sub-sender of an atlas sender (see spoutDX::AddAtlasSender).
+// The sub-sender SharedTextureInfo has the atlas texture handle and the
+// region size. Receivers copy the region and use the access mutex and
+// frame count of the atlas sender.
+//
+struct SharedAtlasRegion {		// 272 bytes total
+	uint8_t  atlas[256];		// 256 bytes : atlas sender name
+	uint32_t x;					// 4 bytes : region left
+	uint32_t y;					// 4 bytes : region top
+	uint32_t width;				// 4 bytes : region width
+	uint32_t height;			// 4 bytes : region height
+};
+
+//
+// Replicas of a sender texture on other graphics adapters saved to shared memory
+// "<sendername>_SpoutReplicas" (see spoutDX::AddSenderReplica). The sender reads
+// back each frame once and updates the replica on every adapter. A receiver that
+// cannot open the sender texture opens the replica on the adapter of its device.
+// Receivers use the access mutex and frame count of the sender.
+// Entries with a zero share handle are not used.
+//
+#define SPOUT_MAX_REPLICAS 4
+struct SharedTextureReplica {	// 32 bytes total
+	LUID adapter;				// 8 bytes : adapter of the replica texture
+	uint32_t shareHandle;		// 4 bytes : replica texture handle
+	uint32_t width;				// 4 bytes : texture width
+	uint32_t height;			// 4 bytes : texture height
+	uint32_t format;			// 4 bytes : texture format
+	volatile LONG64 frame;		// 8 bytes : number of frames written
+};
+
+//
+// Sender name set generation saved to shared memory "SpoutSenderNamesGeneration".
+// "names" is odd while the sender name set is being written.
+// "changes" is incremented when any sender is created, updated or released
+// so that a receiver can test for a change by comparing one value.
+// "checksum" is the checksum of the name set written with "names".
+// Applications of earlier versions change the name set within the map lock
+// without the generation. The set is read without the lock only if its
+// checksum is the same, and otherwise within the lock.
+//
+struct SenderSetGeneration {	// 64 bytes total
+	volatile LONG names;		// 4 bytes : sender name set write generation
+	volatile LONG changes;		// 4 bytes : sender change count
+	volatile LONG segments;		// 4 bytes : number of sender name segments
+	volatile LONG checksum;		// 4 bytes : name set checksum, zero if not recorded
+	uint32_t reserved[12];		// 48 bytes : reserved
+};
+
+//
+// Sender names after a full "SpoutSenderNames" map continue in segments
+// "SpoutSenderNames_1", "SpoutSenderNames_2" etc. of SPOUT_SEGMENT_SENDERS names.
+// Applications of earlier versions find the names in the first map only.
+//
+#define SPOUT_SEGMENT_SENDERS 64 // names in each segment
+#define SPOUT_SENDER_SEGMENTS 16 // maximum number of segments
+
+//
+// Sender liveness saved in the sender information map following SharedTextureInfo.
+// The process is recorded when the sender is created or updated, and the
+// heartbeat is updated by sending at SPOUT_HEARTBEAT_INTERVAL msec intervals.
+// The information change count is incremented before and after the sender
+// information is written, so that a receiver can test one value for a change.
+// The count is odd while the information is being written, and a copy
+// without the map mutex is consistent if the count is even and unchanged.
+// A sender with a recent heartbeat is alive without any further check,
+// otherwise the process is tested. The process creation time distinguishes
+// a new process with the same ID. The adapter of the shared texture is
+// recorded by the sender (SetSenderAdapterLuid).
+// All zero for senders of earlier versions.
+//
+#define SPOUT_HEARTBEAT_INTERVAL 500 // msec between heartbeat updates
+#define SPOUT_HEARTBEAT_TIMEOUT 2000 // msec before the process is tested
+
+struct SharedSenderAlive {		// 32 bytes total
+	uint32_t processId;			// 4 bytes : sender process ID
+	volatile LONG changes;		// 4 bytes : sender information change count
+	uint64_t processTime;		// 8 bytes : sender process creation time (FILETIME)
+	volatile LONG64 heartbeat;	// 8 bytes : time of the last update (GetTickCount64)
+	LUID adapter;				// 8 bytes : adapter of the sender texture
+};
+
+//
+// Sender ID saved in the sender information map following SharedSenderAlive.
+// Each sender is assigned a 64 bit ID when the information map is created.
+// IDs are not used again and the ID of a sender does not change until it
+// is released, so that a receiver can find a sender without comparing names.
+// Zero for senders of earlier versions.
+//
+struct SharedSenderUID {		// 16 bytes total
+	volatile LONG64 uid;		// 8 bytes : sender ID
+	uint64_t reserved;			// 8 bytes : reserved
+};
+
+//
+// Sender ID table saved to shared memory "SpoutSenderUIDs".
+// An open addressing table of the IDs of current senders with their names,
+// probed from the low bits of the ID. Written within the sender names map
+// lock and read without it. An entry name is written before the ID, and
+// the ID is read again after the name is copied. "write" is odd while the
+// table is rebuilt to remove deleted entries. "next" is the last ID assigned.
+// The entries follow the header.
+//
+#define SPOUT_SENDERUID_ENTRIES 2048 // power of two
+#define SPOUT_SENDERUID_EMPTY   0ULL
+#define SPOUT_SENDERUID_DELETED 0xFFFFFFFFFFFFFFFFULL
+
+struct SenderUIDEntry {			// 264 bytes total
+	volatile LONG64 uid;		// 8 bytes : sender ID, empty or deleted
+	char name[SpoutMaxSenderNameLen]; // 256 bytes : sender name
+};
+
+struct SenderUIDTable {			// 32 bytes total
+	volatile LONG64 next;		// 8 bytes : last ID assigned
+	volatile LONG write;		// 4 bytes : table write generation (odd while rebuilt)
+	uint32_t capacity;			// 4 bytes : number of entries (power of two)
+	uint32_t count;				// 4 bytes : number of IDs in the table
+	uint32_t deleted;			// 4 bytes : number of deleted entries
+	uint32_t reserved[2];		// 8 bytes : reserved
+};
+
+//
+// Sender details returned for all senders by GetSenderList
+//
+struct SpoutSenderDetails {
+	char name[SpoutMaxSenderNameLen]; // Sender name
+	unsigned int width; // Texture width
+	unsigned int height; // Texture height
+	DWORD format; // Texture format
+	HANDLE shareHandle; // Texture share handle
+	double fps; // Sender frame rate, zero if not recorded
+	LONG64 frame; // Last frame sent, zero without frame counting
+	LUID adapter; // Sender adapter, zero if not recorded
+	char hostpath[256]; // Sender executable path
+};
+
+//
+// Sender in the snapshot published by the sender service (StartSenderService)
+//
+struct SpoutSenderSnapshotEntry {
+	char name[SpoutMaxSenderNameLen]; // Sender name
+	SharedTextureInfo info; // Sender information
+};
+
+//
+// Sender name index saved to shared memory "SpoutSenderNamesIndex".
+// An open addressing hash table of the names in "SpoutSenderNames" so that
+// a sender name can be found, registered or released without reading the
+// whole name set. Each entry has the hash of a name and its slot in the
+// sender names map. New names are added after the last and a released
+// name is replaced by the last, so that the set remains compatible with
+// earlier versions. Written within the sender names map lock.
+// "names" is the name set generation (SenderSetGeneration) that the index
+// is valid for, and "count" the number of names in the set.
+// The entries follow the header.
+//
+#define SPOUT_NAMEINDEX_VERSION 1
+#define SPOUT_NAMEINDEX_EMPTY   -1
+#define SPOUT_NAMEINDEX_DELETED -2
+
+struct SenderNameIndexEntry {	// 8 bytes total
+	uint32_t hash;				// 4 bytes : hash of the sender name
+	int32_t slot;				// 4 bytes : slot in the sender names map, empty or deleted
+};
+
+struct SenderNameIndex {		// 32 bytes total
+	uint32_t size;				// 4 bytes : size of the header
+	uint32_t version;			// 4 bytes : index version
+	volatile LONG names;		// 4 bytes : name set generation indexed (odd if not valid)
+	uint32_t count;				// 4 bytes : number of names in the set
+	uint32_t capacity;			// 4 bytes : number of entries (power of two)
+	uint32_t deleted;			// 4 bytes : number of deleted entries
+	uint32_t reserved[2];		// 8 bytes : reserved
+};
+
 //
 // GUIDs for additional sender information maps
 // Used for development work
@@ -111,18 +409,35 @@ class SPOUT_DLLEXP spoutSenderNames {
 		// Find a name in the list
 		bool FindSenderName(const char* sendername);
 
+		//
+		// Sender IDs
+		//
+
+		// ID of a sender, zero if not found or an earlier version
+		uint64_t GetSenderUID(const char* sendername);
+		// Find a sender by ID and optionally return the name
+		static bool FindSenderUID(uint64_t uid, char* sendername = nullptr, int maxlength = SpoutMaxSenderNameLen);
+		// Sender information by ID
+		bool GetSenderUIDInfo(uint64_t uid, SharedTextureInfo* info);
+		// Close sender information maps retained by GetSenderUIDInfo
+		void CloseSenderUIDInfo();
+
 		//
 		// Functions to retrieve info about the sender set map and the senders in it
 		//
 
 		// Retrieve the sender name list as a set of names
 		bool GetSenderNames(std::set<std::string> *sendernames);
+		// Copy the sender names to a buffer without allocation
+		int GetSenderNames(char* names, int maxsenders, int maxlength = SpoutMaxSenderNameLen);
 		// Number of senders in the list
 		int  GetSenderCount();
 		// Sender item name
 		bool GetSender(int index, char* sendername, int MaxSize = 256);
 		// Information about a sender from an index into the list
 		bool GetSenderNameInfo(int index, char* sendername, int sendernameMaxSize, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle);
+		// Details of all senders in one call
+		int GetSenderList(SpoutSenderDetails* pSenders, int maxsenders);
 
 
 		//
@@ -134,6 +449,8 @@ class SPOUT_DLLEXP spoutSenderNames {
 		int GetMaxSenders();
 		// Set the maximum number of senders in a new sender map
 		void SetMaxSenders(int maxSenders);
+		// Number of senders that can be registered including name segments
+		int GetSenderCapacity();
 
 		//
 		// Functions to read and write info to a sender memory map
@@ -145,12 +462,32 @@ class SPOUT_DLLEXP spoutSenderNames {
 		bool SetSenderInfo (const char* sendername, unsigned int width, unsigned int height, HANDLE dxShareHandle, DWORD dwFormat);
 		// Set sender PartnerID field with "CPU" sharing method and GL/DX compatibility
 		bool SetSenderID(const char *sendername, bool bCPU, bool bGLDX);
+		// Set the number of views of an array texture sender to the usage field
+		bool SetSenderArraySize(const char *sendername, unsigned int arraysize);
+		// Number of views of the sender texture (1 for a single texture)
+		unsigned int GetSenderArraySize(const char *sendername);
+		// Set the number of mip levels of the sender texture to the usage field
+		bool SetSenderMipLevels(const char *sendername, unsigned int miplevels);
+		// Number of mip levels of the sender texture (1 without a mip chain)
+		unsigned int GetSenderMipLevels(const char *sendername);
+		// Record that the sender texture is shared by a named NT handle
+		bool SetSenderNTHandle(const char *sendername, bool bNThandle);
+		// Sender texture shared by a named NT handle
+		bool GetSenderNTHandle(const char *sendername);
+		// Record the adapter of the sender texture
+		bool SetSenderAdapterLuid(const char *sendername, LUID luid);
+		// Adapter of the sender texture if recorded
+		bool GetSenderAdapterLuid(const char *sendername, LUID &luid);
 		// Generic sender map info read (returned in a shared texture information structure)
 		bool getSharedInfo (const char* sendername, SharedTextureInfo* info);
 		// Generic sender map info write
 		bool setSharedInfo (const char* sendername, const SharedTextureInfo* info);
 		// Test for shared info memory map existence
 		bool hasSharedInfo(const char* sendername);
+		// Keep sender information maps open between getSharedInfo calls
+		void SetSenderInfoCache(bool bCache = true);
+		// Sender information cache status
+		bool GetSenderInfoCache();
 
 		//
 		// Functions to maintain the active sender
@@ -182,6 +519,42 @@ class SPOUT_DLLEXP spoutSenderNames {
 		bool FindSender   (const char* sendername);
 		// Release orphaned senders
 		void CleanSenders();
+		// Sender update of the heartbeat while sending
+		void SetSenderHeartbeat(const char* sendername);
+		// Test whether the sender process is running
+		bool IsSenderAlive(const char* sendername);
+		// Release orphaned senders on a thread at intervals
+		bool StartSenderCleanup(DWORD dwInterval = 1000);
+		// Stop the cleanup thread
+		void StopSenderCleanup();
+
+		//
+		// Sender service
+		//
+
+		// Start the process sender service thread
+		static bool StartSenderService(DWORD dwInterval = 100);
+		// Stop the sender service when all users have stopped it
+		static void StopSenderService();
+		// Sender service status
+		static bool IsSenderServiceRunning();
+		// Copy of the sender snapshot
+		static bool GetSenderSnapshot(std::vector<SpoutSenderSnapshotEntry>& senders, char* activesender = nullptr, int maxlength = SpoutMaxSenderNameLen);
+
+		//
+		// Sender change notification
+		//
+
+		// Sender change count
+		LONG GetSenderGeneration();
+		// Test for sender change since a previous check
+		bool CheckSenderChange(LONG &generation, DWORD &dwTime, DWORD dwInterval = 1000);
+		// Wait for a sender change
+		bool WaitSenderChange(LONG generation, DWORD dwTimeout = SPOUT_WAIT_TIMEOUT);
+		// Test for a change of the information of a connected sender
+		bool CheckSenderInfoChange(const char* sendername, LONG &changes, LONG &generation, DWORD &dwTime, DWORD dwInterval = 1000);
+		// Close the sender information map retained by CheckSenderInfoChange
+		void CloseSenderInfoChange();
 
 protected:
 
@@ -202,8 +575,113 @@ protected:
 		static void readSenderSetFromBuffer(const char* buffer, std::set<std::string>& SenderNames, int maxSenders);
 		static void	writeBufferFromSenderSet(const std::set<std::string>& SenderNames, char *buffer, int maxSenders);
 
+		// Sender name set generation for reading without the map mutex
+		// Written within the map lock
+		void writeSenderSet(const std::set<std::string>& SenderNames, char* buffer);
+		// Read without locking, retry if the generation changes
+		bool readSenderSetNoLock(std::set<std::string>& SenderNames);
+		// Update the name set cache without locking if the names have changed
+		bool readSenderSetCache();
+		// Update the name set cache, with the lock if necessary
+		bool updateSenderSetCache();
+		// Copy names from the sender name slots to a buffer
+		int copySenderNames(char* names, int maxsenders, int maxlength, uint32_t* pChecksum = nullptr);
+		// Copy names without locking, -1 if changed during every try
+		int readSenderNamesNoLock(char* names, int maxsenders, int maxlength);
+		SenderSetGeneration* getSenderSetGeneration();
+		// Increment the sender change count
+		void setSenderChange();
+		// Start and end a change of the locked sender names buffer
+		void beginSenderSetWrite();
+		void endSenderSetWrite();
+		// Read the locked sender names buffer and segments
+		void readSenderSet(const char* buffer, std::set<std::string>& SenderNames);
+		// Checksum of the names in the locked sender names buffer and segments
+		LONG getSenderSetChecksum();
+		// Record the checksum of a name set read within the lock
+		void setSenderSetChecksum(LONG checksum);
+		// Add a name to a name set checksum
+		static uint32_t checksumSenderName(uint32_t checksum, const char* sendername);
+
+		// Sender name segments
+		// Number of name slots in the sender names map
+		int getPrimarySlots();
+		// Number of name slots including the segments created
+		int getSenderSlots();
+		// Number of name slots including all segments
+		int getMaxSenderSlots();
+		// Name slot in the sender names map or a segment
+		char* getSenderSlot(int slot, bool bCreate = false);
+		bool openSenderSegment(int segment, bool bCreate);
+		void openSenderSegments();
+		// Move segment names to a sender names map compacted by an earlier version
+		bool checkSenderSegments();
+
+		// Sender name index
+		SenderNameIndex* getSenderNameIndex();
+		SenderNameIndexEntry* getSenderNameEntries();
+		// Check the index within the map lock and rebuild it if out of date
+		bool checkSenderNameIndex();
+		void buildSenderNameIndex();
+		// Slot of a name and its index entry, -1 if not found
+		int findSenderNameSlot(const char* sendername, uint32_t hash, int* pEntry = nullptr);
+		void insertSenderNameIndex(uint32_t hash, int slot);
+		// Slot of a name within the map lock, searching the slots if not in the index
+		int findSenderSlot(const char* sendername, uint32_t hash, int* pEntry = nullptr);
+		// Slot of a name searched in the name slots within the map lock
+		int scanSenderNameSlot(const char* sendername);
+		// Find a name without the map lock. 1 found, 0 not in the index, -1 index not available
+		int findSenderNameNoLock(const char* sendername);
+		static uint32_t hashSenderName(const char* sendername);
+
+		// Sender information map read without the cache
+		bool openSharedInfo(const char* sendername, SharedTextureInfo* info);
+		// Sender information map read from the cache
+		bool getCachedInfo(const char* sendername, SharedTextureInfo* info);
+		// Close all cached sender information maps
+		void clearInfoCache();
+		// Read a sender information map without the mutex unless it is being written
+		bool readSharedInfo(SpoutSharedMemory* mem, SharedTextureInfo* info);
+
+		// Sender ID of a sender information map
+		static SharedSenderUID* getSharedSenderUID(SpoutSharedMemory* pMem);
+		// Record the ID of a sender of this process, assigned if new
+		void setSenderUID(const char* sendername, SpoutSharedMemory* pMem);
+		// Sender ID table, shared by all objects of the process
+		static SenderUIDTable* getSenderUIDTable();
+		static SenderUIDEntry* getSenderUIDEntries(SenderUIDTable* pTable);
+		// Functions within the sender names map lock
+		uint64_t registerSenderUID(const char* sendername);
+		void releaseSenderUID(const char* sendername);
+		void insertSenderUID(SenderUIDTable* pTable, uint64_t uid, const char* sendername);
+		void buildSenderUIDTable(SenderUIDTable* pTable);
+
 		SpoutSharedMemory m_senderNames;
 		SpoutSharedMemory m_activeSender;
+		SpoutSharedMemory m_senderGeneration;
+		SpoutSharedMemory m_senderIndex;
+		SpoutSharedMemory m_senderSegments[SPOUT_SENDER_SEGMENTS];
+
+		// Copy of the last sender name buffer read and the set parsed from it
+		// Pointers to avoid size differences between compilers
+		std::vector<char>* m_pNamesCache;
+		std::set<std::string>* m_pSetCache;
+		// Names read for comparison with the cache, retained to avoid allocation
+		std::vector<char>* m_pNamesRead;
+
+		// Open sender information maps used by getSharedInfo
+		// Closed when the sender change count changes or at intervals
+		std::unordered_map<std::string, SpoutSharedMemory*>* m_pInfoCache;
+		bool m_bInfoCache;
+		LONG m_InfoGeneration;
+		DWORD m_dwInfoTime;
+
+		// Sender information maps opened by GetSenderUIDInfo
+		std::unordered_map<uint64_t, SpoutSharedMemory*>* m_pUIDCache;
+
+		// Information map of a connected sender (CheckSenderInfoChange)
+		SpoutSharedMemory m_InfoChangeMap;
+		char m_InfoChangeName[256]; // Sender of the last check
 
 		// This should be a unordered_map of sender names ->SharedMemory
 		// to handle multiple inputs and outputs all going through the
@@ -213,6 +691,35 @@ protected:
 		std::unordered_map<std::string, SpoutSharedMemory*>* m_senders;
 		int m_MaxSenders; // maximum number of senders via registry
 
+		// Sender liveness
+		ULONGLONG m_HeartbeatTime; // time of the last heartbeat update
+		HANDLE m_hCleanupThread;
+		HANDLE m_hCleanupStop;
+		DWORD m_dwCleanupInterval;
+		// Liveness in a sender information map, 1 alive, 0 closed, -1 unknown
+		static SharedSenderAlive* getSenderAlive(SpoutSharedMemory* pMem);
+		static int checkSenderAlive(SpoutSharedMemory* pMem);
+		// Record the sender process and heartbeat
+		static void setSenderAlive(SpoutSharedMemory* pMem);
+		// Increment the sender information change count before writing (odd)
+		static void beginSenderInfoChange(SpoutSharedMemory* pMem);
+		// Increment the sender information change count after writing (even)
+		static void setSenderInfoChange(SpoutSharedMemory* pMem);
+		static DWORD WINAPI CleanupThread(LPVOID lpParameter);
+		void CleanupLoop();
+
+		// Sender service
+		static DWORD WINAPI ServiceThread(LPVOID lpParameter);
+		static void ServiceLoop();
+		// Snapshot functions used if the service is running
+		static bool getSnapshotCount(int &count);
+		static bool getSnapshotSender(int index, char* sendername, int maxlength, SharedTextureInfo* info);
+		static bool getSnapshotNames(char* names, int maxsenders, int maxlength, int &count);
+		static bool getSnapshotActive(char* sendername, int maxlength, SharedTextureInfo* info);
+
+		// Sender details for GetSenderList
+		bool readSenderDetails(const char* sendername, SpoutSenderDetails &details);
+
 };
 
 #endif
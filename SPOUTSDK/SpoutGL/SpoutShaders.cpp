@@ -29,10 +29,38 @@
 	========================
 
 	14.07.23 - first version
+	14.10.26 - Add Unload and Load for texture <> buffer format conversion
+			 - Add filter graph - AddFilter, ApplyFilters etc.
+			 - Add process-wide program cache and optional program binary cache
+			   CreateComputeShader returns an existing program for the same source.
+			   Programs are no longer deleted by the destructor. See ClearProgramCache.
+			 - Blur and Kuwahara use shared memory tile shaders if source and dest are different
+			   Add TuneWorkGroupSize, SetWorkGroupSize, GetWorkGroupSize
+			 - Add Resample - nearest, bilinear or box
+			 - TuneWorkGroupSize - correct log for EndTiming milliseconds
+			 - Add Draw - core profile texture draw with a cached vertex array,
+			   static vertex buffer and vertex/fragment program
+	15.10.26 - Add UnloadYUV for planar NV12 or I420 buffers
+			 - Add Hash for a content hash published with sender frames
+			 - Add Analyze and GetAnalysis for histograms and waveform
+			 - Add ToneMap for floating point textures to 8 bit sRGB
 
 */
 
-#include "spoutShaders.h"
+#include "SpoutShaders.h"
+#include <mutex> // for the program cache lock
+#include <unordered_map>
+
+// Compute programs shared by all spoutShaders objects
+// The key is the OpenGL context and the full shader source
+static std::unordered_map<std::string, GLuint> g_Programs;
+static std::mutex g_ProgramMutex;
+static bool g_bBinaryCache = false;
+
+// Work group size of the shared memory tile shaders
+// Selected by TuneWorkGroupSize when first used
+static unsigned int g_TileWgX = 0;
+static unsigned int g_TileWgY = 0;
 
 //
 // Class: spoutShaders
@@ -47,12 +75,17 @@ spoutShaders::spoutShaders() {
 
 spoutShaders::~spoutShaders() {
 
-	if (m_copyProgram > 0) glDeleteProgram(m_copyProgram);
-	if (m_brcosaProgram > 0) glDeleteProgram(m_brcosaProgram);
-	if (m_sharpenProgram > 0) glDeleteProgram(m_sharpenProgram);
-	if (m_hBlurProgram > 0) glDeleteProgram(m_hBlurProgram);
-	if (m_vBlurProgram > 0) glDeleteProgram(m_vBlurProgram);
-	if (m_kuwaharaProgram > 0) glDeleteProgram(m_kuwaharaProgram);
+	// Programs are retained by the program cache for other
+	// spoutShaders objects and deleted by ClearProgramCache
+	if (m_filterTexture[0] > 0) glDeleteTextures(2, m_filterTexture);
+	// Vertex arrays are not shared between contexts
+	if (m_drawVao > 0) glDeleteVertexArrays(1, &m_drawVao);
+	if (m_drawVbo > 0) glDeleteBuffers(1, &m_drawVbo);
+	if (m_hashBuffer > 0) glDeleteBuffers(1, &m_hashBuffer);
+	if (m_scopeBuffer[0] > 0) glDeleteBuffers(2, m_scopeBuffer);
+	for (int i = 0; i < 2; i++) {
+		if (m_scopeSync[i]) glDeleteSync(m_scopeSync[i]);
+	}
 
 }
 
@@ -97,6 +130,299 @@ bool spoutShaders::Swap(GLuint SourceID, unsigned int width, unsigned int height
 	return ComputeShader(m_swapstr, m_swapProgram, SourceID, 0, width, height);
 }
 
+//---------------------------------------------------------
+// Function: Unload
+//    Copy texture pixels to a buffer object in the final byte layout
+//    RGBA/BGRA swap, RGB packing, flip and row padding in one dispatch
+//    glFormat - GL_RGBA, GL_BGRA_EXT, GL_RGB or GL_BGR_EXT
+//    pitch    - buffer row pitch in bytes (0 for width * bytes per pixel)
+// The buffer must be at least pitch*height bytes rounded up to 4
+// and can be bound as a pixel pack buffer and mapped for read.
+// The texture internal format must be GL_RGBA8.
+bool spoutShaders::Unload(GLuint SourceID, GLuint BufferID,
+	unsigned int width, unsigned int height, unsigned int pitch,
+	GLenum glFormat, bool bInvert)
+{
+	return BufferShader(m_unloadstr, m_unloadProgram, SourceID, BufferID,
+		width, height, pitch, glFormat, bInvert, false);
+}
+
+//---------------------------------------------------------
+// Function: UnloadYUV
+//    Convert texture pixels to planar YUV in a buffer object
+//    Y plane followed by interleaved UV (NV12) or U and V planes (I420)
+//    bPlanar    - I420 (NV12 if false)
+//    bBT709     - BT.709 matrix (BT.601 if false)
+//    bFullRange - 0-255 (16-235 luma, 16-240 chroma if false)
+// Width and height are the buffer image size and must be even.
+// The texture is sampled nearest if it is a different size.
+// The buffer must be at least width*height*3/2 bytes rounded up to 4.
+// The texture internal format must be GL_RGBA8.
+bool spoutShaders::UnloadYUV(GLuint SourceID, GLuint BufferID,
+	unsigned int width, unsigned int height,
+	bool bPlanar, bool bBT709, bool bFullRange, bool bInvert)
+{
+	if (SourceID == 0 || BufferID == 0 || width < 2 || height < 2 || (width & 1) || (height & 1))
+		return false;
+
+	if (m_unloadYUVProgram == 0) {
+		m_unloadYUVProgram = CreateComputeShader(m_unloadyuvstr, 16, 16);
+		if (m_unloadYUVProgram == 0)
+			return false;
+	}
+
+	// One invocation per buffer word in groups of 256,
+	// limited to 65535 groups for each dimension
+	const unsigned int words = (width*height*3/2 + 3) / 4;
+	const unsigned int groups = (words + 255) / 256;
+	const unsigned int groupsX = groups < 65535 ? groups : 65535;
+	const unsigned int groupsY = (groups + groupsX - 1) / groupsX;
+
+	glUseProgram(m_unloadYUVProgram);
+	glBindImageTexture(0, SourceID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, BufferID);
+	glUniform1i(0, bInvert ? 1 : 0);
+	glUniform1i(1, bPlanar ? 1 : 0);
+	glUniform1i(2, (bBT709 ? 1 : 0) | (bFullRange ? 2 : 0));
+	glUniform1i(3, (GLint)width);
+	glUniform1i(4, (GLint)height);
+	glDispatchCompute(groupsX, groupsY, 1);
+	// buffer map follows
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8);
+	glUseProgram(0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Load
+//    Copy pixels from a buffer object to a texture
+//    The reverse of Unload, with the same arguments.
+bool spoutShaders::Load(GLuint BufferID, GLuint DestID,
+	unsigned int width, unsigned int height, unsigned int pitch,
+	GLenum glFormat, bool bInvert)
+{
+	return BufferShader(m_loadstr, m_loadProgram, DestID, BufferID,
+		width, height, pitch, glFormat, bInvert, true);
+}
+
+//---------------------------------------------------------
+// Function: Hash
+//    Hash of the texture content for comparison of frames
+//    Width and height are the texture size.
+//    The texture internal format must be GL_RGBA8.
+// The result is read back from a buffer of two words,
+// so waits for the GPU to complete the dispatch and any
+// commands before it. Used by a sender after the copy
+// to the shared texture, when the wait is short.
+bool spoutShaders::Hash(GLuint SourceID, unsigned int width, unsigned int height, uint64_t &hash)
+{
+	hash = 0;
+
+	if (SourceID == 0 || width == 0 || height == 0)
+		return false;
+
+	if (m_hashProgram == 0) {
+		m_hashProgram = CreateComputeShader(m_hashstr, 16, 16);
+		if (m_hashProgram == 0)
+			return false;
+	}
+
+	// Clear the result
+	const GLuint zero[2] = { 0, 0 };
+	if (m_hashBuffer == 0)
+		glGenBuffers(1, &m_hashBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_hashBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), zero, GL_STREAM_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glUseProgram(m_hashProgram);
+	glBindImageTexture(0, SourceID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_hashBuffer);
+	glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+	// buffer map follows
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glUseProgram(0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_hashBuffer);
+	const GLuint* pResult = (const GLuint*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), GL_MAP_READ_BIT);
+	if (!pResult) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return false;
+	}
+	hash = ((uint64_t)pResult[1] << 32) | (uint64_t)pResult[0];
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// Zero is reserved for no hash
+	if (hash == 0)
+		hash = 1;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Analyze
+//    Histograms and waveform of the texture content
+//    Width and height are the texture size.
+//    The texture internal format must be GL_RGBA8.
+// The result is a buffer of a few KB (SpoutScopeData) instead of the
+// whole image. Alternate buffers are used and the dispatch is not waited for.
+// Use GetAnalysis for the result, normally a frame later.
+bool spoutShaders::Analyze(GLuint SourceID, unsigned int width, unsigned int height)
+{
+	if (SourceID == 0 || width == 0 || height == 0)
+		return false;
+
+	if (m_scopeProgram == 0) {
+		m_scopeProgram = CreateComputeShader(m_scopestr, 16, 16);
+		if (m_scopeProgram == 0)
+			return false;
+	}
+
+	if (m_scopeBuffer[0] == 0)
+		glGenBuffers(2, m_scopeBuffer);
+
+	// A result not read is replaced
+	const int n = m_scopeIndex;
+	if (m_scopeSync[n]) {
+		glDeleteSync(m_scopeSync[n]);
+		m_scopeSync[n] = nullptr;
+	}
+
+	// Clear the counts
+	static const GLuint zero[SPOUT_SCOPE_WORDS] = {};
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_scopeBuffer[n]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), zero, GL_STREAM_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glUseProgram(m_scopeProgram);
+	glBindImageTexture(0, SourceID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_scopeBuffer[n]);
+	glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+	// buffer map follows
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glUseProgram(0);
+
+	m_scopeSync[n] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_scopeIndex = 1 - n;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetAnalysis
+//    Result of the latest Analyze with a completed dispatch
+//    bWait - wait for the latest dispatch to complete
+// Returns false if there is no result that has not been read.
+bool spoutShaders::GetAnalysis(SpoutScopeData &data, bool bWait)
+{
+	// The latest dispatch, or the one before it if not complete
+	int n = -1;
+	const int latest = 1 - m_scopeIndex;
+	if (m_scopeSync[latest]) {
+		const GLenum status = glClientWaitSync(m_scopeSync[latest], GL_SYNC_FLUSH_COMMANDS_BIT,
+			bWait ? 1000000000 : 0); // 1 second
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+			n = latest;
+	}
+	if (n < 0 && m_scopeSync[m_scopeIndex]) {
+		const GLenum status = glClientWaitSync(m_scopeSync[m_scopeIndex], 0, 0);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+			n = m_scopeIndex;
+	}
+	if (n < 0)
+		return false;
+
+	glDeleteSync(m_scopeSync[n]);
+	m_scopeSync[n] = nullptr;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_scopeBuffer[n]);
+	const GLuint* pResult = (const GLuint*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+		SPOUT_SCOPE_WORDS*sizeof(GLuint), GL_MAP_READ_BIT);
+	if (!pResult) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return false;
+	}
+	SpoutScopeResult(pResult, data);
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Resample
+//    Resample to a texture of different size
+//    Source and dest sizes are those of the textures.
+//    mode - 0 nearest, 1 bilinear, 2 box
+//    Box is used to reduce size by more than half.
+bool spoutShaders::Resample(GLuint SourceID, GLuint DestID,
+	unsigned int destWidth, unsigned int destHeight, int mode)
+{
+	if (SourceID == 0 || DestID == 0 || SourceID == DestID || destWidth == 0 || destHeight == 0)
+		return false;
+
+	if (m_resampleProgram == 0) {
+		m_resampleProgram = CreateComputeShader(m_resamplestr, 16, 16);
+		if (m_resampleProgram == 0)
+			return false;
+	}
+
+	glUseProgram(m_resampleProgram);
+	glBindImageTexture(0, SourceID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindImageTexture(1, DestID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glUniform1i(0, mode);
+	glDispatchCompute((destWidth + 15) / 16, (destHeight + 15) / 16, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glUseProgram(0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: ToneMap
+//    Tone map a floating point texture to an 8 bit sRGB texture
+//    The textures must be the same size.
+//    mode     - SPOUT_TONEMAP_REINHARD or SPOUT_TONEMAP_ACES
+//    exposure - scale of the linear source before mapping
+//    bInvert  - flip image
+bool spoutShaders::ToneMap(GLuint SourceID, GLuint DestID,
+	unsigned int width, unsigned int height,
+	SpoutToneMap mode, float exposure, bool bInvert)
+{
+	if (SourceID == 0 || DestID == 0 || SourceID == DestID || width == 0 || height == 0)
+		return false;
+
+	if (m_toneMapProgram == 0) {
+		m_toneMapProgram = CreateComputeShader(m_tonemapstr, 16, 16);
+		if (m_toneMapProgram == 0)
+			return false;
+	}
+
+	glUseProgram(m_toneMapProgram);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, SourceID);
+	glBindImageTexture(1, DestID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glUniform1i(0, (int)mode);
+	glUniform1f(1, exposure);
+	glUniform1i(2, bInvert ? 1 : 0);
+	glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+	glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(0);
+
+	return true;
+}
 
 //---------------------------------------------------------
 // Function: Adjust
@@ -134,6 +460,16 @@ bool spoutShaders::Sharpen(GLuint SourceID, GLuint DestID,
 bool spoutShaders::Blur(GLuint SourceID, GLuint DestID,
 	unsigned int width, unsigned int height, float amount)
 {
+	// Horizontal and vertical blur in one pass
+	if (DestID > 0 && DestID != SourceID) {
+		const float params[4] = { amount, 0.0f, 0.0f, 0.0f };
+		if (CheckTilePrograms()
+			&& GetTileProgram(m_blurTileProgram, SPOUT_FILTER_BLUR) > 0) {
+			return DispatchTiles(m_blurTileProgram, m_tileWgX, m_tileWgY,
+				SourceID, DestID, width, height, params, 4);
+		}
+	}
+
 	// Horizontal blur
 	if (ComputeShader(m_hblurstr, m_hBlurProgram, SourceID, DestID, width, height, amount)) {
 		// Vertical blur on Horizontal blur result
@@ -160,10 +496,625 @@ bool spoutShaders::Kuwahara(GLuint SourceID, GLuint DestID,
 		// printf("%s\n", m_kuwaharastr.c_str());
 	}
 	*/
+
+	// Shared memory tile
+	if (DestID > 0 && DestID != SourceID) {
+		const float params[4] = { amount, 0.0f, 0.0f, 0.0f };
+		if (CheckTilePrograms()
+			&& GetTileProgram(m_kuwaharaTileProgram, SPOUT_FILTER_KUWAHARA) > 0) {
+			return DispatchTiles(m_kuwaharaTileProgram, m_tileWgX, m_tileWgY,
+				SourceID, DestID, width, height, params, 4);
+		}
+	}
+
 	return ComputeShader(m_kuwaharastr, m_kuwaharaProgram,
 		SourceID, DestID, width, height, amount);
 }
 
+//
+// Filter graph
+//
+// Effects are added in the order they are applied.
+// Adjust operates on single pixels and is combined with the neighbourhood
+// effect before or after it. Each program loads a work group tile with a
+// border into shared memory once for all its effects, so that
+// Adjust + Sharpen or Sharpen + Adjust is one dispatch and Blur is one
+// dispatch instead of two.
+//
+// Parameters can be changed with SetFilter without compiling again.
+//
+//    Adjust   - brightness, contrast, saturation, gamma
+//    Sharpen  - width (1-3), strength
+//    Blur     - amount (0-4)
+//    Kuwahara - amount (1-8)
+//
+
+//---------------------------------------------------------
+// Function: ClearFilters
+//    Remove all effects
+void spoutShaders::ClearFilters()
+{
+	m_nFilters = 0;
+}
+
+//---------------------------------------------------------
+// Function: AddFilter
+//    Add an effect to the end of the list
+bool spoutShaders::AddFilter(SpoutFilterType type,
+	float param0, float param1, float param2, float param3)
+{
+	if (m_nFilters >= SPOUT_MAX_FILTERS) {
+		SpoutLogWarning("spoutShaders::AddFilter - maximum %d effects", SPOUT_MAX_FILTERS);
+		return false;
+	}
+	if (type < SPOUT_FILTER_ADJUST || type > SPOUT_FILTER_KUWAHARA)
+		return false;
+
+	m_filters[m_nFilters].type = type;
+	m_nFilters++;
+
+	return SetFilter(m_nFilters-1, param0, param1, param2, param3);
+}
+
+//---------------------------------------------------------
+// Function: SetFilter
+//    Change the parameters of an effect
+bool spoutShaders::SetFilter(int index,
+	float param0, float param1, float param2, float param3)
+{
+	if (index < 0 || index >= m_nFilters)
+		return false;
+
+	m_filters[index].param[0] = param0;
+	m_filters[index].param[1] = param1;
+	m_filters[index].param[2] = param2;
+	m_filters[index].param[3] = param3;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetFilterCount
+//    Number of effects
+int spoutShaders::GetFilterCount()
+{
+	return m_nFilters;
+}
+
+//---------------------------------------------------------
+// Function: GetFilterPasses
+//    Number of compute dispatches for the effects
+int spoutShaders::GetFilterPasses()
+{
+	int passes = 0;
+	int first = 0;
+	while (first < m_nFilters) {
+		int last = 0;
+		int nb = -1;
+		GetFilterPass(first, last, nb);
+		first = last;
+		passes++;
+	}
+	return passes;
+}
+
+//---------------------------------------------------------
+// Function: ApplyFilters
+//    Apply all effects from source to dest.
+//    Intermediate textures are used if more than one pass is needed.
+bool spoutShaders::ApplyFilters(GLuint SourceID, GLuint DestID,
+	unsigned int width, unsigned int height)
+{
+	if (m_nFilters == 0 || SourceID == 0 || DestID == 0 || width == 0 || height == 0)
+		return false;
+
+	// A tile shader cannot read and write the same image
+	if (SourceID == DestID) {
+		SpoutLogWarning("spoutShaders::ApplyFilters - source and dest textures must be different");
+		return false;
+	}
+
+	if (GetFilterPasses() > 1 && !CheckFilterTextures(width, height))
+		return false;
+
+	if (!CheckTilePrograms())
+		return false;
+
+	// Parameters for all effects, 4 for each
+	float params[SPOUT_MAX_FILTERS*4]={};
+	for (int i = 0; i < m_nFilters; i++) {
+		for (int j = 0; j < 4; j++)
+			params[i*4+j] = m_filters[i].param[j];
+	}
+
+	GLuint input = SourceID;
+	int first = 0;
+	int pass = 0;
+	while (first < m_nFilters) {
+
+		int last = 0;
+		int nb = -1;
+		GetFilterPass(first, last, nb);
+
+		// Create the program again only if the effects of this pass change
+		std::string key = std::to_string(first) + ":";
+		for (int i = first; i < last; i++)
+			key += std::to_string((int)m_filters[i].type);
+		if (m_filterProgram[pass] == 0 || key != m_filterKey[pass]) {
+			// The previous program remains in the program cache
+			m_filterProgram[pass] = CreateComputeShader(GetFilterShader(m_filters, first, last, nb), m_tileWgX, m_tileWgY);
+			if (m_filterProgram[pass] == 0) {
+				m_filterKey[pass].clear();
+				return false;
+			}
+			m_filterKey[pass] = key;
+		}
+
+		// The last pass writes to dest, others alternate between the intermediate textures
+		GLuint output = DestID;
+		if (last < m_nFilters)
+			output = m_filterTexture[pass % 2];
+
+		if (!DispatchTiles(m_filterProgram[pass], m_tileWgX, m_tileWgY,
+			input, output, width, height, params, SPOUT_MAX_FILTERS*4))
+			return false;
+
+		input = output;
+		first = last;
+		pass++;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetFilterPass
+//    Effects of the pass starting at "first" and ending before "last".
+//    A pass has adjust effects before and after one neighbourhood
+//    effect "nb" (-1 if there is none).
+void spoutShaders::GetFilterPass(int first, int& last, int& nb)
+{
+	nb = -1;
+	last = first;
+	while (last < m_nFilters) {
+		if (m_filters[last].type != SPOUT_FILTER_ADJUST) {
+			if (nb >= 0)
+				break; // Next pass
+			nb = last;
+		}
+		last++;
+	}
+}
+
+//---------------------------------------------------------
+// Function: GetFilterShader
+//    Shader source for one pass of the filter graph
+std::string spoutShaders::GetFilterShader(const SpoutFilter* filters, int first, int last, int nb)
+{
+	// Tile border and neighbourhood effect
+	int border = 0;
+	std::string effectstr;
+	if (nb >= 0) {
+		switch (filters[nb].type) {
+			case SPOUT_FILTER_SHARPEN:
+				border = 3; // width 1-3
+				effectstr = m_filtersharpenstr;
+				break;
+			case SPOUT_FILTER_BLUR:
+				border = 16; // 4 x amount 0-4
+				effectstr = m_filterblurstr;
+				break;
+			case SPOUT_FILTER_KUWAHARA:
+				border = 8; // amount 1-8
+				effectstr = m_filterkuwaharastr;
+				break;
+			default:
+				break;
+		}
+	}
+
+	std::string shaderstr = "const int H = ";
+	shaderstr += std::to_string(border);
+	shaderstr += ";\n";
+	shaderstr += m_filterstr;
+	shaderstr += effectstr;
+
+	// Adjust effects before the neighbourhood effect
+	// are applied when the tile is loaded
+	const int endpre = (nb >= 0) ? nb : last;
+	shaderstr += "vec4 pre(vec4 c) {\n";
+	for (int i = first; i < endpre; i++)
+		shaderstr += "    c = adjust(c, " + std::to_string(i*4) + ");\n";
+	shaderstr += "    return c;\n}\n";
+
+	shaderstr += "void main() {\n"
+		"    ivec2 size = imageSize(src);\n"
+		"    ivec2 origin = ivec2(gl_WorkGroupID.xy * gl_WorkGroupSize.xy);\n"
+		"    loadtile(origin, size);\n"
+		"    ivec2 t = ivec2(gl_LocalInvocationID.xy) + ivec2(H);\n";
+	if (nb >= 0)
+		shaderstr += "    vec4 c = effect(t, " + std::to_string(nb*4) + ");\n";
+	else
+		shaderstr += "    vec4 c = fetch(t);\n";
+
+	// Adjust effects after the neighbourhood effect
+	for (int i = nb+1; nb >= 0 && i < last; i++)
+		shaderstr += "    c = adjust(c, " + std::to_string(i*4) + ");\n";
+
+	shaderstr += "    ivec2 pos = origin + ivec2(gl_LocalInvocationID.xy);\n"
+		"    if (pos.x < size.x && pos.y < size.y)\n"
+		"        imageStore(dst, pos, c);\n"
+		"}\n";
+
+	return shaderstr;
+}
+
+//---------------------------------------------------------
+// Function: CheckTilePrograms
+//    Select the work group size if not already and
+//    release tile programs created with a different size
+bool spoutShaders::CheckTilePrograms()
+{
+	if (g_TileWgX == 0 || g_TileWgY == 0) {
+		if (!TuneWorkGroupSize())
+			return false;
+	}
+
+	if (m_tileWgX != g_TileWgX || m_tileWgY != g_TileWgY) {
+		// Programs remain in the program cache
+		m_blurTileProgram = 0;
+		m_kuwaharaTileProgram = 0;
+		for (int i = 0; i < SPOUT_MAX_FILTERS; i++) {
+			m_filterProgram[i] = 0;
+			m_filterKey[i].clear();
+		}
+		m_tileWgX = g_TileWgX;
+		m_tileWgY = g_TileWgY;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: GetTileProgram
+//    Tile program for a single effect
+GLuint spoutShaders::GetTileProgram(GLuint &program, SpoutFilterType type)
+{
+	if (program == 0) {
+		const SpoutFilter filter = { type, { 0.0f, 0.0f, 0.0f, 0.0f } };
+		program = CreateComputeShader(GetFilterShader(&filter, 0, 1, 0), m_tileWgX, m_tileWgY);
+	}
+	return program;
+}
+
+//---------------------------------------------------------
+// Function: DispatchTiles
+//    Run a tile program on the whole image
+bool spoutShaders::DispatchTiles(GLuint program, unsigned int wgX, unsigned int wgY,
+	GLuint SourceID, GLuint DestID, unsigned int width, unsigned int height,
+	const float* params, int nParams)
+{
+	if (program == 0 || wgX == 0 || wgY == 0)
+		return false;
+
+	glUseProgram(program);
+	glBindImageTexture(0, SourceID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindImageTexture(1, DestID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glUniform1fv(0, nParams, params);
+	glDispatchCompute((width + wgX - 1) / wgX, (height + wgY - 1) / wgY, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glUseProgram(0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: TuneWorkGroupSize
+//    Time the Kuwahara tile shader (radius 4) for each work group size
+//    that the GPU supports and select the fastest.
+//    Sizes that do not leave room for the largest shared memory
+//    tile (blur) are skipped.
+bool spoutShaders::TuneWorkGroupSize(unsigned int width, unsigned int height)
+{
+	static const unsigned int sizes[6][2] = { {8,8}, {16,8}, {16,16}, {32,8}, {32,16}, {32,32} };
+
+	GLint maxinvocations = 0;
+	GLint maxshared = 0;
+	glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxinvocations);
+	glGetIntegerv(GL_MAX_COMPUTE_SHARED_MEMORY_SIZE, &maxshared);
+	if (maxinvocations <= 0) maxinvocations = 1024; // OpenGL minimum
+	if (maxshared <= 0) maxshared = 32768;
+
+	// Test textures
+	GLuint texture[2]={};
+	GLint texturebinding = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texturebinding);
+	glGenTextures(2, texture);
+	for (int i = 0; i < 2; i++) {
+		glBindTexture(GL_TEXTURE_2D, texture[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glBindTexture(GL_TEXTURE_2D, texturebinding);
+
+	const SpoutFilter filter = { SPOUT_FILTER_KUWAHARA, { 4.0f, 0.0f, 0.0f, 0.0f } };
+	const std::string shaderstr = GetFilterShader(&filter, 0, 1, 0);
+	unsigned int bestX = 0;
+	unsigned int bestY = 0;
+	double besttime = 0.0;
+	for (int i = 0; i < 6; i++) {
+
+		const unsigned int x = sizes[i][0];
+		const unsigned int y = sizes[i][1];
+		if ((GLint)(x*y) > maxinvocations)
+			continue;
+		// Blur tile and horizontal result with border 16
+		if ((GLint)((x+32)*(y+32)*4 + (y+32)*x*16) > maxshared)
+			continue;
+
+		GLuint program = CreateComputeShader(shaderstr, x, y);
+		if (program == 0)
+			continue;
+
+		// The first dispatch is not timed
+		DispatchTiles(program, x, y, texture[0], texture[1], width, height, filter.param, 4);
+		glFinish();
+		StartTiming();
+		for (int j = 0; j < 4; j++)
+			DispatchTiles(program, x, y, texture[0], texture[1], width, height, filter.param, 4);
+		glFinish();
+		const double elapsed = EndTiming();
+		if (bestX == 0 || elapsed < besttime) {
+			besttime = elapsed;
+			bestX = x;
+			bestY = y;
+		}
+	}
+
+	glDeleteTextures(2, texture);
+
+	if (bestX == 0) {
+		SpoutLogError("spoutShaders::TuneWorkGroupSize - no work group size could be used");
+		return false;
+	}
+
+	g_TileWgX = bestX;
+	g_TileWgY = bestY;
+	SpoutLogNotice("spoutShaders::TuneWorkGroupSize - %ux%u (%.3f msec)", bestX, bestY, besttime/4.0);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: SetWorkGroupSize
+//    Set the work group size for all tile shaders.
+//    The application is responsible for a size supported by the GPU.
+void spoutShaders::SetWorkGroupSize(unsigned int x, unsigned int y)
+{
+	g_TileWgX = x;
+	g_TileWgY = y;
+}
+
+//---------------------------------------------------------
+// Function: GetWorkGroupSize
+//    Work group size of the tile shaders (0 if not tuned yet)
+void spoutShaders::GetWorkGroupSize(unsigned int &x, unsigned int &y)
+{
+	x = g_TileWgX;
+	y = g_TileWgY;
+}
+
+//---------------------------------------------------------
+// Function: CheckFilterTextures
+//    Create or resize the filter graph intermediate textures
+bool spoutShaders::CheckFilterTextures(unsigned int width, unsigned int height)
+{
+	if (m_filterTexture[0] > 0 && width == m_filterWidth && height == m_filterHeight)
+		return true;
+
+	if (m_filterTexture[0] > 0)
+		glDeleteTextures(2, m_filterTexture);
+	glGenTextures(2, m_filterTexture);
+
+	GLint texturebinding = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texturebinding);
+	for (int i = 0; i < 2; i++) {
+		glBindTexture(GL_TEXTURE_2D, m_filterTexture[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	glBindTexture(GL_TEXTURE_2D, texturebinding);
+
+	if (m_filterTexture[0] == 0 || m_filterTexture[1] == 0) {
+		SpoutLogError("spoutShaders::CheckFilterTextures - could not create textures");
+		m_filterTexture[0] = m_filterTexture[1] = 0;
+		return false;
+	}
+
+	m_filterWidth  = width;
+	m_filterHeight = height;
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: Draw
+//    Draw a texture to the bound framebuffer and viewport.
+//    For a core profile context instead of immediate mode.
+//    The program, vertex array and vertex buffer are created
+//    on the first call and used for every draw after that.
+//    Program, vertex array and texture binding are restored.
+bool spoutShaders::Draw(GLuint TextureID, float max_x, float max_y, float aspect, bool bInvert)
+{
+	if (TextureID == 0)
+		return false;
+
+	if (!CheckDrawObjects())
+		return false;
+
+	GLint program = 0;
+	GLint vao = 0;
+	GLint activeTexture = 0;
+	GLint texture = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+
+	const float params[4] ={ aspect, max_x, max_y, bInvert ? 1.0f : 0.0f };
+	glUseProgram(m_drawProgram);
+	glUniform1fv(m_drawParamsLoc, 4, params);
+	glUniform1i(m_drawTextureLoc, 0);
+	glBindTexture(GL_TEXTURE_2D, TextureID);
+	glBindVertexArray(m_drawVao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glBindVertexArray((GLuint)vao);
+	glBindTexture(GL_TEXTURE_2D, (GLuint)texture);
+	glActiveTexture((GLenum)activeTexture);
+	glUseProgram((GLuint)program);
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: CheckDrawObjects
+//    Create the draw program, vertex array and vertex buffer
+bool spoutShaders::CheckDrawObjects()
+{
+	if (m_drawProgram > 0 && m_drawVao > 0)
+		return true;
+
+	if (!glGenVertexArrays) {
+		SpoutLogError("spoutShaders::Draw - vertex array functions not available");
+		return false;
+	}
+
+	if (m_drawProgram == 0) {
+		m_drawProgram = CreateDrawProgram();
+		if (m_drawProgram == 0)
+			return false;
+		m_drawParamsLoc  = glGetUniformLocation(m_drawProgram, "params");
+		m_drawTextureLoc = glGetUniformLocation(m_drawProgram, "tex");
+	}
+
+	if (m_drawVao == 0) {
+		// Triangle strip - position xy, texture coordinate uv
+		const float quad[16] = {
+			-1.0f, -1.0f, 0.0f, 0.0f, // bottom left
+			 1.0f, -1.0f, 1.0f, 0.0f, // bottom right
+			-1.0f,  1.0f, 0.0f, 1.0f, // top left
+			 1.0f,  1.0f, 1.0f, 1.0f  // top right
+		};
+		GLint vao = 0;
+		GLint buffer = 0;
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+		glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+		glGenVertexArrays(1, &m_drawVao);
+		glBindVertexArray(m_drawVao);
+		glGenBuffers(1, &m_drawVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawVbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (const void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (const void*)(2*sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glBindVertexArray((GLuint)vao);
+		glBindBuffer(GL_ARRAY_BUFFER, (GLuint)buffer);
+	}
+
+	return (m_drawVao > 0);
+}
+
+//---------------------------------------------------------
+// Function: CreateDrawProgram
+//    Create the draw program or return the program
+//    already created for the current context
+GLuint spoutShaders::CreateDrawProgram()
+{
+	// Program cache key - context and both shader sources
+	char context[32]={};
+	sprintf_s(context, 32, "%p\n", (void*)wglGetCurrentContext());
+	const std::string key = context + m_drawvertstr + m_drawfragstr;
+
+	std::lock_guard<std::mutex> lock(g_ProgramMutex);
+
+	auto it = g_Programs.find(key);
+	if (it != g_Programs.end()) {
+		GLint status = 0;
+		glGetProgramiv(it->second, GL_LINK_STATUS, &status);
+		glGetError(); // remove the error for a deleted program
+		if (status != 0)
+			return it->second;
+		g_Programs.erase(it);
+	}
+
+	GLuint drawProgram = glCreateProgram();
+	if (drawProgram == 0) {
+		SpoutLogError("spoutShaders::CreateDrawProgram - glCreateProgram failed");
+		return 0;
+	}
+
+	GLuint vertShader = CompileShader(GL_VERTEX_SHADER, m_drawvertstr);
+	GLuint fragShader = CompileShader(GL_FRAGMENT_SHADER, m_drawfragstr);
+	if (vertShader == 0 || fragShader == 0) {
+		if (vertShader > 0) glDeleteShader(vertShader);
+		if (fragShader > 0) glDeleteShader(fragShader);
+		glDeleteProgram(drawProgram);
+		return 0;
+	}
+
+	GLint status = 0;
+	glAttachShader(drawProgram, vertShader);
+	glAttachShader(drawProgram, fragShader);
+	glLinkProgram(drawProgram);
+	glGetProgramiv(drawProgram, GL_LINK_STATUS, &status);
+	// After linking, the shader objects are not needed
+	glDetachShader(drawProgram, vertShader);
+	glDetachShader(drawProgram, fragShader);
+	glDeleteShader(vertShader);
+	glDeleteShader(fragShader);
+	if (status == 0) {
+		SpoutLogError("spoutShaders::CreateDrawProgram - glLinkProgram failed");
+		glDeleteProgram(drawProgram);
+		return 0;
+	}
+
+	g_Programs[key] = drawProgram;
+
+	return drawProgram;
+}
+
+//---------------------------------------------------------
+// Function: CompileShader
+//    Compile a vertex or fragment shader
+GLuint spoutShaders::CompileShader(GLenum type, const std::string &shaderstr)
+{
+	GLuint shader = glCreateShader(type);
+	if (shader == 0) {
+		SpoutLogError("spoutShaders::CompileShader - glCreateShader failed");
+		return 0;
+	}
+
+	GLint status = 0;
+	const char* source = shaderstr.c_str();
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status == 0) {
+		char log[512]={};
+		glGetShaderInfoLog(shader, 512, NULL, log);
+		SpoutLogError("spoutShaders::CompileShader - %s", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
 //---------------------------------------------------------
 // Function: ComputeShader
 //    Apply compute shader on source to dest
@@ -204,9 +1155,65 @@ bool spoutShaders::ComputeShader(std::string shaderstr, GLuint &program,
 
 }
 
+//---------------------------------------------------------
+// Function: BufferShader
+//    Texture <> shader storage buffer copy
+//    Dispatched for the whole image with a fixed 16x16 work group.
+//    Each invocation tests the image bounds.
+bool spoutShaders::BufferShader(std::string shaderstr, GLuint &program,
+	GLuint TextureID, GLuint BufferID,
+	unsigned int width, unsigned int height, unsigned int pitch,
+	GLenum glFormat, bool bInvert, bool bLoad)
+{
+	if (TextureID == 0 || BufferID == 0 || width == 0 || height == 0)
+		return false;
+
+	unsigned int channels = 4;
+	if (glFormat == GL_RGB || glFormat == GL_BGR_EXT)
+		channels = 3;
+	else if (glFormat != GL_RGBA && glFormat != GL_BGRA_EXT)
+		return false;
+
+	if (pitch == 0)
+		pitch = width*channels;
+	if (pitch < width*channels)
+		return false;
+
+	if (program == 0) {
+		program = CreateComputeShader(shaderstr, 16, 16);
+		if (program == 0)
+			return false;
+	}
+
+	// Load - one invocation per pixel
+	// Unload - one invocation per buffer word
+	unsigned int nx = width;
+	if (!bLoad)
+		nx = (pitch + 3) / 4;
+
+	glUseProgram(program);
+	glBindImageTexture(0, TextureID, 0, GL_FALSE, 0, bLoad ? GL_WRITE_ONLY : GL_READ_ONLY, GL_RGBA8);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, BufferID);
+	glUniform1i(0, bInvert ? 1 : 0);
+	glUniform1i(1, (glFormat == GL_BGRA_EXT || glFormat == GL_BGR_EXT) ? 1 : 0);
+	glUniform1i(2, (GLint)channels);
+	glUniform1i(3, (GLint)pitch);
+	glDispatchCompute((nx + 15) / 16, (height + 15) / 16, 1);
+	if (bLoad) // texture copy or draw follows
+		glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	else // buffer map or pixel read follows
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8);
+	glUseProgram(0);
+
+	return true;
+}
+
 //---------------------------------------------------------
 // Function: CreateComputeShader
 // Create compute shader from a source string
+// or return the program already created for the current context
 unsigned int spoutShaders::CreateComputeShader(std::string shader, unsigned int nWgX, unsigned int nWgY)
 {
 	// Compute shaders are only supported since openGL 4.3
@@ -236,6 +1243,53 @@ unsigned int spoutShaders::CreateComputeShader(std::string shader, unsigned int
 	// Full shader string
 	shaderstr += shader;
 
+	// Program cache key - context and full source including work group size
+	char context[32]={};
+	sprintf_s(context, 32, "%p\n", (void*)wglGetCurrentContext());
+	const std::string key = context + shaderstr;
+
+	std::lock_guard<std::mutex> lock(g_ProgramMutex);
+
+	// Program already created by this or another spoutShaders object
+	auto it = g_Programs.find(key);
+	if (it != g_Programs.end()) {
+		// Check that the program still exists in case
+		// the context has been deleted and created again
+		GLint status = 0;
+		glGetProgramiv(it->second, GL_LINK_STATUS, &status);
+		glGetError(); // remove the error for a deleted program
+		if (status != 0)
+			return it->second;
+		g_Programs.erase(it);
+	}
+
+	// Program binary saved by a previous run
+	std::string path;
+	GLuint computeProgram = 0;
+	if (g_bBinaryCache && glProgramBinary && glGetProgramBinary && glProgramParameteri) {
+		path = GetBinaryPath(shaderstr);
+		if (!path.empty())
+			computeProgram = LoadProgramBinary(path);
+	}
+
+	if (computeProgram == 0) {
+		computeProgram = CompileComputeShader(shaderstr, !path.empty());
+		if (computeProgram > 0 && !path.empty())
+			SaveProgramBinary(path, computeProgram);
+	}
+
+	if (computeProgram > 0)
+		g_Programs[key] = computeProgram;
+
+	return computeProgram;
+}
+
+//---------------------------------------------------------
+// Function: CompileComputeShader
+// Compile and link a compute shader program
+//    bRetrievable - program binary to be saved
+GLuint spoutShaders::CompileComputeShader(const std::string &shaderstr, bool bRetrievable)
+{
 	// Create the compute shader program
 	GLuint computeProgram = glCreateProgram();
 	if (computeProgram > 0) {
@@ -247,6 +1301,8 @@ unsigned int spoutShaders::CreateComputeShader(std::string shader, unsigned int
 			glShaderSource(computeShader, 1, &source, NULL);
 			glCompileShader(computeShader);
 			glAttachShader(computeProgram, computeShader);
+			if (bRetrievable)
+				glProgramParameteri(computeProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 			glLinkProgram(computeProgram);
 			glGetProgramiv(computeProgram, GL_LINK_STATUS, &status);
 			if (status == 0) {
@@ -270,6 +1326,160 @@ unsigned int spoutShaders::CreateComputeShader(std::string shader, unsigned int
 	return 0;
 }
 
+//---------------------------------------------------------
+// Function: SetBinaryCache
+// Save compute program binaries to "%APPDATA%\Spout\shaders"
+// and load them instead of compiling the source again.
+// Binaries are specific to the graphics driver, so the file name
+// includes the renderer and version as well as the shader source.
+// A binary that the driver does not accept is compiled again.
+void spoutShaders::SetBinaryCache(bool bCache)
+{
+	g_bBinaryCache = bCache;
+}
+
+//---------------------------------------------------------
+// Function: GetBinaryCache
+// Binary cache status
+bool spoutShaders::GetBinaryCache()
+{
+	return g_bBinaryCache;
+}
+
+//---------------------------------------------------------
+// Function: ClearProgramCache
+// Delete all programs created for the current context
+void spoutShaders::ClearProgramCache()
+{
+	char context[32]={};
+	sprintf_s(context, 32, "%p\n", (void*)wglGetCurrentContext());
+	const size_t len = strlen(context);
+
+	std::lock_guard<std::mutex> lock(g_ProgramMutex);
+	for (auto it = g_Programs.begin(); it != g_Programs.end();) {
+		if (it->first.compare(0, len, context) == 0) {
+			glDeleteProgram(it->second);
+			it = g_Programs.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+}
+
+//---------------------------------------------------------
+// Function: GetBinaryPath
+// Program binary file path for a shader source
+// Created from a hash of the renderer, driver version and source.
+std::string spoutShaders::GetBinaryPath(const std::string &shaderstr)
+{
+	char folder[MAX_PATH]={};
+	char* appdatapath = nullptr;
+	errno_t err = 0;
+#if defined(_MSC_VER)
+	err = _dupenv_s(&appdatapath, NULL, "APPDATA");
+#else
+	appdatapath = getenv("APPDATA");
+#endif
+	if (err != 0 || !appdatapath)
+		return "";
+	strcpy_s(folder, MAX_PATH, appdatapath);
+#if defined(_MSC_VER)
+	free(appdatapath);
+#endif
+	strcat_s(folder, MAX_PATH, "\\Spout");
+	if (_access(folder, 0) == -1)
+		CreateDirectoryA(folder, NULL);
+	strcat_s(folder, MAX_PATH, "\\shaders");
+	if (_access(folder, 0) == -1) {
+		if (!CreateDirectoryA(folder, NULL))
+			return "";
+	}
+
+	// FNV-1a hash
+	std::string hashstr;
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* glversion = (const char*)glGetString(GL_VERSION);
+	if (renderer) hashstr += renderer;
+	if (glversion) hashstr += glversion;
+	hashstr += shaderstr;
+	uint64_t hash = 14695981039346656037ULL;
+	for (const char c : hashstr) {
+		hash ^= (uint64_t)(unsigned char)c;
+		hash *= 1099511628211ULL;
+	}
+
+	char path[MAX_PATH]={};
+	sprintf_s(path, MAX_PATH, "%s\\%016llx.bin", folder, (unsigned long long)hash);
+
+	return path;
+}
+
+//---------------------------------------------------------
+// Function: LoadProgramBinary
+// Create a program from a saved binary
+//    File contents : binary format (4 bytes), binary
+GLuint spoutShaders::LoadProgramBinary(const std::string &path)
+{
+	if (_access(path.c_str(), 0) == -1)
+		return 0;
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return 0;
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	if (data.size() <= sizeof(uint32_t))
+		return 0;
+
+	uint32_t format = 0;
+	memcpy(&format, data.data(), sizeof(uint32_t));
+
+	GLuint program = glCreateProgram();
+	if (program == 0)
+		return 0;
+
+	glProgramBinary(program, (GLenum)format, data.data() + sizeof(uint32_t),
+		(GLsizei)(data.size() - sizeof(uint32_t)));
+	GLint status = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status == 0) {
+		// Driver changed or binary not valid
+		SpoutLogNotice("spoutShaders::LoadProgramBinary - binary not accepted, compiling source");
+		glGetError();
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+//---------------------------------------------------------
+// Function: SaveProgramBinary
+// Save a program binary for the next run
+void spoutShaders::SaveProgramBinary(const std::string &path, GLuint program)
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> data(sizeof(uint32_t) + (size_t)length);
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(program, length, &written, &format, data.data() + sizeof(uint32_t));
+	if (written <= 0)
+		return;
+	const uint32_t format32 = (uint32_t)format;
+	memcpy(data.data(), &format32, sizeof(uint32_t));
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (file.is_open()) {
+		file.write(data.data(), (std::streamsize)(sizeof(uint32_t) + written));
+		file.close();
+	}
+}
+
 
 //---------------------------------------------------------
 // Function: GetFileString
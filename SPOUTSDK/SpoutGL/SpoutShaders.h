@@ -37,9 +37,30 @@
 #include "SpoutGLextensions.h"
 #include "SpoutCommon.h"
 #include "SpoutUtils.h"
+#include "SpoutCopy.h" // for SpoutScopeData
+#include <math.h> // for ceil
 
 using namespace spoututils;
 
+//
+// Filter graph effects
+// Applied in order by spoutShaders::ApplyFilters
+//
+enum SpoutFilterType {
+	SPOUT_FILTER_ADJUST = 0, // brightness, contrast, saturation, gamma
+	SPOUT_FILTER_SHARPEN,    // width (1-3), strength
+	SPOUT_FILTER_BLUR,       // amount (0-4)
+	SPOUT_FILTER_KUWAHARA,   // amount (1-8)
+};
+
+// Maximum number of effects in the filter graph
+#define SPOUT_MAX_FILTERS 8
+
+struct SpoutFilter {
+	SpoutFilterType type;
+	float param[4];
+};
+
 class SPOUT_DLLEXP spoutShaders {
 
 	public:
@@ -61,6 +82,43 @@ class SPOUT_DLLEXP spoutShaders {
 		// Swap RGBA <> BGRA
 		bool Swap(GLuint SourceID, unsigned int width, unsigned int height);
 
+		// Texture to buffer object with format conversion
+		bool Unload(GLuint SourceID, GLuint BufferID,
+			unsigned int width, unsigned int height, unsigned int pitch,
+			GLenum glFormat = GL_RGBA, bool bInvert = false);
+
+		// Texture to buffer object as planar YUV (NV12 or I420)
+		bool UnloadYUV(GLuint SourceID, GLuint BufferID,
+			unsigned int width, unsigned int height,
+			bool bPlanar = false, bool bBT709 = true,
+			bool bFullRange = false, bool bInvert = false);
+
+		// Buffer object to texture with format conversion
+		bool Load(GLuint BufferID, GLuint DestID,
+			unsigned int width, unsigned int height, unsigned int pitch,
+			GLenum glFormat = GL_RGBA, bool bInvert = false);
+
+		// Hash of the texture content for comparison of frames
+		// The texture internal format must be GL_RGBA8
+		bool Hash(GLuint SourceID, unsigned int width, unsigned int height, uint64_t &hash);
+
+		// Histograms and waveform of the texture content
+		// The texture internal format must be GL_RGBA8
+		bool Analyze(GLuint SourceID, unsigned int width, unsigned int height);
+		// Result of the latest Analyze with a completed dispatch
+		bool GetAnalysis(SpoutScopeData &data, bool bWait = false);
+
+		// Resample to a texture of different size
+		//    mode - 0 nearest, 1 bilinear, 2 box
+		bool Resample(GLuint SourceID, GLuint DestID,
+			unsigned int destWidth, unsigned int destHeight, int mode = 1);
+
+		// Tone map a floating point texture to an 8 bit sRGB texture
+		// The dest internal format must be GL_RGBA8
+		bool ToneMap(GLuint SourceID, GLuint DestID,
+			unsigned int width, unsigned int height,
+			SpoutToneMap mode = SPOUT_TONEMAP_ACES, float exposure = 1.0f, bool bInvert = false);
+
 		// Image adjust - brightness, contrast, saturation, gamma
 		bool Adjust(GLuint SourceID, GLuint DestID, 
 			unsigned int width, unsigned int height,
@@ -73,17 +131,105 @@ class SPOUT_DLLEXP spoutShaders {
 			float sharpenWidth, float sharpenStrength);
 
 		// Gaussian blur
+		// Single pass shared memory tile if source and dest are different
 		bool Blur(GLuint SourceID, GLuint DestID, 
 			unsigned int width, unsigned int height, float amount);
 
 		// Kuwahara
+		// Shared memory tile if source and dest are different
 		bool Kuwahara(GLuint SourceID, GLuint DestID, 
 			unsigned int width, unsigned int height, float amount);
 
+		//
+		// Work group size for shared memory tile shaders
+		// (filter graph, Blur and Kuwahara)
+		//
+
+		// Time the tile shaders for a range of work group sizes and select the fastest.
+		// Done once for the process when a tile shader is first used
+		// or can be called by the application at startup.
+		bool TuneWorkGroupSize(unsigned int width = 1920, unsigned int height = 1080);
+		// Set the work group size for all tile shaders
+		static void SetWorkGroupSize(unsigned int x, unsigned int y);
+		// Work group size selected (0 if not tuned yet)
+		static void GetWorkGroupSize(unsigned int &x, unsigned int &y);
+
+		//
+		// Filter graph
+		// An ordered list of effects compiled into the minimum number of
+		// compute programs. Each program has at most one neighbourhood effect
+		// (sharpen, blur or kuwahara) using a shared memory tile, with the
+		// adjust effects before and after it applied to the same pixels.
+		//
+
+		// Remove all effects
+		void ClearFilters();
+		// Add an effect to the end of the list
+		bool AddFilter(SpoutFilterType type,
+			float param0 = 0.0f, float param1 = 0.0f,
+			float param2 = 0.0f, float param3 = 0.0f);
+		// Change the parameters of an effect
+		bool SetFilter(int index,
+			float param0 = 0.0f, float param1 = 0.0f,
+			float param2 = 0.0f, float param3 = 0.0f);
+		// Number of effects
+		int GetFilterCount();
+		// Number of compute dispatches for the effects
+		int GetFilterPasses();
+		// Apply all effects from source to dest
+		// The textures must be different, internal format GL_RGBA8
+		bool ApplyFilters(GLuint SourceID, GLuint DestID,
+			unsigned int width, unsigned int height);
+
+		//
+		// Drawing
+		// Vertex and fragment shaders for a core profile context (OpenGL 3.3)
+		//
+
+		// Draw a GL_TEXTURE_2D texture to the bound framebuffer and viewport
+		//   max_x, max_y - texture coordinate range
+		//   aspect - quad width relative to the viewport height (1 fills the viewport)
+		//   bInvert - flip image
+		// Depth test, blending and culling are not changed
+		bool Draw(GLuint TextureID, float max_x = 1.0f, float max_y = 1.0f,
+			float aspect = 1.0f, bool bInvert = false);
+
+		//
+		// Program cache
+		// Compute programs are shared by all spoutShaders objects
+		// of the process that use the same OpenGL context.
+		//
+
+		// Save and load program binaries in "%APPDATA%\Spout\shaders"
+		static void SetBinaryCache(bool bCache = true);
+		// Binary cache status
+		static bool GetBinaryCache();
+		// Delete all programs created for the current context
+		// Call before the context is deleted, after all spoutShaders objects are released
+		static void ClearProgramCache();
+
 		GLuint m_copyProgram    = 0;
 		GLuint m_flipProgram    = 0;
 		GLuint m_mirrorProgram  = 0;
 		GLuint m_swapProgram    = 0;
+		GLuint m_unloadProgram  = 0;
+		GLuint m_unloadYUVProgram = 0;
+		GLuint m_loadProgram    = 0;
+		GLuint m_resampleProgram = 0;
+		GLuint m_toneMapProgram = 0;
+		GLuint m_hashProgram    = 0;
+		GLuint m_hashBuffer     = 0; // Two words for the result
+		GLuint m_scopeProgram   = 0;
+		GLuint m_scopeBuffer[2] = {}; // Results of alternate dispatches
+		GLsync m_scopeSync[2]   = {}; // Fence after each dispatch, null when read
+		int m_scopeIndex        = 0; // Next buffer for Analyze
+
+		// Drawing
+		GLuint m_drawProgram    = 0;
+		GLuint m_drawVao        = 0; // Vertex array object for the quad
+		GLuint m_drawVbo        = 0; // Static vertex buffer
+		GLint m_drawParamsLoc   = -1;
+		GLint m_drawTextureLoc  = -1;
 
 		GLuint m_brcosaProgram  = 0;
 		float m_brightness      = 0.0f; // -1 > 1
@@ -102,6 +248,21 @@ class SPOUT_DLLEXP spoutShaders {
 		GLuint m_kuwaharaProgram = 0;
 		float m_kuwaharaAmount   = 0.0f; // 1 > 4 typical
 
+		// Shared memory tile programs
+		GLuint m_blurTileProgram     = 0;
+		GLuint m_kuwaharaTileProgram = 0;
+		unsigned int m_tileWgX = 0; // Work group size of the tile programs
+		unsigned int m_tileWgY = 0;
+
+		// Filter graph
+		SpoutFilter m_filters[SPOUT_MAX_FILTERS] = {};
+		int m_nFilters = 0;
+		GLuint m_filterProgram[SPOUT_MAX_FILTERS] = {}; // One for each pass
+		std::string m_filterKey[SPOUT_MAX_FILTERS]; // Effects of each program
+		GLuint m_filterTexture[2] = {}; // Intermediate textures
+		unsigned int m_filterWidth  = 0;
+		unsigned int m_filterHeight = 0;
+
 	protected :
 
 		bool ComputeShader(std::string shader, GLuint &program, 
@@ -109,13 +270,58 @@ class SPOUT_DLLEXP spoutShaders {
 			unsigned int width, unsigned int height,
 			float uniform0 = -1.0, float uniform1 = -1.0,
 			float uniform2 = -1.0, float uniform3 = -1.0);
+		bool BufferShader(std::string shader, GLuint &program,
+			GLuint TextureID, GLuint BufferID,
+			unsigned int width, unsigned int height, unsigned int pitch,
+			GLenum glFormat, bool bInvert, bool bLoad);
 		GLuint CreateComputeShader(std::string shader, unsigned int nWgX, unsigned int nWgY);
+		GLuint CompileComputeShader(const std::string &shaderstr, bool bRetrievable);
+		bool CheckDrawObjects();
+		GLuint CreateDrawProgram();
+		GLuint CompileShader(GLenum type, const std::string &shaderstr);
+		GLuint LoadProgramBinary(const std::string &path);
+		void SaveProgramBinary(const std::string &path, GLuint program);
+		std::string GetBinaryPath(const std::string &shaderstr);
+		// Filter graph pass range [first, last) with neighbourhood effect nb or -1
+		void GetFilterPass(int first, int& last, int& nb);
+		std::string GetFilterShader(const SpoutFilter* filters, int first, int last, int nb);
+		bool CheckTilePrograms();
+		GLuint GetTileProgram(GLuint &program, SpoutFilterType type);
+		bool DispatchTiles(GLuint program, unsigned int wgX, unsigned int wgY,
+			GLuint SourceID, GLuint DestID, unsigned int width, unsigned int height,
+			const float* params, int nParams);
+		bool CheckFilterTextures(unsigned int width, unsigned int height);
 		std::string GetFileString(const char* filepath);
 
 		//
 		// Shader source
 		//
 
+		//
+		// Texture draw
+		// Unit quad with position -1 > 1 and texture coordinates 0 > 1
+		// params - aspect, max_x, max_y, invert
+		//
+		std::string m_drawvertstr = "#version 330 core\n"
+			"layout (location = 0) in vec2 pos;\n"
+			"layout (location = 1) in vec2 uv;\n"
+			"uniform float params[4];\n"
+			"out vec2 tc;\n"
+		"void main() {\n"
+			"float v = uv.y;\n"
+			"if(params[3] > 0.5) v = 1.0-v;\n"
+			"tc = vec2(uv.x*params[1], v*params[2]);\n"
+			"gl_Position = vec4(pos.x*params[0], pos.y, 0.0, 1.0);\n"
+		"}\n";
+
+		std::string m_drawfragstr = "#version 330 core\n"
+			"uniform sampler2D tex;\n"
+			"in vec2 tc;\n"
+			"out vec4 color;\n"
+		"void main() {\n"
+			"color = texture(tex, tc);\n"
+		"}\n";
+
 		//
 		// Texture copy
 		//
@@ -183,6 +389,281 @@ class SPOUT_DLLEXP spoutShaders {
 			"imageStore(src, ivec2(gl_GlobalInvocationID.xy), vec4(c0.b, c0.g, c0.r, c0.a));\n" 
 		"}";
 
+		//
+		// Texture to buffer
+		// One invocation for each 32 bit word of the buffer.
+		// Bytes are packed for RGBA/BGRA/RGB/BGR with flip
+		// and zero row padding if the pitch is larger than the row.
+		//
+		std::string m_unloadstr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(std430, binding=2) writeonly buffer dstbuf { uint dst[]; };\n"
+			"layout (location = 0) uniform int flip;\n"
+			"layout (location = 1) uniform int swap;\n"
+			"layout (location = 2) uniform int channels;\n"
+			"layout (location = 3) uniform int pitch;\n"
+		"void main() {\n"
+			"ivec2 size = imageSize(src);\n"
+			"uint upitch = uint(pitch);\n"
+			"uint rowwords = (upitch + 3u) / 4u;\n"
+			"if (gl_GlobalInvocationID.x >= rowwords || gl_GlobalInvocationID.y >= uint(size.y))\n"
+			"    return;\n"
+			"uint id = gl_GlobalInvocationID.y * rowwords + gl_GlobalInvocationID.x;\n"
+			"if (id >= (upitch * uint(size.y) + 3u) / 4u)\n" // Whole words of the buffer
+			"    return;\n"
+			"uint word = 0u;\n"
+			"for (uint i = 0u; i < 4u; i++) {\n"
+			"    uint b = id * 4u + i;\n" // Byte position in the buffer
+			"    uint row = b / upitch;\n"
+			"    uint col = b - row * upitch;\n"
+			"    uint x = col / uint(channels);\n"
+			"    if (row < uint(size.y) && x < uint(size.x)) {\n" // Not padding
+			"        int y = int(row);\n"
+			"        if (flip != 0) y = size.y - 1 - y;\n"
+			"        vec4 c = imageLoad(src, ivec2(int(x), y));\n"
+			"        if (swap != 0) c = c.bgra;\n"
+			"        word |= (uint(c[col - x * uint(channels)] * 255.0 + 0.5) & 0xFFu) << (i * 8u);\n"
+			"    }\n"
+			"}\n"
+			"dst[id] = word;\n"
+		"}";
+
+		//
+		// Texture to planar YUV buffer
+		// One invocation for each 32 bit word of the Y plane followed by
+		// interleaved UV (NV12) or U and V planes (I420).
+		// Chroma is the average of 2x2 pixels. The texture is
+		// sampled nearest if it is a different size to the buffer.
+		//
+		std::string m_unloadyuvstr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(std430, binding=2) writeonly buffer dstbuf { uint dst[]; };\n"
+			"layout (location = 0) uniform int flip;\n"
+			"layout (location = 1) uniform int planar;\n"
+			"layout (location = 2) uniform int flags;\n" // 1 - BT.709, 2 - full range
+			"layout (location = 3) uniform int width;\n"
+			"layout (location = 4) uniform int height;\n"
+		"vec3 rgb(uint x, uint y) {\n"
+			"uvec2 ssize = uvec2(imageSize(src));\n"
+			"if (flip != 0) y = uint(height) - 1u - y;\n"
+			"return imageLoad(src, ivec2(x * ssize.x / uint(width), y * ssize.y / uint(height))).rgb;\n"
+		"}\n"
+		"void main() {\n"
+			"uint id = (gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x) * 256u + gl_LocalInvocationIndex;\n"
+			"uint w = uint(width);\n"
+			"uint ysize = w * uint(height);\n"
+			"uint cwidth = w / 2u;\n"
+			"uint csize = cwidth * (uint(height) / 2u);\n"
+			"if (id >= (ysize + csize * 2u + 3u) / 4u)\n"
+			"    return;\n"
+			"vec2 k = ((flags & 1) != 0) ? vec2(0.2126, 0.0722) : vec2(0.299, 0.114);\n"
+			"vec3 kY = vec3(k.x, 1.0 - k.x - k.y, k.y);\n"
+			"vec3 range = ((flags & 2) != 0) ? vec3(0.0, 255.0, 255.0) : vec3(16.0, 219.0, 224.0);\n"
+			"uint word = 0u;\n"
+			"for (uint i = 0u; i < 4u; i++) {\n"
+			"    uint b = id * 4u + i;\n"
+			"    if (b >= ysize + csize * 2u) break;\n"
+			"    float v;\n"
+			"    if (b < ysize) {\n"
+			"        v = range.x + dot(rgb(b % w, b / w), kY) * range.y;\n"
+			"    }\n"
+			"    else {\n"
+			"        uint c = b - ysize;\n"
+			"        uint p = (planar != 0) ? c % csize : c / 2u;\n"
+			"        bool bV = (planar != 0) ? (c >= csize) : ((c & 1u) != 0u);\n"
+			"        uint x = (p % cwidth) * 2u;\n"
+			"        uint y = (p / cwidth) * 2u;\n"
+			"        vec3 f = (rgb(x, y) + rgb(x + 1u, y) + rgb(x, y + 1u) + rgb(x + 1u, y + 1u)) * 0.25;\n"
+			"        float l = dot(f, kY);\n"
+			"        float d = bV ? (f.r - l) / (2.0 * (1.0 - k.x)) : (f.b - l) / (2.0 * (1.0 - k.y));\n"
+			"        v = 128.0 + d * range.z;\n"
+			"    }\n"
+			"    word |= uint(clamp(v + 0.5, 0.0, 255.0)) << (i * 8u);\n"
+			"}\n"
+			"dst[id] = word;\n"
+		"}";
+
+		//
+		// Content hash
+		// One invocation for each pixel. Each pixel is mixed with its position
+		// and reduced in shared memory to a sum and an exclusive-or for each
+		// 16x16 work group, which are then added to the result by atomics.
+		//
+		std::string m_hashstr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(std430, binding=2) buffer hashbuf { uint h[]; };\n"
+			"shared uint sa[256];\n"
+			"shared uint sx[256];\n"
+		"uint mix32(uint x) {\n"
+			"x ^= x >> 16; x *= 0x7FEB352Du;\n"
+			"x ^= x >> 15; x *= 0x846CA68Bu;\n"
+			"return x ^ (x >> 16);\n"
+		"}\n"
+		"void main() {\n"
+			"ivec2 size = imageSize(src);\n"
+			"ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+			"uint i = gl_LocalInvocationIndex;\n"
+			"uint a = 0u;\n"
+			"uint x = 0u;\n"
+			"if (p.x < size.x && p.y < size.y) {\n"
+			"    uint v = packUnorm4x8(imageLoad(src, p));\n"
+			"    uint k = uint(p.y * size.x + p.x);\n"
+			"    a = mix32(v ^ mix32(k));\n"
+			"    x = mix32(v + k * 0x9E3779B9u);\n"
+			"}\n"
+			"sa[i] = a;\n"
+			"sx[i] = x;\n"
+			"barrier();\n"
+			"for (uint s = 128u; s > 0u; s >>= 1) {\n"
+			"    if (i < s) {\n"
+			"        sa[i] += sa[i + s];\n"
+			"        sx[i] ^= sx[i + s];\n"
+			"    }\n"
+			"    barrier();\n"
+			"}\n"
+			"if (i == 0u) {\n"
+			"    atomicAdd(h[0], sa[0]);\n"
+			"    atomicXor(h[1], sx[0]);\n"
+			"}\n"
+		"}";
+
+		//
+		// Histograms and waveform (see SpoutScopeData)
+		// Counts for each work group are accumulated in shared memory
+		// and added to the output buffer once by each invocation.
+		//
+		std::string m_scopestr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(std430, binding=2) buffer scopebuf { uint d[]; };\n"
+			"shared uint hist[1024];\n"
+		"void main() {\n"
+			"uint i = gl_LocalInvocationIndex;\n"
+			"for (uint k = i; k < 1024u; k += 256u) hist[k] = 0u;\n"
+			"barrier();\n"
+			"ivec2 size = imageSize(src);\n"
+			"ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+			"if (p.x < size.x && p.y < size.y) {\n"
+			"    vec3 c = clamp(imageLoad(src, p).rgb, 0.0, 1.0);\n"
+			"    uvec3 v = uvec3(c * 255.0 + 0.5);\n"
+			"    uint l = uint(dot(c, vec3(0.2126, 0.7152, 0.0722)) * 255.0 + 0.5);\n"
+			"    atomicAdd(hist[v.r], 1u);\n"
+			"    atomicAdd(hist[256u + v.g], 1u);\n"
+			"    atomicAdd(hist[512u + v.b], 1u);\n"
+			"    atomicAdd(hist[768u + l], 1u);\n"
+			"    uint col = uint(p.x) * 128u / uint(size.x);\n"
+			"    atomicAdd(d[1024u + col * 64u + (l >> 2)], 1u);\n"
+			"}\n"
+			"barrier();\n"
+			"for (uint k = i; k < 1024u; k += 256u) {\n"
+			"    if (hist[k] != 0u) atomicAdd(d[k], hist[k]);\n"
+			"}\n"
+		"}";
+
+		//
+		// Resample
+		// One invocation for each dest pixel.
+		// Box averages the source pixels covered, up to 16x16 samples.
+		//
+		std::string m_resamplestr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(rgba8, binding=1) uniform writeonly image2D dst;\n"
+			"layout (location = 0) uniform int mode;\n"
+		"void main() {\n"
+			"ivec2 ssize = imageSize(src);\n"
+			"ivec2 dsize = imageSize(dst);\n"
+			"ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+			"if (p.x >= dsize.x || p.y >= dsize.y)\n"
+			"    return;\n"
+			"vec2 scale = vec2(ssize) / vec2(dsize);\n"
+			"ivec2 m = ssize - ivec2(1);\n"
+			"vec4 c;\n"
+			"if (mode == 2) {\n"
+			"    ivec2 p0 = min(ivec2(vec2(p) * scale), m);\n"
+			"    ivec2 p1 = clamp(ivec2(vec2(p + ivec2(1)) * scale), p0 + ivec2(1), ssize);\n"
+			"    ivec2 step = max(ivec2(1), (p1 - p0 + ivec2(15)) / 16);\n"
+			"    c = vec4(0.0);\n"
+			"    float n = 0.0;\n"
+			"    for (int y = p0.y; y < p1.y; y += step.y) {\n"
+			"        for (int x = p0.x; x < p1.x; x += step.x) {\n"
+			"            c += imageLoad(src, ivec2(x, y));\n"
+			"            n += 1.0;\n"
+			"        }\n"
+			"    }\n"
+			"    c /= n;\n"
+			"}\n"
+			"else if (mode == 1) {\n"
+			"    vec2 s = (vec2(p) + 0.5) * scale - 0.5;\n"
+			"    ivec2 s0 = ivec2(floor(s));\n"
+			"    vec2 f = s - vec2(s0);\n"
+			"    vec4 c00 = imageLoad(src, clamp(s0, ivec2(0), m));\n"
+			"    vec4 c10 = imageLoad(src, clamp(s0 + ivec2(1, 0), ivec2(0), m));\n"
+			"    vec4 c01 = imageLoad(src, clamp(s0 + ivec2(0, 1), ivec2(0), m));\n"
+			"    vec4 c11 = imageLoad(src, clamp(s0 + ivec2(1, 1), ivec2(0), m));\n"
+			"    c = mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);\n"
+			"}\n"
+			"else {\n"
+			"    c = imageLoad(src, min(ivec2(vec2(p) * scale), m));\n"
+			"}\n"
+			"imageStore(dst, p, c);\n"
+		"}";
+
+		//
+		// Tone map
+		// One invocation for each dest pixel.
+		// The source is read by sampler for any floating point format.
+		// Linear scRGB (1.0 = SDR white) is scaled by exposure,
+		// mapped by luminance Reinhard or the Narkowicz ACES fit
+		// and encoded as sRGB for an 8 bit texture.
+		//
+		std::string m_tonemapstr = "layout(binding=0) uniform sampler2D src;\n"
+			"layout(rgba8, binding=1) uniform writeonly image2D dst;\n"
+			"layout (location = 0) uniform int mode;\n"
+			"layout (location = 1) uniform float exposure;\n"
+			"layout (location = 2) uniform int invert;\n"
+		"vec3 aces(vec3 x) {\n"
+			"    x *= 0.6;\n"
+			"    return (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14);\n"
+		"}\n"
+		"void main() {\n"
+			"ivec2 size = imageSize(dst);\n"
+			"ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+			"if (p.x >= size.x || p.y >= size.y)\n"
+			"    return;\n"
+			"ivec2 s = p;\n"
+			"if (invert != 0)\n"
+			"    s.y = size.y - 1 - p.y;\n"
+			"vec4 c = texelFetch(src, s, 0);\n"
+			"vec3 x = max(c.rgb * exposure, vec3(0.0));\n"
+			"if (mode == 2)\n"
+			"    x = aces(x);\n"
+			"else\n"
+			"    x = x / (1.0 + dot(x, vec3(0.2126, 0.7152, 0.0722)));\n"
+			"x = clamp(x, 0.0, 1.0);\n"
+			"x = mix(x * 12.92, 1.055 * pow(x, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), x));\n"
+			"imageStore(dst, p, vec4(x, clamp(c.a, 0.0, 1.0)));\n"
+		"}";
+
+		//
+		// Buffer to texture
+		// One invocation for each pixel
+		//
+		std::string m_loadstr = "layout(rgba8, binding=0) uniform writeonly image2D dst;\n"
+			"layout(std430, binding=2) readonly buffer srcbuf { uint src[]; };\n"
+			"layout (location = 0) uniform int flip;\n"
+			"layout (location = 1) uniform int swap;\n"
+			"layout (location = 2) uniform int channels;\n"
+			"layout (location = 3) uniform int pitch;\n"
+			"float getbyte(uint b) {\n"
+			"    return float((src[b >> 2u] >> ((b & 3u) * 8u)) & 0xFFu) / 255.0;\n"
+			"}\n"
+		"void main() {\n"
+			"ivec2 size = imageSize(dst);\n"
+			"if (gl_GlobalInvocationID.x >= uint(size.x) || gl_GlobalInvocationID.y >= uint(size.y))\n"
+			"    return;\n"
+			"uint b = gl_GlobalInvocationID.y * uint(pitch) + gl_GlobalInvocationID.x * uint(channels);\n"
+			"vec4 c = vec4(getbyte(b), getbyte(b + 1u), getbyte(b + 2u), 1.0);\n"
+			"if (channels == 4) c.a = getbyte(b + 3u);\n"
+			"if (swap != 0) c = c.bgra;\n"
+			"int y = int(gl_GlobalInvocationID.y);\n"
+			"if (flip != 0) y = size.y - 1 - y;\n"
+			"imageStore(dst, ivec2(int(gl_GlobalInvocationID.x), y), c);\n"
+		"}";
+
 		//
 		// Adjust - brightness, contrast, saturation, gamma
 		//
@@ -376,6 +857,121 @@ class SPOUT_DLLEXP spoutShaders {
 			"	}\n"
 		"}\n";
 
+		//
+		// Filter graph
+		// Common source for all filter programs.
+		// "H" is the tile border for the neighbourhood effect
+		// and "pre" the adjust effects applied when the tile is loaded.
+		// These are defined by GetFilterShader.
+		//
+		std::string m_filterstr = "layout(rgba8, binding=0) uniform readonly image2D src;\n"
+			"layout(rgba8, binding=1) uniform writeonly image2D dst;\n"
+			"layout(location = 0) uniform float params[32];\n" // 4 for each effect
+			"const int WX = int(gl_WorkGroupSize.x);\n"
+			"const int WY = int(gl_WorkGroupSize.y);\n"
+			"const int TSX = WX + 2 * H;\n" // Tile size with border
+			"const int TSY = WY + 2 * H;\n"
+			"shared uint tile[TSX * TSY];\n" // Packed rgba8
+			"vec4 pre(vec4 c);\n"
+			"\n"
+			"vec4 fetch(ivec2 t) {\n" // Tile position
+			"    return unpackUnorm4x8(tile[t.y * TSX + t.x]);\n"
+			"}\n"
+			"\n"
+			// Tile and border for this work group, clamped to the image edges
+			"void loadtile(ivec2 origin, ivec2 size) {\n"
+			"    for (int i = int(gl_LocalInvocationIndex); i < TSX * TSY; i += WX * WY) {\n"
+			"        ivec2 p = clamp(origin + ivec2(i % TSX, i / TSX) - ivec2(H), ivec2(0), size - 1);\n"
+			"        tile[i] = packUnorm4x8(pre(imageLoad(src, p)));\n"
+			"    }\n"
+			"    memoryBarrierShared();\n"
+			"    barrier();\n"
+			"}\n"
+			"\n"
+			// Adjust - as for m_brcosastr
+			"vec4 adjust(vec4 c1, int p) {\n"
+			"    c1 = clamp(c1, 0.0, 1.0);\n"
+			"    vec3 c2 = pow(c1.rgb, vec3(1.0 / params[p + 3]));\n" // gamma
+			"    float luminance = dot(c2, vec3(0.2125, 0.7154, 0.0721));\n"
+			"    c2 = mix(vec3(luminance), c2, vec3(params[p + 2]));\n" // saturation
+			"    c2 = (c2 - 0.5) * params[p + 1] + 0.5;\n" // contrast
+			"    c2 += params[p];\n" // brightness
+			"    return clamp(vec4(c2, c1.a), 0.0, 1.0);\n"
+			"}\n";
+
+		//
+		// Sharpen - as for m_sharpenstr
+		//
+		std::string m_filtersharpenstr = "vec4 effect(ivec2 t, int p) {\n"
+			"    int d = clamp(int(params[p]), 1, H);\n"
+			"    float strength = params[p + 1];\n"
+			"    vec4 orig = fetch(t);\n"
+			"    vec4 blur = ((fetch(t + ivec2(-d, -d)) + fetch(t + ivec2(d, -d))\n"
+			"        + fetch(t + ivec2(-d, d)) + fetch(t + ivec2(d, d)))\n"
+			"        + 2.0 * (fetch(t + ivec2(0, -d)) + fetch(t + ivec2(-d, 0))\n"
+			"        + fetch(t + ivec2(d, 0)) + fetch(t + ivec2(0, d)))\n"
+			"        + 4.0 * orig) / 16.0;\n"
+			"    return (1.0 + strength) * orig - strength * blur;\n"
+			"}\n";
+
+		//
+		// Gaussian blur - as for m_hblurstr and m_vblurstr
+		// Horizontal to a second shared tile then vertical
+		//
+		std::string m_filterblurstr = "shared vec4 hblur[TSY * WX];\n"
+			"const float weight[5] = float[](0.382928, 0.241732, 0.060598, 0.005977, 0.000229);\n"
+			"vec4 effect(ivec2 t, int p) {\n"
+			"    float amount = clamp(params[p], 0.0, float(H) / 4.0);\n"
+			"    int lx = int(gl_LocalInvocationID.x);\n"
+			"    for (int y = int(gl_LocalInvocationID.y); y < TSY; y += WY) {\n"
+			"        ivec2 h = ivec2(t.x, y);\n"
+			"        vec4 c = weight[0] * fetch(h);\n"
+			"        for (int k = 1; k < 5; k++) {\n"
+			"            int o = int(amount * float(k));\n"
+			"            c += weight[k] * (fetch(h - ivec2(o, 0)) + fetch(h + ivec2(o, 0)));\n"
+			"        }\n"
+			"        hblur[y * WX + lx] = c;\n"
+			"    }\n"
+			"    memoryBarrierShared();\n"
+			"    barrier();\n"
+			"    vec4 c = weight[0] * hblur[t.y * WX + lx];\n"
+			"    for (int k = 1; k < 5; k++) {\n"
+			"        int o = int(amount * float(k));\n"
+			"        c += weight[k] * (hblur[(t.y - o) * WX + lx] + hblur[(t.y + o) * WX + lx]);\n"
+			"    }\n"
+			"    return c;\n"
+			"}\n";
+
+		//
+		// Kuwahara - as for m_kuwaharastr
+		//
+		std::string m_filterkuwaharastr = "vec4 effect(ivec2 t, int p) {\n"
+			"    int ir = clamp(int(floor(params[p])), 1, H);\n"
+			"    ivec2 q0[4] = ivec2[](ivec2(-ir, -ir), ivec2(0, -ir), ivec2(0, 0), ivec2(-ir, 0));\n"
+			"    float n = float((ir + 1) * (ir + 1));\n"
+			"    float min_sigma2 = 1e+2;\n"
+			"    vec3 result = fetch(t).rgb;\n"
+			"    for (int k = 0; k < 4; ++k) {\n"
+			"        vec3 m = vec3(0.0);\n"
+			"        vec3 s = vec3(0.0);\n"
+			"        for (int j = 0; j <= ir; ++j) {\n"
+			"            for (int i = 0; i <= ir; ++i) {\n"
+			"                vec3 c = fetch(t + q0[k] + ivec2(i, j)).rgb;\n"
+			"                m += c;\n"
+			"                s += c * c;\n"
+			"            }\n"
+			"        }\n"
+			"        m /= n;\n"
+			"        s = abs(s / n - m * m);\n"
+			"        float sigma2 = s.r + s.g + s.b;\n"
+			"        if (sigma2 < min_sigma2) {\n"
+			"            min_sigma2 = sigma2;\n"
+			"            result = m;\n"
+			"        }\n"
+			"    }\n"
+			"    return vec4(result, 1.0);\n"
+			"}\n";
+
 	// ============================================================
 
 };
@@ -38,6 +38,7 @@
 #include "SpoutSharedMemory.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <string>
 
 // ====================================================================================
@@ -52,6 +53,18 @@
 //	Version 2.007.012
 //	07.12.23 - Remove unused <d3d9.h> from header
 //	Version 2.007.013
+//	14.10.26 - Add Buffer() for access without locking
+//			   Create - limit the size of an existing map to the size of the view
+//			 - Add SetLargePages, GetLargePages and IsLargePageMap.
+//			   Create - allocate with SEC_LARGE_PAGES if requested and
+//			   SeLockMemoryPrivilege is held, otherwise with default pages.
+//			 - Add spoutMemoryBufferScope to the header
+//			 - Add Lock(timeout), SetLockTimeout and GetLockTimeout
+//			 - Add SetSpinLock and GetSpinLock for a lock word
+//			   that spins before waiting on an event
+//			 - Create - 64 bit size passed as high and low dwords
+//			   Add Size64, SetViewSize, GetViewSize, MapView and UnmapView
+//			   for maps larger than 2GB and partial views
 //
 // ====================================================================================
 
@@ -70,7 +83,16 @@ SpoutSharedMemory::SpoutSharedMemory()
 	m_hMap = NULL;
 	m_pName = NULL;
 	m_size = 0;
+	m_viewSize = 0;
+	m_pView = nullptr;
 	m_lockCount = 0;
+	m_bLargePages = false;
+	m_bLargePageMap = false;
+	m_dwLockTimeout = SPOUT_LOCK_TIMEOUT;
+	m_bSpinLock = false;
+	m_hLockMap = NULL;
+	m_hLockEvent = NULL;
+	m_pLockWord = nullptr;
 }
 
 SpoutSharedMemory::~SpoutSharedMemory()
@@ -83,10 +105,53 @@ SpoutSharedMemory::~SpoutSharedMemory()
 	}
 }
 
+#ifndef FILE_MAP_LARGE_PAGES
+#define FILE_MAP_LARGE_PAGES 0x20000000
+#endif
+
+// Enable the lock memory privilege for the process and return the
+// large page size, or zero if large pages are not available.
+static SIZE_T EnableLargePages()
+{
+	const SIZE_T largepage = GetLargePageMinimum();
+	if (largepage == 0)
+		return 0;
+
+	HANDLE hToken = NULL;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken))
+		return 0;
+
+	TOKEN_PRIVILEGES tp={};
+	tp.PrivilegeCount = 1;
+	tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	bool bEnabled = false;
+	if (LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid)) {
+		// Succeeds without the privilege, so check the error
+		if (AdjustTokenPrivileges(hToken, FALSE, &tp, 0, NULL, NULL))
+			bEnabled = (GetLastError() == ERROR_SUCCESS);
+	}
+	CloseHandle(hToken);
+	SetLastError(NO_ERROR);
+
+	if (!bEnabled) {
+		SpoutLogNotice("SpoutSharedMemory - large pages not available (SeLockMemoryPrivilege)");
+		return 0;
+	}
+
+	return largepage;
+}
+
+// Large page size tested once for the process
+static SIZE_T LargePageSize()
+{
+	static const SIZE_T largepage = EnableLargePages();
+	return largepage;
+}
+
 //---------------------------------------------------------
 // Function: Create
 // Create a new memory segment, or attach to an existing one
-SpoutCreateResult SpoutSharedMemory::Create(const char* name, int size)
+SpoutCreateResult SpoutSharedMemory::Create(const char* name, ULONGLONG size)
 {
 	DWORD err = 0;
 
@@ -107,12 +172,37 @@ SpoutCreateResult SpoutSharedMemory::Create(const char* name, int size)
 	// In this scenario, CreateFileMapping creates a file mapping object of a specified size
 	// that is backed by the system paging file instead of by a file in the file system.
 
-	m_hMap = CreateFileMappingA ( INVALID_HANDLE_VALUE,
-									NULL,
-									PAGE_READWRITE,
-									0,
-									(DWORD)size,
-									(LPCSTR)name);
+	// Large pages for maps of at least one large page if requested.
+	// The map size is a multiple of the large page size.
+	// Fall back to default pages if they cannot be allocated.
+	m_bLargePageMap = false;
+	if (m_bLargePages) {
+		const SIZE_T largepage = LargePageSize();
+		if (largepage > 0 && size >= (ULONGLONG)largepage) {
+			const ULONGLONG mapsize = (size + largepage - 1) & ~((ULONGLONG)largepage - 1);
+			m_hMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL,
+				PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+				(DWORD)(mapsize >> 32), (DWORD)(mapsize & 0xFFFFFFFF), (LPCSTR)name);
+			if (m_hMap) {
+				// An existing map is used as it was created
+				m_bLargePageMap = (GetLastError() != ERROR_ALREADY_EXISTS);
+				if (!m_bLargePageMap)
+					SetLastError(ERROR_ALREADY_EXISTS);
+			}
+			else {
+				SpoutLogNotice("SpoutSharedMemory::Create - large pages not allocated for [%s]", name);
+			}
+		}
+	}
+
+	if (!m_hMap) {
+		m_hMap = CreateFileMappingA ( INVALID_HANDLE_VALUE,
+										NULL,
+										PAGE_READWRITE,
+										(DWORD)(size >> 32),
+										(DWORD)(size & 0xFFFFFFFF),
+										(LPCSTR)name);
+	}
 
 	if (m_hMap == NULL)	{
 		err = GetLastError();
@@ -141,13 +231,30 @@ SpoutCreateResult SpoutSharedMemory::Create(const char* name, int size)
 	// We can depend on the mapping object to be initially zeros.
 	// https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-createfilemappinga
 
-	m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	// Map the whole segment or the view size if set.
+	// A map larger than the process address space
+	// requires a view size and MapView for other parts.
+	SIZE_T viewsize = 0;
+	if (m_viewSize > 0 && (ULONGLONG)m_viewSize < size)
+		viewsize = m_viewSize;
+
+	m_pBuffer = nullptr;
+	if (m_bLargePageMap)
+		m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS | FILE_MAP_LARGE_PAGES, 0, 0, viewsize);
+	// FILE_MAP_LARGE_PAGES requires Windows 10 1703
+	if (!m_pBuffer)
+		m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS, 0, 0, viewsize);
 
 	if (!m_pBuffer)	{
+		err = GetLastError();
+		SpoutLogError("SpoutSharedMemory::Create - MapViewOfFile failed error = %lu (0x%4.4lX)", err, err);
 		Close();
 		return SPOUT_CREATE_FAILED;
 	}
 
+	if (m_bLargePageMap)
+		SpoutLogNotice("SpoutSharedMemory::Create - [%s] large pages", name);
+
 	std::string	mutexName;
 	mutexName = name;
 	mutexName += "_mutex";
@@ -164,6 +271,16 @@ SpoutCreateResult SpoutSharedMemory::Create(const char* name, int size)
 
 	m_size = size;
 
+	// An existing map could be smaller than requested
+	// Limit the size to the region of a view of the whole map
+	if (alreadyExists && viewsize == 0) {
+		MEMORY_BASIC_INFORMATION mbi={};
+		if (VirtualQuery(m_pBuffer, &mbi, sizeof(mbi)) == sizeof(mbi)) {
+			if ((ULONGLONG)mbi.RegionSize < size)
+				m_size = (ULONGLONG)mbi.RegionSize;
+		}
+	}
+
 	return alreadyExists ? SPOUT_ALREADY_EXISTS : SPOUT_CREATE_SUCCESS;
 
 }
@@ -187,7 +304,12 @@ bool SpoutSharedMemory::Open(const char* name)
 		return false;
 	}
 
-	m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	// The whole map or the view size if set
+	m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS, 0, 0, m_viewSize);
+	if (!m_pBuffer && m_viewSize > 0) {
+		// The map could be smaller than the view
+		m_pBuffer = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	}
 	if (!m_pBuffer)	{
 		Close();
 		return false;
@@ -223,6 +345,8 @@ bool SpoutSharedMemory::Open(const char* name)
 // Close a map
 void SpoutSharedMemory::Close()
 {
+	UnmapView();
+
 	if (m_pBuffer) {
 		UnmapViewOfFile((LPCVOID)m_pBuffer);
 		m_pBuffer = NULL;
@@ -238,12 +362,15 @@ void SpoutSharedMemory::Close()
 		m_hMutex = NULL;
 	}
 
+	CloseSpinLock();
+
 	if (m_pName) {
 		free((void*)m_pName);
 		m_pName = NULL;
 	}
 
 	m_size = 0;
+	m_bLargePageMap = false;
 
 }
 
@@ -251,6 +378,16 @@ void SpoutSharedMemory::Close()
 // Function: Lock
 // Lock an open map and return the buffer
 char* SpoutSharedMemory::Lock()
+{
+	return Lock(m_dwLockTimeout);
+}
+
+//---------------------------------------------------------
+// Function: Lock
+// Lock an open map with a timeout and return the buffer.
+// A zero timeout returns at once if the lock is not available
+// so that real time threads do not stall.
+char* SpoutSharedMemory::Lock(DWORD dwTimeout)
 {
 	assert(m_lockCount >= 0);
 	assert(m_hMutex);
@@ -273,9 +410,15 @@ char* SpoutSharedMemory::Lock()
 		return m_pBuffer;
 	}
 
-	const DWORD waitResult = WaitForSingleObject(m_hMutex, 67);
-	if (waitResult != WAIT_OBJECT_0) {
-		return nullptr;
+	if (m_bSpinLock && OpenSpinLock()) {
+		if (!SpinLock(dwTimeout))
+			return nullptr;
+	}
+	else {
+		const DWORD waitResult = WaitForSingleObject(m_hMutex, dwTimeout);
+		if (waitResult != WAIT_OBJECT_0) {
+			return nullptr;
+		}
 	}
 
 	m_lockCount++;
@@ -295,10 +438,22 @@ void SpoutSharedMemory::Unlock()
 	assert(m_lockCount >= 0);
 
 	if (m_lockCount == 0) {
-		ReleaseMutex(m_hMutex);
+		if (m_pLockWord)
+			SpinUnlock();
+		else
+			ReleaseMutex(m_hMutex);
 	}
 }
 
+//---------------------------------------------------------
+// Function: Buffer
+// Return the buffer pointer of an open map without locking.
+// For data that is read and written atomically by the caller.
+char* SpoutSharedMemory::Buffer()
+{
+	return m_pBuffer;
+}
+
 //---------------------------------------------------------
 // Function: Name
 // Return the name of an existing map
@@ -311,10 +466,300 @@ const char* SpoutSharedMemory::Name()
 // Function: Size
 // Return the size of an existing map
 int SpoutSharedMemory::Size()
+{
+	if (m_size > (ULONGLONG)INT_MAX)
+		return INT_MAX;
+	return (int)m_size;
+}
+
+//---------------------------------------------------------
+// Function: Size64
+// Return the size of an existing map
+ULONGLONG SpoutSharedMemory::Size64()
 {
 	return m_size;
 }
 
+//---------------------------------------------------------
+// Function: SetViewSize
+// Set the number of bytes mapped by Create and Open.
+// Zero maps the whole segment. For segments larger than the process
+// address space, map part with the view size and use MapView for the rest.
+// Set before Create or Open.
+void SpoutSharedMemory::SetViewSize(size_t size)
+{
+	m_viewSize = size;
+}
+
+//---------------------------------------------------------
+// Function: GetViewSize
+// Size of the view mapped by Create or Open (0 for the whole map)
+size_t SpoutSharedMemory::GetViewSize()
+{
+	return m_viewSize;
+}
+
+//---------------------------------------------------------
+// Function: MapView
+// Map part of an open map and return a pointer to the data at the offset.
+//
+// The view starts at the allocation granularity below the offset.
+// The view is not locked. Lock the map for access if necessary.
+// A previous view is unmapped.
+char* SpoutSharedMemory::MapView(ULONGLONG offset, size_t length)
+{
+	UnmapView();
+
+	if (!m_hMap || length == 0)
+		return nullptr;
+
+	if (m_size > 0 && offset + length > m_size) {
+		SpoutLogError("SpoutSharedMemory::MapView - view exceeds the map size");
+		return nullptr;
+	}
+
+	SYSTEM_INFO si={};
+	GetSystemInfo(&si);
+	const ULONGLONG granularity = (ULONGLONG)si.dwAllocationGranularity;
+	const ULONGLONG base = offset - (offset % granularity);
+	const size_t delta = (size_t)(offset - base);
+
+	m_pView = (char*)MapViewOfFile(m_hMap, FILE_MAP_ALL_ACCESS,
+		(DWORD)(base >> 32), (DWORD)(base & 0xFFFFFFFF), length + delta);
+	if (!m_pView) {
+		const DWORD err = GetLastError();
+		SpoutLogError("SpoutSharedMemory::MapView - failed error = %lu (0x%4.4lX)", err, err);
+		return nullptr;
+	}
+
+	return m_pView + delta;
+}
+
+//---------------------------------------------------------
+// Function: UnmapView
+// Unmap a view mapped by MapView
+void SpoutSharedMemory::UnmapView()
+{
+	if (m_pView) {
+		UnmapViewOfFile((LPCVOID)m_pView);
+		m_pView = nullptr;
+	}
+}
+
+//---------------------------------------------------------
+// Function: SetLargePages
+// Create maps with large pages.
+//
+// Maps created after this call of at least the large page size
+// (usually 2 MB) are allocated with SEC_LARGE_PAGES. This reduces
+// TLB misses for copy of frame size buffers.
+//
+// The process requires the "Lock pages in memory" user right
+// (SeLockMemoryPrivilege). If large pages are not available,
+// maps are created with default pages.
+// Large pages are locked in physical memory and are not paged.
+void SpoutSharedMemory::SetLargePages(bool bLarge)
+{
+	m_bLargePages = bLarge;
+}
+
+//---------------------------------------------------------
+// Function: GetLargePages
+// Large pages requested
+bool SpoutSharedMemory::GetLargePages()
+{
+	return m_bLargePages;
+}
+
+//---------------------------------------------------------
+// Function: IsLargePageMap
+// The map was created with large pages
+bool SpoutSharedMemory::IsLargePageMap()
+{
+	return m_bLargePageMap;
+}
+
+//---------------------------------------------------------
+// Function: SetLockTimeout
+// Timeout for Lock() in msec
+void SpoutSharedMemory::SetLockTimeout(DWORD dwTimeout)
+{
+	m_dwLockTimeout = dwTimeout;
+}
+
+//---------------------------------------------------------
+// Function: GetLockTimeout
+// Lock timeout
+DWORD SpoutSharedMemory::GetLockTimeout()
+{
+	return m_dwLockTimeout;
+}
+
+//---------------------------------------------------------
+// Function: SetSpinLock
+// Spin on a shared lock word before blocking instead of using the map mutex.
+//
+// For short access such as sender information, most of the time
+// for the mutex is the kernel transition. The lock word is in a small
+// map "<mapname>_lock" so that the layout of existing maps is unchanged.
+// A waiter spins on the word and then waits on the event "<mapname>_lock_event".
+//
+// The lock is not shared with the map mutex, so all processes using
+// the map must enable the option. Set before the map is locked.
+void SpoutSharedMemory::SetSpinLock(bool bSpin)
+{
+	if (m_lockCount > 0) {
+		SpoutLogWarning("SpoutSharedMemory::SetSpinLock - map is locked");
+		return;
+	}
+	m_bSpinLock = bSpin;
+	if (!m_bSpinLock)
+		CloseSpinLock();
+}
+
+//---------------------------------------------------------
+// Function: GetSpinLock
+// Spin lock enabled
+bool SpoutSharedMemory::GetSpinLock()
+{
+	return m_bSpinLock;
+}
+
+//---------------------------------------------------------
+// Function: OpenSpinLock
+// Create or open the lock word and waiter event of the map
+bool SpoutSharedMemory::OpenSpinLock()
+{
+	if (m_pLockWord)
+		return true;
+
+	if (!m_pName)
+		return false;
+
+	std::string name = m_pName;
+	name += "_lock";
+	// Owner thread id and waiter count
+	m_hLockMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		0, 2*sizeof(LONG), name.c_str());
+	if (!m_hLockMap) {
+		SpoutLogError("SpoutSharedMemory::OpenSpinLock - could not create [%s]", name.c_str());
+		return false;
+	}
+	SetLastError(NO_ERROR);
+
+	m_pLockWord = (volatile LONG*)MapViewOfFile(m_hLockMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (!m_pLockWord) {
+		SpoutLogError("SpoutSharedMemory::OpenSpinLock - could not map [%s]", name.c_str());
+		CloseSpinLock();
+		return false;
+	}
+
+	// Auto reset event to release one waiter
+	name += "_event";
+	m_hLockEvent = CreateEventA(NULL, FALSE, FALSE, name.c_str());
+	SetLastError(NO_ERROR);
+	if (!m_hLockEvent) {
+		SpoutLogError("SpoutSharedMemory::OpenSpinLock - could not create [%s]", name.c_str());
+		CloseSpinLock();
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------
+// Function: CloseSpinLock
+// Close the lock word and waiter event
+void SpoutSharedMemory::CloseSpinLock()
+{
+	if (m_pLockWord) {
+		UnmapViewOfFile((LPCVOID)m_pLockWord);
+		m_pLockWord = nullptr;
+	}
+	if (m_hLockMap) {
+		CloseHandle(m_hLockMap);
+		m_hLockMap = NULL;
+	}
+	if (m_hLockEvent) {
+		CloseHandle(m_hLockEvent);
+		m_hLockEvent = NULL;
+	}
+}
+
+// The thread that holds a lock word has exited
+static bool LockOwnerExited(LONG owner)
+{
+	HANDLE hThread = OpenThread(SYNCHRONIZE, FALSE, (DWORD)owner);
+	if (!hThread) {
+		// No such thread
+		const bool bExited = (GetLastError() == ERROR_INVALID_PARAMETER);
+		SetLastError(NO_ERROR);
+		return bExited;
+	}
+	const bool bExited = (WaitForSingleObject(hThread, 0) == WAIT_OBJECT_0);
+	CloseHandle(hThread);
+	return bExited;
+}
+
+//---------------------------------------------------------
+// Function: SpinLock
+// Acquire the lock word.
+// Spin for a short time and then wait on the event until timeout.
+// A lock held by a thread that has exited is released.
+bool SpoutSharedMemory::SpinLock(DWORD dwTimeout)
+{
+	volatile LONG* pOwner  = &m_pLockWord[0];
+	volatile LONG* pWaiters = &m_pLockWord[1];
+	const LONG thread = (LONG)GetCurrentThreadId();
+
+	for (int i = 0; i < SPOUT_LOCK_SPINCOUNT; i++) {
+		if (*pOwner == 0 && InterlockedCompareExchange(pOwner, thread, 0) == 0)
+			return true;
+		YieldProcessor();
+	}
+
+	if (dwTimeout == 0)
+		return false;
+
+	const ULONGLONG start = GetTickCount64();
+	bool bLocked = false;
+	InterlockedIncrement(pWaiters);
+	for (;;) {
+		if (InterlockedCompareExchange(pOwner, thread, 0) == 0) {
+			bLocked = true;
+			break;
+		}
+		DWORD dwWait = 16; // Check the owner at intervals
+		if (dwTimeout != INFINITE) {
+			const ULONGLONG elapsed = GetTickCount64() - start;
+			if (elapsed >= dwTimeout)
+				break;
+			if (dwTimeout - elapsed < dwWait)
+				dwWait = (DWORD)(dwTimeout - elapsed);
+		}
+		if (WaitForSingleObject(m_hLockEvent, dwWait) == WAIT_TIMEOUT) {
+			const LONG owner = *pOwner;
+			if (owner != 0 && LockOwnerExited(owner)) {
+				SpoutLogWarning("SpoutSharedMemory::SpinLock - lock owner exited [%s]", m_pName);
+				InterlockedCompareExchange(pOwner, 0, owner);
+			}
+		}
+	}
+	InterlockedDecrement(pWaiters);
+
+	return bLocked;
+}
+
+//---------------------------------------------------------
+// Function: SpinUnlock
+// Release the lock word and wake a waiter
+void SpoutSharedMemory::SpinUnlock()
+{
+	InterlockedExchange(&m_pLockWord[0], 0);
+	if (m_pLockWord[1] > 0)
+		SetEvent(m_hLockEvent);
+}
+
 //---------------------------------------------------------
 // Function: Debug
 // Print map information for debugging
@@ -52,6 +52,50 @@ enum SpoutCreateResult {
 	SPOUT_ALREADY_CREATED,
 };
 
+// Default map lock timeout (4 frames at 60fps)
+#define SPOUT_LOCK_TIMEOUT 67
+
+// Lock wait iterations before blocking
+#define SPOUT_LOCK_SPINCOUNT 4000
+
+// Number of frame slots of the shared memory ring
+#define SPOUT_MEMORY_SLOTS 3
+
+// Memory share ring "<sendername>_memring_<width>x<height>"
+// Header followed by SPOUT_MEMORY_SLOTS slots of rgba pixels.
+// A ring has one frame size. For a different size the writer closes the ring
+// and creates another with a new name, so that a ring is never created again
+// while receivers have it open. Receivers open the ring for the sender size.
+// Slot (frame % SPOUT_MEMORY_SLOTS) has the pixels of a frame and
+// the slot sequence is 2*frame when complete, odd while written.
+// The slot size is written with the frame. If it is not zero, the slot has
+// that many bytes of pixels compressed by spoutCopy::EncodePixels.
+// Shared by the OpenGL memory share and the D3D12 copy queue writer.
+struct SpoutMemoryRing {
+	uint32_t magic; // SPOUT_MEMORY_RING when valid, 0 if closed by the writer
+	uint32_t capacity; // Bytes of each slot
+	uint32_t width; // Current frame size
+	uint32_t height;
+	uint32_t offset; // Bytes from the start of the map to the first slot (0 - after the header)
+	uint32_t size[SPOUT_MEMORY_SLOTS]; // Compressed bytes of each slot (0 - rgba pixels)
+	volatile LONG64 latest; // Latest complete frame (0 - none)
+	volatile LONG64 sequence[SPOUT_MEMORY_SLOTS]; // Slot sequence numbers
+};
+#define SPOUT_MEMORY_RING 0x524D5053 // "SPMR"
+
+// Pixels of a memory ring slot
+inline unsigned char* SpoutMemoryRingSlot(SpoutMemoryRing* pRing, int slot)
+{
+	const uint64_t offset = pRing->offset ? pRing->offset : sizeof(SpoutMemoryRing);
+	return reinterpret_cast<unsigned char*>(pRing) + offset + (uint64_t)slot * pRing->capacity;
+}
+
+// Memory ring map name for a sender and frame size
+inline void SpoutMemoryRingName(char* mapname, size_t maxchars, const char* sendername, unsigned int width, unsigned int height)
+{
+	sprintf_s(mapname, maxchars, "%s_memring_%ux%u", sendername, width, height);
+}
+
 class SPOUT_DLLEXP SpoutSharedMemory {
 
 public:
@@ -59,8 +103,9 @@ public:
 	SpoutSharedMemory();
 	~SpoutSharedMemory();
 
-	// Create a new memory segment, or attach to an existing one
-	SpoutCreateResult Create(const char* name, int size);
+	// Create a new memory segment, or attach to an existing one.
+	// Segments may be larger than 4GB (see SetViewSize and MapView).
+	SpoutCreateResult Create(const char* name, ULONGLONG size);
 
 	// Open an existing memory map
 	bool Open(const char* name);
@@ -70,15 +115,49 @@ public:
 
 	// Lock an open map and return the buffer
 	char* Lock();
+	// Lock with a timeout in msec (0 to return at once if not available)
+	char* Lock(DWORD dwTimeout);
 
 	// Unlock a map
 	void Unlock();
 
+	// Buffer pointer of an open map without locking
+	char* Buffer();
+
 	// Name of an existing map
 	const char* Name();
 	
-	// Size of an existing map
+	// Size of an existing map (limited to INT_MAX)
 	int Size();
+	// Size of an existing map
+	ULONGLONG Size64();
+
+	// Bytes mapped by Create and Open (0 for the whole map)
+	void SetViewSize(size_t size = 0);
+	// Size of the view mapped by Create or Open (0 for the whole map)
+	size_t GetViewSize();
+	// Map part of an open map without locking.
+	// Returns a pointer to the data at the offset.
+	char* MapView(ULONGLONG offset, size_t length);
+	// Unmap a view mapped by MapView
+	void UnmapView();
+
+	// Create maps of at least one large page with large pages if available
+	void SetLargePages(bool bLarge = true);
+	// Large pages requested
+	bool GetLargePages();
+	// The map was created with large pages
+	bool IsLargePageMap();
+
+	// Timeout for Lock() in msec
+	void SetLockTimeout(DWORD dwTimeout = SPOUT_LOCK_TIMEOUT);
+	// Lock timeout
+	DWORD GetLockTimeout();
+	// Spin on a shared lock word before blocking instead of using the map mutex.
+	// All processes using the map must enable the option.
+	void SetSpinLock(bool bSpin = true);
+	// Spin lock enabled
+	bool GetSpinLock();
 
 	// Print map information for debugging
 	void Debug();
@@ -90,8 +169,64 @@ private:
 	HANDLE m_hMutex; // Mutex for map access
 	int m_lockCount; // Map access lock count
 	char* m_pName; // Map name
-	int m_size; // Map size
+	ULONGLONG m_size; // Map size
+	size_t m_viewSize; // Bytes mapped by Create and Open
+	char* m_pView; // MapView base address
+	bool m_bLargePages; // Large pages requested
+	bool m_bLargePageMap; // Created with large pages
+	DWORD m_dwLockTimeout; // Lock timeout
+	bool m_bSpinLock; // Spin lock option
+	HANDLE m_hLockMap; // Spin lock word map
+	HANDLE m_hLockEvent; // Spin lock waiter event
+	volatile LONG* m_pLockWord; // Lock owner and waiter count
+
+	bool OpenSpinLock();
+	void CloseSpinLock();
+	bool SpinLock(DWORD dwTimeout);
+	void SpinUnlock();
+
+};
 
+//
+// Named data channel of a sender or receiver (CreateDataChannel).
+// Each channel retains its own shared memory map.
+//
+#define SPOUT_DATA_CHANNELS 8
+struct SpoutDataChannel {
+	char name[256]; // Channel name, the map is "name_map"
+	SpoutSharedMemory* pMap; // Retained map, null if the channel is not used
+	int size; // Bytes available to the writer, zero if opened for read
+};
+
+//
+// Scoped read of a sender memory buffer without copy.
+// The buffer is locked by LockMemoryBuffer for the life of the object.
+// For classes with LockMemoryBuffer and UnlockMemoryBuffer
+// (spoutGL, SpoutReceiver, spoutDX).
+//
+//   spoutMemoryBufferScope<SpoutReceiver> buffer(&receiver, "Sender name");
+//   if (buffer.Data()) ... buffer.Length() bytes ...
+//
+template <class T>
+class spoutMemoryBufferScope {
+public:
+	spoutMemoryBufferScope(T* pSpout, const char* name) :
+		m_pSpout(pSpout), m_pData(nullptr), m_Length(0) {
+		if (m_pSpout) m_Length = m_pSpout->LockMemoryBuffer(name, &m_pData);
+	}
+	~spoutMemoryBufferScope() {
+		if (m_pSpout && m_pData) m_pSpout->UnlockMemoryBuffer();
+	}
+	// Buffer data, null if not available
+	const char* Data() const { return m_pData; }
+	// Number of bytes available
+	int Length() const { return m_Length; }
+private:
+	spoutMemoryBufferScope(const spoutMemoryBufferScope&) = delete;
+	spoutMemoryBufferScope& operator=(const spoutMemoryBufferScope&) = delete;
+	T* m_pSpout;
+	const char* m_pData;
+	int m_Length;
 };
 
 #endif
@@ -182,10 +182,42 @@
 		27.12.23 - Send OK button message to close taskdialog instead of DestroyWindow for URL click
 				 - Test for custom icon and multiple buttons in MessageTaskDialog
 		Version 2.007.013
+		14.10.26 - Add spoutTimer class and spoutTimerScope for per-object scoped timing
+				 - Add SpoutTrace and SpoutTraceEnabled for TraceLogging events
+				 - Correct EndTiming comments for milliseconds return
+				 - Add EnableSpoutLogAsync and LogAsyncEnabled. Logs are queued without
+				   locks and written in batches by a background thread. The oldest logs
+				   are dropped if the queue is full.
+				 - Add SPOUT_MIN_LOG_LEVEL define to remove lower level logs at compile time
+				 - ReadDwordFromRegistry - DWORD values of the Spout settings key are read
+				   once for the process and again only after a change notification
+				 - Add spoutTimer::Record for times measured elsewhere, such as GPU queries
+		15.10.26 - Add thread scheduling functions. Threads created by Spout register
+				   with the Multimedia Class Scheduler, set priority and optionally
+				   select performance or efficiency cores of hybrid processors.
+				 - Add SPOUT_TRACE_ACCESS_WAIT for an access wait longer than a threshold
+				 - Add SPOUT_TRACE_RECEIVE_CHECK, SPOUT_TRACE_CONVERT_BEGIN/END
+				   and SPOUT_TRACE_FLUSH events
+				 - Add flight recorder. SpoutTrace records every event in a lock-free
+				   ring of the latest events of the process. The ring is written to a
+				   file if a stage takes longer than a threshold or by DumpFlightRecorder.
+				 - Flight recorder disabled by default. Enabled by EnableFlightRecorder
+				   or a threshold in the Spout settings, so that SpoutTraceEnabled is
+				   true only for a trace session or an enabled recorder.
+				   The dump callback keeps the module loaded (SetThreadpoolCallbackLibrary).
 
 */
 
 #include "SpoutUtils.h"
+#include <algorithm> // for std::sort
+
+#ifdef USE_TRACELOGGING
+#include <TraceLoggingProvider.h>
+#include <winmeta.h> // for WINEVENT_OPCODE_START/STOP
+// "Spout2" {8c31c397-495c-4bb3-b193-dee46884b93d}
+TRACELOGGING_DEFINE_PROVIDER(g_hSpoutTraceProvider, "Spout2",
+	(0x8c31c397, 0x495c, 0x4bb3, 0xb1, 0x93, 0xde, 0xe4, 0x68, 0x84, 0xb9, 0x3d));
+#endif
 
 //
 // Namespace: spoututils
@@ -199,6 +231,9 @@
 // - Registry utilities
 // - Computer information
 // - Timing utilities
+// - Event tracing
+// - Flight recorder
+// - Thread scheduling
 //
 // Refer to source code for documentation.
 //
@@ -215,6 +250,34 @@ namespace spoututils {
 	std::string logPath; // folder path for the logfile
 	char logChars[1024]={}; // The current log string
 	bool bConsole = false;
+	// Background log queue
+	// Slot sequence : 0 empty, odd being written, 2*(index+1) written for a log index
+	struct logEntry {
+		volatile LONG64 seq;
+		SpoutLogLevel level;
+		char log[1024];
+	};
+	const LONG64 logQueueSize = 256; // Queued logs before the oldest are dropped
+	logEntry* logQueue = nullptr;
+	volatile LONG64 logWriteIndex = 0; // Next log index to queue
+	LONG64 logReadIndex = 0; // Next log index to write (writer thread only)
+	bool bLogAsync = false;
+	volatile bool bLogThreadExit = false;
+	HANDLE hLogThread = NULL;
+	HANDLE hLogEvent = NULL;
+	// Spout settings DWORD values
+	struct spoutSetting {
+		char name[64];
+		DWORD value;
+	};
+	const int maxSettings = 64;
+	spoutSetting settings[maxSettings]={};
+	int nSettings = 0;
+	bool bSettingsValid = false; // values have been read
+	bool bSettingsPartial = false; // some DWORD values could not be saved
+	HKEY hSettingsKey = NULL; // key opened for change notification
+	HANDLE hSettingsEvent = NULL; // signalled when a value changes
+	SRWLOCK settingsLock = SRWLOCK_INIT;
 #ifdef USE_CHRONO
 	std::chrono::steady_clock::time_point start;
 	std::chrono::steady_clock::time_point end;
@@ -225,6 +288,45 @@ namespace spoututils {
 	double startcount = 0.0;
 	double endcount = 0.0;
 	double m_FrameStart = 0.0;
+	// Trace provider registration
+	INIT_ONCE traceInitOnce = INIT_ONCE_STATIC_INIT;
+	bool bTraceRegistered = false;
+	// Flight recorder
+	SpoutFlightEvent flightEvents[SPOUT_FLIGHT_EVENTS]={};
+	volatile LONG64 flightIndex = 0; // Next event index of the ring
+	volatile bool bFlightRecorder = false;
+	volatile double flightThreshold = 0.0; // msec
+	double flightFrequency = 1.0; // Performance counter frequency
+	INIT_ONCE flightInitOnce = INIT_ONCE_STATIC_INIT;
+	thread_local LONG64 t_flightBegin[3]={}; // Send, map and convert start on this thread
+	volatile LONG flightDumpBusy = 0;
+	LONG64 flightLastDump = 0;
+	int flightDumps = 0;
+	const int maxFlightDumps = 16; // Automatic files for the process
+	char flightReason[256]={};
+	// Thread scheduling
+	int threadPriority[SPOUT_THREAD_ROLES] = {
+		THREAD_PRIORITY_ABOVE_NORMAL, // Frame critical
+		THREAD_PRIORITY_NORMAL, // Worker
+		THREAD_PRIORITY_BELOW_NORMAL }; // Housekeeping
+	char threadTask[64] = "Games";
+	bool bThreadCoreHint = false;
+	SRWLOCK threadLock = SRWLOCK_INIT;
+	INIT_ONCE threadInitOnce = INIT_ONCE_STATIC_INIT;
+	// CPU set IDs of the performance and efficiency cores
+	const ULONG maxCores = 256;
+	ULONG performanceCores[maxCores]={};
+	ULONG nPerformanceCores = 0;
+	ULONG efficiencyCores[maxCores]={};
+	ULONG nEfficiencyCores = 0;
+	// Avrt.dll (Vista and later) and CPU set (Windows 10 and later) functions
+	typedef HANDLE(WINAPI* AvSetMmThreadCharacteristicsPROC)(LPCSTR, LPDWORD);
+	typedef BOOL(WINAPI* AvRevertMmThreadCharacteristicsPROC)(HANDLE);
+	typedef BOOL(WINAPI* GetSystemCpuSetInformationPROC)(PSYSTEM_CPU_SET_INFORMATION, ULONG, PULONG, HANDLE, ULONG);
+	typedef BOOL(WINAPI* SetThreadSelectedCpuSetsPROC)(HANDLE, const ULONG*, ULONG);
+	AvSetMmThreadCharacteristicsPROC pAvSetMmThreadCharacteristics = nullptr;
+	AvRevertMmThreadCharacteristicsPROC pAvRevertMmThreadCharacteristics = nullptr;
+	SetThreadSelectedCpuSetsPROC pSetThreadSelectedCpuSets = nullptr;
 
 	// Spout SDK version number string
 	// Major, minor, release
@@ -426,10 +528,14 @@ namespace spoututils {
 				return;
 		}
 		if (pCout) {
+			// Write queued logs before the console is closed
+			const bool bThread = _stopLogThread();
 			fclose(pCout);
 			FreeConsole();
 			pCout = NULL;
 			bConsole = false;
+			if (bThread)
+				_startLogThread();
 		}
 	}
 
@@ -548,6 +654,8 @@ namespace spoututils {
 	// You can find and examine the log file after the application has run.
 	void EnableSpoutLogFile(const char* filename, bool bAppend)
 	{
+		// The writer thread is stopped while the file is changed
+		const bool bThread = _stopLogThread();
 		bEnableLogFile = true;
 		if (!logPath.empty()) {
 			if (logFile.is_open())
@@ -559,17 +667,23 @@ namespace spoututils {
 		// Create the log file path given the filename passed in
 		logPath = _getLogFilePath(filename);
 		_logtofile(bAppend);
+		if (bThread)
+			_startLogThread();
 	}
 
 	// ---------------------------------------------------------
 	// Function: DisableSpoutLogFile
 	// Disable logging to file
 	void DisableSpoutLogFile() {
+		// Queued logs are written before the file is closed
+		const bool bThread = _stopLogThread();
 		if (!logPath.empty()) {
 			if (logFile.is_open())
 				logFile.close();
 			logPath.clear();
 		}
+		if (bThread)
+			_startLogThread();
 	}
 
 	// ---------------------------------------------------------
@@ -598,6 +712,9 @@ namespace spoututils {
 	// Disable logging to console and file
 	void DisableSpoutLog()
 	{
+		// Write queued logs and stop the writer thread
+		_stopLogThread();
+		bLogAsync = false;
 		CloseSpoutConsole();
 		if (!logPath.empty()) {
 			if (logFile.is_open())
@@ -638,6 +755,40 @@ namespace spoututils {
 		return bEnableLogFile;
 	}
 
+	// ---------------------------------------------------------
+	// Function: EnableSpoutLogAsync
+	// Write logs from a background thread.
+	//
+	// Console and file output can take some time and logs are produced
+	// within functions that are called every frame. With background logging,
+	// the calling thread only copies the log to a queue and the logs are written
+	// in batches by a separate thread, so logs can be left enabled for performance.
+	//
+	// The queue holds 256 logs. If the writer falls behind, the oldest logs
+	// are dropped and a warning with the number dropped is written.
+	// Queued logs are written when background logging or the log file
+	// is disabled, but logs still queued when the application exits are lost.
+	void EnableSpoutLogAsync(bool bAsync)
+	{
+		if (bAsync) {
+			if (_startLogThread())
+				bLogAsync = true;
+		}
+		else {
+			// Write queued logs before returning to direct logs
+			bLogAsync = false;
+			_stopLogThread();
+		}
+	}
+
+	// ---------------------------------------------------------
+	// Function: LogAsyncEnabled
+	// Is background logging enabled
+	bool LogAsyncEnabled()
+	{
+		return bLogAsync;
+	}
+
 	// ---------------------------------------------------------
 	// Function: GetSpoutLogPath
 	// Return the full log file path
@@ -731,6 +882,7 @@ namespace spoututils {
 		va_end(args);
 	}
 
+#if SPOUT_MIN_LOG_LEVEL <= 1
 	// ---------------------------------------------------------
 	// Function: SpoutLogVerbose
 	// Verbose - show log for SPOUT_LOG_VERBOSE or above
@@ -741,7 +893,9 @@ namespace spoututils {
 		_doLog(SPOUT_LOG_VERBOSE, format, args);
 		va_end(args);
 	}
+#endif
 
+#if SPOUT_MIN_LOG_LEVEL <= 2
 	// ---------------------------------------------------------
 	// Function: SpoutLogNotice
 	// Notice - show log for SPOUT_LOG_NOTICE or above
@@ -752,7 +906,9 @@ namespace spoututils {
 		_doLog(SPOUT_LOG_NOTICE, format, args);
 		va_end(args);
 	}
+#endif
 
+#if SPOUT_MIN_LOG_LEVEL <= 3
 	// ---------------------------------------------------------
 	// Function: SpoutLogWarning
 	// Warning - show log for SPOUT_LOG_WARNING or above
@@ -767,7 +923,9 @@ namespace spoututils {
 		SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 		va_end(args);
 	}
+#endif
 
+#if SPOUT_MIN_LOG_LEVEL <= 4
 	// ---------------------------------------------------------
 	// Function: SpoutLogError
 	// Error - show log for SPOUT_LOG_ERROR or above
@@ -778,6 +936,7 @@ namespace spoututils {
 		_doLog(SPOUT_LOG_ERROR, format, args);
 		va_end(args);
 	}
+#endif
 
 	// ---------------------------------------------------------
 	// Function: SpoutLogFatal
@@ -825,6 +984,12 @@ namespace spoututils {
 			// Save the current log as the last
 			strcpy_s(logChars, 1024, currentLog);
 
+			// Queue the log for the writer thread
+			if (bLogAsync && hLogThread) {
+				_queueLog(level, currentLog);
+				return;
+			}
+
 			// Console logging
 			if (bEnableLog && bConsole) {
 				FILE* out = stdout; // Console output
@@ -1124,11 +1289,28 @@ namespace spoututils {
 
 	// ---------------------------------------------------------
 	// Function: ReadDwordFromRegistry
-	// Read subkey DWORD value
+	// Read subkey DWORD value.
+	//
+	// DWORD values of the Spout settings key "Software\Leading Edge\Spout"
+	// are read together once for the process. They are read again
+	// only after the registry notifies a change to the key,
+	// so that class constructors do not read the registry each time.
 	bool ReadDwordFromRegistry(HKEY hKey, const char *subkey, const char *valuename, DWORD *pValue)
 	{
 		if (!subkey || !*subkey || !valuename || !*valuename || !pValue)
 			return false;
+
+		if (hKey == HKEY_CURRENT_USER && _stricmp(subkey, "Software\\Leading Edge\\Spout") == 0) {
+			const int result = _readSpoutSetting(valuename, pValue);
+			if (result >= 0) {
+				if (result == 0) {
+					SpoutLogWarning("ReadDwordFromRegistry - could not read [%s] from registry", valuename);
+					return false;
+				}
+				return true;
+			}
+			// Read directly if the settings could not be read
+		}
 	
 		DWORD dwKey = 0;
 		DWORD dwSize = sizeof(DWORD);
@@ -1170,6 +1352,9 @@ namespace spoututils {
 			RegCloseKey(hRegKey); // Done with the key
 		}
 
+		// Read settings again for the new value
+		_invalidateSettings();
+
 		if (regres != ERROR_SUCCESS) {
 			SpoutLogWarning("WriteDwordToRegistry - could not write [%s] to registry", valuename);
 			return false;
@@ -1292,6 +1477,7 @@ namespace spoututils {
 		if (regres == ERROR_SUCCESS) {
 			regres = RegDeleteValueA(hRegKey, valuename);
 			RegCloseKey(hRegKey);
+			_invalidateSettings();
 		}
 
 		if (regres == ERROR_SUCCESS)
@@ -1317,6 +1503,7 @@ namespace spoututils {
 			return false;
 
 		const LONG lStatus = RegDeleteKeyA(hKey, subkey);
+		_invalidateSettings();
 		if (lStatus == ERROR_SUCCESS)
 			return true;
 
@@ -1357,7 +1544,7 @@ namespace spoututils {
 
 	// ---------------------------------------------------------
 	// Function: 
-	// Stop timing and return microseconds elapsed.
+	// Stop timing and return milliseconds elapsed.
 	//
 	// Code console output can be enabled for quick timing tests.
 	// double EndTiming()
@@ -1420,7 +1607,7 @@ namespace spoututils {
 		StartCounter();
 	}
 
-	// Stop timing and return microseconds elapsed.
+	// Stop timing and return milliseconds elapsed.
 	// Console output can be enabled for quick timing tests.
 	double EndTiming() {
 		endcount = GetCounter();
@@ -1461,6 +1648,624 @@ namespace spoututils {
 		}
 	}
 
+	//
+	// Group: Event tracing
+	//
+	// TraceLogging events for Windows Performance Analyzer or GPUView.
+	//
+	// Sender and receiver stages can be aligned with GPU queues across processes.
+	// Capture with a trace session for the "Spout2" provider, e.g.
+	//   wpr -start GPU -start spout2.wprp
+	// or
+	//   tracelog -start spout -guid #8c31c397-495c-4bb3-b193-dee46884b93d -f spout.etl
+	//
+	// Events are not written if there is no session for the provider
+	// so they can remain in release builds.
+	//
+
+	// ---------------------------------------------------------
+	// Function: SpoutTraceEnabled
+	// Trace session active for the Spout provider or flight recorder enabled.
+	// Can be used to avoid preparing event data.
+	bool SpoutTraceEnabled()
+	{
+		_initFlightRecorder();
+		if (bFlightRecorder)
+			return true;
+#ifdef USE_TRACELOGGING
+		return (_registerTrace() && TraceLoggingProviderEnabled(g_hSpoutTraceProvider, 0, 0));
+#else
+		return false;
+#endif
+	}
+
+	// ---------------------------------------------------------
+	// Function: SpoutTrace
+	// Write a trace event with sender name, frame number and optional time in msec.
+	//
+	// Begin/end events have start and stop opcodes
+	// for regions of the same event name.
+	void SpoutTrace(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec)
+	{
+		// Record the event whether or not there is a trace session
+		_initFlightRecorder();
+		if (bFlightRecorder)
+			_recordFlight(event, sendername, frame, msec);
+
+#ifdef USE_TRACELOGGING
+		if (!_registerTrace() || !TraceLoggingProviderEnabled(g_hSpoutTraceProvider, 0, 0))
+			return;
+
+		const char* name = sendername ? sendername : "";
+
+		switch (event) {
+			case SPOUT_TRACE_SEND_BEGIN:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "SendTexture",
+					TraceLoggingOpcode(WINEVENT_OPCODE_START),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_SEND_END:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "SendTexture",
+					TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_ACCESS_ACQUIRE:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "TextureAccess",
+					TraceLoggingOpcode(WINEVENT_OPCODE_START),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"),
+					TraceLoggingFloat64(msec, "WaitMsec"));
+				break;
+			case SPOUT_TRACE_ACCESS_RELEASE:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "TextureAccess",
+					TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_RECEIVE_COPY:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "ReceiveCopy",
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_MAP_BEGIN:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "StagingMap",
+					TraceLoggingOpcode(WINEVENT_OPCODE_START),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_MAP_END:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "StagingMap",
+					TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_HOLD_FPS:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "HoldFps",
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"),
+					TraceLoggingFloat64(msec, "SleepMsec"));
+				break;
+			case SPOUT_TRACE_ACCESS_WAIT:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "AccessWait",
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"),
+					TraceLoggingFloat64(msec, "WaitMsec"));
+				break;
+			case SPOUT_TRACE_RECEIVE_CHECK:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "ReceiveCheck",
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_CONVERT_BEGIN:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "PixelConvert",
+					TraceLoggingOpcode(WINEVENT_OPCODE_START),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_CONVERT_END:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "PixelConvert",
+					TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			case SPOUT_TRACE_FLUSH:
+				TraceLoggingWrite(g_hSpoutTraceProvider, "SendFlush",
+					TraceLoggingString(name, "Sender"),
+					TraceLoggingInt64(frame, "Frame"));
+				break;
+			default:
+				break;
+		}
+#endif
+	}
+
+	//
+	// Group: Flight recorder
+	//
+	// Every trace event is recorded in a fixed size ring of the latest
+	// SPOUT_FLIGHT_EVENTS events of the process, whether or not a trace
+	// session is active. Recording takes a performance counter read and an
+	// interlocked increment without locks, so the recorder can remain enabled
+	// to catch a glitch that happens only occasionally.
+	//
+	// If a send, staging map, pixel conversion or texture access wait takes
+	// longer than a threshold (SetFlightRecorderThreshold), the events are
+	// written to a text file by a thread pool thread :
+	//   C:\Users\username\AppData\Roaming\Spout\exename_flight_yyyymmdd_hhmmss.txt
+	// A file is written at most every 10 seconds and 16 times for the process.
+	// The threshold can also be set in msec by the Spout settings
+	// DWORD value "FlightRecorder", which also enables the recorder.
+	//
+	// The recorder is disabled by default (EnableFlightRecorder).
+	//
+
+	// ---------------------------------------------------------
+	// Function: EnableFlightRecorder
+	// Enable or disable the flight recorder.
+	// Disabled by default unless there is a threshold in the Spout settings.
+	void EnableFlightRecorder(bool bEnable)
+	{
+		_initFlightRecorder();
+		bFlightRecorder = bEnable;
+	}
+
+	// ---------------------------------------------------------
+	// Function: FlightRecorderEnabled
+	// Flight recorder enabled.
+	bool FlightRecorderEnabled()
+	{
+		return bFlightRecorder;
+	}
+
+	// ---------------------------------------------------------
+	// Function: SetFlightRecorderThreshold
+	// Stage time in msec that writes the recorder to a file.
+	// 0 for no file (default).
+	void SetFlightRecorderThreshold(double msec)
+	{
+		_initFlightRecorder();
+		flightThreshold = (msec > 0.0) ? msec : 0.0;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetFlightRecorderThreshold
+	// Stage time in msec that writes the recorder to a file.
+	double GetFlightRecorderThreshold()
+	{
+		_initFlightRecorder();
+		return flightThreshold;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetFlightRecorder
+	// Copy the recorded events, oldest first.
+	// Returns the number of events copied.
+	//
+	// Events are not locked while they are copied.
+	// An event recorded during the copy can replace one of the oldest.
+	int GetFlightRecorder(SpoutFlightEvent* events, int maxevents)
+	{
+		if (!events || maxevents <= 0)
+			return 0;
+
+		const LONG64 last = flightIndex;
+		LONG64 first = last - SPOUT_FLIGHT_EVENTS;
+		if (first < 0)
+			first = 0;
+		if (last - first > maxevents)
+			first = last - maxevents;
+
+		int nEvents = 0;
+		for (LONG64 i = first; i < last; i++)
+			events[nEvents++] = flightEvents[i & (SPOUT_FLIGHT_EVENTS-1)];
+
+		return nEvents;
+	}
+
+	// ---------------------------------------------------------
+	// Function: DumpFlightRecorder
+	// Write the recorded events to a text file.
+	// Returns the file path or an empty string if the file could not be written.
+	//
+	// The default file is "exename_flight_yyyymmdd_hhmmss.txt"
+	// in the same folder as the default log file.
+	// Times are in msec before the last event.
+	std::string DumpFlightRecorder(const char* filepath, const char* reason)
+	{
+		_initFlightRecorder();
+
+		std::vector<SpoutFlightEvent> events(SPOUT_FLIGHT_EVENTS);
+		const int nEvents = GetFlightRecorder(events.data(), SPOUT_FLIGHT_EVENTS);
+
+		std::string path;
+		if (filepath && *filepath) {
+			path = filepath;
+		}
+		else {
+			SYSTEMTIME st={};
+			GetLocalTime(&st);
+			char name[64]={};
+			sprintf_s(name, 64, "_flight_%04d%02d%02d_%02d%02d%02d.txt",
+				st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+			path = _getLogPath();
+			path += "\\";
+			path += GetExeName();
+			path += name;
+		}
+
+		FILE* pFile = nullptr;
+		if (fopen_s(&pFile, path.c_str(), "wt") != 0 || !pFile)
+			return "";
+
+		fprintf(pFile, "Spout flight recorder - %s\n", GetExeName().c_str());
+		if (reason && *reason)
+			fprintf(pFile, "%s\n", reason);
+		fprintf(pFile, "%d events\n\n", nEvents);
+		fprintf(pFile, "%12s %8s %-14s %-20s %10s %10s\n",
+			"msec", "thread", "event", "sender", "frame", "value");
+
+		const LONG64 lasttime = (nEvents > 0) ? events[nEvents-1].time : 0;
+		for (int i = 0; i < nEvents; i++) {
+			const SpoutFlightEvent& ev = events[i];
+			char sender[sizeof(ev.sender)+1]={};
+			memcpy(sender, ev.sender, sizeof(ev.sender));
+			fprintf(pFile, "%12.3f %8lu %-14s %-20s %10lld %10.3f\n",
+				static_cast<double>(ev.time - lasttime)*1000.0/flightFrequency,
+				ev.thread, _flightEventName(ev.event), sender, ev.frame, ev.msec);
+		}
+		fclose(pFile);
+
+		return path;
+	}
+
+	//
+	// Group: Thread scheduling
+	//
+	// Threads created by Spout call BeginSpoutThread when they start
+	// so that they are not delayed by other work when the system is busy.
+	//
+	// Frame critical threads (asynchronous send, background receive)
+	// register with the Multimedia Class Scheduler Service for the task
+	// selected by SetSpoutThreadTask and have above normal priority.
+	// Housekeeping threads (log writer, sender cleanup and service,
+	// sender pre-open) have below normal priority. spoutCopy worker
+	// stripes run on system pool threads and are restored after each
+	// image by EndSpoutThread.
+	//
+	// For processors with performance and efficiency cores, SetSpoutThreadCoreHint
+	// selects performance cores for frame critical threads and efficiency
+	// cores for the others. This is a hint to the scheduler using CPU sets
+	// and is disabled by default.
+	//
+
+	// ---------------------------------------------------------
+	// Function: SetSpoutThreadPriority
+	// Set the priority of threads of a role.
+	//   THREAD_PRIORITY_LOWEST to THREAD_PRIORITY_TIME_CRITICAL
+	void SetSpoutThreadPriority(SpoutThreadRole role, int priority)
+	{
+		if (role < 0 || role >= SPOUT_THREAD_ROLES)
+			return;
+		if (priority < THREAD_PRIORITY_LOWEST && priority != THREAD_PRIORITY_IDLE)
+			priority = THREAD_PRIORITY_LOWEST;
+		if (priority > THREAD_PRIORITY_HIGHEST && priority != THREAD_PRIORITY_TIME_CRITICAL)
+			priority = THREAD_PRIORITY_HIGHEST;
+		threadPriority[role] = priority;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetSpoutThreadPriority
+	// Priority of threads of a role
+	int GetSpoutThreadPriority(SpoutThreadRole role)
+	{
+		if (role < 0 || role >= SPOUT_THREAD_ROLES)
+			return THREAD_PRIORITY_NORMAL;
+		return threadPriority[role];
+	}
+
+	// ---------------------------------------------------------
+	// Function: SetSpoutThreadTask
+	// Multimedia Class Scheduler task for frame critical threads.
+	// A task of the "SystemProfile\Tasks" registry key,
+	// "Games" (default), "Pro Audio", "Playback" etc.
+	// An empty string or null for no registration.
+	void SetSpoutThreadTask(const char* taskname)
+	{
+		AcquireSRWLockExclusive(&threadLock);
+		if (taskname)
+			strcpy_s(threadTask, 64, taskname);
+		else
+			threadTask[0] = 0;
+		ReleaseSRWLockExclusive(&threadLock);
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetSpoutThreadTask
+	// Multimedia Class Scheduler task for frame critical threads
+	std::string GetSpoutThreadTask()
+	{
+		AcquireSRWLockShared(&threadLock);
+		std::string task = threadTask;
+		ReleaseSRWLockShared(&threadLock);
+		return task;
+	}
+
+	// ---------------------------------------------------------
+	// Function: SetSpoutThreadCoreHint
+	// Select performance cores for frame critical threads and
+	// efficiency cores for others on hybrid processors.
+	// No effect for other processors.
+	void SetSpoutThreadCoreHint(bool bHint)
+	{
+		bThreadCoreHint = bHint;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetSpoutThreadCoreHint
+	// Performance and efficiency core hint enabled
+	bool GetSpoutThreadCoreHint()
+	{
+		return bThreadCoreHint;
+	}
+
+	// ---------------------------------------------------------
+	// Function: IsHybridProcessor
+	// Processor with performance and efficiency cores.
+	// Requires Windows 10 or later.
+	bool IsHybridProcessor()
+	{
+		_initThreadScheduling();
+		return (nPerformanceCores > 0 && nEfficiencyCores > 0);
+	}
+
+	// ---------------------------------------------------------
+	// Function: BeginSpoutThread
+	// Apply the settings of a role to the calling thread.
+	// Returns the Multimedia Class Scheduler handle for EndSpoutThread
+	// or null if the thread is not registered.
+	HANDLE BeginSpoutThread(SpoutThreadRole role)
+	{
+		if (role < 0 || role >= SPOUT_THREAD_ROLES)
+			return nullptr;
+
+		_initThreadScheduling();
+
+		if (threadPriority[role] != THREAD_PRIORITY_NORMAL)
+			SetThreadPriority(GetCurrentThread(), threadPriority[role]);
+
+		// Performance cores for frame critical threads, efficiency cores for others
+		if (bThreadCoreHint && nPerformanceCores > 0 && nEfficiencyCores > 0) {
+			if (role == SPOUT_THREAD_FRAME)
+				pSetThreadSelectedCpuSets(GetCurrentThread(), performanceCores, nPerformanceCores);
+			else
+				pSetThreadSelectedCpuSets(GetCurrentThread(), efficiencyCores, nEfficiencyCores);
+		}
+
+		// Multimedia Class Scheduler for frame critical threads
+		HANDLE hTask = nullptr;
+		if (role == SPOUT_THREAD_FRAME && pAvSetMmThreadCharacteristics) {
+			char task[64]={};
+			AcquireSRWLockShared(&threadLock);
+			strcpy_s(task, 64, threadTask);
+			ReleaseSRWLockShared(&threadLock);
+			if (task[0]) {
+				DWORD dwTaskIndex = 0;
+				hTask = pAvSetMmThreadCharacteristics(task, &dwTaskIndex);
+			}
+		}
+
+		return hTask;
+	}
+
+	// ---------------------------------------------------------
+	// Function: EndSpoutThread
+	// Restore the calling thread after BeginSpoutThread.
+	// Pool threads used by spoutCopy are returned to normal priority
+	// and all processors so that other work on the pool is not affected.
+	void EndSpoutThread(SpoutThreadRole role, HANDLE hTask)
+	{
+		if (hTask && pAvRevertMmThreadCharacteristics)
+			pAvRevertMmThreadCharacteristics(hTask);
+
+		if (role == SPOUT_THREAD_WORKER) {
+			if (threadPriority[role] != THREAD_PRIORITY_NORMAL)
+				SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+			if (nPerformanceCores > 0 && nEfficiencyCores > 0)
+				pSetThreadSelectedCpuSets(GetCurrentThread(), nullptr, 0);
+		}
+	}
+
+	//
+	// Class: spoutTimer
+	//
+	// Scoped timing of named stages for an object.
+	//
+	// Start returns a performance counter value
+	// and Stop records the time elapsed for a scope.
+	// Statistics are calculated from the last SPOUT_TIMER_SAMPLES
+	// times of each scope when they are queried. Disabled by default.
+	//
+
+	spoutTimer::spoutTimer()
+	{
+		m_bEnabled = false;
+		m_Frequency = 0.0;
+		m_nScopes = 0;
+		for (int i = 0; i < SPOUT_TIMER_SCOPES; i++) {
+			m_Names[i] = nullptr;
+			m_Count[i] = 0;
+		}
+		LARGE_INTEGER li={};
+		if (QueryPerformanceFrequency(&li))
+			m_Frequency = static_cast<double>(li.QuadPart) / 1000.0;
+	}
+
+	spoutTimer::~spoutTimer()
+	{
+
+	}
+
+	// ---------------------------------------------------------
+	// Function: Enable
+	// Enable or disable timing
+	void spoutTimer::Enable(bool bEnable)
+	{
+		m_bEnabled = (bEnable && m_Frequency > 0.0);
+	}
+
+	// ---------------------------------------------------------
+	// Function: IsEnabled
+	// Timing enabled
+	bool spoutTimer::IsEnabled()
+	{
+		return m_bEnabled;
+	}
+
+	// ---------------------------------------------------------
+	// Function: Start
+	// Start time of a scope. Zero if timing is disabled.
+	LONG64 spoutTimer::Start()
+	{
+		if (!m_bEnabled)
+			return 0;
+		LARGE_INTEGER li={};
+		QueryPerformanceCounter(&li);
+		return li.QuadPart;
+	}
+
+	// ---------------------------------------------------------
+	// Function: Stop
+	// Record the time elapsed since start for a named scope.
+	// The name pointer is retained and must persist for the life of the timer.
+	void spoutTimer::Stop(const char* name, LONG64 start)
+	{
+		if (!m_bEnabled || start == 0 || !name)
+			return;
+
+		LARGE_INTEGER li={};
+		QueryPerformanceCounter(&li);
+
+		Record(name, static_cast<double>(li.QuadPart - start) / m_Frequency);
+	}
+
+	// ---------------------------------------------------------
+	// Function: Record
+	// Record a time in milliseconds measured elsewhere for a named scope.
+	// For example the GPU time of a copy from timestamp queries.
+	// The name pointer is retained and must persist for the life of the timer.
+	void spoutTimer::Record(const char* name, double msec)
+	{
+		if (!m_bEnabled || !name)
+			return;
+
+		int index = FindScope(name);
+		if (index < 0) {
+			if (m_nScopes >= SPOUT_TIMER_SCOPES)
+				return;
+			index = m_nScopes;
+			m_Names[index] = name;
+			m_Count[index] = 0;
+			m_nScopes++;
+		}
+		m_Samples[index][m_Count[index] % SPOUT_TIMER_SAMPLES] = static_cast<float>(msec);
+		m_Count[index]++;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetScopes
+	// Number of scopes recorded
+	int spoutTimer::GetScopes()
+	{
+		return m_nScopes;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetStats
+	// Statistics of a scope by index
+	bool spoutTimer::GetStats(int index, SpoutTimerStats& stats)
+	{
+		if (index < 0 || index >= m_nScopes || m_Count[index] == 0)
+			return false;
+
+		const unsigned int count = m_Count[index];
+		const unsigned int n = (count < SPOUT_TIMER_SAMPLES) ? count : SPOUT_TIMER_SAMPLES;
+
+		float sorted[SPOUT_TIMER_SAMPLES];
+		double total = 0.0;
+		for (unsigned int i = 0; i < n; i++) {
+			sorted[i] = m_Samples[index][i];
+			total += static_cast<double>(sorted[i]);
+		}
+		std::sort(sorted, sorted + n);
+
+		stats.name = m_Names[index];
+		stats.count = count;
+		stats.samples = n;
+		stats.last = static_cast<double>(m_Samples[index][(count - 1) % SPOUT_TIMER_SAMPLES]);
+		stats.min = static_cast<double>(sorted[0]);
+		stats.max = static_cast<double>(sorted[n - 1]);
+		stats.avg = total / static_cast<double>(n);
+		// Nearest rank
+		unsigned int rank = (n * 99 + 99) / 100;
+		if (rank > n) rank = n;
+		stats.p99 = static_cast<double>(sorted[rank - 1]);
+
+		return true;
+	}
+
+	// ---------------------------------------------------------
+	// Function: GetStats
+	// Statistics of a scope by name
+	bool spoutTimer::GetStats(const char* name, SpoutTimerStats& stats)
+	{
+		return GetStats(FindScope(name), stats);
+	}
+
+	// ---------------------------------------------------------
+	// Function: Reset
+	// Clear all scopes
+	void spoutTimer::Reset()
+	{
+		for (int i = 0; i < SPOUT_TIMER_SCOPES; i++) {
+			m_Names[i] = nullptr;
+			m_Count[i] = 0;
+		}
+		m_nScopes = 0;
+	}
+
+	// ---------------------------------------------------------
+	// Function: LogStats
+	// Log statistics of all scopes
+	void spoutTimer::LogStats(const char* caption)
+	{
+		SpoutTimerStats stats={};
+		SpoutLog("%s - %d scopes (msec)", caption ? caption : "spoutTimer", m_nScopes);
+		for (int i = 0; i < m_nScopes; i++) {
+			if (GetStats(i, stats)) {
+				SpoutLog("    %-20s %6u  min %.3f  avg %.3f  p99 %.3f  max %.3f",
+					stats.name, stats.count, stats.min, stats.avg, stats.p99, stats.max);
+			}
+		}
+	}
+
+	// Find a scope by name pointer, then by string
+	int spoutTimer::FindScope(const char* name)
+	{
+		if (!name)
+			return -1;
+		for (int i = 0; i < m_nScopes; i++) {
+			if (m_Names[i] == name)
+				return i;
+		}
+		for (int i = 0; i < m_nScopes; i++) {
+			if (strcmp(m_Names[i], name) == 0)
+				return i;
+		}
+		return -1;
+	}
+
 
 	//
 	// Private functions
@@ -1520,6 +2325,312 @@ namespace spoututils {
 			}
 		}
 
+		// Start the log writer thread
+		bool _startLogThread()
+		{
+			if (hLogThread)
+				return true;
+
+			// The queue is retained once created so that a log
+			// being queued is never written to released memory
+			if (!logQueue) {
+				logQueue = new(std::nothrow) logEntry[logQueueSize]();
+				if (!logQueue)
+					return false;
+			}
+
+			if (!hLogEvent) {
+				hLogEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+				if (!hLogEvent)
+					return false;
+			}
+
+			bLogThreadExit = false;
+			hLogThread = CreateThread(NULL, 0, _logThread, NULL, 0, NULL);
+
+			return (hLogThread != NULL);
+		}
+
+		// Stop the log writer thread and write any logs still queued.
+		// Returns true if the thread was running.
+		bool _stopLogThread()
+		{
+			if (!hLogThread)
+				return false;
+
+			bLogThreadExit = true;
+			SetEvent(hLogEvent);
+			// The thread exits after the current batch
+			WaitForSingleObject(hLogThread, INFINITE);
+			CloseHandle(hLogThread);
+			hLogThread = NULL;
+
+			// The calling thread is now the only reader of the queue
+			_writeLogQueue();
+
+			return true;
+		}
+
+		// Add a log to the queue.
+		// Each log takes the next index and the slot for that index.
+		// An older log in the slot is overwritten if the queue is full.
+		void _queueLog(SpoutLogLevel level, const char* log)
+		{
+			const LONG64 index = InterlockedIncrement64(&logWriteIndex) - 1;
+			const LONG64 written = 2*(index+1);
+			logEntry* entry = &logQueue[index % logQueueSize];
+
+			// Claim the slot with an odd sequence while the log is copied.
+			// Another thread only holds the slot for the time of a copy.
+			LONG64 seq = 0;
+			do {
+				seq = entry->seq;
+				if (seq > written) {
+					// The queue has wrapped past this log and a newer one is in the slot
+					return;
+				}
+			} while ((seq & 1) || InterlockedCompareExchange64(&entry->seq, seq+1, seq) != seq);
+
+			entry->level = level;
+			strcpy_s(entry->log, 1024, log);
+
+			// Release the slot with the sequence for this log
+			InterlockedExchange64(&entry->seq, written);
+
+			SetEvent(hLogEvent);
+		}
+
+		// Write queued logs in one batch for the console and the log file.
+		// Called only by the writer thread, or after the thread has stopped.
+		void _writeLogQueue()
+		{
+			if (!logQueue)
+				return;
+
+			std::string fileLogs;
+			std::vector<SpoutLogLevel> consoleLevels;
+			std::vector<std::string> consoleLines;
+			LONG64 dropped = 0;
+			logEntry entry={};
+
+			const LONG64 writeIndex = InterlockedCompareExchange64(&logWriteIndex, 0, 0);
+
+			// Skip logs that have been overwritten
+			if (writeIndex - logReadIndex > logQueueSize) {
+				dropped += writeIndex - logQueueSize - logReadIndex;
+				logReadIndex = writeIndex - logQueueSize;
+			}
+
+			while (logReadIndex < writeIndex) {
+				logEntry* slot = &logQueue[logReadIndex % logQueueSize];
+				const LONG64 written = 2*(logReadIndex+1);
+				const LONG64 seq = slot->seq;
+				if (seq != written) {
+					if (seq < written) {
+						// Not copied yet. Write it with the next batch.
+						break;
+					}
+					// Overwritten by a newer log
+					dropped++;
+					logReadIndex++;
+					continue;
+				}
+				entry.level = slot->level;
+				memcpy(entry.log, slot->log, 1024);
+				entry.log[1023] = 0;
+				MemoryBarrier();
+				// Overwritten while it was copied
+				if (slot->seq != written) {
+					dropped++;
+					logReadIndex++;
+					continue;
+				}
+				logReadIndex++;
+
+				// Console and file logs in the same format as direct logs
+				std::string line;
+				if (entry.level != SPOUT_LOG_NONE) {
+					line = "[";
+					line += _levelName(entry.level);
+					line += "] ";
+				}
+				line += entry.log;
+				if (bEnableLog && bConsole) {
+					consoleLevels.push_back(entry.level);
+					consoleLines.push_back(line);
+				}
+				// No verbose logs for log to file
+				if (entry.level != SPOUT_LOG_VERBOSE) {
+					fileLogs += line;
+					fileLogs += "\n";
+				}
+			}
+
+			if (dropped > 0) {
+				char tmp[128]={};
+				sprintf_s(tmp, 128, "[%s] %lld logs dropped", _levelName(SPOUT_LOG_WARNING).c_str(), dropped);
+				if (bEnableLog && bConsole) {
+					consoleLevels.push_back(SPOUT_LOG_WARNING);
+					consoleLines.push_back(tmp);
+				}
+				fileLogs += tmp;
+				fileLogs += "\n";
+			}
+
+			// Console logging
+			if (!consoleLines.empty()) {
+				HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+				for (size_t i = 0; i < consoleLines.size(); i++) {
+					// Yellow text for warnings and errors
+					if (consoleLevels[i] == SPOUT_LOG_WARNING || consoleLevels[i] == SPOUT_LOG_ERROR)
+						SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+					fprintf(stdout, "%s\n", consoleLines[i].c_str());
+					// Reset white text
+					SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+				}
+			}
+
+			// File logging
+			// One open and close of the log file for the batch
+			if (!fileLogs.empty() && bEnableLogFile && !logPath.empty()) {
+				logFile.open(logPath, logFile.app);
+				if (logFile.is_open()) {
+					logFile << fileLogs;
+					logFile.flush();
+				}
+				logFile.close();
+			}
+		}
+
+		// Log writer thread.
+		// Logs are written in batches after they are queued or
+		// at an interval for any log that was still being copied.
+		DWORD WINAPI _logThread(LPVOID lpParameter)
+		{
+			UNREFERENCED_PARAMETER(lpParameter);
+			const HANDLE hTask = BeginSpoutThread(SPOUT_THREAD_HOUSEKEEPING);
+			while (!bLogThreadExit) {
+				WaitForSingleObject(hLogEvent, 100);
+				if (bLogThreadExit)
+					break;
+				_writeLogQueue();
+			}
+			EndSpoutThread(SPOUT_THREAD_HOUSEKEEPING, hTask);
+			return 0;
+		}
+
+		// Read a DWORD value of the Spout settings key.
+		// All values are read again if the key has changed.
+		// Returns 1 if the value was found, 0 if not or -1
+		// if the settings could not be read.
+		int _readSpoutSetting(const char* valuename, DWORD* pValue)
+		{
+			AcquireSRWLockShared(&settingsLock);
+			bool bRead = bSettingsValid && hSettingsEvent
+				&& (WaitForSingleObject(hSettingsEvent, 0) == WAIT_TIMEOUT);
+			if (bRead) {
+				for (int i = 0; i < nSettings; i++) {
+					if (_stricmp(settings[i].name, valuename) == 0) {
+						*pValue = settings[i].value;
+						ReleaseSRWLockShared(&settingsLock);
+						return 1;
+					}
+				}
+				const int result = bSettingsPartial ? -1 : 0;
+				ReleaseSRWLockShared(&settingsLock);
+				return result;
+			}
+			ReleaseSRWLockShared(&settingsLock);
+
+			//
+			// Read all DWORD values of the key
+			//
+			int result = -1;
+			AcquireSRWLockExclusive(&settingsLock);
+
+			// The key is opened again in case it has been removed
+			if (hSettingsKey) {
+				RegCloseKey(hSettingsKey);
+				hSettingsKey = NULL;
+			}
+			if (!hSettingsEvent)
+				hSettingsEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+			bSettingsValid = false;
+			bSettingsPartial = false;
+			nSettings = 0;
+
+			if (hSettingsEvent && RegOpenKeyExA(HKEY_CURRENT_USER, "Software\\Leading Edge\\Spout",
+				0, KEY_READ | KEY_NOTIFY, &hSettingsKey) == ERROR_SUCCESS) {
+
+				// Request notification before reading so that no change is missed.
+				// REG_NOTIFY_THREAD_AGNOSTIC (Windows 8 and later) keeps the request
+				// if this thread exits. For earlier systems the event is signalled
+				// when the thread exits and the values are read again.
+				ResetEvent(hSettingsEvent);
+				LONG regres = RegNotifyChangeKeyValue(hSettingsKey, FALSE,
+					REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_CHANGE_NAME | 0x10000000L, // REG_NOTIFY_THREAD_AGNOSTIC
+					hSettingsEvent, TRUE);
+				if (regres != ERROR_SUCCESS) {
+					regres = RegNotifyChangeKeyValue(hSettingsKey, FALSE,
+						REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_CHANGE_NAME, hSettingsEvent, TRUE);
+				}
+
+				if (regres == ERROR_SUCCESS) {
+					char name[256]={};
+					for (DWORD index = 0; ; index++) {
+						DWORD namelength = 256;
+						DWORD type = 0;
+						DWORD value = 0;
+						DWORD size = sizeof(DWORD);
+						regres = RegEnumValueA(hSettingsKey, index, name, &namelength, NULL, &type, (LPBYTE)&value, &size);
+						if (regres == ERROR_NO_MORE_ITEMS)
+							break;
+						if (regres == ERROR_SUCCESS && type == REG_DWORD && size == sizeof(DWORD)) {
+							// Values that cannot be saved are read directly
+							if (nSettings < maxSettings && namelength < 64) {
+								strcpy_s(settings[nSettings].name, 64, name);
+								settings[nSettings].value = value;
+								nSettings++;
+							}
+							else {
+								bSettingsPartial = true;
+							}
+						}
+					}
+					bSettingsValid = true;
+				}
+			}
+
+			// No key or no notification
+			if (!bSettingsValid && hSettingsKey) {
+				RegCloseKey(hSettingsKey);
+				hSettingsKey = NULL;
+			}
+
+			if (bSettingsValid) {
+				result = bSettingsPartial ? -1 : 0;
+				for (int i = 0; i < nSettings; i++) {
+					if (_stricmp(settings[i].name, valuename) == 0) {
+						*pValue = settings[i].value;
+						result = 1;
+						break;
+					}
+				}
+			}
+
+			ReleaseSRWLockExclusive(&settingsLock);
+
+			return result;
+		}
+
+		// Read the settings again with the next value
+		void _invalidateSettings()
+		{
+			AcquireSRWLockExclusive(&settingsLock);
+			bSettingsValid = false;
+			ReleaseSRWLockExclusive(&settingsLock);
+		}
+
 		// Get the default log file path
 		std::string _getLogPath()
 		{
@@ -2063,6 +3174,249 @@ namespace spoututils {
 			return bRet;
 
 		} // end OpenSpoutPanel
+
+#ifdef USE_TRACELOGGING
+		// Unregister the trace provider on exit
+		// or before the dll is unloaded
+		void __cdecl _unregisterTrace()
+		{
+			if (bTraceRegistered) {
+				TraceLoggingUnregister(g_hSpoutTraceProvider);
+				bTraceRegistered = false;
+			}
+		}
+
+		BOOL CALLBACK _traceInitOnce(PINIT_ONCE, PVOID, PVOID*)
+		{
+			if (SUCCEEDED(TraceLoggingRegister(g_hSpoutTraceProvider))) {
+				bTraceRegistered = true;
+				atexit(_unregisterTrace);
+			}
+			return TRUE;
+		}
+#endif
+
+		// Register the trace provider once for the process
+		bool _registerTrace()
+		{
+#ifdef USE_TRACELOGGING
+			InitOnceExecuteOnce(&traceInitOnce, _traceInitOnce, NULL, NULL);
+			return bTraceRegistered;
+#else
+			return false;
+#endif
+		}
+
+		// Counter frequency and threshold from the Spout settings
+		BOOL CALLBACK _flightInitOnce(PINIT_ONCE, PVOID, PVOID*)
+		{
+			LARGE_INTEGER frequency={};
+			if (QueryPerformanceFrequency(&frequency) && frequency.QuadPart > 0)
+				flightFrequency = static_cast<double>(frequency.QuadPart);
+			// A threshold in the settings enables the recorder
+			DWORD dwValue = 0;
+			if (_readSpoutSetting("FlightRecorder", &dwValue) > 0 && dwValue > 0) {
+				flightThreshold = static_cast<double>(dwValue);
+				bFlightRecorder = true;
+			}
+			return TRUE;
+		}
+
+		// Initialize the flight recorder once for the process
+		void _initFlightRecorder()
+		{
+			InitOnceExecuteOnce(&flightInitOnce, _flightInitOnce, NULL, NULL);
+		}
+
+		// Record an event in the flight recorder ring
+		// and check the time of the stage against the threshold
+		void _recordFlight(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec)
+		{
+			_initFlightRecorder();
+
+			LARGE_INTEGER now={};
+			QueryPerformanceCounter(&now);
+
+			// Reserve the next event of the ring
+			const LONG64 index = InterlockedIncrement64(&flightIndex) - 1;
+			SpoutFlightEvent& ev = flightEvents[index & (SPOUT_FLIGHT_EVENTS-1)];
+			ev.time = now.QuadPart;
+			ev.frame = frame;
+			ev.msec = static_cast<float>(msec);
+			ev.event = static_cast<unsigned short>(event);
+			ev.reserved = 0;
+			ev.thread = GetCurrentThreadId();
+			ev.sender[0] = 0;
+			if (sendername)
+				strncpy_s(ev.sender, sizeof(ev.sender), sendername, _TRUNCATE);
+
+			// Time of a stage ending with this event
+			double stage = 0.0;
+			int begin = -1;
+			switch (event) {
+				case SPOUT_TRACE_SEND_BEGIN:
+					t_flightBegin[0] = now.QuadPart;
+					break;
+				case SPOUT_TRACE_MAP_BEGIN:
+					t_flightBegin[1] = now.QuadPart;
+					break;
+				case SPOUT_TRACE_CONVERT_BEGIN:
+					t_flightBegin[2] = now.QuadPart;
+					break;
+				case SPOUT_TRACE_SEND_END:
+					begin = 0;
+					break;
+				case SPOUT_TRACE_MAP_END:
+					begin = 1;
+					break;
+				case SPOUT_TRACE_CONVERT_END:
+					begin = 2;
+					break;
+				case SPOUT_TRACE_ACCESS_ACQUIRE:
+				case SPOUT_TRACE_ACCESS_WAIT:
+					stage = msec;
+					break;
+				default:
+					break;
+			}
+			if (begin >= 0) {
+				if (t_flightBegin[begin] > 0)
+					stage = static_cast<double>(now.QuadPart - t_flightBegin[begin])*1000.0/flightFrequency;
+				t_flightBegin[begin] = 0;
+			}
+
+			const double threshold = flightThreshold;
+			if (threshold > 0.0 && stage > threshold)
+				_triggerFlightDump(event, sendername, frame, stage);
+		}
+
+		// Write the flight recorder to a file on a thread pool thread
+		// so that the stage that took too long is not delayed further
+		void _triggerFlightDump(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec)
+		{
+			// One file at a time
+			if (InterlockedCompareExchange(&flightDumpBusy, 1, 0) != 0)
+				return;
+
+			// At most every 10 seconds and maxFlightDumps for the process
+			LARGE_INTEGER now={};
+			QueryPerformanceCounter(&now);
+			if (flightDumps >= maxFlightDumps
+				|| (flightLastDump != 0 && static_cast<double>(now.QuadPart - flightLastDump)/flightFrequency < 10.0)) {
+				InterlockedExchange(&flightDumpBusy, 0);
+				return;
+			}
+			flightLastDump = now.QuadPart;
+			flightDumps++;
+
+			sprintf_s(flightReason, 256, "%s %.3f msec - %s frame %lld",
+				_flightEventName(static_cast<unsigned short>(event)), msec,
+				sendername ? sendername : "", frame);
+
+			// The module is kept loaded until the callback returns,
+			// so that it cannot run after the library is unloaded
+			TP_CALLBACK_ENVIRON callbackEnviron;
+			InitializeThreadpoolEnvironment(&callbackEnviron);
+			HMODULE hModule = NULL;
+			if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+				reinterpret_cast<LPCSTR>(&_flightDumpCallback), &hModule))
+				SetThreadpoolCallbackLibrary(&callbackEnviron, hModule);
+			if (!hModule || !TrySubmitThreadpoolCallback(_flightDumpCallback, NULL, &callbackEnviron))
+				InterlockedExchange(&flightDumpBusy, 0);
+			DestroyThreadpoolEnvironment(&callbackEnviron);
+		}
+
+		VOID CALLBACK _flightDumpCallback(PTP_CALLBACK_INSTANCE instance, PVOID context)
+		{
+			UNREFERENCED_PARAMETER(instance);
+			UNREFERENCED_PARAMETER(context);
+			DumpFlightRecorder(nullptr, flightReason);
+			InterlockedExchange(&flightDumpBusy, 0);
+		}
+
+		// Name of a recorded event
+		const char* _flightEventName(unsigned short event)
+		{
+			switch (event) {
+				case SPOUT_TRACE_SEND_BEGIN:     return "SendBegin";
+				case SPOUT_TRACE_SEND_END:       return "SendEnd";
+				case SPOUT_TRACE_ACCESS_ACQUIRE: return "AccessAcquire";
+				case SPOUT_TRACE_ACCESS_RELEASE: return "AccessRelease";
+				case SPOUT_TRACE_RECEIVE_COPY:   return "ReceiveCopy";
+				case SPOUT_TRACE_MAP_BEGIN:      return "MapBegin";
+				case SPOUT_TRACE_MAP_END:        return "MapEnd";
+				case SPOUT_TRACE_HOLD_FPS:       return "HoldFps";
+				case SPOUT_TRACE_ACCESS_WAIT:    return "AccessWait";
+				case SPOUT_TRACE_RECEIVE_CHECK:  return "ReceiveCheck";
+				case SPOUT_TRACE_CONVERT_BEGIN:  return "ConvertBegin";
+				case SPOUT_TRACE_CONVERT_END:    return "ConvertEnd";
+				case SPOUT_TRACE_FLUSH:          return "Flush";
+				default:                         return "Unknown";
+			}
+		}
+
+		// Find the scheduling functions and the processor cores.
+		// Performance cores have the highest efficiency class
+		// and efficiency cores the lowest. All cores have the same
+		// class if the processor is not hybrid.
+		BOOL CALLBACK _threadInitOnce(PINIT_ONCE, PVOID, PVOID*)
+		{
+			// The library is retained for the process
+			const HMODULE hAvrt = LoadLibraryA("avrt.dll");
+			if (hAvrt) {
+				pAvSetMmThreadCharacteristics = (AvSetMmThreadCharacteristicsPROC)GetProcAddress(hAvrt, "AvSetMmThreadCharacteristicsA");
+				pAvRevertMmThreadCharacteristics = (AvRevertMmThreadCharacteristicsPROC)GetProcAddress(hAvrt, "AvRevertMmThreadCharacteristics");
+			}
+
+			const HMODULE hKernel = GetModuleHandleA("kernel32.dll");
+			if (!hKernel)
+				return TRUE;
+			const GetSystemCpuSetInformationPROC pGetSystemCpuSetInformation
+				= (GetSystemCpuSetInformationPROC)GetProcAddress(hKernel, "GetSystemCpuSetInformation");
+			pSetThreadSelectedCpuSets = (SetThreadSelectedCpuSetsPROC)GetProcAddress(hKernel, "SetThreadSelectedCpuSets");
+			if (!pGetSystemCpuSetInformation || !pSetThreadSelectedCpuSets)
+				return TRUE;
+
+			ULONG size = 0;
+			pGetSystemCpuSetInformation(nullptr, 0, &size, GetCurrentProcess(), 0);
+			if (size == 0)
+				return TRUE;
+			std::vector<unsigned char> buffer(size);
+			if (!pGetSystemCpuSetInformation((PSYSTEM_CPU_SET_INFORMATION)buffer.data(), size, &size, GetCurrentProcess(), 0))
+				return TRUE;
+
+			BYTE minClass = 255;
+			BYTE maxClass = 0;
+			for (ULONG offset = 0; offset < size; ) {
+				const PSYSTEM_CPU_SET_INFORMATION info = (PSYSTEM_CPU_SET_INFORMATION)(buffer.data() + offset);
+				if (info->Type == CpuSetInformation) {
+					minClass = (std::min)(minClass, info->CpuSet.EfficiencyClass);
+					maxClass = (std::max)(maxClass, info->CpuSet.EfficiencyClass);
+				}
+				offset += info->Size;
+			}
+			if (maxClass <= minClass)
+				return TRUE;
+
+			for (ULONG offset = 0; offset < size; ) {
+				const PSYSTEM_CPU_SET_INFORMATION info = (PSYSTEM_CPU_SET_INFORMATION)(buffer.data() + offset);
+				if (info->Type == CpuSetInformation) {
+					if (info->CpuSet.EfficiencyClass == maxClass && nPerformanceCores < maxCores)
+						performanceCores[nPerformanceCores++] = info->CpuSet.Id;
+					else if (info->CpuSet.EfficiencyClass == minClass && nEfficiencyCores < maxCores)
+						efficiencyCores[nEfficiencyCores++] = info->CpuSet.Id;
+				}
+				offset += info->Size;
+			}
+
+			return TRUE;
+		}
+
+		// Scheduling functions and processor cores found once for the process
+		void _initThreadScheduling()
+		{
+			InitOnceExecuteOnce(&threadInitOnce, _threadInitOnce, NULL, NULL);
+		}
 		
 	} // end private namespace
 
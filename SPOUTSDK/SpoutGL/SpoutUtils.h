@@ -60,6 +60,38 @@
 #define USE_CHRONO
 #endif
 
+//
+// Event Tracing for Windows
+//
+// TraceLogging events for the main stages of sending and receiving
+// are written to the "Spout2" provider {8c31c397-495c-4bb3-b193-dee46884b93d}
+// Events are only written while a trace session for the provider is active.
+// Requires TraceLoggingProvider.h from the Windows 10 SDK.
+// Comment out or remove the define to build without events.
+//
+#if defined(_MSC_VER)
+#define USE_TRACELOGGING
+#endif
+
+//
+// Compiled log level
+//
+// Logs below this level are removed at compile time and have no cost.
+// The value is that of the SpoutLogLevel enum.
+//   0 - all logs (default)
+//   2 - remove Verbose logs (SPOUT_LOG_NOTICE)
+//   3 - remove Verbose and Notice logs (SPOUT_LOG_WARNING)
+//   4 - remove all except Error and Fatal logs (SPOUT_LOG_ERROR)
+//   5 - remove all except Fatal logs (SPOUT_LOG_FATAL)
+// SpoutLog and SpoutLogFatal are never removed.
+// SetSpoutLogLevel still selects from the logs that remain.
+// Define in the preprocessor definitions for all projects of the build.
+// For example : SPOUT_MIN_LOG_LEVEL=3
+//
+#ifndef SPOUT_MIN_LOG_LEVEL
+#define SPOUT_MIN_LOG_LEVEL 0
+#endif
+
 #ifdef USE_CHRONO
 #include <chrono> // c++11 timer
 #include <thread>
@@ -180,6 +212,13 @@ namespace spoututils {
 	// Is file logging enabled
 	bool SPOUT_DLLEXP LogFileEnabled();
 
+	// Write logs from a background thread
+	// Logs are queued and written in batches. The oldest are dropped if the queue is full.
+	void SPOUT_DLLEXP EnableSpoutLogAsync(bool bAsync = true);
+
+	// Is background logging enabled
+	bool SPOUT_DLLEXP LogAsyncEnabled();
+
 	// Return the full log file path
 	std::string SPOUT_DLLEXP GetSpoutLogPath();
 
@@ -195,17 +234,36 @@ namespace spoututils {
 	// General purpose log
 	void SPOUT_DLLEXP SpoutLog(const char* format, ...);
 	
+	// Logs removed by SPOUT_MIN_LOG_LEVEL are replaced by an empty
+	// inline function that the compiler removes with the format string
+
 	// Verbose - show log for SPOUT_LOG_VERBOSE or above
+#if SPOUT_MIN_LOG_LEVEL > 1
+	template<typename... Args> inline void SpoutLogVerbose(const char*, const Args&...) {}
+#else
 	void SPOUT_DLLEXP SpoutLogVerbose(const char* format, ...);
+#endif
 	
 	// Notice - show log for SPOUT_LOG_NOTICE or above
+#if SPOUT_MIN_LOG_LEVEL > 2
+	template<typename... Args> inline void SpoutLogNotice(const char*, const Args&...) {}
+#else
 	void SPOUT_DLLEXP SpoutLogNotice(const char* format, ...);
+#endif
 	
 	// Warning - show log for SPOUT_LOG_WARNING or above
+#if SPOUT_MIN_LOG_LEVEL > 3
+	template<typename... Args> inline void SpoutLogWarning(const char*, const Args&...) {}
+#else
 	void SPOUT_DLLEXP SpoutLogWarning(const char* format, ...);
+#endif
 	
 	// Error - show log for SPOUT_LOG_ERROR or above
+#if SPOUT_MIN_LOG_LEVEL > 4
+	template<typename... Args> inline void SpoutLogError(const char*, const Args&...) {}
+#else
 	void SPOUT_DLLEXP SpoutLogError(const char* format, ...);
+#endif
 	
 	// Fatal - always show log
 	void SPOUT_DLLEXP SpoutLogFatal(const char* format, ...);
@@ -299,7 +357,7 @@ namespace spoututils {
 	// Start timing period
 	void SPOUT_DLLEXP StartTiming();
 
-	// Stop timing and return microseconds elapsed.
+	// Stop timing and return milliseconds elapsed.
 	// Code console output can be enabled for quick timing tests.
 	double SPOUT_DLLEXP EndTiming();
 
@@ -313,6 +371,205 @@ namespace spoututils {
 	void SPOUT_DLLEXP StartCounter();
 	double SPOUT_DLLEXP GetCounter();
 
+	//
+	// Event tracing
+	//
+
+	// Events with sender name and frame number
+	enum SpoutTraceEvent {
+		// SendTexture start and stop
+		SPOUT_TRACE_SEND_BEGIN,
+		SPOUT_TRACE_SEND_END,
+		// Shared texture access acquired with the wait time and released
+		SPOUT_TRACE_ACCESS_ACQUIRE,
+		SPOUT_TRACE_ACCESS_RELEASE,
+		// Receiver copy from the shared texture
+		SPOUT_TRACE_RECEIVE_COPY,
+		// Staging texture map start and stop
+		SPOUT_TRACE_MAP_BEGIN,
+		SPOUT_TRACE_MAP_END,
+		// HoldFps sleep time
+		SPOUT_TRACE_HOLD_FPS,
+		// Shared texture access wait longer than a threshold
+		SPOUT_TRACE_ACCESS_WAIT,
+		// Receiver check for a new frame
+		SPOUT_TRACE_RECEIVE_CHECK,
+		// Pixel conversion start and stop
+		SPOUT_TRACE_CONVERT_BEGIN,
+		SPOUT_TRACE_CONVERT_END,
+		// Sender flush and new frame signal
+		SPOUT_TRACE_FLUSH
+	};
+
+	// Trace session active for the Spout provider or flight recorder enabled
+	bool SPOUT_DLLEXP SpoutTraceEnabled();
+
+	// Write a trace event with sender name, frame number and optional time in msec
+	void SPOUT_DLLEXP SpoutTrace(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec = 0.0);
+
+	//
+	// Flight recorder
+	//
+	// Trace events are always recorded in a ring of the latest events
+	// of the process and written to a file if a stage takes too long.
+	//
+
+	// Events in the flight recorder ring (power of 2)
+#define SPOUT_FLIGHT_EVENTS 4096
+
+	// Recorded trace event
+	struct SpoutFlightEvent {
+		LONG64 time; // Performance counter
+		LONG64 frame; // Frame number
+		float msec; // Time passed with the event
+		unsigned short event; // SpoutTraceEvent
+		unsigned short reserved;
+		DWORD thread; // Thread ID
+		char sender[20]; // Sender name, truncated
+	};
+
+	// Enable or disable the flight recorder (default disabled)
+	void SPOUT_DLLEXP EnableFlightRecorder(bool bEnable = true);
+	// Flight recorder enabled
+	bool SPOUT_DLLEXP FlightRecorderEnabled();
+	// Stage time in msec that writes the recorder to a file (0 to disable)
+	void SPOUT_DLLEXP SetFlightRecorderThreshold(double msec);
+	// Stage time that writes the recorder to a file
+	double SPOUT_DLLEXP GetFlightRecorderThreshold();
+	// Copy the recorded events, oldest first, and return the number copied
+	int SPOUT_DLLEXP GetFlightRecorder(SpoutFlightEvent* events, int maxevents);
+	// Write the recorded events to a text file and return the path
+	std::string SPOUT_DLLEXP DumpFlightRecorder(const char* filepath = nullptr, const char* reason = nullptr);
+
+	//
+	// Thread scheduling
+	//
+	// Threads created by Spout apply the settings for their role when they start.
+	// Change the settings before senders and receivers are created.
+	//
+
+	// Roles of threads created by Spout
+	enum SpoutThreadRole {
+		// Frame critical - asynchronous send and background receive
+		SPOUT_THREAD_FRAME,
+		// Pixel conversion stripes of spoutCopy on pool threads
+		SPOUT_THREAD_WORKER,
+		// Housekeeping - log writer, sender cleanup and service, sender pre-open
+		SPOUT_THREAD_HOUSEKEEPING,
+		SPOUT_THREAD_ROLES
+	};
+
+	// Set the priority of threads of a role (THREAD_PRIORITY_LOWEST to THREAD_PRIORITY_TIME_CRITICAL)
+	void SPOUT_DLLEXP SetSpoutThreadPriority(SpoutThreadRole role, int priority);
+
+	// Priority of threads of a role
+	int SPOUT_DLLEXP GetSpoutThreadPriority(SpoutThreadRole role);
+
+	// Multimedia Class Scheduler task for frame critical threads
+	// "Games" (default), "Pro Audio", "Playback" etc. or an empty string for none
+	void SPOUT_DLLEXP SetSpoutThreadTask(const char* taskname);
+
+	// Multimedia Class Scheduler task for frame critical threads
+	std::string SPOUT_DLLEXP GetSpoutThreadTask();
+
+	// Hybrid processors - frame critical threads on performance cores,
+	// worker and housekeeping threads on efficiency cores
+	void SPOUT_DLLEXP SetSpoutThreadCoreHint(bool bHint = true);
+
+	// Performance and efficiency core hint enabled
+	bool SPOUT_DLLEXP GetSpoutThreadCoreHint();
+
+	// Processor with performance and efficiency cores
+	bool SPOUT_DLLEXP IsHybridProcessor();
+
+	// Apply the settings of a role to the calling thread.
+	// Returns the Multimedia Class Scheduler handle for EndSpoutThread.
+	HANDLE SPOUT_DLLEXP BeginSpoutThread(SpoutThreadRole role);
+
+	// Restore the calling thread after BeginSpoutThread
+	void SPOUT_DLLEXP EndSpoutThread(SpoutThreadRole role, HANDLE hTask);
+
+	//
+	// Scoped timing
+	//
+	// StartTiming/EndTiming use one global timer.
+	// spoutTimer is for an object to time named stages of its own.
+	// Each scope keeps the last SPOUT_TIMER_SAMPLES times for
+	// rolling minimum, average, maximum and 99th percentile.
+	// Disabled by default. Not thread safe, use a timer for each thread.
+	//
+
+	// Maximum number of named scopes for a timer
+#define SPOUT_TIMER_SCOPES 16
+	// Samples in the rolling window of each scope
+#define SPOUT_TIMER_SAMPLES 128
+
+	// Statistics of a scope in milliseconds
+	struct SpoutTimerStats {
+		const char* name; // Scope name
+		unsigned int count; // Samples since reset
+		unsigned int samples; // Samples in the rolling window
+		double last; // Last time
+		double min; // Rolling minimum
+		double avg; // Rolling average
+		double max; // Rolling maximum
+		double p99; // Rolling 99th percentile
+	};
+
+	class SPOUT_DLLEXP spoutTimer {
+
+	public:
+
+		spoutTimer();
+		~spoutTimer();
+
+		// Enable or disable timing
+		void Enable(bool bEnable = true);
+		// Timing enabled
+		bool IsEnabled();
+		// Start time of a scope - zero if disabled
+		LONG64 Start();
+		// Record the time since start for a named scope
+		// The name must be a string literal or persist for the life of the timer
+		void Stop(const char* name, LONG64 start);
+		// Record a time measured elsewhere for a named scope, for example on the GPU
+		void Record(const char* name, double msec);
+		// Number of scopes recorded
+		int GetScopes();
+		// Statistics of a scope by index
+		bool GetStats(int index, SpoutTimerStats& stats);
+		// Statistics of a scope by name
+		bool GetStats(const char* name, SpoutTimerStats& stats);
+		// Clear all scopes
+		void Reset();
+		// Log statistics of all scopes
+		void LogStats(const char* caption = nullptr);
+
+	private:
+
+		int FindScope(const char* name);
+		bool m_bEnabled;
+		double m_Frequency; // Counts per millisecond
+		int m_nScopes;
+		const char* m_Names[SPOUT_TIMER_SCOPES];
+		unsigned int m_Count[SPOUT_TIMER_SCOPES];
+		float m_Samples[SPOUT_TIMER_SCOPES][SPOUT_TIMER_SAMPLES];
+
+	};
+
+	// Time the life of a block for a named scope
+	//   spoutTimerScope scope(&timer, "ReadPixels");
+	class spoutTimerScope {
+	public:
+		spoutTimerScope(spoutTimer* timer, const char* name) :
+			m_pTimer(timer), m_Name(name), m_Start(timer->Start()) {}
+		~spoutTimerScope() { m_pTimer->Stop(m_Name, m_Start); }
+	private:
+		spoutTimer* m_pTimer;
+		const char* m_Name;
+		LONG64 m_Start;
+	};
+
 	//
 	// Private functions
 	//
@@ -323,6 +580,25 @@ namespace spoututils {
 		std::string _getLogPath();
 		std::string _getLogFilePath(const char *filename);
 		std::string _levelName(SpoutLogLevel level);
+		// Background log writer
+		bool _startLogThread();
+		bool _stopLogThread();
+		void _queueLog(SpoutLogLevel level, const char* log);
+		void _writeLogQueue();
+		DWORD WINAPI _logThread(LPVOID lpParameter);
+		// Spout settings read once for the process
+		int _readSpoutSetting(const char* valuename, DWORD* pValue);
+		void _invalidateSettings();
+		// Register the trace provider once for the process
+		bool _registerTrace();
+		// Flight recorder
+		void _recordFlight(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec);
+		void _triggerFlightDump(SpoutTraceEvent event, const char* sendername, LONG64 frame, double msec);
+		const char* _flightEventName(unsigned short event);
+		void _initFlightRecorder();
+		VOID CALLBACK _flightDumpCallback(PTP_CALLBACK_INSTANCE instance, PVOID context);
+		// Scheduling functions and processor cores found once for the process
+		void _initThreadScheduling();
 		// Taskdialog for SpoutMessageBox
 		int MessageTaskDialog(HWND hWnd, const char* content, const char* caption, DWORD dwButtons, DWORD dwMilliseconds);
 		// TaskDialogIndirect callback to handle timer, topmost and hyperlinks
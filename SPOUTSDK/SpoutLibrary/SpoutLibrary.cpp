@@ -106,6 +106,9 @@
 //		03.12.23   Rebuild with SDK version 2.007.013 /MD and /MT using CMake
 //		08.12.23   Rebuild all libraries /MT and /MD with Openframeworks 12.0 files using CMake
 //		28.12.23   Add SpoutMessageBoxModeless and SpoutMessageBoxWindow
+//		15.10.26   Add GetSenderList
+//		15.10.26   Add ReceiveImageView and ReleaseImageView
+//		15.10.26   Add GetSpoutShared factory, SetSharedInterop and GetSharedInterop
 //
 /*
 		Copyright (c) 2016-2024, Lynn Jarvis. All rights reserved.
@@ -400,6 +403,24 @@ private: // Spout SDK functions
 	//    As for ReceiveTexture, the ID of a currently bound fbo should be passed in.
 	bool ReceiveImage(unsigned char *pixels, GLenum glFormat = GL_RGBA, bool bInvert = false, GLuint HostFbo = 0);
 	
+	// Function: ReceiveImageView
+	// Receive a view of the mapped sender frame without copy.
+	//
+	//    For hosts that wrap the data pointer directly,
+	//    such as managed languages, without copy to their own buffer.
+	//    The view has the data pointer, line pitch, width, height,
+	//    data size, DXGI format and sender frame number.
+	//    Lines can be padded, so use the pitch and not the width.
+	//    The data is valid until ReleaseImageView is called,
+	//    which must be done before the next receive.
+	//    Returns false if there is no new data to view.
+	//    Requires a texture sender.
+	bool ReceiveImageView(SpoutLibImageView* pView);
+
+	// Function: ReleaseImageView
+	// Release the view returned by ReceiveImageView.
+	void ReleaseImageView();
+
 	// Function: IsUpdated
 	// Query whether the sender has changed.
 	//
@@ -794,6 +815,11 @@ private: // Spout SDK functions
 	// Function: GetSenderInfo
 	// Sender information
 	bool GetSenderInfo(const char* sendername, unsigned int &width, unsigned int &height, HANDLE &dxShareHandle, DWORD &dwFormat);
+
+	// Function: GetSenderList
+	// Details of all senders in one call.
+	// Returns the number of senders copied, or the number of senders if pSenders is null.
+	int GetSenderList(SpoutLibSenderDetails* pSenders, int maxsenders);
 	
 	// Function: GetActiveSender
 	// Current active sender
@@ -1101,6 +1127,21 @@ private: // Spout SDK functions
 	// Return the class context
 	void * GetDX11Context();
 
+	// Function: SetSharedInterop
+	// Share DirectX and GL/DX interop devices with other instances.
+	//
+	//    Instances on the same OpenGL context that enable shared interop
+	//    use the same DirectX 11 device and GL/DX interop device,
+	//    for example one instance for each layer of a host application.
+	//    Instances must be used from the thread of the OpenGL context.
+	//    Set before the first send or receive.
+	//    Instances created by GetSpoutShared have this enabled.
+	void SetSharedInterop(bool bShared = true);
+
+	// Function: GetSharedInterop
+	// Shared interop devices enabled
+	bool GetSharedInterop();
+
 	//
 	// Group: Class release
 	//
@@ -1216,6 +1257,28 @@ bool SPOUTImpl::ReceiveImage(unsigned char *pixels, GLenum glFormat, bool bInver
 	return spout->ReceiveImage(pixels, glFormat, bInvert, HostFbo);
 }
 
+bool SPOUTImpl::ReceiveImageView(SpoutLibImageView* pView)
+{
+	if (!pView)
+		return false;
+
+	SpoutImageView view;
+	const bool bView = spout->ReceiveImageView(view);
+	pView->data   = view.data;
+	pView->pitch  = view.pitch;
+	pView->width  = view.width;
+	pView->height = view.height;
+	pView->size   = view.pitch*view.height;
+	pView->format = view.format;
+	pView->frame  = view.frame;
+	return bView;
+}
+
+void SPOUTImpl::ReleaseImageView()
+{
+	spout->ReleaseImageView();
+}
+
 bool SPOUTImpl::IsUpdated()
 {
 	return spout->IsUpdated();
@@ -1586,6 +1649,27 @@ bool SPOUTImpl::GetSenderInfo(const char* sendername, unsigned int &width, unsig
 	return spout->GetSenderInfo(sendername, width, height, dxShareHandle, dwFormat);
 }
 
+int SPOUTImpl::GetSenderList(SpoutLibSenderDetails* pSenders, int maxsenders)
+{
+	if (!pSenders || maxsenders <= 0)
+		return spout->GetSenderList(nullptr, 0);
+
+	std::vector<SpoutSenderDetails> senders(maxsenders);
+	const int count = spout->GetSenderList(senders.data(), maxsenders);
+	for (int i = 0; i < count; i++) {
+		strcpy_s(pSenders[i].name, 256, senders[i].name);
+		pSenders[i].width = senders[i].width;
+		pSenders[i].height = senders[i].height;
+		pSenders[i].format = senders[i].format;
+		pSenders[i].shareHandle = senders[i].shareHandle;
+		pSenders[i].fps = senders[i].fps;
+		pSenders[i].frame = senders[i].frame;
+		pSenders[i].adapter = senders[i].adapter;
+		strcpy_s(pSenders[i].hostpath, 256, senders[i].hostpath);
+	}
+	return count;
+}
+
 bool SPOUTImpl::GetActiveSender(char* Sendername)
 {
 	return spout->GetActiveSender(Sendername);
@@ -1911,6 +1995,16 @@ void * SPOUTImpl::GetDX11Context()
 	return spout->GetDX11Device();
 }
 
+void SPOUTImpl::SetSharedInterop(bool bShared)
+{
+	spout->SetSharedInterop(bShared);
+}
+
+bool SPOUTImpl::GetSharedInterop()
+{
+	return spout->GetSharedInterop();
+}
+
 
 //
 // Class function
@@ -1942,6 +2036,7 @@ void SPOUTImpl::Release()
 // This pragma is required only for 32-bit builds.
 // In a 64-bit environment, C functions are not decorated.
 #pragma comment(linker, "/export:GetSpout=_GetSpout@0")
+#pragma comment(linker, "/export:GetSpoutShared=_GetSpoutShared@0")
 #endif  // _WIN64
 
 extern "C" SPOUTAPI SPOUTHANDLE APIENTRY GetSpout()
@@ -1955,4 +2050,18 @@ extern "C" SPOUTAPI SPOUTHANDLE APIENTRY GetSpout()
 	return pSpout;
 }
 
+// Instances created by GetSpoutShared use one DirectX 11 device
+// and GL/DX interop device for each OpenGL context of the process.
+// The devices are released with the last instance that uses them.
+extern "C" SPOUTAPI SPOUTHANDLE APIENTRY GetSpoutShared()
+{
+	SPOUTImpl * pSpout = new SPOUTImpl;
+	pSpout->spout = new Spout;
+
+	// Share DirectX and interop devices with other shared instances
+	pSpout->spout->SetSharedInterop(true);
+
+	return pSpout;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
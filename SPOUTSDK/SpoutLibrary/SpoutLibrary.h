@@ -87,6 +87,33 @@ enum SpoutLibLogLevel {
 	SPOUT_LOG_NONE
 };
 
+//
+// Sender details returned by GetSenderList.
+// Defined here to avoid include of SpoutSenderNames.h
+//
+struct SpoutLibSenderDetails {
+	char name[256]; // Sender name
+	unsigned int width; // Texture width
+	unsigned int height; // Texture height
+	DWORD format; // Texture format
+	HANDLE shareHandle; // Texture share handle
+	double fps; // Sender frame rate, zero if not recorded
+	LONG64 frame; // Last frame sent, zero without frame counting
+	LUID adapter; // Sender adapter, zero if not recorded
+	char hostpath[256]; // Sender executable path
+};
+
+// Mapped sender frame (ReceiveImageView)
+struct SpoutLibImageView {
+	const unsigned char* data; // First pixel of the top line
+	unsigned int pitch; // Bytes per line including padding
+	unsigned int width; // Width in pixels
+	unsigned int height; // Height in lines
+	unsigned int size; // Data size in bytes (pitch * height)
+	DWORD format; // DXGI texture format
+	long frame; // Sender frame number
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // COM-Like abstract interface.
@@ -514,6 +541,30 @@ struct SPOUTLIBRARY
 	// Library release function
     virtual void Release() = 0;
 
+	//
+	// Functions added after Release
+	//
+	// The order of the functions above must not change so that
+	// applications built with an earlier header can use this library.
+	// New functions are added at the end.
+	//
+
+	// Details of all senders
+	virtual int GetSenderList(SpoutLibSenderDetails* pSenders, int maxsenders) = 0;
+
+	// Receive a view of the mapped sender frame without copy
+	//   The data is valid until ReleaseImageView
+	virtual bool ReceiveImageView(SpoutLibImageView* pView) = 0;
+	// Release the view returned by ReceiveImageView
+	virtual void ReleaseImageView() = 0;
+
+	// Share DirectX and GL/DX interop devices with other instances
+	//   on the same OpenGL context. Set before the first send or receive.
+	//   Instances created by GetSpoutShared have this enabled.
+	virtual void SetSharedInterop(bool bShared = true) = 0;
+	// Shared interop devices enabled
+	virtual bool GetSharedInterop() = 0;
+
 };
 
 // Handle type. In C++ language the interface type is used.
@@ -522,4 +573,8 @@ typedef SPOUTLIBRARY* SPOUTHANDLE;
 // Factory function that creates an instance of the SPOUT object.
 extern "C" SPOUTAPI SPOUTHANDLE WINAPI GetSpout(VOID);
 
+// Factory function that creates an instance of the SPOUT object
+// sharing DirectX and GL/DX interop devices with other shared instances.
+extern "C" SPOUTAPI SPOUTHANDLE WINAPI GetSpoutShared(VOID);
+
 ////////////////////////////////////////////////////////////////////////////////